@@ -0,0 +1,103 @@
+#include <iostream>
+#include <string>
+
+#include "harness.h"
+#include "kernel_benches.cc"
+#include "effect_benches.cc"
+#include "io_benches.cc"
+#include "concurrency_benches.cc"
+
+namespace {
+
+void usage(){
+    std::cout << "usage: bench [--filter <text>] [--json <file>] [--baseline <file>] [--tolerance <fraction>]\n"
+              << "             [--min-time <seconds>] [--max-frames <n>] [--dir <directory>]\n"
+              << "             [--stream-seconds <seconds>] [--stream-pool <blocks>]\n"
+              << "             [--duration <seconds>] [--cores <producer>,<consumer>]\n"
+              << "\n"
+              << "  --filter <text>       only the benchmarks whose name contains it (e.g. kernel/gain, effect/).\n"
+              << "  --json <file>         write the results as JSON.\n"
+              << "  --baseline <file>     compare with the JSON of an earlier run, exit with 2 if slower.\n"
+              << "  --tolerance <f>       slowdown reported as a regression (default 0.10).\n"
+              << "  --min-time <seconds>  time each measurement repeats for (default 0.25).\n"
+              << "  --max-frames <n>      largest buffer (or file) of the sweep, in frames (default one hour of 48 kHz).\n"
+              << "  --dir <directory>     where the I/O benchmarks write (default: the temp directory).\n"
+              << "  --stream-seconds <s>  wall time of each FileStreamer run (default 3).\n"
+              << "  --stream-pool <n>     buffers of the FileStreamer pool, 5.33 ms each (default 256).\n"
+              << "  --duration <s>        wall time of each concurrency run (default 0.5), hours for a soak test.\n"
+              << "  --cores <p>,<c>       pin the producer and consumer threads of the concurrency runs.\n"
+              << "\n"
+              << "Set AJ_SIMD=scalar|sse4.1|avx2|avx512|neon to run the effects with another kernel table.\n"
+              << "Exits with 2 on a regression against the baseline, 3 if a concurrency run lost the order.\n";
+}
+
+}
+
+int main(int argc, char **argv){
+    AJ::bench::Options options;
+
+    try {
+        for(int i = 1; i < argc; ++i){
+            const std::string arg = argv[i];
+            const bool valued = i + 1 < argc;
+
+            if(arg == "--filter" && valued){
+                options.filter = argv[++i];
+            } else if(arg == "--json" && valued){
+                options.json = argv[++i];
+            } else if(arg == "--baseline" && valued){
+                options.baseline = argv[++i];
+            } else if(arg == "--tolerance" && valued){
+                options.tolerance = std::stod(argv[++i]);
+            } else if(arg == "--min-time" && valued){
+                options.minTime = std::stod(argv[++i]);
+            } else if(arg == "--max-frames" && valued){
+                options.maxFrames = std::stoull(argv[++i]);
+            } else if(arg == "--dir" && valued){
+                options.directory = argv[++i];
+            } else if(arg == "--stream-seconds" && valued){
+                options.streamSeconds = std::stod(argv[++i]);
+            } else if(arg == "--stream-pool" && valued){
+                options.streamPool = std::stoull(argv[++i]);
+            } else if(arg == "--duration" && valued){
+                options.duration = std::stod(argv[++i]);
+            } else if(arg == "--cores" && valued){
+                const std::string cores = argv[++i];
+                const size_t comma = cores.find(',');
+                if(comma == std::string::npos){
+                    usage();
+                    return 1;
+                }
+                options.producerCore = std::stoi(cores.substr(0, comma));
+                options.consumerCore = std::stoi(cores.substr(comma + 1));
+            } else {
+                usage();
+                return 1;
+            }
+        }
+    } catch(const std::exception&){
+        usage();
+        return 1;
+    }
+
+    AJ::bench::Runner runner(options);
+
+    KernelBenches::run_all(runner);
+    EffectBenches::run_all(runner);
+    IOBenches::run_all(runner);
+    const bool ordered = ConcurrencyBenches::run_all(runner);
+
+    if(!options.json.empty() && !runner.writeJson(options.json)){
+        return 1;
+    }
+
+    if(!options.baseline.empty() && runner.compare(options.baseline) > 0){
+        return 2;
+    }
+
+    if(!ordered){
+        return 3;
+    }
+
+    return 0;
+}
@@ -0,0 +1,597 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "harness.h"
+#include "core/constants.h"
+#include "core/buffer_pool.h"
+#include "core/mpmc_queue.h"
+#include "core/ring_buffer.h"
+#include "core/fixed_ring_buffer.h"
+#include "core/error_handler.h"
+
+#if defined(__SANITIZE_THREAD__)
+#define AJ_BENCH_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define AJ_BENCH_TSAN 1
+#endif
+#endif
+
+/**
+ * @brief Handoff rate and latency of the realtime structures between a producer and a consumer thread.
+ *
+ * - `concurrency/pool_queue`: the recording round trip, buffers from a BufferPool through a
+ *   Queue to the consumer and back to the pool (both are SPSC, one in each direction).
+ * - `concurrency/ring_copy`, `concurrency/ring_two_phase`: chunks of stereo frames through a
+ *   RingBuffer with writeFrames() / readFrames() and with acquire / commit, then through a
+ *   FixedRingBuffer of the same capacity (variant `fixed/...`).
+ * - `concurrency/mpmc_queue`: the same round trip with an MPMCBufferPool and an MPMCQueue shared
+ *   by P producers and C consumers (variant `PxC`), next to the SPSC pair (`spsc`) it replaces.
+ * - `concurrency/false_sharing`: two threads incrementing their own counter, in one cache
+ *   line then in two: the cost of sharing a line on this host, what the `alignas(CACHE_LINE_SIZE)`
+ *   fields of the structures avoid.
+ *
+ * Every handoff carries a sequence number and the time it was published: the consumer checks
+ * the order (`sequence_errors`, must stay 0) and records the latency in a histogram.
+ * Each configuration runs for Options::duration seconds, hours for a soak test.
+ *
+ * Built with `-fsanitize=thread` (AJ_BENCH_TSAN in CMake) the waits yield instead of spinning,
+ * so the instrumented threads still make progress; the latencies are then meaningless but
+ * every access to the structures is checked.
+ */
+class ConcurrencyBenches {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Log-linear latency histogram (16 sub-buckets per power of two, < 6.25% error).
+     */
+    class Histogram {
+        static constexpr size_t kSub = 16;
+        std::array<uint64_t, 64 * kSub> mCounts{};
+        uint64_t mTotal = 0;
+        uint64_t mMax = 0;
+
+        static size_t index(uint64_t ns) {
+            if (ns < kSub) {
+                return static_cast<size_t>(ns);
+            }
+            const size_t exponent = 63 - __builtin_clzll(ns);
+            return (exponent - 3) * kSub + ((ns >> (exponent - 4)) & (kSub - 1));
+        }
+
+        //* lowest value of bucket `i`.
+        static uint64_t value(size_t i) {
+            if (i < kSub) {
+                return i;
+            }
+            const size_t exponent = i / kSub + 3;
+            return (uint64_t(1) << exponent) | (uint64_t(i % kSub) << (exponent - 4));
+        }
+
+    public:
+        void record(uint64_t ns) {
+            ++mCounts[index(ns)];
+            ++mTotal;
+            mMax = std::max(mMax, ns);
+        }
+
+        uint64_t total() const { return mTotal; }
+
+        void merge(const Histogram &other) {
+            for (size_t i = 0; i < mCounts.size(); ++i) {
+                mCounts[i] += other.mCounts[i];
+            }
+            mTotal += other.mTotal;
+            mMax = std::max(mMax, other.mMax);
+        }
+
+        uint64_t max() const { return mMax; }
+
+        uint64_t percentile(double p) const {
+            const uint64_t rank = static_cast<uint64_t>(p * mTotal);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < mCounts.size(); ++i) {
+                seen += mCounts[i];
+                if (seen > rank) {
+                    return value(i);
+                }
+            }
+            return mMax;
+        }
+    };
+
+    //* what the consumer found, read by the calling thread after join().
+    struct Outcome {
+        Histogram latency;
+        uint64_t handoffs = 0;
+        uint64_t sequenceErrors = 0;
+    };
+
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count());
+    }
+
+    //* a wait of a spinning thread: a pause instruction, or a yield under TSan and on a single
+    //* core (where the other thread can't run while this one spins).
+    static void relax() {
+#if defined(AJ_BENCH_TSAN)
+        std::this_thread::yield();
+#elif defined(__x86_64__) || defined(__i386__)
+        static const bool spin = std::thread::hardware_concurrency() > 1;
+        if (spin) {
+            _mm_pause();
+        } else {
+            std::this_thread::yield();
+        }
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    //* pin the calling thread to `core` (-1 = leave it to the scheduler).
+    static void pin(int core) {
+#ifdef __linux__
+        if (core >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+#else
+        (void)core;
+#endif
+    }
+
+    //* the sequence number and timestamp of a handoff in the first 16 bytes of its samples.
+    static void stamp(float *data, uint64_t sequence) {
+        const uint64_t header[2] = { sequence, now_ns() };
+        std::memcpy(data, header, sizeof(header));
+    }
+
+    static void check(const float *data, uint64_t &expected, Outcome &outcome) {
+        uint64_t header[2];
+        std::memcpy(header, data, sizeof(header));
+        const uint64_t ns = now_ns();
+        outcome.latency.record(ns > header[1] ? ns - header[1] : 0);
+        outcome.sequenceErrors += header[0] != expected;
+        expected = header[0] + 1;
+        ++outcome.handoffs;
+    }
+
+    //* read (consumer) or write (producer) every sample, as a writer or a callback would.
+    static float touch_read(const float *data, size_t samples) {
+        float sum = 0.0f;
+        for (size_t i = 4; i < samples; ++i) {
+            sum += data[i];
+        }
+        return sum;
+    }
+
+    static void touch_write(float *data, size_t samples, uint64_t sequence) {
+        std::fill(data + 4, data + samples, static_cast<float>(sequence & 0xff));
+    }
+
+    /**
+     * @brief Run `producer` and `consumer` on their cores for the duration, then join them.
+     * Both get the stop flag, the producer stops first and the consumer drains.
+     */
+    template <typename Producer, typename Consumer>
+    static void run_pair(const AJ::bench::Runner &runner, Producer producer, Consumer consumer) {
+        std::atomic<bool> stop{false}, produced{false};
+
+        std::thread consume([&] {
+            pin(runner.options().consumerCore);
+            consumer(produced);
+        });
+        std::thread produce([&] {
+            pin(runner.options().producerCore);
+            producer(stop);
+            produced.store(true, std::memory_order_release);
+        });
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(runner.options().duration));
+        stop.store(true, std::memory_order_release);
+        produce.join();
+        consume.join();
+    }
+
+    //* one run per configuration: the figures of the consumer belong to that run.
+    static AJ::bench::Measurement timed(const std::string &name, const std::string &variant, size_t channels,
+                                        const std::function<void()> &body) {
+        AJ::bench::Measurement m;
+        m.name = name;
+        m.variant = variant;
+        m.channels = channels;
+        m.repetitions = 1;
+        const Clock::time_point t0 = Clock::now();
+        body();
+        m.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+        return m;
+    }
+
+    static void record(AJ::bench::Runner &runner, AJ::bench::Measurement m, const Outcome &outcome,
+                       size_t frames, size_t bytesPerHandoff, bool &ok) {
+        //? a handoff counts as a repetition, so the key (frames of one handoff) stays the same
+        //? from run to run and --baseline compares the rates.
+        m.counters["handoffs_per_second"] = m.seconds > 0.0 ? outcome.handoffs / m.seconds : 0.0;
+        m.frames = frames;
+        m.bytes = bytesPerHandoff;
+        m.repetitions = outcome.handoffs;
+        m.seconds = outcome.handoffs ? m.seconds / outcome.handoffs : 0.0;
+        m.counters["p50_ns"] = static_cast<double>(outcome.latency.percentile(0.50));
+        m.counters["p99_ns"] = static_cast<double>(outcome.latency.percentile(0.99));
+        m.counters["p999_ns"] = static_cast<double>(outcome.latency.percentile(0.999));
+        m.counters["max_ns"] = static_cast<double>(outcome.latency.max());
+        m.counters["sequence_errors"] = static_cast<double>(outcome.sequenceErrors);
+        ok = ok && outcome.sequenceErrors == 0;
+        runner.record(m);
+    }
+
+    static void pool_queue(AJ::bench::Runner &runner, size_t buffers, size_t frames, bool &ok) {
+        AJ::error::CollectingErrorHandler handler;
+        Outcome outcome;
+
+        auto body = [&] {
+            outcome = Outcome();
+            AJ::utils::BufferPool pool(handler, buffers, frames, 2);
+            AJ::utils::Queue queue(true, buffers, frames, 2, handler);
+            const size_t samples = 2 * frames;
+
+            run_pair(runner,
+                [&](std::atomic<bool> &stop) {
+                    uint64_t sequence = 0;
+                    while (!stop.load(std::memory_order_acquire)) {
+                        AJ::utils::Buffer *buffer = pool.tryPop();
+                        if (!buffer) {
+                            relax();
+                            continue;
+                        }
+                        touch_write(buffer->data, samples, sequence);
+                        buffer->frames = frames;
+                        stamp(buffer->data, sequence++);
+                        while (!queue.push(buffer)) {
+                            relax();
+                        }
+                    }
+                },
+                [&](std::atomic<bool> &produced) {
+                    uint64_t expected = 0;
+                    volatile float sink = 0.0f;
+                    while (true) {
+                        //? the flag is read first: once set, an empty pop means nothing is left.
+                        const bool done = produced.load(std::memory_order_acquire);
+                        AJ::utils::Buffer *buffer = queue.pop();
+                        if (!buffer) {
+                            if (done) {
+                                break;
+                            }
+                            relax();
+                            continue;
+                        }
+                        check(buffer->data, expected, outcome);
+                        sink = sink + touch_read(buffer->data, samples);
+                        pool.push(buffer, handler);
+                    }
+                });
+        };
+
+        const std::string variant = std::to_string(buffers) + "x" + std::to_string(frames);
+        AJ::bench::Measurement m = timed("concurrency/pool_queue", variant, 2, body);
+        record(runner, m, outcome, frames, 2 * frames * sizeof(float), ok);
+    }
+
+    /**
+     * @brief `producers` threads take buffers from `pool` and queue them, `consumers` threads pop
+     * them and give them back. A handoff carries its producer in the top 16 bits of its sequence:
+     * what one consumer sees of a producer must still be in order.
+     */
+    template <typename Pool, typename Ring>
+    static void fan(AJ::bench::Runner &runner, const std::string &variant, size_t producers, size_t consumers,
+                    size_t buffers, size_t frames, bool &ok) {
+        AJ::error::CollectingErrorHandler handler;
+        Outcome outcome;
+
+        auto body = [&] {
+            outcome = Outcome();
+            Pool pool(handler, buffers, frames, 2);
+            Ring queue(true, buffers, frames, 2, handler);
+            const size_t samples = 2 * frames;
+
+            std::atomic<bool> stop{false};
+            std::atomic<size_t> running{producers};
+            std::vector<Outcome> seen(consumers);
+            std::vector<std::thread> threads;
+
+            for (size_t p = 0; p < producers; ++p) {
+                threads.emplace_back([&, p] {
+                    if (producers == 1) pin(runner.options().producerCore);
+                    uint64_t sequence = uint64_t(p) << 48;
+                    while (!stop.load(std::memory_order_acquire)) {
+                        AJ::utils::Buffer *buffer = pool.tryPop();
+                        if (!buffer) {
+                            relax();
+                            continue;
+                        }
+                        touch_write(buffer->data, samples, sequence);
+                        buffer->frames = frames;
+                        stamp(buffer->data, sequence++);
+                        while (!queue.push(buffer)) {
+                            relax();
+                        }
+                    }
+                    running.fetch_sub(1, std::memory_order_release);
+                });
+            }
+
+            for (size_t c = 0; c < consumers; ++c) {
+                threads.emplace_back([&, c] {
+                    if (consumers == 1) pin(runner.options().consumerCore);
+                    std::vector<uint64_t> next(producers, 0);
+                    Outcome &mine = seen[c];
+                    volatile float sink = 0.0f;
+                    while (true) {
+                        const bool done = running.load(std::memory_order_acquire) == 0;
+                        AJ::utils::Buffer *buffer = queue.pop();
+                        if (!buffer) {
+                            if (done) {
+                                break;
+                            }
+                            relax();
+                            continue;
+                        }
+
+                        uint64_t header[2];
+                        std::memcpy(header, buffer->data, sizeof(header));
+                        const size_t producer = static_cast<size_t>(header[0] >> 48);
+                        const uint64_t sequence = header[0] & ((uint64_t(1) << 48) - 1);
+                        const uint64_t ns = now_ns();
+                        mine.latency.record(ns > header[1] ? ns - header[1] : 0);
+                        mine.sequenceErrors += producer >= producers || sequence < next[producer];
+                        if (producer < producers) next[producer] = sequence + 1;
+                        ++mine.handoffs;
+
+                        sink = sink + touch_read(buffer->data, samples);
+                        pool.push(buffer, handler);
+                    }
+                });
+            }
+
+            std::this_thread::sleep_for(std::chrono::duration<double>(runner.options().duration));
+            stop.store(true, std::memory_order_release);
+            for (std::thread &thread : threads) thread.join();
+
+            for (const Outcome &consumer : seen) {
+                outcome.latency.merge(consumer.latency);
+                outcome.handoffs += consumer.handoffs;
+                outcome.sequenceErrors += consumer.sequenceErrors;
+            }
+        };
+
+        AJ::bench::Measurement m = timed("concurrency/mpmc_queue", variant, 2, body);
+        record(runner, m, outcome, frames, 2 * frames * sizeof(float), ok);
+    }
+
+    static std::unique_ptr<AJ::utils::RingBuffer> make_ring(AJ::utils::RingBuffer *, size_t capacity,
+                                                            AJ::error::IErrorHandler &handler) {
+        return std::make_unique<AJ::utils::RingBuffer>(capacity, 2, handler);
+    }
+
+    template <size_t Frames>
+    static std::unique_ptr<AJ::utils::FixedRingBuffer<2, Frames>> make_ring(AJ::utils::FixedRingBuffer<2, Frames> *, size_t,
+                                                                            AJ::error::IErrorHandler &handler) {
+        return std::make_unique<AJ::utils::FixedRingBuffer<2, Frames>>(handler);
+    }
+
+    //* `Ring` is a RingBuffer, or a FixedRingBuffer of `capacity` stereo frames (variant `fixed/...`).
+    template <typename Ring>
+    static void ring(AJ::bench::Runner &runner, size_t capacity, size_t chunk, bool twoPhase, bool &ok) {
+        AJ::error::CollectingErrorHandler handler;
+        Outcome outcome;
+
+        //* frame `f` of a region (stereo frames).
+        auto frame = [](const AJ::utils::RingRegion &region, size_t f) {
+            return f < region.first.frames ? region.first.data + 2 * f
+                                           : region.second.data + 2 * (f - region.first.frames);
+        };
+
+        auto body = [&] {
+            outcome = Outcome();
+            std::unique_ptr<Ring> owned = make_ring(static_cast<Ring *>(nullptr), capacity, handler);
+            Ring &rb = *owned;
+
+            run_pair(runner,
+                [&](std::atomic<bool> &stop) {
+                    std::vector<float> local(2 * chunk);
+                    uint64_t sequence = 0;
+                    while (!stop.load(std::memory_order_acquire)) {
+                        if (twoPhase) {
+                            const AJ::utils::RingRegion region = rb.acquireWrite(chunk);
+                            if (region.frames() < chunk) {
+                                relax();
+                                continue;
+                            }
+                            for (size_t f = 2; f < chunk; ++f) {
+                                float *out = frame(region, f);
+                                out[0] = out[1] = static_cast<float>(f);
+                            }
+                            //? the 16-byte header is two stereo frames, possibly on both spans.
+                            const uint64_t header[2] = { sequence++, now_ns() };
+                            std::memcpy(frame(region, 0), &header[0], 8);
+                            std::memcpy(frame(region, 1), &header[1], 8);
+                            rb.commitWrite(chunk);
+                        } else {
+                            touch_write(local.data(), local.size(), sequence);
+                            stamp(local.data(), sequence++);
+                            //* a chunk is always finished, a partial one would break the framing of the consumer.
+                            size_t written = 0;
+                            while (written < chunk) {
+                                const size_t n = rb.writeFrames(local.data() + 2 * written, chunk - written);
+                                written += n;
+                                if (n == 0) {
+                                    relax();
+                                }
+                            }
+                        }
+                    }
+                },
+                [&](std::atomic<bool> &produced) {
+                    std::vector<float> local(2 * chunk);
+                    uint64_t expected = 0;
+                    volatile float sink = 0.0f;
+                    while (true) {
+                        const bool done = produced.load(std::memory_order_acquire);
+                        if (twoPhase) {
+                            const AJ::utils::RingRegion region = rb.acquireRead(chunk);
+                            if (region.frames() < chunk) {
+                                if (done) {
+                                    break;
+                                }
+                                relax();
+                                continue;
+                            }
+                            float header[4];
+                            std::memcpy(header, frame(region, 0), 8);
+                            std::memcpy(header + 2, frame(region, 1), 8);
+                            check(header, expected, outcome);
+                            float sum = 0.0f;
+                            for (size_t f = 2; f < chunk; ++f) {
+                                sum += frame(region, f)[0];
+                            }
+                            sink = sink + sum;
+                            rb.commitRead(chunk);
+                        } else {
+                            size_t read = 0;
+                            while (read < chunk) {
+                                const size_t n = rb.readFrames(local.data() + 2 * read, chunk - read);
+                                read += n;
+                                if (n == 0) {
+                                    if (read == 0 && done) {
+                                        break;
+                                    }
+                                    relax();
+                                }
+                            }
+                            if (read < chunk) {
+                                break;
+                            }
+                            check(local.data(), expected, outcome);
+                            sink = sink + touch_read(local.data(), local.size());
+                        }
+                    }
+                });
+        };
+
+        const std::string name = twoPhase ? "concurrency/ring_two_phase" : "concurrency/ring_copy";
+        const std::string variant = std::string(std::is_same_v<Ring, AJ::utils::RingBuffer> ? "" : "fixed/")
+                                  + std::to_string(capacity) + "/" + std::to_string(chunk);
+        AJ::bench::Measurement m = timed(name, variant, 2, body);
+        record(runner, m, outcome, chunk, 2 * chunk * sizeof(float), ok);
+    }
+
+    struct alignas(AJ::CACHE_LINE_SIZE) Packed {
+        std::atomic<uint64_t> a{0};
+        std::atomic<uint64_t> b{0};
+    };
+
+    struct Padded {
+        alignas(AJ::CACHE_LINE_SIZE) std::atomic<uint64_t> a{0};
+        alignas(AJ::CACHE_LINE_SIZE) std::atomic<uint64_t> b{0};
+    };
+
+    template <typename Counters>
+    static void false_sharing(AJ::bench::Runner &runner, const std::string &variant) {
+        Counters counters;
+        auto body = [&] {
+            counters.a.store(0, std::memory_order_relaxed);
+            counters.b.store(0, std::memory_order_relaxed);
+            run_pair(runner,
+                [&](std::atomic<bool> &stop) {
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        counters.a.fetch_add(1, std::memory_order_relaxed);
+                    }
+                },
+                [&](std::atomic<bool> &produced) {
+                    while (!produced.load(std::memory_order_relaxed)) {
+                        counters.b.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+        };
+
+        AJ::bench::Measurement m = timed("concurrency/false_sharing", variant, 1, body);
+        const uint64_t ops = counters.a.load() + counters.b.load();
+        m.counters["ops_per_second"] = m.seconds > 0.0 ? ops / m.seconds : 0.0;
+        m.frames = 1;
+        m.bytes = sizeof(uint64_t);
+        m.repetitions = ops;
+        m.seconds = ops ? m.seconds / ops : 0.0;
+        runner.record(m);
+    }
+
+public:
+    /// @return false if a handoff arrived out of order.
+    static bool run_all(AJ::bench::Runner &runner) {
+        std::cout << "\nConcurrency (" << runner.options().duration << " s per run, producer core "
+                  << runner.options().producerCore << ", consumer core " << runner.options().consumerCore << ")\n";
+        std::cout << "---------------------------------------------\n";
+
+        bool ok = true;
+
+        if (runner.enabled("concurrency/pool_queue")) {
+            for (size_t buffers : { 4, 64, 1024 }) {
+                for (size_t frames : { 64, 256, 4096 }) {
+                    pool_queue(runner, buffers, frames, ok);
+                }
+            }
+        }
+
+        if (runner.enabled("concurrency/mpmc_queue")) {
+            fan<AJ::utils::BufferPool, AJ::utils::Queue>(runner, "spsc", 1, 1, 64, 256, ok);
+
+            const size_t threads[][2] = { { 1, 1 }, { 2, 1 }, { 1, 2 }, { 2, 2 }, { 4, 4 } };
+            for (const auto &pc : threads) {
+                const std::string variant = std::to_string(pc[0]) + "x" + std::to_string(pc[1]);
+                fan<AJ::utils::MPMCBufferPool, AJ::utils::MPMCQueue>(runner, variant, pc[0], pc[1], 64, 256, ok);
+            }
+        }
+
+        for (bool twoPhase : { false, true }) {
+            if (!runner.enabled(twoPhase ? "concurrency/ring_two_phase" : "concurrency/ring_copy")) {
+                continue;
+            }
+            for (size_t capacity : { 1024, 16384 }) {
+                for (size_t chunk : { 16, 256 }) {
+                    ring<AJ::utils::RingBuffer>(runner, capacity, chunk, twoPhase, ok);
+                }
+            }
+            for (size_t chunk : { 16, 256 }) {
+                ring<AJ::utils::FixedRingBuffer<2, 1024>>(runner, 1024, chunk, twoPhase, ok);
+                ring<AJ::utils::FixedRingBuffer<2, 16384>>(runner, 16384, chunk, twoPhase, ok);
+            }
+        }
+
+        if (runner.enabled("concurrency/false_sharing")) {
+            false_sharing<Packed>(runner, "packed");
+            false_sharing<Padded>(runner, "padded");
+        }
+
+        if (!ok) {
+            std::cout << "  handoffs arrived out of order (sequence_errors)\n";
+        }
+        return ok;
+    }
+};
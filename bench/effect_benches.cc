@@ -0,0 +1,126 @@
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "core/types.h"
+#include "core/error_handler.h"
+#include "dsp/gain.h"
+#include "dsp/fade.h"
+#include "dsp/echo.h"
+#include "dsp/distortion.h"
+#include "dsp/normalization.h"
+#include "dsp/reverb/reverb.h"
+
+/**
+ * @brief Whole effects on a stereo file in memory, as applyEffect() runs them.
+ *
+ * Effects use the kernel table of the process: run the bench once per `AJ_SIMD` value to
+ * compare ISAs end to end (the variant of the results is the ISA they ran with).
+ */
+class EffectBenches {
+    using MakeParams = std::function<std::shared_ptr<AJ::dsp::EffectParams>(size_t frames, AJ::error::IErrorHandler&)>;
+
+    //* parameters are made again before every repetition, an effect may cache what it measured.
+    static void bench(AJ::bench::Runner &runner, const std::string &name, AJ::dsp::Effect &effect,
+                      const MakeParams &make, AJ::AudioBuffer &audio, size_t frames) {
+        const std::string full = "effect/" + name;
+        if (!runner.enabled(full)) {
+            return;
+        }
+
+        AJ::error::CollectingErrorHandler handler;
+        auto setup = [&] {
+            for (size_t ch = 0; ch < 2; ++ch) {
+                audio[ch].resize(frames);
+                AJ::bench::fill(audio[ch].data(), frames);
+            }
+            std::shared_ptr<AJ::dsp::EffectParams> params = make(frames, handler);
+            if (params) {
+                effect.setParams(params, handler);
+            }
+        };
+
+        //? some effects need a minimum length (e.g. the reverb delay): those sizes are skipped.
+        setup();
+        if (!handler.errors().empty() || !effect.process(audio, 2, handler)) {
+            std::cout << "  " << full << ": skipped at " << frames << " frames\n";
+            return;
+        }
+
+        const std::string isa = AJ::dsp::kernels::name(AJ::dsp::kernels::table().isa);
+        runner.measure(full, isa, frames, 2, setup, [&] { effect.process(audio, 2, handler); });
+    }
+
+public:
+    static void run_all(AJ::bench::Runner &runner) {
+        std::cout << "\nEffects (" << AJ::dsp::kernels::name(AJ::dsp::kernels::table().isa) << ")\n";
+        std::cout << "---------------------------------------------\n";
+
+        const int samplerate = 48000;
+        AJ::AudioBuffer audio;
+
+        AJ::dsp::gain::Gain gain;
+        AJ::dsp::fade::Fade fade;
+        AJ::dsp::echo::Echo echo;
+        AJ::dsp::reverb::Reverb reverb;
+        AJ::dsp::distortion::Distortion distortion;
+        AJ::dsp::normalization::Normalization normalization;
+
+        for (size_t frames : runner.sweep()) {
+            const AJ::sample_pos end = static_cast<AJ::sample_pos>(frames) - 1;
+
+            bench(runner, "gain", gain, [&](size_t, AJ::error::IErrorHandler &h) {
+                AJ::dsp::gain::Params p{ 0, end, 0.8f };
+                return AJ::dsp::gain::GainParams::create(p, h);
+            }, audio, frames);
+
+            bench(runner, "fade", fade, [&](size_t, AJ::error::IErrorHandler &h) {
+                AJ::dsp::fade::Params p{ 0, end, 1.0f, 0.0f, AJ::dsp::fade::FadeMode::Out };
+                return AJ::dsp::fade::FadeParams::create(p, h);
+            }, audio, frames);
+
+            //* a 250 ms echo, shorter on the buffers that can't hold it.
+            bench(runner, "echo", echo, [&](size_t n, AJ::error::IErrorHandler &h) {
+                const float delay = std::min(0.25f, static_cast<float>(n / 4) / samplerate);
+                AJ::dsp::echo::Params p{ 0, end, 0.5f, delay, samplerate };
+                return AJ::dsp::echo::EchoParams::create(p, h);
+            }, audio, frames);
+
+            bench(runner, "reverb", reverb, [&](size_t n, AJ::error::IErrorHandler &h) {
+                AJ::dsp::reverb::Params p{ 40.0f, 0.3f, 0.7f, samplerate, 0.45f, 0, n - 1 };
+                return AJ::dsp::reverb::ReverbParams::create(p, h);
+            }, audio, frames);
+
+            const std::pair<const char*, AJ::dsp::distortion::DistortionType> types[] = {
+                { "distortion_soft", AJ::dsp::distortion::SoftClipping },
+                { "distortion_hard", AJ::dsp::distortion::HardClipping },
+                { "distortion_cubic", AJ::dsp::distortion::Cubic }
+            };
+            for (const auto &[name, type] : types) {
+                bench(runner, name, distortion, [&, type = type](size_t n, AJ::error::IErrorHandler &h) {
+                    AJ::dsp::distortion::Params p;
+                    p.mStart = 0;
+                    p.mEnd = n - 1;
+                    p.mGain = 2.0f;
+                    p.mType = type;
+                    return AJ::dsp::distortion::DistortionParams::create(p, h);
+                }, audio, frames);
+            }
+
+            for (AJ::dsp::normalization::NormalizationMode mode : { AJ::dsp::normalization::Peak, AJ::dsp::normalization::LUFS }) {
+                const std::string name = mode == AJ::dsp::normalization::Peak ? "normalization_peak" : "normalization_lufs";
+                bench(runner, name, normalization, [&, mode](size_t, AJ::error::IErrorHandler &h) {
+                    AJ::dsp::normalization::Params p;
+                    p.mStart = 0;
+                    p.mEnd = end;
+                    p.mMode = mode;
+                    p.mTarget = mode == AJ::dsp::normalization::Peak ? 0.9f : -16.0f;
+                    p.mSamplerate = samplerate;
+                    return AJ::dsp::normalization::NormalizationParams::create(p, h);
+                }, audio, frames);
+            }
+        }
+    }
+};
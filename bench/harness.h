@@ -0,0 +1,340 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define AJ_BENCH_TSC 1
+#endif
+
+#include "dsp/kernels.h"
+
+namespace AJ::bench {
+
+/**
+ * @brief Buffer sizes swept by every benchmark, in frames per channel (stereo).
+ *
+ * From a buffer that stays in L1 to one hour of 48 kHz audio, which only fits in RAM.
+ */
+inline const std::vector<size_t> kSweepFrames = {
+    512,                 //   4 KiB stereo: L1
+    8192,                //  64 KiB: L2
+    131072,              //   1 MiB: L2 / L3
+    2097152,             //  16 MiB: L3 / RAM
+    3600ull * 48000ull   // 1.3 GiB: one hour, RAM
+};
+
+/**
+ * @brief Command line options of the bench executable.
+ */
+struct Options {
+    std::string filter;        ///< only the benchmarks whose name contains it.
+    std::string json;          ///< results written there if not empty.
+    std::string baseline;      ///< results of an earlier run to compare with, if not empty.
+    double tolerance = 0.10;   ///< slowdown (fraction) reported as a regression against the baseline.
+    double minTime = 0.25;     ///< seconds each measurement repeats for (at least one repetition).
+    size_t maxFrames = kSweepFrames.back(); ///< the sweep stops above this size.
+    std::string directory;     ///< where the I/O benchmarks write their files, empty = the temp directory.
+    double streamSeconds = 3.0; ///< wall time of each FileStreamer run.
+    size_t streamPool = 256;   ///< buffers of the pool (and queue) of the FileStreamer runs.
+    double duration = 0.5;     ///< wall time of each concurrency run.
+    int producerCore = -1;     ///< core the producer thread of the concurrency runs is pinned to, -1 = any.
+    int consumerCore = -1;     ///< core of the consumer thread, -1 = any.
+};
+
+/**
+ * @brief One benchmark at one buffer size.
+ */
+struct Measurement {
+    std::string name;     ///< e.g. "kernel/gain" or "effect/reverb".
+    std::string variant;  ///< ISA of the kernel table, or the one the effects ran with.
+    size_t frames = 0;    ///< frames per channel.
+    size_t channels = 2;
+    size_t repetitions = 0;
+    double seconds = 0.0; ///< fastest repetition.
+    double cycles = 0.0;  ///< TSC cycles of the fastest repetition, 0 if unavailable.
+
+    /// @brief Bytes a repetition moves: the audio as 32-bit samples, or the file of an I/O benchmark.
+    size_t bytes = 0;
+
+    /// @brief Highest resident memory above the start of a repetition, 0 if not measured.
+    size_t peakRss = 0;
+
+    /// @brief Figures of the benchmark itself (e.g. dropped blocks), written as they are.
+    std::map<std::string, double> counters;
+
+    size_t samples() const { return frames * channels; }
+
+    double samplesPerSecond() const { return seconds > 0.0 ? samples() / seconds : 0.0; }
+
+    double megabytesPerSecond() const { return seconds > 0.0 ? bytes / seconds / 1e6 : 0.0; }
+
+    double bytesPerCycle() const { return cycles > 0.0 ? bytes / cycles : 0.0; }
+
+    std::string key() const { return name + "|" + variant + "|" + std::to_string(frames); }
+};
+
+/**
+ * @class Runner
+ * @brief Times benchmarks, prints them and writes them as JSON.
+ *
+ * A measurement repeats `setup` (untimed, e.g. refill the buffer so a fade doesn't
+ * decay it to denormals) then `body` (timed) for at least Options::minTime seconds and keeps
+ * the fastest repetition, the most stable figure to compare two builds with.
+ */
+class Runner {
+    Options mOptions;
+    std::vector<Measurement> mResults;
+
+    static uint64_t cycles() {
+#ifdef AJ_BENCH_TSC
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    //* `VmRSS` / `VmHWM` of /proc/self/status in bytes, 0 if unavailable.
+    static size_t procStatus(const std::string &key) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, key.size() + 1, key + ":") == 0) {
+                return std::strtoull(line.c_str() + key.size() + 1, nullptr, 10) * 1024;
+            }
+        }
+        return 0;
+    }
+
+    //? Linux resets the high-water mark (VmHWM) to the current RSS on a write of 5 to clear_refs.
+    static bool resetPeakRss() {
+        std::ofstream refs("/proc/self/clear_refs");
+        return static_cast<bool>(refs << "5" << std::flush);
+    }
+
+    static size_t peakRss() {
+        if (const size_t hwm = procStatus("VmHWM")) {
+            return hwm;
+        }
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;
+    }
+
+public:
+    explicit Runner(const Options &options) : mOptions(options) {}
+
+    const Options& options() const { return mOptions; }
+
+    const std::vector<Measurement>& results() const { return mResults; }
+
+    /// @brief Whether `name` passes the filter.
+    bool enabled(const std::string &name) const {
+        return mOptions.filter.empty() || name.find(mOptions.filter) != std::string::npos;
+    }
+
+    /// @brief The sizes of the sweep up to Options::maxFrames.
+    std::vector<size_t> sweep() const {
+        std::vector<size_t> frames;
+        for (size_t f : kSweepFrames) {
+            if (f <= mOptions.maxFrames) {
+                frames.push_back(f);
+            }
+        }
+        return frames;
+    }
+
+    /**
+     * @brief Time `body` (see the class), without recording the result.
+     *
+     * @param memory also measure the peak RSS of the repetitions (costs a few /proc accesses each,
+     *               only for benchmarks much longer than that).
+     */
+    Measurement time(const std::string &name, const std::string &variant, size_t frames, size_t channels,
+                     const std::function<void()> &setup, const std::function<void()> &body, bool memory = false) {
+        using Clock = std::chrono::steady_clock;
+
+        Measurement m;
+        m.name = name;
+        m.variant = variant;
+        m.frames = frames;
+        m.channels = channels;
+        m.bytes = frames * channels * sizeof(float);
+        m.seconds = INFINITY;
+
+        double total = 0.0;
+        while (m.repetitions == 0 || total < mOptions.minTime) {
+            setup();
+
+            size_t before = 0;
+            if (memory) {
+                resetPeakRss();
+                before = procStatus("VmRSS");
+            }
+
+            const uint64_t c0 = cycles();
+            const Clock::time_point t0 = Clock::now();
+            body();
+            const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+            const uint64_t c1 = cycles();
+
+            if (seconds < m.seconds) {
+                m.seconds = seconds;
+                m.cycles = static_cast<double>(c1 - c0);
+            }
+            if (memory) {
+                const size_t peak = peakRss();
+                m.peakRss = std::max(m.peakRss, peak > before ? peak - before : 0);
+            }
+            total += seconds;
+            ++m.repetitions;
+        }
+        return m;
+    }
+
+    /// @brief Print and keep a measurement (of time(), possibly completed by the benchmark).
+    void record(const Measurement &m) {
+        std::cout << "  " << std::left << std::setw(32) << m.name << std::setw(8) << m.variant << std::right
+                  << std::setw(11) << m.frames << " frames " << std::fixed << std::setprecision(1)
+                  << std::setw(9) << m.samplesPerSecond() / 1e6 << " Msamples/s " << std::setw(9)
+                  << m.megabytesPerSecond() << " MB/s " << std::setprecision(2) << std::setw(7)
+                  << m.bytesPerCycle() << " B/cycle";
+        if (m.peakRss) {
+            std::cout << std::setprecision(1) << "  peak " << m.peakRss / 1048576.0 << " MiB";
+        }
+        for (const auto &[key, value] : m.counters) {
+            std::cout << std::setprecision(0) << "  " << key << " " << value;
+        }
+        std::cout << "  (" << m.repetitions << " reps)\n";
+        mResults.push_back(m);
+    }
+
+    void measure(const std::string &name, const std::string &variant, size_t frames, size_t channels,
+                 const std::function<void()> &setup, const std::function<void()> &body) {
+        record(time(name, variant, frames, channels, setup, body));
+    }
+
+    /// @brief Write the results, one benchmark per line (compare() reads them back line by line).
+    bool writeJson(const std::string &path) const {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "can't write " << path << "\n";
+            return false;
+        }
+
+        out << "{\n  \"context\": {\"isa\": \"" << dsp::kernels::name(dsp::kernels::table().isa)
+            << "\", \"detected\": \"" << dsp::kernels::name(dsp::kernels::detect())
+            << "\", \"tsc\": " << (cycles() ? "true" : "false") << "},\n  \"benchmarks\": [\n";
+
+        out << std::setprecision(9);
+        for (size_t i = 0; i < mResults.size(); ++i) {
+            const Measurement &m = mResults[i];
+            out << "    {\"name\": \"" << m.name << "\", \"variant\": \"" << m.variant
+                << "\", \"frames\": " << m.frames << ", \"channels\": " << m.channels
+                << ", \"repetitions\": " << m.repetitions << ", \"seconds\": " << m.seconds
+                << ", \"cycles\": " << m.cycles << ", \"bytes\": " << m.bytes
+                << ", \"samples_per_second\": " << m.samplesPerSecond()
+                << ", \"megabytes_per_second\": " << m.megabytesPerSecond()
+                << ", \"bytes_per_cycle\": " << m.bytesPerCycle();
+            if (m.peakRss) {
+                out << ", \"peak_rss\": " << m.peakRss;
+            }
+            for (const auto &[key, value] : m.counters) {
+                out << ", \"" << key << "\": " << value;
+            }
+            out << "}"
+                << (i + 1 < mResults.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+        return true;
+    }
+
+    /**
+     * @brief Compare with the JSON of an earlier run.
+     * @return the number of benchmarks (found in both) slower than the baseline by more than Options::tolerance.
+     */
+    size_t compare(const std::string &path) const {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "can't read the baseline " << path << "\n";
+            return 1;
+        }
+
+        //* `"key": value` of one line of writeJson().
+        auto field = [](const std::string &line, const std::string &key) {
+            const size_t at = line.find("\"" + key + "\": ");
+            if (at == std::string::npos) {
+                return std::string();
+            }
+            size_t begin = at + key.size() + 4;
+            if (line[begin] == '"') {
+                ++begin;
+                return line.substr(begin, line.find('"', begin) - begin);
+            }
+            return line.substr(begin, line.find_first_of(",}", begin) - begin);
+        };
+
+        std::map<std::string, double> baseline;
+        std::string line;
+        while (std::getline(in, line)) {
+            const std::string name = field(line, "name");
+            if (!name.empty()) {
+                const std::string key = name + "|" + field(line, "variant") + "|" + field(line, "frames");
+                baseline[key] = std::atof(field(line, "samples_per_second").c_str());
+            }
+        }
+
+        size_t regressions = 0, compared = 0;
+        std::cout << "\nAgainst " << path << " (tolerance " << 100.0 * mOptions.tolerance << "%)\n";
+        for (const Measurement &m : mResults) {
+            const auto found = baseline.find(m.key());
+            if (found == baseline.end() || found->second <= 0.0) {
+                continue;
+            }
+
+            ++compared;
+            const double ratio = m.samplesPerSecond() / found->second;
+            if (ratio < 1.0 - mOptions.tolerance) {
+                ++regressions;
+                std::cout << "  SLOWER " << m.name << " " << m.variant << " " << m.frames << " frames: "
+                          << std::fixed << std::setprecision(1) << 100.0 * (1.0 - ratio) << "% slower\n";
+            }
+        }
+        std::cout << "  " << regressions << " of " << compared << " benchmarks slower\n";
+        return regressions;
+    }
+};
+
+/**
+ * @brief Fill `data` with a deterministic signal: sines and noise around ±0.5, no denormals.
+ */
+inline void fill(float *data, size_t count) {
+    static const std::vector<float> pattern = [] {
+        std::vector<float> p(4096);
+        uint32_t state = 0x9e3779b9u;
+        for (size_t i = 0; i < p.size(); ++i) {
+            state = state * 1664525u + 1013904223u;
+            const float noise = static_cast<float>(state >> 8) / 16777216.0f - 0.5f;
+            p[i] = 0.4f * std::sin(0.031f * i) + 0.2f * std::sin(0.0021f * i) + 0.1f * noise;
+        }
+        return p;
+    }();
+
+    for (size_t i = 0; i < count; i += pattern.size()) {
+        std::copy_n(pattern.begin(), std::min(pattern.size(), count - i), data + i);
+    }
+}
+
+} // namespace AJ::bench
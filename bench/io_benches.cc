@@ -0,0 +1,311 @@
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "harness.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/buffer_pool.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+#include "file_io/wav_file.h"
+#include "file_io/mp3_file.h"
+#include "file_io/file_streamer.h"
+
+/**
+ * @brief Load and save of whole files, and sustained recording through FileStreamer.
+ *
+ * Files go to Options::directory (`--dir`), the disk a host records to is the one to measure.
+ * Loads start from a cold page cache (the file is flushed and evicted before every
+ * repetition), saves end when write() returns, i.e. once the data is in the page cache.
+ */
+class IOBenches {
+    using FileStreamer = AJ::io::file_streamer::FileStreamer;
+    using WriteOptions = AJ::io::file_streamer::WriteOptions;
+    using StreamCounters = AJ::io::file_streamer::StreamCounters;
+    using StreamStats = AJ::io::file_streamer::StreamStats;
+
+    static constexpr int kSamplerate = 48000;
+
+    //* 1 s to 1 h of 48 kHz stereo.
+    static std::vector<size_t> durations(const AJ::bench::Runner &runner) {
+        std::vector<size_t> frames;
+        for (size_t seconds : { 1, 10, 60, 600, 3600 }) {
+            if (seconds * kSamplerate <= runner.options().maxFrames) {
+                frames.push_back(seconds * kSamplerate);
+            }
+        }
+        return frames;
+    }
+
+    static std::filesystem::path directory(const AJ::bench::Runner &runner) {
+        const std::filesystem::path dir = runner.options().directory.empty()
+            ? std::filesystem::temp_directory_path() / "aj_bench_io"
+            : std::filesystem::path(runner.options().directory);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    //* write back and drop the pages of `path` so the next read comes from the disk.
+    static void evict(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            ::fdatasync(fd);
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+    }
+
+    static std::string depth_name(AJ::BitDepth_t bitdepth) {
+        switch (bitdepth) {
+        case AJ::BitDepth_t::int_16: return "int16";
+        case AJ::BitDepth_t::int_24: return "int24";
+        default: return "float32";
+        }
+    }
+
+    template <typename File>
+    static std::shared_ptr<File> make_file(size_t frames) {
+        auto file = std::make_shared<File>();
+        file->mInfo.channels = 2;
+        file->mInfo.samplerate = kSamplerate;
+        file->mInfo.length = 2 * frames;
+        for (size_t ch = 0; ch < 2; ++ch) {
+            (*file->pAudio)[ch].resize(frames);
+            AJ::bench::fill((*file->pAudio)[ch].data(), frames);
+        }
+        return file;
+    }
+
+    /**
+     * @brief Save `file` as `dir/name + format`, then load it back, both timed.
+     */
+    template <typename File>
+    static void save_and_load(AJ::bench::Runner &runner, const std::string &kind, const std::string &variant,
+                              std::shared_ptr<File> file, AJ::BitDepth_t bitdepth, const std::string &format,
+                              const std::filesystem::path &dir, size_t frames) {
+        AJ::error::CollectingErrorHandler handler;
+
+        //? WAV_File writes `name`, MP3_File `name + format`.
+        const std::string name = format == ".wav" ? "aj_bench.wav" : "aj_bench";
+        const std::string path = (dir / ("aj_bench" + format)).string();
+
+        AJ::AudioWriteInfo info;
+        info.length = 2 * frames;
+        info.samplerate = kSamplerate;
+        info.channels = 2;
+        info.bitdepth = bitdepth;
+        info.format = format;
+        info.seekable = true;
+        info.path = dir.string();
+        info.name = name;
+
+        if (runner.enabled("io/" + kind + "_save")) {
+            AJ::bench::Measurement m = runner.time("io/" + kind + "_save", variant, frames, 2,
+                [&] { std::filesystem::remove(path); file->setWriteInfo(info, handler); },
+                [&] { file->write(handler); }, true);
+            m.bytes = std::filesystem::exists(path) ? std::filesystem::file_size(path) : 0;
+
+            if (!handler.errors().empty() || m.bytes == 0) {
+                std::cout << "  io/" << kind << "_save " << variant << ": failed at " << frames << " frames\n";
+                return;
+            }
+            runner.record(m);
+        } else {
+            file->setWriteInfo(info, handler);
+            file->write(handler);
+        }
+
+        if (runner.enabled("io/" + kind + "_load") && std::filesystem::exists(path)) {
+            std::shared_ptr<File> loaded;
+            AJ::bench::Measurement m = runner.time("io/" + kind + "_load", variant, frames, 2,
+                [&] {
+                    loaded.reset();
+                    evict(path);
+                    loaded = std::make_shared<File>();
+                    std::string file_path = path;
+                    loaded->setFilePath(file_path);
+                },
+                [&] { loaded->read(handler); }, true);
+            m.bytes = std::filesystem::file_size(path);
+
+            if (!handler.errors().empty()) {
+                std::cout << "  io/" << kind << "_load " << variant << ": failed at " << frames << " frames\n";
+            } else {
+                runner.record(m);
+            }
+        }
+
+        std::filesystem::remove(path);
+    }
+
+    /**
+     * @brief Record `seconds` of wall time through a FileStreamer fed at `speed` × real time
+     * (0 = as fast as the writer takes it).
+     *
+     * The producer behaves like the record callback with the drop newest policy: a block
+     * that finds the pool empty or the queue full is dropped. Unpaced, it waits for the
+     * writer to give buffers back instead, so the run measures the sustained ceiling.
+     */
+    static void stream(AJ::bench::Runner &runner, const std::string &mode, const WriteOptions &options,
+                       size_t speed, double seconds, size_t poolBlocks, const std::filesystem::path &dir) {
+        using Clock = std::chrono::steady_clock;
+
+        const std::string name = "stream/" + mode;
+        const std::string variant = speed ? "x" + std::to_string(speed) : "max";
+        const size_t block = static_cast<size_t>(kSamplerate * AJ::BUFFER_SECONDS);
+        const std::filesystem::path session = dir / "aj_bench_stream";
+
+        AJ::error::CollectingErrorHandler handler;
+        StreamStats stats;
+        size_t produced = 0;
+
+        auto setup = [&] {
+            std::filesystem::remove_all(session);
+            std::filesystem::create_directories(session);
+        };
+        auto body = [&] {
+            auto pool = std::make_shared<AJ::utils::BufferPool>(handler, poolBlocks, block, 2);
+            auto queue = std::make_shared<AJ::utils::Queue>(true, poolBlocks, block, 2, handler);
+            auto stop = std::make_shared<AJ::LFControlFlag>();
+            auto counters = std::make_shared<StreamCounters>();
+            stop->flag.store(false, std::memory_order_release);
+
+            FileStreamer streamer(queue, pool, stop, AJ::FileStreamingTypes::recording, session.string());
+            AJ::AudioWriteInfo info;
+            info.channels = 2;
+            info.samplerate = kSamplerate;
+            streamer.setWriteInfo(info, handler);
+            streamer.setWriteOptions(options);
+            streamer.setCounters(counters);
+
+            AJ::utils::ThreadPool writer(1);
+            std::future<bool> written = writer.enqueue([&] { return streamer.write(handler); });
+
+            const Clock::time_point begin = Clock::now();
+            const double blocksPerSecond = static_cast<double>(speed * kSamplerate) / block;
+            produced = 0;
+
+            while (true) {
+                const double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+                if (elapsed >= seconds) {
+                    break;
+                }
+
+                //* the blocks due by now (a burst when the producer can't sleep that short).
+                const size_t due = speed ? static_cast<size_t>(elapsed * blocksPerSecond) + 1 : produced + 1;
+                while (produced < due) {
+                    AJ::utils::Buffer *buffer = pool->tryPop();
+                    if (!buffer && !speed) {
+                        pool->wait(1, std::chrono::milliseconds(1));
+                        break;
+                    }
+
+                    ++produced;
+                    if (!buffer) {
+                        counters->poolExhausted.fetch_add(1, std::memory_order_relaxed);
+                        counters->dropped.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+
+                    AJ::bench::fill(buffer->data, 2 * block);
+                    buffer->frames = block;
+                    if (queue->push(buffer)) {
+                        counters->blocks.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        counters->dropped.fetch_add(1, std::memory_order_relaxed);
+                        pool->push(buffer, handler);
+                    }
+                }
+
+                if (speed) {
+                    std::this_thread::sleep_for(std::min(std::chrono::duration<double>(1.0 / blocksPerSecond),
+                                                         std::chrono::duration<double>(0.001)));
+                }
+            }
+
+            //* the run ends once the writer drained the queue and closed the file.
+            stop->flag.store(true, std::memory_order_release);
+            queue->wake();
+            written.get();
+            stats = counters->snapshot();
+        };
+
+        AJ::bench::Measurement m = runner.time(name, variant, 0, 2, setup, body, true);
+        m.frames = stats.written * block;
+        m.bytes = m.frames * 2 * sizeof(float);
+        m.cycles = 0;
+        m.counters["produced_blocks"] = static_cast<double>(produced);
+        m.counters["dropped_blocks"] = static_cast<double>(stats.dropped);
+        m.counters["max_queue_depth"] = static_cast<double>(stats.maxQueueDepth);
+        m.counters["pool_blocks"] = static_cast<double>(poolBlocks);
+
+        std::filesystem::remove_all(session);
+        if (!handler.errors().empty()) {
+            std::cout << "  " << name << " " << variant << ": failed\n";
+            return;
+        }
+        runner.record(m);
+    }
+
+public:
+    static void run_all(AJ::bench::Runner &runner) {
+        std::cout << "\nFile I/O\n";
+        std::cout << "---------------------------------------------\n";
+
+        const std::filesystem::path dir = directory(runner);
+
+        for (size_t frames : durations(runner)) {
+            if (runner.enabled("io/wav")) {
+                auto wav = make_file<AJ::io::WAV_File>(frames);
+                for (AJ::BitDepth_t bitdepth : { AJ::BitDepth_t::int_16, AJ::BitDepth_t::int_24, AJ::BitDepth_t::float_32 }) {
+                    save_and_load(runner, "wav", depth_name(bitdepth), wav, bitdepth, ".wav", dir, frames);
+                }
+            }
+
+            if (runner.enabled("io/mp3")) {
+                auto mp3 = make_file<AJ::io::MP3_File>(frames);
+                save_and_load(runner, "mp3", "mp3", mp3, AJ::BitDepth_t::int_16, ".mp3", dir, frames);
+            }
+        }
+
+        std::cout << "\nFileStreamer (" << runner.options().streamSeconds << " s per run, "
+                  << runner.options().streamPool << " pool blocks)\n";
+        std::cout << "---------------------------------------------\n";
+
+        WriteOptions sndfile;
+        WriteOptions coalesced;
+        coalesced.coalesce = true;
+        WriteOptions direct = coalesced;
+        direct.stream.direct = true;
+        WriteOptions flac;
+        flac.format = AJ::io::file_streamer::StreamFormat::Flac;
+
+        const std::pair<const char*, WriteOptions> modes[] = {
+            { "wav_sndfile", sndfile }, { "wav_coalesced", coalesced }, { "wav_direct", direct }, { "flac", flac }
+        };
+
+        for (const auto &[mode, options] : modes) {
+            if (!runner.enabled(std::string("stream/") + mode)) {
+                continue;
+            }
+
+            //* faster and faster until blocks drop, then the ceiling.
+            for (size_t speed : { 1, 4, 16, 64, 256, 1024 }) {
+                stream(runner, mode, options, speed, runner.options().streamSeconds, runner.options().streamPool, dir);
+                const AJ::bench::Measurement &last = runner.results().back();
+                if (last.name == std::string("stream/") + mode && last.counters.at("dropped_blocks") > 0) {
+                    break;
+                }
+            }
+            stream(runner, mode, options, 0, runner.options().streamSeconds, runner.options().streamPool, dir);
+        }
+    }
+};
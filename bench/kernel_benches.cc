@@ -0,0 +1,76 @@
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "core/types.h"
+#include "dsp/kernels.h"
+
+/**
+ * @brief The kernels under the effects, for every ISA the CPU supports.
+ *
+ * The tables are taken with tableFor(), so one run compares scalar, SSE4.1, AVX2 and AVX-512
+ * (or NEON) on the same buffers whatever AJ_SIMD selects for the engine.
+ */
+class KernelBenches {
+    using ISA = AJ::dsp::kernels::ISA;
+    using KernelTable = AJ::dsp::kernels::KernelTable;
+
+    //* the kernel of each effect (distortion: the shape curves, normalization: analysis then scaling).
+    static void run_table(AJ::bench::Runner &runner, const KernelTable &k, float *a, float *b, size_t frames) {
+        const std::string isa = AJ::dsp::kernels::name(k.isa);
+        const size_t n = 2 * frames;
+        volatile float sink = 0.0f;
+
+        auto refill = [=] { AJ::bench::fill(a, n); };
+        auto refill_both = [=] { AJ::bench::fill(a, n); AJ::bench::fill(b, n); };
+
+        auto bench = [&](const std::string &name, const std::function<void()> &setup, const std::function<void()> &body) {
+            if (runner.enabled("kernel/" + name)) {
+                runner.measure("kernel/" + name, isa, frames, 2, setup, body);
+            }
+        };
+
+        bench("gain", refill, [=] { k.gain(a, n, 0.8f); });
+        bench("fade", refill, [=] { k.fade(a, n, 1.0, -1.0 / n); });
+        bench("echo", refill_both, [=] { k.echo(a, b, a, n, 0.5f); });
+        bench("reverb_comb", refill_both, [=] { k.comb(b, 0.7f, a, a, n); });
+
+        AJ::dsp::kernels::ShapeParams shape;
+        shape.drive = 2.0f;
+        bench("distortion_tanh", refill, [=] { k.shape(a, n, shape); });
+
+        shape.approx = AJ::dsp::kernels::TanhApprox::Fast;
+        bench("distortion_tanh_fast", refill, [=] { k.shape(a, n, shape); });
+
+        shape.curve = AJ::dsp::kernels::Curve::HardClip;
+        bench("distortion_hard_clip", refill, [=] { k.shape(a, n, shape); });
+
+        shape.curve = AJ::dsp::kernels::Curve::Cubic;
+        bench("distortion_cubic", refill, [=] { k.shape(a, n, shape); });
+
+        bench("normalization_analyze", refill, [=, &sink] { sink = AJ::dsp::kernels::peak(k.analyze(a, n)); });
+        bench("normalization_scale", refill, [=] { k.scale(a, n, 1.25f); });
+    }
+
+public:
+    static void run_all(AJ::bench::Runner &runner) {
+        std::cout << "\nKernels\n";
+        std::cout << "---------------------------------------------\n";
+
+        const std::vector<size_t> sweep = runner.sweep();
+        if (sweep.empty()) {
+            return;
+        }
+
+        //* two buffers of the largest size, every smaller run uses their beginning.
+        AJ::Float a(2 * sweep.back()), b(2 * sweep.back());
+
+        for (size_t frames : sweep) {
+            for (ISA isa : { ISA::Scalar, ISA::SSE41, ISA::AVX2, ISA::AVX512, ISA::NEON }) {
+                if (AJ::dsp::kernels::supported(isa)) {
+                    run_table(runner, AJ::dsp::kernels::tableFor(isa), a.data(), b.data(), frames);
+                }
+            }
+        }
+    }
+};
@@ -5,13 +5,31 @@ set(COMMON_SOURCES
     src/file_io/audio_file.cc
     src/file_io/file_utils.cc 
     src/file_io/file_streamer.cc
+    src/file_io/writer_pool.cc
+    src/file_io/level_index.cc
+    src/file_io/seek_index.cc
+    src/file_io/spectrogram.cc
+    src/file_io/mapped_wav.cc
+    src/file_io/decode_cache.cc
+    src/file_io/wav_stream_writer.cc
+    src/file_io/mp3_stream_encoder.cc
+    src/file_io/compact_samples.cc
     
+    src/dsp/effect_chain.cc
+    src/dsp/effect_registry.cc
+    src/dsp/automation.cc
+    src/dsp/fft.cc
+    src/dsp/kernels/kernels.cc
+
     src/dsp/echo/echo.cc
+    src/dsp/echo/multi_tap_echo.cc
     src/dsp/gain/gain.cc
 
     src/dsp/reverb/all_pass_filter.cc
-    src/dsp/reverb/comb_filter.cc
     src/dsp/reverb/reverb.cc
+    src/dsp/reverb/impulse_response.cc
+    src/dsp/reverb/convolver.cc
+    src/dsp/reverb/convolution_reverb.cc
     
     src/dsp/fade/fade.cc
 
@@ -22,12 +40,54 @@ set(COMMON_SOURCES
 
     src/dsp/reverse/reverse.cc
 
+    src/dsp/pitch/phase_vocoder.cc
+    src/dsp/pitch/pitch_shift.cc
+
+    src/dsp/eq/biquad.cc
+    src/dsp/eq/equalizer.cc
+
+    src/dsp/dynamics/dynamics.cc
+    src/dsp/dynamics/gate.cc
+    src/dsp/silence/silence.cc
+    src/dsp/loudness/loudness.cc
+
+    src/dsp/stretch/time_stretch.cc
+
+    src/dsp/resample/resampler.cc
+
     src/editing/cut.cc
     src/editing/insert.cc
+    src/editing/piece_table.cc
+    src/editing/render_graph.cc
+    src/editing/preview.cc
+    src/editing/project.cc
+    src/editing/transaction.cc
+    src/editing/trim.cc
+    src/editing/session/time_line.cc
+    src/editing/session/render_cache.cc
+    src/editing/session/mixer.cc
+    src/editing/session/session.cc
+    src/editing/session/export.cc
+
+    src/undo_system/state.cc
+    src/undo_system/undo.cc
 
     src/core/buffer_pool.cc
     src/core/ring_buffer.cc
+    src/core/scratch_arena.cc
+    src/core/metrics.cc
+    src/core/trace.cc
+    src/core/memory.cc
+    src/core/realtime.cc
+    src/core/elastic_pool.cc
+    src/core/thread_placement.cc
+    src/core/mpmc_queue.cc
+    src/core/error_channel.cc
 
     src/audio_io/record.cc
+    src/audio_io/callback_profiler.cc
+    src/audio_io/play.cc
+    src/audio_io/device.cc
+    src/audio_io/multi_recorder.cc
 )
 
@@ -3,21 +3,78 @@ set(COMMON_TEST_SOURCES
     test/file_io/wav_file_tests.cc
     test/file_io/mp3_file_tests.cc
     test/file_io/file_streamer_tests.cc
+    test/file_io/writer_pool_tests.cc
+    test/file_io/level_index_tests.cc
+    test/file_io/seek_index_tests.cc
+    test/file_io/spectrogram_tests.cc
+    test/file_io/mapped_wav_tests.cc
+    test/file_io/decode_cache_tests.cc
+    test/file_io/wav_stream_writer_tests.cc
+    test/file_io/mp3_stream_encoder_tests.cc
+    test/file_io/compact_samples_tests.cc
+    test/file_io/async_load_tests.cc
 
     test/echo/echo_tests.cc
+    test/echo/multi_tap_echo_tests.cc
     test/gain/gain_tests.cc
     test/reverb/reverb_tests.cc
+    test/reverb/convolution_reverb_tests.cc
     test/fade/fade_tests.cc
     test/normalization/norm_tests.cc
     test/distortion/distortion_tests.cc
     test/reverse/reverse_tests.cc
+    test/pitch_shift/pitch_shift_tests.cc
+    test/equalizer/equalizer_tests.cc
+    test/dynamics/dynamics_tests.cc
+    test/dynamics/gate_tests.cc
+    test/silence/silence_tests.cc
+    test/loudness/loudness_tests.cc
+    test/time_stretch/time_stretch_tests.cc
+    test/resample/resample_tests.cc
+    test/effect_chain/effect_chain_tests.cc
+    test/effect_registry/effect_registry_tests.cc
+    test/static_chain/static_chain_tests.cc
+    test/automation/automation_tests.cc
+    test/audio_view/audio_view_tests.cc
+    test/kernels/kernels_tests.cc
+    test/fft/fft_tests.cc
 
     test/editing/cut/cut_tests.cc
     test/editing/insert/insert_tests.cc
+    test/editing/piece_table/piece_table_tests.cc
+    test/editing/render_graph/render_graph_tests.cc
+    test/editing/preview/preview_tests.cc
+    test/editing/project/project_tests.cc
+    test/editing/transaction/transaction_tests.cc
+    test/editing/trim/trim_tests.cc
+    test/editing/session/session_tests.cc
+    test/editing/session/export_tests.cc
+    test/editing/session/render_cache_tests.cc
+
+    test/undo/undo_tests.cc
+
+    test/batch/batch_runner_tests.cc
 
     test/core/utils/buffer_pool_tests.cc
+    test/core/utils/mpmc_queue_tests.cc
     test/core/utils/ring_buffer_tests.cc
+    test/core/utils/fixed_ring_tests.cc
     test/core/utils/thread_pool_tests.cc
+    test/core/utils/aligned_allocator_tests.cc
+    test/core/utils/scratch_arena_tests.cc
+    test/core/utils/param_store_tests.cc
+    test/core/utils/metrics_tests.cc
+    test/core/utils/trace_tests.cc
+    test/core/utils/memory_tests.cc
+    test/core/utils/realtime_tests.cc
+    test/core/utils/engine_resources_tests.cc
+    test/core/utils/elastic_pool_tests.cc
+    test/core/utils/thread_placement_tests.cc
+    test/core/utils/error_channel_tests.cc
 
     test/audio_io/record_tests.cc
+    test/audio_io/play_tests.cc
+    test/audio_io/callback_profiler_tests.cc
+    test/audio_io/device_tests.cc
+    test/audio_io/multi_recorder_tests.cc
 )
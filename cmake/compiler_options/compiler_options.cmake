@@ -1,6 +1,35 @@
-
 # while debugging:
 # add_compile_options(-O0 -g)
 
 # while running:
-add_compile_options(-O3 -march=native -mfpmath=sse)
+add_compile_options(-O3)
+
+# -march=native ties the binary to the build machine. The SIMD kernels are picked at
+# runtime (src/dsp/kernels), so the portable build already uses the widest vectors available.
+option(AJ_NATIVE_ARCH "Tune the whole build for the build machine (-march=native)" OFF)
+
+if(AJ_NATIVE_ARCH)
+    add_compile_options(-march=native)
+endif()
+
+# AJ_TRACE_ZONE() compiles to nothing unless AJ_TRACE is defined (include/core/trace.h).
+option(AJ_TRACE "Build the trace zones (sound_processor --trace <file>)" OFF)
+
+if(AJ_TRACE)
+    add_compile_definitions(AJ_TRACE)
+endif()
+
+# Replaces malloc and wraps the pthread lock / wait / sleep calls to report the ones made inside
+# a utils::RealtimeScope, with their stack (include/core/realtime.h). Not with -fsanitize=address.
+option(AJ_REALTIME_GUARD "Report allocations, locks and blocking calls on realtime threads" OFF)
+
+if(AJ_REALTIME_GUARD)
+    add_compile_definitions(AJ_REALTIME_GUARD)
+    # dlsym for the wrapped calls, -rdynamic so backtrace_symbols() names the engine's functions.
+    link_libraries(${CMAKE_DL_LIBS})
+    add_link_options(-rdynamic)
+endif()
+
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64|amd64|i[3-6]86")
+    add_compile_options(-mfpmath=sse)
+endif()
@@ -2,6 +2,8 @@
 
 #include<memory>
 #include "record.h"
+#include "play.h"
+#include "device.h"
 #include "core/engine_resources.h"
 
 namespace AJ::io::audio_io_manager {
@@ -56,7 +58,8 @@ struct PlayHandlers {
  *
  * Responsibilities:
  * - Validate and manage session directory.
- * - Initialize and manage the recorder with engine resources.
+ * - Open the devices of a device::DeviceConfig and size the engine's record pool and queue from it.
+ * - Initialize and manage the recorder and the player with engine resources.
  * - Provide entry points for recording and playback.
  */
 class AudioIOManager{
@@ -69,6 +72,11 @@ private:
      */
     std::string mSessionDirectory;
 
+    /**
+     * @brief Devices, samplerate, channels and buffer size of the recorder and the player.
+     */
+    device::DeviceConfig mConfig;
+
     /**
      * @brief Recorder instance responsible for capturing audio.
      *
@@ -92,6 +100,25 @@ private:
      */
     AJ::utils::IEventHandler& mRecordHandler;
 
+    /**
+     * @brief Player instance responsible for playback.
+     *
+     * Created with the engine thread pool, plays the source given to play().
+     */
+    std::shared_ptr<io::play::Player> pPlayer;
+
+    /**
+     * @brief Reference to the error handler for playback.
+     */
+    AJ::error::IErrorHandler& mPlayErrHandler;
+
+    /**
+     * @brief Reference to the event handler for playback.
+     *
+     * Handles interaction logic during playback, transport commands go through player().
+     */
+    AJ::utils::IEventHandler& mPlayHandler;
+
     /**
      * @brief Shared engine-wide resources.
      *
@@ -134,8 +161,23 @@ public:
      * @param play_handlers Handlers for playback (error + event).
      */
     AudioIOManager(std::shared_ptr<AJ::EngineResources> engineResources, std::string& session_directory,
-        RecordHandlers& record_handlers, PlayHandlers& play_handlers) : pEngineResources(engineResources), 
-        mRecordErrHandler(record_handlers.mRecordErrHandler),mRecordHandler(record_handlers.mRecordHandler){
+        RecordHandlers& record_handlers, PlayHandlers& play_handlers) :
+        AudioIOManager(std::move(engineResources), session_directory, record_handlers, play_handlers, device::DeviceConfig{}) {}
+
+    /**
+     * @brief Construct an AudioIOManager for a device configuration.
+     *
+     * The recorder and the player open the devices of `config` at its samplerate, channel count
+     * and buffer size. The engine's record pool and queue (mono or stereo, as `config`) are
+     * resized to device::poolSizing(config): construct managers before recording, not during.
+     *
+     * @param config devices and stream settings, e.g. device::DeviceConfig::tracking().
+     */
+    AudioIOManager(std::shared_ptr<AJ::EngineResources> engineResources, std::string& session_directory,
+        RecordHandlers& record_handlers, PlayHandlers& play_handlers, const device::DeviceConfig& config) :
+        mConfig(config), pEngineResources(engineResources),
+        mRecordErrHandler(record_handlers.mRecordErrHandler),mRecordHandler(record_handlers.mRecordHandler),
+        mPlayErrHandler(play_handlers.mPlayErrHandler), mPlayHandler(play_handlers.mPlayHandler){
         
         mValid = false;
 
@@ -145,33 +187,55 @@ public:
 
         mSessionDirectory = session_directory;
 
-        //* init recorder ptr.
-        AJ::io::record::InitRecordInfo recorder_info;
-        recorder_info.mChannels = 2;
-        recorder_info.mSamplerate = 44100;
-        recorder_info.mSessionDirectory = mSessionDirectory;
-
-        if(!pEngineResources){
+        if(!pEngineResources || !pEngineResources->ioThreadPool() || !mConfig.validate(mRecordErrHandler)){
             return;
         }
-        
-        if(!pEngineResources->queueStereo() || !pEngineResources->bufferPoolStereo() || !pEngineResources->threadPool()){
-            return;
-        }
-    
-        if(!pEngineResources->queueStereo()->isValid() || !pEngineResources->bufferPoolStereo()->isValid()){
+
+        //* the record path holds mBufferedSeconds of audio in buffers of one callback each.
+        const device::PoolSizing sizing = device::poolSizing(mConfig);
+        if(!pEngineResources->resizeStreamBuffers(mConfig.mChannels, sizing.buffers, sizing.bufferFrames, mRecordErrHandler)){
             return;
         }
 
+        const bool mono = mConfig.mChannels == 1;
+        std::shared_ptr<AJ::utils::Queue> queue = mono ? pEngineResources->queueMono() : pEngineResources->queueStereo();
+        std::shared_ptr<AJ::utils::BufferPool> pool = mono ? pEngineResources->bufferPoolMono() : pEngineResources->bufferPoolStereo();
+
         pStopFlag = std::make_shared<LFControlFlag>();
         pStopFlag->flag.store(false, std::memory_order_release);
 
-        recorder_info.pQueue = pEngineResources->queueStereo();
-        recorder_info.pBufferPool = pEngineResources->bufferPoolStereo();
-        recorder_info.pThreadPool = pEngineResources->threadPool();
+        //* init recorder ptr.
+        AJ::io::record::InitRecordInfo recorder_info;
+        recorder_info.mChannels = mConfig.mChannels;
+        recorder_info.mSamplerate = mConfig.mSamplerate;
+        recorder_info.mFramesPerBuffer = mConfig.framesPerBuffer();
+        recorder_info.mDevice = mConfig.mInput;
+        recorder_info.mSessionDirectory = mSessionDirectory;
+
+        recorder_info.pQueue = queue;
+        recorder_info.pBufferPool = pool;
+        recorder_info.pThreadPool = pEngineResources->ioThreadPool();
         recorder_info.pStopFlag = pStopFlag;
+        recorder_info.pMetrics = pEngineResources->metrics();
+        recorder_info.mWriterPlacement = pEngineResources->config().mDiskPlacement;
         
         pRecorder = std::make_shared<record::Recorder>(recorder_info, record_handlers.mRecordErrHandler);
+
+        //* init player ptr.
+        AJ::io::play::InitPlayInfo player_info;
+        player_info.mChannels = mConfig.mChannels;
+        player_info.mSamplerate = mConfig.mSamplerate;
+        player_info.mFramesPerBuffer = mConfig.framesPerBuffer();
+        player_info.mDevice = mConfig.mOutput;
+        player_info.pThreadPool = pEngineResources->ioThreadPool();
+        player_info.pStopFlag = pStopFlag;
+        player_info.pMetrics = pEngineResources->metrics();
+
+        pPlayer = std::make_shared<play::Player>(player_info, play_handlers.mPlayErrHandler);
+
+        if(!pPlayer->isValid()){
+            return;
+        }
         
         mValid = true;
     }
@@ -189,6 +253,27 @@ public:
         return mValid;
     }
 
+    /**
+     * @brief Device configuration the recorder and the player use.
+     */
+    const device::DeviceConfig& deviceConfig() const noexcept {
+        return mConfig;
+    }
+
+    /**
+     * @brief Measure the round-trip latency of the configured devices through a loopback
+     * (see device::measureRoundTrip()). Not while recording or playing.
+     *
+     * @return True if the burst was heard, errors go to the record error handler.
+     */
+    bool calibrate(device::RoundTripLatency& latency){
+        if(!mValid){
+            return false;
+        }
+
+        return device::measureRoundTrip(mConfig, latency, mRecordErrHandler);
+    }
+
 
     /**
      * @brief Start the recording process.
@@ -207,14 +292,127 @@ public:
     }
 
     /**
-     * @brief Start the playback process.
+     * @brief Capture ahead of record() so the take starts with the last setPreroll() seconds.
+     *
+     * record() then only opens the file, see record::Recorder::arm().
+     * @return True if the input stream runs, errors go to the record error handler.
+     */
+    bool arm(){
+        if(!mValid){
+            return false;
+        }
+
+        return pRecorder->arm();
+    }
+
+    /**
+     * @brief Stop an armed input stream without recording.
+     */
+    void disarm(){
+        if(mValid){
+            pRecorder->disarm();
+        }
+    }
+
+    /**
+     * @brief Audio kept while armed, at most half of the record pool (mBufferedSeconds / 2).
+     *
+     * @return True if it fits, errors go to the record error handler.
+     */
+    bool setPreroll(double seconds){
+        if(!mValid){
+            return false;
+        }
+
+        return pRecorder->setPreroll(seconds, mRecordErrHandler);
+    }
+
+    /**
+     * @brief Hear the input while recording, processed by `chain`, on the configured output device.
+     *
+     * The next record() runs one duplex stream (see record::Recorder::setMonitor()), one buffer
+     * of added latency. Pick a small buffer for it, e.g. device::DeviceConfig::tracking().
+     *
+     * @param chain block processing effects, an empty chain monitors dry, nullptr turns monitoring off.
+     * @return True if the chain can run in the callback, errors go to the record error handler.
+     */
+    bool setMonitor(std::shared_ptr<AJ::dsp::EffectChain> chain){
+        if(!mValid){
+            return false;
+        }
+
+        return pRecorder->setMonitor(std::move(chain), mConfig.mOutput, mRecordErrHandler);
+    }
+
+    /**
+     * @brief Counters of the current (or last) recording, safe to call while recording.
+     *
+     * Non zero `dropped` / `poolExhausted` mean the disk writer didn't keep up,
+     * see record::OverflowPolicy.
+     */
+    AJ::io::file_streamer::StreamStats recordStats() const noexcept {
+        return pRecorder ? pRecorder->stats() : AJ::io::file_streamer::StreamStats{};
+    }
+
+    /**
+     * @brief Timing of the record callbacks of the current (or last) recording.
+     *
+     * Deadline misses or input overflows call for a larger buffer, a queue that keeps
+     * growing for a faster disk writer (see record::CallbackProfiler).
+     */
+    AJ::io::record::CallbackProfile recordCallbackProfile() const {
+        return pRecorder ? pRecorder->callbackProfile() : AJ::io::record::CallbackProfile{};
+    }
+
+    /**
+     * @brief Start the playback process of the last source given to play().
      *
-     * Not yet implemented.
+     * Blocks until the event handler stops the playback or the source ends.
      *
-     * @return True if playback started successfully, false otherwise.
+     * @return True if playback ran successfully, false otherwise (no source yet).
      */
     bool play(){
-        return false;
+        if(!mValid){
+            return false;
+        }
+
+        return pPlayer->play(mPlayErrHandler, mPlayHandler);
+    }
+
+    /**
+     * @brief Play a source (e.g. a play::StreamSource fed by FileStreamer::read()).
+     *
+     * @param source frames to play, interleaved to the configured channel count.
+     * @return True if playback ran successfully, false otherwise.
+     */
+    bool play(std::shared_ptr<io::play::IPlaySource> source){
+        if(!mValid || !pPlayer->setSource(std::move(source), mPlayErrHandler)){
+            return false;
+        }
+
+        return play();
+    }
+
+    /**
+     * @brief Play an in-memory audio file from its start.
+     *
+     * @param file decoded audio file.
+     * @param reversed play it backwards, from its last frame (the samples aren't moved).
+     * @return True if playback ran successfully, false otherwise.
+     */
+    bool play(std::shared_ptr<AJ::io::AudioFile> file, bool reversed = false){
+        if(!file){
+            return false;
+        }
+
+        return play(std::make_shared<io::play::AudioFileSource>(file, mConfig.mChannels, reversed));
+    }
+
+    /**
+     * @brief Player used by play(), for transport (pause / resume / seek) and stats while playing.
+     */
+    std::shared_ptr<io::play::Player> player() const {
+        return pPlayer;
     }
 };
 
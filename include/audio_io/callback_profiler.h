@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "portaudio.h"
+
+#include "core/constants.h"
+#include "core/metrics.h"
+
+namespace AJ::io::record {
+
+/**
+ * @brief One record callback of the slow callbacks log, see CallbackProfile::worst.
+ */
+struct SlowCallback {
+    uint64_t index = 0;       ///< callback number since the stream started (0 based).
+    uint64_t duration = 0;    ///< ns spent in the callback.
+    uint64_t deadline = 0;    ///< ns the buffer lasts (frames / samplerate).
+    uint64_t frames = 0;      ///< frames given to the callback.
+    uint64_t queueDepth = 0;  ///< blocks waiting for the disk writer when the callback returned.
+    uint64_t flags = 0;       ///< PaStreamCallbackFlags of the callback.
+    double inputTime = 0.0;   ///< inputBufferAdcTime of the callback in seconds (0 if the host doesn't give it).
+
+    /// @brief Fraction of the deadline the callback used, above 1 it missed it.
+    double load() const noexcept {
+        return deadline ? static_cast<double>(duration) / static_cast<double>(deadline) : 0.0;
+    }
+};
+
+/**
+ * @brief Plain values of a CallbackProfiler, see Recorder::callbackProfile().
+ */
+struct CallbackProfile {
+    uint64_t callbacks = 0;        ///< record callbacks since the stream started.
+    uint64_t deadlineMisses = 0;   ///< callbacks that ran longer than their buffer lasts.
+    uint64_t inputOverflows = 0;   ///< callbacks flagged paInputOverflow: the host dropped input before us.
+    uint64_t inputUnderflows = 0;  ///< callbacks flagged paInputUnderflow: the input was padded with silence.
+    uint64_t queueDepth = 0;       ///< blocks waiting for the disk writer after the last callback.
+    uint64_t maxQueueDepth = 0;    ///< deepest queue a callback left.
+    uint64_t deadline = 0;         ///< ns, deadline of the last callback.
+
+    AJ::utils::LatencySummary durations;   ///< ns spent in the callbacks.
+    std::vector<SlowCallback> worst;       ///< slowest callbacks, slowest first (at most kRecordWorstCallbacks).
+
+    /// @brief Fraction of its deadline the slowest callback used.
+    double maxLoad() const noexcept {
+        return worst.empty() ? 0.0 : worst.front().load();
+    }
+};
+
+/**
+ * @class CallbackProfiler
+ * @brief Times the record callback against its deadline and counts the xruns the host reports.
+ *
+ * onCallback() is only called by the audio thread: relaxed atomic adds, no lock or allocation.
+ * The slow callbacks log is kept by the callback and republished (seqlock) only when it changes,
+ * which becomes rare once it holds the kRecordWorstCallbacks slowest. snapshot() can run on any
+ * thread while recording, a rising queue depth with no slow callback means the disk writer is
+ * falling behind, slow callbacks or input overflows point at the buffer size or the host.
+ */
+class CallbackProfiler {
+    static constexpr size_t kWords = 7;   ///< atomic words of a published SlowCallback.
+
+    //* only touched by the callback.
+    std::array<SlowCallback, kRecordWorstCallbacks> mWorst{};
+    size_t mWorstCount = 0;
+    double mNsPerFrame = 0.0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> mCallbacks{0};
+    std::atomic<uint64_t> mDeadlineMisses{0};
+    std::atomic<uint64_t> mInputOverflows{0};
+    std::atomic<uint64_t> mInputUnderflows{0};
+    std::atomic<uint64_t> mQueueDepth{0};
+    std::atomic<uint64_t> mMaxQueueDepth{0};
+    std::atomic<uint64_t> mDeadline{0};
+
+    AJ::utils::LatencyHistogram mDurations;
+
+    //* the slow callbacks log as the control thread reads it, odd sequence while it's rewritten.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> mWorstSequence{0};
+    std::atomic<uint64_t> mWorstPublished{0};
+    std::array<std::atomic<uint64_t>, kRecordWorstCallbacks * kWords> mWorstWords{};
+
+    void publishWorst() noexcept;
+
+public:
+    /// @brief Samplerate of the stream, gives the deadline of a callback (before the stream starts).
+    void setSamplerate(int samplerate) noexcept {
+        mNsPerFrame = samplerate > 0 ? 1e9 / samplerate : 0.0;
+    }
+
+    /// @brief ns `frames` last at the samplerate, the deadline of a callback.
+    uint64_t deadline(unsigned long frames) const noexcept {
+        return static_cast<uint64_t>(frames * mNsPerFrame);
+    }
+
+    /**
+     * @brief Account one callback (audio thread only).
+     *
+     * @param duration ns spent in the callback.
+     * @param frames frames given to the callback.
+     * @param flags status flags of the callback.
+     * @param timeInfo time info of the callback (may be null).
+     * @param queueDepth blocks waiting for the disk writer.
+     * @return true if the callback missed its deadline.
+     */
+    bool onCallback(uint64_t duration, unsigned long frames, PaStreamCallbackFlags flags,
+                    const PaStreamCallbackTimeInfo *timeInfo, uint64_t queueDepth) noexcept;
+
+    /// @brief Read everything (control thread, allocates the log).
+    CallbackProfile snapshot() const;
+
+    /// @brief Zero everything but the samplerate (not while a stream is running).
+    void reset() noexcept;
+};
+
+}
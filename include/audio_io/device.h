@@ -0,0 +1,180 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "portaudio.h"
+
+#include "core/constants.h"
+#include "core/error_handler.h"
+
+namespace AJ::io::device {
+
+/**
+ * @brief PortAudio host APIs a stream can be opened with.
+ */
+enum class HostApi : uint8_t {
+    Default,    ///< the default host API of the platform.
+    ALSA,
+    JACK,
+    CoreAudio,
+    ASIO,
+    WASAPI,
+};
+
+/// @brief Name of a host API (e.g. "ALSA").
+const char* hostApiName(HostApi api) noexcept;
+
+/**
+ * @brief Which device one direction of a stream opens, and how.
+ */
+struct DeviceSelection {
+    HostApi mHostApi = HostApi::Default;    ///< host API the device is looked up in.
+    std::string mName;                      ///< part of the device name, empty = default device of the host API.
+    double mSuggestedLatency = 0.0;         ///< seconds, 0 = the device's default low latency.
+};
+
+/**
+ * @brief Audio device setup of the recorder and the player, see AudioIOManager.
+ *
+ * The frames per buffer set the latency of the callbacks, the record pool and queue are sized
+ * from them and mBufferedSeconds (see poolSizing()): a 32-frame tracking setup gets thousands of
+ * small buffers, a large-buffer one a few big buffers, both holding the same time of audio.
+ *
+ * ### Example:
+ * @code
+ * AJ::io::device::DeviceConfig config = AJ::io::device::DeviceConfig::tracking(48000);
+ * config.mInput.mHostApi = config.mOutput.mHostApi = AJ::io::device::HostApi::JACK;
+ * config.mInput.mName = "Scarlett";
+ * @endcode
+ */
+struct DeviceConfig {
+    DeviceSelection mInput;         ///< device the recorder opens.
+    DeviceSelection mOutput;        ///< device the player opens.
+
+    int mSamplerate = 44100;        ///< Hz.
+    uint8_t mChannels = 2;          ///< 1 or 2.
+    size_t mFramesPerBuffer = 0;    ///< frames per callback, 0 = BUFFER_SECONDS worth.
+
+    double mBufferedSeconds = kDeviceBufferedSeconds; ///< audio the record pool holds while the disk writer lags.
+
+    /// @brief Smallest buffers, lowest latency: monitoring while tracking (kDeviceTrackingFrames).
+    static DeviceConfig tracking(int samplerate = 48000);
+
+    /// @brief Large buffers and a high suggested latency: long takes on a busy machine (kDeviceSafeFrames).
+    static DeviceConfig safe(int samplerate = 48000);
+
+    /// @brief Frames per callback, mFramesPerBuffer or its default.
+    size_t framesPerBuffer() const noexcept;
+
+    /// @brief Check the rate, channels and buffer size without opening anything.
+    bool validate(AJ::error::IErrorHandler &handler) const;
+};
+
+/**
+ * @brief Buffers of the record pool and queue for a configuration.
+ */
+struct PoolSizing {
+    size_t buffers = 0;         ///< power of two, kDeviceMinBuffers to kDeviceMaxBuffers.
+    size_t bufferFrames = 0;    ///< one callback.
+};
+
+/// @brief Enough buffers of one callback each for mBufferedSeconds of audio.
+PoolSizing poolSizing(const DeviceConfig &config) noexcept;
+
+/**
+ * @brief A device as PortAudio reports it, see listDevices().
+ */
+struct DeviceInfo {
+    int index = -1;                 ///< PortAudio device index.
+    std::string name;
+    HostApi hostApi = HostApi::Default; ///< Default for host APIs without a HostApi value.
+    std::string hostApiName;
+    int maxInputChannels = 0;
+    int maxOutputChannels = 0;
+    double defaultSamplerate = 0.0;
+    double defaultLowInputLatency = 0.0;    ///< seconds.
+    double defaultLowOutputLatency = 0.0;
+    double defaultHighInputLatency = 0.0;
+    double defaultHighOutputLatency = 0.0;
+};
+
+/**
+ * @brief Keeps PortAudio initialized while it is held.
+ *
+ * Pa_Initialize() scans every host API and device, which takes from a few to a few hundred
+ * milliseconds. The recorder and the player hold a session for their lifetime instead of
+ * initializing around every take: the first acquire() initializes, the last release terminates.
+ *
+ * ### Example:
+ * @code
+ * auto session = AJ::io::device::PortAudioSession::acquire(handler);
+ * if(!session) return;            // reported
+ * // open, start and close streams as many times as needed
+ * @endcode
+ */
+class PortAudioSession {
+private:
+    PortAudioSession() = default;
+
+public:
+    /**
+     * @brief The current session, or a new one if nobody holds it.
+     * @return nullptr (reported) if PortAudio can't be initialized.
+     */
+    static std::shared_ptr<PortAudioSession> acquire(AJ::error::IErrorHandler &handler);
+
+    /// @brief Terminates PortAudio, only ever run by the last holder.
+    ~PortAudioSession();
+
+    PortAudioSession(const PortAudioSession&) = delete;
+    PortAudioSession& operator=(const PortAudioSession&) = delete;
+};
+
+/// @brief Every device of every host API (initializes PortAudio for the call).
+std::vector<DeviceInfo> listDevices(AJ::error::IErrorHandler &handler);
+
+/**
+ * @brief Stream parameters of one direction for a selection, PortAudio must be initialized.
+ *
+ * Picks the first device of the host API whose name contains mName (the host API default
+ * when empty), checks it has `channels` channels and sets the suggested latency.
+ * @param input true for the input side, false for the output side.
+ * @return false if the host API or the device is missing or has too few channels.
+ */
+bool streamParameters(const DeviceSelection &selection, bool input, int channels,
+    PaStreamParameters &parameters, AJ::error::IErrorHandler &handler);
+
+/**
+ * @brief Result of measureRoundTrip().
+ */
+struct RoundTripLatency {
+    size_t frames = 0;          ///< output to input delay measured through the loopback.
+    double seconds = 0.0;
+    double reported = 0.0;      ///< input + output latency PortAudio reports for the stream, seconds.
+    float confidence = 0.0f;    ///< correlation peak over its RMS, see kCalibrationMinConfidence.
+};
+
+/**
+ * @brief Measure the true round-trip latency through a physical or virtual loopback.
+ *
+ * Opens a duplex stream with the input and output devices of `config`, plays a noise burst
+ * of kCalibrationProbeFrames after kCalibrationLeadSeconds and finds it in the first input
+ * channel by cross-correlation. Connect an output to an input first; the difference with
+ * `reported` is what the drivers don't account for (converters, USB buffering).
+ * @return false if the stream can't run or the burst wasn't heard.
+ */
+bool measureRoundTrip(const DeviceConfig &config, RoundTripLatency &latency, AJ::error::IErrorHandler &handler);
+
+/**
+ * @brief Find a probe in a captured signal by cross-correlation (polarity independent).
+ *
+ * @param confidence set to the correlation peak over the RMS of the correlation, 0 on silence.
+ * @return frames between the start of `captured` and the probe, the best match if it isn't there.
+ */
+size_t detectDelay(const float *captured, size_t frames, const float *probe, size_t probe_frames, float &confidence);
+
+/// @brief The calibration burst: deterministic white noise at half scale.
+std::vector<float> calibrationProbe(size_t frames = kCalibrationProbeFrames);
+
+}
@@ -0,0 +1,222 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "portaudio.h"
+
+#include "core/types.h"
+#include "core/error_handler.h"
+#include "core/buffer_pool.h"
+#include "core/metrics.h"
+
+#include "file_io/file_streamer.h"
+#include "file_io/writer_pool.h"
+#include "audio_io/record.h"
+#include "audio_io/callback_profiler.h"
+#include "audio_io/device.h"
+
+namespace AJ::io::record {
+
+/**
+ * @brief One recorded file of a MultiRecorder: one or two consecutive input channels of a device.
+ */
+struct TrackSpec {
+    int mFirstChannel = 0;      ///< first device channel of the track, 0-based.
+    uint8_t mChannels = 1;      ///< 1 (mono) or 2 (stereo pair).
+    std::string mName;          ///< prefix of the file names, empty = "track_<index>".
+};
+
+/**
+ * @brief One input device a MultiRecorder opens, split into tracks.
+ */
+struct DeviceStreamSpec {
+    AJ::io::device::DeviceSelection mDevice; ///< device, host API and suggested latency.
+    int mChannels = 2;                       ///< channels opened on the device.
+    std::vector<TrackSpec> mTracks;          ///< empty = one mono track per channel.
+};
+
+/**
+ * @brief Initialization info of a MultiRecorder.
+ */
+struct InitMultiRecordInfo {
+    int mSamplerate = 48000;        ///< Hz, every device runs at it.
+    size_t mFramesPerBuffer = 0;    ///< frames per callback, 0 = BUFFER_SECONDS worth.
+    double mBufferedSeconds = kDeviceBufferedSeconds; ///< audio each track's pool holds while the writers lag.
+    std::string mSessionDirectory;  ///< the files go to `<directory>/records/`.
+
+    std::vector<DeviceStreamSpec> mStreams; ///< devices, one callback each.
+
+    size_t mWriterThreads = kRecordWriterThreads; ///< disk writers shared by all the tracks.
+    std::shared_ptr<AJ::io::file_streamer::WriterPool> pWriters; ///< existing writers to use instead (e.g. EngineResources::diskWriters()), mWriterThreads is then ignored.
+
+    OverflowPolicy mOverflowPolicy = OverflowPolicy::Reserve; ///< per track, see OverflowPolicy.
+    size_t mReserveBuffers = 4;     ///< emergency buffers per track (at most kRecordReserveMax).
+
+    AJ::io::file_streamer::WriteOptions mWriteOptions; ///< format of every file.
+
+    std::shared_ptr<AJ::utils::MetricsRegistry> pMetrics; ///< Engine metrics (optional).
+};
+
+/**
+ * @brief Records many tracks from several devices at once, without a thread per track.
+ *
+ * Each device stream has one callback that splits its input channels into tracks. A track
+ * has its own queue and a pool leased from a SharedBufferPool (one per channel layout,
+ * sized for every track at construction). Its file is written by one of a few shared
+ * WriterPool threads. start() and stop() return once the streams run or are closed, the
+ * caller's thread is never held for the length of a take (unlike Recorder::record()).
+ *
+ * ### Example:
+ * @code
+ * AJ::io::record::InitMultiRecordInfo info;
+ * info.mSessionDirectory = dir;
+ * info.mFramesPerBuffer = 256;
+ *
+ * AJ::io::record::DeviceStreamSpec interface;      // 24 mono tracks of one interface
+ * interface.mDevice.mName = "MADIface";
+ * interface.mChannels = 24;
+ * info.mStreams.push_back(interface);
+ *
+ * AJ::io::record::MultiRecorder recorder(info, handler);
+ * recorder.start();
+ * // ...
+ * recorder.stop();
+ * @endcode
+ */
+class MultiRecorder {
+private:
+    /// @brief A recorded file: its queue, pool, callback state and writer.
+    struct Track {
+        TrackSpec mSpec;
+        std::shared_ptr<AJ::utils::Queue> pQueue;
+        std::shared_ptr<AJ::utils::SharedBufferPool> pShared; ///< where the pool is leased from.
+        std::shared_ptr<AJ::utils::BufferPool> pPool;         ///< leased by start(), released by stop().
+        std::shared_ptr<AudioData> pData;
+        std::shared_ptr<AJ::io::file_streamer::FileStreamer> pStreamer; ///< new for every take.
+        std::string mPath;                                    ///< file of the current (or last) take.
+    };
+
+    /// @brief An open device and the tracks its callback fills.
+    struct DeviceStream {
+        DeviceStreamSpec mSpec;
+        PaStream* stream = nullptr;
+        LFControlFlagPtr pStopFlag;
+        std::vector<Track*> mTracks;
+        CallbackProfiler mProfiler;
+        std::shared_ptr<AJ::utils::MetricsRegistry> pMetrics;
+    };
+
+    InitMultiRecordInfo mInfo;
+    AJ::error::IErrorHandler& mHandler;
+
+    size_t mFramesPerBuffer = 0;
+    size_t mTrackBuffers = 0;       ///< buffers leased per track.
+
+    std::vector<std::unique_ptr<Track>> mTracks;
+    std::vector<std::unique_ptr<DeviceStream>> mStreams;
+    std::shared_ptr<AJ::utils::SharedBufferPool> pMonoPool;
+    std::shared_ptr<AJ::utils::SharedBufferPool> pStereoPool;
+    std::shared_ptr<AJ::io::file_streamer::WriterPool> pWriters;
+    std::shared_ptr<AJ::io::device::PortAudioSession> pPortAudio; ///< Held from the first start() on.
+
+    bool mValid = false;
+    bool mRecording = false;
+
+    /**
+     * @brief Callback of one device: every track gets its channels of the block.
+     *
+     * Realtime safe, same rules as Recorder::recordCallback().
+     */
+    static int streamCallback(const void *inputBuffer, void *outputBuffer,
+                              unsigned long framesPerBuffer,
+                              const PaStreamCallbackTimeInfo* timeInfo,
+                              PaStreamCallbackFlags statusFlags,
+                              void *userData);
+
+    /**
+     * @brief Lease the pools, create the streamers and hand them to the writers.
+     */
+    bool prepareTracks();
+
+    /**
+     * @brief Close the open streams, finish the files and give the pools back.
+     * @return false if a stream or a file didn't close cleanly (reported).
+     */
+    bool closeAll();
+
+public:
+    /**
+     * @brief Check the streams and tracks, allocate the shared pools, queues and writers.
+     *
+     * @note call `isValid()` right after construction, the errors went to `handler`.
+     */
+    MultiRecorder(const InitMultiRecordInfo& info, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Stops a running recording.
+     */
+    ~MultiRecorder();
+
+    MultiRecorder(const MultiRecorder&) = delete;
+    MultiRecorder& operator=(const MultiRecorder&) = delete;
+
+    /// @brief Whether construction succeeded.
+    bool isValid() const noexcept {
+        return mValid;
+    }
+
+    /**
+     * @brief Open every device and start recording a new file per track.
+     *
+     * Returns once all the streams run. Nothing is left open if one of them fails.
+     * @return false if a device or a file can't be opened (reported).
+     */
+    bool start();
+
+    /**
+     * @brief Stop the callbacks, wait for the writers to flush and close every file.
+     *
+     * Takes about one buffer plus the audio still queued.
+     * @return false if a stream or a file failed to close (reported).
+     */
+    bool stop();
+
+    /// @brief Between start() and stop().
+    bool isRecording() const noexcept {
+        return mRecording;
+    }
+
+    /// @brief Tracks of all the streams, in stream then track order.
+    size_t trackCount() const noexcept {
+        return mTracks.size();
+    }
+
+    /// @brief Device streams.
+    size_t streamCount() const noexcept {
+        return mStreams.size();
+    }
+
+    /**
+     * @brief Counters of a track, see Recorder::stats(). Safe to call while recording.
+     */
+    AJ::io::file_streamer::StreamStats stats(size_t track) const noexcept {
+        return mTracks[track]->pData->pCounters->snapshot();
+    }
+
+    /**
+     * @brief Callback timing of a device stream, see Recorder::callbackProfile().
+     */
+    CallbackProfile callbackProfile(size_t stream) const {
+        return mStreams[stream]->mProfiler.snapshot();
+    }
+
+    /**
+     * @brief File of a track, for the current (or last) take.
+     */
+    const std::string& trackPath(size_t track) const noexcept {
+        return mTracks[track]->mPath;
+    }
+};
+
+}
@@ -1,14 +1,418 @@
-#pragma once 
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+
 #include "portaudio.h"
+
 #include "core/types.h"
+#include "core/constants.h"
 #include "core/error_handler.h"
-#include "audio_io.h"
+#include "core/ring_buffer.h"
+#include "core/buffer_pool.h"
+#include "core/thread_pool.h"
+#include "core/metrics.h"
+#include "core/event_handler.h"
 
+#include "file_io/audio_file.h"
+#include "editing/render_graph.h"
+#include "editing/preview.h"
+#include "audio_io/device.h"
 
 namespace AJ::io::play {
+
+/**
+ * @brief Source of interleaved frames for the Player.
+ *
+ * Only called from the read-ahead thread, never from the audio callback,
+ * so implementations may block on disk or decode.
+ */
+class IPlaySource {
+public:
+    virtual ~IPlaySource() = default;
+
+    /**
+     * @brief Read up to `frames` interleaved frames (one sample per output channel) into `out`.
+     * @return frames written, fewer than asked when the data isn't available (yet).
+     */
+    virtual size_t read(float *out, size_t frames) = 0;
+
+    /**
+     * @brief Move the read position to a frame.
+     * @return false if the source can't seek.
+     */
+    virtual bool seek(sample_pos frame) = 0;
+
+    /**
+     * @brief Whether every frame of the source was read.
+     */
+    virtual bool finished() const = 0;
+
+    /**
+     * @brief Sample rate of the source in Hz (0 if unknown).
+     */
+    virtual int samplerate() const = 0;
+};
+
+/**
+ * @brief Plays an in-memory AudioFile, interleaved to the output channel count
+ * (mono is duplicated to stereo, stereo is averaged to mono).
+ *
+ * A reversed source plays the file backwards without touching it: every read interleaves
+ * the frames before the position, counted from the end, and reverses the block it wrote.
+ * Positions (seek(), the player position) are then counted in played order, frame 0 is
+ * the last frame of the file.
+ */
+class AudioFileSource : public IPlaySource {
+    std::shared_ptr<AJ::io::AudioFile> pFile; ///< file to play.
+    uint8_t mChannels;                       ///< output channels.
+    bool mReversed;                          ///< play from the last frame to the first.
+    size_t mPosition = 0;                    ///< next frame to read, in played order.
+    Float mLeft, mRight;                     ///< widened frames of compact samples.
+
+public:
+    AudioFileSource(std::shared_ptr<AJ::io::AudioFile> file, uint8_t channels, bool reversed = false) :
+        pFile(std::move(file)), mChannels(channels), mReversed(reversed) {}
+
+    size_t read(float *out, size_t frames) override;
+    bool seek(sample_pos frame) override;
+    bool finished() const override;
+
+    int samplerate() const override {
+        return static_cast<int>(pFile->mInfo.samplerate);
+    }
+
+    /**
+     * @brief Number of frames of the file.
+     */
+    size_t length() const noexcept {
+        return pFile->channelFrames();
+    }
+
+    /**
+     * @brief Whether the file is played backwards.
+     */
+    bool reversed() const noexcept {
+        return mReversed;
+    }
+};
+
+/**
+ * @brief Plays buffers streamed through a Queue (e.g. filled by FileStreamer::read()),
+ * every consumed buffer goes back to its BufferPool.
+ *
+ * The stream can't seek, it is finished once `doneFlag` is set and the queue is drained.
+ */
+class StreamSource : public IPlaySource {
+    std::shared_ptr<AJ::utils::Queue> pQueue;           ///< filled buffers.
+    std::shared_ptr<AJ::utils::BufferPool> pBufferPool; ///< pool the buffers go back to.
+    LFControlFlagPtr pDoneFlag;                         ///< set by the producer after its last buffer.
+    AJ::error::IErrorHandler& mErrHandler;               ///< handler of the pool push.
+    int mSamplerate;                                    ///< sample rate of the stream.
+
+    AJ::utils::Buffer* pCurrent = nullptr;              ///< buffer being consumed.
+    size_t mOffset = 0;                                 ///< frames of pCurrent already consumed.
+
+public:
+    StreamSource(std::shared_ptr<AJ::utils::Queue> queue, std::shared_ptr<AJ::utils::BufferPool> pool,
+        LFControlFlagPtr doneFlag, int samplerate, AJ::error::IErrorHandler& handler) :
+        pQueue(std::move(queue)), pBufferPool(std::move(pool)), pDoneFlag(std::move(doneFlag)),
+        mErrHandler(handler), mSamplerate(samplerate) {}
+
+    ~StreamSource() override;
+
+    size_t read(float *out, size_t frames) override;
+
+    bool seek(sample_pos frame) override {
+        return false;
+    }
+
+    bool finished() const override;
+
+    int samplerate() const override {
+        return mSamplerate;
+    }
+};
+
+/**
+ * @brief Plays a file's render graph: the deferred effects are rendered as the frames are read
+ * (see AJ_Engine::setDeferredEffects()), interleaved like AudioFileSource.
+ *
+ * A failing effect is reported to `handler` and ends the read.
+ */
+class RenderGraphSource : public IPlaySource {
+    std::shared_ptr<AJ::editing::render_graph::RenderGraph> pGraph; ///< graph to render.
+    uint8_t mChannels;                                               ///< output channels.
+    int mSamplerate;                                                 ///< sample rate of the file.
+    AJ::error::IErrorHandler& mErrHandler;                           ///< handler of the effects.
+    size_t mPosition = 0;                                            ///< next frame to read.
+    Float mLeft, mRight;                                             ///< rendered planar frames.
+
+public:
+    RenderGraphSource(std::shared_ptr<AJ::editing::render_graph::RenderGraph> graph, uint8_t channels,
+        int samplerate, AJ::error::IErrorHandler& handler) :
+        pGraph(std::move(graph)), mChannels(channels), mSamplerate(samplerate), mErrHandler(handler) {}
+
+    size_t read(float *out, size_t frames) override;
+    bool seek(sample_pos frame) override;
+    bool finished() const override;
+
+    int samplerate() const override {
+        return mSamplerate;
+    }
+};
+
+/**
+ * @brief Plays a preview renderer (see AJ_Engine::createPreview()), interleaved like AudioFileSource.
+ *
+ * Every read moves the renderer's playhead, so the background render follows what is heard.
+ * quality() tells whether the last frames read were provisional. A failing effect is reported
+ * to `handler` and ends the read.
+ */
+class PreviewSource : public IPlaySource {
+    std::shared_ptr<AJ::editing::preview::PreviewRenderer> pPreview; ///< renderer to play.
+    uint8_t mChannels;                                               ///< output channels.
+    int mSamplerate;                                                 ///< sample rate of the file.
+    AJ::error::IErrorHandler& mErrHandler;                           ///< handler of the effects.
+    size_t mPosition = 0;                                            ///< next frame to read.
+    Float mLeft, mRight;                                             ///< rendered planar frames.
+    std::atomic<AJ::editing::preview::Quality> mQuality{AJ::editing::preview::Quality::Full};
+
+public:
+    PreviewSource(std::shared_ptr<AJ::editing::preview::PreviewRenderer> preview, uint8_t channels,
+        int samplerate, AJ::error::IErrorHandler& handler) :
+        pPreview(std::move(preview)), mChannels(channels), mSamplerate(samplerate), mErrHandler(handler) {}
+
+    size_t read(float *out, size_t frames) override;
+    bool seek(sample_pos frame) override;
+    bool finished() const override;
+
+    int samplerate() const override {
+        return mSamplerate;
+    }
+
+    /**
+     * @brief Quality of the last block read (readable from any thread).
+     */
+    AJ::editing::preview::Quality quality() const noexcept {
+        return mQuality.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Play / pause state of the Player.
+ */
+enum class Transport : uint8_t {
+    Playing, ///< the callback plays from the ring.
+    Paused   ///< the callback outputs silence, the ring stays filled.
+};
+
+/**
+ * @brief Initialization info required to set up a Player instance.
+ */
+struct InitPlayInfo {
+    int mSamplerate = 44100;   ///< Stream sample rate in Hz, used when the source doesn't report one.
+    uint8_t mChannels = 2;     ///< Number of output channels (1 = mono, 2 = stereo).
+    size_t mFramesPerBuffer = kPlayFramesPerBuffer; ///< Frames per output callback.
+    size_t mPrefetchFrames = kPlayPrefetchFrames;   ///< Read-ahead depth (ring size, rounded up to a power of two).
+    size_t mReadBlockFrames = kPlayReadBlockFrames; ///< Frames read from the source per step.
+    AJ::io::device::DeviceSelection mDevice;        ///< Output device, host API and suggested latency.
+
+    LFControlFlagPtr pStopFlag; ///< Lock-free stop flag used to control playback state.
+    std::shared_ptr<AJ::utils::ThreadPool> pThreadPool; ///< Thread pool used for the read-ahead task.
+    std::shared_ptr<AJ::utils::MetricsRegistry> pMetrics; ///< Engine metrics the callback updates (optional).
+};
+
+/**
+ * @brief Playback counters, see Player::stats().
+ */
+struct PlayStats {
+    uint64_t callbacks = 0;     ///< output callbacks.
+    uint64_t underruns = 0;     ///< callbacks that found less than a full buffer in the ring.
+    uint64_t underrunFrames = 0;///< frames replaced by silence because of underruns.
+    uint64_t framesPlayed = 0;  ///< frames copied to the device.
+    uint64_t seeks = 0;         ///< seeks served.
+};
+
+/**
+ * @brief State shared by the output callback, the read-ahead thread and the control thread.
+ *
+ * Everything is lock-free:
+ * - the ring is SPSC, the read-ahead thread produces and the callback consumes.
+ * - seek: the control thread publishes a target and bumps mSeekRequest. The read-ahead thread
+ *   stops producing and forwards it as a flush request, the callback empties the ring, moves the
+ *   position and acknowledges in mFlushed, then the read-ahead thread seeks the source and refills.
+ * - while mBuffering is set (start / after a seek) the callback outputs silence without counting underruns.
+ */
+class PlayData {
+public:
+    AJ::utils::RingBuffer mRing; ///< read-ahead frames.
+    LFControlFlagPtr pStopFlag;  ///< Stop flag controlling playback lifecycle.
+
+    alignas(CACHE_LINE_SIZE) std::atomic<Transport> mTransport{Transport::Playing}; ///< play / pause.
+    std::atomic<sample_pos> mSeekTarget{0};     ///< requested frame (control thread).
+    std::atomic<uint64_t> mSeekRequest{0};      ///< seek generation (control thread).
+
+    alignas(CACHE_LINE_SIZE) std::atomic<sample_pos> mFlushTarget{0}; ///< frame the ring restarts at (read-ahead thread).
+    std::atomic<uint64_t> mFlushRequest{0};     ///< flush generation (read-ahead thread).
+    std::atomic<bool> mBuffering{true};         ///< ring is being (re)filled (read-ahead thread).
+    std::atomic<bool> mSourceDone{false};       ///< the source has no more frames (read-ahead thread).
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> mFlushed{0}; ///< flush generation served (callback).
+    std::atomic<sample_pos> mPosition{0};       ///< frame of the next output sample (callback).
+    std::atomic<uint64_t> mCallbacks{0};
+    std::atomic<uint64_t> mUnderruns{0};
+    std::atomic<uint64_t> mUnderrunFrames{0};
+    std::atomic<uint64_t> mFramesPlayed{0};
+    std::atomic<uint64_t> mSeeks{0};
+
+    std::shared_ptr<AJ::utils::MetricsRegistry> pMetrics; ///< Engine metrics (may be null).
+
+    PlayData(size_t prefetch_frames, uint8_t channels, AJ::error::IErrorHandler& handler) :
+        mRing(prefetch_frames, channels, handler) {}
+
+    /**
+     * @brief Fill `out` with `frames` frames (the body of the output callback).
+     *
+     * Wait-free: copies out of the ring, zero fills what's missing.
+     * @return false once the source is finished and the ring is empty.
+     */
+    bool render(float *out, size_t frames) noexcept;
+};
+
+/**
+ * @brief Core class responsible for managing audio playback.
+ *
+ * A read-ahead task on the thread pool pulls frames from an IPlaySource into the
+ * SPSC RingBuffer, the PortAudio output callback only copies out of the ring
+ * (no locks, no allocation, no disk). Transport (pause / resume / seek) is
+ * lock-free and can be driven from any thread, e.g. the event handler, while play() runs.
+ *
+ * Playback ends when the source is finished or the stop flag is set.
+ *
+ * @note this functionality requires at least two threads available in the thread pool,
+ *       one for the read-ahead and one available to the Event Handler.
+ */
 class Player {
+    int mSamplerate;                       ///< stream sample rate used when the source reports none.
+    uint8_t mChannels;                     ///< output channels.
+    size_t mFramesPerBuffer;               ///< frames per callback.
+    size_t mReadBlockFrames;               ///< frames read from the source per step.
+    AJ::io::device::DeviceSelection mDevice; ///< output device opened by play().
+    PaStream* mStream = nullptr;           ///< PortAudio stream pointer.
+    std::shared_ptr<AJ::io::device::PortAudioSession> pPortAudio; ///< Held from the first play() on.
+
+    std::shared_ptr<PlayData> pPlayData;   ///< state shared with the callback.
+    std::shared_ptr<IPlaySource> pSource;  ///< frames to play.
+
+    LFControlFlagPtr pStopFlag;            ///< Stop flag for controlling playback lifecycle.
+    std::shared_ptr<AJ::utils::ThreadPool> pThreadPool; ///< Thread pool for async tasks.
+
+    std::future<void> mReaderDone;         ///< Completion of the read-ahead task.
+    uint64_t mSeekServed = 0;              ///< last seek request served (read-ahead thread).
+    std::atomic<bool> mPlaying{false};     ///< play() is running.
+
+private:
+    /**
+     * @brief Open the output stream.
+     * @return True if initialization succeeds, false otherwise.
+     */
+    bool initPlayer(AJ::error::IErrorHandler& errHandler);
+
+    /**
+     * @brief PortAudio callback, copies the next frames out of the ring (see PlayData::render()).
+     */
+    static int playCallback(const void *inputBuffer, void *outputBuffer,
+                           unsigned long framesPerBuffer,
+                           const PaStreamCallbackTimeInfo* timeInfo,
+                           PaStreamCallbackFlags statusFlags,
+                           void *userData);
+
+    /**
+     * @brief Background task keeping the ring filled from the source, serves seeks.
+     */
+    void readAhead();
+
+    /**
+     * @brief Serve a pending seek request (read-ahead thread).
+     */
+    void serveSeek(uint64_t request);
 
 public:
-    bool play(AJ::error::IErrorHandler& errHandler, AJ::io::IEventHandler& evHandler);
-};    
-}
\ No newline at end of file
+    /**
+     * @brief Construct a Player.
+     *
+     * @param info Initialization parameters (resources, channels, prefetch depth, etc.).
+     * @param handler Error handler for reporting failures.
+     */
+    Player(InitPlayInfo& info, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Whether the ring was allocated.
+     */
+    bool isValid() const noexcept {
+        return pPlayData && pPlayData->mRing.isValid();
+    }
+
+    /**
+     * @brief Set the source of the next play() (not while playing).
+     */
+    bool setSource(std::shared_ptr<IPlaySource> source, AJ::error::IErrorHandler& errHandler);
+
+    /**
+     * @brief Play the source with a given event handler (blocking).
+     *
+     * Prefetches the ring, starts the output stream and invokes the event handler,
+     * which is responsible for stopping the playback by setting the stop flag
+     * (playback also ends by itself at the end of the source).
+     *
+     * @param errHandler Error handler for reporting failures.
+     * @param evHandler Event handler used for handling UI/interaction logic.
+     * @return True if playback ran successfully, false otherwise.
+     */
+    bool play(AJ::error::IErrorHandler& errHandler, AJ::utils::IEventHandler& evHandler);
+
+    /**
+     * @brief Output silence, keep the ring filled.
+     */
+    void pause() noexcept {
+        pPlayData->mTransport.store(Transport::Paused, std::memory_order_release);
+    }
+
+    /**
+     * @brief Continue after pause().
+     */
+    void resume() noexcept {
+        pPlayData->mTransport.store(Transport::Playing, std::memory_order_release);
+    }
+
+    /**
+     * @brief Current transport state.
+     */
+    Transport transport() const noexcept {
+        return pPlayData->mTransport.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Continue playing from a frame (lock-free, the last request wins).
+     */
+    void seek(sample_pos frame) noexcept {
+        pPlayData->mSeekTarget.store(std::max<sample_pos>(frame, 0), std::memory_order_relaxed);
+        pPlayData->mSeekRequest.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Frame of the next output sample.
+     */
+    sample_pos position() const noexcept {
+        return pPlayData->mPosition.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Counters of the current (or last) playback, safe to call while playing.
+     */
+    PlayStats stats() const noexcept;
+};
+
+}
@@ -1,5 +1,11 @@
 #pragma once 
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "portaudio.h"
 
@@ -8,12 +14,30 @@
 #include "core/ring_buffer.h"
 #include "core/buffer_pool.h"
 #include "core/thread_pool.h"
+#include "core/metrics.h"
 #include "core/event_handler.h"
+#include "core/realtime.h"
+#include "core/thread_placement.h"
 
 #include "file_io/file_streamer.h"
+#include "dsp/effect_chain.h"
+#include "audio_io/callback_profiler.h"
+#include "audio_io/device.h"
 
 namespace AJ::io::record {
 
+/**
+ * @brief What the record callback does with a block when the buffer pool is empty.
+ *
+ * The callback never waits: it holds a few emergency reserve buffers (InitRecordInfo::mReserveBuffers)
+ * taken from the pool before the stream starts and topped up again whenever the pool has spare buffers.
+ */
+enum class OverflowPolicy : uint8_t {
+    DropNewest, ///< drop the incoming block, everything already queued gets written.
+    DropOldest, ///< keep the incoming block (reserve buffer) and have the disk writer discard the oldest queued block.
+    Reserve     ///< keep the incoming block in a reserve buffer, drop it only once the reserve is used up.
+};
+
 /**
  * @brief Initialization info required to set up a Recorder instance.
  *
@@ -26,11 +50,22 @@ struct InitRecordInfo {
     int mSamplerate;   ///< Recording sample rate in Hz.
     uint8_t mChannels; ///< Number of audio channels (1 = mono, 2 = stereo, etc.).
     std::string mSessionDirectory; ///< Directory where recorded session files will be stored.
+    size_t mFramesPerBuffer = 0;   ///< Frames per input callback, 0 = BUFFER_SECONDS worth.
+    AJ::io::device::DeviceSelection mDevice; ///< Input device, host API and suggested latency.
 
     LFControlFlagPtr pStopFlag; ///< Lock-free stop flag used to control recording state.
     std::shared_ptr<AJ::utils::ThreadPool> pThreadPool; ///< Thread pool used for background tasks (e.g., disk writing).
     std::shared_ptr<AJ::utils::BufferPool> pBufferPool; ///< Buffer pool for audio data storage.
     std::shared_ptr<AJ::utils::Queue> pQueue; ///< Queue for transferring audio buffers between threads.
+
+    OverflowPolicy mOverflowPolicy = OverflowPolicy::Reserve; ///< What to do with a block when the pool is empty.
+    size_t mReserveBuffers = 4; ///< Emergency buffers held by the callback (at most kRecordReserveMax).
+
+    AJ::io::file_streamer::WriteOptions mWriteOptions; ///< Format of the recorded file and how it's written.
+
+    std::shared_ptr<AJ::utils::MetricsRegistry> pMetrics; ///< Engine metrics the callback and the writer update (optional).
+
+    AJ::utils::ThreadPlacement mWriterPlacement; ///< Cores and priority of the disk writer thread (default: unchanged).
 };
 
 /**
@@ -43,21 +78,27 @@ class AudioMetaData {
 public:
     int samplerate;                ///< Recording sample rate.
     uint8_t channels;              ///< Number of channels.
-    size_t frames_per_buffer;      ///< Frames per buffer (derived from buffer size and channels).
+    size_t frames_per_buffer;      ///< Frames per input callback.
     
-    PaStream* stream;              ///< PortAudio stream pointer.
+    PaStream* stream = nullptr;    ///< PortAudio stream pointer.
 
     size_t mBufferSizePerChan;     ///< Buffer size per channel.
     std::string mSessionDirectory; ///< Directory for storing session files.
+    AJ::io::device::DeviceSelection mDevice; ///< Input device opened by the recorder.
+
+    bool mMonitor = false;         ///< Open a duplex stream and play the monitored input (see Recorder::setMonitor()).
+    AJ::io::device::DeviceSelection mMonitorDevice; ///< Output device of the monitor.
 
     AudioMetaData(){}
 
     /**
      * @brief Construct metadata with a given sample rate.
      * @param rate The sample rate in Hz.
+     * @param frames Frames per callback, 0 = BUFFER_SECONDS worth.
      */
-    AudioMetaData(int rate): samplerate(rate) {
-        mBufferSizePerChan = samplerate * BUFFER_SECONDS;    
+    AudioMetaData(int rate, size_t frames = 0): samplerate(rate) {
+        mBufferSizePerChan = frames ? frames : static_cast<size_t>(samplerate * BUFFER_SECONDS);
+        frames_per_buffer = mBufferSizePerChan;
     }
 };
 
@@ -66,6 +107,9 @@ public:
  *
  * Stores buffer pool, queue, stop flag, and error handler references for
  * managing audio data during port audio callback.
+ *
+ * The reserve, the spare buffer, the counters and the profiler are only touched by the
+ * callback while the stream runs (the counters are atomics, readable at any time).
  */
 class AudioData {
 public:
@@ -74,6 +118,23 @@ public:
     LFControlFlagPtr pStopFlag;                         ///< Stop flag controlling recording lifecycle.
     AJ::error::IErrorHandler& errHandler;               ///< Error handler reference for reporting errors.
 
+    std::shared_ptr<AJ::io::file_streamer::StreamCounters> pCounters; ///< Counters shared with the disk writer.
+    std::shared_ptr<AJ::utils::MetricsRegistry> pMetrics; ///< Engine metrics (may be null).
+    CallbackProfiler mProfiler;                         ///< Deadline, xruns and queue depth of the callbacks.
+    OverflowPolicy mPolicy = OverflowPolicy::Reserve;   ///< Overflow policy of the callback.
+
+    std::array<AJ::utils::Buffer*, kRecordReserveMax> mReserve{}; ///< Emergency buffers.
+    size_t mReserveCount = 0;                           ///< Buffers currently in the reserve.
+    size_t mReserveSize = 0;                            ///< Target size of the reserve.
+
+    AJ::utils::Buffer* pSpare = nullptr;                ///< Buffer of a block the queue rejected, reused first.
+
+    uint8_t mChannels = 0;                              ///< Interleaved channels of the input and the monitor output.
+    std::shared_ptr<AJ::dsp::EffectChain> pMonitorChain; ///< Effects of the monitor path (null or empty = dry).
+    std::unique_ptr<AJ::dsp::EffectState> pMonitorState; ///< State of pMonitorChain, created before the stream starts.
+    AJ::error::CountingErrorHandler mMonitorErrors;     ///< Errors of the chain, counted only.
+    bool mMonitorBypassed = false;                      ///< Chain failed once, the dry input is played from then on.
+
     AudioData() = default;
 
     /**
@@ -88,19 +149,61 @@ public:
         pBufferPool = pool;
         pQueue = queue;
         pStopFlag = stopFlag;
+        pCounters = std::make_shared<AJ::io::file_streamer::StreamCounters>();
     }
+
+    /**
+     * @brief Next free buffer for the callback: the spare one, the pool, then the reserve.
+     *
+     * Realtime safe, never blocks or reports.
+     * @return a buffer, or nullptr if the block must be dropped.
+     */
+    AJ::utils::Buffer* acquire() noexcept;
+
+    /**
+     * @brief Queue a filled buffer for the disk writer and count it.
+     *
+     * A buffer the queue rejects is kept for the next acquire(), a null buffer (nothing
+     * acquired) is counted as dropped. Realtime safe.
+     */
+    void commit(AJ::utils::Buffer* buffer) noexcept;
+
+    /**
+     * @brief Fill the reserve up to mReserveSize from the pool (before the stream starts).
+     */
+    void fillReserve() noexcept;
+
+    /**
+     * @brief Give the reserve and the spare buffer back to the pool (after the stream stopped).
+     */
+    void releaseReserve();
+
+    /**
+     * @brief Write the input of a duplex callback, through the monitor chain, to its output.
+     *
+     * Realtime safe as long as the chain is (block processing, state created beforehand).
+     * A null input plays silence. If the chain fails the block is played dry, the failure is
+     * counted (Counter::MonitorFailures) and the chain is bypassed until the next recording.
+     * @param output interleaved, `frames * mChannels` floats.
+     * @param input  interleaved, `frames * mChannels` floats, or nullptr.
+     */
+    void monitor(float *output, const float *input, size_t frames) noexcept;
 };
 
 /**
  * @brief Core class responsible for managing audio recording.
  *
- * The Recorder sets up audio metadata, manages buffers and queues,
- * initializes the PortAudio stream, and spawns background disk writer tasks
- * using the thread pool. Recording is stopped by toggling the stop flag
- * provided in InitRecordInfo.
- * 
- * @note this functionality requires at least two threads available in the thread pool,
- *       one for disk writer and one available to the Event Handler.
+ * The Recorder sets up audio metadata, manages buffers and queues and
+ * initializes the PortAudio stream. Recording is stopped by toggling the stop
+ * flag provided in InitRecordInfo.
+ *
+ * PortAudio stays initialized and a disk writer thread stays parked for the lifetime of
+ * the Recorder, so record() only opens the stream and the file. The writer signals the file
+ * is open before the stream starts: no polling or sleeps between record() and the first
+ * captured block. arm() starts the stream ahead of record() and keeps the last
+ * setPreroll() seconds, which start the file.
+ *
+ * @note the event handler may use one thread of the thread pool, the writer doesn't take any.
  */
 class Recorder {
     AudioMetaData mAudioInfo;                   ///< Audio metadata for current recording session.
@@ -111,6 +214,29 @@ class Recorder {
 
     std::shared_ptr<AJ::io::file_streamer::FileStreamer> pStreamer; ///< File streamer for writing audio to disk.
 
+    std::shared_ptr<AJ::io::device::PortAudioSession> pPortAudio; ///< Held from the first record() or arm() on.
+    std::unique_ptr<AJ::utils::RealtimeGuard> pGuard; ///< While a stream is open (AJ_REALTIME_GUARD builds).
+
+    /// @brief What the disk writer thread does.
+    enum class WriterState : uint8_t {
+        Idle,       ///< parked, nothing open.
+        Holding,    ///< armed: keeps the pre-roll, the rest goes back to the pool.
+        Writing,    ///< a take: the file is open until the stop flag.
+        Exit        ///< the Recorder is destroyed.
+    };
+
+    std::thread mWriter;                        ///< The disk writer, reserved for this Recorder.
+    AJ::utils::ThreadPlacement mWriterPlacement; ///< Applied by the writer when it starts.
+    std::mutex mWriterMux;
+    std::condition_variable mWriterWake;        ///< State changes, both ways.
+    WriterState mWriterState = WriterState::Idle;
+    bool mWriterParked = false;                 ///< The writer is waiting in Idle.
+    std::promise<bool> mWriterReady;            ///< File open (pre-roll written) or failed, per take.
+    std::promise<bool> mWriterDone;             ///< endWrite() result, per take.
+
+    size_t mPrerollBuffers = 0;                 ///< Blocks kept while armed.
+    bool mArmed = false;                        ///< The stream runs ahead of record().
+
 private:
     /**
      * @brief Initialize the recorder and prepare the audio stream.
@@ -119,12 +245,29 @@ private:
      */
     bool initRecorder();
 
+    /**
+     * @brief Open the stream and reset the per take state (counters, reserve, monitor).
+     */
+    bool prepare();
+
+    /**
+     * @brief Stop and close the stream, park the writer and give every buffer back.
+     */
+    void abort();
+
     /**
      * @brief PortAudio callback for capturing input audio buffers.
      *
      * Called by PortAudio when new audio data is available.
      * The input data is copied into a buffer obtained from the buffer pool,
      * then pushed into the queue for consumption by the disk writer thread.
+     *
+     * Realtime safe: never waits, allocates or reports errors. When the pool or the
+     * queue is exhausted the overflow policy applies and the event is counted (see stats()).
+     * Its duration, status flags and the queue depth it leaves go to the profiler (see callbackProfile()).
+     *
+     * On a duplex stream (setMonitor()) the same input is then played through the monitor chain,
+     * one buffer later than it was captured.
      */
     static int recordCallback(const void *inputBuffer, void *outputBuffer,
                            unsigned long framesPerBuffer,
@@ -133,12 +276,21 @@ private:
                            void *userData);
 
     /**
-     * @brief Background task for writing audio data to disk.
-     * 
-     * Retrieves a buffer from the queue when available,
-     * writes its contents to disk, and then returns the buffer to the pool.
+     * @brief Loop of the disk writer thread, see WriterState.
      */
     void diskWriter();
+
+    /**
+     * @brief Move the writer to `state` (Idle waits until it's parked).
+     */
+    void setWriterState(WriterState state);
+
+    /**
+     * @brief Start a take on the writer.
+     * @param done set to the endWrite() result of the take.
+     * @return set once the file is open and the pre-roll written, false if it couldn't be opened.
+     */
+    std::future<bool> startWriting(std::future<bool> &done);
     
 public:
     /**
@@ -148,45 +300,128 @@ public:
      * @param handler Error handler for reporting failures.
      */
     Recorder(InitRecordInfo& info, AJ::error::IErrorHandler& handler){
-        mAudioInfo = AudioMetaData(info.mSamplerate);
+        mAudioInfo = AudioMetaData(info.mSamplerate, info.mFramesPerBuffer);
         mAudioInfo.channels = info.mChannels;
         mAudioInfo.mSessionDirectory = info.mSessionDirectory;
-
-        size_t size = mAudioInfo.mBufferSizePerChan * mAudioInfo.channels;
-        mAudioInfo.frames_per_buffer = size;
+        mAudioInfo.mDevice = info.mDevice;
 
         pStopFlag = info.pStopFlag;
         pThreadPool = info.pThreadPool;
 
         pAudioData = std::make_shared<AudioData>(info.pBufferPool, info.pQueue, info.pStopFlag, handler);
-        
+        pAudioData->mPolicy = info.mOverflowPolicy;
+        pAudioData->mReserveSize = std::min(info.mReserveBuffers, kRecordReserveMax);
+        pAudioData->pMetrics = info.pMetrics;
+        pAudioData->mProfiler.setSamplerate(info.mSamplerate);
+        pAudioData->mChannels = info.mChannels;
+
         pStreamer = std::make_shared<AJ::io::file_streamer::FileStreamer>(
             info.pQueue, info.pBufferPool, info.pStopFlag,
             AJ::FileStreamingTypes::recording, info.mSessionDirectory
         );
+        pStreamer->setCounters(pAudioData->pCounters);
+        pStreamer->setMetrics(info.pMetrics);
+        pStreamer->setWriteOptions(info.mWriteOptions);
 
         AJ::AudioWriteInfo write_info;
         write_info.channels = info.mChannels;
         write_info.samplerate = info.mSamplerate;
 
         pStreamer->setWriteInfo(write_info, handler);
+
+        mWriterPlacement = info.mWriterPlacement;
+        mWriter = std::thread([this](){ diskWriter(); });
     }
 
+    /**
+     * @brief Disarm and join the disk writer.
+     */
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
     /**
      * @brief Begin recording process with a given event handler.
      *
      * Starts the recording stream and invokes the event handler to handle
      * user interaction (e.g., console timer, GUI, etc.).
      *
-     * At least one thread is guaranteed to be available in the thread pool
-     * for the handler to use if needed. The handler is also responsible for
-     * stopping the recording by setting the stop flag to true.
+     * The stream starts as soon as the writer has the file open, unarmed the first
+     * captured sample is the first of the file. Armed (arm()), the file starts with the
+     * pre-roll and continues without a gap.
+     * The handler is responsible for stopping the recording by setting the stop flag to true.
      *
      * @param evHandler Event handler used for handling UI/interaction logic.
      * 
      * @return True if recording starts successfully, false otherwise.
      */
     bool record(AJ::utils::IEventHandler& evHandler);
+
+    /**
+     * @brief Start capturing before record(), keeping the last setPreroll() seconds.
+     *
+     * Nothing is written until record(), the older blocks go straight back to the pool.
+     * @return false if the stream can't be opened or started (reported).
+     */
+    bool arm();
+
+    /**
+     * @brief Stop an armed stream without recording, the pre-roll is dropped.
+     */
+    void disarm();
+
+    /// @brief Between arm() and record() or disarm().
+    bool isArmed() const noexcept {
+        return mArmed;
+    }
+
+    /**
+     * @brief Audio an armed recorder keeps before record(), rounded up to whole callbacks.
+     *
+     * The pre-roll is held in pool buffers: it may take at most half of the pool.
+     * @param seconds 0 turns pre-roll off.
+     * @return false if armed or the pool is too small (reported).
+     */
+    bool setPreroll(double seconds, AJ::error::IErrorHandler& handler);
+
+    /// @brief Blocks of pre-roll, see setPreroll().
+    size_t prerollBuffers() const noexcept {
+        return mPrerollBuffers;
+    }
+
+    /**
+     * @brief Monitor the input while recording, through an effect chain.
+     *
+     * The next record() opens one full-duplex stream: every callback queues its input for
+     * disk as usual, then runs the chain on a copy and plays it on `output`. The chain runs
+     * with processBlock() inside the callback, so every stage must support block processing;
+     * its state is created and the chain run once on silence here, not on the audio thread.
+     * Added latency is one buffer (InitRecordInfo::mFramesPerBuffer). Call it before record().
+     *
+     * @param chain   effects of the monitor path, an empty chain monitors dry, nullptr turns monitoring off.
+     * @param output  output device the monitor plays on.
+     * @param handler Error handler (recording, chain without block processing).
+     * @return false if the chain can't run in the callback.
+     */
+    bool setMonitor(std::shared_ptr<AJ::dsp::EffectChain> chain,
+        const AJ::io::device::DeviceSelection &output, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Counters of the current (or last) recording: blocks written, dropped,
+     * pool exhaustion, reserve use and discarded blocks. Safe to call while recording.
+     */
+    AJ::io::file_streamer::StreamStats stats() const noexcept {
+        return pAudioData->pCounters->snapshot();
+    }
+
+    /**
+     * @brief Callback durations against their deadline, input xruns, queue depth and the
+     * slowest callbacks of the current (or last) recording. Safe to call while recording.
+     */
+    CallbackProfile callbackProfile() const {
+        return pAudioData->mProfiler.snapshot();
+    }
 };    
 
 }
@@ -1,16 +1,27 @@
 #pragma once
-#include <stack>
-
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "file_io/audio_file.h"
+#include "file_io/decode_cache.h"
+#include "file_io/wav_stream_writer.h"
 #include "dsp/reverb/reverb.h"
 #include "dsp/echo.h"
 #include "dsp/gain.h"
+#include "dsp/effect_chain.h"
+#include "dsp/effect_registry.h"
+#include "dsp/kernels.h"
+#include "editing/render_graph.h"
+#include "editing/preview.h"
 
 #include "core/error_handler.h"
 #include "core/effect_params.h"
+#include "core/engine_resources.h"
 
 
 #include "undo_system/state.h"
@@ -20,23 +31,73 @@ using Audio = std::shared_ptr<AJ::io::AudioFile>;
 
 namespace AJ {
 
-// TODO: cut, insert and mixing will have special APIs not like the applyEffect API
-class AJ_Engine {
+/**
+ * @brief Options controlling how the multi-channel / multi-file applyEffect overloads run.
+ */
+struct ParallelOptions {
+    /**
+     * @brief Run channels of a file and files of a batch as tasks on the
+     * EngineResources thread pool. If false (or no EngineResources were set)
+     * everything runs sequentially on the calling thread.
+     */
+    bool enabled = false;
 
-    // TODO: this stack may be moved to the UndoSystem class.
     /**
-     * @brief Stack of saved undo states.
-     *
-     * Each state represents a snapshot of the system before a change was made.
-     * Used to implement undo functionality by restoring previous states.
+     * @brief Maximum number of tasks running at the same time (including the calling thread).
+     * 0 means one per thread of the pool. Also caps the pieces a split range is cut into.
      */
-    std::stack<AJ::undo::State> mStates;
+    size_t maxConcurrentTasks = 0;
+};
+
+/**
+ * @brief Settings of AJ_Engine::processFile().
+ */
+struct FileProcessOptions {
+    /// @brief Frames per block read, processed and written.
+    size_t blockFrames = kProcessFileBlockFrames;
+
+    /// @brief Blocks in flight between the reader and the chain (the reader waits when they're all taken).
+    size_t inflightBlocks = kProcessFileInflightBlocks;
+
+    /// @brief Coalesced writer of the output, RF64 by default: the output may be past 4 GiB.
+    io::WavStreamOptions stream{ kStreamWriteBatchBytes, false, true, 0 };
+};
+
+/**
+ * @brief Outcome of AJ_Engine::loadAudioAsync(): the file, or nullptr and the errors of the load.
+ */
+struct LoadResult {
+    std::shared_ptr<io::AudioFile> audio;
+    error::CollectingErrorHandler errors; ///< reported by the worker, replay() them into the caller's handler.
+};
+
+/**
+ * @brief Outcome of AJ_Engine::saveAudioAsync().
+ */
+struct SaveResult {
+    bool success = false;
+    error::CollectingErrorHandler errors; ///< reported by the worker, replay() them into the caller's handler.
+};
+
+/**
+ * @brief Limits of a batch of AJ_Engine::loadAudioAsync().
+ */
+struct AsyncLoadOptions {
+    /// @brief Files loading at the same time, 0 = one per I/O worker.
+    size_t maxInFlight = kAsyncLoadInFlight;
+
+    /// @brief Decoded bytes of the files loading at the same time. A larger file still loads, alone.
+    size_t memoryBudget = kAsyncLoadMemoryBudget;
+};
+
+// TODO: cut, insert and mixing will have special APIs not like the applyEffect API
+class AJ_Engine {
 
     /**
      * @brief The undo system controller.
      *
-     * Manages state registration, undo operations, and history limits.
-     * Encapsulates the core logic for the undo functionality.
+     * Holds the undo / redo history of the files changed through the engine, see undo::UndoSystem.
+     * A state keeps only the frames an operation replaced.
      */
     AJ::undo::UndoSystem mUndo;
 
@@ -48,12 +109,133 @@ class AJ_Engine {
      * Used by components that maintain reversible state changes.
      */
     bool mUndoSupportEnabled;
+
+    /**
+     * @brief Shared engine resources, used for the thread pool when parallel processing is enabled.
+     */
+    std::shared_ptr<EngineResources> pEngineResources;
+
+    /**
+     * @brief Parallel execution options of the multi-channel / multi-file applyEffect overloads.
+     */
+    ParallelOptions mParallel;
+
+    /**
+     * @brief Factories of the effects applied by applyEffect, with their per-thread instances.
+     */
+    std::shared_ptr<dsp::EffectRegistry> pEffects = std::make_shared<dsp::EffectRegistry>();
+
+    /**
+     * @brief Build the level index of every file loaded by loadAudio(), see io::LevelIndex.
+     */
+    bool mLevelIndexEnabled = false;
+
+    /**
+     * @brief Cache of decoded compressed files used by loadAudio(), nullptr if disabled.
+     */
+    std::shared_ptr<io::DecodeCache> pDecodeCache;
+
+    /**
+     * @brief Record applyEffect() on the files as render graph nodes instead of processing them.
+     */
+    bool mDeferredEffects = false;
+
+    /**
+     * @brief Render graph of every file given to applyEffect() in deferred mode.
+     */
+    std::vector<std::pair<std::weak_ptr<io::AudioFile>, std::shared_ptr<editing::render_graph::RenderGraph>>> mGraphs;
+    mutable std::mutex mGraphsMux;
+
+    /**
+     * @brief Graphs of every deferred applyEffect() call not committed yet, the last call last.
+     */
+    std::vector<std::vector<std::weak_ptr<editing::render_graph::RenderGraph>>> mDeferred;
+
+    /**
+     * @brief The render graph of `audio` if it has effects waiting, nullptr otherwise.
+     */
+    std::shared_ptr<editing::render_graph::RenderGraph> pendingGraph(const std::shared_ptr<io::AudioFile> &audio) const;
+
+    /**
+     * @brief Record `effect` on the render graph of `audio` (deferred mode), see setDeferredEffects().
+     * @return the graph, nullptr (reported) on failure.
+     */
+    std::shared_ptr<editing::render_graph::RenderGraph> deferEffect(const std::shared_ptr<io::AudioFile> &audio,
+        const Effect &effect, std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler);
+
+    /**
+     * @brief Run `count` independent jobs, sequentially or on the thread pool.
+     *
+     * In sequential mode the first failing job stops the run.
+     * In parallel mode at most `mParallel.maxConcurrentTasks` jobs run at once, every job
+     * gets its own CollectingErrorHandler and all jobs run to completion. The collected errors
+     * are replayed into `handler` in job order after all jobs finished.
+     *
+     * @param count number of jobs.
+     * @param job callable `bool(size_t index, IErrorHandler&)`.
+     * @param handler Error handler of the caller.
+     * @return true if every job succeeded.
+     */
+    bool runJobs(size_t count, const std::function<bool(size_t, error::IErrorHandler&)> &job,
+        error::IErrorHandler &handler);
+
+    /**
+     * @brief Create the AudioFile of a path from its extension (or `ext`) and set its path.
+     * @return nullptr (reported) if the format isn't supported or the path is invalid.
+     */
+    std::shared_ptr<io::AudioFile> createAudioFile(const std::string &path, error::IErrorHandler &handler,
+        std::string ext);
+
+    /**
+     * @brief Parameters of `effect` for one file: a LUFS normalization gets a copy carrying the
+     * loudness of all the channels of the range (cached by the level index), other parameters are returned as is.
+     * @return nullptr (reported) if the measurement failed.
+     */
+    std::shared_ptr<dsp::EffectParams> fileParams(io::AudioFile &audio, const Effect &effect,
+        std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler);
+
+    /**
+     * @brief After fileParams() parameters were applied: a LUFS normalization that was a plain gain
+     * moved the loudness by as many dB, the file caches the new loudness of the range.
+     */
+    void keepLoudness(io::AudioFile &audio, const std::shared_ptr<dsp::EffectParams> &applied);
+
+    /// @brief Start time of an effect for noteEffect(), 0 without engine resources.
+    uint64_t effectStart() const noexcept {
+        return pEngineResources ? utils::MetricsRegistry::now() : 0;
+    }
+
+    /**
+     * @brief Count an effect applied to `files` files since `start` in the engine metrics,
+     * as a failure if it didn't succeed.
+     */
+    void noteEffect(uint64_t start, bool success, size_t files) const noexcept;
+
+    /**
+     * @brief Whether the channels of a file run as separate jobs: only in parallel mode, and only
+     * for an effect that doesn't link its channels (dsp::Effect::linksChannels()). Otherwise every
+     * file is a single call to dsp::Effect::process(AudioBuffer&, ...).
+     */
+    bool splitChannels(const Effect &effect, const std::shared_ptr<dsp::EffectParams> &params);
+
+    /**
+     * @brief The thread pool of the engine resources in parallel mode, nullptr otherwise.
+     */
+    std::shared_ptr<utils::ThreadPool> parallelPool() const;
+
+    /**
+     * @brief The I/O pool of the engine resources (loads, saves), nullptr without them.
+     */
+    std::shared_ptr<utils::ThreadPool> ioPool() const;
 public:
     /**
      * @brief Default constructor initializing that enables the undo system.
+     *
+     * Also resolves the SIMD kernel table once for the running CPU.
      */
     AJ_Engine(){
         mUndoSupportEnabled = true;
+        dsp::kernels::init();
     }
 
     /**
@@ -69,6 +251,11 @@ public:
      * The effect is applied to the range [mStart, mEnd], inclusive, as specified in the provided parameters.
      * Supported effects are defined in core/types.h under the Effect enum.
      *
+     * In parallel mode (see setParallelOptions()) the effect gets the thread pool for the passes it
+     * parallelizes itself, and the range of a stateless effect (gain, fades, distortion, reverse, see
+     * dsp::Effect::splitsRange()) longer than kParallelChunkFrames is split into pieces that run on
+     * the pool, at most `ParallelOptions::maxConcurrentTasks` of them.
+     *
      * @param buffer Reference to the single-channel audio buffer to process.
      * @param effect The effect to apply.
      * @param params Parameters for the effect (polymorphic based on the effect type).
@@ -81,14 +268,53 @@ public:
     bool applyEffect(Float &buffer, const Effect &effect, 
         std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler);
 
-    // TODO: Support multi-threading per channel.
-    // TODO: Add undo functionality after processing.
+    /**
+     * @brief Applies a DSP effect to the first `channels` planar channels of an audio buffer in one call.
+     *
+     * The range is validated and the effect set up once for all the channels. Effects that link
+     * their channels (normalization, dynamics) measure them together and apply the same gain to
+     * each, others process the channels one after the other.
+     *
+     * @param audio Planar channels, the first `channels` of the same length.
+     * @param channels Number of channels to process, 1 or 2.
+     * @param effect The effect to apply.
+     * @param params Parameters for the effect (polymorphic based on the effect type).
+     * @param handler Error handler for reporting processing issues.
+     *
+     * @return true if processing succeeded, false otherwise.
+     */
+    bool applyEffect(AudioBuffer &audio, size_t channels, const Effect &effect,
+        std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler);
+
+    /**
+     * @brief Applies a DSP effect to samples the caller owns, without copying them into a Float.
+     *
+     * For hosts that already hold the audio: an interleaved device buffer, a utils::Buffer, a
+     * memory map. [mStart, mEnd] are frames of the view. Most effects run on the view where it
+     * is, see dsp::Effect::processView() for the ones that need a planar copy.
+     *
+     * @param view Interleaved samples, 1 to kNumChannels channels (see AudioView).
+     * @param effect The effect to apply.
+     * @param params Parameters for the effect (polymorphic based on the effect type).
+     * @param handler Error handler for reporting processing issues.
+     *
+     * @return true if processing succeeded, false otherwise.
+     */
+    bool applyEffect(const AudioView &view, const Effect &effect,
+        std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler);
 
     /**
      * @brief Applies a DSP effect to all audio channels of a single audio file.
      *
-     * The effect is applied to the range [mStart, mEnd], inclusive, on each channel buffer,
-     * using the provided effect parameters.
+     * The effect is applied to the range [mStart, mEnd], inclusive, of all the channels in one
+     * call (see the AudioBuffer overload), so linked effects treat a stereo file as one signal.
+     *
+     * If parallel processing is enabled (see setParallelOptions()) the channels of an effect
+     * that doesn't link them are processed concurrently on the EngineResources thread pool.
+     *
+     * With undo support enabled the range is saved first, undo() restores it.
+     *
+     * In deferred mode (setDeferredEffects()) the effect is only recorded on the file's render graph.
      *
      * Supported effects are defined in core/types.h under the Effect enum.
      *
@@ -105,14 +331,22 @@ public:
     bool applyEffect(std::shared_ptr<AJ::io::AudioFile> audio, const Effect &effect, 
         std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler);
 
-    // TODO: Support multi-threading per file.
-    // TODO: Add undo functionality after processing.
     /**
      * @brief Applies a DSP effect to all audio channels of multiple audio files.
      *
      * The effect is applied to the range [mStart, mEnd], inclusive, on each channel
      * of each audio file in the provided list.
      *
+     * If parallel processing is enabled (see setParallelOptions()) every file, or every channel
+     * of every file for an effect that doesn't link them, is a separate task on the
+     * EngineResources thread pool, at most
+     * `ParallelOptions::maxConcurrentTasks` of them run at once. In that mode all files are
+     * processed even if some of them fail, and the errors of every failing task are
+     * reported to `handler`.
+     *
+     * With undo support enabled the range of every file is saved first, one undo() restores them all.
+     * In deferred mode (setDeferredEffects()) the effect is recorded on the render graph of every file.
+     *
      * Supported effects are defined in core/types.h under the Effect enum.
      *
      * @param audioFiles Vector of shared pointers to audio files to process.
@@ -127,6 +361,55 @@ public:
     bool applyEffect(std::vector<std::shared_ptr<AJ::io::AudioFile>> audioFiles, const Effect &effect, 
         std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler);
 
+    /**
+     * @brief Applies an EffectChain to a single-channel audio buffer in one pass per block.
+     *
+     * Every stage of the chain uses its own parameters and range, see dsp::EffectChain.
+     *
+     * @param buffer Reference to the single-channel audio buffer to process.
+     * @param chain The chain of effects to apply, in order.
+     * @param handler Error handler for reporting processing issues.
+     *
+     * @return true if processing succeeded, false otherwise.
+     */
+    bool applyEffectChain(Float &buffer, dsp::EffectChain &chain, error::IErrorHandler &handler);
+
+    /**
+     * @brief Applies an EffectChain to all audio channels of a single audio file.
+     *
+     * Channels run in parallel if parallel processing is enabled (see setParallelOptions()).
+     * With undo support enabled the file is saved first (the stages have their own ranges).
+     *
+     * @param audio Shared pointer to the audio file to process.
+     * @param chain The chain of effects to apply, in order.
+     * @param handler Error handler for reporting processing issues.
+     *
+     * @return true if processing succeeded, false otherwise.
+     */
+    bool applyEffectChain(std::shared_ptr<AJ::io::AudioFile> audio, dsp::EffectChain &chain,
+        error::IErrorHandler &handler);
+
+    /**
+     * @brief Applies an EffectChain to a file on disk, block by block, into a 32-bit float WAV file.
+     *
+     * Unlike loadAudio() / applyEffectChain() / saveAudio() the file is never in memory as a whole:
+     * a FileStreamer decodes it into the blocks of a BufferPool on a worker of the engine's
+     * thread pool, the calling thread runs the chain over every block with processBlock() and
+     * appends it to an io::WavStreamWriter. Memory is `inflightBlocks` blocks whatever the length
+     * of the file, so files larger than RAM can be processed. The ranges of the stages are in
+     * frames of the file.
+     *
+     * @param inPath  WAV or MP3 file to process (mono or stereo).
+     * @param outPath WAV file written (overwritten), at the samplerate and channels of the input.
+     * @param chain   chain of effects, every stage must support block processing.
+     * @param handler Error handler for reporting processing issues.
+     * @param options block size, blocks in flight and settings of the writer.
+     *
+     * @return false (reported) if the chain can't run on blocks, or if a read, a stage or a write failed.
+     */
+    bool processFile(const std::string &inPath, const std::string &outPath, dsp::EffectChain &chain,
+        error::IErrorHandler &handler, const FileProcessOptions &options = FileProcessOptions());
+
     /**
      * @brief Loads an audio file into memory.
      *
@@ -138,11 +421,54 @@ public:
      * @param ext Expected file extensiion 
      * if not known don't pass it.
      * 
+     * If a decode cache is set (setDecodeCache()), compressed files are read from their
+     * cache entry when it's up to date, and stored in it after they were decoded (an MP3 with
+     * its seek index).
+     *
      * @return std::shared_ptr<io::AudioFile> Smart pointer to the loaded audio file,
      *         or nullptr if loading failed
      */
     std::shared_ptr<io::AudioFile> loadAudio(const std::string &path, error::IErrorHandler &handler,
         std::string ext = "");
+
+    /**
+     * @brief Loads only the frames [start, end] of an audio file into memory.
+     *
+     * The file is seeked to `start` (sf_seek for WAV, av_seek_frame plus sample accurate
+     * trimming for MP3), so load time and memory follow the range instead of the file.
+     * The returned file remembers where the range sits (AudioFile::rangeStart(),
+     * AudioFile::sourceFrames()). The decode cache isn't used for the samples of a range, but an MP3
+     * seeks through the seek index kept in it (io::SeekIndex, built by a demux pass the first time).
+     *
+     * @param path Full path to the audio file
+     * @param handler Error handler for reporting loading issues
+     * @param start first frame to load.
+     * @param end last frame to load (inclusive), -1 loads to the end of the file.
+     * @param ext Expected file extension, if not known don't pass it.
+     *
+     * @return std::shared_ptr<io::AudioFile> Smart pointer to the loaded range,
+     *         or nullptr if loading failed
+     */
+    std::shared_ptr<io::AudioFile> loadAudio(const std::string &path, error::IErrorHandler &handler,
+        sample_pos start, sample_pos end, std::string ext = "");
+
+    /**
+     * @brief Reads the metadata of an audio file without decoding it.
+     *
+     * WAV files only have their header parsed, MP3 files their stream info, so probing
+     * every clip of a session is cheap; the samples are loaded later with loadAudio().
+     * For MP3 the length comes from the reported duration and may differ from the
+     * decoded length by a few codec frames.
+     *
+     * @param path Full path to the audio file
+     * @param info Filled with length, samplerate, channels, bit depth (WAV) and format.
+     * @param handler Error handler for reporting probing issues
+     * @param ext Expected file extension, if not known don't pass it.
+     *
+     * @return true if the file was probed, false otherwise.
+     */
+    bool probeAudio(const std::string &path, AudioInfo &info, error::IErrorHandler &handler,
+        std::string ext = "");
     
     /**
      * @brief Saves an audio file to disk using its internal format.
@@ -155,6 +481,9 @@ public:
      * setting its write information via the `setWriteInfo` method. This method
      * requires an `AudioWriteInfo&` object specifying write settings and an
      * `IErrorHandler&` for reporting any configuration issues.
+     *
+     * A write samplerate different from the file's converts the samples first
+     * (AudioFile::resample(), on the engine's thread pool); the file stays at that rate.
      * 
      * @param audio Smart pointer to the audio file to save
      * @param handler Error handler for reporting saving issues
@@ -163,16 +492,199 @@ public:
      */
     bool saveAudio(std::shared_ptr<io::AudioFile> audio, error::IErrorHandler &handler);
 
+    /**
+     * @brief loadAudio() on a worker of the engine's I/O pool (EngineResources::ioThreadPool()).
+     *
+     * Returns at once, the calling thread (e.g. a GUI) never waits for the disk or the decoder.
+     * Inside the load the file reads overlap the conversion, see AudioFile::setReadPool().
+     * Without engine resources the file is loaded on the calling thread and the future is ready.
+     *
+     * @param path Full path to the audio file
+     * @param ext Expected file extension, if not known don't pass it.
+     * @return the loaded file, or nullptr with the errors of the load.
+     *
+     * @warning The engine must outlive the future. The loads share the I/O workers with
+     * playback and recording, give them more threads (EngineResourcesConfig::ioThreads())
+     * to import while playing.
+     */
+    std::future<LoadResult> loadAudioAsync(const std::string &path, std::string ext = "");
+
+    /**
+     * @brief Load a batch of files on the I/O workers, at most `options.maxInFlight` at once and
+     * no more decoded bytes at once than `options.memoryBudget`.
+     *
+     * The headers are probed on a worker in order. A file starts once it fits in the budget next
+     * to the running ones, so the memory held by the loads stays bounded whatever the batch.
+     * The futures complete in any order. Without engine resources everything is loaded on the
+     * calling thread.
+     *
+     * @param paths files to load (WAV or MP3).
+     * @param options files in flight and memory budget.
+     * @return one future per path, in the order of `paths`.
+     */
+    std::vector<std::future<LoadResult>> loadAudioAsync(const std::vector<std::string> &paths,
+        const AsyncLoadOptions &options = AsyncLoadOptions());
+
+    /**
+     * @brief saveAudio() on a worker of the engine's I/O pool.
+     *
+     * `audio` must not be changed until the future is ready. Without engine resources the file
+     * is saved on the calling thread and the future is ready.
+     *
+     * @param audio File to save, its write information already set.
+     * @return whether the save succeeded, with its errors.
+     */
+    std::future<SaveResult> saveAudioAsync(std::shared_ptr<io::AudioFile> audio);
+
+    /**
+     * @brief Set the engine resources whose thread pool is used for parallel processing.
+     *
+     * @param resources shared engine resources (may be shared with AudioIOManager).
+     */
+    void setEngineResources(std::shared_ptr<EngineResources> resources) {
+        pEngineResources = std::move(resources);
+    }
+
+    /**
+     * @brief Get the engine resources (nullptr if none were set).
+     */
+    std::shared_ptr<EngineResources> engineResources() const {
+        return pEngineResources;
+    }
+
+    /**
+     * @brief Effects reachable through applyEffect, e.g. to register a custom implementation.
+     */
+    std::shared_ptr<dsp::EffectRegistry> effectRegistry() const {
+        return pEffects;
+    }
+
+    /**
+     * @brief Configure parallel execution of the multi-channel / multi-file applyEffect overloads.
+     *
+     * @note Parallel execution requires engine resources, see setEngineResources().
+     */
+    void setParallelOptions(const ParallelOptions &options) {
+        mParallel = options;
+    }
+
+    /**
+     * @brief Get the current parallel execution options.
+     */
+    const ParallelOptions &parallelOptions() const {
+        return mParallel;
+    }
+
+    /**
+     * @brief Build a level index (peak / RMS pyramid) for every file loaded from now on.
+     *
+     * Indexed files answer AudioFile::levels() queries without rescanning the samples,
+     * the engine keeps the index up to date after applyEffect / applyEffectChain.
+     *
+     * @param enabled Set to true to index loaded files.
+     */
+    void setLevelIndexEnabled(bool enabled) {
+        mLevelIndexEnabled = enabled;
+    }
+
+    /**
+     * @brief Whether loaded files get a level index.
+     */
+    bool isLevelIndexEnabled() const {
+        return mLevelIndexEnabled;
+    }
+
+    /**
+     * @brief Keep the decoded samples of compressed files (MP3) in `directory`, see io::DecodeCache.
+     *
+     * A file loaded again with loadAudio() while its size and modification time didn't change
+     * is read from its entry instead of being decoded. WAV files are always read directly.
+     *
+     * @param directory cache directory (e.g. next to the session), "" disables the cache.
+     */
+    void setDecodeCache(const std::string &directory) {
+        pDecodeCache = directory.empty() ? nullptr : std::make_shared<io::DecodeCache>(directory);
+    }
+
+    /**
+     * @brief Decode cache used by loadAudio(), nullptr if disabled.
+     */
+    std::shared_ptr<io::DecodeCache> decodeCache() const {
+        return pDecodeCache;
+    }
+
+    /**
+     * @brief Defer the effects applied to files: applyEffect() records a node on the file's render
+     * graph (see renderGraph()) and returns, the samples are only computed for what is read.
+     *
+     * Playback (io::play::RenderGraphSource), analysis (RenderGraph::levels(), RenderGraph::read())
+     * then cost what they read, and undo() of a deferred effect pops its nodes, nothing is restored.
+     * The file's own samples stay dry until commitEffects(), which saveAudio(), applyEffectChain()
+     * and applyEffect() out of deferred mode call first.
+     *
+     * Compact files (AudioFile::setStorage()) are always processed at once.
+     *
+     * @param enabled true to defer the effects applied from now on.
+     */
+    void setDeferredEffects(bool enabled) {
+        mDeferredEffects = enabled;
+    }
+
+    /**
+     * @brief Whether applyEffect() defers the effects applied to files.
+     */
+    bool isDeferredEffects() const {
+        return mDeferredEffects;
+    }
+
+    /**
+     * @brief The render graph of a file, created on first use with the file's samples as its source.
+     *
+     * While it has no node its source follows the file's samples. The file must not be changed
+     * outside of the engine while effects are waiting on it.
+     *
+     * @return nullptr (reported) if the samples are compact.
+     */
+    std::shared_ptr<editing::render_graph::RenderGraph> renderGraph(const std::shared_ptr<io::AudioFile> &audio,
+        error::IErrorHandler &handler);
+
+    /**
+     * @brief Render the deferred effects of a file into its samples, as one undoable operation.
+     *
+     * The graph starts again from the rendered samples, without node. Does nothing if no
+     * effect is waiting.
+     *
+     * @return true on success (or nothing to render); false if an effect failed.
+     */
+    bool commitEffects(const std::shared_ptr<io::AudioFile> &audio, error::IErrorHandler &handler);
+
+    /**
+     * @brief A preview renderer of a file, to audition effect settings on it (see editing::preview::PreviewRenderer).
+     *
+     * Its source is the file's samples as they are now, with the engine's effect registry. Edits of
+     * the renderer never reach the file: apply the settings that were kept with applyEffect().
+     *
+     * @param audio   the file, Float32 storage.
+     * @param handler Error handler, also kept for the errors of the background render: it must
+     *                outlive the renderer.
+     * @return nullptr (reported) if the samples are compact or invalid.
+     */
+    std::shared_ptr<editing::preview::PreviewRenderer> createPreview(const std::shared_ptr<io::AudioFile> &audio,
+        error::IErrorHandler &handler);
+
     /**
      * @brief Enables or disables support for the undo system.
      * 
      * This flag determines whether the object participates in
-     * the undo/redo operation stack.
+     * the undo/redo operation stack. Disabling it drops the history.
      *
      * @param enabled Set to true to enable undo support; false to disable.
      */
     void setUndoSupportEnabled(bool enabled) {
         mUndoSupportEnabled = enabled;
+        if(!enabled){
+            mUndo.clear();
+        }
     }
 
     /**
@@ -184,5 +696,31 @@ public:
         return mUndoSupportEnabled;
     }
 
+    /**
+     * @brief Undo history of the engine, e.g. to set its memory budget and spill directory,
+     * or to push the states of Cut / Insert / piece table edits made outside the engine.
+     */
+    undo::UndoSystem& undoSystem() noexcept {
+        return mUndo;
+    }
+
+    /**
+     * @brief Restore the files changed by the last operation.
+     *
+     * An applyEffect() still deferred is the last operation: its nodes are popped from the
+     * render graphs (it can't be redone).
+     *
+     * @return false (reported) if there's nothing to undo or a file can't be restored.
+     */
+    bool undo(error::IErrorHandler &handler);
+
+    /**
+     * @brief Make the last undone operation again.
+     * @return false (reported) if there's nothing to redo or a file can't be restored.
+     */
+    bool redo(error::IErrorHandler &handler) {
+        return mUndo.redo(handler);
+    }
+
 };
 }
@@ -0,0 +1,79 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "core/constants.h"
+#include "core/memory.h"
+
+namespace AJ {
+
+/**
+ * @brief Allocator of `kBufferAlignment` aligned, padded storage that doesn't zero on resize.
+ *
+ * - Every allocation starts on a cache line (and an AVX-512 register), and its size is
+ *   rounded up to a multiple of `kBufferAlignment`, so a full-width vector load of the last
+ *   elements stays inside the allocation.
+ * - `resize(n)` / `Float(n)` default-initialize: samples are left as they were instead of
+ *   being zeroed, since readers and effects overwrite them anyway. Ask for zeros explicitly
+ *   with `Float(n, 0.0f)`, `resize(n, 0.0f)` or `assign(n, 0.0f)`.
+ * - Memory comes from the engine allocator, accounted to the subsystem of the MemoryScope
+ *   the allocation was made in (see utils::allocateTagged()).
+ */
+template<typename T>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n){
+        if(n > static_cast<size_t>(-1) / sizeof(T) - kBufferAlignment){
+            throw std::bad_alloc();
+        }
+
+        void *data = utils::allocateTagged(std::max<size_t>(n * sizeof(T), 1));
+        if(!data){
+            throw std::bad_alloc();
+        }
+
+        return static_cast<T*>(data);
+    }
+
+    void deallocate(T *data, size_t) noexcept {
+        utils::deallocateTagged(data);
+    }
+
+    //? default-initialize (no zeroing for floats), value construct when given arguments.
+    template<typename U>
+    void construct(U *p) noexcept(std::is_nothrow_default_constructible<U>::value) {
+        ::new(static_cast<void*>(p)) U;
+    }
+
+    template<typename U, typename... Args>
+    void construct(U *p, Args&&... args){
+        ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) noexcept {
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) noexcept {
+    return false;
+}
+
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/effect_params.h"
+#include "core/thread_pool.h"
+#include "core/aj_audio_engine.h"
+
+namespace AJ::batch {
+
+/**
+ * @brief The effect a batch applies to every file, with its whole-file parameters.
+ *
+ * Specs are `name` or `name=value`:
+ * - `gain=<x>`: linear gain multiplier;
+ * - `normalize[=<x>]`: peak normalization to the linear level `x` (default 1.0);
+ * - `lufs[=<x>]`: loudness normalization to `x` LUFS (default -23, EBU R128);
+ * - `fadein`, `fadeout`: fade over the whole file;
+ * - `reverse`: reverse the file;
+ * - `reverb[=<wet>]`: the default room, with the wet mix `wet` (default 0.7);
+ * - `gate[=<dB>]`: noise gate opening at `dB` dBFS (default -50), closed at -80 dB;
+ * - `trim[=<dB>]`: remove the leading and trailing silence under `dB` dBFS (default kTrimThresholdDb),
+ *   an editing::trim::AutoTrim instead of an effect.
+ */
+struct EffectSpec {
+    Effect effect = Effect::gain;
+    float value = 1.0f;
+    bool lufs = false; ///< a normalization to `value` LUFS instead of a peak level.
+    bool trim = false; ///< an auto-trim at `value` dBFS instead of `effect`.
+
+    /**
+     * @brief Parse a spec (see above).
+     * @return false (reported) if the name is unknown or the value isn't a number.
+     */
+    static bool parse(const std::string &spec, EffectSpec &out, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Parameters of the effect over all the frames of `audio`, nullptr (reported) if invalid.
+     */
+    std::shared_ptr<dsp::EffectParams> params(const io::AudioFile &audio, AJ::error::IErrorHandler &handler) const;
+};
+
+/**
+ * @brief One file of a batch.
+ */
+struct Job {
+    std::string input;  ///< WAV or MP3 file processed.
+    std::string output; ///< file written, in the format of the input.
+};
+
+/**
+ * @brief Outcome of a job, reported in the order of the batch.
+ */
+struct JobResult {
+    size_t index = 0;      ///< position of the job in the batch.
+    const Job *job = nullptr;
+    bool success = false;
+    size_t bytes = 0;      ///< decoded samples accounted against the memory budget.
+
+    /// @brief Errors of the job, in the order they were reported.
+    std::vector<std::pair<error::Error, std::string>> errors;
+
+    double wait = 0.0;     ///< seconds the job waited for memory or a free slot.
+    double load = 0.0;     ///< seconds decoding the file.
+    double process = 0.0;  ///< seconds applying the effect.
+    double save = 0.0;     ///< seconds encoding and writing the output.
+};
+
+/**
+ * @brief Limits of BatchRunner::run().
+ */
+struct BatchOptions {
+    /**
+     * @brief Decoded bytes (all the files being processed) held at once. A file larger than the
+     * budget still runs, alone.
+     */
+    size_t memoryBudget = kBatchMemoryBudget;
+
+    /// @brief Files processed at the same time, 0 = one per thread of the pool.
+    size_t maxConcurrentFiles = 0;
+};
+
+/**
+ * @class BatchRunner
+ * @brief Loads, processes and saves the files of a batch concurrently on the engine's thread pool.
+ *
+ * ### Design:
+ * - The calling thread dispatches the jobs in order. A job starts once its decoded size
+ *   (probed from the header) fits in the memory budget next to the running ones, and a slot
+ *   is free (`maxConcurrentFiles`), so memory stays bounded whatever the size of the batch.
+ * - Every job runs loadAudio() / applyEffect() / saveAudio() on a pool worker, with its own
+ *   error handler. The effects of the engine are per thread; its undo support must be disabled.
+ * - Results are reported on the calling thread in the order of the batch, each as soon as it
+ *   and every job before it completed; their errors are replayed to the handler then.
+ * - Without engine resources the jobs run one after another on the calling thread.
+ *
+ * Typical usage:
+ * @code
+ * AJ::batch::EffectSpec spec;
+ * AJ::batch::EffectSpec::parse("lufs=-16", spec, handler);
+ *
+ * engine->setUndoSupportEnabled(false);
+ * AJ::batch::BatchRunner runner(*engine);
+ * auto jobs = AJ::batch::BatchRunner::fromDirectory("/field/day3", "/field/day3/normalized", handler);
+ * runner.run(jobs, spec, [](const AJ::batch::JobResult &result){ print(result); }, handler);
+ * @endcode
+ */
+class BatchRunner {
+    AJ_Engine &mEngine;
+    BatchOptions mOptions;
+    size_t mPeakBytes = 0;
+
+    std::mutex mMux;
+    std::condition_variable mDone; ///< a job completed.
+
+public:
+    using Report = std::function<void(const JobResult&)>;
+
+    explicit BatchRunner(AJ_Engine &engine, const BatchOptions &options = BatchOptions()) :
+        mEngine(engine), mOptions(options) {}
+
+    /**
+     * @brief Every WAV / MP3 file of `directory` (sorted by name), written with the same name into `outDirectory`.
+     */
+    static std::vector<Job> fromDirectory(const std::string &directory, const std::string &outDirectory,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief The jobs of a manifest: one input per line, optionally followed by a tab and its
+     * output. Empty lines and lines starting with `#` are skipped. Outputs without a directory,
+     * and inputs without an output, are written into `outDirectory`.
+     */
+    static std::vector<Job> fromManifest(const std::string &manifest, const std::string &outDirectory,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Apply `spec` to every job.
+     *
+     * @param jobs    files of the batch.
+     * @param spec    effect applied to every file.
+     * @param report  called on the calling thread for every job, in the order of `jobs` (may be empty).
+     * @param handler receives the errors of every job, in the order of `jobs`.
+     * @return false if a job failed (the others still ran), or (reported) if the engine's undo support is enabled.
+     */
+    bool run(const std::vector<Job> &jobs, const EffectSpec &spec, const Report &report,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Most decoded bytes held at once by the last run().
+     */
+    size_t peakBytes() const noexcept {
+        return mPeakBytes;
+    }
+};
+
+} // namespace AJ::batch
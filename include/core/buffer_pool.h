@@ -1,28 +1,50 @@
 #pragma once 
 #include "types.h"
 #include "error_handler.h"
+#include "memory.h"
 
 #include <vector>
 #include <cstdint>
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <cmath>
 #include <cstring>
+#include <cstdlib>
 
 namespace AJ::utils {
 
+/**
+ * @brief Round up to next power of 2 (queue sizes and buffer sizes, masked instead of wrapped).
+ */
+constexpr size_t next_power_of_2(size_t n) {
+    if (n <= 1) return 1;
+    n--;
+    n |= n >> 1;
+    n |= n >> 2;
+    n |= n >> 4;
+    n |= n >> 8;
+    n |= n >> 16;
+    n |= n >> 32;
+    return n + 1;
+}
+
 /**
  * @struct Buffer
  * @brief Container for audio buffer data.
  *
- * The Buffer struct owns a contiguous block of float samples used
+ * The Buffer struct describes a contiguous block of float samples used
  * for audio processing. It tracks both the total capacity (in samples)
  * and the number of valid frames currently stored.
  *
  * ### Design:
- * - Memory is allocated dynamically using `new[]` in the constructor
- *   and freed in the destructor.
- * 
+ * - A Buffer is either **owning** or a **view**:
+ *   - Owning buffers (`Buffer(size, channels)`) allocate their own
+ *     `kBufferAlignment`-aligned storage and free it in the destructor.
+ *   - Views (`Buffer(data, size, channels)`) point into memory owned by
+ *     someone else (e.g. the slab of a `Queue`) and never free it.
+ *
  * - Samples are stored as interleaved floats if the buffer
  *   represents multi-channel audio (handled externally).
  * - The `frames` member allows tracking how many frames have
@@ -42,17 +64,47 @@ namespace AJ::utils {
  * @endcode
  */
 struct Buffer {
-    float *data;   ///< Pointer to audio sample buffer.
+    float *data;   ///< Pointer to audio sample buffer (kBufferAlignment aligned).
     size_t size;   ///< Total allocated size in samples.
     uint8_t channels; ///< Number of channels
     size_t frames; ///< Number of valid frames currently in use.
+    bool owned;    ///< true if `data` was allocated by this Buffer and must be freed by it.
+
+    /**
+     * @brief Allocate an owning buffer of `size` samples.
+     *
+     * Storage is aligned to `kBufferAlignment` and padded up to a multiple of it,
+     * on allocation failure `data` is set to nullptr. It's accounted to Subsystem::Pools.
+     */
+    Buffer(size_t size, uint8_t channels) : size(size), channels(channels), frames(0), owned(true) {
+        data = static_cast<float*>(engineAllocator().allocate(storageBytes(size), kBufferAlignment, Subsystem::Pools));
+    }
+
+    /**
+     * @brief Create a non-owning view over externally managed sample memory.
+     */
+    Buffer(float *data, size_t size, uint8_t channels) :
+        data(data), size(size), channels(channels), frames(0), owned(false) {}
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
 
-    Buffer(size_t size, uint8_t channels) : size(size), channels(channels), frames(0) {
-        data = new float[size];
+    Buffer(Buffer&& other) noexcept :
+        data(other.data), size(other.size), channels(other.channels),
+        frames(other.frames), owned(other.owned) {
+        other.data = nullptr;
+        other.owned = false;
     }
 
     ~Buffer() {
-        delete[] data;
+        if(owned){
+            engineAllocator().deallocate(data, storageBytes(size), kBufferAlignment, Subsystem::Pools);
+        }
+    }
+
+    /// @brief Bytes of the storage of an owning buffer of `size` samples.
+    static size_t storageBytes(size_t size) noexcept {
+        return (sizeof(float) * std::max<size_t>(size, 1) + kBufferAlignment - 1) & ~(kBufferAlignment - 1);
     }
 };
 
@@ -159,7 +211,7 @@ struct Buffer {
  *
  * ## Notes:
  * - Only supports single producer and single consumer (SPSC).
- * - No runtime allocations; everything is pre-allocated up front.
+ * - No runtime allocations; everything is pre-allocated up front in a single slab.
  * - Safe for use in real-time audio contexts (e.g., DAWs, game engines).
  */
 class Queue {
@@ -186,6 +238,21 @@ private:
      */
     alignas(CACHE_LINE_SIZE) std::atomic<bool> mFullFlag;
 
+    /**
+     * @brief Event count the consumer parks on (futex word), bumped by the producer to wake it.
+     */
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> mEpoch{0};
+
+    /**
+     * @brief Number of consumers parked in wait(), the producer only wakes if it's not 0.
+     */
+    std::atomic<uint32_t> mWaiters{0};
+
+    /**
+     * @brief Queued buffers the parked consumer waits for (see wait()).
+     */
+    std::atomic<size_t> mWakeThreshold{1};
+
     /**
      * @brief Raw pointer to the allocated buffer memory (float samples).
      *
@@ -193,6 +260,51 @@ private:
      */
     alignas(CACHE_LINE_SIZE) std::vector<Buffer *>mQueue;
 
+    /**
+     * @brief Buffer descriptors owned by the queue (full mode only).
+     *
+     * Every descriptor is a non-owning view into `pSlab`, the queue ring
+     * only stores pointers to these.
+     */
+    std::vector<Buffer> mBuffers;
+
+    /**
+     * @brief One contiguous, kBufferAlignment aligned block holding the samples of all buffers.
+     */
+    float *pSlab{nullptr};
+
+    /**
+     * @brief Size of the slab in bytes (as passed to the allocator).
+     */
+    size_t mSlabBytes{0};
+
+    /**
+     * @brief Distance in samples between the start of two consecutive buffers in the slab.
+     *
+     * Rounded up to a multiple of kBufferAlignment so no two buffers share a cache line.
+     */
+    size_t mBufferStride{0};
+
+    /**
+     * @brief true if the slab was mapped with mmap (huge pages) and must be released with munmap.
+     */
+    bool mSlabMapped{false};
+
+    /**
+     * @brief Alignment the slab was allocated with (kHugePageSize for transparent huge pages).
+     */
+    size_t mSlabAlignment{kBufferAlignment};
+
+    /**
+     * @brief Request huge pages for the slab (falls back to regular pages if unavailable).
+     */
+    bool mHugePages{false};
+
+    /**
+     * @brief NUMA node the slab pages are preferred on, -1 = where the constructing thread runs.
+     */
+    int mNumaNode{-1};
+
 
     /**
      * @brief Total buffer size (number of samples).
@@ -238,31 +350,18 @@ private:
     bool mEmptyQueue{false};
 
 private:
-    /**
-     * @brief Round up to next power of 2
-     */
-    static constexpr size_t next_power_of_2(size_t n) {
-        if (n <= 1) return 1;
-        n--;
-        n |= n >> 1;
-        n |= n >> 2;
-        n |= n >> 4;
-        n |= n >> 8;
-        n |= n >> 16;
-        n |= n >> 32;
-        return n + 1;
-    }
-    
     /**
      * @brief Get available space for writing (from writer's perspective)
      */
     size_t getFreeSpace(size_t currentWrite){
-        size_t currentRead = mReadIndex.load(std::memory_order_acquire);
-
+        //? the flag first: the reader clears it after moving mReadIndex, an index read before
+        //? could be the one of the full queue and count it empty.
         if(mFullFlag.load(std::memory_order_acquire)){
             return 0;
         }
 
+        size_t currentRead = mReadIndex.load(std::memory_order_acquire);
+
         /*
          * this different calculation to make sure if the write is 0 and the read is 0 and 
          * the buffer is not full, the calculation returns the full size.
@@ -303,12 +402,8 @@ private:
 
         // free only if we own the buffers
         if (!mEmptyQueue) {
-            for (auto& buffer : mQueue) {
-                if (buffer) {
-                    delete buffer;
-                    buffer = nullptr;
-                }
-            }
+            mBuffers.clear();
+            freeSlab();
         }
 
         mQueue.clear();
@@ -319,23 +414,56 @@ private:
     }
 
 
+    /**
+     * @brief Allocate the sample slab for all buffers.
+     *
+     * The slab is aligned to kBufferAlignment. If huge pages were requested it first
+     * tries an explicit MAP_HUGETLB mapping, then a kHugePageSize aligned allocation
+     * advised with MADV_HUGEPAGE, and finally regular pages.
+     *
+     * @param bytes total slab size in bytes.
+     * @return true on success, false if no memory could be allocated.
+     */
+    bool allocSlab(size_t bytes);
+
+    /**
+     * @brief Release the slab allocated by allocSlab().
+     */
+    void freeSlab() noexcept;
+
+    /**
+     * @brief Called by push(): wake a parked consumer once `queued` reaches its threshold.
+     *
+     * Costs one fence and one load when nobody is parked, the wake itself is a single
+     * non-blocking futex syscall (no lock), so it is safe in a realtime callback.
+     */
+    void notify(size_t queued) noexcept;
+
     /**
      * @brief allocates buffers of the queue.
+     *
+     * All buffers are carved out of one contiguous slab, each one starting on
+     * a kBufferAlignment boundary, instead of one heap allocation per buffer.
      */
     void allocBuffers(size_t queue_size, size_t buffer_size, uint8_t channels, AJ::error::IErrorHandler& handler){
-        //* init the buffers.
-        for(size_t i = 0; i < queue_size; ++i){
-            mQueue[i] = new Buffer(mBufferSize, channels);
+        mBufferStride = (buffer_size * sizeof(float) + kBufferAlignment - 1) & ~(kBufferAlignment - 1);
+        mBufferStride /= sizeof(float);
 
-            if(!mQueue[i] || !mQueue[i]->data){
-                const std::string message = std::bad_alloc().what();
-                handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
-                cleanup();
-                return;
-            }
+        if(!allocSlab(sizeof(float) * mBufferStride * queue_size)){
+            const std::string message = std::bad_alloc().what();
+            handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+            cleanup();
+            return;
+        }
 
-            //* init the buffer with 0 values.
-            std::memset(mQueue[i]->data, 0, sizeof(float) * buffer_size);
+        //* init the buffers with 0 values.
+        std::memset(pSlab, 0, mSlabBytes);
+
+        mBuffers.reserve(queue_size);
+
+        for(size_t i = 0; i < queue_size; ++i){
+            mBuffers.emplace_back(pSlab + i * mBufferStride, buffer_size, channels);
+            mQueue[i] = &mBuffers[i];
         }
 
         mValid = true;
@@ -346,7 +474,7 @@ public:
      * @brief Construct a lock-free audio buffer queue.
      *
      * This constructor pre-allocates a fixed number of audio buffers 
-     * (each aligned to 32 bytes for SIMD optimization) and arranges them 
+     * (carved out of one slab, each aligned to 64 bytes for SIMD) and arranges them 
      * in a lock-free ring queue. The queue provides pre-zeroed buffers for 
      * real-time audio processing tasks such as disk I/O or effect processing.
      *
@@ -372,6 +500,12 @@ public:
      * @param handler Reference to an error handler for reporting allocation or 
      *        configuration errors.
      *
+     * @param huge_pages Back the buffer slab with huge pages when possible (full mode only).
+     *        - Falls back silently to regular pages if the system has none available.
+     *
+     * @param numa_node NUMA node to allocate the slab on, e.g. the node of the threads using
+     *        the buffers (full mode only, see bindToNumaNode()). -1 = the default first touch.
+     *
      * @warning After construction, the caller **must** call `isValid()` 
      *          before using the queue.  
      *          - If `isValid()` returns `false`, the queue is unusable and 
@@ -386,7 +520,9 @@ public:
      *
      * ### Design Notes
      * - The queue is designed for **real-time audio** use cases (no runtime allocations).  
-     * - Buffers are **32-byte aligned** to ensure compatibility with SIMD instructions.  
+     * - All buffers live in **one contiguous slab** (a single allocation for the whole queue).  
+     * - Buffers are **64-byte (cache line) aligned** so aligned AVX/AVX-512 loads can be used
+     *   and neighbouring buffers never share a cache line.  
      * - All buffers are **zero-initialized**.  
      * - Internally uses power-of-2 sizes to enable efficient masking (`index & (size-1)`).
      *
@@ -399,8 +535,11 @@ public:
      * }
      * @endcode
      */
-    Queue(bool empty, size_t queue_size, size_t buffer_size, uint8_t channels, AJ::error::IErrorHandler& handler){
+    Queue(bool empty, size_t queue_size, size_t buffer_size, uint8_t channels, AJ::error::IErrorHandler& handler,
+        bool huge_pages = false, int numa_node = -1){
         mValid = false;
+        mHugePages = huge_pages;
+        mNumaNode = numa_node;
         mFullFlag.store(!empty, std::memory_order_relaxed);
 
         if(queue_size == 0 || buffer_size == 0){
@@ -488,6 +627,50 @@ public:
      */
     Buffer* pop() noexcept;
 
+    /**
+     * @brief Push up to `count` buffers with a single index update.
+     *
+     * The read index and the full flag are loaded once for the whole batch, the write
+     * index is published once, and a parked consumer is notified once. Stops at the
+     * first nullptr in `buffers`.
+     *
+     * @return buffers pushed, fewer than `count` if the queue filled up.
+     *
+     * @note This function is non-blocking and lock-free (producer side).
+     */
+    size_t pushBatch(Buffer* const* buffers, size_t count) noexcept;
+
+    /**
+     * @brief Pop up to `max` buffers, oldest first, with a single index update.
+     *
+     * @param out receives the buffers, must hold `max` pointers.
+     *
+     * @return buffers popped, 0 if the queue is empty.
+     *
+     * @note This function is non-blocking and lock-free (consumer side).
+     */
+    size_t popBatch(Buffer** out, size_t max) noexcept;
+
+    /**
+     * @brief Park the consumer until at least `min_buffers` buffers are queued, or `timeout` expired.
+     *
+     * The consumer sleeps in the kernel (futex on Linux) instead of polling pop(), it is woken
+     * by the push() that makes the queue reach `min_buffers` (batch threshold), or by wake().
+     * Only one consumer may wait at a time (SPSC).
+     *
+     * @param min_buffers buffers to wait for, clamped to [1, queueSize()].
+     * @param timeout maximum time to wait.
+     *
+     * @return `true` if at least `min_buffers` buffers are queued, `false` on timeout / wake().
+     */
+    bool wait(size_t min_buffers, std::chrono::microseconds timeout) noexcept;
+
+    /**
+     * @brief Wake the consumer parked in wait() regardless of the queue size
+     * (e.g. after setting a stop flag).
+     */
+    void wake() noexcept;
+
     /**
      * @brief Get the total size (capacity) of the Queue buffers in frames.
      * @return Number of frames (not samples).
@@ -585,7 +768,8 @@ public:
      * @param num_of_buffers Number of pre-allocated buffers in the pool (default = 1024).
      * @param buffer_frames  Number of float frames per buffer (default = 1024).
      * @param channels       Number of channels per buffer (1 = mono, 2 = stereo, etc., default = 2).
-     * @param empty          Flag 
+     * @param huge_pages     Back the buffers slab with huge pages when possible (default = false).
+     * @param numa_node      NUMA node of the buffers slab, -1 = no preference (default).
      * 
      * @note All buffers are allocated at construction time and reused for the pool’s lifetime.
      *       This avoids memory allocations in the real-time path.
@@ -593,10 +777,19 @@ public:
     BufferPool(AJ::error::IErrorHandler& handler,
                size_t num_of_buffers = 1024,
                size_t buffer_frames = 1024,
-               uint8_t channels = 2) {
-        pBuffersQueue = std::make_shared<Queue>(false, num_of_buffers, buffer_frames, channels, handler);
+               uint8_t channels = 2,
+               bool huge_pages = false,
+               int numa_node = -1) {
+        pBuffersQueue = std::make_shared<Queue>(false, num_of_buffers, buffer_frames, channels, handler, huge_pages, numa_node);
     }
 
+    /**
+     * @brief Wrap an existing queue, e.g. an empty-mode Queue filled by SharedBufferPool::lease().
+     *
+     * @note an empty-mode queue doesn't own its buffers, they must go back to their owner.
+     */
+    explicit BufferPool(std::shared_ptr<Queue> queue) : pBuffersQueue(std::move(queue)) {}
+
     /**
      * @brief Push a buffer into the pool for later reuse.
      * 
@@ -650,6 +843,53 @@ public:
         return buffer;
     }
 
+    /**
+     * @brief Pop a buffer without reporting an empty pool (realtime safe, no allocation).
+     * 
+     * @return Pointer to a buffer, or `nullptr` if the pool is empty.
+     */
+    Buffer* tryPop() noexcept {
+        return pBuffersQueue->pop();
+    }
+
+    /**
+     * @brief Give back `count` buffers at once, see Queue::pushBatch().
+     *
+     * @return buffers returned, fewer than `count` (reported) on a nullptr or a full pool.
+     */
+    size_t pushBatch(Buffer* const* buffers, size_t count, AJ::error::IErrorHandler& handler) {
+        const size_t pushed = pBuffersQueue->pushBatch(buffers, count);
+
+        if(pushed < count){
+            if(!buffers[pushed]){
+                const std::string message = "error: invalid buffer, buffer cannot be NULL.";
+                handler.onError(AJ::error::Error::NullBufferPtr, message);
+            } else {
+                const std::string message = "error: queue is full.";
+                handler.onError(AJ::error::Error::BufferOverflow, message);
+            }
+        }
+
+        return pushed;
+    }
+
+    /**
+     * @brief Take up to `max` buffers at once without reporting an empty pool, see Queue::popBatch().
+     */
+    size_t popBatch(Buffer** out, size_t max) noexcept {
+        return pBuffersQueue->popBatch(out, max);
+    }
+
+    /**
+     * @brief Park the (single) taker of the pool until `min_buffers` buffers were
+     * returned, see Queue::wait(). Used by producers for backpressure.
+     * 
+     * @return `true` if at least `min_buffers` buffers are available, `false` on timeout / wake().
+     */
+    bool wait(size_t min_buffers, std::chrono::microseconds timeout) noexcept {
+        return pBuffersQueue->wait(min_buffers, timeout);
+    }
+
     /**
      * @brief Check whether the buffer pool is in a valid state.
      * 
@@ -699,4 +939,117 @@ public:
 
 };
 
+/**
+ * @class SharedBufferPool
+ * @brief One slab of buffers that many streams lease their own BufferPool from.
+ *
+ * A BufferPool is single producer / single consumer, it can't be shared by the callbacks and
+ * the writers of several streams. Instead every stream leases a pool of its own (an empty-mode
+ * queue holding part of the shared buffers) before it starts and releases it after it stopped.
+ * A host recording many streams makes one allocation per channel layout, and the buffers a
+ * stream gives back go to the next one.
+ *
+ * lease() and release() lock, they are for the control thread, never for the audio callback.
+ *
+ * ## Example:
+ * @code
+ * SharedBufferPool shared(handler, 4096, 256, 1);   // 4096 mono buffers of 256 frames
+ *
+ * std::shared_ptr<BufferPool> pool = shared.lease(512, handler);
+ * // ... the stream records with `pool` ...
+ * shared.release(*pool, handler);
+ * @endcode
+ */
+class SharedBufferPool {
+private:
+    BufferPool mPool;       ///< Buffers not leased, owns the slab.
+    std::mutex mMux;        ///< Serializes lease() / release() (SPSC pool underneath).
+
+public:
+    /**
+     * @brief Allocate the shared buffers, see BufferPool::BufferPool().
+     */
+    SharedBufferPool(AJ::error::IErrorHandler& handler,
+                     size_t num_of_buffers,
+                     size_t buffer_frames,
+                     uint8_t channels,
+                     bool huge_pages = false) :
+        mPool(handler, num_of_buffers, buffer_frames, channels, huge_pages) {}
+
+    /**
+     * @brief Move `buffers` buffers into a new pool for one stream.
+     *
+     * @return the stream's pool, or nullptr (reported) if fewer than `buffers` are left.
+     */
+    std::shared_ptr<BufferPool> lease(size_t buffers, AJ::error::IErrorHandler& handler){
+        std::lock_guard<std::mutex> lock(mMux);
+
+        if(buffers == 0 || mPool.currentSize() < buffers){
+            const std::string message = "error: the shared buffer pool has " + std::to_string(mPool.currentSize()) +
+                " buffers left, " + std::to_string(buffers) + " were asked for.\n";
+            handler.onError(AJ::error::Error::EmptyBufferQueue, message);
+            return nullptr;
+        }
+
+        auto queue = std::make_shared<Queue>(true, buffers, mPool.bufferSize() / mPool.channels(),
+            static_cast<uint8_t>(mPool.channels()), handler);
+        if(!queue->isValid()){
+            return nullptr;
+        }
+
+        for(size_t i = 0; i < buffers; ++i){
+            queue->push(mPool.tryPop());
+        }
+
+        return std::make_shared<BufferPool>(std::move(queue));
+    }
+
+    /**
+     * @brief Take back every buffer a leased pool holds (after its stream stopped and its
+     * writer returned the queued buffers).
+     *
+     * @return the number of buffers returned.
+     */
+    size_t release(BufferPool& pool, AJ::error::IErrorHandler& handler){
+        std::lock_guard<std::mutex> lock(mMux);
+
+        size_t returned = 0;
+        while(Buffer* buffer = pool.tryPop()){
+            mPool.push(buffer, handler);
+            ++returned;
+        }
+
+        return returned;
+    }
+
+    /**
+     * @brief Check whether the shared buffers were allocated.
+     */
+    bool isValid() {
+        return mPool.isValid();
+    }
+
+    /**
+     * @brief Buffers not leased right now.
+     */
+    size_t available() {
+        std::lock_guard<std::mutex> lock(mMux);
+        return mPool.currentSize();
+    }
+
+    /**
+     * @brief Total number of shared buffers.
+     */
+    int capacity() const {
+        return mPool.capacity();
+    }
+
+    /**
+     * @brief Channels per buffer (1 = mono, 2 = stereo).
+     */
+    int channels() const {
+        return mPool.channels();
+    }
+};
+
 }
\ No newline at end of file
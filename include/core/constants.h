@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <new>
+#include <chrono>
 
 namespace AJ{
 
@@ -11,6 +12,96 @@ constexpr int8_t kNumChannels = 2;
 /// @brief Block size used for audio processing (e.g., for delay buffers).
 constexpr int16_t kBlockSize = 2048;
 
+/// @brief Frames per block used by EffectChain, 4096 floats (16 KiB) stay in L1/L2 across all stages.
+constexpr size_t kChainBlockFrames = 4096;
+
+/// @brief Frames per task when an analysis / gain pass over a long range is split across the thread pool.
+constexpr size_t kParallelChunkFrames = 1 << 18;
+
+/// @brief Pieces of a split range are a multiple of this many frames, whole vectors of every kernel.
+constexpr size_t kParallelPieceAlignment = 64;
+
+// -----------------------------
+// Level Index Constants
+// -----------------------------
+
+/// @brief Number of levels of the io::LevelIndex pyramid.
+constexpr size_t kLevelIndexDepth = 3;
+
+/// @brief Frames per block of the finest level of io::LevelIndex.
+constexpr size_t kLevelIndexBaseFrames = 256;
+
+/// @brief Blocks of a level merged into one block of the next level (256 / 4096 / 65536 frames).
+constexpr size_t kLevelIndexFanout = 16;
+
+/// @brief Loudness measurements of different ranges cached by a io::LevelIndex.
+constexpr size_t kLevelIndexLoudnessEntries = 8;
+
+// -----------------------------
+// Spectrogram Constants
+// -----------------------------
+
+/// @brief Default FFT size (frames per analysis window) of an io::Spectrogram, 1025 bins.
+constexpr size_t kSpectrogramFFTSize = 2048;
+
+/// @brief Default frames between two columns of the finest zoom level of an io::Spectrogram.
+constexpr size_t kSpectrogramHop = 512;
+
+/// @brief Columns of an io::Spectrogram tile (about 2 MiB of magnitudes with the default FFT size).
+constexpr size_t kSpectrogramTileColumns = 256;
+
+/// @brief Zoom levels of an io::Spectrogram, the hop of each is kSpectrogramFanout times the one below.
+constexpr size_t kSpectrogramLevels = 6;
+
+/// @brief Hop ratio between two zoom levels of an io::Spectrogram (512 / 2048 / ... / 524288 frames).
+constexpr size_t kSpectrogramFanout = 4;
+
+/// @brief Windows whose power is averaged into one column once the hop is longer than the window.
+constexpr size_t kSpectrogramColumnWindows = 4;
+
+/// @brief Columns computed per thread pool task.
+constexpr size_t kSpectrogramTaskColumns = 16;
+
+/// @brief Default bytes of tiles an io::Spectrogram keeps (128 MiB), the least recently used go first.
+constexpr size_t kSpectrogramCacheBudget = 128ull * 1024 * 1024;
+
+// -----------------------------
+// File IO Constants
+// -----------------------------
+
+/// @brief Frames (de)interleaved / converted per step by the file readers and writers,
+/// small enough for the interleaved chunk and the channels to stay in L2.
+constexpr size_t kIOChunkFrames = 8192;
+
+/// @brief Chunks of kIOChunkFrames a mapped file reader asks the kernel to read ahead of the chunk it converts.
+constexpr size_t kLoadReadAheadChunks = 4;
+
+/// @brief Frames of a mapped file one worker of AudioFile::setReadPool() converts at a time (~5 s at 48 kHz).
+constexpr size_t kLoadStretchFrames = 32 * kIOChunkFrames;
+
+/// @brief Largest number of samples per channel in one MP3 frame (MPEG-1 Layer III).
+constexpr size_t kMP3MaxFrameSamples = 1152;
+
+/// @brief Packets before its run a segment decoder of io::MP3_File decodes and drops, to fill the bit
+/// reservoir (up to 511 bytes back, several frames at low bitrates) and the filter bank overlap.
+constexpr size_t kMP3SegmentPrimePackets = 8;
+
+/// @brief Least packets per segment of a parallel io::MP3_File decode (~6.7 s at 44.1 kHz), shorter files use fewer segments.
+constexpr size_t kMP3SegmentMinPackets = 256;
+
+/// @brief Packets per point of an io::SeekIndex (~0.4 s of MP3), also the packets priming the decoder after an indexed seek.
+constexpr size_t kSeekIndexStride = 16;
+static_assert(kSeekIndexStride >= kMP3SegmentPrimePackets, "an indexed seek must prime the decoder like a segment");
+
+/// @brief Encoder frames (and packets) preallocated per stage by io::Mp3StreamEncoder.
+constexpr size_t kMp3PipelineFrames = 8;
+
+/// @brief Longest time io::Mp3StreamEncoder::run() waits for workers to start its stages before it runs them inline.
+constexpr std::chrono::milliseconds kMp3StageWaitTimeout{20};
+
+/// @brief Alignment (in bytes) of every channel in an io::DecodeCache entry, one page so a channel can be mapped alone.
+constexpr size_t kDecodeCacheAlignment = 4096;
+
 // -----------------------------
 // Reverb Configuration Constants
 // -----------------------------
@@ -21,6 +112,9 @@ constexpr int8_t kCombFilters = 4;
 /// @brief Number of all-pass filters used in the reverb effect.
 constexpr int8_t kAllPassFilters = 2;
 
+/// @brief Frames the reverb renders per chunk (comb bank output lives on the stack).
+constexpr size_t kReverbChunkFrames = 256;
+
 /// @brief Minimum delay (in samples or ms, depending on usage) for the reverb effect.
 constexpr short REVERB_DELAY_MIN = 20;
 
@@ -64,6 +158,233 @@ constexpr float COMB_FILTER_2_DELAY = 19.31f;
 /// @brief Delay time for the third comb filter.
 constexpr float COMB_FILTER_3_DELAY = -7.97f;
 
+// -----------------------------
+// FFT Constants
+// -----------------------------
+
+/// @brief Smallest size of a dsp::fft::Plan (real samples).
+constexpr size_t kFFTMinSize = 4;
+
+/// @brief Largest size of a dsp::fft::Plan (real samples), 2^24.
+constexpr size_t kFFTMaxSize = static_cast<size_t>(1) << 24;
+
+// -----------------------------
+// Convolution Reverb Constants
+// -----------------------------
+
+/// @brief Smallest head partition (frames) of the convolution reverb.
+constexpr size_t kConvolutionMinPartition = 32;
+
+/// @brief Largest partition (frames) of the convolution reverb, head or tail.
+constexpr size_t kConvolutionMaxPartition = 16384;
+
+/// @brief Longest impulse response (frames per channel) accepted by the convolution reverb.
+constexpr size_t kConvolutionMaxImpulseFrames = 1 << 22;
+
+
+// -----------------------------
+// Multi-Tap Echo Constants
+// -----------------------------
+
+/// @brief Largest number of taps of the multi-tap echo.
+constexpr size_t kEchoMaxTaps = 8;
+
+/// @brief Largest feedback of the multi-tap echo (< 1 so the repeats die out).
+constexpr float kEchoMaxFeedback = 0.95f;
+
+/// @brief Frames the multi-tap echo renders per chunk (tap sums live on the stack).
+constexpr size_t kEchoChunkFrames = 256;
+
+// -----------------------------
+// Pitch Shift Constants
+// -----------------------------
+
+/// @brief Largest shift of the pitch shift effect, up or down, in semitones (two octaves).
+constexpr float kPitchMaxSemitones = 24.0f;
+
+/// @brief Smallest phase vocoder frame (samples) of the pitch shift effect.
+constexpr size_t kPitchMinFrame = 256;
+
+/// @brief Largest phase vocoder frame (samples) of the pitch shift effect.
+constexpr size_t kPitchMaxFrame = 8192;
+
+/// @brief Overlapping frames of the phase vocoder (hop = frame / oversampling).
+constexpr size_t kPitchOversampling = 4;
+
+/// @brief Spectral peaks quieter than this fraction of the loudest bin (-60 dB) don't get a region of their own.
+constexpr float kPitchPeakFloor = 1e-3f;
+
+/// @brief Frames per segment when the pitch shift splits a long range across the thread pool.
+constexpr size_t kPitchSegmentFrames = 1 << 18;
+
+// -----------------------------
+// Time Stretch Constants
+// -----------------------------
+
+/// @brief Slowest tempo factor of the time stretch effect (4x longer).
+constexpr float kStretchMinRate = 0.25f;
+
+/// @brief Fastest tempo factor of the time stretch effect (4x shorter).
+constexpr float kStretchMaxRate = 4.0f;
+
+/// @brief Smallest WSOLA frame (samples) of the time stretch effect.
+constexpr size_t kStretchMinFrame = 128;
+
+/// @brief Largest WSOLA frame (samples) of the time stretch effect.
+constexpr size_t kStretchMaxFrame = 8192;
+
+/// @brief Output frames per segment when the time stretch splits a long range across the thread pool.
+constexpr size_t kStretchSegmentFrames = 1 << 18;
+
+// -----------------------------
+// Resample Constants
+// -----------------------------
+
+/// @brief Lowest samplerate the engine reads, converts and writes.
+constexpr uint32_t kMinSamplerate = 8000;
+
+/// @brief Highest samplerate the engine reads, converts and writes.
+constexpr uint32_t kMaxSamplerate = 192000;
+
+/// @brief Zero crossings of the windowed sinc on each side of its centre (taps = 2x when upsampling).
+constexpr size_t kResampleZeroCrossings = 32;
+
+/// @brief Passband edge as a fraction of the lower Nyquist frequency of the two rates.
+constexpr double kResampleRolloff = 0.945;
+
+/// @brief Kaiser window shape of the sinc (~-100 dB stopband).
+constexpr double kResampleKaiserBeta = 9.5;
+
+/// @brief Largest number of filter phases (output rate / gcd of the rates), bigger ratios are rejected.
+constexpr size_t kResampleMaxPhases = 4096;
+
+/// @brief Input frames the streaming resampler converts per step.
+constexpr size_t kResampleChunkFrames = 1024;
+
+/// @brief Output frames per segment when an offline conversion is split across the thread pool.
+constexpr size_t kResampleSegmentFrames = 1 << 16;
+
+// -----------------------------
+// Equalizer Constants
+// -----------------------------
+
+/// @brief Most bands of one equalizer (with kNumChannels channels they fill the lanes of the biquad kernel).
+constexpr size_t kEqMaxBands = 8;
+
+/// @brief Lowest centre / corner frequency of an equalizer band, in Hz.
+constexpr float kEqMinFrequency = 10.0f;
+
+/// @brief Largest boost or cut of a shelf or peaking band, in dB.
+constexpr float kEqMaxGainDb = 24.0f;
+
+/// @brief Widest band (quality factor).
+constexpr float kEqMinQ = 0.1f;
+
+/// @brief Narrowest band (quality factor).
+constexpr float kEqMaxQ = 24.0f;
+
+// -----------------------------
+// Dynamics Constants
+// -----------------------------
+
+/// @brief Lowest compressor threshold, in dBFS.
+constexpr float kDynamicsMinThresholdDb = -60.0f;
+
+/// @brief Strongest compression ratio (20:1 is limiting).
+constexpr float kDynamicsMaxRatio = 20.0f;
+
+/// @brief Widest soft knee of the compressor, in dB.
+constexpr float kDynamicsMaxKneeDb = 24.0f;
+
+/// @brief Largest makeup gain, in dB.
+constexpr float kDynamicsMaxMakeupDb = 24.0f;
+
+/// @brief Lowest limiter ceiling, in dBFS.
+constexpr float kDynamicsMinCeilingDb = -24.0f;
+
+/// @brief Longest attack of the compressor, in milliseconds.
+constexpr float kDynamicsMaxAttackMs = 500.0f;
+
+/// @brief Longest release of the compressor and the limiter, in milliseconds.
+constexpr float kDynamicsMaxReleaseMs = 5000.0f;
+
+/// @brief Longest lookahead (and latency) of the limiter, in milliseconds.
+constexpr float kDynamicsMaxLookaheadMs = 20.0f;
+
+/// @brief Frames the dynamics processor detects and applies gains for at a time (per-frame gain arrays on the stack).
+constexpr size_t kDynamicsChunkFrames = 512;
+
+// -----------------------------
+// Gate and Silence Constants
+// -----------------------------
+
+/// @brief Lowest gate (and silence) threshold, in dBFS.
+constexpr float kGateMinThresholdDb = -96.0f;
+
+/// @brief Deepest attenuation of a closed gate, in dB.
+constexpr float kGateMinRangeDb = -96.0f;
+
+/// @brief Level under the threshold a gate closes at once open, in dB, so it doesn't chatter on a steady level.
+constexpr float kGateHysteresisDb = 6.0f;
+
+/// @brief Longest attack of the gate, in milliseconds.
+constexpr float kGateMaxAttackMs = 500.0f;
+
+/// @brief Longest hold of the gate, in milliseconds.
+constexpr float kGateMaxHoldMs = 5000.0f;
+
+/// @brief Longest release of the gate, in milliseconds.
+constexpr float kGateMaxReleaseMs = 5000.0f;
+
+/// @brief Default silence level of an auto-trim, in dBFS.
+constexpr float kTrimThresholdDb = -60.0f;
+
+/// @brief Default shortest leading / trailing silence an auto-trim removes, in milliseconds.
+constexpr float kTrimMinSilenceMs = 100.0f;
+
+/// @brief Default silence an auto-trim keeps next to the sound, in milliseconds.
+constexpr float kTrimPadMs = 20.0f;
+
+/// @brief Limiter ceiling of the RMS and LUFS normalizations, in dBFS (dBTP for LUFS, the EBU R128 maximum).
+constexpr float kNormalizationCeilingDb = -1.0f;
+
+/// @brief Limiter lookahead of the RMS normalization, in milliseconds.
+constexpr float kNormalizationLookaheadMs = 5.0f;
+
+/// @brief Limiter release of the RMS normalization, in milliseconds.
+constexpr float kNormalizationReleaseMs = 80.0f;
+
+// -----------------------------
+// Loudness Constants (ITU-R BS.1770 / EBU R128)
+// -----------------------------
+
+/// @brief Hop between gating blocks, in milliseconds (75% overlap).
+constexpr double kLoudnessStepMs = 100.0;
+
+/// @brief Hops per gating block (400 ms).
+constexpr size_t kLoudnessBlockSteps = 4;
+
+/// @brief Absolute gate, blocks at or below it don't count, in LUFS.
+constexpr double kLoudnessAbsoluteGateLufs = -70.0;
+
+/// @brief Relative gate, below the loudness of the blocks over the absolute gate, in LU.
+constexpr double kLoudnessRelativeGateLu = 10.0;
+
+/// @brief Hops measured per thread pool task.
+constexpr size_t kLoudnessChunkSteps = 64;
+
+/// @brief Oversampling of the true peak interpolator.
+constexpr size_t kLoudnessOversampling = 4;
+
+/// @brief Quietest target of the LUFS normalization, in LUFS.
+constexpr float kLoudnessMinTargetLufs = -70.0f;
+
+// -----------------------------
+// Distortion Constants
+// -----------------------------
+
+/// @brief Drive multiplier of the negative half-wave for the Asymmetric distortion.
+constexpr float DISTORTION_ASYMMETRIC_DRIVE = 2.0f;
 
 // -----------------------------
 // Recording Buffer Constants
@@ -71,6 +392,97 @@ constexpr float COMB_FILTER_3_DELAY = -7.97f;
 
 constexpr float BUFFER_SECONDS = 5.33 / 1000; // 5.33ms
 
+/// @brief Longest time a FileStreamer stays parked on its queue before it re-checks the stop flag.
+constexpr std::chrono::milliseconds kStreamerWakeTimeout{10};
+
+/// @brief Buffers a FileStreamer moves per Queue::popBatch() / BufferPool::pushBatch() when it drains its queue.
+constexpr size_t kStreamerBatch = 32;
+
+/// @brief Maximum number of emergency reserve buffers the record callback can hold.
+constexpr size_t kRecordReserveMax = 16;
+
+/// @brief Slowest record callbacks a record::CallbackProfiler keeps (see Recorder::callbackProfile()).
+constexpr size_t kRecordWorstCallbacks = 8;
+
+/// @brief Default disk writer threads of a record::MultiRecorder, shared by all its tracks.
+constexpr size_t kRecordWriterThreads = 2;
+
+/// @brief Most input channels a record::MultiRecorder opens on one device.
+constexpr int kRecordMaxDeviceChannels = 64;
+
+/// @brief Alignment (offset and size) of the batches of io::WavStreamWriter, the O_DIRECT block size.
+constexpr size_t kStreamWriteAlignment = 4096;
+
+/// @brief Default bytes coalesced per disk write by io::WavStreamWriter (~3 s of stereo float at 44.1 kHz).
+constexpr size_t kStreamWriteBatchBytes = 1 << 20;
+
+/// @brief Frames per block of AJ_Engine::processFile().
+constexpr size_t kProcessFileBlockFrames = 16384;
+
+/// @brief Blocks AJ_Engine::processFile() keeps in flight between the reader and the chain: its whole memory.
+constexpr size_t kProcessFileInflightBlocks = 8;
+
+// -----------------------------
+// Live Parameter / Automation Constants
+// -----------------------------
+
+/// @brief Frames a live gain-type parameter ramps over to its new value (~11.6 ms at 44.1 kHz), no zipper noise.
+constexpr uint32_t kParamSmoothFrames = 512;
+
+/// @brief Frames between two exact evaluations of an exponential / S-curve automation segment, linear in between.
+constexpr size_t kAutomationRampFrames = 64;
+
+// -----------------------------
+// Playback Constants
+// -----------------------------
+
+/// @brief Frames per PortAudio output callback.
+constexpr size_t kPlayFramesPerBuffer = 256;
+
+/// @brief Default read-ahead depth of the playback ring (frames, rounded up to a power of two).
+constexpr size_t kPlayPrefetchFrames = 16384;
+
+/// @brief Frames the read-ahead thread pulls from the source per step.
+constexpr size_t kPlayReadBlockFrames = 2048;
+
+/// @brief Sleep of the read-ahead thread while the ring is full (or the source has ended).
+constexpr std::chrono::milliseconds kPlayReaderIdle{2};
+
+// -----------------------------
+// Audio Device Constants
+// -----------------------------
+
+/// @brief Frames per buffer of io::device::DeviceConfig::tracking() (0.67 ms at 48 kHz).
+constexpr size_t kDeviceTrackingFrames = 32;
+
+/// @brief Frames per buffer of io::device::DeviceConfig::safe() (42.7 ms at 48 kHz).
+constexpr size_t kDeviceSafeFrames = 2048;
+
+/// @brief Suggested latency of io::device::DeviceConfig::safe(), in seconds.
+constexpr double kDeviceSafeLatency = 0.1;
+
+/// @brief Default seconds of audio the record pool and queue hold while the disk writer lags.
+constexpr double kDeviceBufferedSeconds = 2.0;
+
+/// @brief Fewest and most buffers a device configuration sizes the record pool to.
+constexpr size_t kDeviceMinBuffers = 16;
+constexpr size_t kDeviceMaxBuffers = 1 << 16;
+
+/// @brief Frames of the noise burst played by the loopback calibration.
+constexpr size_t kCalibrationProbeFrames = 2048;
+
+/// @brief Silence before the calibration burst, lets the stream settle.
+constexpr double kCalibrationLeadSeconds = 0.25;
+
+/// @brief Longest round trip the calibration can measure, in seconds.
+constexpr double kCalibrationWindowSeconds = 1.0;
+
+/// @brief Correlation peak over its RMS below which the burst counts as not heard (noise peaks stay under ~5).
+constexpr float kCalibrationMinConfidence = 10.0f;
+
+/// @brief Longest wait for the calibration stream to capture its window.
+constexpr std::chrono::milliseconds kCalibrationTimeout{5000};
+
 // -----------------------------
 // Common CPU cache line sizes
 // -----------------------------
@@ -88,4 +500,179 @@ constexpr float BUFFER_SECONDS = 5.33 / 1000; // 5.33ms
 //* this for false sharing. producer consumer patterns.
 constexpr size_t CACHE_LINE_SIZE = std::hardware_destructive_interference_size; 
 
+// -----------------------------
+// Buffer Pool Memory Constants
+// -----------------------------
+
+/// @brief Alignment (in bytes) of every pooled audio buffer, one cache line / one AVX-512 register.
+constexpr size_t kBufferAlignment = 64;
+
+/// @brief Huge page size used for the buffer pool slab when huge pages are requested (2 MiB).
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+/// @brief Largest FixedRingBuffer kept inside the object, bigger ones allocate their samples once at construction.
+constexpr size_t kFixedRingInlineBytes = 16 * 1024;
+
+/// @brief Period of the ElasticBufferPool maintenance (refill, growth, shrink), the low watermarks must cover it.
+constexpr std::chrono::milliseconds kElasticPoolPeriod{5};
+
+/// @brief Maintenance passes a size class must stay well above its low watermark before it shrinks (2 s).
+constexpr size_t kElasticPoolIdlePasses = 400;
+
+// -----------------------------
+// Engine Resources Constants
+// -----------------------------
+
+/// @brief Default buffers and frames per buffer of the mono and stereo record pools of EngineResources.
+constexpr size_t kEngineStreamBuffers = 1024;
+constexpr size_t kEngineStreamFrames = 1024;
+
+/// @brief Threads of the EngineResources I/O pool, and its minimum: a playback read-ahead plus an event handler.
+constexpr size_t kEngineIoThreads = 2;
+
+/// @brief SCHED_FIFO priority of ThreadPriority::Realtime threads, under the audio driver threads (80 and up).
+constexpr int kRealtimeThreadPriority = 70;
+
+/// @brief Nice value of ThreadPriority::High threads.
+constexpr int kHighThreadNice = -10;
+
+/// @brief Nice value of ThreadPriority::Low threads.
+constexpr int kLowThreadNice = 10;
+
+// -----------------------------
+// Scratch Arena Constants
+// -----------------------------
+
+/// @brief Size of the first block of a scratch arena (256 KiB), bigger requests get a block of their size.
+constexpr size_t kScratchBlockBytes = 256 * 1024;
+
+// -----------------------------
+// Metrics, Trace and Realtime Constants
+// -----------------------------
+
+/// @brief Shards of a MetricsRegistry: threads are spread over them, so up to this many never share a line.
+constexpr size_t kMetricShards = 8;
+
+/// @brief Buckets per power of two of a latency histogram (values within 1/8 of the truth).
+constexpr size_t kMetricSubBuckets = 8;
+
+/// @brief Powers of two a latency histogram covers in nanoseconds (2^40 ns is about 18 minutes, longer saturates).
+constexpr size_t kMetricMaxExponent = 40;
+
+/// @brief Events kept per thread while tracing (1 MiB each), older events are overwritten.
+constexpr size_t kTraceThreadEvents = 32768;
+
+/// @brief Violations a utils::RealtimeGuard can hold before it reports them, more are only counted.
+constexpr size_t kRealtimeViolationSlots = 64;
+
+/// @brief Frames of the backtrace kept per realtime violation.
+constexpr size_t kRealtimeStackDepth = 24;
+
+/// @brief Time between two reports of a utils::RealtimeGuard.
+constexpr std::chrono::milliseconds kRealtimeReportPeriod{50};
+
+// -----------------------------
+// Error Channel Constants
+// -----------------------------
+
+/// @brief Integer arguments an error::Event carries for the `{}` of its format.
+constexpr size_t kErrorEventArgs = 4;
+
+/// @brief Bytes of message an error::ErrorChannel keeps from an onError() call (longer ones are cut).
+constexpr size_t kErrorEventTextBytes = 120;
+
+/// @brief Default events an error::ErrorChannel holds before it drains them, more are only counted.
+constexpr size_t kErrorChannelCapacity = 256;
+
+/// @brief Events of one code an error::ErrorChannel lets through per kErrorChannelWindow, more are only counted.
+constexpr uint32_t kErrorChannelBurst = 8;
+
+/// @brief Rate limiting window of an error::ErrorChannel.
+constexpr std::chrono::milliseconds kErrorChannelWindow{1000};
+
+/// @brief Time between two drains of an error::ErrorChannel running its own reporter.
+constexpr std::chrono::milliseconds kErrorChannelPeriod{50};
+
+/// @brief Error codes an error::ErrorChannel counts separately (codes are below 700).
+constexpr size_t kErrorCodeSlots = 700;
+
+// -----------------------------
+// Undo Constants
+// -----------------------------
+
+/// @brief Default bytes of saved samples the undo history keeps in memory (512 MiB), older states spill or drop.
+constexpr size_t kUndoDefaultBudget = 512ull * 1024 * 1024;
+
+/// @brief Default number of undo states kept, older ones are dropped.
+constexpr size_t kUndoDefaultMaxStates = 100;
+
+// -----------------------------
+// Project Store Constants
+// -----------------------------
+
+/// @brief Alignment of the chunks of a project's sample file, every channel maps from a page boundary.
+constexpr size_t kProjectAlignment = 4096;
+
+// -----------------------------
+// Render Graph Constants
+// -----------------------------
+
+/// @brief Frames per chunk a render graph computes and caches its effects in.
+constexpr size_t kRenderChunkFrames = 8192;
+
+/// @brief Default bytes of rendered chunks a render graph keeps (256 MiB), the least recently read go first.
+constexpr size_t kRenderCacheBudget = 256ull * 1024 * 1024;
+
+// -----------------------------
+// Preview Render Constants
+// -----------------------------
+
+/// @brief Frames per window a preview renderer renders and swaps at once (about 0.7 s at 48 kHz).
+constexpr size_t kPreviewWindowFrames = 4 * kRenderChunkFrames;
+static_assert(kPreviewWindowFrames % kRenderChunkFrames == 0, "preview windows must cover whole render chunks");
+
+/// @brief Seconds of history the effects with memory hear before a preview window (their tail is cut there).
+constexpr float kPreviewTailSeconds = 0.5f;
+
+/// @brief Default samplerate divisor of previews, the reduced rate never goes under kMinSamplerate.
+constexpr uint32_t kPreviewDecimation = 4;
+
+/// @brief Windows from the playhead the background thread previews before rendering at full quality.
+constexpr size_t kPreviewLeadWindows = 4;
+
+// -----------------------------
+// Mixer Constants
+// -----------------------------
+
+/// @brief Frames per block a session renders its tracks in (about 85 ms at 48 kHz).
+constexpr size_t kMixBlockFrames = 4096;
+
+/// @brief Default maximum number of tracks of a session, one pooled block buffer each.
+constexpr size_t kMixMaxTracks = 128;
+
+/// @brief Frames of the master summed per task, the tracks are summed slice by slice.
+constexpr size_t kMixSumFrames = 1024;
+
+/// @brief Default bytes of rendered track blocks a mixer render cache keeps in memory (256 MiB).
+constexpr size_t kMixCacheBudget = 256ull * 1024 * 1024;
+
+/// @brief Default bytes of track blocks a render cache keeps spilled on disk (1 GiB), the oldest are deleted.
+constexpr size_t kMixCacheSpillBudget = 1024ull * 1024 * 1024;
+
+/// @brief Blocks in flight between the stages of an export (render, conversion, writing).
+constexpr size_t kExportInflightBlocks = 8;
+
+// -----------------------------
+// Batch Constants
+// -----------------------------
+
+/// @brief Default decoded bytes a batch holds at once (1 GiB), further files wait for the running ones.
+constexpr size_t kBatchMemoryBudget = 1024ull * 1024 * 1024;
+
+/// @brief Default files a batch of AJ_Engine::loadAudioAsync() decodes at the same time.
+constexpr size_t kAsyncLoadInFlight = 4;
+
+/// @brief Default decoded bytes of the files a batch of AJ_Engine::loadAudioAsync() has in flight (512 MiB).
+constexpr size_t kAsyncLoadMemoryBudget = 512ull * 1024 * 1024;
+
 };
@@ -0,0 +1,226 @@
+#pragma once
+#include "buffer_pool.h"
+#include "metrics.h"
+#include "error_handler.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AJ::utils {
+
+/**
+ * @brief One buffer size of an ElasticBufferPool and how its count may change.
+ */
+struct SizeClass {
+    size_t frames = 1024;       ///< frames per buffer.
+    uint8_t channels = 2;       ///< 1 or 2.
+    size_t initial = 64;        ///< buffers allocated by the constructor, the class never shrinks below.
+    size_t lowWatermark = 16;   ///< free buffers under which the maintenance adds growBy more.
+    size_t growBy = 16;         ///< buffers added per maintenance pass.
+    size_t max = 1024;          ///< hard cap of buffers of the class.
+};
+
+/**
+ * @brief Counters of one size class, see ElasticBufferPool::stats().
+ */
+struct SizeClassStats {
+    size_t buffers = 0;         ///< allocated now.
+    size_t free = 0;            ///< ready for take(), returned buffers not yet recycled included.
+    size_t peakInUse = 0;       ///< most buffers out at once.
+    uint64_t taken = 0;         ///< take() calls that got a buffer.
+    uint64_t misses = 0;        ///< take() calls that found the class empty.
+    uint64_t grown = 0;         ///< buffers allocated past `initial`.
+    uint64_t shrunk = 0;        ///< buffers freed (idle shrink and trim()).
+    uint64_t capped = 0;        ///< refills refused by the class `max` or the pool budget.
+};
+
+/**
+ * @class ElasticBufferPool
+ * @brief Buffers of several sizes under one memory budget, refilled and resized off the audio thread.
+ *
+ * A BufferPool has one buffer size and count for its lifetime, and pop() returns nullptr once it's
+ * empty. Here every SizeClass has its own lock-free free list. take() and give() never allocate, lock
+ * or wait. A maintenance pass, run every kElasticPoolPeriod by a background thread (or by calling
+ * maintain()), does everything else:
+ * - recycles the given back buffers into the free list;
+ * - allocates `growBy` buffers when a class is below its low watermark or missed since the last
+ *   pass, as long as the class stays under `max` and the whole pool under its byte budget;
+ * - once a class stayed well above its watermark for kElasticPoolIdlePasses passes, frees the
+ *   buffers given back instead of recycling them, down to `initial`.
+ *
+ * Buffers sitting in the free list are only freed by trim(), on a class nobody takes from.
+ *
+ * A size class has one taker and one giver at a time (the lists are SPSC), e.g. a record callback
+ * and its disk writer. A 5 ms record class and a 64k-frame offline class share the budget: what one
+ * doesn't use, the other may grow into.
+ *
+ * ## Example:
+ * @code
+ * std::vector<AJ::utils::SizeClass> classes(2);
+ * classes[0].frames = 256;   classes[0].initial = 128; classes[0].max = 4096;   // record blocks
+ * classes[1].frames = 65536; classes[1].initial = 2;   classes[1].max = 32;     // offline blocks
+ *
+ * AJ::utils::ElasticBufferPool pool(handler, classes, 64 * 1024 * 1024);
+ * const size_t record = pool.classFor(256, 2);
+ *
+ * Buffer *block = pool.take(record);      // audio thread
+ * // ... queue it, write it ...
+ * pool.give(block);                       // writer thread
+ * @endcode
+ */
+class ElasticBufferPool {
+private:
+    /// @brief Lists, buffers and counters of one SizeClass.
+    struct Class {
+        SizeClass mSpec;
+        size_t mSamples = 0;                        ///< samples of a buffer (frames * channels).
+        size_t mBytes = 0;                          ///< storage bytes of a buffer.
+
+        std::shared_ptr<Queue> pFree;               ///< taker <- maintenance.
+        std::shared_ptr<Queue> pReturned;           ///< giver -> maintenance.
+        std::vector<std::unique_ptr<Buffer>> mOwned; ///< every allocated buffer (maintenance only).
+
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> mTaken{0};
+        std::atomic<uint64_t> mMisses{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> mBuffers{0};
+        std::atomic<size_t> mPeakInUse{0};
+        std::atomic<uint64_t> mGrown{0};
+        std::atomic<uint64_t> mShrunk{0};
+        std::atomic<uint64_t> mCapped{0};
+
+        size_t mIdlePasses = 0;                     ///< consecutive passes well above the watermark.
+        uint64_t mReportedMisses = 0;               ///< misses already added to the metrics.
+    };
+
+    std::vector<std::unique_ptr<Class>> mClasses;
+    size_t mBudget = 0;                             ///< bytes all the classes may hold together.
+    std::atomic<size_t> mBytes{0};
+    bool mValid = false;
+
+    std::mutex mMaintain;                           ///< One maintain() / trim() at a time.
+    std::shared_ptr<MetricsRegistry> pMetrics;
+
+    std::thread mWorker;
+    std::mutex mWorkerMux;
+    std::condition_variable mWorkerWake;
+    bool mStop = false;
+
+    /**
+     * @brief Allocate up to `count` buffers of a class into its free list (mMaintain held).
+     * @return buffers added, fewer if the class cap or the budget was reached.
+     */
+    size_t grow(Class &cls, size_t count);
+
+    /// @brief Free one buffer of a class that nobody holds (mMaintain held).
+    void release(Class &cls, Buffer *buffer);
+
+    /// @brief Buffers of `cls` that are neither in the free list nor given back.
+    static size_t inUse(Class &cls) noexcept {
+        const size_t home = cls.pFree->currentSize() + cls.pReturned->currentSize();
+        const size_t buffers = cls.mBuffers.load(std::memory_order_relaxed);
+        return buffers > home ? buffers - home : 0;
+    }
+
+public:
+    /**
+     * @brief Allocate the initial buffers of every class, start the maintenance thread.
+     *
+     * @param classes     distinct buffer sizes, any order.
+     * @param budget      bytes of buffer storage all the classes may hold together.
+     * @param background  false: no thread, the owner calls maintain() (tests, offline tools).
+     *
+     * @note call `isValid()` right after construction, the errors went to `handler`
+     *       (bad class, initial buffers over the budget, allocation failure).
+     */
+    ElasticBufferPool(AJ::error::IErrorHandler& handler, const std::vector<SizeClass>& classes,
+                      size_t budget, bool background = true);
+
+    /**
+     * @brief Stop the maintenance and free every buffer, all of them must have been given back.
+     */
+    ~ElasticBufferPool();
+
+    ElasticBufferPool(const ElasticBufferPool&) = delete;
+    ElasticBufferPool& operator=(const ElasticBufferPool&) = delete;
+
+    /// @brief Whether construction succeeded.
+    bool isValid() const noexcept {
+        return mValid;
+    }
+
+    /**
+     * @brief Smallest class whose buffers hold `frames` frames of `channels` channels.
+     * @return its index, or classCount() if none does.
+     */
+    size_t classFor(size_t frames, uint8_t channels) const noexcept;
+
+    /// @brief Size classes, by increasing buffer size.
+    size_t classCount() const noexcept {
+        return mClasses.size();
+    }
+
+    /// @brief Spec of a class, `max` as given.
+    const SizeClass& sizeClass(size_t cls) const noexcept {
+        return mClasses[cls]->mSpec;
+    }
+
+    /**
+     * @brief A free buffer of a class (realtime safe, lock-free, single taker per class).
+     * @return nullptr (counted as a miss) if the class is empty.
+     */
+    Buffer* take(size_t cls) noexcept;
+
+    /**
+     * @brief Give a taken buffer back (lock-free, single giver per class).
+     *
+     * The buffer is recycled, or freed when its class shrinks, by the next maintenance pass.
+     * @return false for a buffer of no class of this pool.
+     */
+    bool give(Buffer *buffer) noexcept;
+
+    /**
+     * @brief One maintenance pass over every class: recycle, grow, shrink, report to the metrics.
+     *
+     * Runs on the background thread every kElasticPoolPeriod, call it directly without one.
+     */
+    void maintain();
+
+    /**
+     * @brief Free the buffers of a class sitting in its free list, down to `initial`.
+     *
+     * Takes from the free list: nothing may take() from the class meanwhile (e.g. after its
+     * stream stopped).
+     * @return buffers freed.
+     */
+    size_t trim(size_t cls);
+
+    /**
+     * @brief Counters of a class. Safe to call at any time.
+     */
+    SizeClassStats stats(size_t cls) const noexcept;
+
+    /// @brief Bytes of buffer storage held now, all classes.
+    size_t bytes() const noexcept {
+        return mBytes.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Bytes all the classes may hold together.
+    size_t budget() const noexcept {
+        return mBudget;
+    }
+
+    /**
+     * @brief Registry the maintenance adds the misses, growths, shrinks and bytes to (optional).
+     */
+    void setMetrics(std::shared_ptr<MetricsRegistry> metrics){
+        std::lock_guard<std::mutex> lock(mMaintain);
+        pMetrics = std::move(metrics);
+    }
+};
+
+}
@@ -1,71 +1,247 @@
 #pragma once
+#include <algorithm>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 #include "core/buffer_pool.h"
 #include "core/thread_pool.h"
+#include "core/thread_placement.h"
+#include "core/scratch_arena.h"
+#include "core/metrics.h"
+#include "core/constants.h"
 #include "core/error_handler.h"
+#include "file_io/writer_pool.h"
 
 namespace AJ {
 
+/**
+ * @brief Buffers of one record pool of EngineResources and its queue.
+ */
+struct EngineStreamSizing {
+    size_t buffers = kEngineStreamBuffers;  ///< buffers of the pool, the queue holds as many.
+    size_t frames = kEngineStreamFrames;    ///< frames per buffer, one callback each.
+};
+
+/**
+ * @brief EngineResources::Config: threads per role, record pool sizes and when they are created.
+ *
+ * The setters return the Config, to be chained.
+ */
+struct EngineResourcesConfig {
+    size_t mDspThreads = 0;                     ///< threadPool(), 0 = hardware_concurrency().
+    size_t mIoThreads = kEngineIoThreads;       ///< ioThreadPool(), at least kEngineIoThreads.
+    size_t mDiskThreads = kRecordWriterThreads; ///< diskWriters().
+    EngineStreamSizing mMono;                   ///< bufferPoolMono() / queueMono().
+    EngineStreamSizing mStereo;                 ///< bufferPoolStereo() / queueStereo().
+    bool mLazy = true;                          ///< false: everything is created by the constructor.
+
+    AJ::utils::ThreadPlacement mDspPlacement;   ///< workers of threadPool().
+    AJ::utils::ThreadPlacement mIoPlacement;    ///< workers of ioThreadPool().
+    AJ::utils::ThreadPlacement mDiskPlacement;  ///< diskWriters() and the recorder's writer, the record pools follow its node.
+
+    EngineResourcesConfig& dspThreads(size_t threads) noexcept { mDspThreads = threads; return *this; }
+    EngineResourcesConfig& ioThreads(size_t threads) noexcept { mIoThreads = threads; return *this; }
+    EngineResourcesConfig& diskThreads(size_t threads) noexcept { mDiskThreads = threads; return *this; }
+    EngineResourcesConfig& monoStream(size_t buffers, size_t frames) noexcept { mMono = EngineStreamSizing{ buffers, frames }; return *this; }
+    EngineResourcesConfig& stereoStream(size_t buffers, size_t frames) noexcept { mStereo = EngineStreamSizing{ buffers, frames }; return *this; }
+    EngineResourcesConfig& lazy(bool on) noexcept { mLazy = on; return *this; }
+    EngineResourcesConfig& dspPlacement(AJ::utils::ThreadPlacement placement) { mDspPlacement = std::move(placement); return *this; }
+    EngineResourcesConfig& ioPlacement(AJ::utils::ThreadPlacement placement) { mIoPlacement = std::move(placement); return *this; }
+    EngineResourcesConfig& diskPlacement(AJ::utils::ThreadPlacement placement) { mDiskPlacement = std::move(placement); return *this; }
+
+    /**
+     * @brief Offline processing: small record pools, created only if something records anyway.
+     */
+    static EngineResourcesConfig transcode() noexcept {
+        return EngineResourcesConfig().monoStream(64, kEngineStreamFrames).stereoStream(64, kEngineStreamFrames);
+    }
+
+    /**
+     * @brief A recording application: every pool and thread exists before the first take.
+     */
+    static EngineResourcesConfig recording() noexcept {
+        return EngineResourcesConfig().lazy(false);
+    }
+};
+
 /**
  * @class EngineResources
  * @brief Central container that manages and provides access to core engine resources.
  *
  * The EngineResources class encapsulates shared resources required by the audio engine,
- * such as the thread pool, buffer pools, and queues. This ensures that subsystems
+ * such as the thread pools, buffer pools, and queues. This ensures that subsystems
  * (recording, playback, processing) can reuse the same resources in a coordinated manner.
  *
+ * What is created, and how large, comes from a Config. By default every thread pool, buffer
+ * pool and queue is created on first use, so a tool that only transcodes never starts the
+ * I/O threads or allocates the record pools.
+ *
  * ### Resources:
- * - **Thread Pool**: Provides a reusable set of threads to avoid repeated allocation and deallocation overhead.
- * 
- * - **Buffer Pools**: Pre-allocated memory blocks for mono or stereo audio sample storage.
- * 
- * - **Queues**: Lock-free queues for passing audio buffers between producers (e.g., driver callbacks) 
+ * - **Thread Pools**: Provides a reusable set of threads to avoid repeated allocation and deallocation overhead.
+ *   threadPool() runs the DSP jobs (parallel effects, batch, export), ioThreadPool() the playback
+ *   read-ahead and the record / play event handlers, diskWriters() the files of multi-stream recordings.
+ *
+ *   Each role may be pinned to cores and raised in priority with a ThreadPlacement (dspPlacement(),
+ *   ioPlacement(), diskPlacement()); errors go to the handler when the pool is created.
+ *
+ * - **Buffer Pools**: Pre-allocated memory blocks for mono or stereo audio sample storage, on the
+ *   NUMA node of the disk writers when diskPlacement() names one.
+ *
+ * - **Queues**: Lock-free queues for passing audio buffers between producers (e.g., driver callbacks)
  *   and consumers (e.g., file writers, processors).
+ *
+ * - **Scratch Arenas**: Bump allocators for effect and editing temporaries, one leased per engine job
+ *   (see `ScratchPool`), so repeated processing stops allocating once the arenas have grown.
+ *
+ * - **Metrics**: Lock-free counters and latency histograms the recorder, the player, the disk
+ *   writer and the effects update while they run (see `MetricsRegistry`), read with metricsSnapshot().
+ *
+ * ### Example:
+ * @code
+ * // a transcoding tool: 4 DSP threads, nothing else until asked for.
+ * auto resources = std::make_shared<AJ::EngineResources>(handler,
+ *     AJ::EngineResources::Config().dspThreads(4));
+ *
+ * // a recorder: small blocks, everything allocated up front.
+ * auto recorder = std::make_shared<AJ::EngineResources>(handler,
+ *     AJ::EngineResources::Config::recording().stereoStream(4096, 64));
+ *
+ * // a dual-socket server: disk writers and record pools on node 1, DSP on the cores of node 0.
+ * auto server = std::make_shared<AJ::EngineResources>(handler, AJ::EngineResources::Config::recording()
+ *     .diskPlacement(AJ::utils::ThreadPlacement().onNode(1).withPriority(AJ::utils::ThreadPriority::High))
+ *     .dspPlacement(AJ::utils::ThreadPlacement().onNode(0)));
+ * @endcode
  */
 class EngineResources {
+public:
+    using StreamSizing = EngineStreamSizing;
+    using Config = EngineResourcesConfig;
+
 private:
-    std::shared_ptr<AJ::utils::ThreadPool> pThreadPool;       ///< Shared thread pool.
+    Config mConfig;
+    AJ::error::IErrorHandler& mHandler;                       ///< Receives the errors of the lazy creations.
 
-    std::shared_ptr<AJ::utils::BufferPool> pBufferPoolMono;   ///< Buffer pool for mono audio data.
-    std::shared_ptr<AJ::utils::Queue> pQueueMono;             ///< Queue for mono audio streaming.
+    //? the accessors are const and may be the first use, from any thread.
+    mutable std::mutex mMux;
 
-    std::shared_ptr<AJ::utils::BufferPool> pBufferPoolStereo; ///< Buffer pool for stereo audio data.
-    std::shared_ptr<AJ::utils::Queue> pQueueStereo;           ///< Queue for stereo audio streaming.
+    mutable std::shared_ptr<AJ::utils::ThreadPool> pThreadPool;   ///< DSP thread pool.
+    mutable std::shared_ptr<AJ::utils::ThreadPool> pIoThreadPool; ///< Playback and event handler threads.
+    mutable std::shared_ptr<AJ::io::file_streamer::WriterPool> pDiskWriters; ///< Shared disk writers.
+
+    mutable std::shared_ptr<AJ::utils::BufferPool> pBufferPoolMono;   ///< Buffer pool for mono audio data.
+    mutable std::shared_ptr<AJ::utils::Queue> pQueueMono;             ///< Queue for mono audio streaming.
+
+    mutable std::shared_ptr<AJ::utils::BufferPool> pBufferPoolStereo; ///< Buffer pool for stereo audio data.
+    mutable std::shared_ptr<AJ::utils::Queue> pQueueStereo;           ///< Queue for stereo audio streaming.
+
+    std::shared_ptr<AJ::utils::ScratchPool> pScratchPool;     ///< Scratch arenas of the engine jobs.
+
+    std::shared_ptr<AJ::utils::MetricsRegistry> pMetrics;     ///< Runtime metrics of the engine.
+
+    /// @brief The pool and queue of a layout, created if needed (mMux held).
+    void createStream(uint8_t channels) const {
+        std::shared_ptr<AJ::utils::BufferPool> &pool = channels == 1 ? pBufferPoolMono : pBufferPoolStereo;
+        std::shared_ptr<AJ::utils::Queue> &queue = channels == 1 ? pQueueMono : pQueueStereo;
+        const StreamSizing &sizing = channels == 1 ? mConfig.mMono : mConfig.mStereo;
+
+        if(!pool){
+            pool = std::make_shared<utils::BufferPool>(mHandler, sizing.buffers, sizing.frames, channels,
+                                                       false, mConfig.mDiskPlacement.node());
+        }
+        if(!queue){
+            queue = std::make_shared<utils::Queue>(true, sizing.buffers, sizing.frames, channels, mHandler);
+        }
+    }
 
 public:
     /**
-     * @brief Construct engine resources with default pools and queues.
+     * @brief Construct engine resources as `config` describes.
      *
-     * Initializes the following resources:
-     * - Thread pool (at least one thread guaranteed).
-     * - Mono buffer pool and queue.
-     * - Stereo buffer pool and queue.
+     * Creates the scratch arena pool and the metrics registry. The thread pools, the mono and
+     * stereo buffer pools and their queues are created by the first accessor call, or here when
+     * `config.mLazy` is false.
      *
-     * @param handler Reference to an error handler used to report initialization issues.
+     * @param handler Reference to an error handler used to report initialization issues, kept
+     *                for the lazy creations: it must outlive the resources.
+     * @param config  Threads and pool sizes, see Config.
      */
-    EngineResources(AJ::error::IErrorHandler& handler){
-        pThreadPool = std::make_shared<utils::ThreadPool>();
-        pBufferPoolMono = std::make_shared<utils::BufferPool>(handler, 1024, 1024, 1);
-        pBufferPoolStereo = std::make_shared<utils::BufferPool>(handler);
+    explicit EngineResources(AJ::error::IErrorHandler& handler, const Config& config = Config())
+        : mConfig(config), mHandler(handler) {
+
+        pScratchPool = std::make_shared<utils::ScratchPool>();
+        pMetrics = std::make_shared<utils::MetricsRegistry>();
+
+        if(!mConfig.mLazy){
+            threadPool();
+            ioThreadPool();
+            diskWriters();
+            bufferPoolMono();
+            bufferPoolStereo();
+        }
+    }
 
-        pQueueMono = std::make_shared<utils::Queue>(true, 1024, 1024, 1, handler);
-        pQueueStereo = std::make_shared<utils::Queue>(true, 1024, 1024, 2, handler);
+    /**
+     * @brief Configuration the resources are created with.
+     */
+    const Config& config() const noexcept {
+        return mConfig;
     }
 
     /**
-     * @brief Get the shared thread pool.
+     * @brief Get the DSP thread pool (effects, batch jobs, export).
      * @return std::shared_ptr to ThreadPool.
      */
     std::shared_ptr<AJ::utils::ThreadPool> threadPool() const {
+        std::lock_guard<std::mutex> lock(mMux);
+        if(!pThreadPool){
+            const size_t threads = mConfig.mDspThreads ? mConfig.mDspThreads : std::thread::hardware_concurrency();
+            pThreadPool = mConfig.mDspPlacement.isDefault()
+                ? std::make_shared<utils::ThreadPool>(threads)
+                : std::make_shared<utils::ThreadPool>(threads, mConfig.mDspPlacement, mHandler);
+        }
         return pThreadPool;
     }
 
+    /**
+     * @brief Get the I/O thread pool: playback read-ahead and record / play event handlers.
+     *
+     * Kept apart from threadPool() so a long DSP job never delays the start of a playback.
+     * @return std::shared_ptr to ThreadPool.
+     */
+    std::shared_ptr<AJ::utils::ThreadPool> ioThreadPool() const {
+        std::lock_guard<std::mutex> lock(mMux);
+        if(!pIoThreadPool){
+            const size_t threads = std::max(mConfig.mIoThreads, kEngineIoThreads);
+            pIoThreadPool = mConfig.mIoPlacement.isDefault()
+                ? std::make_shared<utils::ThreadPool>(threads)
+                : std::make_shared<utils::ThreadPool>(threads, mConfig.mIoPlacement, mHandler);
+        }
+        return pIoThreadPool;
+    }
+
+    /**
+     * @brief Get the disk writers shared by the multi-stream recordings (see record::InitMultiRecordInfo).
+     * @return std::shared_ptr to WriterPool.
+     */
+    std::shared_ptr<AJ::io::file_streamer::WriterPool> diskWriters() const {
+        std::lock_guard<std::mutex> lock(mMux);
+        if(!pDiskWriters){
+            pDiskWriters = mConfig.mDiskPlacement.isDefault()
+                ? std::make_shared<AJ::io::file_streamer::WriterPool>(mConfig.mDiskThreads)
+                : std::make_shared<AJ::io::file_streamer::WriterPool>(mConfig.mDiskThreads, mConfig.mDiskPlacement, mHandler);
+        }
+        return pDiskWriters;
+    }
+
     /**
      * @brief Get the mono buffer pool.
      * @return std::shared_ptr to BufferPool for mono audio.
      */
     std::shared_ptr<AJ::utils::BufferPool> bufferPoolMono() const {
+        std::lock_guard<std::mutex> lock(mMux);
+        createStream(1);
         return pBufferPoolMono;
     }
 
@@ -74,6 +250,8 @@ public:
      * @return std::shared_ptr to Queue for mono audio streaming.
      */
     std::shared_ptr<AJ::utils::Queue> queueMono() const {
+        std::lock_guard<std::mutex> lock(mMux);
+        createStream(1);
         return pQueueMono;
     }
 
@@ -82,6 +260,8 @@ public:
      * @return std::shared_ptr to BufferPool for stereo audio.
      */
     std::shared_ptr<AJ::utils::BufferPool> bufferPoolStereo() const {
+        std::lock_guard<std::mutex> lock(mMux);
+        createStream(2);
         return pBufferPoolStereo;
     }
 
@@ -90,8 +270,74 @@ public:
      * @return std::shared_ptr to Queue for stereo audio streaming.
      */
     std::shared_ptr<AJ::utils::Queue> queueStereo() const {
+        std::lock_guard<std::mutex> lock(mMux);
+        createStream(2);
         return pQueueStereo;
     }
+
+    /**
+     * @brief Whether the pool and queue of a layout exist yet (1 = mono, 2 = stereo).
+     */
+    bool hasStreamBuffers(uint8_t channels) const {
+        std::lock_guard<std::mutex> lock(mMux);
+        return channels == 1 ? pBufferPoolMono != nullptr : pBufferPoolStereo != nullptr;
+    }
+
+    /**
+     * @brief Replace the mono or stereo pool and queue with `buffers` buffers of `buffer_frames`.
+     *
+     * Used to size the recording path from an audio device configuration (see
+     * io::device::poolSizing()). Not while recording: holders of the old pool keep it alive,
+     * but the new one is only seen by those who ask for it again.
+     *
+     * @return false (and the old pool and queue are kept) if the new ones can't be allocated.
+     */
+    bool resizeStreamBuffers(uint8_t channels, size_t buffers, size_t buffer_frames, AJ::error::IErrorHandler& handler){
+        auto pool = std::make_shared<utils::BufferPool>(handler, buffers, buffer_frames, channels,
+                                                        false, mConfig.mDiskPlacement.node());
+        auto queue = std::make_shared<utils::Queue>(true, buffers, buffer_frames, channels, handler);
+
+        if(!pool->isValid() || !queue->isValid()){
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mMux);
+        (channels == 1 ? mConfig.mMono : mConfig.mStereo) = StreamSizing{ buffers, buffer_frames };
+        (channels == 1 ? pBufferPoolMono : pBufferPoolStereo) = std::move(pool);
+        (channels == 1 ? pQueueMono : pQueueStereo) = std::move(queue);
+        return true;
+    }
+
+    /**
+     * @brief Get the scratch arenas of the engine jobs.
+     * @return std::shared_ptr to ScratchPool.
+     */
+    std::shared_ptr<AJ::utils::ScratchPool> scratchPool() const {
+        return pScratchPool;
+    }
+
+    /**
+     * @brief Get the metrics registry the engine components update.
+     * @return std::shared_ptr to MetricsRegistry.
+     */
+    std::shared_ptr<AJ::utils::MetricsRegistry> metrics() const {
+        return pMetrics;
+    }
+
+    /**
+     * @brief Merged metrics, with the current depth of the stereo queue and the free
+     * buffers of the stereo pool (the recording path). Safe to call while recording.
+     *
+     * Doesn't create the stereo pool, both stay 0 until something used it.
+     */
+    AJ::utils::MetricsSnapshot metricsSnapshot() const {
+        AJ::utils::MetricsSnapshot snapshot = pMetrics->snapshot();
+
+        std::lock_guard<std::mutex> lock(mMux);
+        snapshot.queueDepth = pQueueStereo ? pQueueStereo->currentSize() : 0;
+        snapshot.poolAvailable = pBufferPoolStereo ? pBufferPoolStereo->currentSize() : 0;
+        return snapshot;
+    }
 };
 
 }
@@ -0,0 +1,137 @@
+#pragma once
+#include "error_handler.h"
+#include "constants.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace AJ::error {
+
+/**
+ * @class ErrorChannel
+ * @brief IErrorHandler that queues the errors of hot paths and hands them to another handler later.
+ *
+ * Reporting an error from an audio callback or a per-block loop used to mean building a
+ * std::string and calling the handler right there, e.g. a ConsoleErrorHandler writing to
+ * stderr. A channel only records the event and returns:
+ * - report() / onEvent() copy the code, the format literal and the integer arguments into a
+ *   cell of a bounded lock-free queue (D. Vyukov's MPMC cells, as utils::MPMCQueue) that was
+ *   allocated with the channel. onError() does the same with the first kErrorEventTextBytes
+ *   of its message. Nothing is allocated, locked or formatted.
+ * - Every code has a counter, and lets at most `burst` events through per kErrorChannelWindow:
+ *   the others are only counted. A storm of the same error costs an atomic increment each.
+ * - drain() formats the queued events and calls the sink with them, in order, followed by one
+ *   "N more ... suppressed" line per code that was limited. With start(), a reporter thread
+ *   drains every kErrorChannelPeriod; otherwise the owner drains where it likes (e.g. the
+ *   disk writer loop of the recorder).
+ *
+ * The sink is only called from drain(), one call at a time, so it needn't be thread-safe.
+ * A full queue drops the newest events (counted by dropped()).
+ *
+ * ## Example:
+ * @code
+ * AJ::error::ConsoleErrorHandler console;
+ * AJ::error::ErrorChannel channel(console);
+ * channel.start();
+ *
+ * // audio thread
+ * AJ::error::report(channel, AJ::error::Error::BufferOverflow, "block {} dropped, {} frames.\n", block, frames);
+ * @endcode
+ */
+class ErrorChannel : public IErrorHandler {
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence{0};
+        Event event;
+        char text[kErrorEventTextBytes]; ///< message of an onError() call (hasText).
+        bool hasText = false;
+    };
+
+    /// @brief Counters and rate limit of one code.
+    struct CodeState {
+        std::atomic<uint64_t> count{0};       ///< events reported.
+        std::atomic<uint64_t> suppressed{0};  ///< events the rate limit held back.
+        std::atomic<int64_t> window{0};       ///< start of the current window, ns.
+        std::atomic<uint32_t> passed{0};      ///< events let through in the current window.
+        uint64_t announced = 0;               ///< suppressed events already reported (drain only).
+    };
+
+    IErrorHandler &mSink;
+    std::unique_ptr<Cell[]> pCells;
+    size_t mMask = 0;
+    uint32_t mBurst;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mEnqueuePos{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mDequeuePos{0};
+
+    std::unique_ptr<std::array<CodeState, kErrorCodeSlots>> pCodes;
+    std::atomic<uint64_t> mDropped{0};
+
+    std::mutex mDrainMux;             ///< one drain() at a time.
+
+    std::mutex mMux;                  ///< reporter thread state.
+    std::condition_variable mWake;
+    bool mStop = false;
+    std::thread mReporter;
+
+    /// @brief Counter and rate limit of `code`: true if the event goes into the queue.
+    bool admit(Error code) noexcept;
+
+    /// @brief Copy an event (and its text) into a free cell, false if the queue is full.
+    bool push(const Event &event, const char *text, size_t length) noexcept;
+
+public:
+    /**
+     * @param sink     handler the drained errors go to.
+     * @param capacity events the queue holds (rounded up to a power of two).
+     * @param burst    events of one code let through per kErrorChannelWindow.
+     */
+    explicit ErrorChannel(IErrorHandler &sink, size_t capacity = kErrorChannelCapacity,
+        uint32_t burst = kErrorChannelBurst);
+
+    /// @brief Stops the reporter and drains what is left.
+    ~ErrorChannel() override;
+
+    ErrorChannel(const ErrorChannel&) = delete;
+    ErrorChannel& operator=(const ErrorChannel&) = delete;
+
+    /// @brief Queue the error, the message is cut to kErrorEventTextBytes - 1 bytes. Realtime safe.
+    void onError(Error err, const std::string &errorMessage) override;
+
+    /// @brief Queue the event, it's formatted by drain(). Realtime safe.
+    void onEvent(const Event &event) override;
+
+    /// @brief Start a reporter thread draining every kErrorChannelPeriod (does nothing if running).
+    void start();
+
+    /// @brief Stop the reporter thread after a last drain().
+    void stop();
+
+    /**
+     * @brief Format the queued events and hand them to the sink, then the suppression counts.
+     * @return events handed to the sink.
+     */
+    size_t drain();
+
+    /// @brief Events of `code` reported so far, let through or not.
+    uint64_t count(Error code) const noexcept;
+
+    /// @brief Events of `code` the rate limit held back.
+    uint64_t suppressed(Error code) const noexcept;
+
+    /// @brief Events reported so far, all codes.
+    uint64_t count() const noexcept;
+
+    /// @brief Events lost because the queue was full.
+    uint64_t dropped() const noexcept {
+        return mDropped.load(std::memory_order_relaxed);
+    }
+};
+
+}
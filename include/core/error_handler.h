@@ -1,10 +1,47 @@
 #pragma once 
 
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include "errors.h"
+#include "constants.h"
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace AJ::error {
+
+/**
+ * @brief An error as a code, a format literal and a few integers, built without allocating.
+ *
+ * The message is only formatted (describe()) by whoever finally handles it, so a realtime path
+ * can report through report() and leave the string building to another thread.
+ */
+struct Event {
+    Error code = Error::Success;
+    const char *format = "";             ///< literal (static storage), each `{}` takes the next argument.
+    int64_t args[kErrorEventArgs] = {};  ///< indices, sizes, counts.
+    uint8_t count = 0;                   ///< arguments used.
+};
+
+/**
+ * @brief The message of an event: its format with the `{}` replaced by the arguments in order
+ * (the ones without an argument are left as they are).
+ */
+inline std::string describe(const Event &event){
+    std::string message;
+    size_t next = 0;
+
+    for(const char *c = event.format; *c; ++c){
+        if(c[0] == '{' && c[1] == '}' && next < event.count){
+            message += std::to_string(event.args[next++]);
+            ++c;
+        } else {
+            message += *c;
+        }
+    }
+    return message;
+}
 /**
  * @brief Interface for custom error handling.
  * 
@@ -22,6 +59,16 @@ public:
      */
     virtual void onError(Error err, const std::string &errorMessage) = 0;
 
+    /**
+     * @brief Called by report(): an error whose message isn't formatted yet.
+     *
+     * The default formats it and calls onError(). Handlers that can defer or skip the
+     * formatting (ErrorChannel, CountingErrorHandler) override it.
+     */
+    virtual void onEvent(const Event &event){
+        onError(event.code, describe(event));
+    }
+
     IErrorHandler() = default;
 
     /// @brief Virtual destructor for safe inheritance.
@@ -46,4 +93,106 @@ public:
         std::cerr << errorMessage << "\033[90m(Error Code: " << static_cast<int>(err) << ")\033[0m\n";
     }
 };
-}
\ No newline at end of file
+
+/**
+ * @brief IErrorHandler that stores the reported errors instead of handling them.
+ *
+ * Used to give every parallel task its own handler (IErrorHandler implementations
+ * are not required to be thread-safe), the collected errors are then replayed
+ * into the caller's handler from a single thread.
+ */
+class CollectingErrorHandler : public IErrorHandler {
+public:
+    void onError(Error err, const std::string &errorMessage) override {
+        mErrors.emplace_back(err, errorMessage);
+    }
+
+    /**
+     * @brief Forward all collected errors (in report order) to another handler.
+     */
+    void replay(IErrorHandler &handler) const {
+        for (const auto &[err, message] : mErrors) {
+            handler.onError(err, message);
+        }
+    }
+
+    /// @brief true if at least one error was reported.
+    bool hasErrors() const noexcept {
+        return !mErrors.empty();
+    }
+
+    /// @brief the collected errors.
+    const std::vector<std::pair<Error, std::string>> &errors() const noexcept {
+        return mErrors;
+    }
+
+    /// @brief drop all collected errors.
+    void clear() noexcept {
+        mErrors.clear();
+    }
+
+private:
+    std::vector<std::pair<Error, std::string>> mErrors;
+};
+/**
+ * @brief IErrorHandler that only counts the reported errors and keeps the last code.
+ *
+ * For the audio thread: nothing is stored or printed, the count and the code are
+ * atomics readable from any thread.
+ */
+class CountingErrorHandler : public IErrorHandler {
+public:
+    void onError(Error err, const std::string &) override {
+        mLast.store(static_cast<int>(err), std::memory_order_relaxed);
+        mCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// @brief Counted like onError(), the message is never formatted.
+    void onEvent(const Event &event) override {
+        mLast.store(static_cast<int>(event.code), std::memory_order_relaxed);
+        mCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// @brief errors reported so far.
+    uint64_t count() const noexcept {
+        return mCount.load(std::memory_order_relaxed);
+    }
+
+    /// @brief code of the last reported error (Error::Success if none).
+    Error last() const noexcept {
+        return static_cast<Error>(mLast.load(std::memory_order_relaxed));
+    }
+
+private:
+    std::atomic<uint64_t> mCount{0};
+    std::atomic<int> mLast{0};
+};
+
+/**
+ * @brief Report an error without building its message: `format` is a literal whose `{}` take
+ * the integer `args` in order (see Event).
+ *
+ * Allocation free up to the handler: an ErrorChannel queues the event, a CountingErrorHandler
+ * counts it, other handlers get the formatted message through onError().
+ *
+ * @code
+ * AJ::error::report(handler, AJ::error::Error::InvalidChannelCount, "block of {} channels, the state has {}.\n", channels, state.channels());
+ * @endcode
+ */
+template <typename... Args>
+void report(IErrorHandler &handler, Error code, const char *format, Args... args){
+    static_assert(sizeof...(Args) <= kErrorEventArgs, "too many arguments for an error::Event");
+
+    Event event;
+    event.code = code;
+    event.format = format;
+    event.count = static_cast<uint8_t>(sizeof...(Args));
+
+    size_t k = 0;
+    ((event.args[k++] = static_cast<int64_t>(args)), ...);
+    (void)k;
+
+    handler.onEvent(event);
+}
+
+}
@@ -62,6 +62,9 @@ enum class Error {
     RingBufferOverflow,
     NullBufferPtr,
     EmptyBufferQueue,
+    PlaybackError,
+    RealtimeViolation,          ///< Allocation, lock or blocking call on an audio thread (AJ_REALTIME_GUARD builds)
+    CalibrationFailed,          ///< The loopback calibration didn't hear its burst
 };
 
 }
@@ -0,0 +1,164 @@
+#pragma once
+#include "buffer_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace AJ::utils {
+
+/**
+ * @class FixedQueue
+ * @brief Empty-mode Queue with its capacity fixed at compile time.
+ *
+ * Holds `Buffer*` owned elsewhere (a BufferPool) between one producer and one consumer, for
+ * a pipeline whose depth is known when it is built: the handoff between two fixed DSP stages,
+ * or the blocks of a render graph.
+ *
+ * Compared to Queue:
+ * - The slots are an array inside the object and the mask is a constant.
+ * - The indices never wrap, so there is no full flag for the two sides to share.
+ * - Each side keeps its last view of the other side's index and reloads it only when that view
+ *   shows too little, the other side's cache line is read once per refill.
+ * - No wait(): the consumer polls, or is driven by its own clock (a callback, a graph tick).
+ *
+ * @tparam Capacity slots, a power of two.
+ *
+ * ## Example:
+ * @code
+ * AJ::utils::FixedQueue<64> blocks;
+ *
+ * // producer
+ * blocks.push(pool.tryPop());
+ *
+ * // consumer
+ * AJ::utils::Buffer *batch[16];
+ * size_t n = blocks.popBatch(batch, 16);
+ * @endcode
+ */
+template <size_t Capacity>
+class FixedQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "FixedQueue capacity must be a power of two");
+
+    static constexpr size_t kMask = Capacity - 1;
+
+    //* producer side: its index, and its last view of the consumer's.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mWriteIndex{0};
+    size_t mReadSeen = 0;
+
+    //* consumer side: its index, and its last view of the producer's.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mReadIndex{0};
+    size_t mWriteSeen = 0;
+
+    alignas(CACHE_LINE_SIZE) std::array<Buffer*, Capacity> mSlots{};
+
+    size_t freeSlots(size_t write, size_t wanted) noexcept {
+        size_t space = Capacity - (write - mReadSeen);
+        if(space < wanted){
+            mReadSeen = mReadIndex.load(std::memory_order_acquire);
+            space = Capacity - (write - mReadSeen);
+        }
+        return space;
+    }
+
+    size_t queued(size_t read, size_t wanted) noexcept {
+        size_t available = mWriteSeen - read;
+        if(available < wanted){
+            mWriteSeen = mWriteIndex.load(std::memory_order_acquire);
+            available = mWriteSeen - read;
+        }
+        return available;
+    }
+
+public:
+    FixedQueue() = default;
+    FixedQueue(const FixedQueue&) = delete;
+    FixedQueue& operator=(const FixedQueue&) = delete;
+
+    /**
+     * @brief Queue a buffer (producer side, lock-free).
+     * @return false if the queue is full or `buffer` is nullptr.
+     */
+    bool push(Buffer* buffer) noexcept {
+        if(!buffer){
+            return false;
+        }
+
+        const size_t write = mWriteIndex.load(std::memory_order_relaxed);
+        if(freeSlots(write, 1) == 0){
+            return false;
+        }
+
+        mSlots[write & kMask] = buffer;
+        mWriteIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest buffer (consumer side, lock-free).
+     * @return nullptr if the queue is empty.
+     */
+    Buffer* pop() noexcept {
+        const size_t read = mReadIndex.load(std::memory_order_relaxed);
+        if(queued(read, 1) == 0){
+            return nullptr;
+        }
+
+        Buffer *buffer = mSlots[read & kMask];
+        mReadIndex.store(read + 1, std::memory_order_release);
+        return buffer;
+    }
+
+    /**
+     * @brief Queue up to `count` buffers with one index update, see Queue::pushBatch().
+     * @return buffers queued, stops at a full queue or the first nullptr.
+     */
+    size_t pushBatch(Buffer* const* buffers, size_t count) noexcept {
+        const size_t write = mWriteIndex.load(std::memory_order_relaxed);
+        const size_t limit = std::min(count, freeSlots(write, count));
+
+        size_t pushed = 0;
+        while(pushed < limit && buffers[pushed]){
+            mSlots[(write + pushed) & kMask] = buffers[pushed];
+            ++pushed;
+        }
+
+        if(pushed){
+            mWriteIndex.store(write + pushed, std::memory_order_release);
+        }
+        return pushed;
+    }
+
+    /**
+     * @brief Take up to `max` buffers, oldest first, with one index update, see Queue::popBatch().
+     */
+    size_t popBatch(Buffer** out, size_t max) noexcept {
+        const size_t read = mReadIndex.load(std::memory_order_relaxed);
+        const size_t popped = std::min(max, queued(read, max));
+
+        for(size_t i = 0; i < popped; ++i){
+            out[i] = mSlots[(read + i) & kMask];
+        }
+
+        if(popped){
+            mReadIndex.store(read + popped, std::memory_order_release);
+        }
+        return popped;
+    }
+
+    /**
+     * @brief Buffers queued, exact only from the producer or consumer thread while the other is idle.
+     */
+    size_t currentSize() const noexcept {
+        const size_t read = mReadIndex.load(std::memory_order_acquire);
+        return mWriteIndex.load(std::memory_order_acquire) - read;
+    }
+
+    /// @brief Slots of the queue.
+    static constexpr size_t queueSize() noexcept {
+        return Capacity;
+    }
+};
+
+}
@@ -0,0 +1,340 @@
+#pragma once
+#include "error_handler.h"
+#include "core/constants.h"
+#include "core/memory.h"
+#include "core/ring_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+
+namespace AJ::utils {
+
+namespace detail {
+
+/**
+ * @brief Samples of a FixedRingBuffer: an aligned array inside the object, or one heap block.
+ */
+template <size_t Samples, bool Inline = (Samples * sizeof(float) <= kFixedRingInlineBytes)>
+struct FixedRingStorage {
+    alignas(kBufferAlignment) float samples[Samples]{};
+
+    explicit FixedRingStorage(AJ::error::IErrorHandler&) noexcept {}
+
+    float* data() noexcept {
+        return samples;
+    }
+
+    bool isValid() const noexcept {
+        return true;
+    }
+};
+
+template <size_t Samples>
+struct FixedRingStorage<Samples, false> {
+    float *samples = nullptr;
+
+    explicit FixedRingStorage(AJ::error::IErrorHandler& handler){
+        samples = static_cast<float *>(
+            engineAllocator().allocate(Samples * sizeof(float), kBufferAlignment, Subsystem::Pools)
+        );
+
+        if(!samples){
+            const std::string message = std::bad_alloc().what();
+            handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+            return;
+        }
+
+        std::memset(samples, 0, Samples * sizeof(float));
+    }
+
+    ~FixedRingStorage(){
+        if(samples){
+            engineAllocator().deallocate(samples, Samples * sizeof(float), kBufferAlignment, Subsystem::Pools);
+        }
+    }
+
+    FixedRingStorage(const FixedRingStorage&) = delete;
+    FixedRingStorage& operator=(const FixedRingStorage&) = delete;
+
+    float* data() noexcept {
+        return samples;
+    }
+
+    bool isValid() const noexcept {
+        return samples != nullptr;
+    }
+};
+
+}
+
+/**
+ * @class FixedRingBuffer
+ * @brief RingBuffer with its channel count and capacity fixed at compile time.
+ *
+ * Same SPSC interface as RingBuffer (frames, acquire / commit regions), for the paths whose
+ * configuration is known when they are built, e.g. a stereo 256-frame monitor ring. RingBuffer
+ * stays the one to use when channels or size come from the user.
+ *
+ * ## What the fixed configuration buys:
+ * - The mask and the samples per frame are constants: a frame is `Channels` stores at a
+ *   constant offset, and the copies of writeFrames() / readFrames() have constant strides.
+ * - Rings up to kFixedRingInlineBytes keep their samples in the object, no allocation and no
+ *   pointer to follow. Bigger ones allocate once in the constructor.
+ * - The indices count frames and never wrap (only their low bits address the ring), so there
+ *   is no full flag: each side loads one index of the other side.
+ * - Each side keeps its last view of the other side's index and reloads it only when that view
+ *   doesn't cover the request. A writer far behind a full ring or a reader far ahead of an
+ *   empty one touches the other side's cache line once per refill instead of once per call.
+ *
+ * @tparam Channels 1 (mono) or 2 (stereo).
+ * @tparam Frames   capacity in frames, a power of two.
+ *
+ * ## Example:
+ * @code
+ * AJ::utils::FixedRingBuffer<2, 1024> ring(handler);
+ *
+ * // audio callback
+ * ring.writeFrames(input, frames);
+ *
+ * // reader
+ * size_t got = ring.readFrames(block, 256);
+ * @endcode
+ *
+ * @warning Like RingBuffer, check `isValid()` after construction (only a heap ring can fail).
+ */
+template <size_t Channels, size_t Frames>
+class FixedRingBuffer {
+    static_assert(Channels == 1 || Channels == 2, "FixedRingBuffer supports mono and stereo only");
+    static_assert(Frames >= 2 && (Frames & (Frames - 1)) == 0, "FixedRingBuffer capacity must be a power of two");
+
+public:
+    static constexpr size_t kChannels = Channels;
+    static constexpr size_t kFrames = Frames;
+    static constexpr size_t kSamples = Frames * Channels;
+
+    /// @brief Whether the samples live inside the object.
+    static constexpr bool kInline = kSamples * sizeof(float) <= kFixedRingInlineBytes;
+
+private:
+    static constexpr size_t kMask = Frames - 1;
+
+    //* producer side: its index, and its last view of the reader's.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mWriteIndex{0};
+    size_t mReadSeen = 0;
+
+    //* consumer side: its index, and its last view of the writer's.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mReadIndex{0};
+    size_t mWriteSeen = 0;
+
+    alignas(CACHE_LINE_SIZE) detail::FixedRingStorage<kSamples> mStorage;
+
+    /**
+     * @brief Free frames from the writer's side, reloads the reader's index only if `wanted` isn't covered.
+     */
+    size_t writeSpace(size_t write, size_t wanted) noexcept {
+        size_t space = Frames - (write - mReadSeen);
+        if(space < wanted){
+            mReadSeen = mReadIndex.load(std::memory_order_acquire);
+            space = Frames - (write - mReadSeen);
+        }
+        return space;
+    }
+
+    /**
+     * @brief Readable frames from the reader's side, reloads the writer's index only if `wanted` isn't covered.
+     */
+    size_t readAvailable(size_t read, size_t wanted) noexcept {
+        size_t available = mWriteSeen - read;
+        if(available < wanted){
+            mWriteSeen = mWriteIndex.load(std::memory_order_acquire);
+            available = mWriteSeen - read;
+        }
+        return available;
+    }
+
+    float* frameAt(size_t index) noexcept {
+        return mStorage.data() + (index & kMask) * Channels;
+    }
+
+    RingRegion region(size_t index, size_t frames) noexcept {
+        RingRegion result;
+        const size_t first = std::min(Frames - (index & kMask), frames);
+
+        result.first.data = frameAt(index);
+        result.first.frames = first;
+
+        if(first != frames){
+            result.second.data = mStorage.data();
+            result.second.frames = frames - first;
+        }
+
+        return result;
+    }
+
+public:
+    /**
+     * @brief Construct the ring, zeroed.
+     *
+     * @param handler gets a ResourceAllocationFailed if a heap ring can't allocate its samples.
+     */
+    explicit FixedRingBuffer(AJ::error::IErrorHandler& handler) : mStorage(handler) {}
+
+    FixedRingBuffer(const FixedRingBuffer&) = delete;
+    FixedRingBuffer& operator=(const FixedRingBuffer&) = delete;
+
+    /// @brief Whether the samples are allocated (always for an inline ring).
+    bool isValid() const noexcept {
+        return mStorage.isValid();
+    }
+
+    /**
+     * @brief Write one frame of `Channels` samples.
+     * @return false if the ring is full or `samples` is nullptr.
+     */
+    bool writeFrame(const float *samples) noexcept {
+        if(!samples){
+            return false;
+        }
+
+        const size_t write = mWriteIndex.load(std::memory_order_relaxed);
+        if(writeSpace(write, 1) == 0){
+            return false;
+        }
+
+        float *out = frameAt(write);
+        for(size_t ch = 0; ch < Channels; ++ch){
+            out[ch] = samples[ch];
+        }
+
+        mWriteIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Write up to `frame_count` interleaved frames.
+     * @return frames written, fewer if the ring filled up.
+     */
+    size_t writeFrames(const float *input, size_t frame_count) noexcept {
+        if(!input){
+            return 0;
+        }
+
+        const size_t write = mWriteIndex.load(std::memory_order_relaxed);
+        const size_t frames = std::min(frame_count, writeSpace(write, frame_count));
+        if(frames == 0){
+            return 0;
+        }
+
+        const size_t first = std::min(Frames - (write & kMask), frames);
+        std::memcpy(frameAt(write), input, first * Channels * sizeof(float));
+        std::memcpy(mStorage.data(), input + first * Channels, (frames - first) * Channels * sizeof(float));
+
+        mWriteIndex.store(write + frames, std::memory_order_release);
+        return frames;
+    }
+
+    /**
+     * @brief Read one frame of `Channels` samples.
+     * @return false if the ring is empty or `output` is nullptr.
+     */
+    bool readFrame(float *output) noexcept {
+        if(!output){
+            return false;
+        }
+
+        const size_t read = mReadIndex.load(std::memory_order_relaxed);
+        if(readAvailable(read, 1) == 0){
+            return false;
+        }
+
+        const float *in = frameAt(read);
+        for(size_t ch = 0; ch < Channels; ++ch){
+            output[ch] = in[ch];
+        }
+
+        mReadIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Read up to `frames_count` frames, interleaved.
+     * @return frames read, 0 if the ring is empty.
+     */
+    size_t readFrames(float *output, size_t frames_count) noexcept {
+        if(!output){
+            return 0;
+        }
+
+        const size_t read = mReadIndex.load(std::memory_order_relaxed);
+        const size_t frames = std::min(frames_count, readAvailable(read, frames_count));
+        if(frames == 0){
+            return 0;
+        }
+
+        const size_t first = std::min(Frames - (read & kMask), frames);
+        std::memcpy(output, frameAt(read), first * Channels * sizeof(float));
+        std::memcpy(output + first * Channels, mStorage.data(), (frames - first) * Channels * sizeof(float));
+
+        mReadIndex.store(read + frames, std::memory_order_release);
+        return frames;
+    }
+
+    /**
+     * @brief Ring memory for up to `frames` frames to write, see RingBuffer::acquireWrite().
+     */
+    RingRegion acquireWrite(size_t frames) noexcept {
+        const size_t write = mWriteIndex.load(std::memory_order_relaxed);
+        return region(write, std::min(frames, writeSpace(write, frames)));
+    }
+
+    /**
+     * @brief Publish `frames` frames written into the region of acquireWrite().
+     */
+    void commitWrite(size_t frames) noexcept {
+        const size_t write = mWriteIndex.load(std::memory_order_relaxed);
+        frames = std::min(frames, writeSpace(write, frames));
+        if(frames){
+            mWriteIndex.store(write + frames, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Ring memory holding up to `frames` readable frames, see RingBuffer::acquireRead().
+     */
+    RingRegion acquireRead(size_t frames) noexcept {
+        const size_t read = mReadIndex.load(std::memory_order_relaxed);
+        return region(read, std::min(frames, readAvailable(read, frames)));
+    }
+
+    /**
+     * @brief Release `frames` frames of the region of acquireRead() to the producer.
+     */
+    void commitRead(size_t frames) noexcept {
+        const size_t read = mReadIndex.load(std::memory_order_relaxed);
+        frames = std::min(frames, readAvailable(read, frames));
+        if(frames){
+            mReadIndex.store(read + frames, std::memory_order_release);
+        }
+    }
+
+    /// @brief Capacity in frames.
+    static constexpr size_t frameCapacity() noexcept {
+        return Frames;
+    }
+
+    /// @brief Capacity in samples.
+    static constexpr size_t samplesCapacity() noexcept {
+        return kSamples;
+    }
+
+    /// @brief Channels per frame.
+    static constexpr size_t channels() noexcept {
+        return Channels;
+    }
+};
+
+}
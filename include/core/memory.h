@@ -0,0 +1,181 @@
+#pragma once
+#include "constants.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace AJ::utils {
+
+/**
+ * @brief Parts of the engine heap memory is accounted to, see MemoryScope.
+ */
+enum class Subsystem : uint8_t {
+    Other,      ///< anything outside a MemoryScope.
+    FileIO,     ///< decoded and encoded files (loadAudio(), saveAudio(), streaming).
+    Dsp,        ///< effects, their state and temporaries.
+    Editing,    ///< cut, insert, mixing and export.
+    Pools,      ///< BufferPool / Queue slabs and RingBuffers.
+    Count
+};
+
+/// @brief Name of a subsystem in snake case (e.g. "file_io").
+const char* subsystemName(Subsystem subsystem) noexcept;
+
+/**
+ * @brief Heap use of one subsystem, see MemorySnapshot.
+ */
+struct SubsystemMemory {
+    uint64_t current = 0;       ///< bytes held now.
+    uint64_t peak = 0;          ///< most bytes held at once since the last resetPeaks().
+    uint64_t allocations = 0;   ///< allocations since the process started.
+    uint64_t frees = 0;         ///< deallocations since the process started.
+};
+
+/**
+ * @brief Heap use of the engine at one point, see TrackingAllocator::snapshot().
+ */
+struct MemorySnapshot {
+    std::array<SubsystemMemory, static_cast<size_t>(Subsystem::Count)> subsystems{};
+    uint64_t realtimeAllocations = 0;   ///< allocations made on a thread inside a RealtimeScope.
+    uint64_t time = 0;                  ///< steady clock of the snapshot, ns.
+
+    const SubsystemMemory& operator[](Subsystem subsystem) const noexcept {
+        return subsystems[static_cast<size_t>(subsystem)];
+    }
+
+    /// @brief Bytes held now by every subsystem.
+    uint64_t current() const noexcept;
+
+    /// @brief Allocations per second of `subsystem` between an `earlier` snapshot and this one.
+    double allocationRate(const MemorySnapshot &earlier, Subsystem subsystem) const noexcept;
+};
+
+/**
+ * @class IAllocator
+ * @brief Source of the engine heap memory.
+ *
+ * `bytes` is a multiple of `alignment`, a power of two up to kHugePageSize.
+ * deallocate() gets the same size, alignment and subsystem as the matching allocate().
+ */
+class IAllocator {
+public:
+    virtual ~IAllocator() = default;
+
+    /// @return nullptr on failure.
+    virtual void* allocate(size_t bytes, size_t alignment, Subsystem subsystem) noexcept = 0;
+    virtual void deallocate(void *data, size_t bytes, size_t alignment, Subsystem subsystem) noexcept = 0;
+};
+
+/**
+ * @class SystemAllocator
+ * @brief std::aligned_alloc / std::free.
+ */
+class SystemAllocator : public IAllocator {
+public:
+    void* allocate(size_t bytes, size_t alignment, Subsystem subsystem) noexcept override;
+    void deallocate(void *data, size_t bytes, size_t alignment, Subsystem subsystem) noexcept override;
+};
+
+/**
+ * @class TrackingAllocator
+ * @brief Counts the bytes and allocations of every subsystem, then forwards to another allocator.
+ *
+ * Accounting is a few relaxed atomic adds on the cache line of the subsystem: no lock,
+ * safe anywhere. Allocations made inside a RealtimeScope are counted apart
+ * (MemorySnapshot::realtimeAllocations), the audio callbacks should never make any.
+ */
+class TrackingAllocator : public IAllocator {
+    struct alignas(CACHE_LINE_SIZE) Counters {
+        std::atomic<uint64_t> current{0};
+        std::atomic<uint64_t> peak{0};
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> frees{0};
+    };
+
+    IAllocator &mUpstream;
+    std::array<Counters, static_cast<size_t>(Subsystem::Count)> mCounters;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> mRealtimeAllocations{0};
+
+public:
+    explicit TrackingAllocator(IAllocator &upstream) noexcept : mUpstream(upstream) {}
+
+    void* allocate(size_t bytes, size_t alignment, Subsystem subsystem) noexcept override;
+    void deallocate(void *data, size_t bytes, size_t alignment, Subsystem subsystem) noexcept override;
+
+    /// @brief Account memory obtained elsewhere (e.g. mmap), released with noteReleased().
+    void noteAcquired(size_t bytes, Subsystem subsystem) noexcept;
+    void noteReleased(size_t bytes, Subsystem subsystem) noexcept;
+
+    /// @brief Count an allocation made inside a RealtimeScope.
+    void noteRealtimeAllocation() noexcept {
+        mRealtimeAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    MemorySnapshot snapshot() const noexcept;
+
+    /// @brief Start the peaks again from the bytes held now.
+    void resetPeaks() noexcept;
+};
+
+/**
+ * @brief The allocator of the engine: a TrackingAllocator over the SystemAllocator.
+ *
+ * AlignedAllocator (every Float), BufferPool, Queue, RingBuffer and ScratchArena allocate through it.
+ */
+TrackingAllocator& engineAllocator() noexcept;
+
+/// @brief Subsystem the allocations of the calling thread are accounted to.
+Subsystem currentSubsystem() noexcept;
+
+/// @brief true inside a RealtimeScope of the calling thread.
+bool inRealtimeScope() noexcept;
+
+/**
+ * @brief Allocate `bytes` for the current subsystem, kBufferAlignment aligned.
+ *
+ * The block is prefixed by a kBufferAlignment header holding its size and subsystem,
+ * so deallocateTagged() accounts it right from any thread.
+ * @return nullptr on failure.
+ */
+void* allocateTagged(size_t bytes) noexcept;
+void deallocateTagged(void *data) noexcept;
+
+/**
+ * @class MemoryScope
+ * @brief Accounts the allocations of the calling thread to `subsystem` until the scope ends.
+ *
+ * Scopes nest, the innermost wins. Memory is accounted to the subsystem it was allocated
+ * for, wherever it is freed.
+ */
+class MemoryScope {
+    Subsystem mPrevious;
+
+public:
+    explicit MemoryScope(Subsystem subsystem) noexcept;
+    ~MemoryScope();
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+};
+
+/**
+ * @class RealtimeScope
+ * @brief Marks the calling thread as realtime (audio callback body) until the scope ends.
+ *
+ * Engine allocations inside it are counted as realtime allocations. With `AJ_REALTIME_GUARD`
+ * defined, every allocation, lock and blocking call inside it is reported (see RealtimeGuard).
+ */
+class RealtimeScope {
+    bool mPrevious;
+
+public:
+    RealtimeScope() noexcept;
+    ~RealtimeScope();
+
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+};
+
+}
@@ -0,0 +1,232 @@
+#pragma once
+#include "constants.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace AJ::utils {
+
+/**
+ * @brief Events counted by a MetricsRegistry.
+ */
+enum class Counter : size_t {
+    RecordedBlocks,   ///< blocks the record callback queued.
+    DroppedBlocks,    ///< blocks the record callback lost (pool or queue exhausted).
+    PoolExhausted,    ///< record callbacks that found the buffer pool empty.
+    BlocksWritten,    ///< blocks a FileStreamer wrote.
+    BytesWritten,     ///< bytes of float samples a FileStreamer wrote (before conversion to the file format).
+    FramesPlayed,     ///< frames the output callback copied to the device.
+    Underruns,        ///< output callbacks that found less than a buffer in the read-ahead ring.
+    EffectRuns,       ///< effects applied to a file.
+    EffectFailures,   ///< effects that reported an error.
+    InputOverflows,   ///< record callbacks flagged paInputOverflow (the device lost input).
+    InputUnderflows,  ///< record callbacks flagged paInputUnderflow (the input was padded).
+    DeadlineMisses,   ///< record callbacks that ran longer than their buffer lasts.
+    MonitorFailures,  ///< monitor chains that failed in the record callback (the dry input is played instead).
+    ElasticMisses,    ///< ElasticBufferPool takes that found their size class empty.
+    ElasticGrowths,   ///< buffers an ElasticBufferPool allocated past its initial sizes.
+    ElasticShrinks,   ///< buffers an ElasticBufferPool freed (idle shrink and trim()).
+    Count
+};
+
+/**
+ * @brief Highest values seen by a MetricsRegistry.
+ */
+enum class Peak : size_t {
+    QueueDepth,       ///< deepest recording queue a FileStreamer found.
+    CallbackLoad,     ///< highest load of the record callback, in per mille of its deadline.
+    ElasticBytes,     ///< most bytes of buffers an ElasticBufferPool held at once.
+    Count
+};
+
+/**
+ * @brief Durations recorded by a MetricsRegistry, in nanoseconds.
+ */
+enum class Latency : size_t {
+    RecordCallback,   ///< body of the record callback.
+    PlayCallback,     ///< body of the output callback.
+    BlockWrite,       ///< write of one block by a FileStreamer.
+    Effect,           ///< applyEffect() on a file.
+    MonitorChain,     ///< monitor effect chain of one record callback (full duplex).
+    Count
+};
+
+/**
+ * @brief Merged latency histogram of a MetricsSnapshot.
+ */
+struct LatencySummary {
+    /// @brief Buckets per histogram: values below kMetricSubBuckets, then kMetricSubBuckets per power of two.
+    static constexpr size_t kBuckets = (kMetricMaxExponent - 2) * kMetricSubBuckets;
+
+    std::array<uint64_t, kBuckets> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;   ///< ns.
+    uint64_t max = 0;   ///< ns.
+
+    /// @brief Bucket of `ns` (the last one for values past the range).
+    static size_t bucket(uint64_t ns) noexcept;
+
+    /// @brief Lowest value of bucket `index`.
+    static uint64_t lowest(size_t index) noexcept;
+
+    /// @brief Value under which a fraction `p` (0 to 1) of the durations fall, 0 if none was recorded.
+    uint64_t percentile(double p) const noexcept;
+
+    double mean() const noexcept {
+        return count ? static_cast<double>(sum) / count : 0.0;
+    }
+};
+
+/**
+ * @brief Plain values of a MetricsRegistry at one point, see MetricsRegistry::snapshot().
+ */
+struct MetricsSnapshot {
+    std::array<uint64_t, static_cast<size_t>(Counter::Count)> counters{};
+    std::array<uint64_t, static_cast<size_t>(Peak::Count)> peaks{};
+    std::array<LatencySummary, static_cast<size_t>(Latency::Count)> latencies{};
+
+    /// @brief Levels read when the snapshot was taken (see EngineResources::metricsSnapshot()).
+    uint64_t queueDepth = 0;
+    uint64_t poolAvailable = 0;
+
+    uint64_t operator[](Counter counter) const noexcept {
+        return counters[static_cast<size_t>(counter)];
+    }
+
+    uint64_t operator[](Peak peak) const noexcept {
+        return peaks[static_cast<size_t>(peak)];
+    }
+
+    const LatencySummary& operator[](Latency latency) const noexcept {
+        return latencies[static_cast<size_t>(latency)];
+    }
+
+    /**
+     * @brief The snapshot in the Prometheus text format, metric names prefixed `aj_`.
+     *
+     * Counters are `_total` counters, levels and peaks gauges, and latencies summaries
+     * (p50, p99, p999 in seconds with `_sum` and `_count`).
+     */
+    std::string prometheus() const;
+};
+
+/// @brief Keep `value` in `peak` if it is the highest seen (relaxed).
+inline void raiseAtomic(std::atomic<uint64_t> &peak, uint64_t value) noexcept {
+    uint64_t seen = peak.load(std::memory_order_relaxed);
+    while(value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)){}
+}
+
+/**
+ * @class LatencyHistogram
+ * @brief Lock-free log-linear histogram of durations, the writable side of a LatencySummary.
+ *
+ * record() is a few relaxed atomic adds (realtime safe), summary() can run on any thread.
+ */
+class alignas(CACHE_LINE_SIZE) LatencyHistogram {
+    std::array<std::atomic<uint64_t>, LatencySummary::kBuckets> mBuckets{};
+    std::atomic<uint64_t> mCount{0};
+    std::atomic<uint64_t> mSum{0};
+    std::atomic<uint64_t> mMax{0};
+
+public:
+    void record(uint64_t ns) noexcept {
+        mBuckets[LatencySummary::bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        mCount.fetch_add(1, std::memory_order_relaxed);
+        mSum.fetch_add(ns, std::memory_order_relaxed);
+        raiseAtomic(mMax, ns);
+    }
+
+    /// @brief Add the durations recorded so far to `summary`.
+    void mergeInto(LatencySummary &summary) const noexcept;
+
+    LatencySummary summary() const noexcept {
+        LatencySummary summary;
+        mergeInto(summary);
+        return summary;
+    }
+
+    void reset() noexcept;
+};
+
+/// @brief Name of a counter, peak or latency in snake case (e.g. "dropped_blocks").
+const char* metricName(Counter counter) noexcept;
+const char* metricName(Peak peak) noexcept;
+const char* metricName(Latency latency) noexcept;
+
+/**
+ * @class MetricsRegistry
+ * @brief Lock-free counters, peaks and latency histograms of the engine.
+ *
+ * The hot paths (audio callbacks, disk writer, effects) update it with relaxed atomics, no
+ * lock, allocation or system call: safe on the audio thread. Every thread writes to its own
+ * cache-line aligned shard (threads are spread over kMetricShards of them), so two threads
+ * updating the same metric don't bounce a line between their cores.
+ *
+ * snapshot() merges the shards for the control thread or an exporter. Values updated while it
+ * runs may or may not be included, each value is exact on its own.
+ *
+ * ### Example:
+ * @code
+ * auto metrics = resources.metrics();
+ * const uint64_t start = AJ::utils::MetricsRegistry::now();
+ * // ... write a block
+ * metrics->add(AJ::utils::Counter::BlocksWritten);
+ * metrics->record(AJ::utils::Latency::BlockWrite, AJ::utils::MetricsRegistry::now() - start);
+ *
+ * std::cout << metrics->snapshot().prometheus();
+ * @endcode
+ */
+class MetricsRegistry {
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> counters{};
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(Peak::Count)> peaks{};
+        std::array<LatencyHistogram, static_cast<size_t>(Latency::Count)> latencies;
+    };
+
+    std::unique_ptr<Shard[]> pShards;
+
+    //? a thread keeps its shard for its life, whichever registry it updates.
+    static size_t shardIndex() noexcept;
+
+    Shard& shard() noexcept {
+        return pShards[shardIndex()];
+    }
+
+public:
+    MetricsRegistry() : pShards(new Shard[kMetricShards]) {}
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /// @brief Monotonic time in nanoseconds, for the durations given to record().
+    static uint64_t now() noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void add(Counter counter, uint64_t n = 1) noexcept {
+        shard().counters[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /// @brief Keep `value` if it is the highest seen.
+    void raise(Peak peak, uint64_t value) noexcept {
+        raiseAtomic(shard().peaks[static_cast<size_t>(peak)], value);
+    }
+
+    void record(Latency latency, uint64_t ns) noexcept {
+        shard().latencies[static_cast<size_t>(latency)].record(ns);
+    }
+
+    /// @brief Merge the shards (control thread, not realtime safe: the snapshot is about 10 KiB).
+    MetricsSnapshot snapshot() const noexcept;
+
+    /// @brief Zero everything. Updates running at the same time may survive it.
+    void reset() noexcept;
+};
+
+}
@@ -0,0 +1,239 @@
+#pragma once
+#include "buffer_pool.h"
+#include "error_handler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace AJ::utils {
+
+/**
+ * @class MPMCQueue
+ * @brief Bounded lock-free queue of `Buffer*` for any number of producers and consumers.
+ *
+ * Queue is SPSC: fan-in (several recorders into one writer pool) or fan-out (several DSP
+ * workers pulling from one render queue) needs a Queue per pair. This one is shared.
+ *
+ * ## Design (D. Vyukov's bounded MPMC queue):
+ * - Every cell carries a sequence number next to its buffer. A producer owns the cell at
+ *   `enqueue position` once its sequence equals that position, claims it with one CAS on the
+ *   position, writes the buffer and publishes it with sequence = position + 1. A consumer
+ *   does the same against `dequeue position` and hands the cell back to the producers with
+ *   sequence = position + queue size.
+ * - No thread waits on another: a producer preempted between its CAS and its publish only
+ *   delays the consumers of that cell, pop() returns nullptr meanwhile.
+ * - Cells and the two positions have a cache line each, so threads working on neighbouring
+ *   cells don't share lines.
+ *
+ * push() and pop() cost one CAS each, where the SPSC Queue needs none: keep Queue for a single
+ * pair (the record callback and its writer). There is no wait(): consumers poll, or park on
+ * their own condition.
+ *
+ * Same modes as Queue: empty (holds buffers owned elsewhere) or full (owns `queue_size`
+ * zeroed buffers, allocated as one slab by a full-mode Queue kept as storage).
+ *
+ * ## Example:
+ * @code
+ * AJ::utils::MPMCQueue blocks(true, 256, 1024, 2, handler);
+ *
+ * // any render worker
+ * blocks.push(rendered);
+ *
+ * // any writer
+ * if (AJ::utils::Buffer *block = blocks.pop()) { ... }
+ * @endcode
+ */
+class MPMCQueue {
+private:
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence{0};
+        Buffer *buffer = nullptr;
+    };
+
+    std::unique_ptr<Cell[]> pCells;
+    std::unique_ptr<Queue> pStorage;            ///< owner of the buffers (full mode only).
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mEnqueuePos{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mDequeuePos{0};
+
+    alignas(CACHE_LINE_SIZE) size_t mQueueSize = 0;  ///< power of two.
+    size_t mMask = 0;
+    size_t mBufferSize = 0;                     ///< samples per buffer.
+    uint8_t mChannels = 0;
+    bool mValid = false;
+
+public:
+    /**
+     * @brief Construct an MPMC queue of `queue_size` cells (rounded up to a power of two).
+     *
+     * @param empty       true: start empty, the buffers come from elsewhere. false: allocate
+     *                    `queue_size` buffers and queue them all.
+     * @param buffer_size frames per buffer, rounded up to a power of two as in Queue.
+     * @param channels    1 or 2.
+     * @param huge_pages  full mode: back the slab with huge pages when possible.
+     * @param numa_node   full mode: NUMA node of the slab, -1 = no preference.
+     *
+     * @warning call `isValid()` after construction, the errors went to `handler`.
+     */
+    MPMCQueue(bool empty, size_t queue_size, size_t buffer_size, uint8_t channels,
+              AJ::error::IErrorHandler& handler, bool huge_pages = false, int numa_node = -1);
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    /// @brief Whether construction succeeded.
+    bool isValid() const noexcept {
+        return mValid;
+    }
+
+    /**
+     * @brief Queue a buffer (lock-free, any thread).
+     * @return false if the queue is full or `buffer` is nullptr.
+     */
+    bool push(Buffer* buffer) noexcept;
+
+    /**
+     * @brief Take the oldest buffer (lock-free, any thread).
+     * @return nullptr if the queue is empty.
+     */
+    Buffer* pop() noexcept;
+
+    /**
+     * @brief Buffers queued, exact only while nobody pushes or pops.
+     */
+    size_t currentSize() const noexcept;
+
+    /// @brief Cells of the queue.
+    size_t queueSize() const noexcept {
+        return mQueueSize;
+    }
+
+    /// @brief Channels of the buffers (1 = mono, 2 = stereo).
+    size_t channels() const noexcept {
+        return mChannels;
+    }
+
+    /// @brief Frames per buffer.
+    size_t bufferFrameCapacity() const noexcept {
+        return mChannels ? mBufferSize / mChannels : 0;
+    }
+
+    /// @brief Samples per buffer.
+    size_t bufferSamplesCapacity() const noexcept {
+        return mBufferSize;
+    }
+};
+
+/**
+ * @class MPMCBufferPool
+ * @brief BufferPool over an MPMCQueue: any thread takes buffers, any thread gives them back.
+ *
+ * Same interface as BufferPool, for the stages that scale over threads: several DSP workers
+ * taking render blocks from one pool, several writers returning them. wait() is missing, an
+ * MPMC queue has no single consumer to park.
+ *
+ * ## Example:
+ * @code
+ * AJ::utils::MPMCBufferPool pool(handler, 256, 1024, 2);
+ *
+ * // any producer
+ * if (Buffer *buffer = pool.tryPop()) { ... }
+ *
+ * // any consumer, when done with it
+ * pool.push(buffer, handler);
+ * @endcode
+ */
+class MPMCBufferPool {
+private:
+    std::shared_ptr<MPMCQueue> pBuffersQueue;   ///< full-mode queue owning the buffers.
+
+public:
+    /**
+     * @brief Allocate `num_of_buffers` buffers, see BufferPool::BufferPool().
+     */
+    MPMCBufferPool(AJ::error::IErrorHandler& handler,
+                   size_t num_of_buffers = 1024,
+                   size_t buffer_frames = 1024,
+                   uint8_t channels = 2,
+                   bool huge_pages = false,
+                   int numa_node = -1) {
+        pBuffersQueue = std::make_shared<MPMCQueue>(false, num_of_buffers, buffer_frames, channels, handler,
+                                                    huge_pages, numa_node);
+    }
+
+    /**
+     * @brief Wrap an existing queue, e.g. an empty-mode MPMCQueue filled elsewhere.
+     */
+    explicit MPMCBufferPool(std::shared_ptr<MPMCQueue> queue) : pBuffersQueue(std::move(queue)) {}
+
+    /**
+     * @brief Give a buffer back to the pool.
+     * @return false (reported) for nullptr or a full pool.
+     */
+    bool push(Buffer* buffer, AJ::error::IErrorHandler& handler) {
+        if(!buffer){
+            const std::string message = "error: invalid buffer, buffer cannot be NULL.";
+            handler.onError(AJ::error::Error::NullBufferPtr, message);
+            return false;
+        }
+
+        if(!pBuffersQueue->push(buffer)){
+            const std::string message = "error: queue is full.";
+            handler.onError(AJ::error::Error::BufferOverflow, message);
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Take a buffer.
+     * @return nullptr (reported) if the pool is empty.
+     */
+    Buffer* pop(AJ::error::IErrorHandler& handler) {
+        Buffer* buffer = pBuffersQueue->pop();
+
+        if(!buffer){
+            const std::string message = "error: queue is empty.";
+            handler.onError(AJ::error::Error::EmptyBufferQueue, message);
+            return nullptr;
+        }
+
+        return buffer;
+    }
+
+    /**
+     * @brief Take a buffer without reporting an empty pool (realtime safe, no allocation).
+     */
+    Buffer* tryPop() noexcept {
+        return pBuffersQueue->pop();
+    }
+
+    /// @brief Whether the buffers were allocated.
+    bool isValid() const noexcept {
+        return pBuffersQueue->isValid();
+    }
+
+    /// @brief Buffers managed by the pool.
+    int capacity() const {
+        return pBuffersQueue->queueSize();
+    }
+
+    /// @brief Channels per buffer.
+    int channels() const {
+        return pBuffersQueue->channels();
+    }
+
+    /// @brief Samples per buffer.
+    int bufferSize() const {
+        return pBuffersQueue->bufferSamplesCapacity();
+    }
+
+    /// @brief Buffers in the pool now, see MPMCQueue::currentSize().
+    size_t currentSize() const noexcept {
+        return pBuffersQueue->currentSize();
+    }
+};
+
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+#include "core/constants.h"
+
+namespace AJ::utils {
+
+/**
+ * @class ParamStore
+ * @brief Lock-free triple buffer for the live parameters of an effect.
+ *
+ * A control thread (UI) publishes snapshots of `T` and a processing thread (audio
+ * callback, stream writer) picks the latest one up at the start of each block.
+ * Neither side locks, waits or allocates.
+ *
+ * ## Design:
+ * - Three slots: one owned by the writer, one by the reader, and one in the middle.
+ * - publish() fills the writer slot and swaps it with the middle one (one atomic exchange).
+ * - acquire() swaps the reader slot with the middle one only if a new snapshot is there.
+ * - The reader always sees a complete snapshot, and intermediate ones may be skipped.
+ *
+ * @warning Single producer, single consumer: serialize publish() calls of several
+ *          control threads yourself, and read a store from one stream only.
+ */
+template<typename T>
+class ParamStore {
+    static_assert(std::is_trivially_copyable<T>::value, "live parameters must be trivially copyable");
+
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;   ///< set in mMiddle when it holds a snapshot the reader hasn't seen.
+
+    std::array<T, 3> mSlots;
+    uint8_t mWrite = 0;                       ///< writer-only.
+    uint8_t mRead = 1;                        ///< reader-only.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint8_t> mMiddle{2};
+
+public:
+    /// @param initial snapshot returned by acquire() until the first publish().
+    explicit ParamStore(const T &initial = T{}) {
+        mSlots.fill(initial);
+    }
+
+    ParamStore(const ParamStore&) = delete;
+    ParamStore& operator=(const ParamStore&) = delete;
+
+    /**
+     * @brief Publish a new snapshot (writer thread).
+     */
+    void publish(const T &value) noexcept {
+        mSlots[mWrite] = value;
+        mWrite = mMiddle.exchange(mWrite | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    /**
+     * @brief Latest published snapshot (reader thread).
+     *
+     * The reference stays valid until the next acquire().
+     */
+    const T& acquire() noexcept {
+        if(mMiddle.load(std::memory_order_relaxed) & kFresh){
+            mRead = mMiddle.exchange(mRead, std::memory_order_acq_rel) & kIndexMask;
+        }
+        return mSlots[mRead];
+    }
+};
+
+/**
+ * @class LinearSmoother
+ * @brief Per-sample linear ramp of a gain-type parameter towards its latest target.
+ *
+ * A gain that jumps from one block to the next produces an audible click ("zipper noise").
+ * The smoother ramps to a new target over `frames` samples instead.
+ */
+class LinearSmoother {
+    float mCurrent = 0.0f;
+    float mTarget = 0.0f;
+    float mStep = 0.0f;
+    uint32_t mRemaining = 0;
+
+public:
+    /// @brief Jump to `value`, with no ramp.
+    void reset(float value) noexcept {
+        mCurrent = mTarget = value;
+        mStep = 0.0f;
+        mRemaining = 0;
+    }
+
+    /// @brief Ramp from the current value to `target` over `frames` samples (no-op if it's the target already).
+    void setTarget(float target, uint32_t frames) noexcept {
+        if(target == mTarget){
+            return;
+        }
+
+        if(frames == 0){
+            reset(target);
+            return;
+        }
+
+        mTarget = target;
+        mStep = (target - mCurrent) / frames;
+        mRemaining = frames;
+    }
+
+    /// @brief Value of the next sample.
+    float next() noexcept {
+        if(mRemaining == 0){
+            return mTarget;
+        }
+
+        //? the last step lands on the target exactly.
+        mCurrent = --mRemaining == 0 ? mTarget : mCurrent + mStep;
+        return mCurrent;
+    }
+
+    /// @brief Advance `frames` samples without reading them.
+    void skip(size_t frames) noexcept {
+        if(frames >= mRemaining){
+            reset(mTarget);
+            return;
+        }
+
+        mRemaining -= static_cast<uint32_t>(frames);
+        mCurrent += mStep * frames;
+    }
+
+    /// @brief Whether a ramp is in progress.
+    bool smoothing() const noexcept {
+        return mRemaining != 0;
+    }
+
+    /// @brief Value the ramp ends at.
+    float target() const noexcept {
+        return mTarget;
+    }
+};
+
+}
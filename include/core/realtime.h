@@ -0,0 +1,141 @@
+#pragma once
+#include "constants.h"
+#include "error_handler.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE__)
+#include <xmmintrin.h>
+#define AJ_DENORMALS_MXCSR
+#elif defined(__aarch64__)
+#define AJ_DENORMALS_FPCR
+#endif
+
+namespace AJ::utils {
+
+/**
+ * @class DenormalScope
+ * @brief Flushes denormal floats to zero on the calling thread until the scope ends.
+ *
+ * Feedback loops (reverb combs, echo taps) decay into denormals, which cost up to a hundred
+ * times a normal operation on x86. Inside the scope they are read and written as zero:
+ * FTZ and DAZ in MXCSR on x86, FZ in FPCR on aarch64. The previous mode is restored on exit,
+ * elsewhere the scope does nothing.
+ *
+ * Open one per audio callback, read-ahead loop or block render: it's two register moves.
+ */
+class DenormalScope {
+#if defined(AJ_DENORMALS_MXCSR)
+    static constexpr unsigned int kFlushToZero = 0x8000;
+    static constexpr unsigned int kDenormalsAreZero = 0x0040;
+
+    unsigned int mPrevious;
+
+public:
+    DenormalScope() noexcept : mPrevious(_mm_getcsr()) {
+        _mm_setcsr(mPrevious | kFlushToZero | kDenormalsAreZero);
+    }
+
+    ~DenormalScope(){
+        _mm_setcsr(mPrevious);
+    }
+#elif defined(AJ_DENORMALS_FPCR)
+    static constexpr uint64_t kFlushToZero = uint64_t(1) << 24;
+
+    uint64_t mPrevious;
+
+public:
+    DenormalScope() noexcept {
+        asm volatile("mrs %0, fpcr" : "=r"(mPrevious));
+        asm volatile("msr fpcr, %0" : : "r"(mPrevious | kFlushToZero));
+    }
+
+    ~DenormalScope(){
+        asm volatile("msr fpcr, %0" : : "r"(mPrevious));
+    }
+#else
+public:
+    DenormalScope() noexcept = default;
+#endif
+
+    DenormalScope(const DenormalScope&) = delete;
+    DenormalScope& operator=(const DenormalScope&) = delete;
+};
+
+/**
+ * @brief Calls a realtime thread must never make, see RealtimeGuard.
+ */
+enum class RealtimeViolation : uint8_t {
+    Allocation,     ///< malloc, calloc, realloc, aligned_alloc, posix_memalign, memalign (and so operator new).
+    Lock,           ///< pthread_mutex_lock (std::mutex, std::lock_guard, ...).
+    Blocking,       ///< sleeps, condition and semaphore waits, read / write.
+};
+
+/// @brief Name of a violation in snake case (e.g. "allocation").
+const char* violationName(RealtimeViolation violation) noexcept;
+
+/**
+ * @class RealtimeGuard
+ * @brief Reports the allocations, locks and blocking calls made inside a RealtimeScope.
+ *
+ * Only in builds with `AJ_REALTIME_GUARD` defined (`-DAJ_REALTIME_GUARD=ON` in CMake), where
+ * the engine replaces malloc and its siblings and wraps the pthread lock, wait, sleep and
+ * read / write calls. A call made on a thread inside a RealtimeScope stores its kind and
+ * backtrace (kRealtimeStackDepth frames) in a fixed ring of kRealtimeViolationSlots, with no
+ * lock and no allocation; the call itself goes on unchanged.
+ *
+ * A guard drains the ring on its own thread every kRealtimeReportPeriod and reports each
+ * violation with its symbolized stack to `handler` (Error::RealtimeViolation), from that
+ * thread: the handler must accept calls from it. Recorder::record() and Player::play()
+ * keep one while the stream runs. Violations made while no guard runs wait in the ring,
+ * when it is full the newest are only counted.
+ *
+ * In other builds the guard is empty and violations() stays 0.
+ *
+ * The replaced allocator doesn't mix with AddressSanitizer, build one or the other.
+ */
+class RealtimeGuard {
+#ifdef AJ_REALTIME_GUARD
+    AJ::error::IErrorHandler &mHandler;
+    std::mutex mMux;
+    std::condition_variable mWake;
+    bool mStop = false;
+    std::thread mReporter;
+#endif
+
+public:
+    explicit RealtimeGuard(AJ::error::IErrorHandler &handler);
+
+    /// @brief Stop the reporter after a last drain().
+    ~RealtimeGuard();
+
+    RealtimeGuard(const RealtimeGuard&) = delete;
+    RealtimeGuard& operator=(const RealtimeGuard&) = delete;
+
+    /// @brief true in builds with `AJ_REALTIME_GUARD` defined.
+    static constexpr bool enabled() noexcept {
+#ifdef AJ_REALTIME_GUARD
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// @brief Violations detected since the process started, reported or not.
+    static uint64_t violations() noexcept;
+
+    /**
+     * @brief Record a violation of the calling thread if it is inside a RealtimeScope.
+     *
+     * Called by the replaced functions, `call` is the name of the function (a literal).
+     */
+    static void check(RealtimeViolation violation, const char *call) noexcept;
+
+    /// @brief Report the waiting violations now, on the calling thread.
+    void drain();
+};
+
+}
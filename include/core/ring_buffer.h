@@ -2,6 +2,7 @@
 #include "error_handler.h"
 #include "core/constants.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <atomic>
 #include <memory>
@@ -10,6 +11,30 @@
 
 namespace AJ::utils {
 
+/**
+ * @brief Contiguous run of interleaved frames inside a RingBuffer.
+ */
+struct RingSpan {
+    float *data = nullptr; ///< first sample of the run.
+    size_t frames = 0;     ///< number of frames in the run.
+};
+
+/**
+ * @brief Frames of a RingBuffer handed out by acquireWrite() / acquireRead().
+ *
+ * A region that crosses the end of the ring is split in two spans, the second one
+ * starts at the beginning of the ring. In mirrored mode the second span is always empty.
+ */
+struct RingRegion {
+    RingSpan first;  ///< frames from the current index up to the end of the ring.
+    RingSpan second; ///< frames wrapped to the beginning of the ring (empty if the region doesn't wrap).
+
+    /// @brief Total number of frames of the region.
+    size_t frames() const noexcept {
+        return first.frames + second.frames;
+    }
+};
+
 /**
  * @class RingBuffer
  * @brief Lock-free single-producer, single-consumer (SPSC) ring buffer for real-time audio.
@@ -55,6 +80,22 @@ namespace AJ::utils {
  *     //* out now contains the frame
  * }
  * @endcode
+ *
+ * ## Zero-copy access:
+ * `acquireWrite()` / `acquireRead()` hand out the ring memory itself (one or two spans),
+ * `commitWrite()` / `commitRead()` publish how many frames were actually produced / consumed.
+ * A callback or decoder writes straight into the ring and a consumer processes the data in place,
+ * there is no copy through an intermediate buffer.
+ *
+ * @code
+ * AJ::utils::RingRegion region = rb.acquireWrite(frames);
+ * decode(region.first.data, region.first.frames);
+ * decode(region.second.data, region.second.frames);
+ * rb.commitWrite(region.frames());
+ * @endcode
+ *
+ * Constructed with `mirrored = true` (Linux), the ring memory is mapped twice back to back,
+ * so a region never splits at the wrap (`second` is always empty).
  */
 
 class RingBuffer {
@@ -117,6 +158,11 @@ private:
      */
     alignas(CACHE_LINE_SIZE) std::atomic<bool> mFullFlag;
 
+    /**
+     * @brief true if the buffer memory is mapped twice back to back (magic ring), released with munmap.
+     */
+    bool mMirrored{false};
+
 private:
     /**
      * @brief Round up to next power of 2
@@ -161,6 +207,39 @@ private:
         return (currentWrite - currentRead) & mMask;
     }
 
+    /**
+     * @brief Allocate mSize samples (zeroed), double-mapped if `mirrored` and supported.
+     *
+     * The mirrored mapping needs whole pages, mSize (and mMask) may grow to a page.
+     * Falls back to a regular allocation if the mapping fails.
+     *
+     * @return false if the allocation failed.
+     */
+    bool allocBuffer(bool mirrored) noexcept;
+
+    /**
+     * @brief Release the memory allocated by allocBuffer().
+     */
+    void freeBuffer() noexcept;
+
+    /**
+     * @brief Split `samples` samples starting at `index` into the spans of a region.
+     */
+    RingRegion region(size_t index, size_t samples) const noexcept {
+        RingRegion result;
+        size_t first = mMirrored ? samples : std::min(mSize - index, samples);
+
+        result.first.data = &mBuffer[index];
+        result.first.frames = first / mChannels;
+
+        if(first != samples){
+            result.second.data = &mBuffer[0];
+            result.second.frames = (samples - first) / mChannels;
+        }
+
+        return result;
+    }
+
     /**
      * @brief Free the buffer and reset indices.
      *
@@ -174,10 +253,7 @@ private:
         mSize = 0;
         mMask = 0;
 
-        if(mBuffer){
-            std::free(mBuffer);
-            mBuffer = nullptr;
-        }
+        freeBuffer();
     }
 
 public: 
@@ -187,6 +263,8 @@ public:
      * @param size Desired buffer size per channel (will be rounded up to power of 2)
      * @param channels Number of audio channels (1=mono, 2=stereo)
      * @param handler Error handler for handling issues
+     * @param mirrored Map the buffer twice back to back so acquired regions never wrap
+     *                 (Linux only, the capacity is rounded up to a page; see isMirrored()).
      * 
      * @warning After construction, the caller **must check** if the buffer 
      *          is valid by calling `isValid()`. 
@@ -209,8 +287,9 @@ public:
      * - Buffers are initialized to zero.
      * - Memory is 32-byte aligned for SIMD operations.
      */
-    RingBuffer(size_t size, uint8_t channels, AJ::error::IErrorHandler& handler){
+    RingBuffer(size_t size, uint8_t channels, AJ::error::IErrorHandler& handler, bool mirrored = false){
         mValid = false;
+        mBuffer = nullptr;
         mFullFlag.store(false, std::memory_order_relaxed);
 
         if(size == 0){
@@ -230,20 +309,14 @@ public:
         mSize = size;
         mMask = size - 1;
 
-        //* init the buffers.
-        mBuffer = static_cast<float *>(
-            std::aligned_alloc(32, size * sizeof(float)) //? 32 alognment for SIMD operations.
-        );
-
-        if(!mBuffer){
+        //* init the buffers (zeroed).
+        if(!allocBuffer(mirrored)){
             const std::string message = std::bad_alloc().what();
             handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
             cleanup();
             return;
         }
 
-        //* init the buffer with 0 values.
-        std::memset(mBuffer, 0, sizeof(float) * size);
         mValid = true;
     }
 
@@ -321,6 +394,52 @@ public:
      */
     size_t readFrames(float *output, const size_t frames_count) noexcept;
 
+    /**
+     * @brief Get ring memory for up to `frames` frames to write (producer side).
+     *
+     * Nothing is published until commitWrite(). Calling acquireWrite() again before
+     * committing hands out the same memory.
+     *
+     * @param frames maximum number of frames wanted.
+     * @return region of at most `frames` free frames (fewer if the ring is nearly full, empty if full).
+     *
+     * It's wait-free and will never block.
+     */
+    RingRegion acquireWrite(size_t frames) noexcept;
+
+    /**
+     * @brief Publish `frames` frames written into the region returned by acquireWrite().
+     *
+     * @param frames frames actually written (<= region.frames()).
+     */
+    void commitWrite(size_t frames) noexcept;
+
+    /**
+     * @brief Get ring memory holding up to `frames` readable frames (consumer side).
+     *
+     * The frames stay in the ring (and may be processed in place) until commitRead().
+     *
+     * @param frames maximum number of frames wanted.
+     * @return region of at most `frames` frames (empty if the ring is empty).
+     *
+     * It's wait-free and will never block.
+     */
+    RingRegion acquireRead(size_t frames) noexcept;
+
+    /**
+     * @brief Release `frames` frames of the region returned by acquireRead() to the producer.
+     *
+     * @param frames frames actually consumed (<= region.frames()).
+     */
+    void commitRead(size_t frames) noexcept;
+
+    /**
+     * @brief Whether the ring memory is double-mapped (acquired regions never wrap).
+     */
+    bool isMirrored() const noexcept {
+        return mMirrored;
+    }
+
     /**
      * @brief Get the total size (capacity) of the buffer in frames.
      * @return Number of frames (not samples).
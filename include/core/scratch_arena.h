@@ -0,0 +1,254 @@
+#pragma once
+#include "types.h"
+#include "memory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace AJ::utils {
+
+/**
+ * @class ScratchArena
+ * @brief Bump allocator for the temporaries of effects and editing operations.
+ *
+ * Allocations are carved out of `kBufferAlignment` aligned blocks and released all at
+ * once, by rewind() to a mark() (see ScratchScope) or by reset(). reset() merges the blocks
+ * into one of their total size, so once a workload has run the arena holds a single block
+ * big enough for it: repeating the workload allocates (and page-faults) nothing.
+ *
+ * Objects with a destructor made by create() are destroyed on rewind, in reverse order.
+ * An arena belongs to one thread at a time, it isn't thread-safe.
+ *
+ * ### Example:
+ * @code
+ * AJ::utils::ScratchScope scope;         // marks the arena of this thread
+ * float *out = scope.arena().array<float>(frames);
+ * if(!out) { ... report ResourceAllocationFailed ... }
+ * // ... out is released when `scope` ends.
+ * @endcode
+ */
+class ScratchArena {
+public:
+    /// @brief Position of the arena, see mark() / rewind().
+    struct Marker {
+        size_t block = 0;
+        size_t offset = 0;
+        void *destructors = nullptr;
+    };
+
+    explicit ScratchArena(size_t blockBytes = kScratchBlockBytes) : mBlockBytes(blockBytes) {}
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * @brief Allocate `bytes` aligned to `alignment` (a power of two up to kBufferAlignment).
+     * @return nullptr if a new block couldn't be allocated.
+     */
+    void* allocate(size_t bytes, size_t alignment = kBufferAlignment) noexcept;
+
+    /**
+     * @brief `count` uninitialized elements, kBufferAlignment aligned.
+     * @return nullptr on allocation failure.
+     */
+    template<typename T>
+    T* array(size_t count) noexcept {
+        static_assert(std::is_trivially_destructible<T>::value, "arena arrays are never destroyed");
+
+        if(count > static_cast<size_t>(-1) / sizeof(T)){
+            return nullptr;
+        }
+
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T) > kBufferAlignment ? alignof(T) : kBufferAlignment));
+    }
+
+    /**
+     * @brief Construct a T in the arena, destroyed when the arena is rewound past it.
+     * @return nullptr on allocation failure.
+     */
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(alignof(T) <= kBufferAlignment, "over-aligned type");
+
+        if constexpr (std::is_trivially_destructible<T>::value){
+            void *storage = allocate(sizeof(T), alignof(T));
+            return storage ? ::new(storage) T(std::forward<Args>(args)...) : nullptr;
+        } else {
+            void *storage = allocate(sizeof(T), alignof(T));
+            Destructor *entry = static_cast<Destructor*>(allocate(sizeof(Destructor), alignof(Destructor)));
+            if(!storage || !entry){
+                return nullptr;
+            }
+
+            T *object = ::new(storage) T(std::forward<Args>(args)...);
+            *entry = Destructor{ [](void *p){ static_cast<T*>(p)->~T(); }, object, mDestructors };
+            mDestructors = entry;
+            return object;
+        }
+    }
+
+    /**
+     * @brief A Float of `frames` samples owned by the arena, for code that takes a Float.
+     *
+     * There is one per arena (not nested, not released by rewind): its capacity only grows,
+     * so resizing it allocates nothing once the longest channel has been seen.
+     */
+    Float& channel(size_t frames) {
+        return channels(frames, 1)[0];
+    }
+
+    /**
+     * @brief An AudioBuffer owned by the arena whose first `count` channels hold `frames` samples,
+     * for code that takes whole files. Same lifetime as channel(), which is its first channel.
+     */
+    AudioBuffer& channels(size_t frames, size_t count) {
+        for(size_t ch = 0; ch < count && ch < mChannels.size(); ++ch){
+            mChannels[ch].resize(frames);
+        }
+        return mChannels;
+    }
+
+    Marker mark() const noexcept {
+        return Marker{ mBlock, mOffset, mDestructors };
+    }
+
+    /// @brief Release everything allocated since `marker` (the memory stays in the arena).
+    void rewind(const Marker &marker) noexcept;
+
+    /// @brief Release every allocation and merge the blocks into one (only an arena with no live scope).
+    void reset() noexcept;
+
+    /// @brief Release every allocation and free the blocks (and the channels() buffers).
+    void release() noexcept;
+
+    /// @brief Bytes in use since the last reset (including alignment padding).
+    size_t used() const noexcept;
+
+    /// @brief Bytes owned by the arena.
+    size_t capacity() const noexcept;
+
+    /// @brief Blocks allocated over the arena's life, stops growing once the workload fits.
+    uint64_t blockAllocations() const noexcept {
+        return mBlockAllocations;
+    }
+
+    /**
+     * @brief The arena of the calling thread: the one installed by a ScratchScope or a
+     * ScratchPool::Lease, else a thread_local arena of the thread.
+     */
+    static ScratchArena& current() noexcept;
+
+private:
+    friend class ScratchScope;
+    friend class ScratchPool;
+
+    struct Block {
+        unsigned char *data;
+        size_t size;
+        Subsystem subsystem;   ///< MemoryScope the block was allocated in.
+    };
+
+    struct Destructor {
+        void (*destroy)(void*);
+        void *object;
+        Destructor *next;
+    };
+
+    std::vector<Block> mBlocks;
+    size_t mBlock = 0;                 ///< block being carved.
+    size_t mOffset = 0;                ///< first free byte of that block.
+    Destructor *mDestructors = nullptr;
+    size_t mBlockBytes;
+    uint64_t mBlockAllocations = 0;
+    AudioBuffer mChannels;             ///< see channels().
+
+    /// @brief Destroy the created objects down to `last` (exclusive).
+    void destroyUntil(Destructor *last) noexcept;
+
+    static ScratchArena*& installed() noexcept;
+};
+
+/**
+ * @class ScratchScope
+ * @brief Marks an arena and rewinds it when the scope ends.
+ *
+ * `ScratchScope()` marks the calling thread's current arena, `ScratchScope(arena)` also makes
+ * `arena` the current one until the scope ends, so code called inside draws from it.
+ */
+class ScratchScope {
+    ScratchArena &mArena;
+    ScratchArena *mPrevious;
+    ScratchArena::Marker mMarker;
+    bool mInstalled;
+
+public:
+    ScratchScope() : mArena(ScratchArena::current()), mPrevious(nullptr), mMarker(mArena.mark()), mInstalled(false) {}
+
+    explicit ScratchScope(ScratchArena &arena) : mArena(arena), mPrevious(ScratchArena::installed()),
+        mMarker(arena.mark()), mInstalled(true) {
+        ScratchArena::installed() = &arena;
+    }
+
+    ~ScratchScope() {
+        mArena.rewind(mMarker);
+        if(mInstalled){
+            ScratchArena::installed() = mPrevious;
+        }
+    }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    ScratchArena& arena() noexcept {
+        return mArena;
+    }
+};
+
+/**
+ * @class ScratchPool
+ * @brief Arenas shared by the jobs of an engine, one leased per running job.
+ *
+ * A Lease takes an idle arena (or creates one), installs it as the calling thread's current
+ * arena and, when it ends, resets it and gives it back. Concurrent jobs never share an arena,
+ * and the pool settles at one arena per concurrent job.
+ */
+class ScratchPool {
+    std::mutex mMux;
+    std::vector<std::unique_ptr<ScratchArena>> mIdle;
+    size_t mBlockBytes;
+
+public:
+    explicit ScratchPool(size_t blockBytes = kScratchBlockBytes) : mBlockBytes(blockBytes) {}
+
+    class Lease {
+        ScratchPool &mPool;
+        std::unique_ptr<ScratchArena> pArena;
+        ScratchArena *mPrevious;
+
+    public:
+        explicit Lease(ScratchPool &pool);
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ScratchArena& arena() noexcept {
+            return *pArena;
+        }
+    };
+
+    /// @brief Idle arenas (leases give theirs back).
+    size_t idle();
+
+    /// @brief Free the idle arenas.
+    void trim();
+};
+
+}
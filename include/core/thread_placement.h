@@ -0,0 +1,88 @@
+#pragma once
+#include "constants.h"
+#include "error_handler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace AJ::utils {
+
+/**
+ * @brief Scheduling class of a placed thread.
+ */
+enum class ThreadPriority : uint8_t {
+    Normal,     ///< left as created.
+    High,       ///< nice kHighThreadNice: ahead of the other threads of the host, still time shared.
+    Realtime,   ///< SCHED_FIFO at kRealtimeThreadPriority, needs CAP_SYS_NICE or an rtprio limit.
+    Low,        ///< nice kLowThreadNice: background work that yields to everything else, never refused.
+};
+
+/**
+ * @struct ThreadPlacement
+ * @brief Where a thread runs and how it's scheduled: cores, priority and NUMA node.
+ *
+ * The default placement changes nothing. `cores` pins the thread, when empty and `numaNode` is
+ * set the thread is pinned to the cores of that node. node() is also the node the pools used by
+ * the thread are allocated on (see EngineResources::Config::diskPlacement()).
+ *
+ * The setters return the placement, to be chained:
+ * @code
+ * // the disk writers on the second socket, the DSP workers on cores 0-7 of the first.
+ * auto disk = AJ::utils::ThreadPlacement().onNode(1).withPriority(AJ::utils::ThreadPriority::High);
+ * auto dsp = AJ::utils::ThreadPlacement().onCores({0, 1, 2, 3, 4, 5, 6, 7});
+ * @endcode
+ */
+struct ThreadPlacement {
+    std::vector<int> cores;                             ///< CPUs the thread may run on, empty: any.
+    ThreadPriority priority = ThreadPriority::Normal;
+    int numaNode = -1;                                  ///< -1: the node of the first core, if any.
+
+    ThreadPlacement& onCores(std::vector<int> list) { cores = std::move(list); return *this; }
+    ThreadPlacement& withPriority(ThreadPriority p) noexcept { priority = p; return *this; }
+    ThreadPlacement& onNode(int node) noexcept { numaNode = node; return *this; }
+
+    /// @brief true if placing a thread would change nothing.
+    bool isDefault() const noexcept {
+        return cores.empty() && priority == ThreadPriority::Normal && numaNode < 0;
+    }
+
+    /**
+     * @brief NUMA node of the placed thread: `numaNode`, else the node of the first core, else -1.
+     */
+    int node() const noexcept;
+};
+
+/// @brief NUMA nodes of the host, 1 without NUMA (or outside Linux).
+int numaNodes() noexcept;
+
+/// @brief CPUs of a NUMA node, empty for an unknown node.
+std::vector<int> numaNodeCores(int node);
+
+/// @brief NUMA node of a CPU, -1 if unknown.
+int numaNodeOfCore(int core) noexcept;
+
+/**
+ * @brief Apply a placement to the calling thread.
+ *
+ * Pins it to its cores, then sets its priority. A step that fails is reported and the others
+ * are still applied: InvalidConfiguration for cores the host doesn't have, InsufficientPermissions
+ * when the system refuses the priority (raise `rtprio` / `nice` in /etc/security/limits.conf),
+ * OperationNotAllowed outside Linux.
+ *
+ * @return true if everything was applied.
+ */
+bool placeCurrentThread(const ThreadPlacement &placement, AJ::error::IErrorHandler &handler);
+
+/**
+ * @brief Prefer the pages of [ptr, ptr + bytes) on a NUMA node.
+ *
+ * Only pages not yet touched follow: call it right after allocating, before writing the memory.
+ * The node is a preference, the kernel falls back on another when it's full.
+ *
+ * @return true if bound, or if `node` is -1.
+ */
+bool bindToNumaNode(void *ptr, size_t bytes, int node) noexcept;
+
+}
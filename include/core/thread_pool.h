@@ -1,57 +1,198 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
-#include <functional>
+#include <cstddef>
+#include <deque>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <new>
 #include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "constants.h"
+#include "error_handler.h"
+#include "thread_placement.h"
 
 namespace AJ::utils {
 
-class ThreadPool {
+/**
+ * @class Task
+ * @brief Move-only, type-erased `void()` callable with small buffer storage.
+ *
+ * Replaces `std::function<void()>` inside the ThreadPool.
+ * Callables up to `kInlineSize` bytes (lambdas capturing a few pointers / indices,
+ * `std::packaged_task`) are stored inline, so creating and running a Task does not
+ * touch the heap. Bigger callables fall back to a single heap allocation.
+ */
+class Task {
 public:
-    ThreadPool(size_t num_threads = std::thread::hardware_concurrency()) {
-        mNumThreads = num_threads;
-        mWorking = num_threads;
+    /// @brief Inline storage size in bytes.
+    static constexpr size_t kInlineSize = 48;
 
-        // Creating worker threads
-        for (size_t i = 0; i < num_threads; ++i) {
-            mThreads.emplace_back([this] {
-                while (true) {
-                    std::function<void()> task; 
-
-                    {
-                        std::unique_lock<std::mutex> lock(mMux);
-
-                        mWorking--;
-                        
-                        cv_.wait(lock, [this] {
-                            return !mTasks.empty() || mStop;
-                        });
-                        
-
-                        if (mStop && mTasks.empty()) {
-                            return;
-                        }
-
-                        // Get the next task from the queue
-                        task = move(mTasks.front());
-                        mTasks.pop();
-                        mWorking++;
-                    }
+    Task() noexcept = default;
 
-                    task();
-                }
-            });
+    template <typename F,
+              typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, Task>>>
+    Task(F&& fn) {
+        if constexpr (fitsInline<Fn>()) {
+            new (mStorage) Fn(std::forward<F>(fn));
+            pOps = &kInlineOps<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(mStorage) = new Fn(std::forward<F>(fn));
+            pOps = &kHeapOps<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept {
+        moveFrom(other);
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        reset();
+    }
+
+    /**
+     * @brief Run the stored callable.
+     * @warning The Task must not be empty.
+     */
+    void operator()() {
+        pOps->invoke(mStorage);
+    }
+
+    explicit operator bool() const noexcept {
+        return pOps != nullptr;
+    }
+
+    /**
+     * @brief Destroy the stored callable (if any), the Task becomes empty.
+     */
+    void reset() noexcept {
+        if (pOps) {
+            pOps->destroy(mStorage);
+            pOps = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= kInlineSize &&
+               alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static constexpr Ops kInlineOps = {
+        [](void* s) { (*static_cast<Fn*>(s))(); },
+        [](void* dst, void* src) noexcept {
+            new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* s) noexcept { static_cast<Fn*>(s)->~Fn(); }
+    };
+
+    template <typename Fn>
+    static constexpr Ops kHeapOps = {
+        [](void* s) { (**static_cast<Fn**>(s))(); },
+        [](void* dst, void* src) noexcept {
+            *static_cast<Fn**>(dst) = *static_cast<Fn**>(src);
+        },
+        [](void* s) noexcept { delete *static_cast<Fn**>(s); }
+    };
+
+    void moveFrom(Task& other) noexcept {
+        pOps = other.pOps;
+        if (pOps) {
+            pOps->move(mStorage, other.mStorage);
+            other.pOps = nullptr;
         }
     }
 
+    alignas(std::max_align_t) unsigned char mStorage[kInlineSize];
+    const Ops* pOps = nullptr;
+};
+
+/**
+ * @class ThreadPool
+ * @brief Work-stealing thread pool.
+ *
+ * ## Design:
+ * - Every worker owns a deque of `Task`s. A worker pushes/pops its own deque
+ *   from the back (LIFO, cache friendly) and steals from the front of the
+ *   other workers' deques when its own deque is empty.
+ * - Tasks enqueued from outside the pool are distributed round-robin over the
+ *   workers, tasks enqueued from a worker go to its own deque.
+ * - Each deque has its own lock, so producers and workers do not all fight
+ *   over one mutex. Idle workers sleep on a condition variable which is only
+ *   touched when someone is actually sleeping.
+ *
+ * ## Usage:
+ * @code
+ * AJ::utils::ThreadPool pool(4);
+ *
+ * // fire and forget
+ * pool.post([]{ doWork(); });
+ *
+ * // with a result
+ * std::future<int> f = pool.enqueue([]{ return 42; });
+ * int value = f.get();
+ *
+ * // split [0, n) into chunks of 4096 items and wait for all of them
+ * pool.parallel_for(0, n, 4096, [&](size_t begin, size_t end){
+ *     for (size_t i = begin; i < end; ++i) out[i] = in[i] * 0.5f;
+ * });
+ * @endcode
+ *
+ * @warning Do not block on a `std::future` from inside a pool task unless the
+ *          awaited task can make progress, use `parallel_for()` (which helps
+ *          executing pending tasks while waiting) or `tryRunPendingTask()`.
+ */
+class ThreadPool {
+public:
+    ThreadPool(size_t num_threads = std::thread::hardware_concurrency()) {
+        start(num_threads, nullptr, nullptr);
+    }
+
+    /**
+     * @brief A pool whose workers run with `placement` (cores, priority, NUMA node).
+     *
+     * Every worker places itself before taking its first task, the constructor returns once
+     * they all did. Failures go to `handler` from the worker threads, during the constructor
+     * only, and the workers run unplaced: see placed().
+     */
+    ThreadPool(size_t num_threads, const ThreadPlacement& placement, AJ::error::IErrorHandler& handler) {
+        start(num_threads, &placement, &handler);
+    }
+
     // Destructor to stop the thread pool
     ~ThreadPool()
     {
         {
-            // Lock the queue to update the stop flag safely
-            std::unique_lock<std::mutex> lock(mMux);
+            // Lock to update the stop flag safely
+            std::unique_lock<std::mutex> lock(mSleepMux);
             mStop = true;
         }
 
@@ -65,33 +206,320 @@ public:
         }
     }
 
-    // Enqueue task for execution by the thread pool
-    void enqueue(std::function<void()> task)
-    {
-        {
-            std::unique_lock<std::mutex> lock(mMux);
-            mTasks.emplace(std::move(task));
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Enqueue a task without a result handle.
+     *
+     * Small callables are stored inline in the `Task`, so this does not allocate
+     * (besides a possible growth of the worker deque).
+     */
+    template <typename F>
+    void post(F&& task) {
+        push(Task(std::forward<F>(task)));
+    }
+
+    /**
+     * @brief Enqueue a task for execution by the thread pool.
+     *
+     * @return std::future holding the result of `task()` (or `std::future<void>`).
+     *         Discarding the future is fine, it does not block on destruction.
+     */
+    template <typename F, typename R = std::invoke_result_t<std::decay_t<F>&>>
+    std::future<R> enqueue(F&& task) {
+        std::packaged_task<R()> packaged(std::forward<F>(task));
+        std::future<R> future = packaged.get_future();
+
+        push(Task(std::move(packaged)));
+
+        return future;
+    }
+
+    /**
+     * @brief Run `body(chunk_begin, chunk_end)` over [begin, end) split in chunks of `grain` items.
+     *
+     * Chunks are half-open ranges. The calling thread executes the first chunk
+     * itself and helps running pending pool tasks until every chunk is done, so
+     * calling parallel_for from inside a pool task does not dead lock.
+     *
+     * @param begin first index.
+     * @param end   one past the last index.
+     * @param grain number of items per chunk (values < 1 are treated as 1).
+     * @param body  callable `void(size_t chunk_begin, size_t chunk_end)`, must be safe to call concurrently.
+     */
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F&& body) {
+        if (begin >= end) {
+            return;
+        }
+
+        grain = std::max<size_t>(grain, 1);
+        const size_t chunks = (end - begin + grain - 1) / grain;
+
+        if (chunks == 1) {
+            body(begin, end);
+            return;
+        }
+
+        std::atomic<size_t> remaining{chunks - 1};
+
+        for (size_t c = 1; c < chunks; ++c) {
+            const size_t b = begin + c * grain;
+            const size_t e = std::min(b + grain, end);
+
+            post([&body, &remaining, b, e] {
+                body(b, e);
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+
+        body(begin, std::min(begin + grain, end));
+
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!tryRunPendingTask()) {
+                std::this_thread::yield();
+            }
         }
-        cv_.notify_one();
     }
 
+    /**
+     * @brief Execute one pending task on the calling thread, if there is any.
+     *
+     * @return true if a task was executed, false if no task was found.
+     */
+    bool tryRunPendingTask() {
+        Task task;
+        const size_t index = (currentPool() == this) ? currentIndex() : kNoWorker;
+
+        if (!popTask(index, task)) {
+            return false;
+        }
+
+        task();
+        return true;
+    }
+
+    /**
+     * @brief Wait for a task of this pool on the calling thread, running pending tasks
+     * meanwhile: a waiting worker keeps the pool going (see the warning above).
+     *
+     * @return the result of the task, a default one if `task` isn't valid.
+     */
+    template <typename R>
+    R helpUntil(std::future<R> &task) {
+        if (!task.valid()) {
+            return R();
+        }
+
+        while (task.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!tryRunPendingTask()) {
+                std::this_thread::yield();
+            }
+        }
+
+        return task.get();
+    }
+
+    /**
+     * @brief Number of currently idle worker threads.
+     */
     int available() noexcept {
-        std::unique_lock<std::mutex> lock(mMux);
-        return mNumThreads - mWorking;
+        return mIdle.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Number of queued tasks no thread started yet.
+     */
+    size_t pending() const noexcept {
+        return mPending.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Number of worker threads in the pool.
+     */
+    size_t size() const noexcept {
+        return mNumThreads;
+    }
+
+    /**
+     * @brief false if a worker couldn't apply its ThreadPlacement.
+     */
+    bool placed() const noexcept {
+        return mPlaced.load(std::memory_order_relaxed);
     }
 
 private:
+    static constexpr size_t kNoWorker = static_cast<size_t>(-1);
+
+    /**
+     * @brief Per worker task deque, padded to a cache line to avoid false sharing.
+     */
+    struct alignas(CACHE_LINE_SIZE) WorkerQueue {
+        std::mutex mux;
+        std::deque<Task> tasks;
+    };
+
+    static ThreadPool*& currentPool() noexcept {
+        static thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& currentIndex() noexcept {
+        static thread_local size_t index = kNoWorker;
+        return index;
+    }
+
+    void push(Task&& task) {
+        size_t index;
+
+        if (currentPool() == this) {
+            index = currentIndex();
+        } else {
+            index = mNext.fetch_add(1, std::memory_order_relaxed) % mNumThreads;
+        }
+
+        //? count the task before publishing it so mPending never underflows.
+        mPending.fetch_add(1, std::memory_order_seq_cst);
+
+        {
+            std::lock_guard<std::mutex> lock(mQueues[index]->mux);
+            mQueues[index]->tasks.emplace_back(std::move(task));
+        }
+
+        //? only touch the sleep mutex if someone is actually sleeping.
+        if (mIdle.load(std::memory_order_seq_cst) > 0) {
+            { std::lock_guard<std::mutex> lock(mSleepMux); }
+            cv_.notify_one();
+        }
+    }
+
+    /**
+     * @brief Pop from the own deque (back) or steal from the others (front).
+     */
+    bool popTask(size_t index, Task& out) {
+        if (mPending.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+
+        if (index != kNoWorker) {
+            WorkerQueue& own = *mQueues[index];
+            std::lock_guard<std::mutex> lock(own.mux);
+
+            if (!own.tasks.empty()) {
+                out = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                mPending.fetch_sub(1, std::memory_order_acq_rel);
+                return true;
+            }
+        }
+
+        const size_t start = (index == kNoWorker) ? 0 : index + 1;
+
+        for (size_t i = 0; i < mNumThreads; ++i) {
+            const size_t victim = (start + i) % mNumThreads;
+            if (victim == index) {
+                continue;
+            }
+
+            WorkerQueue& queue = *mQueues[victim];
+            std::unique_lock<std::mutex> lock(queue.mux, std::try_to_lock);
+
+            if (lock.owns_lock() && !queue.tasks.empty()) {
+                out = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                mPending.fetch_sub(1, std::memory_order_acq_rel);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void start(size_t num_threads, const ThreadPlacement* placement, AJ::error::IErrorHandler* handler) {
+        if (num_threads == 0) {
+            num_threads = 1;
+        }
+
+        mNumThreads = num_threads;
+
+        mQueues.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i) {
+            mQueues.emplace_back(std::make_unique<WorkerQueue>());
+        }
+
+        std::mutex startMux;
+        std::condition_variable started;
+        size_t starting = placement ? num_threads : 0;
+
+        // Creating worker threads
+        for (size_t i = 0; i < num_threads; ++i) {
+            mThreads.emplace_back([this, i, placement, handler, &startMux, &started, &starting] {
+                if (placement) {
+                    if (!placeCurrentThread(*placement, *handler)) {
+                        mPlaced.store(false, std::memory_order_relaxed);
+                    }
+
+                    //? the placement, handler and latch live on the constructor's stack.
+                    std::lock_guard<std::mutex> lock(startMux);
+                    if (--starting == 0) {
+                        started.notify_one();
+                    }
+                }
+                workerLoop(i);
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(startMux);
+        started.wait(lock, [&starting] { return starting == 0; });
+    }
+
+    void workerLoop(size_t index) {
+        currentPool() = this;
+        currentIndex() = index;
+
+        while (true) {
+            Task task;
+
+            if (popTask(index, task)) {
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mSleepMux);
+
+            mIdle.fetch_add(1, std::memory_order_seq_cst);
+
+            cv_.wait(lock, [this] {
+                return mPending.load(std::memory_order_seq_cst) > 0 || mStop;
+            });
+
+            mIdle.fetch_sub(1, std::memory_order_seq_cst);
+
+            if (mStop && mPending.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
     std::vector<std::thread> mThreads;
 
-    std::queue<std::function<void()> > mTasks;
+    std::vector<std::unique_ptr<WorkerQueue>> mQueues;
 
-    std::mutex mMux;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mPending{0};
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int> mIdle{0};
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mNext{0};
+
+    std::mutex mSleepMux;
 
     std::condition_variable cv_;
 
     bool mStop = false;
 
-    int mWorking;
-    int mNumThreads;
+    size_t mNumThreads;
+
+    std::atomic<bool> mPlaced{true};
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "constants.h"
+#include "error_handler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Timed zones of the engine, written as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+ *
+ * Zones are placed with AJ_TRACE_ZONE(category, name) around decoding, resampling, effects,
+ * file writes and queue waits. They only exist in builds with `AJ_TRACE` defined
+ * (`-DAJ_TRACE=ON` in CMake), elsewhere the macro expands to nothing.
+ *
+ * In a tracing build a zone costs one relaxed load while recording is stopped. While it runs,
+ * a zone appends one event to the ring of its thread (no lock, no allocation after the
+ * first event of the thread): kTraceThreadEvents per thread, the oldest are overwritten.
+ * The rings outlive their threads, so the events of finished pool threads are written too.
+ *
+ * ### Example:
+ * @code
+ * AJ::utils::trace::start();
+ * engine->applyEffect(file, AJ::Effect::gain, params, handler);
+ * AJ::utils::trace::stop();
+ * AJ::utils::trace::write("effects.json", handler);
+ * @endcode
+ *
+ * start() and write() expect no zone of an earlier recording to still be running.
+ */
+namespace AJ::utils::trace {
+
+namespace detail {
+    inline std::atomic<bool> gRecording{false};
+}
+
+/// @brief Clear the rings and start recording.
+void start() noexcept;
+
+/// @brief Stop recording, the events are kept until the next start().
+void stop() noexcept;
+
+inline bool recording() noexcept {
+    return detail::gRecording.load(std::memory_order_relaxed);
+}
+
+/// @brief Monotonic time in nanoseconds, the clock of the events.
+inline uint64_t now() noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * @brief Append a complete event to the ring of the calling thread.
+ * @param category, name string literals (only the pointers are kept).
+ */
+void record(const char *category, const char *name, uint64_t start, uint64_t end) noexcept;
+
+/// @brief Events recorded since start(), including the overwritten ones.
+uint64_t recorded() noexcept;
+
+/// @brief Events overwritten because a ring was full.
+uint64_t overwritten() noexcept;
+
+/**
+ * @brief Write the events kept by the rings as Chrome trace JSON (one track per thread).
+ * @return false (reported as FileOpenError / FileWriteError) if the file can't be written.
+ */
+bool write(const std::string &path, AJ::error::IErrorHandler &handler);
+
+/**
+ * @class Zone
+ * @brief Times its scope as an event, if recording when it begins.
+ */
+class Zone {
+    const char *mCategory;
+    const char *mName;
+    uint64_t mStart;
+
+public:
+    Zone(const char *category, const char *name) noexcept :
+        mCategory(category), mName(name), mStart(recording() ? now() : 0) {}
+
+    ~Zone() {
+        if(mStart){
+            record(mCategory, mName, mStart, now());
+        }
+    }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+};
+
+}
+
+#define AJ_TRACE_CONCAT_(a, b) a##b
+#define AJ_TRACE_CONCAT(a, b) AJ_TRACE_CONCAT_(a, b)
+
+#ifdef AJ_TRACE
+/// @brief Time the rest of the scope as `name` in `category` (string literals).
+#define AJ_TRACE_ZONE(category, name) \
+    const AJ::utils::trace::Zone AJ_TRACE_CONCAT(ajTraceZone, __LINE__)(category, name)
+#else
+#define AJ_TRACE_ZONE(category, name) ((void)0)
+#endif
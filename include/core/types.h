@@ -8,6 +8,7 @@
 #include <atomic>
 
 #include "constants.h"
+#include "aligned_allocator.h"
 
 namespace AJ {
 
@@ -26,8 +27,9 @@ typedef uint64_t sample_c;
 /// @brief Sample position/index in a stream.
 typedef int64_t sample_pos;
 
-/// @brief Single-channel buffer of float samples.
-using Float = std::vector<float>;
+/// @brief Single-channel buffer of float samples, kBufferAlignment aligned (see AlignedAllocator).
+/// Resizing doesn't zero the new samples.
+using Float = std::vector<float, AlignedAllocator<float>>;
 
 /// @brief Multichannel audio buffer organized by processing blocks.
 /// Outer array: channels, inner vectors: sample blocks.
@@ -36,6 +38,30 @@ using AudioBuffer = std::array<Float, kNumChannels>;
 /// @brief Shared pointer to audio sample data (used in AudioFile).
 using AudioSamples = std::shared_ptr<AudioBuffer>;
 
+/**
+ * @brief Non-owning view of interleaved samples in memory owned by the caller (a device buffer,
+ * a utils::Buffer, a mapping).
+ *
+ * Sample `ch` of frame `i` is `data[i * stride + ch]`. `stride` is in floats and at least
+ * `channels`, a larger one skips the interleaved channels the view leaves out. A single planar
+ * channel is a view of 1 channel with a stride of 1.
+ */
+struct AudioView {
+    float *data = nullptr;
+    size_t frames = 0;
+    uint8_t channels = 1;
+    size_t stride = 1;
+
+    /// @brief Whether the frames follow each other without a gap, as processBlock() takes them.
+    bool packed() const noexcept {
+        return stride == channels;
+    }
+
+    float& at(uint8_t channel, size_t frame) const noexcept {
+        return data[frame * stride + channel];
+    }
+};
+
 /// @brief Read-only string reference.
 using String_c = const std::string;
 
@@ -205,10 +231,25 @@ enum Effect {
      */
     pitchShift,
 
+    /**
+     * @brief Boosts or cuts frequency bands (parametric equalizer).
+     */
+    equalizer,
+
+    /**
+     * @brief Compresses the dynamic range and holds the peaks under a ceiling (lookahead limiter).
+     */
+    dynamics,
+
     /**
      * @brief Reverses the audio data in time.
      */
-    reverse
+    reverse,
+
+    /**
+     * @brief Attenuates the audio while it stays under a threshold (noise gate).
+     */
+    gate
 };
 
 /**
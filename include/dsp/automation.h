@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/error_handler.h"
+
+namespace AJ::dsp {
+
+/**
+ * @brief Shape of an automation segment, from one breakpoint to the next.
+ */
+enum class CurveShape : uint8_t {
+    Hold,        ///< keeps the value of the breakpoint until the next one (a step).
+    Linear,      ///< straight line.
+    Exponential, ///< `v0 * (v1 / v0)^t`, linear in dB (linear if a value isn't > 0).
+    SCurve       ///< smoothstep `3t^2 - 2t^3`, flat at both ends.
+};
+
+/**
+ * @brief Automation point: `mValue` at frame `mFrame`, `mShape` to the next point.
+ */
+struct Breakpoint {
+    sample_pos mFrame;                        ///< frame of the point (same frames as the effect range).
+    float mValue;                             ///< parameter value at the point.
+    CurveShape mShape = CurveShape::Linear;   ///< shape of the segment to the next point.
+};
+
+/**
+ * @brief Linear piece of an automation lane, `value + step * i` for i in [0, frames).
+ */
+struct AutomationRun {
+    size_t frames;
+    double value;
+    double step;
+};
+
+/**
+ * @class Automation
+ * @brief Breakpoint curve of an effect parameter (gain, echo decay, reverb wet mix).
+ *
+ * A lane is evaluated as consecutive linear runs, so it goes through the same ramp
+ * kernel as Fade (`kernels::fade`) and is sample accurate at every breakpoint:
+ * - Hold and Linear segments are a single run.
+ * - Exponential and SCurve segments are evaluated exactly every `kAutomationRampFrames`
+ *   frames and interpolated linearly in between.
+ * - Before the first point the lane holds its value, after the last point too.
+ *
+ * ### Example:
+ * @code
+ * auto duck = std::make_shared<AJ::dsp::Automation>();
+ * duck->add({ 0, 1.0f, AJ::dsp::CurveShape::SCurve }, handler);
+ * duck->add({ 44100, 0.3f, AJ::dsp::CurveShape::Hold }, handler);
+ * duck->add({ 8 * 44100, 0.3f, AJ::dsp::CurveShape::Exponential }, handler);
+ * duck->add({ 9 * 44100, 1.0f }, handler);
+ *
+ * gain.setGainAutomation(duck);
+ * @endcode
+ */
+class Automation {
+    std::vector<Breakpoint> mPoints; ///< sorted by frame, one point per frame.
+
+public:
+    /**
+     * @brief Add a point, or replace the point at the same frame.
+     *
+     * @return false (reported) if the frame is negative.
+     */
+    bool add(const Breakpoint &point, AJ::error::IErrorHandler &handler);
+
+    /// @brief Remove all points.
+    void clear() noexcept {
+        mPoints.clear();
+    }
+
+    /// @brief Number of points.
+    size_t size() const noexcept {
+        return mPoints.size();
+    }
+
+    /// @brief Whether the lane has no point (it then has no value).
+    bool empty() const noexcept {
+        return mPoints.empty();
+    }
+
+    /// @brief Points, sorted by frame.
+    const std::vector<Breakpoint>& points() const noexcept {
+        return mPoints;
+    }
+
+    /**
+     * @brief The linear run starting at `frame`, at most `maxFrames` frames long.
+     * @pre the lane isn't empty, maxFrames > 0.
+     */
+    AutomationRun runAt(sample_pos frame, size_t maxFrames) const;
+
+    /// @brief Value at `frame` (the lane must not be empty).
+    float valueAt(sample_pos frame) const;
+
+    /**
+     * @brief `out[i]` = value at frame `start + i`, for i in [0, frames).
+     */
+    void render(sample_pos start, size_t frames, float *out) const;
+
+    /**
+     * @brief `data[i] = clamp(data[i] * value(start + i), -1, 1)` for i in [0, count), on the fade kernel.
+     */
+    void applyGain(float *data, size_t count, sample_pos start) const;
+};
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <algorithm>
+
+#include "core/types.h"
+
+namespace AJ::dsp {
+
+/**
+ * @class DelayLine
+ * @brief Fixed-length circular delay line.
+ *
+ * Holds the last `delay()` samples pushed into it, memory is bounded by the
+ * delay and not by the length of the processed audio.
+ *
+ * ### Usage:
+ * @code
+ * DelayLine line;
+ * line.resize(delaySamples);
+ *
+ * for (...) {
+ *     sample_t delayed = line.tap(); // x[n - delay], 0 until the line is primed
+ *     line.push(x);
+ * }
+ * @endcode
+ */
+class DelayLine {
+    Float mBuffer;        ///< ring storage, size = delay in samples.
+    size_t mIndex = 0;    ///< position of the oldest sample (= next write position).
+    size_t mFilled = 0;   ///< number of samples pushed so far (saturates at delay).
+
+public:
+    DelayLine() = default;
+
+    explicit DelayLine(size_t delay) {
+        resize(delay);
+    }
+
+    /**
+     * @brief Set the delay in samples, clears the line.
+     */
+    void resize(size_t delay) {
+        mBuffer.assign(delay, 0.0f);
+        mIndex = 0;
+        mFilled = 0;
+    }
+
+    /**
+     * @brief Delay in samples.
+     */
+    size_t delay() const noexcept {
+        return mBuffer.size();
+    }
+
+    /**
+     * @brief The sample pushed `delay()` pushes ago (0 while the line is not primed).
+     */
+    sample_t tap() const noexcept {
+        return mBuffer.empty() ? 0.0f : mBuffer[mIndex];
+    }
+
+    /**
+     * @brief true once at least `delay()` samples were pushed.
+     */
+    bool primed() const noexcept {
+        return mFilled >= mBuffer.size();
+    }
+
+    /**
+     * @brief Push a new sample, overwriting the oldest one.
+     */
+    void push(sample_t sample) noexcept {
+        if(mBuffer.empty()){
+            return;
+        }
+
+        mBuffer[mIndex] = sample;
+
+        if(++mIndex == mBuffer.size()){
+            mIndex = 0;
+        }
+
+        if(mFilled < mBuffer.size()){
+            ++mFilled;
+        }
+    }
+
+    /**
+     * @brief Pointer to the oldest sample (= next write position).
+     *
+     * `head()[0 .. contiguous())` are the next taps in order, used by block kernels that
+     * read the taps and overwrite them with the new samples in place, then call advance().
+     */
+    sample_t *head() noexcept {
+        return mBuffer.data() + mIndex;
+    }
+
+    /**
+     * @brief Number of samples from head() to the end of the ring storage.
+     */
+    size_t contiguous() const noexcept {
+        return mBuffer.size() - mIndex;
+    }
+
+    /**
+     * @brief Move the line forward after `count` (<= contiguous()) samples were written at head().
+     */
+    void advance(size_t count) noexcept {
+        if(mBuffer.empty()){
+            return;
+        }
+
+        mIndex += count;
+        if(mIndex == mBuffer.size()){
+            mIndex = 0;
+        }
+
+        mFilled = std::min(mFilled + count, mBuffer.size());
+    }
+
+    /**
+     * @brief Zero the line, keeps the delay.
+     */
+    void clear() noexcept {
+        std::fill(mBuffer.begin(), mBuffer.end(), 0.0f);
+        mIndex = 0;
+        mFilled = 0;
+    }
+};
+
+}
@@ -14,7 +14,21 @@ namespace AJ::dsp::distortion {
  * @brief Enumeration of available distortion processing types.
  */
 enum DistortionType {
-    SoftClipping ///< Soft clipping distortion using tanh waveshaping.
+    SoftClipping, ///< Soft clipping distortion using tanh waveshaping.
+    HardClipping, ///< Hard clipping at ±1 after the gain.
+    Cubic,        ///< Cubic soft clipping `1.5x - 0.5x^3` (gentler knee than tanh).
+    Asymmetric    ///< tanh waveshaping with the negative half-wave driven harder (even harmonics).
+};
+
+/**
+ * @brief Accuracy of the tanh used by SoftClipping and Asymmetric.
+ *
+ * The other types don't use tanh and ignore it.
+ */
+enum DistortionPrecision {
+    Exact,    ///< std::tanh per sample (scalar).
+    Accurate, ///< vectorized rational approximation, max error < 1e-4.
+    Fast      ///< vectorized low order approximation, max error < 2.4e-2.
 };
 
 /**
@@ -25,14 +39,15 @@ struct Params {
     sample_c mEnd;             ///< Ending sample index for processing.
     float mGain;               ///< Gain multiplier for distortion.
     DistortionType mType;      ///< Type of distortion to apply.
+    DistortionPrecision mPrecision; ///< Accuracy of the tanh approximation.
     
     /**
      * @brief Default constructor.
      *
-     * Initializes the distortion type to SoftClipping. Other members
-     * remain uninitialized and should be explicitly set before use.
+     * Initializes the distortion type to SoftClipping and the precision to Accurate.
+     * Other members remain uninitialized and should be explicitly set before use.
      */
-    Params(){ mType = DistortionType::SoftClipping; }
+    Params(){ mType = DistortionType::SoftClipping; mPrecision = DistortionPrecision::Accurate; }
 };
 
 /**
@@ -47,6 +62,7 @@ class DistortionParams : public EffectParams {
     sample_c mEnd;        ///< Ending sample index.(inclusive)
     float mGain;          ///< Gain multiplier.
     DistortionType mType; ///< Distortion processing type.
+    DistortionPrecision mPrecision; ///< Accuracy of the tanh approximation.
 
 public:
 
@@ -101,6 +117,24 @@ public:
         return mType;
     }
 
+    /**
+     * @brief Set the accuracy of the tanh approximation.
+     * 
+     * @param precision Distortion precision.
+     */
+    void setPrecision(DistortionPrecision precision) noexcept {
+        mPrecision = precision;
+    }
+
+    /**
+     * @brief Get the accuracy of the tanh approximation.
+     * 
+     * @return Distortion precision.
+     */
+    DistortionPrecision Precision() const noexcept {
+        return mPrecision;
+    }
+
 
     /**
      * @brief Private-tag constructor with default values.
@@ -110,6 +144,7 @@ public:
         mEnd = -1;
         mGain = 1.0f;
         mType = DistortionType::SoftClipping;
+        mPrecision = DistortionPrecision::Accurate;
     }
 };
 
@@ -125,16 +160,20 @@ public:
  */
 class Distortion : public AJ::dsp::Effect {
     std::shared_ptr<DistortionParams> mParams; ///< Effect parameters.
+    RenderQuality mQuality = RenderQuality::Full; ///< Preview shapes with the Fast tanh.
 
     /**
-     * @brief Apply soft clipping distortion to the buffer.
+     * @brief Apply the distortion curve of the parameters to contiguous samples.
+     *
+     * Runs the vectorized shape kernel, or std::tanh for the Exact precision.
      * 
-     * @param buffer  Audio buffer to process.
+     * @param data    samples to process in-place.
+     * @param count   number of samples.
      * @param handler Error handler for reporting invalid parameters.
      * 
      * @return true if processing succeeded, false otherwise.
      */
-    bool softClipping(Float& buffer, AJ::error::IErrorHandler &handler);
+    bool shape(float *data, size_t count, AJ::error::IErrorHandler &handler);
 
 public:
 
@@ -167,6 +206,50 @@ public:
      */
     bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
 
+    /**
+     * @brief At RenderQuality::Preview the tanh curves use the Fast approximation, whatever the
+     * precision of the parameters.
+     */
+    void setQuality(RenderQuality quality) override {
+        mQuality = quality;
+    }
+
+    /**
+     * @brief The curve is applied to every sample on its own.
+     */
+    bool splitsRange() const override {
+        return true;
+    }
+
+    /**
+     * @brief Apply the distortion curve to the frames [first, last) of the range.
+     */
+    bool processRange(Float &buffer, size_t first, size_t last, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief Apply the distortion effect to one block of interleaved frames, in-place.
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     * Distortion has no memory, the base EffectState is enough.
+     *
+     * @param data     interleaved samples, `frames * channels` floats.
+     * @param frames   number of frames in the block.
+     * @param channels number of interleaved channels (must match the state).
+     * @param state    stream state created by createState().
+     * @param handler  Error handler for reporting processing issues.
+     *
+     * @return true on success, false on failure.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+
     /** @name Parameter Accessors */
     ///@{
 
@@ -194,6 +277,12 @@ public:
     /** @brief Get the distortion type. */
     DistortionType Type() const { return mParams ? mParams->Type() : DistortionType::SoftClipping; }
 
+    /** @brief Set the tanh precision. */
+    void setPrecision(DistortionPrecision precision) { if (mParams) mParams->setPrecision(precision); }
+
+    /** @brief Get the tanh precision. */
+    DistortionPrecision Precision() const { return mParams ? mParams->Precision() : DistortionPrecision::Accurate; }
+
     ///@}
 };
 
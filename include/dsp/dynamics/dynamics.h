@@ -0,0 +1,237 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "dsp/effect.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+
+namespace AJ::dsp::dynamics {
+
+/**
+ * @brief Container for all dynamics (compressor + limiter) parameters.
+ */
+struct Params {
+    sample_pos mStart;     /**< Start position of the effect in samples (inclusive). */
+    sample_pos mEnd;       /**< End position of the effect in samples (inclusive). */
+    uint32_t mSamplerate;  /**< Samplerate of the audio, sets the timing of the envelopes. */
+    float mThresholdDb;    /**< Compressor threshold in dBFS, [kDynamicsMinThresholdDb, 0]. */
+    float mRatio;          /**< Compression ratio, [1, kDynamicsMaxRatio] (1: no compression). */
+    float mKneeDb;         /**< Soft knee width in dB, [0, kDynamicsMaxKneeDb] (0: hard knee). */
+    float mAttackMs;       /**< Compressor attack, [0, kDynamicsMaxAttackMs] ms. */
+    float mReleaseMs;      /**< Compressor and limiter release, [0, kDynamicsMaxReleaseMs] ms. */
+    float mMakeupDb;       /**< Gain after the compressor in dB, [0, kDynamicsMaxMakeupDb]. */
+    float mCeilingDb;      /**< Limiter ceiling in dBFS, [kDynamicsMinCeilingDb, 0]: no output sample exceeds it. */
+    float mLookaheadMs;    /**< Limiter lookahead (and latency), (0, kDynamicsMaxLookaheadMs] ms. */
+};
+
+/**
+ * @brief Per-frame constants of a Processor, derived once from Params.
+ */
+struct Settings {
+    float mThresholdDb = 0.0f; ///< compressor threshold, dBFS.
+    float mSlope = 0.0f;       ///< 1 / ratio - 1: gain change per dB above the threshold (0: no compression).
+    float mKneeDb = 0.0f;      ///< soft knee width, dB.
+    float mKneeStart = 1.0f;   ///< linear level below which the compressor leaves the signal alone.
+    float mMakeup = 1.0f;      ///< linear makeup gain.
+    float mAttack = 0.0f;      ///< attack one-pole coefficient per frame.
+    float mRelease = 0.0f;     ///< release one-pole coefficient per frame.
+    float mCeiling = 1.0f;     ///< linear limiter ceiling.
+    size_t mLookahead = 1;     ///< limiter lookahead in frames, the latency of the processor.
+
+    /// @brief Whether the compressor stage changes the signal (ratio > 1 or makeup gain).
+    bool compresses() const noexcept { return mSlope != 0.0f || mMakeup != 1.0f; }
+
+    /// @brief Settings of valid parameters (see DynamicsParams::create()).
+    static Settings from(const Params &params);
+
+    /// @brief Settings of a limiter alone (no compression, no makeup).
+    static Settings limiter(uint32_t samplerate, float ceilingDb, float lookaheadMs, float releaseMs);
+};
+
+/**
+ * @brief Streaming compressor and lookahead peak limiter of interleaved mono or stereo frames.
+ *
+ * Per chunk of kDynamicsChunkFrames frames:
+ * 1. the `framePeak` kernel measures every frame (channels linked: the loudest one);
+ * 2. the compressor follows the peaks with an attack / release envelope, maps it through the
+ *    soft knee curve and the `frameGain` kernel applies the gains;
+ * 3. the limiter asks each frame for min(1, ceiling / peak). The minimum over the last
+ *    `lookahead + 1` requests (a monotonic queue, amortized O(1) per frame) is averaged over
+ *    as many frames, so the gain ramps down over the lookahead and is at or under every
+ *    request of the frame it's applied to: the frames leave `lookahead` frames late, after the
+ *    release smoothing, and never exceed the ceiling.
+ *
+ * Nothing is allocated after construction.
+ */
+class Processor {
+    Settings mSettings;
+    size_t mChannels;
+
+    Float mDelay;                     ///< lookahead frames waiting for their gain (ring).
+    size_t mDelayPos = 0;
+
+    Float mMinValues;                 ///< requested gains of the window, increasing (ring).
+    std::vector<uint64_t> mMinFrames; ///< frame of every queued request.
+    size_t mMinHead = 0;
+    size_t mMinCount = 0;
+
+    Float mHold;                      ///< window minimums averaged by the limiter (ring).
+    size_t mHoldPos = 0;
+    double mHoldSum = 0.0;
+
+    float mEnvelope = 0.0f;           ///< compressor level follower.
+    float mGain = 1.0f;               ///< limiter gain after the release.
+    uint64_t mFrame = 0;              ///< frames processed since reset().
+
+    /// @brief Gain the limiter applies to the frame leaving the delay line when `request` comes in.
+    float limit(float request);
+
+public:
+    /**
+     * @param settings derived constants (see Settings::from()).
+     * @param channels interleaved channels, 1 to kNumChannels.
+     */
+    Processor(const Settings &settings, size_t channels);
+
+    /// @brief Frames the output lags the input, the lookahead.
+    size_t latency() const noexcept { return mSettings.mLookahead; }
+
+    /// @brief Process `frames` interleaved frames in-place, the output lags by latency() frames.
+    void process(float *data, size_t frames);
+
+    /**
+     * @brief Process a whole planar signal in-place, latency compensated: reset(), then `frames`
+     * frames scaled by `inputGain` followed by latency() frames of silence.
+     *
+     * @param channels one pointer per channel of the processor, `frames` samples each
+     *                 (interleaved in chunks on the way in, so the channels stay linked).
+     */
+    void processAligned(float *const *channels, size_t frames, float inputGain = 1.0f);
+
+    /// @brief Forget the envelopes and the delayed frames.
+    void reset();
+};
+
+/**
+ * @brief Parameter container for the Dynamics effect.
+ *
+ * @see AJ::dsp::EffectParams
+ */
+class DynamicsParams : public EffectParams {
+    struct PrivateTag {};
+
+    Settings mSettings; ///< derived constants.
+
+public:
+    /**
+     * @brief Factory method to create a DynamicsParams instance.
+     *
+     * Validation rules: every field in the range documented in Params, `mSamplerate` in
+     * [kMinSamplerate, kMaxSamplerate].
+     *
+     * @return Shared pointer to a valid DynamicsParams instance if parameters are valid,
+     *         otherwise nullptr.
+     */
+    static std::shared_ptr<DynamicsParams> create(Params &params, AJ::error::IErrorHandler &handler);
+
+    /// @brief Per-frame constants of the processors.
+    const Settings& Setup() const noexcept { return mSettings; }
+
+    /// @brief Frames the block processing output lags its input, the lookahead.
+    size_t Latency() const noexcept { return mSettings.mLookahead; }
+
+    ~DynamicsParams() override = default;
+
+    DynamicsParams(PrivateTag) {}
+};
+
+/**
+ * @brief Block processing state of the Dynamics effect, the processor of the stream.
+ */
+class DynamicsState : public EffectState {
+public:
+    std::unique_ptr<Processor> mProcessor;        ///< envelopes and delayed frames.
+    std::shared_ptr<const DynamicsParams> mOwner; ///< parameters the processor was set up from.
+
+    explicit DynamicsState(uint8_t channels) : EffectState(channels) {}
+
+    void reset() override {
+        EffectState::reset();
+        mProcessor->reset();
+    }
+};
+
+/**
+ * @brief Compressor followed by a lookahead peak limiter over [Start, End] (see Processor).
+ *
+ * - process() compensates the lookahead: the output is aligned with the input.
+ * - processBlock() streams: the output lags the input by `Latency()` frames, and the range starts
+ *   with that much silence. Like every ranged effect the result stops at End.
+ */
+class Dynamics : public AJ::dsp::Effect {
+    std::shared_ptr<DynamicsParams> mParams;
+
+public:
+    Dynamics() {
+        mParams = nullptr;
+    }
+
+    /**
+     * @brief Compress and limit [Start, End] of a single-channel buffer in-place, latency compensated.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Compress and limit [Start, End] of the first `channels` channels with linked gains,
+     * latency compensated: the loudest channel of every frame drives both.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief The channels share the envelopes.
+     */
+    bool linksChannels() const override {
+        return true;
+    }
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief The stream lags by the lookahead, process() is aligned with its input.
+     */
+    bool blockMatchesProcess() const override {
+        return false;
+    }
+
+    /**
+     * @brief Create a DynamicsState for mono or stereo streams (channels are linked).
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Compress and limit one block of interleaved frames, in-place (the output lags by `Latency()` frames).
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Set effect parameters from a shared EffectParams object (must be DynamicsParams).
+     */
+    bool setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler) override;
+};
+
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include <memory>
+
+#include "dsp/effect.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+
+namespace AJ::dsp::gate {
+
+/**
+ * @brief Container for all noise gate parameters.
+ */
+struct Params {
+    sample_pos mStart;     /**< Start position of the effect in samples (inclusive). */
+    sample_pos mEnd;       /**< End position of the effect in samples (inclusive). */
+    uint32_t mSamplerate;  /**< Samplerate of the audio, sets the timing of the envelope. */
+    float mThresholdDb;    /**< Level the gate opens at in dBFS, [kGateMinThresholdDb, 0]. */
+    float mRangeDb;        /**< Gain of the closed gate in dB, [kGateMinRangeDb, 0] (0: the gate does nothing). */
+    float mAttackMs;       /**< Time to open, [0, kGateMaxAttackMs] ms. */
+    float mHoldMs;         /**< Time the gate stays open once the level falls under the threshold, [0, kGateMaxHoldMs] ms. */
+    float mReleaseMs;      /**< Time to close, [0, kGateMaxReleaseMs] ms. */
+};
+
+/**
+ * @brief Per-frame constants of a Processor, derived once from Params.
+ */
+struct Settings {
+    float mOpen = 0.0f;     ///< linear level at or above which the closed gate opens.
+    float mClose = 0.0f;    ///< linear level under which the open gate starts holding, kGateHysteresisDb under mOpen.
+    float mFloor = 1.0f;    ///< linear gain of the closed gate.
+    float mAttack = 0.0f;   ///< attack one-pole coefficient per frame.
+    float mRelease = 0.0f;  ///< release one-pole coefficient per frame.
+    size_t mHold = 0;       ///< hold in frames.
+
+    /// @brief Settings of valid parameters (see GateParams::create()).
+    static Settings from(const Params &params);
+};
+
+/**
+ * @brief Streaming noise gate of interleaved mono or stereo frames.
+ *
+ * Per chunk of kDynamicsChunkFrames frames:
+ * 1. the `framePeak` kernel measures every frame (channels linked: the loudest one);
+ * 2. a scalar pass turns the peaks into per-frame targets, 1 (open) or the floor (closed),
+ *    opening at the threshold, closing kGateHysteresisDb under it after the hold;
+ * 3. every run of equal targets is one attack or release segment: the one-pole envelope
+ *    towards a constant target has a closed form, which the `glide` kernel evaluates a
+ *    vector of frames at a time instead of one frame after the other;
+ * 4. the `frameGain` kernel applies the gains.
+ *
+ * There is no lookahead: the output is aligned with the input. Nothing is allocated.
+ */
+class Processor {
+    Settings mSettings;
+    size_t mChannels;
+
+    float mGain = 1.0f;   ///< gain of the last frame.
+    bool mOpen = false;   ///< the level crossed the threshold and the hold hasn't run out.
+    size_t mHoldLeft = 0; ///< frames of hold left while the level is under the close level.
+
+public:
+    /**
+     * @param settings derived constants (see Settings::from()).
+     * @param channels interleaved channels, 1 to kNumChannels.
+     */
+    Processor(const Settings &settings, size_t channels);
+
+    /// @brief Gate `frames` interleaved frames in-place.
+    void process(float *data, size_t frames);
+
+    /**
+     * @brief Gate a planar signal in-place (interleaved in chunks on the way so the channels stay linked).
+     *
+     * @param channels one pointer per channel of the processor, `frames` samples each.
+     */
+    void processPlanar(float *const *channels, size_t frames);
+
+    /// @brief Start closed, at the floor.
+    void reset();
+};
+
+/**
+ * @brief Parameter container for the Gate effect.
+ *
+ * @see AJ::dsp::EffectParams
+ */
+class GateParams : public EffectParams {
+    struct PrivateTag {};
+
+    Settings mSettings; ///< derived constants.
+
+public:
+    /**
+     * @brief Factory method to create a GateParams instance.
+     *
+     * Validation rules: every field in the range documented in Params, `mSamplerate` in
+     * [kMinSamplerate, kMaxSamplerate].
+     *
+     * @return Shared pointer to a valid GateParams instance if parameters are valid,
+     *         otherwise nullptr.
+     */
+    static std::shared_ptr<GateParams> create(Params &params, AJ::error::IErrorHandler &handler);
+
+    /// @brief Per-frame constants of the processors.
+    const Settings& Setup() const noexcept { return mSettings; }
+
+    ~GateParams() override = default;
+
+    GateParams(PrivateTag) {}
+};
+
+/**
+ * @brief Block processing state of the Gate effect, the processor of the stream.
+ */
+class GateState : public EffectState {
+public:
+    std::unique_ptr<Processor> mProcessor;    ///< envelope and hold.
+    std::shared_ptr<const GateParams> mOwner; ///< parameters the processor was set up from.
+
+    explicit GateState(uint8_t channels) : EffectState(channels) {}
+
+    void reset() override {
+        EffectState::reset();
+        mProcessor->reset();
+    }
+};
+
+/**
+ * @brief Noise gate over [Start, End] (see Processor): the audio is attenuated by `Range` while
+ * it stays under the threshold.
+ */
+class Gate : public AJ::dsp::Effect {
+    std::shared_ptr<GateParams> mParams;
+
+public:
+    Gate() {
+        mParams = nullptr;
+    }
+
+    /**
+     * @brief Gate [Start, End] of a single-channel buffer in-place.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Gate [Start, End] of the first `channels` channels with linked gains: the loudest
+     * channel of every frame opens the gate of both.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief The channels share the envelope.
+     */
+    bool linksChannels() const override {
+        return true;
+    }
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief Create a GateState for mono or stereo streams (channels are linked).
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Gate one block of interleaved frames, in-place.
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Set effect parameters from a shared EffectParams object (must be GateParams).
+     */
+    bool setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler) override;
+};
+
+}
@@ -1,8 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <vector>
+
 #include "effect.h"
+#include "automation.h"
 #include "core/types.h"
 #include "core/effect_params.h"
 #include "core/error_handler.h"
+#include "core/param_store.h"
 
 namespace AJ::dsp::echo {
 
@@ -83,44 +88,72 @@ public:
     EchoParams(PrivateTag) {}
 };
 
+/**
+ * @brief Decay that can be changed while a stream is running, see Echo::setLiveParams().
+ */
+struct LiveParams {
+    float mDecay = 0.0f; /**< Decay factor of the echo. */
+};
+
+/// @brief Lock-free store the control thread publishes LiveParams to.
+using LiveStore = utils::ParamStore<LiveParams>;
+
+/**
+ * @brief Block processing state of the Echo effect.
+ *
+ * Holds the last `DelaySamples()` input frames of each channel in a ring,
+ * so the echo can reach back across block boundaries, and the smoothed decay.
+ */
+class EchoState : public EffectState {
+public:
+    std::vector<Float> mHistory;  ///< one history ring per channel (size = delay in frames).
+    size_t mWriteIndex = 0;       ///< next write position in the rings.
+    utils::LinearSmoother mDecay; ///< decay applied to the next frame.
+    float mInitialDecay;          ///< decay at the beginning of the stream.
+
+    EchoState(uint8_t channels, size_t delay, float decay = 0.0f) : EffectState(channels), mInitialDecay(decay) {
+        mHistory.assign(channels, Float(delay, 0.0f));
+        mDecay.reset(decay);
+    }
+
+    void reset() override {
+        EffectState::reset();
+        mWriteIndex = 0;
+        mDecay.reset(mInitialDecay);
+        for(auto &ring : mHistory){
+            std::fill(ring.begin(), ring.end(), 0.0f);
+        }
+    }
+};
+
 /** 
  * @brief Echo effect processor with architecture-specific implementations.
  *
- * Supports naive and SIMD-based echo effect processing (SSE, AVX).
+ * The echo loop runs on the SIMD kernel picked at runtime (see dsp/kernels.h).
  * Uses `EchoParams` for configuration. 
 */
 class Echo : public AJ::dsp::Effect {
 private:
 
     /**
-     * @brief Naive implementation of the echo effect (no SIMD).
-     * @param buffer The audio buffer to process in-place.
-     * @param handler Error handler for reporting processing errors.
-     * @return true if processing was successful.
-    */
-    bool echoNaive(Float &buffer, AJ::error::IErrorHandler &handler);
-    /**
-     * @brief SSE SIMD implementation of the echo effect.
-     */
-    bool echoSIMD_SSE(Float &buffer, AJ::error::IErrorHandler &handler);
-    /**
-     * @brief AVX SIMD implementation of the echo effect.
+     * @brief Parameters for the echo effect.
      */
-    bool echoSIMD_AVX(Float &buffer, AJ::error::IErrorHandler &handler);
+    std::shared_ptr<EchoParams> mParams;
 
     /**
-     * @brief Calculates a new sample value by adding delayed signal with decay.
-     * @param in The input buffer.
-     * @param sample_idx The current sample index.
-     * @param echo_idx The delayed sample index.
-     * @param handler Error handler.
-     * @return The new sample value. 
+     * @brief Live decay of block processing, nullptr to use the decay of the parameters.
      */
-    sample_t calculate_new_sample_with_echo(Float &in, sample_pos sample_idx, sample_pos echo_idx, AJ::error::IErrorHandler &handler);
+    std::shared_ptr<LiveStore> mLive;
+
     /**
-     * @brief Parameters for the echo effect.
+     * @brief Decay curve over the range, nullptr (or empty) to use a constant decay.
      */
-    std::shared_ptr<EchoParams> mParams;
+    std::shared_ptr<const Automation> mAutomation;
+
+    /// @brief Whether a non-empty decay automation is set.
+    bool automated() const noexcept {
+        return mAutomation && !mAutomation->empty();
+    }
 
 public:
 
@@ -136,6 +169,74 @@ public:
      */
     bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
 
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief Not with live parameters: blocks ramp to the live decay, process() keeps the decay of the parameters.
+     */
+    bool blockMatchesProcess() const override {
+        return !mLive;
+    }
+
+    /**
+     * @brief Take the block processing decay from a live store instead of the parameters.
+     *
+     * Every block picks up the latest published decay, the change is ramped over
+     * kParamSmoothFrames frames. Set it before creating the stream state. The store is read
+     * by one stream only (see utils::ParamStore), the delay and range still come from the parameters.
+     *
+     * @param live the store, nullptr to go back to the decay of the parameters.
+     */
+    void setLiveParams(std::shared_ptr<LiveStore> live) {
+        mLive = std::move(live);
+    }
+
+    /**
+     * @brief Follow a decay curve instead of a constant decay.
+     *
+     * The decay of an output frame is the value of the curve at that frame, the lane frames are
+     * buffer samples for process() and stream frames for processBlock(). It replaces both the
+     * decay of the parameters and the live decay, and is shared, not copied: don't edit it while
+     * the effect runs.
+     *
+     * @param automation the curve, nullptr to go back to a constant decay.
+     */
+    void setDecayAutomation(std::shared_ptr<const Automation> automation) {
+        mAutomation = std::move(automation);
+    }
+
+    /**
+     * @brief Create an EchoState with a history ring of `DelaySamples()` frames per channel.
+     *
+     * @param channels number of interleaved channels of the stream.
+     * @param handler  Error handler (parameters not set).
+     * @return the new state, or nullptr on failure.
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Apply the echo effect to one block of interleaved frames, in-place.
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     * The echo reads the input of `DelaySamples()` frames ago from the EchoState history ring.
+     * A new (live) decay ramps per frame.
+     *
+     * @param data     interleaved samples, `frames * channels` floats.
+     * @param frames   number of frames in the block.
+     * @param channels number of interleaved channels (must match the state).
+     * @param state    stream state created by createState().
+     * @param handler  Error handler for reporting processing issues.
+     *
+     * @return true on success, false on failure.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+
     /**
      * @brief Set effect parameters from a shared EffectParams object.
      *        Will downcast to EchoParams.
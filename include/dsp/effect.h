@@ -1,24 +1,207 @@
 #pragma once
 
 #include<cstdint>
+#include <algorithm>
+#include <memory>
+#include <string>
 #include "core/types.h"
 #include "core/effect_params.h"
 #include "core/error_handler.h"
+#include "core/buffer_pool.h"
+#include "core/thread_pool.h"
 
 namespace AJ::dsp {
+
+/// @brief Per-stream state of an effect used by Effect::processBlock().
+///
+/// Block processing sees the audio as a stream of interleaved frames split in
+/// consecutive blocks. Everything an effect must remember between two blocks
+/// (stream position, delay lines, filter memories) lives in an EffectState, so
+/// one Effect instance can process several independent streams.
+///
+/// Effects with memory derive from this class, create it with Effect::createState().
+class EffectState {
+protected:
+    /// @brief Number of frames already processed in this stream.
+    sample_pos mPosition = 0;
+
+    /// @brief Channels of the stream the state was created for.
+    uint8_t mChannels = 1;
+
+public:
+    explicit EffectState(uint8_t channels) : mChannels(channels) {}
+
+    virtual ~EffectState() = default;
+
+    /// @brief Position (in frames) of the first frame of the next block.
+    sample_pos position() const noexcept {
+        return mPosition;
+    }
+
+    /// @brief Channels of the stream the state was created for.
+    uint8_t channels() const noexcept {
+        return mChannels;
+    }
+
+    /// @brief Move the stream position forward after a block was processed.
+    void advance(size_t frames) noexcept {
+        mPosition += static_cast<sample_pos>(frames);
+    }
+
+    /// @brief Reset the state to the beginning of a new stream (clears any memory).
+    virtual void reset() {
+        mPosition = 0;
+    }
+
+    /// @brief Restart the stream at frame `position` (clears any memory), e.g. when a session jumps.
+    virtual void seek(sample_pos position) {
+        reset();
+        mPosition = position;
+    }
+};
+
+/// @brief How carefully an effect renders, see Effect::setQuality().
+enum class RenderQuality : uint8_t {
+    Full,   ///< the effect as its parameters describe it.
+    Preview ///< cheaper approximations, while settings are auditioned (see editing::preview::PreviewRenderer).
+};
+
 /// @brief Base interface for all DSP audio effects.
 ///
 /// Any audio effect that modifies audio buffers must inherit from this class.
 /// This class provides a common interface for applying effects and passing configuration parameters.
+///
+/// Effects can be used in two ways:
+/// - process(): the whole channel is in one `Float` buffer, the effect is applied to [Start, End].
+/// - process() on an AudioBuffer: all the planar channels of a file in one call, linked effects
+///   (linksChannels()) see them together.
+/// - processBlock(): the audio arrives in consecutive interleaved blocks (e.g. `utils::Buffer`s from
+///   a BufferPool), the effect keeps its memory in an EffectState between calls. [Start, End] is then
+///   a range of stream frames, frames outside of it pass through unchanged.
+/// - processView(): interleaved or strided samples the caller owns (an AudioView), processed where
+///   they are when the effect can.
 class Effect {
+protected:
+    /// @brief Intersect a block with the effect range.
+    ///
+    /// @param position stream position (frames) of the first frame of the block.
+    /// @param frames   number of frames in the block.
+    /// @param start    first frame of the effect range (inclusive).
+    /// @param end      last frame of the effect range (inclusive).
+    /// @param first    [out] first frame inside the block to process (block relative).
+    /// @param last     [out] one past the last frame inside the block to process (block relative).
+    /// @return false if the block does not overlap the range.
+    static bool blockRange(sample_pos position, size_t frames, sample_pos start, sample_pos end,
+        size_t &first, size_t &last) noexcept {
+        const sample_pos blockEnd = position + static_cast<sample_pos>(frames) - 1;
+
+        if(frames == 0 || blockEnd < start || position > end){
+            return false;
+        }
+
+        first = static_cast<size_t>(std::max(start, position) - position);
+        last = static_cast<size_t>(std::min(end, blockEnd) - position) + 1;
+        return true;
+    }
+
+    /// @brief Validate the arguments of processBlock().
+    static bool checkBlock(const float *data, uint8_t channels, const EffectState &state,
+        AJ::error::IErrorHandler &handler) {
+        if(!data){
+            error::report(handler, error::Error::NullBufferPtr, "invalid block, data cannot be NULL.\n");
+            return false;
+        }
+
+        if(channels == 0 || channels != state.channels()){
+            error::report(handler, error::Error::InvalidChannelCount,
+                "block of {} channels doesn't match the {} channels of the effect state.\n", channels, state.channels());
+            return false;
+        }
+
+        return true;
+    }
+
 public:
     /// @brief Apply the effect to the given audio buffer.
-    /// 
+    ///
     /// @param buffer The audio buffer to be processed in-place.
     /// @param handler Error handler callback used to report any processing failures.
     /// @return true if processing was successful, false if an error occurred.
     virtual bool process(Float &buffer, AJ::error::IErrorHandler &handler) = 0;
 
+    /// @brief Apply the effect to the first `channels` planar channels of `audio`, in-place.
+    ///
+    /// The default runs process() on every channel in turn. Effects that link their channels
+    /// (see linksChannels()) override it: the levels, envelopes or alignment are shared, so the
+    /// result differs from processing each channel alone. Effects that only share their setup
+    /// may override it too, to validate and prepare once for all the channels.
+    ///
+    /// @param audio    planar channels, the first `channels` must have the same length.
+    /// @param channels number of channels to process, 1 to kNumChannels.
+    /// @param handler  Error handler callback used to report any processing failures.
+    /// @return true if processing was successful, false if an error occurred.
+    virtual bool process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler) {
+        if(channels == 0 || channels > audio.size()){
+            const std::string message = "invalid channel count, it must be in [1, "
+                + std::to_string(audio.size()) + "].\n";
+            handler.onError(error::Error::InvalidChannelCount, message);
+            return false;
+        }
+
+        for(size_t ch = 0; ch < channels; ++ch){
+            if(!process(audio[ch], handler)){
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /// @brief Whether [Start, End] can be cut into pieces processed independently (see processRange()).
+    ///
+    /// True for effects without memory: every frame only depends on its samples and its position in
+    /// the range, so pieces can run in any order, on any thread. The engine then splits long ranges
+    /// across its thread pool.
+    virtual bool splitsRange() const {
+        return false;
+    }
+
+    /// @brief Apply the effect to the piece [first, last) of the range, frames relative to Start, in-place.
+    ///
+    /// Only for effects that split their range. The caller checked that [Start, End] fits `buffer`,
+    /// pieces that don't overlap may be processed concurrently, and the pieces of a partition of
+    /// [0, End - Start + 1) give the result of process().
+    ///
+    /// @param buffer  the single-channel buffer passed to process().
+    /// @param first   first frame of the piece, relative to Start.
+    /// @param last    one past the last frame of the piece, relative to Start.
+    /// @param handler Error handler callback used to report any processing failures.
+    /// @return true if processing was successful, false if an error occurred
+    ///         (or the effect doesn't split its range).
+    virtual bool processRange(Float &buffer, size_t first, size_t last, AJ::error::IErrorHandler &handler) {
+        const std::string message = "range splitting is not supported by this effect.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    /// @brief Thread pool for the passes an effect parallelizes itself (analysis, segments, partitions).
+    ///
+    /// @param pool thread pool (e.g. EngineResources::threadPool()), nullptr to run on the caller thread.
+    virtual void setThreadPool(std::shared_ptr<utils::ThreadPool> pool) {}
+
+    /// @brief Trade accuracy for speed, e.g. to audition settings before the final render.
+    ///
+    /// Effects with a cheaper path (Distortion: the fast tanh) take it at RenderQuality::Preview,
+    /// the others ignore the call. Full (the default) is what the parameters ask for.
+    virtual void setQuality(RenderQuality quality) {}
+
+    /// @brief Whether the channels of a file must go through process(AudioBuffer&, ...) together.
+    ///
+    /// A linked effect (shared peak, gain or alignment) can't split a file into one task per channel.
+    virtual bool linksChannels() const {
+        return false;
+    }
+
     /// @brief Set the parameters for the effect.
     ///
     /// Each effect has its own derived EffectParams subclass that must be passed.
@@ -27,7 +210,111 @@ public:
     /// @return true if parameters were successfully set, false otherwise.
     virtual bool setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler) = 0;
 
+    /// @brief Whether this effect implements processBlock().
+    virtual bool supportsBlockProcessing() const {
+        return false;
+    }
+
+    /// @brief Create the per-stream state used by processBlock().
+    ///
+    /// Must be called after setParams(), effects with delay lines size them from the parameters.
+    /// @param channels number of interleaved channels of the stream.
+    /// @param handler Error handler callback for reporting allocation failures.
+    /// @return the new state, or nullptr on failure.
+    virtual std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) {
+        return std::make_unique<EffectState>(channels);
+    }
+
+    /// @brief Apply the effect to one block of interleaved frames, in-place.
+    ///
+    /// Consecutive calls with the same state continue the same stream (delay lines
+    /// and filter memories carry over), the state position advances by `frames`.
+    /// Does not allocate, so it can be used on real-time threads.
+    ///
+    /// @param data     interleaved samples, `frames * channels` floats.
+    /// @param frames   number of frames in the block.
+    /// @param channels number of interleaved channels (must match the state).
+    /// @param state    stream state created by createState().
+    /// @param handler  Error handler callback used to report any processing failures.
+    /// @return true if processing was successful, false if an error occurred
+    ///         (or the effect doesn't support block processing).
+    virtual bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) {
+        const std::string message = "block processing is not supported by this effect.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    /// @brief Whether processBlock() over a whole buffer, as one new stream, gives the result of process().
+    ///
+    /// True for the effects without latency whose streamed output follows the parameters alone.
+    /// Latency compensated effects (pitch shift, lookahead dynamics) and live parameters make
+    /// the stream differ, processView() then goes through process().
+    virtual bool blockMatchesProcess() const {
+        return supportsBlockProcessing();
+    }
+
+    /// @brief Apply the effect to samples the caller owns, in-place.
+    ///
+    /// [Start, End] is a range of frames of the view, like process() on a buffer of `view.frames`
+    /// (AJ_Engine::applyEffect(AudioView, ...) checks it). A packed view of an effect whose blocks
+    /// match process() (blockMatchesProcess()) is one processBlock() call on the caller's memory,
+    /// with a new state. The others are copied to planar channels for process(AudioBuffer&, ...)
+    /// and copied back.
+    ///
+    /// @param view    the samples, 1 to kNumChannels channels.
+    /// @param handler Error handler callback used to report any processing failures.
+    /// @return true if processing was successful, false if an error occurred.
+    virtual bool processView(const AudioView &view, AJ::error::IErrorHandler &handler) {
+        if(!view.data){
+            error::report(handler, error::Error::NullBufferPtr, "invalid view, data cannot be NULL.\n");
+            return false;
+        }
+
+        if(view.channels == 0 || view.channels > kNumChannels || view.stride < view.channels){
+            error::report(handler, error::Error::InvalidChannelCount,
+                "view of {} channels in a stride of {} floats, it needs 1 to {} channels within the stride.\n",
+                view.channels, view.stride, kNumChannels);
+            return false;
+        }
+
+        if(view.packed() && blockMatchesProcess()){
+            std::unique_ptr<EffectState> state = createState(view.channels, handler);
+            return state && processBlock(view.data, view.frames, view.channels, *state, handler);
+        }
+
+        AudioBuffer planar;
+        for(uint8_t ch = 0; ch < view.channels; ++ch){
+            planar[ch].resize(view.frames);
+            for(size_t i = 0; i < view.frames; ++i){
+                planar[ch][i] = view.at(ch, i);
+            }
+        }
+
+        if(!process(planar, view.channels, handler)){
+            return false;
+        }
+
+        for(uint8_t ch = 0; ch < view.channels; ++ch){
+            for(size_t i = 0; i < view.frames; ++i){
+                view.at(ch, i) = planar[ch][i];
+            }
+        }
+
+        return true;
+    }
+
+    /// @brief Apply the effect to the valid frames of a pooled buffer, in-place.
+    ///
+    /// @param buffer buffer obtained from a BufferPool / Queue (`buffer.frames` valid frames).
+    /// @param state  stream state created by createState().
+    /// @param handler Error handler callback used to report any processing failures.
+    /// @return true if processing was successful, false otherwise.
+    bool processBuffer(utils::Buffer &buffer, EffectState &state, AJ::error::IErrorHandler &handler) {
+        return processBlock(buffer.data, buffer.frames, buffer.channels, state, handler);
+    }
+
     virtual ~Effect() = default;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "effect.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/error_handler.h"
+
+namespace AJ::dsp {
+
+/**
+ * @brief Block processing state of an EffectChain, one EffectState per stage.
+ */
+class ChainState : public EffectState {
+public:
+    std::vector<std::unique_ptr<EffectState>> mStates; ///< state of every stage, in chain order.
+
+    explicit ChainState(uint8_t channels) : EffectState(channels) {}
+
+    void reset() override {
+        EffectState::reset();
+        for(auto &state : mStates){
+            state->reset();
+        }
+    }
+
+    void seek(sample_pos position) override {
+        EffectState::seek(position);
+        for(auto &state : mStates){
+            state->seek(position);
+        }
+    }
+};
+
+/**
+ * @brief Ordered list of effects applied in one pass per block.
+ *
+ * Instead of walking the whole buffer once per effect, the chain splits the
+ * buffer in blocks of `blockFrames()` frames and runs every stage on a block
+ * while it is still in L1/L2 cache, so N effects cost one trip through memory
+ * instead of N.
+ *
+ * ### Design:
+ * - Consecutive stages that support block processing are fused.
+ * - A stage that needs the whole buffer (e.g. Reverb, Normalization, Reverse)
+ *   runs with `process()` between two fused segments.
+ * - Each effect keeps its own parameters and range, set them with the effect's
+ *   `setParams()` before adding it. setParams() on the chain itself is not allowed.
+ * - The chain is an Effect itself: it can be nested, or streamed with
+ *   `processBlock()` if all its stages support it.
+ *
+ * ### Example:
+ * @code
+ * auto gain = std::make_shared<AJ::dsp::gain::Gain>();
+ * gain->setParams(gainParams, handler);
+ *
+ * auto fade = std::make_shared<AJ::dsp::fade::Fade>();
+ * fade->setParams(fadeParams, handler);
+ *
+ * AJ::dsp::EffectChain chain;
+ * chain.add(gain);
+ * chain.add(fade);
+ *
+ * chain.process(buffer, handler); // gain then fade, one pass
+ * @endcode
+ *
+ * @note In fused segments the range of each stage is clamped to the buffer
+ *       instead of being rejected.
+ */
+class EffectChain : public Effect {
+    std::vector<std::shared_ptr<Effect>> mEffects; ///< stages in processing order.
+    size_t mBlockFrames;                            ///< frames per block of the fused segments.
+    RenderQuality mQuality = RenderQuality::Full;   ///< quality given to every stage.
+
+    /**
+     * @brief Run stages [first, last) fused, block by block, over the whole buffer.
+     */
+    bool processFused(Float &buffer, size_t first, size_t last, AJ::error::IErrorHandler &handler);
+
+public:
+    /**
+     * @param block_frames frames per block (default kChainBlockFrames).
+     */
+    explicit EffectChain(size_t block_frames = kChainBlockFrames) :
+        mBlockFrames(block_frames == 0 ? kChainBlockFrames : block_frames) {}
+
+    /**
+     * @brief Append an effect (with its parameters already set) to the end of the chain.
+     *
+     * @param effect  the effect to append.
+     * @param handler Error handler (null effect).
+     * @return true if the effect was added.
+     */
+    bool add(std::shared_ptr<Effect> effect, AJ::error::IErrorHandler &handler);
+
+    /// @brief Remove all stages.
+    void clear() {
+        mEffects.clear();
+    }
+
+    /// @brief Number of stages.
+    size_t size() const noexcept {
+        return mEffects.size();
+    }
+
+    /// @brief Stage at `index`.
+    std::shared_ptr<Effect> at(size_t index) const {
+        return mEffects.at(index);
+    }
+
+    /// @brief Frames per block of the fused segments.
+    size_t blockFrames() const noexcept {
+        return mBlockFrames;
+    }
+
+    /**
+     * @brief Set the quality of every stage, and of the stages added to a previewing chain.
+     *
+     * The stages are shared: a preview chain changes the effects it was built from.
+     */
+    void setQuality(RenderQuality quality) override;
+
+    /// @brief Quality given to the stages.
+    RenderQuality quality() const noexcept {
+        return mQuality;
+    }
+
+    /**
+     * @brief Apply all stages, in order, to a single-channel buffer in-place.
+     *
+     * @param buffer  Audio buffer to process.
+     * @param handler Error handler for reporting issues.
+     * @return true if every stage succeeded.
+     */
+    bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Not supported, each stage has its own parameters.
+     * @return always false.
+     */
+    bool setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief true if every stage supports block processing.
+     */
+    bool supportsBlockProcessing() const override;
+
+    /**
+     * @brief true if every stage streams like it processes a whole buffer.
+     */
+    bool blockMatchesProcess() const override;
+
+    /**
+     * @brief Create a ChainState holding the state of every stage.
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Run every stage on one block of interleaved frames, in-place.
+     *
+     * @param data     interleaved samples, `frames * channels` floats.
+     * @param frames   number of frames in the block.
+     * @param channels number of interleaved channels (must match the state).
+     * @param state    ChainState created by createState().
+     * @param handler  Error handler for reporting processing issues.
+     * @return true if every stage succeeded.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+};
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "dsp/effect.h"
+#include "core/types.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+
+namespace AJ::dsp {
+
+/// @brief Number of values of the AJ::Effect enum.
+constexpr size_t kEffectCount = static_cast<size_t>(AJ::Effect::gate) + 1;
+
+/**
+ * @class EffectRegistry
+ * @brief Maps every AJ::Effect to a factory and keeps the constructed effects per thread.
+ *
+ * acquire() returns the calling thread's instance of an effect, constructed on first use
+ * and kept afterwards with its internal buffers (filters, delay lines). The parameters are
+ * checked and set on every call, even the same object again: its values may have changed.
+ *
+ * Instances are never shared between threads: the multi-channel / multi-file applyEffect
+ * overloads run their jobs on several threads, each uses its own cached instance.
+ * A thread's cache goes away when the thread exits.
+ */
+class EffectRegistry {
+public:
+    /// @brief Construct a new instance of an effect.
+    using Factory = std::unique_ptr<Effect> (*)();
+
+    /// @brief Extra check of the parameters of an effect (e.g. the fade direction), may be nullptr.
+    using Check = bool (*)(EffectParams &params, AJ::error::IErrorHandler &handler);
+
+    /// @brief Registry with the engine effects (every value of AJ::Effect).
+    EffectRegistry();
+
+    EffectRegistry(const EffectRegistry&) = delete;
+    EffectRegistry& operator=(const EffectRegistry&) = delete;
+
+    /**
+     * @brief Register (or replace) the factory of an effect.
+     *
+     * Threads construct the new effect the next time they acquire it.
+     *
+     * @return false if `effect` isn't a value of AJ::Effect or `factory` is nullptr.
+     */
+    bool registerEffect(AJ::Effect effect, Factory factory, Check check = nullptr);
+
+    /// @brief Whether `effect` has a factory.
+    bool has(AJ::Effect effect) const;
+
+    /**
+     * @brief Construct a new, unconfigured instance of an effect.
+     * @return nullptr if the effect has no factory.
+     */
+    std::unique_ptr<Effect> create(AJ::Effect effect) const;
+
+    /**
+     * @brief The calling thread's instance of `effect`, configured with `params`.
+     *
+     * @return nullptr (reported) if the effect has no factory, or the parameters were rejected.
+     */
+    Effect* acquire(AJ::Effect effect, std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler);
+
+private:
+    struct Entry {
+        Factory factory = nullptr;
+        Check check = nullptr;
+    };
+
+    /// @brief One cached instance of the calling thread.
+    struct CachedEffect {
+        uint64_t owner = 0;                     ///< mId of the registry that constructed it.
+        uint64_t generation = 0;                ///< mGeneration when it was constructed.
+        std::unique_ptr<Effect> effect;
+    };
+
+    mutable std::mutex mMux;                    ///< guards mEntries.
+    std::array<Entry, kEffectCount> mEntries{};
+    const uint64_t mId;                         ///< unique per registry, a thread cache entry of another registry is rebuilt.
+    std::atomic<uint64_t> mGeneration{0};       ///< bumped by registerEffect().
+
+    static std::array<CachedEffect, kEffectCount>& threadCache() noexcept;
+};
+
+}
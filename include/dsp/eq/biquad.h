@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+
+#include "core/constants.h"
+#include "dsp/kernels.h"
+
+namespace AJ::dsp::eq {
+
+/// @brief Response of one equalizer band.
+enum class BandType {
+    LowShelf,  ///< boosts / cuts below the frequency.
+    HighShelf, ///< boosts / cuts above the frequency.
+    Peaking,   ///< boosts / cuts around the frequency, Q sets the width.
+    LowPass,   ///< 12 dB / octave above the frequency, Q sets the resonance (0.707: Butterworth).
+    HighPass   ///< 12 dB / octave below the frequency, Q sets the resonance (0.707: Butterworth).
+};
+
+/**
+ * @brief One band of an equalizer.
+ */
+struct Band {
+    BandType mType;    /**< Response of the band. */
+    float mFrequency;  /**< Centre / corner frequency in Hz, below half the samplerate. */
+    float mGainDb;     /**< Boost (> 0) or cut (< 0) in dB, ignored by LowPass / HighPass. */
+    float mQ;          /**< Quality factor (shelves: slope, 0.707 is the steepest without overshoot). */
+};
+
+/**
+ * @brief Coefficients of one biquad, normalized by a0:
+ * y[n] = b0·x[n] + b1·x[n-1] + b2·x[n-2] - a1·y[n-1] - a2·y[n-2]. The defaults pass the input through.
+ */
+struct Coefficients {
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+};
+
+/**
+ * @brief Biquad of a band at `samplerate` (Audio EQ Cookbook formulas, computed in double).
+ *
+ * The band must be valid (see EqParams::create()).
+ */
+Coefficients design(const Band &band, double samplerate);
+
+/**
+ * @brief Cascade of biquads run by the `biquad` SIMD kernel, on interleaved mono or stereo frames.
+ *
+ * Stage k of channel c sits in lane k·channels + c of the kernel rows (see kernels::BiquadFn), the
+ * rows past the last stage are identity stages. Every channel runs the same stages, in order.
+ * The coefficients are laid out once by setup(), process() only streams the frames through.
+ */
+class BiquadCascade {
+    alignas(kBufferAlignment) float mCoeffs[5 * kernels::kBiquadLanes]; ///< b0, b1, b2, a1, a2 rows.
+    alignas(kBufferAlignment) float mState[2 * kernels::kBiquadLanes];  ///< s1, s2 rows (transposed direct form II).
+    size_t mStages = 0;
+    size_t mChannels = 1;
+
+public:
+    /// @brief An empty cascade (passes the input through).
+    BiquadCascade();
+
+    /**
+     * @brief Lay out `count` stages for `channels` interleaved channels.
+     *
+     * The filter state is kept when the number of stages and channels doesn't change, so new
+     * coefficients (e.g. an edited band) take effect without a click. Otherwise it's cleared.
+     *
+     * @return false (nothing changed) if `channels` isn't 1 or 2 or count · channels > kBiquadLanes.
+     */
+    bool setup(const Coefficients *stages, size_t count, size_t channels);
+
+    /// @brief Filter `frames` interleaved frames in-place.
+    void process(float *data, size_t frames);
+
+    /// @brief Clear the filter state.
+    void reset();
+
+    /// @brief Stages per channel.
+    size_t stages() const noexcept { return mStages; }
+
+    /// @brief Interleaved channels.
+    size_t channels() const noexcept { return mChannels; }
+};
+
+}
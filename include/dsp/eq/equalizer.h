@@ -0,0 +1,139 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "dsp/effect.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+#include "dsp/eq/biquad.h"
+
+namespace AJ::dsp::eq {
+
+static_assert(kEqMaxBands * kNumChannels <= kernels::kBiquadLanes, "every band of every channel needs a biquad lane");
+
+/**
+ * @brief Container for all equalizer parameters.
+ */
+struct Params {
+    sample_pos mStart;          /**< Start position of the equalizer in samples (inclusive). */
+    sample_pos mEnd;            /**< End position of the equalizer in samples (inclusive). */
+    std::vector<Band> mBands;   /**< 1 to kEqMaxBands bands, applied in order. */
+    uint32_t mSamplerate;       /**< Samplerate of the audio the band frequencies refer to. */
+};
+
+/**
+ * @brief Parameter container for the Equalizer effect.
+ *
+ * The biquad of every band is designed once, here: an equalizer (or a stream state) only
+ * lays the coefficients out again when it's given a different parameters object.
+ *
+ * @see AJ::dsp::EffectParams
+ */
+class EqParams : public EffectParams {
+    struct PrivateTag {};
+
+    std::vector<Band> mBands;                ///< bands, in order.
+    std::vector<Coefficients> mCoefficients; ///< biquad of every band.
+    uint32_t mSamplerate = 0;                ///< samplerate the biquads were designed for.
+
+public:
+    /**
+     * @brief Factory method to create an EqParams instance.
+     *
+     * Validation rules:
+     * - 1 to kEqMaxBands bands.
+     * - `mFrequency` in [kEqMinFrequency, samplerate / 2).
+     * - `mQ` in [kEqMinQ, kEqMaxQ], `mGainDb` in [-kEqMaxGainDb, kEqMaxGainDb].
+     * - `mSamplerate` in [kMinSamplerate, kMaxSamplerate].
+     *
+     * @return Shared pointer to a valid EqParams instance if parameters are valid,
+     *         otherwise nullptr.
+     */
+    static std::shared_ptr<EqParams> create(Params &params, AJ::error::IErrorHandler &handler);
+
+    /// @brief Bands, in order.
+    const std::vector<Band>& Bands() const noexcept { return mBands; }
+
+    /// @brief Biquad of every band, in order.
+    const std::vector<Coefficients>& Stages() const noexcept { return mCoefficients; }
+
+    /// @brief Samplerate the biquads were designed for.
+    uint32_t Samplerate() const noexcept { return mSamplerate; }
+
+    ~EqParams() override = default;
+
+    EqParams(PrivateTag) {}
+};
+
+/**
+ * @brief Block processing state of the Equalizer effect, the biquad cascade of the stream.
+ */
+class EqState : public EffectState {
+public:
+    BiquadCascade mCascade;                  ///< stages of every channel.
+    std::shared_ptr<const EqParams> mLayout; ///< parameters the cascade holds the coefficients of.
+
+    explicit EqState(uint8_t channels) : EffectState(channels) {}
+
+    void reset() override {
+        EffectState::reset();
+        mCascade.reset();
+    }
+};
+
+/**
+ * @brief Parametric equalizer: a cascade of up to kEqMaxBands biquads over [Start, End].
+ *
+ * The bands run in the `biquad` SIMD kernel, vectorized across bands and channels: every
+ * lane holds one band of one channel, and the kernel pipelines the bands so each of them
+ * filters a different frame in the same instruction (see kernels::BiquadFn).
+ *
+ * - process() filters the range of a single-channel buffer, starting from silence.
+ * - processBlock() streams. New parameters with the same number of bands keep the filter
+ *   state, so bands can be edited while the stream runs.
+ */
+class Equalizer : public AJ::dsp::Effect {
+    std::shared_ptr<EqParams> mParams;
+    BiquadCascade mCascade; ///< cascade of process(), laid out by setParams().
+
+public:
+    Equalizer() {
+        mParams = nullptr;
+    }
+
+    /**
+     * @brief Equalize [Start, End] of a single-channel buffer in-place.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief Create an EqState for mono or stereo streams.
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Equalize one block of interleaved frames, in-place.
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Set effect parameters from a shared EffectParams object (must be EqParams).
+     */
+    bool setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler) override;
+};
+
+}
@@ -143,30 +143,6 @@ public:
 class Fade : public AJ::dsp::Effect {
     std::shared_ptr<FadeParams> mParams; ///< Parameters controlling fade behavior.
 
-    /**
-     * @brief Scalar (non-SIMD) fade processing.
-     * 
-     * Processes samples in a straightforward loop, updating the gain per sample.
-     * Intended as a fallback when SIMD acceleration is unavailable.
-     * 
-     * @param buffer   Audio buffer to process.
-     * @param handler  Error handler for reporting parameter or processing errors.
-     * 
-     * @return true if processing was successful, false otherwise.
-     */
-    bool fadeNaive(Float &buffer, AJ::error::IErrorHandler &handler);
-
-    /**
-     * @brief AVX-optimized fade processing.
-     * 
-     * Uses 256-bit AVX vector operations to process 8 samples at a time, 
-     * 
-     * @param buffer   Audio buffer to process.
-     * @param handler  Error handler for reporting parameter or processing errors.
-     * 
-     * @return true if processing was successful, false otherwise.
-     */
-    bool fadeAVX(Float &buffer, AJ::error::IErrorHandler &handler);
 
 public:
     /**
@@ -204,6 +180,43 @@ public:
      */
     bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
 
+    /**
+     * @brief The gain of a frame only depends on its distance to Start.
+     */
+    bool splitsRange() const override {
+        return true;
+    }
+
+    /**
+     * @brief Apply the ramp to the frames [first, last) of the range, starting at the gain of
+     * frame `first` (computed directly, not accumulated from Start).
+     */
+    bool processRange(Float &buffer, size_t first, size_t last, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief Apply the fade effect to one block of interleaved frames, in-place.
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     * The gain of every frame is derived from its stream position, the base EffectState is enough.
+     *
+     * @param data     interleaved samples, `frames * channels` floats.
+     * @param frames   number of frames in the block.
+     * @param channels number of interleaved channels (must match the state).
+     * @param state    stream state created by createState().
+     * @param handler  Error handler for reporting processing issues.
+     *
+     * @return true on success, false on failure.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+
     /**
      * @brief Assigns fade parameters to the effect.
      * 
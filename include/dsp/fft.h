@@ -0,0 +1,109 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/scratch_arena.h"
+
+namespace AJ::dsp::fft {
+
+/**
+ * @class Plan
+ * @brief FFT of real signals of a power of two size, spectra in split (real / imaginary arrays) form.
+ *
+ * A size N transform runs one N/2 point complex radix-2 FFT on the even / odd samples packed as
+ * real / imaginary parts, then splits its result into the N/2 + 1 bins of the real spectrum.
+ * The butterflies of every stage from 8 points on go through the `butterfly` kernel (SIMD,
+ * picked at runtime), the first two stages run as one scalar radix-4 pass.
+ *
+ * Plans are shared: get them from plan(), which computes the twiddles and the bit reversal
+ * table once per size for the whole process. forward() and inverse() are const and only touch
+ * the caller's arrays, so one plan serves every thread.
+ *
+ * ### Usage:
+ * @code
+ * auto fft = AJ::dsp::fft::plan(1024);
+ *
+ * AJ::utils::ScratchScope scope;
+ * AJ::dsp::fft::Spectrum spectrum = AJ::dsp::fft::spectrum(scope.arena(), *fft);
+ *
+ * fft->forward(signal, spectrum.re, spectrum.im);
+ * // ... multiply spectra ...
+ * fft->inverse(spectrum.re, spectrum.im, signal); // 1024 * the original signal
+ * @endcode
+ */
+class Plan {
+    struct PrivateTag {};
+
+    size_t mSize = 0;                 ///< N, number of real samples.
+    size_t mHalf = 0;                 ///< N / 2, size of the complex FFT.
+    std::vector<uint32_t> mReverse;   ///< bit reversal permutation of [0, N / 2).
+    Float mTwiddleRe;                 ///< cos(2πj / len) of every stage, stage of `len` at offset len / 2 - 1.
+    Float mTwiddleIm;                 ///< -sin(2πj / len) (forward), same layout.
+    Float mInverseIm;                 ///< sin(2πj / len) (inverse), same layout.
+    Float mSplitRe;                   ///< cos(2πk / N) for k in [0, N / 2], to split / merge the real spectrum.
+    Float mSplitIm;                   ///< sin(2πk / N), same layout.
+
+    /// @brief In-place complex FFT of `re` / `im` (N / 2 points), `Inverse` uses the conjugate twiddles (unscaled).
+    template <bool Inverse>
+    void complexFFT(float *re, float *im) const;
+
+public:
+    /// @brief Use plan(), the constructor computes the tables.
+    Plan(PrivateTag, size_t size);
+
+    /// @brief Number of real samples N.
+    size_t size() const noexcept { return mSize; }
+
+    /// @brief Number of bins of the spectrum, N / 2 + 1.
+    size_t bins() const noexcept { return mHalf + 1; }
+
+    /**
+     * @brief Spectrum of `in` (N samples), bins [0, N / 2] in `re` / `im`.
+     *
+     * `im[0]` and `im[N / 2]` are always 0. `in` must not alias `re` / `im`.
+     */
+    void forward(const float *in, float *re, float *im) const;
+
+    /**
+     * @brief N samples of the signal of spectrum `re` / `im`, unscaled: `inverse(forward(x)) = N * x`.
+     *
+     * `re` / `im` are used as work arrays and overwritten.
+     */
+    void inverse(float *re, float *im, float *out) const;
+
+    friend std::shared_ptr<const Plan> plan(size_t size);
+};
+
+/**
+ * @brief The shared plan of `size` real samples, built on the first request of that size.
+ *
+ * Thread-safe. Plans live until the end of the process.
+ *
+ * @return the plan, nullptr if `size` isn't a power of two in [kFFTMinSize, kFFTMaxSize].
+ */
+std::shared_ptr<const Plan> plan(size_t size);
+
+/**
+ * @brief Split spectrum of `bins` bins, `re` and `im` kBufferAlignment aligned.
+ */
+struct Spectrum {
+    float *re = nullptr;
+    float *im = nullptr;
+};
+
+/**
+ * @brief Work spectrum for `plan` from a scratch arena (e.g. ScratchScope().arena(), the
+ * arena of the calling thread), released with the arena scope.
+ *
+ * @return the spectrum, null pointers if the arena couldn't allocate.
+ */
+inline Spectrum spectrum(utils::ScratchArena &arena, const Plan &plan) noexcept {
+    Spectrum spectrum;
+    spectrum.re = arena.array<float>(plan.bins());
+    spectrum.im = arena.array<float>(plan.bins());
+    return spectrum.re && spectrum.im ? spectrum : Spectrum{};
+}
+
+}
@@ -4,8 +4,10 @@
 #include <memory>
 
 #include "effect.h"
+#include "automation.h"
 #include "core/types.h"
 #include "core/error_handler.h"
+#include "core/param_store.h"
 
 namespace AJ::dsp::gain {
 
@@ -73,6 +75,34 @@ public:
     }
 };
 
+/**
+ * @brief Gain that can be changed while a stream is running, see Gain::setLiveParams().
+ */
+struct LiveParams {
+    float mGain = 1.0f; /**< Gain multiplier (clamped to [0.0f, 5.0f]). */
+};
+
+/// @brief Lock-free store the control thread publishes LiveParams to.
+using LiveStore = utils::ParamStore<LiveParams>;
+
+/**
+ * @brief Block processing state of the Gain effect, the smoothed live gain.
+ */
+class GainState : public EffectState {
+public:
+    utils::LinearSmoother mGain; ///< gain applied to the next frame.
+    float mInitialGain;          ///< gain at the beginning of the stream.
+
+    GainState(uint8_t channels, float gain) : EffectState(channels), mInitialGain(gain) {
+        mGain.reset(gain);
+    }
+
+    void reset() override {
+        EffectState::reset();
+        mGain.reset(mInitialGain);
+    }
+};
+
 /**
  * @brief Gain effect class that scales audio samples by a gain factor.
  */
@@ -85,31 +115,19 @@ private:
     std::shared_ptr<GainParams> mParams;
 
     /**
-     * @brief Apply gain to a single sample (naive implementation).
-     * 
-     * @param sample Reference to the sample to be modified.
+     * @brief Live gain of block processing, nullptr to use the gain of the parameters.
      */
-    void calculate_gain_sample(sample_t &sample);
+    std::shared_ptr<LiveStore> mLive;
 
     /**
-     * @brief Naive gain implementation for the entire buffer.
-     * 
-     * @param buffer Audio buffer to process.
-     * @param handler Error handler for reporting issues.
-     * 
-     * @return true on success, false on failure.
+     * @brief Gain curve over the range, nullptr (or empty) to use a constant gain.
      */
-    bool gainNaive(Float &buffer, AJ::error::IErrorHandler &handler);
+    std::shared_ptr<const Automation> mAutomation;
 
-    /**
-     * @brief AVX-accelerated gain implementation (optional optimization).
-     * 
-     * @param buffer Audio buffer to process.
-     * @param handler Error handler for reporting issues.
-     * 
-     * @return true on success, false on failure.
-     */
-    bool gainAVX(Float &buffer, AJ::error::IErrorHandler &handler);
+    /// @brief Whether a non-empty gain automation is set.
+    bool automated() const noexcept {
+        return mAutomation && !mAutomation->empty();
+    }
 
 public:
     /**
@@ -181,6 +199,84 @@ public:
      * @return true on success, false on failure.
      */
     bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief The gain of a frame only depends on its position, constant or automated.
+     */
+    bool splitsRange() const override {
+        return true;
+    }
+
+    /**
+     * @brief Apply the gain (or the automation curve) to the frames [first, last) of the range.
+     */
+    bool processRange(Float &buffer, size_t first, size_t last, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief Not with live parameters: blocks take the live gain, process() the gain of the parameters.
+     */
+    bool blockMatchesProcess() const override {
+        return !mLive;
+    }
+
+    /**
+     * @brief Take the block processing gain from a live store instead of the parameters.
+     *
+     * Every block picks up the latest published gain, the change is ramped over
+     * kParamSmoothFrames frames. Set it before creating the stream state. The store is read
+     * by one stream only (see utils::ParamStore), and the range still comes from the parameters.
+     *
+     * @param live the store, nullptr to go back to the gain of the parameters.
+     */
+    void setLiveParams(std::shared_ptr<LiveStore> live) {
+        mLive = std::move(live);
+    }
+
+    /**
+     * @brief Follow a gain curve over [Start, End] instead of a constant gain.
+     *
+     * The lane frames are buffer samples for process() and stream frames for processBlock().
+     * It replaces both the gain of the parameters and the live gain, and is shared, not copied:
+     * don't edit it while the effect runs.
+     *
+     * @param automation the curve, nullptr to go back to a constant gain.
+     */
+    void setGainAutomation(std::shared_ptr<const Automation> automation) {
+        mAutomation = std::move(automation);
+    }
+
+    /**
+     * @brief Create a GainState, starting at the live gain (or the gain of the parameters).
+     *
+     * @param channels number of interleaved channels of the stream.
+     * @param handler  Error handler (parameters not set).
+     * @return the new state, or nullptr on failure.
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Apply the gain effect to one block of interleaved frames, in-place.
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     * With live parameters the gain ramps per frame while it changes, which needs the GainState.
+     *
+     * @param data     interleaved samples, `frames * channels` floats.
+     * @param frames   number of frames in the block.
+     * @param channels number of interleaved channels (must match the state).
+     * @param state    stream state created by createState().
+     * @param handler  Error handler for reporting processing issues.
+     *
+     * @return true on success, false on failure.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
 };
 
 };
@@ -0,0 +1,538 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace AJ::dsp::kernels {
+
+/**
+ * @brief Instruction sets the DSP kernels are built for.
+ *
+ * Each level (except Scalar) is compiled in its own static library with only
+ * that ISA enabled, so the rest of the engine can be built for the baseline
+ * architecture and still use the widest vectors the running CPU supports.
+ */
+enum class ISA : uint8_t {
+    Scalar, ///< portable C++, always available.
+    SSE41,  ///< x86 SSE4.1, 4 floats.
+    AVX2,   ///< x86 AVX2 + FMA, 8 floats.
+    AVX512, ///< x86 AVX-512F, 16 floats.
+    NEON    ///< ARM NEON (aarch64), 4 floats.
+};
+
+/**
+ * @brief Waveshaping curves of the shape kernel.
+ */
+enum class Curve : uint8_t {
+    Tanh,     ///< `makeup * tanh(drive * x)`, `driveNeg`/`makeupNeg` for x < 0 (asymmetric when they differ).
+    HardClip, ///< `clamp(drive * x, -1, 1)`.
+    Cubic     ///< `1.5 u - 0.5 u^3` with `u = clamp(drive * x, -1, 1)`.
+};
+
+/**
+ * @brief Rational (Padé) approximations of tanh used by the shape kernel.
+ *
+ * Both saturate to ±1 outside their clamp range and are odd and monotonic.
+ */
+enum class TanhApprox : uint8_t {
+    Accurate, ///< [7/6] Padé on [-4.97, 4.97], max error < 1e-4.
+    Fast      ///< [3/2] Padé on [-3, 3], max error < 2.4e-2 (cheapest, audible only at high drive).
+};
+
+/**
+ * @brief Parameters of the shape kernel.
+ */
+struct ShapeParams {
+    Curve curve = Curve::Tanh;
+    TanhApprox approx = TanhApprox::Accurate;
+    float drive = 1.0f;     ///< input gain (x >= 0 for Tanh).
+    float makeup = 1.0f;    ///< output gain (x >= 0 for Tanh).
+    float driveNeg = 1.0f;  ///< input gain for x < 0 (Tanh only).
+    float makeupNeg = 1.0f; ///< output gain for x < 0 (Tanh only).
+};
+
+/**
+ * @brief Result of the analysis kernel.
+ *
+ * Plain aggregate (no member initializers), so the ISA translation units don't emit constructors.
+ */
+struct Levels {
+    float min;         ///< min x (FLT_MAX for an empty range).
+    float max;         ///< max x (-FLT_MAX for an empty range).
+    double sumSquares; ///< sum of x^2, accumulated in double lanes.
+};
+
+/// @brief `data[i] = clamp(data[i] * gain, -1, 1)` for i in [0, count).
+using GainFn = void (*)(float *data, size_t count, float gain);
+
+/// @brief `data[i] *= gain` for i in [0, count) (no clamping).
+using ScaleFn = void (*)(float *data, size_t count, float gain);
+
+/// @brief `data[i] = clamp(data[i] * (startGain + step * i), -1, 1)` for i in [0, count).
+using FadeFn = void (*)(float *data, size_t count, double startGain, double step);
+
+/// @brief `out[i] = clamp(in[i] + decay * delayed[i], -1, 1)` for i in [0, count).
+using EchoFn = void (*)(const float *in, const float *delayed, float *out, size_t count, float decay);
+
+/// @brief `out[i] = in[i] + gain * delayed[i]` for i in [0, count) (no clamping, `out` may be `in` or `delayed`).
+using MulAddFn = void (*)(const float *in, const float *delayed, float *out, size_t count, float gain);
+
+/**
+ * @brief Complex multiply-accumulate of split (real / imaginary arrays) spectra.
+ *
+ * `acc[i] += a[i] * b[i]` for i in [0, count), with `a = aRe + j·aIm`, `b = bRe + j·bIm`
+ * and `acc = accRe + j·accIm`.
+ */
+using ComplexMulAddFn = void (*)(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count);
+
+/**
+ * @brief Radix-2 FFT butterflies of split arrays.
+ *
+ * For i in [0, count): `v = b[i] * w[i]`, `b[i] = a[i] - v`, `a[i] = a[i] + v` with
+ * `a = ar + j·ai`, `b = br + j·bi` and the twiddles `w = wr + j·wi`.
+ */
+using ButterflyFn = void (*)(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count);
+
+/**
+ * @brief Phase vocoder analysis of the split spectrum bins [first, first + count).
+ *
+ * For every bin k: `mag[k] = |X[k]|`, `phase = atan2(im[k], re[k])` and the true frequency of the
+ * bin, in bins, `freq[k] = k + wrap(phase - lastPhase[k] - k·hopPhase) / hopPhase` where wrap()
+ * maps into [-π, π] and `hopPhase = 2π·hop / N`. `lastPhase[k]` is replaced by `phase`.
+ * The pointers point at bin `first`. atan2 is a polynomial approximation (error < 2e-6 rad).
+ */
+using PhaseAnalyzeFn = void (*)(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase);
+
+/**
+ * @brief Phase vocoder resynthesis of `count` bins.
+ *
+ * For i in [0, count): `sumPhase[i] = wrap(sumPhase[i] + freq[i]·hopPhase)` (into [-π, π], so the
+ * accumulated phase keeps its precision) and `re[i] + j·im[i] = mag[i]·e^(j·sumPhase[i])`.
+ * sin / cos are polynomial approximations (error < 1e-7 on [-π, π]).
+ */
+using PhaseSynthesizeFn = void (*)(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase);
+
+/**
+ * @brief Cross-correlation of `ref` with `lags` consecutive windows of `x`.
+ *
+ * For l in [0, lags): `out[l] = Σ x[l + i]·ref[i]` over i in [0, length).
+ * Reads `x[0 .. lags + length - 1)`.
+ */
+using CrossCorrelateFn = void (*)(const float *x, const float *ref, float *out, size_t lags, size_t length);
+
+/**
+ * @brief Polyphase FIR: `count` outputs of a resampler advancing `step / phases` input samples per output.
+ *
+ * `bank` holds `phases` rows of `taps` coefficients. For k in [0, count):
+ * `out[k] = Σ x[i]·bank[phase·taps + i]` over i in [0, taps), then `phase += step`,
+ * `x += phase / phases` and `phase %= phases`. `phase` starts below `phases`.
+ */
+using PolyphaseFn = void (*)(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count);
+
+/**
+ * @brief Lanes of the biquad kernel rows: stages × channels of a cascade, at most 16.
+ */
+constexpr size_t kBiquadLanes = 16;
+
+/**
+ * @brief Cascade of biquads (transposed direct form II) over interleaved frames, in place.
+ *
+ * Lane j = stage·channels + ch runs stage j / channels of channel ch. `coeffs` holds 5 rows of
+ * kBiquadLanes floats (b0, b1, b2, a1, a2, normalized by a0), `state` 2 rows (s1, s2). For every
+ * sample x of a channel, stage after stage: `y = b0·x + s1`, `s1 = b1·x - a1·y + s2`,
+ * `s2 = b2·x - a2·y`, then x = y. `lanes` is a multiple of `channels`; the rows past `lanes`
+ * must hold identity stages (b0 = 1, zero state), the SIMD kernels round the lanes up to their width.
+ *
+ * The SIMD kernels pipeline the cascade: at step t stage k filters frame t - k, fed with the
+ * output of stage k - 1 from step t - 1, so every lane advances with one instruction per
+ * coefficient. The pipeline is filled and drained within the call, the output isn't delayed.
+ */
+using BiquadFn = void (*)(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs, float *state);
+
+/**
+ * @brief Level of every interleaved frame: peaks[f] = max over the channels of |data[f · channels + c]|.
+ *
+ * Vectorized for 1 and 2 channels, other counts run the scalar loop.
+ */
+using FramePeakFn = void (*)(const float *data, size_t frames, size_t channels, float *peaks);
+
+/**
+ * @brief One gain per interleaved frame, in place: data[f · channels + c] *= gains[f] (no clamping).
+ *
+ * Vectorized for 1 and 2 channels, other counts run the scalar loop.
+ */
+using FrameGainFn = void (*)(float *data, size_t frames, size_t channels, const float *gains);
+
+/**
+ * @brief Swap interleaved frames from both ends: frame i of `front` with frame `frames - 1 - i` of `back`,
+ * for i in [0, frames) (frames of `channels` samples, the two ranges don't overlap).
+ *
+ * reverseFrames() reverses a range with it in place. Vectorized for 1 and 2 channels: a vector
+ * from each end, its frames permuted in the register, stored at the other end.
+ */
+using ReverseFn = void (*)(float *front, float *back, size_t frames, size_t channels);
+
+/**
+ * @brief Stereo accumulate with a gain per side: out[2i] += left · in[2i], out[2i + 1] += right · in[2i + 1]
+ * for i in [0, frames) (interleaved stereo frames, in and out may not overlap).
+ *
+ * Sums the tracks of a session into the master with their pan / gain.
+ */
+using MixAddFn = void (*)(const float *in, float *out, size_t frames, float left, float right);
+
+/**
+ * @brief Index of the first sample louder than `threshold`: min i with |data[i]| > threshold, `count` if none.
+ *
+ * The silence scanner skips quiet audio with it. The SIMD kernels test four vectors per step and
+ * only look for the lane once one of them is over.
+ */
+using FindAboveFn = size_t (*)(const float *data, size_t count, float threshold);
+
+/// @brief One past the last sample louder than `threshold`: max i + 1 with |data[i]| > threshold, 0 if none (scans from the end).
+using FindLastAboveFn = size_t (*)(const float *data, size_t count, float threshold);
+
+/**
+ * @brief One-pole glide toward a constant: gains[i] = target + (start - target) · coef^(i + 1) for i in [0, count).
+ *
+ * The attack / release of a gate in closed form: every lane starts from its own power of `coef`
+ * and a vector advances them all, so only one multiply per vector depends on the previous one.
+ */
+using GlideFn = void (*)(float *gains, size_t count, float start, float target, float coef);
+
+/**
+ * @brief Comb filter over a contiguous run of its delay line.
+ *
+ * For i in [0, count): `line[i] = in[i] + gain * line[i]` (y[n] = x[n] + g·y[n-M], the tap
+ * is replaced by the new output in place), then `acc[i] += line[i]`.
+ * Valid as long as count <= delay, which always holds since a run never wraps the ring.
+ */
+using CombFn = void (*)(float *line, float gain, const float *in, float *acc, size_t count);
+
+/// @brief `data[i] = shape(data[i])` for i in [0, count), see Curve.
+using ShapeFn = void (*)(float *data, size_t count, const ShapeParams &params);
+
+/// @brief Min, max and sum of squares of `data[0 .. count)` in one pass.
+using AnalyzeFn = Levels (*)(const float *data, size_t count);
+
+/// @brief `out[2i] = left[i]`, `out[2i + 1] = right[i]` for i in [0, frames).
+using InterleaveFn = void (*)(const float *left, const float *right, float *out, size_t frames);
+
+/// @brief `left[i] = in[2i]`, `right[i] = in[2i + 1]` for i in [0, frames).
+using DeinterleaveFn = void (*)(const float *in, float *left, float *right, size_t frames);
+
+/**
+ * @brief `out[i] = round(clamp(in[i] * 32767 + dither[i], -32768, 32767))` for i in [0, count).
+ *
+ * `dither` is in LSB units (see ditherTPDF()), nullptr for none. Rounds to nearest even.
+ */
+using ToInt16Fn = void (*)(const float *in, int16_t *out, size_t count, const float *dither);
+
+/// @brief `out[i] = in[i] / 32768` for i in [0, count).
+using FromInt16Fn = void (*)(const int16_t *in, float *out, size_t count);
+
+/**
+ * @brief `out[i] = round(clamp(in[i] * scale + dither[i], -scale - 1, scale))` for i in [0, count).
+ *
+ * `scale` is 2^(bits-1) - 1: 8388607 for 24-bit samples (in the low bits of an int32),
+ * 2147483647 for 32-bit (clamped to the largest float below 2^31). `dither` as for ToInt16Fn.
+ */
+using ToInt32Fn = void (*)(const float *in, int32_t *out, size_t count, float scale, const float *dither);
+
+/// @brief `out[i] = in[i] * gain` for i in [0, count), e.g. `gain = 1 / 2^(bits-1)`.
+using FromInt32Fn = void (*)(const int32_t *in, float *out, size_t count, float gain);
+
+/// @brief `out[i]` = bits of `in[i]` as an IEEE 754 half (round to nearest even, overflow to inf).
+using ToHalfFn = void (*)(const float *in, uint16_t *out, size_t count);
+
+/// @brief `out[i]` = the IEEE 754 half of bits `in[i]` as a float (exact).
+using FromHalfFn = void (*)(const uint16_t *in, float *out, size_t count);
+
+/**
+ * @brief Function pointers of the kernels used by the effects, all for the same ISA.
+ */
+struct KernelTable {
+    ISA isa;
+    GainFn gain;
+    ScaleFn scale;
+    FadeFn fade;
+    EchoFn echo;
+    CombFn comb;
+    ShapeFn shape;
+    AnalyzeFn analyze;
+    InterleaveFn interleave;
+    DeinterleaveFn deinterleave;
+    ToInt16Fn toInt16;
+    FromInt16Fn fromInt16;
+    ToInt32Fn toInt32;
+    FromInt32Fn fromInt32;
+    ToHalfFn toHalf;
+    FromHalfFn fromHalf;
+    MulAddFn mulAdd;
+    ComplexMulAddFn complexMulAdd;
+    ButterflyFn butterfly;
+    PhaseAnalyzeFn phaseAnalyze;
+    PhaseSynthesizeFn phaseSynthesize;
+    CrossCorrelateFn crossCorrelate;
+    PolyphaseFn polyphase;
+    BiquadFn biquad;
+    FramePeakFn framePeak;
+    FrameGainFn frameGain;
+    ReverseFn reverse;
+    MixAddFn mixAdd;
+    FindAboveFn findAbove;
+    FindLastAboveFn findLastAbove;
+    GlideFn glide;
+};
+
+/**
+ * @brief Kernel table of the engine.
+ *
+ * Resolved once (thread-safe) on the first call: the best ISA supported by the
+ * running CPU, or the one requested by the `AJ_SIMD` environment variable
+ * (`scalar`, `sse4.1`, `avx2`, `avx512`, `neon`) if it is supported.
+ */
+const KernelTable& table();
+
+/**
+ * @brief Resolve the kernel table now, called by AJ_Engine on construction so
+ * the first processed buffer doesn't pay for the CPU detection.
+ */
+void init();
+
+/**
+ * @brief Best ISA supported by the running CPU (among the ones compiled in).
+ */
+ISA detect();
+
+/**
+ * @brief Whether kernels for `isa` are compiled in and the running CPU supports them.
+ */
+bool supported(ISA isa);
+
+/**
+ * @brief Kernel table for a given ISA (Scalar table if `isa` is not supported).
+ */
+KernelTable tableFor(ISA isa);
+
+/**
+ * @brief Printable name of an ISA, same spelling as `AJ_SIMD`.
+ */
+const char* name(ISA isa);
+
+/**
+ * @brief Scalar value of a tanh approximation, same result as the shape kernels
+ * (used e.g. to compute the makeup gain 1 / tanh(drive)).
+ */
+float tanhApprox(float x, TanhApprox approx);
+
+/**
+ * @brief Levels of two adjacent ranges merged into the levels of their union.
+ */
+Levels combine(const Levels &a, const Levels &b);
+
+/**
+ * @brief Peak (max |x|) of a range, 0 for an empty range.
+ */
+float peak(const Levels &levels);
+
+/**
+ * @brief Reverse the order of `frames` interleaved frames in place (the samples of a frame keep their order).
+ */
+void reverseFrames(float *data, size_t frames, size_t channels);
+
+/**
+ * @brief Fill `noise` with TPDF dither (sum of two uniform values, in [-1, 1) LSB) for the
+ * ToInt16Fn / ToInt32Fn kernels.
+ * @param state xorshift state carried between calls (must not be 0).
+ */
+void ditherTPDF(float *noise, size_t count, uint32_t &state);
+
+//* kernels of every ISA, defined in src/dsp/kernels/kernels_<isa>.cc.
+//! the ISA translation units must not include engine headers: inline functions
+//! compiled there with wider instructions could be picked by the linker for the
+//! scalar code too.
+
+void gainScalar(float *data, size_t count, float gain);
+void scaleScalar(float *data, size_t count, float gain);
+void fadeScalar(float *data, size_t count, double startGain, double step);
+void echoScalar(const float *in, const float *delayed, float *out, size_t count, float decay);
+void mulAddScalar(const float *in, const float *delayed, float *out, size_t count, float gain);
+void complexMulAddScalar(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count);
+void butterflyScalar(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count);
+void phaseAnalyzeScalar(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase);
+void phaseSynthesizeScalar(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase);
+void crossCorrelateScalar(const float *x, const float *ref, float *out, size_t lags, size_t length);
+void polyphaseScalar(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count);
+void biquadScalar(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs, float *state);
+void framePeakScalar(const float *data, size_t frames, size_t channels, float *peaks);
+void frameGainScalar(float *data, size_t frames, size_t channels, const float *gains);
+void reverseScalar(float *front, float *back, size_t frames, size_t channels);
+void mixAddScalar(const float *in, float *out, size_t frames, float left, float right);
+size_t findAboveScalar(const float *data, size_t count, float threshold);
+size_t findLastAboveScalar(const float *data, size_t count, float threshold);
+void glideScalar(float *gains, size_t count, float start, float target, float coef);
+void combScalar(float *line, float gain, const float *in, float *acc, size_t count);
+void shapeScalar(float *data, size_t count, const ShapeParams &params);
+Levels analyzeScalar(const float *data, size_t count);
+void interleaveScalar(const float *left, const float *right, float *out, size_t frames);
+void deinterleaveScalar(const float *in, float *left, float *right, size_t frames);
+void toInt16Scalar(const float *in, int16_t *out, size_t count, const float *dither);
+void fromInt16Scalar(const int16_t *in, float *out, size_t count);
+void toInt32Scalar(const float *in, int32_t *out, size_t count, float scale, const float *dither);
+void fromInt32Scalar(const int32_t *in, float *out, size_t count, float gain);
+void toHalfScalar(const float *in, uint16_t *out, size_t count);
+void fromHalfScalar(const uint16_t *in, float *out, size_t count);
+
+void gainSSE41(float *data, size_t count, float gain);
+void scaleSSE41(float *data, size_t count, float gain);
+void fadeSSE41(float *data, size_t count, double startGain, double step);
+void echoSSE41(const float *in, const float *delayed, float *out, size_t count, float decay);
+void mulAddSSE41(const float *in, const float *delayed, float *out, size_t count, float gain);
+void complexMulAddSSE41(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count);
+void butterflySSE41(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count);
+void phaseAnalyzeSSE41(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase);
+void phaseSynthesizeSSE41(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase);
+void crossCorrelateSSE41(const float *x, const float *ref, float *out, size_t lags, size_t length);
+void polyphaseSSE41(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count);
+void biquadSSE41(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs, float *state);
+void framePeakSSE41(const float *data, size_t frames, size_t channels, float *peaks);
+void frameGainSSE41(float *data, size_t frames, size_t channels, const float *gains);
+void reverseSSE41(float *front, float *back, size_t frames, size_t channels);
+void mixAddSSE41(const float *in, float *out, size_t frames, float left, float right);
+size_t findAboveSSE41(const float *data, size_t count, float threshold);
+size_t findLastAboveSSE41(const float *data, size_t count, float threshold);
+void glideSSE41(float *gains, size_t count, float start, float target, float coef);
+void combSSE41(float *line, float gain, const float *in, float *acc, size_t count);
+void shapeSSE41(float *data, size_t count, const ShapeParams &params);
+Levels analyzeSSE41(const float *data, size_t count);
+void interleaveSSE41(const float *left, const float *right, float *out, size_t frames);
+void deinterleaveSSE41(const float *in, float *left, float *right, size_t frames);
+void toInt16SSE41(const float *in, int16_t *out, size_t count, const float *dither);
+void fromInt16SSE41(const int16_t *in, float *out, size_t count);
+void toInt32SSE41(const float *in, int32_t *out, size_t count, float scale, const float *dither);
+void fromInt32SSE41(const int32_t *in, float *out, size_t count, float gain);
+//? no half conversions before F16C, the SSE4.1 table uses the scalar ones.
+
+void gainAVX2(float *data, size_t count, float gain);
+void scaleAVX2(float *data, size_t count, float gain);
+void fadeAVX2(float *data, size_t count, double startGain, double step);
+void echoAVX2(const float *in, const float *delayed, float *out, size_t count, float decay);
+void mulAddAVX2(const float *in, const float *delayed, float *out, size_t count, float gain);
+void complexMulAddAVX2(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count);
+void butterflyAVX2(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count);
+void phaseAnalyzeAVX2(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase);
+void phaseSynthesizeAVX2(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase);
+void crossCorrelateAVX2(const float *x, const float *ref, float *out, size_t lags, size_t length);
+void polyphaseAVX2(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count);
+void biquadAVX2(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs, float *state);
+void framePeakAVX2(const float *data, size_t frames, size_t channels, float *peaks);
+void frameGainAVX2(float *data, size_t frames, size_t channels, const float *gains);
+void reverseAVX2(float *front, float *back, size_t frames, size_t channels);
+void mixAddAVX2(const float *in, float *out, size_t frames, float left, float right);
+size_t findAboveAVX2(const float *data, size_t count, float threshold);
+size_t findLastAboveAVX2(const float *data, size_t count, float threshold);
+void glideAVX2(float *gains, size_t count, float start, float target, float coef);
+void combAVX2(float *line, float gain, const float *in, float *acc, size_t count);
+void shapeAVX2(float *data, size_t count, const ShapeParams &params);
+Levels analyzeAVX2(const float *data, size_t count);
+void interleaveAVX2(const float *left, const float *right, float *out, size_t frames);
+void deinterleaveAVX2(const float *in, float *left, float *right, size_t frames);
+void toInt16AVX2(const float *in, int16_t *out, size_t count, const float *dither);
+void fromInt16AVX2(const int16_t *in, float *out, size_t count);
+void toInt32AVX2(const float *in, int32_t *out, size_t count, float scale, const float *dither);
+void fromInt32AVX2(const int32_t *in, float *out, size_t count, float gain);
+void toHalfAVX2(const float *in, uint16_t *out, size_t count);
+void fromHalfAVX2(const uint16_t *in, float *out, size_t count);
+
+void gainAVX512(float *data, size_t count, float gain);
+void scaleAVX512(float *data, size_t count, float gain);
+void fadeAVX512(float *data, size_t count, double startGain, double step);
+void echoAVX512(const float *in, const float *delayed, float *out, size_t count, float decay);
+void mulAddAVX512(const float *in, const float *delayed, float *out, size_t count, float gain);
+void complexMulAddAVX512(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count);
+void butterflyAVX512(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count);
+void phaseAnalyzeAVX512(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase);
+void phaseSynthesizeAVX512(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase);
+void crossCorrelateAVX512(const float *x, const float *ref, float *out, size_t lags, size_t length);
+void polyphaseAVX512(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count);
+void biquadAVX512(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs, float *state);
+void framePeakAVX512(const float *data, size_t frames, size_t channels, float *peaks);
+void frameGainAVX512(float *data, size_t frames, size_t channels, const float *gains);
+void reverseAVX512(float *front, float *back, size_t frames, size_t channels);
+void mixAddAVX512(const float *in, float *out, size_t frames, float left, float right);
+size_t findAboveAVX512(const float *data, size_t count, float threshold);
+size_t findLastAboveAVX512(const float *data, size_t count, float threshold);
+void glideAVX512(float *gains, size_t count, float start, float target, float coef);
+void combAVX512(float *line, float gain, const float *in, float *acc, size_t count);
+void shapeAVX512(float *data, size_t count, const ShapeParams &params);
+Levels analyzeAVX512(const float *data, size_t count);
+void interleaveAVX512(const float *left, const float *right, float *out, size_t frames);
+void deinterleaveAVX512(const float *in, float *left, float *right, size_t frames);
+void toInt16AVX512(const float *in, int16_t *out, size_t count, const float *dither);
+void fromInt16AVX512(const int16_t *in, float *out, size_t count);
+void toInt32AVX512(const float *in, int32_t *out, size_t count, float scale, const float *dither);
+void fromInt32AVX512(const int32_t *in, float *out, size_t count, float gain);
+void toHalfAVX512(const float *in, uint16_t *out, size_t count);
+void fromHalfAVX512(const uint16_t *in, float *out, size_t count);
+
+void gainNEON(float *data, size_t count, float gain);
+void scaleNEON(float *data, size_t count, float gain);
+void fadeNEON(float *data, size_t count, double startGain, double step);
+void echoNEON(const float *in, const float *delayed, float *out, size_t count, float decay);
+void mulAddNEON(const float *in, const float *delayed, float *out, size_t count, float gain);
+void complexMulAddNEON(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count);
+void butterflyNEON(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count);
+void phaseAnalyzeNEON(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase);
+void phaseSynthesizeNEON(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase);
+void crossCorrelateNEON(const float *x, const float *ref, float *out, size_t lags, size_t length);
+void polyphaseNEON(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count);
+void biquadNEON(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs, float *state);
+void framePeakNEON(const float *data, size_t frames, size_t channels, float *peaks);
+void frameGainNEON(float *data, size_t frames, size_t channels, const float *gains);
+void reverseNEON(float *front, float *back, size_t frames, size_t channels);
+void mixAddNEON(const float *in, float *out, size_t frames, float left, float right);
+size_t findAboveNEON(const float *data, size_t count, float threshold);
+size_t findLastAboveNEON(const float *data, size_t count, float threshold);
+void glideNEON(float *gains, size_t count, float start, float target, float coef);
+void combNEON(float *line, float gain, const float *in, float *acc, size_t count);
+void shapeNEON(float *data, size_t count, const ShapeParams &params);
+Levels analyzeNEON(const float *data, size_t count);
+void interleaveNEON(const float *left, const float *right, float *out, size_t frames);
+void deinterleaveNEON(const float *in, float *left, float *right, size_t frames);
+void toInt16NEON(const float *in, int16_t *out, size_t count, const float *dither);
+void fromInt16NEON(const int16_t *in, float *out, size_t count);
+void toInt32NEON(const float *in, int32_t *out, size_t count, float scale, const float *dither);
+void fromInt32NEON(const int32_t *in, float *out, size_t count, float gain);
+void toHalfNEON(const float *in, uint16_t *out, size_t count);
+void fromHalfNEON(const uint16_t *in, float *out, size_t count);
+
+}
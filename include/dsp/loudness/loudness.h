@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/thread_pool.h"
+#include "dsp/eq/biquad.h"
+
+namespace AJ::dsp::loudness {
+
+/**
+ * @brief Integrated loudness and true peak of a range (ITU-R BS.1770-4, EBU R128).
+ */
+struct Measurement {
+    /// @brief Gated loudness in LUFS, -infinity if no 400 ms block passes the gates (silence, or shorter than a block).
+    double mIntegrated = -std::numeric_limits<double>::infinity();
+    /// @brief Largest absolute value of the samples and of the 4x oversampled signal (linear, dBTP = 20·log10).
+    float mTruePeak = 0.0f;
+
+    /// @brief Whether the integrated loudness is defined (some block passed the gates).
+    bool audible() const noexcept { return std::isfinite(mIntegrated); }
+};
+
+/**
+ * @brief The two K-weighting stages at `samplerate`: the head shelf (+4 dB above ~1.7 kHz) and the
+ * RLB high pass (~38 Hz), in the order they are applied. At 48 kHz they are the BS.1770 coefficients.
+ */
+std::array<eq::Coefficients, 2> kWeighting(double samplerate);
+
+/**
+ * @brief Measure `frames` frames of `count` planar channels (1 or 2, both weighted 1.0).
+ *
+ * The K-weighted power of every 100 ms hop is measured in tasks of kLoudnessChunkSteps hops, on
+ * `pool` if one is given. Every task runs its filters over the hop before its range first, which
+ * settles them to well under float precision, so the hops don't depend on the task boundaries
+ * and the result is the same with or without a pool. The 400 ms blocks (4 hops) are gated
+ * afterwards, in order: at kLoudnessAbsoluteGateLufs, then kLoudnessRelativeGateLu under the
+ * loudness of what's left. The true peak goes through the BS.1770 4-phase interpolator
+ * (the `polyphase` kernel) in the same tasks.
+ *
+ * @param channels    `count` pointers to `frames` samples each.
+ * @param samplerate  samplerate of the audio, in [kMinSamplerate, kMaxSamplerate].
+ * @param measurement [out] loudness and true peak of the frames.
+ * @return false if a task couldn't get its scratch buffers.
+ */
+bool measure(const float *const *channels, size_t count, size_t frames, uint32_t samplerate,
+    Measurement &measurement, utils::ThreadPool *pool = nullptr);
+
+}
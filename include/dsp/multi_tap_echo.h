@@ -0,0 +1,183 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "effect.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+
+namespace AJ::dsp::multitap {
+
+/**
+ * @brief One tap of the multi-tap echo.
+ */
+struct Tap {
+    float mDelayInSeconds; /**< Delay of the tap, in seconds (at least one sample). */
+    float mGain;           /**< Gain of the tap, in [-1.0, 1.0]. */
+};
+
+/**
+ * @brief Container for all multi-tap echo parameters.
+ */
+struct Params {
+    sample_pos mStart;       /**< Start position of the echo in samples (inclusive). */
+    sample_pos mEnd;         /**< End position of the echo in samples (inclusive). */
+    std::vector<Tap> mTaps;  /**< 1 to kEchoMaxTaps taps. */
+    float mFeedback;         /**< Part of the longest tap fed back into the delay line, in [0, kEchoMaxFeedback]. */
+    int mSamplerate;         /**< Sampling rate of the audio in Hz. */
+};
+
+/**
+ * @brief Tap of MultiTapParams, its delay converted to samples.
+ */
+struct DelayTap {
+    size_t mDelay; ///< delay in samples (>= 1).
+    float mGain;   ///< gain of the tap.
+};
+
+/**
+ * @brief Parameter container for the MultiTapEcho effect.
+ *
+ * @see AJ::dsp::EffectParams
+ */
+class MultiTapParams : public EffectParams {
+    struct PrivateTag {};
+
+    std::vector<DelayTap> mTaps;  ///< taps, delays in samples.
+    float mFeedback = 0.0f;       ///< feedback of the longest tap.
+    size_t mMinDelay = 0;         ///< shortest tap delay.
+    size_t mMaxDelay = 0;         ///< longest tap delay (= delay line length).
+
+public:
+    /**
+     * @brief Factory method to create a MultiTapParams instance.
+     *
+     * Validation rules:
+     * - 1 to kEchoMaxTaps taps, every delay at least one sample, every gain in [-1.0, 1.0].
+     * - `feedback` in [0.0, kEchoMaxFeedback].
+     *
+     * @param params   Struct containing all multi-tap echo parameters.
+     * @param handler  Error handler for reporting parameter validation failures.
+     *
+     * @return Shared pointer to a valid MultiTapParams instance if parameters are valid,
+     *         otherwise nullptr.
+     */
+    static std::shared_ptr<MultiTapParams> create(Params &params, AJ::error::IErrorHandler &handler);
+
+    /// @brief Taps, delays in samples.
+    const std::vector<DelayTap>& Taps() const noexcept { return mTaps; }
+
+    /// @brief Feedback of the longest tap.
+    float Feedback() const noexcept { return mFeedback; }
+
+    /// @brief Shortest tap delay in samples.
+    size_t MinDelay() const noexcept { return mMinDelay; }
+
+    /// @brief Longest tap delay in samples, the length of the delay line.
+    size_t MaxDelay() const noexcept { return mMaxDelay; }
+
+    ~MultiTapParams() override = default;
+
+    MultiTapParams(PrivateTag) {}
+};
+
+/**
+ * @brief Block processing state of the MultiTapEcho effect.
+ *
+ * One delay ring of `MaxDelay()` frames per channel, the memory doesn't depend on
+ * the length of the stream.
+ */
+class MultiTapState : public EffectState {
+public:
+    std::vector<Float> mRings;      ///< delay ring of every channel.
+    std::vector<float*> mRingData;  ///< data() of every ring, so processBlock() doesn't build the list.
+    size_t mHead = 0;               ///< ring index of the oldest frame (= next write position).
+
+    MultiTapState(uint8_t channels, size_t delay) : EffectState(channels) {
+        mRings.assign(channels, Float(delay, 0.0f));
+        for(auto &ring : mRings){
+            mRingData.push_back(ring.data());
+        }
+    }
+
+    MultiTapState(const MultiTapState&) = delete;
+    MultiTapState& operator=(const MultiTapState&) = delete;
+
+    void reset() override {
+        EffectState::reset();
+        mHead = 0;
+        for(auto &ring : mRings){
+            std::fill(ring.begin(), ring.end(), 0.0f);
+        }
+    }
+};
+
+/**
+ * @brief Multi-tap echo with feedback, on a delay ring sized to the longest tap.
+ *
+ * ### Equation:
+ * @code
+ * w[n] = x[n] + feedback * w[n - MaxDelay()]        (delay line input)
+ * y[n] = clamp(x[n] + sum_k gain_k * w[n - delay_k], -1, 1)
+ * @endcode
+ *
+ * The taps are summed a chunk at a time (at most the shortest delay, so every tap read is
+ * already in the ring) with the mulAdd kernel. process() and processBlock() run the same
+ * chunks: whole buffers, live streams and files streamed block by block give the same output.
+ */
+class MultiTapEcho : public AJ::dsp::Effect {
+    std::shared_ptr<MultiTapParams> mParams;
+
+    /**
+     * @brief Run frames [first, last) of `data` (`stride` interleaved channels) through the echo.
+     *
+     * @param rings delay ring of every channel, `MaxDelay()` frames each.
+     * @param head  [in, out] ring index of the oldest frame.
+     */
+    void render(float *data, size_t first, size_t last, uint8_t stride, float *const *rings, size_t &head) const;
+
+public:
+    MultiTapEcho() {
+        mParams = nullptr;
+    }
+
+    /**
+     * @brief Apply the echo to [Start, End] of a single-channel buffer in-place.
+     *
+     * The delay ring comes from the thread's scratch arena.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief Create a MultiTapState with a delay ring of `MaxDelay()` frames per channel.
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Apply the echo to one block of interleaved frames, in-place.
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left
+     * unchanged (and are not fed into the delay ring).
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Set effect parameters from a shared EffectParams object (must be MultiTapParams).
+     */
+    bool setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler) override;
+};
+
+}
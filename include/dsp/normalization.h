@@ -2,25 +2,30 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <cmath>
 
 #include "effect.h"
+#include "dsp/kernels.h"
+#include "dsp/loudness/loudness.h"
 #include "core/effect_params.h"
 #include "core/types.h"
+#include "core/thread_pool.h"
 
 namespace AJ::dsp::normalization {
 /**
  * @brief Modes of normalization.
  *
  * - Peak: Scales audio so that the highest peak reaches the target amplitude.
- * - RMS:  Scales audio so that the RMS (Root Mean Square) value reaches the target amplitude.\
- * 
- * * NOTE: RMS normalization in this implementation is not fully tuned for
- *   practical use — it may produce excessive gain for low-level or sparse audio.
+ * - RMS:  Scales audio so that the RMS (Root Mean Square) value reaches the target amplitude,
+ *         the peaks above kNormalizationCeilingDb are held back by a lookahead limiter.
+ * - LUFS: Scales audio so that the integrated loudness (ITU-R BS.1770, EBU R128) reaches the
+ *         target in LUFS, the true peaks above kNormalizationCeilingDb are held back by the limiter.
  */
 enum NormalizationMode {
     Peak,  ///< Peak normalization mode.
     RMS,   ///< RMS normalization mode.
+    LUFS,  ///< Integrated loudness normalization mode.
 };
 
 /**
@@ -31,8 +36,9 @@ enum NormalizationMode {
 struct Params {
     sample_pos mStart;   /**< Sample position where normalization starts (inclusive). */
     sample_pos mEnd;     /**< Sample position where normalization ends (inclusive). */
-    float mTarget;       /**< Target normalization level (default: 1.0f). */
+    float mTarget;       /**< Target normalization level (default: 1.0f), in LUFS for NormalizationMode::LUFS. */
     NormalizationMode mMode; /**< Normalization mode (default: NormalizationMode::Peak). */
+    uint32_t mSamplerate;    /**< Samplerate of the audio, sets the limiter timing of the RMS mode (default: 44100). */
 
     /**
      * @brief Construct a Params object with default normalization values.
@@ -40,12 +46,14 @@ struct Params {
      * By default:
      * - `mTarget` is set to 1.0f.
      * - `mMode` is set to NormalizationMode::Peak.
+     * - `mSamplerate` is set to 44100.
      */
     Params()
         : mStart(0)
         , mEnd(0)
         , mTarget(1.0f)
-        , mMode(NormalizationMode::Peak) {}
+        , mMode(NormalizationMode::Peak)
+        , mSamplerate(44100) {}
 };
 
 /**
@@ -56,9 +64,11 @@ struct Params {
  * parameters stay within valid ranges.
  */
 class NormalizationParams : public EffectParams {
-    float mTarget;               ///< Target amplitude (linear scale, [0.0f, 1.0f]).
+    float mTarget;               ///< Target amplitude (linear scale, [0.0f, 1.0f]) or loudness (LUFS, [kLoudnessMinTargetLufs, 0]).
     float mGain;                 ///< Computed gain factor to apply.
     NormalizationMode mMode;     ///< Selected normalization mode.
+    uint32_t mSamplerate;        ///< Samplerate of the audio (limiter timing, K-weighting).
+    std::optional<loudness::Measurement> mLoudness; ///< loudness of the whole file, measured beforehand (LUFS mode).
 
     struct PrivateTag {};        ///< Tag for private constructor to enforce factory creation.
 public:
@@ -69,7 +79,8 @@ public:
      * in a Params structure.
      * 
      * Validation rules:
-     * - `target` must be non-negative.
+     * - `target` must be non-negative, or in [kLoudnessMinTargetLufs, 0] for NormalizationMode::LUFS.
+     * - `mSamplerate` must be in [kMinSamplerate, kMaxSamplerate].
      * 
      * The constructor is intentionally restricted — use this method as the only way
      * to create a NormalizationParams instance.
@@ -89,11 +100,12 @@ public:
     }
 
     /**
-     * @brief Set the target amplitude (linear scale).
-     * @param factor Target amplitude in range [0.0f, 1.0f].
+     * @brief Set the target amplitude (linear scale) or loudness (LUFS mode).
+     * @param factor Target amplitude in range [0.0f, 1.0f], or [kLoudnessMinTargetLufs, 0.0f] LUFS.
      */
     void setTarget(float factor){
-        mTarget = std::clamp(factor, 0.0f, 1.0f);
+        mTarget = mMode == NormalizationMode::LUFS ? std::clamp(factor, kLoudnessMinTargetLufs, 0.0f)
+            : std::clamp(factor, 0.0f, 1.0f);
     }
 
     /// @return The current normalization mode.
@@ -102,13 +114,33 @@ public:
     }
 
     /**
-     * @brief Set the normalization mode.
-     * @param mode NormalizationMode::Peak or NormalizationMode::RMS.
+     * @brief Set the normalization mode (call setTarget() again when switching to or from LUFS).
+     * @param mode NormalizationMode::Peak, NormalizationMode::RMS or NormalizationMode::LUFS.
      */
     void setMode(NormalizationMode mode){
         mMode = mode;
     }
 
+    /// @return The samplerate of the audio.
+    uint32_t Samplerate() const {
+        return mSamplerate;
+    }
+
+    /**
+     * @brief Use the loudness of the whole file instead of measuring every buffer (LUFS mode).
+     *
+     * The engine measures a file over all its channels with io::AudioFile::loudness(), which
+     * caches the result for the next normalization of the range.
+     */
+    void setLoudness(const loudness::Measurement &measurement){
+        mLoudness = measurement;
+    }
+
+    /// @return The loudness set by setLoudness(), nullptr if every buffer is measured.
+    const loudness::Measurement* Loudness() const {
+        return mLoudness ? &*mLoudness : nullptr;
+    }
+
     /// @return The current gain factor.
     float Gain(){
         return mGain;
@@ -128,6 +160,7 @@ public:
     NormalizationParams(PrivateTag){
         mTarget = 1.0f;
         mMode = NormalizationMode::Peak;
+        mSamplerate = 44100;
     }
 };
 
@@ -136,68 +169,66 @@ public:
  *
  * Applies gain to audio samples to achieve a specified
  * target amplitude, either by peak normalization or RMS normalization.
- * In RMS mode, a peak clamp is applied to avoid clipping.
- *
- * TODO: Fix RMS Function.
+ * In RMS mode, the gain is applied through a lookahead limiter (dynamics::Processor) when it
+ * would push the peaks over kNormalizationCeilingDb, in the same pass. The LUFS mode does the
+ * same with the true peak.
  */
 class Normalization : public AJ::dsp::Effect {
 
     std::shared_ptr<NormalizationParams> mParams; ///< Effect parameters.
+    std::shared_ptr<utils::ThreadPool> pThreadPool; ///< optional pool used for long ranges.
 
     /**
-     * @brief Applies gain using AVX vectorization without clamping.
-     * 
-     * Optimized for Peak normalization where clamping is unnecessary.  
-     * Uses AVX instructions to process multiple samples in parallel.
-     * 
-     * @param buffer   Audio buffer to be modified in-place.
-     * @param handler  Error handler for processing errors.
-     * 
-     * @return true if processing was successful, false otherwise.
+     * @brief Validate the parameters and [Start, End] against the buffer.
+     *
+     * @return false (and reports the error) if the range is out of the buffer.
      */
-    bool gainAVX(Float &buffer, AJ::error::IErrorHandler &handler);
+    bool checkRange(const Float &buffer, AJ::error::IErrorHandler &handler);
 
     /**
-     * @brief Applies gain using a naive scalar loop without clamping.
-     * 
-     * Intended for Peak normalization when vectorization is not available  
-     * or AVX optimization is disabled.
-     * 
-     * @param buffer   Audio buffer to be modified in-place.
-     * @param handler  Error handler for processing errors.
-     * 
-     * @return true if processing was successful, false otherwise.
+     * @brief Min, max and sum of squares of [Start, End] over `count` channels (SIMD kernel picked at runtime).
+     *
+     * Ranges longer than kParallelChunkFrames are split across the thread pool (if set),
+     * partial results are combined in order so the result doesn't depend on the scheduling.
+     *
+     * @param channels `count` pointers to the frame at Start of each channel.
      */
-    bool gainNaive(Float &buffer, AJ::error::IErrorHandler &handler);
+    kernels::Levels analyze(const float *const *channels, size_t count);
 
     /**
-     * @brief Dispatches to the appropriate gain function (AVX or naive).
+     * @brief Applies the gain without clamping (SIMD kernel picked at runtime).
      * 
-     * Automatically selects between AVX and naive implementations  
-     * based on platform capabilities and compile-time configuration.
+     * Shared by the Peak and RMS modes: the gain is limited by the peak so the result never clips.
      * 
-     * @param buffer   Audio buffer to be modified in-place.
+     * @param channels `count` pointers to the frame at Start of each channel, modified in-place.
      * @param handler  Error handler for processing errors.
      * 
      * @return true if processing was successful, false otherwise.
      */
-    bool gain(Float &buffer, AJ::error::IErrorHandler &handler);
+    bool gain(float *const *channels, size_t count, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Normalize checked channels with the mode of the parameters, `levels` are those of all of them.
+     */
+    bool normalize(float *const *channels, size_t count, const kernels::Levels &levels,
+        AJ::error::IErrorHandler &handler);
 
     /**
      * @brief Performs RMS-based normalization.
      * 
-     * Adjusts gain so that the Root Mean Square (RMS) level matches the target.  
-     * Includes a basic peak limiter to reduce excessive gain.  
-     * 
-     * @warning Current implementation may produce unpredictable results  
-     * for low-level or sparse audio. Peak normalization is recommended.
+     * Adjusts gain so that the Root Mean Square (RMS) level matches the target (the gain is
+     * still clamped to [0, 5]). Peaks the gain would push over kNormalizationCeilingDb go
+     * through a lookahead limiter instead of lowering the gain of the whole range, so the
+     * RMS only drops by what the limiter takes off the peaks.
      * 
-     * @param buffer   Audio buffer to be normalized in-place.
+     * @param channels `count` pointers to the frame at Start of each channel, normalized in-place.
+     * @param levels   Levels of [Start, End] of all the channels.
      * @param handler  Error handler for processing errors.
      * 
      * @return true if processing was successful, false otherwise.
      */
-    bool normalizationRMS(Float &buffer, AJ::error::IErrorHandler &handler);
+    bool normalizationRMS(float *const *channels, size_t count, const kernels::Levels &levels,
+        AJ::error::IErrorHandler &handler);
 
     /**
      * @brief Performs Peak-based normalization.
@@ -205,12 +236,29 @@ class Normalization : public AJ::dsp::Effect {
      * Scales the audio buffer so the highest absolute sample reaches the target.  
      * This method is fast, predictable, and safe for production use.
      * 
-     * @param buffer   Audio buffer to be normalized in-place.
+     * @param channels `count` pointers to the frame at Start of each channel, normalized in-place.
+     * @param levels   Levels of [Start, End] of all the channels.
      * @param handler  Error handler for processing errors.
      * 
      * @return true if processing was successful, false otherwise.
      */
-    bool normalizationPeak(Float &buffer, AJ::error::IErrorHandler &handler);
+    bool normalizationPeak(float *const *channels, size_t count, const kernels::Levels &levels,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Performs loudness (LUFS) normalization.
+     *
+     * Uses the loudness set on the parameters (NormalizationParams::setLoudness()), otherwise
+     * measures [Start, End] of the channels (loudness::measure(), on the thread pool if set). The gain moves the integrated loudness to the target (clamped to [0, 5] like RMS),
+     * the limiter takes over when the gained true peak would exceed kNormalizationCeilingDb.
+     * A range with no block over the absolute gate is left unchanged.
+     *
+     * @param channels `count` pointers to the frame at Start of each channel, normalized in-place.
+     * @param handler  Error handler for processing errors.
+     *
+     * @return true if processing was successful, false otherwise.
+     */
+    bool normalizationLUFS(float *const *channels, size_t count, AJ::error::IErrorHandler &handler);
 
 public:
     /// @brief Default constructor.
@@ -227,6 +275,14 @@ public:
         setParams(params, handler);
     }
 
+    /**
+     * @brief Use a thread pool for the analysis and gain passes over long ranges.
+     * @param pool thread pool (e.g. EngineResources::threadPool()), nullptr to run on the caller thread.
+     */
+    void setThreadPool(std::shared_ptr<utils::ThreadPool> pool) override {
+        pThreadPool = std::move(pool);
+    }
+
     /**
      * @brief Process the audio buffer using the selected normalization mode.
      * 
@@ -237,6 +293,41 @@ public:
      */
     bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
 
+    /**
+     * @brief Process the audio buffer with levels measured beforehand, skips the analysis pass.
+     *
+     * Used with io::LevelIndex, whose queries make re-normalizing a file close to free.
+     * The LUFS mode doesn't use the levels (see NormalizationParams::setLoudness()).
+     *
+     * @param buffer   Audio samples to process.
+     * @param levels   Levels of [Start, End] of `buffer` (e.g. io::LevelIndex::query()).
+     * @param handler  Error handler for reporting processing issues.
+     *
+     * @return true if processing was successful, false otherwise.
+     */
+    bool process(Float &buffer, const kernels::Levels &levels, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Normalize [Start, End] of the first `channels` channels together.
+     *
+     * The channels are linked: the peak, RMS or loudness is measured over all of them and they
+     * all get the same gain (and limiter), so the balance between them doesn't change.
+     *
+     * @param audio    planar channels, the range must fit every one of them.
+     * @param channels number of channels, 1 to kNumChannels.
+     * @param handler  Error handler for reporting processing issues.
+     *
+     * @return true if processing was successful, false otherwise.
+     */
+    bool process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief The channels share the gain.
+     */
+    bool linksChannels() const override {
+        return true;
+    }
+
     /**
      * @brief Assigns normalization parameters to the effect.
      * 
@@ -0,0 +1,95 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "dsp/fft.h"
+
+namespace AJ::dsp::pitch {
+
+/**
+ * @brief Frame layout and tables of a phase vocoder, shared read-only by every vocoder using it.
+ *
+ * Frames of `mFrameSize` samples, `kPitchOversampling` of them overlap (hop = frame / oversampling).
+ * Both the analysis and the synthesis window are a periodic Hann window, the synthesis one is
+ * scaled so overlapping frames add back to unity gain.
+ */
+struct VocoderSetup {
+    size_t mFrameSize;                   ///< N, samples per frame (power of two).
+    size_t mHop;                         ///< N / kPitchOversampling, samples between two frames.
+    float mRatio;                        ///< frequency ratio, 2^(semitones / 12).
+    float mHopPhase;                     ///< 2π hop / N, phase advance of bin 1 over one hop.
+    std::shared_ptr<const fft::Plan> mFFT; ///< N point real FFT.
+    Float mWindow;                       ///< analysis window, N samples.
+    Float mSynthesis;                    ///< synthesis window, Hann / (N * sum of the overlapping Hann^2).
+    Float mUnit;                         ///< N / 2 + 1 ones, unit magnitudes of the phase accumulation.
+
+    VocoderSetup(size_t frameSize, float ratio);
+
+    /// @brief Frames between a sample going in and coming out of a PhaseVocoder, N.
+    size_t latency() const noexcept { return mFrameSize; }
+};
+
+/**
+ * @class PhaseVocoder
+ * @brief Streaming phase vocoder pitch shift of one channel.
+ *
+ * Samples are collected in an N sample FIFO. Every hop the frame is windowed and transformed,
+ * the `phaseAnalyze` kernel turns the bins into magnitudes and true frequencies (phase
+ * unwrapping). Every spectral peak moves to bin round(peak·ratio) together with the bins around it,
+ * the `phaseSynthesize` kernel accumulates the phases at the new bins (with the frequencies scaled
+ * by the ratio) and every moved region is rotated onto the phase of its peak (phase locking).
+ * The inverse FFT is windowed and overlap-added.
+ *
+ * The output lags the input by `latency()` frames. Nothing is allocated after construction.
+ */
+class PhaseVocoder {
+    std::shared_ptr<const VocoderSetup> pSetup;
+
+    Float mInput;      ///< input FIFO, N samples, [0, mFill) filled, refilled from N - hop.
+    Float mOutput;     ///< overlap-add accumulator, N samples.
+    Float mReady;      ///< hop samples of finished output, read while the FIFO refills.
+    Float mLastPhase;  ///< analysis phase of every bin in the previous frame.
+    Float mSumPhase;   ///< synthesis phase of every bin.
+    Float mTime;       ///< windowed frame / inverse FFT output, N samples.
+    Float mRe, mIm;    ///< spectrum of the frame.
+    Float mMag, mFreq; ///< analysed magnitudes / frequencies (in bins).
+    Float mShiftFreq;  ///< frequency (in bins) landing on every target bin.
+    Float mPhasorRe, mPhasorIm; ///< unit phasors of the accumulated phases.
+    Float mShiftRe, mShiftIm;   ///< shifted spectrum.
+    std::vector<size_t> mPeaks; ///< local magnitude maxima of the frame.
+    size_t mFill = 0;  ///< samples in mInput.
+
+    /// @brief Move the peak regions of the analysed frame by the ratio into mShiftRe / mShiftIm.
+    void shift();
+
+    /// @brief Analyse the full FIFO, overlap-add its shifted frame and move one hop forward.
+    void frame();
+
+public:
+    explicit PhaseVocoder(std::shared_ptr<const VocoderSetup> setup);
+
+    PhaseVocoder(const PhaseVocoder&) = delete;
+    PhaseVocoder& operator=(const PhaseVocoder&) = delete;
+
+    /// @brief Setup the vocoder runs with.
+    const std::shared_ptr<const VocoderSetup>& setup() const noexcept {
+        return pSetup;
+    }
+
+    /**
+     * @brief Push `frames` samples and write the same number of output samples.
+     *
+     * `in` and `out` may be the same pointer (in place).
+     *
+     * @param in     first input sample, consecutive samples `stride` floats apart (nullptr feeds silence).
+     * @param out    first output sample, same stride.
+     */
+    void process(const float *in, float *out, size_t frames, size_t stride);
+
+    /// @brief Forget the history, the next sample starts a new stream.
+    void reset();
+};
+
+}
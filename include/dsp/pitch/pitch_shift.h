@@ -0,0 +1,159 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "dsp/effect.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+#include "dsp/pitch/phase_vocoder.h"
+
+namespace AJ::dsp::pitch {
+
+/**
+ * @brief Container for all pitch shift parameters.
+ */
+struct Params {
+    sample_pos mStart;   /**< Start position of the shift in samples (inclusive). */
+    sample_pos mEnd;     /**< End position of the shift in samples (inclusive). */
+    float mSemitones;    /**< Shift in semitones, in [-kPitchMaxSemitones, kPitchMaxSemitones] (fractions allowed). */
+    size_t mFrameSize;   /**< Vocoder frame, a power of two in [kPitchMinFrame, kPitchMaxFrame] (2048 at 44.1 kHz). */
+};
+
+/**
+ * @brief Parameter container for the PitchShift effect.
+ *
+ * Holds the vocoder setup (window, FFT plan), shared by every state created from it.
+ *
+ * @see AJ::dsp::EffectParams
+ */
+class PitchParams : public EffectParams {
+    struct PrivateTag {};
+
+    std::shared_ptr<const VocoderSetup> mSetup; ///< frame layout and tables.
+    float mSemitones = 0.0f;                    ///< shift in semitones.
+
+public:
+    /**
+     * @brief Factory method to create a PitchParams instance.
+     *
+     * Validation rules:
+     * - `mSemitones` in [-kPitchMaxSemitones, kPitchMaxSemitones].
+     * - `mFrameSize` a power of two in [kPitchMinFrame, kPitchMaxFrame].
+     *
+     * @return Shared pointer to a valid PitchParams instance if parameters are valid,
+     *         otherwise nullptr.
+     */
+    static std::shared_ptr<PitchParams> create(Params &params, AJ::error::IErrorHandler &handler);
+
+    /// @brief Frame layout and tables of the vocoder.
+    const std::shared_ptr<const VocoderSetup>& Setup() const noexcept { return mSetup; }
+
+    /// @brief Shift in semitones.
+    float Semitones() const noexcept { return mSemitones; }
+
+    /// @brief Frequency ratio, 2^(semitones / 12).
+    float Ratio() const noexcept { return mSetup->mRatio; }
+
+    /// @brief Frames the block processing output lags its input, one frame.
+    size_t Latency() const noexcept { return mSetup->latency(); }
+
+    ~PitchParams() override = default;
+
+    PitchParams(PrivateTag) {}
+};
+
+/**
+ * @brief Block processing state of the PitchShift effect, one PhaseVocoder per channel.
+ */
+class PitchState : public EffectState {
+public:
+    std::vector<std::unique_ptr<PhaseVocoder>> mVocoders; ///< vocoder of every channel.
+
+    explicit PitchState(uint8_t channels) : EffectState(channels) {}
+
+    void reset() override {
+        EffectState::reset();
+        for(auto &vocoder : mVocoders){
+            vocoder->reset();
+        }
+    }
+};
+
+/**
+ * @brief Phase vocoder pitch shift: the pitch of [Start, End] changes, its duration doesn't.
+ *
+ * Every hop (frame / kPitchOversampling) a Hann windowed frame is analysed into magnitudes and
+ * true bin frequencies, the bins are moved by the frequency ratio and resynthesized with
+ * accumulated phases (see PhaseVocoder). The phase unwrapping and resynthesis loops run in the
+ * SIMD `phaseAnalyze` / `phaseSynthesize` kernels.
+ *
+ * - process() compensates the vocoder latency: the output is aligned with the input. Ranges longer
+ *   than kPitchSegmentFrames are cut into segments rendered independently (with a frame of
+ *   warm-up) and stitched by frame-long linear crossfades, on the thread pool if one is set.
+ *   The segmentation only depends on the range, so the output is the same with or without a pool.
+ * - processBlock() streams: the output lags the input by `Latency()` frames, and the range starts
+ *   with that much silence. Like every ranged effect the result stops at End.
+ *
+ * Larger frames resolve low notes better, smaller ones smear transients less.
+ */
+class PitchShift : public AJ::dsp::Effect {
+    std::shared_ptr<PitchParams> mParams;
+    std::shared_ptr<utils::ThreadPool> pThreadPool; ///< optional pool rendering the segments of process().
+
+public:
+    PitchShift() {
+        mParams = nullptr;
+    }
+
+    /**
+     * @brief Render the segments of long ranges on a thread pool.
+     * @param pool thread pool (e.g. EngineResources::threadPool()), nullptr to run on the caller thread.
+     */
+    void setThreadPool(std::shared_ptr<utils::ThreadPool> pool) override {
+        pThreadPool = std::move(pool);
+    }
+
+    /**
+     * @brief Shift the pitch of [Start, End] of a single-channel buffer in-place, latency compensated.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief The stream lags by `Latency()` frames where process() compensates it.
+     */
+    bool blockMatchesProcess() const override {
+        return false;
+    }
+
+    /**
+     * @brief Create a PitchState, one vocoder per channel.
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Shift one block of interleaved frames, in-place (the output lags by `Latency()` frames).
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Set effect parameters from a shared EffectParams object (must be PitchParams).
+     */
+    bool setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler) override;
+};
+
+}
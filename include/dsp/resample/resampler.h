@@ -0,0 +1,147 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+
+namespace AJ::dsp::resample {
+
+/**
+ * @brief Windowed-sinc polyphase filter converting `InRate()` to `OutRate()`.
+ *
+ * The ratio is reduced to Up / Down (out / in over their gcd). Output n sits at input time
+ * n·Down / Up = i + p / Up: it is the dot product of the `Taps()` inputs around i with row p of
+ * the bank, a Kaiser windowed sinc sampled at that fractional offset. The cutoff is
+ * kResampleRolloff of the lower Nyquist frequency, so downsampling widens the sinc by Down / Up.
+ * Every row sums to 1 (unity gain at DC).
+ *
+ * Filters are shared: get them from filter(), which computes the bank once per pair of rates.
+ * They are never modified afterwards, so one filter serves every thread.
+ */
+class Filter {
+    struct PrivateTag {};
+
+    uint32_t mInRate;  ///< input samplerate.
+    uint32_t mOutRate; ///< output samplerate.
+    size_t mUp;        ///< phases, out / gcd.
+    size_t mDown;      ///< input step per output in phases, in / gcd.
+    size_t mTaps;      ///< coefficients per phase.
+    Float mBank;       ///< mUp rows of mTaps coefficients.
+
+public:
+    /// @brief Use filter(), the constructor computes the bank.
+    Filter(PrivateTag, uint32_t inRate, uint32_t outRate, size_t up, size_t down);
+
+    /// @brief Samplerate of the input.
+    uint32_t InRate() const noexcept { return mInRate; }
+
+    /// @brief Samplerate of the output.
+    uint32_t OutRate() const noexcept { return mOutRate; }
+
+    /// @brief Number of phases (output rate over the gcd of the rates).
+    size_t Up() const noexcept { return mUp; }
+
+    /// @brief Input step per output, in phases (input rate over the gcd of the rates).
+    size_t Down() const noexcept { return mDown; }
+
+    /// @brief Coefficients per phase, an even number.
+    size_t Taps() const noexcept { return mTaps; }
+
+    /// @brief Inputs the output depends on past its own time, Taps() / 2 (the latency of a stream).
+    size_t Reach() const noexcept { return mTaps / 2; }
+
+    /// @brief Coefficient rows, Up() rows of Taps() values.
+    const float* Bank() const noexcept { return mBank.data(); }
+
+    /// @brief Output frames of `frames` input frames, ceil(frames · Up / Down).
+    size_t OutputLength(size_t frames) const noexcept;
+
+    friend std::shared_ptr<const Filter> filter(uint32_t inRate, uint32_t outRate, AJ::error::IErrorHandler &handler);
+};
+
+/**
+ * @brief The shared filter converting `inRate` to `outRate`, built on the first request of that pair.
+ *
+ * Thread-safe.
+ *
+ * @return the filter, nullptr (reported, InvalidSampleRate) if a rate is outside
+ *         [kMinSamplerate, kMaxSamplerate] or the reduced ratio needs more than kResampleMaxPhases phases.
+ */
+std::shared_ptr<const Filter> filter(uint32_t inRate, uint32_t outRate, AJ::error::IErrorHandler &handler);
+
+/**
+ * @brief Streaming converter of interleaved frames (recording, playback, block processing).
+ *
+ * Keeps `Taps()` frames of history per channel, so blocks of any size give the same samples as
+ * one offline conversion. The output lags the input by `Reach()` input frames: flush() pushes
+ * the missing silence through and emits the last frames, `OutputLength(consumed)` in total.
+ * Inputs are converted in chunks of kResampleChunkFrames; nothing is allocated after construction.
+ */
+class Resampler {
+    std::shared_ptr<const Filter> pFilter;
+    uint8_t mChannels;
+    std::vector<Float> mHistory; ///< per channel: kept taps, then the chunk being converted.
+    Float mOutput;               ///< outputs of one chunk and channel, before interleaving.
+    size_t mFill = 0;            ///< frames in the history.
+    size_t mNext = 0;            ///< history frame of the first tap of the next output.
+    size_t mPhase = 0;           ///< phase of the next output.
+    uint64_t mConsumed = 0;      ///< input frames since reset().
+    uint64_t mProduced = 0;      ///< output frames since reset().
+
+    size_t generate(float *out, size_t limit);
+
+public:
+    /**
+     * @param filter shared filter (see filter()).
+     * @param channels interleaved channels, 1 to kNumChannels.
+     */
+    Resampler(std::shared_ptr<const Filter> filter, uint8_t channels);
+
+    /**
+     * @brief Create a resampler from `inRate` to `outRate`.
+     * @return the resampler, nullptr (reported) if the rates or the channel count are invalid.
+     */
+    static std::unique_ptr<Resampler> create(uint32_t inRate, uint32_t outRate, uint8_t channels,
+        AJ::error::IErrorHandler &handler);
+
+    /// @brief The filter of the conversion.
+    const Filter& filter() const noexcept { return *pFilter; }
+
+    /// @brief Interleaved channels.
+    uint8_t channels() const noexcept { return mChannels; }
+
+    /// @brief Largest number of frames process() writes for `frames` input frames (flush(): 0).
+    size_t maxOutput(size_t frames) const noexcept;
+
+    /**
+     * @brief Convert `frames` interleaved input frames.
+     * @param out room for maxOutput(frames) interleaved frames.
+     * @return frames written to `out`.
+     */
+    size_t process(const float *in, size_t frames, float *out);
+
+    /**
+     * @brief End of the stream: emit the frames still held back by the filter, then reset().
+     * @param out room for maxOutput(0) interleaved frames.
+     * @return frames written to `out`.
+     */
+    size_t flush(float *out);
+
+    /// @brief Forget the history, the next frame starts a new stream.
+    void reset();
+};
+
+/**
+ * @brief Offline conversion of one channel: `output` is resized to OutputLength(frames) and filled.
+ *
+ * The output is cut into segments of kResampleSegmentFrames, converted on `pool` if one is given.
+ * Every output only depends on the input, so the result is the same with or without a pool,
+ * and equal to a Resampler fed the whole input then flushed (up to float rounding of the edges).
+ * `input` must not point into `output`.
+ */
+void resample(const float *input, size_t frames, Float &output, const Filter &filter, utils::ThreadPool *pool = nullptr);
+
+}
@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include "core/types.h"
+#include "dsp/delay_line.h"
 
 namespace AJ::dsp::reverb {
 
@@ -12,6 +13,9 @@ namespace AJ::dsp::reverb {
  *
  * This filter delays the input signal and feeds it back with a gain to create phase shifting
  * without affecting the amplitude response. It is used in reverb effect.
+ *
+ * The last `mDelay` input and output samples are kept in two circular DelayLines,
+ * so the filter runs in place with memory bounded by its delay.
  */
 class AllPassFilter {
 
@@ -20,6 +24,8 @@ private:
     sample_c mDelay;      ///< Delay in samples
     int mSamplerate;      ///< Audio sample rate (Hz)
     float mGain;          ///< Feedback gain
+    DelayLine mInput;     ///< Last `mDelay` input samples x[n-M].
+    DelayLine mOutput;    ///< Last `mDelay` output samples y[n-M].
 
 public:
 
@@ -36,6 +42,8 @@ public:
         mGain = 0.131f;
         mSamplerate = 44100;
         mDelay = mDelayMS * (float(mSamplerate) / 1000.0f);
+        mInput.resize(mDelay);
+        mOutput.resize(mDelay);
     }
 
     /**
@@ -48,6 +56,8 @@ public:
         mGain = 0.131f;
         mSamplerate = samplerate;
         mDelay = mDelayMS * (float(mSamplerate) / 1000.0f);
+        mInput.resize(mDelay);
+        mOutput.resize(mDelay);
     }
 
     /**
@@ -58,6 +68,8 @@ public:
      */
     void setDelay(float delayMS, const sample_c samplerate){
         mDelay = (float(samplerate) / 1000) * delayMS;
+        mInput.resize(mDelay);
+        mOutput.resize(mDelay);
     }
     
     /**
@@ -81,12 +93,49 @@ public:
     }
 
     /**
-     * @brief Applies the all-pass filter to the input buffer.
-     * 
-     * @param input Audio buffer to be processed.
-     * @return Processed audio buffer.
+     * @brief Delay of the filter in samples.
+     */
+    sample_c delay() const noexcept {
+        return mDelay;
+    }
+
+    /**
+     * @brief Clear the filter memory (start of a new stream).
+     */
+    void reset() noexcept {
+        mInput.clear();
+        mOutput.clear();
+    }
+
+    /**
+     * @brief Applies the all-pass filter to one sample.
+     *
+     * All-pass filter formula: y[n] = -g·x[n] + x[n-M] + g·y[n-M],
+     * the first M samples pass through unchanged.
+     *
+     * @param input The input sample x[n].
+     * @return Processed sample y[n].
+     */
+    sample_t process(sample_t input) noexcept {
+        sample_t out = input;
+
+        if(mInput.primed()){
+            out = (-mGain * input) + mInput.tap() + (mGain * mOutput.tap());
+        }
+
+        mInput.push(input);
+        mOutput.push(out);
+
+        return out;
+    }
+
+    /**
+     * @brief Applies the all-pass filter to a buffer, in place.
+     *
+     * @param data Samples to be processed.
+     * @param size Number of samples.
      */
-    Float process(Float &input);
+    void process(float *data, size_t size) noexcept;
 };
 
 };
@@ -4,6 +4,8 @@
 
 #include "core/types.h"
 #include "core/error_handler.h"
+#include "dsp/delay_line.h"
+#include "dsp/kernels.h"
 
 namespace AJ::dsp::reverb {
 
@@ -11,13 +13,19 @@ namespace AJ::dsp::reverb {
  * @brief A comb filter used in reverb processing.
  * 
  * This filter applies a delay-based feedback loop to simulate echo and coloration of the input signal.
+ *
+ * The past output is kept in a circular DelayLine of `mDelay` samples, so the
+ * memory of the filter is bounded by its delay, not by the processed range.
  */
 class CombFilter {
 private:
     sample_c mDelay;  ///< Delay in samples.
     float mGain;      ///< Feedback gain factor.
+    DelayLine mLine;  ///< Last `mDelay` output samples.
 
 public:
+    CombFilter() : mDelay(0), mGain(REVERB_GAIN) {}
+
     /**
      * @brief Sets the delay of the comb filter.
      * 
@@ -36,6 +44,7 @@ public:
 
         if(delayMS <= 0) {
             mDelay = (REVERB_DELAY / 1000) * samplerate; // 78.9ms 
+            mLine.resize(mDelay);
             return false;
         }
 
@@ -48,6 +57,7 @@ public:
             return false;
         }
 
+        mLine.resize(mDelay);
         return true;
     }
 
@@ -63,19 +73,62 @@ public:
     }
 
     /**
-     * @brief Processes the audio signal with the comb filter effect.
-     * 
-     * This function assumes that all ranges and indexes have been validated beforehand.
-     * No additional checks or error handlers are required when calling it.
-     * 
-     * @param input The input audio buffer.
-     * @param output The output audio buffer.
-     * @param idx Current sample index.
-     * @param start Starting index of processing.
-     * 
-     * @return Processed sample value.
+     * @brief Delay of the filter in samples.
+     */
+    sample_c delay() const noexcept {
+        return mDelay;
+    }
+
+    /**
+     * @brief Clear the filter memory (start of a new stream).
+     */
+    void reset() noexcept {
+        mLine.clear();
+    }
+
+    /**
+     * @brief Processes one sample with the comb filter effect.
+     *
+     * Comb filter formula: y[n] = x[n] + g·y[n-M]
+     *
+     * @param input The input sample x[n].
+     *
+     * @return Processed sample value y[n].
+     */
+    sample_t process(sample_t input) noexcept {
+        sample_t sample = input + mGain * mLine.tap();
+        mLine.push(sample);
+        return sample;
+    }
+
+    /**
+     * @brief Processes `count` samples and adds the filter output to `acc`.
+     *
+     * Same result as `acc[i] += process(in[i])`, the delay line is walked in
+     * contiguous runs so `kernel` can vectorize along time.
+     *
+     * @param in     input samples x[n].
+     * @param acc    accumulator the outputs y[n] are added to.
+     * @param count  number of samples.
+     * @param kernel comb kernel, see kernels::table().
      */
-    sample_t process(Float &input, Float &output, sample_pos idx, sample_pos start);
+    void processAccumulate(const sample_t *in, sample_t *acc, size_t count, kernels::CombFn kernel) noexcept {
+        if(mLine.delay() == 0){
+            for(size_t i = 0; i < count; ++i) acc[i] += in[i];
+            return;
+        }
+
+        while(count > 0){
+            const size_t run = std::min(count, mLine.contiguous());
+
+            kernel(mLine.head(), mGain, in, acc, run);
+            mLine.advance(run);
+
+            in += run;
+            acc += run;
+            count -= run;
+        }
+    }
 };
 
 };
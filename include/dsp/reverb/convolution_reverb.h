@@ -0,0 +1,176 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "dsp/effect.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+#include "dsp/reverb/impulse_response.h"
+#include "dsp/reverb/convolver.h"
+
+namespace AJ::dsp::reverb::convolution {
+
+/**
+ * @brief Container for all convolution reverb parameters.
+ */
+struct Params {
+    sample_pos mStart;       /**< Start position of the reverb in samples (inclusive). */
+    sample_pos mEnd;         /**< End position of the reverb in samples (inclusive). */
+    std::shared_ptr<const ImpulseResponse> mImpulse; /**< Impulse response, 1 channel or one per stream channel. */
+    float mWetMix;           /**< Volume of the convolved signal. */
+    float mDryMix;           /**< Volume of the original signal. */
+    size_t mPartition;       /**< Head partition in frames, a power of two in [kConvolutionMinPartition, kConvolutionMaxPartition]. */
+    size_t mTailPartition;   /**< Tail partition in frames, 0 for a uniform partitioning, else a power of two in (mPartition, kConvolutionMaxPartition]. */
+};
+
+/**
+ * @brief Parameter container for the ConvolutionReverb effect.
+ *
+ * Holds the partitioned impulse response, shared with every other params created
+ * from the same impulse response and partition sizes.
+ *
+ * @see AJ::dsp::EffectParams
+ */
+class ConvolutionParams : public EffectParams {
+    struct PrivateTag {};
+
+    std::shared_ptr<const ImpulseResponse> mImpulse;      ///< the impulse response.
+    std::shared_ptr<const PartitionedImpulse> mPartitions; ///< its partition spectra.
+    float mWetMix = 0.0f;                                  ///< volume of the convolved signal.
+    float mDryMix = 0.0f;                                  ///< volume of the original signal.
+
+public:
+    /**
+     * @brief Factory method to create a ConvolutionParams instance.
+     *
+     * Validation rules:
+     * - an impulse response is required.
+     * - partition sizes as documented in Params.
+     * - mixes in [REVERB_MIX_MIN, REVERB_MIX_MAX].
+     *
+     * The partition spectra are computed here on the first use of a partitioning of the
+     * impulse response (not on the audio thread).
+     *
+     * @return Shared pointer to a valid ConvolutionParams instance if parameters are valid,
+     *         otherwise nullptr.
+     */
+    static std::shared_ptr<ConvolutionParams> create(Params &params, AJ::error::IErrorHandler &handler);
+
+    /// @brief The impulse response.
+    const std::shared_ptr<const ImpulseResponse>& Impulse() const noexcept { return mImpulse; }
+
+    /// @brief Partition spectra of the impulse response.
+    const std::shared_ptr<const PartitionedImpulse>& Partitions() const noexcept { return mPartitions; }
+
+    /// @brief Volume of the convolved signal.
+    float WetMix() const noexcept { return mWetMix; }
+
+    /// @brief Volume of the original signal.
+    float DryMix() const noexcept { return mDryMix; }
+
+    ~ConvolutionParams() override = default;
+
+    ConvolutionParams(PrivateTag) {}
+};
+
+/**
+ * @brief Block processing state of the ConvolutionReverb effect, one Convolver per channel.
+ */
+class ConvolutionState : public EffectState {
+public:
+    std::vector<std::unique_ptr<Convolver>> mConvolvers; ///< convolver of every channel.
+
+    explicit ConvolutionState(uint8_t channels) : EffectState(channels) {}
+
+    void reset() override {
+        EffectState::reset();
+        for(auto &convolver : mConvolvers){
+            convolver->reset();
+        }
+    }
+};
+
+/**
+ * @brief Convolution reverb: the range is convolved with a (recorded) impulse response.
+ *
+ * ### Equation:
+ * @code
+ * y[n] = clamp(dry * x[n] + wet * sum_k h[k] x[n - k], -1, 1)
+ * @endcode
+ *
+ * Runs as a non-uniformly partitioned FFT convolution (see PartitionedImpulse) with no
+ * latency: small head partitions keep the cost of a block low for streaming, the long
+ * tail runs in large partitions, on the thread pool if one is set. A uniform partitioning
+ * (`mTailPartition = 0`) is there for short impulse responses.
+ *
+ * Only [Start, End] is fed into the convolution and the reverb tail stops at End, like
+ * every ranged effect. The head costs `mPartition` multiply-adds per frame for the direct
+ * taps, 128 - 256 (head) and 4096 - 8192 (tail) suit both live streams and offline rendering.
+ */
+class ConvolutionReverb : public AJ::dsp::Effect {
+    std::shared_ptr<ConvolutionParams> mParams;
+    std::shared_ptr<utils::ThreadPool> pThreadPool; ///< optional pool running the tail partitions.
+    RenderQuality mQuality = RenderQuality::Full;    ///< Preview drops the tail partitions.
+
+public:
+    ConvolutionReverb() {
+        mParams = nullptr;
+    }
+
+    /**
+     * @brief Run the tail partitions on a thread pool.
+     * @param pool thread pool (e.g. EngineResources::threadPool()), nullptr to run them on the caller thread.
+     */
+    void setThreadPool(std::shared_ptr<utils::ThreadPool> pool) override {
+        pThreadPool = std::move(pool);
+    }
+
+    /**
+     * @brief At RenderQuality::Preview the reverb is cut after the head partitions (2 · mTailPartition
+     * frames), so the long tail partitions, most of the cost, don't run.
+     *
+     * Streams take the quality when their state is created (createState()).
+     */
+    void setQuality(RenderQuality quality) override {
+        mQuality = quality;
+    }
+
+    /**
+     * @brief Apply the reverb to [Start, End] of a single-channel buffer in-place (channel 0 of the impulse response).
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief Create a ConvolutionState, one convolver per channel.
+     *
+     * The impulse response must have one channel (used for every channel) or `channels` channels.
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Apply the reverb to one block of interleaved frames, in-place.
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Set effect parameters from a shared EffectParams object (must be ConvolutionParams).
+     */
+    bool setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler) override;
+};
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include "core/types.h"
+#include "core/thread_pool.h"
+#include "dsp/reverb/impulse_response.h"
+
+namespace AJ::dsp::reverb::convolution {
+
+/**
+ * @class Convolver
+ * @brief Streaming partitioned convolution of one channel with one channel of a PartitionedImpulse.
+ *
+ * Frames go in `partition` frames at a time (any call size is split at the block boundaries):
+ * - direct taps: `mulAdd` of the current block and the last `partition` inputs, no latency.
+ * - head: at every block boundary, FFT of the last 2 blocks into the frequency-domain delay
+ *   line, complex multiply-accumulate (`complexMulAdd`) with the head partitions, inverse FFT.
+ *   The result is the head output of the next block.
+ * - tail: the same every `tailPartition` frames on the tail partitions. The job gets a copy
+ *   of its input and has a whole tail block to finish, on the thread pool if there is one.
+ *
+ * The output only depends on the frames fed in, not on the call sizes or the pool.
+ */
+class Convolver {
+    std::shared_ptr<const PartitionedImpulse> pImpulse;  ///< keeps the partitions alive.
+    const PartitionedChannel *pChannel;                  ///< channel of pImpulse used.
+
+    size_t mTaps;            ///< direct taps (partition, or the impulse length if shorter).
+    bool mUseTail;           ///< run the tail partitions, false cuts the impulse at mHeadEnd.
+    size_t mBlockPos = 0;    ///< frames of the current head block.
+    Float mInput;            ///< [previous block | current block], 2 * partition.
+    Float mHeadOut;          ///< head output of the current block.
+    Float mHeadLine;         ///< frequency-domain delay line, one spectrum per head partition.
+    size_t mHeadSlot = 0;    ///< slot of the next head spectrum.
+    Float mSpectrum;         ///< head accumulator (re | im).
+    Float mTime;             ///< head inverse FFT output, 2 * partition.
+    Float mWet;              ///< convolution output of the current step.
+
+    size_t mTailPos = 0;                ///< frames of the current tail block.
+    Float mTailInput;                   ///< [previous | current] tail block, 2 * tailPartition.
+    Float mTailJobInput;                ///< copy of mTailInput the running job works on.
+    Float mTailLine;                    ///< tail frequency-domain delay line.
+    size_t mTailSlot = 0;               ///< slot of the next tail spectrum.
+    Float mTailSpectrum;                ///< tail accumulator (re | im).
+    Float mTailTime;                    ///< tail inverse FFT output, 2 * tailPartition.
+    std::array<Float, 2> mTailOut;      ///< tail outputs: the one read now and the one being computed.
+    size_t mTailActive = 0;             ///< mTailOut read by the current tail block.
+    bool mTailPending = false;          ///< a tail job was started and not waited for.
+    std::atomic<bool> mTailDone{true};  ///< set by the job when its output is written.
+    utils::ThreadPool *pTailPool = nullptr; ///< pool running the pending job (nullptr if it ran inline).
+
+    /// @brief Block boundary of the head: FFT, multiply-accumulate, inverse FFT, shift the input.
+    void headBlock();
+
+    /// @brief Block boundary of the tail: wait for the previous job, start the next one.
+    void tailBlock(utils::ThreadPool *pool);
+
+    /// @brief Tail job: spectrum of mTailJobInput, multiply-accumulate, output into `out`.
+    void runTail(float *out);
+
+    /// @brief Wait for the pending tail job and make its output the active one.
+    void waitTail();
+
+public:
+    /**
+     * @brief Convolver of channel `channel` of `impulse`, silent history.
+     *
+     * Without `tail` only the direct taps and the head run: the reverb stops at `mHeadEnd`
+     * frames, for previews (RenderQuality::Preview).
+     */
+    Convolver(std::shared_ptr<const PartitionedImpulse> impulse, uint8_t channel, bool tail = true);
+
+    ~Convolver() {
+        waitTail();
+    }
+
+    Convolver(const Convolver&) = delete;
+    Convolver& operator=(const Convolver&) = delete;
+
+    /// @brief Partitions the convolver uses.
+    const std::shared_ptr<const PartitionedImpulse>& impulse() const noexcept {
+        return pImpulse;
+    }
+
+    /**
+     * @brief `x = clamp(dry * x + wet * (h * x), -1, 1)` for `frames` frames of `data`, in place.
+     *
+     * @param data   first sample, consecutive frames `stride` floats apart.
+     * @param pool   pool for the tail jobs, nullptr to run them inline.
+     */
+    void process(float *data, size_t frames, uint8_t stride, float wet, float dry, utils::ThreadPool *pool);
+
+    /**
+     * @brief Forget the input history (waits for a running tail job).
+     */
+    void reset();
+};
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/error_handler.h"
+#include "dsp/fft.h"
+
+namespace AJ::dsp::reverb::convolution {
+
+/**
+ * @brief Spectra of the uniform partitions of one segment of an impulse response.
+ *
+ * Partition `p` holds `bins` real parts at `data + p * mStride` and `bins` imaginary parts
+ * at `data + p * mStride + mStride / 2` (both kBufferAlignment aligned).
+ */
+struct PartitionSpectra {
+    size_t mCount = 0;   ///< number of partitions.
+    size_t mStride = 0;  ///< floats from one partition to the next.
+    Float mData;         ///< spectra, already scaled by 1 / FFT size.
+
+    const float* re(size_t p) const noexcept { return mData.data() + p * mStride; }
+    const float* im(size_t p) const noexcept { return mData.data() + p * mStride + mStride / 2; }
+};
+
+/**
+ * @brief One channel of a PartitionedImpulse.
+ */
+struct PartitionedChannel {
+    Float mDirect;           ///< taps [0, partition), convolved in the time domain (no latency).
+    PartitionSpectra mHead;  ///< taps [partition, headEnd) in partitions of `partition` frames.
+    PartitionSpectra mTail;  ///< taps [headEnd, frames) in partitions of `tailPartition` frames.
+};
+
+/**
+ * @brief Impulse response split for the non-uniformly partitioned convolution.
+ *
+ * - The first `mPartition` taps are applied directly, so the convolution has no latency.
+ * - The head, up to `mHeadEnd`, runs as uniformly partitioned overlap-save with FFTs of
+ *   2 * `mPartition` points, one block per `mPartition` frames.
+ * - The tail, from `mHeadEnd` = 2 * `mTailPartition`, uses FFTs of 2 * `mTailPartition`
+ *   points. Its output is due one tail block after its input is complete, so it can run
+ *   on a thread pool while the head keeps going.
+ *
+ * Built once per (partition, tail partition) by ImpulseResponse::partitions() and shared
+ * read-only by every convolver using it.
+ */
+struct PartitionedImpulse {
+    size_t mPartition;        ///< head partition (frames).
+    size_t mTailPartition;    ///< tail partition (frames), 0 if there's no tail.
+    size_t mHeadEnd;          ///< first tap of the tail (= frames without a tail).
+    size_t mFrames;           ///< length of the impulse response.
+    std::shared_ptr<const fft::Plan> mHeadFFT; ///< 2 * mPartition point FFT.
+    std::shared_ptr<const fft::Plan> mTailFFT; ///< 2 * mTailPartition point FFT, nullptr without a tail.
+    std::vector<PartitionedChannel> mChannels;
+
+    PartitionedImpulse(const std::vector<Float> &impulse, size_t partition, size_t tailPartition);
+};
+
+/**
+ * @class ImpulseResponse
+ * @brief Impulse response of the convolution reverb, one or more channels of equal length.
+ *
+ * The partition spectra are computed on the first request for a partitioning and
+ * cached, so params (and effects) created from the same impulse response share them.
+ *
+ * ### Example:
+ * @code
+ * auto ir = AJ::dsp::reverb::convolution::ImpulseResponse::create({ left, right }, handler);
+ * @endcode
+ */
+class ImpulseResponse {
+    struct PrivateTag {};
+
+    std::vector<Float> mChannels;  ///< taps of every channel.
+
+    mutable std::mutex mMux;       ///< guards mCache.
+    mutable std::vector<std::shared_ptr<const PartitionedImpulse>> mCache;
+
+public:
+    /**
+     * @brief Create an impulse response from its channels.
+     *
+     * Validation rules:
+     * - 1 to kNumChannels channels, all of the same length.
+     * - 1 to kConvolutionMaxImpulseFrames frames.
+     *
+     * @return the impulse response, nullptr (reported) if the channels are invalid.
+     */
+    static std::shared_ptr<ImpulseResponse> create(std::vector<Float> channels, AJ::error::IErrorHandler &handler);
+
+    /// @brief Number of channels.
+    uint8_t channels() const noexcept { return static_cast<uint8_t>(mChannels.size()); }
+
+    /// @brief Length in frames.
+    size_t frames() const noexcept { return mChannels[0].size(); }
+
+    /// @brief Taps of channel `ch`.
+    const Float& channel(uint8_t ch) const noexcept { return mChannels[ch]; }
+
+    /**
+     * @brief Spectra of the partitioning (computed on the first call, then cached).
+     *
+     * @param partition     head partition, a power of two in [kConvolutionMinPartition, kConvolutionMaxPartition].
+     * @param tailPartition 0 for a uniform partitioning, or a power of two in (partition, kConvolutionMaxPartition].
+     * @pre the sizes are valid (see ConvolutionParams::create()).
+     */
+    std::shared_ptr<const PartitionedImpulse> partitions(size_t partition, size_t tailPartition) const;
+
+    ImpulseResponse(PrivateTag, std::vector<Float> channels) : mChannels(std::move(channels)) {}
+};
+
+}
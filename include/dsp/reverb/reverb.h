@@ -3,8 +3,12 @@
 #include <iostream>
 #include <memory>
 #include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
 
 #include "dsp/effect.h"
+#include "dsp/automation.h"
 #include "core/types.h"
 #include "dsp/reverb/all_pass_filter.h"
 #include "dsp/reverb/comb_filter.h"
@@ -143,10 +147,36 @@ public:
 };
 
 /// Type alias for the comb filter array used in the reverb.
-using CombFilters = std::array<std::unique_ptr<CombFilter>, kCombFilters>;
+using CombFilters = std::array<CombFilter, kCombFilters>;
 
 /// Type alias for the all-pass filter array used in the reverb.
-using AllPassFilters = std::array<std::unique_ptr<AllPassFilter>, kAllPassFilters>;
+using AllPassFilters = std::array<AllPassFilter, kAllPassFilters>;
+
+/**
+ * @brief Block processing state of the Reverb effect.
+ *
+ * One set of comb and all-pass filters (with their delay lines) per channel.
+ */
+class ReverbState : public EffectState {
+public:
+    std::vector<CombFilters> mCombFilters;       ///< comb filters of every channel.
+    std::vector<AllPassFilters> mAllPassFilters; ///< all-pass filters of every channel.
+
+    explicit ReverbState(uint8_t channels) : EffectState(channels),
+        mCombFilters(channels), mAllPassFilters(channels) {}
+
+    void reset() override {
+        EffectState::reset();
+
+        for(auto &combs : mCombFilters){
+            for(auto &comb : combs) comb.reset();
+        }
+
+        for(auto &allPass : mAllPassFilters){
+            for(auto &filter : allPass) filter.reset();
+        }
+    }
+};
 
 /**
  * @brief Reverb effect implementation.
@@ -160,6 +190,16 @@ private:
     std::shared_ptr<ReverbParams> mParams;     /**< Parameters for the reverb effect. */
     CombFilters mCombFilters;                  /**< Array of comb filters used to simulate echo buildup. */
     AllPassFilters mAllPassFilters;            /**< Array of all-pass filters used to smooth echo tails. */
+    std::shared_ptr<const Automation> mWetAutomation; /**< Wet mix curve, nullptr for the constant WetMix(). */
+    std::shared_ptr<const Automation> mDryAutomation; /**< Dry mix curve, nullptr for the constant DryMix(). */
+
+    /**
+     * @brief Render the wet / dry curves of `count` frames from `frame` (kReverbChunkFrames at most).
+     *
+     * @return the curves, nullptr for a mix that isn't automated.
+     */
+    std::pair<const float*, const float*> renderMix(sample_pos frame, size_t count,
+        float *wet, float *dry) const;
 
     /**
      * @brief Validates the processing range indexes.
@@ -171,16 +211,23 @@ private:
      */
     bool checkValidIndxes(Float &buffer, AJ::error::IErrorHandler &handler);
 
+    /**
+     * @brief Set delays and gains of a set of filters from the parameters and clear their memory.
+     *
+     * @param combs   comb filters to configure.
+     * @param allPass all-pass filters to configure.
+     * @param size    size of the processed range (comb delays must be shorter).
+     * @param handler Error handler for reporting invalid delays.
+     */
+    void configureFilters(CombFilters &combs, AllPassFilters &allPass, sample_c size,
+        AJ::error::IErrorHandler &handler);
+
 public:
     /**
      * @brief Default constructor initializing filters and default parameters.
      */
     Reverb(){
         mParams = nullptr;
-
-        for (auto &comb : mCombFilters) {
-            comb = std::make_unique<CombFilter>();
-        }
     }
 
     /**
@@ -201,6 +248,20 @@ public:
      */
     void setWetMix(float val) { mParams->setWetMix(val); }
 
+    /**
+     * @brief Follow wet / dry mix curves instead of the constant mixes.
+     *
+     * The lane frames are buffer samples for process() and stream frames for processBlock().
+     * The curves are shared, not copied: don't edit them while the effect runs.
+     *
+     * @param wet wet mix curve, nullptr (or empty) for the constant WetMix().
+     * @param dry dry mix curve, nullptr (or empty) for the constant DryMix().
+     */
+    void setMixAutomation(std::shared_ptr<const Automation> wet, std::shared_ptr<const Automation> dry = nullptr) {
+        mWetAutomation = std::move(wet);
+        mDryAutomation = std::move(dry);
+    }
+
     /**
      * @brief Sets the reverb gain (feedback strength).
      * @param val New gain value.
@@ -215,7 +276,7 @@ public:
         mParams->setSamplerate(val); 
 
         for (auto &all_pass : mAllPassFilters) {
-            all_pass = std::make_unique<AllPassFilter>(mParams->Samplerate());
+            all_pass = AllPassFilter(mParams->Samplerate());
         }
     }
 
@@ -279,11 +340,47 @@ public:
     
     /**
      * @brief Processes the audio buffer with reverb.
+     *
+     * Runs in place, the only memory used are the filters delay lines
+     * (bounded by the longest delay, not by the range length).
+     *
      * @param buffer Audio buffer to modify.
      * @param handler Error handler for reporting runtime issues.
      * @return true if processing succeeded.
      */
     bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief This effect supports block processing.
+     */
+    bool supportsBlockProcessing() const override {
+        return true;
+    }
+
+    /**
+     * @brief Create a ReverbState with one set of filters per channel.
+     *
+     * @param channels number of interleaved channels of the stream.
+     * @param handler  Error handler (parameters not set).
+     * @return the new state, or nullptr on failure.
+     */
+    std::unique_ptr<EffectState> createState(uint8_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Apply the reverb to one block of interleaved frames, in-place.
+     *
+     * [Start, End] is interpreted as a range of stream frames, frames outside of it are left unchanged.
+     *
+     * @param data     interleaved samples, `frames * channels` floats.
+     * @param frames   number of frames in the block.
+     * @param channels number of interleaved channels (must match the state).
+     * @param state    ReverbState created by createState().
+     * @param handler  Error handler for reporting processing issues.
+     *
+     * @return true on success, false on failure.
+     */
+    bool processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+        AJ::error::IErrorHandler &handler) override;
 };
 
 }; // namespace AJ::dsp::reverb
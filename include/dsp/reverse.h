@@ -65,7 +65,11 @@ public:
  *
  * @details
  * Reverses only the selected region [start, end] of the buffer; samples outside
- * the selection remain unchanged. The operation is performed in-place.
+ * the selection remain unchanged. The operation is performed in-place, with the `reverse`
+ * kernel (a vector from each end, permuted in the register and stored at the other end).
+ *
+ * To play a range backwards without moving it, see play::AudioFileSource and
+ * FileStreamer::setReadReversed().
  *
  * @par Usage
  * 1) Build @ref ReverseParams via @ref ReverseParams::create.
@@ -74,6 +78,14 @@ public:
  */
 class Reverse : public AJ::dsp::Effect {
     std::shared_ptr<ReverseParams> mParams;
+
+    /**
+     * @brief Validate the parameters and [Start, End] against the buffer.
+     *
+     * @return false (and reports the error) if the parameters are missing or the range is out of the buffer.
+     */
+    bool checkRange(const Float &buffer, AJ::error::IErrorHandler &handler);
+
 public:
     /**
      * @brief Set validated parameters for processing.
@@ -98,6 +110,30 @@ public:
      */
     bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
 
+    /**
+     * @brief Reverse the selected range of the first `channels` channels in one pass.
+     *
+     * The range is checked once for all the channels, then the `reverse` kernel swaps
+     * kChainBlockFrames pairs of every channel in turn, from both ends towards the middle.
+     */
+    bool process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Frame i only trades places with its mirror, End - (i - Start).
+     */
+    bool splitsRange() const override {
+        return true;
+    }
+
+    /**
+     * @brief Swap the mirrored pairs of the piece [first, last) of the range.
+     *
+     * A frame is swapped by the piece its pair index falls in: [first / 2, last / 2) of the
+     * (End - Start + 1) / 2 pairs. Pieces of a partition swap every pair once, each with
+     * half as many pairs as frames.
+     */
+    bool processRange(Float &buffer, size_t first, size_t last, AJ::error::IErrorHandler &handler) override;
+
     /**
      * @brief Override the selection range (inclusive).
      *
@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+
+namespace AJ::dsp::silence {
+
+/**
+ * @brief A silent stretch of frames [mStart, mEnd] (inclusive).
+ */
+struct Region {
+    sample_pos mStart;
+    sample_pos mEnd;
+
+    size_t frames() const noexcept {
+        return static_cast<size_t>(mEnd - mStart + 1);
+    }
+};
+
+/**
+ * @brief Streaming detector of the stretches where every channel stays at or under a level.
+ *
+ * The frames are fed in order, a chunk at a time. Instead of testing every frame, the scanner
+ * jumps with the `findAbove` / `findLastAbove` kernels:
+ * - from a silent frame, to the next frame over the threshold on any channel;
+ * - from a loud frame, over windows of `minFrames` frames: while a window holds a loud frame,
+ *   the next window starts after the last one. A window without any starts a silent run.
+ * Gaps shorter than `minFrames` are never reported, so loud material costs one vector
+ * scan per window and silence one per region.
+ *
+ * Frames known to be silent (e.g. quiet blocks of a level index) are skipped with feedSilent().
+ */
+class Scanner {
+    float mThreshold;
+    size_t mMinFrames;
+
+    sample_pos mPosition = 0; ///< frames fed.
+    sample_pos mRunStart = 0; ///< first frame of the current silent run (== mPosition when loud).
+    std::vector<Region> mRegions;
+
+    /// @brief Report the run from mRunStart to `end` (exclusive) if it's long enough.
+    void close(sample_pos end);
+
+public:
+    /**
+     * @param threshold linear level, a frame is silent when |x| <= threshold on every channel.
+     * @param minFrames shortest silence reported, at least 1.
+     */
+    Scanner(float threshold, size_t minFrames);
+
+    /**
+     * @brief Scan the next `frames` frames.
+     *
+     * @param channels one pointer per channel, `frames` samples each.
+     * @param count    number of channels.
+     */
+    void feed(const float *const *channels, size_t count, size_t frames);
+
+    /**
+     * @brief The next `frames` frames are silent, they're not read.
+     */
+    void feedSilent(size_t frames) noexcept {
+        mPosition += static_cast<sample_pos>(frames);
+    }
+
+    /// @brief Frames fed so far.
+    sample_pos position() const noexcept {
+        return mPosition;
+    }
+
+    /**
+     * @brief Close the last run at the end of the fed frames.
+     * @return the silent regions, in order.
+     */
+    std::vector<Region> finish();
+};
+
+/**
+ * @brief Silent regions of planar channels, see Scanner.
+ */
+std::vector<Region> detect(const float *const *channels, size_t count, size_t frames, float threshold, size_t minFrames);
+
+}
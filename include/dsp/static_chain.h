@@ -0,0 +1,378 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "dsp/gain.h"
+#include "dsp/fade.h"
+#include "dsp/distortion.h"
+#include "dsp/kernels.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/error_handler.h"
+
+namespace AJ::dsp {
+
+namespace stage_detail {
+
+/**
+ * @brief Same Padé approximations as kernels::tanhApprox(), inline so they fuse with the other stages.
+ *
+ * kernels::tanhApprox() itself stays out of line: an inline function shared with the ISA
+ * translation units could be linked in its AVX-512 build.
+ */
+template<kernels::TanhApprox Approx>
+inline float tanhPade(float x) noexcept {
+    if constexpr (Approx == kernels::TanhApprox::Fast){
+        x = std::clamp(x, -3.0f, 3.0f);
+        const float x2 = x * x;
+        return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+    } else {
+        x = std::clamp(x, -4.97f, 4.97f);
+        const float x2 = x * x;
+        return x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)))
+            / (135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f)));
+    }
+}
+
+}
+
+/**
+ * @brief Range [Start, End] (frames, inclusive) of a StaticChain stage.
+ */
+struct StageRange {
+    sample_pos mStart = 0;
+    sample_pos mEnd = -1;
+
+    /// @brief Whether every frame in [position, position + frames) is inside the range.
+    bool covers(sample_pos position, size_t frames) const noexcept {
+        return position >= mStart && position + static_cast<sample_pos>(frames) - 1 <= mEnd;
+    }
+
+    /// @brief Block relative [first, last) frames of the block inside the range, false if none.
+    bool intersect(sample_pos position, size_t frames, size_t &first, size_t &last) const noexcept {
+        const sample_pos blockEnd = position + static_cast<sample_pos>(frames) - 1;
+
+        if(frames == 0 || blockEnd < mStart || position > mEnd){
+            return false;
+        }
+
+        first = static_cast<size_t>(std::max(mStart, position) - position);
+        last = static_cast<size_t>(std::min(mEnd, blockEnd) - position) + 1;
+        return true;
+    }
+};
+
+/**
+ * @brief StaticChain stage of gain::Gain, `clamp(x * gain, -1, 1)`.
+ */
+struct GainStage : StageRange {
+    using Params = gain::GainParams;
+
+    float mGain = 1.0f;
+
+    bool configure(Params &params, AJ::error::IErrorHandler &) {
+        mStart = params.Start();
+        mEnd = params.End();
+        mGain = params.Gain();
+        return true;
+    }
+
+    float apply(float x, sample_pos) const noexcept {
+        return std::clamp(x * mGain, -1.0f, 1.0f);
+    }
+};
+
+/**
+ * @brief StaticChain stage of fade::Fade, the same linear ramp derived from the frame position.
+ */
+struct FadeStage : StageRange {
+    using Params = fade::FadeParams;
+
+    double mBaseGain = 0.0;
+    double mGainStep = 0.0;
+
+    bool configure(Params &params, AJ::error::IErrorHandler &) {
+        mStart = params.Start();
+        mEnd = params.End();
+
+        float gainDiff = params.highGain() - params.lowGain();
+        sample_c totalSamples = params.End() - params.Start() + 1;
+        mGainStep = gainDiff / totalSamples;
+        mBaseGain = params.lowGain();
+
+        if(params.mode() == fade::FadeMode::Out){
+            mBaseGain = params.highGain();
+            mGainStep *= -1;
+        }
+
+        return true;
+    }
+
+    float apply(float x, sample_pos frame) const noexcept {
+        const float gain = static_cast<float>(mBaseGain + mGainStep * (frame - mStart));
+        return std::clamp(x * gain, -1.0f, 1.0f);
+    }
+};
+
+/**
+ * @brief StaticChain stage of distortion::Distortion with the curve fixed at compile time.
+ *
+ * The parameters must have the same type (and, for the tanh curves, the same precision).
+ */
+template<distortion::DistortionType Type,
+    distortion::DistortionPrecision Precision = distortion::DistortionPrecision::Accurate>
+struct DistortionStage : StageRange {
+    using Params = distortion::DistortionParams;
+
+    static constexpr bool kTanh = Type == distortion::DistortionType::SoftClipping
+        || Type == distortion::DistortionType::Asymmetric;
+
+    float mDrive = 1.0f;
+    float mDriveNeg = 1.0f;
+    float mMakeup = 1.0f;
+    float mMakeupNeg = 1.0f;
+
+    bool configure(Params &params, AJ::error::IErrorHandler &handler) {
+        if(params.Type() != Type || (kTanh && params.Precision() != Precision)){
+            const std::string message = "distortion parameters don't match the type / precision of the chain stage.\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return false;
+        }
+
+        mStart = params.Start();
+        mEnd = params.End();
+        mDrive = params.Gain();
+        mDriveNeg = Type == distortion::DistortionType::Asymmetric ?
+            mDrive * DISTORTION_ASYMMETRIC_DRIVE : mDrive;
+
+        if constexpr (kTanh){
+            mMakeup = 1 / tanh(mDrive);
+            mMakeupNeg = 1 / tanh(mDriveNeg);
+        }
+
+        return true;
+    }
+
+    float apply(float x, sample_pos) const noexcept {
+        if constexpr (Type == distortion::DistortionType::HardClipping){
+            return std::clamp(x * mDrive, -1.0f, 1.0f);
+        } else if constexpr (Type == distortion::DistortionType::Cubic){
+            const float u = std::clamp(x * mDrive, -1.0f, 1.0f);
+            return 1.5f * u - 0.5f * u * u * u;
+        } else {
+            const bool positive = x >= 0.0f;
+            return tanh(x * (positive ? mDrive : mDriveNeg)) * (positive ? mMakeup : mMakeupNeg);
+        }
+    }
+
+private:
+    static float tanh(float x) noexcept {
+        if constexpr (Precision == distortion::DistortionPrecision::Exact){
+            return std::tanh(x);
+        } else if constexpr (Precision == distortion::DistortionPrecision::Fast){
+            return stage_detail::tanhPade<kernels::TanhApprox::Fast>(x);
+        } else {
+            return stage_detail::tanhPade<kernels::TanhApprox::Accurate>(x);
+        }
+    }
+};
+
+/**
+ * @brief Chain of stages known at compile time, fused into one loop over the samples.
+ *
+ * EffectChain calls every effect through `Effect::process` and its parameters through a
+ * `shared_ptr`. For a fixed preset the stages are template arguments instead: setParams()
+ * copies the values each stage needs, and every block that all stages fully cover runs
+ * as one loop `x = stageN(... stage1(stage0(x)))` the compiler can inline and vectorize.
+ * A block a stage only partly covers runs stage after stage on the covered frames,
+ * which gives the same result.
+ *
+ * A stage is a StageRange with:
+ * - `using Params`: its EffectParams class,
+ * - `bool configure(Params&, IErrorHandler&)`,
+ * - `float apply(float x, sample_pos frame) const`: the stage applied to a sample of `frame`.
+ *
+ * ### Example:
+ * @code
+ * AJ::dsp::StaticChain<AJ::dsp::GainStage, AJ::dsp::FadeStage,
+ *     AJ::dsp::DistortionStage<AJ::dsp::distortion::DistortionType::Cubic>> preset;
+ *
+ * preset.setParams(handler, gainParams, fadeParams, distortionParams);
+ * preset.process(buffer, handler);
+ * @endcode
+ *
+ * @tparam Channels    channels of the interleaved blocks of processInterleaved().
+ * @tparam BlockFrames frames per block.
+ */
+template<uint8_t Channels, size_t BlockFrames, typename... Stages>
+class BasicStaticChain {
+    static_assert(sizeof...(Stages) > 0, "a static chain needs at least one stage");
+    static_assert(Channels >= 1 && Channels <= kNumChannels, "invalid channel count");
+    static_assert(BlockFrames > 0, "invalid block size");
+
+    std::tuple<Stages...> mStages;
+    bool mConfigured = false;
+
+    using Indices = std::index_sequence_for<Stages...>;
+
+    template<typename Stage>
+    static bool configureStage(Stage &stage, const std::shared_ptr<typename Stage::Params> &params,
+        AJ::error::IErrorHandler &handler) {
+        if(!params){
+            const std::string message = "static chain stage parameters cannot be NULL.\n";
+            handler.onError(error::Error::EffectNotInitialized, message);
+            return false;
+        }
+
+        return stage.configure(*params, handler);
+    }
+
+    /// @brief Run the covered frames of one block through one stage.
+    template<uint8_t Stride, typename Stage>
+    static void runStage(const Stage &stage, float *data, size_t frames, sample_pos position) noexcept {
+        size_t first, last;
+        if(!stage.intersect(position, frames, first, last)){
+            return;
+        }
+
+        for(size_t f = first; f < last; ++f){
+            const sample_pos frame = position + static_cast<sample_pos>(f);
+
+            for(uint8_t ch = 0; ch < Stride; ++ch){
+                data[f * Stride + ch] = stage.apply(data[f * Stride + ch], frame);
+            }
+        }
+    }
+
+    /// @brief Process one block of `frames` (<= BlockFrames) frames of `Stride` interleaved channels.
+    template<uint8_t Stride, size_t... I>
+    void runBlock(float *data, size_t frames, sample_pos position, std::index_sequence<I...>) const noexcept {
+        if((std::get<I>(mStages).covers(position, frames) && ...)){
+            for(size_t f = 0; f < frames; ++f){
+                const sample_pos frame = position + static_cast<sample_pos>(f);
+
+                for(uint8_t ch = 0; ch < Stride; ++ch){
+                    float x = data[f * Stride + ch];
+                    ((x = std::get<I>(mStages).apply(x, frame)), ...);
+                    data[f * Stride + ch] = x;
+                }
+            }
+            return;
+        }
+
+        (runStage<Stride>(std::get<I>(mStages), data, frames, position), ...);
+    }
+
+    template<uint8_t Stride>
+    void run(float *data, size_t frames, sample_pos position) const noexcept {
+        for(size_t done = 0; done < frames; done += BlockFrames){
+            const size_t n = std::min(BlockFrames, frames - done);
+            runBlock<Stride>(data + done * Stride, n, position + static_cast<sample_pos>(done), Indices{});
+        }
+    }
+
+    bool checkConfigured(AJ::error::IErrorHandler &handler) const {
+        if(!mConfigured){
+            const std::string message = "static chain parameters are not set.\n";
+            handler.onError(error::Error::EffectNotInitialized, message);
+            return false;
+        }
+        return true;
+    }
+
+public:
+    /// @brief Number of stages.
+    static constexpr size_t kStages = sizeof...(Stages);
+
+    /**
+     * @brief Configure every stage, one parameters object per stage in chain order.
+     *
+     * The values are copied, later changes to the parameters need another setParams().
+     *
+     * @return true if every stage accepted its parameters.
+     */
+    bool setParams(AJ::error::IErrorHandler &handler,
+        const std::shared_ptr<typename Stages::Params>&... params) {
+        mConfigured = false;
+
+        bool configured = true;
+        std::apply([&](Stages&... stage){
+            ((configured = configured && configureStage(stage, params, handler)), ...);
+        }, mStages);
+
+        mConfigured = configured;
+        return configured;
+    }
+
+    /// @brief Stage `I`, e.g. to read back its configuration.
+    template<size_t I>
+    const auto& stage() const noexcept {
+        return std::get<I>(mStages);
+    }
+
+    /**
+     * @brief Apply the chain to a single-channel buffer in-place.
+     *
+     * As Effect::process(), every stage range must be inside the buffer.
+     *
+     * @return false (reported) if the chain isn't configured or a range is invalid.
+     */
+    bool process(Float &buffer, AJ::error::IErrorHandler &handler) const {
+        if(!checkConfigured(handler)){
+            return false;
+        }
+
+        bool valid = true;
+        std::apply([&](const Stages&... stage){
+            ((valid = valid && stage.mStart >= 0 && stage.mStart <= stage.mEnd
+                && stage.mEnd < static_cast<sample_pos>(buffer.size())), ...);
+        }, mStages);
+
+        if(!valid){
+            const std::string message = "invalid indexes for static chain stage.\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return false;
+        }
+
+        run<1>(buffer.data(), buffer.size(), 0);
+        return true;
+    }
+
+    /**
+     * @brief Apply the chain to one block of `Channels` interleaved channels, in-place.
+     *
+     * Stage ranges are ranges of stream frames, as in Effect::processBlock(): frames outside
+     * of a range pass through that stage unchanged, blocks can be streamed in any size.
+     *
+     * @param data     interleaved samples, `frames * Channels` floats.
+     * @param frames   number of frames in the block.
+     * @param position stream position (frames) of the first frame of the block.
+     * @param handler  Error handler for reporting processing issues.
+     */
+    bool processInterleaved(float *data, size_t frames, sample_pos position,
+        AJ::error::IErrorHandler &handler) const {
+        if(!checkConfigured(handler)){
+            return false;
+        }
+
+        if(!data){
+            const std::string message = "invalid block, data cannot be NULL.\n";
+            handler.onError(error::Error::NullBufferPtr, message);
+            return false;
+        }
+
+        run<Channels>(data, frames, position);
+        return true;
+    }
+};
+
+/// @brief BasicStaticChain for kNumChannels interleaved channels and kBlockSize frames per block.
+template<typename... Stages>
+using StaticChain = BasicStaticChain<kNumChannels, kBlockSize, Stages...>;
+
+}
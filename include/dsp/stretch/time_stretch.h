@@ -0,0 +1,138 @@
+#pragma once
+#include <memory>
+
+#include "dsp/effect.h"
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+
+namespace AJ::dsp::stretch {
+
+/**
+ * @brief Container for all time stretch parameters.
+ */
+struct Params {
+    sample_pos mStart;   /**< Start position of the stretch in samples (inclusive). */
+    sample_pos mEnd;     /**< End position of the stretch in samples (inclusive). */
+    float mRate;         /**< Tempo factor in [kStretchMinRate, kStretchMaxRate], 1.25 plays 25% faster. */
+    size_t mFrameSize;   /**< WSOLA frame, even, in [kStretchMinFrame, kStretchMaxFrame] (1024 at 44.1 kHz). */
+    size_t mSeek;        /**< Search radius of the frame alignment in samples, at most mFrameSize / 2 (256 at 44.1 kHz, 0 = plain overlap-add). */
+};
+
+/**
+ * @brief Parameter container for the TimeStretch effect.
+ *
+ * @see AJ::dsp::EffectParams
+ */
+class StretchParams : public EffectParams {
+    struct PrivateTag {};
+
+    float mRate = 1.0f;         ///< tempo factor.
+    size_t mFrameSize = 0;      ///< frame length N.
+    size_t mSeek = 0;           ///< search radius.
+    std::shared_ptr<const Float> mWindow; ///< periodic Hann window, N samples.
+
+public:
+    /**
+     * @brief Factory method to create a StretchParams instance.
+     *
+     * Validation rules:
+     * - `mRate` in [kStretchMinRate, kStretchMaxRate].
+     * - `mFrameSize` even, in [kStretchMinFrame, kStretchMaxFrame].
+     * - `mSeek` at most `mFrameSize / 2`.
+     *
+     * @return Shared pointer to a valid StretchParams instance if parameters are valid,
+     *         otherwise nullptr.
+     */
+    static std::shared_ptr<StretchParams> create(Params &params, AJ::error::IErrorHandler &handler);
+
+    /// @brief Tempo factor.
+    float Rate() const noexcept { return mRate; }
+
+    /// @brief Frame length in samples.
+    size_t FrameSize() const noexcept { return mFrameSize; }
+
+    /// @brief Output hop in samples, half a frame.
+    size_t Hop() const noexcept { return mFrameSize / 2; }
+
+    /// @brief Search radius of the frame alignment in samples.
+    size_t Seek() const noexcept { return mSeek; }
+
+    /// @brief Periodic Hann window of the frames.
+    const Float& Window() const noexcept { return *mWindow; }
+
+    /// @brief Length of a range of `length` samples once stretched, round(length / rate).
+    size_t StretchedLength(size_t length) const noexcept;
+
+    ~StretchParams() override = default;
+
+    StretchParams(PrivateTag) {}
+};
+
+/**
+ * @brief WSOLA time stretch: the tempo of [Start, End] changes, its pitch doesn't.
+ *
+ * The range becomes `StretchedLength()` samples long, so the buffer grows or shrinks by the
+ * difference (samples after End move). Output frame k (Hann window, 50% overlap) is read around
+ * input position k·hop·rate, shifted by up to `Seek()` samples to where the input looks most like
+ * the natural continuation of frame k - 1 (normalized cross-correlation, `crossCorrelate` kernel).
+ * With several channels the alignment is searched on their sum and shared, so they stay in phase.
+ *
+ * The output is cut into segments of kStretchSegmentFrames, each one starting from a frame at its
+ * nominal position: they are rendered independently, on the thread pool if one is set, and their
+ * overlapping half frames are added afterwards. The segmentation only depends on the range, so the
+ * output is the same with or without a pool. Every output buffer is allocated once, up front.
+ *
+ * Block processing isn't supported, the length of the stream changes.
+ */
+class TimeStretch : public AJ::dsp::Effect {
+    std::shared_ptr<StretchParams> mParams;
+    std::shared_ptr<utils::ThreadPool> pThreadPool; ///< optional pool rendering the segments.
+
+    bool stretch(Float *const *channels, size_t count, AJ::error::IErrorHandler &handler);
+
+public:
+    TimeStretch() {
+        mParams = nullptr;
+    }
+
+    /**
+     * @brief Render the segments of long ranges on a thread pool.
+     * @param pool thread pool (e.g. EngineResources::threadPool()), nullptr to run on the caller thread.
+     */
+    void setThreadPool(std::shared_ptr<utils::ThreadPool> pool) override {
+        pThreadPool = std::move(pool);
+    }
+
+    /**
+     * @brief Stretch [Start, End] of a single-channel buffer, the buffer is resized.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(Float &buffer, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Stretch [Start, End] of the first `channels` channels of `audio` with a shared alignment.
+     *
+     * All channels must have the same length, they are all resized.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief The channels share the alignment of the segments.
+     */
+    bool linksChannels() const override {
+        return true;
+    }
+
+    /**
+     * @brief Set effect parameters from a shared EffectParams object (must be StretchParams).
+     */
+    bool setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler) override;
+};
+
+}
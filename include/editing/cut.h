@@ -3,6 +3,7 @@
 #include "core/errors.h"
 #include "core/error_handler.h"
 #include "file_io/audio_file.h"
+#include "editing/piece_table.h"
 
 namespace AJ::editing::cut {
 
@@ -81,6 +82,18 @@ public:
      * @note If the specified range removes all samples, the file samples will be cleared.
      */
     bool process(std::shared_ptr<AJ::io::AudioFile> file, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Processes the cut operation on a piece table (see piece_table::PieceTable::cut()).
+     *
+     * No sample moves: the pieces of the range are dropped, the cost follows the number
+     * of pieces instead of the length of the file.
+     *
+     * @param table   Edit list of the file.
+     * @param handler Reference to an error handler for reporting errors.
+     * @return true if the operation succeeded, false otherwise.
+     */
+    bool process(piece_table::PieceTable& table, AJ::error::IErrorHandler& handler);
 };
 
 } // namespace AJ::editing::cut
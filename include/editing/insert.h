@@ -4,6 +4,7 @@
 #include "core/errors.h"
 #include "core/error_handler.h"
 #include "file_io/audio_file.h"
+#include "editing/piece_table.h"
 
 namespace AJ::editing::insert {
 
@@ -112,6 +113,22 @@ public:
     bool process(std::shared_ptr<AJ::io::AudioFile> file,
                  AudioSamples audio,
                  AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Inserts the provided audio samples into a piece table (see piece_table::PieceTable::insert()).
+     *
+     * The samples become a new chunk of the table, nothing is copied and the rest of the
+     * file doesn't move.
+     *
+     * @param table   Edit list of the file.
+     * @param audio   The audio samples to insert. **The table takes them**, they must not be modified afterwards.
+     * @param handler Reference to an error handler for reporting errors.
+     *
+     * @return true if the operation succeeded, false otherwise.
+     */
+    bool process(piece_table::PieceTable& table,
+                 AudioSamples audio,
+                 AJ::error::IErrorHandler& handler);
 };
 
 } // namespace AJ::editing::insert
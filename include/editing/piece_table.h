@@ -0,0 +1,227 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "file_io/audio_file.h"
+
+namespace AJ::editing::piece_table {
+
+/**
+ * @brief A run of frames of an immutable, shared chunk of samples.
+ */
+struct Piece {
+    std::shared_ptr<const AudioBuffer> source; ///< samples of the chunk, never modified once in a table.
+    size_t offset = 0;                         ///< first frame of the piece in `source`.
+    size_t frames = 0;                         ///< frames of the piece.
+};
+
+/**
+ * @class PieceTable
+ * @brief Non-destructive edit list of an audio file: the file is the sequence of its pieces.
+ *
+ * The samples live in immutable, refcounted chunks (the samples of the loaded file, every
+ * inserted buffer). An edit only changes the list of pieces pointing into them:
+ * - the piece holding a frame is found by binary search over the piece start frames;
+ * - cut, insert, split and duplicate move piece descriptors, never samples, so their cost
+ *   follows the number of pieces, not the length of the file;
+ * - copying a table (a clipboard, an undo snapshot) shares the chunks.
+ *
+ * The samples are made contiguous again only when something needs them that way: flatten()
+ * before writing the file or running an effect in place. Readers that can take the frames
+ * a run at a time (analysis, streaming, export) use forEachChunk() or read() instead.
+ *
+ * Positions are frames per channel; ranges are inclusive [start, end] like Cut.
+ *
+ * Typical usage:
+ * @code
+ * AJ::editing::piece_table::PieceTable table;
+ * table.load(*file, handler);          // the file's samples move into the table.
+ * table.cut(48000, 95999, handler);    // one second out.
+ * table.duplicate(0, 47999, handler);  // the first second twice.
+ * table.flatten(*file, handler);       // contiguous again, ready for write() or an effect.
+ * @endcode
+ */
+class PieceTable {
+    uint8_t mChannels = 0;
+    size_t mFrames = 0;
+    std::vector<Piece> mPieces;
+    std::vector<size_t> mStarts; ///< table frame of the first frame of every piece (sorted).
+
+    /**
+     * @brief Index of the piece holding `frame` (frame < mFrames).
+     */
+    size_t locate(size_t frame) const {
+        return static_cast<size_t>(std::upper_bound(mStarts.begin(), mStarts.end(), frame) - mStarts.begin()) - 1;
+    }
+
+    /**
+     * @brief Make `frame` the start of a piece (splitting the piece holding it).
+     * @return index of the piece starting at `frame`, the piece count for the end of the table.
+     */
+    size_t boundary(size_t frame);
+
+    /**
+     * @brief Insert pieces before piece `index`, at table frame `frame`.
+     */
+    void place(size_t index, size_t frame, std::vector<Piece> pieces);
+
+    /**
+     * @brief Merge piece `index` into the previous one if they are contiguous in the same chunk.
+     */
+    void coalesce(size_t index);
+
+    /**
+     * @brief Check that [start, end] is inside the table.
+     */
+    bool checkRange(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler) const;
+
+    /**
+     * @brief Check that `at` is a position in the table (0 to frames()).
+     */
+    bool checkPosition(sample_pos at, AJ::error::IErrorHandler &handler) const;
+
+public:
+    PieceTable() = default;
+
+    /**
+     * @brief Replace the content of the table with `audio`, as one chunk.
+     *
+     * @param audio    samples of `channels` channels of the same length. **The table takes them:**
+     *                 they must not be modified afterwards (copy them to keep editing them).
+     * @param channels channels of the table, 1 to kNumChannels.
+     * @param handler  Error handler for reporting channels of different lengths.
+     * @return true on success; false on failure.
+     */
+    bool assign(AudioSamples audio, uint8_t channels, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Replace the content of the table with `pieces`, in order (e.g. read back from a
+     * project). Contiguous pieces of the same chunk are merged.
+     *
+     * @param pieces   pieces of chunks of at least `channels` channels, **the table takes the
+     *                 chunks**, see assign().
+     * @param channels channels of the table, 1 to kNumChannels.
+     * @param handler  Error handler for reporting a piece out of its chunk.
+     * @return true on success; false on failure.
+     */
+    bool assign(std::vector<Piece> pieces, uint8_t channels, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Replace the content of the table with the samples of a file.
+     *
+     * The samples move into the table: `file.pAudio` is left empty (and `mInfo.length` 0)
+     * until flatten() puts the edited samples back. The file must be in Float32 storage.
+     *
+     * @return true on success; false on failure.
+     */
+    bool load(io::AudioFile &file, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Frames per channel.
+     */
+    size_t frames() const noexcept {
+        return mFrames;
+    }
+
+    /**
+     * @brief Channels of the table.
+     */
+    uint8_t channels() const noexcept {
+        return mChannels;
+    }
+
+    /**
+     * @brief The pieces, in order.
+     */
+    const std::vector<Piece>& pieces() const noexcept {
+        return mPieces;
+    }
+
+    /**
+     * @brief Start a new piece at `at` (e.g. to move or process a region on its own).
+     * @return true on success; false if `at` is out of the table.
+     */
+    bool split(sample_pos at, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Remove the frames [start, end].
+     * @return true on success; false if the range is invalid.
+     */
+    bool cut(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Insert `audio` before frame `at` (frames() appends), as a new chunk.
+     *
+     * @param audio samples with the channels of the table. **The table takes them**, see assign().
+     * @return true on success; false if `at` or the samples are invalid.
+     */
+    bool insert(sample_pos at, AudioSamples audio, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Insert the content of another table (e.g. a copy()) before frame `at`, sharing its chunks.
+     *
+     * `other` may be this table.
+     */
+    bool insert(sample_pos at, const PieceTable &other, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Table of the frames [start, end], sharing the chunks (a clipboard).
+     * @return true on success; false if the range is invalid.
+     */
+    bool copy(sample_pos start, sample_pos end, PieceTable &out, AJ::error::IErrorHandler &handler) const;
+
+    /**
+     * @brief Repeat the frames [start, end] right after `end`.
+     * @return true on success; false if the range is invalid.
+     */
+    bool duplicate(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Call `fn(const float *const *channels, size_t frames)` on the contiguous runs of
+     * `count` frames from `start`, in order (the range must be inside the table).
+     */
+    template<typename Fn>
+    void forEachChunk(size_t start, size_t count, Fn &&fn) const {
+        const float *channels[kNumChannels] = {};
+
+        for(size_t index = count ? locate(start) : mPieces.size(); count > 0; ++index){
+            const Piece &piece = mPieces[index];
+            const size_t within = start - mStarts[index];
+            const size_t frames = std::min(count, piece.frames - within);
+
+            for(uint8_t ch = 0; ch < mChannels; ++ch){
+                channels[ch] = (*piece.source)[ch].data() + piece.offset + within;
+            }
+
+            fn(static_cast<const float *const *>(channels), frames);
+            start += frames;
+            count -= frames;
+        }
+    }
+
+    /**
+     * @brief Copy `count` frames of a channel from `start` into `out` (the range must be inside the table).
+     */
+    void read(uint8_t channel, size_t start, size_t count, float *out) const;
+
+    /**
+     * @brief Contiguous copy of the table, `channels()` channels of `frames()` frames.
+     */
+    AudioSamples flatten() const;
+
+    /**
+     * @brief Put the samples of the table back into `file` (contiguous), e.g. before write()
+     * or an effect. `mInfo.length` and the level index follow.
+     *
+     * The table keeps its pieces, editing can go on after a flatten().
+     *
+     * @return true on success; false if the channels of the file don't match the table.
+     */
+    bool flatten(io::AudioFile &file, AJ::error::IErrorHandler &handler) const;
+};
+
+} // namespace AJ::editing::piece_table
@@ -0,0 +1,250 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+#include "dsp/effect.h"
+#include "dsp/effect_registry.h"
+#include "editing/render_graph.h"
+
+namespace AJ::editing::preview {
+
+/**
+ * @brief How final the frames of a read are, see PreviewRenderer::read().
+ */
+enum class Quality : uint8_t {
+    Missing, ///< not rendered since the last change.
+    Preview, ///< provisional, replaced when the full quality render reaches it.
+    Full     ///< what the effects give at full quality (or the dry source where no effect reaches).
+};
+
+/**
+ * @class PreviewRenderer
+ * @brief Effects on a file that can be heard right after every change, then refined in the background.
+ *
+ * Auditioning settings on a long file doesn't need the final render at once. The renderer splits
+ * the file in windows of kPreviewWindowFrames and renders them in two passes:
+ * - **Preview**, when a window is read (or ahead of the playhead, by the background thread): only
+ *   that window, through effects set to RenderQuality::Preview (fast tanh, convolution tails cut
+ *   after the head), at the samplerate divided by decimation() through the resampler when every
+ *   effect of the window can run there (gain, fades, distortion, reverse, echo, reverb). Effects
+ *   with memory only hear kPreviewTailSeconds before the window, so longer echo and reverb tails
+ *   are cut at the window start. A window costs the same whatever the length of the file.
+ * - **Full**, on a background thread at ThreadPriority::Low: the effects as recorded, through a
+ *   render_graph::RenderGraph, from the playhead window to the end of the file then from the
+ *   start. A finished window replaces its preview, the next read returns it.
+ *
+ * read() tells the lowest quality of what it returned, so a player or an editor can mark the
+ * provisional frames. Changing an effect (push(), pop(), setParams()) drops the windows it can
+ * have changed: its range, up to the end of the range of the effects with memory after it.
+ *
+ * Effects needing their whole range (normalization) are previewed on the window alone. An
+ * effect the preview can't run on a window (a custom effect whose parameters it doesn't know)
+ * is rendered at full quality when its window is read.
+ *
+ * The rendered windows take as much memory as the source, on top of the cache of the graph.
+ * Every method is thread-safe.
+ *
+ * Typical usage:
+ * @code
+ * AJ::editing::preview::PreviewRenderer preview(engine->effectRegistry(), handler);
+ * preview.assign(file->pAudio, file->mInfo.channels, file->mInfo.samplerate, handler);
+ * preview.push(AJ::Effect::Distortion, distortionParams, handler);
+ *
+ * preview.setPlayhead(position);
+ * AJ::editing::preview::Quality quality;
+ * preview.read(position, 4096, planar, quality, handler); // Preview right away, Full a bit later.
+ *
+ * distortionParams->setGain(4.0f);
+ * preview.setParams(0, distortionParams, handler);        // heard on the next read.
+ * @endcode
+ */
+class PreviewRenderer {
+    /// @brief An effect of the renderer.
+    struct Stage {
+        AJ::Effect effect;
+        std::shared_ptr<dsp::EffectParams> params;
+        sample_pos start = 0;
+        sample_pos end = 0;
+        bool block = false;  ///< runs with processBlock(), else process() on its range.
+        bool local = false;  ///< every frame only depends on itself (splitsRange()).
+    };
+
+    /// @brief A window of the output.
+    struct Window {
+        Quality quality = Quality::Missing;
+        uint64_t stamp = 0;   ///< generation of the last change that reached the window.
+        bool failed = false;  ///< the background render failed at this stamp, not retried.
+        AudioBuffer samples;  ///< rendered frames, empty before the first render.
+    };
+
+    /// @brief Everything a window is rendered from, copied so it renders without the lock.
+    struct Job {
+        size_t window = 0;
+        uint64_t stamp = 0;
+        Quality quality = Quality::Missing; ///< Preview or Full.
+        AudioSamples source;
+        uint8_t channels = 0;
+        size_t frames = 0;
+        uint32_t samplerate = 0;
+        uint32_t decimation = 1;
+        std::vector<Stage> stages;
+    };
+
+    std::shared_ptr<dsp::EffectRegistry> pEffects;
+    AJ::error::IErrorHandler &mHandler;  ///< errors of the background thread.
+    render_graph::RenderGraph mGraph;    ///< the full quality render.
+
+    mutable std::mutex mMux;
+    std::condition_variable mWake;       ///< work for the background thread.
+    std::condition_variable mSettled;    ///< a window was rendered in the background.
+
+    AudioSamples pSource;
+    uint8_t mChannels = 0;
+    size_t mFrames = 0;
+    uint32_t mSamplerate = 0;
+    uint32_t mDecimation = kPreviewDecimation;
+
+    std::vector<Stage> mStages;
+    std::vector<Window> mWindows;
+    uint64_t mGeneration = 0;
+    size_t mPlayhead = 0;
+    bool mStop = false;
+    std::thread mRenderer;
+
+    /// @brief Loop of the background thread.
+    void run();
+
+    /// @brief The next window the background thread renders, false if there's none.
+    bool nextJob(Job &job) const;
+
+    /// @brief A job rendering `window` at `quality` from the current state (mMux held).
+    Job makeJob(size_t window, Quality quality) const;
+
+    /**
+     * @brief Render the preview of a window into `out`.
+     *
+     * @param exact [out] true if no effect reaches the window: `out` is the dry source.
+     * @return false if an effect failed. `out` is left empty when the preview can't run an
+     *         effect of the window, which then needs the full render.
+     */
+    bool renderPreview(const Job &job, AudioBuffer &out, bool &exact, AJ::error::IErrorHandler &handler) const;
+
+    /// @brief Render a window through the graph.
+    bool renderFull(const Job &job, AudioBuffer &out, AJ::error::IErrorHandler &handler);
+
+    /// @brief Render a Missing window on the calling thread (mMux held).
+    bool renderNow(size_t window, AJ::error::IErrorHandler &handler);
+
+    /// @brief A stage for `effect` and `params`, after the graph accepted them.
+    Stage makeStage(AJ::Effect effect, std::shared_ptr<dsp::EffectParams> params) const;
+
+    /**
+     * @brief Drop the windows changed by a change of stage `from` over [start, end] (mMux held).
+     */
+    void invalidate(size_t from, sample_pos start, sample_pos end);
+
+    size_t windowFrames(size_t window) const noexcept {
+        return std::min(kPreviewWindowFrames, mFrames - window * kPreviewWindowFrames);
+    }
+
+public:
+    /**
+     * @param effects the registry the effects are constructed from (AJ_Engine::effectRegistry()).
+     * @param handler receives the errors of the background renders, from the background thread.
+     *                Kept: it must outlive the renderer.
+     */
+    PreviewRenderer(std::shared_ptr<dsp::EffectRegistry> effects, AJ::error::IErrorHandler &handler);
+
+    /// @brief Stops the background thread (after the window it's rendering).
+    ~PreviewRenderer();
+
+    PreviewRenderer(const PreviewRenderer&) = delete;
+    PreviewRenderer& operator=(const PreviewRenderer&) = delete;
+
+    /**
+     * @brief Replace the source, every effect is removed.
+     *
+     * @param audio      `channels` channels of the same length, kept: they must not be modified
+     *                   while the renderer uses them.
+     * @param channels   channels of the source, 1 to kNumChannels.
+     * @param samplerate samplerate of the source in Hz.
+     * @param handler    Error handler for reporting invalid channels or samplerate.
+     * @return true on success; false on failure.
+     */
+    bool assign(AudioSamples audio, uint8_t channels, uint32_t samplerate, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Append an effect, see render_graph::RenderGraph::push(). Nothing is rendered until read.
+     * @return false (reported) if the effect or its parameters are invalid.
+     */
+    bool push(AJ::Effect effect, std::shared_ptr<dsp::EffectParams> params, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Remove the last effect.
+     * @return false (reported) if there's none.
+     */
+    bool pop(AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Replace the parameters of effect `index`, e.g. after a tweak. The windows it changes
+     * are previewed again on their next read.
+     * @return false (reported) if there's no such effect or the parameters are invalid.
+     */
+    bool setParams(size_t index, std::shared_ptr<dsp::EffectParams> params, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Frame being played or edited: the background thread previews the windows ahead of it,
+     * then renders at full quality from there.
+     */
+    void setPlayhead(size_t frame);
+
+    /**
+     * @brief Samplerate divisor of the previews, 1 previews at the source rate.
+     * The reduced rate doesn't go under kMinSamplerate.
+     */
+    void setDecimation(uint32_t decimation);
+
+    /// @brief Samplerate divisor of the previews.
+    uint32_t decimation() const;
+
+    /**
+     * @brief Render `count` frames of every channel from `start`, `out[ch]` holds `count` floats.
+     *
+     * Windows not rendered since the last change are previewed on the calling thread first.
+     *
+     * @param quality [out] lowest quality of the frames written.
+     * @return false (reported) if the range is out of the source or an effect failed.
+     */
+    bool read(size_t start, size_t count, float *const *out, Quality &quality, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Lowest quality of the frames [start, start + count), nothing is rendered.
+     */
+    Quality quality(size_t start, size_t count) const;
+
+    /**
+     * @brief Wait until every window is at full quality (or failed in the background).
+     * @return true if every window is at full quality, false on timeout or a failed window.
+     */
+    bool wait(std::chrono::milliseconds timeout);
+
+    /// @brief Number of effects.
+    size_t size() const;
+
+    /// @brief Frames per channel.
+    size_t frames() const;
+
+    /// @brief Channels of the source.
+    uint8_t channels() const;
+};
+
+} // namespace AJ::editing::preview
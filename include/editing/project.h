@@ -0,0 +1,343 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/error_handler.h"
+#include "dsp/kernels.h"
+#include "dsp/loudness/loudness.h"
+#include "file_io/seek_index.h"
+#include "editing/piece_table.h"
+#include "undo_system/undo.h"
+
+namespace AJ::editing::project {
+
+/**
+ * @class ProjectStore
+ * @brief On-disk project of a piece table: its chunks, its pieces, its undo history and its
+ * analysis indices, opened without reading the samples.
+ *
+ * A project is a directory holding two append-only files:
+ * - the **sample file**: every chunk of the table as planar float32 channels, each starting on
+ *   a kProjectAlignment boundary, followed by the min / max / sum of squares of every
+ *   kLevelIndexBaseFrames block of its channels. It is memory mapped, pages are read when
+ *   something touches them.
+ * - the **journal**: checksummed records of what changed, the chunks appended to the sample
+ *   file, the pieces of the table, the undo history, loudness measurements, seek indices.
+ *   Opening replays it, the last record of a kind wins.
+ *
+ * Opening costs the records of the journal, not the samples: read() and levels() (a waveform
+ * view, playback, export) read the pieces straight from the mapping. table() gives back an
+ * editable PieceTable, copying the chunks it references out of the mapping.
+ *
+ * commit() appends only what isn't stored yet: the chunks inserted since the last commit
+ * (chunks shared with the table, like the frames an undo state saved, are written once) and
+ * a record of the pieces. The sample file is synced before the journal refers to it, and a
+ * record torn by a crash is dropped on the next open. A complete record that fails its checksum
+ * is damage, not a crash: open() fails and leaves the journal as it is. compact()
+ * rewrites the journal with its current state alone; chunks nothing refers to anymore stay
+ * in the sample file.
+ *
+ * Not thread-safe: the const readers may run together, not with the other methods.
+ *
+ * Typical usage:
+ * @code
+ * AJ::editing::project::ProjectStore store;
+ * store.create("take.ajproj", 2, 48000, handler);
+ * store.commit(*table, history, handler);       // after the edits: new chunks, pieces, undo states.
+ *
+ * // later, in another session:
+ * store.open("take.ajproj", handler);
+ * store.levels(0, 0, store.frames() - 1);       // waveform right away, from the mapping.
+ * store.table(*table, handler);                 // editable again.
+ * store.history(table, history, handler);       // undo where it was left.
+ * @endcode
+ */
+class ProjectStore {
+    /// @brief A chunk appended to the sample file.
+    struct Chunk {
+        uint64_t offset = 0;  ///< first channel in the sample file.
+        uint64_t stride = 0;  ///< bytes from a channel to the next (aligned).
+        uint64_t frames = 0;
+        uint64_t levels = 0;  ///< offset of the level blocks, channel after channel.
+        std::weak_ptr<const AudioBuffer> resident; ///< the samples in memory, if they are.
+    };
+
+    /// @brief A run of frames of a stored chunk.
+    struct Piece {
+        uint64_t chunk = 0;
+        uint64_t offset = 0;
+        uint64_t frames = 0;
+
+        bool operator==(const Piece &other) const noexcept {
+            return chunk == other.chunk && offset == other.offset && frames == other.frames;
+        }
+
+        bool operator!=(const Piece &other) const noexcept {
+            return !(*this == other);
+        }
+    };
+
+    /// @brief A change of an undo state, its saved frames as stored pieces.
+    struct Change {
+        sample_pos start = 0;
+        uint64_t removed = 0;
+        uint64_t inserted = 0;
+        std::vector<Piece> saved;
+    };
+
+    /// @brief An undo state of the history.
+    struct State {
+        std::string label;
+        std::vector<Change> changes;
+    };
+
+    /// @brief A loudness measurement of the table.
+    struct Loudness {
+        sample_pos start = 0;
+        sample_pos end = 0;
+        uint32_t samplerate = 0;
+        dsp::loudness::Measurement measurement;
+    };
+
+    std::string mDirectory;
+    int mData = -1;        ///< sample file.
+    int mJournal = -1;     ///< journal file.
+    uint64_t mDataBytes = 0;
+    uint64_t mJournalBytes = 0;
+
+    const uint8_t *pMap = nullptr; ///< mapping of the sample file.
+    size_t mMapSize = 0;
+
+    uint8_t mChannels = 0;
+    uint32_t mSamplerate = 0;
+
+    std::vector<Chunk> mChunks;
+    std::unordered_map<const AudioBuffer*, uint64_t> mIds; ///< stored chunk of a buffer in memory.
+
+    std::vector<Piece> mPieces;  ///< the table, as committed.
+    std::vector<uint64_t> mStarts;
+    uint64_t mFrames = 0;
+
+    std::vector<State> mUndo;    ///< oldest first, like UndoSystem.
+    std::vector<State> mRedo;
+    std::vector<Loudness> mLoudness;
+    std::map<std::string, io::SeekIndex> mSeekIndices;
+
+    /**
+     * @brief Replay the complete records of the journal, a torn one can only be the last.
+     * @param valid bytes of the complete records.
+     * @return false if it doesn't start with a project record or a complete record is damaged.
+     */
+    bool replay(const std::vector<uint8_t> &journal, uint64_t &valid);
+
+    /// @brief Apply a record of the journal, false if its payload is invalid.
+    bool apply(uint32_t type, const uint8_t *payload, size_t bytes);
+
+    /// @brief Set the committed pieces, dropping the loudness measurements.
+    void setTable(std::vector<Piece> pieces);
+
+    /// @brief Keep a loudness measurement, replacing one of the same range.
+    void remember(const Loudness &entry);
+
+    /// @brief Map the sample file as it is now.
+    bool remap(AJ::error::IErrorHandler &handler);
+
+    /// @brief Append records to the journal.
+    bool append(const std::string &records, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Id of the stored chunk of `source`, appended to the sample file (and a record of
+     * it to `records`) if it isn't stored yet.
+     */
+    bool store(const std::shared_ptr<const AudioBuffer> &source, std::string &records, uint64_t &id,
+        AJ::error::IErrorHandler &handler);
+
+    /// @brief Stored pieces of the pieces of a table, the chunks they need appended.
+    bool store(const std::vector<piece_table::Piece> &pieces, std::vector<Piece> &out, std::string &records,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Check the channels of `table` and store its pieces, with a table record if they
+     * differ from the committed ones.
+     */
+    bool stage(const piece_table::PieceTable &table, std::vector<Piece> &pieces, std::string &records,
+        AJ::error::IErrorHandler &handler);
+
+    /// @brief Forget the chunks stored past `chunks` and cut the sample file back to `data` bytes.
+    void rollback(size_t chunks, uint64_t data) noexcept;
+
+    /**
+     * @brief Sync the chunks stored past `chunks`, then append `records` and remap; rolled back
+     * on failure.
+     */
+    bool finish(size_t chunks, uint64_t data, const std::string &records, AJ::error::IErrorHandler &handler);
+
+    /// @brief The samples of a stored chunk, from memory if something still holds them.
+    std::shared_ptr<const AudioBuffer> resident(uint64_t id);
+
+    /// @brief Pieces of a table built from stored pieces.
+    std::vector<piece_table::Piece> restore(const std::vector<Piece> &pieces);
+
+    /// @brief First sample of a channel of a stored piece, in the mapping.
+    const float* samples(const Piece &piece, uint8_t channel) const noexcept {
+        const Chunk &chunk = mChunks[piece.chunk];
+        return reinterpret_cast<const float*>(pMap + chunk.offset + channel * chunk.stride) + piece.offset;
+    }
+
+    /// @brief Index of the stored piece holding `frame` (frame < mFrames).
+    size_t locate(uint64_t frame) const noexcept;
+
+    /// @brief The whole state as records, for compact().
+    std::string snapshot() const;
+
+public:
+    ProjectStore() = default;
+
+    /// @brief Closes the project.
+    ~ProjectStore();
+
+    ProjectStore(const ProjectStore&) = delete;
+    ProjectStore& operator=(const ProjectStore&) = delete;
+
+    /**
+     * @brief Create an empty project in `directory` (created if needed) and open it.
+     *
+     * @param channels   channels of the table, 1 to kNumChannels.
+     * @param samplerate samplerate of the samples in Hz.
+     * @return false (reported) if the directory already holds a project or can't be written.
+     */
+    bool create(const std::string &directory, uint8_t channels, uint32_t samplerate,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Open the project in `directory` (closes the current one).
+     * @return false (reported) if there's no project there or it can't be read, a damaged
+     * journal isn't modified.
+     */
+    bool open(const std::string &directory, AJ::error::IErrorHandler &handler);
+
+    /// @brief Unmap and close the files, chunks given out by table() stay valid.
+    void close() noexcept;
+
+    bool isOpen() const noexcept {
+        return mJournal >= 0;
+    }
+
+    /**
+     * @brief Store the current state of `table`: the chunks not stored yet, then its pieces.
+     *
+     * The loudness measurements are dropped if the pieces changed. After an open(), chunks are
+     * known by the buffers table() gave out: a table loaded some other way is stored again.
+     *
+     * @return false (reported) if the channels don't match the project or a file can't be written.
+     */
+    bool commit(const piece_table::PieceTable &table, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief commit() the table, then the states of `history` whose changes are all on `table`
+     * (the others target files or other tables, they aren't part of the project).
+     *
+     * The table must be the one the states were recorded on: a `std::shared_ptr` the history's
+     * changes point to. Spilled states are loaded back first (UndoSystem::load()).
+     */
+    bool commit(const std::shared_ptr<piece_table::PieceTable> &table, undo::UndoSystem &history,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief The committed table, its chunks copied out of the mapping (or shared with the
+     * chunks still in memory).
+     */
+    bool table(piece_table::PieceTable &out, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Replace `out` with the committed undo history, its changes on `table` (the table
+     * table() filled in).
+     */
+    bool history(const std::shared_ptr<piece_table::PieceTable> &table, undo::UndoSystem &out,
+        AJ::error::IErrorHandler &handler);
+
+    /// @brief Frames per channel of the committed table.
+    size_t frames() const noexcept {
+        return static_cast<size_t>(mFrames);
+    }
+
+    uint8_t channels() const noexcept {
+        return mChannels;
+    }
+
+    uint32_t samplerate() const noexcept {
+        return mSamplerate;
+    }
+
+    /// @brief Undo and redo states of the committed history.
+    size_t undoCount() const noexcept {
+        return mUndo.size();
+    }
+
+    size_t redoCount() const noexcept {
+        return mRedo.size();
+    }
+
+    /**
+     * @brief Copy `count` frames of a channel of the committed table from `start` into `out`,
+     * from the mapping.
+     * @return frames written, clamped to the end of the table.
+     */
+    size_t read(uint8_t channel, size_t start, size_t count, float *out) const;
+
+    /**
+     * @brief Levels of the frames [start, end] (inclusive) of a channel of the committed table:
+     * the stored blocks the range covers, the samples of the partial blocks at the edges of
+     * its pieces.
+     */
+    dsp::kernels::Levels levels(uint8_t channel, sample_pos start, sample_pos end) const;
+
+    /**
+     * @brief Stored loudness of the frames [start, end] of the committed table at `samplerate`.
+     * @return the measurement, nullptr if none was stored since the pieces last changed.
+     */
+    const dsp::loudness::Measurement* loudness(sample_pos start, sample_pos end, uint32_t samplerate) const;
+
+    /**
+     * @brief Store the loudness of the frames [start, end], the oldest past
+     * kLevelIndexLoudnessEntries are dropped.
+     */
+    bool storeLoudness(sample_pos start, sample_pos end, uint32_t samplerate,
+        const dsp::loudness::Measurement &measurement, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Seek index stored for a source of the project (e.g. the MP3 it was imported from).
+     * @return false if there's none, `index` is left untouched.
+     */
+    bool loadSeekIndex(const std::string &source, io::SeekIndex &index) const;
+
+    /// @brief Store the seek index of a source of the project, replacing its previous one.
+    bool storeSeekIndex(const std::string &source, const io::SeekIndex &index, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Rewrite the journal with the current state alone (written aside, then renamed).
+     */
+    bool compact(AJ::error::IErrorHandler &handler);
+
+    /// @brief Bytes of the sample file.
+    uint64_t dataBytes() const noexcept {
+        return mDataBytes;
+    }
+
+    /// @brief Bytes of the journal.
+    uint64_t journalBytes() const noexcept {
+        return mJournalBytes;
+    }
+
+    const std::string& directory() const noexcept {
+        return mDirectory;
+    }
+};
+
+} // namespace AJ::editing::project
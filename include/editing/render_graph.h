@@ -0,0 +1,275 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/effect_params.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+#include "dsp/effect.h"
+#include "dsp/effect_registry.h"
+#include "dsp/kernels.h"
+#include "file_io/audio_file.h"
+
+namespace AJ::editing::render_graph {
+
+/**
+ * @brief An effect recorded on a RenderGraph, applied to the frames [start, end].
+ */
+struct Node {
+    AJ::Effect effect;
+    std::shared_ptr<dsp::EffectParams> params;
+    sample_pos start = 0;
+    sample_pos end = 0;
+};
+
+/**
+ * @class RenderGraph
+ * @brief Deferred effects of a file: applying an effect records a node, the samples are only
+ * computed for the ranges that are read.
+ *
+ * The graph is a source (the dry samples, never modified) followed by a chain of nodes. Reading
+ * frames (playback, an analysis, flatten() before a save) pulls them through the nodes a chunk
+ * of kRenderChunkFrames at a time, and the output of every node is cached per chunk:
+ * - an effect without memory (gain, fades, distortion) computes only the chunks that are read;
+ * - an effect with memory (echo, reverb, EQ, dynamics, pitch) streams its range from its start
+ *   up to the chunk read, and carries on from there on the next read;
+ * - an effect that needs its whole range at once (normalization, reverse) runs on its range the
+ *   first time one of its chunks is read.
+ *
+ * Frames outside of a node's range pass through it untouched and aren't cached by it.
+ *
+ * Changing a node (setParams(), erase()) drops only the chunks it can have changed, in that node
+ * and after it: a later gain keeps its chunks outside of the changed range, a later echo those
+ * before it. Undoing the last effect is pop(), nothing is restored.
+ *
+ * The cached chunks are capped by a budget (setCacheBudget()), the least recently read go first.
+ * All the methods lock the graph, it can be read by a playback thread while it's edited.
+ *
+ * Typical usage:
+ * @code
+ * AJ::editing::render_graph::RenderGraph graph(engine->effectRegistry());
+ * graph.assign(file->pAudio, file->mInfo.channels, handler);
+ * graph.push(AJ::Effect::gain, gainParams, handler);     // nothing computed yet.
+ * graph.push(AJ::Effect::echo, echoParams, handler);
+ * graph.read(0, 48000, 4096, out, handler);             // one second in: only those chunks run.
+ * graph.flatten(*file, handler);                         // everything, before writing the file.
+ * @endcode
+ */
+class RenderGraph {
+    /// @brief How a node computes its chunks.
+    enum class Mode : uint8_t {
+        Chunked,  ///< any chunk on its own (splitsRange() and processBlock()).
+        Streamed, ///< its range in order, one EffectState across the chunks (processBlock()).
+        Whole     ///< its range in one process() call.
+    };
+
+    /// @brief Output of a node for one chunk.
+    struct Chunk {
+        AudioSamples samples;
+        uint64_t used = 0; ///< read tick, the smallest is evicted first.
+    };
+
+    struct NodeData {
+        Node node;
+        Mode mode = Mode::Whole;
+        std::unique_ptr<dsp::Effect> effect; ///< the node's own instance, configured with node.params.
+        std::unique_ptr<dsp::EffectState> state;
+        size_t next = 0;                     ///< chunk `state` continues with (Streamed).
+        std::unordered_map<size_t, Chunk> chunks;
+    };
+
+    std::shared_ptr<dsp::EffectRegistry> pEffects;
+    std::shared_ptr<utils::ThreadPool> pPool;
+
+    mutable std::mutex mMux;
+    AudioSamples pSource;
+    uint8_t mChannels = 0;
+    size_t mFrames = 0;
+    std::vector<std::unique_ptr<NodeData>> mNodes;
+
+    Float mInterleaved;  ///< a chunk of interleaved frames for processBlock().
+    size_t mCached = 0;  ///< bytes of all the cached chunks.
+    size_t mBudget = kRenderCacheBudget;
+    uint64_t mTick = 0;
+
+    /**
+     * @brief Channel pointers to the frames of `chunk` at the output of the first `depth` nodes
+     * (0 = the source). Valid until the next evict().
+     */
+    bool pull(size_t depth, size_t chunk, const float *(&out)[kNumChannels], AJ::error::IErrorHandler &handler);
+
+    bool computeChunked(size_t index, size_t chunk, AJ::error::IErrorHandler &handler);
+    bool computeStreamed(size_t index, size_t chunk, AJ::error::IErrorHandler &handler);
+    bool computeWhole(size_t index, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Run processBlock() of node `index` on the chunk `samples` (frames from `position`).
+     */
+    bool processBlock(NodeData &data, AudioBuffer &samples, size_t frames, sample_pos position,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Cache `samples` as the output of node `index` for `chunk`.
+     */
+    void store(NodeData &data, size_t chunk, AudioSamples samples);
+
+    /**
+     * @brief Copy the input of a node for `chunk` into a new chunk buffer.
+     */
+    AudioSamples copyChunk(const float *const *input, size_t frames) const;
+
+    /**
+     * @brief Drop the chunks of nodes `from` onwards that change when the input of node `from`
+     * changes over [start, end].
+     */
+    void invalidate(size_t from, sample_pos start, sample_pos end);
+
+    /**
+     * @brief Drop every chunk of a node and its stream state.
+     */
+    void clearNode(NodeData &data);
+
+    /**
+     * @brief Evict the least recently read chunks until the cache fits in 3/4 of the budget.
+     */
+    void evict();
+
+    /**
+     * @brief Configure a node for `effect` and `params`, its range and its mode.
+     */
+    bool configure(NodeData &data, AJ::Effect effect, std::shared_ptr<dsp::EffectParams> params,
+        AJ::error::IErrorHandler &handler);
+
+    bool readLocked(size_t start, size_t count, float *const *out, AJ::error::IErrorHandler &handler);
+
+    size_t chunkFrames(size_t chunk) const noexcept {
+        return std::min(kRenderChunkFrames, mFrames - chunk * kRenderChunkFrames);
+    }
+
+public:
+    /**
+     * @param effects the registry the nodes construct their effects from (AJ_Engine::effectRegistry()).
+     */
+    explicit RenderGraph(std::shared_ptr<dsp::EffectRegistry> effects) : pEffects(std::move(effects)) {}
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    /**
+     * @brief Replace the source of the graph, every node is removed.
+     *
+     * @param audio    `channels` channels of the same length. **The graph keeps them:** they
+     *                 must not be modified while the graph uses them.
+     * @param channels channels of the source, 1 to kNumChannels.
+     * @param handler  Error handler for reporting channels of different lengths.
+     * @return true on success; false on failure.
+     */
+    bool assign(AudioSamples audio, uint8_t channels, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Record an effect after the last node, nothing is computed.
+     *
+     * The parameters are checked (and the effect constructed) now, the graph keeps them:
+     * call setParams() after changing them.
+     *
+     * @param effect  effect to apply.
+     * @param params  its parameters, the range [Start, End] must be inside the source (nullptr = the whole source).
+     * @param handler Error handler for reporting an unknown effect, invalid parameters or range.
+     * @return true on success; false on failure.
+     */
+    bool push(AJ::Effect effect, std::shared_ptr<dsp::EffectParams> params, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Remove the last node (undo the last effect).
+     * @return false (reported) if there's no node.
+     */
+    bool pop(AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Remove node `index`, the chunks after it that it changed are recomputed when read.
+     * @return false (reported) if there's no such node.
+     */
+    bool erase(size_t index, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Replace the parameters (and range) of node `index`.
+     * @return false (reported) if there's no such node or the parameters are invalid, the node is left as it was.
+     */
+    bool setParams(size_t index, std::shared_ptr<dsp::EffectParams> params, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Thread pool for the effects that parallelize their own passes (nullptr = the calling thread).
+     */
+    void setThreadPool(std::shared_ptr<utils::ThreadPool> pool);
+
+    /**
+     * @brief Nodes of the graph, in order.
+     */
+    std::vector<Node> nodes() const;
+
+    /**
+     * @brief Number of nodes.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Frames per channel.
+     */
+    size_t frames() const;
+
+    /**
+     * @brief Channels of the source.
+     */
+    uint8_t channels() const;
+
+    /**
+     * @brief Render `count` frames of a channel from `start` into `out`.
+     * @return false (reported) if the range is out of the graph or an effect failed.
+     */
+    bool read(uint8_t channel, size_t start, size_t count, float *out, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Render `count` frames of every channel from `start`, `out[ch]` holds `count` floats.
+     * @return false (reported) if the range is out of the graph or an effect failed.
+     */
+    bool read(size_t start, size_t count, float *const *out, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Min, max and sum of squares of the rendered frames [start, end] of a channel.
+     * @return false (reported) if the range is invalid or an effect failed.
+     */
+    bool levels(uint8_t channel, sample_pos start, sample_pos end, dsp::kernels::Levels &levels,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Render the whole graph into `file` (contiguous), e.g. before write().
+     *
+     * The graph keeps its source and nodes, `file.pAudio` gets new samples. `mInfo.length` and
+     * the level index follow.
+     *
+     * @return true on success; false if the channels don't match or an effect failed.
+     */
+    bool flatten(io::AudioFile &file, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Bytes of rendered chunks held by the graph.
+     */
+    size_t cachedBytes() const;
+
+    /**
+     * @brief Cap the cached chunks, evicting the least recently read ones if needed.
+     */
+    void setCacheBudget(size_t bytes);
+
+    /**
+     * @brief Drop every cached chunk (the nodes stay).
+     */
+    void clearCache();
+};
+
+} // namespace AJ::editing::render_graph
@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/buffer_pool.h"
+#include "file_io/mp3_stream_encoder.h"
+#include "editing/session/session.h"
+
+namespace AJ::editing::session {
+
+/**
+ * @brief Container / encoding of an exported file.
+ */
+enum class ExportFormat : uint8_t {
+    Wav,  ///< PCM (16, 24, 32-bit) or 32-bit float WAV.
+    Flac, ///< lossless FLAC, 16 or 24-bit.
+    Mp3   ///< MP3 through io::Mp3StreamEncoder.
+};
+
+/**
+ * @brief Settings of Exporter::run().
+ */
+struct ExportOptions {
+    ExportFormat format = ExportFormat::Wav;
+
+    /// @brief Sample encoding of WAV (int_16, int_24, int_32, float_32) and FLAC (int_16, int_24) files.
+    BitDepth_t bitdepth = BitDepth_t::int_24;
+
+    /// @brief TPDF dither when the samples are reduced to integers.
+    bool dither = true;
+
+    /// @brief First frame of the session exported.
+    sample_c start = 0;
+
+    /// @brief Frames exported, 0 = up to the end of the session.
+    sample_c frames = 0;
+
+    /// @brief Blocks in flight between the stages (the render stage waits when they're all taken).
+    size_t inflightBlocks = kExportInflightBlocks;
+
+    /// @brief MP3 encoder settings (`inputSamplerate` and `planar` are set by the exporter).
+    io::Mp3StreamOptions mp3;
+};
+
+/**
+ * @brief Time every stage of the last export spent working (not waiting), in seconds.
+ *
+ * Pipelined, the export takes about as long as its slowest stage: `total` close to the
+ * largest of the others. Run inline, it takes their sum.
+ */
+struct ExportStats {
+    uint64_t blocks = 0;   ///< blocks exported.
+    double render = 0.0;   ///< mixing the session.
+    double convert = 0.0;  ///< dither and integer conversion (and the MP3 encoder, which does both).
+    double write = 0.0;    ///< encoding (libsndfile) and writing the file.
+    double total = 0.0;    ///< the whole export.
+    bool pipelined = false; ///< the stages ran on their own workers.
+};
+
+/**
+ * @class Exporter
+ * @brief Offline bounce of a session into a WAV, FLAC or MP3 file, as a pipeline.
+ *
+ * ### Design:
+ * - Three stages, linked by two `utils::Queue`s and recycling the blocks of one `BufferPool`
+ *   (`inflightBlocks` blocks of the mixer's block size):
+ *   - **render** (a pool worker): mixes a block into a free pool buffer, queues it;
+ *   - **convert** (a pool worker): dithers and converts the block to the file's integers, in place;
+ *   - **write** (the calling thread): hands the block to libsndfile, gives it back to the pool.
+ * - Rendering never waits on the encoder and the encoder never waits on the disk, until
+ *   every block is in flight: the export runs at the pace of the slowest stage.
+ * - MP3 files are written by `io::Mp3StreamEncoder::run()`, which pipelines conversion,
+ *   encoding and writing itself; its stages are queued while the render stage runs, so the tracks
+ *   of a block are mixed on the render stage's thread.
+ * - With fewer than two idle workers (three for MP3: render and the two encoder stages) the stages
+ *   run one after another, block by block.
+ *
+ * Typical usage:
+ * @code
+ * AJ::editing::session::Exporter exporter(session);
+ * ExportOptions options;
+ * options.format = ExportFormat::Flac;
+ * exporter.run("/exports/mix.flac", options, handler);
+ * @endcode
+ */
+class Exporter {
+    Session &mSession;
+    ExportStats mStats;
+
+public:
+    explicit Exporter(Session &session) : mSession(session) {}
+
+    /**
+     * @brief Export the session (or the range of the options) to `path`, overwriting it.
+     *
+     * The session must not be rendered elsewhere meanwhile: its mixer is used by the render stage.
+     *
+     * @return false (reported) on invalid options, if a track failed or if the file couldn't be written.
+     */
+    bool run(const std::string &path, const ExportOptions &options, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Stage timings of the last run().
+     */
+    const ExportStats& stats() const noexcept {
+        return mStats;
+    }
+};
+
+} // namespace AJ::editing::session
@@ -0,0 +1,252 @@
+#pragma once
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/buffer_pool.h"
+#include "core/thread_pool.h"
+#include "dsp/effect_chain.h"
+#include "editing/session/time_line.h"
+#include "editing/session/render_cache.h"
+
+namespace AJ::editing::session {
+
+/**
+ * @class Track
+ * @brief A time line of clips, an optional effect chain, and the track's gain / pan / mute.
+ *
+ * The chain runs on the track's stereo blocks with processBlock(), its stages' ranges are
+ * in time line frames. Rendering a block that doesn't follow the previous one (a seek)
+ * restarts the chain's state at the block.
+ *
+ * With a RenderCache, a block of a track with a chain is looked up before the chain runs
+ * (see render()). The cache can't see the parameters of the chain's stages: call
+ * chainChanged() after changing them, and disable the cache of a track whose stages take
+ * live parameters (setCached()).
+ */
+class Track {
+    TimeLine mTimeLine;
+    std::shared_ptr<dsp::EffectChain> pChain;
+    std::unique_ptr<dsp::EffectState> pChainState; ///< stereo state of pChain.
+    float mGain = 1.0f;
+    float mPan = 0.0f;
+    bool mMute = false;
+
+    static constexpr sample_c kNoBlock = std::numeric_limits<sample_c>::max();
+
+    bool mCached = true;
+    uint64_t mChainRevision;   ///< unique to this track and chain, part of the block keys.
+    sample_c mNext = kNoBlock; ///< frame after the last block looked up in the cache.
+    sample_c mOrigin = 0;      ///< first frame of the current stream, where a jump restarted it.
+    uint64_t mStreamKey = 0;   ///< key of the last block of the stream.
+
+    /**
+     * @brief Bring the chain's state from the stream's origin up to `position`, rendering the
+     * blocks before it (found in the cache) again, `frames` at a time.
+     */
+    bool warmUp(sample_c position, size_t frames, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief New chain revision, the cached blocks of the track are no longer found.
+     */
+    void newRevision() noexcept;
+
+    /**
+     * @brief Whether every stage of the chain processes a block on its own (no memory).
+     */
+    bool memoryless() const;
+
+public:
+    Track();
+
+    TimeLine& timeline() noexcept {
+        return mTimeLine;
+    }
+
+    const TimeLine& timeline() const noexcept {
+        return mTimeLine;
+    }
+
+    /**
+     * @brief Set the effect chain of the track (nullptr removes it).
+     * @return false (reported) if a stage doesn't support block processing.
+     */
+    bool setChain(std::shared_ptr<dsp::EffectChain> chain, AJ::error::IErrorHandler &handler);
+
+    std::shared_ptr<dsp::EffectChain> chain() const noexcept {
+        return pChain;
+    }
+
+    /**
+     * @brief The parameters of a stage of the chain changed: the chain's state starts again and
+     * its cached blocks are no longer used.
+     * @return false (reported) if the state can't be created.
+     */
+    bool chainChanged(AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Whether the track's blocks go through the mixer's render cache (default true).
+     */
+    void setCached(bool cached) noexcept {
+        mCached = cached;
+    }
+
+    bool cached() const noexcept {
+        return mCached;
+    }
+
+    /// @brief Track gain (linear).
+    void setGain(float gain) noexcept {
+        mGain = gain;
+    }
+
+    float gain() const noexcept {
+        return mGain;
+    }
+
+    /// @brief Pan from -1 (left) to 1 (right), constant power (-3 dB per side at 0).
+    void setPan(float pan) noexcept {
+        mPan = pan < -1.0f ? -1.0f : (pan > 1.0f ? 1.0f : pan);
+    }
+
+    float pan() const noexcept {
+        return mPan;
+    }
+
+    void setMute(bool mute) noexcept {
+        mMute = mute;
+    }
+
+    bool muted() const noexcept {
+        return mMute;
+    }
+
+    /**
+     * @brief Gains of the left and right side in the master (gain and pan).
+     */
+    void sideGains(float &left, float &right) const noexcept;
+
+    /**
+     * @brief Render `frames` interleaved stereo frames of the track from `position` into `out`
+     * (clips, then the chain), before gain and pan.
+     *
+     * With a `cache` the clips are mixed and hashed, and the chain only runs if no block has
+     * the same key. A chain with memory keys its blocks on the whole stream since the last
+     * jump; after a block found in the cache, the next block rendered brings the chain's state
+     * up to date first (warmUp()).
+     *
+     * @return false (reported) if the chain failed.
+     */
+    bool render(float *out, sample_c position, size_t frames, AJ::error::IErrorHandler &handler,
+        RenderCache *cache = nullptr);
+};
+
+/**
+ * @class Mixer
+ * @brief Renders the tracks of a session block by block and sums them into the master.
+ *
+ * ### Design:
+ * - Every track of a block is rendered into a buffer of the mixer's `BufferPool`, one task
+ *   per track on the thread pool: 64 tracks keep every core busy.
+ * - The master is then summed slice by slice (kMixSumFrames frames per task) with the
+ *   `mixAdd` kernel, every track in turn, with its gain and pan.
+ * - Each step joins on the atomic counter of `ThreadPool::parallel_for()`, no lock per block.
+ *   The calling thread works too, so mixing from inside a pool task doesn't dead lock.
+ *
+ * The pool buffers are taken and given back by the calling thread only (the pool is a
+ * single consumer queue): mix() must not be called from two threads at once.
+ *
+ * @warning After construction, check isValid().
+ */
+class Mixer {
+    /// @brief A track rendered in a block, into a pool buffer.
+    struct Slot {
+        Track *track = nullptr;
+        utils::Buffer *buffer = nullptr;
+        float left = 1.0f;
+        float right = 1.0f;
+    };
+
+    std::vector<std::shared_ptr<Track>> mTracks;
+    std::shared_ptr<RenderCache> pCache;
+    size_t mMaxTracks;
+    size_t mBlockFrames;
+    utils::BufferPool mPool; ///< one stereo block per track.
+
+    //? reserved for mMaxTracks at construction: mixing a block doesn't allocate.
+    std::vector<Slot> mSlots;
+    std::vector<AJ::error::CollectingErrorHandler> mErrors; ///< per slot, the handler isn't required to be thread-safe.
+    std::vector<char> mSucceeded;
+
+public:
+    /**
+     * @param handler      Error handler for reporting the pool allocation.
+     * @param max_tracks   maximum number of tracks (default kMixMaxTracks).
+     * @param block_frames frames per block (default kMixBlockFrames).
+     */
+    explicit Mixer(AJ::error::IErrorHandler &handler, size_t max_tracks = kMixMaxTracks,
+        size_t block_frames = kMixBlockFrames);
+
+    bool isValid() {
+        return mPool.isValid();
+    }
+
+    /**
+     * @brief Add an empty track.
+     * @return the track, nullptr (reported) if the mixer has max_tracks tracks.
+     */
+    std::shared_ptr<Track> addTrack(AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Remove a track.
+     * @return false if it isn't a track of this mixer.
+     */
+    bool removeTrack(const std::shared_ptr<Track> &track);
+
+    const std::vector<std::shared_ptr<Track>>& tracks() const noexcept {
+        return mTracks;
+    }
+
+    size_t maxTracks() const noexcept {
+        return mMaxTracks;
+    }
+
+    size_t blockFrames() const noexcept {
+        return mBlockFrames;
+    }
+
+    /**
+     * @brief Cache of rendered track blocks (nullptr = every block is rendered), see RenderCache.
+     *
+     * It can be shared by several mixers, the keys of their tracks don't collide.
+     */
+    void setRenderCache(std::shared_ptr<RenderCache> cache) {
+        pCache = std::move(cache);
+    }
+
+    std::shared_ptr<RenderCache> renderCache() const noexcept {
+        return pCache;
+    }
+
+    /**
+     * @brief Frame after the end of the last clip of every track.
+     */
+    sample_c length() const noexcept;
+
+    /**
+     * @brief Mix `frames` (<= blockFrames()) frames from `position` into `master`, interleaved stereo.
+     *
+     * @param master  2 · frames floats, overwritten.
+     * @param pool    thread pool the tracks and the slices are run on (nullptr = calling thread).
+     * @param handler Error handler, the errors of the tracks are reported after the block.
+     * @return false (reported) if a track's chain failed, the master is then incomplete.
+     */
+    bool mix(float *master, sample_c position, size_t frames, utils::ThreadPool *pool,
+        AJ::error::IErrorHandler &handler);
+};
+
+} // namespace AJ::editing::session
@@ -0,0 +1,160 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+
+namespace AJ::editing::session {
+
+/**
+ * @class RenderCache
+ * @brief Rendered track blocks of a mixer (clips and chain, before gain and pan), by content key.
+ *
+ * A track block is keyed by a hash of what produced it: the samples of its clips over the
+ * block, the block's position, the track's chain revision and, for a chain with memory, the
+ * key of the block before it. A mix after a change of gain, pan or mute, or of one track,
+ * then only renders the blocks whose key changed (see Track::render()).
+ *
+ * The blocks in memory are capped by a budget. Over it the least recently used are spilled
+ * to the spill directory (e.g. the session directory) and read back when used again, or
+ * dropped if no directory is set. Spilled blocks are capped too, the oldest files are deleted.
+ *
+ * The tracks of a block are rendered on the thread pool: every method locks the cache.
+ *
+ * Typical usage:
+ * @code
+ * auto cache = std::make_shared<AJ::editing::session::RenderCache>(AJ::kMixCacheBudget, sessionDir);
+ * session.mixer().setRenderCache(cache);
+ * session.render(0, frames, out, handler);   // renders every track.
+ * vocals->setGain(0.8f);
+ * session.render(0, frames, out, handler);   // only sums the cached blocks again.
+ * @endcode
+ */
+class RenderCache {
+    /// @brief A block, in memory (`samples`) or spilled (`path`).
+    struct Entry {
+        std::vector<float> samples;      ///< 2 · frames interleaved floats, empty while spilled.
+        size_t frames = 0;
+        std::string path;                ///< spill file, empty while in memory.
+        std::list<uint64_t>::iterator lru; ///< in mResident or mSpilled.
+    };
+
+    mutable std::mutex mMux;
+    std::unordered_map<uint64_t, Entry> mEntries;
+    std::list<uint64_t> mResident; ///< keys in memory, most recently used first.
+    std::list<uint64_t> mSpilled;  ///< keys on disk, most recently spilled first.
+
+    size_t mBudget;
+    size_t mSpillBudget = kMixCacheSpillBudget;
+    size_t mResidentBytes = 0;
+    size_t mSpilledBytes = 0;
+    std::string mDirectory;
+    uint64_t mNextSpill = 0;
+
+    std::atomic<uint64_t> mHits{ 0 };
+    std::atomic<uint64_t> mMisses{ 0 };
+
+    /**
+     * @brief Spill (or drop) the least recently used blocks until the memory fits the budget,
+     * then delete the oldest spilled blocks until the disk fits its own.
+     */
+    void enforce(AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Remove an entry, its spill file included.
+     */
+    void erase(std::unordered_map<uint64_t, Entry>::iterator it);
+
+    std::string spillPath();
+
+public:
+    /**
+     * @param budget    bytes of blocks kept in memory.
+     * @param directory directory blocks are spilled to over the budget, "" drops them instead.
+     */
+    explicit RenderCache(size_t budget = kMixCacheBudget, std::string directory = "") :
+        mBudget(budget), mDirectory(std::move(directory)) {}
+
+    /**
+     * @brief Removes the spill files.
+     */
+    ~RenderCache();
+
+    RenderCache(const RenderCache&) = delete;
+    RenderCache& operator=(const RenderCache&) = delete;
+
+    /**
+     * @brief Copy the block of `key` into `out` (2 · frames floats), a spilled block is read back.
+     * @return false if there is no such block of `frames` frames (a miss).
+     */
+    bool find(uint64_t key, float *out, size_t frames, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Keep a copy of a rendered block (2 · frames interleaved floats) under `key`.
+     */
+    void store(uint64_t key, const float *block, size_t frames, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Drop every block, in memory and spilled.
+     */
+    void clear();
+
+    void setBudget(size_t bytes, AJ::error::IErrorHandler &handler);
+
+    size_t budget() const;
+
+    /**
+     * @brief Bytes of spilled blocks kept on disk, the oldest are deleted over it.
+     */
+    void setSpillBudget(size_t bytes, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Directory blocks are spilled to, "" drops them instead.
+     */
+    void setSpillDirectory(const std::string &directory);
+
+    /**
+     * @brief Bytes of blocks in memory.
+     */
+    size_t residentBytes() const;
+
+    /**
+     * @brief Bytes of blocks spilled to disk.
+     */
+    size_t spilledBytes() const;
+
+    /**
+     * @brief Number of blocks, in memory and spilled.
+     */
+    size_t size() const;
+
+    /// @brief find() calls that found their block.
+    uint64_t hits() const noexcept {
+        return mHits.load(std::memory_order_relaxed);
+    }
+
+    /// @brief find() calls that didn't.
+    uint64_t misses() const noexcept {
+        return mMisses.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 64-bit hash of `count` floats (their bits: -0.0f and 0.0f differ), from `seed`.
+     */
+    static uint64_t hash(const float *data, size_t count, uint64_t seed) noexcept;
+
+    /**
+     * @brief Mix a value into a key.
+     */
+    static uint64_t combine(uint64_t key, uint64_t value) noexcept;
+};
+
+} // namespace AJ::editing::session
@@ -0,0 +1,107 @@
+#pragma once
+#include <memory>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+#include "file_io/audio_file.h"
+#include "editing/session/mixer.h"
+
+namespace AJ::editing::session {
+
+/**
+ * @class Session
+ * @brief A multi-track session: tracks of clips placed on a time line, mixed to stereo.
+ *
+ * The session renders in blocks of the mixer's block size, each block on the thread pool
+ * (see Mixer). Rendering reads the clip sources, which must not be edited meanwhile.
+ *
+ * Typical usage:
+ * @code
+ * AJ::editing::session::Session session(48000, handler, resources->threadPool());
+ *
+ * auto vocals = session.addTrack(handler);
+ * vocals->timeline().add(Clip{ take, 0, take->channelFrames(), 48000 }, handler);
+ * vocals->setChain(vocalChain, handler);
+ * vocals->setPan(-0.3f);
+ *
+ * session.render(0, 4096, out, handler);   // 4096 interleaved stereo frames.
+ * session.bounce(*mixdown, handler);       // the whole session into a file.
+ * @endcode
+ */
+class Session {
+    sample_c mSamplerate;
+    Mixer mMixer;
+    std::shared_ptr<utils::ThreadPool> pThreadPool; ///< nullptr = render on the calling thread.
+
+public:
+    /**
+     * @param samplerate   sample rate of the session (clips are played at their own rate as is).
+     * @param handler      Error handler for reporting the mixer's allocation.
+     * @param pool         thread pool the blocks are rendered on (nullptr = calling thread).
+     * @param max_tracks   maximum number of tracks (default kMixMaxTracks).
+     * @param block_frames frames per block (default kMixBlockFrames).
+     */
+    Session(sample_c samplerate, AJ::error::IErrorHandler &handler, std::shared_ptr<utils::ThreadPool> pool = nullptr,
+        size_t max_tracks = kMixMaxTracks, size_t block_frames = kMixBlockFrames) :
+        mSamplerate(samplerate), mMixer(handler, max_tracks, block_frames), pThreadPool(std::move(pool)) {}
+
+    bool isValid() {
+        return mMixer.isValid();
+    }
+
+    sample_c samplerate() const noexcept {
+        return mSamplerate;
+    }
+
+    Mixer& mixer() noexcept {
+        return mMixer;
+    }
+
+    /**
+     * @brief Thread pool the session renders on (nullptr = calling thread).
+     */
+    std::shared_ptr<utils::ThreadPool> threadPool() const noexcept {
+        return pThreadPool;
+    }
+
+    /**
+     * @brief Add an empty track (see Mixer::addTrack()).
+     */
+    std::shared_ptr<Track> addTrack(AJ::error::IErrorHandler &handler) {
+        return mMixer.addTrack(handler);
+    }
+
+    bool removeTrack(const std::shared_ptr<Track> &track) {
+        return mMixer.removeTrack(track);
+    }
+
+    const std::vector<std::shared_ptr<Track>>& tracks() const noexcept {
+        return mMixer.tracks();
+    }
+
+    /**
+     * @brief Frames of the session, up to the end of its last clip.
+     */
+    sample_c length() const noexcept {
+        return mMixer.length();
+    }
+
+    /**
+     * @brief Render `frames` interleaved stereo frames from `position` into `out` (2 · frames floats).
+     * @return false (reported) if a track failed.
+     */
+    bool render(sample_c position, size_t frames, float *out, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Render the whole session (length() frames) into `file`, as stereo Float32 samples
+     * at the session's sample rate. The previous samples of the file are replaced.
+     *
+     * @return false (reported) if the file is compact or a track failed (the file is left unchanged).
+     */
+    bool bounce(io::AudioFile &file, AJ::error::IErrorHandler &handler);
+};
+
+} // namespace AJ::editing::session
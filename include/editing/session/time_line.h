@@ -0,0 +1,90 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "file_io/audio_file.h"
+
+namespace AJ::editing::session {
+
+/**
+ * @struct Clip
+ * @brief A reference to `frames` frames of a source file, placed at `position` on a time line.
+ *
+ * The samples stay in the source (in any storage), a clip only reads them: the same file
+ * can be placed many times, on any number of tracks.
+ */
+struct Clip {
+    std::shared_ptr<io::AudioFile> source; ///< file the samples are read from (mono or stereo).
+    sample_c sourceStart = 0;              ///< first frame of the source.
+    sample_c frames = 0;                   ///< frames of the clip.
+    sample_c position = 0;                 ///< time line frame the clip starts at.
+    float gain = 1.0f;                     ///< clip gain (linear).
+};
+
+/**
+ * @class TimeLine
+ * @brief The clips of a track, kept sorted by position.
+ *
+ * Clips may overlap, their samples are summed. A mono source plays on both sides.
+ *
+ * Typical usage:
+ * @code
+ * AJ::editing::session::TimeLine timeline;
+ * timeline.add(Clip{ file, 0, 48000, 96000 }, handler); // first second of the file at 2 s.
+ * timeline.mix(block, 96000, 4096);                      // block += 4096 stereo frames from 2 s.
+ * @endcode
+ */
+class TimeLine {
+    std::vector<Clip> mClips; ///< sorted by position.
+    sample_c mLongest = 0;    ///< frames of the longest clip, bounds the clips that can reach a block.
+
+public:
+    TimeLine() = default;
+
+    /**
+     * @brief Place a clip.
+     * @return false (reported) if the clip has no source or frames, if its source range is
+     *         outside the file, or if the file has more than 2 channels.
+     */
+    bool add(Clip clip, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Remove the clip at `index` (in position order).
+     * @return false if there is no such clip.
+     */
+    bool remove(size_t index);
+
+    void clear() noexcept {
+        mClips.clear();
+        mLongest = 0;
+    }
+
+    /**
+     * @brief The clips, in position order.
+     */
+    const std::vector<Clip>& clips() const noexcept {
+        return mClips;
+    }
+
+    size_t size() const noexcept {
+        return mClips.size();
+    }
+
+    /**
+     * @brief Frame after the end of the last clip (0 if empty).
+     */
+    sample_c length() const noexcept;
+
+    /**
+     * @brief Add the clips over [position, position + frames) to `out`, interleaved stereo.
+     *
+     * Reads the sources in any storage, through the calling thread's scratch arena. The
+     * sources must not be changed while a time line is mixed.
+     */
+    void mix(float *out, sample_c position, size_t frames) const;
+};
+
+} // namespace AJ::editing::session
@@ -0,0 +1,103 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+#include "file_io/audio_file.h"
+#include "undo_system/state.h"
+
+namespace AJ::editing::transaction {
+
+/**
+ * @class Transaction
+ * @brief A batch of cuts and inserts applied to a file in one pass.
+ *
+ * Every edit is given in frames of the file **before** the transaction, so a cut list
+ * (e.g. the ums of a transcript) can be recorded as it is, in any order. commit() sorts the
+ * edits and builds every channel once: one allocation of the final length, filled by a
+ * linear gather of the kept ranges and the inserted buffers, with `mInfo.length` and the
+ * level index updated once. A cut list of N regions costs one pass over the file instead
+ * of N.
+ *
+ * - overlapping or adjacent cuts are merged;
+ * - inserts at the same frame keep the order they were recorded in;
+ * - an insert at the first frame of a cut goes before it, an insert inside a cut is rejected.
+ *
+ * Typical usage:
+ * @code
+ * AJ::editing::transaction::Transaction edits;
+ * edits.cut(48000, 52799, handler);
+ * edits.cut(12000, 13199, handler);
+ * edits.insert(96000, jingle, handler);
+ * edits.commit(file, handler, pool);
+ * @endcode
+ */
+class Transaction {
+    /**
+     * @brief A cut (`removed` frames, no audio) or an insert (`audio`, nothing removed) at `at`.
+     */
+    struct Edit {
+        sample_c at = 0;
+        sample_c removed = 0;
+        AudioSamples audio;
+    };
+
+    std::vector<Edit> mEdits;
+
+public:
+    Transaction() = default;
+
+    /**
+     * @brief Record the removal of the frames [start, end] (inclusive, like Cut).
+     * @return false (reported) if start < 0 or end < start.
+     */
+    bool cut(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Record the insertion of `audio` before frame `at` (the frame count appends).
+     *
+     * The buffer is read by commit(), it must not be changed until then.
+     *
+     * @return false (reported) if `at` < 0 or the buffer is empty.
+     */
+    bool insert(sample_pos at, AudioSamples audio, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Apply the recorded edits to `file` and clear them.
+     *
+     * The file must be in Float32 storage, the edits inside it and the inserted buffers of
+     * its channel count. Nothing is changed if any of that fails.
+     *
+     * @param file    the file to edit.
+     * @param handler Error handler for reporting invalid edits.
+     * @param pool    thread pool the channels are gathered on, in pieces of kParallelChunkFrames
+     *                (nullptr = calling thread).
+     * @param state   if not nullptr, the edits are added to it (see undo::State) before they're made.
+     * @return true on success; false on failure (the edits are kept).
+     */
+    bool commit(std::shared_ptr<io::AudioFile> file, AJ::error::IErrorHandler &handler,
+        utils::ThreadPool *pool = nullptr, undo::State *state = nullptr);
+
+    /**
+     * @brief Number of recorded edits.
+     */
+    size_t size() const noexcept {
+        return mEdits.size();
+    }
+
+    bool empty() const noexcept {
+        return mEdits.empty();
+    }
+
+    /**
+     * @brief Drop the recorded edits.
+     */
+    void clear() noexcept {
+        mEdits.clear();
+    }
+};
+
+} // namespace AJ::editing::transaction
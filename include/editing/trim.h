@@ -0,0 +1,81 @@
+#pragma once
+#include <memory>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+#include "file_io/audio_file.h"
+#include "editing/transaction.h"
+#include "undo_system/state.h"
+
+namespace AJ::editing::trim {
+
+/**
+ * @brief What an AutoTrim considers silence and how much of it is kept.
+ */
+struct Options {
+    float mThresholdDb = kTrimThresholdDb;    ///< silence level in dBFS, [kGateMinThresholdDb, 0].
+    float mMinSilenceMs = kTrimMinSilenceMs;  ///< shorter silences are kept, > 0.
+    float mPadMs = kTrimPadMs;                ///< silence kept next to the sound on each side, >= 0.
+    bool mInner = false;                      ///< also shorten the silences between sounds to 2 · pad.
+};
+
+/**
+ * @class AutoTrim
+ * @brief Removes the leading and trailing silence of a file (and optionally shortens the inner silences).
+ *
+ * The silent regions come from AudioFile::silences() (the level index spares the reads of quiet
+ * blocks), every removal is recorded in a transaction::Transaction, and the cuts are made in one
+ * pass over the file. A file that is silent throughout is left alone.
+ *
+ * Typical usage:
+ * @code
+ * AJ::editing::trim::AutoTrim trim;
+ * trim.setOptions({ -50.0f, 200.0f, 10.0f, false }, handler);
+ * trim.process(file, handler, pool);
+ * @endcode
+ */
+class AutoTrim {
+    Options mOptions;
+
+public:
+    AutoTrim() = default;
+
+    /**
+     * @brief Set the options.
+     * @return false (reported) if a value is out of its range, the options are unchanged then.
+     */
+    bool setOptions(const Options &options, AJ::error::IErrorHandler &handler);
+
+    const Options& options() const noexcept {
+        return mOptions;
+    }
+
+    /**
+     * @brief Record the cuts of the silences of `file` in `edits`, nothing is changed yet.
+     *
+     * @param file    the file to scan.
+     * @param edits   [out] the transaction the cuts are added to.
+     * @param removed [out] frames the cuts remove.
+     * @param handler Error handler for reporting a failed scan.
+     * @return true on success; false on failure.
+     */
+    bool record(const io::AudioFile &file, transaction::Transaction &edits, sample_c &removed,
+        AJ::error::IErrorHandler &handler) const;
+
+    /**
+     * @brief Trim `file` in-place.
+     *
+     * @param file    the file to trim (Float32 storage, see Transaction::commit()).
+     * @param handler Error handler for reporting errors.
+     * @param pool    thread pool the channels are rebuilt on (nullptr = calling thread).
+     * @param state   if not nullptr, the cuts are added to it (see undo::State).
+     * @return true on success (also when there's nothing to trim); false on failure.
+     */
+    bool process(std::shared_ptr<io::AudioFile> file, AJ::error::IErrorHandler &handler,
+        utils::ThreadPool *pool = nullptr, undo::State *state = nullptr) const;
+};
+
+} // namespace AJ::editing::trim
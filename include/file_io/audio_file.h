@@ -1,9 +1,15 @@
 #pragma once
 #include <iostream>
+#include <memory>
 
 #include "core/types.h"
 #include "core/error_handler.h"
+#include "core/thread_pool.h"
 #include "file_io/file_utils.h"
+#include "file_io/level_index.h"
+#include "file_io/spectrogram.h"
+#include "file_io/compact_samples.h"
+#include "dsp/silence.h"
 
 namespace AJ::io {
 
@@ -19,6 +25,18 @@ protected:
     std::string mFileName;     ///< File name including extension.
     std::string mFilePath;     ///< Full directory path (including file name).
     AudioWriteInfo mWriteInfo; ///< Information required for writing files.
+    std::unique_ptr<LevelIndex> pLevelIndex; ///< optional peak / RMS summary of pAudio (nullptr if not built).
+    std::shared_ptr<Spectrogram> pSpectrogram; ///< optional spectrogram tile cache (nullptr if not attached).
+    sample_pos mRangeStart = 0; ///< frame of the source file stored at pAudio[ch][0].
+    sample_c mSourceFrames = 0; ///< frames per channel of the source file when it was read.
+    std::unique_ptr<CompactSamples> pCompact; ///< 16-bit samples when storage() isn't Float32 (`pAudio` is empty then).
+    utils::ThreadPool *pReadPool = nullptr; ///< workers read() may hand conversion work to, see setReadPool().
+
+    /**
+     * @brief Validate the [start, end] range of readRange() (end -1 = to the end of the file).
+     * @return false (reported) if start is negative or end is before start.
+     */
+    static bool checkRange(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler);
 
 public:
     AudioSamples pAudio;       ///< Pointer to multichannel audio buffer.
@@ -45,6 +63,43 @@ public:
      */
     virtual bool read(AJ::error::IErrorHandler &handler) = 0;
 
+    /**
+     * @brief Workers the next read() / readRange() may hand the conversion to, so it overlaps
+     * the reads of the file (nullptr = everything on the calling thread, the default).
+     *
+     * Safe to call from a worker of `pool` itself, the reader helps with the pool's tasks while
+     * it waits. The pool must outlive the read.
+     */
+    void setReadPool(utils::ThreadPool *pool) noexcept {
+        pReadPool = pool;
+    }
+
+    /**
+     * @brief Reads the frames [start, end] of the file into memory, skipping everything else.
+     *
+     * The file is seeked to `start` instead of being read from the beginning, so the cost
+     * follows the size of the range, not of the file. `mInfo.length` is the length of the range,
+     * rangeStart() / sourceFrames() tell where the range sits in the file.
+     *
+     * This method must be implemented by derived classes.
+     *
+     * @param start first frame to read.
+     * @param end last frame to read (inclusive), -1 or past the end of the file reads to the end.
+     * @param handler Reference to an error handler for reporting read issues.
+     * @return true on success; false on failure or if `start` is past the end of the file.
+     */
+    virtual bool readRange(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler) = 0;
+
+    /**
+     * @brief Reads only the metadata of the file into `mInfo`, `pAudio` is left untouched.
+     *
+     * This method must be implemented by derived classes.
+     *
+     * @param handler Reference to an error handler for reporting read issues.
+     * @return true on success; false on failure.
+     */
+    virtual bool probe(AJ::error::IErrorHandler &handler) = 0;
+
     /**
      * @brief Writes the audio buffer to disk using format-specific logic.
      * 
@@ -59,7 +114,8 @@ public:
      * @brief Sets the necessary metadata for writing the file.
      * 
      * Validates and assigns write-related information like file name, sample rate, format, etc.
-     * Only WAV and MP3 formats are supported.
+     * Only WAV and MP3 formats are supported. WAV files take any samplerate in
+     * [kMinSamplerate, kMaxSamplerate], MP3 files the MPEG ones (8 kHz to 48 kHz).
      * 
      * @param info Audio write metadata.
      * @param handler Error handler for reporting validation issues.
@@ -67,6 +123,27 @@ public:
      */
     bool setWriteInfo(const AJ::AudioWriteInfo& info, AJ::error::IErrorHandler &handler);
 
+    /**
+     * @brief Write settings given to setWriteInfo().
+     */
+    const AJ::AudioWriteInfo& writeInfo() const noexcept {
+        return mWriteInfo;
+    }
+
+    /**
+     * @brief Convert the samples to another samplerate (dsp::resample, windowed-sinc polyphase).
+     *
+     * The channels are replaced by their converted copies and `mInfo` is updated; compact samples
+     * are converted as floats and narrowed back. write() calls this when the write samplerate
+     * differs from `mInfo.samplerate`, so the file is left at the written rate.
+     *
+     * @param samplerate target rate in [kMinSamplerate, kMaxSamplerate].
+     * @param pool thread pool converting segments of long channels in parallel (nullptr = caller thread).
+     * @param handler Error handler for reporting unsupported rates.
+     * @return true on success (or if the rate is already `samplerate`); false otherwise.
+     */
+    bool resample(sample_c samplerate, utils::ThreadPool *pool, AJ::error::IErrorHandler &handler);
+
     /**
      * @brief Retrieves the file name (with extension).
      * @return File name string.
@@ -83,6 +160,29 @@ public:
         return mFilePath;
     }
 
+    /**
+     * @brief Frame of the source file held at frame 0 of `pAudio`, 0 unless it was loaded with readRange().
+     */
+    sample_pos rangeStart() const noexcept {
+        return mRangeStart;
+    }
+
+    /**
+     * @brief Frames per channel of the whole source file when it was read.
+     *
+     * Estimated from the stream duration for compressed files loaded with readRange().
+     */
+    sample_c sourceFrames() const noexcept {
+        return mSourceFrames;
+    }
+
+    /**
+     * @brief Whether `pAudio` holds only part of the source file.
+     */
+    bool isPartial() const noexcept {
+        return mRangeStart != 0 || pAudio->at(0).size() < mSourceFrames;
+    }
+
     /**
      * @brief Sets the file name after trimming whitespace.
      * @param name File name string (should include extension).
@@ -108,6 +208,160 @@ public:
         }
         return false;
     }
+
+    /**
+     * @brief Build (or rebuild) the level index of every channel in one pass.
+     *
+     * Once built, the index must follow the samples: Cut, Insert and the engine's
+     * applyEffect / applyEffectChain update it, code that edits `pAudio` directly
+     * must call updateLevelIndex(). Does nothing while the samples are compact.
+     */
+    void buildLevelIndex();
+
+    /**
+     * @brief Drop the level index (queries fall back to scanning the samples).
+     */
+    void dropLevelIndex() noexcept {
+        pLevelIndex.reset();
+    }
+
+    /**
+     * @brief Level index of the file, nullptr if it was not built.
+     */
+    const LevelIndex* levelIndex() const noexcept {
+        return pLevelIndex.get();
+    }
+
+    /**
+     * @brief Attach a spectrogram tile cache, nullptr detaches it.
+     *
+     * Its tiles follow the samples like the level index: the edits that call updateLevelIndex()
+     * drop the tiles they touch, buildLevelIndex() and resample() drop them all.
+     */
+    void setSpectrogram(std::shared_ptr<Spectrogram> spectrogram) noexcept {
+        pSpectrogram = std::move(spectrogram);
+    }
+
+    /**
+     * @brief Spectrogram tile cache of the file, nullptr if none is attached.
+     */
+    const std::shared_ptr<Spectrogram>& spectrogram() const noexcept {
+        return pSpectrogram;
+    }
+
+    /**
+     * @brief Refresh the level index after the frames [start, end] of every channel changed.
+     *
+     * Also drops the spectrogram tiles of the range. Does nothing else if the index was not built.
+     *
+     * @param start first changed frame.
+     * @param end   last changed frame (inclusive), -1 if everything after `start` moved (cut / insert).
+     */
+    void updateLevelIndex(sample_pos start, sample_pos end = -1);
+
+    /**
+     * @brief How the samples are kept in memory (Float32 unless setStorage() changed it).
+     */
+    SampleStorage storage() const noexcept {
+        return pCompact ? pCompact->storage() : SampleStorage::Float32;
+    }
+
+    /**
+     * @brief Keep the samples as int16 or half (half the memory of float), or widen them back.
+     *
+     * While compact, `pAudio` is empty: readFrames() / writeFrames() widen and narrow blocks,
+     * and the engine's applyEffect, applyEffectChain and saveAudio work on any storage.
+     * Code that uses `pAudio` directly (Cut, Insert) must switch back to Float32 first, playback
+     * widens blocks as it reads.
+     * The level index is dropped when the samples are compacted (levels() scans them).
+     *
+     * @param storage Float32 widens the samples back into `pAudio`.
+     * @param handler Error handler for reporting channels of different lengths.
+     * @return true on success; false on failure.
+     */
+    bool setStorage(SampleStorage storage, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Frames per channel of the samples, in any storage.
+     */
+    size_t channelFrames() const noexcept {
+        return pCompact ? pCompact->frames() : (*pAudio)[0].size();
+    }
+
+    /**
+     * @brief Bytes of memory taken by the samples.
+     */
+    size_t residentBytes() const noexcept;
+
+    /**
+     * @brief Widen `count` frames of a channel from `start` into `out`, in any storage
+     * (the range must be inside the channel).
+     */
+    void readFrames(uint8_t channel, size_t start, size_t count, float *out) const;
+
+    /**
+     * @brief Store `count` frames of a channel at `start`, narrowed if the samples are compact
+     * (the range must be inside the channel).
+     */
+    void writeFrames(uint8_t channel, size_t start, size_t count, const float *in);
+
+    /**
+     * @brief Min, max and sum of squares of the frames [start, end] of a channel.
+     *
+     * Uses the level index if built, otherwise scans the samples.
+     *
+     * @param channel channel index.
+     * @param start   first frame.
+     * @param end     last frame (inclusive).
+     * @param levels  [out] levels of the range.
+     * @param handler Error handler for reporting an invalid channel or range.
+     * @return true on success; false on failure.
+     */
+    bool levels(uint8_t channel, sample_pos start, sample_pos end, dsp::kernels::Levels &levels,
+        AJ::error::IErrorHandler &handler) const;
+
+    /**
+     * @brief Stretches of at least `minFrames` frames where every channel stays at or under `thresholdDb`.
+     *
+     * With a level index the pyramid is walked from its coarsest level: blocks whose peak is under
+     * the threshold are skipped without reading a sample, only the samples of the loud base blocks
+     * go through the dsp::silence::Scanner. Compact samples are widened a chunk at a time.
+     *
+     * @param thresholdDb silence level in dBFS, [kGateMinThresholdDb, 0].
+     * @param minFrames   shortest silence reported, at least 1.
+     * @param regions     [out] silent regions, in order.
+     * @param handler     Error handler for reporting an invalid threshold or a failed allocation.
+     * @return true on success; false on failure.
+     */
+    bool silences(float thresholdDb, size_t minFrames, std::vector<dsp::silence::Region> &regions,
+        AJ::error::IErrorHandler &handler) const;
+
+    /**
+     * @brief Integrated loudness and true peak of the frames [start, end] of all channels (dsp::loudness::measure()).
+     *
+     * With a level index the measurement is cached until the range changes, so measuring the
+     * same range again (e.g. normalizing to another target) doesn't read the samples.
+     * Compact samples are widened a range at a time for the measurement.
+     *
+     * @param start       first frame.
+     * @param end         last frame (inclusive).
+     * @param measurement [out] loudness of the range.
+     * @param pool        thread pool for the measurement, nullptr to measure on the calling thread.
+     * @param handler     Error handler for reporting an invalid range or a failed allocation.
+     * @return true on success; false on failure.
+     */
+    bool loudness(sample_pos start, sample_pos end, dsp::loudness::Measurement &measurement,
+        utils::ThreadPool *pool, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Cache a loudness of [start, end] known without measuring it (e.g. after a plain gain).
+     * Does nothing if the level index was not built.
+     */
+    void cacheLoudness(sample_pos start, sample_pos end, const dsp::loudness::Measurement &measurement){
+        if(pLevelIndex){
+            pLevelIndex->storeLoudness(start, end, static_cast<uint32_t>(mInfo.samplerate), measurement);
+        }
+    }
 };
 
 } // namespace AJ::io
@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+
+namespace AJ::io {
+
+/**
+ * @brief How an AudioFile keeps its samples in memory.
+ */
+enum class SampleStorage : uint8_t {
+    Float32, ///< float channels in `pAudio` (default).
+    Int16,   ///< 16-bit integers `n / 32768`, exact for 16-bit sources.
+    Float16  ///< IEEE 754 half, about 11 bits of precision whatever the level.
+};
+
+/**
+ * @class CompactSamples
+ * @brief Planar channels kept as 16-bit samples (int16 or half), half the size of float32.
+ *
+ * Samples are widened to float (and narrowed back) block by block with the SIMD conversion
+ * kernels, so only the block being processed or written exists as float.
+ * Narrowing rounds to nearest, int16 clips to [-1, 1 - 2^-15].
+ */
+class CompactSamples {
+    SampleStorage mStorage = SampleStorage::Int16;
+    uint8_t mChannels = 0;
+    size_t mFrames = 0;
+    std::array<std::vector<uint16_t>, kNumChannels> mData; ///< int16 or half bits per channel.
+
+public:
+    /**
+     * @brief Narrow the first `channels` channels of `audio` into `storage`.
+     * @return false if `storage` is Float32, the channel count is invalid or the channels have different lengths.
+     */
+    bool pack(const AudioBuffer &audio, uint8_t channels, SampleStorage storage);
+
+    /**
+     * @brief Widen every channel into `audio` (resized to frames()).
+     */
+    void unpack(AudioBuffer &audio) const;
+
+    /**
+     * @brief Widen `count` frames of a channel from `start` into `out` (the range must be in the channel).
+     */
+    void read(uint8_t channel, size_t start, size_t count, float *out) const;
+
+    /**
+     * @brief Narrow `count` frames from `in` into a channel at `start` (the range must be in the channel).
+     */
+    void write(uint8_t channel, size_t start, size_t count, const float *in);
+
+    SampleStorage storage() const noexcept {
+        return mStorage;
+    }
+
+    uint8_t channels() const noexcept {
+        return mChannels;
+    }
+
+    /// @brief Frames per channel.
+    size_t frames() const noexcept {
+        return mFrames;
+    }
+
+    /// @brief Bytes taken by the samples.
+    size_t bytes() const noexcept {
+        return mFrames * mChannels * sizeof(uint16_t);
+    }
+};
+
+}
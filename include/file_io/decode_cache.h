@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <utility>
+
+namespace AJ::io {
+
+class AudioFile;
+class SeekIndex;
+
+/**
+ * @class DecodeCache
+ * @brief On-disk cache of decoded audio, so a compressed file is decoded once and mapped afterwards.
+ *
+ * One entry per source file in `directory`, named after a hash of the source path. An entry holds
+ * a fixed header (source size and modification time, the AudioInfo fields, the source path) followed
+ * by the planar float32 channels, each starting on a page boundary so they can be mapped as they are.
+ *
+ * An entry is only used if the size and modification time recorded in it still match the source,
+ * a changed source is decoded again and its entry replaced. store() writes a temporary file and
+ * renames it, so a concurrent or interrupted store never leaves a half written entry behind.
+ *
+ * The seek index of a source (SeekIndex) is kept in a second, small entry next to it, so a
+ * compressed file opened for streaming or a range seeks exactly without a demux pass.
+ *
+ * The cache is best effort: load() and store() return false instead of reporting errors,
+ * the caller falls back to decoding the file.
+ */
+class DecodeCache {
+    std::string mDirectory; ///< directory holding the entries.
+
+public:
+    /**
+     * @param directory directory of the entries, created by store() if it doesn't exist.
+     */
+    explicit DecodeCache(std::string directory) : mDirectory(std::move(directory)) {}
+
+    const std::string& directory() const noexcept {
+        return mDirectory;
+    }
+
+    /**
+     * @brief Path of the entry of a source file (whether it exists or not).
+     */
+    std::string entryPath(const std::string& source) const;
+
+    /**
+     * @brief Fill `audio.mInfo` and `audio.pAudio` from the entry of `source`.
+     * @return false if there's no entry, it's stale or it can't be read, `audio` is left untouched.
+     */
+    bool load(const std::string& source, AudioFile& audio) const;
+
+    /**
+     * @brief Write the samples and info of `audio`, decoded from `source`, as the entry of `source`.
+     * @return false if the entry couldn't be written.
+     */
+    bool store(const std::string& source, const AudioFile& audio) const;
+
+    /**
+     * @brief Path of the seek index entry of a source file (whether it exists or not).
+     */
+    std::string seekIndexPath(const std::string& source) const;
+
+    /**
+     * @brief Read the seek index stored for `source` into `index`.
+     * @return false if there's no entry, it's stale or it can't be read, `index` is left untouched.
+     */
+    bool loadSeekIndex(const std::string& source, SeekIndex& index) const;
+
+    /**
+     * @brief Write `index`, built from `source`, as the seek index entry of `source`.
+     * @return false if the entry couldn't be written.
+     */
+    bool storeSeekIndex(const std::string& source, const SeekIndex& index) const;
+};
+
+}
@@ -1,14 +1,146 @@
 #pragma once 
 #include "file_io/file_utils.h"
+#include "file_io/wav_stream_writer.h"
+#include "dsp/resample/resampler.h"
 #include "core/buffer_pool.h"
+#include "core/metrics.h"
 #include "core/types.h"
 #include "core/error_handler.h"
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 #include <sndfile.h>
 
+namespace AJ::io {
+class MP3_File;
+class SeekIndex;
+}
+
 namespace AJ::io::file_streamer {
 
+/**
+ * @brief Snapshot of StreamCounters (plain values, see StreamCounters::snapshot()).
+ */
+struct StreamStats {
+    uint64_t blocks = 0;        ///< blocks handed to the disk writer.
+    uint64_t dropped = 0;       ///< blocks lost (no buffer left, or the queue was full).
+    uint64_t poolExhausted = 0; ///< callbacks that found the buffer pool empty.
+    uint64_t reserveUsed = 0;   ///< blocks stored in an emergency reserve buffer.
+    uint64_t discarded = 0;     ///< queued blocks the disk writer discarded unwritten (drop oldest).
+    uint64_t written = 0;       ///< blocks the disk writer encoded and wrote.
+    uint64_t maxQueueDepth = 0; ///< most blocks the disk writer found queued when it woke up.
+
+    /**
+     * @brief Blocks handed to the writer but not written yet (queued, or being encoded).
+     *
+     * A lag that keeps growing means the writer (or its encoder) can't keep up and the pool
+     * will run dry, a maxQueueDepth close to the pool size means the pool is too small.
+     */
+    uint64_t lag() const noexcept {
+        return blocks > written + discarded ? blocks - written - discarded : 0;
+    }
+};
+
+/**
+ * @brief Lock-free counters shared by the audio callback and the disk writer.
+ *
+ * Written with relaxed atomics (one increment per event), readable at any time from
+ * the control thread with snapshot().
+ */
+struct StreamCounters {
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> blocks{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> poolExhausted{0};
+    std::atomic<uint64_t> reserveUsed{0};
+
+    /// @brief Queued blocks the callback asked the writer to discard (drop oldest), only grows.
+    std::atomic<uint64_t> discardRequests{0};
+
+    /// @brief Discard requests served by the writer (only written by the writer).
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> discarded{0};
+
+    /// @brief Blocks written by the writer (only written by the writer).
+    std::atomic<uint64_t> written{0};
+
+    /// @brief Deepest queue the writer saw (only written by the writer).
+    std::atomic<uint64_t> maxQueueDepth{0};
+
+    /// @brief Read all counters.
+    StreamStats snapshot() const noexcept {
+        StreamStats stats;
+        stats.blocks = blocks.load(std::memory_order_relaxed);
+        stats.dropped = dropped.load(std::memory_order_relaxed);
+        stats.poolExhausted = poolExhausted.load(std::memory_order_relaxed);
+        stats.reserveUsed = reserveUsed.load(std::memory_order_relaxed);
+        stats.discarded = discarded.load(std::memory_order_relaxed);
+        stats.written = written.load(std::memory_order_relaxed);
+        stats.maxQueueDepth = maxQueueDepth.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /// @brief Reset all counters (not while a stream is running).
+    void reset() noexcept {
+        blocks.store(0, std::memory_order_relaxed);
+        dropped.store(0, std::memory_order_relaxed);
+        poolExhausted.store(0, std::memory_order_relaxed);
+        reserveUsed.store(0, std::memory_order_relaxed);
+        discardRequests.store(0, std::memory_order_relaxed);
+        discarded.store(0, std::memory_order_relaxed);
+        written.store(0, std::memory_order_relaxed);
+        maxQueueDepth.store(0, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Container / encoding of the file FileStreamer::write() records.
+ */
+enum class StreamFormat : uint8_t {
+    Wav, ///< 32-bit float WAV (or RF64), written as it comes.
+    Flac ///< lossless FLAC through libsndfile, about half the disk bandwidth of float WAV.
+};
+
+/**
+ * @brief How FileStreamer::write() puts the queued buffers on disk.
+ */
+struct WriteOptions {
+    /**
+     * @brief File format of the recording. FLAC is encoded by the writer thread, after the
+     * queue, so the audio callback never waits on the encoder (see StreamStats::lag()).
+     * The file gets a `.flac` extension. `coalesce` and `stream` don't apply to FLAC.
+     */
+    StreamFormat format = StreamFormat::Wav;
+
+    /// @brief Sample encoding of a FLAC recording, int_16 or int_24.
+    BitDepth_t flacBitDepth = BitDepth_t::int_24;
+
+    /**
+     * @brief Coalesce the queued buffers into large aligned writes (io::WavStreamWriter)
+     * instead of one libsndfile write per buffer. Buffers go back to the pool as soon as
+     * they are copied into the batch.
+     */
+    bool coalesce = false;
+
+    /**
+     * @brief Batch size, O_DIRECT, RF64 and preallocation of the coalesced writer.
+     *
+     * `rf64` also applies to the libsndfile writer (RF64, downgraded to WAV at close if small),
+     * `preallocateBytes` > 0 selects the coalesced writer.
+     */
+    io::WavStreamOptions stream;
+
+    /**
+     * @brief Samplerate of the file, 0 = the stream rate (setWriteInfo()). Another rate is
+     * converted by the writer thread (dsp::resample::Resampler), the callback isn't affected.
+     */
+    uint32_t samplerate = 0;
+};
+
 /**
  * @class FileStreamer
  * @brief Handles file I/O for audio streaming (recording/playback).
@@ -19,8 +151,17 @@ namespace AJ::io::file_streamer {
  * - A `BufferPool` (recycling memory blocks for reuse).
  * - libsndfile (`SNDFILE`) for reading/writing audio files.
  *
+ * - FFmpeg (through MP3_File's stream decoder) for reading MP3 files.
+ *
  * - A stop flag (`pStopFlag`) is used to signal the writing thread to finish and flush any remaining buffers.
  *
+ * ## Reading
+ * read() decodes the file set with setReadInfo() block by block (one pool buffer per block)
+ * and pushes the blocks into the queue. Memory stays bounded by the pool: when the consumer
+ * doesn't return buffers the reader parks on the pool (backpressure). seek() moves the decode
+ * position, blocks already queued are left where they are (the consumer decides whether
+ * to drop them). endFlag() is set after the last block was pushed.
+ *
  * ## Error Handling
  * - All runtime errors (invalid samplerate, failed file open/write/close, etc.)
  *   are reported via the provided `IErrorHandler`.
@@ -44,10 +185,58 @@ private:
     LFControlFlagPtr pStopFlag;
 
     /**
-     * @brief Audio file information for reading (not implemented yet).
+     * @brief Audio file information for reading (probed by setReadInfo()).
      */
     std::shared_ptr<AudioInfo> pReadInfo;
 
+    /**
+     * @brief Path of the file to read.
+     */
+    std::string mReadPath;
+
+    /**
+     * @brief Open WAV (libsndfile) file of the read loop.
+     */
+    SNDFILE* pReadFile = nullptr;
+
+    /**
+     * @brief Open MP3 stream decoder of the read loop.
+     */
+    std::shared_ptr<AJ::io::MP3_File> pReadMP3;
+
+    /**
+     * @brief Seek index handed to pReadMP3 when it opens (nullptr = seeks by timestamp).
+     */
+    std::shared_ptr<const AJ::io::SeekIndex> pReadIndex;
+
+    /**
+     * @brief Requested read position and its generation, see seek().
+     */
+    std::atomic<sample_pos> mSeekTarget{0};
+    std::atomic<uint64_t> mSeekRequest{0};
+    uint64_t mSeekServed = 0;
+
+    /**
+     * @brief read() waits on it at the end of the file, seek() wakes it.
+     */
+    std::mutex mSeekMux;
+    std::condition_variable mSeekCond;
+
+    /**
+     * @brief Frame of the next block read() decodes.
+     */
+    std::atomic<sample_pos> mReadPosition{0};
+
+    /**
+     * @brief read() streams the file backwards, see setReadReversed().
+     */
+    bool mReadReversed = false;
+
+    /**
+     * @brief Set by read() after its last block was pushed.
+     */
+    LFControlFlagPtr pEndFlag;
+
     /**
      * @brief Audio file information for writing (channels, samplerate, path).
      */
@@ -63,6 +252,48 @@ private:
      */
     std::string mSessionDir;
 
+    /**
+     * @brief Queued buffers that wake the writer (batch threshold), see setWakeThreshold().
+     */
+    size_t mWakeThreshold{1};
+
+    /**
+     * @brief Counters shared with the producer (optional), see setCounters().
+     */
+    std::shared_ptr<StreamCounters> pCounters;
+
+    /**
+     * @brief Engine metrics updated by the writer (optional), see setMetrics().
+     */
+    std::shared_ptr<AJ::utils::MetricsRegistry> pMetrics;
+
+    /**
+     * @brief Disk write mode of write(), see setWriteOptions().
+     */
+    WriteOptions mWriteOptions;
+
+    /**
+     * @brief Converter of the write loop when WriteOptions::samplerate differs from the stream rate.
+     */
+    std::unique_ptr<dsp::resample::Resampler> pResampler;
+
+    /**
+     * @brief Converted frames of the buffer being written.
+     */
+    std::vector<float> mResampled;
+
+    /**
+     * @brief File of the write loop between beginWrite() and endWrite(): libsndfile,
+     * or the coalesced writer (WriteOptions::coalesce).
+     */
+    SNDFILE* pWriteFile = nullptr;
+    std::unique_ptr<WavStreamWriter> pStreamWriter;
+
+    /**
+     * @brief Pre-roll kept by holdPending(), oldest first, written first by beginWrite().
+     */
+    std::deque<AJ::utils::Buffer*> mHeld;
+
 private:
     /**
      * @brief Fill an `SF_INFO` struct with the current write settings.
@@ -90,6 +321,100 @@ private:
      */
     void writeInterleaved(SNDFILE* file, AJ::utils::Buffer* buffer, AJ::error::IErrorHandler& handler);
 
+    /**
+     * @brief Write `frames` interleaved frames, see writeInterleaved().
+     */
+    void writeFrames(SNDFILE* file, const float* data, size_t frames, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Samplerate of the written file (WriteOptions::samplerate, or the stream rate).
+     */
+    uint32_t fileRate() const noexcept {
+        return mWriteOptions.samplerate ? mWriteOptions.samplerate : static_cast<uint32_t>(pWriteInfo->samplerate);
+    }
+
+    /**
+     * @brief Create pResampler if the file rate differs from the stream rate.
+     * @return false (reported) if the rates can't be converted.
+     */
+    bool prepareResampler(AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Frames of the buffer at the file rate: the buffer itself, or its conversion in mResampled.
+     */
+    const float* convert(const AJ::utils::Buffer* buffer, size_t &frames);
+
+    /**
+     * @brief Write one popped buffer to the open file, or discard it (drop oldest).
+     *
+     * The caller gives it back to the pool, the drain loops do it a batch at a time.
+     */
+    void writeBuffer(AJ::utils::Buffer* buffer, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Write the pre-roll of holdPending() into the file just opened.
+     */
+    void writeHeld(AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Record the queue depth the writer woke up to (StreamStats::maxQueueDepth, Peak::QueueDepth).
+     */
+    void noteQueueDepth() noexcept;
+
+    /**
+     * @brief Count a written block (StreamStats::written) and, with metrics, its bytes and
+     * how long the write took since `start` (MetricsRegistry::now(), 0 without metrics).
+     */
+    void noteWritten(const AJ::utils::Buffer *buffer, uint64_t start) noexcept {
+        if(pCounters) pCounters->written.fetch_add(1, std::memory_order_relaxed);
+
+        if(pMetrics){
+            pMetrics->add(AJ::utils::Counter::BlocksWritten);
+            pMetrics->add(AJ::utils::Counter::BytesWritten, sizeof(float) * buffer->frames * buffer->channels);
+            pMetrics->record(AJ::utils::Latency::BlockWrite, AJ::utils::MetricsRegistry::now() - start);
+        }
+    }
+
+    /// @brief Start time of a block write for noteWritten().
+    uint64_t writeStart() const noexcept {
+        return pMetrics ? AJ::utils::MetricsRegistry::now() : 0;
+    }
+
+    /**
+     * @brief Whether the next popped buffer must be discarded (drop oldest overflow policy).
+     *
+     * Serves one pending StreamCounters::discardRequests if any.
+     */
+    bool discardOldest() noexcept;
+
+    /**
+     * @brief Open mReadPath with the decoder of its format (read loop).
+     */
+    bool openRead(AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Decode up to `frames` interleaved frames of the open file.
+     * @return frames decoded, fewer only at the end of the file.
+     */
+    size_t readBlock(float* out, size_t frames, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Decode the `frames` frames before mReadPosition counted from the end of the file,
+     * in reverse order (reversed read loop).
+     * @return frames decoded, fewer only at the start of the file.
+     */
+    size_t readBlockReversed(float* out, size_t frames, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Move the open file to a frame.
+     */
+    bool seekRead(sample_pos frame, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Close the file opened by openRead().
+     */
+    void closeRead(AJ::error::IErrorHandler& handler);
+
 public:
     /**
      * @brief Construct a new FileStreamer instance.
@@ -107,6 +432,8 @@ public:
         std::shared_ptr<AJ::utils::BufferPool> pool, LFControlFlagPtr stopFlag,
         AJ::FileStreamingTypes streaming_type, std::string sessionDir):
         pQueue(queue), pBufferPool(pool), pStopFlag(stopFlag), mSessionDir(sessionDir), pReadInfo(nullptr), pWriteInfo(nullptr){
+            pEndFlag = std::make_shared<LFControlFlag>();
+            pEndFlag->flag.store(false, std::memory_order_relaxed);
             
             mStreamingInfo.type = streaming_type; std::string streaming_dir = mSessionDir + "/";
             
@@ -125,16 +452,32 @@ public:
     }
 
     /**
-     * @brief Configure audio parameters for reading.
+     * @brief Set the file read() streams and probe its audio parameters.
      * 
-     * @param info Read settings (samplerate, channels).
-     * @param handler Error handler.
+     * WAV files are decoded with libsndfile (any PCM / float encoding, converted to float),
+     * MP3 files with FFmpeg. The channels of the file must match the buffers of the pool.
      * 
-     * @return `true` if valid, `false` otherwise.
+     * @param path Path of a `.wav` or `.mp3` file.
+     * @param handler Error handler.
      * 
-     * @note Currently not implemented.
+     * @return `true` if the file can be streamed, `false` otherwise.
      */
-    bool setReadInfo(const AudioInfo& info, AJ::error::IErrorHandler& handler);
+    bool setReadInfo(const std::string& path, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Seek index of the MP3 set with setReadInfo() (e.g. from DecodeCache::loadSeekIndex()),
+     * so seek() lands on the exact frame without a search. Set it before read() starts.
+     */
+    void setSeekIndex(std::shared_ptr<const AJ::io::SeekIndex> index) noexcept {
+        pReadIndex = std::move(index);
+    }
+
+    /**
+     * @brief Audio parameters of the file set with setReadInfo() (nullptr before).
+     */
+    std::shared_ptr<const AudioInfo> readInfo() const noexcept {
+        return pReadInfo;
+    }
 
     /**
      * @brief Configure audio parameters for writing.
@@ -149,6 +492,53 @@ public:
      */
     bool setWriteInfo(const AudioWriteInfo& info, AJ::error::IErrorHandler& handler);
 
+    /**
+     * @brief Wake the writer only once `buffers` buffers are queued (default 1).
+     *
+     * The writer parks on the queue (no polling) and writes everything queued when woken.
+     * A larger threshold batches disk writes and wakeups; queued buffers are still written
+     * at least every kStreamerWakeTimeout.
+     *
+     * @param buffers batch threshold, clamped to the queue size by the queue.
+     */
+    void setWakeThreshold(size_t buffers) noexcept {
+        mWakeThreshold = buffers;
+    }
+
+    /**
+     * @brief Share counters with the producer.
+     *
+     * The writer serves the discard requests of the drop oldest overflow policy: for every
+     * request the oldest queued buffer goes back to the pool without being written.
+     *
+     * @param counters counters of the stream (nullptr to disable).
+     */
+    void setCounters(std::shared_ptr<StreamCounters> counters) noexcept {
+        pCounters = std::move(counters);
+    }
+
+    /**
+     * @brief Report the blocks written, their bytes, write times and the queue depth to `metrics`
+     * (e.g. EngineResources::metrics(), nullptr to disable). Set before write() starts.
+     */
+    void setMetrics(std::shared_ptr<AJ::utils::MetricsRegistry> metrics) noexcept {
+        pMetrics = std::move(metrics);
+    }
+
+    /**
+     * @brief Choose how write() writes the queued buffers (set before write() starts).
+     *
+     * The default writes every buffer through libsndfile. The coalesced mode batches
+     * them into `batchBytes` aligned writes, optionally with O_DIRECT, and patches the
+     * WAV header when the file is closed: far fewer write calls per stream, which matters
+     * when many tracks record to the same disk. For day long sessions `rf64` lifts the 4 GiB
+     * WAV limit and `preallocateBytes` reserves the file in large extents ahead of the writes.
+     * `format` records to FLAC instead, encoded by the writer so the callback never waits on it.
+     */
+    void setWriteOptions(const WriteOptions &options) noexcept {
+        mWriteOptions = options;
+    }
+
     /**
      * @brief Run the write loop (blocking).
      *
@@ -156,24 +546,116 @@ public:
      * the stop flag is set. After stopping, any remaining buffers in the queue
      * are flushed to disk before the file is closed.
      *
+     * While the queue is empty the thread sleeps in Queue::wait() and is woken by
+     * the producer's push(), the stop flag is checked at least every kStreamerWakeTimeout.
+     *
      * @param handler Error handler.
      * @return `true` if file written successfully, `false` on error.
      */
     bool write(AJ::error::IErrorHandler& handler);
 
+    /**
+     * @brief The steps of write() for a caller that runs its own loop (e.g. a WriterPool
+     * worker serving many streams): beginWrite() opens the file, writePending() writes
+     * what is queued and returns, endWrite() writes the rest and closes the file.
+     *
+     * The stop flag isn't looked at, the caller decides when the stream is done.
+     * @return beginWrite() / endWrite(): `false` on error, writePending(): buffers popped.
+     */
+    bool beginWrite(AJ::error::IErrorHandler& handler);
+    size_t writePending(AJ::error::IErrorHandler& handler);
+    bool endWrite(AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Pre-roll: pop what is queued but keep only the newest `keep` buffers, the older
+     * ones go back to the pool and leave the take (StreamCounters::blocks).
+     *
+     * Called by the writer instead of writePending() while no file is open. The next
+     * beginWrite() writes the held buffers first, discardPending() gives them back.
+     * @return buffers held.
+     */
+    size_t holdPending(size_t keep, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Give the held and the queued buffers back to the pool without writing them.
+     * @return buffers given back.
+     */
+    size_t discardPending(AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Name of the written file instead of the generated one (before write()).
+     * @param name file name with its `.wav` extension, replaced by `.flac` for FLAC.
+     */
+    void setFileName(const std::string& name){
+        mStreamingInfo.name = name;
+        if(pWriteInfo){
+            pWriteInfo->name = name;
+        }
+    }
+
+    /**
+     * @brief Path of the written file (set by setWriteInfo(), final once beginWrite() ran).
+     */
+    std::string writePath() const {
+        return pWriteInfo ? pWriteInfo->path + "/" + pWriteInfo->name : std::string();
+    }
+
     /**
      * @brief Run the read loop (blocking).
      *
-     * Opens the target file and streams audio buffers into the queue.
-     * Intended for playback or analysis.
+     * Opens the file set with setReadInfo() and streams it into the queue, one pool
+     * buffer per block (`buffer->frames` valid frames, the last block may be short),
+     * until the stop flag. Pending seek() requests are served before the next block.
+     * At the end of the file endFlag() is set and the reader waits for a seek(), which
+     * clears it and reads on from there, or for the stop flag.
+     * Intended for playback, offline rendering or analysis.
      *
      * @param handler Error handler.
      * 
      * @return `true` if file read successfully, `false` on error.
-     * 
-     * @note Not implemented yet.
      */
     bool read(AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Stream the file backwards, from its last frame to the first (set before read() starts).
+     *
+     * Every block is decoded forward from a seek and reversed in its pool buffer, the file
+     * itself isn't touched. readPosition() and seek() then count frames in played order,
+     * frame 0 being the last frame of the file. The file must be seekable; MP3 files pay
+     * for a decoder seek per block.
+     */
+    void setReadReversed(bool reversed) noexcept {
+        mReadReversed = reversed;
+    }
+
+    /**
+     * @brief Continue read() from a frame (doesn't block, the last request wins).
+     *
+     * Blocks already in the queue are not touched. A read() waiting at the end of the
+     * file is woken up.
+     */
+    void seek(sample_pos frame) noexcept {
+        mSeekTarget.store(std::max<sample_pos>(frame, 0), std::memory_order_relaxed);
+        mSeekRequest.fetch_add(1, std::memory_order_release);
+
+        //? not under mSeekMux: a wake missed between the check and the wait costs one kStreamerWakeTimeout.
+        mSeekCond.notify_one();
+    }
+
+    /**
+     * @brief Frame of the next block read() decodes.
+     */
+    sample_pos readPosition() const noexcept {
+        return mReadPosition.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Flag set once read() pushed its last block, cleared by a later seek()
+     * (e.g. for play::StreamSource).
+     */
+    LFControlFlagPtr endFlag() const noexcept {
+        return pEndFlag;
+    }
 };
 
 }
@@ -2,6 +2,8 @@
 #include "core/constants.h"
 #include "core/types.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace AJ::utils {
@@ -56,6 +58,14 @@ public:
     static std::string get_file_extension(std::string& path);
 
     static std::string generate_file_name(FileStreamingTypes type, std::string& extension);
+
+    /**
+     * @brief pwrite() all of `bytes` at `offset` of a file descriptor, retrying short and
+     * interrupted writes.
+     *
+     * @return false if a write failed (errno is left set), always false without POSIX I/O.
+     */
+    static bool write_all(int fd, const void *data, size_t bytes, uint64_t offset) noexcept;
 };
 
 };
\ No newline at end of file
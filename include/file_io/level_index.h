@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "dsp/kernels.h"
+#include "dsp/loudness/loudness.h"
+
+namespace AJ::io {
+
+/**
+ * @brief Multi-resolution summary (min / max / sum of squares) of the channels of an AudioFile.
+ *
+ * Level `l` stores one dsp::kernels::Levels per block of `kLevelIndexBaseFrames * kLevelIndexFanout^l`
+ * frames (256 / 4096 / 65536). The finest level is built with the analysis kernel in one pass,
+ * the others are merged from the level below.
+ *
+ * A query over [start, end] reads raw samples only for the two partial base blocks at the edges
+ * and combines the largest aligned blocks in between, so peak / RMS of any range costs
+ * O(n / 65536 + fanout * depth + base) instead of O(n).
+ *
+ * The index doesn't own the samples: update() must be called after the samples of a channel changed
+ * (AudioFile::updateLevelIndex() does it for all channels, Cut / Insert and the engine call it).
+ *
+ * It also keeps the last kLevelIndexLoudnessEntries loudness measurements (AudioFile::loudness()),
+ * loudness isn't additive over blocks like the levels, so whole ranges are cached. An update drops
+ * the measurements of the ranges it touches.
+ */
+class LevelIndex {
+    /// @brief Blocks of every level of one channel.
+    using Pyramid = std::array<std::vector<dsp::kernels::Levels>, kLevelIndexDepth>;
+
+    std::array<Pyramid, kNumChannels> mChannels; ///< pyramid of each channel.
+    std::array<size_t, kNumChannels> mFrames{};  ///< frames indexed for each channel.
+
+    /// @brief Loudness of a range of all channels.
+    struct LoudnessEntry {
+        sample_pos mStart;
+        sample_pos mEnd;
+        uint32_t mSamplerate;
+        dsp::loudness::Measurement mMeasurement;
+    };
+
+    std::vector<LoudnessEntry> mLoudness; ///< cached measurements, oldest first.
+
+public:
+    /**
+     * @brief Frames per block of a level.
+     */
+    static constexpr size_t blockFrames(size_t level) noexcept {
+        size_t frames = kLevelIndexBaseFrames;
+        for(size_t l = 0; l < level; ++l){
+            frames *= kLevelIndexFanout;
+        }
+        return frames;
+    }
+
+    /**
+     * @brief Index every channel of `audio` from scratch.
+     * @param audio    channel buffers.
+     * @param channels number of channels to index (1 or 2).
+     */
+    void build(const AudioBuffer &audio, uint8_t channels);
+
+    /**
+     * @brief Re-index the frames of a channel from `start` on.
+     *
+     * Blocks before the one containing `start` are kept, the rest is recomputed from the samples,
+     * the index follows the new length of the buffer. Use it after editing [start, end]
+     * (pass the end to only refresh that range) or after an edit that shifts the samples
+     * after `start` (Cut / Insert, pass `end = -1`).
+     *
+     * @param samples  samples of the channel.
+     * @param channel  channel index.
+     * @param start    first changed frame.
+     * @param end      last changed frame (inclusive), -1 for the end of the buffer.
+     */
+    void update(const Float &samples, uint8_t channel, sample_pos start, sample_pos end = -1);
+
+    /**
+     * @brief Levels of the frames [start, end] (inclusive) of a channel.
+     *
+     * @param samples samples of the channel (same buffer the index was built / updated from).
+     * @param channel channel index.
+     * @param start   first frame.
+     * @param end     last frame (inclusive), must be < indexed frames.
+     */
+    dsp::kernels::Levels query(const Float &samples, uint8_t channel, sample_pos start, sample_pos end) const;
+
+    /**
+     * @brief Blocks of a level of a channel, e.g. min / max columns of a waveform view.
+     *
+     * @param channel channel index.
+     * @param level   level in [0, kLevelIndexDepth).
+     */
+    const std::vector<dsp::kernels::Levels>& blocks(uint8_t channel, size_t level) const {
+        return mChannels[channel][level];
+    }
+
+    /**
+     * @brief Cached loudness of the frames [start, end] (all channels) at `samplerate`.
+     * @return the measurement, nullptr if it wasn't stored since the range last changed.
+     */
+    const dsp::loudness::Measurement* loudness(sample_pos start, sample_pos end, uint32_t samplerate) const;
+
+    /**
+     * @brief Cache the loudness of the frames [start, end] (all channels), drops the oldest
+     * measurement past kLevelIndexLoudnessEntries.
+     */
+    void storeLoudness(sample_pos start, sample_pos end, uint32_t samplerate, const dsp::loudness::Measurement &measurement);
+
+    /**
+     * @brief Frames indexed for a channel.
+     */
+    size_t frames(uint8_t channel) const noexcept {
+        return mFrames[channel];
+    }
+};
+
+} // namespace AJ::io
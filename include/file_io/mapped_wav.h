@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "core/types.h"
+
+namespace AJ::io {
+
+/**
+ * @class MappedWav
+ * @brief Read-only memory mapping of a WAV file, converted to planar float on demand.
+ *
+ * Opening only parses the RIFF header: the samples stay in the page cache and a range
+ * is converted and deinterleaved when it's read, so a caller pays for the regions it
+ * touches (waveform display, analysis, WAV_File::read() converting chunk by chunk
+ * without an interleaved copy of the whole file).
+ *
+ * Handles plain RIFF WAV and RF64 (and WAVE_FORMAT_EXTENSIBLE) with 8/16/24/32-bit PCM or
+ * 32/64-bit float samples. Anything else (compressed encodings, W64, big endian hosts,
+ * platforms without mmap) makes open() return false, callers fall back to libsndfile.
+ *
+ * Samples are scaled like libsndfile's sf_read_float(): integer PCM is divided by 2^(bits-1).
+ */
+class MappedWav {
+    const uint8_t* pMap = nullptr;     ///< start of the mapping.
+    size_t mMapSize = 0;               ///< bytes mapped.
+
+    const uint8_t* pSamples = nullptr; ///< first byte of the data chunk.
+    size_t mFrames = 0;                ///< frames in the data chunk.
+    uint16_t mChannels = 0;            ///< interleaved channels.
+    uint16_t mBytesPerSample = 0;      ///< bytes of one sample of one channel.
+    uint16_t mBlockAlign = 0;          ///< bytes of one frame.
+    int mSamplerate = 0;               ///< sample rate in Hz.
+    BitDepth_t mBitDepth = Not_Supported; ///< sample encoding.
+
+    /**
+     * @brief Parse the fmt and data chunks of the mapping.
+     * @return false if the file isn't a WAV this reader handles.
+     */
+    bool parse() noexcept;
+
+    /**
+     * @brief readPlanar() fast path for packed, aligned stereo float / 16-bit PCM (SIMD kernels).
+     * @return false if the layout doesn't qualify, nothing was read.
+     */
+    bool readStereo(const uint8_t* first, size_t count, float* const* outs) const noexcept;
+
+public:
+    MappedWav() = default;
+    ~MappedWav();
+
+    MappedWav(const MappedWav&) = delete;
+    MappedWav& operator=(const MappedWav&) = delete;
+
+    /**
+     * @brief Map a file and parse its header (closes a previous mapping).
+     * @param path file to map.
+     * @param sequential hint the kernel that the whole file is read once, front to back.
+     * @return false if the file can't be mapped or isn't a supported WAV, nothing is reported.
+     */
+    bool open(const std::string& path, bool sequential = false);
+
+    /**
+     * @brief Unmap the file.
+     */
+    void close() noexcept;
+
+    bool isOpen() const noexcept {
+        return pSamples != nullptr;
+    }
+
+    size_t frames() const noexcept {
+        return mFrames;
+    }
+
+    uint16_t channels() const noexcept {
+        return mChannels;
+    }
+
+    int samplerate() const noexcept {
+        return mSamplerate;
+    }
+
+    BitDepth_t bitdepth() const noexcept {
+        return mBitDepth;
+    }
+
+    /**
+     * @brief Convert `count` frames of one channel starting at frame `start` into `out`.
+     * @return frames written, clamped to the end of the file.
+     */
+    size_t read(uint16_t channel, size_t start, size_t count, float* out) const noexcept;
+
+    /**
+     * @brief Convert `count` frames of every channel starting at `start`, deinterleaved
+     * into `outs[0..channels()-1]` in one pass over the mapped frames.
+     * @return frames written, clamped to the end of the file.
+     */
+    size_t readPlanar(size_t start, size_t count, float* const* outs) const noexcept;
+
+    /**
+     * @brief Ask the kernel to start reading the pages of `count` frames from `start` in the background.
+     *
+     * Doesn't wait: a reader prefetches the chunks ahead of the one it converts, so the disk
+     * reads overlap the conversion instead of faulting in page by page. No-op without mmap.
+     */
+    void prefetch(size_t start, size_t count) const noexcept;
+};
+
+}
@@ -1,5 +1,8 @@
 #pragma once
+#include <memory>
+#include <vector>
 #include "audio_file.h"
+#include "seek_index.h"
 
 extern "C"{
     #include <libavformat/avformat.h> 
@@ -26,7 +29,7 @@ namespace AJ::io {
  * - Offline reading: the full MP3 file is decoded and loaded into memory.
  * - Supports reading per-channel float PCM buffers.
  * - MP3 writing via libavcodec, using encoding parameters derived from the
- *   provided audio metadata.
+ *   provided audio metadata (see Mp3StreamEncoder for block by block export).
  *
  *
  * @see AJ::io::AudioFile
@@ -42,6 +45,15 @@ class MP3_File final : public AJ::io::AudioFile {
         AVAudioFifo* fifo;                          // FIFO buffer holding decoded float PCM samples
         sample_c total_samples_per_chan;                     // Total number of decoded audio samples
 
+        // streaming decode state (openStream() / readStream()).
+        SwrContext* resampler;                      // Converts decoded frames to interleaved float
+        AVPacket* packet;                           // Packet reused for every read
+        AVFrame* frame;                             // Frame reused for every decoded frame
+        bool end_of_file;                           // All packets were read and the decoder drained
+        sample_pos seek_target;                     // Frame to skip to after a seek (-1 if none)
+        bool indexed;                               // Seeked through the seek index: packets are timed from index_frame
+        sample_pos index_frame;                     // Frame the next packet starts at after an indexed seek
+
         AudioDecoder() {
             stream_idx = -1;
             format_ctx = nullptr;
@@ -50,11 +62,20 @@ class MP3_File final : public AJ::io::AudioFile {
             decoder_ctx = nullptr;
             fifo = nullptr;
             total_samples_per_chan = 0;
+            resampler = nullptr;
+            packet = nullptr;
+            frame = nullptr;
+            end_of_file = false;
+            seek_target = -1;
+            indexed = false;
+            index_frame = 0;
         }
     };
 
     AudioDecoder mDecoderInfo;
 
+    std::shared_ptr<const SeekIndex> pSeekIndex; ///< frame accurate seeks of seekStream() (nullptr = by timestamp).
+
     // ======== Internal Reading and Decoding helper methods ========
 
     /**
@@ -76,7 +97,9 @@ class MP3_File final : public AJ::io::AudioFile {
     bool initDecoder(AJ::error::IErrorHandler& handler);
 
     /**
-     * @brief Decodes audio packets into planar float PCM samples and pushes them into the FIFO buffer.
+     * @brief Decodes audio packets into planar float PCM samples, converted straight into `pAudio`.
+     *
+     * The channels are reserved once from durationFrames() plus a margin.
      *
      * @param handler Reference to the error handler for reporting issues.
      * @return true if decoding succeeds, false otherwise.
@@ -84,111 +107,175 @@ class MP3_File final : public AJ::io::AudioFile {
     bool decode(AJ::error::IErrorHandler& handler);
 
     /**
-     * @brief set the `mInfo` metadata for the decoded audio.
-     *
-     * @param decoder_ctx Pointer to the active decoder context.
-     * @param total_samples_per_chan Total number of samples decoded.
+     * @brief Frames per channel of the stream (or container) duration at `samplerate`.
+     * @return 0 if the file doesn't report a duration.
      */
-    void setAudioInfo(AVCodecContext* decoder_ctx, sample_c& total_samples_per_chan);
-
-    /// @brief Struct to hold internal encoder state and FFmpeg objects.
-    struct AudioEncoder{
-        const AVCodec *encoder;
-        AVCodecContext *encoder_ctx;
-        FILE *file;
-        AVPacket *packet;
-        
-        AudioEncoder(){
-            encoder = nullptr;
-            encoder_ctx = nullptr;
-            file = nullptr;
-            packet = nullptr;
-        }
-    };
-
-    AudioEncoder mEncoderInfo;
-
-    // ======== Internal Writing and Encoding helper methods ========
+    size_t durationFrames(int samplerate) const;
 
     /**
-     * @brief Initializes the MP3 encoder and configures the encoder context
-     *        to use AV_SAMPLE_FMT_S16P (int16_t planar). Opens the encoder.
-     *        Only mono and stereo channels are supported.
-     * 
+     * @brief Decodes the file in segments on the workers of setReadPool(), stitched into `pAudio`.
+     *
+     * The packets are demuxed first (the compressed file in memory, a fraction of the decoded
+     * size). They're split in up to one run per worker at packet (frame) boundaries with even
+     * byte counts. Each run is decoded on its own decoder context, primed with the
+     * kMP3SegmentPrimePackets packets before it so the bit reservoir and the filter bank
+     * state match a sequential decode. `pAudio` is sized once from the decoded lengths and
+     * the runs are copied in place.
+     *
+     * Only for decoders that output one frame per packet (MP3), read() picks it.
+     *
      * @param handler Reference to the error handler for reporting issues.
-     * @return true on success, false on failure or if channels are unsupported.
+     * @return true if decoding succeeds, false otherwise.
      */
-    bool initEncoder(AJ::error::IErrorHandler &handler);
+    bool decodeSegmented(AJ::error::IErrorHandler& handler);
 
     /**
-     * @brief Allocates an AVFrame and sets its parameters to hold float planar audio.
-     *        Copies settings from the encoder context, sets nb_samples to frame_size,
-     *        allocates the buffer, and ensures it's writable.
-     *        On failure, the frame is freed.
-     * 
-     * @param frame Pointer to the frame to be initialized.
-     * @param frame_size Number of samples per channel.
-     * @param handler Reference to the error handler for reporting issues.
+     * @brief Resample a decoded frame (nullptr flushes the resampler) to planar float at
+     *        frame `written` of the first `channels` channels of `out`.
+     *
+     * @param written Frames already in the channels, advanced by the converted frames.
+     * @return false if the conversion failed.
      */
-    void allocateFrame(AVFrame *frame, int frame_size, AJ::error::IErrorHandler &handler);
+    static bool convertFrame(SwrContext* resampler, const AVFrame* frame, AudioBuffer& out, int channels,
+        size_t& written, AJ::error::IErrorHandler& handler);
 
     /**
-     * @brief Resamples the input frame (float planar) to S16P (int16_t planar) format.
-     *        Uses the provided SwrContext and writes to the resampled frame.
-     *        Makes the resampled frame writable, and unreferences the input frame.
-     *        On failure, frees the resampler, resampled frame, and input frame.
-     * 
-     * @param frame Pointer to the input float frame.
-     * @param resampled Pointer to the output resampled frame.
-     * @param resampler Pointer to the resampling context.
-     * @param handler Reference to the error handler for reporting issues.
+     * @brief set the `mInfo` metadata for the decoded audio.
+     *
+     * @param decoder_ctx Pointer to the active decoder context.
+     * @param total_samples_per_chan Total number of samples decoded.
      */
-    void resampleFrameData(AVFrame *frame, AVFrame *resampled, SwrContext *resampler, AJ::error::IErrorHandler &handler);
+    void setAudioInfo(AVCodecContext* decoder_ctx, sample_c& total_samples_per_chan);
+
+    /// @brief Interleaved output of the streaming resampler, reused between frames.
+    std::vector<float> mStreamScratch;
 
     /**
-     * @brief Writes encoded packets to the output file.
-     * 
-     * @param handler Reference to the error handler for reporting issues.
-     * @return true on success, false on failure.
+     * @brief Decode the next packet of the stream into the FIFO (interleaved float).
+     *
+     * At the end of the file the decoder is drained and `end_of_file` is set.
+     * @return false on a decoding error.
      */
-    bool writeData(AJ::error::IErrorHandler &handler);
+    bool decodeStreamPacket(AJ::error::IErrorHandler& handler);
 
     /**
-     * @brief Encodes audio samples and writes them to file via writeData().
-     *        Internally initializes and manages the frame, resampled frame,
-     *        and resampler context. These are automatically cleaned up.
-     *        The caller must free the packet, encoder context, and close the file.
-     * 
-     * @param handler Reference to the error handler for reporting issues.
-     * @return true on success, false otherwise.
+     * @brief Convert the decoded frame and append it to the FIFO, dropping the frames
+     * before `seek_target` after a seek.
      */
-    bool encode(AJ::error::IErrorHandler &handler);
-
+    bool queueStreamFrame(AJ::error::IErrorHandler& handler);
 
 public:
     MP3_File() {
         mDecoderInfo = AudioDecoder();
-        mEncoderInfo = AudioEncoder();
     }
 
     /**
      * @brief Reads and decodes an MP3 file. Other formats may work if supported by FFmpeg,
      *        but only MP3 is well tested.
      *        it's also tested for FLAC.
+     *
+     * With a read pool (setReadPool()) an MP3 is decoded in parallel segments, see decodeSegmented().
      *        
      * @param handler Reference to the error handler for reporting issues.
      * @return true if successful, false otherwise.
      */
     bool read(AJ::error::IErrorHandler& handler) override;
 
-    // TODO: Optimize write function — currently performs slowly.
+    /**
+     * @brief Decodes only the frames [start, end] of the file.
+     *
+     * Seeks to the packet before `start` (av_seek_frame) and drops the decoded frames before it,
+     * so the range is sample accurate and the packets before it are never decoded.
+     * sourceFrames() is estimated from the stream duration.
+     *
+     * @param start first frame to decode.
+     * @param end last frame to decode (inclusive), -1 decodes to the end.
+     * @param handler Reference to the error handler for reporting issues.
+     * @return true if successful, false otherwise.
+     */
+    bool readRange(sample_pos start, sample_pos end, AJ::error::IErrorHandler& handler) override;
+
+    /**
+     * @brief Reads the stream info (sample rate, channels, duration) into `mInfo` without decoding.
+     *        `mInfo.length` comes from the reported duration, read() sets the exact length.
+     *
+     * @param handler Reference to the error handler for reporting issues.
+     * @return true if successful, false otherwise.
+     */
+    bool probe(AJ::error::IErrorHandler& handler) override;
+
     /**
      * @brief Encodes and writes audio data to an MP3 file.
      *
+     * The channels are encoded chunk by chunk through an Mp3StreamEncoder,
+     * which reuses its preallocated frames and packets.
+     *
      * @param handler Reference to the error handler for reporting issues.
      * @return true on success, false on failure.
      */
     bool write(AJ::error::IErrorHandler& handler) override;
+
+    // ======== Streaming read (FileStreamer) ========
+
+    /**
+     * @brief Open the file for chunked decoding instead of read().
+     *
+     * Fills `mInfo` (length is estimated from the stream duration), `pAudio` stays empty.
+     *
+     * @param handler Reference to the error handler for reporting issues.
+     * @return true if successful, false otherwise.
+     */
+    bool openStream(AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Decode up to `frames` interleaved float frames into `out`.
+     *
+     * @return frames decoded, fewer than `frames` only at the end of the file (0 after it).
+     */
+    size_t readStream(float* out, size_t frames, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Move the stream to a frame (sample accurate: decodes from the previous
+     * packet and drops the frames before `frame`).
+     *
+     * With a seek index the stream is moved to the byte offset of an indexed packet and timed
+     * from its frame, so VBR files without a TOC seek exactly and without a search.
+     */
+    bool seekStream(sample_pos frame, AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Release the decoder opened by openStream().
+     */
+    void closeStream();
+
+    // ======== Seek index ========
+
+    /**
+     * @brief Build the seek index of the file in a demux pass (no decoding), see SeekIndex.
+     *
+     * read() builds it on the way, this is for files opened with openStream() or readRange().
+     * Doesn't touch an open stream. Only MP3 streams are indexed.
+     *
+     * @param handler Reference to the error handler for reporting issues.
+     * @return true if successful, false otherwise.
+     */
+    bool buildSeekIndex(AJ::error::IErrorHandler& handler);
+
+    /**
+     * @brief Seek index of the file: built by read() / buildSeekIndex() or set with setSeekIndex(),
+     * nullptr if none.
+     */
+    std::shared_ptr<const SeekIndex> seekIndex() const noexcept {
+        return pSeekIndex;
+    }
+
+    /**
+     * @brief Use an index built before (e.g. DecodeCache::loadSeekIndex()) for the next seeks.
+     * It must be the index of this file (nullptr seeks by timestamp again).
+     */
+    void setSeekIndex(std::shared_ptr<const SeekIndex> index) noexcept {
+        pSeekIndex = std::move(index);
+    }
 };
 
 };
\ No newline at end of file
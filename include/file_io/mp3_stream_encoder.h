@@ -0,0 +1,237 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/constants.h"
+#include "core/types.h"
+#include "core/error_handler.h"
+#include "core/buffer_pool.h"
+#include "core/thread_pool.h"
+
+extern "C"{
+    #include <libavcodec/avcodec.h>
+    #include <libavutil/avutil.h>
+    #include <libswresample/swresample.h>
+}
+
+namespace AJ::io {
+
+/**
+ * @brief Settings of a Mp3StreamEncoder.
+ */
+struct Mp3StreamOptions {
+    /// @brief Bit rate in bits per second, 0 for the encoder default.
+    int64_t bitrate = 0;
+
+    /// @brief Sample rate of the appended frames, 0 if it's the rate of the file (resampled otherwise).
+    uint32_t inputSamplerate = 0;
+
+    /// @brief The appended frames are planar (one array per channel) instead of interleaved.
+    bool planar = false;
+
+    /// @brief Encoder frames and packets preallocated between the stages.
+    size_t slots = kMp3PipelineFrames;
+};
+
+/**
+ * @class Mp3StreamEncoder
+ * @brief Block by block MP3 encoder: convert / resample, encode and write as pipeline stages.
+ *
+ * The appended float frames are converted (and resampled) to the encoder format, cut into
+ * encoder frames, encoded into packets and the packets are written to the file. Every
+ * AVFrame and AVPacket is allocated by open() (`slots` of each) and recycled between the
+ * stages, so the memory is bounded whatever the length of the export.
+ *
+ * append() runs the three stages on the calling thread. run() consumes the buffers of a
+ * Queue (returned to their BufferPool) until a flag is set, with the conversion and the
+ * encoder on pool workers and the writes on the calling thread, so encoding overlaps I/O.
+ *
+ * close() encodes the tail (resampler delay, last partial frame, encoder delay) and closes the file.
+ */
+class Mp3StreamEncoder {
+    /**
+     * @brief Bounded ring of slot indices handed from one stage to the next.
+     *
+     * A ring holds at most every slot, push() never waits. pop() may wait for a slot
+     * until the ring is closed, the stages aren't realtime so a mutex is fine.
+     */
+    class SlotRing {
+        std::mutex mMux;
+        std::condition_variable mCond;
+        std::vector<int> mSlots;
+        size_t mHead = 0;
+        size_t mCount = 0;
+        bool mClosed = false;
+
+    public:
+        /// @brief Empty the ring and make room for `capacity` slots.
+        void reset(size_t capacity);
+
+        void push(int slot);
+
+        /**
+         * @brief Take the oldest slot, waiting for one if `wait` is set.
+         * @return -1 if the ring is empty and (when waiting) closed.
+         */
+        int pop(bool wait);
+
+        /// @brief Wake the waiting consumer, pop() returns -1 once the ring is empty.
+        void close();
+
+        /// @brief Accept slots again after close().
+        void open();
+    };
+
+    AVCodecContext* pCodec = nullptr;  ///< MP3 encoder (S16P).
+    SwrContext* pResampler = nullptr;  ///< float (planar or interleaved) to S16P, at the encoder rate.
+    FILE* pFile = nullptr;             ///< output file.
+
+    std::vector<AVFrame*> mFrames;     ///< encoder frames of frame_size samples.
+    std::vector<AVPacket*> mPackets;   ///< encoded packets.
+
+    SlotRing mFreeFrames;              ///< frames the converter may fill.
+    SlotRing mFullFrames;              ///< filled frames waiting for the encoder.
+    SlotRing mFreePackets;             ///< packets the encoder may receive into.
+    SlotRing mFullPackets;             ///< encoded packets waiting for the writer.
+
+    /// @brief Converted samples of one block, planar S16, before they're cut into frames.
+    std::vector<int16_t> mScratch[kNumChannels];
+
+    int mCurrent = -1;                 ///< frame being filled by the converter, -1 if none.
+    int mFill = 0;                     ///< samples already in the current frame.
+    int mFrameSize = 0;                ///< samples per channel of an encoder frame.
+    int64_t mPts = 0;                  ///< timestamp of the next frame, in samples.
+
+    uint8_t mChannels = 0;
+    Mp3StreamOptions mOptions;
+    std::string mPath;
+
+    bool mInline = true;               ///< the stages run one after another on the calling thread.
+    std::atomic<bool> mFailed{false};  ///< a stage failed, the others stop.
+
+    /**
+     * @brief Where the stage tasks of a run() go, shared with them: a task starting after run()
+     * gave up on the workers returns without touching the encoder.
+     */
+    struct Placement {
+        std::mutex mux;
+        std::condition_variable cond;
+        int started = 0;       ///< stage tasks a worker started.
+        bool decided = false;
+        bool workers = false;  ///< both stages run on workers, otherwise inline on run()'s thread.
+    };
+
+    uint64_t mFramesIn = 0;            ///< frames appended.
+    uint64_t mBytes = 0;               ///< bytes written to the file.
+
+    /// @brief Free every FFmpeg object and close the file.
+    void release() noexcept;
+
+    /// @brief Stop every stage after an error (the waiting ones are woken up).
+    void fail() noexcept;
+
+    /**
+     * @brief Convert `count` input frames (nullptr flushes the resampler) and hand every
+     * full encoder frame to the encoder stage.
+     */
+    bool convert(const uint8_t** input, int count, AJ::error::IErrorHandler &handler);
+
+    /// @brief Hand the current frame (possibly partial) to the encoder stage.
+    bool emitFrame(AJ::error::IErrorHandler &handler);
+
+    /// @brief Send a frame (nullptr drains the encoder) and pass its packets to the writer stage.
+    bool encodeFrame(const AVFrame* frame, AJ::error::IErrorHandler &handler);
+
+    /// @brief Write a packet and give it back to the encoder stage.
+    bool writePacket(int slot, AJ::error::IErrorHandler &handler);
+
+    /// @brief Converter stage of run(): pops the queue until `done` is set and the queue is empty.
+    void convertStage(utils::Queue &queue, utils::BufferPool &pool, const LFControlFlag &done,
+        AJ::error::IErrorHandler &handler);
+
+    /// @brief Encoder stage of run(): encodes the full frames until the converter is done.
+    void encodeStage(AJ::error::IErrorHandler &handler);
+
+    /// @brief Writer stage of run(): writes the packets until the encoder is done.
+    void writeStage(AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Start of a stage task of run(): parks the worker until run() placed both stages.
+     * @return false if the stages run inline instead.
+     */
+    static bool join(Placement &placement);
+
+public:
+    Mp3StreamEncoder() = default;
+    ~Mp3StreamEncoder();
+
+    Mp3StreamEncoder(const Mp3StreamEncoder&) = delete;
+    Mp3StreamEncoder& operator=(const Mp3StreamEncoder&) = delete;
+
+    /**
+     * @brief Open the encoder, allocate the frames and packets and create the file.
+     *
+     * @param path file to write.
+     * @param channels 1 or 2.
+     * @param samplerate sample rate of the file in Hz.
+     * @param options bit rate, input rate / layout, preallocated slots.
+     * @param handler Error handler.
+     * @return false if the encoder, the resampler or the file couldn't be created.
+     */
+    bool open(const std::string &path, uint8_t channels, uint32_t samplerate,
+        const Mp3StreamOptions &options, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Convert, encode and write interleaved frames on the calling thread.
+     * @return false if the encoder was opened for planar input or a stage failed.
+     */
+    bool append(const float* interleaved, size_t frames, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Convert, encode and write planar frames (`channels` arrays) on the calling thread.
+     * @return false if the encoder was opened for interleaved input or a stage failed.
+     */
+    bool appendPlanar(const float* const* channels, size_t frames, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Encode the interleaved buffers of `queue` until `done` is set and the queue is drained.
+     *
+     * Each buffer goes back to `pool` once it's converted. The converter and the encoder run
+     * on `threads` and the writer on the calling thread. Without a pool of two workers or more,
+     * if workers didn't start both stages within kMp3StageWaitTimeout, or if tasks queued before
+     * them (e.g. the producer of `queue`) still wait for a worker, the stages run one after
+     * another on the calling thread.
+     *
+     * @return false if the encoder was opened for planar input or a stage failed.
+     */
+    bool run(std::shared_ptr<utils::Queue> queue, std::shared_ptr<utils::BufferPool> pool,
+        LFControlFlagPtr done, std::shared_ptr<utils::ThreadPool> threads, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Encode what's still buffered and close the file.
+     * @return false if a stage failed or the file couldn't be closed (it's closed anyway).
+     */
+    bool close(AJ::error::IErrorHandler &handler);
+
+    bool isOpen() const noexcept {
+        return pFile != nullptr;
+    }
+
+    /// @brief Frames appended so far (at the input rate).
+    uint64_t frames() const noexcept {
+        return mFramesIn;
+    }
+
+    /// @brief Bytes of MP3 written so far.
+    uint64_t bytes() const noexcept {
+        return mBytes;
+    }
+};
+
+}
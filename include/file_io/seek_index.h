@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+
+namespace AJ::io {
+
+/**
+ * @brief Frame accurate seek table of a compressed file: the byte offset of every
+ * kSeekIndexStride-th packet and the frame its samples start at.
+ *
+ * Built packet by packet while the file is demuxed (MP3_File::read(), buildSeekIndex()), no
+ * decoding needed: a packet starts where the previous one ended, minus the samples the decoder
+ * skips at the start of the stream (encoder delay). The frames are those of a full decode
+ * (`pAudio`), so the first packets may start before 0.
+ *
+ * A VBR MP3 without a TOC otherwise seeks by estimated timestamps. With the table,
+ * MP3_File::seekStream() seeks to the byte offset of a packet and knows the exact frame it
+ * decodes from. The frames of MPEG audio packets are regular, so the point of a frame is found
+ * in O(1) (a guess from the average frames per point, corrected by a step or two).
+ *
+ * Persisted next to the decoded samples by DecodeCache::storeSeekIndex().
+ */
+class SeekIndex {
+public:
+    /// @brief A packet the decoder can start from.
+    struct Point {
+        int64_t mPos;       ///< byte offset of the packet in the file.
+        sample_pos mFrame;  ///< frame of the full decode its first sample lands on.
+    };
+
+private:
+    std::vector<Point> mPoints; ///< every kSeekIndexStride-th packet, in file order.
+    size_t mPackets = 0;        ///< packets appended.
+    sample_pos mNext = 0;       ///< frame the next packet starts at.
+
+public:
+    SeekIndex() = default;
+
+    /// @brief An index read back from `points` (e.g. by DecodeCache), `frames` is the end of the last packet.
+    SeekIndex(std::vector<Point> points, size_t packets, sample_pos frames) :
+        mPoints(std::move(points)), mPackets(packets), mNext(frames) {}
+
+    /**
+     * @brief Account for the next packet of the stream.
+     *
+     * @param pos     byte offset of the packet (AVPacket::pos).
+     * @param frames  samples per channel the packet decodes to.
+     * @param skip    samples the decoder drops from the start of the stream with it (AV_PKT_DATA_SKIP_SAMPLES).
+     */
+    void append(int64_t pos, int64_t frames, int64_t skip) {
+        if(mPackets++ % kSeekIndexStride == 0){
+            mPoints.push_back({ pos, mNext });
+        }
+        mNext += frames - skip;
+    }
+
+    /**
+     * @brief Point to decode from to reach `frame` sample accurately.
+     *
+     * One point before the last one at or before `frame`, so at least kSeekIndexStride packets
+     * prime the decoder (bit reservoir) before the frame.
+     *
+     * @return nullptr if that's the first point (the start of the file, seek by timestamp)
+     *         or the index is empty.
+     */
+    const Point* seekPoint(sample_pos frame) const noexcept;
+
+    /// @brief Points of the table.
+    const std::vector<Point>& points() const noexcept {
+        return mPoints;
+    }
+
+    /// @brief Packets appended.
+    size_t packets() const noexcept {
+        return mPackets;
+    }
+
+    /// @brief Frames of the full decode (where the next packet would start).
+    sample_pos frames() const noexcept {
+        return mNext;
+    }
+
+    bool empty() const noexcept {
+        return mPoints.empty();
+    }
+};
+
+}
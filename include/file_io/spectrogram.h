@@ -0,0 +1,212 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+#include "dsp/fft.h"
+
+namespace AJ::io {
+
+class AudioFile;
+
+/**
+ * @brief Magnitudes of kSpectrogramTileColumns consecutive STFT columns of one channel.
+ */
+struct SpectrogramTile {
+    uint8_t channel = 0;
+    size_t level = 0;
+    size_t index = 0;
+    sample_pos start = 0;      ///< first frame of column 0, column c covers [start + c · hop, start + (c + 1) · hop).
+    size_t hop = 0;            ///< frames per column.
+    size_t columns = 0;        ///< columns inside the file (fewer in the last tile).
+    size_t bins = 0;           ///< FFT size / 2 + 1.
+    std::vector<float> magnitudes; ///< `columns` columns of `bins` linear magnitudes, one column after the other.
+
+    const float* column(size_t c) const noexcept {
+        return magnitudes.data() + c * bins;
+    }
+};
+
+/**
+ * @class Spectrogram
+ * @brief Cached STFT magnitude tiles of an AudioFile at several zoom levels, for spectral views.
+ *
+ * Zoom level `l` has one column per `hop · kSpectrogramFanout^l` frames and groups them in tiles
+ * of kSpectrogramTileColumns columns, so a view of any width costs a few tiles at the level
+ * whose hop is closest to its frames per pixel. A column is the Hann-windowed spectrum centered
+ * on it; once the hop is longer than the window, the power of up to kSpectrogramColumnWindows
+ * windows spread across the column is averaged so zoomed-out levels don't skip transients.
+ * Magnitudes are scaled so a full-scale sine reads 1.
+ *
+ * Missing tiles are computed on the thread pool, column chunks of every tile at once, with the
+ * shared dsp::fft plan. Tiles are kept up to a byte budget, least recently used first out.
+ * Tiles are shared: a tile handed out stays valid after the cache drops it.
+ *
+ * The cache doesn't own the samples: attach it with AudioFile::setSpectrogram() and the edits
+ * that update the level index (Cut, Insert, the engine's applyEffect / applyEffectChain, undo)
+ * drop the tiles whose windows overlap the changed frames. Tiles must not be computed while
+ * the file is being edited.
+ *
+ * Typical usage:
+ * @code
+ * file->setSpectrogram(AJ::io::Spectrogram::create(AJ::kSpectrogramFFTSize, AJ::kSpectrogramHop, handler));
+ * std::vector<std::shared_ptr<const AJ::io::SpectrogramTile>> tiles;
+ * file->spectrogram()->tiles(*file, 0, level, first, count, tiles, pool, handler);  // computed
+ * file->spectrogram()->tiles(*file, 0, level, first, count, tiles, pool, handler);  // cached
+ * @endcode
+ */
+class Spectrogram {
+    struct PrivateTag {};
+
+    /// @brief A cached tile and its place in the LRU list.
+    struct Entry {
+        std::shared_ptr<const SpectrogramTile> tile;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    std::shared_ptr<const dsp::fft::Plan> pFFT;
+    size_t mHop;
+    Float mWindow; ///< periodic Hann of the FFT size.
+    float mScale;  ///< magnitude scale, 2 / sum of the window.
+
+    mutable std::mutex mMux;
+    std::unordered_map<uint64_t, Entry> mEntries;
+    std::list<uint64_t> mLRU; ///< keys, most recently used first.
+    size_t mBudget;
+    size_t mBytes = 0;
+
+    std::atomic<uint64_t> mHits{ 0 };
+    std::atomic<uint64_t> mMisses{ 0 };
+
+    static uint64_t key(uint8_t channel, size_t level, size_t index) noexcept {
+        return (static_cast<uint64_t>(channel) << 56) | (static_cast<uint64_t>(level) << 48) | index;
+    }
+
+    /**
+     * @brief Compute columns [first, last) of a tile from the samples of its channel.
+     */
+    bool computeColumns(const AudioFile &file, SpectrogramTile &tile, size_t first, size_t last) const;
+
+    /// @brief Drop least recently used tiles until the cache fits the budget.
+    void enforce();
+
+public:
+    /// @brief Use create(), which checks the sizes.
+    Spectrogram(PrivateTag, std::shared_ptr<const dsp::fft::Plan> fft, size_t hop, size_t budget);
+
+    Spectrogram(const Spectrogram&) = delete;
+    Spectrogram& operator=(const Spectrogram&) = delete;
+
+    /**
+     * @brief A spectrogram cache.
+     *
+     * @param fftSize frames per analysis window, a power of two in [kFFTMinSize, kFFTMaxSize].
+     * @param hop     frames between two columns of level 0, at least 1.
+     * @param handler Error handler for reporting invalid sizes.
+     * @param budget  bytes of tiles kept.
+     * @return the cache, nullptr on failure.
+     */
+    static std::shared_ptr<Spectrogram> create(size_t fftSize, size_t hop, AJ::error::IErrorHandler &handler,
+        size_t budget = kSpectrogramCacheBudget);
+
+    size_t fftSize() const noexcept {
+        return pFFT->size();
+    }
+
+    size_t bins() const noexcept {
+        return pFFT->bins();
+    }
+
+    /**
+     * @brief Frames per column of a zoom level.
+     */
+    size_t hop(size_t level) const noexcept {
+        size_t frames = mHop;
+        for(size_t l = 0; l < level; ++l){
+            frames *= kSpectrogramFanout;
+        }
+        return frames;
+    }
+
+    /**
+     * @brief Frames covered by a tile of a zoom level.
+     */
+    size_t tileFrames(size_t level) const noexcept {
+        return hop(level) * kSpectrogramTileColumns;
+    }
+
+    /**
+     * @brief Tiles of a zoom level covering the channels of `file`.
+     */
+    size_t tileCount(const AudioFile &file, size_t level) const noexcept;
+
+    /**
+     * @brief Tiles [first, first + count) of a zoom level of a channel, computing the missing ones.
+     *
+     * @param file    the file the cache is attached to.
+     * @param channel channel index.
+     * @param level   zoom level in [0, kSpectrogramLevels).
+     * @param first   first tile.
+     * @param count   number of tiles, first + count must be <= tileCount().
+     * @param tiles   [out] the tiles, in order.
+     * @param pool    workers computing the missing tiles, nullptr computes them on the calling thread.
+     * @param handler Error handler for reporting an invalid channel, level or range.
+     * @return true on success; false on failure.
+     */
+    bool tiles(const AudioFile &file, uint8_t channel, size_t level, size_t first, size_t count,
+        std::vector<std::shared_ptr<const SpectrogramTile>> &tiles, utils::ThreadPool *pool,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief One tile, see tiles().
+     * @return the tile, nullptr on failure.
+     */
+    std::shared_ptr<const SpectrogramTile> tile(const AudioFile &file, uint8_t channel, size_t level, size_t index,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Drop the tiles whose windows read any of the frames [start, end].
+     *
+     * @param start first changed frame.
+     * @param end   last changed frame (inclusive), -1 if everything after `start` moved (cut / insert).
+     */
+    void invalidate(sample_pos start, sample_pos end = -1);
+
+    /**
+     * @brief Drop every tile.
+     */
+    void clear();
+
+    void setBudget(size_t bytes);
+
+    /**
+     * @brief Bytes of the cached tiles.
+     */
+    size_t bytes() const;
+
+    /**
+     * @brief Number of cached tiles.
+     */
+    size_t size() const;
+
+    /// @brief Tiles found in the cache.
+    uint64_t hits() const noexcept {
+        return mHits.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Tiles computed.
+    uint64_t misses() const noexcept {
+        return mMisses.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace AJ::io
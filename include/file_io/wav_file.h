@@ -8,6 +8,7 @@
 
 
 #include "audio_file.h"
+#include "mapped_wav.h"
 #include "core/types.h"
 
 
@@ -20,7 +21,8 @@ namespace AJ::io {
  *
  * This class implements the AudioFile interface for `.wav` files,
  * supporting mono and stereo formats. It provides functionality for:
- * - Reading WAV files into memory (offline processing).
+ * - Reading WAV files into memory (offline processing). Plain PCM / float files are
+ *   memory mapped and deinterleaved in one pass (see MappedWav), other encodings go through libsndfile.
  * - Writing processed audio back to disk.
  *
  * @note Currently supports only mono and stereo audio formats.
@@ -46,6 +48,15 @@ private:
      */
     BitDepth_t get_bit_depth(const SF_INFO &info);
 
+    /**
+     * @brief Validates the opened file and fills `mInfo` from its header.
+     * @param file Opened SNDFILE handle, closed if the file is rejected.
+     * @param sfInfo Header info returned by sf_open.
+     * @param handler Error handler for reporting unsupported files.
+     * @return true if the file is a supported WAV, false otherwise.
+     */
+    bool read_info(SNDFILE *file, const SF_INFO &sfInfo, AJ::error::IErrorHandler &handler);
+
     /**
      * @brief Reads mono channel audio data into memory.
      * @param file Opened SNDFILE handle.
@@ -62,6 +73,27 @@ private:
      */
     bool read_stereo_data(SNDFILE *file, AJ::error::IErrorHandler &handler);
 
+    /**
+     * @brief read_stereo_data() with a read pool: the next chunk is decoded while a worker
+     * deinterleaves the last one.
+     * @param file Opened SNDFILE handle, the channels already sized.
+     * @param handler Error handler for reporting read failures.
+     * @return true on success, false otherwise.
+     */
+    bool read_stereo_pipelined(SNDFILE *file, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Reads frames of a memory mapped WAV, converting and deinterleaving them chunk by chunk.
+     *
+     * The pages of the next chunks are prefetched while one is converted. With a read pool,
+     * stretches of kLoadStretchFrames convert on the workers.
+     * @param map Opened mapping of the file, closed once the samples are read.
+     * @param start first frame to read.
+     * @param count frames to read, `start + count` must not be past the end of the mapping.
+     * @return true (the mapping was validated by MappedWav::open()).
+     */
+    bool read_mapped(MappedWav &map, size_t start, size_t count);
+
     /**
      * @brief Initializes SF_INFO struct using internal write info.
      *        Handles frame count, sample rate, seekability, and channels.
@@ -93,6 +125,25 @@ public:
      */
     bool read(AJ::error::IErrorHandler &handler) override;
 
+    /**
+     * @brief Reads the frames [start, end] of a WAV file, other frames are never read.
+     *
+     * Mapped files only touch the pages of the range, others are seeked with sf_seek().
+     *
+     * @param start first frame to read.
+     * @param end last frame to read (inclusive), -1 reads to the end.
+     * @param handler Error handler to report issues during reading.
+     * @return true on successful read, false otherwise.
+     */
+    bool readRange(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler) override;
+
+    /**
+     * @brief Reads the WAV header into `mInfo` without loading the samples.
+     * @param handler Error handler to report issues during probing.
+     * @return true on success, false otherwise.
+     */
+    bool probe(AJ::error::IErrorHandler &handler) override;
+
     /**
      * @brief Writes the internal audio buffer to a WAV file.
      * @param handler Error handler to report issues during writing.
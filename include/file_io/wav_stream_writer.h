@@ -0,0 +1,148 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "core/constants.h"
+#include "core/error_handler.h"
+
+namespace AJ::io {
+
+/**
+ * @brief Settings of a WavStreamWriter.
+ */
+struct WavStreamOptions {
+    /// @brief Bytes coalesced per write, rounded up to kStreamWriteAlignment.
+    size_t batchBytes = kStreamWriteBatchBytes;
+
+    /// @brief Open the file with O_DIRECT (bypass the page cache), buffered if the file system refuses.
+    bool direct = false;
+
+    /**
+     * @brief Promote the file to RF64 at close when it's past the 4 GiB RIFF limit
+     * (files under the limit stay plain WAV). Without it the sizes of a larger file are saturated.
+     */
+    bool rf64 = false;
+
+    /**
+     * @brief Reserve disk space this many bytes at a time ahead of the write cursor (fallocate),
+     * 0 to let the file grow by its writes. The unused reservation is released at close.
+     */
+    size_t preallocateBytes = 0;
+};
+
+/**
+ * @class WavStreamWriter
+ * @brief Append-only 32-bit float WAV writer that coalesces small blocks into large aligned writes.
+ *
+ * Recording produces one small block per audio callback. Instead of one libsndfile write per
+ * block, append() copies the interleaved frames into a staging batch (kStreamWriteAlignment
+ * aligned, a multiple of it in size) and the batch goes to disk in one pwrite() once it's full,
+ * so the caller can recycle its buffer right after append() returns.
+ *
+ * The header takes the first kStreamWriteAlignment bytes of the file (a JUNK chunk reserved for
+ * the RF64 ds64 chunk, the fmt chunk, then a JUNK chunk padding the data chunk to the alignment),
+ * so every batch lands on an aligned offset and the file can be opened with O_DIRECT.
+ * The sizes of the header are patched by close(), which turns the file into RF64 if it grew
+ * past 4 GiB and WavStreamOptions::rf64 is set.
+ *
+ * With WavStreamOptions::preallocateBytes the file reserves its space in large extents ahead
+ * of the writes (steady write latency, one unfragmented file for day long recordings), close()
+ * trims what wasn't used.
+ *
+ * Every failure is reported to the handler, a writer that failed stays open until close().
+ */
+class WavStreamWriter {
+    int mFd = -1;                  ///< file descriptor, -1 if closed.
+    bool mDirect = false;          ///< the file was opened with O_DIRECT.
+    uint8_t* pBatch = nullptr;     ///< staging batch (the header, then samples).
+    size_t mBatchBytes = 0;        ///< capacity of the batch.
+    size_t mBatchUsed = 0;         ///< bytes staged in the batch.
+    uint64_t mFileOffset = 0;      ///< bytes already written to the file.
+    uint64_t mDataBytes = 0;       ///< sample bytes appended so far.
+    uint64_t mWrites = 0;          ///< batches written.
+    uint64_t mAllocated = 0;       ///< bytes reserved by fallocate() from the start of the file.
+    WavStreamOptions mOptions;     ///< settings of open().
+    uint16_t mChannels = 0;        ///< interleaved channels.
+    uint32_t mSamplerate = 0;      ///< sample rate in Hz.
+    std::string mPath;             ///< path of the file, for the error messages.
+
+    /**
+     * @brief Write the header (with the current sizes) into the first kStreamWriteAlignment bytes of `out`.
+     */
+    void header(uint8_t* out) const noexcept;
+
+    /**
+     * @brief Write the staged bytes at the end of the file.
+     */
+    bool flush(AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Reserve the next extents if the cursor reached the end of the reservation.
+     *
+     * A file system without fallocate() support turns preallocation off, nothing is reported.
+     */
+    void preallocate(uint64_t end) noexcept;
+
+    /// @brief Release the descriptor and the batch without finishing the file.
+    void release() noexcept;
+
+public:
+    WavStreamWriter() = default;
+    ~WavStreamWriter();
+
+    WavStreamWriter(const WavStreamWriter&) = delete;
+    WavStreamWriter& operator=(const WavStreamWriter&) = delete;
+
+    /**
+     * @brief Create (or truncate) the file and stage its header.
+     *
+     * @param path file to write.
+     * @param channels interleaved channels of the appended frames.
+     * @param samplerate sample rate in Hz.
+     * @param options batch size, O_DIRECT, RF64 and preallocation settings.
+     * @param handler Error handler.
+     * @return false if the file or the batch couldn't be created.
+     */
+    bool open(const std::string &path, uint16_t channels, uint32_t samplerate,
+        const WavStreamOptions &options, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Append interleaved frames, written once the batch is full.
+     * @return false if a write failed.
+     */
+    bool append(const float* interleaved, size_t frames, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Write what's staged, patch the header sizes (RF64 past 4 GiB if enabled),
+     * release the unused reservation and close the file.
+     * @return false if a write or the close failed (the file is closed anyway).
+     */
+    bool close(AJ::error::IErrorHandler &handler);
+
+    bool isOpen() const noexcept {
+        return mFd >= 0;
+    }
+
+    /// @brief Whether the file is written with O_DIRECT.
+    bool isDirect() const noexcept {
+        return mDirect;
+    }
+
+    /// @brief Frames appended so far.
+    uint64_t frames() const noexcept {
+        return mChannels ? mDataBytes / (mChannels * sizeof(float)) : 0;
+    }
+
+    /// @brief Bytes currently reserved by preallocation (0 if disabled or unsupported).
+    uint64_t allocated() const noexcept {
+        return mAllocated;
+    }
+
+    /// @brief Batches written to disk so far.
+    uint64_t writes() const noexcept {
+        return mWrites;
+    }
+};
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "file_io/file_streamer.h"
+#include "core/constants.h"
+#include "core/error_handler.h"
+#include "core/thread_placement.h"
+
+namespace AJ::io::file_streamer {
+
+/**
+ * @class WriterPool
+ * @brief A few disk writer threads serving the FileStreamers of many recording streams.
+ *
+ * FileStreamer::write() holds one thread per stream, parked on that stream's queue. With
+ * dozens of streams the pool instead gives each stream to the worker with the fewest, and a
+ * worker writes what every one of its streams has queued (FileStreamer::writePending()) before
+ * it sleeps for kStreamerWakeTimeout. The record pools must hold more than that of audio.
+ *
+ * add() and remove() don't wait for the workers: a stream is opened by add() on the caller's
+ * thread, and finished (rest of its queue, file closed) by its worker after remove().
+ *
+ * ### Example:
+ * @code
+ * AJ::io::file_streamer::WriterPool writers(2);
+ * writers.add(streamer, handler);          // the stream's callback can start
+ * // ...
+ * std::future<bool> done = writers.remove(streamer);   // after its callback stopped
+ * done.get();                              // file closed
+ * @endcode
+ */
+class WriterPool {
+private:
+    /// @brief One stream of a worker.
+    struct Stream {
+        std::shared_ptr<FileStreamer> streamer;
+        AJ::error::IErrorHandler *handler;
+        bool closing = false;           ///< remove() was called, the worker finishes it.
+        std::promise<bool> done;        ///< endWrite() result.
+    };
+
+    /// @brief A writer thread and the streams it serves.
+    struct Worker {
+        std::mutex mux;
+        std::condition_variable wake;
+        std::vector<std::shared_ptr<Stream>> streams;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    bool mStop = false;                 ///< set under every worker's mutex by the destructor.
+    std::atomic<bool> mPlaced{true};
+
+    void start(size_t workers, const AJ::utils::ThreadPlacement *placement, AJ::error::IErrorHandler *handler);
+
+    /**
+     * @brief Worker loop: write, finish removed streams, sleep when nothing was queued.
+     */
+    void run(Worker &worker);
+
+public:
+    /**
+     * @param workers writer threads, at least one.
+     */
+    explicit WriterPool(size_t workers = kRecordWriterThreads);
+
+    /**
+     * @brief Writer threads running with `placement`, e.g. pinned next to the disk controller.
+     *
+     * Returns once every worker placed itself. Failures go to `handler`, during the constructor
+     * only, and the worker runs unplaced: see placed().
+     */
+    WriterPool(size_t workers, const AJ::utils::ThreadPlacement &placement, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Finish every stream still served and join the workers.
+     */
+    ~WriterPool();
+
+    WriterPool(const WriterPool&) = delete;
+    WriterPool& operator=(const WriterPool&) = delete;
+
+    /**
+     * @brief Open the stream's file (FileStreamer::beginWrite()) and hand it to a worker.
+     *
+     * @param handler receives the errors of the stream, from the worker thread after this call.
+     * @return false (reported) if the file can't be opened.
+     */
+    bool add(std::shared_ptr<FileStreamer> streamer, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Have the worker write the rest of the stream's queue and close its file.
+     *
+     * Call it once nothing pushes into the stream's queue anymore.
+     * @return the FileStreamer::endWrite() result, false right away if the stream isn't served.
+     */
+    std::future<bool> remove(const std::shared_ptr<FileStreamer> &streamer);
+
+    /**
+     * @brief Writer threads.
+     */
+    size_t workers() const noexcept {
+        return mWorkers.size();
+    }
+
+    /**
+     * @brief false if a worker couldn't apply its ThreadPlacement.
+     */
+    bool placed() const noexcept {
+        return mPlaced.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Streams served right now, by all workers.
+     */
+    size_t streams();
+};
+
+}
@@ -1,8 +1,147 @@
-#pragma once 
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "core/types.h"
+#include "core/error_handler.h"
+#include "file_io/audio_file.h"
+#include "editing/piece_table.h"
 
 namespace AJ::undo {
+
+/**
+ * @brief One range replacement: `removed` frames from `start` were replaced by `inserted` frames.
+ *
+ * An effect replaces a range by as many frames, a cut inserts none, an insert removes none.
+ * `saved` holds the removed frames, as immutable chunks (shared with the table for a table
+ * target, a copy of the range for a file).
+ */
+struct Change {
+    std::weak_ptr<io::AudioFile> file;                     ///< target file (or expired if a table is the target).
+    std::weak_ptr<editing::piece_table::PieceTable> table; ///< target table (or expired if a file is the target).
+    sample_pos start = 0;
+    size_t removed = 0;   ///< frames replaced by the change (the frames of `saved`).
+    size_t inserted = 0;  ///< frames the change put in their place.
+    uint8_t channels = 0;
+    editing::piece_table::PieceTable saved; ///< the removed frames, empty while the state is spilled.
+};
+
+/**
+ * @class State
+ * @brief One undoable operation: the changes it made, with the frames each of them replaced.
+ *
+ * Capturing a change costs only the frames it touches, not a snapshot of the file. A state
+ * can be spilled to disk (its samples written to a file, its chunks released) and loaded back
+ * when it's undone. The spill file is removed with the state.
+ */
 class State {
+    std::vector<Change> mChanges;
+    std::string mLabel;
+    std::string mSpillPath; ///< file holding the saved frames while spilled, empty otherwise.
+
+    /**
+     * @brief Copy the frames [start, start + frames) of the target of `change` into `change.saved`.
+     */
+    static bool capture(Change &change, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Replace the `inserted` frames of a change by its saved frames.
+     */
+    static bool restore(Change &change, AJ::error::IErrorHandler &handler);
+
+public:
+    State() = default;
+
+    explicit State(std::string label) : mLabel(std::move(label)) {}
+
+    State(State &&other) noexcept;
+    State& operator=(State &&other) noexcept;
+    State(const State&) = delete;
+    State& operator=(const State&) = delete;
+
+    /**
+     * @brief Removes the spill file, if any.
+     */
+    ~State();
+
+    /**
+     * @brief Record a change of a file, **before** it's made.
+     *
+     * The frames [start, start + removed) of every channel are copied (any storage).
+     *
+     * @param file     the file about to change.
+     * @param start    first frame of the change.
+     * @param removed  frames the change will replace (0 for an insert).
+     * @param inserted frames the change will put in their place (0 for a cut).
+     * @param handler  Error handler for reporting a range out of the file.
+     * @return true on success; false on failure.
+     */
+    bool add(const std::shared_ptr<io::AudioFile> &file, sample_pos start, size_t removed, size_t inserted,
+        AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Record a change of a piece table, **before** it's made.
+     *
+     * The removed frames are kept as pieces of the table's own chunks, no sample is copied.
+     */
+    bool add(const std::shared_ptr<editing::piece_table::PieceTable> &table, sample_pos start, size_t removed,
+        size_t inserted, AJ::error::IErrorHandler &handler);
 
+    /**
+     * @brief Append a change recorded elsewhere (e.g. read back from a project), **after** it was
+     * made: `change.saved` already holds its `removed` frames.
+     */
+    void append(Change change) {
+        mChanges.push_back(std::move(change));
+    }
+
+    /**
+     * @brief Undo the changes, the last one first, and record in `inverse` how to redo them.
+     *
+     * The target of every change must still exist and hold the frames the change inserted.
+     * A length changing change of a file needs Float32 storage. A spilled state is loaded first.
+     *
+     * @return true on success; false on failure (the changes before the failing one are undone).
+     */
+    bool apply(State &inverse, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Write the saved frames to `path` and release them.
+     * @return false (reported) if the file can't be written, the state is left in memory.
+     */
+    bool spill(const std::string &path, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Read the saved frames back from the spill file and remove it.
+     */
+    bool load(AJ::error::IErrorHandler &handler);
+
+    bool spilled() const noexcept {
+        return !mSpillPath.empty();
+    }
+
+    bool empty() const noexcept {
+        return mChanges.empty();
+    }
+
+    const std::string& label() const noexcept {
+        return mLabel;
+    }
+
+    const std::vector<Change>& changes() const noexcept {
+        return mChanges;
+    }
+
+    /**
+     * @brief Bytes of samples the saved frames take in memory, 0 while spilled.
+     */
+    size_t residentBytes() const noexcept;
+
+    /**
+     * @brief Bytes of samples of the saved frames, in memory or spilled.
+     */
+    size_t savedBytes() const noexcept;
 };
-}
\ No newline at end of file
+
+} // namespace AJ::undo
@@ -1,8 +1,161 @@
 #pragma once
+#include <deque>
+#include <string>
 
+#include "core/constants.h"
+#include "core/error_handler.h"
+#include "undo_system/state.h"
 
 namespace AJ::undo {
+
+/**
+ * @class UndoSystem
+ * @brief Undo / redo history of States, within a memory budget.
+ *
+ * A State keeps only the frames its operation replaced, so the history grows with what was
+ * edited, not with the length of the files. The saved frames of all the states in memory are
+ * capped by a budget: over it, the oldest states are spilled to the spill directory (e.g. the
+ * session directory) and loaded back when they are undone, or dropped if no directory is set.
+ *
+ * Typical usage:
+ * @code
+ * AJ::undo::State state("gain");
+ * state.add(file, start, frames, frames, handler); // before the change.
+ * // ... process [start, start + frames) of the file ...
+ * undo.push(std::move(state));
+ * undo.undo(handler);
+ * @endcode
+ */
 class UndoSystem {
+    std::deque<State> mUndo; ///< oldest first.
+    std::deque<State> mRedo; ///< oldest (furthest from the current state) first.
+    size_t mBudget = kUndoDefaultBudget;
+    size_t mMaxStates = kUndoDefaultMaxStates;
+    std::string mDirectory;
+    uint64_t mNextSpill = 0;
+
+    /**
+     * @brief Spill or drop the oldest states until the resident bytes fit the budget.
+     */
+    void enforce(AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Path of the next spill file in the spill directory.
+     */
+    std::string spillPath();
+
+public:
+    UndoSystem() = default;
+
+    /**
+     * @brief Add the state of an operation that was just made, the redo history is cleared.
+     *
+     * An empty state is ignored.
+     */
+    void push(State state, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Undo the last operation.
+     * @return false (reported) if there's nothing to undo or it can't be restored.
+     */
+    bool undo(AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Redo the last undone operation.
+     * @return false (reported) if there's nothing to redo or it can't be restored.
+     */
+    bool redo(AJ::error::IErrorHandler &handler);
+
+    bool canUndo() const noexcept {
+        return !mUndo.empty();
+    }
+
+    bool canRedo() const noexcept {
+        return !mRedo.empty();
+    }
+
+    /**
+     * @brief Replace the history (e.g. with states read back from a project), within the budget.
+     *
+     * @param undo undo states, oldest first.
+     * @param redo redo states, oldest (furthest from the current state) first.
+     */
+    void assign(std::deque<State> undo, std::deque<State> redo, AJ::error::IErrorHandler &handler);
+
+    /**
+     * @brief Load every spilled state back into memory (e.g. before saving the history elsewhere).
+     * The budget applies again from the next push, undo or redo.
+     * @return false (reported) if a spill file can't be read.
+     */
+    bool load(AJ::error::IErrorHandler &handler);
+
+    /// @brief Undo states, oldest first.
+    const std::deque<State>& undoStates() const noexcept {
+        return mUndo;
+    }
 
+    /// @brief Redo states, oldest first.
+    const std::deque<State>& redoStates() const noexcept {
+        return mRedo;
+    }
+
+    size_t undoCount() const noexcept {
+        return mUndo.size();
+    }
+
+    size_t redoCount() const noexcept {
+        return mRedo.size();
+    }
+
+    /**
+     * @brief Drop the whole history (and its spill files).
+     */
+    void clear() noexcept {
+        mUndo.clear();
+        mRedo.clear();
+    }
+
+    /**
+     * @brief Bytes of saved samples in memory (spilled states excluded).
+     */
+    size_t residentBytes() const noexcept;
+
+    /**
+     * @brief Bytes of saved samples the history keeps in memory before spilling or dropping states.
+     */
+    void setBudget(size_t bytes, AJ::error::IErrorHandler &handler) {
+        mBudget = bytes;
+        enforce(handler);
+    }
+
+    size_t budget() const noexcept {
+        return mBudget;
+    }
+
+    /**
+     * @brief Number of undo states kept, the oldest are dropped (at least 1).
+     */
+    void setMaxStates(size_t states) {
+        mMaxStates = states > 0 ? states : 1;
+        while(mUndo.size() > mMaxStates){
+            mUndo.pop_front();
+        }
+    }
+
+    size_t maxStates() const noexcept {
+        return mMaxStates;
+    }
+
+    /**
+     * @brief Directory the oldest states are spilled to when over budget, "" drops them instead.
+     */
+    void setSpillDirectory(const std::string &directory) {
+        mDirectory = directory;
+    }
+
+    const std::string& spillDirectory() const noexcept {
+        return mDirectory;
+    }
 };
-}
\ No newline at end of file
+
+} // namespace AJ::undo
@@ -0,0 +1,143 @@
+#include <cstring>
+#include <thread>
+
+#include "audio_io/callback_profiler.h"
+
+namespace {
+
+uint64_t doubleBits(double value) noexcept {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(uint64_t bits) noexcept {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}
+
+bool AJ::io::record::CallbackProfiler::onCallback(uint64_t duration, unsigned long frames, PaStreamCallbackFlags flags,
+    const PaStreamCallbackTimeInfo *timeInfo, uint64_t queueDepth) noexcept {
+
+    const uint64_t index = mCallbacks.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t deadline = static_cast<uint64_t>(frames * mNsPerFrame);
+    const bool missed = deadline && duration > deadline;
+
+    mDurations.record(duration);
+    mDeadline.store(deadline, std::memory_order_relaxed);
+    mQueueDepth.store(queueDepth, std::memory_order_relaxed);
+    AJ::utils::raiseAtomic(mMaxQueueDepth, queueDepth);
+
+    if(missed){
+        mDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+    if(flags & paInputOverflow){
+        mInputOverflows.fetch_add(1, std::memory_order_relaxed);
+    }
+    if(flags & paInputUnderflow){
+        mInputUnderflows.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //* the log is sorted slowest first, most callbacks are faster than its last entry.
+    if(mWorstCount == mWorst.size() && duration <= mWorst.back().duration){
+        return missed;
+    }
+
+    size_t at = mWorstCount < mWorst.size() ? mWorstCount++ : mWorst.size() - 1;
+    for(; at > 0 && mWorst[at - 1].duration < duration; --at){
+        mWorst[at] = mWorst[at - 1];
+    }
+
+    mWorst[at] = SlowCallback{ index, duration, deadline, frames, queueDepth, flags,
+                               timeInfo ? timeInfo->inputBufferAdcTime : 0.0 };
+    publishWorst();
+
+    return missed;
+}
+
+void AJ::io::record::CallbackProfiler::publishWorst() noexcept {
+    const uint64_t sequence = mWorstSequence.load(std::memory_order_relaxed);
+    mWorstSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for(size_t i = 0; i < mWorstCount; ++i){
+        const SlowCallback &slow = mWorst[i];
+        std::atomic<uint64_t> *words = &mWorstWords[i * kWords];
+
+        words[0].store(slow.index, std::memory_order_relaxed);
+        words[1].store(slow.duration, std::memory_order_relaxed);
+        words[2].store(slow.deadline, std::memory_order_relaxed);
+        words[3].store(slow.frames, std::memory_order_relaxed);
+        words[4].store(slow.queueDepth, std::memory_order_relaxed);
+        words[5].store(slow.flags, std::memory_order_relaxed);
+        words[6].store(doubleBits(slow.inputTime), std::memory_order_relaxed);
+    }
+    mWorstPublished.store(mWorstCount, std::memory_order_relaxed);
+
+    mWorstSequence.store(sequence + 2, std::memory_order_release);
+}
+
+AJ::io::record::CallbackProfile AJ::io::record::CallbackProfiler::snapshot() const {
+    CallbackProfile profile;
+    profile.callbacks = mCallbacks.load(std::memory_order_relaxed);
+    profile.deadlineMisses = mDeadlineMisses.load(std::memory_order_relaxed);
+    profile.inputOverflows = mInputOverflows.load(std::memory_order_relaxed);
+    profile.inputUnderflows = mInputUnderflows.load(std::memory_order_relaxed);
+    profile.queueDepth = mQueueDepth.load(std::memory_order_relaxed);
+    profile.maxQueueDepth = mMaxQueueDepth.load(std::memory_order_relaxed);
+    profile.deadline = mDeadline.load(std::memory_order_relaxed);
+    profile.durations = mDurations.summary();
+
+    profile.worst.reserve(kRecordWorstCallbacks);
+
+    //? retry while the callback rewrites the log, it only does so for a new slow callback.
+    for(;;){
+        const uint64_t sequence = mWorstSequence.load(std::memory_order_acquire);
+        if(sequence & 1){
+            std::this_thread::yield();
+            continue;
+        }
+
+        profile.worst.clear();
+        const size_t count = mWorstPublished.load(std::memory_order_relaxed);
+        for(size_t i = 0; i < count && i < kRecordWorstCallbacks; ++i){
+            const std::atomic<uint64_t> *words = &mWorstWords[i * kWords];
+
+            SlowCallback slow;
+            slow.index = words[0].load(std::memory_order_relaxed);
+            slow.duration = words[1].load(std::memory_order_relaxed);
+            slow.deadline = words[2].load(std::memory_order_relaxed);
+            slow.frames = words[3].load(std::memory_order_relaxed);
+            slow.queueDepth = words[4].load(std::memory_order_relaxed);
+            slow.flags = words[5].load(std::memory_order_relaxed);
+            slow.inputTime = bitsDouble(words[6].load(std::memory_order_relaxed));
+            profile.worst.push_back(slow);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(mWorstSequence.load(std::memory_order_relaxed) == sequence){
+            break;
+        }
+    }
+
+    return profile;
+}
+
+void AJ::io::record::CallbackProfiler::reset() noexcept {
+    mWorstCount = 0;
+
+    mCallbacks.store(0, std::memory_order_relaxed);
+    mDeadlineMisses.store(0, std::memory_order_relaxed);
+    mInputOverflows.store(0, std::memory_order_relaxed);
+    mInputUnderflows.store(0, std::memory_order_relaxed);
+    mQueueDepth.store(0, std::memory_order_relaxed);
+    mMaxQueueDepth.store(0, std::memory_order_relaxed);
+    mDeadline.store(0, std::memory_order_relaxed);
+    mDurations.reset();
+
+    mWorstPublished.store(0, std::memory_order_relaxed);
+    mWorstSequence.store(mWorstSequence.load(std::memory_order_relaxed) + 2, std::memory_order_release);
+}
@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <thread>
+
+#include "audio_io/device.h"
+#include "core/memory.h"
+
+namespace {
+
+PaHostApiTypeId hostApiType(AJ::io::device::HostApi api) noexcept {
+    switch(api){
+    case AJ::io::device::HostApi::ALSA: return paALSA;
+    case AJ::io::device::HostApi::JACK: return paJACK;
+    case AJ::io::device::HostApi::CoreAudio: return paCoreAudio;
+    case AJ::io::device::HostApi::ASIO: return paASIO;
+    case AJ::io::device::HostApi::WASAPI: return paWASAPI;
+    default: return paInDevelopment;
+    }
+}
+
+AJ::io::device::HostApi hostApiOf(PaHostApiTypeId type) noexcept {
+    switch(type){
+    case paALSA: return AJ::io::device::HostApi::ALSA;
+    case paJACK: return AJ::io::device::HostApi::JACK;
+    case paCoreAudio: return AJ::io::device::HostApi::CoreAudio;
+    case paASIO: return AJ::io::device::HostApi::ASIO;
+    case paWASAPI: return AJ::io::device::HostApi::WASAPI;
+    default: return AJ::io::device::HostApi::Default;
+    }
+}
+
+size_t nextPowerOfTwo(size_t value) noexcept {
+    size_t power = 1;
+    while(power < value){
+        power <<= 1;
+    }
+    return power;
+}
+
+//* state of the calibration stream, the callback plays the burst and captures the first input channel.
+struct Calibration {
+    std::vector<float> probe;
+    std::vector<float> captured;
+    size_t probeStart = 0;          ///< frame of the stream the burst starts at.
+    int outputChannels = 2;
+    int inputChannels = 1;
+
+    std::atomic<size_t> position{0};
+    std::atomic<bool> done{false};
+};
+
+int calibrationCallback(const void *inputBuffer, void *outputBuffer, unsigned long framesPerBuffer,
+    const PaStreamCallbackTimeInfo*, PaStreamCallbackFlags, void *userData){
+
+    Calibration *calibration = static_cast<Calibration*>(userData);
+
+    const AJ::utils::RealtimeScope realtime;
+    const float *input = static_cast<const float*>(inputBuffer);
+    float *output = static_cast<float*>(outputBuffer);
+
+    const size_t start = calibration->position.load(std::memory_order_relaxed);
+    const size_t probeEnd = calibration->probeStart + calibration->probe.size();
+
+    for(size_t f = 0; f < framesPerBuffer; ++f){
+        const size_t frame = start + f;
+        const float sample = frame >= calibration->probeStart && frame < probeEnd
+            ? calibration->probe[frame - calibration->probeStart] : 0.0f;
+
+        for(int ch = 0; ch < calibration->outputChannels; ++ch){
+            output[f * calibration->outputChannels + ch] = sample;
+        }
+
+        if(frame < calibration->captured.size()){
+            calibration->captured[frame] = input ? input[f * calibration->inputChannels] : 0.0f;
+        }
+    }
+
+    const size_t end = start + framesPerBuffer;
+    calibration->position.store(end, std::memory_order_relaxed);
+
+    if(end >= calibration->captured.size()){
+        calibration->done.store(true, std::memory_order_release);
+        return paComplete;
+    }
+
+    return paContinue;
+}
+
+}
+
+const char* AJ::io::device::hostApiName(HostApi api) noexcept {
+    switch(api){
+    case HostApi::Default: return "default";
+    case HostApi::ALSA: return "ALSA";
+    case HostApi::JACK: return "JACK";
+    case HostApi::CoreAudio: return "CoreAudio";
+    case HostApi::ASIO: return "ASIO";
+    case HostApi::WASAPI: return "WASAPI";
+    default: return "unknown";
+    }
+}
+
+AJ::io::device::DeviceConfig AJ::io::device::DeviceConfig::tracking(int samplerate){
+    DeviceConfig config;
+    config.mSamplerate = samplerate;
+    config.mFramesPerBuffer = kDeviceTrackingFrames;
+    return config;
+}
+
+AJ::io::device::DeviceConfig AJ::io::device::DeviceConfig::safe(int samplerate){
+    DeviceConfig config;
+    config.mSamplerate = samplerate;
+    config.mFramesPerBuffer = kDeviceSafeFrames;
+    config.mInput.mSuggestedLatency = kDeviceSafeLatency;
+    config.mOutput.mSuggestedLatency = kDeviceSafeLatency;
+    return config;
+}
+
+size_t AJ::io::device::DeviceConfig::framesPerBuffer() const noexcept {
+    if(mFramesPerBuffer){
+        return mFramesPerBuffer;
+    }
+
+    return std::max<size_t>(1, static_cast<size_t>(mSamplerate * BUFFER_SECONDS));
+}
+
+bool AJ::io::device::DeviceConfig::validate(AJ::error::IErrorHandler &handler) const {
+    if(mSamplerate < static_cast<int>(kMinSamplerate) || mSamplerate > static_cast<int>(kMaxSamplerate)){
+        const std::string message = "Error: unsupported device samplerate " + std::to_string(mSamplerate) + ".\n";
+        handler.onError(AJ::error::Error::InvalidSampleRate, message);
+        return false;
+    }
+
+    if(mChannels < 1 || mChannels > 2){
+        const std::string message = "Error: the audio devices only support mono and stereo.\n";
+        handler.onError(AJ::error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    if(framesPerBuffer() > static_cast<size_t>(mSamplerate) || !(mBufferedSeconds > 0.0)){
+        const std::string message = "Error: invalid device buffer size.\n";
+        handler.onError(AJ::error::Error::InvalidBufferSize, message);
+        return false;
+    }
+
+    return true;
+}
+
+AJ::io::device::PoolSizing AJ::io::device::poolSizing(const DeviceConfig &config) noexcept {
+    PoolSizing sizing;
+    sizing.bufferFrames = config.framesPerBuffer();
+
+    const double frames = std::max(0.0, config.mBufferedSeconds) * config.mSamplerate;
+    const size_t buffers = static_cast<size_t>(std::ceil(frames / static_cast<double>(sizing.bufferFrames)));
+
+    sizing.buffers = nextPowerOfTwo(std::clamp(buffers, kDeviceMinBuffers, kDeviceMaxBuffers));
+    return sizing;
+}
+
+std::shared_ptr<AJ::io::device::PortAudioSession> AJ::io::device::PortAudioSession::acquire(AJ::error::IErrorHandler &handler){
+    static std::mutex mux;
+    static std::weak_ptr<PortAudioSession> current;
+
+    std::lock_guard<std::mutex> lock(mux);
+
+    if(std::shared_ptr<PortAudioSession> session = current.lock()){
+        return session;
+    }
+
+    //? PortAudio counts initializations: a previous session still terminating elsewhere is fine.
+    if(Pa_Initialize() != paNoError){
+        const std::string message = "Can't initialize PortAudio.\n";
+        handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+        return nullptr;
+    }
+
+    std::shared_ptr<PortAudioSession> session(new PortAudioSession());
+    current = session;
+    return session;
+}
+
+AJ::io::device::PortAudioSession::~PortAudioSession(){
+    Pa_Terminate();
+}
+
+std::vector<AJ::io::device::DeviceInfo> AJ::io::device::listDevices(AJ::error::IErrorHandler &handler){
+    std::vector<DeviceInfo> devices;
+
+    if(Pa_Initialize() != paNoError){
+        const std::string message = "Can't initialize PortAudio to list the devices.\n";
+        handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+        return devices;
+    }
+
+    const PaDeviceIndex count = Pa_GetDeviceCount();
+    for(PaDeviceIndex d = 0; d < count; ++d){
+        const PaDeviceInfo *info = Pa_GetDeviceInfo(d);
+        if(!info){
+            continue;
+        }
+
+        const PaHostApiInfo *api = Pa_GetHostApiInfo(info->hostApi);
+
+        DeviceInfo device;
+        device.index = d;
+        device.name = info->name ? info->name : "";
+        device.hostApi = api ? hostApiOf(api->type) : HostApi::Default;
+        device.hostApiName = api && api->name ? api->name : "";
+        device.maxInputChannels = info->maxInputChannels;
+        device.maxOutputChannels = info->maxOutputChannels;
+        device.defaultSamplerate = info->defaultSampleRate;
+        device.defaultLowInputLatency = info->defaultLowInputLatency;
+        device.defaultLowOutputLatency = info->defaultLowOutputLatency;
+        device.defaultHighInputLatency = info->defaultHighInputLatency;
+        device.defaultHighOutputLatency = info->defaultHighOutputLatency;
+        devices.push_back(std::move(device));
+    }
+
+    Pa_Terminate();
+    return devices;
+}
+
+bool AJ::io::device::streamParameters(const DeviceSelection &selection, bool input, int channels,
+    PaStreamParameters &parameters, AJ::error::IErrorHandler &handler){
+
+    const char *direction = input ? "input" : "output";
+
+    const PaHostApiIndex api = selection.mHostApi == HostApi::Default
+        ? Pa_GetDefaultHostApi() : Pa_HostApiTypeIdToHostApiIndex(hostApiType(selection.mHostApi));
+    const PaHostApiInfo *apiInfo = api >= 0 ? Pa_GetHostApiInfo(api) : nullptr;
+
+    if(!apiInfo){
+        const std::string message = "Error: the " + std::string(hostApiName(selection.mHostApi)) + " host API isn't available.\n";
+        handler.onError(AJ::error::Error::InvalidConfiguration, message);
+        return false;
+    }
+
+    PaDeviceIndex device = input ? apiInfo->defaultInputDevice : apiInfo->defaultOutputDevice;
+
+    if(!selection.mName.empty()){
+        device = paNoDevice;
+
+        for(int d = 0; d < apiInfo->deviceCount; ++d){
+            const PaDeviceIndex index = Pa_HostApiDeviceIndexToDeviceIndex(api, d);
+            const PaDeviceInfo *info = Pa_GetDeviceInfo(index);
+            if(!info || !info->name || (input ? info->maxInputChannels : info->maxOutputChannels) <= 0){
+                continue;
+            }
+
+            if(std::string(info->name).find(selection.mName) != std::string::npos){
+                device = index;
+                break;
+            }
+        }
+    }
+
+    const PaDeviceInfo *info = device == paNoDevice ? nullptr : Pa_GetDeviceInfo(device);
+
+    if(!info){
+        const std::string message = "Can't find the audio " + std::string(direction) + " device" +
+            (selection.mName.empty() ? std::string() : " matching \"" + selection.mName + "\"") +
+            " (" + apiInfo->name + ").\n";
+        handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    const int available = input ? info->maxInputChannels : info->maxOutputChannels;
+    if(available < channels){
+        const std::string message = "Error: the " + std::string(direction) + " device \"" + info->name + "\" has " +
+            std::to_string(available) + " channels, " + std::to_string(channels) + " requested.\n";
+        handler.onError(AJ::error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    parameters.device = device;
+    parameters.channelCount = channels;
+    parameters.sampleFormat = paFloat32;
+    parameters.suggestedLatency = selection.mSuggestedLatency > 0.0 ? selection.mSuggestedLatency
+        : (input ? info->defaultLowInputLatency : info->defaultLowOutputLatency);
+    parameters.hostApiSpecificStreamInfo = nullptr;
+    return true;
+}
+
+size_t AJ::io::device::detectDelay(const float *captured, size_t frames, const float *probe, size_t probe_frames, float &confidence){
+    confidence = 0.0f;
+
+    if(!captured || !probe || probe_frames == 0 || frames < probe_frames){
+        return 0;
+    }
+
+    const size_t lags = frames - probe_frames + 1;
+
+    size_t best = 0;
+    double peak = 0.0;
+    double energy = 0.0;
+
+    for(size_t lag = 0; lag < lags; ++lag){
+        double correlation = 0.0;
+        for(size_t i = 0; i < probe_frames; ++i){
+            correlation += static_cast<double>(captured[lag + i]) * probe[i];
+        }
+
+        // a loopback may invert the polarity.
+        correlation = std::abs(correlation);
+        energy += correlation * correlation;
+
+        if(correlation > peak){
+            peak = correlation;
+            best = lag;
+        }
+    }
+
+    const double rms = std::sqrt(energy / static_cast<double>(lags));
+    confidence = rms > 0.0 ? static_cast<float>(peak / rms) : 0.0f;
+    return best;
+}
+
+std::vector<float> AJ::io::device::calibrationProbe(size_t frames){
+    std::vector<float> probe(frames);
+
+    //? fixed seed: the same burst on every run.
+    uint32_t state = 0x2545F491u;
+    for(float &sample : probe){
+        state = state * 1664525u + 1013904223u;
+        sample = 0.5f * (static_cast<float>(state >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f);
+    }
+
+    return probe;
+}
+
+bool AJ::io::device::measureRoundTrip(const DeviceConfig &config, RoundTripLatency &latency, AJ::error::IErrorHandler &handler){
+    if(!config.validate(handler)){
+        return false;
+    }
+
+    if(Pa_Initialize() != paNoError){
+        const std::string message = "Can't initialize PortAudio for the calibration.\n";
+        handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    PaStreamParameters inputParameters;
+    PaStreamParameters outputParameters;
+
+    if(!streamParameters(config.mInput, true, 1, inputParameters, handler) ||
+       !streamParameters(config.mOutput, false, config.mChannels, outputParameters, handler)){
+        Pa_Terminate();
+        return false;
+    }
+
+    Calibration calibration;
+    calibration.probe = calibrationProbe();
+    calibration.probeStart = static_cast<size_t>(kCalibrationLeadSeconds * config.mSamplerate);
+    calibration.outputChannels = config.mChannels;
+    calibration.captured.assign(calibration.probeStart + calibration.probe.size() +
+        static_cast<size_t>(kCalibrationWindowSeconds * config.mSamplerate), 0.0f);
+
+    PaStream *stream = nullptr;
+    PaError err = Pa_OpenStream(
+        &stream,
+        &inputParameters,
+        &outputParameters,
+        config.mSamplerate,
+        config.framesPerBuffer(),
+        paClipOff,
+        calibrationCallback,
+        &calibration
+    );
+
+    if(err != paNoError){
+        const std::string message = "Can't open the calibration stream: " + std::string(Pa_GetErrorText(err)) + "\n";
+        handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+        Pa_Terminate();
+        return false;
+    }
+
+    const PaStreamInfo *info = Pa_GetStreamInfo(stream);
+    latency.reported = info ? info->inputLatency + info->outputLatency : 0.0;
+
+    err = Pa_StartStream(stream);
+
+    const auto deadline = std::chrono::steady_clock::now() + kCalibrationTimeout;
+    while(err == paNoError && !calibration.done.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < deadline){
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    Pa_CloseStream(stream);
+    Pa_Terminate();
+
+    if(err != paNoError || !calibration.done.load(std::memory_order_acquire)){
+        const std::string message = "Error: the calibration stream didn't run.\n";
+        handler.onError(AJ::error::Error::CalibrationFailed, message);
+        return false;
+    }
+
+    //* the burst can't come back before it was played.
+    const float *window = calibration.captured.data() + calibration.probeStart;
+    const size_t frames = calibration.captured.size() - calibration.probeStart;
+
+    float confidence = 0.0f;
+    latency.frames = detectDelay(window, frames, calibration.probe.data(), calibration.probe.size(), confidence);
+    latency.seconds = static_cast<double>(latency.frames) / config.mSamplerate;
+    latency.confidence = confidence;
+
+    if(confidence < kCalibrationMinConfidence){
+        const std::string message = "Error: the calibration burst wasn't heard, connect an output to the first input.\n";
+        handler.onError(AJ::error::Error::CalibrationFailed, message);
+        return false;
+    }
+
+    return true;
+}
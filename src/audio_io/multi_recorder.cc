@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#include "audio_io/multi_recorder.h"
+#include "file_io/file_utils.h"
+#include "core/realtime.h"
+
+int AJ::io::record::MultiRecorder::streamCallback(const void *inputBuffer, void *,
+    unsigned long framesPerBuffer, const PaStreamCallbackTimeInfo* timeInfo,
+    PaStreamCallbackFlags statusFlags, void *userData){
+
+    DeviceStream* stream = static_cast<DeviceStream*>(userData);
+    const float *input = static_cast<const float*>(inputBuffer);
+
+    //! no waiting, allocation or error reporting here: the callback runs on the audio thread.
+    const AJ::utils::RealtimeScope realtime;
+    const AJ::utils::DenormalScope denormals;
+    AJ::utils::MetricsRegistry *metrics = stream->pMetrics.get();
+    const uint64_t start = AJ::utils::MetricsRegistry::now();
+
+    const size_t stride = static_cast<size_t>(stream->mSpec.mChannels);
+    uint64_t depth = 0;
+
+    for(Track *track : stream->mTracks){
+        AudioData *data = track->pData.get();
+        AJ::utils::Buffer* buffer = data->acquire();
+
+        if(buffer){
+            const size_t channels = buffer->channels;
+            const size_t frames = std::min<size_t>(framesPerBuffer, buffer->size / channels);
+
+            // input can be NULL on an input underflow: record silence to keep the timeline.
+            if(input){
+                const float *in = input + track->mSpec.mFirstChannel;
+                for(size_t f = 0; f < frames; ++f){
+                    for(size_t c = 0; c < channels; ++c){
+                        buffer->data[f * channels + c] = in[f * stride + c];
+                    }
+                }
+            } else {
+                std::memset(buffer->data, 0, sizeof(float) * frames * channels);
+            }
+
+            buffer->frames = frames;
+        }
+
+        data->commit(buffer);
+        depth = std::max<uint64_t>(depth, data->pQueue->currentSize());
+    }
+
+    //* the deepest queue of the device: the track whose writer is furthest behind.
+    const uint64_t duration = AJ::utils::MetricsRegistry::now() - start;
+    const bool missed = stream->mProfiler.onCallback(duration, framesPerBuffer, statusFlags, timeInfo, depth);
+
+    if(metrics){
+        const uint64_t deadline = stream->mProfiler.deadline(framesPerBuffer);
+
+        metrics->record(AJ::utils::Latency::RecordCallback, duration);
+        metrics->raise(AJ::utils::Peak::QueueDepth, depth);
+        if(deadline) metrics->raise(AJ::utils::Peak::CallbackLoad, duration * 1000 / deadline);
+        if(missed) metrics->add(AJ::utils::Counter::DeadlineMisses);
+        if(statusFlags & paInputOverflow) metrics->add(AJ::utils::Counter::InputOverflows);
+        if(statusFlags & paInputUnderflow) metrics->add(AJ::utils::Counter::InputUnderflows);
+    }
+
+    if(stream->pStopFlag->flag.load(std::memory_order_acquire)){
+        return paComplete;
+    }
+
+    return paContinue;
+}
+
+AJ::io::record::MultiRecorder::MultiRecorder(const InitMultiRecordInfo& info, AJ::error::IErrorHandler& handler) :
+    mInfo(info), mHandler(handler) {
+
+    AJ::io::device::DeviceConfig sizing;
+    sizing.mSamplerate = mInfo.mSamplerate;
+    sizing.mFramesPerBuffer = mInfo.mFramesPerBuffer;
+    sizing.mBufferedSeconds = mInfo.mBufferedSeconds;
+
+    if(!sizing.validate(handler)){
+        return;
+    }
+
+    if(!AJ::utils::FileUtils::valid_directory(mInfo.mSessionDirectory)){
+        const std::string message = "Error: invalid session directory: " + mInfo.mSessionDirectory + "\n";
+        handler.onError(AJ::error::Error::DirectoryNotFound, message);
+        return;
+    }
+
+    if(mInfo.mStreams.empty()){
+        const std::string message = "Error: a multi recording needs at least one device stream.\n";
+        handler.onError(AJ::error::Error::InvalidConfiguration, message);
+        return;
+    }
+
+    mFramesPerBuffer = sizing.framesPerBuffer();
+    mTrackBuffers = AJ::io::device::poolSizing(sizing).buffers;
+
+    size_t mono = 0, stereo = 0;
+
+    for(DeviceStreamSpec &spec : mInfo.mStreams){
+        if(spec.mChannels < 1 || spec.mChannels > kRecordMaxDeviceChannels){
+            const std::string message = "Error: a device stream opens 1 to " + std::to_string(kRecordMaxDeviceChannels) + " channels.\n";
+            handler.onError(AJ::error::Error::InvalidChannelCount, message);
+            return;
+        }
+
+        //* no tracks given: every channel is a mono track.
+        if(spec.mTracks.empty()){
+            for(int c = 0; c < spec.mChannels; ++c){
+                spec.mTracks.push_back(TrackSpec{ c, 1, "" });
+            }
+        }
+
+        auto stream = std::make_unique<DeviceStream>();
+        stream->mSpec = spec;
+        stream->pStopFlag = std::make_shared<LFControlFlag>();
+        stream->pMetrics = mInfo.pMetrics;
+        stream->mProfiler.setSamplerate(mInfo.mSamplerate);
+
+        for(TrackSpec &track_spec : stream->mSpec.mTracks){
+            if(track_spec.mChannels < 1 || track_spec.mChannels > 2 || track_spec.mFirstChannel < 0 ||
+               track_spec.mFirstChannel + track_spec.mChannels > spec.mChannels){
+                const std::string message = "Error: a track takes 1 or 2 channels of its device stream.\n";
+                handler.onError(AJ::error::Error::InvalidChannelCount, message);
+                return;
+            }
+
+            if(track_spec.mName.empty()){
+                track_spec.mName = "track_" + std::to_string(mTracks.size());
+            }
+
+            auto track = std::make_unique<Track>();
+            track->mSpec = track_spec;
+            track->pQueue = std::make_shared<AJ::utils::Queue>(true, mTrackBuffers, mFramesPerBuffer, track_spec.mChannels, handler);
+            if(!track->pQueue->isValid()){
+                return;
+            }
+
+            track->pData = std::make_shared<AudioData>(nullptr, track->pQueue, stream->pStopFlag, handler);
+            track->pData->mPolicy = mInfo.mOverflowPolicy;
+            track->pData->mReserveSize = std::min(mInfo.mReserveBuffers, kRecordReserveMax);
+            track->pData->pMetrics = mInfo.pMetrics;
+            track->pData->mChannels = track_spec.mChannels;
+
+            (track_spec.mChannels == 1 ? mono : stereo)++;
+
+            stream->mTracks.push_back(track.get());
+            mTracks.push_back(std::move(track));
+        }
+
+        mStreams.push_back(std::move(stream));
+    }
+
+    //* one slab per channel layout, every track leases its share of it.
+    if(mono){
+        pMonoPool = std::make_shared<AJ::utils::SharedBufferPool>(handler, mono * mTrackBuffers, mFramesPerBuffer, 1);
+        if(!pMonoPool->isValid()){
+            return;
+        }
+    }
+
+    if(stereo){
+        pStereoPool = std::make_shared<AJ::utils::SharedBufferPool>(handler, stereo * mTrackBuffers, mFramesPerBuffer, 2);
+        if(!pStereoPool->isValid()){
+            return;
+        }
+    }
+
+    for(auto &track : mTracks){
+        track->pShared = track->mSpec.mChannels == 1 ? pMonoPool : pStereoPool;
+    }
+
+    pWriters = mInfo.pWriters ? mInfo.pWriters : std::make_shared<AJ::io::file_streamer::WriterPool>(mInfo.mWriterThreads);
+
+    mValid = true;
+}
+
+AJ::io::record::MultiRecorder::~MultiRecorder(){
+    if(mRecording){
+        closeAll();
+    }
+}
+
+bool AJ::io::record::MultiRecorder::prepareTracks(){
+    std::string ext = "wav";
+
+    for(auto &track : mTracks){
+        track->pPool = track->pShared->lease(mTrackBuffers, mHandler);
+        if(!track->pPool){
+            return false;
+        }
+
+        AudioData &data = *track->pData;
+        data.pBufferPool = track->pPool;
+        data.pCounters->reset();
+        data.fillReserve();
+
+        auto streamer = std::make_shared<AJ::io::file_streamer::FileStreamer>(
+            track->pQueue, track->pPool, data.pStopFlag,
+            AJ::FileStreamingTypes::recording, mInfo.mSessionDirectory
+        );
+        streamer->setCounters(data.pCounters);
+        streamer->setMetrics(mInfo.pMetrics);
+        streamer->setWriteOptions(mInfo.mWriteOptions);
+        streamer->setFileName(track->mSpec.mName + "_" + AJ::utils::FileUtils::generate_file_name(AJ::FileStreamingTypes::recording, ext));
+
+        AJ::AudioWriteInfo write_info;
+        write_info.channels = track->mSpec.mChannels;
+        write_info.samplerate = mInfo.mSamplerate;
+
+        if(!streamer->setWriteInfo(write_info, mHandler) || !pWriters->add(streamer, mHandler)){
+            return false;
+        }
+
+        track->pStreamer = std::move(streamer);
+        track->mPath = track->pStreamer->writePath();
+    }
+
+    return true;
+}
+
+bool AJ::io::record::MultiRecorder::start(){
+    if(!mValid || mRecording){
+        return false;
+    }
+
+    //* initialized once, kept until the MultiRecorder goes.
+    if(!pPortAudio && !(pPortAudio = AJ::io::device::PortAudioSession::acquire(mHandler))){
+        return false;
+    }
+
+    //? from here closeAll() undoes whatever was done.
+    mRecording = true;
+
+    if(!prepareTracks()){
+        closeAll();
+        return false;
+    }
+
+    for(auto &stream : mStreams){
+        stream->pStopFlag->flag.store(false, std::memory_order_release);
+        stream->mProfiler.reset();
+
+        PaStreamParameters parameters;
+        if(!AJ::io::device::streamParameters(stream->mSpec.mDevice, true, stream->mSpec.mChannels, parameters, mHandler)){
+            closeAll();
+            return false;
+        }
+
+        const PaError err = Pa_OpenStream(&stream->stream, &parameters, nullptr, mInfo.mSamplerate,
+            mFramesPerBuffer, paClipOff, streamCallback, stream.get());
+
+        if(err != paNoError){
+            stream->stream = nullptr;
+            const std::string message = "Can't open the stream of " +
+                (stream->mSpec.mDevice.mName.empty() ? std::string("the default device") : stream->mSpec.mDevice.mName) + ".\n";
+            mHandler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+            closeAll();
+            return false;
+        }
+    }
+
+    //* every device is open before the first starts, the tracks start as close together as they can.
+    for(auto &stream : mStreams){
+        if(Pa_StartStream(stream->stream) != paNoError){
+            const std::string message = "Can't start the multi recording.\n";
+            mHandler.onError(AJ::error::Error::RecordingError, message);
+            closeAll();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AJ::io::record::MultiRecorder::stop(){
+    if(!mRecording){
+        return false;
+    }
+
+    return closeAll();
+}
+
+bool AJ::io::record::MultiRecorder::closeAll(){
+    bool ok = true;
+
+    for(auto &stream : mStreams){
+        stream->pStopFlag->flag.store(true, std::memory_order_release);
+    }
+
+    //* the callbacks see the flag within a buffer and complete.
+    for(auto &stream : mStreams){
+        if(!stream->stream){
+            continue;
+        }
+
+        while(Pa_IsStreamActive(stream->stream) == 1){
+            std::this_thread::sleep_for(kStreamerWakeTimeout);
+        }
+
+        if(Pa_CloseStream(stream->stream) != paNoError){
+            const std::string message = "Can't close a stream of the multi recording.\n";
+            mHandler.onError(AJ::error::Error::RecordingError, message);
+            ok = false;
+        }
+        stream->stream = nullptr;
+    }
+
+    //* nothing pushes anymore: the writers write the rest of every queue and close the files.
+    std::vector<std::future<bool>> done;
+    for(auto &track : mTracks){
+        if(track->pStreamer){
+            done.push_back(pWriters->remove(track->pStreamer));
+        }
+    }
+
+    for(std::future<bool> &file : done){
+        ok = file.get() && ok;
+    }
+
+    for(auto &track : mTracks){
+        track->pStreamer.reset();
+
+        if(track->pPool){
+            track->pData->releaseReserve();
+            track->pShared->release(*track->pPool, mHandler);
+            track->pData->pBufferPool.reset();
+            track->pPool.reset();
+        }
+    }
+
+    mRecording = false;
+
+    return ok;
+}
@@ -0,0 +1,522 @@
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "audio_io/play.h"
+#include "portaudio.h"
+#include "core/types.h"
+#include "core/memory.h"
+#include "core/realtime.h"
+#include "dsp/kernels.h"
+
+size_t AJ::io::play::AudioFileSource::read(float *out, size_t frames){
+    const size_t total = length();
+
+    if(mPosition >= total){
+        return 0;
+    }
+
+    const size_t count = std::min(frames, total - mPosition);
+    const bool stereo_file = pFile->mInfo.channels > 1;
+
+    //* backwards: the `count` frames before the position counted from the end, reversed once written.
+    const size_t first = mReversed ? total - mPosition - count : mPosition;
+    const float *left = nullptr;
+    const float *right = nullptr;
+
+    if(pFile->storage() == SampleStorage::Float32){
+        left = pFile->pAudio->at(0).data() + first;
+        right = stereo_file ? pFile->pAudio->at(1).data() + first : left;
+    } else {
+        //* compact samples (pAudio is empty) are widened a block at a time.
+        mLeft.resize(count);
+        pFile->readFrames(0, first, count, mLeft.data());
+        left = right = mLeft.data();
+
+        if(stereo_file){
+            mRight.resize(count);
+            pFile->readFrames(1, first, count, mRight.data());
+            right = mRight.data();
+        }
+    }
+
+    if(mChannels == 1){
+        for(size_t i = 0; i < count; ++i){
+            out[i] = stereo_file ? 0.5f * (left[i] + right[i]) : left[i];
+        }
+    } else {
+        dsp::kernels::table().interleave(left, right, out, count);
+    }
+
+    if(mReversed){
+        dsp::kernels::reverseFrames(out, count, mChannels);
+    }
+
+    mPosition += count;
+    return count;
+}
+
+bool AJ::io::play::AudioFileSource::seek(sample_pos frame){
+    mPosition = std::min(static_cast<size_t>(std::max<sample_pos>(frame, 0)), length());
+    return true;
+}
+
+bool AJ::io::play::AudioFileSource::finished() const {
+    return mPosition >= length();
+}
+
+size_t AJ::io::play::RenderGraphSource::read(float *out, size_t frames){
+    const size_t total = pGraph->frames();
+
+    if(mPosition >= total){
+        return 0;
+    }
+
+    const size_t count = std::min(frames, total - mPosition);
+    const bool stereo_graph = pGraph->channels() > 1;
+
+    mLeft.resize(count);
+    mRight.resize(stereo_graph ? count : 0);
+    float *planar[kNumChannels] = { mLeft.data(), stereo_graph ? mRight.data() : nullptr };
+
+    if(!pGraph->read(mPosition, count, planar, mErrHandler)){
+        mPosition = total;
+        return 0;
+    }
+
+    const float *left = mLeft.data();
+    const float *right = stereo_graph ? mRight.data() : left;
+
+    if(mChannels == 1){
+        for(size_t i = 0; i < count; ++i){
+            out[i] = stereo_graph ? 0.5f * (left[i] + right[i]) : left[i];
+        }
+    } else {
+        dsp::kernels::table().interleave(left, right, out, count);
+    }
+
+    mPosition += count;
+    return count;
+}
+
+bool AJ::io::play::RenderGraphSource::seek(sample_pos frame){
+    mPosition = std::min(static_cast<size_t>(std::max<sample_pos>(frame, 0)), pGraph->frames());
+    return true;
+}
+
+bool AJ::io::play::RenderGraphSource::finished() const {
+    return mPosition >= pGraph->frames();
+}
+
+size_t AJ::io::play::PreviewSource::read(float *out, size_t frames){
+    const size_t total = pPreview->frames();
+
+    if(mPosition >= total){
+        return 0;
+    }
+
+    const size_t count = std::min(frames, total - mPosition);
+    const bool stereo_preview = pPreview->channels() > 1;
+
+    mLeft.resize(count);
+    mRight.resize(stereo_preview ? count : 0);
+    float *planar[kNumChannels] = { mLeft.data(), stereo_preview ? mRight.data() : nullptr };
+
+    pPreview->setPlayhead(mPosition);
+
+    AJ::editing::preview::Quality quality;
+    if(!pPreview->read(mPosition, count, planar, quality, mErrHandler)){
+        mPosition = total;
+        return 0;
+    }
+    mQuality.store(quality, std::memory_order_relaxed);
+
+    const float *left = mLeft.data();
+    const float *right = stereo_preview ? mRight.data() : left;
+
+    if(mChannels == 1){
+        for(size_t i = 0; i < count; ++i){
+            out[i] = stereo_preview ? 0.5f * (left[i] + right[i]) : left[i];
+        }
+    } else {
+        dsp::kernels::table().interleave(left, right, out, count);
+    }
+
+    mPosition += count;
+    return count;
+}
+
+bool AJ::io::play::PreviewSource::seek(sample_pos frame){
+    mPosition = std::min(static_cast<size_t>(std::max<sample_pos>(frame, 0)), pPreview->frames());
+    pPreview->setPlayhead(mPosition);
+    return true;
+}
+
+bool AJ::io::play::PreviewSource::finished() const {
+    return mPosition >= pPreview->frames();
+}
+
+AJ::io::play::StreamSource::~StreamSource(){
+    if(pCurrent){
+        pBufferPool->push(pCurrent, mErrHandler);
+    }
+}
+
+size_t AJ::io::play::StreamSource::read(float *out, size_t frames){
+    size_t done = 0;
+
+    while(done < frames){
+        if(!pCurrent){
+            pCurrent = pQueue->pop();
+            mOffset = 0;
+
+            if(!pCurrent){
+                break;
+            }
+        }
+
+        const size_t channels = pCurrent->channels;
+        const size_t count = std::min(frames - done, pCurrent->frames - mOffset);
+
+        std::memcpy(out + done * channels, pCurrent->data + mOffset * channels, sizeof(float) * count * channels);
+        done += count;
+        mOffset += count;
+
+        //* fully consumed, give it back to the producer.
+        if(mOffset >= pCurrent->frames){
+            pBufferPool->push(pCurrent, mErrHandler);
+            pCurrent = nullptr;
+        }
+    }
+
+    return done;
+}
+
+bool AJ::io::play::StreamSource::finished() const {
+    // the producer sets the flag after its last push, check it before the queue.
+    if(!pDoneFlag || !pDoneFlag->flag.load(std::memory_order_acquire)){
+        return false;
+    }
+
+    return !pCurrent && pQueue->currentSize() == 0;
+}
+
+bool AJ::io::play::PlayData::render(float *out, size_t frames) noexcept {
+    const size_t channels = mRing.channels();
+    mCallbacks.fetch_add(1, std::memory_order_relaxed);
+
+    //* seek: drop everything read before the new position.
+    const uint64_t flush = mFlushRequest.load(std::memory_order_acquire);
+
+    if(flush != mFlushed.load(std::memory_order_relaxed)){
+        const AJ::utils::RingRegion queued = mRing.acquireRead(mRing.frameCapacity());
+        mRing.commitRead(queued.frames());
+
+        mPosition.store(mFlushTarget.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        mSeeks.fetch_add(1, std::memory_order_relaxed);
+        mFlushed.store(flush, std::memory_order_release);
+
+        std::memset(out, 0, sizeof(float) * frames * channels);
+        return true;
+    }
+
+    if(mTransport.load(std::memory_order_acquire) == Transport::Paused ||
+        mBuffering.load(std::memory_order_acquire)){
+        std::memset(out, 0, sizeof(float) * frames * channels);
+        return true;
+    }
+
+    // loaded before reading the ring: frames published before the flag are seen below.
+    const bool source_done = mSourceDone.load(std::memory_order_acquire);
+
+    const AJ::utils::RingRegion region = mRing.acquireRead(frames);
+
+    std::memcpy(out, region.first.data, sizeof(float) * region.first.frames * channels);
+    if(region.second.frames){
+        std::memcpy(out + region.first.frames * channels, region.second.data,
+            sizeof(float) * region.second.frames * channels);
+    }
+
+    const size_t copied = region.frames();
+    mRing.commitRead(copied);
+
+    if(copied < frames){
+        std::memset(out + copied * channels, 0, sizeof(float) * (frames - copied) * channels);
+
+        if(!source_done){
+            mUnderruns.fetch_add(1, std::memory_order_relaxed);
+            mUnderrunFrames.fetch_add(frames - copied, std::memory_order_relaxed);
+            if(pMetrics) pMetrics->add(AJ::utils::Counter::Underruns);
+        } else if(copied == 0){
+            return false;
+        }
+    }
+
+    mPosition.fetch_add(static_cast<sample_pos>(copied), std::memory_order_relaxed);
+    mFramesPlayed.fetch_add(copied, std::memory_order_relaxed);
+    if(pMetrics) pMetrics->add(AJ::utils::Counter::FramesPlayed, copied);
+    return true;
+}
+
+AJ::io::play::Player::Player(InitPlayInfo& info, AJ::error::IErrorHandler& handler){
+    mSamplerate = info.mSamplerate;
+    mChannels = info.mChannels;
+    mFramesPerBuffer = info.mFramesPerBuffer;
+    mReadBlockFrames = std::max<size_t>(info.mReadBlockFrames, 1);
+    mDevice = info.mDevice;
+
+    pStopFlag = info.pStopFlag;
+    pThreadPool = info.pThreadPool;
+
+    pPlayData = std::make_shared<PlayData>(info.mPrefetchFrames, info.mChannels, handler);
+    pPlayData->pStopFlag = info.pStopFlag;
+    pPlayData->pMetrics = info.pMetrics;
+}
+
+bool AJ::io::play::Player::setSource(std::shared_ptr<IPlaySource> source, AJ::error::IErrorHandler& errHandler){
+    if(mPlaying.load(std::memory_order_acquire)){
+        const std::string message = "Can't change the playback source while playing.\n";
+        errHandler.onError(AJ::error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    if(!source){
+        const std::string message = "Invalid playback source, source cannot be NULL.\n";
+        errHandler.onError(AJ::error::Error::NullBufferPtr, message);
+        return false;
+    }
+
+    pSource = std::move(source);
+    pPlayData->mPosition.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+int AJ::io::play::Player::playCallback(const void *inputBuffer, void *outputBuffer,
+    unsigned long framesPerBuffer, const PaStreamCallbackTimeInfo* timeInfo,
+    PaStreamCallbackFlags statusFlags, void *userData){
+
+    PlayData* data = (PlayData*) userData;
+
+    //! copy only: no waiting, allocation, disk or error reporting on the audio thread.
+    const AJ::utils::RealtimeScope realtime;
+    const AJ::utils::DenormalScope denormals;
+    AJ::utils::MetricsRegistry *metrics = data->pMetrics.get();
+    const uint64_t start = metrics ? AJ::utils::MetricsRegistry::now() : 0;
+
+    const bool playing = data->render((float*) outputBuffer, framesPerBuffer);
+
+    if(metrics){
+        metrics->record(AJ::utils::Latency::PlayCallback, AJ::utils::MetricsRegistry::now() - start);
+    }
+
+    if(!playing){
+        // end of the source, let the event handler return.
+        data->pStopFlag->flag.store(true, std::memory_order_release);
+        return paComplete;
+    }
+
+    if(data->pStopFlag->flag.load(std::memory_order_acquire)){
+        return paComplete;
+    }
+
+    return paContinue;
+}
+
+void AJ::io::play::Player::serveSeek(uint64_t request){
+    PlayData& data = *pPlayData;
+    const sample_pos target = data.mSeekTarget.load(std::memory_order_relaxed);
+
+    // a source that can't seek keeps playing from where it is.
+    if(!pSource->seek(target)){
+        mSeekServed = request;
+        return;
+    }
+
+    //* nothing is produced until the callback dropped the old frames.
+    data.mBuffering.store(true, std::memory_order_release);
+    data.mFlushTarget.store(target, std::memory_order_relaxed);
+    data.mFlushRequest.store(request, std::memory_order_release);
+
+    while(data.mFlushed.load(std::memory_order_acquire) != request){
+        if(pStopFlag->flag.load(std::memory_order_acquire)){
+            return;
+        }
+        std::this_thread::sleep_for(kPlayReaderIdle);
+    }
+
+    data.mSourceDone.store(pSource->finished(), std::memory_order_release);
+    mSeekServed = request;
+}
+
+void AJ::io::play::Player::readAhead(){
+    PlayData& data = *pPlayData;
+
+    // the source may run effects with feedback tails (session tracks).
+    const AJ::utils::DenormalScope denormals;
+
+    while(!pStopFlag->flag.load(std::memory_order_acquire)){
+        const uint64_t request = data.mSeekRequest.load(std::memory_order_acquire);
+
+        if(request != mSeekServed){
+            serveSeek(request);
+            continue;
+        }
+
+        if(data.mSourceDone.load(std::memory_order_relaxed)){
+            std::this_thread::sleep_for(kPlayReaderIdle);
+            continue;
+        }
+
+        const AJ::utils::RingRegion region = data.mRing.acquireWrite(mReadBlockFrames);
+
+        // ring full: prefetch depth reached.
+        if(region.frames() == 0){
+            data.mBuffering.store(false, std::memory_order_release);
+            std::this_thread::sleep_for(kPlayReaderIdle);
+            continue;
+        }
+
+        size_t written = pSource->read(region.first.data, region.first.frames);
+        if(written == region.first.frames && region.second.frames){
+            written += pSource->read(region.second.data, region.second.frames);
+        }
+
+        data.mRing.commitWrite(written);
+
+        if(pSource->finished()){
+            data.mSourceDone.store(true, std::memory_order_release);
+            data.mBuffering.store(false, std::memory_order_release);
+        } else if(written < region.frames()){
+            // streamed source waiting for its producer.
+            std::this_thread::sleep_for(kPlayReaderIdle);
+        }
+    }
+}
+
+bool AJ::io::play::Player::initPlayer(AJ::error::IErrorHandler& errHandler){
+    PaStreamParameters outputParameters;
+    PaError err = paNoError;
+
+    //* initialized once, kept until the Player goes.
+    if(!pPortAudio && !(pPortAudio = AJ::io::device::PortAudioSession::acquire(errHandler))){
+        return false;
+    }
+
+    if(!AJ::io::device::streamParameters(mDevice, false, mChannels, outputParameters, errHandler)){
+        return false;
+    }
+
+    const int samplerate = pSource->samplerate() > 0 ? pSource->samplerate() : mSamplerate;
+
+    err = Pa_OpenStream(
+        &mStream,
+        nullptr, // inputParameters
+        &outputParameters,
+        samplerate,
+        mFramesPerBuffer,
+        paClipOff,
+        playCallback,
+        pPlayData.get()
+    );
+
+    if(err != paNoError){
+        const std::string message = "Can't open a playback stream.\n";
+        errHandler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    return true;
+}
+
+bool AJ::io::play::Player::play(AJ::error::IErrorHandler& errHandler, AJ::utils::IEventHandler& evHandler){
+    if(!isValid() || !pSource){
+        const std::string message = "Can't play, the player has no valid ring buffer or no source.\n";
+        errHandler.onError(AJ::error::Error::PlaybackError, message);
+        return false;
+    }
+
+    if(mPlaying.exchange(true, std::memory_order_acq_rel)){
+        const std::string message = "Can't play, the player is already playing.\n";
+        errHandler.onError(AJ::error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    PlayData& data = *pPlayData;
+    pStopFlag->flag.store(false, std::memory_order_release);
+
+    //* nothing else runs yet: drop what's left of the last playback and reset the counters.
+    const AJ::utils::RingRegion leftover = data.mRing.acquireRead(data.mRing.frameCapacity());
+    data.mRing.commitRead(leftover.frames());
+
+    data.mFlushRequest.store(0, std::memory_order_relaxed);
+    data.mFlushed.store(0, std::memory_order_relaxed);
+    data.mBuffering.store(true, std::memory_order_relaxed);
+    data.mSourceDone.store(pSource->finished(), std::memory_order_relaxed);
+    data.mCallbacks.store(0, std::memory_order_relaxed);
+    data.mUnderruns.store(0, std::memory_order_relaxed);
+    data.mUnderrunFrames.store(0, std::memory_order_relaxed);
+    data.mFramesPlayed.store(0, std::memory_order_relaxed);
+    data.mSeeks.store(0, std::memory_order_relaxed);
+
+    if(!initPlayer(errHandler)){
+        mPlaying.store(false, std::memory_order_release);
+        return false;
+    }
+
+    // wait until there is atleast 2 threads available.
+    while(pThreadPool->available() < 2){
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    //* reports what the callback shouldn't do (AJ_REALTIME_GUARD builds), until the reader is done.
+    AJ::utils::RealtimeGuard guard(errHandler);
+
+    //* start the read-ahead thread, the callback outputs silence until the ring is prefetched.
+    mReaderDone = pThreadPool->enqueue([this](){
+        readAhead();
+    });
+
+    PaError err = Pa_StartStream(mStream);
+
+    if(err != paNoError){
+        const std::string message = "Can't start playback.\n";
+        errHandler.onError(AJ::error::Error::PlaybackError, message);
+
+        pStopFlag->flag.store(true, std::memory_order_release);
+        mReaderDone.wait();
+        Pa_CloseStream(mStream);
+        mPlaying.store(false, std::memory_order_release);
+        return false;
+    }
+
+    evHandler.onProcess(errHandler, pThreadPool, pStopFlag);
+
+    // stop requested by the handler or end of the source, wait until PortAudio stream finishes.
+    while ((err = Pa_IsStreamActive(mStream)) == 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    err = Pa_CloseStream(mStream);
+
+    pStopFlag->flag.store(true, std::memory_order_release);
+    mReaderDone.wait();
+    mPlaying.store(false, std::memory_order_release);
+
+    if(err != paNoError){
+        const std::string message = "Can't close playback stream.\n";
+        errHandler.onError(AJ::error::Error::PlaybackError, message);
+        return false;
+    }
+
+    return true;
+}
+
+AJ::io::play::PlayStats AJ::io::play::Player::stats() const noexcept {
+    PlayStats stats;
+    stats.callbacks = pPlayData->mCallbacks.load(std::memory_order_relaxed);
+    stats.underruns = pPlayData->mUnderruns.load(std::memory_order_relaxed);
+    stats.underrunFrames = pPlayData->mUnderrunFrames.load(std::memory_order_relaxed);
+    stats.framesPlayed = pPlayData->mFramesPlayed.load(std::memory_order_relaxed);
+    stats.seeks = pPlayData->mSeeks.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -1,6 +1,13 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
 #include "audio_io/record.h"
 #include "portaudio.h"
 #include "core/types.h"
+#include "core/memory.h"
+#include "core/realtime.h"
 
 int AJ::io::record::Recorder::recordCallback(const void *inputBuffer, void *outputBuffer,
     unsigned long framesPerBuffer, const PaStreamCallbackTimeInfo* timeInfo,
@@ -10,19 +17,48 @@ int AJ::io::record::Recorder::recordCallback(const void *inputBuffer, void *outp
     
     const float *input_callback = (const float*)inputBuffer;    
     
-    AJ::utils::Buffer* buffer = nullptr;
-    
-    while(!buffer){
-        buffer = data->pBufferPool->pop(data->errHandler);
+    //! no waiting, allocation or error reporting here: the callback runs on the audio thread.
+    const AJ::utils::RealtimeScope realtime;
+    const AJ::utils::DenormalScope denormals;
+    AJ::utils::MetricsRegistry *metrics = data->pMetrics.get();
+    const uint64_t start = AJ::utils::MetricsRegistry::now();
+
+    AJ::utils::Buffer* buffer = data->acquire();
+
+    if(buffer){
+        const size_t frames = std::min<size_t>(framesPerBuffer, buffer->size / buffer->channels);
+        const size_t bytes = sizeof(float) * frames * buffer->channels;
+
+        // input can be NULL on an input underflow: record silence to keep the timeline.
+        if(input_callback){
+            std::memcpy(buffer->data, input_callback, bytes);
+        } else {
+            std::memset(buffer->data, 0, bytes);
+        }
+
+        buffer->frames = frames;
+    }
+
+    data->commit(buffer);
+
+    //* duplex stream: the same block, through the monitor chain, to the output.
+    if(outputBuffer){
+        data->monitor(static_cast<float*>(outputBuffer), input_callback, framesPerBuffer);
     }
 
-    std::memcpy(buffer->data, input_callback, sizeof(float) * framesPerBuffer * buffer->channels);
+    const uint64_t duration = AJ::utils::MetricsRegistry::now() - start;
+    const uint64_t depth = data->pQueue->currentSize();
+    const bool missed = data->mProfiler.onCallback(duration, framesPerBuffer, statusFlags, timeInfo, depth);
 
-    buffer->frames = framesPerBuffer;
+    if(metrics){
+        const uint64_t deadline = data->mProfiler.deadline(framesPerBuffer);
 
-    while(!data->pQueue->push(buffer)){
-        const std::string message = "Error: pushing buffer failed in recordCallback, queue is full";
-        data->errHandler.onError(AJ::error::Error::RecordingError, message);
+        metrics->record(AJ::utils::Latency::RecordCallback, duration);
+        metrics->raise(AJ::utils::Peak::QueueDepth, depth);
+        if(deadline) metrics->raise(AJ::utils::Peak::CallbackLoad, duration * 1000 / deadline);
+        if(missed) metrics->add(AJ::utils::Counter::DeadlineMisses);
+        if(statusFlags & paInputOverflow) metrics->add(AJ::utils::Counter::InputOverflows);
+        if(statusFlags & paInputUnderflow) metrics->add(AJ::utils::Counter::InputUnderflows);
     }
 
     if(data->pStopFlag->flag.load(std::memory_order_acquire)){
@@ -32,38 +68,256 @@ int AJ::io::record::Recorder::recordCallback(const void *inputBuffer, void *outp
     return paContinue;
 }
 
+AJ::utils::Buffer* AJ::io::record::AudioData::acquire() noexcept {
+    if(pSpare){
+        AJ::utils::Buffer* buffer = pSpare;
+        pSpare = nullptr;
+        return buffer;
+    }
+
+    AJ::utils::Buffer* buffer = pBufferPool->tryPop();
+
+    if(buffer){
+        //* the pool has buffers again, top the reserve up (one per callback).
+        if(mReserveCount < mReserveSize){
+            AJ::utils::Buffer* extra = pBufferPool->tryPop();
+            if(extra){
+                mReserve[mReserveCount++] = extra;
+            }
+        }
+        return buffer;
+    }
+
+    pCounters->poolExhausted.fetch_add(1, std::memory_order_relaxed);
+    if(pMetrics) pMetrics->add(AJ::utils::Counter::PoolExhausted);
+
+    if(mPolicy == OverflowPolicy::DropNewest || mReserveCount == 0){
+        return nullptr;
+    }
+
+    pCounters->reserveUsed.fetch_add(1, std::memory_order_relaxed);
+
+    //* the writer can't be overtaken from here (SPSC queue), ask it to skip the oldest block instead.
+    if(mPolicy == OverflowPolicy::DropOldest){
+        pCounters->discardRequests.fetch_add(1, std::memory_order_release);
+    }
+
+    return mReserve[--mReserveCount];
+}
+
+void AJ::io::record::AudioData::commit(AJ::utils::Buffer* buffer) noexcept {
+    if(buffer && pQueue->push(buffer)){
+        pCounters->blocks.fetch_add(1, std::memory_order_relaxed);
+        if(pMetrics) pMetrics->add(AJ::utils::Counter::RecordedBlocks);
+        return;
+    }
+
+    // queue full: keep the buffer for the next block.
+    if(buffer){
+        pSpare = buffer;
+    }
+
+    pCounters->dropped.fetch_add(1, std::memory_order_relaxed);
+    if(pMetrics) pMetrics->add(AJ::utils::Counter::DroppedBlocks);
+}
+
+void AJ::io::record::AudioData::fillReserve() noexcept {
+    while(mReserveCount < mReserveSize){
+        AJ::utils::Buffer* buffer = pBufferPool->tryPop();
+        if(!buffer){
+            break;
+        }
+        mReserve[mReserveCount++] = buffer;
+    }
+}
+
+void AJ::io::record::AudioData::releaseReserve(){
+    while(mReserveCount > 0){
+        pBufferPool->push(mReserve[--mReserveCount], errHandler);
+    }
+
+    if(pSpare){
+        pBufferPool->push(pSpare, errHandler);
+        pSpare = nullptr;
+    }
+}
+
+void AJ::io::record::AudioData::monitor(float *output, const float *input, size_t frames) noexcept {
+    const size_t samples = frames * mChannels;
+
+    if(!input){
+        std::memset(output, 0, sizeof(float) * samples);
+        return;
+    }
+
+    std::memcpy(output, input, sizeof(float) * samples);
+
+    if(!pMonitorChain || !pMonitorState || mMonitorBypassed || pMonitorChain->size() == 0){
+        return;
+    }
+
+    const uint64_t start = AJ::utils::MetricsRegistry::now();
+    const bool processed = pMonitorChain->processBlock(output, frames, mChannels, *pMonitorState, mMonitorErrors);
+
+    if(pMetrics) pMetrics->record(AJ::utils::Latency::MonitorChain, AJ::utils::MetricsRegistry::now() - start);
+
+    if(!processed){
+        // the block may be half processed, play it dry and leave the chain out from now on.
+        std::memcpy(output, input, sizeof(float) * samples);
+        mMonitorBypassed = true;
+        if(pMetrics) pMetrics->add(AJ::utils::Counter::MonitorFailures);
+    }
+}
+
+bool AJ::io::record::Recorder::setMonitor(std::shared_ptr<AJ::dsp::EffectChain> chain,
+    const AJ::io::device::DeviceSelection &output, AJ::error::IErrorHandler &handler){
+
+    if(!chain){
+        mAudioInfo.mMonitor = false;
+        pAudioData->pMonitorChain.reset();
+        pAudioData->pMonitorState.reset();
+        return true;
+    }
+
+    if(!chain->supportsBlockProcessing()){
+        const std::string message = "the monitor chain runs in the record callback, every effect must support block processing.\n";
+        handler.onError(AJ::error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    std::unique_ptr<AJ::dsp::EffectState> state = chain->createState(mAudioInfo.channels, handler);
+    if(!state){
+        return false;
+    }
+
+    //* run the chain once here: lazy setup of any stage happens off the audio thread.
+    std::vector<float> silence(mAudioInfo.frames_per_buffer * mAudioInfo.channels, 0.0f);
+    if(chain->size() > 0 && !chain->processBlock(silence.data(), mAudioInfo.frames_per_buffer, mAudioInfo.channels, *state, handler)){
+        return false;
+    }
+    state->reset();
+
+    pAudioData->pMonitorChain = std::move(chain);
+    pAudioData->pMonitorState = std::move(state);
+    mAudioInfo.mMonitor = true;
+    mAudioInfo.mMonitorDevice = output;
+
+    return true;
+}
+
+AJ::io::record::Recorder::~Recorder(){
+    if(mArmed){
+        disarm();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mWriterMux);
+        mWriterState = WriterState::Exit;
+    }
+    mWriterWake.notify_all();
+    mWriter.join();
+}
+
 void AJ::io::record::Recorder::diskWriter(){
-    pStreamer->write(pAudioData->errHandler);
+    AJ::error::IErrorHandler &handler = pAudioData->errHandler;
+
+    //? a failed placement is reported, the writer runs where it is.
+    if(!mWriterPlacement.isDefault()){
+        AJ::utils::placeCurrentThread(mWriterPlacement, handler);
+    }
+
+    std::unique_lock<std::mutex> lock(mWriterMux);
+
+    while(mWriterState != WriterState::Exit){
+        if(mWriterState == WriterState::Idle){
+            mWriterParked = true;
+            mWriterWake.notify_all();
+            mWriterWake.wait(lock, [this](){ return mWriterState != WriterState::Idle; });
+            mWriterParked = false;
+            continue;
+        }
+
+        const size_t keep = mPrerollBuffers;
+
+        if(mWriterState == WriterState::Holding){
+            lock.unlock();
+            pAudioData->pQueue->wait(1, kStreamerWakeTimeout);
+            pStreamer->holdPending(keep, handler);
+            lock.lock();
+            continue;
+        }
+
+        //* a take: open (pre-roll first), signal, then the same loop as FileStreamer::write().
+        lock.unlock();
+
+        const bool opened = pStreamer->beginWrite(handler);
+        mWriterReady.set_value(opened);
+
+        bool written = false;
+        if(opened){
+            while(!pStopFlag->flag.load(std::memory_order_acquire)){
+                pAudioData->pQueue->wait(1, kStreamerWakeTimeout);
+                pStreamer->writePending(handler);
+            }
+            written = pStreamer->endWrite(handler);
+        }
+        mWriterDone.set_value(written);
+
+        lock.lock();
+        if(mWriterState == WriterState::Writing){
+            mWriterState = WriterState::Idle;
+        }
+    }
+}
+
+void AJ::io::record::Recorder::setWriterState(WriterState state){
+    std::unique_lock<std::mutex> lock(mWriterMux);
+    mWriterState = state;
+    mWriterWake.notify_all();
+
+    if(state == WriterState::Idle){
+        mWriterWake.wait(lock, [this](){ return mWriterParked; });
+    }
+}
+
+std::future<bool> AJ::io::record::Recorder::startWriting(std::future<bool> &done){
+    std::lock_guard<std::mutex> lock(mWriterMux);
+
+    mWriterReady = std::promise<bool>();
+    mWriterDone = std::promise<bool>();
+    std::future<bool> ready = mWriterReady.get_future();
+    done = mWriterDone.get_future();
+
+    mWriterState = WriterState::Writing;
+    mWriterWake.notify_all();
+
+    return ready;
 }
 
 bool AJ::io::record::Recorder::initRecorder(){
     PaStreamParameters inputParameters;
+    PaStreamParameters outputParameters;
     PaError err = paNoError;
 
-    err = Pa_Initialize();
-    if(err != paNoError){
-        const std::string message = "Can't Initialize the error object for recording.";
-        pAudioData->errHandler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+    //* initialized once, kept until the Recorder goes.
+    if(!pPortAudio && !(pPortAudio = AJ::io::device::PortAudioSession::acquire(pAudioData->errHandler))){
         return false;
     }
 
-    inputParameters.device = Pa_GetDefaultInputDevice();
-
-    if(inputParameters.device == paNoDevice){
-        const std::string message = "Can't find the audio input device.";
-        pAudioData->errHandler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+    if(!AJ::io::device::streamParameters(mAudioInfo.mDevice, true, mAudioInfo.channels, inputParameters, pAudioData->errHandler)){
         return false;
     }
 
-    inputParameters.channelCount = mAudioInfo.channels;
-    inputParameters.sampleFormat = paFloat32;
-    inputParameters.suggestedLatency = Pa_GetDeviceInfo(inputParameters.device)->defaultLowInputLatency;
-    inputParameters.hostApiSpecificStreamInfo = nullptr;
+    //* monitoring: one duplex stream, the callback plays what it records.
+    if(mAudioInfo.mMonitor &&
+       !AJ::io::device::streamParameters(mAudioInfo.mMonitorDevice, false, mAudioInfo.channels, outputParameters, pAudioData->errHandler)){
+        return false;
+    }
 
     err = Pa_OpenStream(
         &mAudioInfo.stream, 
         &inputParameters,
-        nullptr, // outputParameters
+        mAudioInfo.mMonitor ? &outputParameters : nullptr,
         mAudioInfo.samplerate,
         mAudioInfo.frames_per_buffer,
         paClipOff,
@@ -72,6 +326,7 @@ bool AJ::io::record::Recorder::initRecorder(){
     );
 
     if(err != paNoError){
+        mAudioInfo.stream = nullptr;
         const std::string message = "Can't open a stream.";
         pAudioData->errHandler.onError(AJ::error::Error::ResourceAllocationFailed, message);
         return false;
@@ -80,41 +335,141 @@ bool AJ::io::record::Recorder::initRecorder(){
     return true;
 }
 
-bool AJ::io::record::Recorder::record(AJ::utils::IEventHandler& evHandler){
+bool AJ::io::record::Recorder::prepare(){
     if(!initRecorder()){
         return false;
     }
 
-    // wait until there is atleast 2 threads available.
-    while(pThreadPool->available() < 2){
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    pStopFlag->flag.store(false, std::memory_order_release);
+    pAudioData->pCounters->reset();
+    pAudioData->mProfiler.reset();
+    pAudioData->fillReserve();
+
+    pAudioData->mMonitorBypassed = false;
+    if(pAudioData->pMonitorState){
+        pAudioData->pMonitorState->reset();
     }
 
-    //* start the disk writer thread.
-    pThreadPool->enqueue([&](){
-        diskWriter();
-    });
+    //* reports what the callback shouldn't do (AJ_REALTIME_GUARD builds), until the stream is closed.
+    pGuard = std::make_unique<AJ::utils::RealtimeGuard>(pAudioData->errHandler);
 
-    // wait for safety.
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return true;
+}
 
-    //* start recording.
-    PaError err = Pa_StartStream(mAudioInfo.stream);
+void AJ::io::record::Recorder::abort(){
+    pStopFlag->flag.store(true, std::memory_order_release);
 
-    if(err != paNoError){
+    if(mAudioInfo.stream){
+        while(Pa_IsStreamActive(mAudioInfo.stream) == 1){
+            std::this_thread::sleep_for(kStreamerWakeTimeout);
+        }
+        Pa_CloseStream(mAudioInfo.stream);
+        mAudioInfo.stream = nullptr;
+    }
+
+    //? the writer is parked before the buffers it may hold are touched here.
+    setWriterState(WriterState::Idle);
+    pStreamer->discardPending(pAudioData->errHandler);
+    pAudioData->releaseReserve();
+
+    pGuard.reset();
+    mArmed = false;
+}
+
+bool AJ::io::record::Recorder::arm(){
+    if(mArmed){
+        return true;
+    }
+
+    if(!prepare()){
+        return false;
+    }
+
+    setWriterState(WriterState::Holding);
+
+    if(Pa_StartStream(mAudioInfo.stream) != paNoError){
+        const std::string message = "Can't start the armed stream.";
+        pAudioData->errHandler.onError(AJ::error::Error::RecordingError, message);
+        abort();
+        return false;
+    }
+
+    mArmed = true;
+    return true;
+}
+
+void AJ::io::record::Recorder::disarm(){
+    if(mArmed){
+        abort();
+    }
+}
+
+bool AJ::io::record::Recorder::setPreroll(double seconds, AJ::error::IErrorHandler &handler){
+    if(mArmed){
+        const std::string message = "Error: the pre-roll can't change while armed.\n";
+        handler.onError(AJ::error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    const size_t frames = std::max<size_t>(mAudioInfo.frames_per_buffer, 1);
+    const double buffers = std::ceil(seconds * mAudioInfo.samplerate / static_cast<double>(frames));
+
+    //* the callback, the reserve and the writer share the rest of the pool.
+    if(!(buffers >= 0.0) || buffers > static_cast<double>(pAudioData->pBufferPool->currentSize() / 2)){
+        const std::string message = "Error: a pre-roll of " + std::to_string(seconds) +
+            " s doesn't fit in half of the record buffer pool.\n";
+        handler.onError(AJ::error::Error::InvalidBufferSize, message);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mWriterMux);
+    mPrerollBuffers = static_cast<size_t>(buffers);
+    return true;
+}
+
+bool AJ::io::record::Recorder::record(AJ::utils::IEventHandler& evHandler){
+    const bool armed = mArmed;
+
+    if(!armed && !prepare()){
+        return false;
+    }
+
+    //* no polling: the writer says when the file is open, unarmed the stream isn't running yet.
+    std::future<bool> done;
+    std::future<bool> ready = startWriting(done);
+
+    if(!ready.get()){
+        abort();
+        return false;
+    }
+
+    if(!armed && Pa_StartStream(mAudioInfo.stream) != paNoError){
         const std::string message = "Can't start recording.";
         pAudioData->errHandler.onError(AJ::error::Error::RecordingError, message);
+
+        pStopFlag->flag.store(true, std::memory_order_release);
+        done.wait();
+        abort();
         return false;
     }
+    mArmed = false;
     
     evHandler.onProcess(pAudioData->errHandler, pThreadPool, pStopFlag);
 
     // After user stops, wait until PortAudio stream finishes
+    PaError err;
     while ((err = Pa_IsStreamActive(mAudioInfo.stream)) == 1) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::this_thread::sleep_for(kStreamerWakeTimeout);
     }
 
     err = Pa_CloseStream(mAudioInfo.stream);
+    mAudioInfo.stream = nullptr;
+
+    //* the writer drains the queue before it returns, then the callback buffers can go back.
+    const bool written = done.get();
+    setWriterState(WriterState::Idle);
+    pAudioData->releaseReserve();
+    pGuard.reset();
 
     if(err != paNoError){
         const std::string message = "Can't close stream.";
@@ -122,5 +477,5 @@ bool AJ::io::record::Recorder::record(AJ::utils::IEventHandler& evHandler){
         return false;
     }
 
-    return true;
-}
\ No newline at end of file
+    return written;
+}
@@ -1,7 +1,15 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <future>
 #include <list>
+#include <mutex>
 #include <stack>
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "core/aj_audio_engine.h"
@@ -9,25 +17,197 @@
 #include "file_io/audio_file.h"
 #include "file_io/wav_file.h"
 #include "file_io/mp3_file.h"
+#include "file_io/seek_index.h"
+#include "file_io/file_streamer.h"
+#include "file_io/wav_stream_writer.h"
 
 // dsp
 #include "dsp/effect.h"
 #include "dsp/gain.h"
 #include "dsp/echo.h"
 #include "dsp/reverb/reverb.h"
+#include "dsp/normalization.h"
+#include "dsp/effect_chain.h"
 
 #include "core/effect_params.h"
+#include "core/trace.h"
+#include "core/memory.h"
 #include "core/error_handler.h"
+#include "core/engine_resources.h"
+#include "core/scratch_arena.h"
+#include "core/buffer_pool.h"
+#include "core/thread_pool.h"
 
 #include "undo_system/state.h"
 #include "undo_system/undo.h"
 
+namespace {
+
+/**
+ * @brief Run `process` on a channel of `audio` in any storage.
+ *
+ * Compact samples are widened into a scratch channel (effects validate their range against
+ * the whole buffer) and only the frames [start, end] are narrowed back, a failing effect
+ * may still have processed part of the range.
+ */
+bool processChannel(AJ::io::AudioFile &audio, size_t channel, AJ::sample_pos start, AJ::sample_pos end,
+    const std::function<bool(AJ::Float&)> &process){
+
+    if(audio.storage() == AJ::io::SampleStorage::Float32){
+        return process(audio.pAudio->at(channel));
+    }
+
+    const AJ::sample_pos frames = static_cast<AJ::sample_pos>(audio.channelFrames());
+    //? effects take a Float, the arena keeps one that only grows.
+    AJ::Float &scratch = AJ::utils::ScratchArena::current().channel(frames);
+    audio.readFrames(channel, 0, frames, scratch.data());
+
+    const bool success = process(scratch);
+
+    start = std::max<AJ::sample_pos>(start, 0);
+    end = std::min<AJ::sample_pos>(end, frames - 1);
+    if(start <= end){
+        audio.writeFrames(channel, start, end - start + 1, scratch.data() + start);
+    }
+
+    return success;
+}
+
+/**
+ * @brief Run an effect that splits its range (dsp::Effect::splitsRange()) over the `count` frames
+ * from Start of `buffer` in pieces of `grain` frames on `pool`.
+ *
+ * The caller's handler isn't required to be thread-safe, every piece reports into its own.
+ * The pieces share the parameters and fail alike, only the errors of the first failing one are replayed.
+ */
+bool processSplit(AJ::dsp::Effect &effect, AJ::Float &buffer, size_t count, size_t grain,
+    AJ::utils::ThreadPool &pool, AJ::error::IErrorHandler &handler){
+
+    const size_t pieces = (count + grain - 1) / grain;
+    std::vector<AJ::error::CollectingErrorHandler> errors(pieces);
+    std::vector<char> succeeded(pieces, 0);
+
+    pool.parallel_for(0, count, grain, [&](size_t begin, size_t end){
+        AJ_TRACE_ZONE("dsp", "effect_piece");
+        const AJ::utils::MemoryScope memory(AJ::utils::Subsystem::Dsp);
+        const size_t piece = begin / grain;
+        succeeded[piece] = effect.processRange(buffer, begin, end, errors[piece]) ? 1 : 0;
+    });
+
+    for(size_t piece = 0; piece < pieces; ++piece){
+        if(!succeeded[piece]){
+            errors[piece].replay(handler);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Run `process` on the first `channels` channels of `audio` in any storage, as processChannel()
+ * does for one: compact samples are widened into the arena's AudioBuffer and [start, end] narrowed back.
+ */
+bool processChannels(AJ::io::AudioFile &audio, size_t channels, AJ::sample_pos start, AJ::sample_pos end,
+    const std::function<bool(AJ::AudioBuffer&)> &process){
+
+    if(audio.storage() == AJ::io::SampleStorage::Float32){
+        return process(*audio.pAudio);
+    }
+
+    const AJ::sample_pos frames = static_cast<AJ::sample_pos>(audio.channelFrames());
+    AJ::AudioBuffer &scratch = AJ::utils::ScratchArena::current().channels(frames, channels);
+    for(size_t ch = 0; ch < channels; ++ch){
+        audio.readFrames(ch, 0, frames, scratch[ch].data());
+    }
+
+    const bool success = process(scratch);
+
+    start = std::max<AJ::sample_pos>(start, 0);
+    end = std::min<AJ::sample_pos>(end, frames - 1);
+    if(start <= end){
+        for(size_t ch = 0; ch < channels; ++ch){
+            audio.writeFrames(ch, start, end - start + 1, scratch[ch].data() + start);
+        }
+    }
+
+    return success;
+}
+
+/**
+ * @brief A batch of loadAudioAsync(): one worker probes the headers in order, a file starts
+ * once a slot is free and its decoded size fits in the budget next to the running ones.
+ */
+struct LoadBatch : std::enable_shared_from_this<LoadBatch> {
+    AJ::AJ_Engine &engine;
+    std::shared_ptr<AJ::utils::ThreadPool> pool;
+    std::vector<std::string> paths;
+    std::vector<std::promise<AJ::LoadResult>> results;
+    size_t slots;
+    size_t budget;
+
+    std::mutex mux;
+    std::vector<size_t> bytes;   ///< decoded size of the probed files (0 if the probe failed).
+    size_t next = 0;             ///< first file not started.
+    size_t active = 0;
+    size_t inUse = 0;
+
+    LoadBatch(AJ::AJ_Engine &engine, std::shared_ptr<AJ::utils::ThreadPool> pool,
+        std::vector<std::string> paths, size_t slots, size_t budget) :
+        engine(engine), pool(std::move(pool)), paths(std::move(paths)), results(this->paths.size()),
+        slots(std::max<size_t>(slots, 1)), budget(budget) {}
+
+    void probe(){
+        for(const std::string &path : paths){
+            //? a file that can't be probed still loads, its load reports why it failed.
+            AJ::AudioInfo info;
+            AJ::error::CollectingErrorHandler ignored;
+            const size_t size = engine.probeAudio(path, info, ignored) ? static_cast<size_t>(info.length) * sizeof(float) : 0;
+
+            std::lock_guard<std::mutex> lock(mux);
+            bytes.push_back(size);
+            admit();
+        }
+    }
+
+    //* called with `mux` held.
+    void admit(){
+        while(next < bytes.size() && active < slots && (active == 0 || inUse + bytes[next] <= budget)){
+            const size_t index = next++;
+            ++active;
+            inUse += bytes[index];
+
+            pool->post([self = shared_from_this(), index]{
+                self->load(index);
+            });
+        }
+    }
+
+    void load(size_t index){
+        try {
+            AJ::LoadResult result;
+            result.audio = engine.loadAudio(paths[index], result.errors);
+            results[index].set_value(std::move(result));
+        } catch(...) {
+            //? e.g. bad_alloc: the future rethrows it, the next files still start.
+            results[index].set_exception(std::current_exception());
+        }
+
+        std::lock_guard<std::mutex> lock(mux);
+        --active;
+        inUse -= bytes[index];
+        admit();
+    }
+};
+
+}
+
 std::shared_ptr<AJ::AJ_Engine> AJ::AJ_Engine::create(){
     auto engine = std::make_shared<AJ_Engine>();
     return engine;
 }
 
-std::shared_ptr<AJ::io::AudioFile> AJ::AJ_Engine::loadAudio(const std::string &path, 
+std::shared_ptr<AJ::io::AudioFile> AJ::AJ_Engine::createAudioFile(const std::string &path,
     error::IErrorHandler &handler, std::string ext){
 
     std::shared_ptr<io::AudioFile> audio;
@@ -54,14 +234,112 @@ std::shared_ptr<AJ::io::AudioFile> AJ::AJ_Engine::loadAudio(const std::string &p
         return nullptr;
     }    
 
-    if(!audio->read(handler)){
+    return audio;
+}
+
+std::shared_ptr<AJ::io::AudioFile> AJ::AJ_Engine::loadAudio(const std::string &path, 
+    error::IErrorHandler &handler, std::string ext){
+
+    AJ_TRACE_ZONE("engine", "loadAudio");
+    const utils::MemoryScope memory(utils::Subsystem::FileIO);
+    std::shared_ptr<io::AudioFile> audio = createAudioFile(path, handler, ext);
+
+    if(!audio){
+        return nullptr;
+    }
+
+    //? WAV files are already read through a mapping, only decoded formats go through the cache.
+    const bool cached = pDecodeCache && !dynamic_cast<io::WAV_File*>(audio.get());
+
+    if(!cached || !pDecodeCache->load(audio->FilePath(), *audio)){
+        //* the I/O workers convert while this thread reads, the file doesn't keep the pool.
+        const std::shared_ptr<utils::ThreadPool> pool = ioPool();
+        audio->setReadPool(pool.get());
+        const bool read = audio->read(handler);
+        audio->setReadPool(nullptr);
+
+        if(!read){
+            return nullptr;
+        }
+
+        if(cached){
+            pDecodeCache->store(audio->FilePath(), *audio); // best effort, a failed store only costs the next decode.
+
+            //? built on the way by the decode, kept for the streams and ranges of the file.
+            auto *mp3 = dynamic_cast<io::MP3_File*>(audio.get());
+            if(mp3 && mp3->seekIndex()){
+                pDecodeCache->storeSeekIndex(audio->FilePath(), *mp3->seekIndex());
+            }
+        }
+    }
+
+    if(mLevelIndexEnabled){
+        audio->buildLevelIndex();
+    }
+
+    return audio;
+}
+
+std::shared_ptr<AJ::io::AudioFile> AJ::AJ_Engine::loadAudio(const std::string &path, 
+    error::IErrorHandler &handler, sample_pos start, sample_pos end, std::string ext){
+
+    AJ_TRACE_ZONE("engine", "loadAudio");
+    const utils::MemoryScope memory(utils::Subsystem::FileIO);
+    std::shared_ptr<io::AudioFile> audio = createAudioFile(path, handler, ext);
+
+    //* an MP3 seeks to the range through its cached seek index, built by a demux pass the first time.
+    auto *mp3 = dynamic_cast<io::MP3_File*>(audio.get());
+    if(mp3 && pDecodeCache && start > 0){
+        auto index = std::make_shared<io::SeekIndex>();
+        if(pDecodeCache->loadSeekIndex(mp3->FilePath(), *index)){
+            mp3->setSeekIndex(std::move(index));
+        } else {
+            error::CollectingErrorHandler ignored; // best effort, the range is found by timestamp then.
+            if(mp3->buildSeekIndex(ignored)){
+                pDecodeCache->storeSeekIndex(mp3->FilePath(), *mp3->seekIndex());
+            }
+        }
+    }
+
+    if(!audio || !audio->readRange(start, end, handler)){
         return nullptr;
     }
 
+    if(mLevelIndexEnabled){
+        audio->buildLevelIndex();
+    }
+
     return audio;
 }
 
+bool AJ::AJ_Engine::probeAudio(const std::string &path, AudioInfo &info, 
+    error::IErrorHandler &handler, std::string ext){
+
+    std::shared_ptr<io::AudioFile> audio = createAudioFile(path, handler, ext);
+
+    if(!audio || !audio->probe(handler)){
+        return false;
+    }
+
+    info = audio->mInfo;
+    return true;
+}
+
 bool AJ::AJ_Engine::saveAudio(std::shared_ptr<io::AudioFile> audio, error::IErrorHandler &handler){
+    AJ_TRACE_ZONE("engine", "saveAudio");
+    const utils::MemoryScope memory(utils::Subsystem::FileIO);
+
+    //* the export is the read that renders the deferred effects.
+    if(!commitEffects(audio, handler)){
+        return false;
+    }
+
+    //* converted here to use the pool, write() finds the samples at the write samplerate.
+    std::shared_ptr<utils::ThreadPool> pool = pEngineResources ? pEngineResources->threadPool() : nullptr;
+    if(!audio->resample(audio->writeInfo().samplerate, pool.get(), handler)){
+        return false;
+    }
+
     if(!audio->write(handler)){
         return false;
     }
@@ -69,109 +347,778 @@ bool AJ::AJ_Engine::saveAudio(std::shared_ptr<io::AudioFile> audio, error::IErro
     return true;
 }
 
+std::future<AJ::LoadResult> AJ::AJ_Engine::loadAudioAsync(const std::string &path, std::string ext){
+    std::shared_ptr<utils::ThreadPool> pool = ioPool();
+
+    if(!pool){
+        std::promise<LoadResult> ready;
+        LoadResult result;
+        result.audio = loadAudio(path, result.errors, ext);
+        ready.set_value(std::move(result));
+        return ready.get_future();
+    }
+
+    return pool->enqueue([this, path, ext]{
+        LoadResult result;
+        result.audio = loadAudio(path, result.errors, ext);
+        return result;
+    });
+}
+
+std::vector<std::future<AJ::LoadResult>> AJ::AJ_Engine::loadAudioAsync(const std::vector<std::string> &paths,
+    const AsyncLoadOptions &options){
+
+    std::vector<std::future<LoadResult>> futures;
+    futures.reserve(paths.size());
+
+    std::shared_ptr<utils::ThreadPool> pool = ioPool();
+
+    if(!pool){
+        for(const std::string &path : paths){
+            futures.push_back(loadAudioAsync(path));
+        }
+        return futures;
+    }
+
+    const size_t slots = options.maxInFlight ? options.maxInFlight : pool->size();
+    auto batch = std::make_shared<LoadBatch>(*this, pool, paths, slots, options.memoryBudget);
+
+    for(std::promise<LoadResult> &result : batch->results){
+        futures.push_back(result.get_future());
+    }
+
+    pool->post([batch]{
+        batch->probe();
+    });
+
+    return futures;
+}
+
+std::future<AJ::SaveResult> AJ::AJ_Engine::saveAudioAsync(std::shared_ptr<io::AudioFile> audio){
+    std::shared_ptr<utils::ThreadPool> pool = ioPool();
+
+    if(!pool){
+        std::promise<SaveResult> ready;
+        SaveResult result;
+        result.success = saveAudio(audio, result.errors);
+        ready.set_value(std::move(result));
+        return ready.get_future();
+    }
+
+    return pool->enqueue([this, audio = std::move(audio)]{
+        SaveResult result;
+        result.success = saveAudio(audio, result.errors);
+        return result;
+    });
+}
+
+std::shared_ptr<AJ::utils::ThreadPool> AJ::AJ_Engine::ioPool() const {
+    return pEngineResources ? pEngineResources->ioThreadPool() : nullptr;
+}
+
 bool AJ::AJ_Engine::applyEffect(Float &buffer,
     const Effect &effect, std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler){
     
-    std::shared_ptr<AJ::dsp::Effect> audioEffect;
+    AJ_TRACE_ZONE("dsp", "effect_channel");
+    const utils::MemoryScope memory(utils::Subsystem::Dsp);
 
-    switch (effect)
-    {
-        case Effect::gain: {
-            audioEffect = std::make_shared<AJ::dsp::gain::Gain>();
-            break;
+    //* the calling thread's instance, constructed once and kept with its buffers.
+    dsp::Effect *audioEffect = pEffects->acquire(effect, params, handler);
+
+    if(!audioEffect){
+        return false;
+    }
+
+    //? the instance may still hold the pool of an earlier call.
+    std::shared_ptr<utils::ThreadPool> pool = parallelPool();
+    audioEffect->setThreadPool(pool);
+
+    if(!pool || !params || !audioEffect->splitsRange() || params->Start() < 0 || params->End() < params->Start()
+        || static_cast<size_t>(params->End()) >= buffer.size()){
+        return audioEffect->process(buffer, handler);
+    }
+
+    //* a stateless effect over a long range: pieces of the range are the tasks,
+    //* no more of them than the concurrent tasks allowed.
+    const size_t count = static_cast<size_t>(params->End() - params->Start()) + 1;
+    size_t grain = kParallelChunkFrames;
+    if(mParallel.maxConcurrentTasks != 0){
+        grain = std::max(grain, (count + mParallel.maxConcurrentTasks - 1) / mParallel.maxConcurrentTasks);
+    }
+
+    //? whole vectors per piece: only the last one has a scalar tail, the same as a single pass.
+    grain = (grain + kParallelPieceAlignment - 1) / kParallelPieceAlignment * kParallelPieceAlignment;
+
+    if(count <= grain){
+        return audioEffect->process(buffer, handler);
+    }
+
+    return processSplit(*audioEffect, buffer, count, grain, *pool, handler);
+}
+
+bool AJ::AJ_Engine::applyEffect(AudioBuffer &audio, size_t channels,
+    const Effect &effect, std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler){
+
+    AJ_TRACE_ZONE("dsp", "effect_channels");
+    const utils::MemoryScope memory(utils::Subsystem::Dsp);
+
+    dsp::Effect *audioEffect = pEffects->acquire(effect, params, handler);
+
+    if(!audioEffect){
+        return false;
+    }
+
+    std::shared_ptr<utils::ThreadPool> pool = parallelPool();
+    audioEffect->setThreadPool(pool);
+
+    //* a stateless effect splits the range of every channel across the pool instead.
+    if(pool && audioEffect->splitsRange() && !audioEffect->linksChannels() && channels > 0 && channels <= audio.size()){
+        for(size_t ch = 0; ch < channels; ++ch){
+            if(!applyEffect(audio[ch], effect, params, handler)){
+                return false;
+            }
         }
+        return true;
+    }
+
+    return audioEffect->process(audio, channels, handler);
+}
+
+bool AJ::AJ_Engine::applyEffect(const AudioView &view,
+    const Effect &effect, std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler){
+
+    AJ_TRACE_ZONE("dsp", "effect_view");
+    const utils::MemoryScope memory(utils::Subsystem::Dsp);
+
+    //* blocks clip their range to the stream: the view checks it like process() does on a buffer.
+    if(params && (params->Start() < 0 || params->End() < params->Start()
+        || static_cast<uint64_t>(params->End()) >= view.frames)){
+        error::report(handler, error::Error::InvalidEffectParameters,
+            "invalid range [{}, {}] for a view of {} frames.\n", params->Start(), params->End(), view.frames);
+        return false;
+    }
+
+    dsp::Effect *audioEffect = pEffects->acquire(effect, params, handler);
+
+    if(!audioEffect){
+        return false;
+    }
+
+    audioEffect->setThreadPool(parallelPool());
+    return audioEffect->processView(view, handler);
+}
+
+std::shared_ptr<AJ::utils::ThreadPool> AJ::AJ_Engine::parallelPool() const {
+    return mParallel.enabled && pEngineResources ? pEngineResources->threadPool() : nullptr;
+}
+
+bool AJ::AJ_Engine::splitChannels(const Effect &effect, const std::shared_ptr<dsp::EffectParams> &params){
+    if(!parallelPool()){
+        return false;
+    }
 
-        case Effect::echo: {
-            audioEffect = std::make_shared<AJ::dsp::echo::Echo>();
-            break;
+    //? an effect that can't be acquired fails again in its job, which reports it.
+    error::CollectingErrorHandler ignored;
+    dsp::Effect *audioEffect = pEffects->acquire(effect, params, ignored);
+
+    return audioEffect && !audioEffect->linksChannels();
+}
+
+bool AJ::AJ_Engine::runJobs(size_t count, const std::function<bool(size_t, error::IErrorHandler&)> &job,
+    error::IErrorHandler &handler){
+
+    if(count == 0){
+        return true;
+    }
+
+    std::shared_ptr<utils::ThreadPool> pool = pEngineResources ? pEngineResources->threadPool() : nullptr;
+    std::shared_ptr<utils::ScratchPool> scratch = pEngineResources ? pEngineResources->scratchPool() : nullptr;
+
+    //* sequential path, stop at the first failure.
+    if(!mParallel.enabled || !pool || count == 1){
+        std::optional<utils::ScratchPool::Lease> lease;
+        if(scratch) lease.emplace(*scratch);
+
+        for(size_t i = 0; i < count; ++i){
+            if(!job(i, handler)){
+                return false;
+            }
         }
 
-        case Effect::reverb: {
-            audioEffect = std::make_shared<AJ::dsp::reverb::Reverb>();
-            break;
+        return true;
+    }
+
+    size_t workers = mParallel.maxConcurrentTasks == 0 ? pool->size() : mParallel.maxConcurrentTasks;
+    workers = std::min(workers, count);
+
+    //? the caller's handler is not required to be thread-safe, so every job reports into its own handler.
+    std::vector<error::CollectingErrorHandler> errors(count);
+    std::vector<char> succeeded(count, 0);
+    std::atomic<size_t> next{0};
+
+    //* `workers` runners (the calling thread is one of them) pull jobs until none are left.
+    pool->parallel_for(0, workers, 1, [&](size_t, size_t){
+        //? each runner draws its temporaries from its own arena.
+        std::optional<utils::ScratchPool::Lease> lease;
+        if(scratch) lease.emplace(*scratch);
+
+        for(size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)){
+            AJ_TRACE_ZONE("engine", "job");
+            succeeded[i] = job(i, errors[i]) ? 1 : 0;
         }
+    });
 
-        case Effect::fadeIn: {
-            const std::string message = "Fade in effect is not implemented yet.\n";
-            handler.onError(error::Error::UnknownEffect, message);
-            return false;
+    bool success = true;
+    for(size_t i = 0; i < count; ++i){
+        errors[i].replay(handler);
+        success = success && succeeded[i];
+    }
+
+    return success;
+}
+
+std::shared_ptr<AJ::dsp::EffectParams> AJ::AJ_Engine::fileParams(io::AudioFile &audio, const Effect &effect,
+    std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler){
+
+    auto normalization = std::dynamic_pointer_cast<dsp::normalization::NormalizationParams>(params);
+    if(effect != Effect::normalization || !normalization || normalization->Mode() != dsp::normalization::LUFS){
+        return params;
+    }
+
+    //* measured through the file, whose level index keeps it for the next normalization of the range.
+    std::shared_ptr<utils::ThreadPool> pool = pEngineResources ? pEngineResources->threadPool() : nullptr;
+    dsp::loudness::Measurement measurement;
+    if(!audio.loudness(normalization->Start(), normalization->End(), measurement, pool.get(), handler)){
+        return nullptr;
+    }
+
+    auto measured = std::make_shared<dsp::normalization::NormalizationParams>(*normalization);
+    measured->setLoudness(measurement);
+    return measured;
+}
+
+void AJ::AJ_Engine::keepLoudness(io::AudioFile &audio, const std::shared_ptr<dsp::EffectParams> &applied){
+    auto normalization = std::dynamic_pointer_cast<dsp::normalization::NormalizationParams>(applied);
+    if(!normalization || !normalization->Loudness() || !normalization->Loudness()->audible()){
+        return;
+    }
+
+    //? over the ceiling the limiter ran, the new loudness is only known by measuring it.
+    dsp::loudness::Measurement gained = *normalization->Loudness();
+    gained.mTruePeak *= normalization->Gain();
+    if(gained.mTruePeak > std::pow(10.0f, kNormalizationCeilingDb / 20.0f)){
+        return;
+    }
+
+    gained.mIntegrated += 20.0 * std::log10(static_cast<double>(normalization->Gain()));
+    audio.cacheLoudness(normalization->Start(), normalization->End(), gained);
+}
+
+bool AJ::AJ_Engine::applyEffect(std::shared_ptr<AJ::io::AudioFile> audio,
+    const Effect &effect, std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler){ 
+    
+    AJ_TRACE_ZONE("engine", "applyEffect");
+    const utils::MemoryScope memory(utils::Subsystem::Dsp);
+    const uint64_t started = effectStart();
+    const size_t channels = audio->mInfo.channels == 2 ? 2 : 1;
+
+    if(mDeferredEffects && audio->storage() == io::SampleStorage::Float32){
+        std::shared_ptr<editing::render_graph::RenderGraph> graph = deferEffect(audio, effect, std::move(params), handler);
+        if(graph){
+            std::lock_guard<std::mutex> lock(mGraphsMux);
+            mDeferred.push_back({ graph });
         }
+        noteEffect(started, graph != nullptr, 1);
+        return graph != nullptr;
+    }
+
+    //* the effects waiting on the file come first.
+    if(!commitEffects(audio, handler)){
+        noteEffect(started, false, 1);
+        return false;
+    }
+
+    std::shared_ptr<dsp::EffectParams> measured = fileParams(*audio, effect, params, handler);
+    if(params && !measured){
+        noteEffect(started, false, 1);
+        return false;
+    }
+
+    const sample_pos start = params ? params->Start() : 0;
+    const sample_pos end = params ? params->End() : static_cast<sample_pos>(audio->channelFrames()) - 1;
 
-        case Effect::fadeOut: {
-            const std::string message = "Fade out effect is not implemented yet.\n";
-            handler.onError(error::Error::UnknownEffect, message);
+    //? a range the effect rejects isn't saved, the effect reports it.
+    undo::State state("applyEffect");
+    const size_t frames = audio->channelFrames();
+    if(mUndoSupportEnabled && start >= 0 && start <= end && end < static_cast<sample_pos>(frames)){
+        const size_t count = static_cast<size_t>(end - start) + 1;
+        if(!state.add(audio, start, count, count, handler)){
+            noteEffect(started, false, 1);
             return false;
         }
+    }
 
-        case Effect::normalization: {
-            const std::string message = "Normalization effect is not implemented yet.\n";
-            handler.onError(error::Error::UnknownEffect, message);
-            return false;
+    //* one call over all the channels, unless they can run as separate tasks.
+    const bool split = splitChannels(effect, measured);
+
+    const bool success = runJobs(split ? channels : 1, [&](size_t ch, error::IErrorHandler &jobHandler){
+        if(!split){
+            return processChannels(*audio, channels, start, end, [&](AudioBuffer &samples){
+                return applyEffect(samples, channels, effect, measured, jobHandler);
+            });
         }
 
-        case Effect::pitchShift: {
-            const std::string message = "Pitch shift effect is not implemented yet.\n";
-            handler.onError(error::Error::UnknownEffect, message);
-            return false;
+        return processChannel(*audio, ch, start, end, [&](Float &buffer){
+            return applyEffect(buffer, effect, measured, jobHandler);
+        });
+    }, handler);
+
+    //* a failing channel may still have been partially processed.
+    if(params){
+        audio->updateLevelIndex(params->Start(), params->End());
+    }
+
+    if(success){
+        keepLoudness(*audio, measured);
+    }
+
+    //* a failing effect may have processed part of the range, it can still be undone.
+    mUndo.push(std::move(state), handler);
+    noteEffect(started, success, 1);
+
+    return success;
+}
+
+bool AJ::AJ_Engine::applyEffect(std::vector<std::shared_ptr<AJ::io::AudioFile>> audioFiles,
+    const Effect &effect, std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler){
+    
+    AJ_TRACE_ZONE("engine", "applyEffect");
+    const utils::MemoryScope memory(utils::Subsystem::Dsp);
+    const uint64_t started = effectStart();
+
+    if(mDeferredEffects){
+        bool success = true;
+        std::vector<std::weak_ptr<editing::render_graph::RenderGraph>> group;
+
+        for(const auto &audio : audioFiles){
+            //? a compact file is processed at once, by the single file overload.
+            if(audio->storage() != io::SampleStorage::Float32){
+                success = applyEffect(audio, effect, params, handler) && success;
+                continue;
+            }
+
+            std::shared_ptr<editing::render_graph::RenderGraph> graph = deferEffect(audio, effect, params, handler);
+            if(graph){
+                group.push_back(graph);
+            }
+            success = graph && success;
         }
 
-        case Effect::reverse: {
-            const std::string message = "Reverse effect is not implemented yet.\n";
-            handler.onError(error::Error::UnknownEffect, message);
-            return false;
+        //* one undo() pops the node of every file.
+        if(!group.empty()){
+            std::lock_guard<std::mutex> lock(mGraphsMux);
+            mDeferred.push_back(std::move(group));
         }
 
-        case Effect::Distortion: {
-            const std::string message = "Distortion effect is not implemented yet.\n";
-            handler.onError(error::Error::UnknownEffect, message);
+        noteEffect(started, success, audioFiles.size());
+        return success;
+    }
+
+    for(const auto &audio : audioFiles){
+        if(!commitEffects(audio, handler)){
+            noteEffect(started, false, audioFiles.size());
             return false;
         }
+    }
+
+    //* flatten (file, channel) pairs so channels of all files balance across the pool,
+    //* or one job per file when its channels go through the effect together.
+    const bool split = splitChannels(effect, params);
+    std::vector<std::pair<size_t, size_t>> jobs;
+    std::vector<std::shared_ptr<dsp::EffectParams>> measured(audioFiles.size());
+    jobs.reserve(audioFiles.size() * 2);
+
+    for(size_t f = 0; f < audioFiles.size(); ++f){
+        //? a file that can't be measured fails its jobs, the others still run.
+        measured[f] = fileParams(*audioFiles[f], effect, params, handler);
 
-        default: {
-            const std::string message = "Unknown or unsupported audio effect requested.";
-            handler.onError(error::Error::UnknownEffect, message);
+        jobs.emplace_back(f, 0);
+
+        if(split && audioFiles[f]->mInfo.channels == 2){
+            jobs.emplace_back(f, 1);
+        }
+    }
+
+    undo::State state("applyEffect");
+    if(mUndoSupportEnabled && params){
+        for(const auto &audio : audioFiles){
+            const sample_pos start = params->Start(), end = params->End();
+            if(start >= 0 && start <= end && end < static_cast<sample_pos>(audio->channelFrames())){
+                const size_t frames = static_cast<size_t>(end - start) + 1;
+                if(!state.add(audio, start, frames, frames, handler)){
+                    noteEffect(started, false, audioFiles.size());
+                    return false;
+                }
+            }
+        }
+    }
+
+    const bool success = runJobs(jobs.size(), [&](size_t i, error::IErrorHandler &jobHandler){
+        auto [f, ch] = jobs[i];
+        io::AudioFile &audio = *audioFiles[f];
+
+        if(params && !measured[f]){
             return false;
         }
+
+        const sample_pos start = params ? params->Start() : 0;
+        const sample_pos end = params ? params->End() : static_cast<sample_pos>(audio.channelFrames()) - 1;
+
+        if(!split){
+            const size_t channels = audio.mInfo.channels == 2 ? 2 : 1;
+            return processChannels(audio, channels, start, end, [&](AudioBuffer &samples){
+                return applyEffect(samples, channels, effect, measured[f], jobHandler);
+            });
+        }
+
+        return processChannel(audio, ch, start, end, [&](Float &buffer){
+            return applyEffect(buffer, effect, measured[f], jobHandler);
+        });
+    }, handler);
+
+    if(params){
+        for(size_t f = 0; f < audioFiles.size(); ++f){
+            audioFiles[f]->updateLevelIndex(params->Start(), params->End());
+            if(success) keepLoudness(*audioFiles[f], measured[f]);
+        }
+    }
+
+    mUndo.push(std::move(state), handler);
+    noteEffect(started, success, audioFiles.size());
+
+    return success;
+}
+
+std::shared_ptr<AJ::editing::render_graph::RenderGraph> AJ::AJ_Engine::renderGraph(
+    const std::shared_ptr<io::AudioFile> &audio, error::IErrorHandler &handler){
+
+    if(audio->storage() != io::SampleStorage::Float32){
+        const std::string message = "the samples must be in Float32 storage to be rendered.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return nullptr;
+    }
+
+    std::shared_ptr<editing::render_graph::RenderGraph> graph;
+    {
+        std::lock_guard<std::mutex> lock(mGraphsMux);
+
+        //? the graphs of files that are gone go with the lookup.
+        mGraphs.erase(std::remove_if(mGraphs.begin(), mGraphs.end(), [](const auto &entry){
+            return entry.first.expired();
+        }), mGraphs.end());
+
+        for(const auto &[file, existing] : mGraphs){
+            if(file.lock() == audio){
+                graph = existing;
+                break;
+            }
+        }
+
+        if(!graph){
+            graph = std::make_shared<editing::render_graph::RenderGraph>(pEffects);
+            mGraphs.emplace_back(audio, graph);
+        }
+    }
+
+    //* without waiting effects the graph is the file as it is now (it may have been cut, resampled...).
+    if(graph->size() == 0){
+        const uint8_t channels = audio->mInfo.channels == 2 ? 2 : 1;
+        if(!graph->assign(audio->pAudio, channels, handler)){
+            return nullptr;
+        }
     }
 
+    graph->setThreadPool(parallelPool());
+    return graph;
+}
+
+std::shared_ptr<AJ::editing::preview::PreviewRenderer> AJ::AJ_Engine::createPreview(
+    const std::shared_ptr<io::AudioFile> &audio, error::IErrorHandler &handler){
+
+    if(audio->storage() != io::SampleStorage::Float32){
+        const std::string message = "the samples must be in Float32 storage to be previewed.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return nullptr;
+    }
+
+    auto preview = std::make_shared<editing::preview::PreviewRenderer>(pEffects, handler);
+    const uint8_t channels = audio->mInfo.channels == 2 ? 2 : 1;
+    if(!preview->assign(audio->pAudio, channels, static_cast<uint32_t>(audio->mInfo.samplerate), handler)){
+        return nullptr;
+    }
+
+    return preview;
+}
+
+std::shared_ptr<AJ::editing::render_graph::RenderGraph> AJ::AJ_Engine::pendingGraph(
+    const std::shared_ptr<io::AudioFile> &audio) const {
+
+    std::lock_guard<std::mutex> lock(mGraphsMux);
+
+    for(const auto &[file, graph] : mGraphs){
+        if(file.lock() == audio){
+            return graph->size() ? graph : nullptr;
+        }
+    }
+    return nullptr;
+}
 
-    if (!audioEffect->setParams(params, handler)) {
+std::shared_ptr<AJ::editing::render_graph::RenderGraph> AJ::AJ_Engine::deferEffect(
+    const std::shared_ptr<io::AudioFile> &audio, const Effect &effect, std::shared_ptr<dsp::EffectParams> params,
+    error::IErrorHandler &handler){
+
+    std::shared_ptr<editing::render_graph::RenderGraph> graph = renderGraph(audio, handler);
+    if(!graph || !graph->push(effect, std::move(params), handler)){
+        return nullptr;
+    }
+    return graph;
+}
+
+bool AJ::AJ_Engine::undo(error::IErrorHandler &handler){
+    std::vector<std::shared_ptr<editing::render_graph::RenderGraph>> graphs;
+    {
+        std::lock_guard<std::mutex> lock(mGraphsMux);
+
+        //? the files of a call may all be gone, the call before it is the last one then.
+        while(graphs.empty() && !mDeferred.empty()){
+            for(const auto &weak : mDeferred.back()){
+                if(auto graph = weak.lock()){
+                    graphs.push_back(std::move(graph));
+                }
+            }
+            mDeferred.pop_back();
+        }
+    }
+
+    if(graphs.empty()){
+        return mUndo.undo(handler);
+    }
+
+    bool success = true;
+    for(const auto &graph : graphs){
+        success = graph->pop(handler) && success;
+    }
+    return success;
+}
+
+bool AJ::AJ_Engine::commitEffects(const std::shared_ptr<io::AudioFile> &audio, error::IErrorHandler &handler){
+    std::shared_ptr<editing::render_graph::RenderGraph> graph = pendingGraph(audio);
+    if(!graph){
+        return true;
+    }
+
+    AJ_TRACE_ZONE("engine", "commitEffects");
+
+    //* only the frames some node covers change, they're what undo keeps.
+    const std::vector<editing::render_graph::Node> nodes = graph->nodes();
+    sample_pos start = nodes.front().start, end = nodes.front().end;
+    for(const auto &node : nodes){
+        start = std::min(start, node.start);
+        end = std::max(end, node.end);
+    }
+
+    undo::State state("commitEffects");
+    if(mUndoSupportEnabled){
+        const size_t count = static_cast<size_t>(end - start) + 1;
+        if(!state.add(audio, start, count, count, handler)){
+            return false;
+        }
+    }
+
+    if(!graph->flatten(*audio, handler)){
         return false;
     }
 
-    if(!audioEffect->process(buffer, handler)){
-        return false;  
+    //* committed nodes are undone with the undo history now.
+    {
+        std::lock_guard<std::mutex> lock(mGraphsMux);
+        for(auto &group : mDeferred){
+            group.erase(std::remove_if(group.begin(), group.end(), [&](const auto &weak){
+                return weak.lock() == graph;
+            }), group.end());
+        }
+        mDeferred.erase(std::remove_if(mDeferred.begin(), mDeferred.end(), [](const auto &group){
+            return group.empty();
+        }), mDeferred.end());
+    }
+
+    const uint8_t channels = audio->mInfo.channels == 2 ? 2 : 1;
+    if(!graph->assign(audio->pAudio, channels, handler)){
+        return false;
     }
 
+    mUndo.push(std::move(state), handler);
     return true;
 }
 
-// TODO: support multi-threading per channel for this method.
-bool AJ::AJ_Engine::applyEffect(std::shared_ptr<AJ::io::AudioFile> audio,
-    const Effect &effect, std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler){ 
-    
-    if(!applyEffect(audio->pAudio->at(0), effect, params, handler)){
+void AJ::AJ_Engine::noteEffect(uint64_t start, bool success, size_t files) const noexcept {
+    if(!pEngineResources){
+        return;
+    }
+
+    utils::MetricsRegistry &metrics = *pEngineResources->metrics();
+    metrics.add(utils::Counter::EffectRuns, files);
+    if(!success){
+        metrics.add(utils::Counter::EffectFailures, files);
+    }
+    metrics.record(utils::Latency::Effect, utils::MetricsRegistry::now() - start);
+}
+
+bool AJ::AJ_Engine::applyEffectChain(Float &buffer, dsp::EffectChain &chain, error::IErrorHandler &handler){
+    return chain.process(buffer, handler);
+}
+
+bool AJ::AJ_Engine::applyEffectChain(std::shared_ptr<AJ::io::AudioFile> audio, dsp::EffectChain &chain,
+    error::IErrorHandler &handler){
+
+    AJ_TRACE_ZONE("engine", "applyEffectChain");
+    const utils::MemoryScope memory(utils::Subsystem::Dsp);
+    const size_t channels = audio->mInfo.channels == 2 ? 2 : 1;
+
+    if(!commitEffects(audio, handler)){
         return false;
     }
 
-    if(audio->mInfo.channels == 2){
-        if(!applyEffect(audio->pAudio->at(1), effect, params, handler)){
+    //* the chain keeps no state between calls, so channels can share it.
+    const sample_pos end = static_cast<sample_pos>(audio->channelFrames()) - 1;
+
+    undo::State state("applyEffectChain");
+    if(mUndoSupportEnabled && end >= 0){
+        if(!state.add(audio, 0, audio->channelFrames(), audio->channelFrames(), handler)){
             return false;
-        }   
+        }
     }
-    
-    return true;
+
+    const bool success = runJobs(channels, [&](size_t ch, error::IErrorHandler &jobHandler){
+        return processChannel(*audio, ch, 0, end, [&](Float &buffer){
+            return chain.process(buffer, jobHandler);
+        });
+    }, handler);
+
+    // stages have their own ranges, refresh the whole index.
+    audio->updateLevelIndex(0);
+
+    mUndo.push(std::move(state), handler);
+
+    return success;
 }
 
-// TODO: support multi-threading per audio file for this method.
-bool AJ::AJ_Engine::applyEffect(std::vector<std::shared_ptr<AJ::io::AudioFile>> audioFiles,
-    const Effect &effect, std::shared_ptr<dsp::EffectParams> params, error::IErrorHandler &handler){
-    
-    for(auto audio : audioFiles){
-        if(!applyEffect(audio, effect, params, handler)){
-            return false;
+bool AJ::AJ_Engine::processFile(const std::string &inPath, const std::string &outPath, dsp::EffectChain &chain,
+    error::IErrorHandler &handler, const FileProcessOptions &options){
+
+    AJ_TRACE_ZONE("engine", "processFile");
+    const utils::MemoryScope memory(utils::Subsystem::FileIO);
+
+    if(!chain.supportsBlockProcessing()){
+        const std::string message = "every stage of the chain must support block processing to process a file.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    //? the output is truncated while the input is still being read.
+    std::error_code ec;
+    if(inPath == outPath || std::filesystem::equivalent(inPath, outPath, ec)){
+        const std::string message = "a file can't be processed into itself: " + outPath + "\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    AudioInfo info;
+    if(!probeAudio(inPath, info, handler)){
+        return false;
+    }
+
+    const uint8_t channels = static_cast<uint8_t>(info.channels);
+    const size_t block = std::max<size_t>(options.blockFrames, 1);
+    const size_t inflight = std::max<size_t>(options.inflightBlocks, 1);
+
+    auto pool = std::make_shared<utils::BufferPool>(handler, inflight, block, channels);
+    auto queue = std::make_shared<utils::Queue>(true, inflight, block, channels, handler);
+    if(!pool->isValid() || !queue->isValid()){
+        return false;
+    }
+
+    auto stop = std::make_shared<LFControlFlag>();
+    std::string directory = std::filesystem::path(outPath).parent_path().string();
+    io::file_streamer::FileStreamer reader(queue, pool, stop, FileStreamingTypes::processins,
+        directory.empty() ? "." : directory);
+
+    if(!reader.setReadInfo(inPath, handler)){
+        return false;
+    }
+
+    std::unique_ptr<dsp::EffectState> state = chain.createState(channels, handler);
+    if(!state){
+        return false;
+    }
+
+    io::WavStreamWriter writer;
+    if(!writer.open(outPath, channels, static_cast<uint32_t>(info.samplerate), options.stream, handler)){
+        return false;
+    }
+
+    //* the reader decodes on a worker, a pool without an idle one would make it wait for it.
+    std::shared_ptr<utils::ThreadPool> threads = pEngineResources ? pEngineResources->threadPool() : nullptr;
+    if(!threads || threads->available() < 1){
+        threads = std::make_shared<utils::ThreadPool>(1);
+    }
+
+    error::CollectingErrorHandler readErrors; // the handler isn't required to be thread-safe.
+    std::future<void> decoded = threads->enqueue([&]{
+        const utils::MemoryScope readerMemory(utils::Subsystem::FileIO);
+        reader.read(readErrors);
+    });
+
+    //* the chain and the writer on the calling thread, every block goes back to the reader's pool.
+    const LFControlFlagPtr end = reader.endFlag();
+    bool success = true;
+    while(true){
+        utils::Buffer *buffer = queue->pop();
+
+        if(!buffer){
+            //? read() queued its last block before setting the end flag (or failed before reading).
+            if(end->flag.load(std::memory_order_acquire)
+                || decoded.wait_for(std::chrono::seconds(0)) == std::future_status::ready){
+                if(!(buffer = queue->pop())){
+                    break;
+                }
+            } else {
+                AJ_TRACE_ZONE("queue", "wait_decoded");
+                queue->wait(1, kStreamerWakeTimeout);
+                continue;
+            }
+        }
+
+        if(success){
+            AJ_TRACE_ZONE("dsp", "chain_block");
+            const utils::MemoryScope blockMemory(utils::Subsystem::Dsp);
+            success = chain.processBlock(buffer->data, buffer->frames, channels, *state, handler)
+                && writer.append(buffer->data, buffer->frames, handler);
+
+            if(!success){
+                stop->flag.store(true, std::memory_order_release);
+            }
         }
+
+        pool->push(buffer, handler);
     }
-    
-    return true;
-}
\ No newline at end of file
+
+    // the reader waits for a seek at the end of the file.
+    stop->flag.store(true, std::memory_order_release);
+    decoded.wait();
+
+    readErrors.replay(handler);
+    success = writer.close(handler) && success;
+
+    return success && !readErrors.hasErrors();
+}
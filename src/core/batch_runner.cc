@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+#include "dsp/gain.h"
+#include "dsp/fade.h"
+#include "dsp/normalization.h"
+#include "dsp/reverse.h"
+#include "dsp/reverb/reverb.h"
+#include "dsp/dynamics/gate.h"
+#include "editing/trim.h"
+
+#include "core/batch_runner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double since(Clock::time_point begin){
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+bool audioExtension(const std::filesystem::path &path){
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c){ return std::tolower(c); });
+    return ext == ".wav" || ext == ".mp3";
+}
+
+/**
+ * @brief `output` as given if it has a directory, otherwise in `outDirectory` (the input's name if empty).
+ */
+std::string outputPath(const std::string &input, const std::string &output, const std::string &outDirectory){
+    const std::filesystem::path out = output.empty() ? std::filesystem::path(input).filename() : std::filesystem::path(output);
+    return out.has_parent_path() ? out.string() : (std::filesystem::path(outDirectory) / out).string();
+}
+
+}
+
+bool AJ::batch::EffectSpec::parse(const std::string &spec, EffectSpec &out, AJ::error::IErrorHandler &handler){
+    const size_t equal = spec.find('=');
+    const std::string name = spec.substr(0, equal);
+
+    EffectSpec parsed;
+    bool valued = true;
+
+    if(name == "gain"){
+        parsed.effect = Effect::gain;
+    } else if(name == "normalize"){
+        parsed.effect = Effect::normalization;
+    } else if(name == "lufs"){
+        parsed.effect = Effect::normalization;
+        parsed.value = -23.0f;
+    } else if(name == "reverb"){
+        parsed.effect = Effect::reverb;
+        parsed.value = 0.7f;
+    } else if(name == "gate"){
+        parsed.effect = Effect::gate;
+        parsed.value = -50.0f;
+    } else if(name == "trim"){
+        parsed.value = kTrimThresholdDb;
+    } else if(name == "fadein" || name == "fadeout" || name == "reverse"){
+        parsed.effect = name == "reverse" ? Effect::reverse : (name == "fadein" ? Effect::fadeIn : Effect::fadeOut);
+        valued = false;
+    } else {
+        const std::string message = "unknown effect '" + name + "', expected gain, normalize, lufs, fadein, fadeout, reverse, reverb, gate or trim.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    if(equal != std::string::npos){
+        const std::string value = spec.substr(equal + 1);
+        size_t used = 0;
+
+        try {
+            parsed.value = std::stof(value, &used);
+        } catch(const std::exception&){
+            used = 0;
+        }
+
+        if(!valued || used == 0 || used != value.size()){
+            const std::string message = "invalid value '" + value + "' for the effect " + name + ".\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return false;
+        }
+    }
+
+    parsed.lufs = name == "lufs";
+    parsed.trim = name == "trim";
+    out = parsed;
+    return true;
+}
+
+std::shared_ptr<AJ::dsp::EffectParams> AJ::batch::EffectSpec::params(const io::AudioFile &audio,
+    AJ::error::IErrorHandler &handler) const {
+
+    const size_t frames = audio.channelFrames();
+    if(frames == 0){
+        const std::string message = "the file has no samples to process.\n";
+        handler.onError(error::Error::InvalidAudioLength, message);
+        return nullptr;
+    }
+
+    const sample_pos end = static_cast<sample_pos>(frames) - 1;
+
+    switch(effect){
+    case Effect::gain: {
+        dsp::gain::Params params{ 0, end, value };
+        return dsp::gain::GainParams::create(params, handler);
+    }
+    case Effect::normalization: {
+        dsp::normalization::Params params;
+        params.mStart = 0;
+        params.mEnd = end;
+        params.mTarget = value;
+        params.mMode = lufs ? dsp::normalization::LUFS : dsp::normalization::Peak;
+        params.mSamplerate = static_cast<uint32_t>(audio.mInfo.samplerate);
+        return dsp::normalization::NormalizationParams::create(params, handler);
+    }
+    case Effect::fadeIn:
+    case Effect::fadeOut: {
+        const dsp::fade::FadeMode mode = effect == Effect::fadeIn ? dsp::fade::FadeMode::In : dsp::fade::FadeMode::Out;
+        dsp::fade::Params params{ 0, end, 1.0f, 0.0f, mode };
+        return dsp::fade::FadeParams::create(params, handler);
+    }
+    case Effect::reverse: {
+        dsp::reverse::Params params{ 0, frames - 1 };
+        return dsp::reverse::ReverseParams::create(params, handler);
+    }
+    case Effect::reverb: {
+        dsp::reverb::Params params{ 40.0f, value, 1.0f - value, static_cast<int>(audio.mInfo.samplerate), 0.7f, 0, frames - 1 };
+        return dsp::reverb::ReverbParams::create(params, handler);
+    }
+    case Effect::gate: {
+        dsp::gate::Params params{ 0, end, static_cast<uint32_t>(audio.mInfo.samplerate), value, -80.0f, 1.0f, 50.0f, 100.0f };
+        return dsp::gate::GateParams::create(params, handler);
+    }
+    default: {
+        const std::string message = "the effect can't be applied by a batch.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+    }
+}
+
+std::vector<AJ::batch::Job> AJ::batch::BatchRunner::fromDirectory(const std::string &directory,
+    const std::string &outDirectory, AJ::error::IErrorHandler &handler){
+
+    std::vector<Job> jobs;
+    std::error_code ec;
+    std::filesystem::directory_iterator entries(directory, ec);
+
+    if(ec){
+        const std::string message = "Error: can't list the directory " + directory + "\n";
+        handler.onError(error::Error::InvalidFilePath, message);
+        return jobs;
+    }
+
+    for(const auto &entry : entries){
+        if(entry.is_regular_file(ec) && audioExtension(entry.path())){
+            const std::string input = entry.path().string();
+            jobs.push_back(Job{ input, outputPath(input, "", outDirectory) });
+        }
+    }
+
+    std::sort(jobs.begin(), jobs.end(), [](const Job &a, const Job &b){ return a.input < b.input; });
+    return jobs;
+}
+
+std::vector<AJ::batch::Job> AJ::batch::BatchRunner::fromManifest(const std::string &manifest,
+    const std::string &outDirectory, AJ::error::IErrorHandler &handler){
+
+    std::vector<Job> jobs;
+    std::ifstream file(manifest);
+
+    if(!file){
+        const std::string message = "Error: can't open the manifest " + manifest + "\n";
+        handler.onError(error::Error::FileOpenError, message);
+        return jobs;
+    }
+
+    std::string line;
+    while(std::getline(file, line)){
+        if(!line.empty() && line.back() == '\r'){
+            line.pop_back();
+        }
+
+        if(line.empty() || line[0] == '#'){
+            continue;
+        }
+
+        const size_t tab = line.find('\t');
+        const std::string input = line.substr(0, tab);
+        const std::string output = tab == std::string::npos ? "" : line.substr(tab + 1);
+        jobs.push_back(Job{ input, outputPath(input, output, outDirectory) });
+    }
+
+    return jobs;
+}
+
+bool AJ::batch::BatchRunner::run(const std::vector<Job> &jobs, const EffectSpec &spec, const Report &report,
+    AJ::error::IErrorHandler &handler){
+
+    mPeakBytes = 0;
+
+    //? the undo history isn't thread-safe, and turning it off here would clear it.
+    if(mEngine.isUndoSupportEnabled()){
+        const std::string message = "a batch runs with the undo support of the engine disabled (setUndoSupportEnabled(false)).\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    const size_t count = jobs.size();
+    std::shared_ptr<EngineResources> resources = mEngine.engineResources();
+    std::shared_ptr<utils::ThreadPool> pool = resources ? resources->threadPool() : nullptr;
+    const size_t slots = mOptions.maxConcurrentFiles ? mOptions.maxConcurrentFiles : (pool ? pool->size() : 1);
+
+    std::vector<JobResult> results(count);
+    std::vector<char> finished(count, 0);
+    std::vector<std::future<void>> running;
+    size_t active = 0, inUse = 0, reported = 0;
+    bool success = true;
+
+    //* a job on a worker: load, process, save with its own handler.
+    auto process = [&](size_t index){
+        JobResult &result = results[index];
+        const Job &job = jobs[index];
+        error::CollectingErrorHandler errors;
+
+        Clock::time_point t = Clock::now();
+        std::shared_ptr<io::AudioFile> audio = mEngine.loadAudio(job.input, errors);
+        result.load = since(t);
+
+        if(audio && spec.trim){
+            //? the trim is an edit: its cuts are made on this worker, in one pass.
+            editing::trim::Options options;
+            options.mThresholdDb = spec.value;
+
+            editing::trim::AutoTrim trim;
+            t = Clock::now();
+            result.success = trim.setOptions(options, errors) && trim.process(audio, errors);
+            result.process = since(t);
+        } else {
+            std::shared_ptr<dsp::EffectParams> params = audio ? spec.params(*audio, errors) : nullptr;
+            if(params){
+                t = Clock::now();
+                result.success = mEngine.applyEffect(audio, spec.effect, params, errors);
+                result.process = since(t);
+            }
+        }
+
+        if(result.success){
+            const std::filesystem::path out(job.output);
+
+            AudioWriteInfo info;
+            info.length = audio->mInfo.length;
+            info.samplerate = audio->mInfo.samplerate;
+            info.channels = audio->mInfo.channels;
+            info.bitdepth = audio->mInfo.bitdepth;
+            info.format = audio->mInfo.format;
+            info.seekable = audio->mInfo.seekable;
+            info.path = out.has_parent_path() ? out.parent_path().string() : ".";
+            info.name = out.filename().string();
+
+            t = Clock::now();
+            result.success = audio->setWriteInfo(info, errors) && mEngine.saveAudio(audio, errors);
+            result.save = since(t);
+        }
+
+        //? the samples go before the budget is given back.
+        audio.reset();
+        result.errors = errors.errors();
+
+        std::lock_guard<std::mutex> lock(mMux);
+        inUse -= result.bytes;
+        --active;
+        finished[index] = 1;
+        mDone.notify_all();
+    };
+
+    //* the results completed in order so far, reported on this thread (lock released meanwhile).
+    auto flush = [&](std::unique_lock<std::mutex> &lock){
+        while(reported < count && finished[reported]){
+            const JobResult &result = results[reported++];
+            lock.unlock();
+
+            for(const auto &[code, message] : result.errors){
+                handler.onError(code, message);
+            }
+            success = success && result.success;
+
+            if(report){
+                report(result);
+            }
+            lock.lock();
+        }
+    };
+
+    for(size_t i = 0; i < count; ++i){
+        JobResult &result = results[i];
+        result.index = i;
+        result.job = &jobs[i];
+
+        //* the decoded size from the header: samples of every channel, as floats.
+        AudioInfo info;
+        error::CollectingErrorHandler probe;
+        const bool probed = mEngine.probeAudio(jobs[i].input, info, probe);
+        result.bytes = probed ? static_cast<size_t>(info.length) * sizeof(float) : 0;
+
+        const Clock::time_point t = Clock::now();
+        std::unique_lock<std::mutex> lock(mMux);
+
+        if(!probed){
+            result.errors = probe.errors();
+            finished[i] = 1;
+            flush(lock);
+            continue;
+        }
+
+        //? a file larger than the budget runs once nothing else does.
+        while(true){
+            flush(lock);
+            if(active < slots && (active == 0 || inUse + result.bytes <= mOptions.memoryBudget)){
+                break;
+            }
+            mDone.wait(lock);
+        }
+
+        ++active;
+        inUse += result.bytes;
+        mPeakBytes = std::max(mPeakBytes, inUse);
+        result.wait = since(t);
+        lock.unlock();
+
+        if(pool){
+            running.push_back(pool->enqueue([&process, i]{ process(i); }));
+        } else {
+            process(i);
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mMux);
+        while(true){
+            flush(lock);
+            if(reported == count){
+                break;
+            }
+            mDone.wait(lock);
+        }
+    }
+
+    for(std::future<void> &job : running){
+        job.wait();
+    }
+
+    return success;
+}
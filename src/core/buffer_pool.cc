@@ -1,10 +1,114 @@
 #include "core/buffer_pool.h"
+#include "core/thread_placement.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+namespace {
+
+#if defined(__linux__)
+// the futex word is the value of the atomic (std::atomic<uint32_t> is lock-free and has the same layout).
+void futexWait(std::atomic<uint32_t> &word, uint32_t expected, std::chrono::nanoseconds timeout) noexcept {
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t> &word) noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+#endif
+
+}
+
+bool AJ::utils::Queue::allocSlab(size_t bytes) {
+    mSlabMapped = false;
+    mSlabAlignment = kBufferAlignment;
+    pSlab = nullptr;
+
+    //* aligned_alloc requires the size to be a multiple of the alignment.
+    bytes = (bytes + kBufferAlignment - 1) & ~(kBufferAlignment - 1);
+
+#if defined(__linux__)
+    if(mHugePages){
+        size_t huge_bytes = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+
+        //? explicit huge pages, only works if the system reserved some (vm.nr_hugepages).
+        void* ptr = mmap(nullptr, huge_bytes, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if(ptr != MAP_FAILED){
+            bindToNumaNode(ptr, huge_bytes, mNumaNode);
+            pSlab = static_cast<float*>(ptr);
+            mSlabBytes = huge_bytes;
+            mSlabMapped = true;
+            engineAllocator().noteAcquired(huge_bytes, Subsystem::Pools);
+            return true;
+        }
+
+        //? fallback to transparent huge pages, a huge page aligned block the kernel may back with huge pages.
+        ptr = engineAllocator().allocate(huge_bytes, kHugePageSize, Subsystem::Pools);
+        if(ptr){
+            madvise(ptr, huge_bytes, MADV_HUGEPAGE);
+            bindToNumaNode(ptr, huge_bytes, mNumaNode);
+            pSlab = static_cast<float*>(ptr);
+            mSlabBytes = huge_bytes;
+            mSlabAlignment = kHugePageSize;
+            return true;
+        }
+    }
+#endif
+
+    pSlab = static_cast<float*>(engineAllocator().allocate(bytes, kBufferAlignment, Subsystem::Pools));
+    if(!pSlab){
+        mSlabBytes = 0;
+        return false;
+    }
+
+    //? the slab isn't written yet (allocBuffers() clears it next), its pages follow the node.
+    bindToNumaNode(pSlab, bytes, mNumaNode);
+
+    mSlabBytes = bytes;
+    return true;
+}
+
+void AJ::utils::Queue::freeSlab() noexcept {
+    if(!pSlab){
+        return;
+    }
+
+#if defined(__linux__)
+    if(mSlabMapped){
+        munmap(pSlab, mSlabBytes);
+        engineAllocator().noteReleased(mSlabBytes, Subsystem::Pools);
+    } else {
+        engineAllocator().deallocate(pSlab, mSlabBytes, mSlabAlignment, Subsystem::Pools);
+    }
+#else
+    engineAllocator().deallocate(pSlab, mSlabBytes, mSlabAlignment, Subsystem::Pools);
+#endif
+
+    pSlab = nullptr;
+    mSlabBytes = 0;
+    mSlabMapped = false;
+}
 
 size_t AJ::utils::Queue::currentSize() {
     size_t currentRead  = mReadIndex.load(std::memory_order_acquire);
     size_t currentWrite = mWriteIndex.load(std::memory_order_acquire);
 
-    return getAvailableBuffers(currentRead, currentWrite);
+    return getAvailableBuffers(currentWrite, currentRead);
 }
 
 bool AJ::utils::Queue::push(Buffer *buffer) noexcept {
@@ -28,9 +132,103 @@ bool AJ::utils::Queue::push(Buffer *buffer) noexcept {
         mFullFlag.store(true, std::memory_order_release);
     }
 
+    notify(mQueueSize - space + 1);
+
     return true;
 }
 
+size_t AJ::utils::Queue::pushBatch(Buffer* const* buffers, size_t count) noexcept {
+    const size_t currentWrite = mWriteIndex.load(std::memory_order_relaxed);
+
+    const size_t space = getFreeSpace(currentWrite);
+
+    size_t pushed = 0;
+    const size_t limit = std::min(count, space);
+    while(pushed < limit && buffers[pushed]){
+        mQueue[(currentWrite + pushed) & mMask] = buffers[pushed];
+        ++pushed;
+    }
+
+    if(pushed == 0){
+        return 0;
+    }
+
+    mWriteIndex.store((currentWrite + pushed) & mMask, std::memory_order_release);
+
+    if(pushed == space){
+        mFullFlag.store(true, std::memory_order_release);
+    }
+
+    notify(mQueueSize - space + pushed);
+
+    return pushed;
+}
+
+void AJ::utils::Queue::notify(size_t queued) noexcept {
+    //* pairs with the fence in wait(): either the consumer sees the new buffer, or we see the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if(mWaiters.load(std::memory_order_relaxed) == 0){
+        return;
+    }
+
+    if(queued >= mWakeThreshold.load(std::memory_order_relaxed)){
+        wake();
+    }
+}
+
+void AJ::utils::Queue::wake() noexcept {
+    mEpoch.fetch_add(1, std::memory_order_release);
+
+#if defined(__linux__)
+    futexWake(mEpoch);
+#endif
+}
+
+bool AJ::utils::Queue::wait(size_t min_buffers, std::chrono::microseconds timeout) noexcept {
+    using clock = std::chrono::steady_clock;
+
+    min_buffers = std::clamp<size_t>(min_buffers, 1, mQueueSize);
+    const clock::time_point deadline = clock::now() + timeout;
+
+    while(true){
+        //? read the epoch before checking, a push in between changes it and the futex wait returns at once.
+        const uint32_t epoch = mEpoch.load(std::memory_order_acquire);
+
+        if(currentSize() >= min_buffers){
+            return true;
+        }
+
+        const clock::time_point now = clock::now();
+        if(now >= deadline){
+            return false;
+        }
+
+        mWakeThreshold.store(min_buffers, std::memory_order_relaxed);
+        mWaiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if(currentSize() >= min_buffers){
+            mWaiters.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+#if defined(__linux__)
+        futexWait(mEpoch, epoch, deadline - now);
+#else
+        //? no futex, fall back to short sleeps.
+        std::this_thread::sleep_for(std::min<clock::duration>(deadline - now, std::chrono::microseconds(100)));
+#endif
+
+        mWaiters.fetch_sub(1, std::memory_order_relaxed);
+
+        //* woken by wake() without data: let the caller re-check its own state.
+        if(mEpoch.load(std::memory_order_acquire) != epoch && currentSize() < min_buffers){
+            return false;
+        }
+    }
+}
+
 AJ::utils::Buffer* AJ::utils::Queue::pop() noexcept {
     size_t currentWrite = mWriteIndex.load(std::memory_order_acquire);
     
@@ -53,4 +251,29 @@ AJ::utils::Buffer* AJ::utils::Queue::pop() noexcept {
     }
 
     return buffer;
+}
+
+size_t AJ::utils::Queue::popBatch(Buffer** out, size_t max) noexcept {
+    const size_t currentWrite = mWriteIndex.load(std::memory_order_acquire);
+
+    const size_t currentRead = mReadIndex.load(std::memory_order_relaxed);
+
+    const size_t buffers = getAvailableBuffers(currentWrite, currentRead);
+
+    const size_t popped = std::min(max, buffers);
+    if(popped == 0){
+        return 0;
+    }
+
+    for(size_t i = 0; i < popped; ++i){
+        out[i] = mQueue[(currentRead + i) & mMask];
+    }
+
+    mReadIndex.store((currentRead + popped) & mMask, std::memory_order_release);
+
+    if(buffers == mQueueSize){
+        mFullFlag.store(false, std::memory_order_release);
+    }
+
+    return popped;
 }
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "core/elastic_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+AJ::utils::ElasticBufferPool::ElasticBufferPool(AJ::error::IErrorHandler& handler,
+    const std::vector<SizeClass>& classes, size_t budget, bool background) : mBudget(budget) {
+
+    if(classes.empty()){
+        const std::string message = "Error: an elastic buffer pool needs at least one size class.\n";
+        handler.onError(AJ::error::Error::InvalidConfiguration, message);
+        return;
+    }
+
+    std::vector<SizeClass> sorted = classes;
+    std::sort(sorted.begin(), sorted.end(), [](const SizeClass &a, const SizeClass &b){
+        return a.frames * a.channels < b.frames * b.channels;
+    });
+
+    size_t initial_bytes = 0;
+
+    for(size_t c = 0; c < sorted.size(); ++c){
+        const SizeClass &spec = sorted[c];
+
+        if(spec.frames == 0 || spec.channels < 1 || spec.channels > 2 || spec.max == 0 ||
+           spec.initial > spec.max || spec.growBy == 0){
+            const std::string message = "Error: invalid size class of " + std::to_string(spec.frames) + " frames.\n";
+            handler.onError(AJ::error::Error::InvalidConfiguration, message);
+            return;
+        }
+
+        //? give() finds the class of a buffer by its size and channels.
+        if(c > 0 && sorted[c - 1].frames == spec.frames && sorted[c - 1].channels == spec.channels){
+            const std::string message = "Error: two size classes of " + std::to_string(spec.frames) + " frames.\n";
+            handler.onError(AJ::error::Error::InvalidConfiguration, message);
+            return;
+        }
+
+        auto cls = std::make_unique<Class>();
+        cls->mSpec = spec;
+        cls->mSamples = spec.frames * spec.channels;
+        cls->mBytes = Buffer::storageBytes(cls->mSamples);
+        cls->pFree = std::make_shared<Queue>(true, spec.max, spec.frames, spec.channels, handler);
+        cls->pReturned = std::make_shared<Queue>(true, spec.max, spec.frames, spec.channels, handler);
+        cls->mOwned.reserve(spec.max);
+
+        if(!cls->pFree->isValid() || !cls->pReturned->isValid()){
+            return;
+        }
+
+        initial_bytes += spec.initial * cls->mBytes;
+        mClasses.push_back(std::move(cls));
+    }
+
+    if(initial_bytes > mBudget){
+        const std::string message = "Error: the initial buffers take " + std::to_string(initial_bytes) +
+            " bytes, over the budget of " + std::to_string(mBudget) + ".\n";
+        handler.onError(AJ::error::Error::InvalidBufferSize, message);
+        return;
+    }
+
+    for(auto &cls : mClasses){
+        if(grow(*cls, cls->mSpec.initial) != cls->mSpec.initial){
+            const std::string message = "Error: can't allocate the initial buffers of an elastic pool.\n";
+            handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+            return;
+        }
+        //* the initial buffers aren't growth.
+        cls->mGrown.store(0, std::memory_order_relaxed);
+    }
+
+    mValid = true;
+
+    if(background){
+        mWorker = std::thread([this](){
+            std::unique_lock<std::mutex> lock(mWorkerMux);
+            while(!mStop){
+                lock.unlock();
+                maintain();
+                lock.lock();
+                mWorkerWake.wait_for(lock, kElasticPoolPeriod, [this](){ return mStop; });
+            }
+        });
+    }
+}
+
+AJ::utils::ElasticBufferPool::~ElasticBufferPool(){
+    if(mWorker.joinable()){
+        {
+            std::lock_guard<std::mutex> lock(mWorkerMux);
+            mStop = true;
+        }
+        mWorkerWake.notify_one();
+        mWorker.join();
+    }
+
+    //* the buffers free themselves, the byte count follows for the accounting of other pools.
+    for(auto &cls : mClasses){
+        mBytes.fetch_sub(cls->mOwned.size() * cls->mBytes, std::memory_order_relaxed);
+        cls->mOwned.clear();
+    }
+}
+
+size_t AJ::utils::ElasticBufferPool::classFor(size_t frames, uint8_t channels) const noexcept {
+    for(size_t c = 0; c < mClasses.size(); ++c){
+        const SizeClass &spec = mClasses[c]->mSpec;
+        if(spec.channels == channels && spec.frames >= frames){
+            return c;
+        }
+    }
+    return mClasses.size();
+}
+
+AJ::utils::Buffer* AJ::utils::ElasticBufferPool::take(size_t cls) noexcept {
+    Class &c = *mClasses[cls];
+    Buffer *buffer = c.pFree->pop();
+
+    if(!buffer){
+        c.mMisses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    c.mTaken.fetch_add(1, std::memory_order_relaxed);
+    return buffer;
+}
+
+bool AJ::utils::ElasticBufferPool::give(Buffer *buffer) noexcept {
+    if(!buffer){
+        return false;
+    }
+
+    for(auto &cls : mClasses){
+        if(cls->mSamples == buffer->size && cls->mSpec.channels == buffer->channels){
+            //? the returned list holds `max` buffers, it can't be full.
+            return cls->pReturned->push(buffer);
+        }
+    }
+
+    return false;
+}
+
+size_t AJ::utils::ElasticBufferPool::grow(Class &cls, size_t count){
+    size_t added = 0;
+
+    for(; added < count; ++added){
+        if(cls.mOwned.size() >= cls.mSpec.max || mBytes.load(std::memory_order_relaxed) + cls.mBytes > mBudget){
+            break;
+        }
+
+        auto buffer = std::make_unique<Buffer>(cls.mSamples, cls.mSpec.channels);
+        if(!buffer->data){
+            break;
+        }
+        std::memset(buffer->data, 0, cls.mBytes);
+
+        cls.pFree->push(buffer.get());
+        cls.mOwned.push_back(std::move(buffer));
+        mBytes.fetch_add(cls.mBytes, std::memory_order_relaxed);
+    }
+
+    cls.mBuffers.store(cls.mOwned.size(), std::memory_order_relaxed);
+    cls.mGrown.fetch_add(added, std::memory_order_relaxed);
+    return added;
+}
+
+void AJ::utils::ElasticBufferPool::release(Class &cls, Buffer *buffer){
+    auto it = std::find_if(cls.mOwned.begin(), cls.mOwned.end(),
+        [buffer](const std::unique_ptr<Buffer> &owned){ return owned.get() == buffer; });
+    if(it == cls.mOwned.end()){
+        return;
+    }
+
+    std::swap(*it, cls.mOwned.back());
+    cls.mOwned.pop_back();
+
+    cls.mBuffers.store(cls.mOwned.size(), std::memory_order_relaxed);
+    cls.mShrunk.fetch_add(1, std::memory_order_relaxed);
+    mBytes.fetch_sub(cls.mBytes, std::memory_order_relaxed);
+}
+
+void AJ::utils::ElasticBufferPool::maintain(){
+    std::lock_guard<std::mutex> lock(mMaintain);
+
+    uint64_t misses = 0, grown = 0, shrunk = 0;
+
+    for(auto &owned : mClasses){
+        Class &cls = *owned;
+        const SizeClass &spec = cls.mSpec;
+
+        const size_t used = inUse(cls);
+        if(used > cls.mPeakInUse.load(std::memory_order_relaxed)){
+            cls.mPeakInUse.store(used, std::memory_order_relaxed);
+        }
+
+        const uint64_t class_misses = cls.mMisses.load(std::memory_order_relaxed);
+        const bool missed = class_misses != cls.mReportedMisses;
+        misses += class_misses - cls.mReportedMisses;
+        cls.mReportedMisses = class_misses;
+
+        const size_t free = cls.pFree->currentSize() + cls.pReturned->currentSize();
+        cls.mIdlePasses = !missed && free >= spec.lowWatermark + spec.growBy ? cls.mIdlePasses + 1 : 0;
+
+        //* idle long enough: what comes back above the watermark margin is freed, down to `initial`.
+        size_t excess = 0;
+        if(cls.mIdlePasses >= kElasticPoolIdlePasses){
+            excess = std::min(cls.mOwned.size() - std::min(cls.mOwned.size(), spec.initial),
+                              free - (spec.lowWatermark + spec.growBy));
+        }
+
+        while(Buffer *buffer = cls.pReturned->pop()){
+            if(excess > 0){
+                release(cls, buffer);
+                --excess;
+                ++shrunk;
+            } else {
+                cls.pFree->push(buffer);
+            }
+        }
+
+        //? the recycled buffers may refill the list, a miss since the last pass still asks for more.
+        if(missed || cls.pFree->currentSize() < spec.lowWatermark){
+            const size_t added = grow(cls, spec.growBy);
+            grown += added;
+            if(added < spec.growBy){
+                cls.mCapped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    if(pMetrics){
+        if(misses) pMetrics->add(Counter::ElasticMisses, misses);
+        if(grown) pMetrics->add(Counter::ElasticGrowths, grown);
+        if(shrunk) pMetrics->add(Counter::ElasticShrinks, shrunk);
+        pMetrics->raise(Peak::ElasticBytes, mBytes.load(std::memory_order_relaxed));
+    }
+}
+
+size_t AJ::utils::ElasticBufferPool::trim(size_t cls){
+    std::lock_guard<std::mutex> lock(mMaintain);
+    Class &c = *mClasses[cls];
+
+    //* the given back buffers first, then the free list itself: nobody takes meanwhile.
+    while(Buffer *buffer = c.pReturned->pop()){
+        c.pFree->push(buffer);
+    }
+
+    size_t freed = 0;
+    while(c.mOwned.size() > c.mSpec.initial){
+        Buffer *buffer = c.pFree->pop();
+        if(!buffer){
+            break;
+        }
+        release(c, buffer);
+        ++freed;
+    }
+
+    if(pMetrics && freed){
+        pMetrics->add(Counter::ElasticShrinks, freed);
+    }
+
+    return freed;
+}
+
+AJ::utils::SizeClassStats AJ::utils::ElasticBufferPool::stats(size_t cls) const noexcept {
+    Class &c = *mClasses[cls];
+
+    SizeClassStats stats;
+    stats.buffers = c.mBuffers.load(std::memory_order_relaxed);
+    stats.free = c.pFree->currentSize() + c.pReturned->currentSize();
+    stats.peakInUse = c.mPeakInUse.load(std::memory_order_relaxed);
+    stats.taken = c.mTaken.load(std::memory_order_relaxed);
+    stats.misses = c.mMisses.load(std::memory_order_relaxed);
+    stats.grown = c.mGrown.load(std::memory_order_relaxed);
+    stats.shrunk = c.mShrunk.load(std::memory_order_relaxed);
+    stats.capped = c.mCapped.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,200 @@
+#include "core/error_channel.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+size_t slot(AJ::error::Error code) noexcept {
+    const size_t value = static_cast<size_t>(code);
+    return value < AJ::kErrorCodeSlots ? value : AJ::kErrorCodeSlots - 1;
+}
+
+int64_t nowNs() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+AJ::error::ErrorChannel::ErrorChannel(IErrorHandler &sink, size_t capacity, uint32_t burst) :
+    mSink(sink), mBurst(burst) {
+
+    size_t size = 2;
+    while(size < capacity){
+        size <<= 1;
+    }
+
+    mMask = size - 1;
+    pCells.reset(new Cell[size]);
+    for(size_t i = 0; i < size; ++i){
+        pCells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    pCodes = std::make_unique<std::array<CodeState, kErrorCodeSlots>>();
+}
+
+AJ::error::ErrorChannel::~ErrorChannel(){
+    stop();
+    drain();
+}
+
+bool AJ::error::ErrorChannel::admit(Error code) noexcept {
+    CodeState &state = (*pCodes)[slot(code)];
+    state.count.fetch_add(1, std::memory_order_relaxed);
+
+    //? a new window: the first thread to see it resets the count, the others just add to it.
+    const int64_t now = nowNs();
+    int64_t window = state.window.load(std::memory_order_relaxed);
+    const int64_t length = std::chrono::duration_cast<std::chrono::nanoseconds>(kErrorChannelWindow).count();
+
+    if(now - window >= length && state.window.compare_exchange_strong(window, now, std::memory_order_relaxed)){
+        state.passed.store(0, std::memory_order_relaxed);
+    }
+
+    if(state.passed.fetch_add(1, std::memory_order_relaxed) >= mBurst){
+        state.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+bool AJ::error::ErrorChannel::push(const Event &event, const char *text, size_t length) noexcept {
+    Cell *cell;
+    size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+
+    while(true){
+        cell = &pCells[pos & mMask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+        if(diff == 0){
+            if(mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+        } else if(diff < 0){
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->event = event;
+    cell->hasText = text != nullptr;
+    if(text){
+        std::memcpy(cell->text, text, length);
+        cell->text[length] = '\0';
+    }
+
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void AJ::error::ErrorChannel::onError(Error err, const std::string &errorMessage){
+    if(!admit(err)){
+        return;
+    }
+
+    Event event;
+    event.code = err;
+    push(event, errorMessage.data(), std::min(errorMessage.size(), kErrorEventTextBytes - 1));
+}
+
+void AJ::error::ErrorChannel::onEvent(const Event &event){
+    if(!admit(event.code)){
+        return;
+    }
+
+    push(event, nullptr, 0);
+}
+
+void AJ::error::ErrorChannel::start(){
+    std::lock_guard<std::mutex> lock(mMux);
+    if(mReporter.joinable()){
+        return;
+    }
+
+    mStop = false;
+    mReporter = std::thread([this](){
+        std::unique_lock<std::mutex> lock(mMux);
+        while(!mStop){
+            mWake.wait_for(lock, kErrorChannelPeriod);
+
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    });
+}
+
+void AJ::error::ErrorChannel::stop(){
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        if(!mReporter.joinable()){
+            return;
+        }
+        mStop = true;
+    }
+    mWake.notify_one();
+    mReporter.join();
+
+    drain();
+}
+
+size_t AJ::error::ErrorChannel::drain(){
+    std::lock_guard<std::mutex> lock(mDrainMux);
+    size_t handed = 0;
+
+    //* only this thread consumes (under mDrainMux): take the published cells in order.
+    size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+    while(true){
+        Cell &cell = pCells[pos & mMask];
+        if(cell.sequence.load(std::memory_order_acquire) != pos + 1){
+            break;
+        }
+
+        if(cell.hasText){
+            mSink.onError(cell.event.code, cell.text);
+        } else {
+            mSink.onError(cell.event.code, describe(cell.event));
+        }
+
+        cell.sequence.store(pos + mMask + 1, std::memory_order_release);
+        mDequeuePos.store(++pos, std::memory_order_relaxed);
+        ++handed;
+    }
+
+    for(size_t code = 0; code < kErrorCodeSlots; ++code){
+        CodeState &state = (*pCodes)[code];
+        const uint64_t suppressed = state.suppressed.load(std::memory_order_relaxed);
+        if(suppressed == state.announced){
+            continue;
+        }
+
+        const std::string message = std::to_string(suppressed - state.announced) + " more errors of code "
+            + std::to_string(code) + " suppressed.\n";
+        mSink.onError(static_cast<Error>(code), message);
+        state.announced = suppressed;
+        ++handed;
+    }
+
+    return handed;
+}
+
+uint64_t AJ::error::ErrorChannel::count(Error code) const noexcept {
+    return (*pCodes)[slot(code)].count.load(std::memory_order_relaxed);
+}
+
+uint64_t AJ::error::ErrorChannel::suppressed(Error code) const noexcept {
+    return (*pCodes)[slot(code)].suppressed.load(std::memory_order_relaxed);
+}
+
+uint64_t AJ::error::ErrorChannel::count() const noexcept {
+    uint64_t total = 0;
+    for(const CodeState &state : *pCodes){
+        total += state.count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
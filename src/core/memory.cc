@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "core/memory.h"
+
+namespace {
+
+thread_local AJ::utils::Subsystem gSubsystem = AJ::utils::Subsystem::Other;
+thread_local bool gRealtime = false;
+
+//* header of a tagged block, kBufferAlignment bytes before the data.
+struct TagHeader {
+    size_t bytes;
+    AJ::utils::Subsystem subsystem;
+};
+
+static_assert(sizeof(TagHeader) <= AJ::kBufferAlignment, "the header must fit its alignment");
+
+uint64_t steadyNow() noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}
+
+const char* AJ::utils::subsystemName(Subsystem subsystem) noexcept {
+    switch(subsystem){
+    case Subsystem::Other: return "other";
+    case Subsystem::FileIO: return "file_io";
+    case Subsystem::Dsp: return "dsp";
+    case Subsystem::Editing: return "editing";
+    case Subsystem::Pools: return "pools";
+    default: return "unknown";
+    }
+}
+
+uint64_t AJ::utils::MemorySnapshot::current() const noexcept {
+    uint64_t total = 0;
+    for(const SubsystemMemory &memory : subsystems){
+        total += memory.current;
+    }
+    return total;
+}
+
+double AJ::utils::MemorySnapshot::allocationRate(const MemorySnapshot &earlier, Subsystem subsystem) const noexcept {
+    if(time <= earlier.time){
+        return 0.0;
+    }
+
+    const uint64_t allocations = (*this)[subsystem].allocations - earlier[subsystem].allocations;
+    return static_cast<double>(allocations) * 1e9 / static_cast<double>(time - earlier.time);
+}
+
+void* AJ::utils::SystemAllocator::allocate(size_t bytes, size_t alignment, Subsystem) noexcept {
+    return std::aligned_alloc(alignment, bytes);
+}
+
+void AJ::utils::SystemAllocator::deallocate(void *data, size_t, size_t, Subsystem) noexcept {
+    std::free(data);
+}
+
+void* AJ::utils::TrackingAllocator::allocate(size_t bytes, size_t alignment, Subsystem subsystem) noexcept {
+    void *data = mUpstream.allocate(bytes, alignment, subsystem);
+    if(data){
+        noteAcquired(bytes, subsystem);
+    }
+    return data;
+}
+
+void AJ::utils::TrackingAllocator::deallocate(void *data, size_t bytes, size_t alignment, Subsystem subsystem) noexcept {
+    if(!data){
+        return;
+    }
+
+    noteReleased(bytes, subsystem);
+    mUpstream.deallocate(data, bytes, alignment, subsystem);
+}
+
+void AJ::utils::TrackingAllocator::noteAcquired(size_t bytes, Subsystem subsystem) noexcept {
+    Counters &counters = mCounters[static_cast<size_t>(subsystem)];
+
+    const uint64_t current = counters.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t peak = counters.peak.load(std::memory_order_relaxed);
+    while(current > peak && !counters.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)){}
+
+    if(gRealtime){
+        noteRealtimeAllocation();
+    }
+}
+
+void AJ::utils::TrackingAllocator::noteReleased(size_t bytes, Subsystem subsystem) noexcept {
+    Counters &counters = mCounters[static_cast<size_t>(subsystem)];
+    counters.current.fetch_sub(bytes, std::memory_order_relaxed);
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+AJ::utils::MemorySnapshot AJ::utils::TrackingAllocator::snapshot() const noexcept {
+    MemorySnapshot snapshot;
+
+    for(size_t s = 0; s < mCounters.size(); ++s){
+        const Counters &counters = mCounters[s];
+        SubsystemMemory &memory = snapshot.subsystems[s];
+
+        memory.current = counters.current.load(std::memory_order_relaxed);
+        memory.peak = std::max(memory.current, counters.peak.load(std::memory_order_relaxed));
+        memory.allocations = counters.allocations.load(std::memory_order_relaxed);
+        memory.frees = counters.frees.load(std::memory_order_relaxed);
+    }
+
+    snapshot.realtimeAllocations = mRealtimeAllocations.load(std::memory_order_relaxed);
+    snapshot.time = steadyNow();
+    return snapshot;
+}
+
+void AJ::utils::TrackingAllocator::resetPeaks() noexcept {
+    for(Counters &counters : mCounters){
+        counters.peak.store(counters.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+AJ::utils::TrackingAllocator& AJ::utils::engineAllocator() noexcept {
+    //? never destroyed: static objects may free engine memory after main returns. Placement new
+    //? in static storage, the allocator must not need the heap it accounts.
+    alignas(SystemAllocator) static unsigned char systemStorage[sizeof(SystemAllocator)];
+    alignas(TrackingAllocator) static unsigned char trackingStorage[sizeof(TrackingAllocator)];
+
+    static TrackingAllocator *tracking =
+        ::new(static_cast<void*>(trackingStorage)) TrackingAllocator(*::new(static_cast<void*>(systemStorage)) SystemAllocator());
+    return *tracking;
+}
+
+AJ::utils::Subsystem AJ::utils::currentSubsystem() noexcept {
+    return gSubsystem;
+}
+
+bool AJ::utils::inRealtimeScope() noexcept {
+    return gRealtime;
+}
+
+void* AJ::utils::allocateTagged(size_t bytes) noexcept {
+    if(bytes > static_cast<size_t>(-1) - 2 * kBufferAlignment){
+        return nullptr;
+    }
+
+    const size_t total = ((bytes + kBufferAlignment - 1) & ~(kBufferAlignment - 1)) + kBufferAlignment;
+    const Subsystem subsystem = gSubsystem;
+
+    auto *block = static_cast<unsigned char*>(engineAllocator().allocate(total, kBufferAlignment, subsystem));
+    if(!block){
+        return nullptr;
+    }
+
+    ::new(static_cast<void*>(block)) TagHeader{ total, subsystem };
+    return block + kBufferAlignment;
+}
+
+void AJ::utils::deallocateTagged(void *data) noexcept {
+    if(!data){
+        return;
+    }
+
+    auto *block = static_cast<unsigned char*>(data) - kBufferAlignment;
+    const TagHeader header = *reinterpret_cast<const TagHeader*>(block);
+    engineAllocator().deallocate(block, header.bytes, kBufferAlignment, header.subsystem);
+}
+
+AJ::utils::MemoryScope::MemoryScope(Subsystem subsystem) noexcept : mPrevious(gSubsystem) {
+    gSubsystem = subsystem;
+}
+
+AJ::utils::MemoryScope::~MemoryScope(){
+    gSubsystem = mPrevious;
+}
+
+AJ::utils::RealtimeScope::RealtimeScope() noexcept : mPrevious(gRealtime) {
+    gRealtime = true;
+}
+
+AJ::utils::RealtimeScope::~RealtimeScope(){
+    gRealtime = mPrevious;
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+#include "core/metrics.h"
+
+size_t AJ::utils::LatencySummary::bucket(uint64_t ns) noexcept {
+    if(ns < kMetricSubBuckets){
+        return static_cast<size_t>(ns);
+    }
+
+    const size_t exponent = 63 - __builtin_clzll(ns);
+    if(exponent >= kMetricMaxExponent){
+        return kBuckets - 1;
+    }
+
+    //* kMetricSubBuckets (8) per power of two: the 3 bits under the leading one.
+    return (exponent - 2) * kMetricSubBuckets + ((ns >> (exponent - 3)) & (kMetricSubBuckets - 1));
+}
+
+uint64_t AJ::utils::LatencySummary::lowest(size_t index) noexcept {
+    if(index < kMetricSubBuckets){
+        return index;
+    }
+
+    const size_t exponent = index / kMetricSubBuckets + 2;
+    return (uint64_t(1) << exponent) | (uint64_t(index % kMetricSubBuckets) << (exponent - 3));
+}
+
+uint64_t AJ::utils::LatencySummary::percentile(double p) const noexcept {
+    if(count == 0){
+        return 0;
+    }
+
+    const uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(count));
+    uint64_t seen = 0;
+
+    for(size_t i = 0; i < kBuckets; ++i){
+        seen += buckets[i];
+        if(seen > rank){
+            //? the bucket of the maximum is only known up to the maximum itself.
+            return std::min(lowest(i), max);
+        }
+    }
+
+    return max;
+}
+
+void AJ::utils::LatencyHistogram::mergeInto(LatencySummary &summary) const noexcept {
+    for(size_t b = 0; b < LatencySummary::kBuckets; ++b){
+        summary.buckets[b] += mBuckets[b].load(std::memory_order_relaxed);
+    }
+    summary.count += mCount.load(std::memory_order_relaxed);
+    summary.sum += mSum.load(std::memory_order_relaxed);
+    summary.max = std::max(summary.max, mMax.load(std::memory_order_relaxed));
+}
+
+void AJ::utils::LatencyHistogram::reset() noexcept {
+    for(auto &bucket : mBuckets){
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    mCount.store(0, std::memory_order_relaxed);
+    mSum.store(0, std::memory_order_relaxed);
+    mMax.store(0, std::memory_order_relaxed);
+}
+
+size_t AJ::utils::MetricsRegistry::shardIndex() noexcept {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return index;
+}
+
+AJ::utils::MetricsSnapshot AJ::utils::MetricsRegistry::snapshot() const noexcept {
+    MetricsSnapshot snapshot;
+
+    for(size_t s = 0; s < kMetricShards; ++s){
+        const Shard &shard = pShards[s];
+
+        for(size_t c = 0; c < snapshot.counters.size(); ++c){
+            snapshot.counters[c] += shard.counters[c].load(std::memory_order_relaxed);
+        }
+
+        for(size_t p = 0; p < snapshot.peaks.size(); ++p){
+            snapshot.peaks[p] = std::max(snapshot.peaks[p], shard.peaks[p].load(std::memory_order_relaxed));
+        }
+
+        for(size_t l = 0; l < snapshot.latencies.size(); ++l){
+            shard.latencies[l].mergeInto(snapshot.latencies[l]);
+        }
+    }
+
+    return snapshot;
+}
+
+void AJ::utils::MetricsRegistry::reset() noexcept {
+    for(size_t s = 0; s < kMetricShards; ++s){
+        Shard &shard = pShards[s];
+
+        for(auto &counter : shard.counters){
+            counter.store(0, std::memory_order_relaxed);
+        }
+        for(auto &peak : shard.peaks){
+            peak.store(0, std::memory_order_relaxed);
+        }
+        for(LatencyHistogram &histogram : shard.latencies){
+            histogram.reset();
+        }
+    }
+}
+
+const char* AJ::utils::metricName(Counter counter) noexcept {
+    switch(counter){
+    case Counter::RecordedBlocks: return "recorded_blocks";
+    case Counter::DroppedBlocks: return "dropped_blocks";
+    case Counter::PoolExhausted: return "pool_exhausted";
+    case Counter::BlocksWritten: return "blocks_written";
+    case Counter::BytesWritten: return "bytes_written";
+    case Counter::FramesPlayed: return "frames_played";
+    case Counter::Underruns: return "underruns";
+    case Counter::EffectRuns: return "effect_runs";
+    case Counter::EffectFailures: return "effect_failures";
+    case Counter::InputOverflows: return "input_overflows";
+    case Counter::InputUnderflows: return "input_underflows";
+    case Counter::DeadlineMisses: return "deadline_misses";
+    case Counter::MonitorFailures: return "monitor_failures";
+    case Counter::ElasticMisses: return "elastic_pool_misses";
+    case Counter::ElasticGrowths: return "elastic_pool_growths";
+    case Counter::ElasticShrinks: return "elastic_pool_shrinks";
+    default: return "unknown";
+    }
+}
+
+const char* AJ::utils::metricName(Peak peak) noexcept {
+    switch(peak){
+    case Peak::QueueDepth: return "max_queue_depth";
+    case Peak::CallbackLoad: return "max_callback_load_permille";
+    case Peak::ElasticBytes: return "max_elastic_pool_bytes";
+    default: return "unknown";
+    }
+}
+
+const char* AJ::utils::metricName(Latency latency) noexcept {
+    switch(latency){
+    case Latency::RecordCallback: return "record_callback";
+    case Latency::PlayCallback: return "play_callback";
+    case Latency::BlockWrite: return "block_write";
+    case Latency::Effect: return "effect";
+    case Latency::MonitorChain: return "monitor_chain";
+    default: return "unknown";
+    }
+}
+
+std::string AJ::utils::MetricsSnapshot::prometheus() const {
+    std::ostringstream out;
+
+    for(size_t c = 0; c < counters.size(); ++c){
+        const std::string name = std::string("aj_") + metricName(static_cast<Counter>(c)) + "_total";
+        out << "# TYPE " << name << " counter\n" << name << " " << counters[c] << "\n";
+    }
+
+    for(size_t p = 0; p < peaks.size(); ++p){
+        const std::string name = std::string("aj_") + metricName(static_cast<Peak>(p));
+        out << "# TYPE " << name << " gauge\n" << name << " " << peaks[p] << "\n";
+    }
+
+    out << "# TYPE aj_queue_depth gauge\naj_queue_depth " << queueDepth << "\n";
+    out << "# TYPE aj_pool_available gauge\naj_pool_available " << poolAvailable << "\n";
+
+    for(size_t l = 0; l < latencies.size(); ++l){
+        const LatencySummary &summary = latencies[l];
+        const std::string name = std::string("aj_") + metricName(static_cast<Latency>(l)) + "_seconds";
+
+        out << "# TYPE " << name << " summary\n";
+        const std::pair<const char*, double> quantiles[] = { { "0.5", 0.5 }, { "0.99", 0.99 }, { "0.999", 0.999 } };
+        for(const auto &[label, quantile] : quantiles){
+            out << name << "{quantile=\"" << label << "\"} " << summary.percentile(quantile) * 1e-9 << "\n";
+        }
+        out << name << "_sum " << summary.sum * 1e-9 << "\n";
+        out << name << "_count " << summary.count << "\n";
+    }
+
+    return out.str();
+}
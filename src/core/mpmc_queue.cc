@@ -0,0 +1,107 @@
+#include "core/mpmc_queue.h"
+
+#include <cstdint>
+
+AJ::utils::MPMCQueue::MPMCQueue(bool empty, size_t queue_size, size_t buffer_size, uint8_t channels,
+    AJ::error::IErrorHandler& handler, bool huge_pages, int numa_node){
+
+    if(queue_size == 0 || buffer_size == 0){
+        const std::string message = "Error: invalid buffer size.\n";
+        handler.onError(AJ::error::Error::InvalidBufferSize, message);
+        return;
+    }
+
+    if(channels > 2 || channels < 1){
+        const std::string message = "Error: Unsupported channels number only support mono and stereo.\n";
+        handler.onError(AJ::error::Error::InvalidChannelCount, message);
+        return;
+    }
+
+    mQueueSize = next_power_of_2(queue_size);
+    mMask = mQueueSize - 1;
+    mChannels = channels;
+    mBufferSize = next_power_of_2(buffer_size * channels);
+
+    pCells.reset(new Cell[mQueueSize]);
+    for(size_t i = 0; i < mQueueSize; ++i){
+        pCells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    if(!empty){
+        //* the slab, its alignment, huge pages and NUMA node come from a full-mode Queue.
+        pStorage = std::make_unique<Queue>(false, mQueueSize, buffer_size, channels, handler, huge_pages, numa_node);
+        if(!pStorage->isValid()){
+            pStorage.reset();
+            return;
+        }
+
+        while(Buffer *buffer = pStorage->pop()){
+            push(buffer);
+        }
+    }
+
+    mValid = true;
+}
+
+bool AJ::utils::MPMCQueue::push(Buffer *buffer) noexcept {
+    if(!buffer){
+        return false;
+    }
+
+    Cell *cell;
+    size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+
+    while(true){
+        cell = &pCells[pos & mMask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+        if(diff == 0){
+            //? the cell is free for this lap, claim the position.
+            if(mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+        } else if(diff < 0){
+            //? the consumers haven't freed the cell of the last lap: full.
+            return false;
+        } else {
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->buffer = buffer;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+AJ::utils::Buffer* AJ::utils::MPMCQueue::pop() noexcept {
+    Cell *cell;
+    size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+
+    while(true){
+        cell = &pCells[pos & mMask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+        if(diff == 0){
+            if(mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+        } else if(diff < 0){
+            //? nothing published in this cell yet: empty.
+            return nullptr;
+        } else {
+            pos = mDequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    Buffer *buffer = cell->buffer;
+    cell->sequence.store(pos + mQueueSize, std::memory_order_release);
+    return buffer;
+}
+
+size_t AJ::utils::MPMCQueue::currentSize() const noexcept {
+    const size_t dequeued = mDequeuePos.load(std::memory_order_acquire);
+    const size_t enqueued = mEnqueuePos.load(std::memory_order_acquire);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "core/realtime.h"
+#include "core/memory.h"
+
+#ifdef AJ_REALTIME_GUARD
+#include <cerrno>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<uint64_t> gViolations{0};
+
+#ifdef AJ_REALTIME_GUARD
+
+enum SlotState : uint32_t { Free, Writing, Ready };
+
+//* one violation waiting for a guard, written by the realtime thread that made it.
+struct Slot {
+    std::atomic<uint32_t> state{Free};
+    uint64_t sequence;
+    AJ::utils::RealtimeViolation violation;
+    const char *call;
+    int depth;
+    void *frames[AJ::kRealtimeStackDepth];
+};
+
+Slot gSlots[AJ::kRealtimeViolationSlots];
+std::atomic<uint64_t> gSequence{0};
+std::atomic<uint64_t> gDropped{0};
+std::mutex gDrainMux;           ///< one guard drains at a time.
+
+//? set while a violation is recorded: backtrace() may allocate or lock the first time.
+thread_local bool gRecording = false;
+
+//? frames of check() and of the replaced function, on top of every stack.
+constexpr int kGuardFrames = 2;
+
+#endif
+
+}
+
+const char* AJ::utils::violationName(RealtimeViolation violation) noexcept {
+    switch(violation){
+    case RealtimeViolation::Allocation: return "allocation";
+    case RealtimeViolation::Lock: return "lock";
+    case RealtimeViolation::Blocking: return "blocking call";
+    default: return "unknown";
+    }
+}
+
+uint64_t AJ::utils::RealtimeGuard::violations() noexcept {
+    return gViolations.load(std::memory_order_relaxed);
+}
+
+#ifndef AJ_REALTIME_GUARD
+
+AJ::utils::RealtimeGuard::RealtimeGuard(AJ::error::IErrorHandler&){}
+
+AJ::utils::RealtimeGuard::~RealtimeGuard(){}
+
+void AJ::utils::RealtimeGuard::check(RealtimeViolation, const char*) noexcept {}
+
+void AJ::utils::RealtimeGuard::drain(){}
+
+#else
+
+AJ::utils::RealtimeGuard::RealtimeGuard(AJ::error::IErrorHandler &handler) : mHandler(handler) {
+    //* load the unwinder now, not on the first violation of an audio thread.
+    void *frames[1];
+    backtrace(frames, 1);
+
+    mReporter = std::thread([this](){
+        std::unique_lock<std::mutex> lock(mMux);
+        while(!mStop){
+            mWake.wait_for(lock, kRealtimeReportPeriod);
+
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    });
+}
+
+AJ::utils::RealtimeGuard::~RealtimeGuard(){
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        mStop = true;
+    }
+    mWake.notify_one();
+    mReporter.join();
+
+    drain();
+}
+
+__attribute__((noinline)) void AJ::utils::RealtimeGuard::check(RealtimeViolation violation, const char *call) noexcept {
+    if(!inRealtimeScope() || gRecording){
+        return;
+    }
+
+    gRecording = true;
+    gViolations.fetch_add(1, std::memory_order_relaxed);
+
+    const uint64_t sequence = gSequence.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = gSlots[sequence % kRealtimeViolationSlots];
+
+    uint32_t expected = Free;
+    if(slot.state.compare_exchange_strong(expected, Writing, std::memory_order_acquire, std::memory_order_relaxed)){
+        slot.sequence = sequence;
+        slot.violation = violation;
+        slot.call = call;
+        slot.depth = backtrace(slot.frames, static_cast<int>(kRealtimeStackDepth));
+        slot.state.store(Ready, std::memory_order_release);
+    } else {
+        // still waiting for a guard since the last lap.
+        gDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    gRecording = false;
+}
+
+void AJ::utils::RealtimeGuard::drain(){
+    std::lock_guard<std::mutex> lock(gDrainMux);
+
+    struct Report {
+        uint64_t sequence;
+        RealtimeViolation violation;
+        const char *call;
+        int depth;
+        void *frames[kRealtimeStackDepth];
+    };
+
+    //? slots fill out of order once one is dropped, sort by sequence.
+    std::vector<Report> reports;
+    for(Slot &slot : gSlots){
+        if(slot.state.load(std::memory_order_acquire) != Ready){
+            continue;
+        }
+
+        Report report{ slot.sequence, slot.violation, slot.call, slot.depth, {} };
+        std::copy(slot.frames, slot.frames + slot.depth, report.frames);
+        reports.push_back(report);
+
+        slot.state.store(Free, std::memory_order_release);
+    }
+
+    std::sort(reports.begin(), reports.end(), [](const Report &a, const Report &b){
+        return a.sequence < b.sequence;
+    });
+
+    for(const Report &report : reports){
+        std::string message = "realtime violation: " + std::string(violationName(report.violation)) +
+            " (" + report.call + ") inside a RealtimeScope\n";
+
+        const int skip = std::min(report.depth, kGuardFrames);
+        char **symbols = backtrace_symbols(report.frames + skip, report.depth - skip);
+        for(int f = 0; symbols && f < report.depth - skip; ++f){
+            message += "  #" + std::to_string(f) + " " + symbols[f] + "\n";
+        }
+        std::free(symbols);
+
+        mHandler.onError(AJ::error::Error::RealtimeViolation, message);
+    }
+
+    const uint64_t dropped = gDropped.exchange(0, std::memory_order_relaxed);
+    if(dropped){
+        const std::string message = "realtime violation: " + std::to_string(dropped) +
+            " more violations were not recorded, the ring was full\n";
+        mHandler.onError(AJ::error::Error::RealtimeViolation, message);
+    }
+}
+
+//* the replaced functions: check the calling thread, then do the real call.
+namespace {
+
+void* next(std::atomic<void*> &cache, const char *name, const char *version = nullptr) noexcept {
+    void *symbol = cache.load(std::memory_order_relaxed);
+    if(!symbol){
+        // versioned first: a plain dlsym() can return an old compat version (pthread_cond_*).
+        symbol = version ? dlvsym(RTLD_NEXT, name, version) : nullptr;
+        symbol = symbol ? symbol : dlsym(RTLD_NEXT, name);
+        cache.store(symbol, std::memory_order_relaxed);
+    }
+    return symbol;
+}
+
+#define AJ_NEXT(name, ...) reinterpret_cast<decltype(&::name)>(next(g_##name, #name, ##__VA_ARGS__))
+#define AJ_NEXT_CACHE(name) std::atomic<void*> g_##name{nullptr}
+
+AJ_NEXT_CACHE(pthread_mutex_lock);
+AJ_NEXT_CACHE(pthread_cond_wait);
+AJ_NEXT_CACHE(pthread_cond_timedwait);
+AJ_NEXT_CACHE(pthread_cond_clockwait);
+AJ_NEXT_CACHE(sem_wait);
+AJ_NEXT_CACHE(nanosleep);
+AJ_NEXT_CACHE(clock_nanosleep);
+AJ_NEXT_CACHE(usleep);
+AJ_NEXT_CACHE(read);
+AJ_NEXT_CACHE(write);
+
+using Violation = AJ::utils::RealtimeViolation;
+
+}
+
+//? malloc can't go through dlsym (dlsym allocates), glibc exports its own entry points.
+extern "C" {
+
+void* __libc_malloc(size_t size) noexcept;
+void* __libc_calloc(size_t count, size_t size) noexcept;
+void* __libc_realloc(void *data, size_t size) noexcept;
+void* __libc_memalign(size_t alignment, size_t size) noexcept;
+
+void* malloc(size_t size) noexcept {
+    AJ::utils::RealtimeGuard::check(Violation::Allocation, "malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    AJ::utils::RealtimeGuard::check(Violation::Allocation, "calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void *data, size_t size) noexcept {
+    AJ::utils::RealtimeGuard::check(Violation::Allocation, "realloc");
+    return __libc_realloc(data, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    AJ::utils::RealtimeGuard::check(Violation::Allocation, "aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    AJ::utils::RealtimeGuard::check(Violation::Allocation, "memalign");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size) noexcept {
+    AJ::utils::RealtimeGuard::check(Violation::Allocation, "posix_memalign");
+
+    if(alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0){
+        return EINVAL;
+    }
+
+    void *data = __libc_memalign(alignment, size);
+    if(!data){
+        return ENOMEM;
+    }
+
+    *out = data;
+    return 0;
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) noexcept {
+    AJ::utils::RealtimeGuard::check(Violation::Lock, "pthread_mutex_lock");
+    return AJ_NEXT(pthread_mutex_lock)(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex){
+    AJ::utils::RealtimeGuard::check(Violation::Blocking, "pthread_cond_wait");
+    return AJ_NEXT(pthread_cond_wait, "GLIBC_2.3.2")(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *time){
+    AJ::utils::RealtimeGuard::check(Violation::Blocking, "pthread_cond_timedwait");
+    return AJ_NEXT(pthread_cond_timedwait, "GLIBC_2.3.2")(cond, mutex, time);
+}
+
+int pthread_cond_clockwait(pthread_cond_t *cond, pthread_mutex_t *mutex, clockid_t clock, const struct timespec *time){
+    AJ::utils::RealtimeGuard::check(Violation::Blocking, "pthread_cond_clockwait");
+    return AJ_NEXT(pthread_cond_clockwait)(cond, mutex, clock, time);
+}
+
+int sem_wait(sem_t *semaphore){
+    AJ::utils::RealtimeGuard::check(Violation::Blocking, "sem_wait");
+    return AJ_NEXT(sem_wait)(semaphore);
+}
+
+int nanosleep(const struct timespec *duration, struct timespec *remaining){
+    AJ::utils::RealtimeGuard::check(Violation::Blocking, "nanosleep");
+    return AJ_NEXT(nanosleep)(duration, remaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec *time, struct timespec *remaining){
+    AJ::utils::RealtimeGuard::check(Violation::Blocking, "clock_nanosleep");
+    return AJ_NEXT(clock_nanosleep)(clock, flags, time, remaining);
+}
+
+int usleep(useconds_t duration){
+    AJ::utils::RealtimeGuard::check(Violation::Blocking, "usleep");
+    return AJ_NEXT(usleep)(duration);
+}
+
+ssize_t read(int fd, void *data, size_t bytes){
+    AJ::utils::RealtimeGuard::check(Violation::Blocking, "read");
+    return AJ_NEXT(read)(fd, data, bytes);
+}
+
+ssize_t write(int fd, const void *data, size_t bytes){
+    AJ::utils::RealtimeGuard::check(Violation::Blocking, "write");
+    return AJ_NEXT(write)(fd, data, bytes);
+}
+
+}
+
+#endif
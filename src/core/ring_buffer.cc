@@ -1,4 +1,92 @@
 #include "core/ring_buffer.h"
+#include "core/memory.h"
+
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+bool AJ::utils::RingBuffer::allocBuffer(bool mirrored) noexcept {
+    mMirrored = false;
+
+#if defined(__linux__)
+    if(mirrored){
+        //* both mappings must be whole pages, grow the ring to at least a page (sizes are powers of 2).
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t bytes = std::max(mSize * sizeof(float), page);
+
+        int fd = memfd_create("aj_ring_buffer", MFD_CLOEXEC);
+
+        if(fd != -1 && ftruncate(fd, bytes) == 0){
+            //? reserve 2x the address space, then map the same pages in both halves.
+            void *base = mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if(base != MAP_FAILED){
+                char *address = static_cast<char *>(base);
+
+                bool mapped = 
+                    mmap(address, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+                    mmap(address + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+
+                if(mapped){
+                    close(fd);
+
+                    //* the file pages are zero filled.
+                    mBuffer = reinterpret_cast<float *>(address);
+                    mSize = bytes / sizeof(float);
+                    mMask = mSize - 1;
+                    mMirrored = true;
+
+                    //* the pages are mapped twice but exist once.
+                    engineAllocator().noteAcquired(bytes, Subsystem::Pools);
+                    return true;
+                }
+
+                munmap(base, 2 * bytes);
+            }
+        }
+
+        //? fallback to a regular buffer.
+        if(fd != -1){
+            close(fd);
+        }
+    }
+#endif
+
+    mBuffer = static_cast<float *>(
+        engineAllocator().allocate(mSize * sizeof(float), 32, Subsystem::Pools) //? 32 alognment for SIMD operations.
+    );
+
+    if(!mBuffer){
+        return false;
+    }
+
+    //* init the buffer with 0 values.
+    std::memset(mBuffer, 0, sizeof(float) * mSize);
+    return true;
+}
+
+void AJ::utils::RingBuffer::freeBuffer() noexcept {
+    if(!mBuffer){
+        return;
+    }
+
+#if defined(__linux__)
+    if(mMirrored){
+        munmap(mBuffer, 2 * mSize * sizeof(float));
+        engineAllocator().noteReleased(mSize * sizeof(float), Subsystem::Pools);
+    } else {
+        engineAllocator().deallocate(mBuffer, mSize * sizeof(float), 32, Subsystem::Pools);
+    }
+#else
+    engineAllocator().deallocate(mBuffer, mSize * sizeof(float), 32, Subsystem::Pools);
+#endif
+
+    mBuffer = nullptr;
+    mMirrored = false;
+}
 
 bool AJ::utils::RingBuffer::writeFrame(const float *samples) noexcept {
     if(!samples){
@@ -194,3 +282,53 @@ size_t AJ::utils::RingBuffer::readFrames(float *output, const size_t frames_coun
     read_frames /= mChannels;
     return read_frames;
 }
+
+AJ::utils::RingRegion AJ::utils::RingBuffer::acquireWrite(size_t frames) noexcept {
+    size_t currentWrite = mWriteIndex.load(std::memory_order_relaxed);
+
+    size_t samples = std::min(getWriteSpace(currentWrite), frames * mChannels);
+
+    return region(currentWrite, samples);
+}
+
+void AJ::utils::RingBuffer::commitWrite(size_t frames) noexcept {
+    if(frames == 0) return;
+
+    size_t currentWrite = mWriteIndex.load(std::memory_order_relaxed);
+
+    //* the reader only frees space, the acquired region is still free.
+    size_t space = getWriteSpace(currentWrite);
+    size_t samples = std::min(space, frames * mChannels);
+
+    mWriteIndex.store((currentWrite + samples) & mMask, std::memory_order_release);
+
+    if(samples == space){
+        mFullFlag.store(true, std::memory_order_release);
+    }
+}
+
+AJ::utils::RingRegion AJ::utils::RingBuffer::acquireRead(size_t frames) noexcept {
+    size_t currentWrite = mWriteIndex.load(std::memory_order_acquire);
+    size_t currentRead = mReadIndex.load(std::memory_order_relaxed);
+
+    size_t samples = std::min(getReadAvailable(currentWrite, currentRead), frames * mChannels);
+
+    return region(currentRead, samples);
+}
+
+void AJ::utils::RingBuffer::commitRead(size_t frames) noexcept {
+    if(frames == 0) return;
+
+    size_t currentWrite = mWriteIndex.load(std::memory_order_acquire);
+    size_t currentRead = mReadIndex.load(std::memory_order_relaxed);
+
+    size_t available_samples = getReadAvailable(currentWrite, currentRead);
+    size_t samples = std::min(available_samples, frames * mChannels);
+
+    mReadIndex.store((currentRead + samples) & mMask, std::memory_order_release);
+
+    //* update the full flag only if it was full before the read (same as readFrames).
+    if(available_samples == mSize){
+        mFullFlag.store(false, std::memory_order_release);
+    }
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "core/scratch_arena.h"
+
+AJ::utils::ScratchArena::~ScratchArena(){
+    release();
+}
+
+void* AJ::utils::ScratchArena::allocate(size_t bytes, size_t alignment) noexcept {
+    bytes = std::max<size_t>(bytes, 1);
+
+    //* carve the current block, then the following ones (kept by an earlier rewind).
+    for(; mBlock < mBlocks.size(); ++mBlock, mOffset = 0){
+        const Block &block = mBlocks[mBlock];
+        const size_t start = (mOffset + alignment - 1) & ~(alignment - 1);
+
+        if(start <= block.size && bytes <= block.size - start){
+            mOffset = start + bytes;
+            return block.data + start;
+        }
+    }
+
+    if(bytes > static_cast<size_t>(-1) - kBufferAlignment){
+        return nullptr;
+    }
+
+    size_t size = std::max(mBlockBytes, bytes);
+    size = (size + kBufferAlignment - 1) & ~(kBufferAlignment - 1);
+
+    const Subsystem subsystem = currentSubsystem();
+    auto *data = static_cast<unsigned char*>(engineAllocator().allocate(size, kBufferAlignment, subsystem));
+    if(!data){
+        mBlock = mBlocks.empty() ? 0 : mBlocks.size() - 1;
+        mOffset = mBlocks.empty() ? 0 : mBlocks.back().size;
+        return nullptr;
+    }
+
+    ++mBlockAllocations;
+    mBlocks.push_back(Block{ data, size, subsystem });
+    mBlock = mBlocks.size() - 1;
+    mOffset = bytes;
+    return data;
+}
+
+void AJ::utils::ScratchArena::destroyUntil(Destructor *last) noexcept {
+    while(mDestructors && mDestructors != last){
+        Destructor *entry = mDestructors;
+        mDestructors = entry->next;
+        entry->destroy(entry->object);
+    }
+}
+
+void AJ::utils::ScratchArena::rewind(const Marker &marker) noexcept {
+    destroyUntil(static_cast<Destructor*>(marker.destructors));
+    mBlock = marker.block;
+    mOffset = marker.offset;
+}
+
+void AJ::utils::ScratchArena::reset() noexcept {
+    destroyUntil(nullptr);
+    mBlock = 0;
+    mOffset = 0;
+
+    //? one block of the total size: the next run of the same workload fits without growing.
+    if(mBlocks.size() > 1){
+        size_t total = 0;
+        for(const Block &block : mBlocks){
+            total += block.size;
+        }
+
+        const Subsystem subsystem = mBlocks.front().subsystem;
+        auto *data = static_cast<unsigned char*>(engineAllocator().allocate(total, kBufferAlignment, subsystem));
+        if(!data){
+            return; // keep the blocks we have.
+        }
+
+        for(const Block &block : mBlocks){
+            engineAllocator().deallocate(block.data, block.size, kBufferAlignment, block.subsystem);
+        }
+
+        ++mBlockAllocations;
+        mBlocks.assign(1, Block{ data, total, subsystem });
+    }
+}
+
+void AJ::utils::ScratchArena::release() noexcept {
+    destroyUntil(nullptr);
+
+    for(const Block &block : mBlocks){
+        engineAllocator().deallocate(block.data, block.size, kBufferAlignment, block.subsystem);
+    }
+
+    mBlocks.clear();
+    mBlock = 0;
+    mOffset = 0;
+
+    for(Float &channel : mChannels){
+        Float().swap(channel);
+    }
+}
+
+size_t AJ::utils::ScratchArena::used() const noexcept {
+    size_t bytes = 0;
+    for(size_t i = 0; i < mBlock && i < mBlocks.size(); ++i){
+        bytes += mBlocks[i].size;
+    }
+
+    return bytes + mOffset;
+}
+
+size_t AJ::utils::ScratchArena::capacity() const noexcept {
+    size_t bytes = 0;
+    for(const Block &block : mBlocks){
+        bytes += block.size;
+    }
+
+    return bytes;
+}
+
+AJ::utils::ScratchArena*& AJ::utils::ScratchArena::installed() noexcept {
+    static thread_local ScratchArena *arena = nullptr;
+    return arena;
+}
+
+AJ::utils::ScratchArena& AJ::utils::ScratchArena::current() noexcept {
+    if(ScratchArena *arena = installed()){
+        return *arena;
+    }
+
+    static thread_local ScratchArena fallback;
+    return fallback;
+}
+
+AJ::utils::ScratchPool::Lease::Lease(ScratchPool &pool) : mPool(pool), mPrevious(ScratchArena::installed()) {
+    {
+        std::lock_guard<std::mutex> lock(pool.mMux);
+        if(!pool.mIdle.empty()){
+            pArena = std::move(pool.mIdle.back());
+            pool.mIdle.pop_back();
+        }
+    }
+
+    if(!pArena){
+        pArena = std::make_unique<ScratchArena>(pool.mBlockBytes);
+    }
+
+    ScratchArena::installed() = pArena.get();
+}
+
+AJ::utils::ScratchPool::Lease::~Lease(){
+    ScratchArena::installed() = mPrevious;
+    pArena->reset();
+
+    std::lock_guard<std::mutex> lock(mPool.mMux);
+    mPool.mIdle.push_back(std::move(pArena));
+}
+
+size_t AJ::utils::ScratchPool::idle(){
+    std::lock_guard<std::mutex> lock(mMux);
+    return mIdle.size();
+}
+
+void AJ::utils::ScratchPool::trim(){
+    std::lock_guard<std::mutex> lock(mMux);
+    mIdle.clear();
+}
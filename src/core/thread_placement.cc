@@ -0,0 +1,220 @@
+#include "core/thread_placement.h"
+
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <climits>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#endif
+
+namespace {
+
+//* a sysfs cpu / node list: "0-3,8-11".
+std::vector<int> parseList(const std::string &text){
+    std::vector<int> values;
+    size_t pos = 0;
+
+    while(pos < text.size()){
+        size_t end = text.find(',', pos);
+        if(end == std::string::npos){
+            end = text.size();
+        }
+
+        const std::string range = text.substr(pos, end - pos);
+        const size_t dash = range.find('-');
+
+        try {
+            if(dash == std::string::npos){
+                values.push_back(std::stoi(range));
+            } else {
+                const int first = std::stoi(range.substr(0, dash));
+                const int last = std::stoi(range.substr(dash + 1));
+                for(int v = first; v <= last; ++v){
+                    values.push_back(v);
+                }
+            }
+        } catch(...) {
+            //? a blank or malformed entry (trailing newline): skipped.
+        }
+
+        pos = end + 1;
+    }
+
+    return values;
+}
+
+std::vector<int> readList(const std::string &path){
+    std::ifstream file(path);
+    std::string line;
+    if(!file || !std::getline(file, line)){
+        return {};
+    }
+    return parseList(line);
+}
+
+}
+
+int AJ::utils::ThreadPlacement::node() const noexcept {
+    if(numaNode >= 0){
+        return numaNode;
+    }
+    return cores.empty() ? -1 : numaNodeOfCore(cores.front());
+}
+
+#if defined(__linux__)
+
+int AJ::utils::numaNodes() noexcept {
+    try {
+        const std::vector<int> nodes = readList("/sys/devices/system/node/online");
+        return nodes.empty() ? 1 : nodes.back() + 1;
+    } catch(...) {
+        return 1;
+    }
+}
+
+std::vector<int> AJ::utils::numaNodeCores(int node){
+    if(node < 0){
+        return {};
+    }
+    return readList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+}
+
+int AJ::utils::numaNodeOfCore(int core) noexcept {
+    try {
+        const int nodes = numaNodes();
+        for(int node = 0; node < nodes; ++node){
+            for(int cpu : numaNodeCores(node)){
+                if(cpu == core){
+                    return node;
+                }
+            }
+        }
+    } catch(...) {}
+
+    //? no sysfs node entries: a single node machine.
+    return core >= 0 && core < static_cast<int>(sysconf(_SC_NPROCESSORS_CONF)) ? 0 : -1;
+}
+
+bool AJ::utils::placeCurrentThread(const ThreadPlacement &placement, AJ::error::IErrorHandler &handler){
+    bool placed = true;
+
+    const std::vector<int> cores = placement.cores.empty() ? numaNodeCores(placement.numaNode) : placement.cores;
+
+    if(placement.cores.empty() && placement.numaNode >= 0 && cores.empty()){
+        const std::string message = "Error: NUMA node " + std::to_string(placement.numaNode) + " has no cores.\n";
+        handler.onError(AJ::error::Error::InvalidConfiguration, message);
+        placed = false;
+    }
+
+    if(!cores.empty()){
+        cpu_set_t set;
+        CPU_ZERO(&set);
+
+        bool valid = true;
+        for(int core : cores){
+            if(core < 0 || core >= CPU_SETSIZE){
+                valid = false;
+                break;
+            }
+            CPU_SET(core, &set);
+        }
+
+        if(!valid || pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0){
+            const std::string message = "Error: can't pin the thread to cores the host doesn't have.\n";
+            handler.onError(AJ::error::Error::InvalidConfiguration, message);
+            placed = false;
+        }
+    }
+
+    if(placement.priority == ThreadPriority::Realtime){
+        sched_param param{};
+        param.sched_priority = kRealtimeThreadPriority;
+
+        const int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if(result != 0){
+            const std::string message = result == EPERM
+                ? "Error: realtime priority refused, raise the rtprio limit of the user.\n"
+                : "Error: can't set the realtime priority of the thread.\n";
+            handler.onError(AJ::error::Error::InsufficientPermissions, message);
+            placed = false;
+        }
+    } else if(placement.priority == ThreadPriority::High){
+        //? on Linux the nice value is per thread when given its id.
+        const id_t tid = static_cast<id_t>(syscall(SYS_gettid));
+        if(setpriority(PRIO_PROCESS, tid, kHighThreadNice) != 0){
+            const std::string message = "Error: high priority refused, raise the nice limit of the user.\n";
+            handler.onError(AJ::error::Error::InsufficientPermissions, message);
+            placed = false;
+        }
+    } else if(placement.priority == ThreadPriority::Low){
+        const id_t tid = static_cast<id_t>(syscall(SYS_gettid));
+        if(setpriority(PRIO_PROCESS, tid, kLowThreadNice) != 0){
+            const std::string message = "Error: can't lower the priority of the thread.\n";
+            handler.onError(AJ::error::Error::InsufficientPermissions, message);
+            placed = false;
+        }
+    }
+
+    return placed;
+}
+
+bool AJ::utils::bindToNumaNode(void *ptr, size_t bytes, int node) noexcept {
+    if(node < 0){
+        return true;
+    }
+    if(!ptr || bytes == 0){
+        return false;
+    }
+
+    constexpr size_t kBitsPerWord = sizeof(unsigned long) * CHAR_BIT;
+    unsigned long mask[4] = {};
+    if(static_cast<size_t>(node) >= sizeof(mask) * CHAR_BIT){
+        return false;
+    }
+    mask[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+
+    //* mbind works on whole pages.
+    const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) & ~(page - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + bytes + page - 1) & ~(page - 1);
+
+    //? maxnode counts one past the last bit the kernel reads.
+    return syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, mask, sizeof(mask) * CHAR_BIT + 1, 0) == 0;
+}
+
+#else
+
+int AJ::utils::numaNodes() noexcept {
+    return 1;
+}
+
+std::vector<int> AJ::utils::numaNodeCores(int){
+    return {};
+}
+
+int AJ::utils::numaNodeOfCore(int) noexcept {
+    return -1;
+}
+
+bool AJ::utils::placeCurrentThread(const ThreadPlacement &placement, AJ::error::IErrorHandler &handler){
+    if(placement.isDefault()){
+        return true;
+    }
+
+    const std::string message = "Error: thread placement is only supported on Linux.\n";
+    handler.onError(AJ::error::Error::OperationNotAllowed, message);
+    return false;
+}
+
+bool AJ::utils::bindToNumaNode(void*, size_t, int node) noexcept {
+    return node < 0;
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/trace.h"
+
+namespace {
+
+struct Event {
+    const char *category;
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+};
+
+//* the events of one thread, written by it only.
+struct ThreadRing {
+    uint32_t tid;
+    std::unique_ptr<Event[]> events{new Event[AJ::kTraceThreadEvents]};
+    std::atomic<uint64_t> next{0};   ///< events recorded, the ring holds the last kTraceThreadEvents.
+};
+
+std::mutex gMux;
+std::vector<std::shared_ptr<ThreadRing>> gRings;   ///< every ring ever made, kept past its thread.
+std::atomic<uint64_t> gEpoch{0};                   ///< now() at start(), time 0 of the trace.
+
+//? the ring is registered on the first event of the thread, the only lock of a zone.
+ThreadRing& ring() {
+    thread_local std::shared_ptr<ThreadRing> local = [] {
+        auto created = std::make_shared<ThreadRing>();
+        std::lock_guard<std::mutex> lock(gMux);
+        created->tid = static_cast<uint32_t>(gRings.size() + 1);
+        gRings.push_back(created);
+        return created;
+    }();
+    return *local;
+}
+
+}
+
+void AJ::utils::trace::start() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(gMux);
+        for(const auto &ring : gRings){
+            ring->next.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    gEpoch.store(now(), std::memory_order_relaxed);
+    detail::gRecording.store(true, std::memory_order_release);
+}
+
+void AJ::utils::trace::stop() noexcept {
+    detail::gRecording.store(false, std::memory_order_release);
+}
+
+void AJ::utils::trace::record(const char *category, const char *name, uint64_t start, uint64_t end) noexcept {
+    ThreadRing &local = ring();
+    const uint64_t index = local.next.load(std::memory_order_relaxed);
+
+    local.events[index % kTraceThreadEvents] = Event{ category, name, start, end };
+    local.next.store(index + 1, std::memory_order_release);
+}
+
+uint64_t AJ::utils::trace::recorded() noexcept {
+    std::lock_guard<std::mutex> lock(gMux);
+
+    uint64_t total = 0;
+    for(const auto &ring : gRings){
+        total += ring->next.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+uint64_t AJ::utils::trace::overwritten() noexcept {
+    std::lock_guard<std::mutex> lock(gMux);
+
+    uint64_t total = 0;
+    for(const auto &ring : gRings){
+        const uint64_t count = ring->next.load(std::memory_order_acquire);
+        total += count > kTraceThreadEvents ? count - kTraceThreadEvents : 0;
+    }
+    return total;
+}
+
+bool AJ::utils::trace::write(const std::string &path, AJ::error::IErrorHandler &handler){
+    std::ofstream out(path);
+
+    if(!out){
+        const std::string message = "Error: Couldn't create the trace file at: " + path + "\n";
+        handler.onError(AJ::error::Error::FileOpenError, message);
+        return false;
+    }
+
+    const uint64_t epoch = gEpoch.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(gMux);
+
+    //* Chrome trace "complete" events (ph X), timestamps in µs since start().
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    out << std::fixed << std::setprecision(3);
+
+    bool first = true;
+    for(const auto &ring : gRings){
+        const uint64_t count = ring->next.load(std::memory_order_acquire);
+        if(count == 0){
+            continue;
+        }
+
+        out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << ring->tid
+            << ", \"args\": {\"name\": \"thread " << ring->tid << "\"}}";
+        first = false;
+
+        for(uint64_t i = count > kTraceThreadEvents ? count - kTraceThreadEvents : 0; i < count; ++i){
+            const Event &event = ring->events[i % kTraceThreadEvents];
+            const uint64_t start = event.start > epoch ? event.start - epoch : 0;
+
+            out << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+                << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << ring->tid
+                << ", \"ts\": " << start / 1000.0 << ", \"dur\": " << (event.end - event.start) / 1000.0 << "}";
+        }
+    }
+
+    out << "\n]}\n";
+
+    if(!out.flush()){
+        const std::string message = "Error: failed to write the trace file " + path + "\n";
+        handler.onError(AJ::error::Error::FileWriteError, message);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+
+#include "dsp/automation.h"
+#include "dsp/kernels.h"
+#include "core/errors.h"
+
+namespace {
+
+/// @brief Value of a curved segment at `t` in [0, 1].
+double curveValue(const AJ::dsp::Breakpoint &from, const AJ::dsp::Breakpoint &to, double t){
+    const double v0 = from.mValue;
+    const double v1 = to.mValue;
+
+    if(from.mShape == AJ::dsp::CurveShape::Exponential && v0 > 0.0 && v1 > 0.0){
+        return v0 * std::pow(v1 / v0, t);
+    }
+
+    if(from.mShape == AJ::dsp::CurveShape::SCurve){
+        t = t * t * (3.0 - 2.0 * t);
+    }
+
+    return v0 + (v1 - v0) * t;
+}
+
+}
+
+bool AJ::dsp::Automation::add(const Breakpoint &point, AJ::error::IErrorHandler &handler){
+    if(point.mFrame < 0){
+        const std::string message = "invalid automation point, the frame cannot be negative.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    auto it = std::lower_bound(mPoints.begin(), mPoints.end(), point.mFrame,
+        [](const Breakpoint &p, sample_pos frame){ return p.mFrame < frame; });
+
+    if(it != mPoints.end() && it->mFrame == point.mFrame){
+        *it = point;
+    } else {
+        mPoints.insert(it, point);
+    }
+
+    return true;
+}
+
+AJ::dsp::AutomationRun AJ::dsp::Automation::runAt(sample_pos frame, size_t maxFrames) const {
+    //* first point after `frame`, the segment starts at the point before it.
+    auto next = std::upper_bound(mPoints.begin(), mPoints.end(), frame,
+        [](sample_pos f, const Breakpoint &p){ return f < p.mFrame; });
+
+    if(next == mPoints.begin()){
+        const size_t frames = static_cast<size_t>(next->mFrame - frame);
+        return { std::min(frames, maxFrames), next->mValue, 0.0 };
+    }
+
+    const Breakpoint &from = *(next - 1);
+
+    if(next == mPoints.end()){
+        return { maxFrames, from.mValue, 0.0 };
+    }
+
+    const Breakpoint &to = *next;
+    const sample_pos length = to.mFrame - from.mFrame;
+    const size_t left = static_cast<size_t>(to.mFrame - frame);
+
+    switch(from.mShape){
+    case CurveShape::Hold:
+        return { std::min(left, maxFrames), from.mValue, 0.0 };
+
+    case CurveShape::Linear: {
+        const double step = (static_cast<double>(to.mValue) - from.mValue) / length;
+        return { std::min(left, maxFrames), from.mValue + step * (frame - from.mFrame), step };
+    }
+
+    default: {
+        //? exact every kAutomationRampFrames frames of the segment, linear in between.
+        const sample_pos pieceStart = from.mFrame
+            + (frame - from.mFrame) / static_cast<sample_pos>(kAutomationRampFrames) * kAutomationRampFrames;
+        const sample_pos pieceEnd = std::min(pieceStart + static_cast<sample_pos>(kAutomationRampFrames), to.mFrame);
+
+        const double a = curveValue(from, to, static_cast<double>(pieceStart - from.mFrame) / length);
+        const double b = curveValue(from, to, static_cast<double>(pieceEnd - from.mFrame) / length);
+        const double step = (b - a) / (pieceEnd - pieceStart);
+
+        const size_t frames = static_cast<size_t>(pieceEnd - frame);
+        return { std::min(frames, maxFrames), a + step * (frame - pieceStart), step };
+    }
+    }
+}
+
+float AJ::dsp::Automation::valueAt(sample_pos frame) const {
+    return static_cast<float>(runAt(frame, 1).value);
+}
+
+void AJ::dsp::Automation::render(sample_pos start, size_t frames, float *out) const {
+    for(size_t done = 0; done < frames; ){
+        const AutomationRun run = runAt(start + static_cast<sample_pos>(done), frames - done);
+
+        for(size_t i = 0; i < run.frames; ++i){
+            out[done + i] = static_cast<float>(run.value + run.step * i);
+        }
+
+        done += run.frames;
+    }
+}
+
+void AJ::dsp::Automation::applyGain(float *data, size_t count, sample_pos start) const {
+    const kernels::FadeFn fade = kernels::table().fade;
+
+    for(size_t done = 0; done < count; ){
+        const AutomationRun run = runAt(start + static_cast<sample_pos>(done), count - done);
+
+        fade(data + done, run.frames, run.value, run.step);
+        done += run.frames;
+    }
+}
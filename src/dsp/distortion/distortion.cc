@@ -2,6 +2,7 @@
 #include <cmath>
 
 #include "dsp/distortion.h"
+#include "dsp/kernels.h"
 #include "core/types.h"
 #include "core/error_handler.h"
 
@@ -19,6 +20,7 @@ std::shared_ptr<AJ::dsp::distortion::DistortionParams> AJ::dsp::distortion::Dist
 
     distortionParams->setGain(params.mGain);
     distortionParams->setType(params.mType);
+    distortionParams->setPrecision(params.mPrecision);
     distortionParams->setStart(params.mStart);
     distortionParams->setEnd(params.mEnd);
 
@@ -39,16 +41,6 @@ bool AJ::dsp::distortion::Distortion::setParams(std::shared_ptr<EffectParams> pa
 }
 
 bool AJ::dsp::distortion::Distortion::process(Float &buffer, AJ::error::IErrorHandler &handler) {
-    switch (mParams->Type())
-    {
-    case DistortionType::SoftClipping:
-        return softClipping(buffer, handler);
-    default:
-        return false;
-    }
-}
-
-bool AJ::dsp::distortion::Distortion::softClipping(Float &buffer, AJ::error::IErrorHandler &handler) {
     // check valid indexes ranges
     sample_c start = mParams->Start();
     sample_c end = mParams->End();
@@ -59,6 +51,15 @@ bool AJ::dsp::distortion::Distortion::softClipping(Float &buffer, AJ::error::IEr
         return false;
     }
 
+    return shape(buffer.data() + start, end - start + 1, handler);
+}
+
+bool AJ::dsp::distortion::Distortion::processRange(Float &buffer, size_t first, size_t last,
+    AJ::error::IErrorHandler &handler) {
+    return shape(buffer.data() + mParams->Start() + first, last - first, handler);
+}
+
+bool AJ::dsp::distortion::Distortion::shape(float *data, size_t count, AJ::error::IErrorHandler &handler) {
     float gain = mParams->Gain();
 
     if(gain == 0){
@@ -67,12 +68,76 @@ bool AJ::dsp::distortion::Distortion::softClipping(Float &buffer, AJ::error::IEr
         return false;
     }
 
-    float gain_tanh = 1 / std::tanh(gain);
+    kernels::ShapeParams params;
+    params.drive = gain;
+    params.driveNeg = gain;
+
+    switch (mParams->Type())
+    {
+    case DistortionType::SoftClipping:
+        params.curve = kernels::Curve::Tanh;
+        break;
+    case DistortionType::Asymmetric:
+        params.curve = kernels::Curve::Tanh;
+        params.driveNeg = gain * DISTORTION_ASYMMETRIC_DRIVE;
+        break;
+    case DistortionType::HardClipping:
+        params.curve = kernels::Curve::HardClip;
+        break;
+    case DistortionType::Cubic:
+        params.curve = kernels::Curve::Cubic;
+        break;
+    default:
+        return false;
+    }
+
+    const DistortionPrecision precision = mQuality == RenderQuality::Preview
+        ? DistortionPrecision::Fast : mParams->Precision();
+
+    if(params.curve == kernels::Curve::Tanh && precision == DistortionPrecision::Exact){
+        //* y = tanh(g·x) / tanh(g), normalized so a full scale input stays at full scale.
+        const float gain_tanh = 1 / std::tanh(params.drive);
+        const float gain_tanh_neg = 1 / std::tanh(params.driveNeg);
+
+        for(size_t i = 0; i < count; ++i){
+            data[i] = data[i] >= 0.0f ? std::tanh(params.drive * data[i]) * gain_tanh
+                : std::tanh(params.driveNeg * data[i]) * gain_tanh_neg;
+        }
 
-    for(size_t i = mParams->Start(); i <= end; ++i){
-        buffer[i] = std::tanh(gain * buffer[i]) * gain_tanh;
+        return true;
     }
 
+    //? the makeup gains use the same approximation as the kernel, so ±1 still maps to ±1.
+    params.approx = precision == DistortionPrecision::Fast ?
+        kernels::TanhApprox::Fast : kernels::TanhApprox::Accurate;
+    params.makeup = 1 / kernels::tanhApprox(params.drive, params.approx);
+    params.makeupNeg = 1 / kernels::tanhApprox(params.driveNeg, params.approx);
+
+    kernels::table().shape(data, count, params);
     return true;
 }
 
+bool AJ::dsp::distortion::Distortion::processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "distortion effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        //* [first, last) frames are contiguous in the interleaved block.
+        if(!shape(data + first * channels, (last - first) * channels, handler)){
+            return false;
+        }
+    }
+
+    state.advance(frames);
+    return true;
+}
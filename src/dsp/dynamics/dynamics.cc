@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <cmath>
+
+#include "dsp/dynamics/dynamics.h"
+#include "dsp/kernels.h"
+#include "core/errors.h"
+
+namespace {
+
+//* one-pole coefficient reaching 1 - 1/e of a step in `ms`.
+float coefficient(float ms, uint32_t samplerate){
+    return ms > 0.0f ? static_cast<float>(std::exp(-1000.0 / (static_cast<double>(ms) * samplerate))) : 0.0f;
+}
+
+float fromDb(float db){
+    return static_cast<float>(std::pow(10.0, db / 20.0));
+}
+
+bool inRange(float value, float low, float high){
+    return value >= low && value <= high; // NaN fails.
+}
+
+}
+
+AJ::dsp::dynamics::Settings AJ::dsp::dynamics::Settings::from(const Params &params){
+    Settings settings = limiter(params.mSamplerate, params.mCeilingDb, params.mLookaheadMs, params.mReleaseMs);
+
+    settings.mThresholdDb = params.mThresholdDb;
+    settings.mSlope = 1.0f / params.mRatio - 1.0f;
+    settings.mKneeDb = params.mKneeDb;
+    settings.mKneeStart = fromDb(params.mThresholdDb - params.mKneeDb / 2.0f);
+    settings.mMakeup = fromDb(params.mMakeupDb);
+    settings.mAttack = coefficient(params.mAttackMs, params.mSamplerate);
+
+    return settings;
+}
+
+AJ::dsp::dynamics::Settings AJ::dsp::dynamics::Settings::limiter(uint32_t samplerate, float ceilingDb,
+    float lookaheadMs, float releaseMs){
+
+    Settings settings;
+    settings.mRelease = coefficient(releaseMs, samplerate);
+    settings.mCeiling = fromDb(ceilingDb);
+    settings.mLookahead = std::max<size_t>(1, static_cast<size_t>(std::lround(lookaheadMs * samplerate / 1000.0)));
+
+    return settings;
+}
+
+AJ::dsp::dynamics::Processor::Processor(const Settings &settings, size_t channels) :
+    mSettings(settings), mChannels(channels) {
+
+    const size_t window = mSettings.mLookahead + 1;
+
+    mDelay.resize(mSettings.mLookahead * mChannels);
+    mMinValues.resize(window);
+    mMinFrames.resize(window);
+    mHold.resize(window);
+
+    reset();
+}
+
+void AJ::dsp::dynamics::Processor::reset(){
+    std::fill(mDelay.begin(), mDelay.end(), 0.0f);
+    mDelayPos = 0;
+
+    mMinHead = 0;
+    mMinCount = 0;
+
+    //* a window of "no reduction" requests before the first frame.
+    std::fill(mHold.begin(), mHold.end(), 1.0f);
+    mHoldPos = 0;
+    mHoldSum = static_cast<double>(mHold.size());
+
+    mEnvelope = 0.0f;
+    mGain = 1.0f;
+    mFrame = 0;
+}
+
+float AJ::dsp::dynamics::Processor::limit(float request){
+    const size_t window = mHold.size();
+
+    //* monotonic queue: the request leaving the window goes from the front, the ones that can't be
+    //* the minimum any more from the back. At most `window` requests are queued.
+    if(mMinCount > 0 && mMinFrames[mMinHead] + window <= mFrame){
+        mMinHead = (mMinHead + 1) % window;
+        --mMinCount;
+    }
+    while(mMinCount > 0 && mMinValues[(mMinHead + mMinCount - 1) % window] >= request){
+        --mMinCount;
+    }
+    mMinValues[(mMinHead + mMinCount) % window] = request;
+    mMinFrames[(mMinHead + mMinCount) % window] = mFrame;
+    ++mMinCount;
+    ++mFrame;
+
+    //* the running sum is recomputed once per window so it doesn't drift.
+    mHoldSum += static_cast<double>(mMinValues[mMinHead]) - mHold[mHoldPos];
+    mHold[mHoldPos] = mMinValues[mMinHead];
+    if(++mHoldPos == window){
+        mHoldPos = 0;
+        mHoldSum = 0.0;
+        for(float hold : mHold) mHoldSum += hold;
+    }
+
+    //* instant attack (already ramped by the average), exponential release.
+    const float target = static_cast<float>(mHoldSum / window);
+    mGain = target < mGain ? target : target + mSettings.mRelease * (mGain - target);
+
+    return mGain;
+}
+
+void AJ::dsp::dynamics::Processor::process(float *data, size_t frames){
+    alignas(kBufferAlignment) float peaks[kDynamicsChunkFrames];
+    alignas(kBufferAlignment) float gains[kDynamicsChunkFrames];
+
+    const kernels::KernelTable &kernels = kernels::table();
+    const Settings &s = mSettings;
+    const size_t C = mChannels;
+
+    while(frames > 0){
+        const size_t n = std::min(frames, kDynamicsChunkFrames);
+
+        kernels.framePeak(data, n, C, peaks);
+
+        if(s.compresses()){
+            for(size_t f = 0; f < n; ++f){
+                const float level = peaks[f];
+                const float pole = level > mEnvelope ? s.mAttack : s.mRelease;
+                mEnvelope = level + pole * (mEnvelope - level);
+
+                float gain = s.mMakeup;
+                if(mEnvelope > s.mKneeStart){
+                    //* soft knee: quadratic from threshold - knee / 2 to threshold + knee / 2, then the ratio.
+                    const float over = 20.0f * std::log10(mEnvelope) - s.mThresholdDb;
+                    //* (the last test catches log10 rounding right at the knee start, and a hard knee.)
+                    const float reduction = 2.0f * over >= s.mKneeDb ? s.mSlope * over
+                        : 2.0f * over > -s.mKneeDb ? s.mSlope * (over + s.mKneeDb / 2.0f) * (over + s.mKneeDb / 2.0f) / (2.0f * s.mKneeDb)
+                        : 0.0f;
+                    gain *= fromDb(reduction);
+                }
+
+                gains[f] = gain;
+                peaks[f] *= gain;
+            }
+
+            kernels.frameGain(data, n, C, gains);
+        }
+
+        for(size_t f = 0; f < n; ++f){
+            gains[f] = limit(peaks[f] > s.mCeiling ? s.mCeiling / peaks[f] : 1.0f);
+
+            //* the frame waits in the delay line, the one leaving it gets the gain.
+            float *frame = data + f * C;
+            float *slot = &mDelay[mDelayPos * C];
+            for(size_t ch = 0; ch < C; ++ch){
+                std::swap(frame[ch], slot[ch]);
+            }
+            mDelayPos = mDelayPos + 1 == s.mLookahead ? 0 : mDelayPos + 1;
+        }
+
+        kernels.frameGain(data, n, C, gains);
+
+        data += n * C;
+        frames -= n;
+    }
+}
+
+void AJ::dsp::dynamics::Processor::processAligned(float *const *channels, size_t frames, float inputGain){
+    alignas(kBufferAlignment) float chunk[kDynamicsChunkFrames * kNumChannels];
+
+    reset();
+
+    const kernels::KernelTable &kernels = kernels::table();
+    const size_t C = mChannels;
+    const size_t delay = latency();
+    const size_t total = frames + delay;
+
+    //* output frame i of a chunk fed from frame `in` is input frame in + i - delay: it lands behind the reads.
+    for(size_t in = 0; in < total;){
+        const size_t n = std::min(kDynamicsChunkFrames, total - in);
+        const size_t real = in < frames ? std::min(n, frames - in) : 0;
+
+        if(C == 2){
+            kernels.interleave(channels[0] + in, channels[1] + in, chunk, real);
+        } else {
+            std::copy(channels[0] + in, channels[0] + in + real, chunk);
+        }
+        std::fill(chunk + real * C, chunk + n * C, 0.0f);
+        if(inputGain != 1.0f){
+            kernels.scale(chunk, real * C, inputGain);
+        }
+
+        process(chunk, n);
+
+        const size_t skip = in < delay ? std::min(n, delay - in) : 0;
+        const size_t out = in + skip - delay;
+        if(C == 2){
+            kernels.deinterleave(chunk + skip * C, channels[0] + out, channels[1] + out, n - skip);
+        } else {
+            std::copy(chunk + skip, chunk + n, channels[0] + out);
+        }
+
+        in += n;
+    }
+}
+
+std::shared_ptr<AJ::dsp::dynamics::DynamicsParams> AJ::dsp::dynamics::DynamicsParams::create(Params &params,
+    AJ::error::IErrorHandler &handler){
+
+    auto reject = [&](const std::string &message){
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    };
+
+    if(params.mStart > params.mEnd || params.mStart < 0){
+        return reject("invalid range indexes parameters for dynamics effect.\n");
+    }
+
+    if(params.mSamplerate < kMinSamplerate || params.mSamplerate > kMaxSamplerate){
+        return reject("invalid samplerate for dynamics effect, it must be in [" + std::to_string(kMinSamplerate)
+            + ", " + std::to_string(kMaxSamplerate) + "].\n");
+    }
+
+    if(!inRange(params.mThresholdDb, kDynamicsMinThresholdDb, 0.0f) || !inRange(params.mRatio, 1.0f, kDynamicsMaxRatio)
+        || !inRange(params.mKneeDb, 0.0f, kDynamicsMaxKneeDb) || !inRange(params.mMakeupDb, 0.0f, kDynamicsMaxMakeupDb)){
+        return reject("invalid compressor parameters for dynamics effect: threshold in [" + std::to_string(kDynamicsMinThresholdDb)
+            + ", 0] dB, ratio in [1, " + std::to_string(kDynamicsMaxRatio) + "], knee in [0, " + std::to_string(kDynamicsMaxKneeDb)
+            + "] dB and makeup in [0, " + std::to_string(kDynamicsMaxMakeupDb) + "] dB.\n");
+    }
+
+    if(!inRange(params.mAttackMs, 0.0f, kDynamicsMaxAttackMs) || !inRange(params.mReleaseMs, 0.0f, kDynamicsMaxReleaseMs)){
+        return reject("invalid envelope times for dynamics effect: attack in [0, " + std::to_string(kDynamicsMaxAttackMs)
+            + "] ms, release in [0, " + std::to_string(kDynamicsMaxReleaseMs) + "] ms.\n");
+    }
+
+    if(!inRange(params.mCeilingDb, kDynamicsMinCeilingDb, 0.0f) || !(params.mLookaheadMs > 0.0f)
+        || params.mLookaheadMs > kDynamicsMaxLookaheadMs){
+        return reject("invalid limiter parameters for dynamics effect: ceiling in [" + std::to_string(kDynamicsMinCeilingDb)
+            + ", 0] dB, lookahead in (0, " + std::to_string(kDynamicsMaxLookaheadMs) + "] ms.\n");
+    }
+
+    std::shared_ptr<DynamicsParams> dynamicsParams = std::make_shared<DynamicsParams>(PrivateTag{});
+
+    dynamicsParams->mSettings = Settings::from(params);
+    dynamicsParams->setStart(params.mStart);
+    dynamicsParams->setEnd(params.mEnd);
+
+    return dynamicsParams;
+}
+
+bool AJ::dsp::dynamics::Dynamics::setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler){
+    std::shared_ptr<DynamicsParams> dynamicsParams = std::dynamic_pointer_cast<DynamicsParams>(params);
+    // if dynamicsParams is nullptr that means it's not a shared_ptr of DynamicsParams
+    if(!dynamicsParams){
+        const std::string message = "Effect parameters must be of type DynamicsParams for this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    mParams = dynamicsParams;
+    return true;
+}
+
+bool AJ::dsp::dynamics::Dynamics::process(Float &buffer, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "dynamics effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || mParams->End() >= buffer.size()){
+        const std::string message = "invalid indexes for dynamics effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    float *channel = buffer.data() + mParams->Start();
+    Processor processor(mParams->Setup(), 1);
+    processor.processAligned(&channel, mParams->End() - mParams->Start() + 1);
+    return true;
+}
+
+bool AJ::dsp::dynamics::Dynamics::process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "dynamics effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(channels == 0 || channels > audio.size()){
+        const std::string message = "invalid channel count for dynamics effect.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    float *pointers[kNumChannels];
+    for(size_t ch = 0; ch < channels; ++ch){
+        if(mParams->End() < mParams->Start() || mParams->Start() < 0 || mParams->End() >= audio[ch].size()){
+            const std::string message = "invalid indexes for dynamics effect.\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return false;
+        }
+        pointers[ch] = audio[ch].data() + mParams->Start();
+    }
+
+    //* one processor over the channels: every frame is measured on its loudest channel.
+    Processor processor(mParams->Setup(), channels);
+    processor.processAligned(pointers, mParams->End() - mParams->Start() + 1);
+    return true;
+}
+
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::dynamics::Dynamics::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "dynamics effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return nullptr;
+    }
+
+    if(channels < 1 || channels > kNumChannels){
+        const std::string message = "the dynamics effect supports mono and stereo streams.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return nullptr;
+    }
+
+    auto state = std::make_unique<DynamicsState>(channels);
+    state->mProcessor = std::make_unique<Processor>(mParams->Setup(), channels);
+    state->mOwner = mParams;
+
+    return state;
+}
+
+bool AJ::dsp::dynamics::Dynamics::processBlock(float *data, size_t frames, uint8_t channels,
+    EffectState &state, AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "dynamics effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    DynamicsState *dynamicsState = dynamic_cast<DynamicsState*>(&state);
+
+    if(!dynamicsState || dynamicsState->mOwner != mParams){
+        const std::string message = "effect state must be a DynamicsState created with the current parameters.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        dynamicsState->mProcessor->process(data + first * channels, last - first);
+    }
+
+    state.advance(frames);
+    return true;
+}
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cmath>
+
+#include "dsp/dynamics/gate.h"
+#include "dsp/kernels.h"
+#include "core/errors.h"
+
+namespace {
+
+//* one-pole coefficient reaching 1 - 1/e of a step in `ms`.
+float coefficient(float ms, uint32_t samplerate){
+    return ms > 0.0f ? static_cast<float>(std::exp(-1000.0 / (static_cast<double>(ms) * samplerate))) : 0.0f;
+}
+
+float fromDb(float db){
+    return static_cast<float>(std::pow(10.0, db / 20.0));
+}
+
+bool inRange(float value, float low, float high){
+    return value >= low && value <= high; // NaN fails.
+}
+
+}
+
+AJ::dsp::gate::Settings AJ::dsp::gate::Settings::from(const Params &params){
+    Settings settings;
+
+    settings.mOpen = fromDb(params.mThresholdDb);
+    settings.mClose = fromDb(params.mThresholdDb - kGateHysteresisDb);
+    settings.mFloor = fromDb(params.mRangeDb);
+    settings.mAttack = coefficient(params.mAttackMs, params.mSamplerate);
+    settings.mRelease = coefficient(params.mReleaseMs, params.mSamplerate);
+    settings.mHold = static_cast<size_t>(std::lround(params.mHoldMs * params.mSamplerate / 1000.0));
+
+    return settings;
+}
+
+AJ::dsp::gate::Processor::Processor(const Settings &settings, size_t channels) :
+    mSettings(settings), mChannels(channels) {
+
+    reset();
+}
+
+void AJ::dsp::gate::Processor::reset(){
+    mGain = mSettings.mFloor;
+    mOpen = false;
+    mHoldLeft = 0;
+}
+
+void AJ::dsp::gate::Processor::process(float *data, size_t frames){
+    alignas(kBufferAlignment) float peaks[kDynamicsChunkFrames];
+    alignas(kBufferAlignment) float gains[kDynamicsChunkFrames];
+
+    const kernels::KernelTable &kernels = kernels::table();
+    const Settings &s = mSettings;
+    const size_t C = mChannels;
+
+    while(frames > 0){
+        const size_t n = std::min(frames, kDynamicsChunkFrames);
+
+        kernels.framePeak(data, n, C, peaks);
+
+        //* open at the threshold, hold under the close level, then close.
+        for(size_t f = 0; f < n; ++f){
+            if(peaks[f] >= (mOpen ? s.mClose : s.mOpen)){
+                mOpen = true;
+                mHoldLeft = s.mHold;
+            } else if(mOpen && mHoldLeft > 0){
+                --mHoldLeft;
+            } else {
+                mOpen = false;
+            }
+            gains[f] = mOpen ? 1.0f : s.mFloor;
+        }
+
+        //? the envelope towards a constant target is target + (gain - target) · pole^k, one glide per run.
+        for(size_t f = 0; f < n;){
+            const float target = gains[f];
+            size_t end = f + 1;
+            while(end < n && gains[end] == target) ++end;
+
+            kernels.glide(gains + f, end - f, mGain, target, target > mGain ? s.mAttack : s.mRelease);
+            mGain = gains[end - 1];
+            f = end;
+        }
+
+        kernels.frameGain(data, n, C, gains);
+
+        data += n * C;
+        frames -= n;
+    }
+}
+
+void AJ::dsp::gate::Processor::processPlanar(float *const *channels, size_t frames){
+    alignas(kBufferAlignment) float chunk[kDynamicsChunkFrames * kNumChannels];
+
+    if(mChannels == 1){
+        process(channels[0], frames);
+        return;
+    }
+
+    const kernels::KernelTable &kernels = kernels::table();
+
+    for(size_t in = 0; in < frames;){
+        const size_t n = std::min(kDynamicsChunkFrames, frames - in);
+
+        kernels.interleave(channels[0] + in, channels[1] + in, chunk, n);
+        process(chunk, n);
+        kernels.deinterleave(chunk, channels[0] + in, channels[1] + in, n);
+
+        in += n;
+    }
+}
+
+std::shared_ptr<AJ::dsp::gate::GateParams> AJ::dsp::gate::GateParams::create(Params &params,
+    AJ::error::IErrorHandler &handler){
+
+    auto reject = [&](const std::string &message){
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    };
+
+    if(params.mStart > params.mEnd || params.mStart < 0){
+        return reject("invalid range indexes parameters for gate effect.\n");
+    }
+
+    if(params.mSamplerate < kMinSamplerate || params.mSamplerate > kMaxSamplerate){
+        return reject("invalid samplerate for gate effect, it must be in [" + std::to_string(kMinSamplerate)
+            + ", " + std::to_string(kMaxSamplerate) + "].\n");
+    }
+
+    if(!inRange(params.mThresholdDb, kGateMinThresholdDb, 0.0f) || !inRange(params.mRangeDb, kGateMinRangeDb, 0.0f)){
+        return reject("invalid levels for gate effect: threshold in [" + std::to_string(kGateMinThresholdDb)
+            + ", 0] dB, range in [" + std::to_string(kGateMinRangeDb) + ", 0] dB.\n");
+    }
+
+    if(!inRange(params.mAttackMs, 0.0f, kGateMaxAttackMs) || !inRange(params.mHoldMs, 0.0f, kGateMaxHoldMs)
+        || !inRange(params.mReleaseMs, 0.0f, kGateMaxReleaseMs)){
+        return reject("invalid envelope times for gate effect: attack in [0, " + std::to_string(kGateMaxAttackMs)
+            + "] ms, hold in [0, " + std::to_string(kGateMaxHoldMs) + "] ms, release in [0, "
+            + std::to_string(kGateMaxReleaseMs) + "] ms.\n");
+    }
+
+    std::shared_ptr<GateParams> gateParams = std::make_shared<GateParams>(PrivateTag{});
+
+    gateParams->mSettings = Settings::from(params);
+    gateParams->setStart(params.mStart);
+    gateParams->setEnd(params.mEnd);
+
+    return gateParams;
+}
+
+bool AJ::dsp::gate::Gate::setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler){
+    std::shared_ptr<GateParams> gateParams = std::dynamic_pointer_cast<GateParams>(params);
+    // if gateParams is nullptr that means it's not a shared_ptr of GateParams
+    if(!gateParams){
+        const std::string message = "Effect parameters must be of type GateParams for this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    mParams = gateParams;
+    return true;
+}
+
+bool AJ::dsp::gate::Gate::process(Float &buffer, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "gate effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || mParams->End() >= buffer.size()){
+        const std::string message = "invalid indexes for gate effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    Processor processor(mParams->Setup(), 1);
+    processor.process(buffer.data() + mParams->Start(), mParams->End() - mParams->Start() + 1);
+    return true;
+}
+
+bool AJ::dsp::gate::Gate::process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "gate effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(channels == 0 || channels > audio.size()){
+        const std::string message = "invalid channel count for gate effect.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    float *pointers[kNumChannels];
+    for(size_t ch = 0; ch < channels; ++ch){
+        if(mParams->End() < mParams->Start() || mParams->Start() < 0 || mParams->End() >= audio[ch].size()){
+            const std::string message = "invalid indexes for gate effect.\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return false;
+        }
+        pointers[ch] = audio[ch].data() + mParams->Start();
+    }
+
+    //* one processor over the channels: the loudest channel of every frame opens the gate.
+    Processor processor(mParams->Setup(), channels);
+    processor.processPlanar(pointers, mParams->End() - mParams->Start() + 1);
+    return true;
+}
+
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::gate::Gate::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "gate effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return nullptr;
+    }
+
+    if(channels < 1 || channels > kNumChannels){
+        const std::string message = "the gate effect supports mono and stereo streams.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return nullptr;
+    }
+
+    auto state = std::make_unique<GateState>(channels);
+    state->mProcessor = std::make_unique<Processor>(mParams->Setup(), channels);
+    state->mOwner = mParams;
+
+    return state;
+}
+
+bool AJ::dsp::gate::Gate::processBlock(float *data, size_t frames, uint8_t channels,
+    EffectState &state, AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "gate effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    GateState *gateState = dynamic_cast<GateState*>(&state);
+
+    if(!gateState || gateState->mOwner != mParams){
+        const std::string message = "effect state must be a GateState created with the current parameters.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        gateState->mProcessor->process(data + first * channels, last - first);
+    }
+
+    state.advance(frames);
+    return true;
+}
@@ -2,8 +2,10 @@
 #include <limits>
 
 #include "dsp/echo.h"
+#include "dsp/kernels.h"
 #include "core/types.h"
 #include "core/error_handler.h"
+#include "core/scratch_arena.h"
 
 std::shared_ptr<AJ::dsp::echo::EchoParams> AJ::dsp::echo::EchoParams::create(Params& params,
     AJ::error::IErrorHandler &handler) {
@@ -26,44 +28,6 @@ std::shared_ptr<AJ::dsp::echo::EchoParams> AJ::dsp::echo::EchoParams::create(Par
     return echoParams;
 }
 
-bool AJ::dsp::echo::Echo::process(Float &buffer, AJ::error::IErrorHandler &handler) {
-#if defined(__AVX__)
-    if (__builtin_cpu_supports("avx")) {
-        return echoSIMD_AVX(buffer, handler);
-    }
-#endif
-
-#if defined(__SSE__)
-    if (__builtin_cpu_supports("sse")) {
-        return echoSIMD_SSE(buffer, handler);
-    }
-#endif
-
-    return echoNaive(buffer, handler);
-}
-
-AJ::sample_t AJ::dsp::echo::Echo::calculate_new_sample_with_echo(Float &in, sample_pos sample_idx, sample_pos echo_idx,  AJ::error::IErrorHandler &handler){
-    if(sample_idx >= in.size() || sample_idx < 0){
-        const std::string message = "Invalid Index: sample_idx is not in a valid range.\n";
-        handler.onError(error::Error::InternalError, message);
-        
-        return 0.0f;
-    }
-    if(echo_idx >= in.size() || echo_idx < 0){       
-        const std::string message = "Invalid Index: echo_idx is not in a valid range.\n";
-        handler.onError(error::Error::InternalError, message);
-
-        return 0.0f;
-    }
-
-    sample_t newSample = in[sample_idx] + (in[echo_idx] * mParams->Decay());
-
-    if(newSample > 1.0f) newSample = 1.0f;
-    else if (newSample < -1.0f) newSample = -1.0f;
-
-    return newSample;
-}
-
 void AJ::dsp::echo::Echo::SetDelaySamples(decay_t delayInSeconds, sample_c sampleRate){
     mParams->setDelaySamples(sampleRate * delayInSeconds);
 }
@@ -81,7 +45,7 @@ bool AJ::dsp::echo::Echo::setParams(std::shared_ptr<EffectParams> params, AJ::er
     return true;
 }
 
-bool AJ::dsp::echo::Echo::echoNaive(Float &buffer, AJ::error::IErrorHandler &handler){
+bool AJ::dsp::echo::Echo::process(Float &buffer, AJ::error::IErrorHandler &handler){
     /*
         ?Echo Effect Equation:
             Echo_Sample = in[i - _DelaySamples()] * _mDecay
@@ -99,21 +63,145 @@ bool AJ::dsp::echo::Echo::echoNaive(Float &buffer, AJ::error::IErrorHandler &han
         return false;
     }
 
-    Float out;
-    //* copy the first samples
-    out.resize(mParams->End() - mParams->Start() + 1, 0.0f);
-    std::copy(buffer.begin() + mParams->Start(), buffer.begin() + mParams->Start() + mParams->DelaySamples(), out.begin());
+    //* the output range comes from the thread's scratch arena, released at the end of the scope.
+    const size_t count = mParams->End() - mParams->Start() + 1;
+    utils::ScratchScope scope;
+    float *out = scope.arena().array<float>(count);
 
-    for(sample_pos i = mParams->Start() + mParams->DelaySamples(); i <= mParams->End(); ++i){
-        sample_t sample = calculate_new_sample_with_echo(buffer, i, i - mParams->DelaySamples(), handler);
-        out[i - mParams->Start()] = sample;
+    if(!out){
+        const std::string message = "failed to allocate the echo scratch buffer.\n";
+        handler.onError(error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    //* copy the first samples
+    std::copy(buffer.begin() + mParams->Start(), buffer.begin() + mParams->Start() + mParams->DelaySamples(), out);
+
+    if(mParams->Start() + mParams->DelaySamples() <= mParams->End()){
+        const sample_pos first = mParams->Start() + mParams->DelaySamples();
+
+        const float *in = buffer.data() + first;
+        const float *delayed = buffer.data() + mParams->Start();
+        float *dest = out + mParams->DelaySamples();
+        const size_t n = mParams->End() - first + 1;
+
+        if(!automated()){
+            kernels::table().echo(in, delayed, dest, n, mParams->Decay());
+        } else {
+            //* one linear run of decays at a time.
+            for(size_t done = 0; done < n; ){
+                const AutomationRun run = mAutomation->runAt(first + done, n - done);
+
+                for(size_t i = 0; i < run.frames; ++i){
+                    const float decay = static_cast<float>(run.value + run.step * i);
+                    dest[done + i] = std::clamp(in[done + i] + delayed[done + i] * decay, -1.0f, 1.0f);
+                }
+
+                done += run.frames;
+            }
+        }
     }
 
     //* copy the new samples into the main buffer
-    std::copy(out.begin(), out.end(), buffer.begin() + mParams->Start());
+    std::copy(out, out + count, buffer.begin() + mParams->Start());
     return true;
 }
 
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::echo::Echo::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
 
+    if(!mParams){
+        const std::string message = "echo effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return nullptr;
+    }
 
- 
\ No newline at end of file
+    const float decay = mLive ? mLive->acquire().mDecay : mParams->Decay();
+    return std::make_unique<EchoState>(channels, mParams->DelaySamples(), decay);
+}
+
+bool AJ::dsp::echo::Echo::processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+    AJ::error::IErrorHandler &handler){
+    /*
+        ?Same equation as echoNaive, but the delayed input comes from the history ring:
+            out[n] = in[n] + in[n - delay] * decay   for n >= Start() + delay
+            out[n] = in[n]                           for Start() <= n < Start() + delay
+    */
+
+    if(!mParams){
+        const std::string message = "echo effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    EchoState *echoState = dynamic_cast<EchoState*>(&state);
+    const size_t delay = mParams->DelaySamples();
+
+    if(!echoState || (delay > 0 && echoState->mHistory[0].size() != delay)){
+        const std::string message = "effect state must be an EchoState created by this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    utils::LinearSmoother &smoother = echoState->mDecay;
+    smoother.setTarget(mLive ? mLive->acquire().mDecay : mParams->Decay(), kParamSmoothFrames);
+
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        smoother.skip(first);
+        sample_pos offset = state.position() + first - mParams->Start();
+
+        AutomationRun run{ 0, 0.0, 0.0 };
+        size_t runIndex = 0;
+
+        for(size_t f = first; f < last; ++f, ++offset){
+            float decay;
+
+            if(automated()){
+                if(runIndex == run.frames){
+                    run = mAutomation->runAt(state.position() + f, last - f);
+                    runIndex = 0;
+                }
+                decay = static_cast<float>(run.value + run.step * runIndex++);
+            } else {
+                decay = smoother.next();
+            }
+
+            float *frame = data + f * channels;
+
+            for(uint8_t ch = 0; ch < channels; ++ch){
+                const float in = frame[ch];
+
+                if(delay == 0){
+                    frame[ch] = std::clamp(in + in * decay, -1.0f, 1.0f);
+                    continue;
+                }
+
+                float &delayed = echoState->mHistory[ch][echoState->mWriteIndex];
+
+                if(offset >= static_cast<sample_pos>(delay)){
+                    frame[ch] = std::clamp(in + delayed * decay, -1.0f, 1.0f);
+                }
+
+                //* keep the dry input, the echo is feed-forward.
+                delayed = in;
+            }
+
+            if(delay > 0 && ++echoState->mWriteIndex == delay){
+                echoState->mWriteIndex = 0;
+            }
+        }
+
+        smoother.skip(frames - last);
+    } else {
+        //? the ramp follows the stream time, in or out of the range.
+        smoother.skip(frames);
+    }
+
+    state.advance(frames);
+    return true;
+}
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cmath>
+
+#include "dsp/multi_tap_echo.h"
+#include "dsp/kernels.h"
+#include "core/types.h"
+#include "core/error_handler.h"
+#include "core/scratch_arena.h"
+
+std::shared_ptr<AJ::dsp::multitap::MultiTapParams> AJ::dsp::multitap::MultiTapParams::create(Params &params,
+    AJ::error::IErrorHandler &handler) {
+
+    if(params.mStart > params.mEnd || params.mStart < 0){
+        const std::string message = "invalid range indexes parameters for multi-tap echo effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(params.mTaps.empty() || params.mTaps.size() > kEchoMaxTaps){
+        const std::string message = "multi-tap echo needs 1 to " + std::to_string(kEchoMaxTaps) + " taps.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(params.mFeedback < 0.0f || params.mFeedback > kEchoMaxFeedback || params.mSamplerate <= 0){
+        const std::string message = "invalid feedback or samplerate for multi-tap echo effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    std::shared_ptr<MultiTapParams> multiTapParams = std::make_shared<MultiTapParams>(PrivateTag{});
+
+    for(const Tap &tap : params.mTaps){
+        const double delay = std::round(static_cast<double>(tap.mDelayInSeconds) * params.mSamplerate);
+
+        if(!(delay >= 1.0) || tap.mGain < -1.0f || tap.mGain > 1.0f){
+            const std::string message = "invalid tap for multi-tap echo effect, the delay must be at least one "
+                "sample and the gain in [-1.0, 1.0].\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return nullptr;
+        }
+
+        multiTapParams->mTaps.push_back({ static_cast<size_t>(delay), tap.mGain });
+    }
+
+    auto [shortest, longest] = std::minmax_element(multiTapParams->mTaps.begin(), multiTapParams->mTaps.end(),
+        [](const DelayTap &a, const DelayTap &b){ return a.mDelay < b.mDelay; });
+
+    multiTapParams->mMinDelay = shortest->mDelay;
+    multiTapParams->mMaxDelay = longest->mDelay;
+    multiTapParams->mFeedback = params.mFeedback;
+    multiTapParams->setStart(params.mStart);
+    multiTapParams->setEnd(params.mEnd);
+
+    return multiTapParams;
+}
+
+bool AJ::dsp::multitap::MultiTapEcho::setParams(std::shared_ptr<EffectParams> params,
+    AJ::error::IErrorHandler &handler){
+    std::shared_ptr<MultiTapParams> multiTapParams = std::dynamic_pointer_cast<MultiTapParams>(params);
+    // if multiTapParams is nullptr that means it's not a shared_ptr of MultiTapParams
+    if(!multiTapParams){
+        const std::string message = "Effect parameters must be of type MultiTapParams for this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    mParams = multiTapParams;
+    return true;
+}
+
+void AJ::dsp::multitap::MultiTapEcho::render(float *data, size_t first, size_t last, uint8_t stride,
+    float *const *rings, size_t &head) const {
+    /*
+        ?Per chunk of n <= MinDelay() frames, so every tap of the chunk was written before it:
+            acc  = x + sum_k gain_k * ring[head - delay_k ..]   (read as one or two runs of the ring)
+            ring[head ..] = x + feedback * ring[head ..]        (w[n - MaxDelay()] is replaced by w[n])
+            y    = clamp(acc, -1, 1)
+    */
+    const kernels::KernelTable &kernels = kernels::table();
+    const size_t length = mParams->MaxDelay();
+    const size_t chunk = std::min(kEchoChunkFrames, mParams->MinDelay());
+    const float feedback = mParams->Feedback();
+
+    alignas(kBufferAlignment) float input[kEchoChunkFrames];
+    alignas(kBufferAlignment) float acc[kEchoChunkFrames];
+
+    for(size_t f = first; f < last; f += chunk){
+        const size_t n = std::min(chunk, last - f);
+
+        for(uint8_t ch = 0; ch < stride; ++ch){
+            float *samples = data + f * stride + ch;
+            float *ring = rings[ch];
+
+            for(size_t i = 0; i < n; ++i){
+                input[i] = samples[i * stride];
+            }
+            std::copy(input, input + n, acc);
+
+            for(const DelayTap &tap : mParams->Taps()){
+                const size_t start = (head + length - tap.mDelay) % length;
+                const size_t run = std::min(n, length - start);
+
+                kernels.mulAdd(acc, ring + start, acc, run, tap.mGain);
+                if(run < n){
+                    kernels.mulAdd(acc + run, ring, acc + run, n - run, tap.mGain);
+                }
+            }
+
+            const size_t run = std::min(n, length - head);
+            kernels.mulAdd(input, ring + head, ring + head, run, feedback);
+            if(run < n){
+                kernels.mulAdd(input + run, ring, ring, n - run, feedback);
+            }
+
+            //* gain 1 only clamps.
+            kernels.gain(acc, n, 1.0f);
+
+            for(size_t i = 0; i < n; ++i){
+                samples[i * stride] = acc[i];
+            }
+        }
+
+        head = (head + n) % length;
+    }
+}
+
+bool AJ::dsp::multitap::MultiTapEcho::process(Float &buffer, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "multi-tap echo effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || mParams->End() >= buffer.size()){
+        const std::string message = "invalid indexes for multi-tap echo effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    //* the delay ring comes from the thread's scratch arena, released at the end of the scope.
+    utils::ScratchScope scope;
+    float *ring = scope.arena().array<float>(mParams->MaxDelay());
+
+    if(!ring){
+        const std::string message = "failed to allocate the multi-tap echo delay ring.\n";
+        handler.onError(error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    std::fill(ring, ring + mParams->MaxDelay(), 0.0f);
+
+    size_t head = 0;
+    render(buffer.data(), mParams->Start(), mParams->End() + 1, 1, &ring, head);
+    return true;
+}
+
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::multitap::MultiTapEcho::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "multi-tap echo effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return nullptr;
+    }
+
+    return std::make_unique<MultiTapState>(channels, mParams->MaxDelay());
+}
+
+bool AJ::dsp::multitap::MultiTapEcho::processBlock(float *data, size_t frames, uint8_t channels,
+    EffectState &state, AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "multi-tap echo effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    MultiTapState *multiTapState = dynamic_cast<MultiTapState*>(&state);
+
+    if(!multiTapState || multiTapState->mRings[0].size() != mParams->MaxDelay()){
+        const std::string message = "effect state must be a MultiTapState created by this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        render(data, first, last, channels, multiTapState->mRingData.data(), multiTapState->mHead);
+    }
+
+    state.advance(frames);
+    return true;
+}
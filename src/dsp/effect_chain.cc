@@ -0,0 +1,150 @@
+#include <iostream>
+#include <algorithm>
+
+#include "dsp/effect_chain.h"
+#include "core/types.h"
+#include "core/error_handler.h"
+
+bool AJ::dsp::EffectChain::add(std::shared_ptr<Effect> effect, AJ::error::IErrorHandler &handler){
+    if(!effect){
+        const std::string message = "invalid effect, effect cannot be NULL.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    //? a stage keeps the quality it was given, unless the chain previews.
+    if(mQuality != RenderQuality::Full){
+        effect->setQuality(mQuality);
+    }
+    mEffects.emplace_back(std::move(effect));
+    return true;
+}
+
+void AJ::dsp::EffectChain::setQuality(RenderQuality quality){
+    mQuality = quality;
+    for(auto &effect : mEffects){
+        effect->setQuality(quality);
+    }
+}
+
+bool AJ::dsp::EffectChain::setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler){
+    const std::string message = "EffectChain has no parameters, set the parameters of each effect before adding it.\n";
+    handler.onError(error::Error::OperationNotAllowed, message);
+    return false;
+}
+
+bool AJ::dsp::EffectChain::supportsBlockProcessing() const {
+    return std::all_of(mEffects.begin(), mEffects.end(), [](const std::shared_ptr<Effect> &effect){
+        return effect->supportsBlockProcessing();
+    });
+}
+
+bool AJ::dsp::EffectChain::blockMatchesProcess() const {
+    return std::all_of(mEffects.begin(), mEffects.end(), [](const std::shared_ptr<Effect> &effect){
+        return effect->blockMatchesProcess();
+    });
+}
+
+bool AJ::dsp::EffectChain::process(Float &buffer, AJ::error::IErrorHandler &handler){
+    size_t i = 0;
+
+    while(i < mEffects.size()){
+        //* whole-buffer stage.
+        if(!mEffects[i]->supportsBlockProcessing()){
+            if(!mEffects[i]->process(buffer, handler)){
+                return false;
+            }
+
+            ++i;
+            continue;
+        }
+
+        //* fuse all following block stages.
+        size_t j = i;
+        while(j < mEffects.size() && mEffects[j]->supportsBlockProcessing()){
+            ++j;
+        }
+
+        if(!processFused(buffer, i, j, handler)){
+            return false;
+        }
+
+        i = j;
+    }
+
+    return true;
+}
+
+bool AJ::dsp::EffectChain::processFused(Float &buffer, size_t first, size_t last,
+    AJ::error::IErrorHandler &handler){
+
+    std::vector<std::unique_ptr<EffectState>> states;
+    states.reserve(last - first);
+
+    for(size_t k = first; k < last; ++k){
+        auto state = mEffects[k]->createState(1, handler);
+        if(!state){
+            return false;
+        }
+
+        states.emplace_back(std::move(state));
+    }
+
+    const size_t size = buffer.size();
+
+    for(size_t pos = 0; pos < size; pos += mBlockFrames){
+        const size_t frames = std::min(mBlockFrames, size - pos);
+        float *block = buffer.data() + pos;
+
+        for(size_t k = first; k < last; ++k){
+            if(!mEffects[k]->processBlock(block, frames, 1, *states[k - first], handler)){
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::EffectChain::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+
+    auto chainState = std::make_unique<ChainState>(channels);
+    chainState->mStates.reserve(mEffects.size());
+
+    for(auto &effect : mEffects){
+        auto state = effect->createState(channels, handler);
+        if(!state){
+            return nullptr;
+        }
+
+        chainState->mStates.emplace_back(std::move(state));
+    }
+
+    return chainState;
+}
+
+bool AJ::dsp::EffectChain::processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+    AJ::error::IErrorHandler &handler){
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    ChainState *chainState = dynamic_cast<ChainState*>(&state);
+
+    if(!chainState || chainState->mStates.size() != mEffects.size()){
+        error::report(handler, error::Error::InvalidEffectParameters,
+            "effect state must be a ChainState created by this chain ({} effects).\n", mEffects.size());
+        return false;
+    }
+
+    for(size_t k = 0; k < mEffects.size(); ++k){
+        if(!mEffects[k]->processBlock(data, frames, channels, *chainState->mStates[k], handler)){
+            return false;
+        }
+    }
+
+    state.advance(frames);
+    return true;
+}
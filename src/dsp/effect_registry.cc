@@ -0,0 +1,158 @@
+#include "dsp/effect_registry.h"
+
+#include "dsp/gain.h"
+#include "dsp/echo.h"
+#include "dsp/reverb/reverb.h"
+#include "dsp/fade.h"
+#include "dsp/normalization.h"
+#include "dsp/distortion.h"
+#include "dsp/reverse.h"
+#include "dsp/pitch/pitch_shift.h"
+#include "dsp/eq/equalizer.h"
+#include "dsp/dynamics/dynamics.h"
+#include "dsp/dynamics/gate.h"
+
+namespace {
+
+template<typename T>
+std::unique_ptr<AJ::dsp::Effect> make(){
+    return std::make_unique<T>();
+}
+
+/// @brief fadeIn / fadeOut share the Fade effect, the direction of the parameters must match.
+template<AJ::dsp::fade::FadeMode Mode>
+bool checkFadeMode(AJ::dsp::EffectParams &params, AJ::error::IErrorHandler &handler){
+    auto *fadeParams = dynamic_cast<AJ::dsp::fade::FadeParams*>(&params);
+
+    if(fadeParams && fadeParams->mode() != Mode){
+        const std::string message = "the fade mode of the parameters doesn't match the requested fade effect.\n";
+        handler.onError(AJ::error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    return true; // other types are rejected by Fade::setParams.
+}
+
+std::atomic<uint64_t> gNextRegistryId{1};
+
+const char* effectName(size_t index){
+    static const char* const names[AJ::dsp::kEffectCount] = {
+        "Distortion", "Echo", "Reverb", "Fade in", "Fade out", "Gain", "Normalization", "Pitch shift", "Equalizer", "Dynamics", "Reverse", "Gate"
+    };
+
+    return names[index];
+}
+
+}
+
+AJ::dsp::EffectRegistry::EffectRegistry() : mId(gNextRegistryId.fetch_add(1, std::memory_order_relaxed)) {
+    registerEffect(AJ::Effect::gain, make<gain::Gain>);
+    registerEffect(AJ::Effect::echo, make<echo::Echo>);
+    registerEffect(AJ::Effect::reverb, make<reverb::Reverb>);
+    registerEffect(AJ::Effect::fadeIn, make<fade::Fade>, checkFadeMode<fade::FadeMode::In>);
+    registerEffect(AJ::Effect::fadeOut, make<fade::Fade>, checkFadeMode<fade::FadeMode::Out>);
+    registerEffect(AJ::Effect::normalization, make<normalization::Normalization>);
+    registerEffect(AJ::Effect::Distortion, make<distortion::Distortion>);
+    registerEffect(AJ::Effect::pitchShift, make<pitch::PitchShift>);
+    registerEffect(AJ::Effect::equalizer, make<eq::Equalizer>);
+    registerEffect(AJ::Effect::dynamics, make<dynamics::Dynamics>);
+    registerEffect(AJ::Effect::reverse, make<reverse::Reverse>);
+    registerEffect(AJ::Effect::gate, make<gate::Gate>);
+}
+
+bool AJ::dsp::EffectRegistry::registerEffect(AJ::Effect effect, Factory factory, Check check){
+    const size_t index = static_cast<size_t>(effect);
+
+    if(index >= kEffectCount || !factory){
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMux);
+    mEntries[index] = Entry{ factory, check };
+    mGeneration.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+bool AJ::dsp::EffectRegistry::has(AJ::Effect effect) const {
+    const size_t index = static_cast<size_t>(effect);
+
+    std::lock_guard<std::mutex> lock(mMux);
+    return index < kEffectCount && mEntries[index].factory;
+}
+
+std::unique_ptr<AJ::dsp::Effect> AJ::dsp::EffectRegistry::create(AJ::Effect effect) const {
+    const size_t index = static_cast<size_t>(effect);
+    Factory factory = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        if(index < kEffectCount) factory = mEntries[index].factory;
+    }
+
+    return factory ? factory() : nullptr;
+}
+
+std::array<AJ::dsp::EffectRegistry::CachedEffect, AJ::dsp::kEffectCount>&
+    AJ::dsp::EffectRegistry::threadCache() noexcept {
+
+    static thread_local std::array<CachedEffect, kEffectCount> cache;
+    return cache;
+}
+
+AJ::dsp::Effect* AJ::dsp::EffectRegistry::acquire(AJ::Effect effect, std::shared_ptr<EffectParams> params,
+    AJ::error::IErrorHandler &handler){
+
+    const size_t index = static_cast<size_t>(effect);
+
+    if(index >= kEffectCount){
+        const std::string message = "Unknown or unsupported audio effect requested.\n";
+        handler.onError(error::Error::UnknownEffect, message);
+        return nullptr;
+    }
+
+    CachedEffect &cached = threadCache()[index];
+    const uint64_t generation = mGeneration.load(std::memory_order_acquire);
+
+    //* construct on first use, or when the factory changed / another registry filled the slot.
+    if(!cached.effect || cached.owner != mId || cached.generation != generation){
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(mMux);
+            entry = mEntries[index];
+        }
+
+        if(!entry.factory){
+            const std::string message = std::string(effectName(index)) + " effect is not implemented yet.\n";
+            handler.onError(error::Error::UnknownEffect, message);
+            return nullptr;
+        }
+
+        cached.effect = entry.factory();
+        cached.owner = mId;
+        cached.generation = generation;
+
+        if(!cached.effect){
+            const std::string message = "Failed to construct the requested effect.\n";
+            handler.onError(error::Error::ResourceAllocationFailed, message);
+            return nullptr;
+        }
+    }
+
+    //* set on every call: a reused parameters object may have changed since (e.g. the samplerate
+    //* Reverb sizes its all-pass filters from), only the allocation is cached.
+    Check check = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        check = mEntries[index].check;
+    }
+
+    if(params && check && !check(*params, handler)){
+        return nullptr;
+    }
+
+    if(!cached.effect->setParams(std::move(params), handler)){
+        return nullptr;
+    }
+
+    return cached.effect.get();
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+
+#include "dsp/eq/biquad.h"
+
+AJ::dsp::eq::Coefficients AJ::dsp::eq::design(const Band &band, double samplerate){
+    const double A = std::pow(10.0, band.mGainDb / 40.0);
+    const double w0 = 2.0 * M_PI * band.mFrequency / samplerate;
+    const double cosW = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * band.mQ);
+    const double shelf = 2.0 * std::sqrt(A) * alpha;
+
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a0 = 1.0, a1 = 0.0, a2 = 0.0;
+
+    switch(band.mType){
+        case BandType::LowShelf:
+            b0 = A * ((A + 1.0) - (A - 1.0) * cosW + shelf);
+            b1 = 2.0 * A * ((A - 1.0) - (A + 1.0) * cosW);
+            b2 = A * ((A + 1.0) - (A - 1.0) * cosW - shelf);
+            a0 = (A + 1.0) + (A - 1.0) * cosW + shelf;
+            a1 = -2.0 * ((A - 1.0) + (A + 1.0) * cosW);
+            a2 = (A + 1.0) + (A - 1.0) * cosW - shelf;
+            break;
+
+        case BandType::HighShelf:
+            b0 = A * ((A + 1.0) + (A - 1.0) * cosW + shelf);
+            b1 = -2.0 * A * ((A - 1.0) + (A + 1.0) * cosW);
+            b2 = A * ((A + 1.0) + (A - 1.0) * cosW - shelf);
+            a0 = (A + 1.0) - (A - 1.0) * cosW + shelf;
+            a1 = 2.0 * ((A - 1.0) - (A + 1.0) * cosW);
+            a2 = (A + 1.0) - (A - 1.0) * cosW - shelf;
+            break;
+
+        case BandType::Peaking:
+            b0 = 1.0 + alpha * A;
+            b1 = -2.0 * cosW;
+            b2 = 1.0 - alpha * A;
+            a0 = 1.0 + alpha / A;
+            a1 = -2.0 * cosW;
+            a2 = 1.0 - alpha / A;
+            break;
+
+        case BandType::LowPass:
+            b0 = (1.0 - cosW) / 2.0;
+            b1 = 1.0 - cosW;
+            b2 = (1.0 - cosW) / 2.0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW;
+            a2 = 1.0 - alpha;
+            break;
+
+        case BandType::HighPass:
+            b0 = (1.0 + cosW) / 2.0;
+            b1 = -(1.0 + cosW);
+            b2 = (1.0 + cosW) / 2.0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW;
+            a2 = 1.0 - alpha;
+            break;
+    }
+
+    Coefficients c;
+    c.b0 = static_cast<float>(b0 / a0);
+    c.b1 = static_cast<float>(b1 / a0);
+    c.b2 = static_cast<float>(b2 / a0);
+    c.a1 = static_cast<float>(a1 / a0);
+    c.a2 = static_cast<float>(a2 / a0);
+    return c;
+}
+
+AJ::dsp::eq::BiquadCascade::BiquadCascade(){
+    setup(nullptr, 0, 1);
+    reset();
+}
+
+bool AJ::dsp::eq::BiquadCascade::setup(const Coefficients *stages, size_t count, size_t channels){
+    constexpr size_t L = kernels::kBiquadLanes;
+
+    if((channels != 1 && channels != 2) || count * channels > L){
+        return false;
+    }
+
+    const bool keep = count == mStages && channels == mChannels;
+
+    //* identity stages everywhere, then stage k of every channel in lanes [k·channels, (k + 1)·channels).
+    std::fill(mCoeffs, mCoeffs + L, 1.0f);
+    std::fill(mCoeffs + L, mCoeffs + 5 * L, 0.0f);
+
+    for(size_t k = 0; k < count; ++k){
+        for(size_t ch = 0; ch < channels; ++ch){
+            const size_t j = k * channels + ch;
+            mCoeffs[j] = stages[k].b0;
+            mCoeffs[L + j] = stages[k].b1;
+            mCoeffs[2 * L + j] = stages[k].b2;
+            mCoeffs[3 * L + j] = stages[k].a1;
+            mCoeffs[4 * L + j] = stages[k].a2;
+        }
+    }
+
+    mStages = count;
+    mChannels = channels;
+
+    if(!keep){
+        reset();
+    }
+
+    return true;
+}
+
+void AJ::dsp::eq::BiquadCascade::process(float *data, size_t frames){
+    if(mStages == 0 || frames == 0){
+        return;
+    }
+
+    kernels::table().biquad(data, frames, mChannels, mStages * mChannels, mCoeffs, mState);
+}
+
+void AJ::dsp::eq::BiquadCascade::reset(){
+    std::fill(mState, mState + 2 * kernels::kBiquadLanes, 0.0f);
+}
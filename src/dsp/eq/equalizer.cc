@@ -0,0 +1,156 @@
+#include <cmath>
+
+#include "dsp/eq/equalizer.h"
+#include "core/errors.h"
+
+std::shared_ptr<AJ::dsp::eq::EqParams> AJ::dsp::eq::EqParams::create(Params &params,
+    AJ::error::IErrorHandler &handler){
+
+    if(params.mStart > params.mEnd || params.mStart < 0){
+        const std::string message = "invalid range indexes parameters for equalizer effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(params.mBands.empty() || params.mBands.size() > kEqMaxBands){
+        const std::string message = "the equalizer effect needs 1 to " + std::to_string(kEqMaxBands) + " bands.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(params.mSamplerate < kMinSamplerate || params.mSamplerate > kMaxSamplerate){
+        const std::string message = "invalid samplerate for equalizer effect, it must be in ["
+            + std::to_string(kMinSamplerate) + ", " + std::to_string(kMaxSamplerate) + "].\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    const float nyquist = 0.5f * params.mSamplerate;
+
+    for(const Band &band : params.mBands){
+        //? written so NaN fails every check.
+        if(!(band.mFrequency >= kEqMinFrequency && band.mFrequency < nyquist)){
+            const std::string message = "invalid equalizer band frequency, it must be in ["
+                + std::to_string(kEqMinFrequency) + ", " + std::to_string(nyquist) + ") Hz.\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return nullptr;
+        }
+
+        if(!(band.mQ >= kEqMinQ && band.mQ <= kEqMaxQ)){
+            const std::string message = "invalid equalizer band Q, it must be in ["
+                + std::to_string(kEqMinQ) + ", " + std::to_string(kEqMaxQ) + "].\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return nullptr;
+        }
+
+        if(!(std::fabs(band.mGainDb) <= kEqMaxGainDb)){
+            const std::string message = "invalid equalizer band gain, it must be in [-"
+                + std::to_string(kEqMaxGainDb) + ", " + std::to_string(kEqMaxGainDb) + "] dB.\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<EqParams> eqParams = std::make_shared<EqParams>(PrivateTag{});
+
+    eqParams->mBands = params.mBands;
+    eqParams->mSamplerate = params.mSamplerate;
+    for(const Band &band : params.mBands){
+        eqParams->mCoefficients.push_back(design(band, params.mSamplerate));
+    }
+
+    eqParams->setStart(params.mStart);
+    eqParams->setEnd(params.mEnd);
+
+    return eqParams;
+}
+
+bool AJ::dsp::eq::Equalizer::setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler){
+    std::shared_ptr<EqParams> eqParams = std::dynamic_pointer_cast<EqParams>(params);
+    // if eqParams is nullptr that means it's not a shared_ptr of EqParams
+    if(!eqParams){
+        const std::string message = "Effect parameters must be of type EqParams for this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    mParams = eqParams;
+    mCascade.setup(mParams->Stages().data(), mParams->Stages().size(), 1);
+    return true;
+}
+
+bool AJ::dsp::eq::Equalizer::process(Float &buffer, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "equalizer effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || mParams->End() >= buffer.size()){
+        const std::string message = "invalid indexes for equalizer effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    mCascade.reset();
+    mCascade.process(buffer.data() + mParams->Start(), mParams->End() - mParams->Start() + 1);
+    return true;
+}
+
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::eq::Equalizer::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "equalizer effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return nullptr;
+    }
+
+    if(channels < 1 || channels > kNumChannels){
+        const std::string message = "the equalizer effect supports mono and stereo streams.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return nullptr;
+    }
+
+    auto state = std::make_unique<EqState>(channels);
+    state->mCascade.setup(mParams->Stages().data(), mParams->Stages().size(), channels);
+    state->mLayout = mParams;
+
+    return state;
+}
+
+bool AJ::dsp::eq::Equalizer::processBlock(float *data, size_t frames, uint8_t channels,
+    EffectState &state, AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "equalizer effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    EqState *eqState = dynamic_cast<EqState*>(&state);
+
+    if(!eqState){
+        const std::string message = "effect state must be an EqState.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    //* new parameters: only the coefficients are laid out again, the filter state carries on.
+    if(eqState->mLayout != mParams){
+        eqState->mCascade.setup(mParams->Stages().data(), mParams->Stages().size(), channels);
+        eqState->mLayout = mParams;
+    }
+
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        eqState->mCascade.process(data + first * channels, last - first);
+    }
+
+    state.advance(frames);
+    return true;
+}
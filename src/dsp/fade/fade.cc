@@ -2,6 +2,7 @@
 #include <algorithm>
 
 #include "dsp/fade.h"
+#include "dsp/kernels.h"
 #include "core/types.h"
 #include "core/error_handler.h"
 
@@ -47,16 +48,6 @@ bool AJ::dsp::fade::Fade::setParams(std::shared_ptr<EffectParams> params, AJ::er
 }
 
 bool AJ::dsp::fade::Fade::process(Float &buffer, AJ::error::IErrorHandler &handler){
-#if defined(__AVX__)
-    if (__builtin_cpu_supports("avx")) {
-        return fadeAVX(buffer, handler);
-    }
-#endif
-
-    return fadeNaive(buffer, handler);
-}
-
-bool AJ::dsp::fade::Fade::fadeNaive(Float &buffer, AJ::error::IErrorHandler &handler){
     /**
      * Fade equation:
      *   output[i] = input[i] * currentGain
@@ -83,7 +74,11 @@ bool AJ::dsp::fade::Fade::fadeNaive(Float &buffer, AJ::error::IErrorHandler &han
         return false;
     }
 
-    float currentGain;
+    return processRange(buffer, 0, mParams->End() - mParams->Start() + 1, handler);
+}
+
+bool AJ::dsp::fade::Fade::processRange(Float &buffer, size_t first, size_t last, AJ::error::IErrorHandler &handler){
+    double currentGain;
 
     float gainDiff = mParams->highGain() - mParams->lowGain();
     sample_c totalSamples = mParams->End() - mParams->Start() + 1;
@@ -96,10 +91,52 @@ bool AJ::dsp::fade::Fade::fadeNaive(Float &buffer, AJ::error::IErrorHandler &han
         gainStep *= -1;
     }
 
+    //* the kernel computes currentGain + gainStep * i per sample (no accumulated drift),
+    //* a piece starts from the closed form gain of its first frame.
+    currentGain += gainStep * first;
+    kernels::table().fade(buffer.data() + mParams->Start() + first, last - first, currentGain, gainStep);
+
+    return true;
+}
+
+bool AJ::dsp::fade::Fade::processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "fade effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
 
-    for(size_t i = mParams->Start(); i <= mParams->End(); ++i, currentGain += gainStep){
-        buffer[i] = std::clamp(buffer[i] * currentGain, -1.0f, 1.0f);
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        //* same ramp as fadeNaive, the gain of a frame only depends on its distance to Start().
+        float gainDiff = mParams->highGain() - mParams->lowGain();
+        sample_c totalSamples = mParams->End() - mParams->Start() + 1;
+        double gainStep = gainDiff / totalSamples;
+
+        double baseGain = mParams->lowGain();
+        if(mParams->mode() == FadeMode::Out){
+            baseGain = mParams->highGain();
+            gainStep *= -1;
+        }
+
+        sample_pos offset = state.position() + first - mParams->Start();
+
+        for(size_t f = first; f < last; ++f, ++offset){
+            const float gain = static_cast<float>(baseGain + gainStep * offset);
+            float *frame = data + f * channels;
+
+            for(uint8_t ch = 0; ch < channels; ++ch){
+                frame[ch] = std::clamp(frame[ch] * gain, -1.0f, 1.0f);
+            }
+        }
     }
 
+    state.advance(frames);
     return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,190 @@
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <utility>
+
+#include "dsp/fft.h"
+#include "dsp/kernels.h"
+
+AJ::dsp::fft::Plan::Plan(PrivateTag, size_t size) : mSize(size), mHalf(size / 2) {
+    const double pi = 3.14159265358979323846;
+
+    size_t bits = 0;
+    while((static_cast<size_t>(1) << bits) < mHalf) ++bits;
+
+    mReverse.resize(mHalf);
+    for(size_t i = 0; i < mHalf; ++i){
+        uint32_t r = 0;
+        for(size_t b = 0; b < bits; ++b){
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        mReverse[i] = r;
+    }
+
+    mTwiddleRe.resize(mHalf > 1 ? mHalf - 1 : 1);
+    mTwiddleIm.resize(mTwiddleRe.size());
+    mInverseIm.resize(mTwiddleRe.size());
+    for(size_t len = 2; len <= mHalf; len <<= 1){
+        const size_t half = len / 2;
+        for(size_t j = 0; j < half; ++j){
+            const double angle = 2.0 * pi * j / len;
+            mTwiddleRe[half - 1 + j] = static_cast<float>(std::cos(angle));
+            mTwiddleIm[half - 1 + j] = static_cast<float>(-std::sin(angle));
+            mInverseIm[half - 1 + j] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    mSplitRe.resize(mHalf + 1);
+    mSplitIm.resize(mHalf + 1);
+    for(size_t k = 0; k <= mHalf; ++k){
+        mSplitRe[k] = static_cast<float>(std::cos(2.0 * pi * k / mSize));
+        mSplitIm[k] = static_cast<float>(std::sin(2.0 * pi * k / mSize));
+    }
+}
+
+template <bool Inverse>
+void AJ::dsp::fft::Plan::complexFFT(float *re, float *im) const {
+    for(size_t i = 0; i < mHalf; ++i){
+        const size_t r = mReverse[i];
+        if(r > i){
+            std::swap(re[i], re[r]);
+            std::swap(im[i], im[r]);
+        }
+    }
+
+    if(mHalf == 2){
+        const float r0 = re[0], i0 = im[0];
+        re[0] += re[1]; im[0] += im[1];
+        re[1] = r0 - re[1]; im[1] = i0 - im[1];
+        return;
+    }
+
+    //* stages of 2 and 4 points as one radix-4 pass, the twiddles are 1 and ∓j.
+    for(size_t i = 0; i < mHalf; i += 4){
+        const float a0r = re[i] + re[i + 1], a0i = im[i] + im[i + 1];
+        const float a1r = re[i] - re[i + 1], a1i = im[i] - im[i + 1];
+        const float a2r = re[i + 2] + re[i + 3], a2i = im[i + 2] + im[i + 3];
+        const float a3r = re[i + 2] - re[i + 3], a3i = im[i + 2] - im[i + 3];
+
+        // a3 * -j (forward) or a3 * j (inverse)
+        const float vr = Inverse ? -a3i : a3i;
+        const float vi = Inverse ? a3r : -a3r;
+
+        re[i] = a0r + a2r;     im[i] = a0i + a2i;
+        re[i + 2] = a0r - a2r; im[i + 2] = a0i - a2i;
+        re[i + 1] = a1r + vr;  im[i + 1] = a1i + vi;
+        re[i + 3] = a1r - vr;  im[i + 3] = a1i - vi;
+    }
+
+    const kernels::ButterflyFn butterfly = kernels::table().butterfly;
+    const Float &twiddleIm = Inverse ? mInverseIm : mTwiddleIm;
+
+    for(size_t len = 8; len <= mHalf; len <<= 1){
+        const size_t half = len / 2;
+        const float *wr = mTwiddleRe.data() + half - 1;
+        const float *wi = twiddleIm.data() + half - 1;
+
+        for(size_t i = 0; i < mHalf; i += len){
+            butterfly(re + i, im + i, re + i + half, im + i + half, wr, wi, half);
+        }
+    }
+}
+
+void AJ::dsp::fft::Plan::forward(const float *in, float *re, float *im) const {
+    /*
+        ?z[n] = x[2n] + j x[2n + 1], Z = FFT(z) (N / 2 points), then for k in [0, N / 2]:
+            E[k] = (Z[k] + conj(Z[N/2 - k])) / 2        (spectrum of the even samples)
+            O[k] = -j (Z[k] - conj(Z[N/2 - k])) / 2     (spectrum of the odd samples)
+            X[k] = E[k] + W^k O[k],  W = e^(-2πj / N)
+        X[N/2 - k] = conj(E[k] - W^k O[k]), so every pair is split in place.
+    */
+    for(size_t n = 0; n < mHalf; ++n){
+        re[n] = in[2 * n];
+        im[n] = in[2 * n + 1];
+    }
+
+    complexFFT<false>(re, im);
+
+    const float z0r = re[0], z0i = im[0];
+    re[0] = z0r + z0i;
+    im[0] = 0.0f;
+    re[mHalf] = z0r - z0i;
+    im[mHalf] = 0.0f;
+
+    for(size_t k = 1, j = mHalf - 1; k <= j; ++k, --j){
+        const float ar = re[k], ai = im[k];
+        const float br = re[j], bi = -im[j];
+
+        const float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        // -j (a - b) / 2
+        const float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+
+        // W^k O, W^k = cos - j sin
+        const float c = mSplitRe[k], s = mSplitIm[k];
+        const float tr = or_ * c + oi * s;
+        const float ti = oi * c - or_ * s;
+
+        re[k] = er + tr;
+        im[k] = ei + ti;
+        re[j] = er - tr;
+        im[j] = -(ei - ti);
+    }
+}
+
+void AJ::dsp::fft::Plan::inverse(float *re, float *im, float *out) const {
+    /*
+        ?merge the real spectrum back into the packed N / 2 point one (scaled by 2):
+            E[k] = X[k] + conj(X[N/2 - k]),  O[k] = (X[k] - conj(X[N/2 - k])) conj(W^k)
+            Z[k] = E[k] + j O[k],  Z[N/2 - k] = conj(E[k] - j O[k])
+        the unscaled inverse FFT of 2Z is N z.
+    */
+    const float x0 = re[0], xm = re[mHalf];
+    re[0] = x0 + xm;
+    im[0] = x0 - xm;
+
+    for(size_t k = 1, j = mHalf - 1; k <= j; ++k, --j){
+        const float ar = re[k], ai = im[k];
+        const float br = re[j], bi = -im[j];
+
+        const float er = ar + br, ei = ai + bi;
+        const float dr = ar - br, di = ai - bi;
+
+        // (X[k] - conj(X[j])) conj(W^k), conj(W^k) = cos + j sin
+        const float c = mSplitRe[k], s = mSplitIm[k];
+        const float or_ = dr * c - di * s;
+        const float oi = dr * s + di * c;
+
+        // E + j O and conj(E - j O)
+        re[k] = er - oi;
+        im[k] = ei + or_;
+        re[j] = er + oi;
+        im[j] = -(ei - or_);
+    }
+
+    complexFFT<true>(re, im);
+
+    for(size_t n = 0; n < mHalf; ++n){
+        out[2 * n] = re[n];
+        out[2 * n + 1] = im[n];
+    }
+}
+
+std::shared_ptr<const AJ::dsp::fft::Plan> AJ::dsp::fft::plan(size_t size){
+    if(size < kFFTMinSize || size > kFFTMaxSize || (size & (size - 1)) != 0){
+        return nullptr;
+    }
+
+    //* one slot per power of two, filled once and kept for the whole process.
+    static std::mutex mux;
+    static std::array<std::shared_ptr<const Plan>, 64> plans;
+
+    size_t bits = 0;
+    while((static_cast<size_t>(1) << bits) < size) ++bits;
+
+    std::lock_guard<std::mutex> lock(mux);
+    if(!plans[bits]){
+        plans[bits] = std::make_shared<const Plan>(Plan::PrivateTag{}, size);
+    }
+
+    return plans[bits];
+}
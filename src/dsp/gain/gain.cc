@@ -1,10 +1,12 @@
 #include <iostream>
 #include <memory>
+#include <algorithm>
 #include "core/types.h"
 #include "core/errors.h"
 
 #include "dsp/effect.h"
 #include "dsp/gain.h"
+#include "dsp/kernels.h"
 #include "core/effect_params.h"
 
 std::shared_ptr<AJ::dsp::gain::GainParams> AJ::dsp::gain::GainParams::create(Params& params, AJ::error::IErrorHandler &handler){
@@ -47,41 +49,146 @@ bool AJ::dsp::gain::Gain::setParams(std::shared_ptr<EffectParams> params, AJ::er
 
 bool AJ::dsp::gain::Gain::process(Float &buffer, AJ::error::IErrorHandler &handler){
 
-    if(mParams->Gain() == 1.0) return false;
+    if(mParams->Gain() == 1.0 && !automated()) return false;
 
-#if defined(__AVX__)
-    if (__builtin_cpu_supports("avx")) {
-        return gainAVX(buffer, handler);
+    // check valid indexes ranges
+    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || 
+        mParams->Start() >= buffer.size() || mParams->End() >= buffer.size()){
+        const std::string message = "invalid indexes for gain effect.";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    return processRange(buffer, 0, mParams->End() - mParams->Start() + 1, handler);
+}
+
+bool AJ::dsp::gain::Gain::processRange(Float &buffer, size_t first, size_t last, AJ::error::IErrorHandler &handler){
+
+    if(mParams->Gain() == 1.0 && !automated()) return false;
 
+    float *data = buffer.data() + mParams->Start() + first;
+    const size_t count = last - first;
+
+    if(automated()){
+        //* the curve is read at the stream position of the piece.
+        mAutomation->applyGain(data, count, mParams->Start() + static_cast<sample_pos>(first));
+        return true;
     }
-#endif
-    return gainNaive(buffer, handler);
+
+    kernels::table().gain(data, count, mParams->Gain());
+
+    return true;
 }
 
-void AJ::dsp::gain::Gain::calculate_gain_sample(sample_t &sample){
-    sample *= mParams->Gain();
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::gain::Gain::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
 
-    if(sample < -1.0){
-        sample = -1.0;
+    if(!mParams){
+        const std::string message = "gain effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return nullptr;
     }
 
-    if(sample > 1.0){
-        sample = 1.0;
+    float gain = mParams->Gain();
+    if(mLive){
+        gain = std::clamp(mLive->acquire().mGain, 0.0f, 5.0f);
     }
+
+    return std::make_unique<GainState>(channels, gain);
 }
 
-bool AJ::dsp::gain::Gain::gainNaive(Float &buffer, AJ::error::IErrorHandler &handler){
-    // check valid indexes ranges
-    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || 
-        mParams->Start() >= buffer.size() || mParams->End() >= buffer.size()){
-        const std::string message = "invalid indexes for gain effect.";
+bool AJ::dsp::gain::Gain::processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "gain effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    if(automated()){
+        size_t first, last;
+        if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+            const sample_pos position = state.position();
+
+            if(channels == 1){
+                mAutomation->applyGain(data + first, last - first, position + first);
+            } else {
+                //* the channels of a frame share its gain, the curve is rendered a chunk at a time.
+                alignas(kBufferAlignment) float gains[kAutomationRampFrames];
+
+                for(size_t f = first; f < last; f += kAutomationRampFrames){
+                    const size_t count = std::min(kAutomationRampFrames, last - f);
+                    mAutomation->render(position + f, count, gains);
+
+                    for(size_t i = 0; i < count; ++i){
+                        float *frame = data + (f + i) * channels;
+
+                        for(uint8_t ch = 0; ch < channels; ++ch){
+                            frame[ch] = std::clamp(frame[ch] * gains[i], -1.0f, 1.0f);
+                        }
+                    }
+                }
+            }
+        }
+
+        state.advance(frames);
+        return true;
+    }
+
+    GainState *gainState = dynamic_cast<GainState*>(&state);
+
+    if(mLive && !gainState){
+        const std::string message = "live gain needs a GainState created by this effect.\n";
         handler.onError(error::Error::InvalidEffectParameters, message);
         return false;
     }
 
-    for(sample_pos i = mParams->Start(); i <= mParams->End(); ++i){
-        calculate_gain_sample(buffer[i]);
+    if(!gainState){
+        size_t first, last;
+        if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+            //* [first, last) frames are contiguous in the interleaved block.
+            kernels::table().gain(data + first * channels, (last - first) * channels, mParams->Gain());
+        }
+
+        state.advance(frames);
+        return true;
     }
 
+    utils::LinearSmoother &smoother = gainState->mGain;
+    const float target = mLive ? std::clamp(mLive->acquire().mGain, 0.0f, 5.0f) : mParams->Gain();
+    smoother.setTarget(target, kParamSmoothFrames);
+
+    size_t first, last;
+    if(!blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        //? the ramp follows the stream time, in or out of the range.
+        smoother.skip(frames);
+        state.advance(frames);
+        return true;
+    }
+
+    smoother.skip(first);
+
+    //* per frame while the gain ramps, then the kernel on the rest of the range.
+    size_t f = first;
+    for(; f < last && smoother.smoothing(); ++f){
+        const float gain = smoother.next();
+        float *frame = data + f * channels;
+
+        for(uint8_t ch = 0; ch < channels; ++ch){
+            frame[ch] = std::clamp(frame[ch] * gain, -1.0f, 1.0f);
+        }
+    }
+
+    if(f < last){
+        kernels::table().gain(data + f * channels, (last - f) * channels, smoother.target());
+    }
+
+    smoother.skip(frames - last);
+    state.advance(frames);
     return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,573 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#include "dsp/kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AJ_KERNELS_X86
+#elif defined(__aarch64__)
+#define AJ_KERNELS_NEON
+#endif
+
+//* ---------------------------- scalar kernels ----------------------------
+
+void AJ::dsp::kernels::gainScalar(float *data, size_t count, float gain){
+    for(size_t i = 0; i < count; ++i){
+        data[i] = std::clamp(data[i] * gain, -1.0f, 1.0f);
+    }
+}
+
+void AJ::dsp::kernels::scaleScalar(float *data, size_t count, float gain){
+    for(size_t i = 0; i < count; ++i){
+        data[i] *= gain;
+    }
+}
+
+void AJ::dsp::kernels::fadeScalar(float *data, size_t count, double startGain, double step){
+    for(size_t i = 0; i < count; ++i){
+        const float gain = static_cast<float>(startGain + step * i);
+        data[i] = std::clamp(data[i] * gain, -1.0f, 1.0f);
+    }
+}
+
+void AJ::dsp::kernels::echoScalar(const float *in, const float *delayed, float *out, size_t count, float decay){
+    for(size_t i = 0; i < count; ++i){
+        out[i] = std::clamp(in[i] + delayed[i] * decay, -1.0f, 1.0f);
+    }
+}
+
+void AJ::dsp::kernels::mulAddScalar(const float *in, const float *delayed, float *out, size_t count, float gain){
+    for(size_t i = 0; i < count; ++i){
+        out[i] = in[i] + delayed[i] * gain;
+    }
+}
+
+void AJ::dsp::kernels::complexMulAddScalar(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count){
+    for(size_t i = 0; i < count; ++i){
+        accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+        accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+    }
+}
+
+void AJ::dsp::kernels::butterflyScalar(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count){
+    for(size_t i = 0; i < count; ++i){
+        const float vr = br[i] * wr[i] - bi[i] * wi[i];
+        const float vi = br[i] * wi[i] + bi[i] * wr[i];
+
+        br[i] = ar[i] - vr;
+        bi[i] = ai[i] - vi;
+        ar[i] += vr;
+        ai[i] += vi;
+    }
+}
+
+namespace {
+
+constexpr float kPi = 3.14159265f;
+constexpr float kTwoPi = 6.28318531f;
+
+/// @brief atan2 of the phase kernels: minimax atan on [0, 1] plus octant fix-ups (error < 2e-6 rad).
+inline float atan2Approx(float y, float x){
+    const float ax = std::fabs(x), ay = std::fabs(y);
+    const float a = std::min(ax, ay) / std::max(std::max(ax, ay), FLT_MIN);
+    const float s = a * a;
+
+    float r = a * (0.99997726f + s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f
+        + s * (0.05265332f + s * -0.01172120f)))));
+
+    if(ay > ax) r = 0.5f * kPi - r;
+    if(x < 0.0f) r = kPi - r;
+    return std::copysign(r, y);
+}
+
+/// @brief `x - 2π round(x / 2π)`, into [-π, π].
+inline float wrapPhase(float x){
+    return x - kTwoPi * std::nearbyint(x * (1.0f / kTwoPi));
+}
+
+/// @brief sin / cos of the phase kernels: quadrant reduction (Cody-Waite), minimax polynomials on [-π/4, π/4].
+inline void sinCosApprox(float x, float &sin, float &cos){
+    const float j = std::nearbyint(x * (2.0f / kPi));
+    const float r = ((x - j * 1.5703125f) - j * 4.83751297e-4f) - j * 7.54978995e-8f;
+    const float r2 = r * r;
+
+    const float s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    const float c = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568e-2f + r2 * (-1.388731625e-3f + r2 * 2.443315712e-5f));
+
+    switch(static_cast<int>(j) & 3){
+    case 0:  sin = s;  cos = c;  break;
+    case 1:  sin = c;  cos = -s; break;
+    case 2:  sin = -s; cos = -c; break;
+    default: sin = -c; cos = s;  break;
+    }
+}
+
+}
+
+void AJ::dsp::kernels::phaseAnalyzeScalar(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase){
+    const float invHop = 1.0f / hopPhase;
+
+    for(size_t i = 0; i < count; ++i){
+        const float bin = static_cast<float>(first + i);
+        const float phase = atan2Approx(im[i], re[i]);
+
+        mag[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+        freq[i] = bin + wrapPhase(phase - lastPhase[i] - bin * hopPhase) * invHop;
+        lastPhase[i] = phase;
+    }
+}
+
+void AJ::dsp::kernels::phaseSynthesizeScalar(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase){
+    for(size_t i = 0; i < count; ++i){
+        const float phase = wrapPhase(sumPhase[i] + freq[i] * hopPhase);
+        float sin, cos;
+        sinCosApprox(phase, sin, cos);
+
+        sumPhase[i] = phase;
+        re[i] = mag[i] * cos;
+        im[i] = mag[i] * sin;
+    }
+}
+
+void AJ::dsp::kernels::crossCorrelateScalar(const float *x, const float *ref, float *out, size_t lags, size_t length){
+    for(size_t l = 0; l < lags; ++l){
+        float sum = 0.0f;
+        for(size_t i = 0; i < length; ++i){
+            sum += x[l + i] * ref[i];
+        }
+        out[l] = sum;
+    }
+}
+
+void AJ::dsp::kernels::polyphaseScalar(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count){
+    for(size_t k = 0; k < count; ++k){
+        const float *h = bank + phase * taps;
+        float sum = 0.0f;
+        for(size_t i = 0; i < taps; ++i){
+            sum += x[i] * h[i];
+        }
+        out[k] = sum;
+
+        phase += step;
+        x += phase / phases;
+        phase %= phases;
+    }
+}
+
+void AJ::dsp::kernels::biquadScalar(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs,
+    float *state){
+    const float *b0 = coeffs, *b1 = coeffs + kBiquadLanes, *b2 = coeffs + 2 * kBiquadLanes;
+    const float *a1 = coeffs + 3 * kBiquadLanes, *a2 = coeffs + 4 * kBiquadLanes;
+    float *s1 = state, *s2 = state + kBiquadLanes;
+
+    for(size_t f = 0; f < frames; ++f){
+        for(size_t ch = 0; ch < channels; ++ch){
+            float x = data[f * channels + ch];
+
+            for(size_t j = ch; j < lanes; j += channels){
+                const float y = b0[j] * x + s1[j];
+                s1[j] = b1[j] * x - a1[j] * y + s2[j];
+                s2[j] = b2[j] * x - a2[j] * y;
+                x = y;
+            }
+
+            data[f * channels + ch] = x;
+        }
+    }
+}
+
+void AJ::dsp::kernels::framePeakScalar(const float *data, size_t frames, size_t channels, float *peaks){
+    for(size_t f = 0; f < frames; ++f){
+        float peak = 0.0f;
+        for(size_t ch = 0; ch < channels; ++ch){
+            peak = std::max(peak, std::fabs(data[f * channels + ch]));
+        }
+        peaks[f] = peak;
+    }
+}
+
+void AJ::dsp::kernels::frameGainScalar(float *data, size_t frames, size_t channels, const float *gains){
+    for(size_t f = 0; f < frames; ++f){
+        for(size_t ch = 0; ch < channels; ++ch){
+            data[f * channels + ch] *= gains[f];
+        }
+    }
+}
+
+void AJ::dsp::kernels::reverseScalar(float *front, float *back, size_t frames, size_t channels){
+    if(channels == 1){
+        std::swap_ranges(front, front + frames, std::make_reverse_iterator(back + frames));
+        return;
+    }
+
+    for(size_t f = 0; f < frames; ++f){
+        float *mirror = back + (frames - 1 - f) * channels;
+        for(size_t ch = 0; ch < channels; ++ch){
+            std::swap(front[f * channels + ch], mirror[ch]);
+        }
+    }
+}
+
+void AJ::dsp::kernels::mixAddScalar(const float *in, float *out, size_t frames, float left, float right){
+    for(size_t f = 0; f < frames; ++f){
+        out[2 * f] += left * in[2 * f];
+        out[2 * f + 1] += right * in[2 * f + 1];
+    }
+}
+
+size_t AJ::dsp::kernels::findAboveScalar(const float *data, size_t count, float threshold){
+    for(size_t i = 0; i < count; ++i){
+        if(std::fabs(data[i]) > threshold){
+            return i;
+        }
+    }
+    return count;
+}
+
+size_t AJ::dsp::kernels::findLastAboveScalar(const float *data, size_t count, float threshold){
+    for(size_t i = count; i > 0; --i){
+        if(std::fabs(data[i - 1]) > threshold){
+            return i;
+        }
+    }
+    return 0;
+}
+
+void AJ::dsp::kernels::glideScalar(float *gains, size_t count, float start, float target, float coef){
+    float distance = start - target;
+    for(size_t i = 0; i < count; ++i){
+        distance *= coef;
+        gains[i] = target + distance;
+    }
+}
+
+void AJ::dsp::kernels::combScalar(float *line, float gain, const float *in, float *acc, size_t count){
+    for(size_t i = 0; i < count; ++i){
+        line[i] = in[i] + gain * line[i];
+        acc[i] += line[i];
+    }
+}
+
+float AJ::dsp::kernels::tanhApprox(float x, TanhApprox approx){
+    if(approx == TanhApprox::Fast){
+        //? [3/2] Padé: x (27 + x^2) / (27 + 9 x^2), equals 1 at x = 3.
+        x = std::clamp(x, -3.0f, 3.0f);
+        const float x2 = x * x;
+        return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+    }
+
+    //? [7/6] Padé of the tanh continued fraction.
+    x = std::clamp(x, -4.97f, 4.97f);
+    const float x2 = x * x;
+    return x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)))
+        / (135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f)));
+}
+
+void AJ::dsp::kernels::shapeScalar(float *data, size_t count, const ShapeParams &params){
+    switch(params.curve){
+    case Curve::HardClip:
+        for(size_t i = 0; i < count; ++i){
+            data[i] = std::clamp(data[i] * params.drive, -1.0f, 1.0f);
+        }
+        break;
+
+    case Curve::Cubic:
+        for(size_t i = 0; i < count; ++i){
+            const float u = std::clamp(data[i] * params.drive, -1.0f, 1.0f);
+            data[i] = 1.5f * u - 0.5f * u * u * u;
+        }
+        break;
+
+    default:
+        for(size_t i = 0; i < count; ++i){
+            const bool positive = data[i] >= 0.0f;
+            const float drive = positive ? params.drive : params.driveNeg;
+            const float makeup = positive ? params.makeup : params.makeupNeg;
+
+            data[i] = tanhApprox(data[i] * drive, params.approx) * makeup;
+        }
+        break;
+    }
+}
+
+AJ::dsp::kernels::Levels AJ::dsp::kernels::analyzeScalar(const float *data, size_t count){
+    Levels levels{FLT_MAX, -FLT_MAX, 0.0};
+
+    for(size_t i = 0; i < count; ++i){
+        const double sample = data[i];
+
+        levels.min = std::min(levels.min, data[i]);
+        levels.max = std::max(levels.max, data[i]);
+        levels.sumSquares += sample * sample;
+    }
+
+    return levels;
+}
+
+void AJ::dsp::kernels::interleaveScalar(const float *left, const float *right, float *out, size_t frames){
+    for(size_t i = 0; i < frames; ++i){
+        out[2 * i] = left[i];
+        out[2 * i + 1] = right[i];
+    }
+}
+
+void AJ::dsp::kernels::deinterleaveScalar(const float *in, float *left, float *right, size_t frames){
+    for(size_t i = 0; i < frames; ++i){
+        left[i] = in[2 * i];
+        right[i] = in[2 * i + 1];
+    }
+}
+
+void AJ::dsp::kernels::toInt16Scalar(const float *in, int16_t *out, size_t count, const float *dither){
+    for(size_t i = 0; i < count; ++i){
+        const float sample = in[i] * 32767.0f + (dither ? dither[i] : 0.0f);
+        out[i] = static_cast<int16_t>(std::lrint(std::clamp(sample, -32768.0f, 32767.0f)));
+    }
+}
+
+void AJ::dsp::kernels::fromInt16Scalar(const int16_t *in, float *out, size_t count){
+    for(size_t i = 0; i < count; ++i){
+        out[i] = in[i] * (1.0f / 32768.0f);
+    }
+}
+
+void AJ::dsp::kernels::toInt32Scalar(const float *in, int32_t *out, size_t count, float scale, const float *dither){
+    //? 2^31 - 1 isn't a float, the largest float below 2^31 keeps the conversion in range.
+    const float hi = std::min(scale, 2147483520.0f);
+    const float lo = -scale - 1.0f;
+
+    for(size_t i = 0; i < count; ++i){
+        const float sample = in[i] * scale + (dither ? dither[i] : 0.0f);
+        out[i] = static_cast<int32_t>(std::lrint(std::clamp(sample, lo, hi)));
+    }
+}
+
+void AJ::dsp::kernels::toHalfScalar(const float *in, uint16_t *out, size_t count){
+    constexpr uint32_t kInf = 255u << 23;
+    constexpr uint32_t kHalfOverflow = (127u + 16u) << 23;  // 65536, every larger float is inf.
+    constexpr uint32_t kHalfNormal = 113u << 23;            // 2^-14, smallest normal half.
+    constexpr uint32_t kDenormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    for(size_t i = 0; i < count; ++i){
+        uint32_t x;
+        std::memcpy(&x, &in[i], sizeof(x));
+
+        const uint32_t sign = x & 0x80000000u;
+        x ^= sign;
+
+        uint32_t h;
+        if(x >= kHalfOverflow){
+            h = x > kInf ? 0x7e00u : 0x7c00u; // NaN stays a (quiet) NaN.
+        } else if(x < kHalfNormal){
+            //? adding the magic number lets the FPU round the subnormal mantissa (to nearest even).
+            float f, magic;
+            std::memcpy(&f, &x, sizeof(f));
+            std::memcpy(&magic, &kDenormMagic, sizeof(magic));
+            f += magic;
+            std::memcpy(&h, &f, sizeof(h));
+            h -= kDenormMagic;
+        } else {
+            const uint32_t odd = (x >> 13) & 1u;
+            x += ((15u - 127u) << 23) + 0xfffu + odd; // rebias, round to nearest even.
+            h = x >> 13;
+        }
+
+        out[i] = static_cast<uint16_t>(h | (sign >> 16));
+    }
+}
+
+void AJ::dsp::kernels::fromHalfScalar(const uint16_t *in, float *out, size_t count){
+    constexpr uint32_t kExp = 0x7c00u << 13;
+    constexpr uint32_t kHalfNormal = 113u << 23;
+
+    for(size_t i = 0; i < count; ++i){
+        uint32_t x = (in[i] & 0x7fffu) << 13;
+        const uint32_t exp = x & kExp;
+        x += (127u - 15u) << 23;
+
+        if(exp == kExp){
+            x += (128u - 16u) << 23; // inf / NaN.
+        } else if(exp == 0){
+            //? subnormal: renormalize through a float subtraction.
+            x += 1u << 23;
+            float f, normal;
+            std::memcpy(&f, &x, sizeof(f));
+            std::memcpy(&normal, &kHalfNormal, sizeof(normal));
+            f -= normal;
+            std::memcpy(&x, &f, sizeof(x));
+        }
+
+        x |= static_cast<uint32_t>(in[i] & 0x8000u) << 16;
+        std::memcpy(&out[i], &x, sizeof(x));
+    }
+}
+
+void AJ::dsp::kernels::fromInt32Scalar(const int32_t *in, float *out, size_t count, float gain){
+    for(size_t i = 0; i < count; ++i){
+        out[i] = static_cast<float>(in[i]) * gain;
+    }
+}
+
+void AJ::dsp::kernels::ditherTPDF(float *noise, size_t count, uint32_t &state){
+    uint32_t x = state;
+
+    for(size_t i = 0; i < count; ++i){
+        //* two xorshift32 draws, each uniform in [-0.5, 0.5) LSB.
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        const float a = static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        const float b = static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+
+        noise[i] = a + b - 1.0f;
+    }
+
+    state = x;
+}
+
+AJ::dsp::kernels::Levels AJ::dsp::kernels::combine(const Levels &a, const Levels &b){
+    return { std::min(a.min, b.min), std::max(a.max, b.max), a.sumSquares + b.sumSquares };
+}
+
+float AJ::dsp::kernels::peak(const Levels &levels){
+    //* an empty range has min > max, report 0.
+    return levels.min > levels.max ? 0.0f : std::max(levels.max, -levels.min);
+}
+
+void AJ::dsp::kernels::reverseFrames(float *data, size_t frames, size_t channels){
+    //? with an odd count the middle frame stays where it is.
+    table().reverse(data, data + (frames - frames / 2) * channels, frames / 2, channels);
+}
+
+//* ------------------------------- dispatch -------------------------------
+
+namespace {
+
+AJ::dsp::kernels::ISA resolve(){
+    using namespace AJ::dsp::kernels;
+
+    //? AJ_SIMD lets a deployment (or a test) pin a lower ISA, unsupported values are ignored.
+    if(const char *forced = std::getenv("AJ_SIMD")){
+        for(ISA isa : {ISA::Scalar, ISA::SSE41, ISA::AVX2, ISA::AVX512, ISA::NEON}){
+            if(std::strcmp(forced, name(isa)) == 0 && supported(isa)){
+                return isa;
+            }
+        }
+    }
+
+    return detect();
+}
+
+}
+
+bool AJ::dsp::kernels::supported(ISA isa){
+    switch(isa){
+    case ISA::Scalar:
+        return true;
+
+#if defined(AJ_KERNELS_X86)
+    case ISA::SSE41:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.1");
+    case ISA::AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+    case ISA::AVX512:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512f");
+#endif
+
+#if defined(AJ_KERNELS_NEON)
+    case ISA::NEON:
+        return true; // NEON is part of the aarch64 baseline.
+#endif
+
+    default:
+        return false;
+    }
+}
+
+AJ::dsp::kernels::ISA AJ::dsp::kernels::detect(){
+    for(ISA isa : {ISA::AVX512, ISA::AVX2, ISA::SSE41, ISA::NEON}){
+        if(supported(isa)) return isa;
+    }
+
+    return ISA::Scalar;
+}
+
+AJ::dsp::kernels::KernelTable AJ::dsp::kernels::tableFor(ISA isa){
+    if(!supported(isa)){
+        isa = ISA::Scalar;
+    }
+
+    switch(isa){
+#if defined(AJ_KERNELS_X86)
+    case ISA::SSE41:
+        return { ISA::SSE41, gainSSE41, scaleSSE41, fadeSSE41, echoSSE41, combSSE41, shapeSSE41, analyzeSSE41,
+            interleaveSSE41, deinterleaveSSE41, toInt16SSE41, fromInt16SSE41, toInt32SSE41, fromInt32SSE41,
+            toHalfScalar, fromHalfScalar, mulAddSSE41, complexMulAddSSE41, butterflySSE41,
+            phaseAnalyzeSSE41, phaseSynthesizeSSE41, crossCorrelateSSE41, polyphaseSSE41,
+            biquadSSE41, framePeakSSE41, frameGainSSE41, reverseSSE41,
+            mixAddSSE41, findAboveSSE41, findLastAboveSSE41, glideSSE41 };
+    case ISA::AVX2:
+        return { ISA::AVX2, gainAVX2, scaleAVX2, fadeAVX2, echoAVX2, combAVX2, shapeAVX2, analyzeAVX2,
+            interleaveAVX2, deinterleaveAVX2, toInt16AVX2, fromInt16AVX2, toInt32AVX2, fromInt32AVX2,
+            toHalfAVX2, fromHalfAVX2, mulAddAVX2, complexMulAddAVX2, butterflyAVX2,
+            phaseAnalyzeAVX2, phaseSynthesizeAVX2, crossCorrelateAVX2, polyphaseAVX2,
+            biquadAVX2, framePeakAVX2, frameGainAVX2, reverseAVX2,
+            mixAddAVX2, findAboveAVX2, findLastAboveAVX2, glideAVX2 };
+    case ISA::AVX512:
+        return { ISA::AVX512, gainAVX512, scaleAVX512, fadeAVX512, echoAVX512, combAVX512, shapeAVX512, analyzeAVX512,
+            interleaveAVX512, deinterleaveAVX512, toInt16AVX512, fromInt16AVX512, toInt32AVX512, fromInt32AVX512,
+            toHalfAVX512, fromHalfAVX512, mulAddAVX512, complexMulAddAVX512, butterflyAVX512,
+            phaseAnalyzeAVX512, phaseSynthesizeAVX512, crossCorrelateAVX512, polyphaseAVX512,
+            biquadAVX512, framePeakAVX512, frameGainAVX512, reverseAVX512,
+            mixAddAVX512, findAboveAVX512, findLastAboveAVX512, glideAVX512 };
+#endif
+
+#if defined(AJ_KERNELS_NEON)
+    case ISA::NEON:
+        return { ISA::NEON, gainNEON, scaleNEON, fadeNEON, echoNEON, combNEON, shapeNEON, analyzeNEON,
+            interleaveNEON, deinterleaveNEON, toInt16NEON, fromInt16NEON, toInt32NEON, fromInt32NEON,
+            toHalfNEON, fromHalfNEON, mulAddNEON, complexMulAddNEON, butterflyNEON,
+            phaseAnalyzeNEON, phaseSynthesizeNEON, crossCorrelateNEON, polyphaseNEON,
+            biquadNEON, framePeakNEON, frameGainNEON, reverseNEON,
+            mixAddNEON, findAboveNEON, findLastAboveNEON, glideNEON };
+#endif
+
+    default:
+        return { ISA::Scalar, gainScalar, scaleScalar, fadeScalar, echoScalar, combScalar, shapeScalar, analyzeScalar,
+            interleaveScalar, deinterleaveScalar, toInt16Scalar, fromInt16Scalar, toInt32Scalar, fromInt32Scalar,
+            toHalfScalar, fromHalfScalar, mulAddScalar, complexMulAddScalar, butterflyScalar,
+            phaseAnalyzeScalar, phaseSynthesizeScalar, crossCorrelateScalar, polyphaseScalar,
+            biquadScalar, framePeakScalar, frameGainScalar, reverseScalar,
+            mixAddScalar, findAboveScalar, findLastAboveScalar, glideScalar };
+    }
+}
+
+const AJ::dsp::kernels::KernelTable& AJ::dsp::kernels::table(){
+    static const KernelTable kTable = tableFor(resolve());
+    return kTable;
+}
+
+void AJ::dsp::kernels::init(){
+    (void)table();
+}
+
+const char* AJ::dsp::kernels::name(ISA isa){
+    switch(isa){
+    case ISA::SSE41:  return "sse4.1";
+    case ISA::AVX2:   return "avx2";
+    case ISA::AVX512: return "avx512";
+    case ISA::NEON:   return "neon";
+    default:          return "scalar";
+    }
+}
@@ -0,0 +1,41 @@
+# DSP kernels, one static library per instruction set.
+# Each library is built with only its own ISA enabled, the rest of the engine stays
+# portable and picks the kernels at runtime (see include/dsp/kernels.h).
+
+set(AJ_KERNEL_LIBS)
+
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64|amd64|i[3-6]86")
+    # SSE4.1 Kernels
+    add_library(
+        kernels_sse41 STATIC src/dsp/kernels/kernels_sse41.cc
+    )
+    target_compile_options(
+        kernels_sse41 PRIVATE -msse4.1
+    )
+
+    # AVX2 + FMA (+ F16C) Kernels
+    add_library(
+        kernels_avx2 STATIC src/dsp/kernels/kernels_avx2.cc
+    )
+    target_compile_options(
+        kernels_avx2 PRIVATE -mavx2 -mfma -mf16c
+    )
+
+    # AVX-512 Kernels
+    add_library(
+        kernels_avx512 STATIC src/dsp/kernels/kernels_avx512.cc
+    )
+    target_compile_options(
+        kernels_avx512 PRIVATE -mavx512f
+    )
+
+    list(APPEND AJ_KERNEL_LIBS kernels_sse41 kernels_avx2 kernels_avx512)
+
+elseif(CMAKE_SYSTEM_PROCESSOR MATCHES "aarch64|arm64|ARM64")
+    # NEON Kernels (NEON is part of the aarch64 baseline)
+    add_library(
+        kernels_neon STATIC src/dsp/kernels/kernels_neon.cc
+    )
+
+    list(APPEND AJ_KERNEL_LIBS kernels_neon)
+endif()
@@ -0,0 +1,796 @@
+#include "dsp/kernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <immintrin.h>
+/*
+    - AVX2 + FMA - 256-bit operations (8 floats), F16C for the half conversions.
+    ! built with -mavx2 -mfma -mf16c only, don't include engine headers here (see dsp/kernels.h).
+*/
+
+namespace {
+
+inline float clampSample(float sample){
+    return sample > 1.0f ? 1.0f : (sample < -1.0f ? -1.0f : sample);
+}
+
+inline __m256 clamp8(__m256 samples){
+    return _mm256_max_ps(_mm256_min_ps(samples, _mm256_set1_ps(1.0f)), _mm256_set1_ps(-1.0f));
+}
+
+inline float horizontalSum8(__m256 v){
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    return _mm_cvtss_f32(_mm_add_ss(sum, _mm_movehdup_ps(sum)));
+}
+
+//* biquad pipeline: lanes move up by one stage (`channels` lanes), `prev` fills the lowest ones.
+
+inline __m256 shiftStage8(__m256 cur, __m256 prev, size_t channels){
+    const __m256i c = _mm256_castps_si256(cur);
+    const __m256i t = _mm256_castps_si256(_mm256_permute2f128_ps(prev, cur, 0x21));
+    return _mm256_castsi256_ps(channels == 1 ? _mm256_alignr_epi8(c, t, 12) : _mm256_alignr_epi8(c, t, 8));
+}
+
+//* the frame in the highest `channels` lanes (every lane holds a copy).
+inline __m256 broadcastFrame8(const float *frame, size_t channels){
+    return channels == 1 ? _mm256_broadcast_ss(frame)
+        : _mm256_castpd_ps(_mm256_broadcast_sd(reinterpret_cast<const double*>(frame)));
+}
+
+
+//* phase kernels: same approximations as the scalar ones (see kernels.cc).
+
+inline __m256 abs8(__m256 x){
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+}
+
+inline __m256 wrapPhase8(__m256 x){
+    const __m256 turns = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.0f / 6.28318531f)),
+        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    return _mm256_fnmadd_ps(turns, _mm256_set1_ps(6.28318531f), x);
+}
+
+inline __m256 atan2Approx8(__m256 y, __m256 x){
+    const __m256 ax = abs8(x), ay = abs8(y);
+    const __m256 a = _mm256_div_ps(_mm256_min_ps(ax, ay), _mm256_max_ps(_mm256_max_ps(ax, ay), _mm256_set1_ps(FLT_MIN)));
+    const __m256 s = _mm256_mul_ps(a, a);
+
+    __m256 p = _mm256_fmadd_ps(s, _mm256_set1_ps(-0.01172120f), _mm256_set1_ps(0.05265332f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-0.11643287f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(0.19354346f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-0.33262347f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(0.99997726f));
+    __m256 r = _mm256_mul_ps(a, p);
+
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(1.57079633f), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(3.14159265f), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+    return _mm256_or_ps(r, _mm256_and_ps(y, _mm256_set1_ps(-0.0f)));
+}
+
+inline void sinCosApprox8(__m256 x, __m256 &sin, __m256 &cos){
+    const __m256 j = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.636619772f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(j, _mm256_set1_ps(1.5703125f), x);
+    r = _mm256_fnmadd_ps(j, _mm256_set1_ps(4.83751297e-4f), r);
+    r = _mm256_fnmadd_ps(j, _mm256_set1_ps(7.54978995e-8f), r);
+    const __m256 r2 = _mm256_mul_ps(r, r);
+
+    __m256 ps = _mm256_fmadd_ps(r2, _mm256_set1_ps(-1.9515295891e-4f), _mm256_set1_ps(8.3321608736e-3f));
+    ps = _mm256_fmadd_ps(ps, r2, _mm256_set1_ps(-1.6666654611e-1f));
+    ps = _mm256_fmadd_ps(_mm256_mul_ps(r, r2), ps, r);
+
+    __m256 pc = _mm256_fmadd_ps(r2, _mm256_set1_ps(2.443315712e-5f), _mm256_set1_ps(-1.388731625e-3f));
+    pc = _mm256_fmadd_ps(pc, r2, _mm256_set1_ps(4.166664568e-2f));
+    pc = _mm256_fmadd_ps(_mm256_mul_ps(r2, r2), pc, _mm256_fnmadd_ps(r2, _mm256_set1_ps(0.5f), _mm256_set1_ps(1.0f)));
+
+    //* quadrant q: odd swaps sin / cos, sin is negated for q = 2, 3, cos for q = 1, 2.
+    const __m256i q = _mm256_cvtps_epi32(j);
+    const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+    const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30));
+    const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)),
+        _mm256_set1_epi32(2)), 30));
+
+    sin = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, swap), sinSign);
+    cos = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, swap), cosSign);
+}
+
+}
+
+void AJ::dsp::kernels::gainAVX2(float *data, size_t count, float gain){
+    const __m256 gain_v = _mm256_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_ps(&data[i], clamp8(_mm256_mul_ps(_mm256_loadu_ps(&data[i]), gain_v)));
+    }
+
+    // calculate the rest if there.
+    for(; i < count; ++i){
+        data[i] = clampSample(data[i] * gain);
+    }
+}
+
+void AJ::dsp::kernels::scaleAVX2(float *data, size_t count, float gain){
+    const __m256 gain_v = _mm256_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_ps(&data[i], _mm256_mul_ps(_mm256_loadu_ps(&data[i]), gain_v));
+    }
+
+    for(; i < count; ++i){
+        data[i] *= gain;
+    }
+}
+
+void AJ::dsp::kernels::fadeAVX2(float *data, size_t count, double startGain, double step){
+    //* the gain of the first lane is computed in double per vector so it doesn't drift,
+    //* the other lanes are steps ahead of it.
+    const __m256 lanes = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 step_v = _mm256_set1_ps(static_cast<float>(step));
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256 gain = _mm256_fmadd_ps(lanes, step_v, _mm256_set1_ps(static_cast<float>(startGain + step * i)));
+        _mm256_storeu_ps(&data[i], clamp8(_mm256_mul_ps(_mm256_loadu_ps(&data[i]), gain)));
+    }
+
+    for(; i < count; ++i){
+        data[i] = clampSample(data[i] * static_cast<float>(startGain + step * i));
+    }
+}
+
+void AJ::dsp::kernels::echoAVX2(const float *in, const float *delayed, float *out, size_t count, float decay){
+    const __m256 decay_v = _mm256_set1_ps(decay);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        // out = in + delayed * decay
+        __m256 samples = _mm256_fmadd_ps(_mm256_loadu_ps(&delayed[i]), decay_v, _mm256_loadu_ps(&in[i]));
+        _mm256_storeu_ps(&out[i], clamp8(samples));
+    }
+
+    for(; i < count; ++i){
+        out[i] = clampSample(in[i] + delayed[i] * decay);
+    }
+}
+
+void AJ::dsp::kernels::mulAddAVX2(const float *in, const float *delayed, float *out, size_t count, float gain){
+    const __m256 gain_v = _mm256_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_ps(&out[i], _mm256_fmadd_ps(_mm256_loadu_ps(&delayed[i]), gain_v, _mm256_loadu_ps(&in[i])));
+    }
+
+    for(; i < count; ++i){
+        out[i] = in[i] + delayed[i] * gain;
+    }
+}
+
+void AJ::dsp::kernels::complexMulAddAVX2(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count){
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        const __m256 ar = _mm256_loadu_ps(&aRe[i]), ai = _mm256_loadu_ps(&aIm[i]);
+        const __m256 br = _mm256_loadu_ps(&bRe[i]), bi = _mm256_loadu_ps(&bIm[i]);
+
+        // (ar + j ai)(br + j bi) = (ar br - ai bi) + j (ar bi + ai br)
+        _mm256_storeu_ps(&accRe[i], _mm256_fmadd_ps(ar, br, _mm256_fnmadd_ps(ai, bi, _mm256_loadu_ps(&accRe[i]))));
+        _mm256_storeu_ps(&accIm[i], _mm256_fmadd_ps(ar, bi, _mm256_fmadd_ps(ai, br, _mm256_loadu_ps(&accIm[i]))));
+    }
+
+    for(; i < count; ++i){
+        accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+        accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+    }
+}
+
+void AJ::dsp::kernels::butterflyAVX2(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count){
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        const __m256 xr = _mm256_loadu_ps(&ar[i]), xi = _mm256_loadu_ps(&ai[i]);
+        const __m256 yr = _mm256_loadu_ps(&br[i]), yi = _mm256_loadu_ps(&bi[i]);
+        const __m256 cr = _mm256_loadu_ps(&wr[i]), ci = _mm256_loadu_ps(&wi[i]);
+
+        // v = b * w
+        const __m256 vr = _mm256_fmsub_ps(yr, cr, _mm256_mul_ps(yi, ci));
+        const __m256 vi = _mm256_fmadd_ps(yr, ci, _mm256_mul_ps(yi, cr));
+
+        _mm256_storeu_ps(&br[i], _mm256_sub_ps(xr, vr));
+        _mm256_storeu_ps(&bi[i], _mm256_sub_ps(xi, vi));
+        _mm256_storeu_ps(&ar[i], _mm256_add_ps(xr, vr));
+        _mm256_storeu_ps(&ai[i], _mm256_add_ps(xi, vi));
+    }
+
+    for(; i < count; ++i){
+        const float vr = br[i] * wr[i] - bi[i] * wi[i];
+        const float vi = br[i] * wi[i] + bi[i] * wr[i];
+
+        br[i] = ar[i] - vr;
+        bi[i] = ai[i] - vi;
+        ar[i] += vr;
+        ai[i] += vi;
+    }
+}
+
+void AJ::dsp::kernels::phaseAnalyzeAVX2(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase){
+    const __m256 hop_v = _mm256_set1_ps(hopPhase);
+    const __m256 invHop_v = _mm256_set1_ps(1.0f / hopPhase);
+    const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        const __m256 xr = _mm256_loadu_ps(&re[i]), xi = _mm256_loadu_ps(&im[i]);
+        const __m256 bin = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(first + i)), lanes);
+        const __m256 phase = atan2Approx8(xi, xr);
+
+        // freq = k + wrap(phase - last - k * hop) / hop
+        const __m256 delta = _mm256_fnmadd_ps(bin, hop_v, _mm256_sub_ps(phase, _mm256_loadu_ps(&lastPhase[i])));
+        _mm256_storeu_ps(&mag[i], _mm256_sqrt_ps(_mm256_fmadd_ps(xr, xr, _mm256_mul_ps(xi, xi))));
+        _mm256_storeu_ps(&freq[i], _mm256_fmadd_ps(wrapPhase8(delta), invHop_v, bin));
+        _mm256_storeu_ps(&lastPhase[i], phase);
+    }
+
+    if(i < count){
+        phaseAnalyzeScalar(re + i, im + i, lastPhase + i, mag + i, freq + i, first + i, count - i, hopPhase);
+    }
+}
+
+void AJ::dsp::kernels::phaseSynthesizeAVX2(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase){
+    const __m256 hop_v = _mm256_set1_ps(hopPhase);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        const __m256 phase = wrapPhase8(_mm256_fmadd_ps(_mm256_loadu_ps(&freq[i]), hop_v, _mm256_loadu_ps(&sumPhase[i])));
+        const __m256 m = _mm256_loadu_ps(&mag[i]);
+        __m256 sin, cos;
+        sinCosApprox8(phase, sin, cos);
+
+        _mm256_storeu_ps(&sumPhase[i], phase);
+        _mm256_storeu_ps(&re[i], _mm256_mul_ps(m, cos));
+        _mm256_storeu_ps(&im[i], _mm256_mul_ps(m, sin));
+    }
+
+    if(i < count){
+        phaseSynthesizeScalar(mag + i, freq + i, sumPhase + i, re + i, im + i, count - i, hopPhase);
+    }
+}
+
+void AJ::dsp::kernels::crossCorrelateAVX2(const float *x, const float *ref, float *out, size_t lags, size_t length){
+    //* 8 lags per vector: every reference sample is broadcast and multiplied with 8 shifted windows at once.
+    size_t l = 0;
+    for(; l + 32 <= lags; l += 32){
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+
+        for(size_t i = 0; i < length; ++i){
+            const __m256 r = _mm256_set1_ps(ref[i]);
+            const float *p = &x[l + i];
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(p), r, acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(p + 8), r, acc1);
+            acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(p + 16), r, acc2);
+            acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(p + 24), r, acc3);
+        }
+
+        _mm256_storeu_ps(&out[l], acc0);
+        _mm256_storeu_ps(&out[l + 8], acc1);
+        _mm256_storeu_ps(&out[l + 16], acc2);
+        _mm256_storeu_ps(&out[l + 24], acc3);
+    }
+
+    for(; l + 8 <= lags; l += 8){
+        __m256 acc = _mm256_setzero_ps();
+        for(size_t i = 0; i < length; ++i){
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(&x[l + i]), _mm256_set1_ps(ref[i]), acc);
+        }
+        _mm256_storeu_ps(&out[l], acc);
+    }
+
+    crossCorrelateScalar(x + l, ref, out + l, lags - l, length);
+}
+
+void AJ::dsp::kernels::polyphaseAVX2(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count){
+    //* one output per dot product: 16 taps per iteration over two accumulators, summed across lanes at the end.
+    for(size_t k = 0; k < count; ++k){
+        const float *h = bank + phase * taps;
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+
+        size_t i = 0;
+        for(; i + 16 <= taps; i += 16){
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i]), _mm256_loadu_ps(&h[i]), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i + 8]), _mm256_loadu_ps(&h[i + 8]), acc1);
+        }
+
+        for(; i + 8 <= taps; i += 8){
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i]), _mm256_loadu_ps(&h[i]), acc0);
+        }
+
+        float sum = horizontalSum8(_mm256_add_ps(acc0, acc1));
+        for(; i < taps; ++i){
+            sum += x[i] * h[i];
+        }
+        out[k] = sum;
+
+        phase += step;
+        x += phase / phases;
+        phase %= phases;
+    }
+}
+
+void AJ::dsp::kernels::biquadAVX2(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs,
+    float *state){
+    constexpr size_t kVectors = kBiquadLanes / 8;
+    const size_t vectors = (lanes + 7) / 8;
+    const size_t stages = vectors * 8 / channels;
+
+    __m256 b0[kVectors], b1[kVectors], b2[kVectors], a1[kVectors], a2[kVectors];
+    __m256 s1[kVectors], s2[kVectors], y[kVectors], stage[kVectors];
+
+    for(size_t v = 0; v < vectors; ++v){
+        b0[v] = _mm256_loadu_ps(&coeffs[v * 8]);
+        b1[v] = _mm256_loadu_ps(&coeffs[kBiquadLanes + v * 8]);
+        b2[v] = _mm256_loadu_ps(&coeffs[2 * kBiquadLanes + v * 8]);
+        a1[v] = _mm256_loadu_ps(&coeffs[3 * kBiquadLanes + v * 8]);
+        a2[v] = _mm256_loadu_ps(&coeffs[4 * kBiquadLanes + v * 8]);
+        s1[v] = _mm256_loadu_ps(&state[v * 8]);
+        s2[v] = _mm256_loadu_ps(&state[kBiquadLanes + v * 8]);
+        y[v] = _mm256_setzero_ps();
+
+        float index[8];
+        for(size_t l = 0; l < 8; ++l) index[l] = static_cast<float>((v * 8 + l) / channels);
+        stage[v] = _mm256_loadu_ps(index);
+    }
+
+    //* step t: stage k filters frame t - k. While filling / draining only the stages holding a frame update their state.
+    const size_t steps = frames + stages - 1;
+    for(size_t t = 0; t < steps; ++t){
+        const bool full = t + 1 >= stages && t < frames;
+        const __m256 x = t < frames ? broadcastFrame8(&data[t * channels], channels) : _mm256_setzero_ps();
+        const __m256 hi = _mm256_set1_ps(static_cast<float>(std::min(t, stages)));
+        const __m256 lo = _mm256_set1_ps(static_cast<float>(t >= frames ? t - frames + 1 : 0));
+
+        //* last vector first: y[v - 1] still holds the previous step.
+        for(size_t v = vectors; v-- > 0;){
+            const __m256 in = shiftStage8(y[v], v == 0 ? x : y[v - 1], channels);
+            const __m256 out = _mm256_fmadd_ps(b0[v], in, s1[v]);
+            __m256 n1 = _mm256_fnmadd_ps(a1[v], out, _mm256_fmadd_ps(b1[v], in, s2[v]));
+            __m256 n2 = _mm256_fnmadd_ps(a2[v], out, _mm256_mul_ps(b2[v], in));
+
+            if(!full){
+                const __m256 active = _mm256_and_ps(_mm256_cmp_ps(stage[v], hi, _CMP_LE_OQ),
+                    _mm256_cmp_ps(stage[v], lo, _CMP_GE_OQ));
+                n1 = _mm256_blendv_ps(s1[v], n1, active);
+                n2 = _mm256_blendv_ps(s2[v], n2, active);
+            }
+
+            s1[v] = n1;
+            s2[v] = n2;
+            y[v] = out;
+        }
+
+        if(t + 1 >= stages){
+            const __m128 top = _mm256_extractf128_ps(y[vectors - 1], 1);
+            float *frame = &data[(t + 1 - stages) * channels];
+            if(channels == 1){
+                *frame = _mm_cvtss_f32(_mm_shuffle_ps(top, top, _MM_SHUFFLE(3, 3, 3, 3)));
+            } else {
+                _mm_storeh_pi(reinterpret_cast<__m64*>(frame), top);
+            }
+        }
+    }
+
+    for(size_t v = 0; v < vectors; ++v){
+        _mm256_storeu_ps(&state[v * 8], s1[v]);
+        _mm256_storeu_ps(&state[kBiquadLanes + v * 8], s2[v]);
+    }
+}
+
+void AJ::dsp::kernels::framePeakAVX2(const float *data, size_t frames, size_t channels, float *peaks){
+    size_t f = 0;
+
+    if(channels == 1){
+        for(; f + 8 <= frames; f += 8){
+            _mm256_storeu_ps(&peaks[f], abs8(_mm256_loadu_ps(&data[f])));
+        }
+    } else if(channels == 2){
+        for(; f + 8 <= frames; f += 8){
+            const __m256 a = abs8(_mm256_loadu_ps(&data[2 * f]));
+            const __m256 b = abs8(_mm256_loadu_ps(&data[2 * f + 8]));
+            //* per 128-bit lane: frames 0 1 4 5 | 2 3 6 7, put back in order.
+            const __m256 m = _mm256_max_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            _mm256_storeu_ps(&peaks[f], _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(m), _MM_SHUFFLE(3, 1, 2, 0))));
+        }
+    }
+
+    framePeakScalar(data + f * channels, frames - f, channels, peaks + f);
+}
+
+void AJ::dsp::kernels::frameGainAVX2(float *data, size_t frames, size_t channels, const float *gains){
+    size_t f = 0;
+
+    if(channels == 1){
+        for(; f + 8 <= frames; f += 8){
+            _mm256_storeu_ps(&data[f], _mm256_mul_ps(_mm256_loadu_ps(&data[f]), _mm256_loadu_ps(&gains[f])));
+        }
+    } else if(channels == 2){
+        for(; f + 8 <= frames; f += 8){
+            const __m256 g = _mm256_loadu_ps(&gains[f]);
+            const __m256 lo = _mm256_unpacklo_ps(g, g), hi = _mm256_unpackhi_ps(g, g);
+            _mm256_storeu_ps(&data[2 * f], _mm256_mul_ps(_mm256_loadu_ps(&data[2 * f]), _mm256_permute2f128_ps(lo, hi, 0x20)));
+            _mm256_storeu_ps(&data[2 * f + 8], _mm256_mul_ps(_mm256_loadu_ps(&data[2 * f + 8]), _mm256_permute2f128_ps(lo, hi, 0x31)));
+        }
+    }
+
+    frameGainScalar(data + f * channels, frames - f, channels, gains + f);
+}
+
+void AJ::dsp::kernels::reverseAVX2(float *front, float *back, size_t frames, size_t channels){
+    size_t f = 0;
+
+    if(channels == 1 || channels == 2){
+        const size_t step = 8 / channels;
+        const __m256i order = channels == 1 ? _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)
+                                            : _mm256_setr_epi32(6, 7, 4, 5, 2, 3, 0, 1);
+        float *end = back + frames * channels;
+
+        for(; f + step <= frames; f += step){
+            float *mirror = end - (f + step) * channels;
+            const __m256 a = _mm256_loadu_ps(&front[f * channels]);
+            const __m256 b = _mm256_loadu_ps(mirror);
+            _mm256_storeu_ps(&front[f * channels], _mm256_permutevar8x32_ps(b, order));
+            _mm256_storeu_ps(mirror, _mm256_permutevar8x32_ps(a, order));
+        }
+    }
+
+    reverseScalar(front + f * channels, back, frames - f, channels);
+}
+
+void AJ::dsp::kernels::mixAddAVX2(const float *in, float *out, size_t frames, float left, float right){
+    const __m256 gain_v = _mm256_setr_ps(left, right, left, right, left, right, left, right);
+
+    size_t f = 0;
+    for(; f + 4 <= frames; f += 4){
+        _mm256_storeu_ps(&out[2 * f], _mm256_fmadd_ps(_mm256_loadu_ps(&in[2 * f]), gain_v, _mm256_loadu_ps(&out[2 * f])));
+    }
+
+    mixAddScalar(in + 2 * f, out + 2 * f, frames - f, left, right);
+}
+
+size_t AJ::dsp::kernels::findAboveAVX2(const float *data, size_t count, float threshold){
+    const __m256 threshold_v = _mm256_set1_ps(threshold);
+
+    size_t i = 0;
+    for(; i + 32 <= count; i += 32){
+        const __m256 a = _mm256_cmp_ps(abs8(_mm256_loadu_ps(&data[i])), threshold_v, _CMP_GT_OQ);
+        const __m256 b = _mm256_cmp_ps(abs8(_mm256_loadu_ps(&data[i + 8])), threshold_v, _CMP_GT_OQ);
+        const __m256 c = _mm256_cmp_ps(abs8(_mm256_loadu_ps(&data[i + 16])), threshold_v, _CMP_GT_OQ);
+        const __m256 d = _mm256_cmp_ps(abs8(_mm256_loadu_ps(&data[i + 24])), threshold_v, _CMP_GT_OQ);
+        if(_mm256_movemask_ps(_mm256_or_ps(_mm256_or_ps(a, b), _mm256_or_ps(c, d)))){
+            break;
+        }
+    }
+
+    return i + findAboveScalar(data + i, count - i, threshold);
+}
+
+size_t AJ::dsp::kernels::findLastAboveAVX2(const float *data, size_t count, float threshold){
+    const __m256 threshold_v = _mm256_set1_ps(threshold);
+
+    size_t i = count;
+    for(; i >= 32; i -= 32){
+        const float *block = data + i - 32;
+        const __m256 a = _mm256_cmp_ps(abs8(_mm256_loadu_ps(&block[0])), threshold_v, _CMP_GT_OQ);
+        const __m256 b = _mm256_cmp_ps(abs8(_mm256_loadu_ps(&block[8])), threshold_v, _CMP_GT_OQ);
+        const __m256 c = _mm256_cmp_ps(abs8(_mm256_loadu_ps(&block[16])), threshold_v, _CMP_GT_OQ);
+        const __m256 d = _mm256_cmp_ps(abs8(_mm256_loadu_ps(&block[24])), threshold_v, _CMP_GT_OQ);
+        if(_mm256_movemask_ps(_mm256_or_ps(_mm256_or_ps(a, b), _mm256_or_ps(c, d)))){
+            break;
+        }
+    }
+
+    return findLastAboveScalar(data, i, threshold);
+}
+
+void AJ::dsp::kernels::glideAVX2(float *gains, size_t count, float start, float target, float coef){
+    //* lane k is k + 1 steps in, a vector moves every lane 8 steps further.
+    alignas(32) float powers[8];
+    float power = coef;
+    for(float &lane : powers){
+        lane = power;
+        power *= coef;
+    }
+
+    const __m256 step_v = _mm256_set1_ps(powers[7]);
+    const __m256 target_v = _mm256_set1_ps(target);
+    __m256 distance = _mm256_mul_ps(_mm256_set1_ps(start - target), _mm256_load_ps(powers));
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_ps(&gains[i], _mm256_add_ps(target_v, distance));
+        distance = _mm256_mul_ps(distance, step_v);
+    }
+
+    glideScalar(gains + i, count - i, i ? gains[i - 1] : start, target, coef);
+}
+
+void AJ::dsp::kernels::combAVX2(float *line, float gain, const float *in, float *acc, size_t count){
+    const __m256 gain_v = _mm256_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        // y[n] = x[n] + g * y[n - M], the 8 taps y[n - M] are the next 8 samples of the line
+        __m256 out = _mm256_fmadd_ps(_mm256_loadu_ps(&line[i]), gain_v, _mm256_loadu_ps(&in[i]));
+
+        // write back the outputs in place of the taps, add them to the comb bank sum
+        _mm256_storeu_ps(&line[i], out);
+        _mm256_storeu_ps(&acc[i], _mm256_add_ps(_mm256_loadu_ps(&acc[i]), out));
+    }
+
+    for(; i < count; ++i){
+        line[i] = in[i] + gain * line[i];
+        acc[i] += line[i];
+    }
+}
+
+namespace {
+
+//* tanh approximations, see AJ::dsp::kernels::tanhApprox().
+inline __m256 tanhAccurate8(__m256 x){
+    x = _mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(4.97f)), _mm256_set1_ps(-4.97f));
+    const __m256 x2 = _mm256_mul_ps(x, x);
+
+    __m256 num = _mm256_add_ps(_mm256_set1_ps(378.0f), x2);
+    num = _mm256_fmadd_ps(x2, num, _mm256_set1_ps(17325.0f));
+    num = _mm256_mul_ps(x, _mm256_fmadd_ps(x2, num, _mm256_set1_ps(135135.0f)));
+
+    __m256 den = _mm256_fmadd_ps(x2, _mm256_set1_ps(28.0f), _mm256_set1_ps(3150.0f));
+    den = _mm256_fmadd_ps(x2, den, _mm256_set1_ps(62370.0f));
+    den = _mm256_fmadd_ps(x2, den, _mm256_set1_ps(135135.0f));
+
+    return _mm256_div_ps(num, den);
+}
+
+inline __m256 tanhFast8(__m256 x){
+    x = _mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(3.0f)), _mm256_set1_ps(-3.0f));
+    const __m256 x2 = _mm256_mul_ps(x, x);
+
+    return _mm256_div_ps(
+        _mm256_mul_ps(x, _mm256_add_ps(_mm256_set1_ps(27.0f), x2)),
+        _mm256_fmadd_ps(_mm256_set1_ps(9.0f), x2, _mm256_set1_ps(27.0f))
+    );
+}
+
+}
+
+void AJ::dsp::kernels::shapeAVX2(float *data, size_t count, const ShapeParams &params){
+    const __m256 drive = _mm256_set1_ps(params.drive);
+
+    size_t i = 0;
+
+    switch(params.curve){
+    case Curve::HardClip:
+        for(; i + 8 <= count; i += 8){
+            _mm256_storeu_ps(&data[i], clamp8(_mm256_mul_ps(_mm256_loadu_ps(&data[i]), drive)));
+        }
+        break;
+
+    case Curve::Cubic:
+        for(; i + 8 <= count; i += 8){
+            __m256 u = clamp8(_mm256_mul_ps(_mm256_loadu_ps(&data[i]), drive));
+
+            // 1.5 u - 0.5 u^3
+            __m256 u3 = _mm256_mul_ps(_mm256_mul_ps(u, u), u);
+            _mm256_storeu_ps(&data[i], _mm256_fmsub_ps(_mm256_set1_ps(1.5f), u, _mm256_mul_ps(_mm256_set1_ps(0.5f), u3)));
+        }
+        break;
+
+    default: {
+        const __m256 drive_neg = _mm256_set1_ps(params.driveNeg);
+        const __m256 makeup = _mm256_set1_ps(params.makeup);
+        const __m256 makeup_neg = _mm256_set1_ps(params.makeupNeg);
+        const bool fast = params.approx == TanhApprox::Fast;
+
+        for(; i + 8 <= count; i += 8){
+            __m256 samples = _mm256_loadu_ps(&data[i]);
+
+            // per lane drive / makeup: negative samples (mask set) take the negative half values
+            __m256 negative = _mm256_cmp_ps(samples, _mm256_setzero_ps(), _CMP_LT_OQ);
+            __m256 x = _mm256_mul_ps(samples, _mm256_blendv_ps(drive, drive_neg, negative));
+            __m256 y = fast ? tanhFast8(x) : tanhAccurate8(x);
+
+            _mm256_storeu_ps(&data[i], _mm256_mul_ps(y, _mm256_blendv_ps(makeup, makeup_neg, negative)));
+        }
+        break;
+    }
+    }
+
+    // calculate the rest if there.
+    if(i < count){
+        shapeScalar(data + i, count - i, params);
+    }
+}
+
+AJ::dsp::kernels::Levels AJ::dsp::kernels::analyzeAVX2(const float *data, size_t count){
+    __m256 min = _mm256_set1_ps(FLT_MAX);
+    __m256 max = _mm256_set1_ps(-FLT_MAX);
+    // squares are summed in double lanes (2 accumulators per half) so long ranges don't lose precision.
+    __m256d sum_lo = _mm256_setzero_pd();
+    __m256d sum_hi = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256 samples = _mm256_loadu_ps(&data[i]);
+        min = _mm256_min_ps(min, samples);
+        max = _mm256_max_ps(max, samples);
+
+        __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(samples));
+        __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(samples, 1));
+        sum_lo = _mm256_fmadd_pd(lo, lo, sum_lo);
+        sum_hi = _mm256_fmadd_pd(hi, hi, sum_hi);
+    }
+
+    alignas(32) float mins[8];
+    alignas(32) float maxs[8];
+    alignas(32) double sums[4];
+    _mm256_store_ps(mins, min);
+    _mm256_store_ps(maxs, max);
+    _mm256_store_pd(sums, _mm256_add_pd(sum_lo, sum_hi));
+
+    Levels levels{mins[0], maxs[0], (sums[0] + sums[1]) + (sums[2] + sums[3])};
+    for(int lane = 1; lane < 8; ++lane){
+        levels.min = mins[lane] < levels.min ? mins[lane] : levels.min;
+        levels.max = maxs[lane] > levels.max ? maxs[lane] : levels.max;
+    }
+
+    // calculate the rest if there.
+    if(i < count){
+        Levels rest = analyzeScalar(data + i, count - i);
+        levels.min = rest.min < levels.min ? rest.min : levels.min;
+        levels.max = rest.max > levels.max ? rest.max : levels.max;
+        levels.sumSquares += rest.sumSquares;
+    }
+
+    return levels;
+}
+
+void AJ::dsp::kernels::interleaveAVX2(const float *left, const float *right, float *out, size_t frames){
+    size_t i = 0;
+    for(; i + 8 <= frames; i += 8){
+        __m256 l = _mm256_loadu_ps(&left[i]);
+        __m256 r = _mm256_loadu_ps(&right[i]);
+
+        // unpack works per 128-bit lane: lo = l0 r0 l1 r1 | l4 r4 l5 r5, hi = l2 r2 l3 r3 | l6 r6 l7 r7
+        __m256 lo = _mm256_unpacklo_ps(l, r);
+        __m256 hi = _mm256_unpackhi_ps(l, r);
+        _mm256_storeu_ps(&out[2 * i], _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(&out[2 * i + 8], _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+
+    if(i < frames){
+        interleaveScalar(left + i, right + i, out + 2 * i, frames - i);
+    }
+}
+
+void AJ::dsp::kernels::deinterleaveAVX2(const float *in, float *left, float *right, size_t frames){
+    size_t i = 0;
+    for(; i + 8 <= frames; i += 8){
+        __m256 a = _mm256_loadu_ps(&in[2 * i]);     // l0 r0 l1 r1 l2 r2 l3 r3
+        __m256 b = _mm256_loadu_ps(&in[2 * i + 8]); // l4 r4 l5 r5 l6 r6 l7 r7
+
+        // t0 = l0 r0 l1 r1 | l4 r4 l5 r5, t1 = l2 r2 l3 r3 | l6 r6 l7 r7
+        __m256 t0 = _mm256_permute2f128_ps(a, b, 0x20);
+        __m256 t1 = _mm256_permute2f128_ps(a, b, 0x31);
+        _mm256_storeu_ps(&left[i], _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm256_storeu_ps(&right[i], _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    if(i < frames){
+        deinterleaveScalar(in + 2 * i, left + i, right + i, frames - i);
+    }
+}
+
+void AJ::dsp::kernels::toInt16AVX2(const float *in, int16_t *out, size_t count, const float *dither){
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(&in[i]), scale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(&in[i + 8]), scale);
+
+        if(dither){
+            a = _mm256_add_ps(a, _mm256_loadu_ps(&dither[i]));
+            b = _mm256_add_ps(b, _mm256_loadu_ps(&dither[i + 8]));
+        }
+
+        __m256i ia = _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(a, hi), lo));
+        __m256i ib = _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(b, hi), lo));
+
+        // the pack interleaves the 128-bit lanes (a0-3 b0-3 a4-7 b4-7), put them back in order.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(ia, ib), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), packed);
+    }
+
+    if(i < count){
+        toInt16Scalar(in + i, out + i, count - i, dither ? dither + i : nullptr);
+    }
+}
+
+void AJ::dsp::kernels::fromInt16AVX2(const int16_t *in, float *out, size_t count){
+    const __m256 gain = _mm256_set1_ps(1.0f / 32768.0f);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256i values = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i])));
+        _mm256_storeu_ps(&out[i], _mm256_mul_ps(_mm256_cvtepi32_ps(values), gain));
+    }
+
+    if(i < count){
+        fromInt16Scalar(in + i, out + i, count - i);
+    }
+}
+
+void AJ::dsp::kernels::toInt32AVX2(const float *in, int32_t *out, size_t count, float scale, const float *dither){
+    const __m256 scale_v = _mm256_set1_ps(scale);
+    const __m256 hi = _mm256_set1_ps(scale < 2147483520.0f ? scale : 2147483520.0f);
+    const __m256 lo = _mm256_set1_ps(-scale - 1.0f);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256 samples = _mm256_mul_ps(_mm256_loadu_ps(&in[i]), scale_v);
+        if(dither){
+            samples = _mm256_add_ps(samples, _mm256_loadu_ps(&dither[i]));
+        }
+
+        __m256i values = _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(samples, hi), lo));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), values);
+    }
+
+    if(i < count){
+        toInt32Scalar(in + i, out + i, count - i, scale, dither ? dither + i : nullptr);
+    }
+}
+
+void AJ::dsp::kernels::fromInt32AVX2(const int32_t *in, float *out, size_t count, float gain){
+    const __m256 gain_v = _mm256_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[i]));
+        _mm256_storeu_ps(&out[i], _mm256_mul_ps(_mm256_cvtepi32_ps(values), gain_v));
+    }
+
+    if(i < count){
+        fromInt32Scalar(in + i, out + i, count - i, gain);
+    }
+}
+
+void AJ::dsp::kernels::toHalfAVX2(const float *in, uint16_t *out, size_t count){
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        const __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(&in[i]), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), half);
+    }
+
+    if(i < count){
+        toHalfScalar(in + i, out + i, count - i);
+    }
+}
+
+void AJ::dsp::kernels::fromHalfAVX2(const uint16_t *in, float *out, size_t count){
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_ps(&out[i], _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]))));
+    }
+
+    if(i < count){
+        fromHalfScalar(in + i, out + i, count - i);
+    }
+}
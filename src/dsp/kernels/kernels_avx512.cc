@@ -0,0 +1,723 @@
+#include "dsp/kernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <immintrin.h>
+/*
+    - AVX-512F - 512-bit operations (16 floats), the tail is handled with masked loads/stores.
+    ! built with -mavx512f only, don't include engine headers here (see dsp/kernels.h).
+*/
+
+namespace {
+
+inline __mmask16 tailMask(size_t remaining){
+    return static_cast<__mmask16>((1u << remaining) - 1);
+}
+
+inline __m512 clamp16(__m512 samples){
+    return _mm512_max_ps(_mm512_min_ps(samples, _mm512_set1_ps(1.0f)), _mm512_set1_ps(-1.0f));
+}
+
+
+//* phase kernels: same approximations as the scalar ones (see kernels.cc).
+
+inline __m512 wrapPhase16(__m512 x){
+    const __m512 turns = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(1.0f / 6.28318531f)),
+        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    return _mm512_fnmadd_ps(turns, _mm512_set1_ps(6.28318531f), x);
+}
+
+inline __m512 atan2Approx16(__m512 y, __m512 x){
+    const __m512 ax = _mm512_abs_ps(x), ay = _mm512_abs_ps(y);
+    const __m512 a = _mm512_div_ps(_mm512_min_ps(ax, ay), _mm512_max_ps(_mm512_max_ps(ax, ay), _mm512_set1_ps(FLT_MIN)));
+    const __m512 s = _mm512_mul_ps(a, a);
+
+    __m512 p = _mm512_fmadd_ps(s, _mm512_set1_ps(-0.01172120f), _mm512_set1_ps(0.05265332f));
+    p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(-0.11643287f));
+    p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(0.19354346f));
+    p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(-0.33262347f));
+    p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(0.99997726f));
+    __m512 r = _mm512_mul_ps(a, p);
+
+    r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(ay, ax, _CMP_GT_OQ), _mm512_set1_ps(1.57079633f), r);
+    r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ), _mm512_set1_ps(3.14159265f), r);
+
+    const __m512i sign = _mm512_and_epi32(_mm512_castps_si512(y), _mm512_set1_epi32(static_cast<int>(0x80000000u)));
+    return _mm512_castsi512_ps(_mm512_or_epi32(_mm512_castps_si512(r), sign));
+}
+
+inline void sinCosApprox16(__m512 x, __m512 &sin, __m512 &cos){
+    const __m512 j = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(0.636619772f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 r = _mm512_fnmadd_ps(j, _mm512_set1_ps(1.5703125f), x);
+    r = _mm512_fnmadd_ps(j, _mm512_set1_ps(4.83751297e-4f), r);
+    r = _mm512_fnmadd_ps(j, _mm512_set1_ps(7.54978995e-8f), r);
+    const __m512 r2 = _mm512_mul_ps(r, r);
+
+    __m512 ps = _mm512_fmadd_ps(r2, _mm512_set1_ps(-1.9515295891e-4f), _mm512_set1_ps(8.3321608736e-3f));
+    ps = _mm512_fmadd_ps(ps, r2, _mm512_set1_ps(-1.6666654611e-1f));
+    ps = _mm512_fmadd_ps(_mm512_mul_ps(r, r2), ps, r);
+
+    __m512 pc = _mm512_fmadd_ps(r2, _mm512_set1_ps(2.443315712e-5f), _mm512_set1_ps(-1.388731625e-3f));
+    pc = _mm512_fmadd_ps(pc, r2, _mm512_set1_ps(4.166664568e-2f));
+    pc = _mm512_fmadd_ps(_mm512_mul_ps(r2, r2), pc, _mm512_fnmadd_ps(r2, _mm512_set1_ps(0.5f), _mm512_set1_ps(1.0f)));
+
+    //* quadrant q: odd swaps sin / cos, sin is negated for q = 2, 3, cos for q = 1, 2.
+    const __m512i q = _mm512_cvtps_epi32(j);
+    const __mmask16 swap = _mm512_test_epi32_mask(q, _mm512_set1_epi32(1));
+    const __m512i sinSign = _mm512_slli_epi32(_mm512_and_epi32(q, _mm512_set1_epi32(2)), 30);
+    const __m512i cosSign = _mm512_slli_epi32(_mm512_and_epi32(_mm512_add_epi32(q, _mm512_set1_epi32(1)),
+        _mm512_set1_epi32(2)), 30);
+
+    sin = _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(_mm512_mask_blend_ps(swap, ps, pc)), sinSign));
+    cos = _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(_mm512_mask_blend_ps(swap, pc, ps)), cosSign));
+}
+
+}
+
+void AJ::dsp::kernels::gainAVX512(float *data, size_t count, float gain){
+    const __m512 gain_v = _mm512_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        _mm512_storeu_ps(&data[i], clamp16(_mm512_mul_ps(_mm512_loadu_ps(&data[i]), gain_v)));
+    }
+
+    if(i < count){
+        const __mmask16 mask = tailMask(count - i);
+        __m512 samples = _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, &data[i]), gain_v);
+        _mm512_mask_storeu_ps(&data[i], mask, clamp16(samples));
+    }
+}
+
+void AJ::dsp::kernels::scaleAVX512(float *data, size_t count, float gain){
+    const __m512 gain_v = _mm512_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        _mm512_storeu_ps(&data[i], _mm512_mul_ps(_mm512_loadu_ps(&data[i]), gain_v));
+    }
+
+    if(i < count){
+        const __mmask16 mask = tailMask(count - i);
+        _mm512_mask_storeu_ps(&data[i], mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, &data[i]), gain_v));
+    }
+}
+
+void AJ::dsp::kernels::fadeAVX512(float *data, size_t count, double startGain, double step){
+    //* the gain of the first lane is computed in double per vector so it doesn't drift,
+    //* the other lanes are steps ahead of it.
+    const __m512 lanes = _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512 step_v = _mm512_set1_ps(static_cast<float>(step));
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        __m512 gain = _mm512_fmadd_ps(lanes, step_v, _mm512_set1_ps(static_cast<float>(startGain + step * i)));
+        __m512 samples = _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, &data[i]), gain);
+        _mm512_mask_storeu_ps(&data[i], mask, clamp16(samples));
+    }
+}
+
+void AJ::dsp::kernels::echoAVX512(const float *in, const float *delayed, float *out, size_t count, float decay){
+    const __m512 decay_v = _mm512_set1_ps(decay);
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        // out = in + delayed * decay
+        __m512 samples = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &delayed[i]), decay_v,
+            _mm512_maskz_loadu_ps(mask, &in[i]));
+        _mm512_mask_storeu_ps(&out[i], mask, clamp16(samples));
+    }
+}
+
+void AJ::dsp::kernels::mulAddAVX512(const float *in, const float *delayed, float *out, size_t count, float gain){
+    const __m512 gain_v = _mm512_set1_ps(gain);
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        _mm512_mask_storeu_ps(&out[i], mask, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &delayed[i]), gain_v,
+            _mm512_maskz_loadu_ps(mask, &in[i])));
+    }
+}
+
+void AJ::dsp::kernels::complexMulAddAVX512(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count){
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        const __m512 ar = _mm512_maskz_loadu_ps(mask, &aRe[i]), ai = _mm512_maskz_loadu_ps(mask, &aIm[i]);
+        const __m512 br = _mm512_maskz_loadu_ps(mask, &bRe[i]), bi = _mm512_maskz_loadu_ps(mask, &bIm[i]);
+
+        // (ar + j ai)(br + j bi) = (ar br - ai bi) + j (ar bi + ai br)
+        _mm512_mask_storeu_ps(&accRe[i], mask, _mm512_fmadd_ps(ar, br,
+            _mm512_fnmadd_ps(ai, bi, _mm512_maskz_loadu_ps(mask, &accRe[i]))));
+        _mm512_mask_storeu_ps(&accIm[i], mask, _mm512_fmadd_ps(ar, bi,
+            _mm512_fmadd_ps(ai, br, _mm512_maskz_loadu_ps(mask, &accIm[i]))));
+    }
+}
+
+void AJ::dsp::kernels::butterflyAVX512(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count){
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        const __m512 xr = _mm512_maskz_loadu_ps(mask, &ar[i]), xi = _mm512_maskz_loadu_ps(mask, &ai[i]);
+        const __m512 yr = _mm512_maskz_loadu_ps(mask, &br[i]), yi = _mm512_maskz_loadu_ps(mask, &bi[i]);
+        const __m512 cr = _mm512_maskz_loadu_ps(mask, &wr[i]), ci = _mm512_maskz_loadu_ps(mask, &wi[i]);
+
+        // v = b * w
+        const __m512 vr = _mm512_fmsub_ps(yr, cr, _mm512_mul_ps(yi, ci));
+        const __m512 vi = _mm512_fmadd_ps(yr, ci, _mm512_mul_ps(yi, cr));
+
+        _mm512_mask_storeu_ps(&br[i], mask, _mm512_sub_ps(xr, vr));
+        _mm512_mask_storeu_ps(&bi[i], mask, _mm512_sub_ps(xi, vi));
+        _mm512_mask_storeu_ps(&ar[i], mask, _mm512_add_ps(xr, vr));
+        _mm512_mask_storeu_ps(&ai[i], mask, _mm512_add_ps(xi, vi));
+    }
+}
+
+void AJ::dsp::kernels::phaseAnalyzeAVX512(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase){
+    const __m512 hop_v = _mm512_set1_ps(hopPhase);
+    const __m512 invHop_v = _mm512_set1_ps(1.0f / hopPhase);
+    const __m512 lanes = _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+        8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        const __m512 xr = _mm512_maskz_loadu_ps(mask, &re[i]), xi = _mm512_maskz_loadu_ps(mask, &im[i]);
+        const __m512 bin = _mm512_add_ps(_mm512_set1_ps(static_cast<float>(first + i)), lanes);
+        const __m512 phase = atan2Approx16(xi, xr);
+
+        // freq = k + wrap(phase - last - k * hop) / hop
+        const __m512 delta = _mm512_fnmadd_ps(bin, hop_v, _mm512_sub_ps(phase, _mm512_maskz_loadu_ps(mask, &lastPhase[i])));
+        _mm512_mask_storeu_ps(&mag[i], mask, _mm512_sqrt_ps(_mm512_fmadd_ps(xr, xr, _mm512_mul_ps(xi, xi))));
+        _mm512_mask_storeu_ps(&freq[i], mask, _mm512_fmadd_ps(wrapPhase16(delta), invHop_v, bin));
+        _mm512_mask_storeu_ps(&lastPhase[i], mask, phase);
+    }
+}
+
+void AJ::dsp::kernels::phaseSynthesizeAVX512(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase){
+    const __m512 hop_v = _mm512_set1_ps(hopPhase);
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        const __m512 phase = wrapPhase16(_mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &freq[i]), hop_v,
+            _mm512_maskz_loadu_ps(mask, &sumPhase[i])));
+        const __m512 m = _mm512_maskz_loadu_ps(mask, &mag[i]);
+        __m512 sin, cos;
+        sinCosApprox16(phase, sin, cos);
+
+        _mm512_mask_storeu_ps(&sumPhase[i], mask, phase);
+        _mm512_mask_storeu_ps(&re[i], mask, _mm512_mul_ps(m, cos));
+        _mm512_mask_storeu_ps(&im[i], mask, _mm512_mul_ps(m, sin));
+    }
+}
+
+void AJ::dsp::kernels::crossCorrelateAVX512(const float *x, const float *ref, float *out, size_t lags, size_t length){
+    //* 16 lags per vector: every reference sample is broadcast and multiplied with 16 shifted windows at once.
+    size_t l = 0;
+    for(; l + 64 <= lags; l += 64){
+        __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+        __m512 acc2 = _mm512_setzero_ps(), acc3 = _mm512_setzero_ps();
+
+        for(size_t i = 0; i < length; ++i){
+            const __m512 r = _mm512_set1_ps(ref[i]);
+            const float *p = &x[l + i];
+            acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(p), r, acc0);
+            acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(p + 16), r, acc1);
+            acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(p + 32), r, acc2);
+            acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(p + 48), r, acc3);
+        }
+
+        _mm512_storeu_ps(&out[l], acc0);
+        _mm512_storeu_ps(&out[l + 16], acc1);
+        _mm512_storeu_ps(&out[l + 32], acc2);
+        _mm512_storeu_ps(&out[l + 48], acc3);
+    }
+
+    for(; l < lags; l += 16){
+        const __mmask16 mask = lags - l >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(lags - l);
+
+        __m512 acc = _mm512_setzero_ps();
+        for(size_t i = 0; i < length; ++i){
+            acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &x[l + i]), _mm512_set1_ps(ref[i]), acc);
+        }
+        _mm512_mask_storeu_ps(&out[l], mask, acc);
+    }
+}
+
+void AJ::dsp::kernels::polyphaseAVX512(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count){
+    //* one output per dot product: 32 taps per iteration over two accumulators, the last taps masked.
+    for(size_t k = 0; k < count; ++k){
+        const float *h = bank + phase * taps;
+        __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+
+        size_t i = 0;
+        for(; i + 32 <= taps; i += 32){
+            acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(&x[i]), _mm512_loadu_ps(&h[i]), acc0);
+            acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(&x[i + 16]), _mm512_loadu_ps(&h[i + 16]), acc1);
+        }
+
+        for(; i < taps; i += 16){
+            const __mmask16 mask = taps - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(taps - i);
+            acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &x[i]), _mm512_maskz_loadu_ps(mask, &h[i]), acc0);
+        }
+
+        out[k] = _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+
+        phase += step;
+        x += phase / phases;
+        phase %= phases;
+    }
+}
+
+void AJ::dsp::kernels::biquadAVX512(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs,
+    float *state){
+    //* kBiquadLanes is one vector: the whole cascade advances one step per iteration.
+    (void)lanes;
+    const size_t stages = 16 / channels;
+
+    const __m512 b0 = _mm512_loadu_ps(&coeffs[0]);
+    const __m512 b1 = _mm512_loadu_ps(&coeffs[kBiquadLanes]);
+    const __m512 b2 = _mm512_loadu_ps(&coeffs[2 * kBiquadLanes]);
+    const __m512 a1 = _mm512_loadu_ps(&coeffs[3 * kBiquadLanes]);
+    const __m512 a2 = _mm512_loadu_ps(&coeffs[4 * kBiquadLanes]);
+    __m512 s1 = _mm512_loadu_ps(&state[0]);
+    __m512 s2 = _mm512_loadu_ps(&state[kBiquadLanes]);
+    __m512 y = _mm512_setzero_ps();
+
+    //* step t: stage k filters frame t - k. While filling / draining only the stages holding a frame update their state.
+    const size_t steps = frames + stages - 1;
+    for(size_t t = 0; t < steps; ++t){
+        __m512 x = _mm512_setzero_ps();
+        if(t < frames){
+            if(channels == 1){
+                x = _mm512_set1_ps(data[t]);
+            } else {
+                double pair;
+                std::memcpy(&pair, &data[t * 2], sizeof(pair));
+                x = _mm512_castpd_ps(_mm512_set1_pd(pair));
+            }
+        }
+
+        const __m512 in = channels == 1 ? _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(y), _mm512_castps_si512(x), 15))
+            : _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(y), _mm512_castps_si512(x), 14));
+        const __m512 out = _mm512_fmadd_ps(b0, in, s1);
+        const __m512 n1 = _mm512_fnmadd_ps(a1, out, _mm512_fmadd_ps(b1, in, s2));
+        const __m512 n2 = _mm512_fnmadd_ps(a2, out, _mm512_mul_ps(b2, in));
+
+        if(t + 1 >= stages && t < frames){
+            s1 = n1;
+            s2 = n2;
+        } else {
+            //* lanes of the stages [lo, hi] hold a frame.
+            const size_t hi = std::min(t, stages - 1), lo = t >= frames ? t - frames + 1 : 0;
+            const uint32_t bits = ((1u << ((hi + 1) * channels)) - 1) & ~((1u << (lo * channels)) - 1);
+            const __mmask16 active = static_cast<__mmask16>(bits);
+            s1 = _mm512_mask_mov_ps(s1, active, n1);
+            s2 = _mm512_mask_mov_ps(s2, active, n2);
+        }
+        y = out;
+
+        if(t + 1 >= stages){
+            const __m128 top = _mm512_extractf32x4_ps(y, 3);
+            float *frame = &data[(t + 1 - stages) * channels];
+            if(channels == 1){
+                *frame = _mm_cvtss_f32(_mm_shuffle_ps(top, top, _MM_SHUFFLE(3, 3, 3, 3)));
+            } else {
+                _mm_storeh_pi(reinterpret_cast<__m64*>(frame), top);
+            }
+        }
+    }
+
+    _mm512_storeu_ps(&state[0], s1);
+    _mm512_storeu_ps(&state[kBiquadLanes], s2);
+}
+
+void AJ::dsp::kernels::framePeakAVX512(const float *data, size_t frames, size_t channels, float *peaks){
+    if(channels == 1){
+        for(size_t f = 0; f < frames; f += 16){
+            const __mmask16 mask = frames - f >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(frames - f);
+            _mm512_mask_storeu_ps(&peaks[f], mask, _mm512_abs_ps(_mm512_maskz_loadu_ps(mask, &data[f])));
+        }
+    } else if(channels == 2){
+        const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        const __m512i odd = _mm512_add_epi32(even, _mm512_set1_epi32(1));
+
+        for(size_t f = 0; f < frames; f += 16){
+            //* 16 frames are 32 floats: a holds the first 8 frames, b the next ones.
+            const size_t floats = 2 * std::min<size_t>(16, frames - f);
+            const __mmask16 maskA = floats >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(floats);
+            const __mmask16 maskB = floats >= 32 ? static_cast<__mmask16>(0xFFFF) : tailMask(floats > 16 ? floats - 16 : 0);
+
+            const __m512 a = _mm512_abs_ps(_mm512_maskz_loadu_ps(maskA, &data[2 * f]));
+            const __m512 b = _mm512_abs_ps(_mm512_maskz_loadu_ps(maskB, &data[2 * f + 16]));
+            const __m512 m = _mm512_max_ps(_mm512_permutex2var_ps(a, even, b), _mm512_permutex2var_ps(a, odd, b));
+            _mm512_mask_storeu_ps(&peaks[f], tailMask(floats / 2), m);
+        }
+    } else {
+        framePeakScalar(data, frames, channels, peaks);
+    }
+}
+
+void AJ::dsp::kernels::frameGainAVX512(float *data, size_t frames, size_t channels, const float *gains){
+    if(channels == 1){
+        for(size_t f = 0; f < frames; f += 16){
+            const __mmask16 mask = frames - f >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(frames - f);
+            const __m512 x = _mm512_maskz_loadu_ps(mask, &data[f]);
+            _mm512_mask_storeu_ps(&data[f], mask, _mm512_mul_ps(x, _mm512_maskz_loadu_ps(mask, &gains[f])));
+        }
+    } else if(channels == 2){
+        const __m512i low = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+        const __m512i high = _mm512_add_epi32(low, _mm512_set1_epi32(8));
+
+        for(size_t f = 0; f < frames; f += 16){
+            const size_t floats = 2 * std::min<size_t>(16, frames - f);
+            const __mmask16 maskA = floats >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(floats);
+            const __mmask16 maskB = floats >= 32 ? static_cast<__mmask16>(0xFFFF) : tailMask(floats > 16 ? floats - 16 : 0);
+
+            const __m512 g = _mm512_maskz_loadu_ps(tailMask(floats / 2), &gains[f]);
+            const __m512 a = _mm512_maskz_loadu_ps(maskA, &data[2 * f]);
+            const __m512 b = _mm512_maskz_loadu_ps(maskB, &data[2 * f + 16]);
+            _mm512_mask_storeu_ps(&data[2 * f], maskA, _mm512_mul_ps(a, _mm512_permutexvar_ps(low, g)));
+            _mm512_mask_storeu_ps(&data[2 * f + 16], maskB, _mm512_mul_ps(b, _mm512_permutexvar_ps(high, g)));
+        }
+    } else {
+        frameGainScalar(data, frames, channels, gains);
+    }
+}
+
+void AJ::dsp::kernels::reverseAVX512(float *front, float *back, size_t frames, size_t channels){
+    size_t f = 0;
+
+    if(channels == 1 || channels == 2){
+        const size_t step = 16 / channels;
+        const __m512i order = channels == 1
+            ? _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+            : _mm512_setr_epi32(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+        float *end = back + frames * channels;
+
+        //? the two ends move towards each other, a masked tail would need a mask per end: the scalar loop takes the rest.
+        for(; f + step <= frames; f += step){
+            float *mirror = end - (f + step) * channels;
+            const __m512 a = _mm512_loadu_ps(&front[f * channels]);
+            const __m512 b = _mm512_loadu_ps(mirror);
+            _mm512_storeu_ps(&front[f * channels], _mm512_permutexvar_ps(order, b));
+            _mm512_storeu_ps(mirror, _mm512_permutexvar_ps(order, a));
+        }
+    }
+
+    reverseScalar(front + f * channels, back, frames - f, channels);
+}
+
+void AJ::dsp::kernels::mixAddAVX512(const float *in, float *out, size_t frames, float left, float right){
+    const __m512 gain_v = _mm512_setr_ps(left, right, left, right, left, right, left, right,
+        left, right, left, right, left, right, left, right);
+    const size_t count = 2 * frames;
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        _mm512_mask_storeu_ps(&out[i], mask, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &in[i]), gain_v,
+            _mm512_maskz_loadu_ps(mask, &out[i])));
+    }
+}
+
+size_t AJ::dsp::kernels::findAboveAVX512(const float *data, size_t count, float threshold){
+    const __m512 threshold_v = _mm512_set1_ps(threshold);
+
+    size_t i = 0;
+    for(; i + 64 <= count; i += 64){
+        const __mmask16 a = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_loadu_ps(&data[i])), threshold_v, _CMP_GT_OQ);
+        const __mmask16 b = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_loadu_ps(&data[i + 16])), threshold_v, _CMP_GT_OQ);
+        const __mmask16 c = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_loadu_ps(&data[i + 32])), threshold_v, _CMP_GT_OQ);
+        const __mmask16 d = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_loadu_ps(&data[i + 48])), threshold_v, _CMP_GT_OQ);
+        if(a | b | c | d){
+            break;
+        }
+    }
+
+    return i + findAboveScalar(data + i, count - i, threshold);
+}
+
+size_t AJ::dsp::kernels::findLastAboveAVX512(const float *data, size_t count, float threshold){
+    const __m512 threshold_v = _mm512_set1_ps(threshold);
+
+    size_t i = count;
+    for(; i >= 64; i -= 64){
+        const float *block = data + i - 64;
+        const __mmask16 a = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_loadu_ps(&block[0])), threshold_v, _CMP_GT_OQ);
+        const __mmask16 b = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_loadu_ps(&block[16])), threshold_v, _CMP_GT_OQ);
+        const __mmask16 c = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_loadu_ps(&block[32])), threshold_v, _CMP_GT_OQ);
+        const __mmask16 d = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_loadu_ps(&block[48])), threshold_v, _CMP_GT_OQ);
+        if(a | b | c | d){
+            break;
+        }
+    }
+
+    return findLastAboveScalar(data, i, threshold);
+}
+
+void AJ::dsp::kernels::glideAVX512(float *gains, size_t count, float start, float target, float coef){
+    //* lane k is k + 1 steps in, a vector moves every lane 16 steps further; the tail is masked.
+    alignas(64) float powers[16];
+    float power = coef;
+    for(float &lane : powers){
+        lane = power;
+        power *= coef;
+    }
+
+    const __m512 step_v = _mm512_set1_ps(powers[15]);
+    const __m512 target_v = _mm512_set1_ps(target);
+    __m512 distance = _mm512_mul_ps(_mm512_set1_ps(start - target), _mm512_load_ps(powers));
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+        _mm512_mask_storeu_ps(&gains[i], mask, _mm512_add_ps(target_v, distance));
+        distance = _mm512_mul_ps(distance, step_v);
+    }
+}
+
+void AJ::dsp::kernels::combAVX512(float *line, float gain, const float *in, float *acc, size_t count){
+    const __m512 gain_v = _mm512_set1_ps(gain);
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        // y[n] = x[n] + g * y[n - M], the 16 taps y[n - M] are the next 16 samples of the line
+        __m512 out = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, &line[i]), gain_v,
+            _mm512_maskz_loadu_ps(mask, &in[i]));
+
+        // write back the outputs in place of the taps, add them to the comb bank sum
+        _mm512_mask_storeu_ps(&line[i], mask, out);
+        _mm512_mask_storeu_ps(&acc[i], mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, &acc[i]), out));
+    }
+}
+
+namespace {
+
+//* tanh approximations, see AJ::dsp::kernels::tanhApprox().
+inline __m512 tanhAccurate16(__m512 x){
+    x = _mm512_max_ps(_mm512_min_ps(x, _mm512_set1_ps(4.97f)), _mm512_set1_ps(-4.97f));
+    const __m512 x2 = _mm512_mul_ps(x, x);
+
+    __m512 num = _mm512_add_ps(_mm512_set1_ps(378.0f), x2);
+    num = _mm512_fmadd_ps(x2, num, _mm512_set1_ps(17325.0f));
+    num = _mm512_mul_ps(x, _mm512_fmadd_ps(x2, num, _mm512_set1_ps(135135.0f)));
+
+    __m512 den = _mm512_fmadd_ps(x2, _mm512_set1_ps(28.0f), _mm512_set1_ps(3150.0f));
+    den = _mm512_fmadd_ps(x2, den, _mm512_set1_ps(62370.0f));
+    den = _mm512_fmadd_ps(x2, den, _mm512_set1_ps(135135.0f));
+
+    return _mm512_div_ps(num, den);
+}
+
+inline __m512 tanhFast16(__m512 x){
+    x = _mm512_max_ps(_mm512_min_ps(x, _mm512_set1_ps(3.0f)), _mm512_set1_ps(-3.0f));
+    const __m512 x2 = _mm512_mul_ps(x, x);
+
+    return _mm512_div_ps(
+        _mm512_mul_ps(x, _mm512_add_ps(_mm512_set1_ps(27.0f), x2)),
+        _mm512_fmadd_ps(_mm512_set1_ps(9.0f), x2, _mm512_set1_ps(27.0f))
+    );
+}
+
+}
+
+void AJ::dsp::kernels::shapeAVX512(float *data, size_t count, const ShapeParams &params){
+    const __m512 drive = _mm512_set1_ps(params.drive);
+    const __m512 drive_neg = _mm512_set1_ps(params.driveNeg);
+    const __m512 makeup = _mm512_set1_ps(params.makeup);
+    const __m512 makeup_neg = _mm512_set1_ps(params.makeupNeg);
+    const bool fast = params.approx == TanhApprox::Fast;
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+        __m512 samples = _mm512_maskz_loadu_ps(mask, &data[i]);
+        __m512 out;
+
+        switch(params.curve){
+        case Curve::HardClip:
+            out = clamp16(_mm512_mul_ps(samples, drive));
+            break;
+
+        case Curve::Cubic: {
+            // 1.5 u - 0.5 u^3
+            __m512 u = clamp16(_mm512_mul_ps(samples, drive));
+            __m512 u3 = _mm512_mul_ps(_mm512_mul_ps(u, u), u);
+            out = _mm512_fmsub_ps(_mm512_set1_ps(1.5f), u, _mm512_mul_ps(_mm512_set1_ps(0.5f), u3));
+            break;
+        }
+
+        default: {
+            // per lane drive / makeup: negative samples (mask set) take the negative half values
+            const __mmask16 negative = _mm512_cmp_ps_mask(samples, _mm512_setzero_ps(), _CMP_LT_OQ);
+            __m512 x = _mm512_mul_ps(samples, _mm512_mask_blend_ps(negative, drive, drive_neg));
+            __m512 y = fast ? tanhFast16(x) : tanhAccurate16(x);
+            out = _mm512_mul_ps(y, _mm512_mask_blend_ps(negative, makeup, makeup_neg));
+            break;
+        }
+        }
+
+        _mm512_mask_storeu_ps(&data[i], mask, out);
+    }
+}
+
+AJ::dsp::kernels::Levels AJ::dsp::kernels::analyzeAVX512(const float *data, size_t count){
+    __m512 min = _mm512_set1_ps(FLT_MAX);
+    __m512 max = _mm512_set1_ps(-FLT_MAX);
+    // squares are summed in double lanes (2 accumulators per half) so long ranges don't lose precision.
+    __m512d sum_lo = _mm512_setzero_pd();
+    __m512d sum_hi = _mm512_setzero_pd();
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        // masked out lanes load 0, which doesn't change the sum, min / max skip them.
+        __m512 samples = _mm512_maskz_loadu_ps(mask, &data[i]);
+        min = _mm512_mask_min_ps(min, mask, min, samples);
+        max = _mm512_mask_max_ps(max, mask, max, samples);
+
+        __m512d lo = _mm512_cvtps_pd(_mm512_castps512_ps256(samples));
+        __m512d hi = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(samples), 1)));
+        sum_lo = _mm512_fmadd_pd(lo, lo, sum_lo);
+        sum_hi = _mm512_fmadd_pd(hi, hi, sum_hi);
+    }
+
+    Levels levels{FLT_MAX, -FLT_MAX, 0.0};
+    levels.min = _mm512_reduce_min_ps(min);
+    levels.max = _mm512_reduce_max_ps(max);
+    levels.sumSquares = _mm512_reduce_add_pd(_mm512_add_pd(sum_lo, sum_hi));
+
+    return levels;
+}
+
+void AJ::dsp::kernels::interleaveAVX512(const float *left, const float *right, float *out, size_t frames){
+    // indexes into (l, r): 0..15 pick l, 16..31 pick r.
+    const __m512i first = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+    const __m512i second = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+    size_t i = 0;
+    for(; i + 16 <= frames; i += 16){
+        __m512 l = _mm512_loadu_ps(&left[i]);
+        __m512 r = _mm512_loadu_ps(&right[i]);
+
+        _mm512_storeu_ps(&out[2 * i], _mm512_permutex2var_ps(l, first, r));
+        _mm512_storeu_ps(&out[2 * i + 16], _mm512_permutex2var_ps(l, second, r));
+    }
+
+    if(i < frames){
+        interleaveScalar(left + i, right + i, out + 2 * i, frames - i);
+    }
+}
+
+void AJ::dsp::kernels::deinterleaveAVX512(const float *in, float *left, float *right, size_t frames){
+    const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+    size_t i = 0;
+    for(; i + 16 <= frames; i += 16){
+        __m512 a = _mm512_loadu_ps(&in[2 * i]);
+        __m512 b = _mm512_loadu_ps(&in[2 * i + 16]);
+
+        _mm512_storeu_ps(&left[i], _mm512_permutex2var_ps(a, even, b));
+        _mm512_storeu_ps(&right[i], _mm512_permutex2var_ps(a, odd, b));
+    }
+
+    if(i < frames){
+        deinterleaveScalar(in + 2 * i, left + i, right + i, frames - i);
+    }
+}
+
+void AJ::dsp::kernels::toInt16AVX512(const float *in, int16_t *out, size_t count, const float *dither){
+    const __m512 scale = _mm512_set1_ps(32767.0f);
+    const __m512 hi = _mm512_set1_ps(32767.0f);
+    const __m512 lo = _mm512_set1_ps(-32768.0f);
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        __m512 samples = _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, &in[i]), scale);
+        if(dither){
+            samples = _mm512_add_ps(samples, _mm512_maskz_loadu_ps(mask, &dither[i]));
+        }
+
+        // round to nearest, then narrow with signed saturation.
+        __m512i values = _mm512_cvtps_epi32(_mm512_max_ps(_mm512_min_ps(samples, hi), lo));
+        _mm512_mask_cvtsepi32_storeu_epi16(&out[i], mask, values);
+    }
+}
+
+void AJ::dsp::kernels::fromInt16AVX512(const int16_t *in, float *out, size_t count){
+    const __m512 gain = _mm512_set1_ps(1.0f / 32768.0f);
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        __m512i values = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[i])));
+        _mm512_storeu_ps(&out[i], _mm512_mul_ps(_mm512_cvtepi32_ps(values), gain));
+    }
+
+    if(i < count){
+        fromInt16Scalar(in + i, out + i, count - i);
+    }
+}
+
+void AJ::dsp::kernels::toInt32AVX512(const float *in, int32_t *out, size_t count, float scale, const float *dither){
+    const __m512 scale_v = _mm512_set1_ps(scale);
+    const __m512 hi = _mm512_set1_ps(scale < 2147483520.0f ? scale : 2147483520.0f);
+    const __m512 lo = _mm512_set1_ps(-scale - 1.0f);
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        __m512 samples = _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, &in[i]), scale_v);
+        if(dither){
+            samples = _mm512_add_ps(samples, _mm512_maskz_loadu_ps(mask, &dither[i]));
+        }
+
+        __m512i values = _mm512_cvtps_epi32(_mm512_max_ps(_mm512_min_ps(samples, hi), lo));
+        _mm512_mask_storeu_epi32(&out[i], mask, values);
+    }
+}
+
+void AJ::dsp::kernels::fromInt32AVX512(const int32_t *in, float *out, size_t count, float gain){
+    const __m512 gain_v = _mm512_set1_ps(gain);
+
+    for(size_t i = 0; i < count; i += 16){
+        const __mmask16 mask = count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : tailMask(count - i);
+
+        __m512i values = _mm512_maskz_loadu_epi32(mask, &in[i]);
+        _mm512_mask_storeu_ps(&out[i], mask, _mm512_mul_ps(_mm512_cvtepi32_ps(values), gain_v));
+    }
+}
+
+void AJ::dsp::kernels::toHalfAVX512(const float *in, uint16_t *out, size_t count){
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        const __m256i half = _mm512_cvtps_ph(_mm512_loadu_ps(&in[i]), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), half);
+    }
+
+    if(i < count){
+        toHalfScalar(in + i, out + i, count - i);
+    }
+}
+
+void AJ::dsp::kernels::fromHalfAVX512(const uint16_t *in, float *out, size_t count){
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        _mm512_storeu_ps(&out[i], _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[i]))));
+    }
+
+    if(i < count){
+        fromHalfScalar(in + i, out + i, count - i);
+    }
+}
@@ -0,0 +1,741 @@
+#include "dsp/kernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <arm_neon.h>
+/*
+    - NEON (aarch64) - 128-bit operations (4 floats)
+    ! don't include engine headers here (see dsp/kernels.h).
+*/
+
+namespace {
+
+//* biquad pipeline: lanes move up by one stage (`channels` lanes), `prev` fills the lowest ones.
+
+inline float32x4_t shiftStage4(float32x4_t cur, float32x4_t prev, size_t channels){
+    return channels == 1 ? vextq_f32(prev, cur, 3) : vextq_f32(prev, cur, 2);
+}
+
+//* the frame in the highest `channels` lanes (every lane holds a copy).
+inline float32x4_t broadcastFrame4(const float *frame, size_t channels){
+    return channels == 1 ? vld1q_dup_f32(frame) : vcombine_f32(vld1_f32(frame), vld1_f32(frame));
+}
+
+inline float clampSample(float sample){
+    return sample > 1.0f ? 1.0f : (sample < -1.0f ? -1.0f : sample);
+}
+
+inline float32x4_t clamp4(float32x4_t samples){
+    return vmaxq_f32(vminq_f32(samples, vdupq_n_f32(1.0f)), vdupq_n_f32(-1.0f));
+}
+
+
+//* phase kernels: same approximations as the scalar ones (see kernels.cc).
+
+inline float32x4_t wrapPhase4(float32x4_t x){
+    const float32x4_t turns = vrndnq_f32(vmulq_n_f32(x, 1.0f / 6.28318531f));
+    return vfmsq_f32(x, turns, vdupq_n_f32(6.28318531f));
+}
+
+inline float32x4_t atan2Approx4(float32x4_t y, float32x4_t x){
+    const float32x4_t ax = vabsq_f32(x), ay = vabsq_f32(y);
+    const float32x4_t a = vdivq_f32(vminq_f32(ax, ay), vmaxq_f32(vmaxq_f32(ax, ay), vdupq_n_f32(FLT_MIN)));
+    const float32x4_t s = vmulq_f32(a, a);
+
+    float32x4_t p = vfmaq_f32(vdupq_n_f32(0.05265332f), s, vdupq_n_f32(-0.01172120f));
+    p = vfmaq_f32(vdupq_n_f32(-0.11643287f), p, s);
+    p = vfmaq_f32(vdupq_n_f32(0.19354346f), p, s);
+    p = vfmaq_f32(vdupq_n_f32(-0.33262347f), p, s);
+    p = vfmaq_f32(vdupq_n_f32(0.99997726f), p, s);
+    float32x4_t r = vmulq_f32(a, p);
+
+    r = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(vdupq_n_f32(1.57079633f), r), r);
+    r = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vsubq_f32(vdupq_n_f32(3.14159265f), r), r);
+
+    const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(y), vdupq_n_u32(0x80000000u));
+    return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(r), sign));
+}
+
+inline void sinCosApprox4(float32x4_t x, float32x4_t &sin, float32x4_t &cos){
+    const float32x4_t j = vrndnq_f32(vmulq_n_f32(x, 0.636619772f));
+    float32x4_t r = vfmsq_f32(x, j, vdupq_n_f32(1.5703125f));
+    r = vfmsq_f32(r, j, vdupq_n_f32(4.83751297e-4f));
+    r = vfmsq_f32(r, j, vdupq_n_f32(7.54978995e-8f));
+    const float32x4_t r2 = vmulq_f32(r, r);
+
+    float32x4_t ps = vfmaq_f32(vdupq_n_f32(8.3321608736e-3f), r2, vdupq_n_f32(-1.9515295891e-4f));
+    ps = vfmaq_f32(vdupq_n_f32(-1.6666654611e-1f), ps, r2);
+    ps = vfmaq_f32(r, vmulq_f32(r, r2), ps);
+
+    float32x4_t pc = vfmaq_f32(vdupq_n_f32(-1.388731625e-3f), r2, vdupq_n_f32(2.443315712e-5f));
+    pc = vfmaq_f32(vdupq_n_f32(4.166664568e-2f), pc, r2);
+    pc = vfmaq_f32(vfmsq_f32(vdupq_n_f32(1.0f), r2, vdupq_n_f32(0.5f)), vmulq_f32(r2, r2), pc);
+
+    //* quadrant q: odd swaps sin / cos, sin is negated for q = 2, 3, cos for q = 1, 2.
+    const uint32x4_t q = vreinterpretq_u32_s32(vcvtnq_s32_f32(j));
+    const uint32x4_t swap = vtstq_u32(q, vdupq_n_u32(1));
+    const uint32x4_t sinSign = vshlq_n_u32(vandq_u32(q, vdupq_n_u32(2)), 30);
+    const uint32x4_t cosSign = vshlq_n_u32(vandq_u32(vaddq_u32(q, vdupq_n_u32(1)), vdupq_n_u32(2)), 30);
+
+    sin = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, pc, ps)), sinSign));
+    cos = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, ps, pc)), cosSign));
+}
+
+}
+
+void AJ::dsp::kernels::gainNEON(float *data, size_t count, float gain){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        vst1q_f32(&data[i], clamp4(vmulq_n_f32(vld1q_f32(&data[i]), gain)));
+    }
+
+    // calculate the rest if there.
+    for(; i < count; ++i){
+        data[i] = clampSample(data[i] * gain);
+    }
+}
+
+void AJ::dsp::kernels::scaleNEON(float *data, size_t count, float gain){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        vst1q_f32(&data[i], vmulq_n_f32(vld1q_f32(&data[i]), gain));
+    }
+
+    for(; i < count; ++i){
+        data[i] *= gain;
+    }
+}
+
+void AJ::dsp::kernels::fadeNEON(float *data, size_t count, double startGain, double step){
+    //* the gain of the first lane is computed in double per vector so it doesn't drift,
+    //* the other lanes are steps ahead of it.
+    const float lanes_init[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    const float32x4_t lane_steps = vmulq_n_f32(vld1q_f32(lanes_init), static_cast<float>(step));
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        float32x4_t gain = vaddq_f32(vdupq_n_f32(static_cast<float>(startGain + step * i)), lane_steps);
+        vst1q_f32(&data[i], clamp4(vmulq_f32(vld1q_f32(&data[i]), gain)));
+    }
+
+    for(; i < count; ++i){
+        data[i] = clampSample(data[i] * static_cast<float>(startGain + step * i));
+    }
+}
+
+void AJ::dsp::kernels::echoNEON(const float *in, const float *delayed, float *out, size_t count, float decay){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        // out = in + delayed * decay
+        float32x4_t samples = vfmaq_n_f32(vld1q_f32(&in[i]), vld1q_f32(&delayed[i]), decay);
+        vst1q_f32(&out[i], clamp4(samples));
+    }
+
+    for(; i < count; ++i){
+        out[i] = clampSample(in[i] + delayed[i] * decay);
+    }
+}
+
+void AJ::dsp::kernels::mulAddNEON(const float *in, const float *delayed, float *out, size_t count, float gain){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        vst1q_f32(&out[i], vfmaq_n_f32(vld1q_f32(&in[i]), vld1q_f32(&delayed[i]), gain));
+    }
+
+    for(; i < count; ++i){
+        out[i] = in[i] + delayed[i] * gain;
+    }
+}
+
+void AJ::dsp::kernels::complexMulAddNEON(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const float32x4_t ar = vld1q_f32(&aRe[i]), ai = vld1q_f32(&aIm[i]);
+        const float32x4_t br = vld1q_f32(&bRe[i]), bi = vld1q_f32(&bIm[i]);
+
+        // (ar + j ai)(br + j bi) = (ar br - ai bi) + j (ar bi + ai br)
+        vst1q_f32(&accRe[i], vfmaq_f32(vfmsq_f32(vld1q_f32(&accRe[i]), ai, bi), ar, br));
+        vst1q_f32(&accIm[i], vfmaq_f32(vfmaq_f32(vld1q_f32(&accIm[i]), ai, br), ar, bi));
+    }
+
+    for(; i < count; ++i){
+        accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+        accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+    }
+}
+
+void AJ::dsp::kernels::butterflyNEON(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const float32x4_t xr = vld1q_f32(&ar[i]), xi = vld1q_f32(&ai[i]);
+        const float32x4_t yr = vld1q_f32(&br[i]), yi = vld1q_f32(&bi[i]);
+        const float32x4_t cr = vld1q_f32(&wr[i]), ci = vld1q_f32(&wi[i]);
+
+        // v = b * w
+        const float32x4_t vr = vfmsq_f32(vmulq_f32(yr, cr), yi, ci);
+        const float32x4_t vi = vfmaq_f32(vmulq_f32(yr, ci), yi, cr);
+
+        vst1q_f32(&br[i], vsubq_f32(xr, vr));
+        vst1q_f32(&bi[i], vsubq_f32(xi, vi));
+        vst1q_f32(&ar[i], vaddq_f32(xr, vr));
+        vst1q_f32(&ai[i], vaddq_f32(xi, vi));
+    }
+
+    for(; i < count; ++i){
+        const float vr = br[i] * wr[i] - bi[i] * wi[i];
+        const float vi = br[i] * wi[i] + bi[i] * wr[i];
+
+        br[i] = ar[i] - vr;
+        bi[i] = ai[i] - vi;
+        ar[i] += vr;
+        ai[i] += vi;
+    }
+}
+
+void AJ::dsp::kernels::phaseAnalyzeNEON(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase){
+    const float32x4_t hop_v = vdupq_n_f32(hopPhase);
+    const float32x4_t invHop_v = vdupq_n_f32(1.0f / hopPhase);
+    const float lanes[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    const float32x4_t lanes_v = vld1q_f32(lanes);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const float32x4_t xr = vld1q_f32(&re[i]), xi = vld1q_f32(&im[i]);
+        const float32x4_t bin = vaddq_f32(vdupq_n_f32(static_cast<float>(first + i)), lanes_v);
+        const float32x4_t phase = atan2Approx4(xi, xr);
+
+        // freq = k + wrap(phase - last - k * hop) / hop
+        const float32x4_t delta = vfmsq_f32(vsubq_f32(phase, vld1q_f32(&lastPhase[i])), bin, hop_v);
+        vst1q_f32(&mag[i], vsqrtq_f32(vfmaq_f32(vmulq_f32(xi, xi), xr, xr)));
+        vst1q_f32(&freq[i], vfmaq_f32(bin, wrapPhase4(delta), invHop_v));
+        vst1q_f32(&lastPhase[i], phase);
+    }
+
+    if(i < count){
+        phaseAnalyzeScalar(re + i, im + i, lastPhase + i, mag + i, freq + i, first + i, count - i, hopPhase);
+    }
+}
+
+void AJ::dsp::kernels::phaseSynthesizeNEON(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase){
+    const float32x4_t hop_v = vdupq_n_f32(hopPhase);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const float32x4_t phase = wrapPhase4(vfmaq_f32(vld1q_f32(&sumPhase[i]), vld1q_f32(&freq[i]), hop_v));
+        const float32x4_t m = vld1q_f32(&mag[i]);
+        float32x4_t sin, cos;
+        sinCosApprox4(phase, sin, cos);
+
+        vst1q_f32(&sumPhase[i], phase);
+        vst1q_f32(&re[i], vmulq_f32(m, cos));
+        vst1q_f32(&im[i], vmulq_f32(m, sin));
+    }
+
+    if(i < count){
+        phaseSynthesizeScalar(mag + i, freq + i, sumPhase + i, re + i, im + i, count - i, hopPhase);
+    }
+}
+
+void AJ::dsp::kernels::crossCorrelateNEON(const float *x, const float *ref, float *out, size_t lags, size_t length){
+    //* 4 lags per vector: every reference sample is multiplied with 4 shifted windows at once.
+    size_t l = 0;
+    for(; l + 16 <= lags; l += 16){
+        float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+        float32x4_t acc2 = vdupq_n_f32(0.0f), acc3 = vdupq_n_f32(0.0f);
+
+        for(size_t i = 0; i < length; ++i){
+            const float r = ref[i];
+            const float *p = &x[l + i];
+            acc0 = vfmaq_n_f32(acc0, vld1q_f32(p), r);
+            acc1 = vfmaq_n_f32(acc1, vld1q_f32(p + 4), r);
+            acc2 = vfmaq_n_f32(acc2, vld1q_f32(p + 8), r);
+            acc3 = vfmaq_n_f32(acc3, vld1q_f32(p + 12), r);
+        }
+
+        vst1q_f32(&out[l], acc0);
+        vst1q_f32(&out[l + 4], acc1);
+        vst1q_f32(&out[l + 8], acc2);
+        vst1q_f32(&out[l + 12], acc3);
+    }
+
+    for(; l + 4 <= lags; l += 4){
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for(size_t i = 0; i < length; ++i){
+            acc = vfmaq_n_f32(acc, vld1q_f32(&x[l + i]), ref[i]);
+        }
+        vst1q_f32(&out[l], acc);
+    }
+
+    crossCorrelateScalar(x + l, ref, out + l, lags - l, length);
+}
+
+void AJ::dsp::kernels::polyphaseNEON(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count){
+    //* one output per dot product: 8 taps per iteration over two accumulators, summed across lanes at the end.
+    for(size_t k = 0; k < count; ++k){
+        const float *h = bank + phase * taps;
+        float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+
+        size_t i = 0;
+        for(; i + 8 <= taps; i += 8){
+            acc0 = vfmaq_f32(acc0, vld1q_f32(&x[i]), vld1q_f32(&h[i]));
+            acc1 = vfmaq_f32(acc1, vld1q_f32(&x[i + 4]), vld1q_f32(&h[i + 4]));
+        }
+
+        for(; i + 4 <= taps; i += 4){
+            acc0 = vfmaq_f32(acc0, vld1q_f32(&x[i]), vld1q_f32(&h[i]));
+        }
+
+        float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+        for(; i < taps; ++i){
+            sum += x[i] * h[i];
+        }
+        out[k] = sum;
+
+        phase += step;
+        x += phase / phases;
+        phase %= phases;
+    }
+}
+
+void AJ::dsp::kernels::biquadNEON(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs,
+    float *state){
+    constexpr size_t kVectors = kBiquadLanes / 4;
+    const size_t vectors = (lanes + 3) / 4;
+    const size_t stages = vectors * 4 / channels;
+
+    float32x4_t b0[kVectors], b1[kVectors], b2[kVectors], a1[kVectors], a2[kVectors];
+    float32x4_t s1[kVectors], s2[kVectors], y[kVectors], stage[kVectors];
+
+    for(size_t v = 0; v < vectors; ++v){
+        b0[v] = vld1q_f32(&coeffs[v * 4]);
+        b1[v] = vld1q_f32(&coeffs[kBiquadLanes + v * 4]);
+        b2[v] = vld1q_f32(&coeffs[2 * kBiquadLanes + v * 4]);
+        a1[v] = vld1q_f32(&coeffs[3 * kBiquadLanes + v * 4]);
+        a2[v] = vld1q_f32(&coeffs[4 * kBiquadLanes + v * 4]);
+        s1[v] = vld1q_f32(&state[v * 4]);
+        s2[v] = vld1q_f32(&state[kBiquadLanes + v * 4]);
+        y[v] = vdupq_n_f32(0.0f);
+
+        float index[4];
+        for(size_t l = 0; l < 4; ++l) index[l] = static_cast<float>((v * 4 + l) / channels);
+        stage[v] = vld1q_f32(index);
+    }
+
+    //* step t: stage k filters frame t - k. While filling / draining only the stages holding a frame update their state.
+    const size_t steps = frames + stages - 1;
+    for(size_t t = 0; t < steps; ++t){
+        const bool full = t + 1 >= stages && t < frames;
+        const float32x4_t x = t < frames ? broadcastFrame4(&data[t * channels], channels) : vdupq_n_f32(0.0f);
+        const float32x4_t hi = vdupq_n_f32(static_cast<float>(std::min(t, stages)));
+        const float32x4_t lo = vdupq_n_f32(static_cast<float>(t >= frames ? t - frames + 1 : 0));
+
+        //* last vector first: y[v - 1] still holds the previous step.
+        for(size_t v = vectors; v-- > 0;){
+            const float32x4_t in = shiftStage4(y[v], v == 0 ? x : y[v - 1], channels);
+            const float32x4_t out = vfmaq_f32(s1[v], b0[v], in);
+            float32x4_t n1 = vfmsq_f32(vfmaq_f32(s2[v], b1[v], in), a1[v], out);
+            float32x4_t n2 = vfmsq_f32(vmulq_f32(b2[v], in), a2[v], out);
+
+            if(!full){
+                const uint32x4_t active = vandq_u32(vcleq_f32(stage[v], hi), vcgeq_f32(stage[v], lo));
+                n1 = vbslq_f32(active, n1, s1[v]);
+                n2 = vbslq_f32(active, n2, s2[v]);
+            }
+
+            s1[v] = n1;
+            s2[v] = n2;
+            y[v] = out;
+        }
+
+        if(t + 1 >= stages){
+            float *frame = &data[(t + 1 - stages) * channels];
+            if(channels == 1){
+                *frame = vgetq_lane_f32(y[vectors - 1], 3);
+            } else {
+                vst1_f32(frame, vget_high_f32(y[vectors - 1]));
+            }
+        }
+    }
+
+    for(size_t v = 0; v < vectors; ++v){
+        vst1q_f32(&state[v * 4], s1[v]);
+        vst1q_f32(&state[kBiquadLanes + v * 4], s2[v]);
+    }
+}
+
+void AJ::dsp::kernels::framePeakNEON(const float *data, size_t frames, size_t channels, float *peaks){
+    size_t f = 0;
+
+    if(channels == 1){
+        for(; f + 4 <= frames; f += 4){
+            vst1q_f32(&peaks[f], vabsq_f32(vld1q_f32(&data[f])));
+        }
+    } else if(channels == 2){
+        for(; f + 4 <= frames; f += 4){
+            const float32x4x2_t x = vld2q_f32(&data[2 * f]);
+            vst1q_f32(&peaks[f], vmaxq_f32(vabsq_f32(x.val[0]), vabsq_f32(x.val[1])));
+        }
+    }
+
+    framePeakScalar(data + f * channels, frames - f, channels, peaks + f);
+}
+
+void AJ::dsp::kernels::frameGainNEON(float *data, size_t frames, size_t channels, const float *gains){
+    size_t f = 0;
+
+    if(channels == 1){
+        for(; f + 4 <= frames; f += 4){
+            vst1q_f32(&data[f], vmulq_f32(vld1q_f32(&data[f]), vld1q_f32(&gains[f])));
+        }
+    } else if(channels == 2){
+        for(; f + 4 <= frames; f += 4){
+            const float32x4_t g = vld1q_f32(&gains[f]);
+            float32x4x2_t x = vld2q_f32(&data[2 * f]);
+            x.val[0] = vmulq_f32(x.val[0], g);
+            x.val[1] = vmulq_f32(x.val[1], g);
+            vst2q_f32(&data[2 * f], x);
+        }
+    }
+
+    frameGainScalar(data + f * channels, frames - f, channels, gains + f);
+}
+
+void AJ::dsp::kernels::reverseNEON(float *front, float *back, size_t frames, size_t channels){
+    size_t f = 0;
+
+    if(channels == 1 || channels == 2){
+        const size_t step = 4 / channels;
+        float *end = back + frames * channels;
+
+        for(; f + step <= frames; f += step){
+            float *mirror = end - (f + step) * channels;
+            float32x4_t a = vld1q_f32(&front[f * channels]);
+            float32x4_t b = vld1q_f32(mirror);
+            //* swap the halves (stereo: the two frames), mono also swaps within them: 3 2 1 0.
+            if(channels == 1){
+                a = vrev64q_f32(a);
+                b = vrev64q_f32(b);
+            }
+            vst1q_f32(&front[f * channels], vextq_f32(b, b, 2));
+            vst1q_f32(mirror, vextq_f32(a, a, 2));
+        }
+    }
+
+    reverseScalar(front + f * channels, back, frames - f, channels);
+}
+
+void AJ::dsp::kernels::mixAddNEON(const float *in, float *out, size_t frames, float left, float right){
+    const float gains[4] = { left, right, left, right };
+    const float32x4_t gain_v = vld1q_f32(gains);
+
+    size_t f = 0;
+    for(; f + 2 <= frames; f += 2){
+        vst1q_f32(&out[2 * f], vfmaq_f32(vld1q_f32(&out[2 * f]), vld1q_f32(&in[2 * f]), gain_v));
+    }
+
+    mixAddScalar(in + 2 * f, out + 2 * f, frames - f, left, right);
+}
+
+size_t AJ::dsp::kernels::findAboveNEON(const float *data, size_t count, float threshold){
+    const float32x4_t threshold_v = vdupq_n_f32(threshold);
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        //* vcagtq: |x| > |threshold| in one instruction (the threshold is never negative).
+        const uint32x4_t a = vcagtq_f32(vld1q_f32(&data[i]), threshold_v);
+        const uint32x4_t b = vcagtq_f32(vld1q_f32(&data[i + 4]), threshold_v);
+        const uint32x4_t c = vcagtq_f32(vld1q_f32(&data[i + 8]), threshold_v);
+        const uint32x4_t d = vcagtq_f32(vld1q_f32(&data[i + 12]), threshold_v);
+        if(vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d)))){
+            break;
+        }
+    }
+
+    return i + findAboveScalar(data + i, count - i, threshold);
+}
+
+size_t AJ::dsp::kernels::findLastAboveNEON(const float *data, size_t count, float threshold){
+    const float32x4_t threshold_v = vdupq_n_f32(threshold);
+
+    size_t i = count;
+    for(; i >= 16; i -= 16){
+        const float *block = data + i - 16;
+        const uint32x4_t a = vcagtq_f32(vld1q_f32(&block[0]), threshold_v);
+        const uint32x4_t b = vcagtq_f32(vld1q_f32(&block[4]), threshold_v);
+        const uint32x4_t c = vcagtq_f32(vld1q_f32(&block[8]), threshold_v);
+        const uint32x4_t d = vcagtq_f32(vld1q_f32(&block[12]), threshold_v);
+        if(vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d)))){
+            break;
+        }
+    }
+
+    return findLastAboveScalar(data, i, threshold);
+}
+
+void AJ::dsp::kernels::glideNEON(float *gains, size_t count, float start, float target, float coef){
+    //* lane k is k + 1 steps in, a vector moves every lane 4 steps further.
+    const float coef2 = coef * coef;
+    const float powers[4] = { coef, coef2, coef2 * coef, coef2 * coef2 };
+    const float32x4_t target_v = vdupq_n_f32(target);
+    float32x4_t distance = vmulq_n_f32(vld1q_f32(powers), start - target);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        vst1q_f32(&gains[i], vaddq_f32(target_v, distance));
+        distance = vmulq_n_f32(distance, powers[3]);
+    }
+
+    glideScalar(gains + i, count - i, i ? gains[i - 1] : start, target, coef);
+}
+
+void AJ::dsp::kernels::combNEON(float *line, float gain, const float *in, float *acc, size_t count){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        // y[n] = x[n] + g * y[n - M], the 4 taps y[n - M] are the next 4 samples of the line
+        float32x4_t out = vfmaq_n_f32(vld1q_f32(&in[i]), vld1q_f32(&line[i]), gain);
+
+        // write back the outputs in place of the taps, add them to the comb bank sum
+        vst1q_f32(&line[i], out);
+        vst1q_f32(&acc[i], vaddq_f32(vld1q_f32(&acc[i]), out));
+    }
+
+    for(; i < count; ++i){
+        line[i] = in[i] + gain * line[i];
+        acc[i] += line[i];
+    }
+}
+
+namespace {
+
+//* tanh approximations, see AJ::dsp::kernels::tanhApprox().
+inline float32x4_t tanhAccurate4(float32x4_t x){
+    x = vmaxq_f32(vminq_f32(x, vdupq_n_f32(4.97f)), vdupq_n_f32(-4.97f));
+    const float32x4_t x2 = vmulq_f32(x, x);
+
+    float32x4_t num = vaddq_f32(vdupq_n_f32(378.0f), x2);
+    num = vfmaq_f32(vdupq_n_f32(17325.0f), x2, num);
+    num = vmulq_f32(x, vfmaq_f32(vdupq_n_f32(135135.0f), x2, num));
+
+    float32x4_t den = vfmaq_n_f32(vdupq_n_f32(3150.0f), x2, 28.0f);
+    den = vfmaq_f32(vdupq_n_f32(62370.0f), x2, den);
+    den = vfmaq_f32(vdupq_n_f32(135135.0f), x2, den);
+
+    return vdivq_f32(num, den);
+}
+
+inline float32x4_t tanhFast4(float32x4_t x){
+    x = vmaxq_f32(vminq_f32(x, vdupq_n_f32(3.0f)), vdupq_n_f32(-3.0f));
+    const float32x4_t x2 = vmulq_f32(x, x);
+
+    return vdivq_f32(
+        vmulq_f32(x, vaddq_f32(vdupq_n_f32(27.0f), x2)),
+        vfmaq_n_f32(vdupq_n_f32(27.0f), x2, 9.0f)
+    );
+}
+
+}
+
+void AJ::dsp::kernels::shapeNEON(float *data, size_t count, const ShapeParams &params){
+    size_t i = 0;
+
+    switch(params.curve){
+    case Curve::HardClip:
+        for(; i + 4 <= count; i += 4){
+            vst1q_f32(&data[i], clamp4(vmulq_n_f32(vld1q_f32(&data[i]), params.drive)));
+        }
+        break;
+
+    case Curve::Cubic:
+        for(; i + 4 <= count; i += 4){
+            float32x4_t u = clamp4(vmulq_n_f32(vld1q_f32(&data[i]), params.drive));
+
+            // 1.5 u - 0.5 u^3
+            float32x4_t u3 = vmulq_f32(vmulq_f32(u, u), u);
+            vst1q_f32(&data[i], vsubq_f32(vmulq_n_f32(u, 1.5f), vmulq_n_f32(u3, 0.5f)));
+        }
+        break;
+
+    default: {
+        const float32x4_t drive = vdupq_n_f32(params.drive);
+        const float32x4_t drive_neg = vdupq_n_f32(params.driveNeg);
+        const float32x4_t makeup = vdupq_n_f32(params.makeup);
+        const float32x4_t makeup_neg = vdupq_n_f32(params.makeupNeg);
+        const bool fast = params.approx == TanhApprox::Fast;
+
+        for(; i + 4 <= count; i += 4){
+            float32x4_t samples = vld1q_f32(&data[i]);
+
+            // per lane drive / makeup: negative samples (mask set) take the negative half values
+            uint32x4_t negative = vcltq_f32(samples, vdupq_n_f32(0.0f));
+            float32x4_t x = vmulq_f32(samples, vbslq_f32(negative, drive_neg, drive));
+            float32x4_t y = fast ? tanhFast4(x) : tanhAccurate4(x);
+
+            vst1q_f32(&data[i], vmulq_f32(y, vbslq_f32(negative, makeup_neg, makeup)));
+        }
+        break;
+    }
+    }
+
+    // calculate the rest if there.
+    if(i < count){
+        shapeScalar(data + i, count - i, params);
+    }
+}
+
+AJ::dsp::kernels::Levels AJ::dsp::kernels::analyzeNEON(const float *data, size_t count){
+    float32x4_t min = vdupq_n_f32(FLT_MAX);
+    float32x4_t max = vdupq_n_f32(-FLT_MAX);
+    // squares are summed in double lanes (2 accumulators per half) so long ranges don't lose precision.
+    float64x2_t sum_lo = vdupq_n_f64(0.0);
+    float64x2_t sum_hi = vdupq_n_f64(0.0);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        float32x4_t samples = vld1q_f32(&data[i]);
+        min = vminq_f32(min, samples);
+        max = vmaxq_f32(max, samples);
+
+        float64x2_t lo = vcvt_f64_f32(vget_low_f32(samples));
+        float64x2_t hi = vcvt_high_f64_f32(samples);
+        sum_lo = vfmaq_f64(sum_lo, lo, lo);
+        sum_hi = vfmaq_f64(sum_hi, hi, hi);
+    }
+
+    Levels levels{FLT_MAX, -FLT_MAX, 0.0};
+    levels.min = vminvq_f32(min);
+    levels.max = vmaxvq_f32(max);
+    levels.sumSquares = vaddvq_f64(vaddq_f64(sum_lo, sum_hi));
+
+    // calculate the rest if there.
+    if(i < count){
+        Levels rest = analyzeScalar(data + i, count - i);
+        levels.min = rest.min < levels.min ? rest.min : levels.min;
+        levels.max = rest.max > levels.max ? rest.max : levels.max;
+        levels.sumSquares += rest.sumSquares;
+    }
+
+    return levels;
+}
+
+void AJ::dsp::kernels::interleaveNEON(const float *left, const float *right, float *out, size_t frames){
+    size_t i = 0;
+    for(; i + 4 <= frames; i += 4){
+        float32x4x2_t pair;
+        pair.val[0] = vld1q_f32(&left[i]);
+        pair.val[1] = vld1q_f32(&right[i]);
+        vst2q_f32(&out[2 * i], pair); // stores l0 r0 l1 r1 ...
+    }
+
+    if(i < frames){
+        interleaveScalar(left + i, right + i, out + 2 * i, frames - i);
+    }
+}
+
+void AJ::dsp::kernels::deinterleaveNEON(const float *in, float *left, float *right, size_t frames){
+    size_t i = 0;
+    for(; i + 4 <= frames; i += 4){
+        float32x4x2_t pair = vld2q_f32(&in[2 * i]);
+        vst1q_f32(&left[i], pair.val[0]);
+        vst1q_f32(&right[i], pair.val[1]);
+    }
+
+    if(i < frames){
+        deinterleaveScalar(in + 2 * i, left + i, right + i, frames - i);
+    }
+}
+
+void AJ::dsp::kernels::toInt16NEON(const float *in, int16_t *out, size_t count, const float *dither){
+    const float32x4_t hi = vdupq_n_f32(32767.0f);
+    const float32x4_t lo = vdupq_n_f32(-32768.0f);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        float32x4_t a = vmulq_n_f32(vld1q_f32(&in[i]), 32767.0f);
+        float32x4_t b = vmulq_n_f32(vld1q_f32(&in[i + 4]), 32767.0f);
+
+        if(dither){
+            a = vaddq_f32(a, vld1q_f32(&dither[i]));
+            b = vaddq_f32(b, vld1q_f32(&dither[i + 4]));
+        }
+
+        // round to nearest even, then narrow with saturation.
+        int32x4_t ia = vcvtnq_s32_f32(vmaxq_f32(vminq_f32(a, hi), lo));
+        int32x4_t ib = vcvtnq_s32_f32(vmaxq_f32(vminq_f32(b, hi), lo));
+        vst1q_s16(&out[i], vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+    }
+
+    if(i < count){
+        toInt16Scalar(in + i, out + i, count - i, dither ? dither + i : nullptr);
+    }
+}
+
+void AJ::dsp::kernels::fromInt16NEON(const int16_t *in, float *out, size_t count){
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        int16x8_t samples = vld1q_s16(&in[i]);
+
+        vst1q_f32(&out[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), 1.0f / 32768.0f));
+        vst1q_f32(&out[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(samples)), 1.0f / 32768.0f));
+    }
+
+    if(i < count){
+        fromInt16Scalar(in + i, out + i, count - i);
+    }
+}
+
+void AJ::dsp::kernels::toInt32NEON(const float *in, int32_t *out, size_t count, float scale, const float *dither){
+    const float32x4_t hi = vdupq_n_f32(scale < 2147483520.0f ? scale : 2147483520.0f);
+    const float32x4_t lo = vdupq_n_f32(-scale - 1.0f);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        float32x4_t samples = vmulq_n_f32(vld1q_f32(&in[i]), scale);
+        if(dither){
+            samples = vaddq_f32(samples, vld1q_f32(&dither[i]));
+        }
+
+        vst1q_s32(&out[i], vcvtnq_s32_f32(vmaxq_f32(vminq_f32(samples, hi), lo)));
+    }
+
+    if(i < count){
+        toInt32Scalar(in + i, out + i, count - i, scale, dither ? dither + i : nullptr);
+    }
+}
+
+void AJ::dsp::kernels::fromInt32NEON(const int32_t *in, float *out, size_t count, float gain){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        vst1q_f32(&out[i], vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(&in[i])), gain));
+    }
+
+    if(i < count){
+        fromInt32Scalar(in + i, out + i, count - i, gain);
+    }
+}
+
+void AJ::dsp::kernels::toHalfNEON(const float *in, uint16_t *out, size_t count){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        vst1_u16(&out[i], vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(&in[i]))));
+    }
+
+    if(i < count){
+        toHalfScalar(in + i, out + i, count - i);
+    }
+}
+
+void AJ::dsp::kernels::fromHalfNEON(const uint16_t *in, float *out, size_t count){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        vst1q_f32(&out[i], vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(&in[i]))));
+    }
+
+    if(i < count){
+        fromHalfScalar(in + i, out + i, count - i);
+    }
+}
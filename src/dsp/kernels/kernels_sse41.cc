@@ -0,0 +1,768 @@
+#include "dsp/kernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <smmintrin.h>
+/*
+    - SSE4.1 - 128-bit operations (4 floats)
+    ! built with -msse4.1 only, don't include engine headers here (see dsp/kernels.h).
+*/
+
+namespace {
+
+inline float clampSample(float sample){
+    return sample > 1.0f ? 1.0f : (sample < -1.0f ? -1.0f : sample);
+}
+
+inline float horizontalSum4(__m128 v){
+    const __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehdup_ps(pairs)));
+}
+
+//* biquad pipeline: lanes move up by one stage (`channels` lanes), `prev` fills the lowest ones.
+
+inline __m128 shiftStage4(__m128 cur, __m128 prev, size_t channels){
+    const __m128i c = _mm_castps_si128(cur), p = _mm_castps_si128(prev);
+    return _mm_castsi128_ps(channels == 1 ? _mm_alignr_epi8(c, p, 12) : _mm_alignr_epi8(c, p, 8));
+}
+
+//* the frame in the highest `channels` lanes (every lane holds a copy).
+inline __m128 broadcastFrame4(const float *frame, size_t channels){
+    return channels == 1 ? _mm_load1_ps(frame)
+        : _mm_castpd_ps(_mm_loaddup_pd(reinterpret_cast<const double*>(frame)));
+}
+
+//* phase kernels: same approximations as the scalar ones (see kernels.cc).
+
+inline __m128 abs4(__m128 x){
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+
+inline __m128 wrapPhase4(__m128 x){
+    const __m128 turns = _mm_round_ps(_mm_mul_ps(x, _mm_set1_ps(1.0f / 6.28318531f)),
+        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    return _mm_sub_ps(x, _mm_mul_ps(turns, _mm_set1_ps(6.28318531f)));
+}
+
+inline __m128 atan2Approx4(__m128 y, __m128 x){
+    const __m128 ax = abs4(x), ay = abs4(y);
+    const __m128 a = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(_mm_max_ps(ax, ay), _mm_set1_ps(FLT_MIN)));
+    const __m128 s = _mm_mul_ps(a, a);
+
+    __m128 p = _mm_add_ps(_mm_mul_ps(s, _mm_set1_ps(-0.01172120f)), _mm_set1_ps(0.05265332f));
+    p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(-0.11643287f));
+    p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(0.19354346f));
+    p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(-0.33262347f));
+    p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(0.99997726f));
+    __m128 r = _mm_mul_ps(a, p);
+
+    r = _mm_blendv_ps(r, _mm_sub_ps(_mm_set1_ps(1.57079633f), r), _mm_cmpgt_ps(ay, ax));
+    r = _mm_blendv_ps(r, _mm_sub_ps(_mm_set1_ps(3.14159265f), r), _mm_cmplt_ps(x, _mm_setzero_ps()));
+    return _mm_or_ps(r, _mm_and_ps(y, _mm_set1_ps(-0.0f)));
+}
+
+inline void sinCosApprox4(__m128 x, __m128 &sin, __m128 &cos){
+    const __m128 j = _mm_round_ps(_mm_mul_ps(x, _mm_set1_ps(0.636619772f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(1.5703125f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(4.83751297e-4f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(7.54978995e-8f)));
+    const __m128 r2 = _mm_mul_ps(r, r);
+
+    __m128 ps = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)), _mm_set1_ps(8.3321608736e-3f));
+    ps = _mm_add_ps(_mm_mul_ps(ps, r2), _mm_set1_ps(-1.6666654611e-1f));
+    ps = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), ps));
+
+    __m128 pc = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(2.443315712e-5f)), _mm_set1_ps(-1.388731625e-3f));
+    pc = _mm_add_ps(_mm_mul_ps(pc, r2), _mm_set1_ps(4.166664568e-2f));
+    pc = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_mul_ps(_mm_mul_ps(r2, r2), pc));
+
+    //* quadrant q: odd swaps sin / cos, sin is negated for q = 2, 3, cos for q = 1, 2.
+    const __m128i q = _mm_cvtps_epi32(j);
+    const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+    const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)),
+        _mm_set1_epi32(2)), 30));
+
+    sin = _mm_xor_ps(_mm_blendv_ps(ps, pc, swap), sinSign);
+    cos = _mm_xor_ps(_mm_blendv_ps(pc, ps, swap), cosSign);
+}
+
+}
+
+void AJ::dsp::kernels::gainSSE41(float *data, size_t count, float gain){
+    const __m128 gain_v = _mm_set1_ps(gain);
+    const __m128 max_val = _mm_set1_ps(1.0f);
+    const __m128 min_val = _mm_set1_ps(-1.0f);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128 samples = _mm_mul_ps(_mm_loadu_ps(&data[i]), gain_v);
+        _mm_storeu_ps(&data[i], _mm_max_ps(_mm_min_ps(samples, max_val), min_val));
+    }
+
+    // calculate the rest if there.
+    for(; i < count; ++i){
+        data[i] = clampSample(data[i] * gain);
+    }
+}
+
+void AJ::dsp::kernels::scaleSSE41(float *data, size_t count, float gain){
+    const __m128 gain_v = _mm_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        _mm_storeu_ps(&data[i], _mm_mul_ps(_mm_loadu_ps(&data[i]), gain_v));
+    }
+
+    for(; i < count; ++i){
+        data[i] *= gain;
+    }
+}
+
+void AJ::dsp::kernels::fadeSSE41(float *data, size_t count, double startGain, double step){
+    const __m128 max_val = _mm_set1_ps(1.0f);
+    const __m128 min_val = _mm_set1_ps(-1.0f);
+
+    //* the gain of the first lane is computed in double per vector so it doesn't drift,
+    //* the other lanes are steps ahead of it.
+    const __m128 lane_steps = _mm_mul_ps(_mm_setr_ps(0, 1, 2, 3), _mm_set1_ps(static_cast<float>(step)));
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128 gain = _mm_add_ps(_mm_set1_ps(static_cast<float>(startGain + step * i)), lane_steps);
+        __m128 samples = _mm_mul_ps(_mm_loadu_ps(&data[i]), gain);
+        _mm_storeu_ps(&data[i], _mm_max_ps(_mm_min_ps(samples, max_val), min_val));
+    }
+
+    for(; i < count; ++i){
+        data[i] = clampSample(data[i] * static_cast<float>(startGain + step * i));
+    }
+}
+
+void AJ::dsp::kernels::echoSSE41(const float *in, const float *delayed, float *out, size_t count, float decay){
+    const __m128 decay_v = _mm_set1_ps(decay);
+    const __m128 max_val = _mm_set1_ps(1.0f);
+    const __m128 min_val = _mm_set1_ps(-1.0f);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128 samples = _mm_add_ps(_mm_loadu_ps(&in[i]), _mm_mul_ps(_mm_loadu_ps(&delayed[i]), decay_v));
+        _mm_storeu_ps(&out[i], _mm_max_ps(_mm_min_ps(samples, max_val), min_val));
+    }
+
+    for(; i < count; ++i){
+        out[i] = clampSample(in[i] + delayed[i] * decay);
+    }
+}
+
+void AJ::dsp::kernels::mulAddSSE41(const float *in, const float *delayed, float *out, size_t count, float gain){
+    const __m128 gain_v = _mm_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        _mm_storeu_ps(&out[i], _mm_add_ps(_mm_loadu_ps(&in[i]), _mm_mul_ps(_mm_loadu_ps(&delayed[i]), gain_v)));
+    }
+
+    for(; i < count; ++i){
+        out[i] = in[i] + delayed[i] * gain;
+    }
+}
+
+void AJ::dsp::kernels::complexMulAddSSE41(const float *aRe, const float *aIm, const float *bRe, const float *bIm,
+    float *accRe, float *accIm, size_t count){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const __m128 ar = _mm_loadu_ps(&aRe[i]), ai = _mm_loadu_ps(&aIm[i]);
+        const __m128 br = _mm_loadu_ps(&bRe[i]), bi = _mm_loadu_ps(&bIm[i]);
+
+        // (ar + j ai)(br + j bi) = (ar br - ai bi) + j (ar bi + ai br)
+        _mm_storeu_ps(&accRe[i], _mm_add_ps(_mm_loadu_ps(&accRe[i]), _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi))));
+        _mm_storeu_ps(&accIm[i], _mm_add_ps(_mm_loadu_ps(&accIm[i]), _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br))));
+    }
+
+    for(; i < count; ++i){
+        accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+        accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+    }
+}
+
+void AJ::dsp::kernels::butterflySSE41(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+    size_t count){
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const __m128 xr = _mm_loadu_ps(&ar[i]), xi = _mm_loadu_ps(&ai[i]);
+        const __m128 yr = _mm_loadu_ps(&br[i]), yi = _mm_loadu_ps(&bi[i]);
+        const __m128 cr = _mm_loadu_ps(&wr[i]), ci = _mm_loadu_ps(&wi[i]);
+
+        // v = b * w
+        const __m128 vr = _mm_sub_ps(_mm_mul_ps(yr, cr), _mm_mul_ps(yi, ci));
+        const __m128 vi = _mm_add_ps(_mm_mul_ps(yr, ci), _mm_mul_ps(yi, cr));
+
+        _mm_storeu_ps(&br[i], _mm_sub_ps(xr, vr));
+        _mm_storeu_ps(&bi[i], _mm_sub_ps(xi, vi));
+        _mm_storeu_ps(&ar[i], _mm_add_ps(xr, vr));
+        _mm_storeu_ps(&ai[i], _mm_add_ps(xi, vi));
+    }
+
+    for(; i < count; ++i){
+        const float vr = br[i] * wr[i] - bi[i] * wi[i];
+        const float vi = br[i] * wi[i] + bi[i] * wr[i];
+
+        br[i] = ar[i] - vr;
+        bi[i] = ai[i] - vi;
+        ar[i] += vr;
+        ai[i] += vi;
+    }
+}
+
+void AJ::dsp::kernels::phaseAnalyzeSSE41(const float *re, const float *im, float *lastPhase, float *mag, float *freq,
+    size_t first, size_t count, float hopPhase){
+    const __m128 hop_v = _mm_set1_ps(hopPhase);
+    const __m128 invHop_v = _mm_set1_ps(1.0f / hopPhase);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const __m128 xr = _mm_loadu_ps(&re[i]), xi = _mm_loadu_ps(&im[i]);
+        const float k = static_cast<float>(first + i);
+        const __m128 bin = _mm_add_ps(_mm_set1_ps(k), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+        const __m128 phase = atan2Approx4(xi, xr);
+
+        // freq = k + wrap(phase - last - k * hop) / hop
+        const __m128 delta = _mm_sub_ps(_mm_sub_ps(phase, _mm_loadu_ps(&lastPhase[i])), _mm_mul_ps(bin, hop_v));
+        _mm_storeu_ps(&mag[i], _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(xr, xr), _mm_mul_ps(xi, xi))));
+        _mm_storeu_ps(&freq[i], _mm_add_ps(bin, _mm_mul_ps(wrapPhase4(delta), invHop_v)));
+        _mm_storeu_ps(&lastPhase[i], phase);
+    }
+
+    if(i < count){
+        phaseAnalyzeScalar(re + i, im + i, lastPhase + i, mag + i, freq + i, first + i, count - i, hopPhase);
+    }
+}
+
+void AJ::dsp::kernels::phaseSynthesizeSSE41(const float *mag, const float *freq, float *sumPhase, float *re, float *im,
+    size_t count, float hopPhase){
+    const __m128 hop_v = _mm_set1_ps(hopPhase);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const __m128 phase = wrapPhase4(_mm_add_ps(_mm_loadu_ps(&sumPhase[i]), _mm_mul_ps(_mm_loadu_ps(&freq[i]), hop_v)));
+        const __m128 m = _mm_loadu_ps(&mag[i]);
+        __m128 sin, cos;
+        sinCosApprox4(phase, sin, cos);
+
+        _mm_storeu_ps(&sumPhase[i], phase);
+        _mm_storeu_ps(&re[i], _mm_mul_ps(m, cos));
+        _mm_storeu_ps(&im[i], _mm_mul_ps(m, sin));
+    }
+
+    if(i < count){
+        phaseSynthesizeScalar(mag + i, freq + i, sumPhase + i, re + i, im + i, count - i, hopPhase);
+    }
+}
+
+void AJ::dsp::kernels::crossCorrelateSSE41(const float *x, const float *ref, float *out, size_t lags, size_t length){
+    //* 4 lags per vector: every reference sample is broadcast and multiplied with 4 shifted windows at once.
+    size_t l = 0;
+    for(; l + 16 <= lags; l += 16){
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps(), acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+
+        for(size_t i = 0; i < length; ++i){
+            const __m128 r = _mm_set1_ps(ref[i]);
+            const float *p = &x[l + i];
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(p), r));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(p + 4), r));
+            acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(p + 8), r));
+            acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(p + 12), r));
+        }
+
+        _mm_storeu_ps(&out[l], acc0);
+        _mm_storeu_ps(&out[l + 4], acc1);
+        _mm_storeu_ps(&out[l + 8], acc2);
+        _mm_storeu_ps(&out[l + 12], acc3);
+    }
+
+    for(; l + 4 <= lags; l += 4){
+        __m128 acc = _mm_setzero_ps();
+        for(size_t i = 0; i < length; ++i){
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(&x[l + i]), _mm_set1_ps(ref[i])));
+        }
+        _mm_storeu_ps(&out[l], acc);
+    }
+
+    crossCorrelateScalar(x + l, ref, out + l, lags - l, length);
+}
+
+void AJ::dsp::kernels::polyphaseSSE41(const float *x, const float *bank, size_t taps, size_t phases, size_t step,
+    size_t phase, float *out, size_t count){
+    //* one output per dot product: 8 taps per iteration over two accumulators, summed across lanes at the end.
+    for(size_t k = 0; k < count; ++k){
+        const float *h = bank + phase * taps;
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+
+        size_t i = 0;
+        for(; i + 8 <= taps; i += 8){
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&x[i]), _mm_loadu_ps(&h[i])));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&x[i + 4]), _mm_loadu_ps(&h[i + 4])));
+        }
+
+        for(; i + 4 <= taps; i += 4){
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&x[i]), _mm_loadu_ps(&h[i])));
+        }
+
+        float sum = horizontalSum4(_mm_add_ps(acc0, acc1));
+        for(; i < taps; ++i){
+            sum += x[i] * h[i];
+        }
+        out[k] = sum;
+
+        phase += step;
+        x += phase / phases;
+        phase %= phases;
+    }
+}
+
+void AJ::dsp::kernels::biquadSSE41(float *data, size_t frames, size_t channels, size_t lanes, const float *coeffs,
+    float *state){
+    constexpr size_t kVectors = kBiquadLanes / 4;
+    const size_t vectors = (lanes + 3) / 4;
+    const size_t stages = vectors * 4 / channels;
+
+    __m128 b0[kVectors], b1[kVectors], b2[kVectors], a1[kVectors], a2[kVectors];
+    __m128 s1[kVectors], s2[kVectors], y[kVectors], stage[kVectors];
+
+    for(size_t v = 0; v < vectors; ++v){
+        b0[v] = _mm_loadu_ps(&coeffs[v * 4]);
+        b1[v] = _mm_loadu_ps(&coeffs[kBiquadLanes + v * 4]);
+        b2[v] = _mm_loadu_ps(&coeffs[2 * kBiquadLanes + v * 4]);
+        a1[v] = _mm_loadu_ps(&coeffs[3 * kBiquadLanes + v * 4]);
+        a2[v] = _mm_loadu_ps(&coeffs[4 * kBiquadLanes + v * 4]);
+        s1[v] = _mm_loadu_ps(&state[v * 4]);
+        s2[v] = _mm_loadu_ps(&state[kBiquadLanes + v * 4]);
+        y[v] = _mm_setzero_ps();
+
+        float index[4];
+        for(size_t l = 0; l < 4; ++l) index[l] = static_cast<float>((v * 4 + l) / channels);
+        stage[v] = _mm_loadu_ps(index);
+    }
+
+    //* step t: stage k filters frame t - k. While filling / draining only the stages holding a frame update their state.
+    const size_t steps = frames + stages - 1;
+    for(size_t t = 0; t < steps; ++t){
+        const bool full = t + 1 >= stages && t < frames;
+        const __m128 x = t < frames ? broadcastFrame4(&data[t * channels], channels) : _mm_setzero_ps();
+        const __m128 hi = _mm_set1_ps(static_cast<float>(std::min(t, stages)));
+        const __m128 lo = _mm_set1_ps(static_cast<float>(t >= frames ? t - frames + 1 : 0));
+
+        //* last vector first: y[v - 1] still holds the previous step.
+        for(size_t v = vectors; v-- > 0;){
+            const __m128 in = shiftStage4(y[v], v == 0 ? x : y[v - 1], channels);
+            const __m128 out = _mm_add_ps(_mm_mul_ps(b0[v], in), s1[v]);
+            __m128 n1 = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(b1[v], in), s2[v]), _mm_mul_ps(a1[v], out));
+            __m128 n2 = _mm_sub_ps(_mm_mul_ps(b2[v], in), _mm_mul_ps(a2[v], out));
+
+            if(!full){
+                const __m128 active = _mm_and_ps(_mm_cmple_ps(stage[v], hi), _mm_cmpge_ps(stage[v], lo));
+                n1 = _mm_blendv_ps(s1[v], n1, active);
+                n2 = _mm_blendv_ps(s2[v], n2, active);
+            }
+
+            s1[v] = n1;
+            s2[v] = n2;
+            y[v] = out;
+        }
+
+        if(t + 1 >= stages){
+            const __m128 top = y[vectors - 1];
+            float *frame = &data[(t + 1 - stages) * channels];
+            if(channels == 1){
+                *frame = _mm_cvtss_f32(_mm_shuffle_ps(top, top, _MM_SHUFFLE(3, 3, 3, 3)));
+            } else {
+                _mm_storeh_pi(reinterpret_cast<__m64*>(frame), top);
+            }
+        }
+    }
+
+    for(size_t v = 0; v < vectors; ++v){
+        _mm_storeu_ps(&state[v * 4], s1[v]);
+        _mm_storeu_ps(&state[kBiquadLanes + v * 4], s2[v]);
+    }
+}
+
+void AJ::dsp::kernels::framePeakSSE41(const float *data, size_t frames, size_t channels, float *peaks){
+    size_t f = 0;
+
+    if(channels == 1){
+        for(; f + 4 <= frames; f += 4){
+            _mm_storeu_ps(&peaks[f], abs4(_mm_loadu_ps(&data[f])));
+        }
+    } else if(channels == 2){
+        for(; f + 4 <= frames; f += 4){
+            const __m128 a = abs4(_mm_loadu_ps(&data[2 * f]));
+            const __m128 b = abs4(_mm_loadu_ps(&data[2 * f + 4]));
+            const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(&peaks[f], _mm_max_ps(left, right));
+        }
+    }
+
+    framePeakScalar(data + f * channels, frames - f, channels, peaks + f);
+}
+
+void AJ::dsp::kernels::frameGainSSE41(float *data, size_t frames, size_t channels, const float *gains){
+    size_t f = 0;
+
+    if(channels == 1){
+        for(; f + 4 <= frames; f += 4){
+            _mm_storeu_ps(&data[f], _mm_mul_ps(_mm_loadu_ps(&data[f]), _mm_loadu_ps(&gains[f])));
+        }
+    } else if(channels == 2){
+        for(; f + 4 <= frames; f += 4){
+            const __m128 g = _mm_loadu_ps(&gains[f]);
+            _mm_storeu_ps(&data[2 * f], _mm_mul_ps(_mm_loadu_ps(&data[2 * f]), _mm_unpacklo_ps(g, g)));
+            _mm_storeu_ps(&data[2 * f + 4], _mm_mul_ps(_mm_loadu_ps(&data[2 * f + 4]), _mm_unpackhi_ps(g, g)));
+        }
+    }
+
+    frameGainScalar(data + f * channels, frames - f, channels, gains + f);
+}
+
+void AJ::dsp::kernels::reverseSSE41(float *front, float *back, size_t frames, size_t channels){
+    size_t f = 0;
+
+    if(channels == 1 || channels == 2){
+        const size_t step = 4 / channels;
+        float *end = back + frames * channels;
+
+        for(; f + step <= frames; f += step){
+            float *mirror = end - (f + step) * channels;
+            const __m128 a = _mm_loadu_ps(&front[f * channels]);
+            const __m128 b = _mm_loadu_ps(mirror);
+            //* mono: 3 2 1 0, stereo: swap the two frames.
+            if(channels == 1){
+                _mm_storeu_ps(&front[f], _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)));
+                _mm_storeu_ps(mirror, _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3)));
+            } else {
+                _mm_storeu_ps(&front[2 * f], _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)));
+                _mm_storeu_ps(mirror, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 0, 3, 2)));
+            }
+        }
+    }
+
+    reverseScalar(front + f * channels, back, frames - f, channels);
+}
+
+void AJ::dsp::kernels::mixAddSSE41(const float *in, float *out, size_t frames, float left, float right){
+    const __m128 gain_v = _mm_setr_ps(left, right, left, right);
+
+    size_t f = 0;
+    for(; f + 2 <= frames; f += 2){
+        _mm_storeu_ps(&out[2 * f], _mm_add_ps(_mm_loadu_ps(&out[2 * f]), _mm_mul_ps(_mm_loadu_ps(&in[2 * f]), gain_v)));
+    }
+
+    mixAddScalar(in + 2 * f, out + 2 * f, frames - f, left, right);
+}
+
+size_t AJ::dsp::kernels::findAboveSSE41(const float *data, size_t count, float threshold){
+    const __m128 threshold_v = _mm_set1_ps(threshold);
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        const __m128 a = _mm_cmpgt_ps(abs4(_mm_loadu_ps(&data[i])), threshold_v);
+        const __m128 b = _mm_cmpgt_ps(abs4(_mm_loadu_ps(&data[i + 4])), threshold_v);
+        const __m128 c = _mm_cmpgt_ps(abs4(_mm_loadu_ps(&data[i + 8])), threshold_v);
+        const __m128 d = _mm_cmpgt_ps(abs4(_mm_loadu_ps(&data[i + 12])), threshold_v);
+        if(_mm_movemask_ps(_mm_or_ps(_mm_or_ps(a, b), _mm_or_ps(c, d)))){
+            break;
+        }
+    }
+
+    return i + findAboveScalar(data + i, count - i, threshold);
+}
+
+size_t AJ::dsp::kernels::findLastAboveSSE41(const float *data, size_t count, float threshold){
+    const __m128 threshold_v = _mm_set1_ps(threshold);
+
+    size_t i = count;
+    for(; i >= 16; i -= 16){
+        const float *block = data + i - 16;
+        const __m128 a = _mm_cmpgt_ps(abs4(_mm_loadu_ps(&block[0])), threshold_v);
+        const __m128 b = _mm_cmpgt_ps(abs4(_mm_loadu_ps(&block[4])), threshold_v);
+        const __m128 c = _mm_cmpgt_ps(abs4(_mm_loadu_ps(&block[8])), threshold_v);
+        const __m128 d = _mm_cmpgt_ps(abs4(_mm_loadu_ps(&block[12])), threshold_v);
+        if(_mm_movemask_ps(_mm_or_ps(_mm_or_ps(a, b), _mm_or_ps(c, d)))){
+            break;
+        }
+    }
+
+    return findLastAboveScalar(data, i, threshold);
+}
+
+void AJ::dsp::kernels::glideSSE41(float *gains, size_t count, float start, float target, float coef){
+    //* lane k is k + 1 steps in, a vector moves every lane 4 steps further.
+    const float coef2 = coef * coef;
+    const __m128 step_v = _mm_set1_ps(coef2 * coef2);
+    const __m128 target_v = _mm_set1_ps(target);
+    __m128 distance = _mm_mul_ps(_mm_set1_ps(start - target), _mm_setr_ps(coef, coef2, coef2 * coef, coef2 * coef2));
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        _mm_storeu_ps(&gains[i], _mm_add_ps(target_v, distance));
+        distance = _mm_mul_ps(distance, step_v);
+    }
+
+    glideScalar(gains + i, count - i, i ? gains[i - 1] : start, target, coef);
+}
+
+void AJ::dsp::kernels::combSSE41(float *line, float gain, const float *in, float *acc, size_t count){
+    const __m128 gain_v = _mm_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        // y[n] = x[n] + g * y[n - M], the 4 taps y[n - M] are the next 4 samples of the line
+        __m128 out = _mm_add_ps(_mm_loadu_ps(&in[i]), _mm_mul_ps(_mm_loadu_ps(&line[i]), gain_v));
+
+        // write back the outputs in place of the taps, add them to the comb bank sum
+        _mm_storeu_ps(&line[i], out);
+        _mm_storeu_ps(&acc[i], _mm_add_ps(_mm_loadu_ps(&acc[i]), out));
+    }
+
+    for(; i < count; ++i){
+        line[i] = in[i] + gain * line[i];
+        acc[i] += line[i];
+    }
+}
+
+namespace {
+
+//* tanh approximations, see AJ::dsp::kernels::tanhApprox().
+inline __m128 tanhAccurate4(__m128 x){
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(4.97f)), _mm_set1_ps(-4.97f));
+    const __m128 x2 = _mm_mul_ps(x, x);
+
+    __m128 num = _mm_add_ps(_mm_set1_ps(378.0f), x2);
+    num = _mm_add_ps(_mm_set1_ps(17325.0f), _mm_mul_ps(x2, num));
+    num = _mm_mul_ps(x, _mm_add_ps(_mm_set1_ps(135135.0f), _mm_mul_ps(x2, num)));
+
+    __m128 den = _mm_add_ps(_mm_set1_ps(3150.0f), _mm_mul_ps(x2, _mm_set1_ps(28.0f)));
+    den = _mm_add_ps(_mm_set1_ps(62370.0f), _mm_mul_ps(x2, den));
+    den = _mm_add_ps(_mm_set1_ps(135135.0f), _mm_mul_ps(x2, den));
+
+    return _mm_div_ps(num, den);
+}
+
+inline __m128 tanhFast4(__m128 x){
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(3.0f)), _mm_set1_ps(-3.0f));
+    const __m128 x2 = _mm_mul_ps(x, x);
+
+    return _mm_div_ps(
+        _mm_mul_ps(x, _mm_add_ps(_mm_set1_ps(27.0f), x2)),
+        _mm_add_ps(_mm_set1_ps(27.0f), _mm_mul_ps(_mm_set1_ps(9.0f), x2))
+    );
+}
+
+}
+
+void AJ::dsp::kernels::shapeSSE41(float *data, size_t count, const ShapeParams &params){
+    const __m128 max_val = _mm_set1_ps(1.0f);
+    const __m128 min_val = _mm_set1_ps(-1.0f);
+    const __m128 drive = _mm_set1_ps(params.drive);
+
+    size_t i = 0;
+
+    switch(params.curve){
+    case Curve::HardClip:
+        for(; i + 4 <= count; i += 4){
+            __m128 samples = _mm_mul_ps(_mm_loadu_ps(&data[i]), drive);
+            _mm_storeu_ps(&data[i], _mm_max_ps(_mm_min_ps(samples, max_val), min_val));
+        }
+        break;
+
+    case Curve::Cubic:
+        for(; i + 4 <= count; i += 4){
+            __m128 u = _mm_mul_ps(_mm_loadu_ps(&data[i]), drive);
+            u = _mm_max_ps(_mm_min_ps(u, max_val), min_val);
+
+            // 1.5 u - 0.5 u^3
+            __m128 u3 = _mm_mul_ps(_mm_mul_ps(u, u), u);
+            _mm_storeu_ps(&data[i], _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.5f), u), _mm_mul_ps(_mm_set1_ps(0.5f), u3)));
+        }
+        break;
+
+    default: {
+        const __m128 drive_neg = _mm_set1_ps(params.driveNeg);
+        const __m128 makeup = _mm_set1_ps(params.makeup);
+        const __m128 makeup_neg = _mm_set1_ps(params.makeupNeg);
+        const bool fast = params.approx == TanhApprox::Fast;
+
+        for(; i + 4 <= count; i += 4){
+            __m128 samples = _mm_loadu_ps(&data[i]);
+
+            // per lane drive / makeup: negative samples (mask set) take the negative half values
+            __m128 negative = _mm_cmplt_ps(samples, _mm_setzero_ps());
+            __m128 x = _mm_mul_ps(samples, _mm_blendv_ps(drive, drive_neg, negative));
+            __m128 y = fast ? tanhFast4(x) : tanhAccurate4(x);
+
+            _mm_storeu_ps(&data[i], _mm_mul_ps(y, _mm_blendv_ps(makeup, makeup_neg, negative)));
+        }
+        break;
+    }
+    }
+
+    // calculate the rest if there.
+    if(i < count){
+        shapeScalar(data + i, count - i, params);
+    }
+}
+
+AJ::dsp::kernels::Levels AJ::dsp::kernels::analyzeSSE41(const float *data, size_t count){
+    __m128 min = _mm_set1_ps(FLT_MAX);
+    __m128 max = _mm_set1_ps(-FLT_MAX);
+    // squares are summed in double lanes (2 accumulators per half) so long ranges don't lose precision.
+    __m128d sum_lo = _mm_setzero_pd();
+    __m128d sum_hi = _mm_setzero_pd();
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128 samples = _mm_loadu_ps(&data[i]);
+        min = _mm_min_ps(min, samples);
+        max = _mm_max_ps(max, samples);
+
+        __m128d lo = _mm_cvtps_pd(samples);
+        __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(samples, samples));
+        sum_lo = _mm_add_pd(sum_lo, _mm_mul_pd(lo, lo));
+        sum_hi = _mm_add_pd(sum_hi, _mm_mul_pd(hi, hi));
+    }
+
+    alignas(16) float mins[4];
+    alignas(16) float maxs[4];
+    alignas(16) double sums[2];
+    _mm_store_ps(mins, min);
+    _mm_store_ps(maxs, max);
+    _mm_store_pd(sums, _mm_add_pd(sum_lo, sum_hi));
+
+    Levels levels{mins[0], maxs[0], sums[0] + sums[1]};
+    for(int lane = 1; lane < 4; ++lane){
+        levels.min = mins[lane] < levels.min ? mins[lane] : levels.min;
+        levels.max = maxs[lane] > levels.max ? maxs[lane] : levels.max;
+    }
+
+    // calculate the rest if there.
+    if(i < count){
+        Levels rest = analyzeScalar(data + i, count - i);
+        levels.min = rest.min < levels.min ? rest.min : levels.min;
+        levels.max = rest.max > levels.max ? rest.max : levels.max;
+        levels.sumSquares += rest.sumSquares;
+    }
+
+    return levels;
+}
+
+void AJ::dsp::kernels::interleaveSSE41(const float *left, const float *right, float *out, size_t frames){
+    size_t i = 0;
+    for(; i + 4 <= frames; i += 4){
+        __m128 l = _mm_loadu_ps(&left[i]);
+        __m128 r = _mm_loadu_ps(&right[i]);
+
+        // l0 r0 l1 r1 | l2 r2 l3 r3
+        _mm_storeu_ps(&out[2 * i], _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(&out[2 * i + 4], _mm_unpackhi_ps(l, r));
+    }
+
+    if(i < frames){
+        interleaveScalar(left + i, right + i, out + 2 * i, frames - i);
+    }
+}
+
+void AJ::dsp::kernels::deinterleaveSSE41(const float *in, float *left, float *right, size_t frames){
+    size_t i = 0;
+    for(; i + 4 <= frames; i += 4){
+        __m128 a = _mm_loadu_ps(&in[2 * i]);     // l0 r0 l1 r1
+        __m128 b = _mm_loadu_ps(&in[2 * i + 4]); // l2 r2 l3 r3
+
+        _mm_storeu_ps(&left[i], _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(&right[i], _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    if(i < frames){
+        deinterleaveScalar(in + 2 * i, left + i, right + i, frames - i);
+    }
+}
+
+void AJ::dsp::kernels::toInt16SSE41(const float *in, int16_t *out, size_t count, const float *dither){
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(&in[i]), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(&in[i + 4]), scale);
+
+        if(dither){
+            a = _mm_add_ps(a, _mm_loadu_ps(&dither[i]));
+            b = _mm_add_ps(b, _mm_loadu_ps(&dither[i + 4]));
+        }
+
+        // round to nearest (MXCSR default), then saturating pack to 16 bits.
+        __m128i ia = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(a, hi), lo));
+        __m128i ib = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(b, hi), lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), _mm_packs_epi32(ia, ib));
+    }
+
+    if(i < count){
+        toInt16Scalar(in + i, out + i, count - i, dither ? dither + i : nullptr);
+    }
+}
+
+void AJ::dsp::kernels::fromInt16SSE41(const int16_t *in, float *out, size_t count){
+    const __m128 gain = _mm_set1_ps(1.0f / 32768.0f);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+
+        __m128i lo = _mm_cvtepi16_epi32(samples);
+        __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(samples, 8));
+        _mm_storeu_ps(&out[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), gain));
+        _mm_storeu_ps(&out[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), gain));
+    }
+
+    if(i < count){
+        fromInt16Scalar(in + i, out + i, count - i);
+    }
+}
+
+void AJ::dsp::kernels::toInt32SSE41(const float *in, int32_t *out, size_t count, float scale, const float *dither){
+    const __m128 scale_v = _mm_set1_ps(scale);
+    const __m128 hi = _mm_set1_ps(scale < 2147483520.0f ? scale : 2147483520.0f);
+    const __m128 lo = _mm_set1_ps(-scale - 1.0f);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128 samples = _mm_mul_ps(_mm_loadu_ps(&in[i]), scale_v);
+        if(dither){
+            samples = _mm_add_ps(samples, _mm_loadu_ps(&dither[i]));
+        }
+
+        __m128i values = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(samples, hi), lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), values);
+    }
+
+    if(i < count){
+        toInt32Scalar(in + i, out + i, count - i, scale, dither ? dither + i : nullptr);
+    }
+}
+
+void AJ::dsp::kernels::fromInt32SSE41(const int32_t *in, float *out, size_t count, float gain){
+    const __m128 gain_v = _mm_set1_ps(gain);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+        _mm_storeu_ps(&out[i], _mm_mul_ps(_mm_cvtepi32_ps(values), gain_v));
+    }
+
+    if(i < count){
+        fromInt32Scalar(in + i, out + i, count - i, gain);
+    }
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "dsp/loudness/loudness.h"
+#include "dsp/kernels.h"
+#include "core/scratch_arena.h"
+
+namespace {
+
+constexpr size_t kTruePeakTaps = 12;
+
+//* BS.1770-4 Annex 2: one row of 12 taps per phase of the 4x interpolator.
+alignas(AJ::kBufferAlignment) const float kTruePeakBank[AJ::kLoudnessOversampling * kTruePeakTaps] = {
+     0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+     0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f,
+    -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+     0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f,
+    -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+     0.4650878906250f, -0.1665039062500f,  0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f,
+    -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+     0.1373291015625f, -0.0594482421875f,  0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f,
+};
+
+//* input positions interpolated per polyphase call.
+constexpr size_t kTruePeakBlock = 1024;
+
+double toLufs(double power){
+    return -0.691 + 10.0 * std::log10(power);
+}
+
+double fromLufs(double lufs){
+    return std::pow(10.0, (lufs + 0.691) / 10.0);
+}
+
+//* copy `frames` frames from `frame` on into `out`, interleaved.
+void gather(const float *const *channels, size_t count, size_t frame, size_t frames, float *out){
+    if(count == 1){
+        std::copy(channels[0] + frame, channels[0] + frame + frames, out);
+        return;
+    }
+    AJ::dsp::kernels::table().interleave(channels[0] + frame, channels[1] + frame, out, frames);
+}
+
+//* peak of the interpolated channel for the positions [begin, end), position i interpolates after
+//* the window x[i - 11, i] (zeros outside the channel).
+float truePeak(const float *x, size_t frames, size_t begin, size_t end, float *window, float *out){
+    const AJ::dsp::kernels::KernelTable &kernels = AJ::dsp::kernels::table();
+    constexpr size_t reach = kTruePeakTaps - 1;
+    float peak = 0.0f;
+
+    for(size_t position = begin; position < end; position += kTruePeakBlock){
+        const size_t n = std::min(kTruePeakBlock, end - position);
+
+        for(size_t i = 0; i < n + reach; ++i){
+            const size_t at = position + i; // frame at - reach
+            window[i] = at >= reach && at - reach < frames ? x[at - reach] : 0.0f;
+        }
+
+        kernels.polyphase(window, kTruePeakBank, kTruePeakTaps, AJ::kLoudnessOversampling, 1, 0,
+            out, n * AJ::kLoudnessOversampling);
+        peak = std::max(peak, AJ::dsp::kernels::peak(kernels.analyze(out, n * AJ::kLoudnessOversampling)));
+    }
+
+    return peak;
+}
+
+}
+
+std::array<AJ::dsp::eq::Coefficients, 2> AJ::dsp::loudness::kWeighting(double samplerate){
+    std::array<eq::Coefficients, 2> stages;
+
+    //* head shelf: +4 dB over ~1.7 kHz, the bilinear form of the analog prototype.
+    {
+        const double K = std::tan(M_PI * 1681.974450955533 / samplerate);
+        const double Q = 0.7071752369554196;
+        const double Vh = std::pow(10.0, 3.999843853973347 / 20.0);
+        const double Vb = std::pow(Vh, 0.4996667741545416);
+        const double a0 = 1.0 + K / Q + K * K;
+
+        stages[0].b0 = static_cast<float>((Vh + Vb * K / Q + K * K) / a0);
+        stages[0].b1 = static_cast<float>(2.0 * (K * K - Vh) / a0);
+        stages[0].b2 = static_cast<float>((Vh - Vb * K / Q + K * K) / a0);
+        stages[0].a1 = static_cast<float>(2.0 * (K * K - 1.0) / a0);
+        stages[0].a2 = static_cast<float>((1.0 - K / Q + K * K) / a0);
+    }
+
+    //* RLB high pass at ~38 Hz (unnormalized numerator 1, -2, 1 as in the standard).
+    {
+        const double K = std::tan(M_PI * 38.13547087602444 / samplerate);
+        const double Q = 0.5003270373238773;
+        const double a0 = 1.0 + K / Q + K * K;
+
+        stages[1].b0 = 1.0f;
+        stages[1].b1 = -2.0f;
+        stages[1].b2 = 1.0f;
+        stages[1].a1 = static_cast<float>(2.0 * (K * K - 1.0) / a0);
+        stages[1].a2 = static_cast<float>((1.0 - K / Q + K * K) / a0);
+    }
+
+    return stages;
+}
+
+bool AJ::dsp::loudness::measure(const float *const *channels, size_t count, size_t frames, uint32_t samplerate,
+    Measurement &measurement, utils::ThreadPool *pool){
+
+    measurement = Measurement{};
+    if(frames == 0 || count == 0){
+        return true;
+    }
+
+    const std::array<eq::Coefficients, 2> weighting = kWeighting(samplerate);
+    const size_t step = std::max<size_t>(1, static_cast<size_t>(std::lround(samplerate * kLoudnessStepMs / 1000.0)));
+    const size_t steps = frames / step;
+    const size_t chunkFrames = kLoudnessChunkSteps * step;
+    const size_t chunks = (frames + chunkFrames - 1) / chunkFrames;
+
+    std::vector<double> power(steps);   // mean square of every hop, summed over the channels.
+    std::vector<float> peaks(chunks);   // true peak of every task.
+    std::vector<char> done(chunks, 0);
+
+    auto task = [&](size_t c){
+        const kernels::KernelTable &kernels = kernels::table();
+        const size_t begin = c * chunkFrames;
+        const size_t end = std::min(frames, begin + chunkFrames);
+
+        utils::ScratchScope scope;
+        float *hop = scope.arena().array<float>(step * count);
+        float *window = scope.arena().array<float>(kTruePeakBlock + kTruePeakTaps);
+        float *out = scope.arena().array<float>(kTruePeakBlock * kLoudnessOversampling);
+        if(!hop || !window || !out){
+            return;
+        }
+
+        //* the K-weighting of the hops, after one hop of warm-up.
+        eq::BiquadCascade cascade;
+        cascade.setup(weighting.data(), weighting.size(), count);
+
+        if(begin >= step){
+            gather(channels, count, begin - step, step, hop);
+            cascade.process(hop, step);
+        }
+
+        for(size_t s = begin / step; s < std::min(steps, begin / step + kLoudnessChunkSteps); ++s){
+            gather(channels, count, s * step, step, hop);
+            cascade.process(hop, step);
+            power[s] = kernels.analyze(hop, step * count).sumSquares / step;
+        }
+
+        //* the last task also interpolates past the end, while the window slides out of the signal.
+        const size_t tail = end == frames ? kTruePeakTaps - 1 : 0;
+        float peak = 0.0f;
+        for(size_t ch = 0; ch < count; ++ch){
+            peak = std::max(peak, kernels::peak(kernels.analyze(channels[ch] + begin, end - begin)));
+            peak = std::max(peak, truePeak(channels[ch], frames, begin, end + tail, window, out));
+        }
+        peaks[c] = peak;
+        done[c] = 1;
+    };
+
+    if(pool && chunks > 1){
+        pool->parallel_for(0, chunks, 1, [&](size_t begin, size_t end){
+            for(size_t c = begin; c < end; ++c) task(c);
+        });
+    } else {
+        for(size_t c = 0; c < chunks; ++c) task(c);
+    }
+
+    if(std::find(done.begin(), done.end(), 0) != done.end()){
+        return false;
+    }
+
+    measurement.mTruePeak = *std::max_element(peaks.begin(), peaks.end());
+
+    //* 400 ms blocks overlapping by 300 ms, gated in two passes (sums in block order).
+    const size_t blocks = steps >= kLoudnessBlockSteps ? steps - kLoudnessBlockSteps + 1 : 0;
+    std::vector<double> block(blocks);
+    for(size_t b = 0; b < blocks; ++b){
+        double sum = 0.0;
+        for(size_t s = 0; s < kLoudnessBlockSteps; ++s) sum += power[b + s];
+        block[b] = sum / kLoudnessBlockSteps;
+    }
+
+    auto gatedMean = [&](double gate, double &mean){
+        double sum = 0.0;
+        size_t kept = 0;
+        for(double z : block){
+            if(z > gate){
+                sum += z;
+                ++kept;
+            }
+        }
+        mean = kept ? sum / kept : 0.0;
+        return kept > 0;
+    };
+
+    const double absolute = fromLufs(kLoudnessAbsoluteGateLufs);
+    double mean = 0.0;
+    if(!gatedMean(absolute, mean)){
+        return true;
+    }
+
+    //? the loudest block is over both gates, the second pass keeps at least one.
+    gatedMean(std::max(absolute, mean * std::pow(10.0, -kLoudnessRelativeGateLu / 10.0)), mean);
+    measurement.mIntegrated = toLufs(mean);
+
+    return true;
+}
@@ -1,32 +1,31 @@
 #include <iostream>
  
 #include "dsp/normalization.h"
+#include "dsp/kernels.h"
 #include "core/types.h"
 #include "core/error_handler.h"
 
-bool AJ::dsp::normalization::Normalization::gain(Float &buffer, AJ::error::IErrorHandler &handler){
+bool AJ::dsp::normalization::Normalization::gain(float *const *channels, size_t count,
+    AJ::error::IErrorHandler &handler){
     if(mParams->Gain() == 1.0f) return true;
-    
-#if defined(__AVX__)
-    if (__builtin_cpu_supports("avx")) {
-        return gainAVX(buffer, handler);
-    }
-#endif
 
-    return gainNaive(buffer, handler);
-}
+    const size_t frames = mParams->End() - mParams->Start() + 1;
+    const kernels::ScaleFn kernel = kernels::table().scale;
+    const float gain = mParams->Gain();
 
-bool AJ::dsp::normalization::Normalization::gainNaive(Float &buffer, AJ::error::IErrorHandler &handler){
-    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || 
-        mParams->Start() >= buffer.size() || mParams->End() >= buffer.size()){
-        const std::string message = "invalid indexes for gain effect.";
-        handler.onError(error::Error::InvalidEffectParameters, message);
-        return false;
+    if(!pThreadPool || frames * count <= kParallelChunkFrames){
+        for(size_t ch = 0; ch < count; ++ch){
+            kernel(channels[ch], frames, gain);
+        }
+        return true;
     }
 
-    for(sample_pos i = mParams->Start(); i <= mParams->End(); ++i){
-        buffer[i] *= mParams->Gain();
+    //* the channels one after the other, every one split across the pool.
+    for(size_t ch = 0; ch < count; ++ch){
+        pThreadPool->parallel_for(0, frames, kParallelChunkFrames, [&](size_t begin, size_t end){
+            kernel(channels[ch] + begin, end - begin, gain);
+        });
     }
 
     return true;
-}
\ No newline at end of file
+}
@@ -4,7 +4,8 @@
 #include <cmath>
 
 #include "dsp/normalization.h"
-#include "dsp/gain.h"
+#include "dsp/kernels.h"
+#include "dsp/dynamics/dynamics.h"
 #include "core/types.h"
 #include "core/error_handler.h"
 
@@ -20,10 +21,19 @@ std::shared_ptr<AJ::dsp::normalization::NormalizationParams> AJ::dsp::normalizat
         return nullptr;
     }
 
+    if(params.mSamplerate < kMinSamplerate || params.mSamplerate > kMaxSamplerate){
+        const std::string message = "invalid samplerate for normalization effect, it must be in ["
+            + std::to_string(kMinSamplerate) + ", " + std::to_string(kMaxSamplerate) + "].\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+
+        return nullptr;
+    }
+
+    normParams->mMode = params.mMode;
     normParams->setTarget(params.mTarget);
     normParams->setStart(params.mStart);
     normParams->setEnd(params.mEnd);
-    normParams->mMode = params.mMode;
+    normParams->mSamplerate = params.mSamplerate;
 
     return normParams;
 }
@@ -44,14 +54,108 @@ bool AJ::dsp::normalization::Normalization::setParams(std::shared_ptr<EffectPara
 
 bool AJ::dsp::normalization::Normalization::process(Float &buffer, 
     AJ::error::IErrorHandler &handler){
+    if(!checkRange(buffer, handler)) return false;
+
+    float *channel = buffer.data() + mParams->Start();
+
+    //* the loudness has its own analysis pass.
+    if(mParams->Mode() == NormalizationMode::LUFS)
+        return normalizationLUFS(&channel, 1, handler);
+
+    return normalize(&channel, 1, analyze(&channel, 1), handler);
+}
+
+bool AJ::dsp::normalization::Normalization::process(Float &buffer, const kernels::Levels &levels,
+    AJ::error::IErrorHandler &handler){
+    if(!checkRange(buffer, handler)) return false;
+
+    float *channel = buffer.data() + mParams->Start();
+    return normalize(&channel, 1, levels, handler);
+}
+
+bool AJ::dsp::normalization::Normalization::process(AudioBuffer &audio, size_t channels,
+    AJ::error::IErrorHandler &handler){
+    if(channels == 0 || channels > audio.size()){
+        const std::string message = "invalid channel count for normalization effect.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    float *pointers[kNumChannels];
+    for(size_t ch = 0; ch < channels; ++ch){
+        if(!checkRange(audio[ch], handler)) return false;
+        pointers[ch] = audio[ch].data() + mParams->Start();
+    }
+
+    if(mParams->Mode() == NormalizationMode::LUFS)
+        return normalizationLUFS(pointers, channels, handler);
+
+    //* one gain for all the channels, from the levels of all of them.
+    return normalize(pointers, channels, analyze(pointers, channels), handler);
+}
+
+bool AJ::dsp::normalization::Normalization::normalize(float *const *channels, size_t count,
+    const kernels::Levels &levels, AJ::error::IErrorHandler &handler){
+
     if(mParams->Mode() == NormalizationMode::Peak)
-        return normalizationPeak(buffer, handler);
+        return normalizationPeak(channels, count, levels, handler);
+
+    if(mParams->Mode() == NormalizationMode::LUFS)
+        return normalizationLUFS(channels, count, handler);
     
-    return normalizationRMS(buffer, handler);
+    return normalizationRMS(channels, count, levels, handler);
 }
 
-bool AJ::dsp::normalization::Normalization::normalizationPeak(Float &buffer, 
-    AJ::error::IErrorHandler &handler){
+bool AJ::dsp::normalization::Normalization::checkRange(const Float &buffer, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "normalization effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || 
+        mParams->Start() >= buffer.size() || mParams->End() >= buffer.size()){
+        const std::string message = "invalid indexes for normalization effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    return true;
+}
+
+AJ::dsp::kernels::Levels AJ::dsp::normalization::Normalization::analyze(const float *const *channels, size_t count){
+    const size_t frames = mParams->End() - mParams->Start() + 1;
+    const kernels::AnalyzeFn kernel = kernels::table().analyze;
+
+    if(!pThreadPool || frames * count <= kParallelChunkFrames){
+        kernels::Levels levels = kernel(channels[0], frames);
+        for(size_t ch = 1; ch < count; ++ch){
+            levels = kernels::combine(levels, kernel(channels[ch], frames));
+        }
+        return levels;
+    }
+
+    //* one partial result per chunk of every channel, combined in order (deterministic sum).
+    const size_t chunks = (frames + kParallelChunkFrames - 1) / kParallelChunkFrames;
+    std::vector<kernels::Levels> partial(chunks * count);
+
+    pThreadPool->parallel_for(0, chunks * count, 1, [&](size_t begin, size_t end){
+        for(size_t c = begin; c < end; ++c){
+            const size_t offset = (c % chunks) * kParallelChunkFrames;
+            partial[c] = kernel(channels[c / chunks] + offset, std::min(kParallelChunkFrames, frames - offset));
+        }
+    });
+
+    kernels::Levels levels = partial[0];
+    for(size_t c = 1; c < partial.size(); ++c){
+        levels = kernels::combine(levels, partial[c]);
+    }
+
+    return levels;
+}
+
+bool AJ::dsp::normalization::Normalization::normalizationPeak(float *const *channels, size_t count,
+    const kernels::Levels &levels, AJ::error::IErrorHandler &handler){
     /**
      * Peak normalization adjusts audio so that the loudest sample
      * reaches a user-defined target peak level.
@@ -70,92 +174,104 @@ bool AJ::dsp::normalization::Normalization::normalizationPeak(Float &buffer,
      * - If the target is lower than the current peak, the gain will be < 1.0,
      *   which reduces the volume instead of increasing it. This is perfectly
      *   valid and is used to attenuate audio.
+     * - Linked channels share the gain of the loudest one, the balance is kept.
      */
 
-
-    // find the max:
-    float max_sample = -1.0f;
-
-    for(size_t i = mParams->Start(); i <= mParams->End(); ++i)
-        max_sample = std::max(max_sample, std::abs(buffer[i]));
-
-    
     // calc gain:
-    float gain_factor = mParams->Target() / max_sample;
-    mParams->setGain(gain_factor);
+    mParams->setGain(mParams->Target() / kernels::peak(levels));
 
     // use special gain functionality that doesn't need clamping
-
-
-    return gain(buffer, handler);
+    return gain(channels, count, handler);
 }
 
-bool AJ::dsp::normalization::Normalization::normalizationRMS(Float &buffer,
-    AJ::error::IErrorHandler &handler){
+bool AJ::dsp::normalization::Normalization::normalizationRMS(float *const *channels, size_t count,
+    const kernels::Levels &levels, AJ::error::IErrorHandler &handler){
     /**
-     * RMS normalization process (current implementation):
+     * RMS normalization process:
      *
-     * 1. Compute the RMS (Root Mean Square) of all samples:
+     * 1. Compute the RMS (Root Mean Square) and the peak of all samples (of all the
+     *    linked channels) in one pass:
      *      sum_sq = sum(sample^2) for each sample
      *      mean_sq = sum_sq / num_samples
      *      RMS = sqrt(mean_sq)
-     *
-     * 2. Compute peak amplitude across the same range:
      *      max_sample = max(abs(sample))
      *
-     * 3. Calculate desired RMS gain:
-     *      gain_rms = target_linear / RMS
-     *
-     * 4. Calculate peak-safe gain (to prevent clipping):
-     *      gain_peak = target_linear / max_sample
-     *
-     * 5. Use the smaller of the two gains:
-     *      gain = min(gain_rms, gain_peak)
+     * 2. Calculate desired RMS gain:
+     *      gain = target_linear / RMS
      *
-     * 6. Apply the gain to all samples:
+     * 3. If the peak stays under the ceiling (kNormalizationCeilingDb) once scaled,
+     *    apply the gain to all samples (no clamping needed):
      *      sample *= gain
      *
-     * NOTE: This approach effectively performs RMS normalization
-     *       but clamps it using peak normalization to avoid clipping.
-     *
-     * TODO: Replace the simple gain clamp with a proper peak limiter
+     * 4. Otherwise scale and limit in one streaming pass: the lookahead limiter only
+     *    turns down the peaks over the ceiling, the rest of the range keeps the RMS gain.
      */
 
+    const size_t frames = mParams->End() - mParams->Start() + 1;
+    const double mean_sq = levels.sumSquares / (frames * count);
 
-    double sum_sq = 0.0f;
-    float max_sample = -1.0f;
-    for(size_t i = mParams->Start(); i <= mParams->End(); ++i){
-        sum_sq += std::pow(buffer[i], 2);
-        max_sample = std::max(max_sample, std::abs(buffer[i]));
+    float RMS = std::sqrt(mean_sq);
+
+    mParams->setGain(mParams->Target() / RMS);
+
+    const dynamics::Settings limiter = dynamics::Settings::limiter(mParams->Samplerate(), kNormalizationCeilingDb,
+        kNormalizationLookaheadMs, kNormalizationReleaseMs);
+
+    if(kernels::peak(levels) * mParams->Gain() <= limiter.mCeiling){
+        return gain(channels, count, handler);
     }
 
-    float mean_sq = sum_sq / (mParams->End() - mParams->Start() + 1);
+    dynamics::Processor processor(limiter, count);
+    processor.processAligned(channels, frames, mParams->Gain());
 
-    float RMS = std::sqrt(mean_sq);
+    return true;
+}
 
-    float gain = mParams->Target() / RMS;
+bool AJ::dsp::normalization::Normalization::normalizationLUFS(float *const *channels, size_t count,
+    AJ::error::IErrorHandler &handler){
+    /**
+     * Loudness normalization (ITU-R BS.1770 / EBU R128):
+     *
+     * 1. Integrated loudness L (LUFS) and true peak of the range, measured once per file
+     *    (see NormalizationParams::setLoudness()) or here, on the channels being normalized.
+     *
+     * 2. The gain moves L onto the target:
+     *      gain = 10^((target - L) / 20)
+     *
+     * 3. Like RMS: a plain gain pass when the gained true peak stays under the ceiling,
+     *    otherwise the lookahead limiter scales and holds the peaks in the same pass.
+     */
 
-    // peak limiting.
-    gain = std::min(gain, mParams->Target() / max_sample);
+    const size_t frames = mParams->End() - mParams->Start() + 1;
 
-    mParams->setGain(gain);
+    loudness::Measurement measured;
+    const loudness::Measurement *measurement = mParams->Loudness();
 
-    AJ::dsp::gain::Params params;
+    if(!measurement){
+        if(!loudness::measure(channels, count, frames, mParams->Samplerate(), measured, pThreadPool.get())){
+            const std::string message = "failed to allocate the loudness scratch buffers.\n";
+            handler.onError(error::Error::ResourceAllocationFailed, message);
+            return false;
+        }
+        measurement = &measured;
+    }
 
-    params.mStart = mParams->Start();
-    params.mEnd = mParams->End();
-    params.mGain = mParams->Gain();
+    //? silence (or less than one gating block) has no loudness to move.
+    if(!measurement->audible()){
+        return true;
+    }
 
-    // start applying gain
-    std::shared_ptr<AJ::dsp::gain::GainParams> gainParams = AJ::dsp::gain::GainParams::
-        create(params, handler);
-    
+    mParams->setGain(static_cast<float>(std::pow(10.0, (mParams->Target() - measurement->mIntegrated) / 20.0)));
 
-    AJ::dsp::gain::Gain Gain;
+    const dynamics::Settings limiter = dynamics::Settings::limiter(mParams->Samplerate(), kNormalizationCeilingDb,
+        kNormalizationLookaheadMs, kNormalizationReleaseMs);
 
-    if(!Gain.setParams(gainParams, handler)){
-        return false;
+    if(measurement->mTruePeak * mParams->Gain() <= limiter.mCeiling){
+        return gain(channels, count, handler);
     }
 
-    return Gain.process(buffer, handler);
-}
\ No newline at end of file
+    dynamics::Processor processor(limiter, count);
+    processor.processAligned(channels, frames, mParams->Gain());
+
+    return true;
+}
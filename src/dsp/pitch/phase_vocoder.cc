@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cmath>
+
+#include "dsp/pitch/phase_vocoder.h"
+#include "dsp/kernels.h"
+
+AJ::dsp::pitch::VocoderSetup::VocoderSetup(size_t frameSize, float ratio) :
+    mFrameSize(frameSize), mHop(frameSize / kPitchOversampling), mRatio(ratio) {
+
+    mHopPhase = static_cast<float>(2.0 * M_PI / kPitchOversampling);
+    mFFT = fft::plan(frameSize);
+
+    //? periodic Hann, overlapping Hann^2 frames sum to 3/8 * oversampling; the inverse FFT is N times too loud.
+    const double scale = 1.0 / (frameSize * 0.375 * kPitchOversampling);
+
+    mUnit.assign(mFFT->bins(), 1.0f);
+    mWindow.resize(frameSize);
+    mSynthesis.resize(frameSize);
+    for(size_t n = 0; n < frameSize; ++n){
+        const double w = 0.5 - 0.5 * std::cos(2.0 * M_PI * n / frameSize);
+        mWindow[n] = static_cast<float>(w);
+        mSynthesis[n] = static_cast<float>(w * scale);
+    }
+}
+
+AJ::dsp::pitch::PhaseVocoder::PhaseVocoder(std::shared_ptr<const VocoderSetup> setup) : pSetup(std::move(setup)) {
+    const size_t size = pSetup->mFrameSize;
+    const size_t bins = pSetup->mFFT->bins();
+
+    mInput.assign(size, 0.0f);
+    mOutput.assign(size, 0.0f);
+    mReady.assign(pSetup->mHop, 0.0f);
+    mLastPhase.assign(bins, 0.0f);
+    mSumPhase.assign(bins, 0.0f);
+    mTime.assign(size, 0.0f);
+    mRe.assign(bins, 0.0f);
+    mIm.assign(bins, 0.0f);
+    mMag.assign(bins, 0.0f);
+    mFreq.assign(bins, 0.0f);
+    mShiftFreq.assign(bins, 0.0f);
+    mPhasorRe.assign(bins, 0.0f);
+    mPhasorIm.assign(bins, 0.0f);
+    mShiftRe.assign(bins, 0.0f);
+    mShiftIm.assign(bins, 0.0f);
+    mPeaks.reserve(bins);
+
+    mFill = size - pSetup->mHop;
+}
+
+void AJ::dsp::pitch::PhaseVocoder::reset(){
+    std::fill(mInput.begin(), mInput.end(), 0.0f);
+    std::fill(mOutput.begin(), mOutput.end(), 0.0f);
+    std::fill(mReady.begin(), mReady.end(), 0.0f);
+    std::fill(mLastPhase.begin(), mLastPhase.end(), 0.0f);
+    std::fill(mSumPhase.begin(), mSumPhase.end(), 0.0f);
+
+    mFill = pSetup->mFrameSize - pSetup->mHop;
+}
+
+void AJ::dsp::pitch::PhaseVocoder::shift(){
+    const VocoderSetup &setup = *pSetup;
+    const kernels::KernelTable &kernels = kernels::table();
+    const size_t bins = setup.mFFT->bins();
+    const float ratio = setup.mRatio;
+
+    /*
+        ?every spectral peak p owns the bins up to halfway to its neighbours. The whole region moves
+        by round(p * ratio) - p bins, so the shape of its lobe is kept, and is rotated so that the
+        peak lands on the phase accumulated at its target bin (identity phase locking): moving
+        single bins to round(k * ratio) would break the phase relations inside a lobe.
+    */
+    mPeaks.clear();
+    const float floor = *std::max_element(mMag.begin(), mMag.end()) * kPitchPeakFloor;
+    for(size_t k = 1; k + 1 < bins; ++k){
+        if(mMag[k] > floor && mMag[k] > mMag[k - 1] && mMag[k] >= mMag[k + 1]){
+            mPeaks.push_back(k);
+        }
+    }
+
+    //* the phases accumulate at every target bin with the frequency of the bin landing there.
+    for(size_t j = 0; j < bins; ++j){
+        mShiftFreq[j] = static_cast<float>(j);
+    }
+
+    auto region = [&](size_t i, size_t &lo, size_t &hi){
+        lo = i == 0 ? 0 : (mPeaks[i - 1] + mPeaks[i] + 1) / 2;
+        hi = i + 1 == mPeaks.size() ? bins : (mPeaks[i] + mPeaks[i + 1] + 1) / 2;
+    };
+
+    for(size_t i = 0; i < mPeaks.size(); ++i){
+        const size_t peak = mPeaks[i];
+        size_t lo, hi;
+        region(i, lo, hi);
+        const long offset = std::lround(peak * ratio) - static_cast<long>(peak);
+
+        for(size_t k = lo; k < hi; ++k){
+            const long j = static_cast<long>(k) + offset;
+            if(j >= 0 && j < static_cast<long>(bins)){
+                mShiftFreq[j] = mFreq[k] * ratio;
+            }
+        }
+    }
+
+    kernels.phaseSynthesize(setup.mUnit.data(), mShiftFreq.data(), mSumPhase.data(), mPhasorRe.data(),
+        mPhasorIm.data(), bins, setup.mHopPhase);
+
+    std::fill(mShiftRe.begin(), mShiftRe.end(), 0.0f);
+    std::fill(mShiftIm.begin(), mShiftIm.end(), 0.0f);
+
+    for(size_t i = 0; i < mPeaks.size(); ++i){
+        const size_t peak = mPeaks[i];
+        size_t lo, hi;
+        region(i, lo, hi);
+        const long target = std::lround(peak * ratio);
+        if(target >= static_cast<long>(bins)){
+            break;
+        }
+
+        //* rotation = phasor of the target / phasor of the peak.
+        const float inv = 1.0f / mMag[peak];
+        const float pr = mRe[peak] * inv, pi = -mIm[peak] * inv;
+        const float rotRe = mPhasorRe[target] * pr - mPhasorIm[target] * pi;
+        const float rotIm = mPhasorRe[target] * pi + mPhasorIm[target] * pr;
+        const long offset = target - static_cast<long>(peak);
+
+        for(size_t k = lo; k < hi; ++k){
+            const long j = static_cast<long>(k) + offset;
+            if(j < 0 || j >= static_cast<long>(bins)){
+                continue;
+            }
+
+            mShiftRe[j] += mRe[k] * rotRe - mIm[k] * rotIm;
+            mShiftIm[j] += mRe[k] * rotIm + mIm[k] * rotRe;
+        }
+    }
+}
+
+void AJ::dsp::pitch::PhaseVocoder::frame(){
+    const VocoderSetup &setup = *pSetup;
+    const kernels::KernelTable &kernels = kernels::table();
+    const size_t size = setup.mFrameSize;
+    const size_t hop = setup.mHop;
+    const size_t bins = setup.mFFT->bins();
+
+    for(size_t n = 0; n < size; ++n){
+        mTime[n] = mInput[n] * setup.mWindow[n];
+    }
+
+    setup.mFFT->forward(mTime.data(), mRe.data(), mIm.data());
+    kernels.phaseAnalyze(mRe.data(), mIm.data(), mLastPhase.data(), mMag.data(), mFreq.data(), 0, bins, setup.mHopPhase);
+
+    if(setup.mRatio == 1.0f){
+        kernels.phaseSynthesize(mMag.data(), mFreq.data(), mSumPhase.data(), mRe.data(), mIm.data(), bins, setup.mHopPhase);
+        setup.mFFT->inverse(mRe.data(), mIm.data(), mTime.data());
+    } else {
+        shift();
+        setup.mFFT->inverse(mShiftRe.data(), mShiftIm.data(), mTime.data());
+    }
+
+    for(size_t n = 0; n < size; ++n){
+        mOutput[n] += mTime[n] * setup.mSynthesis[n];
+    }
+
+    //* the first hop is complete: hand it out, then slide both buffers by one hop.
+    std::copy(mOutput.begin(), mOutput.begin() + hop, mReady.begin());
+    std::copy(mOutput.begin() + hop, mOutput.end(), mOutput.begin());
+    std::fill(mOutput.end() - hop, mOutput.end(), 0.0f);
+    std::copy(mInput.begin() + hop, mInput.end(), mInput.begin());
+
+    mFill = size - hop;
+}
+
+void AJ::dsp::pitch::PhaseVocoder::process(const float *in, float *out, size_t frames, size_t stride){
+    /*
+        ?mInput[N - hop, N) refills one hop at a time, meanwhile the last finished hop (mReady,
+        the oldest hop of the previous frame) goes out: the output lags the input by N.
+    */
+    const size_t size = pSetup->mFrameSize;
+    const size_t refill = size - pSetup->mHop;
+
+    while(frames > 0){
+        const size_t n = std::min(frames, size - mFill);
+        const float *ready = mReady.data() + (mFill - refill);
+
+        for(size_t i = 0; i < n; ++i){
+            mInput[mFill + i] = in ? in[i * stride] : 0.0f;
+        }
+
+        for(size_t i = 0; i < n; ++i){
+            out[i * stride] = ready[i];
+        }
+
+        mFill += n;
+        frames -= n;
+        if(in) in += n * stride;
+        out += n * stride;
+
+        if(mFill == size){
+            frame();
+        }
+    }
+}
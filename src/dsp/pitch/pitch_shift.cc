@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <cmath>
+
+#include "dsp/pitch/pitch_shift.h"
+#include "core/errors.h"
+#include "core/scratch_arena.h"
+
+namespace {
+
+bool powerOfTwo(size_t value){
+    return value && (value & (value - 1)) == 0;
+}
+
+/**
+ * @brief Render the latency compensated output frames [begin, end) of a range into `out`.
+ *
+ * A fresh vocoder starts `warmup` frames before `begin` (silence before the range and
+ * after its end), the first `warmup + latency` output frames are dropped.
+ */
+void renderSegment(const std::shared_ptr<const AJ::dsp::pitch::VocoderSetup> &setup, const float *source,
+    size_t length, size_t begin, size_t end, size_t warmup, float *out){
+
+    AJ::dsp::pitch::PhaseVocoder vocoder(setup);
+
+    size_t position = begin - warmup;
+    auto feed = [&](float *dst, size_t frames){
+        const size_t available = position < length ? std::min(frames, length - position) : 0;
+
+        vocoder.process(source + position, dst, available, 1);
+        vocoder.process(nullptr, dst + available, frames - available, 1);
+        position += frames;
+    };
+
+    //? `out` doubles as the sink of the dropped frames, it's overwritten right after.
+    const size_t frames = end - begin;
+    for(size_t skip = warmup + setup->latency(); skip > 0;){
+        const size_t n = std::min(skip, frames);
+        feed(out, n);
+        skip -= n;
+    }
+
+    feed(out, frames);
+}
+
+}
+
+std::shared_ptr<AJ::dsp::pitch::PitchParams> AJ::dsp::pitch::PitchParams::create(Params &params,
+    AJ::error::IErrorHandler &handler){
+
+    if(params.mStart > params.mEnd || params.mStart < 0){
+        const std::string message = "invalid range indexes parameters for pitch shift effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(!(std::fabs(params.mSemitones) <= kPitchMaxSemitones)){
+        const std::string message = "invalid shift for pitch shift effect, it must be in [-"
+            + std::to_string(kPitchMaxSemitones) + ", " + std::to_string(kPitchMaxSemitones) + "] semitones.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(!powerOfTwo(params.mFrameSize) || params.mFrameSize < kPitchMinFrame || params.mFrameSize > kPitchMaxFrame){
+        const std::string message = "invalid frame size for pitch shift effect, it must be a power of two in ["
+            + std::to_string(kPitchMinFrame) + ", " + std::to_string(kPitchMaxFrame) + "].\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    std::shared_ptr<PitchParams> pitchParams = std::make_shared<PitchParams>(PrivateTag{});
+
+    const float ratio = static_cast<float>(std::exp2(params.mSemitones / 12.0));
+    pitchParams->mSetup = std::make_shared<const VocoderSetup>(params.mFrameSize, ratio);
+    pitchParams->mSemitones = params.mSemitones;
+    pitchParams->setStart(params.mStart);
+    pitchParams->setEnd(params.mEnd);
+
+    return pitchParams;
+}
+
+bool AJ::dsp::pitch::PitchShift::setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler){
+    std::shared_ptr<PitchParams> pitchParams = std::dynamic_pointer_cast<PitchParams>(params);
+    // if pitchParams is nullptr that means it's not a shared_ptr of PitchParams
+    if(!pitchParams){
+        const std::string message = "Effect parameters must be of type PitchParams for this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    mParams = pitchParams;
+    return true;
+}
+
+bool AJ::dsp::pitch::PitchShift::process(Float &buffer, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "pitch shift effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || mParams->End() >= buffer.size()){
+        const std::string message = "invalid indexes for pitch shift effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    /*
+        ?segment c owns [cK, (c+1)K) of the range (the last one the remainder too, so none is
+        shorter than K) and renders `fade` frames more on both sides. Around every boundary b the
+        tail of c - 1 and the head of c are crossfaded over [b - fade, b + fade).
+    */
+    const std::shared_ptr<const VocoderSetup> &setup = mParams->Setup();
+    const size_t length = mParams->End() - mParams->Start() + 1;
+    const size_t fade = setup->mFrameSize;
+    const size_t segments = std::max<size_t>(1, length / kPitchSegmentFrames);
+
+    //* the segments read their neighbours' input, so the range is read from a copy.
+    const Float source(buffer.begin() + mParams->Start(), buffer.begin() + mParams->End() + 1);
+    float *target = buffer.data() + mParams->Start();
+
+    std::vector<Float> heads(segments), tails(segments);
+    std::vector<char> rendered(segments, 0);
+
+    auto render = [&](size_t c){
+        const size_t core = c * kPitchSegmentFrames;
+        const size_t coreEnd = c + 1 == segments ? length : core + kPitchSegmentFrames;
+        const size_t begin = c == 0 ? 0 : core - fade;
+        const size_t end = c + 1 == segments ? length : coreEnd + fade;
+
+        utils::ScratchScope scope;
+        float *out = scope.arena().array<float>(end - begin);
+        if(!out){
+            return;
+        }
+
+        renderSegment(setup, source.data(), length, begin, end, std::min(begin, fade), out);
+
+        //* only this segment writes [own, ownEnd), the crossfade regions are stitched afterwards.
+        const size_t own = c == 0 ? 0 : core + fade;
+        const size_t ownEnd = c + 1 == segments ? length : coreEnd - fade;
+        std::copy(out + (own - begin), out + (ownEnd - begin), target + own);
+
+        if(c > 0){
+            heads[c].assign(out, out + 2 * fade);
+        }
+        if(c + 1 < segments){
+            tails[c].assign(out + (end - begin) - 2 * fade, out + (end - begin));
+        }
+
+        rendered[c] = 1;
+    };
+
+    if(pThreadPool && segments > 1){
+        pThreadPool->parallel_for(0, segments, 1, [&](size_t first, size_t last){
+            for(size_t c = first; c < last; ++c){
+                render(c);
+            }
+        });
+    } else {
+        for(size_t c = 0; c < segments; ++c){
+            render(c);
+        }
+    }
+
+    if(std::find(rendered.begin(), rendered.end(), 0) != rendered.end()){
+        const std::string message = "failed to allocate the pitch shift segment buffers.\n";
+        handler.onError(error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    for(size_t c = 1; c < segments; ++c){
+        float *region = target + c * kPitchSegmentFrames - fade;
+
+        for(size_t i = 0; i < 2 * fade; ++i){
+            const float w = (i + 0.5f) / (2 * fade);
+            region[i] = tails[c - 1][i] * (1.0f - w) + heads[c][i] * w;
+        }
+    }
+
+    return true;
+}
+
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::pitch::PitchShift::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "pitch shift effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return nullptr;
+    }
+
+    auto state = std::make_unique<PitchState>(channels);
+    for(uint8_t ch = 0; ch < channels; ++ch){
+        state->mVocoders.push_back(std::make_unique<PhaseVocoder>(mParams->Setup()));
+    }
+
+    return state;
+}
+
+bool AJ::dsp::pitch::PitchShift::processBlock(float *data, size_t frames, uint8_t channels,
+    EffectState &state, AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "pitch shift effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    PitchState *pitchState = dynamic_cast<PitchState*>(&state);
+
+    if(!pitchState || pitchState->mVocoders[0]->setup() != mParams->Setup()){
+        const std::string message = "effect state must be a PitchState created with the current parameters.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        for(uint8_t ch = 0; ch < channels; ++ch){
+            float *samples = data + first * channels + ch;
+            pitchState->mVocoders[ch]->process(samples, samples, last - first, channels);
+        }
+
+        //* the first frames out are the warm-up the buffer path drops: the range starts with silence.
+        const sample_pos warm = mParams->Start() + static_cast<sample_pos>(mParams->Latency());
+        const sample_pos position = state.position() + static_cast<sample_pos>(first);
+        if(position < warm){
+            const size_t mute = std::min(last - first, static_cast<size_t>(warm - position));
+            std::fill(data + first * channels, data + (first + mute) * channels, 0.0f);
+        }
+    }
+
+    state.advance(frames);
+    return true;
+}
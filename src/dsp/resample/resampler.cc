@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+
+#include "dsp/resample/resampler.h"
+#include "dsp/kernels.h"
+
+namespace {
+
+//* zeroth order modified Bessel function of the first kind (power series), for the Kaiser window.
+double besselI0(double x){
+    double sum = 1.0, term = 1.0;
+    const double quarter = x * x / 4.0;
+    for(int k = 1; k < 64 && term > sum * 1e-17; ++k){
+        term *= quarter / (static_cast<double>(k) * k);
+        sum += term;
+    }
+    return sum;
+}
+
+//* first output n with n·down / up >= position (time of output n = n·down / up input samples).
+uint64_t firstOutputAt(int64_t position, size_t up, size_t down){
+    if(position <= 0){
+        return 0;
+    }
+    return (static_cast<uint64_t>(position) * up + down - 1) / down;
+}
+
+}
+
+AJ::dsp::resample::Filter::Filter(PrivateTag, uint32_t inRate, uint32_t outRate, size_t up, size_t down) :
+    mInRate(inRate), mOutRate(outRate), mUp(up), mDown(down) {
+
+    //? the cutoff is relative to the input rate: downsampling lowers it to the output Nyquist, the sinc widens.
+    const double ratio = static_cast<double>(up) / down;
+    const double cutoff = 0.5 * kResampleRolloff * std::min(1.0, ratio);
+    const size_t half = static_cast<size_t>(std::ceil(kResampleZeroCrossings * std::max(1.0, 1.0 / ratio)));
+    const double norm = besselI0(kResampleKaiserBeta);
+
+    mTaps = 2 * half;
+    mBank.resize(mUp * mTaps);
+
+    for(size_t p = 0; p < mUp; ++p){
+        float *row = &mBank[p * mTaps];
+        double sum = 0.0;
+
+        //* tap t multiplies input i - (half - 1) + t of an output at time i + p / up.
+        for(size_t t = 0; t < mTaps; ++t){
+            const double x = static_cast<double>(half) - 1.0 - t + static_cast<double>(p) / mUp;
+            const double r = x / half;
+            const double window = std::abs(r) < 1.0 ? besselI0(kResampleKaiserBeta * std::sqrt(1.0 - r * r)) / norm : 0.0;
+            const double arg = 2.0 * cutoff * x;
+            const double sinc = arg == 0.0 ? 1.0 : std::sin(M_PI * arg) / (M_PI * arg);
+
+            const double h = 2.0 * cutoff * sinc * window;
+            row[t] = static_cast<float>(h);
+            sum += h;
+        }
+
+        for(size_t t = 0; t < mTaps; ++t){
+            row[t] = static_cast<float>(row[t] / sum);
+        }
+    }
+}
+
+size_t AJ::dsp::resample::Filter::OutputLength(size_t frames) const noexcept {
+    return static_cast<size_t>((static_cast<uint64_t>(frames) * mUp + mDown - 1) / mDown);
+}
+
+std::shared_ptr<const AJ::dsp::resample::Filter> AJ::dsp::resample::filter(uint32_t inRate, uint32_t outRate,
+    AJ::error::IErrorHandler &handler){
+
+    if(inRate < kMinSamplerate || inRate > kMaxSamplerate || outRate < kMinSamplerate || outRate > kMaxSamplerate){
+        const std::string message = "Error: samplerates must be in [" + std::to_string(kMinSamplerate) + ", "
+            + std::to_string(kMaxSamplerate) + "] to be converted.\n";
+        handler.onError(error::Error::InvalidSampleRate, message);
+        return nullptr;
+    }
+
+    const uint32_t gcd = std::gcd(inRate, outRate);
+    const size_t up = outRate / gcd, down = inRate / gcd;
+
+    if(up > kResampleMaxPhases){
+        const std::string message = "Error: converting " + std::to_string(inRate) + " Hz to " + std::to_string(outRate)
+            + " Hz needs " + std::to_string(up) + " filter phases, at most " + std::to_string(kResampleMaxPhases)
+            + " are supported.\n";
+        handler.onError(error::Error::InvalidSampleRate, message);
+        return nullptr;
+    }
+
+    static std::mutex mux;
+    static std::map<uint64_t, std::shared_ptr<const Filter>> filters;
+
+    const uint64_t key = (static_cast<uint64_t>(inRate) << 32) | outRate;
+
+    std::lock_guard<std::mutex> lock(mux);
+    auto &entry = filters[key];
+    if(!entry){
+        entry = std::make_shared<const Filter>(Filter::PrivateTag{}, inRate, outRate, up, down);
+    }
+
+    return entry;
+}
+
+AJ::dsp::resample::Resampler::Resampler(std::shared_ptr<const Filter> filter, uint8_t channels) :
+    pFilter(std::move(filter)), mChannels(channels) {
+
+    const Filter &f = *pFilter;
+
+    mHistory.resize(mChannels);
+    for(Float &history : mHistory){
+        history.assign(f.Taps() + kResampleChunkFrames, 0.0f);
+    }
+
+    //* outputs of one chunk, per channel (the kernel writes mono output in place).
+    mOutput.assign(kNumChannels * maxOutput(kResampleChunkFrames), 0.0f);
+
+    reset();
+}
+
+std::unique_ptr<AJ::dsp::resample::Resampler> AJ::dsp::resample::Resampler::create(uint32_t inRate, uint32_t outRate,
+    uint8_t channels, AJ::error::IErrorHandler &handler){
+
+    if(channels < 1 || channels > kNumChannels){
+        const std::string message = "Error: the resampler supports mono and stereo streams.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return nullptr;
+    }
+
+    std::shared_ptr<const Filter> shared = resample::filter(inRate, outRate, handler);
+    if(!shared){
+        return nullptr;
+    }
+
+    return std::make_unique<Resampler>(std::move(shared), channels);
+}
+
+size_t AJ::dsp::resample::Resampler::maxOutput(size_t frames) const noexcept {
+    //* the history holds less than Taps() unconverted frames on top of the new ones.
+    return pFilter->OutputLength(frames + pFilter->Taps()) + 1;
+}
+
+void AJ::dsp::resample::Resampler::reset(){
+    const size_t reach = pFilter->Reach();
+
+    //? Reach() - 1 zeros: the first output sits on the first input frame.
+    for(Float &history : mHistory){
+        std::fill(history.begin(), history.begin() + reach - 1, 0.0f);
+    }
+
+    mFill = reach - 1;
+    mNext = 0;
+    mPhase = 0;
+    mConsumed = 0;
+    mProduced = 0;
+}
+
+size_t AJ::dsp::resample::Resampler::generate(float *out, size_t limit){
+    const Filter &f = *pFilter;
+    const size_t taps = f.Taps(), up = f.Up(), down = f.Down();
+
+    if(mFill < mNext + taps){
+        return 0;
+    }
+
+    //* outputs whose taps are all in the history: first tap of output k = mNext + (mPhase + k·down) / up.
+    const uint64_t spare = mFill - taps - mNext;
+    const size_t count = static_cast<size_t>(std::min<uint64_t>(limit,
+        ((spare + 1) * up - mPhase + down - 1) / down));
+
+    if(count == 0){
+        return 0;
+    }
+
+    const kernels::KernelTable &kernels = kernels::table();
+
+    if(mChannels == 1){
+        kernels.polyphase(mHistory[0].data() + mNext, f.Bank(), taps, up, down, mPhase, out, count);
+    } else {
+        float *left = mOutput.data();
+        float *right = mOutput.data() + mOutput.size() / 2;
+        kernels.polyphase(mHistory[0].data() + mNext, f.Bank(), taps, up, down, mPhase, left, count);
+        kernels.polyphase(mHistory[1].data() + mNext, f.Bank(), taps, up, down, mPhase, right, count);
+        kernels.interleave(left, right, out, count);
+    }
+
+    const uint64_t advance = mPhase + static_cast<uint64_t>(count) * down;
+    mNext += static_cast<size_t>(advance / up);
+    mPhase = static_cast<size_t>(advance % up);
+    mProduced += count;
+
+    //* keep the frames the next outputs still need at the front.
+    for(Float &history : mHistory){
+        std::copy(history.begin() + mNext, history.begin() + mFill, history.begin());
+    }
+    mFill -= mNext;
+    mNext = 0;
+
+    return count;
+}
+
+size_t AJ::dsp::resample::Resampler::process(const float *in, size_t frames, float *out){
+    size_t written = 0;
+
+    while(frames > 0){
+        const size_t n = std::min(frames, kResampleChunkFrames);
+
+        if(mChannels == 1){
+            std::copy(in, in + n, mHistory[0].data() + mFill);
+        } else {
+            kernels::table().deinterleave(in, mHistory[0].data() + mFill, mHistory[1].data() + mFill, n);
+        }
+
+        mFill += n;
+        mConsumed += n;
+        in += n * mChannels;
+        frames -= n;
+
+        written += generate(out + written * mChannels, SIZE_MAX);
+    }
+
+    return written;
+}
+
+size_t AJ::dsp::resample::Resampler::flush(float *out){
+    //* Reach() frames of silence complete every output before the end of the input.
+    const size_t limit = pFilter->OutputLength(mConsumed) - mProduced;
+    size_t pending = pFilter->Reach();
+    size_t written = 0;
+
+    while(pending > 0 && written < limit){
+        const size_t n = std::min(pending, kResampleChunkFrames);
+
+        for(Float &history : mHistory){
+            std::fill(history.begin() + mFill, history.begin() + mFill + n, 0.0f);
+        }
+
+        mFill += n;
+        pending -= n;
+
+        written += generate(out + written * mChannels, limit - written);
+    }
+
+    reset();
+    return written;
+}
+
+void AJ::dsp::resample::resample(const float *input, size_t frames, Float &output, const Filter &filter,
+    utils::ThreadPool *pool){
+
+    const size_t total = filter.OutputLength(frames);
+    const size_t taps = filter.Taps(), up = filter.Up(), down = filter.Down();
+    const int64_t lead = static_cast<int64_t>(filter.Reach()) - 1;
+    const float *bank = filter.Bank();
+
+    output.resize(total);
+    if(total == 0){
+        return;
+    }
+
+    //* outputs [interiorBegin, interiorEnd) have all their taps inside the input, the others read zeros past its edges.
+    const uint64_t interiorBegin = std::min<uint64_t>(total, firstOutputAt(lead, up, down));
+    const uint64_t interiorEnd = frames < taps ? interiorBegin
+        : std::max(interiorBegin, std::min<uint64_t>(total, firstOutputAt(static_cast<int64_t>(frames - taps) + lead + 1, up, down)));
+
+    const kernels::KernelTable &kernels = kernels::table();
+    const size_t segments = std::max<size_t>(1, total / kResampleSegmentFrames);
+
+    auto edge = [&](uint64_t n){
+        const uint64_t position = n * down;
+        const int64_t start = static_cast<int64_t>(position / up) - lead;
+        const float *h = bank + (position % up) * taps;
+
+        float sum = 0.0f;
+        for(size_t t = 0; t < taps; ++t){
+            const int64_t i = start + static_cast<int64_t>(t);
+            if(i >= 0 && i < static_cast<int64_t>(frames)){
+                sum += input[i] * h[t];
+            }
+        }
+        output[n] = sum;
+    };
+
+    auto render = [&](size_t c){
+        const uint64_t first = static_cast<uint64_t>(c) * kResampleSegmentFrames;
+        const uint64_t last = c + 1 == segments ? total : first + kResampleSegmentFrames;
+
+        const uint64_t from = std::clamp(interiorBegin, first, last);
+        const uint64_t to = std::clamp(interiorEnd, from, last);
+
+        for(uint64_t n = first; n < from; ++n){
+            edge(n);
+        }
+
+        if(from < to){
+            const uint64_t position = from * down;
+            kernels.polyphase(input + (position / up - lead), bank, taps, up, down, position % up,
+                output.data() + from, static_cast<size_t>(to - from));
+        }
+
+        for(uint64_t n = to; n < last; ++n){
+            edge(n);
+        }
+    };
+
+    if(pool && segments > 1){
+        pool->parallel_for(0, segments, 1, [&](size_t begin, size_t end){
+            for(size_t c = begin; c < end; ++c) render(c);
+        });
+    } else {
+        for(size_t c = 0; c < segments; ++c) render(c);
+    }
+}
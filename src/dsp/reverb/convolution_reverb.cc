@@ -0,0 +1,150 @@
+#include "dsp/reverb/convolution_reverb.h"
+#include "core/errors.h"
+
+namespace {
+
+bool powerOfTwo(size_t value){
+    return value && (value & (value - 1)) == 0;
+}
+
+}
+
+std::shared_ptr<AJ::dsp::reverb::convolution::ConvolutionParams> AJ::dsp::reverb::convolution::ConvolutionParams::
+    create(Params &params, AJ::error::IErrorHandler &handler){
+
+    if(params.mStart > params.mEnd || params.mStart < 0){
+        const std::string message = "invalid range indexes parameters for convolution reverb effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(!params.mImpulse){
+        const std::string message = "convolution reverb needs an impulse response.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    const bool head = powerOfTwo(params.mPartition) && params.mPartition >= kConvolutionMinPartition
+        && params.mPartition <= kConvolutionMaxPartition;
+    const bool tail = params.mTailPartition == 0 || (powerOfTwo(params.mTailPartition)
+        && params.mTailPartition > params.mPartition && params.mTailPartition <= kConvolutionMaxPartition);
+
+    if(!head || !tail){
+        const std::string message = "invalid partitions for convolution reverb effect, they must be powers of two in ["
+            + std::to_string(kConvolutionMinPartition) + ", " + std::to_string(kConvolutionMaxPartition)
+            + "] with the tail partition larger than the head one.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(params.mWetMix < REVERB_MIX_MIN || params.mWetMix > REVERB_MIX_MAX ||
+        params.mDryMix < REVERB_MIX_MIN || params.mDryMix > REVERB_MIX_MAX){
+        const std::string message = "invalid mix for convolution reverb effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    std::shared_ptr<ConvolutionParams> convolutionParams = std::make_shared<ConvolutionParams>(PrivateTag{});
+
+    convolutionParams->mImpulse = params.mImpulse;
+    convolutionParams->mPartitions = params.mImpulse->partitions(params.mPartition, params.mTailPartition);
+    convolutionParams->mWetMix = params.mWetMix;
+    convolutionParams->mDryMix = params.mDryMix;
+    convolutionParams->setStart(params.mStart);
+    convolutionParams->setEnd(params.mEnd);
+
+    return convolutionParams;
+}
+
+bool AJ::dsp::reverb::convolution::ConvolutionReverb::setParams(std::shared_ptr<EffectParams> params,
+    AJ::error::IErrorHandler &handler){
+    std::shared_ptr<ConvolutionParams> convolutionParams = std::dynamic_pointer_cast<ConvolutionParams>(params);
+    // if convolutionParams is nullptr that means it's not a shared_ptr of ConvolutionParams
+    if(!convolutionParams){
+        const std::string message = "Effect parameters must be of type ConvolutionParams for this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    mParams = convolutionParams;
+    return true;
+}
+
+bool AJ::dsp::reverb::convolution::ConvolutionReverb::process(Float &buffer, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "convolution reverb effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || mParams->End() >= buffer.size()){
+        const std::string message = "invalid indexes for convolution reverb effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    Convolver convolver(mParams->Partitions(), 0, mQuality == RenderQuality::Full);
+    convolver.process(buffer.data() + mParams->Start(), mParams->End() - mParams->Start() + 1, 1,
+        mParams->WetMix(), mParams->DryMix(), pThreadPool.get());
+
+    return true;
+}
+
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::reverb::convolution::ConvolutionReverb::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "convolution reverb effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return nullptr;
+    }
+
+    const uint8_t irChannels = mParams->Impulse()->channels();
+
+    if(irChannels != 1 && irChannels != channels){
+        const std::string message = "the impulse response must have 1 channel or as many channels as the stream.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return nullptr;
+    }
+
+    auto state = std::make_unique<ConvolutionState>(channels);
+    for(uint8_t ch = 0; ch < channels; ++ch){
+        state->mConvolvers.push_back(std::make_unique<Convolver>(mParams->Partitions(), irChannels == 1 ? 0 : ch,
+            mQuality == RenderQuality::Full));
+    }
+
+    return state;
+}
+
+bool AJ::dsp::reverb::convolution::ConvolutionReverb::processBlock(float *data, size_t frames, uint8_t channels,
+    EffectState &state, AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "convolution reverb effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
+
+    ConvolutionState *convolutionState = dynamic_cast<ConvolutionState*>(&state);
+
+    if(!convolutionState || convolutionState->mConvolvers[0]->impulse() != mParams->Partitions()){
+        const std::string message = "effect state must be a ConvolutionState created with the current parameters.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        for(uint8_t ch = 0; ch < channels; ++ch){
+            convolutionState->mConvolvers[ch]->process(data + first * channels + ch, last - first, channels,
+                mParams->WetMix(), mParams->DryMix(), pThreadPool.get());
+        }
+    }
+
+    state.advance(frames);
+    return true;
+}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <thread>
+
+#include "dsp/reverb/convolver.h"
+#include "dsp/kernels.h"
+
+namespace {
+
+/// @brief Floats of one spectrum: `bins` real parts then `bins` imaginary parts, each half aligned.
+size_t spectrumStride(size_t bins){
+    const size_t lane = AJ::kBufferAlignment / sizeof(float);
+    return 2 * ((bins + lane - 1) / lane * lane);
+}
+
+/**
+ * @brief Write the spectrum of `input` into `slot` of the delay line `line`, then
+ * `acc = sum_k line[slot - k] * partitions[k]` and `out` = its inverse FFT.
+ */
+void convolveBlock(const AJ::dsp::fft::Plan &fft, const AJ::dsp::reverb::convolution::PartitionSpectra &partitions,
+    const float *input, float *line, size_t slot, float *acc, float *out){
+
+    const AJ::dsp::kernels::ComplexMulAddFn cmac = AJ::dsp::kernels::table().complexMulAdd;
+    const size_t stride = partitions.mStride;
+    const size_t half = stride / 2;
+    const size_t bins = fft.bins();
+
+    fft.forward(input, line + slot * stride, line + slot * stride + half);
+    std::fill(acc, acc + stride, 0.0f);
+
+    for(size_t k = 0; k < partitions.mCount; ++k){
+        const float *x = line + ((slot + partitions.mCount - k) % partitions.mCount) * stride;
+        cmac(x, x + half, partitions.re(k), partitions.im(k), acc, acc + half, bins);
+    }
+
+    fft.inverse(acc, acc + half, out);
+}
+
+}
+
+AJ::dsp::reverb::convolution::Convolver::Convolver(std::shared_ptr<const PartitionedImpulse> impulse,
+    uint8_t channel, bool tail) : pImpulse(std::move(impulse)) {
+
+    pChannel = &pImpulse->mChannels[channel];
+    mUseTail = tail && pChannel->mTail.mCount > 0;
+
+    const size_t partition = pImpulse->mPartition;
+    mTaps = std::min(partition, pImpulse->mFrames);
+
+    mInput.assign(2 * partition, 0.0f);
+    mHeadOut.assign(partition, 0.0f);
+    mHeadLine.assign(pChannel->mHead.mCount * pChannel->mHead.mStride, 0.0f);
+    mSpectrum.assign(spectrumStride(pImpulse->mHeadFFT->bins()), 0.0f);
+    mTime.assign(2 * partition, 0.0f);
+    mWet.assign(partition, 0.0f);
+
+    if(mUseTail){
+        const size_t tail = pImpulse->mTailPartition;
+
+        mTailInput.assign(2 * tail, 0.0f);
+        mTailJobInput.assign(2 * tail, 0.0f);
+        mTailLine.assign(pChannel->mTail.mCount * pChannel->mTail.mStride, 0.0f);
+        mTailSpectrum.assign(spectrumStride(pImpulse->mTailFFT->bins()), 0.0f);
+        mTailTime.assign(2 * tail, 0.0f);
+        mTailOut[0].assign(tail, 0.0f);
+        mTailOut[1].assign(tail, 0.0f);
+    }
+}
+
+void AJ::dsp::reverb::convolution::Convolver::process(float *data, size_t frames, uint8_t stride,
+    float wet, float dry, utils::ThreadPool *pool){
+
+    const kernels::MulAddFn mulAdd = kernels::table().mulAdd;
+    const size_t partition = pImpulse->mPartition;
+    const bool tail = mUseTail;
+
+    for(size_t done = 0; done < frames; ){
+        const size_t n = std::min(partition - mBlockPos, frames - done);
+        float *samples = data + done * stride;
+        float *in = mInput.data() + partition + mBlockPos;
+
+        for(size_t i = 0; i < n; ++i){
+            in[i] = samples[i * stride];
+        }
+
+        //* head and tail outputs of this block, then the direct taps: y += h[t] * x[n - t].
+        std::copy(mHeadOut.begin() + mBlockPos, mHeadOut.begin() + mBlockPos + n, mWet.begin());
+        if(tail){
+            mulAdd(mWet.data(), mTailOut[mTailActive].data() + mTailPos, mWet.data(), n, 1.0f);
+        }
+
+        for(size_t t = 0; t < mTaps; ++t){
+            mulAdd(mWet.data(), in - t, mWet.data(), n, pChannel->mDirect[t]);
+        }
+
+        for(size_t i = 0; i < n; ++i){
+            samples[i * stride] = std::clamp(dry * in[i] + wet * mWet[i], -1.0f, 1.0f);
+        }
+
+        if(tail){
+            std::copy(in, in + n, mTailInput.begin() + pImpulse->mTailPartition + mTailPos);
+            mTailPos += n;
+        }
+
+        mBlockPos += n;
+        done += n;
+
+        if(mBlockPos == partition){
+            headBlock();
+        }
+
+        if(tail && mTailPos == pImpulse->mTailPartition){
+            tailBlock(pool);
+        }
+    }
+}
+
+void AJ::dsp::reverb::convolution::Convolver::headBlock(){
+    const size_t partition = pImpulse->mPartition;
+
+    if(pChannel->mHead.mCount > 0){
+        convolveBlock(*pImpulse->mHeadFFT, pChannel->mHead, mInput.data(), mHeadLine.data(), mHeadSlot,
+            mSpectrum.data(), mTime.data());
+
+        //? overlap-save: the first half is wrapped around, the second half is the block output.
+        std::copy(mTime.begin() + partition, mTime.end(), mHeadOut.begin());
+        mHeadSlot = (mHeadSlot + 1) % pChannel->mHead.mCount;
+    }
+
+    std::copy(mInput.begin() + partition, mInput.end(), mInput.begin());
+    mBlockPos = 0;
+}
+
+void AJ::dsp::reverb::convolution::Convolver::tailBlock(utils::ThreadPool *pool){
+    const size_t tail = pImpulse->mTailPartition;
+
+    //* the previous job's output is due now, and the job inputs are reused below.
+    waitTail();
+
+    std::copy(mTailInput.begin(), mTailInput.end(), mTailJobInput.begin());
+    std::copy(mTailInput.begin() + tail, mTailInput.end(), mTailInput.begin());
+    mTailPos = 0;
+
+    float *out = mTailOut[1 - mTailActive].data();
+    mTailPending = true;
+
+    if(!pool){
+        pTailPool = nullptr;
+        runTail(out);
+        return;
+    }
+
+    pTailPool = pool;
+    mTailDone.store(false, std::memory_order_relaxed);
+
+    pool->post([this, out]{
+        runTail(out);
+        mTailDone.store(true, std::memory_order_release);
+    });
+}
+
+void AJ::dsp::reverb::convolution::Convolver::runTail(float *out){
+    const size_t tail = pImpulse->mTailPartition;
+
+    convolveBlock(*pImpulse->mTailFFT, pChannel->mTail, mTailJobInput.data(), mTailLine.data(), mTailSlot,
+        mTailSpectrum.data(), mTailTime.data());
+
+    std::copy(mTailTime.begin() + tail, mTailTime.end(), out);
+    mTailSlot = (mTailSlot + 1) % pChannel->mTail.mCount;
+}
+
+void AJ::dsp::reverb::convolution::Convolver::waitTail(){
+    if(!mTailPending) return;
+
+    //* help the pool instead of sleeping, the job may be queued behind the caller's own task.
+    while(!mTailDone.load(std::memory_order_acquire)){
+        if(!pTailPool->tryRunPendingTask()){
+            std::this_thread::yield();
+        }
+    }
+
+    mTailPending = false;
+    mTailActive = 1 - mTailActive;
+}
+
+void AJ::dsp::reverb::convolution::Convolver::reset(){
+    waitTail();
+
+    mBlockPos = 0;
+    mHeadSlot = 0;
+    std::fill(mInput.begin(), mInput.end(), 0.0f);
+    std::fill(mHeadOut.begin(), mHeadOut.end(), 0.0f);
+    std::fill(mHeadLine.begin(), mHeadLine.end(), 0.0f);
+
+    mTailPos = 0;
+    mTailSlot = 0;
+    mTailActive = 0;
+    std::fill(mTailInput.begin(), mTailInput.end(), 0.0f);
+    std::fill(mTailLine.begin(), mTailLine.end(), 0.0f);
+    for(auto &out : mTailOut){
+        std::fill(out.begin(), out.end(), 0.0f);
+    }
+}
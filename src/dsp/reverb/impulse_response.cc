@@ -0,0 +1,120 @@
+#include <algorithm>
+
+#include "dsp/reverb/impulse_response.h"
+#include "core/errors.h"
+#include "core/scratch_arena.h"
+
+namespace {
+
+/// @brief Spectra of taps [begin, end) in partitions of `partition` frames, scaled for the unscaled inverse.
+AJ::dsp::reverb::convolution::PartitionSpectra partitionSpectra(const AJ::Float &taps, size_t begin, size_t end,
+    size_t partition, const AJ::dsp::fft::Plan &fft){
+
+    AJ::dsp::reverb::convolution::PartitionSpectra spectra;
+    if(end <= begin) return spectra;
+
+    const size_t lane = AJ::kBufferAlignment / sizeof(float);
+    const size_t half = (fft.bins() + lane - 1) / lane * lane;
+    const float scale = 1.0f / fft.size();
+
+    spectra.mCount = (end - begin + partition - 1) / partition;
+    spectra.mStride = 2 * half;
+    spectra.mData.assign(spectra.mCount * spectra.mStride, 0.0f);
+
+    //* the arena of this thread, the allocation falls back to the heap only if it fails.
+    AJ::utils::ScratchScope scope;
+    float *time = scope.arena().array<float>(fft.size());
+    AJ::Float fallback;
+    if(!time){
+        fallback.resize(fft.size());
+        time = fallback.data();
+    }
+
+    for(size_t p = 0; p < spectra.mCount; ++p){
+        const size_t first = begin + p * partition;
+        const size_t last = std::min(first + partition, end);
+
+        //* [partition taps | zeros], the overlap-save output is then the second half.
+        std::fill(time, time + fft.size(), 0.0f);
+        std::copy(taps.begin() + first, taps.begin() + last, time);
+
+        float *re = spectra.mData.data() + p * spectra.mStride;
+        float *im = re + half;
+        fft.forward(time, re, im);
+
+        for(size_t k = 0; k < fft.bins(); ++k){
+            re[k] *= scale;
+            im[k] *= scale;
+        }
+    }
+
+    return spectra;
+}
+
+}
+
+AJ::dsp::reverb::convolution::PartitionedImpulse::PartitionedImpulse(const std::vector<Float> &impulse,
+    size_t partition, size_t tailPartition)
+    : mPartition(partition), mFrames(impulse[0].size()), mHeadFFT(fft::plan(2 * partition)) {
+
+    const bool tail = tailPartition && mFrames > 2 * tailPartition;
+    mTailPartition = tail ? tailPartition : 0;
+    mHeadEnd = tail ? 2 * tailPartition : mFrames;
+    mTailFFT = tail ? fft::plan(2 * tailPartition) : nullptr;
+
+    for(const Float &taps : impulse){
+        PartitionedChannel channel;
+
+        channel.mDirect.assign(partition, 0.0f);
+        std::copy(taps.begin(), taps.begin() + std::min(partition, mFrames), channel.mDirect.begin());
+
+        channel.mHead = partitionSpectra(taps, partition, mHeadEnd, partition, *mHeadFFT);
+        if(tail){
+            channel.mTail = partitionSpectra(taps, mHeadEnd, mFrames, tailPartition, *mTailFFT);
+        }
+
+        mChannels.push_back(std::move(channel));
+    }
+}
+
+std::shared_ptr<AJ::dsp::reverb::convolution::ImpulseResponse> AJ::dsp::reverb::convolution::ImpulseResponse::
+    create(std::vector<Float> channels, AJ::error::IErrorHandler &handler){
+
+    if(channels.empty() || channels.size() > kNumChannels){
+        const std::string message = "impulse response needs 1 to " + std::to_string(kNumChannels) + " channels.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    const size_t frames = channels[0].size();
+
+    for(const Float &channel : channels){
+        if(channel.size() != frames || frames == 0 || frames > kConvolutionMaxImpulseFrames){
+            const std::string message = "invalid impulse response, the channels must have the same length, 1 to "
+                + std::to_string(kConvolutionMaxImpulseFrames) + " frames.\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return nullptr;
+        }
+    }
+
+    return std::make_shared<ImpulseResponse>(PrivateTag{}, std::move(channels));
+}
+
+std::shared_ptr<const AJ::dsp::reverb::convolution::PartitionedImpulse> AJ::dsp::reverb::convolution::
+    ImpulseResponse::partitions(size_t partition, size_t tailPartition) const {
+    std::lock_guard<std::mutex> lock(mMux);
+
+    //* a tail partition that leaves no tail is the uniform partitioning.
+    if(frames() <= 2 * tailPartition) tailPartition = 0;
+
+    for(const auto &cached : mCache){
+        if(cached->mPartition == partition && cached->mTailPartition == tailPartition){
+            return cached;
+        }
+    }
+
+    auto partitioned = std::make_shared<const PartitionedImpulse>(mChannels, partition, tailPartition);
+    mCache.push_back(partitioned);
+
+    return partitioned;
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <limits>
 #include "core/types.h"
 
 #include "dsp/reverb/reverb.h"
@@ -37,7 +38,7 @@ bool AJ::dsp::reverb::Reverb::setParams(std::shared_ptr<EffectParams> params, AJ
     }
 
     for (auto &all_pass : mAllPassFilters) {
-        all_pass = std::make_unique<AllPassFilter>(reverbParams->Samplerate());
+        all_pass = AllPassFilter(reverbParams->Samplerate());
     }
 
     mParams = reverbParams; 
@@ -94,52 +95,172 @@ bool AJ::dsp::reverb::Reverb::checkValidIndxes(Float &buffer, AJ::error::IErrorH
     return true;
 }
 
+namespace {
+
+/**
+ * @brief Apply the reverb network to `count` samples spaced by `stride`, in place.
+ *
+ * The four parallel comb filters run as a bank over the whole chunk (vectorized kernel),
+ * their average goes through the all-pass filters in series and is mixed with the dry input.
+ * `wetRamp` / `dryRamp` hold one mix per sample when automated, nullptr otherwise.
+ */
+void renderChunk(float *data, size_t count, size_t stride, AJ::dsp::reverb::CombFilters &combs,
+    AJ::dsp::reverb::AllPassFilters &allPass, float wet, float dry, const float *wetRamp, const float *dryRamp,
+    AJ::dsp::kernels::CombFn kernel){
+
+    alignas(AJ::kBufferAlignment) AJ::sample_t input[AJ::kReverbChunkFrames];
+    alignas(AJ::kBufferAlignment) AJ::sample_t comb[AJ::kReverbChunkFrames];
+
+    for(size_t i = 0; i < count; ++i){
+        input[i] = data[i * stride];
+        comb[i] = 0.0f;
+    }
+
+    for(auto &filter : combs){
+        filter.processAccumulate(input, comb, count, kernel);
+    }
+
+    for(size_t i = 0; i < count; ++i){
+        AJ::sample_t sample = comb[i] * 0.25f; // normalization.
+
+        for(auto &filter : allPass){
+            sample = filter.process(sample);
+        }
+
+        //? the automated mixes, if any, replace the constant ones.
+        const float wetMix = wetRamp ? wetRamp[i] : wet;
+        const float dryMix = dryRamp ? dryRamp[i] : dry;
+
+        data[i * stride] = std::clamp(wetMix * sample + dryMix * input[i], -1.0f, 1.0f);
+    }
+}
+
+}
+
+std::pair<const float*, const float*> AJ::dsp::reverb::Reverb::renderMix(sample_pos frame, size_t count,
+    float *wet, float *dry) const {
+    const float *wetRamp = nullptr;
+    const float *dryRamp = nullptr;
+
+    if(mWetAutomation && !mWetAutomation->empty()){
+        mWetAutomation->render(frame, count, wet);
+        wetRamp = wet;
+    }
+
+    if(mDryAutomation && !mDryAutomation->empty()){
+        mDryAutomation->render(frame, count, dry);
+        dryRamp = dry;
+    }
+
+    return { wetRamp, dryRamp };
+}
+
+void AJ::dsp::reverb::Reverb::configureFilters(CombFilters &combs, AllPassFilters &allPass, sample_c size,
+    AJ::error::IErrorHandler &handler){
+
+    combs[0].setDelay(mParams->DelayMS(), mParams->Samplerate(), size, handler);
+    combs[1].setDelay(mParams->DelayMS() + COMB_FILTER_1_DELAY, mParams->Samplerate(), size, handler);
+    combs[2].setDelay(mParams->DelayMS() + COMB_FILTER_2_DELAY, mParams->Samplerate(), size, handler);
+    combs[3].setDelay(mParams->DelayMS() + COMB_FILTER_3_DELAY, mParams->Samplerate(), size, handler);
+
+    for(auto &comb : combs){
+        comb.setGain(mParams->Gain());
+        comb.reset();
+    }
+
+    for(auto &filter : allPass){
+        filter.reset();
+    }
+}
+
 bool AJ::dsp::reverb::Reverb::process(Float &buffer, AJ::error::IErrorHandler &handler){
     
     if(!checkValidIndxes(buffer, handler)) return false;
 
     // set the comb filters.
     sample_c size = mParams->End() - mParams->Start() + 1;
-    mCombFilters[0]->setDelay(mParams->DelayMS(), mParams->Samplerate(), size, handler);
-    mCombFilters[0]->setGain(mParams->Gain());
+    configureFilters(mCombFilters, mAllPassFilters, size, handler);
+
+    //* comb bank -> all pass -> wet/dry mix, chunk by chunk, in place.
+    const kernels::CombFn kernel = kernels::table().comb;
+
+    alignas(kBufferAlignment) float wet[kReverbChunkFrames];
+    alignas(kBufferAlignment) float dry[kReverbChunkFrames];
+
+    for(sample_pos i = mParams->Start(); i <= mParams->End(); i += kReverbChunkFrames){
+        const size_t count = std::min<size_t>(kReverbChunkFrames, mParams->End() - i + 1);
+        const auto [wetRamp, dryRamp] = renderMix(i, count, wet, dry);
+
+        renderChunk(buffer.data() + i, count, 1, mCombFilters, mAllPassFilters,
+            mParams->WetMix(), mParams->DryMix(), wetRamp, dryRamp, kernel);
+    }
+
+    return true;
+}
+
+std::unique_ptr<AJ::dsp::EffectState> AJ::dsp::reverb::Reverb::createState(uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "reverb effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return nullptr;
+    }
 
-    mCombFilters[1]->setDelay(mParams->DelayMS() + COMB_FILTER_1_DELAY, mParams->Samplerate(), size, handler);
-    mCombFilters[1]->setGain(mParams->Gain());
+    auto state = std::make_unique<ReverbState>(channels);
 
-    mCombFilters[2]->setDelay(mParams->DelayMS() + COMB_FILTER_2_DELAY, mParams->Samplerate(), size, handler);
-    mCombFilters[2]->setGain(mParams->Gain());
+    for(uint8_t ch = 0; ch < channels; ++ch){
+        for(auto &filter : state->mAllPassFilters[ch]){
+            filter = AllPassFilter(mParams->Samplerate());
+        }
 
-    mCombFilters[3]->setDelay(mParams->DelayMS() + COMB_FILTER_3_DELAY, mParams->Samplerate(), size, handler);
-    mCombFilters[3]->setGain(mParams->Gain());
+        //? a stream has no known length, so the comb delays are not limited by a buffer size.
+        configureFilters(state->mCombFilters[ch], state->mAllPassFilters[ch],
+            std::numeric_limits<sample_c>::max(), handler);
+    }
 
+    return state;
+}
 
-    Float output(size, 0.0f);
-    Float comb1_out(size, 0.0f);
-    Float comb2_out(size, 0.0f);
-    Float comb3_out(size, 0.0f);
-    Float comb4_out(size, 0.0f);
+bool AJ::dsp::reverb::Reverb::processBlock(float *data, size_t frames, uint8_t channels, EffectState &state,
+    AJ::error::IErrorHandler &handler){
+
+    if(!mParams){
+        const std::string message = "reverb effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
 
+    if(!checkBlock(data, channels, state, handler)){
+        return false;
+    }
 
-    for(sample_c i = mParams->Start(); i <= mParams->End(); ++i){
-        sample_t s1 = mCombFilters[0]->process(buffer, comb1_out, i, mParams->Start());
-        sample_t s2 = mCombFilters[1]->process(buffer, comb2_out, i, mParams->Start());
-        sample_t s3 = mCombFilters[2]->process(buffer, comb3_out, i, mParams->Start());
-        sample_t s4 = mCombFilters[3]->process(buffer, comb4_out, i, mParams->Start());
+    ReverbState *reverbState = dynamic_cast<ReverbState*>(&state);
 
-        output[i - mParams->Start()] = (s1 + s2 + s3 + s4) / 4; // normalization.
+    if(!reverbState){
+        const std::string message = "effect state must be a ReverbState created by this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
     }
 
-    // sequential processing for all pass filters 
-    Float all_pass_out = mAllPassFilters[0]->process(output);
-    all_pass_out = mAllPassFilters[1]->process(all_pass_out);
+    size_t first, last;
+    if(blockRange(state.position(), frames, mParams->Start(), mParams->End(), first, last)){
+        const kernels::CombFn kernel = kernels::table().comb;
 
-    // wet and dry mixing and copying into main buffer
-    size_t j = mParams->Start();
-    sample_t sample;
-    for(size_t i = 0; i < size; ++i, ++j){
-        sample = mParams->WetMix() * all_pass_out[i] + mParams->DryMix() * buffer[j];
-        buffer[j] = std::clamp(sample, -1.0f, 1.0f); 
+        alignas(kBufferAlignment) float wet[kReverbChunkFrames];
+        alignas(kBufferAlignment) float dry[kReverbChunkFrames];
+
+        for(size_t f = first; f < last; f += kReverbChunkFrames){
+            const size_t count = std::min(kReverbChunkFrames, last - f);
+            const auto [wetRamp, dryRamp] = renderMix(state.position() + f, count, wet, dry);
+
+            for(uint8_t ch = 0; ch < channels; ++ch){
+                renderChunk(data + f * channels + ch, count, channels, reverbState->mCombFilters[ch],
+                    reverbState->mAllPassFilters[ch], mParams->WetMix(), mParams->DryMix(), wetRamp, dryRamp, kernel);
+            }
+        }
     }
 
+    state.advance(frames);
     return true;
-}
\ No newline at end of file
+}
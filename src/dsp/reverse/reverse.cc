@@ -3,10 +3,12 @@
 #include <algorithm>
 
 #include "core/types.h"
+#include "core/constants.h"
 #include "core/errors.h"
 #include "core/error_handler.h"
 
 #include "dsp/reverse.h"
+#include "dsp/kernels.h"
 #include "core/effect_params.h"
 
 std::shared_ptr<AJ::dsp::reverse::ReverseParams> AJ::dsp::reverse::ReverseParams::create(Params& params,
@@ -40,7 +42,13 @@ bool AJ::dsp::reverse::Reverse::setParams(std::shared_ptr<EffectParams> params,
     return true;
 }
 
-bool AJ::dsp::reverse::Reverse::process(Float &buffer, AJ::error::IErrorHandler &handler){
+bool AJ::dsp::reverse::Reverse::checkRange(const Float &buffer, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "reverse effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
     sample_c start = mParams->Start();
     sample_c end = mParams->End();
 
@@ -50,9 +58,54 @@ bool AJ::dsp::reverse::Reverse::process(Float &buffer, AJ::error::IErrorHandler
         return false;
     }
 
-    std::reverse(buffer.begin() + start, buffer.begin() + end + 1);
+    return true;
+}
+
+bool AJ::dsp::reverse::Reverse::process(Float &buffer, AJ::error::IErrorHandler &handler){
+    if(!checkRange(buffer, handler)){
+        return false;
+    }
+
+    kernels::reverseFrames(buffer.data() + mParams->Start(), mParams->End() - mParams->Start() + 1, 1);
+
+    return true;
+}
+
+bool AJ::dsp::reverse::Reverse::process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler){
+    if(channels == 0 || channels > audio.size()){
+        const std::string message = "invalid channel count for reverse effect.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    for(size_t ch = 0; ch < channels; ++ch){
+        if(!checkRange(audio[ch], handler)) return false;
+    }
+
+    const kernels::KernelTable &kernels = kernels::table();
+    const size_t count = mParams->End() - mParams->Start() + 1;
+    const size_t pairs = count / 2;
+
+    //* both ends of every channel advance together, block after block.
+    for(size_t pair = 0; pair < pairs; pair += kChainBlockFrames){
+        const size_t n = std::min(kChainBlockFrames, pairs - pair);
+        for(size_t ch = 0; ch < channels; ++ch){
+            float *data = audio[ch].data() + mParams->Start();
+            kernels.reverse(data + pair, data + count - pair - n, n, 1);
+        }
+    }
 
     return true;
 }
 
+bool AJ::dsp::reverse::Reverse::processRange(Float &buffer, size_t first, size_t last,
+    AJ::error::IErrorHandler &handler){
+    float *data = buffer.data() + mParams->Start();
+    const size_t count = mParams->End() - mParams->Start() + 1;
+    const size_t n = last / 2 - first / 2;
+
+    //? with an odd count the middle frame is its own mirror, last / 2 never reaches its pair.
+    kernels::table().reverse(data + first / 2, data + count - first / 2 - n, n, 1);
 
+    return true;
+}
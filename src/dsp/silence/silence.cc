@@ -0,0 +1,67 @@
+#include <algorithm>
+
+#include "dsp/silence.h"
+#include "dsp/kernels.h"
+
+AJ::dsp::silence::Scanner::Scanner(float threshold, size_t minFrames) :
+    mThreshold(threshold), mMinFrames(std::max<size_t>(1, minFrames)) {}
+
+void AJ::dsp::silence::Scanner::close(sample_pos end){
+    if(end - mRunStart >= static_cast<sample_pos>(mMinFrames)){
+        mRegions.push_back(Region{ mRunStart, end - 1 });
+    }
+}
+
+void AJ::dsp::silence::Scanner::feed(const float *const *channels, size_t count, size_t frames){
+    const kernels::KernelTable &kernels = kernels::table();
+
+    for(size_t pos = 0; pos < frames;){
+        //* next loud frame on any channel: each channel only looks before the earliest one found.
+        size_t loud = frames - pos;
+        for(size_t ch = 0; ch < count && loud > 0; ++ch){
+            loud = kernels.findAbove(channels[ch] + pos, loud, mThreshold);
+        }
+
+        if(pos + loud == frames){
+            break;
+        }
+
+        size_t last = pos + loud;
+        close(mPosition + static_cast<sample_pos>(last));
+
+        //* skip the loud material a window of mMinFrames at a time, the last loud frame of a window starts the next.
+        size_t window = 0;
+        for(;;){
+            window = std::min(mMinFrames, frames - last - 1);
+
+            size_t found = 0;
+            for(size_t ch = 0; ch < count; ++ch){
+                found = std::max(found, kernels.findLastAbove(channels[ch] + last + 1, window, mThreshold));
+            }
+
+            if(found == 0){
+                break;
+            }
+            last += found;
+        }
+
+        mRunStart = mPosition + static_cast<sample_pos>(last + 1);
+        pos = last + 1 + window;
+    }
+
+    mPosition += static_cast<sample_pos>(frames);
+}
+
+std::vector<AJ::dsp::silence::Region> AJ::dsp::silence::Scanner::finish(){
+    close(mPosition);
+    mRunStart = mPosition;
+    return std::move(mRegions);
+}
+
+std::vector<AJ::dsp::silence::Region> AJ::dsp::silence::detect(const float *const *channels, size_t count,
+    size_t frames, float threshold, size_t minFrames){
+
+    Scanner scanner(threshold, minFrames);
+    scanner.feed(channels, count, frames);
+    return scanner.finish();
+}
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "dsp/stretch/time_stretch.h"
+#include "dsp/kernels.h"
+#include "core/errors.h"
+#include "core/scratch_arena.h"
+
+namespace {
+
+/**
+ * @brief `dst[j]` = sum over the channels of the range sample `position + j`, 0 outside the range.
+ */
+void gather(const float *const *sources, size_t count, size_t length, int64_t position, size_t frames, float *dst){
+    std::fill(dst, dst + frames, 0.0f);
+
+    const int64_t first = std::max<int64_t>(position, 0);
+    const int64_t last = std::min<int64_t>(position + static_cast<int64_t>(frames), static_cast<int64_t>(length));
+    for(size_t ch = 0; ch < count; ++ch){
+        for(int64_t i = first; i < last; ++i){
+            dst[i - position] += sources[ch][i];
+        }
+    }
+}
+
+}
+
+std::shared_ptr<AJ::dsp::stretch::StretchParams> AJ::dsp::stretch::StretchParams::create(Params &params,
+    AJ::error::IErrorHandler &handler){
+
+    if(params.mStart > params.mEnd || params.mStart < 0){
+        const std::string message = "invalid range indexes parameters for time stretch effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(!(params.mRate >= kStretchMinRate && params.mRate <= kStretchMaxRate)){
+        const std::string message = "invalid rate for time stretch effect, it must be in ["
+            + std::to_string(kStretchMinRate) + ", " + std::to_string(kStretchMaxRate) + "].\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(params.mFrameSize % 2 != 0 || params.mFrameSize < kStretchMinFrame || params.mFrameSize > kStretchMaxFrame){
+        const std::string message = "invalid frame size for time stretch effect, it must be even and in ["
+            + std::to_string(kStretchMinFrame) + ", " + std::to_string(kStretchMaxFrame) + "].\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    if(params.mSeek > params.mFrameSize / 2){
+        const std::string message = "invalid seek for time stretch effect, it must be at most half a frame.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return nullptr;
+    }
+
+    std::shared_ptr<StretchParams> stretchParams = std::make_shared<StretchParams>(PrivateTag{});
+
+    //? periodic Hann: w[n] + w[n + N/2] = 1, frames overlapping by half add back to unity gain.
+    auto window = std::make_shared<Float>(params.mFrameSize);
+    for(size_t n = 0; n < params.mFrameSize; ++n){
+        (*window)[n] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * n / params.mFrameSize));
+    }
+
+    stretchParams->mRate = params.mRate;
+    stretchParams->mFrameSize = params.mFrameSize;
+    stretchParams->mSeek = params.mSeek;
+    stretchParams->mWindow = std::move(window);
+    stretchParams->setStart(params.mStart);
+    stretchParams->setEnd(params.mEnd);
+
+    return stretchParams;
+}
+
+size_t AJ::dsp::stretch::StretchParams::StretchedLength(size_t length) const noexcept {
+    return std::max<size_t>(1, static_cast<size_t>(std::llround(length / static_cast<double>(mRate))));
+}
+
+bool AJ::dsp::stretch::TimeStretch::setParams(std::shared_ptr<EffectParams> params, AJ::error::IErrorHandler &handler){
+    std::shared_ptr<StretchParams> stretchParams = std::dynamic_pointer_cast<StretchParams>(params);
+    // if stretchParams is nullptr that means it's not a shared_ptr of StretchParams
+    if(!stretchParams){
+        const std::string message = "Effect parameters must be of type StretchParams for this effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    mParams = stretchParams;
+    return true;
+}
+
+bool AJ::dsp::stretch::TimeStretch::process(Float &buffer, AJ::error::IErrorHandler &handler){
+    Float *channels[] = { &buffer };
+    return stretch(channels, 1, handler);
+}
+
+bool AJ::dsp::stretch::TimeStretch::process(AudioBuffer &audio, size_t channels, AJ::error::IErrorHandler &handler){
+    if(channels == 0 || channels > audio.size()){
+        const std::string message = "invalid channel count for time stretch effect.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    Float *pointers[kNumChannels];
+    for(size_t ch = 0; ch < channels; ++ch){
+        pointers[ch] = &audio[ch];
+    }
+
+    return stretch(pointers, channels, handler);
+}
+
+bool AJ::dsp::stretch::TimeStretch::stretch(Float *const *channels, size_t count, AJ::error::IErrorHandler &handler){
+    if(!mParams){
+        const std::string message = "time stretch effect parameters are not set.\n";
+        handler.onError(error::Error::EffectNotInitialized, message);
+        return false;
+    }
+
+    const size_t size = channels[0]->size();
+    for(size_t ch = 0; ch < count; ++ch){
+        if(channels[ch]->size() != size){
+            const std::string message = "time stretch effect channels must have the same length.\n";
+            handler.onError(error::Error::InvalidEffectParameters, message);
+            return false;
+        }
+    }
+
+    if(mParams->End() < mParams->Start() || mParams->Start() < 0 || mParams->End() >= size){
+        const std::string message = "invalid indexes for time stretch effect.\n";
+        handler.onError(error::Error::InvalidEffectParameters, message);
+        return false;
+    }
+
+    if(mParams->Rate() == 1.0f){
+        return true;
+    }
+
+    /*
+        ?frame k is centered on output sample k·hop and input sample round(k·hop·rate) + offset[k],
+        it covers [k·hop - hop, k·hop + hop) of the output. Segment c owns frames [cK, (c+1)K) (the
+        last one the remainder too, so none is shorter than K). Its first frame sits at its nominal
+        position (offset 0), the others search theirs. The half frame shared by two segments is
+        kept aside and added once both are rendered.
+    */
+    const size_t start = static_cast<size_t>(mParams->Start());
+    const size_t length = static_cast<size_t>(mParams->End()) - start + 1;
+    const size_t stretched = mParams->StretchedLength(length);
+    const size_t frameSize = mParams->FrameSize();
+    const size_t hop = mParams->Hop();
+    const size_t seek = mParams->Seek();
+    const double analysisHop = hop * static_cast<double>(mParams->Rate());
+    const float *window = mParams->Window().data();
+
+    const size_t frames = (stretched + hop - 1) / hop + 1;
+    const size_t perSegment = std::max<size_t>(1, kStretchSegmentFrames / hop);
+    const size_t segments = std::max<size_t>(1, frames / perSegment);
+
+    std::vector<const float*> sources(count);
+    std::vector<Float> results(count);
+    for(size_t ch = 0; ch < count; ++ch){
+        sources[ch] = channels[ch]->data() + start;
+
+        //* the only allocation of the output: the samples around the range are copied once.
+        results[ch].resize(size - length + stretched);
+        std::copy(channels[ch]->begin(), channels[ch]->begin() + start, results[ch].begin());
+        std::copy(channels[ch]->begin() + start + length, channels[ch]->end(), results[ch].begin() + start + stretched);
+    }
+
+    //* heads[c * count + ch] / tails[...]: the first / last half frame of a segment, shared with its neighbour.
+    std::vector<Float> heads(segments * count), tails(segments * count);
+    std::vector<char> rendered(segments, 0);
+
+    const kernels::KernelTable &kernels = kernels::table();
+
+    auto render = [&](size_t c){
+        const size_t firstFrame = c * perSegment;
+        const size_t lastFrame = c + 1 == segments ? frames : firstFrame + perSegment;
+
+        //* output span of the segment, clipped to the stretched range.
+        const int64_t spanBegin = std::max<int64_t>(0, static_cast<int64_t>(firstFrame * hop) - static_cast<int64_t>(hop));
+        const int64_t spanEnd = std::min<int64_t>(static_cast<int64_t>(stretched), static_cast<int64_t>((lastFrame - 1) * hop + hop));
+        const size_t span = static_cast<size_t>(spanEnd - spanBegin);
+
+        utils::ScratchScope scope;
+        utils::ScratchArena &arena = scope.arena();
+        float *out = arena.array<float>(span * count);
+        float *frame = arena.array<float>(frameSize);
+        float *reference = arena.array<float>(hop);
+        float *candidates = arena.array<float>(2 * seek + hop);
+        float *correlation = arena.array<float>(2 * seek + 1);
+        if(!out || !frame || !reference || !candidates || !correlation){
+            return;
+        }
+
+        std::fill(out, out + span * count, 0.0f);
+
+        int64_t previous = 0;
+        for(size_t k = firstFrame; k < lastFrame; ++k){
+            const int64_t nominal = static_cast<int64_t>(std::llround(k * analysisHop)) - static_cast<int64_t>(hop);
+            int64_t position = nominal;
+
+            if(k != firstFrame && seek > 0){
+                //* match the first half of the frame with what would have followed frame k - 1.
+                gather(sources.data(), count, length, previous + static_cast<int64_t>(hop), hop, reference);
+                gather(sources.data(), count, length, nominal - static_cast<int64_t>(seek), 2 * seek + hop, candidates);
+                kernels.crossCorrelate(candidates, reference, correlation, 2 * seek + 1, hop);
+
+                double energy = 0.0;
+                for(size_t i = 0; i < hop; ++i){
+                    energy += static_cast<double>(candidates[i]) * candidates[i];
+                }
+
+                size_t best = seek;
+                double bestScore = -1e300;
+                for(size_t l = 0; l <= 2 * seek; ++l){
+                    const double score = correlation[l] / std::sqrt(energy + 1e-12);
+                    if(score > bestScore){
+                        bestScore = score;
+                        best = l;
+                    }
+
+                    if(l < 2 * seek){
+                        const double leaving = candidates[l], entering = candidates[l + hop];
+                        energy = std::max(0.0, energy - leaving * leaving + entering * entering);
+                    }
+                }
+
+                position = nominal - static_cast<int64_t>(seek) + static_cast<int64_t>(best);
+            }
+
+            //* overlap-add the windowed frame of every channel into the segment span.
+            const int64_t outBegin = static_cast<int64_t>(k * hop) - static_cast<int64_t>(hop);
+            const int64_t from = std::max(outBegin, spanBegin);
+            const int64_t to = std::min(outBegin + static_cast<int64_t>(frameSize), spanEnd);
+
+            for(size_t ch = 0; ch < count; ++ch){
+                const float *source = sources[ch];
+                gather(&source, 1, length, position, frameSize, frame);
+
+                float *dst = out + ch * span;
+                for(int64_t o = from; o < to; ++o){
+                    const size_t n = static_cast<size_t>(o - outBegin);
+                    dst[o - spanBegin] += frame[n] * window[n];
+                }
+            }
+
+            previous = position;
+        }
+
+        //* [own, ownEnd) is only written by this segment.
+        const int64_t own = c == 0 ? 0 : static_cast<int64_t>(firstFrame * hop);
+        const int64_t ownEnd = c + 1 == segments ? spanEnd : static_cast<int64_t>(lastFrame * hop) - static_cast<int64_t>(hop);
+
+        for(size_t ch = 0; ch < count; ++ch){
+            const float *src = out + ch * span;
+            std::copy(src + (own - spanBegin), src + (ownEnd - spanBegin), results[ch].begin() + start + own);
+
+            if(c > 0){
+                heads[c * count + ch].assign(src, src + hop);
+            }
+            if(c + 1 < segments){
+                tails[c * count + ch].assign(src + (ownEnd - spanBegin), src + span);
+            }
+        }
+
+        rendered[c] = 1;
+    };
+
+    if(pThreadPool && segments > 1){
+        pThreadPool->parallel_for(0, segments, 1, [&](size_t first, size_t last){
+            for(size_t c = first; c < last; ++c){
+                render(c);
+            }
+        });
+    } else {
+        for(size_t c = 0; c < segments; ++c){
+            render(c);
+        }
+    }
+
+    if(std::find(rendered.begin(), rendered.end(), 0) != rendered.end()){
+        const std::string message = "failed to allocate the time stretch segment buffers.\n";
+        handler.onError(error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    for(size_t c = 1; c < segments; ++c){
+        const size_t boundary = start + c * perSegment * hop - hop;
+
+        for(size_t ch = 0; ch < count; ++ch){
+            const Float &tail = tails[(c - 1) * count + ch];
+            const Float &head = heads[c * count + ch];
+            float *dst = results[ch].data() + boundary;
+
+            for(size_t i = 0; i < hop; ++i){
+                dst[i] = tail[i] + head[i];
+            }
+        }
+    }
+
+    for(size_t ch = 0; ch < count; ++ch){
+        channels[ch]->swap(results[ch]);
+    }
+
+    return true;
+}
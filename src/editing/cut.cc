@@ -3,11 +3,14 @@
 #include "core/types.h"
 #include "core/errors.h"
 #include "core/error_handler.h"
+#include "core/memory.h"
 
 #include "editing/cut.h"
 
 bool AJ::editing::cut::Cut::process(std::shared_ptr<AJ::io::AudioFile> file,
     AJ::error::IErrorHandler& handler){
+    const utils::MemoryScope memory(utils::Subsystem::Editing);
+
     if(mStart == -1){
         const std::string message = "Cut range not initialized. Please use setRange method before calling process().\n";
         handler.onError(error::Error::InvalidProcessingRange, message);
@@ -34,6 +37,7 @@ bool AJ::editing::cut::Cut::process(std::shared_ptr<AJ::io::AudioFile> file,
             file->pAudio->at(i).clear();
         }
         file->mInfo.length = 0;
+        file->updateLevelIndex(0);
         return true;
     }
 
@@ -50,5 +54,20 @@ bool AJ::editing::cut::Cut::process(std::shared_ptr<AJ::io::AudioFile> file,
     
     file->mInfo.length = (size - count_to_remove) * file->mInfo.channels;
 
+    // samples after mStart moved.
+    file->updateLevelIndex(mStart);
+
     return true;
-}
\ No newline at end of file
+}
+
+bool AJ::editing::cut::Cut::process(piece_table::PieceTable& table, AJ::error::IErrorHandler& handler){
+    const utils::MemoryScope memory(utils::Subsystem::Editing);
+
+    if(mStart == -1){
+        const std::string message = "Cut range not initialized. Please use setRange method before calling process().\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    return table.cut(static_cast<sample_pos>(mStart), static_cast<sample_pos>(mEnd), handler);
+}
@@ -2,10 +2,12 @@
 #include <utility>
 #include <vector>
 #include <algorithm>
+#include <memory>
 
 #include "core/types.h"
 #include "core/errors.h"
 #include "core/error_handler.h"
+#include "core/memory.h"
 
 #include "editing/insert.h"
 
@@ -17,32 +19,22 @@ bool AJ::editing::insert::Insert::insert(std::shared_ptr<AJ::io::AudioFile> file
     sample_c new_size = buffer_size + main_buffer_size;
 
 
+    //* in place: grow the channel, shift the tail up and copy the new samples into the gap.
     for(int ch = 0; ch < file->mInfo.channels; ++ch){
-        Float new_buffer(new_size);
-        
-        new_buffer.insert (
-            new_buffer.begin(), // destination pos.
-            main_buffer->at(ch).begin(), // source start pos.
-            main_buffer->at(ch).begin() + mInsertAt // source end pos.
+        Float &samples = main_buffer->at(ch);
+        samples.resize(new_size);
+
+        std::move_backward(
+            samples.begin() + mInsertAt, // source start pos.
+            samples.begin() + main_buffer_size, // source end pos.
+            samples.end() // destination end pos.
         );
-        
 
-        std::move(
+        std::copy(
             audio->at(ch).begin(), 
             audio->at(ch).end(), 
-            new_buffer.begin() + mInsertAt
-        );
-
-        std::move(
-            main_buffer->at(ch).begin() + mInsertAt,
-            main_buffer->at(ch).end(),
-            new_buffer.begin() + mInsertAt + buffer_size
+            samples.begin() + mInsertAt
         );
-
-        // file->pAudio->at(ch).clear();
-        file->pAudio->at(ch).resize(new_size);
-
-        file->pAudio->at(ch) = std::move(new_buffer);
     }
 
     file->mInfo.length += buffer_size * file->mInfo.channels;
@@ -74,31 +66,25 @@ bool AJ::editing::insert::Insert::pushBack(std::shared_ptr<AJ::io::AudioFile> fi
 }
 
 bool AJ::editing::insert::Insert::pushFront(std::shared_ptr<AJ::io::AudioFile> file, AudioSamples audio){
-        auto main_buffer = file->pAudio;
+    auto main_buffer = file->pAudio;
 
     sample_c buffer_size = audio->at(0).size();
     sample_c main_buffer_size = main_buffer->at(0).size();
     sample_c new_size = buffer_size + main_buffer_size;
 
 
+    //* in place, like insert() at 0.
     for(int ch = 0; ch < file->mInfo.channels; ++ch){
-        Float new_buffer(new_size);
+        Float &samples = main_buffer->at(ch);
+        samples.resize(new_size);
 
-        std::move(
+        std::move_backward(samples.begin(), samples.begin() + main_buffer_size, samples.end());
+
+        std::copy(
             audio->at(ch).begin(), 
             audio->at(ch).end(), 
-            new_buffer.begin()
-        );
-
-        std::move(
-            main_buffer->at(ch).begin(),
-            main_buffer->at(ch).end(),
-            new_buffer.begin() + buffer_size
+            samples.begin()
         );
-
-        file->pAudio->at(ch).resize(new_size);
-
-        file->pAudio->at(ch) = std::move(new_buffer);
     }
 
     file->mInfo.length += buffer_size * file->mInfo.channels;
@@ -109,6 +95,8 @@ bool AJ::editing::insert::Insert::pushFront(std::shared_ptr<AJ::io::AudioFile> f
 bool AJ::editing::insert::Insert::process(std::shared_ptr<AJ::io::AudioFile> file,
     AudioSamples audio, AJ::error::IErrorHandler& handler){
 
+    const utils::MemoryScope memory(utils::Subsystem::Editing);
+
     if(audio->size() == 0){
         const std::string message = "Invalid audio buffers.";
         handler.onError(error::Error::InvalidAudioLength, message);
@@ -139,12 +127,39 @@ bool AJ::editing::insert::Insert::process(std::shared_ptr<AJ::io::AudioFile> fil
         return false;
     } 
 
+    //? the channels are grown in place, a file inserted into itself is copied first.
+    if(audio == file->pAudio){
+        audio = std::make_shared<AudioBuffer>(*audio);
+    }
+
+    bool inserted;
+
     if(mInsertAt == 0)
-        return pushFront(file, audio);
+        inserted = pushFront(file, audio);
     
     else if(mInsertAt == file->pAudio->at(0).size())
-        return pushBack(file, audio);
+        inserted = pushBack(file, audio);
     
     else 
-        return insert(file, audio);
-}
\ No newline at end of file
+        inserted = insert(file, audio);
+
+    // samples after mInsertAt moved.
+    if(inserted)
+        file->updateLevelIndex(mInsertAt);
+
+    return inserted;
+}
+
+bool AJ::editing::insert::Insert::process(piece_table::PieceTable& table,
+    AudioSamples audio, AJ::error::IErrorHandler& handler){
+
+    const utils::MemoryScope memory(utils::Subsystem::Editing);
+
+    if(mInsertAt == -1){
+        const std::string message = "Insert at index is not initialized. Please use setInsertAt method before calling process().\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    return table.insert(static_cast<sample_pos>(mInsertAt), std::move(audio), handler);
+}
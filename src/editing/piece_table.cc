@@ -0,0 +1,353 @@
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+
+#include "editing/piece_table.h"
+
+size_t AJ::editing::piece_table::PieceTable::boundary(size_t frame){
+    if(frame >= mFrames){
+        return mPieces.size();
+    }
+
+    const size_t index = locate(frame);
+    if(mStarts[index] == frame){
+        return index;
+    }
+
+    //* the piece keeps its head, the tail becomes the next piece (same chunk).
+    const size_t within = frame - mStarts[index];
+    Piece tail = mPieces[index];
+    tail.offset += within;
+    tail.frames -= within;
+    mPieces[index].frames = within;
+
+    mPieces.insert(mPieces.begin() + index + 1, std::move(tail));
+    mStarts.insert(mStarts.begin() + index + 1, frame);
+    return index + 1;
+}
+
+void AJ::editing::piece_table::PieceTable::place(size_t index, size_t frame, std::vector<Piece> pieces){
+    std::vector<size_t> starts;
+    starts.reserve(pieces.size());
+
+    size_t total = 0;
+    for(const Piece &piece : pieces){
+        starts.push_back(frame + total);
+        total += piece.frames;
+    }
+
+    for(size_t i = index; i < mStarts.size(); ++i){
+        mStarts[i] += total;
+    }
+
+    const size_t count = pieces.size();
+    mPieces.insert(mPieces.begin() + index, std::make_move_iterator(pieces.begin()), std::make_move_iterator(pieces.end()));
+    mStarts.insert(mStarts.begin() + index, starts.begin(), starts.end());
+    mFrames += total;
+
+    //? the later edge first, merging it doesn't move the earlier one.
+    coalesce(index + count);
+    coalesce(index);
+}
+
+void AJ::editing::piece_table::PieceTable::coalesce(size_t index){
+    if(index == 0 || index >= mPieces.size()){
+        return;
+    }
+
+    Piece &previous = mPieces[index - 1];
+    const Piece &piece = mPieces[index];
+
+    if(previous.source != piece.source || previous.offset + previous.frames != piece.offset){
+        return;
+    }
+
+    previous.frames += piece.frames;
+    mPieces.erase(mPieces.begin() + index);
+    mStarts.erase(mStarts.begin() + index);
+}
+
+bool AJ::editing::piece_table::PieceTable::checkRange(sample_pos start, sample_pos end,
+    AJ::error::IErrorHandler &handler) const {
+    if(start < 0 || end < start || end >= static_cast<sample_pos>(mFrames)){
+        const std::string message =
+            "Invalid edit range. Expected 0 <= start <= end < frames. "
+            "Received start = " + std::to_string(start) +
+            ", end = " + std::to_string(end) +
+            ", frames = " + std::to_string(mFrames) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::checkPosition(sample_pos at, AJ::error::IErrorHandler &handler) const {
+    if(mChannels == 0){
+        const std::string message = "the piece table is empty, use assign() or load() first.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    if(at < 0 || at > static_cast<sample_pos>(mFrames)){
+        const std::string message = "invalid edit position " + std::to_string(at)
+            + ", expected 0 <= position <= " + std::to_string(mFrames) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::assign(AudioSamples audio, uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+    if(channels < 1 || channels > kNumChannels){
+        const std::string message = "invalid channel count for the piece table.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    if(!audio){
+        const std::string message = "Invalid audio buffers.\n";
+        handler.onError(error::Error::InvalidAudioLength, message);
+        return false;
+    }
+
+    const size_t frames = (*audio)[0].size();
+    for(uint8_t ch = 1; ch < channels; ++ch){
+        if((*audio)[ch].size() != frames){
+            const std::string message = "Invalid audio buffers, the channels have different lengths.\n";
+            handler.onError(error::Error::InvalidAudioLength, message);
+            return false;
+        }
+    }
+
+    mChannels = channels;
+    mFrames = frames;
+    mPieces.clear();
+    mStarts.clear();
+
+    if(frames > 0){
+        mPieces.push_back(Piece{ std::move(audio), 0, frames });
+        mStarts.push_back(0);
+    }
+
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::assign(std::vector<Piece> pieces, uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+    if(channels < 1 || channels > kNumChannels){
+        const std::string message = "invalid channel count for the piece table.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    for(const Piece &piece : pieces){
+        bool valid = piece.source && piece.frames > 0;
+        for(uint8_t ch = 0; ch < channels && valid; ++ch){
+            valid = piece.offset + piece.frames <= (*piece.source)[ch].size();
+        }
+
+        if(!valid){
+            const std::string message = "Invalid piece, frames " + std::to_string(piece.offset) + " + "
+                + std::to_string(piece.frames) + " aren't in its chunk.\n";
+            handler.onError(error::Error::InvalidAudioLength, message);
+            return false;
+        }
+    }
+
+    mChannels = channels;
+    mFrames = 0;
+    mPieces.clear();
+    mStarts.clear();
+    place(0, 0, std::move(pieces));
+
+    //? place() only merges at the edges of what it inserts.
+    for(size_t index = mPieces.size(); index-- > 1; ){
+        coalesce(index);
+    }
+
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::load(io::AudioFile &file, AJ::error::IErrorHandler &handler){
+    if(file.storage() != io::SampleStorage::Float32){
+        const std::string message = "the samples must be in Float32 storage to be edited.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    if(!assign(file.pAudio, static_cast<uint8_t>(file.mInfo.channels), handler)){
+        return false;
+    }
+
+    //* the chunk must not change under the table: the file gets it back through flatten().
+    file.pAudio = std::make_shared<AudioBuffer>();
+    file.mInfo.length = 0;
+    file.updateLevelIndex(0);
+
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::split(sample_pos at, AJ::error::IErrorHandler &handler){
+    if(!checkPosition(at, handler)){
+        return false;
+    }
+
+    boundary(static_cast<size_t>(at));
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::cut(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler){
+    if(!checkRange(start, end, handler)){
+        return false;
+    }
+
+    const size_t first = boundary(static_cast<size_t>(start));
+    const size_t last = boundary(static_cast<size_t>(end) + 1);
+    const size_t removed = static_cast<size_t>(end - start) + 1;
+
+    mPieces.erase(mPieces.begin() + first, mPieces.begin() + last);
+    mStarts.erase(mStarts.begin() + first, mStarts.begin() + last);
+
+    for(size_t i = first; i < mStarts.size(); ++i){
+        mStarts[i] -= removed;
+    }
+    mFrames -= removed;
+
+    //* e.g. a region cut and inserted back: its neighbours join again.
+    coalesce(first);
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::insert(sample_pos at, AudioSamples audio, AJ::error::IErrorHandler &handler){
+    if(!checkPosition(at, handler)){
+        return false;
+    }
+
+    if(!audio || (*audio)[0].empty()){
+        const std::string message = "Invalid audio buffers, insert buffer is empty.\n";
+        handler.onError(error::Error::InvalidAudioLength, message);
+        return false;
+    }
+
+    const size_t frames = (*audio)[0].size();
+    for(uint8_t ch = 1; ch < mChannels; ++ch){
+        if((*audio)[ch].size() != frames){
+            const std::string message = "Invalid audio buffers, expected " + std::to_string(mChannels)
+                + " channels of the same length.\n";
+            handler.onError(error::Error::InvalidAudioLength, message);
+            return false;
+        }
+    }
+
+    std::vector<Piece> pieces{ Piece{ std::move(audio), 0, frames } };
+    place(boundary(static_cast<size_t>(at)), static_cast<size_t>(at), std::move(pieces));
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::insert(sample_pos at, const PieceTable &other, AJ::error::IErrorHandler &handler){
+    if(!checkPosition(at, handler)){
+        return false;
+    }
+
+    if(other.mChannels != mChannels){
+        const std::string message = "the inserted piece table has " + std::to_string(other.mChannels)
+            + " channels, expected " + std::to_string(mChannels) + ".\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    //? copied before the split, `other` may be this table.
+    std::vector<Piece> pieces = other.mPieces;
+    place(boundary(static_cast<size_t>(at)), static_cast<size_t>(at), std::move(pieces));
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::copy(sample_pos start, sample_pos end, PieceTable &out,
+    AJ::error::IErrorHandler &handler) const {
+    if(!checkRange(start, end, handler)){
+        return false;
+    }
+
+    PieceTable clip;
+    clip.mChannels = mChannels;
+
+    size_t position = static_cast<size_t>(start);
+    size_t count = static_cast<size_t>(end - start) + 1;
+
+    for(size_t index = locate(position); count > 0; ++index){
+        const Piece &piece = mPieces[index];
+        const size_t within = position - mStarts[index];
+        const size_t frames = std::min(count, piece.frames - within);
+
+        clip.mStarts.push_back(clip.mFrames);
+        clip.mPieces.push_back(Piece{ piece.source, piece.offset + within, frames });
+        clip.mFrames += frames;
+
+        position += frames;
+        count -= frames;
+    }
+
+    out = std::move(clip);
+    return true;
+}
+
+bool AJ::editing::piece_table::PieceTable::duplicate(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler){
+    PieceTable clip;
+    if(!copy(start, end, clip, handler)){
+        return false;
+    }
+
+    return insert(end + 1, clip, handler);
+}
+
+void AJ::editing::piece_table::PieceTable::read(uint8_t channel, size_t start, size_t count, float *out) const {
+    forEachChunk(start, count, [&](const float *const *channels, size_t frames){
+        std::memcpy(out, channels[channel], frames * sizeof(float));
+        out += frames;
+    });
+}
+
+AJ::AudioSamples AJ::editing::piece_table::PieceTable::flatten() const {
+    auto audio = std::make_shared<AudioBuffer>();
+    for(uint8_t ch = 0; ch < mChannels; ++ch){
+        (*audio)[ch].resize(mFrames);
+    }
+
+    size_t position = 0;
+    forEachChunk(0, mFrames, [&](const float *const *channels, size_t frames){
+        for(uint8_t ch = 0; ch < mChannels; ++ch){
+            std::memcpy((*audio)[ch].data() + position, channels[ch], frames * sizeof(float));
+        }
+        position += frames;
+    });
+
+    return audio;
+}
+
+bool AJ::editing::piece_table::PieceTable::flatten(io::AudioFile &file, AJ::error::IErrorHandler &handler) const {
+    if(file.mInfo.channels != mChannels){
+        const std::string message = "the file has " + std::to_string(file.mInfo.channels)
+            + " channels, the piece table " + std::to_string(mChannels) + ".\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    if(file.storage() != io::SampleStorage::Float32){
+        const std::string message = "the samples must be in Float32 storage to be edited.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    file.pAudio = flatten();
+    file.mInfo.length = mFrames * mChannels;
+    file.updateLevelIndex(0);
+
+    return true;
+}
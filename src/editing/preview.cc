@@ -0,0 +1,650 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/thread_placement.h"
+#include "core/trace.h"
+
+#include "dsp/kernels.h"
+#include "dsp/gain.h"
+#include "dsp/fade.h"
+#include "dsp/distortion.h"
+#include "dsp/reverse.h"
+#include "dsp/echo.h"
+#include "dsp/normalization.h"
+#include "dsp/reverb/reverb.h"
+#include "dsp/resample/resampler.h"
+
+#include "editing/preview.h"
+
+namespace {
+
+template <typename P>
+std::shared_ptr<P> copyParams(const std::shared_ptr<AJ::dsp::EffectParams> &params){
+    auto typed = std::dynamic_pointer_cast<P>(params);
+    return typed ? std::make_shared<P>(*typed) : nullptr;
+}
+
+/**
+ * @brief A copy of `params` over [start, end], its durations in frames multiplied by `ratio`
+ * (audio at `ratio` times the samplerate).
+ *
+ * @return nullptr if the parameters aren't of a type known here, or depend on the samplerate
+ *         in a way a copy can't follow (normalization measures loudness at the file's rate).
+ */
+std::shared_ptr<AJ::dsp::EffectParams> movedParams(AJ::Effect effect,
+    const std::shared_ptr<AJ::dsp::EffectParams> &params, AJ::sample_pos start, AJ::sample_pos end, double ratio){
+
+    std::shared_ptr<AJ::dsp::EffectParams> copy;
+
+    switch(effect){
+    case AJ::Effect::gain:
+        copy = copyParams<AJ::dsp::gain::GainParams>(params);
+        break;
+    case AJ::Effect::fadeIn:
+    case AJ::Effect::fadeOut:
+        copy = copyParams<AJ::dsp::fade::FadeParams>(params);
+        break;
+    case AJ::Effect::Distortion:
+        copy = copyParams<AJ::dsp::distortion::DistortionParams>(params);
+        break;
+    case AJ::Effect::reverse:
+        copy = copyParams<AJ::dsp::reverse::ReverseParams>(params);
+        break;
+    case AJ::Effect::echo: {
+        auto echo = copyParams<AJ::dsp::echo::EchoParams>(params);
+        if(echo){
+            echo->setDelaySamples(std::max<AJ::sample_c>(1, std::llround(echo->DelaySamples() * ratio)));
+        }
+        copy = echo;
+        break;
+    }
+    case AJ::Effect::reverb: {
+        auto reverb = copyParams<AJ::dsp::reverb::ReverbParams>(params);
+        if(reverb){
+            reverb->setSamplerate(static_cast<int>(std::lround(reverb->Samplerate() * ratio)));
+        }
+        copy = reverb;
+        break;
+    }
+    case AJ::Effect::normalization:
+        if(ratio == 1.0){
+            copy = copyParams<AJ::dsp::normalization::NormalizationParams>(params);
+        }
+        break;
+    default:
+        break;
+    }
+
+    if(copy){
+        copy->setStart(start);
+        copy->setEnd(end);
+    }
+    return copy;
+}
+
+}
+
+AJ::editing::preview::PreviewRenderer::PreviewRenderer(std::shared_ptr<dsp::EffectRegistry> effects,
+    AJ::error::IErrorHandler &handler) : pEffects(effects), mHandler(handler), mGraph(std::move(effects)) {
+
+    mRenderer = std::thread([this](){
+        run();
+    });
+}
+
+AJ::editing::preview::PreviewRenderer::~PreviewRenderer(){
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        mStop = true;
+    }
+    mWake.notify_all();
+    mRenderer.join();
+}
+
+bool AJ::editing::preview::PreviewRenderer::assign(AudioSamples audio, uint8_t channels, uint32_t samplerate,
+    AJ::error::IErrorHandler &handler){
+
+    if(samplerate < kMinSamplerate || samplerate > kMaxSamplerate){
+        const std::string message = "invalid samplerate " + std::to_string(samplerate) + " for the preview.\n";
+        handler.onError(error::Error::InvalidSampleRate, message);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMux);
+    if(!mGraph.assign(audio, channels, handler)){
+        return false;
+    }
+
+    pSource = std::move(audio);
+    mChannels = channels;
+    mFrames = (*pSource)[0].size();
+    mSamplerate = samplerate;
+    mStages.clear();
+    mPlayhead = 0;
+
+    //* new stamps: whatever the background thread is rendering is dropped when it's done.
+    ++mGeneration;
+    mWindows.clear();
+    mWindows.resize((mFrames + kPreviewWindowFrames - 1) / kPreviewWindowFrames);
+    for(Window &window : mWindows){
+        window.stamp = mGeneration;
+    }
+
+    mWake.notify_one();
+    return true;
+}
+
+AJ::editing::preview::PreviewRenderer::Stage AJ::editing::preview::PreviewRenderer::makeStage(AJ::Effect effect,
+    std::shared_ptr<dsp::EffectParams> params) const {
+
+    Stage stage;
+    stage.effect = effect;
+    stage.start = params ? params->Start() : 0;
+    stage.end = params ? params->End() : static_cast<sample_pos>(mFrames) - 1;
+    stage.params = std::move(params);
+
+    //? the graph built one already, so the registry has a factory.
+    std::unique_ptr<dsp::Effect> instance = pEffects->create(effect);
+    stage.block = instance->supportsBlockProcessing();
+    stage.local = stage.block && instance->splitsRange();
+    return stage;
+}
+
+void AJ::editing::preview::PreviewRenderer::invalidate(size_t from, sample_pos start, sample_pos end){
+    for(size_t index = from; index < mStages.size(); ++index){
+        const Stage &stage = mStages[index];
+        if(end < stage.start || start > stage.end){
+            continue;
+        }
+
+        //* as the graph: a whole range effect changes all its range, memory carries to the end of it.
+        if(!stage.block){
+            start = std::min(start, stage.start);
+            end = std::max(end, stage.end);
+        } else if(!stage.local){
+            end = std::max(end, stage.end);
+        }
+    }
+
+    if(mWindows.empty() || end < start){
+        return;
+    }
+
+    ++mGeneration;
+    const size_t first = static_cast<size_t>(std::max<sample_pos>(start, 0)) / kPreviewWindowFrames;
+    const size_t last = std::min(static_cast<size_t>(end) / kPreviewWindowFrames, mWindows.size() - 1);
+
+    for(size_t index = first; index <= last; ++index){
+        Window &window = mWindows[index];
+        window.quality = Quality::Missing;
+        window.stamp = mGeneration;
+        window.failed = false;
+    }
+
+    mWake.notify_one();
+}
+
+bool AJ::editing::preview::PreviewRenderer::push(AJ::Effect effect, std::shared_ptr<dsp::EffectParams> params,
+    AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+    if(!mGraph.push(effect, params, handler)){
+        return false;
+    }
+
+    mStages.push_back(makeStage(effect, std::move(params)));
+    invalidate(mStages.size() - 1, mStages.back().start, mStages.back().end);
+    return true;
+}
+
+bool AJ::editing::preview::PreviewRenderer::pop(AJ::error::IErrorHandler &handler){
+    std::lock_guard<std::mutex> lock(mMux);
+    if(!mGraph.pop(handler)){
+        return false;
+    }
+
+    const Stage removed = mStages.back();
+    mStages.pop_back();
+    invalidate(mStages.size(), removed.start, removed.end);
+    return true;
+}
+
+bool AJ::editing::preview::PreviewRenderer::setParams(size_t index, std::shared_ptr<dsp::EffectParams> params,
+    AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+    if(!mGraph.setParams(index, params, handler)){
+        return false;
+    }
+
+    //? both the old and the new range changed.
+    const Stage old = mStages[index];
+    mStages[index] = makeStage(old.effect, std::move(params));
+    invalidate(index, std::min(old.start, mStages[index].start), std::max(old.end, mStages[index].end));
+    return true;
+}
+
+void AJ::editing::preview::PreviewRenderer::setPlayhead(size_t frame){
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        mPlayhead = std::min(frame, mFrames);
+    }
+    mWake.notify_one();
+}
+
+void AJ::editing::preview::PreviewRenderer::setDecimation(uint32_t decimation){
+    std::lock_guard<std::mutex> lock(mMux);
+    mDecimation = std::max<uint32_t>(decimation, 1);
+}
+
+uint32_t AJ::editing::preview::PreviewRenderer::decimation() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mDecimation;
+}
+
+AJ::editing::preview::PreviewRenderer::Job AJ::editing::preview::PreviewRenderer::makeJob(size_t window,
+    Quality quality) const {
+
+    Job job;
+    job.window = window;
+    job.stamp = mWindows[window].stamp;
+    job.quality = quality;
+    job.source = pSource;
+    job.channels = mChannels;
+    job.frames = mFrames;
+    job.samplerate = mSamplerate;
+    job.decimation = mDecimation;
+    if(quality == Quality::Preview){
+        job.stages = mStages;
+    }
+    return job;
+}
+
+bool AJ::editing::preview::PreviewRenderer::nextJob(Job &job) const {
+    if(mWindows.empty()){
+        return false;
+    }
+
+    const size_t head = std::min(mPlayhead / kPreviewWindowFrames, mWindows.size() - 1);
+
+    //* first what is about to be played, then the final render from there, wrapping to the start.
+    const size_t lead = std::min(mWindows.size(), head + kPreviewLeadWindows);
+    for(size_t index = head; index < lead; ++index){
+        if(mWindows[index].quality == Quality::Missing && !mWindows[index].failed){
+            job = makeJob(index, Quality::Preview);
+            return true;
+        }
+    }
+
+    for(size_t k = 0; k < mWindows.size(); ++k){
+        const size_t index = (head + k) % mWindows.size();
+        if(mWindows[index].quality != Quality::Full && !mWindows[index].failed){
+            job = makeJob(index, Quality::Full);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AJ::editing::preview::PreviewRenderer::run(){
+    //? a priority that can't be lowered (outside Linux) isn't worth reporting, the render only competes more.
+    error::CollectingErrorHandler ignored;
+    utils::placeCurrentThread(utils::ThreadPlacement().withPriority(utils::ThreadPriority::Low), ignored);
+
+    std::unique_lock<std::mutex> lock(mMux);
+    while(true){
+        Job job;
+        mWake.wait(lock, [&](){
+            return mStop || nextJob(job);
+        });
+
+        if(mStop){
+            return;
+        }
+
+        lock.unlock();
+
+        AudioBuffer samples;
+        bool exact = false;
+        error::CollectingErrorHandler errors;
+
+        bool success = job.quality == Quality::Preview
+            ? renderPreview(job, samples, exact, errors) : renderFull(job, samples, errors);
+
+        if(success && samples[0].empty()){
+            success = renderFull(job, samples, errors);
+            exact = true;
+        }
+
+        lock.lock();
+
+        //* a change since the job was made dropped the window again, its render is stale.
+        bool report = false;
+        if(job.window < mWindows.size() && mWindows[job.window].stamp == job.stamp){
+            Window &window = mWindows[job.window];
+            const Quality quality = job.quality == Quality::Full || exact ? Quality::Full : Quality::Preview;
+
+            if(!success){
+                window.failed = true;
+                report = true;
+            } else if(quality > window.quality){
+                window.samples = std::move(samples);
+                window.quality = quality;
+            }
+        }
+
+        mSettled.notify_all();
+
+        if(report){
+            lock.unlock();
+            errors.replay(mHandler);
+            lock.lock();
+        }
+    }
+}
+
+bool AJ::editing::preview::PreviewRenderer::renderFull(const Job &job, AudioBuffer &out,
+    AJ::error::IErrorHandler &handler){
+
+    const size_t start = job.window * kPreviewWindowFrames;
+    const size_t count = std::min(kPreviewWindowFrames, job.frames - start);
+
+    float *planar[kNumChannels] = {};
+    for(uint8_t ch = 0; ch < job.channels; ++ch){
+        out[ch].resize(count);
+        planar[ch] = out[ch].data();
+    }
+
+    AJ_TRACE_ZONE("editing", "preview_full");
+    return mGraph.read(start, count, planar, handler);
+}
+
+bool AJ::editing::preview::PreviewRenderer::renderPreview(const Job &job, AudioBuffer &out, bool &exact,
+    AJ::error::IErrorHandler &handler) const {
+
+    AJ_TRACE_ZONE("editing", "preview_window");
+
+    const size_t first = job.window * kPreviewWindowFrames;
+    const size_t count = std::min(kPreviewWindowFrames, job.frames - first);
+    const size_t last = first + count;
+
+    auto overlaps = [](const Stage &stage, size_t from, size_t to){
+        return stage.end >= static_cast<sample_pos>(from) && stage.start < static_cast<sample_pos>(to);
+    };
+
+    //* a reduced rate if the source allows one, and the frames its filters need past the window.
+    uint32_t decimation = job.decimation;
+    while(decimation > 1 && job.samplerate / decimation < kMinSamplerate){
+        --decimation;
+    }
+
+    std::shared_ptr<const dsp::resample::Filter> down, up;
+    if(decimation > 1){
+        //? a ratio the resampler has no filter for previews at the source rate.
+        error::CollectingErrorHandler ignored;
+        down = dsp::resample::filter(job.samplerate, job.samplerate / decimation, ignored);
+        up = down ? dsp::resample::filter(job.samplerate / decimation, job.samplerate, ignored) : nullptr;
+    }
+    size_t pad = up ? down->Reach() + up->Reach() * decimation : 0;
+
+    //? the filters ring at the ends of the file, where there's nothing to pad with.
+    if(first < pad || last + pad > job.frames){
+        up = nullptr;
+        pad = 0;
+    }
+
+    //* effects with memory hear the tail before the window, the others only the window.
+    bool memory = false;
+    for(const Stage &stage : job.stages){
+        memory = memory || (overlaps(stage, first, last) && !stage.local);
+    }
+
+    const size_t tail = memory ? static_cast<size_t>(kPreviewTailSeconds * job.samplerate) : 0;
+    const size_t begin = first - std::min(first, std::max(tail, pad));
+    const size_t end = std::min(job.frames, last + pad);
+
+    std::vector<const Stage*> active;
+    for(const Stage &stage : job.stages){
+        if(overlaps(stage, begin, end)){
+            active.push_back(&stage);
+        }
+    }
+
+    exact = active.empty();
+    if(exact){
+        for(uint8_t ch = 0; ch < job.channels; ++ch){
+            out[ch].assign((*job.source)[ch].begin() + first, (*job.source)[ch].begin() + last);
+        }
+        return true;
+    }
+
+    //* the parameters every stage runs with: block stages keep stream frames (scaled to the reduced
+    //* rate), whole range stages get their range moved into the frames [begin, end).
+    std::vector<std::shared_ptr<dsp::EffectParams>> params(active.size());
+    double ratio = up ? static_cast<double>(job.samplerate / decimation) / job.samplerate : 1.0;
+
+    auto moveAll = [&](double scale){
+        for(size_t i = 0; i < active.size(); ++i){
+            const Stage &stage = *active[i];
+            if(stage.block && scale == 1.0){
+                params[i] = stage.params;
+                continue;
+            }
+
+            //? a whole range stage only sees [begin, end), its range is moved there.
+            const sample_pos offset = stage.block ? 0 : static_cast<sample_pos>(begin);
+            const sample_pos from = stage.block ? stage.start : std::max<sample_pos>(stage.start, begin);
+            const sample_pos to = stage.block ? stage.end : std::min<sample_pos>(stage.end, end - 1);
+
+            params[i] = movedParams(stage.effect, stage.params, static_cast<sample_pos>((from - offset) * scale),
+                static_cast<sample_pos>((to - offset) * scale), scale);
+            if(!params[i]){
+                return false;
+            }
+        }
+        return true;
+    };
+
+    //* a stage that can't run at the reduced rate keeps the window at the source rate, a whole
+    //* range stage the preview can't move leaves it to the full render.
+    if(ratio != 1.0 && !moveAll(ratio)){
+        ratio = 1.0;
+    }
+    if(ratio == 1.0 && !moveAll(1.0)){
+        return true;
+    }
+
+    const bool reduced = ratio != 1.0;
+    const size_t frames = end - begin;
+
+    AudioBuffer work;
+    for(uint8_t ch = 0; ch < job.channels; ++ch){
+        work[ch].assign((*job.source)[ch].begin() + begin, (*job.source)[ch].begin() + end);
+
+        if(reduced){
+            Float low;
+            dsp::resample::resample(work[ch].data(), frames, low, *down);
+            work[ch] = std::move(low);
+        }
+    }
+
+    const size_t length = work[0].size();
+    const sample_pos position = static_cast<sample_pos>(begin * ratio);
+    const dsp::kernels::KernelTable &kernels = dsp::kernels::table();
+    Float interleaved;
+
+    for(size_t i = 0; i < active.size(); ++i){
+        std::unique_ptr<dsp::Effect> effect = pEffects->create(active[i]->effect);
+        if(!effect){
+            const std::string message = "no effect registered for a stage of the preview.\n";
+            handler.onError(error::Error::EffectNotInitialized, message);
+            return false;
+        }
+
+        effect->setQuality(dsp::RenderQuality::Preview);
+        if(!effect->setParams(params[i], handler)){
+            return false;
+        }
+
+        if(!active[i]->block){
+            if(!effect->process(work, job.channels, handler)){
+                return false;
+            }
+            continue;
+        }
+
+        std::unique_ptr<dsp::EffectState> state = effect->createState(job.channels, handler);
+        if(!state){
+            return false;
+        }
+        state->seek(position);
+
+        float *data = work[0].data();
+        if(job.channels == 2){
+            interleaved.resize(2 * length);
+            kernels.interleave(work[0].data(), work[1].data(), interleaved.data(), length);
+            data = interleaved.data();
+        }
+
+        for(size_t done = 0; done < length; done += kRenderChunkFrames){
+            const size_t block = std::min(kRenderChunkFrames, length - done);
+            if(!effect->processBlock(data + done * job.channels, block, job.channels, *state, handler)){
+                return false;
+            }
+        }
+
+        if(job.channels == 2){
+            kernels.deinterleave(interleaved.data(), work[0].data(), work[1].data(), length);
+        }
+    }
+
+    for(uint8_t ch = 0; ch < job.channels; ++ch){
+        if(reduced){
+            Float full;
+            dsp::resample::resample(work[ch].data(), length, full, *up);
+            work[ch] = std::move(full);
+        }
+
+        out[ch].assign(work[ch].begin() + (first - begin), work[ch].begin() + (last - begin));
+    }
+
+    return true;
+}
+
+bool AJ::editing::preview::PreviewRenderer::renderNow(size_t window, AJ::error::IErrorHandler &handler){
+    const Job job = makeJob(window, Quality::Preview);
+
+    AudioBuffer samples;
+    bool exact = false;
+    if(!renderPreview(job, samples, exact, handler)){
+        return false;
+    }
+
+    if(samples[0].empty()){
+        if(!renderFull(job, samples, handler)){
+            return false;
+        }
+        exact = true;
+    }
+
+    mWindows[window].samples = std::move(samples);
+    mWindows[window].quality = exact ? Quality::Full : Quality::Preview;
+    return true;
+}
+
+bool AJ::editing::preview::PreviewRenderer::read(size_t start, size_t count, float *const *out, Quality &quality,
+    AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+
+    if(mChannels == 0 || start + count > mFrames || start + count < start){
+        const std::string message = "Invalid preview range. Expected start + count <= frames. "
+            "Received start = " + std::to_string(start) + ", count = " + std::to_string(count)
+            + ", frames = " + std::to_string(mFrames) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    quality = Quality::Full;
+    bool rendered = false;
+
+    for(size_t done = 0; done < count; ){
+        const size_t position = start + done;
+        const size_t index = position / kPreviewWindowFrames;
+        const size_t within = position - index * kPreviewWindowFrames;
+        const size_t frames = std::min(count - done, windowFrames(index) - within);
+
+        Window &window = mWindows[index];
+        if(window.quality == Quality::Missing){
+            if(!renderNow(index, handler)){
+                return false;
+            }
+            rendered = true;
+        }
+
+        for(uint8_t ch = 0; ch < mChannels; ++ch){
+            std::copy_n(window.samples[ch].begin() + within, frames, out[ch] + done);
+        }
+
+        quality = std::min(quality, window.quality);
+        done += frames;
+    }
+
+    if(rendered){
+        mSettled.notify_all();
+    }
+    return true;
+}
+
+AJ::editing::preview::Quality AJ::editing::preview::PreviewRenderer::quality(size_t start, size_t count) const {
+    std::lock_guard<std::mutex> lock(mMux);
+
+    Quality lowest = Quality::Full;
+    if(count == 0 || start >= mFrames){
+        return lowest;
+    }
+
+    const size_t last = std::min(start + count, mFrames) - 1;
+    for(size_t index = start / kPreviewWindowFrames; index <= last / kPreviewWindowFrames; ++index){
+        lowest = std::min(lowest, mWindows[index].quality);
+    }
+    return lowest;
+}
+
+bool AJ::editing::preview::PreviewRenderer::wait(std::chrono::milliseconds timeout){
+    std::unique_lock<std::mutex> lock(mMux);
+
+    auto settled = [&](){
+        return std::all_of(mWindows.begin(), mWindows.end(), [](const Window &window){
+            return window.quality == Quality::Full || window.failed;
+        });
+    };
+
+    if(!mSettled.wait_for(lock, timeout, settled)){
+        return false;
+    }
+
+    return std::all_of(mWindows.begin(), mWindows.end(), [](const Window &window){
+        return window.quality == Quality::Full;
+    });
+}
+
+size_t AJ::editing::preview::PreviewRenderer::size() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mStages.size();
+}
+
+size_t AJ::editing::preview::PreviewRenderer::frames() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mFrames;
+}
+
+uint8_t AJ::editing::preview::PreviewRenderer::channels() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mChannels;
+}
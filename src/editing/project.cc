@@ -0,0 +1,1089 @@
+#include <algorithm>
+#include <cerrno>
+#include <cfloat>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+
+#include "editing/project.h"
+#include "file_io/file_utils.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kJournalName[] = "journal.ajpj";
+constexpr char kSamplesName[] = "samples.ajps";
+
+constexpr char kRecordMagic[4] = {'A', 'J', 'P', 'R'};
+constexpr uint32_t kVersion = 1;
+
+enum class RecordType : uint32_t {
+    Project = 1, ///< channels and samplerate, the first record.
+    Chunk,       ///< a chunk appended to the sample file, ids follow the order of the records.
+    Table,       ///< the pieces of the table.
+    History,     ///< the undo and redo states.
+    Loudness,    ///< a loudness measurement of the table.
+    SeekIndex    ///< the seek index of a source.
+};
+
+/// @brief Fixed part of a journal record, followed by its payload.
+struct RecordHeader {
+    char magic[4];
+    uint32_t type;
+    uint64_t bytes;    ///< bytes of the payload.
+    uint64_t checksum; ///< FNV-1a of the payload.
+};
+
+static_assert(sizeof(RecordHeader) % 8 == 0, "RecordHeader must not need trailing padding");
+static_assert(sizeof(AJ::dsp::kernels::Levels) == 16, "Levels are stored as they are");
+static_assert(sizeof(AJ::io::SeekIndex::Point) == 16, "SeekIndex::Point is stored as it is");
+
+uint64_t checksum(const uint8_t *data, size_t bytes) noexcept {
+    uint64_t hash = 14695981039346656037ull;
+    for(size_t i = 0; i < bytes; ++i){
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+template<typename T>
+void put(std::string &out, const T &value){
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void record(std::string &out, RecordType type, const std::string &payload){
+    RecordHeader header = {};
+    std::memcpy(header.magic, kRecordMagic, sizeof(kRecordMagic));
+    header.type = static_cast<uint32_t>(type);
+    header.bytes = payload.size();
+    header.checksum = checksum(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+
+    put(out, header);
+    out += payload;
+}
+
+/// @brief The fields of a payload in order, every get() fails past its end.
+struct Reader {
+    const uint8_t *data;
+    size_t left;
+
+    template<typename T>
+    bool get(T &value) noexcept {
+        if(left < sizeof(T)) return false;
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        left -= sizeof(T);
+        return true;
+    }
+
+    bool get(std::string &value, size_t bytes) {
+        if(left < bytes) return false;
+        value.assign(reinterpret_cast<const char*>(data), bytes);
+        data += bytes;
+        left -= bytes;
+        return true;
+    }
+};
+
+size_t align_up(size_t bytes) noexcept {
+    return (bytes + AJ::kProjectAlignment - 1) / AJ::kProjectAlignment * AJ::kProjectAlignment;
+}
+
+size_t level_blocks(uint64_t frames) noexcept {
+    return static_cast<size_t>((frames + AJ::kLevelIndexBaseFrames - 1) / AJ::kLevelIndexBaseFrames);
+}
+
+template<typename Piece>
+void put_pieces(std::string &out, const std::vector<Piece> &pieces){
+    put(out, static_cast<uint64_t>(pieces.size()));
+    for(const Piece &piece : pieces){
+        put(out, piece.chunk);
+        put(out, piece.offset);
+        put(out, piece.frames);
+    }
+}
+
+//* pieces only refer to chunks of earlier records, inside their frames.
+template<typename Piece, typename Chunk>
+bool get_pieces(Reader &in, std::vector<Piece> &pieces, const std::vector<Chunk> &chunks){
+    uint64_t count = 0;
+    if(!in.get(count) || count > in.left / (3 * sizeof(uint64_t))) return false;
+
+    pieces.resize(static_cast<size_t>(count));
+    for(Piece &piece : pieces){
+        if(!in.get(piece.chunk) || !in.get(piece.offset) || !in.get(piece.frames)) return false;
+
+        if(piece.chunk >= chunks.size() || piece.frames == 0 || piece.offset > chunks[piece.chunk].frames
+            || piece.frames > chunks[piece.chunk].frames - piece.offset){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename State>
+void put_states(std::string &out, const std::vector<State> &states){
+    put(out, static_cast<uint64_t>(states.size()));
+    for(const State &state : states){
+        put(out, static_cast<uint32_t>(state.label.size()));
+        out += state.label;
+        put(out, static_cast<uint64_t>(state.changes.size()));
+
+        for(const auto &change : state.changes){
+            put(out, change.start);
+            put(out, change.removed);
+            put(out, change.inserted);
+            put_pieces(out, change.saved);
+        }
+    }
+}
+
+template<typename State, typename Chunk>
+bool get_states(Reader &in, std::vector<State> &states, const std::vector<Chunk> &chunks){
+    uint64_t count = 0;
+    if(!in.get(count) || count > in.left) return false;
+
+    states.resize(static_cast<size_t>(count));
+    for(State &state : states){
+        uint32_t label = 0;
+        uint64_t changes = 0;
+        if(!in.get(label) || !in.get(state.label, label) || !in.get(changes) || changes > in.left) return false;
+
+        state.changes.resize(static_cast<size_t>(changes));
+        for(auto &change : state.changes){
+            if(!in.get(change.start) || !in.get(change.removed) || !in.get(change.inserted)
+                || !get_pieces(in, change.saved, chunks)){
+                return false;
+            }
+
+            uint64_t saved = 0;
+            for(const auto &piece : change.saved) saved += piece.frames;
+            if(saved != change.removed) return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename State>
+std::string history_payload(const std::vector<State> &undo, const std::vector<State> &redo){
+    std::string payload;
+    put_states(payload, undo);
+    put_states(payload, redo);
+    return payload;
+}
+
+std::string project_payload(uint8_t channels, uint32_t samplerate){
+    std::string payload;
+    put(payload, kVersion);
+    put(payload, samplerate);
+    put(payload, channels);
+    return payload;
+}
+
+template<typename Chunk>
+std::string chunk_payload(const Chunk &chunk){
+    std::string payload;
+    put(payload, chunk.offset);
+    put(payload, chunk.stride);
+    put(payload, chunk.frames);
+    put(payload, chunk.levels);
+    return payload;
+}
+
+template<typename Loudness>
+std::string loudness_payload(const Loudness &entry){
+    std::string payload;
+    put(payload, entry.start);
+    put(payload, entry.end);
+    put(payload, entry.samplerate);
+    put(payload, entry.measurement.mTruePeak);
+    put(payload, entry.measurement.mIntegrated);
+    return payload;
+}
+
+std::string seek_payload(const std::string &source, const AJ::io::SeekIndex &index){
+    std::string payload;
+    put(payload, static_cast<uint32_t>(source.size()));
+    payload += source;
+    put(payload, static_cast<uint64_t>(index.packets()));
+    put(payload, index.frames());
+    put(payload, static_cast<uint64_t>(index.points().size()));
+    payload.append(reinterpret_cast<const char*>(index.points().data()), index.points().size() * sizeof(AJ::io::SeekIndex::Point));
+    return payload;
+}
+
+enum class OpenMode {
+    Existing,  ///< the file must exist.
+    Exclusive, ///< the file must not exist.
+    Truncate   ///< created or emptied.
+};
+
+#if defined(__linux__)
+int open_file(const std::string &path, OpenMode mode){
+    const int flags = mode == OpenMode::Existing ? O_RDWR
+        : mode == OpenMode::Exclusive ? O_RDWR | O_CREAT | O_EXCL : O_RDWR | O_CREAT | O_TRUNC;
+    return ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+}
+
+void close_file(int fd) noexcept {
+    ::close(fd);
+}
+
+bool file_bytes(int fd, uint64_t &bytes) noexcept {
+    struct stat st;
+    if(fstat(fd, &st) != 0) return false;
+    bytes = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+bool read_all(int fd, std::vector<uint8_t> &out){
+    uint64_t bytes = 0;
+    if(!file_bytes(fd, bytes)) return false;
+
+    out.resize(static_cast<size_t>(bytes));
+    size_t done = 0;
+    while(done < out.size()){
+        const ssize_t got = pread(fd, out.data() + done, out.size() - done, static_cast<off_t>(done));
+
+        if(got < 0 && errno == EINTR) continue;
+        if(got <= 0) return false;
+        done += static_cast<size_t>(got);
+    }
+
+    return true;
+}
+
+bool sync_file(int fd) noexcept {
+    return fdatasync(fd) == 0;
+}
+
+bool truncate_file(int fd, uint64_t bytes) noexcept {
+    return ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+}
+
+const uint8_t* map_file(int fd, size_t bytes) noexcept {
+    void *ptr = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    return ptr == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(ptr);
+}
+
+void unmap_file(const uint8_t *map, size_t bytes) noexcept {
+    munmap(const_cast<uint8_t*>(map), bytes);
+}
+#else
+//? no mmap: a project can't be opened, create() and open() report it.
+int open_file(const std::string&, OpenMode){ return -1; }
+void close_file(int) noexcept {}
+bool file_bytes(int, uint64_t&) noexcept { return false; }
+bool read_all(int, std::vector<uint8_t>&){ return false; }
+bool sync_file(int) noexcept { return false; }
+bool truncate_file(int, uint64_t) noexcept { return false; }
+const uint8_t* map_file(int, size_t) noexcept { return nullptr; }
+void unmap_file(const uint8_t*, size_t) noexcept {}
+#endif
+
+std::string file_path(const std::string &directory, const char *name){
+    return (std::filesystem::path(directory) / name).string();
+}
+
+}
+
+AJ::editing::project::ProjectStore::~ProjectStore(){
+    close();
+}
+
+void AJ::editing::project::ProjectStore::close() noexcept {
+    if(pMap) unmap_file(pMap, mMapSize);
+    if(mData >= 0) close_file(mData);
+    if(mJournal >= 0) close_file(mJournal);
+
+    pMap = nullptr;
+    mMapSize = 0;
+    mData = -1;
+    mJournal = -1;
+    mDataBytes = 0;
+    mJournalBytes = 0;
+    mChannels = 0;
+    mSamplerate = 0;
+    mFrames = 0;
+
+    mDirectory.clear();
+    mChunks.clear();
+    mIds.clear();
+    mPieces.clear();
+    mStarts.clear();
+    mUndo.clear();
+    mRedo.clear();
+    mLoudness.clear();
+    mSeekIndices.clear();
+}
+
+bool AJ::editing::project::ProjectStore::create(const std::string &directory, uint8_t channels, uint32_t samplerate,
+    AJ::error::IErrorHandler &handler){
+
+    close();
+
+    if(channels < 1 || channels > kNumChannels){
+        const std::string message = "invalid channel count " + std::to_string(channels) + " for the project.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    if(samplerate < kMinSamplerate || samplerate > kMaxSamplerate){
+        const std::string message = "invalid samplerate " + std::to_string(samplerate) + " for the project.\n";
+        handler.onError(error::Error::InvalidSampleRate, message);
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+
+    const std::string journal = file_path(directory, kJournalName);
+    mJournal = open_file(journal, OpenMode::Exclusive);
+    if(mJournal < 0){
+        const std::string message = "can't create the project " + directory
+            + ", it already holds one or can't be written.\n";
+        handler.onError(error::Error::FileOpenError, message);
+        return false;
+    }
+
+    mData = open_file(file_path(directory, kSamplesName), OpenMode::Truncate);
+    mChannels = channels;
+    mSamplerate = samplerate;
+    mDirectory = directory;
+
+    std::string records;
+    record(records, RecordType::Project, project_payload(channels, samplerate));
+
+    if(mData < 0 || !append(records, handler)){
+        if(mData < 0){
+            const std::string message = "can't create the sample file of the project " + directory + ".\n";
+            handler.onError(error::Error::FileOpenError, message);
+        }
+
+        //? removed so create() can be retried.
+        close();
+        std::filesystem::remove(journal, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool AJ::editing::project::ProjectStore::open(const std::string &directory, AJ::error::IErrorHandler &handler){
+    close();
+
+    mJournal = open_file(file_path(directory, kJournalName), OpenMode::Existing);
+    mData = mJournal >= 0 ? open_file(file_path(directory, kSamplesName), OpenMode::Existing) : -1;
+
+    if(mData < 0 || !file_bytes(mData, mDataBytes)){
+        close();
+        const std::string message = "no project in " + directory + ".\n";
+        handler.onError(error::Error::FileOpenError, message);
+        return false;
+    }
+
+    std::vector<uint8_t> journal;
+    uint64_t valid = 0;
+
+    if(!read_all(mJournal, journal) || !replay(journal, valid)){
+        close();
+        const std::string message = "the journal of the project " + directory + " can't be read.\n";
+        handler.onError(error::Error::FileReadError, message);
+        return false;
+    }
+
+    //* a record torn by a crash is dropped, the next ones are appended after the last complete one.
+    if(valid < journal.size() && !truncate_file(mJournal, valid)){
+        close();
+        const std::string message = "the journal of the project " + directory + " can't be repaired.\n";
+        handler.onError(error::Error::FileWriteError, message);
+        return false;
+    }
+
+    mJournalBytes = valid;
+    mDirectory = directory;
+    return remap(handler);
+}
+
+bool AJ::editing::project::ProjectStore::replay(const std::vector<uint8_t> &journal, uint64_t &valid){
+    size_t pos = 0;
+    valid = 0;
+
+    while(journal.size() - pos >= sizeof(RecordHeader)){
+        RecordHeader header;
+        std::memcpy(&header, journal.data() + pos, sizeof(header));
+
+        const uint8_t *payload = journal.data() + pos + sizeof(header);
+        const size_t left = journal.size() - pos - sizeof(header);
+
+        //? a payload past the end was torn by a crash, open() drops it.
+        if(header.bytes > left){
+            break;
+        }
+
+        //* a complete record that doesn't check out is damage: the records after it can't be trusted either.
+        if(std::memcmp(header.magic, kRecordMagic, sizeof(kRecordMagic)) != 0
+            || checksum(payload, static_cast<size_t>(header.bytes)) != header.checksum){
+            return false;
+        }
+
+        //? only the first record describes the project.
+        const bool first = header.type == static_cast<uint32_t>(RecordType::Project);
+        if(first != (pos == 0) || !apply(header.type, payload, static_cast<size_t>(header.bytes))){
+            return false;
+        }
+
+        pos += sizeof(header) + static_cast<size_t>(header.bytes);
+        valid = pos;
+    }
+
+    return valid > 0;
+}
+
+bool AJ::editing::project::ProjectStore::apply(uint32_t type, const uint8_t *payload, size_t bytes){
+    Reader in{ payload, bytes };
+
+    switch(static_cast<RecordType>(type)){
+    case RecordType::Project: {
+        uint32_t version = 0;
+        if(!in.get(version) || version != kVersion || !in.get(mSamplerate) || !in.get(mChannels)) return false;
+        return mChannels >= 1 && mChannels <= kNumChannels;
+    }
+    case RecordType::Chunk: {
+        Chunk chunk;
+        if(!in.get(chunk.offset) || !in.get(chunk.stride) || !in.get(chunk.frames) || !in.get(chunk.levels)) return false;
+
+        //* the samples were synced before the record: a chunk out of the file is damage.
+        const uint64_t planes = chunk.offset + (mChannels - 1) * chunk.stride + chunk.frames * sizeof(float);
+        const bool valid = chunk.frames > 0 && chunk.frames <= mDataBytes / sizeof(float)
+            && chunk.offset % kProjectAlignment == 0 && chunk.stride % kProjectAlignment == 0
+            && chunk.stride >= chunk.frames * sizeof(float) && chunk.offset <= mDataBytes && chunk.stride <= mDataBytes
+            && planes <= chunk.levels && chunk.levels % kProjectAlignment == 0
+            && chunk.levels + mChannels * level_blocks(chunk.frames) * sizeof(dsp::kernels::Levels) <= mDataBytes;
+        if(!valid) return false;
+
+        mChunks.push_back(std::move(chunk));
+        return true;
+    }
+    case RecordType::Table: {
+        std::vector<Piece> pieces;
+        if(!get_pieces(in, pieces, mChunks)) return false;
+
+        setTable(std::move(pieces));
+        return true;
+    }
+    case RecordType::History: {
+        std::vector<State> undo, redo;
+        if(!get_states(in, undo, mChunks) || !get_states(in, redo, mChunks)) return false;
+
+        mUndo = std::move(undo);
+        mRedo = std::move(redo);
+        return true;
+    }
+    case RecordType::Loudness: {
+        Loudness entry;
+        if(!in.get(entry.start) || !in.get(entry.end) || !in.get(entry.samplerate)
+            || !in.get(entry.measurement.mTruePeak) || !in.get(entry.measurement.mIntegrated)){
+            return false;
+        }
+
+        remember(entry);
+        return true;
+    }
+    case RecordType::SeekIndex: {
+        uint32_t length = 0;
+        std::string source;
+        uint64_t packets = 0, count = 0;
+        sample_pos frames = 0;
+
+        if(!in.get(length) || !in.get(source, length) || !in.get(packets) || !in.get(frames) || !in.get(count)
+            || count > in.left / sizeof(io::SeekIndex::Point)){
+            return false;
+        }
+
+        std::vector<io::SeekIndex::Point> points(static_cast<size_t>(count));
+        std::memcpy(points.data(), in.data, points.size() * sizeof(io::SeekIndex::Point));
+        mSeekIndices[source] = io::SeekIndex(std::move(points), static_cast<size_t>(packets), frames);
+        return true;
+    }
+    default:
+        //? a record of a newer version: skipped, the journal isn't cut there.
+        return true;
+    }
+}
+
+void AJ::editing::project::ProjectStore::setTable(std::vector<Piece> pieces){
+    mPieces = std::move(pieces);
+    mStarts.resize(mPieces.size());
+    mFrames = 0;
+
+    for(size_t i = 0; i < mPieces.size(); ++i){
+        mStarts[i] = mFrames;
+        mFrames += mPieces[i].frames;
+    }
+
+    //* measurements were of the previous pieces.
+    mLoudness.clear();
+}
+
+void AJ::editing::project::ProjectStore::remember(const Loudness &entry){
+    mLoudness.erase(std::remove_if(mLoudness.begin(), mLoudness.end(), [&](const Loudness &other){
+        return other.start == entry.start && other.end == entry.end && other.samplerate == entry.samplerate;
+    }), mLoudness.end());
+
+    if(mLoudness.size() >= kLevelIndexLoudnessEntries){
+        mLoudness.erase(mLoudness.begin());
+    }
+    mLoudness.push_back(entry);
+}
+
+bool AJ::editing::project::ProjectStore::remap(AJ::error::IErrorHandler &handler){
+    if(pMap){
+        unmap_file(pMap, mMapSize);
+        pMap = nullptr;
+        mMapSize = 0;
+    }
+
+    if(mDataBytes == 0){
+        return true;
+    }
+
+    pMap = map_file(mData, static_cast<size_t>(mDataBytes));
+    if(!pMap){
+        const std::string message = "failed to map the sample file of the project " + mDirectory + ".\n";
+        handler.onError(error::Error::FileReadError, message);
+        return false;
+    }
+
+    mMapSize = static_cast<size_t>(mDataBytes);
+    return true;
+}
+
+bool AJ::editing::project::ProjectStore::append(const std::string &records, AJ::error::IErrorHandler &handler){
+    if(!utils::FileUtils::write_all(mJournal, records.data(), records.size(), mJournalBytes) || !sync_file(mJournal)){
+        //? a partial record would be dropped by the next open anyway.
+        truncate_file(mJournal, mJournalBytes);
+        const std::string message = "failed to write the journal of the project " + mDirectory + ".\n";
+        handler.onError(error::Error::FileWriteError, message);
+        return false;
+    }
+
+    mJournalBytes += records.size();
+    return true;
+}
+
+bool AJ::editing::project::ProjectStore::store(const std::shared_ptr<const AudioBuffer> &source, std::string &records,
+    uint64_t &id, AJ::error::IErrorHandler &handler){
+
+    //? an address alone could be a new buffer where a stored one was freed.
+    const auto found = mIds.find(source.get());
+    if(found != mIds.end() && mChunks[found->second].resident.lock() == source){
+        id = found->second;
+        return true;
+    }
+
+    const uint64_t frames = (*source)[0].size();
+    for(uint8_t ch = 1; ch < mChannels; ++ch){
+        if((*source)[ch].size() != frames){
+            const std::string message = "Invalid audio buffers, a chunk of the table has channels of different lengths.\n";
+            handler.onError(error::Error::InvalidAudioLength, message);
+            return false;
+        }
+    }
+
+    Chunk chunk;
+    chunk.offset = mDataBytes;
+    chunk.stride = align_up(static_cast<size_t>(frames) * sizeof(float));
+    chunk.frames = frames;
+    chunk.levels = chunk.offset + mChannels * chunk.stride;
+    chunk.resident = source;
+
+    const size_t blocks = level_blocks(frames);
+    const dsp::kernels::AnalyzeFn analyze = dsp::kernels::table().analyze;
+    std::vector<dsp::kernels::Levels> levels(blocks);
+
+    bool written = true;
+    for(uint8_t ch = 0; ch < mChannels && written; ++ch){
+        const float *samples = (*source)[ch].data();
+        for(size_t b = 0; b < blocks; ++b){
+            const size_t offset = b * kLevelIndexBaseFrames;
+            levels[b] = analyze(samples + offset, std::min<size_t>(kLevelIndexBaseFrames, frames - offset));
+        }
+
+        written = utils::FileUtils::write_all(mData, samples, static_cast<size_t>(frames) * sizeof(float), chunk.offset + ch * chunk.stride)
+            && utils::FileUtils::write_all(mData, levels.data(), blocks * sizeof(dsp::kernels::Levels),
+                chunk.levels + ch * blocks * sizeof(dsp::kernels::Levels));
+    }
+
+    //* the file ends on a page boundary, the mapping never reaches past it.
+    const uint64_t end = align_up(static_cast<size_t>(chunk.levels) + mChannels * blocks * sizeof(dsp::kernels::Levels));
+    if(!written || !truncate_file(mData, end)){
+        const std::string message = "failed to write a chunk to the project " + mDirectory + ".\n";
+        handler.onError(error::Error::FileWriteError, message);
+        return false;
+    }
+
+    record(records, RecordType::Chunk, chunk_payload(chunk));
+
+    id = mChunks.size();
+    mIds[source.get()] = id;
+    mChunks.push_back(std::move(chunk));
+    mDataBytes = end;
+    return true;
+}
+
+bool AJ::editing::project::ProjectStore::store(const std::vector<piece_table::Piece> &pieces, std::vector<Piece> &out,
+    std::string &records, AJ::error::IErrorHandler &handler){
+
+    out.clear();
+    out.reserve(pieces.size());
+
+    for(const piece_table::Piece &piece : pieces){
+        uint64_t id = 0;
+        if(!store(piece.source, records, id, handler)){
+            return false;
+        }
+        out.push_back(Piece{ id, piece.offset, piece.frames });
+    }
+
+    return true;
+}
+
+void AJ::editing::project::ProjectStore::rollback(size_t chunks, uint64_t data) noexcept {
+    for(auto it = mIds.begin(); it != mIds.end(); ){
+        it = it->second >= chunks ? mIds.erase(it) : std::next(it);
+    }
+
+    mChunks.resize(chunks);
+    mDataBytes = data;
+    truncate_file(mData, data);
+}
+
+bool AJ::editing::project::ProjectStore::finish(size_t chunks, uint64_t data, const std::string &records,
+    AJ::error::IErrorHandler &handler){
+
+    if(records.empty()){
+        return true;
+    }
+
+    //* the journal only refers to samples that are on disk.
+    if(mChunks.size() > chunks && !sync_file(mData)){
+        rollback(chunks, data);
+        const std::string message = "failed to sync the sample file of the project " + mDirectory + ".\n";
+        handler.onError(error::Error::FileWriteError, message);
+        return false;
+    }
+
+    if(!append(records, handler)){
+        rollback(chunks, data);
+        return false;
+    }
+
+    return mChunks.size() == chunks || remap(handler);
+}
+
+bool AJ::editing::project::ProjectStore::stage(const piece_table::PieceTable &table, std::vector<Piece> &pieces,
+    std::string &records, AJ::error::IErrorHandler &handler){
+
+    if(!isOpen()){
+        const std::string message = "no project is open.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    if(table.channels() != mChannels){
+        const std::string message = "the piece table has " + std::to_string(table.channels())
+            + " channels, the project " + std::to_string(mChannels) + ".\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    if(!store(table.pieces(), pieces, records, handler)){
+        return false;
+    }
+
+    //? the same pieces (e.g. only the history changed) aren't recorded again.
+    if(pieces != mPieces){
+        std::string payload;
+        put_pieces(payload, pieces);
+        record(records, RecordType::Table, payload);
+    }
+
+    return true;
+}
+
+bool AJ::editing::project::ProjectStore::commit(const piece_table::PieceTable &table, AJ::error::IErrorHandler &handler){
+    const size_t chunks = mChunks.size();
+    const uint64_t data = mDataBytes;
+
+    std::vector<Piece> pieces;
+    std::string records;
+
+    if(!stage(table, pieces, records, handler)){
+        rollback(chunks, data);
+        return false;
+    }
+
+    if(!finish(chunks, data, records, handler)){
+        return false;
+    }
+
+    if(pieces != mPieces){
+        setTable(std::move(pieces));
+    }
+    return true;
+}
+
+bool AJ::editing::project::ProjectStore::commit(const std::shared_ptr<piece_table::PieceTable> &table,
+    undo::UndoSystem &history, AJ::error::IErrorHandler &handler){
+
+    if(!table){
+        const std::string message = "invalid piece table for the project.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    if(!history.load(handler)){
+        return false;
+    }
+
+    const size_t chunks = mChunks.size();
+    const uint64_t data = mDataBytes;
+
+    std::vector<Piece> pieces;
+    std::string records;
+
+    //* the changes on the table, a state with none left is someone else's.
+    auto convert = [&](const std::deque<undo::State> &states, std::vector<State> &out){
+        for(const undo::State &state : states){
+            State stored;
+            stored.label = state.label();
+
+            for(const undo::Change &change : state.changes()){
+                if(change.table.lock() != table){
+                    continue;
+                }
+
+                Change saved;
+                saved.start = change.start;
+                saved.removed = change.removed;
+                saved.inserted = change.inserted;
+
+                if(!store(change.saved.pieces(), saved.saved, records, handler)){
+                    return false;
+                }
+                stored.changes.push_back(std::move(saved));
+            }
+
+            if(!stored.changes.empty()){
+                out.push_back(std::move(stored));
+            }
+        }
+        return true;
+    };
+
+    std::vector<State> undo, redo;
+    if(!stage(*table, pieces, records, handler) || !convert(history.undoStates(), undo)
+        || !convert(history.redoStates(), redo)){
+        rollback(chunks, data);
+        return false;
+    }
+
+    const std::string payload = history_payload(undo, redo);
+    const bool changed = payload != history_payload(mUndo, mRedo);
+    if(changed){
+        record(records, RecordType::History, payload);
+    }
+
+    if(!finish(chunks, data, records, handler)){
+        return false;
+    }
+
+    if(pieces != mPieces){
+        setTable(std::move(pieces));
+    }
+    if(changed){
+        mUndo = std::move(undo);
+        mRedo = std::move(redo);
+    }
+    return true;
+}
+
+std::shared_ptr<const AJ::AudioBuffer> AJ::editing::project::ProjectStore::resident(uint64_t id){
+    Chunk &chunk = mChunks[id];
+    if(auto samples = chunk.resident.lock()){
+        return samples;
+    }
+
+    //* only the pages of this chunk are read.
+    auto samples = std::make_shared<AudioBuffer>();
+    for(uint8_t ch = 0; ch < mChannels; ++ch){
+        const float *plane = reinterpret_cast<const float*>(pMap + chunk.offset + ch * chunk.stride);
+        (*samples)[ch].assign(plane, plane + chunk.frames);
+    }
+
+    chunk.resident = samples;
+    mIds[samples.get()] = id;
+    return samples;
+}
+
+std::vector<AJ::editing::piece_table::Piece> AJ::editing::project::ProjectStore::restore(const std::vector<Piece> &pieces){
+    std::vector<piece_table::Piece> out;
+    out.reserve(pieces.size());
+
+    for(const Piece &piece : pieces){
+        out.push_back(piece_table::Piece{ resident(piece.chunk), static_cast<size_t>(piece.offset),
+            static_cast<size_t>(piece.frames) });
+    }
+    return out;
+}
+
+bool AJ::editing::project::ProjectStore::table(piece_table::PieceTable &out, AJ::error::IErrorHandler &handler){
+    if(!isOpen()){
+        const std::string message = "no project is open.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    return out.assign(restore(mPieces), mChannels, handler);
+}
+
+bool AJ::editing::project::ProjectStore::history(const std::shared_ptr<piece_table::PieceTable> &table,
+    undo::UndoSystem &out, AJ::error::IErrorHandler &handler){
+
+    if(!isOpen() || !table || table->channels() != mChannels){
+        const std::string message = "the history of a project needs its table, see table().\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    auto build = [&](const std::vector<State> &states, std::deque<undo::State> &restored){
+        for(const State &state : states){
+            undo::State undone(state.label);
+
+            for(const Change &change : state.changes){
+                undo::Change saved;
+                saved.table = table;
+                saved.start = change.start;
+                saved.removed = static_cast<size_t>(change.removed);
+                saved.inserted = static_cast<size_t>(change.inserted);
+                saved.channels = mChannels;
+
+                if(!saved.saved.assign(restore(change.saved), mChannels, handler)){
+                    return false;
+                }
+                undone.append(std::move(saved));
+            }
+
+            restored.push_back(std::move(undone));
+        }
+        return true;
+    };
+
+    std::deque<undo::State> undo, redo;
+    if(!build(mUndo, undo) || !build(mRedo, redo)){
+        return false;
+    }
+
+    out.assign(std::move(undo), std::move(redo), handler);
+    return true;
+}
+
+size_t AJ::editing::project::ProjectStore::locate(uint64_t frame) const noexcept {
+    return static_cast<size_t>(std::upper_bound(mStarts.begin(), mStarts.end(), frame) - mStarts.begin()) - 1;
+}
+
+size_t AJ::editing::project::ProjectStore::read(uint8_t channel, size_t start, size_t count, float *out) const {
+    if(channel >= mChannels || start >= mFrames){
+        return 0;
+    }
+
+    count = static_cast<size_t>(std::min<uint64_t>(count, mFrames - start));
+
+    size_t done = 0;
+    for(size_t index = locate(start); done < count; ++index){
+        const Piece &piece = mPieces[index];
+        const uint64_t within = start + done - mStarts[index];
+        const size_t frames = static_cast<size_t>(std::min<uint64_t>(count - done, piece.frames - within));
+
+        std::memcpy(out + done, samples(piece, channel) + within, frames * sizeof(float));
+        done += frames;
+    }
+
+    return count;
+}
+
+AJ::dsp::kernels::Levels AJ::editing::project::ProjectStore::levels(uint8_t channel, sample_pos start, sample_pos end) const {
+    dsp::kernels::Levels levels{FLT_MAX, -FLT_MAX, 0.0};
+    if(channel >= mChannels || start < 0 || end < start || static_cast<uint64_t>(end) >= mFrames){
+        return levels;
+    }
+
+    const dsp::kernels::AnalyzeFn analyze = dsp::kernels::table().analyze;
+    uint64_t position = static_cast<uint64_t>(start);
+    const uint64_t stop = static_cast<uint64_t>(end) + 1;
+
+    for(size_t index = locate(position); position < stop; ++index){
+        const Piece &piece = mPieces[index];
+        const Chunk &chunk = mChunks[piece.chunk];
+        const size_t count = level_blocks(chunk.frames);
+
+        const float *plane = reinterpret_cast<const float*>(pMap + chunk.offset + channel * chunk.stride);
+        const dsp::kernels::Levels *blocks = reinterpret_cast<const dsp::kernels::Levels*>(pMap + chunk.levels) + channel * count;
+
+        //* the range in the chunk: its whole blocks are stored, the samples of the partial ones are read.
+        uint64_t pos = piece.offset + (position - mStarts[index]);
+        const uint64_t last = piece.offset + std::min<uint64_t>(piece.frames, stop - mStarts[index]);
+        position += last - pos;
+
+        while(pos < last){
+            const uint64_t block = std::min<uint64_t>((pos / kLevelIndexBaseFrames + 1) * kLevelIndexBaseFrames, chunk.frames);
+            const uint64_t to = std::min(block, last);
+
+            levels = dsp::kernels::combine(levels, pos % kLevelIndexBaseFrames == 0 && to == block
+                ? blocks[pos / kLevelIndexBaseFrames] : analyze(plane + pos, static_cast<size_t>(to - pos)));
+            pos = to;
+        }
+    }
+
+    return levels;
+}
+
+const AJ::dsp::loudness::Measurement* AJ::editing::project::ProjectStore::loudness(sample_pos start, sample_pos end,
+    uint32_t samplerate) const {
+    for(const Loudness &entry : mLoudness){
+        if(entry.start == start && entry.end == end && entry.samplerate == samplerate){
+            return &entry.measurement;
+        }
+    }
+
+    return nullptr;
+}
+
+bool AJ::editing::project::ProjectStore::storeLoudness(sample_pos start, sample_pos end, uint32_t samplerate,
+    const dsp::loudness::Measurement &measurement, AJ::error::IErrorHandler &handler){
+
+    if(!isOpen()){
+        const std::string message = "no project is open.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    Loudness entry{ start, end, samplerate, measurement };
+    std::string records;
+    record(records, RecordType::Loudness, loudness_payload(entry));
+
+    if(!append(records, handler)){
+        return false;
+    }
+
+    remember(entry);
+    return true;
+}
+
+bool AJ::editing::project::ProjectStore::loadSeekIndex(const std::string &source, io::SeekIndex &index) const {
+    const auto found = mSeekIndices.find(source);
+    if(found == mSeekIndices.end()){
+        return false;
+    }
+
+    index = found->second;
+    return true;
+}
+
+bool AJ::editing::project::ProjectStore::storeSeekIndex(const std::string &source, const io::SeekIndex &index,
+    AJ::error::IErrorHandler &handler){
+
+    if(!isOpen()){
+        const std::string message = "no project is open.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    std::string records;
+    record(records, RecordType::SeekIndex, seek_payload(source, index));
+
+    if(!append(records, handler)){
+        return false;
+    }
+
+    mSeekIndices[source] = index;
+    return true;
+}
+
+std::string AJ::editing::project::ProjectStore::snapshot() const {
+    std::string records;
+    record(records, RecordType::Project, project_payload(mChannels, mSamplerate));
+
+    for(const Chunk &chunk : mChunks){
+        record(records, RecordType::Chunk, chunk_payload(chunk));
+    }
+
+    std::string pieces;
+    put_pieces(pieces, mPieces);
+    record(records, RecordType::Table, pieces);
+
+    if(!mUndo.empty() || !mRedo.empty()){
+        record(records, RecordType::History, history_payload(mUndo, mRedo));
+    }
+
+    //? after the table, which drops the measurements.
+    for(const Loudness &entry : mLoudness){
+        record(records, RecordType::Loudness, loudness_payload(entry));
+    }
+
+    for(const auto &[source, index] : mSeekIndices){
+        record(records, RecordType::SeekIndex, seek_payload(source, index));
+    }
+
+    return records;
+}
+
+bool AJ::editing::project::ProjectStore::compact(AJ::error::IErrorHandler &handler){
+    if(!isOpen()){
+        const std::string message = "no project is open.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    const std::string records = snapshot();
+    const std::string journal = file_path(mDirectory, kJournalName);
+    const std::string temp = journal + ".tmp";
+
+    //* written aside and renamed over the journal, a crash leaves one or the other.
+    std::error_code ec;
+    const int fd = open_file(temp, OpenMode::Truncate);
+    bool written = fd >= 0 && utils::FileUtils::write_all(fd, records.data(), records.size(), 0) && sync_file(fd);
+
+    if(written){
+        std::filesystem::rename(temp, journal, ec);
+        written = !ec;
+    }
+
+    if(!written){
+        if(fd >= 0) close_file(fd);
+        std::filesystem::remove(temp, ec);
+        const std::string message = "failed to compact the journal of the project " + mDirectory + ".\n";
+        handler.onError(error::Error::FileWriteError, message);
+        return false;
+    }
+
+    close_file(mJournal);
+    mJournal = fd;
+    mJournalBytes = records.size();
+    return true;
+}
@@ -0,0 +1,656 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <string>
+#include <tuple>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/memory.h"
+#include "core/trace.h"
+
+#include "editing/render_graph.h"
+
+namespace {
+
+size_t chunkBytes(const AJ::AudioSamples &samples, uint8_t channels){
+    return samples ? (*samples)[0].size() * channels * sizeof(float) : 0;
+}
+
+}
+
+bool AJ::editing::render_graph::RenderGraph::assign(AudioSamples audio, uint8_t channels,
+    AJ::error::IErrorHandler &handler){
+    if(channels < 1 || channels > kNumChannels){
+        const std::string message = "invalid channel count for the render graph.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    if(!audio){
+        const std::string message = "Invalid audio buffers.\n";
+        handler.onError(error::Error::InvalidAudioLength, message);
+        return false;
+    }
+
+    const size_t frames = (*audio)[0].size();
+    for(uint8_t ch = 1; ch < channels; ++ch){
+        if((*audio)[ch].size() != frames){
+            const std::string message = "Invalid audio buffers, the channels have different lengths.\n";
+            handler.onError(error::Error::InvalidAudioLength, message);
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMux);
+    pSource = std::move(audio);
+    mChannels = channels;
+    mFrames = frames;
+    mNodes.clear();
+    mCached = 0;
+
+    return true;
+}
+
+bool AJ::editing::render_graph::RenderGraph::configure(NodeData &data, AJ::Effect effect,
+    std::shared_ptr<dsp::EffectParams> params, AJ::error::IErrorHandler &handler){
+
+    if(mChannels == 0){
+        const std::string message = "the render graph is empty, use assign() first.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    const sample_pos start = params ? params->Start() : 0;
+    const sample_pos end = params ? params->End() : static_cast<sample_pos>(mFrames) - 1;
+
+    if(start < 0 || end < start || end >= static_cast<sample_pos>(mFrames)){
+        const std::string message =
+            "Invalid effect range. Expected 0 <= start <= end < frames. "
+            "Received start = " + std::to_string(start) +
+            ", end = " + std::to_string(end) +
+            ", frames = " + std::to_string(mFrames) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    //* the registry checks the parameters, the node gets an instance of its own: it's read from any thread.
+    dsp::Effect *checked = pEffects->acquire(effect, params, handler);
+    if(!checked){
+        return false;
+    }
+
+    std::unique_ptr<dsp::Effect> own = pEffects->create(effect);
+    if(!own || !own->setParams(params, handler)){
+        return false;
+    }
+    own->setThreadPool(pPool);
+
+    if(checked->supportsBlockProcessing()){
+        data.mode = checked->splitsRange() ? Mode::Chunked : Mode::Streamed;
+    } else {
+        data.mode = Mode::Whole;
+    }
+
+    data.node = Node{ effect, std::move(params), start, end };
+    data.effect = std::move(own);
+    data.state.reset();
+    data.next = 0;
+
+    return true;
+}
+
+bool AJ::editing::render_graph::RenderGraph::push(AJ::Effect effect, std::shared_ptr<dsp::EffectParams> params,
+    AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+
+    auto data = std::make_unique<NodeData>();
+    if(!configure(*data, effect, std::move(params), handler)){
+        return false;
+    }
+
+    mNodes.push_back(std::move(data));
+    return true;
+}
+
+bool AJ::editing::render_graph::RenderGraph::pop(AJ::error::IErrorHandler &handler){
+    std::lock_guard<std::mutex> lock(mMux);
+
+    if(mNodes.empty()){
+        const std::string message = "the render graph has no effect to remove.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    //* nothing reads the last node's chunks but the readers of the graph.
+    clearNode(*mNodes.back());
+    mNodes.pop_back();
+    return true;
+}
+
+bool AJ::editing::render_graph::RenderGraph::erase(size_t index, AJ::error::IErrorHandler &handler){
+    std::lock_guard<std::mutex> lock(mMux);
+
+    if(index >= mNodes.size()){
+        const std::string message = "no effect " + std::to_string(index) + " in the render graph, it has "
+            + std::to_string(mNodes.size()) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    const Node removed = mNodes[index]->node;
+    clearNode(*mNodes[index]);
+    mNodes.erase(mNodes.begin() + index);
+
+    invalidate(index, removed.start, removed.end);
+    return true;
+}
+
+bool AJ::editing::render_graph::RenderGraph::setParams(size_t index, std::shared_ptr<dsp::EffectParams> params,
+    AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+
+    if(index >= mNodes.size()){
+        const std::string message = "no effect " + std::to_string(index) + " in the render graph, it has "
+            + std::to_string(mNodes.size()) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    auto data = std::make_unique<NodeData>();
+    if(!configure(*data, mNodes[index]->node.effect, std::move(params), handler)){
+        return false;
+    }
+
+    //? both the old and the new range changed.
+    const sample_pos start = std::min(mNodes[index]->node.start, data->node.start);
+    const sample_pos end = std::max(mNodes[index]->node.end, data->node.end);
+
+    clearNode(*mNodes[index]);
+    mNodes[index] = std::move(data);
+
+    invalidate(index + 1, start, end);
+    return true;
+}
+
+void AJ::editing::render_graph::RenderGraph::setThreadPool(std::shared_ptr<utils::ThreadPool> pool){
+    std::lock_guard<std::mutex> lock(mMux);
+
+    pPool = std::move(pool);
+    for(auto &data : mNodes){
+        data->effect->setThreadPool(pPool);
+    }
+}
+
+std::vector<AJ::editing::render_graph::Node> AJ::editing::render_graph::RenderGraph::nodes() const {
+    std::lock_guard<std::mutex> lock(mMux);
+
+    std::vector<Node> nodes;
+    nodes.reserve(mNodes.size());
+    for(const auto &data : mNodes){
+        nodes.push_back(data->node);
+    }
+    return nodes;
+}
+
+size_t AJ::editing::render_graph::RenderGraph::size() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mNodes.size();
+}
+
+size_t AJ::editing::render_graph::RenderGraph::frames() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mFrames;
+}
+
+uint8_t AJ::editing::render_graph::RenderGraph::channels() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mChannels;
+}
+
+void AJ::editing::render_graph::RenderGraph::clearNode(NodeData &data){
+    for(const auto &[index, chunk] : data.chunks){
+        mCached -= chunkBytes(chunk.samples, mChannels);
+    }
+
+    data.chunks.clear();
+    data.state.reset();
+}
+
+void AJ::editing::render_graph::RenderGraph::invalidate(size_t from, sample_pos start, sample_pos end){
+    for(size_t index = from; index < mNodes.size(); ++index){
+        NodeData &data = *mNodes[index];
+
+        //? frames outside of a node's range pass through, it holds nothing for them.
+        if(end < data.node.start || start > data.node.end){
+            continue;
+        }
+
+        if(data.mode == Mode::Whole){
+            //* the whole range was computed at once, all of it can change.
+            clearNode(data);
+            start = std::min(start, data.node.start);
+            end = std::max(end, data.node.end);
+            continue;
+        }
+
+        size_t first = static_cast<size_t>(std::max(start, data.node.start)) / kRenderChunkFrames;
+        size_t last = static_cast<size_t>(end) / kRenderChunkFrames;
+
+        if(data.mode == Mode::Streamed){
+            //* the memory of the effect carries the change up to the end of its range.
+            last = static_cast<size_t>(data.node.end) / kRenderChunkFrames;
+            end = std::max(end, data.node.end);
+            data.state.reset();
+        }
+
+        for(size_t chunk = first; chunk <= last; ++chunk){
+            auto it = data.chunks.find(chunk);
+            if(it != data.chunks.end()){
+                mCached -= chunkBytes(it->second.samples, mChannels);
+                data.chunks.erase(it);
+            }
+        }
+    }
+}
+
+AJ::AudioSamples AJ::editing::render_graph::RenderGraph::copyChunk(const float *const *input, size_t frames) const {
+    auto samples = std::make_shared<AudioBuffer>();
+    for(uint8_t ch = 0; ch < mChannels; ++ch){
+        (*samples)[ch].assign(input[ch], input[ch] + frames);
+    }
+    return samples;
+}
+
+void AJ::editing::render_graph::RenderGraph::store(NodeData &data, size_t chunk, AudioSamples samples){
+    Chunk &entry = data.chunks[chunk];
+    mCached -= chunkBytes(entry.samples, mChannels);
+    mCached += chunkBytes(samples, mChannels);
+
+    entry.samples = std::move(samples);
+    entry.used = ++mTick;
+}
+
+bool AJ::editing::render_graph::RenderGraph::processBlock(NodeData &data, AudioBuffer &samples, size_t frames,
+    sample_pos position, AJ::error::IErrorHandler &handler){
+
+    if(!data.state){
+        data.state = data.effect->createState(mChannels, handler);
+        if(!data.state){
+            return false;
+        }
+        data.state->seek(position);
+    }
+
+    if(mChannels == 1){
+        return data.effect->processBlock(samples[0].data(), frames, 1, *data.state, handler);
+    }
+
+    //* processBlock() takes interleaved frames, one chunk of scratch for every node.
+    mInterleaved.resize(2 * kRenderChunkFrames);
+    const dsp::kernels::KernelTable &kernels = dsp::kernels::table();
+    kernels.interleave(samples[0].data(), samples[1].data(), mInterleaved.data(), frames);
+
+    if(!data.effect->processBlock(mInterleaved.data(), frames, 2, *data.state, handler)){
+        return false;
+    }
+
+    kernels.deinterleave(mInterleaved.data(), samples[0].data(), samples[1].data(), frames);
+    return true;
+}
+
+bool AJ::editing::render_graph::RenderGraph::computeChunked(size_t index, size_t chunk,
+    AJ::error::IErrorHandler &handler){
+
+    NodeData &data = *mNodes[index];
+    const float *input[kNumChannels] = {};
+    if(!pull(index, chunk, input, handler)){
+        return false;
+    }
+
+    const size_t frames = chunkFrames(chunk);
+    AudioSamples samples = copyChunk(input, frames);
+
+    //? without memory a chunk only needs the stream position it starts at.
+    const sample_pos position = static_cast<sample_pos>(chunk * kRenderChunkFrames);
+    if(data.state){
+        data.state->seek(position);
+    }
+
+    if(!processBlock(data, *samples, frames, position, handler)){
+        return false;
+    }
+
+    store(data, chunk, std::move(samples));
+    return true;
+}
+
+bool AJ::editing::render_graph::RenderGraph::computeStreamed(size_t index, size_t chunk,
+    AJ::error::IErrorHandler &handler){
+
+    NodeData &data = *mNodes[index];
+
+    //* the state continues from `next`, a chunk before it (evicted or invalidated) restarts the range.
+    if(!data.state || data.next > chunk){
+        data.state.reset();
+        data.next = static_cast<size_t>(data.node.start) / kRenderChunkFrames;
+    }
+
+    for(; data.next <= chunk; ++data.next){
+        const float *input[kNumChannels] = {};
+        if(!pull(index, data.next, input, handler)){
+            data.state.reset();
+            return false;
+        }
+
+        const size_t frames = chunkFrames(data.next);
+        AudioSamples samples = copyChunk(input, frames);
+
+        if(!processBlock(data, *samples, frames, static_cast<sample_pos>(data.next * kRenderChunkFrames), handler)){
+            data.state.reset();
+            return false;
+        }
+
+        store(data, data.next, std::move(samples));
+    }
+
+    return true;
+}
+
+bool AJ::editing::render_graph::RenderGraph::computeWhole(size_t index, AJ::error::IErrorHandler &handler){
+    NodeData &data = *mNodes[index];
+    const size_t start = static_cast<size_t>(data.node.start);
+    const size_t end = static_cast<size_t>(data.node.end);
+    const size_t first = start / kRenderChunkFrames, last = end / kRenderChunkFrames;
+
+    //? the effect addresses [Start, End] of whole channels: the frames before Start are silence (Float doesn't zero on resize).
+    AudioBuffer whole;
+    for(uint8_t ch = 0; ch < mChannels; ++ch){
+        whole[ch].resize(end + 1);
+        std::fill(whole[ch].begin(), whole[ch].begin() + start, 0.0f);
+    }
+
+    std::vector<AudioSamples> chunks;
+    chunks.reserve(last - first + 1);
+
+    for(size_t chunk = first; chunk <= last; ++chunk){
+        const float *input[kNumChannels] = {};
+        if(!pull(index, chunk, input, handler)){
+            return false;
+        }
+
+        chunks.push_back(copyChunk(input, chunkFrames(chunk)));
+
+        const size_t from = std::max(start, chunk * kRenderChunkFrames);
+        const size_t to = std::min(end + 1, chunk * kRenderChunkFrames + chunkFrames(chunk));
+        for(uint8_t ch = 0; ch < mChannels; ++ch){
+            std::memcpy(whole[ch].data() + from, (*chunks.back())[ch].data() + (from - chunk * kRenderChunkFrames),
+                (to - from) * sizeof(float));
+        }
+    }
+
+    {
+        AJ_TRACE_ZONE("dsp", "render_whole");
+        const utils::MemoryScope memory(utils::Subsystem::Dsp);
+        if(!data.effect->process(whole, mChannels, handler)){
+            return false;
+        }
+    }
+
+    for(size_t chunk = first; chunk <= last; ++chunk){
+        AudioSamples &samples = chunks[chunk - first];
+        const size_t from = std::max(start, chunk * kRenderChunkFrames);
+        const size_t to = std::min(end + 1, chunk * kRenderChunkFrames + chunkFrames(chunk));
+
+        for(uint8_t ch = 0; ch < mChannels; ++ch){
+            std::memcpy((*samples)[ch].data() + (from - chunk * kRenderChunkFrames), whole[ch].data() + from,
+                (to - from) * sizeof(float));
+        }
+
+        store(data, chunk, std::move(samples));
+    }
+
+    return true;
+}
+
+bool AJ::editing::render_graph::RenderGraph::pull(size_t depth, size_t chunk, const float *(&out)[kNumChannels],
+    AJ::error::IErrorHandler &handler){
+
+    const size_t position = chunk * kRenderChunkFrames;
+
+    if(depth == 0){
+        for(uint8_t ch = 0; ch < mChannels; ++ch){
+            out[ch] = (*pSource)[ch].data() + position;
+        }
+        return true;
+    }
+
+    NodeData &data = *mNodes[depth - 1];
+    const sample_pos first = static_cast<sample_pos>(position);
+    const sample_pos last = first + static_cast<sample_pos>(chunkFrames(chunk)) - 1;
+
+    if(last < data.node.start || first > data.node.end){
+        return pull(depth - 1, chunk, out, handler);
+    }
+
+    auto it = data.chunks.find(chunk);
+    if(it == data.chunks.end()){
+        bool computed = false;
+        switch(data.mode){
+            case Mode::Chunked: computed = computeChunked(depth - 1, chunk, handler); break;
+            case Mode::Streamed: computed = computeStreamed(depth - 1, chunk, handler); break;
+            case Mode::Whole: computed = computeWhole(depth - 1, handler); break;
+        }
+
+        if(!computed){
+            return false;
+        }
+        it = data.chunks.find(chunk);
+    }
+
+    it->second.used = ++mTick;
+    for(uint8_t ch = 0; ch < mChannels; ++ch){
+        out[ch] = (*it->second.samples)[ch].data();
+    }
+    return true;
+}
+
+void AJ::editing::render_graph::RenderGraph::evict(){
+    if(mCached <= mBudget){
+        return;
+    }
+
+    std::vector<std::tuple<uint64_t, NodeData*, size_t>> entries;
+    for(auto &data : mNodes){
+        for(const auto &[index, chunk] : data->chunks){
+            entries.emplace_back(chunk.used, data.get(), index);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b){
+        return std::get<0>(a) < std::get<0>(b);
+    });
+
+    //? down to 3/4 of the budget, so a graph at its limit doesn't evict on every read.
+    const size_t target = mBudget / 4 * 3;
+    for(const auto &[used, data, index] : entries){
+        if(mCached <= target){
+            break;
+        }
+
+        auto it = data->chunks.find(index);
+        mCached -= chunkBytes(it->second.samples, mChannels);
+        data->chunks.erase(it);
+    }
+}
+
+bool AJ::editing::render_graph::RenderGraph::readLocked(size_t start, size_t count, float *const *out,
+    AJ::error::IErrorHandler &handler){
+
+    if(mChannels == 0 || start + count > mFrames || start + count < start){
+        const std::string message = "Invalid render range. Expected start + count <= frames. "
+            "Received start = " + std::to_string(start) + ", count = " + std::to_string(count)
+            + ", frames = " + std::to_string(mFrames) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    AJ_TRACE_ZONE("editing", "render_read");
+    const utils::MemoryScope memory(utils::Subsystem::Editing);
+
+    size_t done = 0;
+    bool success = true;
+
+    while(done < count){
+        const size_t position = start + done;
+        const size_t chunk = position / kRenderChunkFrames;
+        const size_t within = position - chunk * kRenderChunkFrames;
+        const size_t frames = std::min(count - done, chunkFrames(chunk) - within);
+
+        const float *samples[kNumChannels] = {};
+        if(!pull(mNodes.size(), chunk, samples, handler)){
+            success = false;
+            break;
+        }
+
+        for(uint8_t ch = 0; ch < mChannels; ++ch){
+            if(out[ch]){
+                std::memcpy(out[ch] + done, samples[ch] + within, frames * sizeof(float));
+            }
+        }
+        done += frames;
+    }
+
+    //* only once the frames are copied: the pointers of pull() die with their chunks.
+    evict();
+    return success;
+}
+
+bool AJ::editing::render_graph::RenderGraph::read(uint8_t channel, size_t start, size_t count, float *out,
+    AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+
+    if(channel >= mChannels || !out){
+        const std::string message = "invalid channel " + std::to_string(channel) + " of the render graph.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    float *outs[kNumChannels] = {};
+    outs[channel] = out;
+    return readLocked(start, count, outs, handler);
+}
+
+bool AJ::editing::render_graph::RenderGraph::read(size_t start, size_t count, float *const *out,
+    AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+    return readLocked(start, count, out, handler);
+}
+
+bool AJ::editing::render_graph::RenderGraph::levels(uint8_t channel, sample_pos start, sample_pos end,
+    dsp::kernels::Levels &levels, AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+
+    if(channel >= mChannels){
+        const std::string message = "invalid channel " + std::to_string(channel) + " of the render graph.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    if(start < 0 || end < start || end >= static_cast<sample_pos>(mFrames)){
+        const std::string message =
+            "Invalid range. Expected 0 <= start <= end < frames. "
+            "Received start = " + std::to_string(start) +
+            ", end = " + std::to_string(end) +
+            ", frames = " + std::to_string(mFrames) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    //* chunk by chunk, the chunks read stay cached for the next query or playback.
+    const dsp::kernels::AnalyzeFn analyze = dsp::kernels::table().analyze;
+    levels = dsp::kernels::Levels{ FLT_MAX, -FLT_MAX, 0.0 };
+
+    size_t position = static_cast<size_t>(start);
+    const size_t stop = static_cast<size_t>(end) + 1;
+    bool success = true;
+
+    while(position < stop){
+        const size_t chunk = position / kRenderChunkFrames;
+        const size_t within = position - chunk * kRenderChunkFrames;
+        const size_t frames = std::min(stop - position, chunkFrames(chunk) - within);
+
+        const float *samples[kNumChannels] = {};
+        if(!pull(mNodes.size(), chunk, samples, handler)){
+            success = false;
+            break;
+        }
+
+        levels = dsp::kernels::combine(levels, analyze(samples[channel] + within, frames));
+        position += frames;
+    }
+
+    evict();
+    return success;
+}
+
+bool AJ::editing::render_graph::RenderGraph::flatten(io::AudioFile &file, AJ::error::IErrorHandler &handler){
+    std::unique_lock<std::mutex> lock(mMux);
+
+    if(file.mInfo.channels != mChannels){
+        const std::string message = "the file has " + std::to_string(file.mInfo.channels)
+            + " channels, the render graph " + std::to_string(mChannels) + ".\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    if(file.storage() != io::SampleStorage::Float32){
+        const std::string message = "the samples must be in Float32 storage to be rendered into.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    //? a new buffer: the source may be the file's own samples.
+    auto audio = std::make_shared<AudioBuffer>();
+    float *outs[kNumChannels] = {};
+    for(uint8_t ch = 0; ch < mChannels; ++ch){
+        (*audio)[ch].resize(mFrames);
+        outs[ch] = (*audio)[ch].data();
+    }
+
+    if(!readLocked(0, mFrames, outs, handler)){
+        return false;
+    }
+
+    const size_t length = mFrames * mChannels;
+    lock.unlock();
+
+    file.pAudio = std::move(audio);
+    file.mInfo.length = length;
+    file.updateLevelIndex(0);
+
+    return true;
+}
+
+size_t AJ::editing::render_graph::RenderGraph::cachedBytes() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mCached;
+}
+
+void AJ::editing::render_graph::RenderGraph::setCacheBudget(size_t bytes){
+    std::lock_guard<std::mutex> lock(mMux);
+    mBudget = bytes;
+    evict();
+}
+
+void AJ::editing::render_graph::RenderGraph::clearCache(){
+    std::lock_guard<std::mutex> lock(mMux);
+    for(auto &data : mNodes){
+        clearNode(*data);
+    }
+}
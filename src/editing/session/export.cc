@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <sndfile.h>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/memory.h"
+#include "core/scratch_arena.h"
+#include "dsp/kernels.h"
+
+#include "editing/session/export.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double since(Clock::time_point begin){
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+/**
+ * @brief Next buffer of `queue`, waiting for one; nullptr once `done` is set and the queue is drained.
+ */
+AJ::utils::Buffer* next(AJ::utils::Queue &queue, const AJ::LFControlFlag &done){
+    while(true){
+        if(AJ::utils::Buffer *buffer = queue.pop()){
+            return buffer;
+        }
+
+        //? the producer queued its last buffer before setting `done`.
+        if(done.flag.load(std::memory_order_acquire)){
+            return queue.pop();
+        }
+
+        queue.wait(1, AJ::kStreamerWakeTimeout);
+    }
+}
+
+/**
+ * @brief libsndfile format of a WAV / FLAC export, 0 if the bit depth isn't supported.
+ */
+int fileFormat(AJ::editing::session::ExportFormat format, AJ::BitDepth_t bitdepth){
+    const bool flac = format == AJ::editing::session::ExportFormat::Flac;
+    const int container = flac ? SF_FORMAT_FLAC : SF_FORMAT_WAV;
+
+    switch(bitdepth){
+    case AJ::BitDepth_t::int_16:
+        return container | SF_FORMAT_PCM_16;
+    case AJ::BitDepth_t::int_24:
+        return container | SF_FORMAT_PCM_24;
+    case AJ::BitDepth_t::int_32:
+        return flac ? 0 : container | SF_FORMAT_PCM_32;
+    case AJ::BitDepth_t::float_32:
+        return flac ? 0 : container | SF_FORMAT_FLOAT;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Convert stage: blocks of float samples to the integers of the file, in place.
+ *
+ * Samples are rounded at the file's bit depth (with TPDF dither) and left aligned in an int32,
+ * so libsndfile's int writer only drops the zero low bits.
+ */
+class Converter {
+    bool mInteger = false;
+    float mScale = 0.0f;
+    uint32_t mShift = 0;
+    bool mDither = false;
+    uint32_t mState = 0x2545F491u;
+
+public:
+    Converter(AJ::BitDepth_t bitdepth, bool dither) : mDither(dither) {
+        const uint32_t bits = bitdepth == AJ::BitDepth_t::int_16 ? 16 : (bitdepth == AJ::BitDepth_t::int_24 ? 24 : 32);
+        mInteger = bitdepth != AJ::BitDepth_t::float_32;
+        mScale = static_cast<float>((1u << (bits - 1)) - 1u);
+        mShift = 32 - bits;
+    }
+
+    bool integer() const noexcept {
+        return mInteger;
+    }
+
+    void operator()(float *data, size_t samples){
+        if(!mInteger || samples == 0){
+            return;
+        }
+
+        AJ::utils::ScratchScope scope;
+        float *noise = nullptr;
+        if(mDither){
+            noise = scope.arena().array<float>(samples);
+            AJ::dsp::kernels::ditherTPDF(noise, samples, mState);
+        }
+
+        int32_t *out = reinterpret_cast<int32_t*>(data);
+        AJ::dsp::kernels::table().toInt32(data, out, samples, mScale, noise);
+
+        if(mShift > 0){
+            for(size_t i = 0; i < samples; ++i){
+                out[i] = static_cast<int32_t>(static_cast<uint32_t>(out[i]) << mShift);
+            }
+        }
+    }
+};
+
+}
+
+bool AJ::editing::session::Exporter::run(const std::string &path, const ExportOptions &options,
+    AJ::error::IErrorHandler &handler){
+
+    const utils::MemoryScope memory(utils::Subsystem::Editing);
+
+    mStats = ExportStats{};
+    const Clock::time_point begin = Clock::now();
+
+    const sample_c start = options.start;
+    const sample_c end = options.frames > 0 ? start + options.frames : mSession.length();
+    if(start >= end){
+        const std::string message = "nothing to export: frames [" + std::to_string(start) + ", "
+            + std::to_string(end) + ") of a session of " + std::to_string(mSession.length()) + " frames.\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    const bool mp3 = options.format == ExportFormat::Mp3;
+    const int format = mp3 ? 0 : fileFormat(options.format, options.bitdepth);
+    if(!mp3 && format == 0){
+        const std::string message = "unsupported bit depth, WAV exports are 16, 24, 32-bit or float and FLAC exports 16 or 24-bit.\n";
+        handler.onError(error::Error::InvalidBitDepth, message);
+        return false;
+    }
+
+    Mixer &mixer = mSession.mixer();
+    const size_t block = mixer.blockFrames();
+    const size_t inflight = std::max<size_t>(options.inflightBlocks, 1);
+    std::shared_ptr<utils::ThreadPool> threads = mSession.threadPool();
+
+    auto pool = std::make_shared<utils::BufferPool>(handler, inflight, block, 2);
+    auto rendered = std::make_shared<utils::Queue>(true, inflight, block, 2, handler);
+    if(!pool->isValid() || !rendered->isValid()){
+        return false;
+    }
+
+    auto renderDone = std::make_shared<LFControlFlag>();
+    std::atomic<bool> failed{false};
+    error::CollectingErrorHandler renderErrors; // the handler isn't required to be thread-safe.
+
+    //? the tracks of a block are rendered on `mixThreads`. A parallel_for helps with pending pool
+    //? tasks: it must not start a stage that waits on the render stage itself.
+    utils::ThreadPool *mixThreads = threads.get();
+    std::atomic<bool> stagesStarted{true};
+
+    //* render stage: mix every block into a free pool buffer and queue it. A failed block is
+    //* queued empty, only the writer gives buffers back to the pool (single producer).
+    auto render = [&]{
+        while(!stagesStarted.load(std::memory_order_acquire)){
+            std::this_thread::yield();
+        }
+
+        for(sample_c position = start; position < end && !failed.load(std::memory_order_acquire); ){
+            utils::Buffer *buffer = pool->tryPop();
+            if(!buffer){
+                pool->wait(1, kStreamerWakeTimeout);
+                continue;
+            }
+
+            const size_t count = std::min<sample_c>(block, end - position);
+            const Clock::time_point t = Clock::now();
+            const bool ok = mixer.mix(buffer->data, position, count, mixThreads, renderErrors);
+            mStats.render += since(t);
+
+            buffer->frames = ok ? count : 0;
+            rendered->push(buffer);
+
+            if(!ok){
+                failed.store(true, std::memory_order_release);
+                break;
+            }
+
+            ++mStats.blocks;
+            position += count;
+        }
+
+        renderDone->flag.store(true, std::memory_order_release);
+        rendered->wake();
+    };
+
+    bool success = true;
+
+    if(mp3){
+        io::Mp3StreamOptions mp3Options = options.mp3;
+        mp3Options.inputSamplerate = 0;
+        mp3Options.planar = false;
+
+        io::Mp3StreamEncoder encoder;
+        if(!encoder.open(path, 2, static_cast<uint32_t>(mSession.samplerate()), mp3Options, handler)){
+            return false;
+        }
+
+        //? the encoder pipelines its own two stages, the render stage needs a third worker.
+        mStats.pipelined = threads && threads->available() >= 3;
+
+        const Clock::time_point t = Clock::now();
+        if(mStats.pipelined){
+            //? the encoder's stages are queued after the render stage started: its tracks render serially.
+            mixThreads = nullptr;
+            std::future<void> renderer = threads->enqueue(render);
+            success = encoder.run(rendered, pool, renderDone, threads, handler);
+            if(!success){
+                failed.store(true, std::memory_order_release);
+            }
+
+            //? once the encoder stopped, nobody gives the buffers back: drain the queue for the render stage.
+            while(renderer.wait_for(kStreamerWakeTimeout) != std::future_status::ready){
+                while(utils::Buffer *buffer = rendered->pop()){
+                    pool->push(buffer, handler);
+                }
+            }
+            mStats.convert = since(t);
+        } else {
+            for(sample_c position = start; position < end && success; position += block){
+                utils::Buffer *buffer = pool->tryPop();
+                const size_t count = std::min<sample_c>(block, end - position);
+
+                const Clock::time_point r = Clock::now();
+                success = mixer.mix(buffer->data, position, count, threads.get(), renderErrors);
+                mStats.render += since(r);
+
+                const Clock::time_point c = Clock::now();
+                success = success && encoder.append(buffer->data, count, handler);
+                mStats.convert += since(c);
+
+                pool->push(buffer, handler);
+                mStats.blocks += success ? 1 : 0;
+            }
+        }
+
+        success = encoder.close(handler) && success;
+        renderErrors.replay(handler);
+        mStats.total = since(begin);
+        return success && !renderErrors.hasErrors();
+    }
+
+    SF_INFO info = {};
+    info.channels = 2;
+    info.samplerate = static_cast<int>(mSession.samplerate());
+    info.format = format;
+
+    SNDFILE *file = sf_open(path.c_str(), SFM_WRITE, &info);
+    if(!file){
+        const std::string message = "Error: Couldn't create file at: " + path + "\n";
+        handler.onError(error::Error::FileOpenError, message);
+        return false;
+    }
+
+    Converter convert(options.bitdepth, options.dither);
+
+    //* write stage: libsndfile packs (and for FLAC encodes) the converted samples.
+    auto write = [&](utils::Buffer *buffer){
+        const Clock::time_point t = Clock::now();
+        const sf_count_t frames = static_cast<sf_count_t>(buffer->frames);
+        const sf_count_t written = convert.integer()
+            ? sf_writef_int(file, reinterpret_cast<const int*>(buffer->data), frames)
+            : sf_writef_float(file, buffer->data, frames);
+        mStats.write += since(t);
+
+        if(written != frames){
+            const std::string message = "Error: failed to write audio samples to file " + path + "\n";
+            handler.onError(error::Error::FileWriteError, message);
+            return false;
+        }
+
+        return true;
+    };
+
+    mStats.pipelined = threads && threads->available() >= 2;
+
+    if(mStats.pipelined){
+        auto converted = std::make_shared<utils::Queue>(true, inflight, block, 2, handler);
+        if(!converted->isValid()){
+            sf_close(file);
+            return false;
+        }
+
+        auto convertDone = std::make_shared<LFControlFlag>();
+
+        //* convert stage: in place, between the two queues.
+        auto converter = [&]{
+            stagesStarted.store(true, std::memory_order_release);
+
+            while(utils::Buffer *buffer = next(*rendered, *renderDone)){
+                if(!failed.load(std::memory_order_acquire)){
+                    const Clock::time_point t = Clock::now();
+                    convert(buffer->data, 2 * buffer->frames);
+                    mStats.convert += since(t);
+                }
+
+                converted->push(buffer);
+            }
+
+            convertDone->flag.store(true, std::memory_order_release);
+            converted->wake();
+        };
+
+        //? the render stage starts mixing once the convert stage runs on its own worker.
+        stagesStarted.store(false, std::memory_order_relaxed);
+        std::future<void> conversion = threads->enqueue(converter);
+        std::future<void> renderer = threads->enqueue(render);
+
+        while(utils::Buffer *buffer = next(*converted, *convertDone)){
+            if(!failed.load(std::memory_order_acquire) && !write(buffer)){
+                failed.store(true, std::memory_order_release);
+            }
+
+            pool->push(buffer, handler);
+        }
+
+        renderer.wait();
+        conversion.wait();
+    } else {
+        for(sample_c position = start; position < end && !failed.load(std::memory_order_relaxed); position += block){
+            utils::Buffer *buffer = pool->tryPop();
+            const size_t count = std::min<sample_c>(block, end - position);
+
+            const Clock::time_point r = Clock::now();
+            const bool ok = mixer.mix(buffer->data, position, count, threads.get(), renderErrors);
+            mStats.render += since(r);
+            buffer->frames = count;
+            mStats.blocks += ok ? 1 : 0;
+
+            if(ok){
+                const Clock::time_point c = Clock::now();
+                convert(buffer->data, 2 * count);
+                mStats.convert += since(c);
+            }
+
+            if(!ok || !write(buffer)){
+                failed.store(true, std::memory_order_relaxed);
+            }
+
+            pool->push(buffer, handler);
+        }
+    }
+
+    renderErrors.replay(handler);
+    success = !failed.load(std::memory_order_acquire);
+
+    if(sf_close(file) != 0){
+        const std::string message = "Failed to close audio file. Resource may still be in use.\n";
+        handler.onError(error::Error::FileClosingError, message);
+        success = false;
+    }
+
+    mStats.total = since(begin);
+    return success;
+}
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/realtime.h"
+#include "core/scratch_arena.h"
+#include "dsp/kernels.h"
+
+#include "editing/session/mixer.h"
+
+namespace {
+
+//* one revision for every chain of every track: equal clips on two tracks never share a key.
+uint64_t next_revision(){
+    static std::atomic<uint64_t> revision{ 0 };
+    return revision.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+}
+
+AJ::editing::session::Track::Track() : mChainRevision(next_revision()) {}
+
+void AJ::editing::session::Track::newRevision() noexcept {
+    mChainRevision = next_revision();
+    mNext = kNoBlock;
+}
+
+bool AJ::editing::session::Track::chainChanged(AJ::error::IErrorHandler &handler){
+    if(pChain){
+        std::unique_ptr<dsp::EffectState> state = pChain->createState(2, handler);
+        if(!state){
+            return false;
+        }
+        pChainState = std::move(state);
+    }
+
+    newRevision();
+    return true;
+}
+
+bool AJ::editing::session::Track::memoryless() const {
+    for(size_t i = 0; i < pChain->size(); ++i){
+        if(!pChain->at(i)->splitsRange()){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AJ::editing::session::Track::setChain(std::shared_ptr<dsp::EffectChain> chain, AJ::error::IErrorHandler &handler){
+    if(!chain){
+        pChain.reset();
+        pChainState.reset();
+        newRevision();
+        return true;
+    }
+
+    if(!chain->supportsBlockProcessing()){
+        const std::string message = "a track chain must support block processing, every stage runs on the track's blocks.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    std::unique_ptr<dsp::EffectState> state = chain->createState(2, handler);
+    if(!state){
+        return false;
+    }
+
+    pChain = std::move(chain);
+    pChainState = std::move(state);
+    newRevision();
+    return true;
+}
+
+void AJ::editing::session::Track::sideGains(float &left, float &right) const noexcept {
+    const float angle = (mPan + 1.0f) * static_cast<float>(M_PI) / 4.0f;
+    left = mGain * std::cos(angle);
+    right = mGain * std::sin(angle);
+}
+
+bool AJ::editing::session::Track::warmUp(sample_c position, size_t frames, AJ::error::IErrorHandler &handler){
+    utils::ScratchScope scope;
+    float *block = scope.arena().array<float>(2 * frames);
+
+    pChainState->seek(static_cast<sample_pos>(mOrigin));
+    for(sample_c at = mOrigin; at < position; at += frames){
+        const size_t count = std::min<size_t>(frames, position - at);
+
+        std::fill(block, block + 2 * count, 0.0f);
+        mTimeLine.mix(block, at, count);
+        if(!pChain->processBlock(block, count, 2, *pChainState, handler)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AJ::editing::session::Track::render(float *out, sample_c position, size_t frames, AJ::error::IErrorHandler &handler,
+    RenderCache *cache){
+    //* reverb and echo tails of the chain decay into denormals, on the pool thread or the player's.
+    const AJ::utils::DenormalScope denormals;
+
+    std::fill(out, out + 2 * frames, 0.0f);
+    mTimeLine.mix(out, position, frames);
+
+    if(!pChain){
+        return true;
+    }
+
+    if(!cache || !mCached){
+        mNext = kNoBlock;
+        if(pChainState->position() != static_cast<sample_pos>(position)){
+            pChainState->seek(static_cast<sample_pos>(position));
+        }
+
+        return pChain->processBlock(out, frames, 2, *pChainState, handler);
+    }
+
+    //* a jump starts a new stream, the state restarts there whatever it held.
+    if(position != mNext){
+        mOrigin = position;
+        mStreamKey = RenderCache::combine(0, position);
+        pChainState->seek(static_cast<sample_pos>(position));
+    }
+
+    //? with memory the block depends on every block since the origin, their keys are chained.
+    uint64_t key = RenderCache::hash(out, 2 * frames, mChainRevision);
+    key = RenderCache::combine(key, position);
+    if(!memoryless()){
+        key = RenderCache::combine(key, mStreamKey);
+    }
+    mStreamKey = key;
+    mNext = position + frames;
+
+    if(cache->find(key, out, frames, handler)){
+        return true;
+    }
+
+    if(pChainState->position() != static_cast<sample_pos>(position)){
+        if(memoryless()){
+            pChainState->seek(static_cast<sample_pos>(position));
+        } else if(!warmUp(position, frames, handler)){
+            return false;
+        }
+    }
+
+    if(!pChain->processBlock(out, frames, 2, *pChainState, handler)){
+        return false;
+    }
+
+    cache->store(key, out, frames, handler);
+    return true;
+}
+
+AJ::editing::session::Mixer::Mixer(AJ::error::IErrorHandler &handler, size_t max_tracks, size_t block_frames) :
+    mMaxTracks(max_tracks == 0 ? kMixMaxTracks : max_tracks),
+    mBlockFrames(block_frames == 0 ? kMixBlockFrames : block_frames),
+    mPool(handler, mMaxTracks, mBlockFrames, 2) {
+
+    mTracks.reserve(mMaxTracks);
+    mSlots.reserve(mMaxTracks);
+    mErrors.resize(mMaxTracks);
+    mSucceeded.resize(mMaxTracks);
+}
+
+std::shared_ptr<AJ::editing::session::Track> AJ::editing::session::Mixer::addTrack(AJ::error::IErrorHandler &handler){
+    if(mTracks.size() >= mMaxTracks){
+        const std::string message = "the mixer is full (" + std::to_string(mMaxTracks) + " tracks).\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return nullptr;
+    }
+
+    mTracks.push_back(std::make_shared<Track>());
+    return mTracks.back();
+}
+
+bool AJ::editing::session::Mixer::removeTrack(const std::shared_ptr<Track> &track){
+    auto it = std::find(mTracks.begin(), mTracks.end(), track);
+    if(it == mTracks.end()){
+        return false;
+    }
+
+    mTracks.erase(it);
+    return true;
+}
+
+AJ::sample_c AJ::editing::session::Mixer::length() const noexcept {
+    sample_c end = 0;
+    for(const auto &track : mTracks){
+        end = std::max(end, track->timeline().length());
+    }
+
+    return end;
+}
+
+bool AJ::editing::session::Mixer::mix(float *master, sample_c position, size_t frames, utils::ThreadPool *pool,
+    AJ::error::IErrorHandler &handler){
+
+    if(frames > mBlockFrames){
+        const std::string message = "a mixer block holds at most " + std::to_string(mBlockFrames)
+            + " frames. Received " + std::to_string(frames) + ".\n";
+        handler.onError(error::Error::InvalidAudioLength, message);
+        return false;
+    }
+
+    //* a pool buffer per audible track, taken on this thread.
+    mSlots.clear();
+    for(const auto &track : mTracks){
+        if(track->muted()){
+            continue;
+        }
+
+        Slot slot;
+        slot.track = track.get();
+        slot.buffer = mPool.tryPop();
+        track->sideGains(slot.left, slot.right);
+
+        if(!slot.buffer){
+            for(Slot &taken : mSlots){
+                mPool.push(taken.buffer, handler);
+            }
+            mSlots.clear();
+
+            const std::string message = "error: the mixer pool has no block buffer left.\n";
+            handler.onError(error::Error::EmptyBufferQueue, message);
+            return false;
+        }
+
+        mSlots.push_back(slot);
+    }
+
+    const size_t count = mSlots.size();
+
+    auto renderTracks = [&](size_t begin, size_t end){
+        for(size_t i = begin; i < end; ++i){
+            mErrors[i].clear();
+            mSucceeded[i] = mSlots[i].track->render(mSlots[i].buffer->data, position, frames, mErrors[i],
+                pCache.get()) ? 1 : 0;
+            mSlots[i].buffer->frames = frames;
+        }
+    };
+
+    if(pool && count > 1){
+        pool->parallel_for(0, count, 1, renderTracks);
+    } else {
+        renderTracks(0, count);
+    }
+
+    //* every slice of the master sums the tracks in slot order: the same result on any thread count.
+    const dsp::kernels::KernelTable &kernels = dsp::kernels::table();
+    auto sum = [&](size_t begin, size_t end){
+        float *out = master + 2 * begin;
+        std::fill(out, master + 2 * end, 0.0f);
+
+        for(const Slot &slot : mSlots){
+            kernels.mixAdd(slot.buffer->data + 2 * begin, out, end - begin, slot.left, slot.right);
+        }
+    };
+
+    if(pool && frames > kMixSumFrames){
+        pool->parallel_for(0, frames, kMixSumFrames, sum);
+    } else {
+        sum(0, frames);
+    }
+
+    bool success = true;
+    for(size_t i = 0; i < count; ++i){
+        mErrors[i].replay(handler);
+        success = success && mSucceeded[i];
+        mPool.push(mSlots[i].buffer, handler);
+    }
+    mSlots.clear();
+
+    return success;
+}
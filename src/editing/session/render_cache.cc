@@ -0,0 +1,259 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+
+#include "editing/session/render_cache.h"
+
+namespace {
+
+void remove_file(const std::string &path){
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+size_t block_bytes(size_t frames){
+    return 2 * frames * sizeof(float);
+}
+
+}
+
+AJ::editing::session::RenderCache::~RenderCache(){
+    for(const auto &[key, entry] : mEntries){
+        if(!entry.path.empty()){
+            remove_file(entry.path);
+        }
+    }
+}
+
+std::string AJ::editing::session::RenderCache::spillPath(){
+    //? the address keeps two caches sharing a directory apart.
+    const std::string name = "mix-" + std::to_string(reinterpret_cast<uintptr_t>(this))
+        + "-" + std::to_string(mNextSpill++) + ".ajblock";
+    return (std::filesystem::path(mDirectory) / name).string();
+}
+
+void AJ::editing::session::RenderCache::erase(std::unordered_map<uint64_t, Entry>::iterator it){
+    Entry &entry = it->second;
+
+    if(entry.path.empty()){
+        mResidentBytes -= block_bytes(entry.frames);
+        mResident.erase(entry.lru);
+    } else {
+        mSpilledBytes -= block_bytes(entry.frames);
+        mSpilled.erase(entry.lru);
+        remove_file(entry.path);
+    }
+
+    mEntries.erase(it);
+}
+
+void AJ::editing::session::RenderCache::enforce(AJ::error::IErrorHandler &handler){
+    while(mResidentBytes > mBudget && !mResident.empty()){
+        auto it = mEntries.find(mResident.back());
+        Entry &entry = it->second;
+
+        if(mDirectory.empty()){
+            erase(it);
+            continue;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(mDirectory, ec);
+
+        const std::string path = spillPath();
+        bool written = false;
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(entry.samples.data()),
+                static_cast<std::streamsize>(entry.samples.size() * sizeof(float)));
+            written = out && out.flush();
+        }
+
+        if(!written){
+            remove_file(path);
+            erase(it);
+
+            const std::string message = "failed to spill a track block to " + path + ", it is dropped.\n";
+            handler.onError(error::Error::FileWriteError, message);
+            continue;
+        }
+
+        mResidentBytes -= block_bytes(entry.frames);
+        mResident.pop_back();
+        std::vector<float>().swap(entry.samples);
+
+        entry.path = path;
+        mSpilled.push_front(it->first);
+        entry.lru = mSpilled.begin();
+        mSpilledBytes += block_bytes(entry.frames);
+    }
+
+    while(mSpilledBytes > mSpillBudget && !mSpilled.empty()){
+        erase(mEntries.find(mSpilled.back()));
+    }
+}
+
+bool AJ::editing::session::RenderCache::find(uint64_t key, float *out, size_t frames,
+    AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+
+    auto it = mEntries.find(key);
+    if(it == mEntries.end() || it->second.frames != frames){
+        mMisses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Entry &entry = it->second;
+
+    if(!entry.path.empty()){
+        //* read back into memory: a block used again is likely to be used once more.
+        std::vector<float> samples(2 * frames);
+        bool read = false;
+        {
+            std::ifstream in(entry.path, std::ios::binary);
+            in.read(reinterpret_cast<char*>(samples.data()), static_cast<std::streamsize>(block_bytes(frames)));
+            read = static_cast<bool>(in);
+        }
+
+        //? a spill file that can't be read back is a miss, the block is rendered again.
+        if(!read){
+            erase(it);
+            mMisses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        remove_file(entry.path);
+        entry.path.clear();
+        mSpilled.erase(entry.lru);
+        mSpilledBytes -= block_bytes(frames);
+
+        entry.samples = std::move(samples);
+        mResident.push_front(key);
+        entry.lru = mResident.begin();
+        mResidentBytes += block_bytes(frames);
+    } else {
+        mResident.splice(mResident.begin(), mResident, entry.lru);
+    }
+
+    std::memcpy(out, entry.samples.data(), block_bytes(frames));
+    mHits.fetch_add(1, std::memory_order_relaxed);
+
+    enforce(handler);
+    return true;
+}
+
+void AJ::editing::session::RenderCache::store(uint64_t key, const float *block, size_t frames,
+    AJ::error::IErrorHandler &handler){
+
+    std::lock_guard<std::mutex> lock(mMux);
+
+    if(block_bytes(frames) > mBudget){
+        return;
+    }
+
+    auto it = mEntries.find(key);
+    if(it != mEntries.end()){
+        erase(it);
+    }
+
+    Entry &entry = mEntries[key];
+    entry.samples.assign(block, block + 2 * frames);
+    entry.frames = frames;
+    mResident.push_front(key);
+    entry.lru = mResident.begin();
+    mResidentBytes += block_bytes(frames);
+
+    enforce(handler);
+}
+
+void AJ::editing::session::RenderCache::clear(){
+    std::lock_guard<std::mutex> lock(mMux);
+
+    for(const auto &[key, entry] : mEntries){
+        if(!entry.path.empty()){
+            remove_file(entry.path);
+        }
+    }
+
+    mEntries.clear();
+    mResident.clear();
+    mSpilled.clear();
+    mResidentBytes = 0;
+    mSpilledBytes = 0;
+}
+
+void AJ::editing::session::RenderCache::setBudget(size_t bytes, AJ::error::IErrorHandler &handler){
+    std::lock_guard<std::mutex> lock(mMux);
+    mBudget = bytes;
+    enforce(handler);
+}
+
+size_t AJ::editing::session::RenderCache::budget() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mBudget;
+}
+
+void AJ::editing::session::RenderCache::setSpillBudget(size_t bytes, AJ::error::IErrorHandler &handler){
+    std::lock_guard<std::mutex> lock(mMux);
+    mSpillBudget = bytes;
+    enforce(handler);
+}
+
+void AJ::editing::session::RenderCache::setSpillDirectory(const std::string &directory){
+    std::lock_guard<std::mutex> lock(mMux);
+    mDirectory = directory;
+}
+
+size_t AJ::editing::session::RenderCache::residentBytes() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mResidentBytes;
+}
+
+size_t AJ::editing::session::RenderCache::spilledBytes() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mSpilledBytes;
+}
+
+size_t AJ::editing::session::RenderCache::size() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mEntries.size();
+}
+
+uint64_t AJ::editing::session::RenderCache::hash(const float *data, size_t count, uint64_t seed) noexcept {
+    //* four independent lanes keep the multiplies in flight, the block is hashed at memory speed.
+    constexpr uint64_t kPrime = 0x9E3779B97F4A7C15ull;
+    uint64_t lanes[4] = { seed, seed ^ 0x632BE59BD9B4E019ull, seed + kPrime, seed ^ 0xC2B2AE3D27D4EB4Full };
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        for(size_t lane = 0; lane < 4; ++lane){
+            uint64_t word;
+            std::memcpy(&word, data + i + 2 * lane, sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * kPrime;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+
+    uint64_t key = combine(combine(lanes[0], lanes[1]), combine(lanes[2], lanes[3]));
+    for(; i < count; ++i){
+        uint32_t bits;
+        std::memcpy(&bits, data + i, sizeof(bits));
+        key = combine(key, bits);
+    }
+
+    return combine(key, count);
+}
+
+uint64_t AJ::editing::session::RenderCache::combine(uint64_t key, uint64_t value) noexcept {
+    //? splitmix64 finalizer of the pair: a one-bit change of either flips about half of the bits.
+    uint64_t x = key ^ (value + 0x9E3779B97F4A7C15ull + (key << 6) + (key >> 2));
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/scratch_arena.h"
+#include "dsp/kernels.h"
+
+#include "editing/session/session.h"
+
+bool AJ::editing::session::Session::render(sample_c position, size_t frames, float *out, AJ::error::IErrorHandler &handler){
+    const size_t block = mMixer.blockFrames();
+
+    for(size_t done = 0; done < frames; done += block){
+        const size_t count = std::min(block, frames - done);
+        if(!mMixer.mix(out + 2 * done, position + done, count, pThreadPool.get(), handler)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AJ::editing::session::Session::bounce(io::AudioFile &file, AJ::error::IErrorHandler &handler){
+    if(file.storage() != io::SampleStorage::Float32){
+        const std::string message = "the samples must be in Float32 storage to be replaced.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    const size_t frames = length();
+    const size_t block = mMixer.blockFrames();
+
+    AudioBuffer output;
+    output[0].resize(frames);
+    output[1].resize(frames);
+
+    utils::ScratchScope scope;
+    float *stereo = scope.arena().array<float>(2 * block);
+    const dsp::kernels::KernelTable &kernels = dsp::kernels::table();
+
+    for(size_t done = 0; done < frames; done += block){
+        const size_t count = std::min(block, frames - done);
+        if(!mMixer.mix(stereo, done, count, pThreadPool.get(), handler)){
+            return false;
+        }
+
+        kernels.deinterleave(stereo, output[0].data() + done, output[1].data() + done, count);
+    }
+
+    *file.pAudio = std::move(output);
+    file.mInfo.channels = 2;
+    file.mInfo.samplerate = mSamplerate;
+    file.mInfo.length = 2 * frames;
+
+    //? every sample is new, and the channel count may have changed: an index is rebuilt, tiles dropped.
+    if(file.levelIndex()){
+        file.buildLevelIndex();
+    } else if(file.spectrogram()){
+        file.spectrogram()->clear();
+    }
+
+    return true;
+}
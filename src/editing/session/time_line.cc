@@ -0,0 +1,115 @@
+#include <algorithm>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/scratch_arena.h"
+#include "dsp/kernels.h"
+
+#include "editing/session/time_line.h"
+
+bool AJ::editing::session::TimeLine::add(Clip clip, AJ::error::IErrorHandler &handler){
+    if(!clip.source || clip.frames == 0){
+        const std::string message = "Invalid clip, it needs a source file and at least one frame.\n";
+        handler.onError(error::Error::InvalidAudioLength, message);
+        return false;
+    }
+
+    if(clip.source->mInfo.channels == 0 || clip.source->mInfo.channels > 2){
+        const std::string message = "Invalid clip source, expected 1 or 2 channels. Received "
+            + std::to_string(clip.source->mInfo.channels) + ".\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    const sample_c sourceFrames = clip.source->channelFrames();
+    if(clip.sourceStart >= sourceFrames || clip.frames > sourceFrames - clip.sourceStart){
+        const std::string message = "Invalid clip range, frames [" + std::to_string(clip.sourceStart) + ", "
+            + std::to_string(clip.sourceStart + clip.frames) + ") are outside of the source ("
+            + std::to_string(sourceFrames) + " frames).\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    auto at = std::upper_bound(mClips.begin(), mClips.end(), clip.position,
+        [](sample_c position, const Clip &other){ return position < other.position; });
+
+    mLongest = std::max(mLongest, clip.frames);
+    mClips.insert(at, std::move(clip));
+    return true;
+}
+
+bool AJ::editing::session::TimeLine::remove(size_t index){
+    if(index >= mClips.size()){
+        return false;
+    }
+
+    mClips.erase(mClips.begin() + index);
+
+    mLongest = 0;
+    for(const Clip &clip : mClips){
+        mLongest = std::max(mLongest, clip.frames);
+    }
+
+    return true;
+}
+
+AJ::sample_c AJ::editing::session::TimeLine::length() const noexcept {
+    sample_c end = 0;
+    for(const Clip &clip : mClips){
+        end = std::max(end, clip.position + clip.frames);
+    }
+
+    return end;
+}
+
+void AJ::editing::session::TimeLine::mix(float *out, sample_c position, size_t frames) const {
+    const sample_c blockEnd = position + frames;
+    const dsp::kernels::KernelTable &kernels = dsp::kernels::table();
+
+    //* only the clips starting in [position - longest, blockEnd) can reach the block.
+    const sample_c earliest = position > mLongest ? position - mLongest : 0;
+    auto first = std::lower_bound(mClips.begin(), mClips.end(), earliest,
+        [](const Clip &clip, sample_c frame){ return clip.position < frame; });
+
+    for(auto it = first; it != mClips.end() && it->position < blockEnd; ++it){
+        const Clip &clip = *it;
+        const sample_c begin = std::max(position, clip.position);
+        const sample_c end = std::min(blockEnd, clip.position + clip.frames);
+        if(begin >= end){
+            continue;
+        }
+
+        const size_t count = end - begin;
+        const size_t from = clip.sourceStart + (begin - clip.position);
+        const io::AudioFile &source = *clip.source;
+
+        //? a source cut shorter since the clip was placed plays silence past its end.
+        if(from + count > source.channelFrames()){
+            continue;
+        }
+
+        utils::ScratchScope scope;
+        const float *left = nullptr, *right = nullptr;
+
+        //? Float32 sources are read in place, compact ones widened into the arena.
+        if(source.storage() == io::SampleStorage::Float32){
+            left = (*source.pAudio)[0].data() + from;
+            right = source.mInfo.channels == 2 ? (*source.pAudio)[1].data() + from : left;
+        } else {
+            float *l = scope.arena().array<float>(count);
+            source.readFrames(0, from, count, l);
+            left = right = l;
+
+            if(source.mInfo.channels == 2){
+                float *r = scope.arena().array<float>(count);
+                source.readFrames(1, from, count, r);
+                right = r;
+            }
+        }
+
+        float *stereo = scope.arena().array<float>(2 * count);
+        kernels.interleave(left, right, stereo, count);
+        kernels.mixAdd(stereo, out + 2 * (begin - position), count, clip.gain, clip.gain);
+    }
+}
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+
+#include "editing/transaction.h"
+
+namespace {
+
+/**
+ * @brief `frames` frames of the output, copied from `source` (an insert buffer, or the file if nullptr) at `offset`.
+ */
+struct Segment {
+    size_t out = 0;
+    size_t frames = 0;
+    size_t offset = 0;
+    const AJ::AudioBuffer *source = nullptr;
+};
+
+/**
+ * @brief Fill the frames [begin, end) of channel `ch` of the output from the segments.
+ */
+void gather(float *out, const AJ::Float &file, const std::vector<Segment> &segments, size_t ch,
+    size_t begin, size_t end){
+
+    auto it = std::upper_bound(segments.begin(), segments.end(), begin,
+        [](size_t frame, const Segment &segment){ return frame < segment.out; }) - 1;
+
+    for(size_t frame = begin; frame < end; ++it){
+        const size_t within = frame - it->out;
+        const size_t frames = std::min(it->frames - within, end - frame);
+        const float *source = it->source ? (*it->source)[ch].data() : file.data();
+
+        std::memcpy(out + frame, source + it->offset + within, frames * sizeof(float));
+        frame += frames;
+    }
+}
+
+}
+
+bool AJ::editing::transaction::Transaction::cut(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler){
+    if(start < 0 || end < start){
+        const std::string message = "Invalid cut range. Start index must be >= 0 and <= end index. Received start = "
+            + std::to_string(start) + ", end = " + std::to_string(end) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    mEdits.push_back(Edit{ static_cast<sample_c>(start), static_cast<sample_c>(end - start) + 1, nullptr });
+    return true;
+}
+
+bool AJ::editing::transaction::Transaction::insert(sample_pos at, AudioSamples audio, AJ::error::IErrorHandler &handler){
+    if(at < 0){
+        const std::string message = "invalid insert at index " + std::to_string(at) + ".\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    if(!audio || (*audio)[0].empty()){
+        const std::string message = "Invalid audio buffers, insert buffer is empty.\n";
+        handler.onError(error::Error::InvalidAudioLength, message);
+        return false;
+    }
+
+    mEdits.push_back(Edit{ static_cast<sample_c>(at), 0, std::move(audio) });
+    return true;
+}
+
+bool AJ::editing::transaction::Transaction::commit(std::shared_ptr<io::AudioFile> file, AJ::error::IErrorHandler &handler,
+    utils::ThreadPool *pool, undo::State *state){
+
+    if(file->storage() != io::SampleStorage::Float32){
+        const std::string message = "the samples must be in Float32 storage to be edited.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    const size_t channels = file->mInfo.channels == 2 ? 2 : 1;
+    const size_t frames = file->channelFrames();
+
+    //* by position; at the same frame the inserts (in recorded order) go before the cut.
+    std::vector<Edit> edits = mEdits;
+    std::stable_sort(edits.begin(), edits.end(), [](const Edit &a, const Edit &b){
+        if(a.at != b.at) return a.at < b.at;
+        return a.audio && !b.audio;
+    });
+
+    //* merge overlapping cuts, validate, and lay the output out as segments.
+    std::vector<Edit> merged;
+    merged.reserve(edits.size());
+    size_t cutEnd = 0; // one past the last frame of the last cut.
+
+    for(Edit &edit : edits){
+        const size_t end = edit.at + edit.removed;
+
+        if(end > frames || (edit.audio && edit.at > frames)){
+            const std::string message = "edit at frame " + std::to_string(edit.at)
+                + " is out of the file (" + std::to_string(frames) + " frames).\n";
+            handler.onError(error::Error::InvalidProcessingRange, message);
+            return false;
+        }
+
+        if(edit.audio){
+            if(edit.at < cutEnd){
+                const std::string message = "insert at frame " + std::to_string(edit.at)
+                    + " falls inside a cut ending at frame " + std::to_string(cutEnd - 1) + ".\n";
+                handler.onError(error::Error::InvalidProcessingRange, message);
+                return false;
+            }
+
+            const size_t length = (*edit.audio)[0].size();
+            for(size_t ch = 1; ch < channels; ++ch){
+                if((*edit.audio)[ch].size() != length){
+                    const std::string message = "Invalid audio buffers, expected " + std::to_string(channels)
+                        + " channels of the same length.\n";
+                    handler.onError(error::Error::InvalidAudioLength, message);
+                    return false;
+                }
+            }
+
+            merged.push_back(std::move(edit));
+            continue;
+        }
+
+        //? a cut touching the previous one (overlapping or adjacent) extends it.
+        if(!merged.empty() && !merged.back().audio && edit.at <= cutEnd){
+            cutEnd = std::max<size_t>(cutEnd, end);
+            merged.back().removed = cutEnd - merged.back().at;
+            continue;
+        }
+
+        cutEnd = end;
+        merged.push_back(std::move(edit));
+    }
+
+    std::vector<Segment> segments;
+    segments.reserve(2 * merged.size() + 1);
+
+    size_t position = 0, out = 0;
+    auto keep = [&](size_t offset, size_t count, const AudioBuffer *source){
+        if(count > 0){
+            segments.push_back(Segment{ out, count, offset, source });
+            out += count;
+        }
+    };
+
+    for(const Edit &edit : merged){
+        keep(position, edit.at - position, nullptr);
+        position = edit.at;
+
+        if(edit.audio){
+            keep(0, (*edit.audio)[0].size(), edit.audio.get());
+        } else {
+            position += edit.removed;
+        }
+    }
+    keep(position, frames - position, nullptr);
+
+    //* every change is saved in frames of the original file: last first, so the earlier ones don't shift it.
+    if(state){
+        for(auto it = merged.rbegin(); it != merged.rend(); ++it){
+            const size_t inserted = it->audio ? (*it->audio)[0].size() : 0;
+            if(!state->add(file, static_cast<sample_pos>(it->at), it->removed, inserted, handler)){
+                return false;
+            }
+        }
+    }
+
+    //* one allocation of the final length per channel, filled by pieces (on the pool if any).
+    std::vector<Float> output(channels);
+    for(size_t ch = 0; ch < channels; ++ch){
+        output[ch].resize(out);
+    }
+
+    const size_t pieces = (out + kParallelChunkFrames - 1) / kParallelChunkFrames;
+    auto fill = [&](size_t begin, size_t end){
+        for(size_t task = begin; task < end; ++task){
+            const size_t ch = task / pieces, piece = task % pieces;
+            const size_t first = piece * kParallelChunkFrames;
+            gather(output[ch].data(), (*file->pAudio)[ch], segments, ch, first, std::min(first + kParallelChunkFrames, out));
+        }
+    };
+
+    if(pool && channels * pieces > 1){
+        pool->parallel_for(0, channels * pieces, 1, fill);
+    } else {
+        fill(0, channels * pieces);
+    }
+
+    for(size_t ch = 0; ch < channels; ++ch){
+        (*file->pAudio)[ch] = std::move(output[ch]);
+    }
+
+    file->mInfo.length = out * file->mInfo.channels;
+
+    //* samples after the first edit moved.
+    if(!merged.empty()){
+        file->updateLevelIndex(static_cast<sample_pos>(merged.front().at));
+    }
+
+    mEdits.clear();
+    return true;
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+
+#include "editing/trim.h"
+
+bool AJ::editing::trim::AutoTrim::setOptions(const Options &options, AJ::error::IErrorHandler &handler){
+    const bool valid = options.mThresholdDb >= kGateMinThresholdDb && options.mThresholdDb <= 0.0f
+        && options.mMinSilenceMs > 0.0f && options.mPadMs >= 0.0f; // NaN fails.
+
+    if(!valid){
+        const std::string message = "invalid auto-trim options: threshold in [" + std::to_string(kGateMinThresholdDb)
+            + ", 0] dB, minimum silence > 0 ms and pad >= 0 ms.\n";
+        handler.onError(error::Error::InvalidConfiguration, message);
+        return false;
+    }
+
+    mOptions = options;
+    return true;
+}
+
+bool AJ::editing::trim::AutoTrim::record(const io::AudioFile &file, transaction::Transaction &edits, sample_c &removed,
+    AJ::error::IErrorHandler &handler) const {
+
+    removed = 0;
+
+    const double samplerate = static_cast<double>(file.mInfo.samplerate);
+    const size_t minFrames = std::max<size_t>(1, static_cast<size_t>(std::lround(mOptions.mMinSilenceMs * samplerate / 1000.0)));
+    const sample_pos pad = static_cast<sample_pos>(std::lround(mOptions.mPadMs * samplerate / 1000.0));
+    const sample_pos last = static_cast<sample_pos>(file.channelFrames()) - 1;
+
+    std::vector<dsp::silence::Region> regions;
+    if(!file.silences(mOptions.mThresholdDb, minFrames, regions, handler)){
+        return false;
+    }
+
+    for(const dsp::silence::Region &region : regions){
+        const bool leading = region.mStart == 0;
+        const bool trailing = region.mEnd == last;
+
+        //? silent throughout: there's no sound to trim to.
+        if(leading && trailing){
+            continue;
+        }
+
+        if(!leading && !trailing && !mOptions.mInner){
+            continue;
+        }
+
+        const sample_pos start = leading ? 0 : region.mStart + pad;
+        const sample_pos end = trailing ? last : region.mEnd - pad;
+
+        if(start <= end){
+            if(!edits.cut(start, end, handler)){
+                return false;
+            }
+            removed += static_cast<sample_c>(end - start + 1);
+        }
+    }
+
+    return true;
+}
+
+bool AJ::editing::trim::AutoTrim::process(std::shared_ptr<io::AudioFile> file, AJ::error::IErrorHandler &handler,
+    utils::ThreadPool *pool, undo::State *state) const {
+
+    if(!file){
+        const std::string message = "invalid file for auto-trim.\n";
+        handler.onError(error::Error::InvalidConfiguration, message);
+        return false;
+    }
+
+    transaction::Transaction edits;
+    sample_c removed = 0;
+
+    if(!record(*file, edits, removed, handler)){
+        return false;
+    }
+
+    return edits.empty() || edits.commit(std::move(file), handler, pool, state);
+}
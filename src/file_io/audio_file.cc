@@ -1,3 +1,5 @@
+#include <array>
+#include <cmath>
 #include <filesystem>
 #include <algorithm>
 #include <unordered_set>
@@ -7,7 +9,13 @@
 #include "core/types.h"
 
 #include "file_io/audio_file.h"
+#include "file_io/level_index.h"
+#include "dsp/kernels.h"
+#include "dsp/resample/resampler.h"
+#include "dsp/loudness/loudness.h"
 #include "core/error_handler.h"
+#include "core/trace.h"
+#include "core/scratch_arena.h"
 
 bool AJ::io::AudioFile::setWriteInfo(const AJ::AudioWriteInfo& info, AJ::error::IErrorHandler &handler)
 {
@@ -48,12 +56,16 @@ bool AJ::io::AudioFile::setWriteInfo(const AJ::AudioWriteInfo& info, AJ::error::
         return false;
     }
 
-    const std::unordered_set<sample_c> validRates = {
+    //* WAV takes any rate the resampler converts to, MPEG audio only has these.
+    const std::unordered_set<sample_c> mp3Rates = {
         8000, 11025, 12000, 16000, 22050,
         24000, 32000, 44100, 48000
     };
 
-    if (validRates.find(info.samplerate) == validRates.end()) {
+    const bool validRate = info.format == ".mp3" ? mp3Rates.find(info.samplerate) != mp3Rates.end()
+        : info.samplerate >= kMinSamplerate && info.samplerate <= kMaxSamplerate;
+
+    if (!validRate) {
         const std::string message = "Error: unsupported samplerate.\n";
 
         handler.onError(AJ::error::Error::InvalidSampleRate, message);
@@ -66,4 +78,348 @@ bool AJ::io::AudioFile::setWriteInfo(const AJ::AudioWriteInfo& info, AJ::error::
     return true;
 }
 
+bool AJ::io::AudioFile::checkRange(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler){
+    if(start < 0 || (end >= 0 && end < start)){
+        const std::string message = "invalid range, expected 0 <= start <= end (or end = -1).\n";
+        handler.onError(AJ::error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    return true;
+}
+
+void AJ::io::AudioFile::buildLevelIndex(){
+    if(pSpectrogram){
+        pSpectrogram->clear();
+    }
+
+    if(pCompact){
+        return;
+    }
+
+    if(!pLevelIndex){
+        pLevelIndex = std::make_unique<LevelIndex>();
+    }
+
+    pLevelIndex->build(*pAudio, mInfo.channels == 2 ? 2 : 1);
+}
+
+void AJ::io::AudioFile::updateLevelIndex(sample_pos start, sample_pos end){
+    if(pSpectrogram){
+        pSpectrogram->invalidate(start, end);
+    }
+
+    if(!pLevelIndex){
+        return;
+    }
+
+    const uint8_t channels = mInfo.channels == 2 ? 2 : 1;
+    for(uint8_t ch = 0; ch < channels; ++ch){
+        pLevelIndex->update(pAudio->at(ch), ch, start, end);
+    }
+}
+
+bool AJ::io::AudioFile::levels(uint8_t channel, sample_pos start, sample_pos end,
+    dsp::kernels::Levels &levels, AJ::error::IErrorHandler &handler) const {
+    if(channel >= mInfo.channels || channel >= kNumChannels){
+        const std::string message = "invalid channel index.\n";
+        handler.onError(AJ::error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    const Float &samples = pAudio->at(channel);
+
+    if(start < 0 || end < start || end >= static_cast<sample_pos>(channelFrames())){
+        const std::string message = "invalid range, expected 0 <= start <= end < length.\n";
+        handler.onError(AJ::error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    //* compact samples: widen a chunk at a time and merge the chunk levels.
+    if(pCompact){
+        const dsp::kernels::KernelTable &kernels = dsp::kernels::table();
+        const size_t chunkFrames = std::min<size_t>(kIOChunkFrames, end - start + 1);
+
+        utils::ScratchScope scope;
+        float *chunk = scope.arena().array<float>(chunkFrames);
+
+        if(!chunk){
+            const std::string message = "failed to allocate the level scan buffer.\n";
+            handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+            return false;
+        }
+
+        levels = kernels.analyze(nullptr, 0);
+        for(sample_pos frame = start; frame <= end; ){
+            const size_t count = std::min<size_t>(chunkFrames, end - frame + 1);
+
+            pCompact->read(channel, frame, count, chunk);
+            levels = dsp::kernels::combine(levels, kernels.analyze(chunk, count));
+            frame += count;
+        }
+
+        return true;
+    }
+
+    if(pLevelIndex){
+        levels = pLevelIndex->query(samples, channel, start, end);
+        return true;
+    }
+
+    levels = dsp::kernels::table().analyze(samples.data() + start, end - start + 1);
+    return true;
+}
+
+namespace {
+
+//* blocks [first, end) of a level: the quiet ones are skipped, the others split into the level below.
+void scanBlocks(const AJ::io::LevelIndex &index, AJ::dsp::silence::Scanner &scanner, const float *const *data,
+    uint8_t channels, size_t frames, float threshold, size_t level, size_t first, size_t end){
+
+    const size_t span = AJ::io::LevelIndex::blockFrames(level);
+    end = std::min(end, index.blocks(0, level).size());
+
+    for(size_t b = first; b < end; ++b){
+        const size_t start = b * span;
+        const size_t count = std::min(span, frames - start);
+
+        bool quiet = true;
+        for(uint8_t ch = 0; ch < channels && quiet; ++ch){
+            const AJ::dsp::kernels::Levels &levels = index.blocks(ch, level)[b];
+            quiet = std::max(-levels.min, levels.max) <= threshold;
+        }
+
+        if(quiet){
+            scanner.feedSilent(count);
+        } else if(level == 0){
+            const float *block[AJ::kNumChannels];
+            for(uint8_t ch = 0; ch < channels; ++ch){
+                block[ch] = data[ch] + start;
+            }
+            scanner.feed(block, channels, count);
+        } else {
+            scanBlocks(index, scanner, data, channels, frames, threshold, level - 1,
+                b * AJ::kLevelIndexFanout, (b + 1) * AJ::kLevelIndexFanout);
+        }
+    }
+}
+
+}
+
+bool AJ::io::AudioFile::silences(float thresholdDb, size_t minFrames, std::vector<dsp::silence::Region> &regions,
+    AJ::error::IErrorHandler &handler) const {
+
+    if(!(thresholdDb >= kGateMinThresholdDb && thresholdDb <= 0.0f) || minFrames == 0){
+        const std::string message = "invalid silence detection, the threshold must be in ["
+            + std::to_string(kGateMinThresholdDb) + ", 0] dB and the length at least one frame.\n";
+        handler.onError(AJ::error::Error::InvalidConfiguration, message);
+        return false;
+    }
+
+    AJ_TRACE_ZONE("analysis", "silences");
+
+    const float threshold = static_cast<float>(std::pow(10.0, thresholdDb / 20.0));
+    const uint8_t channels = mInfo.channels == 2 ? 2 : 1;
+    const size_t frames = channelFrames();
+
+    dsp::silence::Scanner scanner(threshold, minFrames);
+    const float *data[kNumChannels];
+
+    if(pCompact){
+        //* compact samples: widen a chunk of every channel at a time.
+        utils::ScratchScope scope;
+        float *chunk = scope.arena().array<float>(kIOChunkFrames * channels);
+
+        if(!chunk){
+            const std::string message = "failed to allocate the silence scan buffer.\n";
+            handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+            return false;
+        }
+
+        for(size_t frame = 0; frame < frames; frame += kIOChunkFrames){
+            const size_t count = std::min(kIOChunkFrames, frames - frame);
+            for(uint8_t ch = 0; ch < channels; ++ch){
+                data[ch] = chunk + ch * kIOChunkFrames;
+                pCompact->read(ch, frame, count, chunk + ch * kIOChunkFrames);
+            }
+            scanner.feed(data, channels, count);
+        }
+    } else {
+        for(uint8_t ch = 0; ch < channels; ++ch){
+            data[ch] = pAudio->at(ch).data();
+        }
+
+        bool indexed = pLevelIndex != nullptr;
+        for(uint8_t ch = 0; ch < channels && indexed; ++ch){
+            indexed = pLevelIndex->frames(ch) == frames;
+        }
+
+        if(indexed){
+            scanBlocks(*pLevelIndex, scanner, data, channels, frames, threshold, kLevelIndexDepth - 1,
+                0, pLevelIndex->blocks(0, kLevelIndexDepth - 1).size());
+        } else {
+            scanner.feed(data, channels, frames);
+        }
+    }
+
+    regions = scanner.finish();
+    return true;
+}
 
+bool AJ::io::AudioFile::loudness(sample_pos start, sample_pos end, dsp::loudness::Measurement &measurement,
+    utils::ThreadPool *pool, AJ::error::IErrorHandler &handler){
+
+    if(start < 0 || end < start || end >= static_cast<sample_pos>(channelFrames())){
+        const std::string message = "invalid range, expected 0 <= start <= end < length.\n";
+        handler.onError(AJ::error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    const uint32_t samplerate = static_cast<uint32_t>(mInfo.samplerate);
+
+    if(pLevelIndex){
+        if(const dsp::loudness::Measurement *cached = pLevelIndex->loudness(start, end, samplerate)){
+            measurement = *cached;
+            return true;
+        }
+    }
+
+    const uint8_t channels = mInfo.channels == 2 ? 2 : 1;
+    const size_t frames = static_cast<size_t>(end - start + 1);
+    const float *data[kNumChannels];
+
+    //* compact samples: the measurement needs the float channels of the range.
+    std::array<Float, kNumChannels> widened;
+    for(uint8_t ch = 0; ch < channels; ++ch){
+        if(pCompact){
+            widened[ch].resize(frames);
+            pCompact->read(ch, start, frames, widened[ch].data());
+            data[ch] = widened[ch].data();
+            continue;
+        }
+        data[ch] = pAudio->at(ch).data() + start;
+    }
+
+    if(!dsp::loudness::measure(data, channels, frames, samplerate, measurement, pool)){
+        const std::string message = "failed to allocate the loudness scratch buffers.\n";
+        handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    if(pLevelIndex){
+        pLevelIndex->storeLoudness(start, end, samplerate, measurement);
+    }
+
+    return true;
+}
+
+bool AJ::io::AudioFile::setStorage(SampleStorage storage, AJ::error::IErrorHandler &handler){
+    if(storage == this->storage()){
+        return true;
+    }
+
+    const uint8_t channels = mInfo.channels == 2 ? 2 : 1;
+
+    if(storage == SampleStorage::Float32){
+        pCompact->unpack(*pAudio);
+        pCompact.reset();
+        return true;
+    }
+
+    //* int16 <-> half: through float, one channel at a time.
+    if(pCompact){
+        pCompact->unpack(*pAudio);
+        pCompact.reset();
+    }
+
+    auto compact = std::make_unique<CompactSamples>();
+
+    if(!compact->pack(*pAudio, channels, storage)){
+        const std::string message = "Error: the channels must have the same length to be compacted.\n";
+        handler.onError(AJ::error::Error::InvalidAudioLength, message);
+        return false;
+    }
+
+    //? the float channels are released, not just cleared.
+    for(Float &channel : *pAudio){
+        Float().swap(channel);
+    }
+
+    pCompact = std::move(compact);
+    pLevelIndex.reset();
+    return true;
+}
+
+bool AJ::io::AudioFile::resample(sample_c samplerate, utils::ThreadPool *pool, AJ::error::IErrorHandler &handler){
+    if(samplerate == mInfo.samplerate){
+        return true;
+    }
+
+    AJ_TRACE_ZONE("dsp", "resample");
+    auto filter = dsp::resample::filter(static_cast<uint32_t>(mInfo.samplerate), static_cast<uint32_t>(samplerate), handler);
+    if(!filter){
+        return false;
+    }
+
+    //* compact samples are converted as floats and narrowed back afterwards.
+    const SampleStorage compact = storage();
+    if(compact != SampleStorage::Float32 && !setStorage(SampleStorage::Float32, handler)){
+        return false;
+    }
+
+    const uint8_t channels = mInfo.channels == 2 ? 2 : 1;
+    Float converted;
+
+    for(uint8_t ch = 0; ch < channels; ++ch){
+        Float &channel = (*pAudio)[ch];
+        dsp::resample::resample(channel.data(), channel.size(), converted, *filter, pool);
+        channel.swap(converted);
+    }
+
+    //? positions in the source file keep pointing at the same instants.
+    mRangeStart = static_cast<sample_pos>(filter->OutputLength(static_cast<size_t>(mRangeStart)));
+    mSourceFrames = static_cast<sample_c>(filter->OutputLength(static_cast<size_t>(mSourceFrames)));
+
+    mInfo.samplerate = samplerate;
+    mInfo.length = static_cast<sample_c>((*pAudio)[0].size() * channels);
+
+    if(pLevelIndex){
+        buildLevelIndex();
+    } else if(pSpectrogram){
+        pSpectrogram->clear();
+    }
+
+    return compact == SampleStorage::Float32 || setStorage(compact, handler);
+}
+
+size_t AJ::io::AudioFile::residentBytes() const noexcept {
+    if(pCompact){
+        return pCompact->bytes();
+    }
+
+    size_t bytes = 0;
+    for(const Float &channel : *pAudio){
+        bytes += channel.capacity() * sizeof(float);
+    }
+
+    return bytes;
+}
+
+void AJ::io::AudioFile::readFrames(uint8_t channel, size_t start, size_t count, float *out) const {
+    if(pCompact){
+        pCompact->read(channel, start, count, out);
+        return;
+    }
+
+    const float *samples = (*pAudio)[channel].data() + start;
+    std::copy(samples, samples + count, out);
+}
+
+void AJ::io::AudioFile::writeFrames(uint8_t channel, size_t start, size_t count, const float *in){
+    if(pCompact){
+        pCompact->write(channel, start, count, in);
+        return;
+    }
+
+    std::copy(in, in + count, (*pAudio)[channel].data() + start);
+}
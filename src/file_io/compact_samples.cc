@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <new>
+
+#include "file_io/compact_samples.h"
+#include "dsp/kernels.h"
+#include "core/scratch_arena.h"
+
+namespace {
+
+/// @brief int16 storage holds `n / 32768`: scaling by 32768 / 32767 lets the toInt16 kernel (x 32767) store n exactly.
+constexpr float kInt16Rescale = 32768.0f / 32767.0f;
+
+}
+
+bool AJ::io::CompactSamples::pack(const AudioBuffer &audio, uint8_t channels, SampleStorage storage){
+    if(storage == SampleStorage::Float32 || channels < 1 || channels > kNumChannels){
+        return false;
+    }
+
+    const size_t frames = audio[0].size();
+    for(uint8_t ch = 1; ch < channels; ++ch){
+        if(audio[ch].size() != frames) return false;
+    }
+
+    mStorage = storage;
+    mChannels = channels;
+    mFrames = frames;
+
+    for(uint8_t ch = 0; ch < kNumChannels; ++ch){
+        if(ch < channels){
+            mData[ch].resize(frames);
+            write(ch, 0, frames, audio[ch].data());
+        } else {
+            std::vector<uint16_t>().swap(mData[ch]);
+        }
+    }
+
+    return true;
+}
+
+void AJ::io::CompactSamples::unpack(AudioBuffer &audio) const {
+    for(uint8_t ch = 0; ch < mChannels; ++ch){
+        audio[ch].resize(mFrames);
+        read(ch, 0, mFrames, audio[ch].data());
+    }
+}
+
+void AJ::io::CompactSamples::read(uint8_t channel, size_t start, size_t count, float *out) const {
+    const dsp::kernels::KernelTable &kernels = dsp::kernels::table();
+    const uint16_t *in = mData[channel].data() + start;
+
+    if(mStorage == SampleStorage::Float16){
+        kernels.fromHalf(in, out, count);
+    } else {
+        kernels.fromInt16(reinterpret_cast<const int16_t*>(in), out, count);
+    }
+}
+
+void AJ::io::CompactSamples::write(uint8_t channel, size_t start, size_t count, const float *in){
+    const dsp::kernels::KernelTable &kernels = dsp::kernels::table();
+    uint16_t *out = mData[channel].data() + start;
+
+    if(mStorage == SampleStorage::Float16){
+        kernels.toHalf(in, out, count);
+        return;
+    }
+
+    //* rescaled a chunk at a time in scratch memory, the source is left untouched.
+    const size_t chunkFrames = std::min(count, kIOChunkFrames);
+    utils::ScratchScope scope;
+    float *chunk = scope.arena().array<float>(chunkFrames);
+
+    if(!chunk){
+        throw std::bad_alloc();
+    }
+
+    for(size_t done = 0; done < count; ){
+        const size_t n = std::min(chunkFrames, count - done);
+
+        std::copy(in + done, in + done + n, chunk);
+        kernels.scale(chunk, n, kInt16Rescale);
+        kernels.toInt16(chunk, reinterpret_cast<int16_t*>(out + done), n, nullptr);
+
+        done += n;
+    }
+}
@@ -0,0 +1,331 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "file_io/decode_cache.h"
+#include "file_io/audio_file.h"
+#include "file_io/seek_index.h"
+#include "core/constants.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kMagic[4] = {'A', 'J', 'D', 'C'};
+constexpr uint32_t kVersion = 1;
+
+/// @brief Fixed part of an entry, followed by the source path and the page aligned channels.
+struct EntryHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize;   ///< bytes of the source when it was decoded.
+    int64_t sourceMtime;   ///< modification time of the source (file clock ticks).
+    uint64_t frames;       ///< frames of every channel.
+    uint64_t samplerate;
+    int32_t bitdepth;
+    uint32_t pathBytes;    ///< bytes of the source path right after the header.
+    uint8_t channels;
+    uint8_t seekable;
+    uint8_t reserved[6];
+    char format[16];       ///< AudioInfo::format, zero padded.
+    uint64_t dataOffset;   ///< offset of the first channel, a multiple of kDecodeCacheAlignment.
+};
+
+static_assert(sizeof(EntryHeader) % 8 == 0, "EntryHeader must not need trailing padding");
+
+/// @brief Size and modification time of the source, the part of the key that changes when the file does.
+bool source_stamp(const std::string& source, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    size = std::filesystem::file_size(source, ec);
+    if(ec) return false;
+
+    const auto time = std::filesystem::last_write_time(source, ec);
+    if(ec) return false;
+
+    mtime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+size_t align_up(size_t bytes) noexcept {
+    return (bytes + AJ::kDecodeCacheAlignment - 1) / AJ::kDecodeCacheAlignment * AJ::kDecodeCacheAlignment;
+}
+
+//? a path that can't be made absolute keys on its spelling.
+std::string absolute_path(const std::string& source) {
+    std::error_code ec;
+    const std::filesystem::path path = std::filesystem::absolute(source, ec);
+    return ec ? source : path.lexically_normal().string();
+}
+
+//* entries of a source share the hash of its path, the extension tells them apart.
+std::string entry_file(const std::string& directory, const std::string& source, const char* extension) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.%s",
+        static_cast<unsigned long long>(std::hash<std::string>{}(absolute_path(source))), extension);
+
+    return (std::filesystem::path(directory) / name).string();
+}
+
+//? the pid keeps apart the processes sharing a cache directory, the thread the writers of one process.
+std::string temp_path(const std::string& entry) {
+#if defined(__linux__)
+    const std::string process = std::to_string(getpid()) + ".";
+#else
+    const std::string process;
+#endif
+    return entry + ".tmp" + process + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+}
+
+constexpr char kIndexMagic[4] = {'A', 'J', 'S', 'I'};
+constexpr uint32_t kIndexVersion = 1;
+
+/// @brief Fixed part of a seek index entry, followed by the source path and the points.
+struct IndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize;   ///< bytes of the source when it was indexed.
+    int64_t sourceMtime;   ///< modification time of the source (file clock ticks).
+    uint64_t packets;      ///< packets indexed.
+    int64_t frames;        ///< frames of the full decode.
+    uint64_t points;       ///< points after the path.
+    uint32_t pathBytes;    ///< bytes of the source path right after the header.
+    uint32_t reserved;
+};
+
+static_assert(sizeof(IndexHeader) % 8 == 0, "IndexHeader must not need trailing padding");
+static_assert(sizeof(AJ::io::SeekIndex::Point) == 16, "SeekIndex::Point is stored as it is");
+
+}
+
+std::string AJ::io::DecodeCache::entryPath(const std::string& source) const {
+    return entry_file(mDirectory, source, "ajdc");
+}
+
+std::string AJ::io::DecodeCache::seekIndexPath(const std::string& source) const {
+    return entry_file(mDirectory, source, "ajsi");
+}
+
+bool AJ::io::DecodeCache::load(const std::string& source, AudioFile& audio) const {
+#if defined(__linux__)
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if(!source_stamp(source, size, mtime)) return false;
+
+    const std::string entry = entryPath(source);
+    int fd = ::open(entry.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(EntryHeader)){
+        ::close(fd);
+        return false;
+    }
+
+    const size_t map_size = static_cast<size_t>(st.st_size);
+    void* ptr = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file open.
+
+    if(ptr == MAP_FAILED) return false;
+
+    const uint8_t* map = static_cast<const uint8_t*>(ptr);
+    EntryHeader header;
+    std::memcpy(&header, map, sizeof(header));
+
+    const std::string path = absolute_path(source);
+    const size_t plane_bytes = static_cast<size_t>(header.frames) * sizeof(float); // only used once frames is bounded.
+
+    //* everything is checked before `audio` is touched: a stale or damaged entry is a plain miss.
+    bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion
+        && header.sourceSize == size && header.sourceMtime == mtime
+        && header.channels > 0 && header.channels <= kNumChannels
+        && header.pathBytes == path.size() && sizeof(EntryHeader) + header.pathBytes <= map_size
+        && std::memcmp(map + sizeof(EntryHeader), path.data(), path.size()) == 0
+        && header.dataOffset % kDecodeCacheAlignment == 0 && header.dataOffset <= map_size
+        && header.frames <= map_size / sizeof(float)
+        && header.dataOffset + (header.channels - 1) * align_up(plane_bytes) + plane_bytes <= map_size;
+
+    if(valid){
+        madvise(ptr, map_size, MADV_SEQUENTIAL);
+
+        for(uint8_t ch = 0; ch < header.channels; ++ch){
+            const float* plane = reinterpret_cast<const float*>(map + header.dataOffset + ch * align_up(plane_bytes));
+            (*audio.pAudio)[ch].assign(plane, plane + header.frames);
+        }
+
+        audio.mInfo.length = header.frames * header.channels;
+        audio.mInfo.samplerate = header.samplerate;
+        audio.mInfo.channels = header.channels;
+        audio.mInfo.bitdepth = static_cast<BitDepth_t>(header.bitdepth);
+        audio.mInfo.format.assign(header.format, strnlen(header.format, sizeof(header.format)));
+        audio.mInfo.seekable = header.seekable != 0;
+    }
+
+    munmap(ptr, map_size);
+    return valid;
+#else
+    //? no mmap: the caller decodes the file.
+    (void)source;
+    (void)audio;
+    return false;
+#endif
+}
+
+bool AJ::io::DecodeCache::store(const std::string& source, const AudioFile& audio) const {
+    const AudioInfo& info = audio.mInfo;
+    if(info.channels == 0 || info.channels > kNumChannels) return false;
+
+    EntryHeader header = {};
+    if(!source_stamp(source, header.sourceSize, header.sourceMtime)) return false;
+
+    const std::string path = absolute_path(source);
+    const size_t frames = (*audio.pAudio)[0].size();
+
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.frames = frames;
+    header.samplerate = info.samplerate;
+    header.bitdepth = static_cast<int32_t>(info.bitdepth);
+    header.pathBytes = static_cast<uint32_t>(path.size());
+    header.channels = info.channels;
+    header.seekable = info.seekable ? 1 : 0;
+    std::strncpy(header.format, info.format.c_str(), sizeof(header.format) - 1);
+    header.dataOffset = align_up(sizeof(EntryHeader) + path.size());
+
+    for(uint8_t ch = 1; ch < info.channels; ++ch){
+        if((*audio.pAudio)[ch].size() != frames) return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(mDirectory, ec);
+    if(ec) return false;
+
+    //* written next to the entry and renamed over it, readers only ever see a complete entry.
+    const std::string entry = entryPath(source);
+    const std::string temp = temp_path(entry);
+
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if(!out) return false;
+
+        const std::vector<char> padding(kDecodeCacheAlignment, 0);
+        const size_t plane_bytes = frames * sizeof(float);
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(path.data(), static_cast<std::streamsize>(path.size()));
+        out.write(padding.data(), static_cast<std::streamsize>(header.dataOffset - sizeof(header) - path.size()));
+
+        for(uint8_t ch = 0; ch < info.channels; ++ch){
+            out.write(reinterpret_cast<const char*>((*audio.pAudio)[ch].data()), static_cast<std::streamsize>(plane_bytes));
+
+            //? the last channel isn't padded, the file ends with its samples.
+            if(ch + 1 < info.channels){
+                out.write(padding.data(), static_cast<std::streamsize>(align_up(plane_bytes) - plane_bytes));
+            }
+        }
+
+        if(!out.flush()){
+            out.close();
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp, entry, ec);
+    if(ec){
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool AJ::io::DecodeCache::loadSeekIndex(const std::string& source, SeekIndex& index) const {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if(!source_stamp(source, size, mtime)) return false;
+
+    std::ifstream in(seekIndexPath(source), std::ios::binary);
+    if(!in) return false;
+
+    IndexHeader header;
+    if(!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+
+    const std::string path = absolute_path(source);
+
+    std::error_code ec;
+    const uint64_t entry_size = std::filesystem::file_size(seekIndexPath(source), ec);
+
+    //* a stale or damaged entry is a plain miss, like a samples entry.
+    const bool valid = !ec && std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) == 0
+        && header.version == kIndexVersion && header.sourceSize == size && header.sourceMtime == mtime
+        && header.pathBytes == path.size()
+        && entry_size == sizeof(IndexHeader) + header.pathBytes + header.points * sizeof(SeekIndex::Point);
+    if(!valid) return false;
+
+    std::string stored(header.pathBytes, '\0');
+    std::vector<SeekIndex::Point> points(header.points);
+
+    if(!in.read(stored.data(), static_cast<std::streamsize>(stored.size())) || stored != path
+        || !in.read(reinterpret_cast<char*>(points.data()), static_cast<std::streamsize>(points.size() * sizeof(SeekIndex::Point)))){
+        return false;
+    }
+
+    index = SeekIndex(std::move(points), header.packets, header.frames);
+    return true;
+}
+
+bool AJ::io::DecodeCache::storeSeekIndex(const std::string& source, const SeekIndex& index) const {
+    IndexHeader header = {};
+    if(!source_stamp(source, header.sourceSize, header.sourceMtime)) return false;
+
+    const std::string path = absolute_path(source);
+    const std::vector<SeekIndex::Point>& points = index.points();
+
+    std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+    header.version = kIndexVersion;
+    header.packets = index.packets();
+    header.frames = index.frames();
+    header.points = points.size();
+    header.pathBytes = static_cast<uint32_t>(path.size());
+
+    std::error_code ec;
+    std::filesystem::create_directories(mDirectory, ec);
+    if(ec) return false;
+
+    const std::string entry = seekIndexPath(source);
+    const std::string temp = temp_path(entry);
+
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if(!out) return false;
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(path.data(), static_cast<std::streamsize>(path.size()));
+        out.write(reinterpret_cast<const char*>(points.data()), static_cast<std::streamsize>(points.size() * sizeof(SeekIndex::Point)));
+
+        if(!out.flush()){
+            out.close();
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp, entry, ec);
+    if(ec){
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+
+    return true;
+}
@@ -1,14 +1,21 @@
 #include "file_io/file_streamer.h"
+#include "file_io/mp3_file.h"
+#include "dsp/kernels.h"
+#include "core/trace.h"
 #include <sndfile.h>
 
-#include <unordered_set>
+#include <algorithm>
 #include <chrono>
-#include <thread>
 
 void AJ::io::file_streamer::FileStreamer::set_file_info(SF_INFO& info){
     info.channels = pWriteInfo->channels;
-    info.samplerate = pWriteInfo->samplerate;
-    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    info.samplerate = fileRate();
+    if(mWriteOptions.format == StreamFormat::Flac){
+        info.format = SF_FORMAT_FLAC | (mWriteOptions.flacBitDepth == BitDepth_t::int_16 ? SF_FORMAT_PCM_16 : SF_FORMAT_PCM_24);
+        return;
+    }
+
+    info.format = (mWriteOptions.stream.rf64 ? SF_FORMAT_RF64 : SF_FORMAT_WAV) | SF_FORMAT_FLOAT;
 }
 
 bool AJ::io::file_streamer::FileStreamer::close_file(SNDFILE *file, bool return_val, AJ::error::IErrorHandler &handler){
@@ -22,16 +29,255 @@ bool AJ::io::file_streamer::FileStreamer::close_file(SNDFILE *file, bool return_
     return return_val;
 }
 
+bool AJ::io::file_streamer::FileStreamer::openRead(AJ::error::IErrorHandler &handler){
+    if(pReadInfo->format == "wav"){
+        SF_INFO info;
+        info.format = 0;
+
+        pReadFile = sf_open(mReadPath.c_str(), SFM_READ, &info);
+
+        if(!pReadFile){
+            const std::string message = "Error: Couldn't open file: " + mReadPath + "\n";
+            handler.onError(AJ::error::Error::FileOpenError, message);
+            return false;
+        }
+
+        pReadInfo->channels = static_cast<uint8_t>(info.channels);
+        pReadInfo->samplerate = info.samplerate;
+        pReadInfo->length = info.frames * info.channels;
+        pReadInfo->seekable = info.seekable;
+        return true;
+    }
+
+    pReadMP3 = std::make_shared<AJ::io::MP3_File>();
+    std::string file_path = mReadPath;
+
+    if(!pReadMP3->setFilePath(file_path) || !pReadMP3->openStream(handler)){
+        pReadMP3.reset();
+        return false;
+    }
+
+    pReadMP3->setSeekIndex(pReadIndex);
+
+    pReadInfo->channels = pReadMP3->mInfo.channels;
+    pReadInfo->samplerate = pReadMP3->mInfo.samplerate;
+    pReadInfo->length = pReadMP3->mInfo.length;
+    pReadInfo->seekable = pReadMP3->mInfo.seekable;
+    return true;
+}
+
+size_t AJ::io::file_streamer::FileStreamer::readBlock(float *out, size_t frames, AJ::error::IErrorHandler &handler){
+    if(pReadFile){
+        const sf_count_t read = sf_readf_float(pReadFile, out, static_cast<sf_count_t>(frames));
+        return read > 0 ? static_cast<size_t>(read) : 0;
+    }
+
+    return pReadMP3 ? pReadMP3->readStream(out, frames, handler) : 0;
+}
+
+size_t AJ::io::file_streamer::FileStreamer::readBlockReversed(float *out, size_t frames, AJ::error::IErrorHandler &handler){
+    const sample_pos total = static_cast<sample_pos>(pReadInfo->length / pReadInfo->channels);
+    const sample_pos position = mReadPosition.load(std::memory_order_relaxed);
+
+    if(position >= total){
+        return 0;
+    }
+
+    const size_t count = std::min(frames, static_cast<size_t>(total - position));
+    if(!seekRead(total - position - static_cast<sample_pos>(count), handler)){
+        return 0;
+    }
+
+    const size_t read = readBlock(out, count, handler);
+    AJ::dsp::kernels::reverseFrames(out, read, pReadInfo->channels);
+    return read;
+}
+
+bool AJ::io::file_streamer::FileStreamer::seekRead(sample_pos frame, AJ::error::IErrorHandler &handler){
+    if(pReadMP3){
+        return pReadMP3->seekStream(frame, handler);
+    }
+
+    const sample_pos frames = static_cast<sample_pos>(pReadInfo->length / pReadInfo->channels);
+
+    if(!pReadInfo->seekable || sf_seek(pReadFile, std::min(frame, frames), SEEK_SET) < 0){
+        const std::string message = "Error: Couldn't seek in file: " + mReadPath + "\n";
+        handler.onError(AJ::error::Error::FileReadError, message);
+        return false;
+    }
+
+    return true;
+}
+
+void AJ::io::file_streamer::FileStreamer::closeRead(AJ::error::IErrorHandler &handler){
+    if(pReadFile){
+        close_file(pReadFile, true, handler);
+        pReadFile = nullptr;
+    }
+
+    if(pReadMP3){
+        pReadMP3->closeStream();
+        pReadMP3.reset();
+    }
+}
+
 bool AJ::io::file_streamer::FileStreamer::read(AJ::error::IErrorHandler &handler){
-    //TODO: implement read in chunks function.
-    return false;
+    /*
+        * 1- check whether the queue is valid and a file was set.
+        * 2- open the file with the decoder of its format.
+        * 3- pop from buffer pool -> decode one block -> push into queue, until the end of the file.
+        * 4- at the end, wait for a seek (back to 3) or the stop flag.
+     */
+    if(!pQueue->isValid() || !pBufferPool->isValid()){
+        return false;
+    }
+
+    if(!pReadInfo){
+        const std::string message = "Error: no file to read, call setReadInfo() first.\n";
+        handler.onError(AJ::error::Error::InvalidFilePath, message);
+        return false;
+    }
+
+    pEndFlag->flag.store(false, std::memory_order_release);
+
+    if(!openRead(handler)){
+        pEndFlag->flag.store(true, std::memory_order_release);
+        return false;
+    }
+
+    if(mReadReversed && !pReadInfo->seekable){
+        const std::string message = "Error: a file read backwards must be seekable: " + mReadPath + "\n";
+        handler.onError(AJ::error::Error::OperationNotAllowed, message);
+        closeRead(handler);
+        pEndFlag->flag.store(true, std::memory_order_release);
+        return false;
+    }
+
+    const size_t channels = pReadInfo->channels;
+    bool end_of_file = false;
+
+    mReadPosition.store(0, std::memory_order_relaxed);
+
+    while(!pStopFlag->flag.load(std::memory_order_acquire)){
+        //* seek before the next block, what's queued stays queued.
+        const uint64_t request = mSeekRequest.load(std::memory_order_acquire);
+
+        if(request != mSeekServed){
+            mSeekServed = request;
+            const sample_pos target = mSeekTarget.load(std::memory_order_relaxed);
+
+            //* backwards every block seeks anyway, only the position moves.
+            if(mReadReversed || seekRead(target, handler)){
+                mReadPosition.store(target, std::memory_order_relaxed);
+                end_of_file = false;
+                pEndFlag->flag.store(false, std::memory_order_release);
+            }
+            continue;
+        }
+
+        //* the end: the consumers see it, the file stays open for a seek() until the stop flag.
+        if(end_of_file){
+            if(!pEndFlag->flag.load(std::memory_order_relaxed)){
+                pEndFlag->flag.store(true, std::memory_order_release);
+                pQueue->wake();
+            }
+
+            AJ_TRACE_ZONE("queue", "reader_end");
+            std::unique_lock<std::mutex> lock(mSeekMux);
+            mSeekCond.wait_for(lock, kStreamerWakeTimeout, [this]{
+                return mSeekRequest.load(std::memory_order_acquire) != mSeekServed;
+            });
+            continue;
+        }
+
+        AJ::utils::Buffer* buffer = pBufferPool->tryPop();
+
+        //* backpressure: every buffer is queued or in use, park until the consumer returns one.
+        if(!buffer){
+            AJ_TRACE_ZONE("queue", "reader_wait");
+            pBufferPool->wait(1, kStreamerWakeTimeout);
+            continue;
+        }
+
+        AJ_TRACE_ZONE("io", "block_read");
+        const size_t capacity = buffer->size / channels;
+        const size_t frames = mReadReversed ? readBlockReversed(buffer->data, capacity, handler)
+                                            : readBlock(buffer->data, capacity, handler);
+        end_of_file = frames < capacity;
+
+        if(frames == 0){
+            pBufferPool->push(buffer, handler);
+            continue;
+        }
+
+        buffer->frames = frames;
+
+        while(!pQueue->push(buffer)){
+            if(pStopFlag->flag.load(std::memory_order_acquire)){
+                pBufferPool->push(buffer, handler);
+                buffer = nullptr;
+                break;
+            }
+
+            //? the consumer pops a slot before it gives the buffer back: park until the pool grows.
+            AJ_TRACE_ZONE("queue", "reader_wait");
+            pBufferPool->wait(pBufferPool->currentSize() + 1, kStreamerWakeTimeout);
+        }
+
+        if(buffer){
+            mReadPosition.fetch_add(static_cast<sample_pos>(frames), std::memory_order_relaxed);
+        }
+    }
+
+    closeRead(handler);
+
+    // consumers parked on the queue see the end right away.
+    pEndFlag->flag.store(true, std::memory_order_release);
+    pQueue->wake();
+
+    return true;
+}
+
+bool AJ::io::file_streamer::FileStreamer::prepareResampler(AJ::error::IErrorHandler &handler){
+    const uint32_t rate = static_cast<uint32_t>(pWriteInfo->samplerate);
+
+    if(fileRate() == rate){
+        pResampler.reset();
+        return true;
+    }
+
+    pResampler = dsp::resample::Resampler::create(rate, fileRate(), pWriteInfo->channels, handler);
+    return pResampler != nullptr;
+}
+
+const float* AJ::io::file_streamer::FileStreamer::convert(const AJ::utils::Buffer* buffer, size_t &frames){
+    if(!pResampler){
+        frames = buffer->frames;
+        return buffer->data;
+    }
+
+    //* sized by the first buffers, the writer thread may allocate.
+    const size_t room = pResampler->maxOutput(buffer->frames) * pWriteInfo->channels;
+    if(mResampled.size() < room){
+        mResampled.resize(room);
+    }
+
+    frames = pResampler->process(buffer->data, buffer->frames, mResampled.data());
+    return mResampled.data();
 }
 
 void AJ::io::file_streamer::FileStreamer::writeInterleaved(SNDFILE* file,
     AJ::utils::Buffer* buffer, AJ::error::IErrorHandler& handler){
-    sf_count_t written = sf_writef_float(file, buffer->data, buffer->frames);
+    size_t frames = 0;
+    const float *data = convert(buffer, frames);
+    writeFrames(file, data, frames, handler);
+}
+
+void AJ::io::file_streamer::FileStreamer::writeFrames(SNDFILE* file,
+    const float* data, size_t frames, AJ::error::IErrorHandler& handler){
+    sf_count_t written = sf_writef_float(file, data, frames);
 
-    if (written != static_cast<sf_count_t>(buffer->frames)) {
+    if (written != static_cast<sf_count_t>(frames)) {
         const std::string message = "Error: failed to write audio samples to file " 
             + pWriteInfo->path + "/" + pWriteInfo->name + "\n";
             
@@ -45,62 +291,266 @@ bool AJ::io::file_streamer::FileStreamer::write(AJ::error::IErrorHandler &handle
         * 2- create a file and open it to be ready for the writing.
         * 3- listen to the queue -> pop from queue -> write to disk -> push into buffer pool 
      */
-    if(!pQueue->isValid()){
+    if(!beginWrite(handler)){
+        return false;
+    }
+
+    while(!pStopFlag->flag.load(std::memory_order_acquire)){
+        //* park until the producer queued a batch (or the timeout to re-check the stop flag).
+        {
+            AJ_TRACE_ZONE("queue", "writer_wait");
+            pQueue->wait(mWakeThreshold, kStreamerWakeTimeout);
+        }
+        writePending(handler);
+    }
+
+    // consume the rest of the buffers if exists.
+    return endWrite(handler);
+}
+
+bool AJ::io::file_streamer::FileStreamer::beginWrite(AJ::error::IErrorHandler &handler){
+    if(!pQueue->isValid() || !prepareResampler(handler)){
         return false;
     }
 
     SF_INFO info;
 
     set_file_info(info);
-    
+
+    const bool flac = mWriteOptions.format == StreamFormat::Flac;
+
+    // the generated name ends with ".wav".
+    std::string &name = pWriteInfo->name;
+    if(flac && name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0){
+        name.replace(name.size() - 4, 4, ".flac");
+    }
+
     std::string fullPath = pWriteInfo->path + "/" + pWriteInfo->name;
 
-    SNDFILE *file = sf_open(fullPath.c_str(), SFM_WRITE, &info);
+    //? preallocation needs the file descriptor, only the coalesced writer has one.
+    if(!flac && (mWriteOptions.coalesce || mWriteOptions.stream.preallocateBytes > 0)){
+        pStreamWriter = std::make_unique<WavStreamWriter>();
+
+        if(!pStreamWriter->open(fullPath, pWriteInfo->channels, fileRate(), mWriteOptions.stream, handler)){
+            pStreamWriter.reset();
+            return false;
+        }
+
+        writeHeld(handler);
+        return true;
+    }
+
+    pWriteFile = sf_open(fullPath.c_str(), SFM_WRITE, &info);
 
-    if(!file){
+    if(!pWriteFile){
         const std::string message = "Error: Couldn't create file at: " + fullPath + "\n";
 
         handler.onError(AJ::error::Error::FileOpenError, message);
         return false;
     }
 
-    AJ::utils::Buffer* buffer = nullptr;
+    // an RF64 recording that stayed under 4 GiB is written as a plain WAV.
+    if(!flac && mWriteOptions.stream.rf64){
+        sf_command(pWriteFile, SFC_RF64_AUTO_DOWNGRADE, nullptr, SF_TRUE);
+    }
 
-    while(!pStopFlag->flag.load(std::memory_order_acquire)){
-        buffer = pQueue->pop();
+    //* FLAC stores integers: clip out of range floats instead of wrapping them.
+    if(flac){
+        sf_command(pWriteFile, SFC_SET_CLIPPING, nullptr, SF_TRUE);
+    }
 
-        if(!buffer){
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-            continue;
-        } 
+    writeHeld(handler);
+    return true;
+}
+
+void AJ::io::file_streamer::FileStreamer::writeHeld(AJ::error::IErrorHandler &handler){
+    //* the pre-roll goes before anything queued after it.
+    while(!mHeld.empty()){
+        AJ::utils::Buffer *buffer = mHeld.front();
+        mHeld.pop_front();
+        writeBuffer(buffer, handler);
+        pBufferPool->push(buffer, handler);
+    }
+}
+
+size_t AJ::io::file_streamer::FileStreamer::holdPending(size_t keep, AJ::error::IErrorHandler &handler){
+    AJ::utils::Buffer* batch[kStreamerBatch];
+
+    while(size_t count = pQueue->popBatch(batch, kStreamerBatch)){
+        for(size_t i = 0; i < count; ++i){
+            if(discardOldest()){
+                pBufferPool->push(batch[i], handler);
+                continue;
+            }
+            mHeld.push_back(batch[i]);
+        }
+    }
+
+    while(mHeld.size() > keep){
+        pBufferPool->push(mHeld.front(), handler);
+        mHeld.pop_front();
+        if(pCounters) pCounters->blocks.fetch_sub(1, std::memory_order_relaxed);
+    }
 
-        writeInterleaved(file, buffer, handler);
+    return mHeld.size();
+}
+
+size_t AJ::io::file_streamer::FileStreamer::discardPending(AJ::error::IErrorHandler &handler){
+    size_t count = mHeld.size();
 
+    for(AJ::utils::Buffer *buffer : mHeld){
         pBufferPool->push(buffer, handler);
     }
+    mHeld.clear();
 
+    AJ::utils::Buffer* batch[kStreamerBatch];
+    while(size_t popped = pQueue->popBatch(batch, kStreamerBatch)){
+        pBufferPool->pushBatch(batch, popped, handler);
+        count += popped;
+    }
 
-    // consume the rest of the buffers if exists.
-    while(true){
-        buffer = pQueue->pop();
+    return count;
+}
 
-        if(!buffer){
-            close_file(file, true, handler);
-            return true;
+size_t AJ::io::file_streamer::FileStreamer::writePending(AJ::error::IErrorHandler &handler){
+    noteQueueDepth();
+
+    size_t popped = 0;
+    AJ::utils::Buffer* batch[kStreamerBatch];
+
+    //? for FLAC this is the encoder stage: the callback only ever touches the queue.
+    //* one index update per batch on each queue, instead of one per buffer.
+    while(size_t count = pQueue->popBatch(batch, kStreamerBatch)){
+        for(size_t i = 0; i < count; ++i){
+            writeBuffer(batch[i], handler);
         }
+        pBufferPool->pushBatch(batch, count, handler);
+        popped += count;
+    }
 
-        writeInterleaved(file, buffer, handler);
+    return popped;
+}
 
-        pBufferPool->push(buffer, handler);
+bool AJ::io::file_streamer::FileStreamer::endWrite(AJ::error::IErrorHandler &handler){
+    if(!pWriteFile && !pStreamWriter){
+        return false;
     }
 
-    // this point will never be reached but to stop compiler warnings.
+    writePending(handler);
+
+    //* the frames the converter still holds back.
+    if(pResampler){
+        mResampled.resize(pResampler->maxOutput(0) * pWriteInfo->channels);
+        const size_t frames = pResampler->flush(mResampled.data());
+
+        if(pStreamWriter){
+            pStreamWriter->append(mResampled.data(), frames, handler);
+        } else {
+            writeFrames(pWriteFile, mResampled.data(), frames, handler);
+        }
+    }
+
+    if(pStreamWriter){
+        const bool closed = pStreamWriter->close(handler);
+        pStreamWriter.reset();
+        return closed;
+    }
+
+    SNDFILE *file = pWriteFile;
+    pWriteFile = nullptr;
+    return close_file(file, true, handler);
+}
+
+void AJ::io::file_streamer::FileStreamer::writeBuffer(AJ::utils::Buffer* buffer, AJ::error::IErrorHandler &handler){
+    if(!discardOldest()){
+        AJ_TRACE_ZONE("io", "block_write");
+        const uint64_t start = writeStart();
+
+        if(pStreamWriter){
+            //* the buffer is copied into the batch and recycled right away.
+            size_t frames = 0;
+            const float *data = convert(buffer, frames);
+            pStreamWriter->append(data, frames, handler);
+        } else {
+            writeInterleaved(pWriteFile, buffer, handler);
+        }
+
+        noteWritten(buffer, start);
+    }
+}
+
+void AJ::io::file_streamer::FileStreamer::noteQueueDepth() noexcept {
+    if(!pCounters && !pMetrics){
+        return;
+    }
+
+    const uint64_t depth = pQueue->currentSize();
+    if(pCounters && depth > pCounters->maxQueueDepth.load(std::memory_order_relaxed)){
+        pCounters->maxQueueDepth.store(depth, std::memory_order_relaxed);
+    }
+
+    if(pMetrics){
+        pMetrics->raise(AJ::utils::Peak::QueueDepth, depth);
+    }
+}
+
+bool AJ::io::file_streamer::FileStreamer::discardOldest() noexcept {
+    if(!pCounters){
+        return false;
+    }
+
+    const uint64_t served = pCounters->discarded.load(std::memory_order_relaxed);
+
+    if(pCounters->discardRequests.load(std::memory_order_acquire) <= served){
+        return false;
+    }
+
+    pCounters->discarded.store(served + 1, std::memory_order_relaxed);
     return true;
 }
 
-bool AJ::io::file_streamer::FileStreamer::setReadInfo(const AudioInfo& info, AJ::error::IErrorHandler &handler){
-    // TODO: implement this function.
-    return false;
+bool AJ::io::file_streamer::FileStreamer::setReadInfo(const std::string& path, AJ::error::IErrorHandler &handler){
+    std::string file_path = path;
+
+    if(!AJ::utils::FileUtils::file_exists(file_path)){
+        const std::string message = "Error: file not found: " + path + "\n";
+        handler.onError(AJ::error::Error::FileNotFound, message);
+        return false;
+    }
+
+    const std::string ext = AJ::utils::FileUtils::get_file_extension(file_path);
+
+    auto info = std::make_shared<AJ::AudioInfo>();
+
+    if(ext == "wav" || ext == "WAV"){
+        info->format = "wav";
+    } else if(ext == "mp3" || ext == "MP3"){
+        info->format = "mp3";
+    } else {
+        const std::string message = "Error: only WAV and MP3 files can be streamed.\n";
+        handler.onError(AJ::error::Error::UnsupportedFileFormat, message);
+        return false;
+    }
+
+    //* probe the header, read() opens the file again.
+    pReadInfo = info;
+    mReadPath = path;
+
+    if(!openRead(handler)){
+        pReadInfo = nullptr;
+        return false;
+    }
+
+    closeRead(handler);
+
+    if(info->channels < 1 || info->channels > kNumChannels || info->channels != pBufferPool->channels()){
+        const std::string message = "Error: the channels of the file don't match the buffers of the pool.\n";
+        handler.onError(AJ::error::Error::InvalidChannelCount, message);
+        pReadInfo = nullptr;
+        return false;
+    }
+
+    return true;
 }
 
 bool AJ::io::file_streamer::FileStreamer::setWriteInfo(const AudioWriteInfo& info, AJ::error::IErrorHandler &handler){
@@ -111,12 +561,7 @@ bool AJ::io::file_streamer::FileStreamer::setWriteInfo(const AudioWriteInfo& inf
         return false;
     } 
 
-    const std::unordered_set<sample_c> validRates = {
-        8000, 11025, 12000, 16000, 22050,
-        24000, 32000, 44100, 48000
-    };
-
-    if (validRates.find(info.samplerate) == validRates.end()) {
+    if (info.samplerate < kMinSamplerate || info.samplerate > kMaxSamplerate) {
         const std::string message = "Error: unsupported samplerate.\n";
 
         handler.onError(AJ::error::Error::InvalidSampleRate, message);
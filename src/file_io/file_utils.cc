@@ -2,6 +2,11 @@
 
 #include <filesystem>
 #include <algorithm>
+#include <cerrno>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
 
 
 
@@ -101,3 +106,24 @@ std::string AJ::utils::FileUtils::get_file_extension(std::string& path) {
     return path.substr(dotPos + 1);
 }
 
+bool AJ::utils::FileUtils::write_all(int fd, const void *data, size_t bytes, uint64_t offset) noexcept {
+#if defined(__linux__)
+    const uint8_t *p = static_cast<const uint8_t*>(data);
+    while(bytes > 0){
+        const ssize_t written = pwrite(fd, p, bytes, static_cast<off_t>(offset));
+
+        if(written < 0){
+            if(errno == EINTR) continue;
+            return false;
+        }
+
+        p += written;
+        bytes -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "file_io/level_index.h"
+#include "dsp/kernels.h"
+
+void AJ::io::LevelIndex::build(const AudioBuffer &audio, uint8_t channels){
+    for(uint8_t ch = 0; ch < kNumChannels; ++ch){
+        if(ch < channels){
+            mFrames[ch] = 0;
+            update(audio[ch], ch, 0);
+            continue;
+        }
+
+        for(auto &level : mChannels[ch]) level.clear();
+        mFrames[ch] = 0;
+    }
+
+    mLoudness.clear();
+}
+
+void AJ::io::LevelIndex::update(const Float &samples, uint8_t channel, sample_pos start, sample_pos end){
+    Pyramid &pyramid = mChannels[channel];
+    const size_t frames = samples.size();
+
+    if(frames == 0){
+        for(auto &level : pyramid) level.clear();
+        mFrames[channel] = 0;
+        mLoudness.clear();
+        return;
+    }
+
+    //* a length change shifts everything after `start`.
+    const sample_pos last_frame = static_cast<sample_pos>(frames) - 1;
+    if(end < 0 || frames != mFrames[channel] || end > last_frame){
+        end = last_frame;
+    }
+
+    // start past the new end (e.g. cut at the end): the last block lost frames, recompute it.
+    start = std::clamp<sample_pos>(start, 0, end);
+    mFrames[channel] = frames;
+
+    mLoudness.erase(std::remove_if(mLoudness.begin(), mLoudness.end(), [&](const LoudnessEntry &entry){
+        return entry.mEnd >= start && entry.mStart <= end;
+    }), mLoudness.end());
+
+    const dsp::kernels::AnalyzeFn analyze = dsp::kernels::table().analyze;
+
+    //* finest level straight from the samples.
+    size_t first = start / kLevelIndexBaseFrames;
+    size_t last = end / kLevelIndexBaseFrames;
+
+    auto &base = pyramid[0];
+    base.resize((frames + kLevelIndexBaseFrames - 1) / kLevelIndexBaseFrames);
+
+    for(size_t b = first; b <= last; ++b){
+        const size_t offset = b * kLevelIndexBaseFrames;
+        base[b] = analyze(samples.data() + offset, std::min(kLevelIndexBaseFrames, frames - offset));
+    }
+
+    //* every next level merges kLevelIndexFanout blocks of the level below.
+    for(size_t l = 1; l < kLevelIndexDepth; ++l){
+        const auto &below = pyramid[l - 1];
+        auto &level = pyramid[l];
+
+        first /= kLevelIndexFanout;
+        last /= kLevelIndexFanout;
+        level.resize((below.size() + kLevelIndexFanout - 1) / kLevelIndexFanout);
+
+        for(size_t b = first; b <= last; ++b){
+            const size_t child_end = std::min((b + 1) * kLevelIndexFanout, below.size());
+
+            dsp::kernels::Levels levels = below[b * kLevelIndexFanout];
+            for(size_t c = b * kLevelIndexFanout + 1; c < child_end; ++c){
+                levels = dsp::kernels::combine(levels, below[c]);
+            }
+
+            level[b] = levels;
+        }
+    }
+}
+
+AJ::dsp::kernels::Levels AJ::io::LevelIndex::query(const Float &samples, uint8_t channel,
+    sample_pos start, sample_pos end) const {
+    const Pyramid &pyramid = mChannels[channel];
+    const dsp::kernels::AnalyzeFn analyze = dsp::kernels::table().analyze;
+
+    dsp::kernels::Levels levels{FLT_MAX, -FLT_MAX, 0.0};
+
+    size_t pos = static_cast<size_t>(start);
+    const size_t stop = static_cast<size_t>(end) + 1;
+
+    while(pos < stop){
+        const size_t remaining = stop - pos;
+
+        //* partial base block at the edges: read the samples.
+        if(pos % kLevelIndexBaseFrames != 0 || remaining < kLevelIndexBaseFrames){
+            const size_t count = std::min(remaining, kLevelIndexBaseFrames - pos % kLevelIndexBaseFrames);
+            levels = dsp::kernels::combine(levels, analyze(samples.data() + pos, count));
+            pos += count;
+            continue;
+        }
+
+        //* largest aligned block that fits in what's left of the range.
+        size_t l = kLevelIndexDepth - 1;
+        while(pos % blockFrames(l) != 0 || remaining < blockFrames(l)){
+            --l;
+        }
+
+        levels = dsp::kernels::combine(levels, pyramid[l][pos / blockFrames(l)]);
+        pos += blockFrames(l);
+    }
+
+    return levels;
+}
+
+const AJ::dsp::loudness::Measurement* AJ::io::LevelIndex::loudness(sample_pos start, sample_pos end,
+    uint32_t samplerate) const {
+    for(const LoudnessEntry &entry : mLoudness){
+        if(entry.mStart == start && entry.mEnd == end && entry.mSamplerate == samplerate){
+            return &entry.mMeasurement;
+        }
+    }
+
+    return nullptr;
+}
+
+void AJ::io::LevelIndex::storeLoudness(sample_pos start, sample_pos end, uint32_t samplerate,
+    const dsp::loudness::Measurement &measurement){
+    if(mLoudness.size() == kLevelIndexLoudnessEntries){
+        mLoudness.erase(mLoudness.begin());
+    }
+
+    mLoudness.push_back({start, end, samplerate, measurement});
+}
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <cstring>
+
+#include "file_io/mapped_wav.h"
+#include "dsp/kernels.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint16_t kWaveFormatPCM = 0x0001;
+constexpr uint16_t kWaveFormatFloat = 0x0003;
+constexpr uint16_t kWaveFormatExtensible = 0xFFFE;
+
+//* WAV is little endian, unaligned loads through memcpy.
+inline uint16_t load_u16(const uint8_t* p) noexcept {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t load_u32(const uint8_t* p) noexcept {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t load_u64(const uint8_t* p) noexcept {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline float sample_to_float(const uint8_t* p, AJ::BitDepth_t depth) noexcept {
+    switch(depth){
+        case AJ::BitDepth_t::int_8:
+            return (static_cast<int>(p[0]) - 128) * (1.0f / 128.0f); // 8-bit WAV is unsigned
+
+        case AJ::BitDepth_t::int_16:
+            return static_cast<int16_t>(load_u16(p)) * (1.0f / 32768.0f);
+
+        case AJ::BitDepth_t::int_24: {
+            int32_t v = static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 8 |
+                static_cast<uint32_t>(p[1]) << 16 | static_cast<uint32_t>(p[2]) << 24) >> 8;
+            return v * (1.0f / 8388608.0f);
+        }
+
+        case AJ::BitDepth_t::int_32:
+            return static_cast<float>(static_cast<int32_t>(load_u32(p)) * (1.0 / 2147483648.0));
+
+        case AJ::BitDepth_t::float_32: {
+            float v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        case AJ::BitDepth_t::float_64: {
+            double v;
+            std::memcpy(&v, p, sizeof(v));
+            return static_cast<float>(v);
+        }
+
+        default:
+            return 0.0f;
+    }
+}
+
+//* one loop per encoding so the switch stays out of the per-sample path.
+template <AJ::BitDepth_t Depth>
+void convert_frames(const uint8_t* frame, size_t frames, size_t stride, uint16_t channels,
+    float* const* outs) noexcept {
+    constexpr size_t bytes = Depth == AJ::BitDepth_t::int_8 ? 1 : Depth == AJ::BitDepth_t::int_16 ? 2 :
+        Depth == AJ::BitDepth_t::int_24 ? 3 : Depth == AJ::BitDepth_t::float_64 ? 8 : 4;
+
+    for(size_t i = 0; i < frames; ++i, frame += stride){
+        for(uint16_t ch = 0; ch < channels; ++ch){
+            if(outs[ch]) outs[ch][i] = sample_to_float(frame + ch * bytes, Depth);
+        }
+    }
+}
+
+void convert(AJ::BitDepth_t depth, const uint8_t* frame, size_t frames, size_t stride,
+    uint16_t channels, float* const* outs) noexcept {
+    switch(depth){
+        case AJ::BitDepth_t::int_8:    convert_frames<AJ::BitDepth_t::int_8>(frame, frames, stride, channels, outs); break;
+        case AJ::BitDepth_t::int_16:   convert_frames<AJ::BitDepth_t::int_16>(frame, frames, stride, channels, outs); break;
+        case AJ::BitDepth_t::int_24:   convert_frames<AJ::BitDepth_t::int_24>(frame, frames, stride, channels, outs); break;
+        case AJ::BitDepth_t::int_32:   convert_frames<AJ::BitDepth_t::int_32>(frame, frames, stride, channels, outs); break;
+        case AJ::BitDepth_t::float_32: convert_frames<AJ::BitDepth_t::float_32>(frame, frames, stride, channels, outs); break;
+        case AJ::BitDepth_t::float_64: convert_frames<AJ::BitDepth_t::float_64>(frame, frames, stride, channels, outs); break;
+        default: break;
+    }
+}
+
+}
+
+AJ::io::MappedWav::~MappedWav(){
+    close();
+}
+
+bool AJ::io::MappedWav::open(const std::string& path, bool sequential){
+    close();
+
+#if defined(__linux__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < 44){
+        ::close(fd);
+        return false;
+    }
+
+    void* ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file open.
+
+    if(ptr == MAP_FAILED) return false;
+
+    pMap = static_cast<const uint8_t*>(ptr);
+    mMapSize = static_cast<size_t>(st.st_size);
+
+    if(!parse()){
+        close();
+        return false;
+    }
+
+    if(sequential){
+        madvise(const_cast<uint8_t*>(pMap), mMapSize, MADV_SEQUENTIAL);
+    }
+
+    return true;
+#else
+    //? no mmap (or a big endian host): the caller reads through libsndfile.
+    (void)path;
+    (void)sequential;
+    return false;
+#endif
+}
+
+void AJ::io::MappedWav::close() noexcept {
+#if defined(__linux__)
+    if(pMap) munmap(const_cast<uint8_t*>(pMap), mMapSize);
+#endif
+    pMap = nullptr;
+    mMapSize = 0;
+    pSamples = nullptr;
+    mFrames = 0;
+    mChannels = 0;
+    mBytesPerSample = 0;
+    mBlockAlign = 0;
+    mSamplerate = 0;
+    mBitDepth = Not_Supported;
+}
+
+void AJ::io::MappedWav::prefetch(size_t start, size_t count) const noexcept {
+    if(!pSamples || start >= mFrames){
+        return;
+    }
+    count = std::min(count, mFrames - start);
+
+#if defined(__linux__)
+    //* madvise works on whole pages.
+    const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t first = reinterpret_cast<uintptr_t>(pSamples + start * mBlockAlign);
+    const uintptr_t begin = first & ~(page - 1);
+    const uintptr_t end = first + count * mBlockAlign;
+
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+#endif
+}
+
+bool AJ::io::MappedWav::parse() noexcept {
+    //* RF64 keeps the real data size in its ds64 chunk, the 32-bit field is 0xFFFFFFFF.
+    const bool rf64 = std::memcmp(pMap, "RF64", 4) == 0;
+    if((!rf64 && std::memcmp(pMap, "RIFF", 4) != 0) || std::memcmp(pMap + 8, "WAVE", 4) != 0) return false;
+
+    const uint8_t* end = pMap + mMapSize;
+    const uint8_t* chunk = pMap + 12;
+    bool has_fmt = false;
+    uint16_t format = 0, bits = 0;
+    uint64_t ds64_data = 0;
+
+    while(chunk + 8 <= end){
+        const uint32_t chunk_size = load_u32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        const size_t available = static_cast<size_t>(end - body);
+
+        if(std::memcmp(chunk, "fmt ", 4) == 0){
+            if(chunk_size < 16 || available < 16) return false;
+
+            format = load_u16(body);
+            mChannels = load_u16(body + 2);
+            mSamplerate = static_cast<int>(load_u32(body + 4));
+            mBlockAlign = load_u16(body + 12);
+            bits = load_u16(body + 14);
+
+            //* extensible: the real format is the first two bytes of the sub-format GUID.
+            if(format == kWaveFormatExtensible){
+                if(chunk_size < 40 || available < 40) return false;
+                format = load_u16(body + 24);
+            }
+
+            has_fmt = true;
+        } else if(rf64 && std::memcmp(chunk, "ds64", 4) == 0){
+            if(chunk_size < 24 || available < 24) return false;
+            ds64_data = load_u64(body + 8);
+        } else if(std::memcmp(chunk, "data", 4) == 0){
+            if(!has_fmt) return false;
+
+            if(format == kWaveFormatPCM){
+                mBitDepth = bits == 8 ? BitDepth_t::int_8 : bits == 16 ? BitDepth_t::int_16 :
+                    bits == 24 ? BitDepth_t::int_24 : bits == 32 ? BitDepth_t::int_32 : Not_Supported;
+            } else if(format == kWaveFormatFloat){
+                mBitDepth = bits == 32 ? BitDepth_t::float_32 : bits == 64 ? BitDepth_t::float_64 : Not_Supported;
+            }
+
+            mBytesPerSample = bits / 8;
+            if(mBitDepth == Not_Supported || mChannels == 0 || mBlockAlign < mChannels * mBytesPerSample){
+                return false;
+            }
+
+            //? a truncated file (or a streamed header with a 0 / 0xFFFFFFFF size) keeps what's mapped.
+            uint64_t data_bytes = rf64 && chunk_size == UINT32_MAX ? ds64_data : chunk_size;
+            if(data_bytes == 0 || data_bytes > available) data_bytes = available;
+
+            pSamples = body;
+            mFrames = static_cast<size_t>(data_bytes / mBlockAlign);
+            return true;
+        }
+
+        //* chunks are padded to an even size.
+        const size_t skip = static_cast<size_t>(chunk_size) + (chunk_size & 1);
+        if(skip > available) break;
+        chunk = body + skip;
+    }
+
+    return false;
+}
+
+size_t AJ::io::MappedWav::read(uint16_t channel, size_t start, size_t count, float* out) const noexcept {
+    if(!pSamples || channel >= mChannels || start >= mFrames) return 0;
+
+    count = std::min(count, mFrames - start);
+
+    //* a single channel view: start at the channel's sample, same frame stride.
+    float* outs[1] = {out};
+    convert(mBitDepth, pSamples + start * mBlockAlign + channel * mBytesPerSample, count, mBlockAlign, 1, outs);
+    return count;
+}
+
+size_t AJ::io::MappedWav::readPlanar(size_t start, size_t count, float* const* outs) const noexcept {
+    if(!pSamples || start >= mFrames) return 0;
+
+    count = std::min(count, mFrames - start);
+    const uint8_t *first = pSamples + start * mBlockAlign;
+
+    if(readStereo(first, count, outs)){
+        return count;
+    }
+
+    convert(mBitDepth, first, count, mBlockAlign, mChannels, outs);
+    return count;
+}
+
+bool AJ::io::MappedWav::readStereo(const uint8_t *first, size_t count, float* const* outs) const noexcept {
+    //* packed stereo float / 16-bit, aligned to the sample size: SIMD kernels instead of the generic loop.
+    if(mChannels != 2 || !outs[0] || !outs[1] || mBlockAlign != 2 * mBytesPerSample
+        || reinterpret_cast<uintptr_t>(first) % mBytesPerSample != 0){
+        return false;
+    }
+
+    const dsp::kernels::KernelTable &kernels = dsp::kernels::table();
+
+    if(mBitDepth == BitDepth_t::float_32){
+        kernels.deinterleave(reinterpret_cast<const float*>(first), outs[0], outs[1], count);
+        return true;
+    }
+
+    if(mBitDepth != BitDepth_t::int_16){
+        return false;
+    }
+
+    // converted through a small interleaved scratch on the stack.
+    constexpr size_t kScratchFrames = 1024;
+    float scratch[2 * kScratchFrames];
+    const int16_t *samples = reinterpret_cast<const int16_t*>(first);
+
+    for(size_t done = 0; done < count; done += kScratchFrames){
+        const size_t n = std::min(kScratchFrames, count - done);
+
+        kernels.fromInt16(samples + 2 * done, scratch, 2 * n);
+        kernels.deinterleave(scratch, outs[0] + done, outs[1] + done, n);
+    }
+
+    return true;
+}
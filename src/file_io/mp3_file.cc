@@ -1,8 +1,17 @@
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 #include "file_io/mp3_file.h"
+#include "file_io/mp3_stream_encoder.h"
 #include "core/error_handler.h"
 #include "core/types.h"
+#include "core/constants.h"
+#include "core/trace.h"
+#include "dsp/kernels.h"
 
 extern "C"{
     #include <libavformat/avformat.h> 
@@ -12,6 +21,30 @@ extern "C"{
     #include <libswresample/swresample.h>
 }
 
+namespace {
+
+//* samples per channel a packet decodes to (its duration, or the codec frame size if the demuxer gave none).
+int64_t packet_frames(const AVPacket *packet, const AVStream *stream, int samplerate) {
+    if (packet->duration > 0) {
+        return av_rescale_q(packet->duration, stream->time_base, AVRational{1, samplerate});
+    }
+    return stream->codecpar->frame_size;
+}
+
+//* samples the decoder drops from the start of the stream with this packet (the encoder delay).
+uint8_t* packet_skip_data(const AVPacket *packet) {
+    size_t size = 0;
+    uint8_t *data = av_packet_get_side_data(packet, AV_PKT_DATA_SKIP_SAMPLES, &size);
+    return size >= 4 ? data : nullptr;
+}
+
+int64_t packet_skip(const AVPacket *packet) {
+    const uint8_t *data = packet_skip_data(packet);
+    return data ? static_cast<int64_t>(data[0] | data[1] << 8 | data[2] << 16 | static_cast<uint32_t>(data[3]) << 24) : 0;
+}
+
+}
+
 void AJ::io::MP3_File::setAudioInfo(AVCodecContext *decoder_ctx, sample_c &total_samples_per_chan){
     mInfo.samplerate = decoder_ctx->sample_rate;
     mInfo.channels = decoder_ctx->ch_layout.nb_channels;
@@ -120,19 +153,55 @@ bool AJ::io::MP3_File::initDecoder(AJ::error::IErrorHandler &handler){
     return true;
 }
 
+size_t AJ::io::MP3_File::durationFrames(int samplerate) const {
+    const AVStream *stream = mDecoderInfo.format_ctx->streams[mDecoderInfo.stream_idx];
+
+    int64_t frames = 0;
+    if(stream->duration != AV_NOPTS_VALUE && stream->duration > 0){
+        frames = av_rescale_q(stream->duration, stream->time_base, AVRational{1, samplerate});
+    } else if(mDecoderInfo.format_ctx->duration != AV_NOPTS_VALUE && mDecoderInfo.format_ctx->duration > 0){
+        frames = av_rescale(mDecoderInfo.format_ctx->duration, samplerate, AV_TIME_BASE);
+    }
+
+    return frames > 0 ? static_cast<size_t>(frames) : 0;
+}
+
+bool AJ::io::MP3_File::convertFrame(SwrContext *resampler, const AVFrame *frame, AudioBuffer &out, int channels,
+    size_t &written, AJ::error::IErrorHandler &handler){
+    //* the channels only grow past the reserved size if the duration estimate was short.
+    const int max_out = swr_get_out_samples(resampler, frame ? frame->nb_samples : 0);
+    if(max_out <= 0){
+        return true;
+    }
+
+    uint8_t *planes[kNumChannels] = {};
+    for(int ch = 0; ch < channels; ++ch){
+        Float &samples = out[ch];
+        samples.resize(written + max_out);
+        planes[ch] = reinterpret_cast<uint8_t*>(samples.data() + written);
+    }
+
+    const int converted = swr_convert(resampler, planes, max_out,
+        frame ? const_cast<const uint8_t**>(frame->extended_data) : nullptr, frame ? frame->nb_samples : 0);
+
+    if(converted < 0){
+        const std::string message = "Couldn't resample audio frame.\n";
+        handler.onError(error::Error::FileReadError, message);
+        return false;
+    }
+
+    written += converted;
+    return true;
+}
+
 bool AJ::io::MP3_File::decode(AJ::error::IErrorHandler &handler) {
     // allocate packet.
     AVPacket *packet = av_packet_alloc();
     
     // init frame.
     AVFrame *frame = av_frame_alloc();
-    
-    frame->format = mDecoderInfo.decoder_params->format;
-    frame->sample_rate = mDecoderInfo.decoder_params->sample_rate;
-    frame->ch_layout = mDecoderInfo.decoder_params->ch_layout;
-    frame->nb_samples = mDecoderInfo.decoder_params->frame_size;
 
-    // Create resampler
+    // Create resampler: decoder format -> planar float, written straight into pAudio.
     SwrContext *resampler = swr_alloc();
     const AVChannelLayout *chan_layout = &mDecoderInfo.decoder_ctx->ch_layout;
 
@@ -141,175 +210,320 @@ bool AJ::io::MP3_File::decode(AJ::error::IErrorHandler &handler) {
         AV_SAMPLE_FMT_FLTP,
         mDecoderInfo.decoder_params->sample_rate,
         chan_layout,
-        (AVSampleFormat)frame->format,
+        (AVSampleFormat)mDecoderInfo.decoder_params->format,
         mDecoderInfo.decoder_params->sample_rate,
         0, nullptr
     );
 
-    if(ret != 0 || swr_init(resampler) != 0) {
-        const std::string message = "Couldn't initialize audio resampler.\n";
-        handler.onError(error::Error::FileWriteError, message);
+    auto cleanup = [&](){
+        //? decoder_params is the stream's codecpar, freed with the format context.
+        avformat_close_input(&mDecoderInfo.format_ctx);
+        mDecoderInfo.decoder_params = nullptr;
+        avcodec_free_context(&mDecoderInfo.decoder_ctx);
+        av_frame_free(&frame);
         swr_free(&resampler);
+        av_packet_free(&packet);
+    };
+
+    if(ret != 0 || swr_init(resampler) != 0 || !packet || !frame) {
+        const std::string message = "Couldn't initialize audio resampler.\n";
+        handler.onError(error::Error::FileReadError, message);
+        cleanup();
         return false;
     }
 
     /*
-    * Read audio in fixed-size chunks to prevent AVAudioFifo from exceeding its capacity
-    * or causing realloc failures.
-    * Each chunk is appended to temporary buffers for efficient accumulation.
-    * Once the entire file is processed, move the accumulated data into the pAudio buffers.
+    * Reserve the channels once from the stream duration, then every decoded frame is
+    * converted in place at the end of the channels: no FIFO, no temporary buffers and
+    * no regrowth unless the header underestimates the length.
     */
+    const int channels = chan_layout->nb_channels;
 
-    // Use 1MB chunk size.
-    const size_t CHUNK_SIZE = (1024 * 1024) / (sizeof(float) * mDecoderInfo.decoder_ctx->ch_layout.nb_channels);
-    
-    // Initialize vectors for each channel
-    std::vector<std::vector<float>> temp_buffers(mDecoderInfo.decoder_ctx->ch_layout.nb_channels);
-    
-    // Initialize FIFO for chunk processing
-    mDecoderInfo.fifo = av_audio_fifo_alloc(
-        AV_SAMPLE_FMT_FLTP,
-        mDecoderInfo.decoder_ctx->ch_layout.nb_channels,
-        CHUNK_SIZE  // Initial size matches our chunk size
-    );
+    //* headers round the duration, leave room for a couple of codec frames.
+    size_t estimate = durationFrames(mDecoderInfo.decoder_ctx->sample_rate);
+    if(estimate > 0) estimate += 2 * kMP3MaxFrameSamples;
 
-    if (!mDecoderInfo.fifo) {
-        const std::string message = "Couldn't allocate FIFO.\n";
-        handler.onError(error::Error::FileReadError, message);
-        return false;
+    for (int ch = 0; ch < channels; ch++) {
+        pAudio->at(ch).clear();
+        pAudio->at(ch).reserve(estimate);
     }
 
+    size_t written = 0;
     bool end_of_file = false;
-    while (!end_of_file) {
-        // Read packets until FIFO is full enough or file ends
-        while (av_audio_fifo_size(mDecoderInfo.fifo) < CHUNK_SIZE) {
-            if (av_read_frame(mDecoderInfo.format_ctx, packet) < 0) {
-                end_of_file = true;
-                break;
-            }
 
+    const AVStream *stream = mDecoderInfo.format_ctx->streams[mDecoderInfo.stream_idx];
+    const int samplerate = mDecoderInfo.decoder_ctx->sample_rate;
+    const bool indexed = mDecoderInfo.decoder_params->codec_id == AV_CODEC_ID_MP3;
+    auto index = indexed ? std::make_shared<SeekIndex>() : nullptr;
+
+    while (!end_of_file) {
+        if (av_read_frame(mDecoderInfo.format_ctx, packet) < 0) {
+            // end of file: drain the frames still in the decoder.
+            end_of_file = true;
+            ret = avcodec_send_packet(mDecoderInfo.decoder_ctx, nullptr);
+        } else {
             if (packet->stream_index != mDecoderInfo.stream_idx) {
                 av_packet_unref(packet);
                 continue;
             }
 
+            if (index) {
+                index->append(packet->pos, packet_frames(packet, stream, samplerate), packet_skip(packet));
+            }
+
             ret = avcodec_send_packet(mDecoderInfo.decoder_ctx, packet);
             av_packet_unref(packet);
+        }
 
-            if (ret < 0 && ret != AVERROR(EAGAIN)) {
-                const std::string message = "Couldn't decode packets.\n";
-                handler.onError(error::Error::FileReadError, message);
-
-                avformat_close_input(&mDecoderInfo.format_ctx);
-                avcodec_parameters_free(&mDecoderInfo.decoder_params);
-                av_frame_free(&frame);
-                swr_free(&resampler);
-                av_packet_free(&packet);
-                av_audio_fifo_free(mDecoderInfo.fifo);
+        if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+            const std::string message = "Couldn't decode packets.\n";
+            handler.onError(error::Error::FileReadError, message);
+            cleanup();
+            return false;
+        }
+
+        // Get all available frames
+        while (avcodec_receive_frame(mDecoderInfo.decoder_ctx, frame) == 0) {
+            const bool converted = convertFrame(resampler, frame, *pAudio, channels, written, handler);
+            av_frame_unref(frame);
+
+            if (!converted) {
+                cleanup();
                 return false;
             }
+        }
+    }
 
-            // Get all available frames
-            while ((ret = avcodec_receive_frame(mDecoderInfo.decoder_ctx, frame)) == 0) {
-                AVFrame *resampled = av_frame_alloc();
-                resampled->ch_layout = frame->ch_layout;
-                resampled->format = AV_SAMPLE_FMT_FLTP;
-                resampled->sample_rate = frame->sample_rate;
+    // samples the resampler still buffers.
+    if (!convertFrame(resampler, nullptr, *pAudio, channels, written, handler)) {
+        cleanup();
+        return false;
+    }
 
-                ret = swr_convert_frame(resampler, resampled, frame);
-                av_frame_unref(frame);
+    // drop the unused tail of the last conversion, give back a badly overestimated reservation.
+    for (int ch = 0; ch < channels; ch++) {
+        Float &samples = pAudio->at(ch);
+        samples.resize(written);
 
-                if (ret < 0) {
-                    const std::string message = "Couldn't resample audio frame.\n";
-                    handler.onError(error::Error::FileReadError, message);
-
-                    av_frame_free(&resampled);
-                    avformat_close_input(&mDecoderInfo.format_ctx);
-                    avcodec_parameters_free(&mDecoderInfo.decoder_params);
-                    av_frame_free(&frame);
-                    swr_free(&resampler);
-                    av_packet_free(&packet);
-                    av_audio_fifo_free(mDecoderInfo.fifo);
-                    return false;
-                }
+        if (samples.capacity() - written > written / 8 + kMP3MaxFrameSamples) {
+            samples.shrink_to_fit();
+        }
+    }
 
-                // Write to FIFO
-                if (av_audio_fifo_write(mDecoderInfo.fifo, (void**)resampled->data, resampled->nb_samples) != resampled->nb_samples) {
-                    const std::string message = "Couldn't write to FIFO.\n";
-                    handler.onError(error::Error::FileReadError, message);
-                    
-                    av_frame_free(&resampled);
-                    avformat_close_input(&mDecoderInfo.format_ctx);
-                    avcodec_parameters_free(&mDecoderInfo.decoder_params);
-                    av_frame_free(&frame);
-                    swr_free(&resampler);
-                    av_packet_free(&packet);
-                    av_audio_fifo_free(mDecoderInfo.fifo);
-                    return false;
-                }
+    mDecoderInfo.total_samples_per_chan = written;
+    setAudioInfo(mDecoderInfo.decoder_ctx, mDecoderInfo.total_samples_per_chan);
+    pSeekIndex = std::move(index);
 
-                av_frame_free(&resampled);
-            }
+    cleanup();
+    return true;
+}
+
+namespace {
+
+//* a run of packets decoded by one worker into its own channels.
+struct Segment {
+    size_t begin = 0;                           // first packet of the run
+    size_t end = 0;                             // one past its last packet
+    AJ::AudioBuffer audio;
+    size_t frames = 0;
+    AJ::error::CollectingErrorHandler errors;   // replayed by the caller
+};
+
+}
+
+bool AJ::io::MP3_File::decodeSegmented(AJ::error::IErrorHandler &handler) {
+    std::vector<AVPacket*> packets;
+    AVPacket *packet = av_packet_alloc();
+
+    auto cleanup = [&](){
+        for (AVPacket *kept : packets) {
+            av_packet_free(&kept);
         }
+        av_packet_free(&packet);
 
-        // Read from FIFO and append to our temp buffers
-        const int available_samples = av_audio_fifo_size(mDecoderInfo.fifo);
-        if (available_samples > 0) {
-            // Temporary buffers for each channel
-            std::vector<float*> channel_buffers(mDecoderInfo.decoder_ctx->ch_layout.nb_channels);
-            for (int ch = 0; ch < mDecoderInfo.decoder_ctx->ch_layout.nb_channels; ch++) {
-                channel_buffers[ch] = new float[available_samples];
-            }
+        avformat_close_input(&mDecoderInfo.format_ctx);
+        mDecoderInfo.decoder_params = nullptr;
+        avcodec_free_context(&mDecoderInfo.decoder_ctx);
+    };
+
+    if (!packet) {
+        const std::string message = "Couldn't allocate a packet for the file: " + mFilePath + "\n";
+        handler.onError(error::Error::ResourceAllocationFailed, message);
+        cleanup();
+        return false;
+    }
+
+    //* 1. demux: the packets of the audio stream, in order (and the seek index on the way).
+    const AVStream *stream = mDecoderInfo.format_ctx->streams[mDecoderInfo.stream_idx];
+    const int samplerate = mDecoderInfo.decoder_ctx->sample_rate;
+    auto index = std::make_shared<SeekIndex>();
+
+    size_t bytes = 0;
+    while (av_read_frame(mDecoderInfo.format_ctx, packet) >= 0) {
+        if (packet->stream_index != mDecoderInfo.stream_idx) {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        AVPacket *kept = av_packet_alloc();
+        if (!kept) {
+            const std::string message = "Couldn't allocate a packet for the file: " + mFilePath + "\n";
+            handler.onError(error::Error::ResourceAllocationFailed, message);
+            av_packet_unref(packet);
+            cleanup();
+            return false;
+        }
+
+        index->append(packet->pos, packet_frames(packet, stream, samplerate), packet_skip(packet));
+
+        av_packet_move_ref(kept, packet);
+        bytes += kept->size;
+        packets.push_back(kept);
+    }
+
+    //* 2. runs of even byte counts, cut at the next packet (frame) boundary.
+    const size_t workers = pReadPool ? pReadPool->size() + 1 : 1;
+    const size_t count = std::clamp<size_t>(packets.size() / kMP3SegmentMinPackets, 1, workers);
+    std::vector<Segment> segments(count);
 
-            // Read from FIFO
-            if (av_audio_fifo_read(mDecoderInfo.fifo, (void**)channel_buffers.data(), available_samples) < available_samples) {
-                const std::string message = "Couldn't read from FIFO.\n";
-                handler.onError(error::Error::FileReadError, message);
-
-                avformat_close_input(&mDecoderInfo.format_ctx);
-                avcodec_parameters_free(&mDecoderInfo.decoder_params);
-                av_frame_free(&frame);
-                swr_free(&resampler);
-                av_packet_free(&packet);
-                av_audio_fifo_free(mDecoderInfo.fifo);
+    size_t next = 0;
+    size_t taken = 0;
+    for (size_t s = 0; s < count; ++s) {
+        const size_t target = s + 1 == count ? bytes : bytes / count * (s + 1);
+        segments[s].begin = next;
+
+        while (next < packets.size() && (taken < target || s + 1 == count)) {
+            taken += packets[next++]->size;
+        }
+        segments[s].end = next;
+    }
+
+    //* 3. decode every run on its own decoder, primed with the packets before it.
+    const int channels = mDecoderInfo.decoder_ctx->ch_layout.nb_channels;
+
+    auto decode_segment = [&](Segment &segment, bool last){
+        AVCodecContext *decoder_ctx = avcodec_alloc_context3(mDecoderInfo.decoder);
+        AVFrame *frame = av_frame_alloc();
+        SwrContext *resampler = nullptr;
+
+        auto release = [&](){
+            avcodec_free_context(&decoder_ctx);
+            av_frame_free(&frame);
+            swr_free(&resampler);
+        };
+
+        if (!decoder_ctx || !frame
+            || avcodec_parameters_to_context(decoder_ctx, mDecoderInfo.decoder_params) < 0
+            || (decoder_ctx->ch_layout.nb_channels == 0 && av_channel_layout_default(&decoder_ctx->ch_layout, channels) < 0)
+            || avcodec_open2(decoder_ctx, mDecoderInfo.decoder, nullptr) < 0
+            || swr_alloc_set_opts2(&resampler, &decoder_ctx->ch_layout, AV_SAMPLE_FMT_FLTP, samplerate,
+                &decoder_ctx->ch_layout, decoder_ctx->sample_fmt, samplerate, 0, nullptr) != 0
+            || swr_init(resampler) != 0) {
+            const std::string message = "Couldn't open a segment decoder for the file: " + mFilePath + "\n";
+            segment.errors.onError(error::Error::FileReadError, message);
+            release();
+            return;
+        }
+
+        // reserved from the packet durations, like decode() from the stream duration.
+        int64_t duration = 0;
+        for (size_t i = segment.begin; i < segment.end; ++i) {
+            duration += std::max<int64_t>(packets[i]->duration, 0);
+        }
+
+        const size_t estimate = static_cast<size_t>(av_rescale_q(duration, stream->time_base, AVRational{1, samplerate}));
+        for (int ch = 0; ch < channels; ch++) {
+            segment.audio[ch].reserve(estimate + kMP3MaxFrameSamples);
+        }
+
+        //? `keep` false: a priming packet, its frames (and errors, the reservoir is still short) are dropped.
+        auto send = [&](const AVPacket *input, bool keep){
+            const int ret = avcodec_send_packet(decoder_ctx, input);
+
+            if (keep && ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+                const std::string message = "Couldn't decode packets.\n";
+                segment.errors.onError(error::Error::FileReadError, message);
                 return false;
             }
 
-            // Append to our temp buffers
-            for (int ch = 0; ch < mDecoderInfo.decoder_ctx->ch_layout.nb_channels; ch++) {
-                temp_buffers[ch].insert(temp_buffers[ch].end(), 
-                    channel_buffers[ch], 
-                    channel_buffers[ch] + available_samples);
-                delete[] channel_buffers[ch];
+            while (avcodec_receive_frame(decoder_ctx, frame) == 0) {
+                const bool converted = !keep || convertFrame(resampler, frame, segment.audio, channels, segment.frames, segment.errors);
+                av_frame_unref(frame);
+
+                if (!converted) {
+                    return false;
+                }
             }
+            return true;
+        };
 
-            mDecoderInfo.total_samples_per_chan += available_samples;
+        bool ok = true;
+        for (size_t i = segment.begin - std::min(segment.begin, kMP3SegmentPrimePackets); ok && i < segment.begin; ++i) {
+            ok = send(packets[i], false);
         }
 
-        // Reset FIFO to read new data.
-        av_audio_fifo_reset(mDecoderInfo.fifo);
+        for (size_t i = segment.begin; ok && i < segment.end; ++i) {
+            ok = send(packets[i], true);
+        }
+
+        // only the end of the file drains the decoder, as the sequential decode does.
+        if (ok && last) {
+            ok = send(nullptr, true);
+        }
+
+        if (ok) {
+            convertFrame(resampler, nullptr, segment.audio, channels, segment.frames, segment.errors);
+        }
+
+        release();
+    };
+
+    pReadPool->parallel_for(0, count, 1, [&](size_t begin, size_t end){
+        for (size_t s = begin; s < end; ++s) {
+            decode_segment(segments[s], s + 1 == count);
+        }
+    });
+
+    //* 4. stitch: the channels are sized once, every run is copied to its offset.
+    size_t total = 0;
+    std::vector<size_t> offsets(count);
+    for (size_t s = 0; s < count; ++s) {
+        if (segments[s].errors.hasErrors()) {
+            segments[s].errors.replay(handler);
+            cleanup();
+            return false;
+        }
+
+        offsets[s] = total;
+        total += segments[s].frames;
     }
 
-    // Move data to pAudio buffers
-    for (int ch = 0; ch < mDecoderInfo.decoder_ctx->ch_layout.nb_channels; ch++) {
-        pAudio->at(ch) = std::move(temp_buffers[ch]);
+    for (int ch = 0; ch < channels; ch++) {
+        Float().swap(pAudio->at(ch));
+        pAudio->at(ch).resize(total);
     }
 
-    setAudioInfo(mDecoderInfo.decoder_ctx, mDecoderInfo.total_samples_per_chan);
+    pReadPool->parallel_for(0, count, 1, [&](size_t begin, size_t end){
+        for (size_t s = begin; s < end; ++s) {
+            for (int ch = 0; ch < channels; ch++) {
+                Float &run = segments[s].audio[ch];
+                std::copy(run.begin(), run.begin() + segments[s].frames, pAudio->at(ch).begin() + offsets[s]);
+                Float().swap(run);
+            }
+        }
+    });
 
-    // Cleanup
-    avformat_close_input(&mDecoderInfo.format_ctx);
-    avcodec_parameters_free(&mDecoderInfo.decoder_params);
-    avcodec_free_context(&mDecoderInfo.decoder_ctx);
-    av_audio_fifo_free(mDecoderInfo.fifo);
-    av_frame_free(&frame);
-    swr_free(&resampler);
-    av_packet_free(&packet);
+    mDecoderInfo.total_samples_per_chan = total;
+    setAudioInfo(mDecoderInfo.decoder_ctx, mDecoderInfo.total_samples_per_chan);
+    pSeekIndex = std::move(index);
 
+    cleanup();
     return true;
 }
 
 bool AJ::io::MP3_File::read(AJ::error::IErrorHandler &handler){
+    AJ_TRACE_ZONE("io", "mp3_decode");
+
     //* 1. open file and find audio stream.
     if(!openFile(handler)){
         return false;
@@ -320,350 +534,434 @@ bool AJ::io::MP3_File::read(AJ::error::IErrorHandler &handler){
         return false;
     }
 
-    //* 3. start decoding and writing to pAudio buffers.
-    if(!decode(handler)){
+    //* 3. start decoding and writing to pAudio buffers, in parallel segments for an MP3 with a read pool.
+    const bool segmented = pReadPool && mDecoderInfo.decoder_params->codec_id == AV_CODEC_ID_MP3;
+    if(!(segmented ? decodeSegmented(handler) : decode(handler))){
         return false;
     }
 
+    mRangeStart = 0;
+    mSourceFrames = mDecoderInfo.total_samples_per_chan;
     return true;
 }
 
-bool AJ::io::MP3_File::initEncoder(AJ::error::IErrorHandler &handler){
-    mEncoderInfo.encoder = avcodec_find_encoder(AV_CODEC_ID_MP3);
-    
-    if(!mEncoderInfo.encoder){
-        const std::string message = "Couldn't find MP3 Encoder.\n";
-        handler.onError(error::Error::FileWriteError, message);
+bool AJ::io::MP3_File::readRange(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler){
+    if(!checkRange(start, end, handler)){
+        return false;
+    }
 
-        return false;   
+    //* the streaming decoder already seeks sample accurately, the range is read through it.
+    if(!openStream(handler)){
+        return false;
     }
 
-    mEncoderInfo.encoder_ctx = avcodec_alloc_context3(mEncoderInfo.encoder);
+    const uint8_t channels = mInfo.channels;
+    const sample_c estimated = mInfo.length / channels;
+
+    if(start > 0 && !seekStream(start, handler)){
+        closeStream();
+        return false;
+    }
 
+    const size_t wanted = end < 0 ? SIZE_MAX : static_cast<size_t>(end - start + 1);
+    const size_t reserve = static_cast<sample_c>(start) < estimated ? estimated - start + kMP3MaxFrameSamples : 0;
 
-    if(!mEncoderInfo.encoder_ctx){
-        const std::string message = "Couldn't allocate MP3 Encoder Context.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        
-        return false;   
+    for(uint8_t ch = 0; ch < channels; ++ch){
+        (*pAudio)[ch].clear();
+        (*pAudio)[ch].reserve(std::min(wanted, reserve));
     }
 
+    const dsp::kernels::DeinterleaveFn deinterleave = dsp::kernels::table().deinterleave;
+    Float chunk(kIOChunkFrames * channels);
+    size_t frames = 0;
 
-    mEncoderInfo.encoder_ctx->sample_rate = mWriteInfo.samplerate;
-    mEncoderInfo.encoder_ctx->sample_fmt = AV_SAMPLE_FMT_S16P;
+    while(frames < wanted){
+        const size_t got = readStream(chunk.data(), std::min(kIOChunkFrames, wanted - frames), handler);
 
-    if(mWriteInfo.channels == 1)
-        mEncoderInfo.encoder_ctx->ch_layout = AV_CHANNEL_LAYOUT_MONO;
+        if(got == 0){
+            //? 0 before the end of the file is a decoding error, already reported.
+            if(!mDecoderInfo.end_of_file){
+                closeStream();
+                return false;
+            }
+            break;
+        }
 
-    if(mWriteInfo.channels == 2)
-        mEncoderInfo.encoder_ctx->ch_layout = AV_CHANNEL_LAYOUT_STEREO;
+        for(uint8_t ch = 0; ch < channels; ++ch){
+            (*pAudio)[ch].resize(frames + got);
+        }
 
+        if(channels == 1){
+            std::copy(chunk.begin(), chunk.begin() + got, (*pAudio)[0].begin() + frames);
+        } else {
+            deinterleave(chunk.data(), (*pAudio)[0].data() + frames, (*pAudio)[1].data() + frames, got);
+        }
 
-    if(avcodec_open2(mEncoderInfo.encoder_ctx, mEncoderInfo.encoder, NULL) < 0){
-        const std::string message = "Couldn't open MP3 Encoder.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        avcodec_free_context(&mEncoderInfo.encoder_ctx);
-        return false;       
+        frames += got;
     }
 
+    closeStream();
+
+    if(frames == 0){
+        const std::string message = "Error: the range starts after the end of the file: " + mFilePath + "\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    mInfo.length = frames * channels;
+    mRangeStart = start;
+    mSourceFrames = std::max<sample_c>(estimated, start + frames);
     return true;
 }
 
-void AJ::io::MP3_File::allocateFrame(AVFrame *frame , int frame_size, AJ::error::IErrorHandler &handler){
-    frame->format = AV_SAMPLE_FMT_FLTP;
-    frame->nb_samples = frame_size;
-    frame->sample_rate = mEncoderInfo.encoder_ctx->sample_rate;
+bool AJ::io::MP3_File::probe(AJ::error::IErrorHandler &handler){
+    //* demuxer and stream parameters only, the decoder isn't opened.
+    if(!openFile(handler)){
+        return false;
+    }
+
+    const AVCodecParameters *params = mDecoderInfo.format_ctx->streams[mDecoderInfo.stream_idx]->codecpar;
+    const int channels = params->ch_layout.nb_channels;
 
-    int ret = av_channel_layout_copy(&frame->ch_layout, &mEncoderInfo.encoder_ctx->ch_layout);
-    
-    if(ret != 0){
-        const std::string message = "Couldn't copy channel layout for audio frame.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        av_frame_free(&frame);
+    mInfo.samplerate = params->sample_rate;
+    mInfo.channels = channels;
+    mInfo.length = params->sample_rate > 0 ? durationFrames(params->sample_rate) * channels : 0;
+    mInfo.bitdepth = BitDepth_t::Not_Supported;
+    mInfo.seekable = mDecoderInfo.format_ctx->pb && mDecoderInfo.format_ctx->pb->seekable;
+    mInfo.format = "mp3";
 
-        return;  
+    avformat_close_input(&mDecoderInfo.format_ctx);
+    return true;
+}
+
+bool AJ::io::MP3_File::openStream(AJ::error::IErrorHandler &handler){
+    if(!openFile(handler)){
+        return false;
     }
 
-    ret = av_frame_get_buffer(frame, AV_INPUT_BUFFER_PADDING_SIZE);
+    if(!initDecoder(handler)){
+        return false;
+    }
 
-    if(ret != 0){
-        const std::string message = "Couldn't get buffer for audio frame.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        av_frame_free(&frame);
+    AVCodecContext *decoder_ctx = mDecoderInfo.decoder_ctx;
+    const AVStream *stream = mDecoderInfo.format_ctx->streams[mDecoderInfo.stream_idx];
 
-        return;
+    // length from the container, decoding the whole file is what we avoid here.
+    sample_c total_samples_per_chan = 0;
+    if(stream->duration != AV_NOPTS_VALUE){
+        total_samples_per_chan = av_rescale_q(stream->duration, stream->time_base, AVRational{1, decoder_ctx->sample_rate});
+    } else if(mDecoderInfo.format_ctx->duration != AV_NOPTS_VALUE){
+        total_samples_per_chan = av_rescale(mDecoderInfo.format_ctx->duration, decoder_ctx->sample_rate, AV_TIME_BASE);
     }
 
+    setAudioInfo(decoder_ctx, total_samples_per_chan);
+    mInfo.seekable = mDecoderInfo.format_ctx->pb && mDecoderInfo.format_ctx->pb->seekable;
 
-    ret = av_frame_make_writable(frame);
+    // decoded frames -> interleaved float, same rate and layout.
+    int ret = swr_alloc_set_opts2(&mDecoderInfo.resampler,
+        &decoder_ctx->ch_layout,
+        AV_SAMPLE_FMT_FLT,
+        decoder_ctx->sample_rate,
+        &decoder_ctx->ch_layout,
+        decoder_ctx->sample_fmt,
+        decoder_ctx->sample_rate,
+        0, nullptr
+    );
 
-    if(ret != 0){
-        const std::string message = "Couldn't make frame writable.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        av_frame_free(&frame);
+    mDecoderInfo.fifo = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLT, decoder_ctx->ch_layout.nb_channels, 4096);
+    mDecoderInfo.packet = av_packet_alloc();
+    mDecoderInfo.frame = av_frame_alloc();
 
-        return;
+    if(ret != 0 || swr_init(mDecoderInfo.resampler) != 0 || !mDecoderInfo.fifo || !mDecoderInfo.packet || !mDecoderInfo.frame){
+        const std::string message = "Couldn't initialize the stream decoder for the file: " + mFilePath + "\n";
+        handler.onError(error::Error::ResourceAllocationFailed, message);
+        closeStream();
+        return false;
     }
 
+    mDecoderInfo.end_of_file = false;
+    mDecoderInfo.seek_target = -1;
+    mDecoderInfo.indexed = false;
+    return true;
 }
 
-void AJ::io::MP3_File::resampleFrameData(AVFrame *frame, AVFrame *resampled, SwrContext *resampler, AJ::error::IErrorHandler &handler){
-    resampled->ch_layout = frame->ch_layout;
-    resampled->ch_layout.nb_channels = frame->ch_layout.nb_channels;
-    resampled->format = AV_SAMPLE_FMT_S16P; // uint16_t planar.
-    resampled->sample_rate = frame->sample_rate;
-    resampled->nb_samples = frame->nb_samples;
-
-    int ret = av_frame_get_buffer(resampled, AV_INPUT_BUFFER_PADDING_SIZE);
-
-    if(ret != 0){
-        const std::string message = "Couldn't get buffer for resampled audio frame.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        av_frame_free(&frame);
-        av_frame_free(&resampled);
-        swr_free(&resampler);
+bool AJ::io::MP3_File::queueStreamFrame(AJ::error::IErrorHandler &handler){
+    AVFrame *frame = mDecoderInfo.frame;
+    const int channels = mDecoderInfo.decoder_ctx->ch_layout.nb_channels;
 
-        return;
+    const int max_out = swr_get_out_samples(mDecoderInfo.resampler, frame->nb_samples);
+    if(mStreamScratch.size() < static_cast<size_t>(max_out) * channels){
+        mStreamScratch.resize(static_cast<size_t>(max_out) * channels);
     }
 
+    uint8_t *out = reinterpret_cast<uint8_t*>(mStreamScratch.data());
+    const int converted = swr_convert(mDecoderInfo.resampler, &out, max_out,
+        const_cast<const uint8_t**>(frame->extended_data), frame->nb_samples);
 
-    ret = av_frame_make_writable(resampled);
+    int skip = 0;
 
-    if(ret != 0){
-        const std::string message = "Couldn't make resampled frame writable.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        av_frame_free(&frame);
-        av_frame_free(&resampled);
-        swr_free(&resampler);
+    //* after a seek: drop what comes before the target inside the first frames.
+    if(mDecoderInfo.seek_target >= 0 && frame->best_effort_timestamp != AV_NOPTS_VALUE){
+        const AVStream *stream = mDecoderInfo.format_ctx->streams[mDecoderInfo.stream_idx];
+        const sample_pos start = av_rescale_q(frame->best_effort_timestamp, stream->time_base,
+            AVRational{1, mDecoderInfo.decoder_ctx->sample_rate});
 
-        return;
+        skip = static_cast<int>(std::clamp<sample_pos>(mDecoderInfo.seek_target - start, 0, std::max(converted, 0)));
+        if(skip < converted){
+            mDecoderInfo.seek_target = -1;
+        }
     }
 
-    ret = swr_convert_frame(resampler, resampled, frame);
     av_frame_unref(frame);
 
-    if(ret != 0){
-        const std::string message = "Couldn't resample data.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        av_frame_free(&resampled);
+    if(converted < 0){
+        const std::string message = "Couldn't resample audio frame.\n";
+        handler.onError(error::Error::FileReadError, message);
+        return false;
+    }
 
-        return;  
+    void *data = mStreamScratch.data() + static_cast<size_t>(skip) * channels;
+    if(av_audio_fifo_write(mDecoderInfo.fifo, &data, converted - skip) != converted - skip){
+        const std::string message = "Couldn't write to FIFO.\n";
+        handler.onError(error::Error::FileReadError, message);
+        return false;
     }
+
+    return true;
 }
 
-bool AJ::io::MP3_File::encode(AJ::error::IErrorHandler &handler){
-    //* 1. Init packet 
-    // packet holding encoded output.
-    mEncoderInfo.packet = av_packet_alloc();
+bool AJ::io::MP3_File::decodeStreamPacket(AJ::error::IErrorHandler &handler){
+    AVPacket *packet = mDecoderInfo.packet;
+    int ret = 0;
 
-    if(!mEncoderInfo.packet){
-        const std::string message = "Couldn't allocate audio packet.\n";
-        handler.onError(error::Error::FileWriteError, message);
+    if(av_read_frame(mDecoderInfo.format_ctx, packet) < 0){
+        // end of file: drain the frames still in the decoder.
+        mDecoderInfo.end_of_file = true;
+        ret = avcodec_send_packet(mDecoderInfo.decoder_ctx, nullptr);
+    } else {
+        if(packet->stream_index != mDecoderInfo.stream_idx){
+            av_packet_unref(packet);
+            return true;
+        }
 
-        return false;  
-    }
+        //* after an indexed seek the demuxer's timestamps are estimates: the packets are timed from the index.
+        if(mDecoderInfo.indexed){
+            const AVStream *stream = mDecoderInfo.format_ctx->streams[mDecoderInfo.stream_idx];
+            const int samplerate = mDecoderInfo.decoder_ctx->sample_rate;
 
+            //? the index never seeks to the first packet, a start skip here is a demuxer guess.
+            if(uint8_t *skip = packet_skip_data(packet)){
+                std::fill(skip, skip + 4, uint8_t(0));
+            }
 
-    //* 2. init resampler
-    // create a resampler to convert from float planar to uint16_t.
-    SwrContext *resampler = swr_alloc();
+            packet->pts = packet->dts = av_rescale_q(mDecoderInfo.index_frame, AVRational{1, samplerate}, stream->time_base);
+            mDecoderInfo.index_frame += packet_frames(packet, stream, samplerate);
+        }
 
-    const AVChannelLayout *chan_layout = &mEncoderInfo.encoder_ctx->ch_layout;
-    
-    int ret = swr_alloc_set_opts2(&resampler, 
-        chan_layout, // output channel layout.
-        AV_SAMPLE_FMT_S16P, // output format (uint16_t planar)
-        mEncoderInfo.encoder_ctx->sample_rate, // output samplerate.
-        chan_layout, // input channel layout.
-        AV_SAMPLE_FMT_FLTP, // input format (float planar).
-        mEncoderInfo.encoder_ctx->sample_rate, // input sample rate.
-        0, nullptr
-    );
+        ret = avcodec_send_packet(mDecoderInfo.decoder_ctx, packet);
+        av_packet_unref(packet);
+    }
 
-    if(ret != 0 || swr_init(resampler) != 0){
-        const std::string message = "Couldn't initialize audio resampler.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        swr_free(&resampler);
+    if(ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF){
+        const std::string message = "Couldn't decode packets.\n";
+        handler.onError(error::Error::FileReadError, message);
         return false;
     }
 
-    //* 3. start encoding and writing data in chunks.
-    /*
-        * frame holding input raw audio (PCM Float).
-        * frame size is usually 1152 so it must be encoded in chunks
-        * data is gonna be written in chunks also. 
-    */ 
-    
-    size_t frame_size = mEncoderInfo.encoder_ctx->frame_size;
-    AVFrame *frame = av_frame_alloc();
+    while(avcodec_receive_frame(mDecoderInfo.decoder_ctx, mDecoderInfo.frame) == 0){
+        if(!queueStreamFrame(handler)){
+            return false;
+        }
+    }
 
-    if(!frame){
-        const std::string message = "Couldn't allocate audio frame.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        swr_free(&resampler);
+    return true;
+}
 
-        return false;  
+size_t AJ::io::MP3_File::readStream(float *out, size_t frames, AJ::error::IErrorHandler &handler){
+    if(!mDecoderInfo.fifo){
+        return 0;
     }
 
-    AVFrame *resampled = av_frame_alloc();
+    while(static_cast<size_t>(av_audio_fifo_size(mDecoderInfo.fifo)) < frames && !mDecoderInfo.end_of_file){
+        if(!decodeStreamPacket(handler)){
+            return 0;
+        }
+    }
 
-    if(!resampled){
-        const std::string message = "Couldn't allocate resampled audio frame.\n";
-        handler.onError(error::Error::FileWriteError, message);
-        av_frame_free(&frame);
-        swr_free(&resampler);
+    const int count = std::min<int>(static_cast<int>(frames), av_audio_fifo_size(mDecoderInfo.fifo));
+    if(count <= 0){
+        return 0;
+    }
 
-        return false;  
+    void *data = out;
+    return static_cast<size_t>(std::max(av_audio_fifo_read(mDecoderInfo.fifo, &data, count), 0));
+}
+
+bool AJ::io::MP3_File::seekStream(sample_pos frame, AJ::error::IErrorHandler &handler){
+    if(!mDecoderInfo.fifo){
+        return false;
     }
 
-    for(size_t offset = 0; offset < pAudio->at(0).size(); offset += frame_size){
-        //* 1. set frame and copy chunk of data to it.
-        int nb_samples = std::min(frame_size, pAudio->at(0).size() - offset);
+    const AVStream *stream = mDecoderInfo.format_ctx->streams[mDecoderInfo.stream_idx];
+    const SeekIndex::Point *point = pSeekIndex ? pSeekIndex->seekPoint(frame) : nullptr;
 
-        allocateFrame(frame, nb_samples, handler);
+    //* indexed: straight to the packet, timed from its frame. A failed byte seek falls back to the timestamps.
+    if(point && av_seek_frame(mDecoderInfo.format_ctx, mDecoderInfo.stream_idx, point->mPos, AVSEEK_FLAG_BYTE) >= 0){
+        avcodec_flush_buffers(mDecoderInfo.decoder_ctx);
+        av_audio_fifo_reset(mDecoderInfo.fifo);
 
-        if(!frame){
-            swr_free(&resampler);
-            return false;
-        }
+        mDecoderInfo.end_of_file = false;
+        mDecoderInfo.seek_target = frame;
+        mDecoderInfo.indexed = true;
+        mDecoderInfo.index_frame = point->mFrame;
+        return true;
+    }
 
-        
-        for(short ch = 0; ch < frame->ch_layout.nb_channels; ch++){
-            memcpy(frame->data[ch],
-                pAudio->at(ch).data() + offset,
-                nb_samples * sizeof(float)
-            );
-        }
+    const int64_t timestamp = av_rescale_q(std::max<sample_pos>(frame, 0),
+        AVRational{1, mDecoderInfo.decoder_ctx->sample_rate}, stream->time_base);
 
-        //* 2. resample to S16P.
-        // the frame is unref in the resampleFrameData.
-        resampleFrameData(frame, resampled, resampler, handler);
+    mDecoderInfo.indexed = false;
 
-        if(!resampled){
-            return false;
-        }
+    if(av_seek_frame(mDecoderInfo.format_ctx, mDecoderInfo.stream_idx, timestamp, AVSEEK_FLAG_BACKWARD) < 0){
+        const std::string message = "Couldn't seek in the file: " + mFilePath + "\n";
+        handler.onError(error::Error::FileReadError, message);
+        return false;
+    }
 
-        // send audio frame to the encoder context.
-        int ret = avcodec_send_frame(mEncoderInfo.encoder_ctx, resampled);
-        av_frame_unref(resampled);    
+    avcodec_flush_buffers(mDecoderInfo.decoder_ctx);
+    av_audio_fifo_reset(mDecoderInfo.fifo);
 
-        if(ret != 0){
-            const std::string message = "Couldn't send audio frame to the encoder context.\n";
-            handler.onError(error::Error::FileWriteError, message);
-            swr_free(&resampler);
-            return false;  
-        }
+    mDecoderInfo.end_of_file = false;
+    mDecoderInfo.seek_target = std::max<sample_pos>(frame, 0);
+    return true;
+}
 
-        //* 3. write the encoded chunk.
-        if(!writeData(handler)){
-            return false;
-        }
+void AJ::io::MP3_File::closeStream(){
+    if(mDecoderInfo.format_ctx){
+        avformat_close_input(&mDecoderInfo.format_ctx);
     }
-    
-    av_frame_free(&frame);
-    av_frame_free(&resampled);
 
+    avcodec_free_context(&mDecoderInfo.decoder_ctx);
+    swr_free(&mDecoderInfo.resampler);
+    av_packet_free(&mDecoderInfo.packet);
+    av_frame_free(&mDecoderInfo.frame);
 
-    //* 4. Flush the encoder.
-    if(avcodec_send_frame(mEncoderInfo.encoder_ctx, nullptr) != 0){
-        const std::string message = "Couldn't send audio frame to the encoder context.\n";
-        handler.onError(error::Error::FileWriteError, message);
+    if(mDecoderInfo.fifo){
+        av_audio_fifo_free(mDecoderInfo.fifo);
+        mDecoderInfo.fifo = nullptr;
+    }
 
-        swr_free(&resampler);
+    // the codec parameters belong to the stream, freed with the format context.
+    mDecoderInfo.decoder_params = nullptr;
+    mDecoderInfo.end_of_file = false;
+    mDecoderInfo.seek_target = -1;
+    mDecoderInfo.indexed = false;
+}
+
+bool AJ::io::MP3_File::buildSeekIndex(AJ::error::IErrorHandler &handler){
+    AJ_TRACE_ZONE("io", "mp3_seek_index");
+
+    //* its own demuxer: an open stream keeps its position.
+    AVFormatContext *format_ctx = nullptr;
+    if(avformat_open_input(&format_ctx, mFilePath.c_str(), nullptr, nullptr) < 0){
+        const std::string message = "Couldn't open file: " + mFilePath + "\n";
+        handler.onError(error::Error::FileOpenError, message);
         return false;
     }
 
-    if(!writeData(handler)){
-        swr_free(&resampler);
+    const int stream_idx = avformat_find_stream_info(format_ctx, nullptr) < 0 ? -1
+        : av_find_best_stream(format_ctx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+
+    if(stream_idx < 0){
+        const std::string message = "Couldn't find audio stream in: " + mFilePath + "\n";
+        handler.onError(error::Error::FileReadError, message);
+        avformat_close_input(&format_ctx);
         return false;
     }
 
-    swr_free(&resampler);
+    const AVStream *stream = format_ctx->streams[stream_idx];
+    const int samplerate = stream->codecpar->sample_rate;
 
-    return true;
-}
-
-bool AJ::io::MP3_File::writeData(AJ::error::IErrorHandler &handler){
-    int ret = 0;
-    // read all available output packets 
-    while(ret >= 0){
-        ret = avcodec_receive_packet(mEncoderInfo.encoder_ctx, mEncoderInfo.packet);
-    
-        /*
-            * needs more packets,
-            * that's normal just break this loop.
-            * in the next iteration in encode function it will have the needed samples.
-            * don't free the packet now just skip it.
-        */
-        if(ret == AVERROR(EAGAIN)){
-            break;
-        }
+    if(stream->codecpar->codec_id != AV_CODEC_ID_MP3 || samplerate <= 0){
+        const std::string message = "Only MP3 streams can be indexed: " + mFilePath + "\n";
+        handler.onError(error::Error::UnsupportedFileFormat, message);
+        avformat_close_input(&format_ctx);
+        return false;
+    }
 
-        // end of the file.
-        else if(ret == AVERROR_EOF){
-            // free memory.
-            av_packet_free(&mEncoderInfo.packet);
-            
-            // succeed
-            return true;
-        } else if (ret < 0) { // error
-            const std::string message = "Couldn't read the encoded data from the encoder.\n";
-            handler.onError(error::Error::FileWriteError, message);
+    AVPacket *packet = av_packet_alloc();
+    if(!packet){
+        const std::string message = "Couldn't allocate a packet for the file: " + mFilePath + "\n";
+        handler.onError(error::Error::ResourceAllocationFailed, message);
+        avformat_close_input(&format_ctx);
+        return false;
+    }
 
-            av_packet_free(&mEncoderInfo.packet);
-            return false;  
+    auto index = std::make_shared<SeekIndex>();
+    while(av_read_frame(format_ctx, packet) >= 0){
+        if(packet->stream_index == stream_idx){
+            index->append(packet->pos, packet_frames(packet, stream, samplerate), packet_skip(packet));
         }
-
-        // there is no need to care about planar data the encoder will handle it.
-        fwrite(mEncoderInfo.packet->data, 1, mEncoderInfo.packet->size, mEncoderInfo.file);
-        av_packet_unref(mEncoderInfo.packet);
+        av_packet_unref(packet);
     }
 
+    av_packet_free(&packet);
+    avformat_close_input(&format_ctx);
+
+    pSeekIndex = std::move(index);
     return true;
 }
 
 bool AJ::io::MP3_File::write(AJ::error::IErrorHandler &handler){
+    AJ_TRACE_ZONE("io", "mp3_encode");
 
-    //* 1. find MP3 encoder, alloc encoder context and open encoder.
-    
-    bool failed = !initEncoder(handler);
-
-    if(failed){
-        avcodec_free_context(&mEncoderInfo.encoder_ctx);
+    if(!resample(mWriteInfo.samplerate, nullptr, handler)){
         return false;
     }
 
-    //* 2. Open file.
     std::string fullPath = mWriteInfo.path + "/" + mWriteInfo.name + mWriteInfo.format;
-    mEncoderInfo.file = fopen(fullPath.c_str(), "wb");
 
-    if(!mEncoderInfo.file){
-        const std::string message = "Couldn't open MP3 File in the targeted path: " 
-            + mWriteInfo.path + "\n";
-        handler.onError(error::Error::FileOpenError, message);
+    Mp3StreamOptions options;
+    options.planar = true;
 
-        avcodec_free_context(&mEncoderInfo.encoder_ctx);
-        return false;  
+    Mp3StreamEncoder encoder;
+
+    if(!encoder.open(fullPath, mWriteInfo.channels, static_cast<uint32_t>(mWriteInfo.samplerate), options, handler)){
+        return false;
     }
 
-    
-    //* 3. encoding and write data.
-    
-    failed = !encode(handler);
-    
-    if(mEncoderInfo.packet)
-        av_packet_free(&mEncoderInfo.packet);
-    
-    // should be non-null here; extra check for safety.
-    if(mEncoderInfo.encoder_ctx)
-        avcodec_free_context(&mEncoderInfo.encoder_ctx);
+    //* converted and encoded chunk by chunk with the encoder's preallocated frames and packets.
+    const float* channels[kNumChannels] = {};
+    bool ok = true;
 
-    
-    fclose(mEncoderInfo.file);
-    
-    if(failed){
-        return false;
+    if(storage() == SampleStorage::Float32){
+        for(uint8_t ch = 0; ch < mWriteInfo.channels; ++ch){
+            channels[ch] = pAudio->at(ch).data();
+        }
+
+        ok = encoder.appendPlanar(channels, pAudio->at(0).size(), handler);
+    } else {
+        // compact samples are widened a chunk at a time.
+        const size_t frames = channelFrames();
+        std::array<Float, kNumChannels> planes;
+
+        for(uint8_t ch = 0; ch < mWriteInfo.channels; ++ch){
+            planes[ch].resize(std::min<size_t>(kIOChunkFrames, frames));
+            channels[ch] = planes[ch].data();
+        }
+
+        for(size_t frame = 0; ok && frame < frames; ){
+            const size_t count = std::min<size_t>(kIOChunkFrames, frames - frame);
+
+            for(uint8_t ch = 0; ch < mWriteInfo.channels; ++ch){
+                readFrames(ch, frame, count, planes[ch].data());
+            }
+
+            ok = encoder.appendPlanar(channels, count, handler);
+            frame += count;
+        }
     }
-    
-    return true;
+
+    // closed either way, the file is finished as far as it was encoded.
+    return encoder.close(handler) && ok;
 }
@@ -0,0 +1,573 @@
+#include <algorithm>
+#include <cstring>
+#include <future>
+
+#include "file_io/mp3_stream_encoder.h"
+
+extern "C"{
+    #include <libavcodec/avcodec.h>
+    #include <libavutil/avutil.h>
+    #include <libswresample/swresample.h>
+}
+
+// ======== SlotRing ========
+
+void AJ::io::Mp3StreamEncoder::SlotRing::reset(size_t capacity){
+    std::lock_guard<std::mutex> lock(mMux);
+    mSlots.assign(capacity, -1);
+    mHead = 0;
+    mCount = 0;
+    mClosed = false;
+}
+
+void AJ::io::Mp3StreamEncoder::SlotRing::push(int slot){
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        mSlots[(mHead + mCount) % mSlots.size()] = slot;
+        ++mCount;
+    }
+
+    mCond.notify_one();
+}
+
+int AJ::io::Mp3StreamEncoder::SlotRing::pop(bool wait){
+    std::unique_lock<std::mutex> lock(mMux);
+
+    if(wait){
+        mCond.wait(lock, [this]{ return mCount > 0 || mClosed; });
+    }
+
+    if(mCount == 0){
+        return -1;
+    }
+
+    const int slot = mSlots[mHead];
+    mHead = (mHead + 1) % mSlots.size();
+    --mCount;
+    return slot;
+}
+
+void AJ::io::Mp3StreamEncoder::SlotRing::close(){
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        mClosed = true;
+    }
+
+    mCond.notify_all();
+}
+
+void AJ::io::Mp3StreamEncoder::SlotRing::open(){
+    std::lock_guard<std::mutex> lock(mMux);
+    mClosed = false;
+}
+
+// ======== Mp3StreamEncoder ========
+
+AJ::io::Mp3StreamEncoder::~Mp3StreamEncoder(){
+    release();
+}
+
+void AJ::io::Mp3StreamEncoder::release() noexcept {
+    for(AVFrame* frame : mFrames) av_frame_free(&frame);
+    for(AVPacket* packet : mPackets) av_packet_free(&packet);
+    mFrames.clear();
+    mPackets.clear();
+
+    if(pResampler) swr_free(&pResampler);
+    if(pCodec) avcodec_free_context(&pCodec);
+
+    // released without close(): the file stays as far as it was written.
+    if(pFile) fclose(pFile);
+    pFile = nullptr;
+
+    mCurrent = -1;
+    mFill = 0;
+}
+
+void AJ::io::Mp3StreamEncoder::fail() noexcept {
+    mFailed.store(true, std::memory_order_release);
+
+    // wake every stage waiting on a slot, they see the flag and stop.
+    mFreeFrames.close();
+    mFullFrames.close();
+    mFreePackets.close();
+    mFullPackets.close();
+}
+
+bool AJ::io::Mp3StreamEncoder::open(const std::string &path, uint8_t channels, uint32_t samplerate,
+    const Mp3StreamOptions &options, AJ::error::IErrorHandler &handler){
+    release();
+
+    mOptions = options;
+    mPath = path;
+    mChannels = channels;
+    mPts = 0;
+    mFramesIn = 0;
+    mBytes = 0;
+    mInline = true;
+    mFailed.store(false, std::memory_order_relaxed);
+
+    if(channels < 1 || channels > kNumChannels){
+        const std::string message = "Unsupported channels number, the Engine only support mono and stereo.\n";
+        handler.onError(error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    //* 1. encoder.
+    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_MP3);
+
+    if(!codec){
+        const std::string message = "Couldn't find MP3 Encoder.\n";
+        handler.onError(error::Error::FileWriteError, message);
+        return false;
+    }
+
+    pCodec = avcodec_alloc_context3(codec);
+
+    if(!pCodec){
+        const std::string message = "Couldn't allocate MP3 Encoder Context.\n";
+        handler.onError(error::Error::FileWriteError, message);
+        return false;
+    }
+
+    pCodec->sample_rate = static_cast<int>(samplerate);
+    pCodec->sample_fmt = AV_SAMPLE_FMT_S16P;
+    av_channel_layout_default(&pCodec->ch_layout, channels);
+
+    if(options.bitrate > 0){
+        pCodec->bit_rate = options.bitrate;
+    }
+
+    if(avcodec_open2(pCodec, codec, nullptr) < 0){
+        const std::string message = "Couldn't open MP3 Encoder.\n";
+        handler.onError(error::Error::FileWriteError, message);
+        release();
+        return false;
+    }
+
+    mFrameSize = pCodec->frame_size > 0 ? pCodec->frame_size : static_cast<int>(kMP3MaxFrameSamples);
+
+    //* 2. resampler: float (interleaved or planar) at the input rate to S16P at the file rate.
+    const int input_rate = options.inputSamplerate ? static_cast<int>(options.inputSamplerate) : pCodec->sample_rate;
+
+    int ret = swr_alloc_set_opts2(&pResampler,
+        &pCodec->ch_layout, AV_SAMPLE_FMT_S16P, pCodec->sample_rate,
+        &pCodec->ch_layout, options.planar ? AV_SAMPLE_FMT_FLTP : AV_SAMPLE_FMT_FLT, input_rate,
+        0, nullptr
+    );
+
+    if(ret != 0 || swr_init(pResampler) != 0){
+        const std::string message = "Couldn't initialize audio resampler.\n";
+        handler.onError(error::Error::FileWriteError, message);
+        release();
+        return false;
+    }
+
+    //* 3. the frames and packets recycled by the stages, allocated once.
+    const size_t slots = std::max<size_t>(options.slots, 2);
+
+    mFreeFrames.reset(slots);
+    mFullFrames.reset(slots);
+    mFreePackets.reset(slots);
+    mFullPackets.reset(slots);
+
+    for(size_t i = 0; i < slots; ++i){
+        AVFrame* frame = av_frame_alloc();
+        AVPacket* packet = av_packet_alloc();
+
+        if(frame){
+            frame->format = AV_SAMPLE_FMT_S16P;
+            frame->nb_samples = mFrameSize;
+            frame->sample_rate = pCodec->sample_rate;
+        }
+
+        if(!frame || !packet || av_channel_layout_copy(&frame->ch_layout, &pCodec->ch_layout) != 0
+            || av_frame_get_buffer(frame, 0) != 0){
+            av_frame_free(&frame);
+            av_packet_free(&packet);
+
+            const std::string message = "Couldn't allocate the MP3 encoder frames.\n";
+            handler.onError(error::Error::ResourceAllocationFailed, message);
+            release();
+            return false;
+        }
+
+        mFrames.push_back(frame);
+        mPackets.push_back(packet);
+        mFreeFrames.push(static_cast<int>(i));
+        mFreePackets.push(static_cast<int>(i));
+    }
+
+    //* 4. file.
+    pFile = fopen(path.c_str(), "wb");
+
+    if(!pFile){
+        const std::string message = "Couldn't open MP3 File in the targeted path: " + path + "\n";
+        handler.onError(error::Error::FileOpenError, message);
+        release();
+        return false;
+    }
+
+    return true;
+}
+
+bool AJ::io::Mp3StreamEncoder::convert(const uint8_t** input, int count, AJ::error::IErrorHandler &handler){
+    const int capacity = swr_get_out_samples(pResampler, count);
+
+    if(capacity < 0){
+        const std::string message = "Couldn't resample data.\n";
+        handler.onError(error::Error::FileWriteError, message);
+        fail();
+        return false;
+    }
+
+    // grows to the largest block once, then reused.
+    uint8_t* scratch[kNumChannels] = {};
+    for(uint8_t ch = 0; ch < mChannels; ++ch){
+        if(mScratch[ch].size() < static_cast<size_t>(capacity)) mScratch[ch].resize(capacity);
+        scratch[ch] = reinterpret_cast<uint8_t*>(mScratch[ch].data());
+    }
+
+    //? nullptr input drains the resampler delay (end of the stream).
+    const int converted = swr_convert(pResampler, scratch, capacity, input, count);
+
+    if(converted < 0){
+        const std::string message = "Couldn't resample data.\n";
+        handler.onError(error::Error::FileWriteError, message);
+        fail();
+        return false;
+    }
+
+    //* cut the converted samples into encoder frames, a frame may span several blocks.
+    for(int offset = 0; offset < converted;){
+        if(mCurrent < 0){
+            mCurrent = mFreeFrames.pop(!mInline);
+            if(mCurrent < 0) return false; // closed by a failed stage.
+
+            AVFrame* frame = mFrames[mCurrent];
+            frame->nb_samples = mFrameSize;
+
+            //? the encoder may still reference the previous content of the frame.
+            if(av_frame_make_writable(frame) != 0){
+                const std::string message = "Couldn't make frame writable.\n";
+                handler.onError(error::Error::FileWriteError, message);
+                fail();
+                return false;
+            }
+
+            mFill = 0;
+        }
+
+        AVFrame* frame = mFrames[mCurrent];
+        const int n = std::min(mFrameSize - mFill, converted - offset);
+
+        for(uint8_t ch = 0; ch < mChannels; ++ch){
+            std::memcpy(frame->data[ch] + mFill * sizeof(int16_t), mScratch[ch].data() + offset, n * sizeof(int16_t));
+        }
+
+        mFill += n;
+        offset += n;
+
+        if(mFill == mFrameSize && !emitFrame(handler)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AJ::io::Mp3StreamEncoder::emitFrame(AJ::error::IErrorHandler &handler){
+    const int slot = mCurrent;
+    AVFrame* frame = mFrames[slot];
+
+    frame->nb_samples = mFill; // only the last frame is partial.
+    frame->pts = mPts;
+    mPts += mFill;
+
+    mCurrent = -1;
+    mFill = 0;
+
+    if(!mInline){
+        mFullFrames.push(slot);
+        return !mFailed.load(std::memory_order_acquire);
+    }
+
+    const bool ok = encodeFrame(frame, handler);
+    mFreeFrames.push(slot);
+    return ok;
+}
+
+bool AJ::io::Mp3StreamEncoder::encodeFrame(const AVFrame* frame, AJ::error::IErrorHandler &handler){
+    if(avcodec_send_frame(pCodec, frame) != 0){
+        const std::string message = "Couldn't send audio frame to the encoder context.\n";
+        handler.onError(error::Error::FileWriteError, message);
+        fail();
+        return false;
+    }
+
+    // read all available output packets.
+    while(true){
+        const int slot = mFreePackets.pop(!mInline);
+        if(slot < 0) return false; // closed by a failed stage.
+
+        const int ret = avcodec_receive_packet(pCodec, mPackets[slot]);
+
+        // needs more samples (or drained): the packet stays free for the next frame.
+        if(ret == AVERROR(EAGAIN) || ret == AVERROR_EOF){
+            mFreePackets.push(slot);
+            return true;
+        }
+
+        if(ret < 0){
+            mFreePackets.push(slot);
+
+            const std::string message = "Couldn't read the encoded data from the encoder.\n";
+            handler.onError(error::Error::FileWriteError, message);
+            fail();
+            return false;
+        }
+
+        if(!mInline){
+            mFullPackets.push(slot);
+        } else if(!writePacket(slot, handler)){
+            return false;
+        }
+    }
+}
+
+bool AJ::io::Mp3StreamEncoder::writePacket(int slot, AJ::error::IErrorHandler &handler){
+    AVPacket* packet = mPackets[slot];
+    const size_t size = static_cast<size_t>(packet->size);
+
+    // there is no need to care about planar data the encoder handled it.
+    const bool ok = fwrite(packet->data, 1, size, pFile) == size;
+
+    av_packet_unref(packet);
+    mFreePackets.push(slot);
+
+    if(!ok){
+        const std::string message = "Error: failed to write MP3 packets to file " + mPath + "\n";
+        handler.onError(error::Error::FileWriteError, message);
+        fail();
+        return false;
+    }
+
+    mBytes += size;
+    return true;
+}
+
+bool AJ::io::Mp3StreamEncoder::append(const float* interleaved, size_t frames, AJ::error::IErrorHandler &handler){
+    if(!pFile || mFailed.load(std::memory_order_acquire)){
+        return false;
+    }
+
+    if(mOptions.planar){
+        const std::string message = "Error: the MP3 encoder was opened for planar frames.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    //* in chunks: the scratch space stays small whatever the size of the block.
+    for(size_t offset = 0; offset < frames; offset += kIOChunkFrames){
+        const size_t count = std::min(kIOChunkFrames, frames - offset);
+        const uint8_t* input[1] = { reinterpret_cast<const uint8_t*>(interleaved + offset * mChannels) };
+
+        mFramesIn += count;
+        if(!convert(input, static_cast<int>(count), handler)) return false;
+    }
+
+    return true;
+}
+
+bool AJ::io::Mp3StreamEncoder::appendPlanar(const float* const* channels, size_t frames, AJ::error::IErrorHandler &handler){
+    if(!pFile || mFailed.load(std::memory_order_acquire)){
+        return false;
+    }
+
+    if(!mOptions.planar){
+        const std::string message = "Error: the MP3 encoder was opened for interleaved frames.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    for(size_t offset = 0; offset < frames; offset += kIOChunkFrames){
+        const size_t count = std::min(kIOChunkFrames, frames - offset);
+
+        const uint8_t* input[kNumChannels] = {};
+        for(uint8_t ch = 0; ch < mChannels; ++ch){
+            input[ch] = reinterpret_cast<const uint8_t*>(channels[ch] + offset);
+        }
+
+        mFramesIn += count;
+        if(!convert(input, static_cast<int>(count), handler)) return false;
+    }
+
+    return true;
+}
+
+void AJ::io::Mp3StreamEncoder::convertStage(utils::Queue &queue, utils::BufferPool &pool, const LFControlFlag &done,
+    AJ::error::IErrorHandler &handler){
+    utils::Buffer* buffer = nullptr;
+
+    //? after a failure the buffers are still recycled, so the producer never runs out of them.
+    auto consume = [&](utils::Buffer* block){
+        if(!mFailed.load(std::memory_order_acquire)){
+            const uint8_t* input[1] = { reinterpret_cast<const uint8_t*>(block->data) };
+            mFramesIn += block->frames;
+            convert(input, static_cast<int>(block->frames), handler);
+        }
+
+        pool.push(block, handler);
+    };
+
+    while(!done.flag.load(std::memory_order_acquire)){
+        queue.wait(1, kStreamerWakeTimeout);
+
+        while((buffer = queue.pop())){
+            consume(buffer);
+        }
+    }
+
+    // the producer is done: what it queued before the flag is still encoded.
+    while((buffer = queue.pop())){
+        consume(buffer);
+    }
+}
+
+void AJ::io::Mp3StreamEncoder::encodeStage(AJ::error::IErrorHandler &handler){
+    int slot;
+
+    while((slot = mFullFrames.pop(true)) >= 0){
+        AVFrame* frame = mFrames[slot];
+
+        if(!mFailed.load(std::memory_order_acquire)){
+            encodeFrame(frame, handler);
+        }
+
+        mFreeFrames.push(slot);
+    }
+}
+
+void AJ::io::Mp3StreamEncoder::writeStage(AJ::error::IErrorHandler &handler){
+    int slot;
+
+    while((slot = mFullPackets.pop(true)) >= 0){
+        if(mFailed.load(std::memory_order_acquire)){
+            av_packet_unref(mPackets[slot]);
+            mFreePackets.push(slot);
+            continue;
+        }
+
+        writePacket(slot, handler);
+    }
+}
+
+bool AJ::io::Mp3StreamEncoder::join(Placement &placement){
+    std::unique_lock<std::mutex> lock(placement.mux);
+
+    //? started after run() went inline.
+    if(placement.decided){
+        return false;
+    }
+
+    ++placement.started;
+    placement.cond.notify_all();
+    placement.cond.wait(lock, [&placement]{ return placement.decided; });
+    return placement.workers;
+}
+
+bool AJ::io::Mp3StreamEncoder::run(std::shared_ptr<utils::Queue> queue, std::shared_ptr<utils::BufferPool> pool,
+    LFControlFlagPtr done, std::shared_ptr<utils::ThreadPool> threads, AJ::error::IErrorHandler &handler){
+    if(!pFile || mFailed.load(std::memory_order_acquire)){
+        return false;
+    }
+
+    if(!queue || !pool || !done){
+        const std::string message = "Error: the MP3 encoder needs a queue, a buffer pool and a stop flag.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    if(mOptions.planar){
+        const std::string message = "Error: the MP3 encoder was opened for planar frames, queued buffers are interleaved.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    //? a pool of one worker can't run both stages.
+    if(!threads || threads->size() < 2){
+        mInline = true;
+        convertStage(*queue, *pool, *done, handler);
+        return !mFailed.load(std::memory_order_acquire);
+    }
+
+    mInline = false;
+    auto placement = std::make_shared<Placement>();
+
+    //* convert -> encode on the workers, write on this thread, linked by the slot rings.
+    std::future<void> converter = threads->enqueue([this, placement, &queue, &pool, &done, &handler]{
+        if(!join(*placement)) return;
+        convertStage(*queue, *pool, *done, handler);
+        mFullFrames.close();
+    });
+
+    std::future<void> encoder = threads->enqueue([this, placement, &handler]{
+        if(!join(*placement)) return;
+        encodeStage(handler);
+        mFullPackets.close();
+    });
+
+    //? every stage blocks on the next one: they need a worker each. This thread doesn't run other
+    //? pool tasks meanwhile, one of them could wait on the stages. A task still queued once the
+    //? stages started (the producer of the queue?) would wait on the workers they hold.
+    {
+        std::unique_lock<std::mutex> lock(placement->mux);
+        placement->workers = placement->cond.wait_for(lock, kMp3StageWaitTimeout,
+            [&placement]{ return placement->started == 2; }) && threads->pending() == 0;
+        placement->decided = true;
+    }
+    placement->cond.notify_all();
+
+    if(!placement->workers){
+        // the stage tasks return as soon as they start, they only hold the placement.
+        mInline = true;
+        convertStage(*queue, *pool, *done, handler);
+        return !mFailed.load(std::memory_order_acquire);
+    }
+
+    writeStage(handler);
+
+    threads->helpUntil(converter);
+    threads->helpUntil(encoder);
+
+    // a partial frame stays in mCurrent, close() (or the next run) finishes it.
+    mInline = true;
+    mFullFrames.open();
+    mFullPackets.open();
+
+    return !mFailed.load(std::memory_order_acquire);
+}
+
+bool AJ::io::Mp3StreamEncoder::close(AJ::error::IErrorHandler &handler){
+    if(!pFile){
+        return false;
+    }
+
+    mInline = true;
+    bool ok = !mFailed.load(std::memory_order_acquire);
+
+    //* the tail: resampler delay, last partial frame, then the encoder delay.
+    if(ok) ok = convert(nullptr, 0, handler);
+    if(ok && mCurrent >= 0) ok = emitFrame(handler);
+    if(ok) ok = encodeFrame(nullptr, handler);
+
+    if(fclose(pFile) != 0){
+        const std::string message = "Failed to close audio file. Resource may still be in use.\n";
+        handler.onError(error::Error::FileClosingError, message);
+        ok = false;
+    }
+
+    pFile = nullptr;
+    release();
+    return ok;
+}
@@ -0,0 +1,26 @@
+#include <algorithm>
+
+#include "file_io/seek_index.h"
+
+const AJ::io::SeekIndex::Point* AJ::io::SeekIndex::seekPoint(sample_pos frame) const noexcept {
+    const size_t count = mPoints.size();
+    if(count < 2 || frame < mPoints[1].mFrame){
+        return nullptr;
+    }
+
+    //* the points are almost evenly spaced: guess from the average span, then step to the right one.
+    const sample_pos first = mPoints.front().mFrame;
+    const sample_pos span = std::max<sample_pos>((mPoints.back().mFrame - first) / static_cast<sample_pos>(count - 1), 1);
+
+    size_t k = static_cast<size_t>(std::min<sample_pos>((frame - first) / span, static_cast<sample_pos>(count - 1)));
+
+    while(k + 1 < count && mPoints[k + 1].mFrame <= frame){
+        ++k;
+    }
+    while(k > 0 && mPoints[k].mFrame > frame){
+        --k;
+    }
+
+    //? one point back: a stride of packets to fill the bit reservoir before the frame.
+    return k >= 2 ? &mPoints[k - 1] : nullptr;
+}
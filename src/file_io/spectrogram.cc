@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+#include "core/scratch_arena.h"
+#include "core/trace.h"
+
+#include "file_io/spectrogram.h"
+#include "file_io/audio_file.h"
+
+AJ::io::Spectrogram::Spectrogram(PrivateTag, std::shared_ptr<const dsp::fft::Plan> fft, size_t hop, size_t budget) :
+    pFFT(std::move(fft)), mHop(hop), mBudget(budget) {
+
+    const size_t size = pFFT->size();
+    double sum = 0.0;
+
+    mWindow.resize(size);
+    for(size_t n = 0; n < size; ++n){
+        const double w = 0.5 - 0.5 * std::cos(2.0 * M_PI * n / size);
+        mWindow[n] = static_cast<float>(w);
+        sum += w;
+    }
+
+    //? a sine of amplitude A puts A / 2 · sum(w) in its bin.
+    mScale = static_cast<float>(2.0 / sum);
+}
+
+std::shared_ptr<AJ::io::Spectrogram> AJ::io::Spectrogram::create(size_t fftSize, size_t hop,
+    AJ::error::IErrorHandler &handler, size_t budget){
+
+    auto fft = dsp::fft::plan(fftSize);
+    if(!fft){
+        const std::string message = "the spectrogram FFT size must be a power of two in ["
+            + std::to_string(kFFTMinSize) + ", " + std::to_string(kFFTMaxSize) + "].\n";
+        handler.onError(AJ::error::Error::InvalidConfiguration, message);
+        return nullptr;
+    }
+
+    if(hop == 0){
+        const std::string message = "the spectrogram hop must be at least one frame.\n";
+        handler.onError(AJ::error::Error::InvalidConfiguration, message);
+        return nullptr;
+    }
+
+    return std::make_shared<Spectrogram>(PrivateTag{}, std::move(fft), hop, budget);
+}
+
+size_t AJ::io::Spectrogram::tileCount(const AudioFile &file, size_t level) const noexcept {
+    const size_t frames = file.channelFrames();
+    const size_t span = tileFrames(level);
+    return (frames + span - 1) / span;
+}
+
+bool AJ::io::Spectrogram::computeColumns(const AudioFile &file, SpectrogramTile &tile, size_t first, size_t last) const {
+    const size_t size = pFFT->size();
+    const size_t bins = pFFT->bins();
+    const sample_pos frames = static_cast<sample_pos>(file.channelFrames());
+    const size_t windows = std::clamp<size_t>(tile.hop / size, 1, kSpectrogramColumnWindows);
+
+    utils::ScratchScope scope;
+    float *frame = scope.arena().array<float>(size);
+    float *power = scope.arena().array<float>(bins);
+    dsp::fft::Spectrum spectrum = dsp::fft::spectrum(scope.arena(), *pFFT);
+
+    if(!frame || !power || !spectrum.re){
+        return false;
+    }
+
+    for(size_t c = first; c < last; ++c){
+        const sample_pos column = tile.start + static_cast<sample_pos>(c * tile.hop);
+        std::fill(power, power + bins, 0.0f);
+
+        for(size_t w = 0; w < windows; ++w){
+            //* windows centered at the middle of equal slices of the column, zeros outside the file.
+            const sample_pos center = column + static_cast<sample_pos>((2 * w + 1) * tile.hop / (2 * windows));
+            const sample_pos from = center - static_cast<sample_pos>(size / 2);
+            const sample_pos begin = std::max<sample_pos>(from, 0);
+            const sample_pos end = std::min<sample_pos>(from + static_cast<sample_pos>(size), frames);
+
+            std::fill(frame, frame + size, 0.0f);
+            if(begin < end){
+                file.readFrames(tile.channel, static_cast<size_t>(begin), static_cast<size_t>(end - begin), frame + (begin - from));
+            }
+
+            for(size_t n = 0; n < size; ++n){
+                frame[n] *= mWindow[n];
+            }
+
+            pFFT->forward(frame, spectrum.re, spectrum.im);
+            for(size_t k = 0; k < bins; ++k){
+                power[k] += spectrum.re[k] * spectrum.re[k] + spectrum.im[k] * spectrum.im[k];
+            }
+        }
+
+        float *out = tile.magnitudes.data() + c * bins;
+        const float average = 1.0f / static_cast<float>(windows);
+        for(size_t k = 0; k < bins; ++k){
+            out[k] = std::sqrt(power[k] * average) * mScale;
+        }
+    }
+
+    return true;
+}
+
+void AJ::io::Spectrogram::enforce(){
+    while(mBytes > mBudget && !mLRU.empty()){
+        auto it = mEntries.find(mLRU.back());
+        mBytes -= it->second.tile->magnitudes.size() * sizeof(float);
+        mEntries.erase(it);
+        mLRU.pop_back();
+    }
+}
+
+bool AJ::io::Spectrogram::tiles(const AudioFile &file, uint8_t channel, size_t level, size_t first, size_t count,
+    std::vector<std::shared_ptr<const SpectrogramTile>> &tiles, utils::ThreadPool *pool,
+    AJ::error::IErrorHandler &handler){
+
+    if(channel >= file.mInfo.channels || channel >= kNumChannels){
+        const std::string message = "invalid spectrogram channel " + std::to_string(channel) + ".\n";
+        handler.onError(AJ::error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+    if(level >= kSpectrogramLevels){
+        const std::string message = "invalid spectrogram level, expected < " + std::to_string(kSpectrogramLevels) + ".\n";
+        handler.onError(AJ::error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    const size_t available = tileCount(file, level);
+    if(first > available || count > available - first){
+        const std::string message = "invalid spectrogram tiles, the level has " + std::to_string(available) + ".\n";
+        handler.onError(AJ::error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    AJ_TRACE_ZONE("analysis", "spectrogram");
+
+    tiles.assign(count, nullptr);
+    std::vector<std::shared_ptr<SpectrogramTile>> missing;
+    std::vector<size_t> slots;
+
+    const size_t frames = file.channelFrames();
+    const size_t step = hop(level);
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+
+        for(size_t t = 0; t < count; ++t){
+            auto it = mEntries.find(key(channel, level, first + t));
+            if(it != mEntries.end()){
+                mLRU.splice(mLRU.begin(), mLRU, it->second.lru);
+                tiles[t] = it->second.tile;
+                mHits.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            auto tile = std::make_shared<SpectrogramTile>();
+            tile->channel = channel;
+            tile->level = level;
+            tile->index = first + t;
+            tile->start = static_cast<sample_pos>((first + t) * tileFrames(level));
+            tile->hop = step;
+            tile->bins = bins();
+            tile->columns = std::min(kSpectrogramTileColumns, (frames - static_cast<size_t>(tile->start) + step - 1) / step);
+            tile->magnitudes.resize(tile->columns * tile->bins);
+
+            missing.push_back(std::move(tile));
+            slots.push_back(t);
+            mMisses.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if(missing.empty()){
+        return true;
+    }
+
+    //* one task per chunk of columns of every missing tile: a single new tile still fills the pool.
+    struct Task {
+        SpectrogramTile *tile;
+        size_t first;
+    };
+
+    std::vector<Task> tasks;
+    for(const auto &tile : missing){
+        for(size_t c = 0; c < tile->columns; c += kSpectrogramTaskColumns){
+            tasks.push_back(Task{ tile.get(), c });
+        }
+    }
+
+    std::atomic<bool> failed{ false };
+    auto compute = [&](size_t begin, size_t end){
+        for(size_t i = begin; i < end; ++i){
+            SpectrogramTile &tile = *tasks[i].tile;
+            const size_t last = std::min(tile.columns, tasks[i].first + kSpectrogramTaskColumns);
+            if(!computeColumns(file, tile, tasks[i].first, last)){
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    if(pool && tasks.size() > 1){
+        pool->parallel_for(0, tasks.size(), 1, compute);
+    } else {
+        compute(0, tasks.size());
+    }
+
+    if(failed.load(std::memory_order_relaxed)){
+        tiles.clear();
+        const std::string message = "failed to allocate the spectrogram buffers.\n";
+        handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMux);
+
+    for(size_t m = 0; m < missing.size(); ++m){
+        std::shared_ptr<const SpectrogramTile> tile = std::move(missing[m]);
+        tiles[slots[m]] = tile;
+
+        const size_t bytes = tile->magnitudes.size() * sizeof(float);
+        if(bytes > mBudget){
+            continue;
+        }
+
+        //? another thread may have computed the same tile meanwhile, the newest one is kept.
+        const uint64_t k = key(tile->channel, tile->level, tile->index);
+        auto it = mEntries.find(k);
+        if(it != mEntries.end()){
+            mBytes -= it->second.tile->magnitudes.size() * sizeof(float);
+            mLRU.erase(it->second.lru);
+            mEntries.erase(it);
+        }
+
+        mLRU.push_front(k);
+        mEntries[k] = Entry{ tile, mLRU.begin() };
+        mBytes += bytes;
+    }
+
+    enforce();
+    return true;
+}
+
+std::shared_ptr<const AJ::io::SpectrogramTile> AJ::io::Spectrogram::tile(const AudioFile &file, uint8_t channel,
+    size_t level, size_t index, AJ::error::IErrorHandler &handler){
+
+    std::vector<std::shared_ptr<const SpectrogramTile>> found;
+    if(!tiles(file, channel, level, index, 1, found, nullptr, handler)){
+        return nullptr;
+    }
+
+    return found.front();
+}
+
+void AJ::io::Spectrogram::invalidate(sample_pos start, sample_pos end){
+    std::lock_guard<std::mutex> lock(mMux);
+    const sample_pos half = static_cast<sample_pos>(pFFT->size() / 2);
+
+    for(auto it = mEntries.begin(); it != mEntries.end(); ){
+        const SpectrogramTile &tile = *it->second.tile;
+
+        //? the whole span of the tile, a partial last tile grows when frames are appended.
+        const sample_pos readStart = tile.start - half;
+        const sample_pos readEnd = tile.start + static_cast<sample_pos>(kSpectrogramTileColumns * tile.hop) + half;
+
+        const bool touched = readEnd >= start && (end < 0 || readStart <= end);
+        if(!touched){
+            ++it;
+            continue;
+        }
+
+        mBytes -= tile.magnitudes.size() * sizeof(float);
+        mLRU.erase(it->second.lru);
+        it = mEntries.erase(it);
+    }
+}
+
+void AJ::io::Spectrogram::clear(){
+    std::lock_guard<std::mutex> lock(mMux);
+    mEntries.clear();
+    mLRU.clear();
+    mBytes = 0;
+}
+
+void AJ::io::Spectrogram::setBudget(size_t bytes){
+    std::lock_guard<std::mutex> lock(mMux);
+    mBudget = bytes;
+    enforce();
+}
+
+size_t AJ::io::Spectrogram::bytes() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mBytes;
+}
+
+size_t AJ::io::Spectrogram::size() const {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mEntries.size();
+}
@@ -1,11 +1,17 @@
 #include <iostream>
+#include <array>
 #include <vector>
+#include <algorithm>
 #include <cstdint>
 #include <cmath>
+#include <future>
 
 #include "file_io/wav_file.h"
 #include "core/error_handler.h"
 #include "core/types.h"
+#include "core/constants.h"
+#include "core/trace.h"
+#include "dsp/kernels.h"
 #include <sndfile.h> // docs: http://www.mega-nerd.com/libsndfile/api.html#open
 
 
@@ -77,59 +83,129 @@ bool AJ::io::WAV_File::read_stereo_data(SNDFILE *file, AJ::error::IErrorHandler
         return close_file(file, false, handler);   
     }
 
-    Float file_samples;
-    file_samples.resize(mInfo.length);
-
-    sample_c samplesCount =  sf_read_float(file, file_samples.data(), mInfo.length);
+    const sample_c chan_samples = mInfo.length / 2;
+    (*pAudio)[0].resize(chan_samples);
+    (*pAudio)[1].resize(chan_samples);
 
-    if (samplesCount % 2 != 0) {
-        const std::string message = "Error: unexpected stereo sample count.\n";
+    //* chunk by chunk: one cache-sized interleaved scratch instead of a copy of the whole file.
+    const dsp::kernels::DeinterleaveFn deinterleave = dsp::kernels::table().deinterleave;
 
-        handler.onError(AJ::error::Error::FileReadError, message);
-        return close_file(file, false, handler);     
+    if(pReadPool && static_cast<size_t>(chan_samples) > kIOChunkFrames){
+        return read_stereo_pipelined(file, handler);
     }
-    
-    if(mInfo.length != samplesCount){
-        const std::string message = "Error: failed while reading samples.\n";
 
-        handler.onError(AJ::error::Error::FileReadError, message);
-        return close_file(file, false, handler);   
-    }
-   
-   
-    sample_c chan_samples = mInfo.length / 2;
-    (*pAudio)[0].resize(chan_samples);
-    (*pAudio)[1].resize(chan_samples);
+    Float chunk(2 * std::min<size_t>(kIOChunkFrames, chan_samples));
+
+    for(sample_c frame = 0; frame < chan_samples; ){
+        const sf_count_t want = std::min<sample_c>(kIOChunkFrames, chan_samples - frame);
+        const sf_count_t got = sf_readf_float(file, chunk.data(), want);
+
+        if(got != want){
+            const std::string message = "Error: failed while reading samples.\n";
 
-    size_t sample = 0;
-    for(size_t i = 0; i < chan_samples; ++i){
-        (*pAudio)[0][i] = file_samples[sample]; // left chan
-        (*pAudio)[1][i] = file_samples[sample + 1]; // right chan
-        sample += 2;
+            handler.onError(AJ::error::Error::FileReadError, message);
+            return close_file(file, false, handler);
+        }
+
+        deinterleave(chunk.data(), (*pAudio)[0].data() + frame, (*pAudio)[1].data() + frame, got);
+        frame += got;
     }
 
     return close_file(file, true, handler);   
 }
 
-bool AJ::io::WAV_File::read(AJ::error::IErrorHandler &handler) {
-    SF_INFO sfInfo = {};
+bool AJ::io::WAV_File::read_stereo_pipelined(SNDFILE *file, AJ::error::IErrorHandler &handler){
+    const sample_c chan_samples = mInfo.length / 2;
+    const dsp::kernels::DeinterleaveFn deinterleave = dsp::kernels::table().deinterleave;
 
-    SNDFILE *snd_file = sf_open(mFilePath.c_str(), SFM_READ, &sfInfo);
+    //* two scratch chunks: libsndfile decodes one while a worker deinterleaves the other.
+    Float chunks[2] = { Float(2 * kIOChunkFrames), Float(2 * kIOChunkFrames) };
+    std::future<void> pending;
+    size_t slot = 0;
 
-    if(!snd_file){
-        const std::string message = "Unable to open audio file. Please verify file permissions and ensure it is not corrupted.\n";
+    for(sample_c frame = 0; frame < chan_samples; ){
+        const sf_count_t want = std::min<sample_c>(kIOChunkFrames, chan_samples - frame);
+        const sf_count_t got = sf_readf_float(file, chunks[slot].data(), want);
 
-        handler.onError(AJ::error::Error::FileOpenError, message);
+        //? the previous chunk is still being deinterleaved, its scratch is the next one read into.
+        pReadPool->helpUntil(pending);
 
-        return false;
+        if(got != want){
+            const std::string message = "Error: failed while reading samples.\n";
+
+            handler.onError(AJ::error::Error::FileReadError, message);
+            return close_file(file, false, handler);
+        }
+
+        float *left = (*pAudio)[0].data() + frame;
+        float *right = (*pAudio)[1].data() + frame;
+        const float *interleaved = chunks[slot].data();
+
+        pending = pReadPool->enqueue([deinterleave, interleaved, left, right, got]{
+            deinterleave(interleaved, left, right, got);
+        });
+
+        frame += got;
+        slot ^= 1;
     }
-    
+
+    pReadPool->helpUntil(pending);
+    return close_file(file, true, handler);
+}
+
+bool AJ::io::WAV_File::read_mapped(MappedWav &map, size_t start, size_t count){
+    mInfo.format = ".wav";
+    mInfo.channels = static_cast<uint8_t>(map.channels());
+    mInfo.length = static_cast<sample_c>(count * map.channels());
+    mInfo.samplerate = map.samplerate();
+    mInfo.seekable = true;
+    mInfo.bitdepth = map.bitdepth();
+
+    mRangeStart = static_cast<sample_pos>(start);
+    mSourceFrames = map.frames();
+
+    for(uint8_t ch = 0; ch < mInfo.channels; ++ch){
+        (*pAudio)[ch].resize(count);
+    }
+
+    //* one pass, chunk by chunk: the mapped pages are converted straight into the channels,
+    //* while the kernel reads the pages of the next chunks.
+    auto convert = [&](size_t begin, size_t end){
+        float *outs[kNumChannels] = {};
+        map.prefetch(start + begin, kLoadReadAheadChunks * kIOChunkFrames);
+
+        for(size_t done = begin; done < end; done += kIOChunkFrames){
+            const size_t ahead = done + kLoadReadAheadChunks * kIOChunkFrames;
+            if(ahead < end){
+                map.prefetch(start + ahead, kIOChunkFrames);
+            }
+
+            for(uint8_t ch = 0; ch < mInfo.channels; ++ch){
+                outs[ch] = (*pAudio)[ch].data() + done;
+            }
+
+            map.readPlanar(start + done, std::min(kIOChunkFrames, end - done), outs);
+        }
+    };
+
+    if(pReadPool && count > kLoadStretchFrames){
+        //? stretches of the file convert on separate workers, each reading ahead of itself.
+        pReadPool->parallel_for(0, count, kLoadStretchFrames, convert);
+    } else {
+        convert(0, count);
+    }
+
+    map.close();
+    return true;
+}
+
+bool AJ::io::WAV_File::read_info(SNDFILE *file, const SF_INFO &sfInfo, AJ::error::IErrorHandler &handler){
     // check file format
     if((sfInfo.format & SF_FORMAT_TYPEMASK) != SF_FORMAT_WAV){
         const std::string message = "Error: unsupported file format.\n";
 
         handler.onError(AJ::error::Error::UnsupportedFileFormat, message);
-        return close_file(snd_file, false, handler);   
+        return close_file(file, false, handler);   
     } else {
         mInfo.format = ".wav";
     }
@@ -144,9 +220,62 @@ bool AJ::io::WAV_File::read(AJ::error::IErrorHandler &handler) {
         const std::string message = "Error: Unsupported channels number only support mono and stereo.\n";
         handler.onError(AJ::error::Error::FileReadError, message);
 
-        return close_file(snd_file, false, handler);   
+        return close_file(file, false, handler);   
+    }
+
+    return true;
+}
+
+bool AJ::io::WAV_File::probe(AJ::error::IErrorHandler &handler) {
+    SF_INFO sfInfo = {};
+
+    //* sf_open only parses the header, no sample is read.
+    SNDFILE *snd_file = sf_open(mFilePath.c_str(), SFM_READ, &sfInfo);
+
+    if(!snd_file){
+        const std::string message = "Unable to open audio file. Please verify file permissions and ensure it is not corrupted.\n";
+
+        handler.onError(AJ::error::Error::FileOpenError, message);
+        return false;
+    }
+
+    if(!read_info(snd_file, sfInfo, handler)){
+        return false;
+    }
+
+    return close_file(snd_file, true, handler);
+}
+
+bool AJ::io::WAV_File::read(AJ::error::IErrorHandler &handler) {
+    AJ_TRACE_ZONE("io", "wav_read");
+
+    {
+        //? plain PCM / float WAV: no interleaved copy of the file, otherwise libsndfile reads it.
+        MappedWav map;
+        if(map.open(mFilePath, true) && map.channels() <= kNumChannels && map.frames() > 0){
+            return read_mapped(map, 0, map.frames());
+        }
     }
 
+    SF_INFO sfInfo = {};
+
+    SNDFILE *snd_file = sf_open(mFilePath.c_str(), SFM_READ, &sfInfo);
+
+    if(!snd_file){
+        const std::string message = "Unable to open audio file. Please verify file permissions and ensure it is not corrupted.\n";
+
+        handler.onError(AJ::error::Error::FileOpenError, message);
+
+        return false;
+    }
+    
+    if(!read_info(snd_file, sfInfo, handler)){
+        return false;
+    }
+
+    mRangeStart = 0;
+    mSourceFrames = sfInfo.frames;
+
     if(mInfo.channels == 1){
         return read_mono_data(snd_file, handler);
     } else {
@@ -154,20 +283,97 @@ bool AJ::io::WAV_File::read(AJ::error::IErrorHandler &handler) {
     }
 }   
 
-// TODO: after implementing the Upsampling and Downsampling resample the audio data here.
+bool AJ::io::WAV_File::readRange(sample_pos start, sample_pos end, AJ::error::IErrorHandler &handler) {
+    if(!checkRange(start, end, handler)){
+        return false;
+    }
+
+    const std::string past_end = "Error: the range starts after the end of the file.\n";
+
+    {
+        //? mapped: only the pages of the range are faulted in.
+        MappedWav map;
+        if(map.open(mFilePath) && map.channels() <= kNumChannels && map.frames() > 0){
+            if(static_cast<size_t>(start) >= map.frames()){
+                handler.onError(AJ::error::Error::InvalidProcessingRange, past_end);
+                return false;
+            }
+
+            const size_t last = end < 0 ? map.frames() - 1 : std::min<size_t>(end, map.frames() - 1);
+            return read_mapped(map, start, last - start + 1);
+        }
+    }
+
+    SF_INFO sfInfo = {};
+
+    SNDFILE *snd_file = sf_open(mFilePath.c_str(), SFM_READ, &sfInfo);
+
+    if(!snd_file){
+        const std::string message = "Unable to open audio file. Please verify file permissions and ensure it is not corrupted.\n";
+
+        handler.onError(AJ::error::Error::FileOpenError, message);
+        return false;
+    }
+
+    if(!read_info(snd_file, sfInfo, handler)){
+        return false;
+    }
+
+    if(start >= sfInfo.frames){
+        handler.onError(AJ::error::Error::InvalidProcessingRange, past_end);
+        return close_file(snd_file, false, handler);
+    }
+
+    if(sf_seek(snd_file, start, SEEK_SET) != start){
+        const std::string message = "Error: couldn't seek to the start of the range.\n";
+
+        handler.onError(AJ::error::Error::FileReadError, message);
+        return close_file(snd_file, false, handler);
+    }
+
+    //* the readers below read `mInfo.length` samples from the current position.
+    const sf_count_t last = end < 0 ? sfInfo.frames - 1 : std::min<sf_count_t>(end, sfInfo.frames - 1);
+    mInfo.length = (last - start + 1) * mInfo.channels;
+    mRangeStart = start;
+    mSourceFrames = sfInfo.frames;
+
+    if(mInfo.channels == 1){
+        return read_mono_data(snd_file, handler);
+    } else {
+        return read_stereo_data(snd_file, handler);
+    }
+}
+
 void AJ::io::WAV_File::set_file_info(SF_INFO &info){
     info.channels = mWriteInfo.channels;
     info.frames = mWriteInfo.length / mWriteInfo.channels;
     info.seekable = mWriteInfo.seekable;
     info.samplerate = mWriteInfo.samplerate;
-    
-    // TODO: after implementing the Upsampling and Downsampling resample the audio data here.
-    if (mWriteInfo.samplerate != mInfo.samplerate){
-
-    }
 }
 
 bool AJ::io::WAV_File::write_samples_mono(SNDFILE *file, AJ::error::IErrorHandler &handler){
+    //* compact samples are widened a chunk at a time.
+    if(storage() != SampleStorage::Float32){
+        Float chunk(std::min<size_t>(kIOChunkFrames, mInfo.length));
+
+        for(sample_c frame = 0; frame < mInfo.length; ){
+            const sf_count_t count = std::min<sample_c>(kIOChunkFrames, mInfo.length - frame);
+            readFrames(0, frame, count, chunk.data());
+
+            if(sf_write_float(file, chunk.data(), count) != count){
+                const std::string message = "Error: faild to write audio samples to file " 
+                    + mWriteInfo.path + "/" + mWriteInfo.name + "\n";
+
+                handler.onError(AJ::error::Error::FileWriteError, message);
+                return close_file(file, false, handler);
+            }
+
+            frame += count;
+        }
+
+        return close_file(file, true, handler);
+    }
+
     sample_c samples = sf_write_float(file, (*pAudio)[0].data(), mInfo.length);
 
     if(samples != mInfo.length){
@@ -183,31 +389,53 @@ bool AJ::io::WAV_File::write_samples_mono(SNDFILE *file, AJ::error::IErrorHandle
 }
 
 bool AJ::io::WAV_File::write_samples_stereo(SNDFILE *file, AJ::error::IErrorHandler &handler){
-    Float audio_samples;
-
-    audio_samples.resize(mInfo.length);
-
-    int i = 0;
-    for(sample_pos sample = 0; sample < mInfo.length; sample += 2){
-        audio_samples[sample] = (*pAudio)[0][i];
-        audio_samples[sample + 1] = (*pAudio)[1][i];
-        i++;
+    const sample_c chan_samples = mInfo.length / 2;
+
+    //* interleave a cache-sized chunk at a time instead of building a copy of the whole file.
+    const dsp::kernels::InterleaveFn interleave = dsp::kernels::table().interleave;
+    Float chunk(2 * std::min<size_t>(kIOChunkFrames, chan_samples));
+
+    // compact samples are widened into planes of a chunk first.
+    const bool compact = storage() != SampleStorage::Float32;
+    std::array<Float, 2> planes;
+    if(compact){
+        planes[0].resize(chunk.size() / 2);
+        planes[1].resize(chunk.size() / 2);
     }
 
-    sample_c samples = sf_write_float(file, audio_samples.data(), mInfo.length);
-    
-    if(samples != mInfo.length){
-        const std::string message = "Error: faild to write audio samples to file " 
-            + mWriteInfo.path + "/" + mWriteInfo.name + "\n";
-        
-        handler.onError(AJ::error::Error::FileWriteError, message);
-        return close_file(file, false, handler);
+    for(sample_c frame = 0; frame < chan_samples; ){
+        const sf_count_t count = std::min<sample_c>(kIOChunkFrames, chan_samples - frame);
+
+        if(compact){
+            readFrames(0, frame, count, planes[0].data());
+            readFrames(1, frame, count, planes[1].data());
+            interleave(planes[0].data(), planes[1].data(), chunk.data(), count);
+        } else {
+            interleave((*pAudio)[0].data() + frame, (*pAudio)[1].data() + frame, chunk.data(), count);
+        }
+
+        if(sf_writef_float(file, chunk.data(), count) != count){
+            const std::string message = "Error: faild to write audio samples to file " 
+                + mWriteInfo.path + "/" + mWriteInfo.name + "\n";
+            
+            handler.onError(AJ::error::Error::FileWriteError, message);
+            return close_file(file, false, handler);
+        }
+
+        frame += count;
     }
 
     return close_file(file, true, handler);
 }
 
 bool AJ::io::WAV_File::write(AJ::error::IErrorHandler &handler){
+    AJ_TRACE_ZONE("io", "wav_write");
+
+    //* the samples are converted to the write samplerate first (a no-op when they match).
+    if(!resample(mWriteInfo.samplerate, nullptr, handler)){
+        return false;
+    }
+
     SF_INFO info = {};
 
     set_file_info(info);
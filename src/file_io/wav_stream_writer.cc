@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "file_io/wav_stream_writer.h"
+#include "file_io/file_utils.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint16_t kWaveFormatFloat = 0x0003;
+
+//* the header fills the first aligned block: RIFF, a JUNK chunk the size of a ds64 chunk (RF64),
+//* the fmt chunk, a JUNK chunk padding to the data chunk header in the last 8 bytes of the block.
+constexpr size_t kHeaderBytes = AJ::kStreamWriteAlignment;
+constexpr size_t kDs64Offset = 12;
+constexpr size_t kDs64Bytes = 28;
+constexpr size_t kFmtOffset = kDs64Offset + 8 + kDs64Bytes;
+constexpr size_t kJunkOffset = kFmtOffset + 8 + 16;
+constexpr size_t kDataOffset = kHeaderBytes - 8;
+
+inline void store_u16(uint8_t* p, uint16_t v) noexcept {
+    std::memcpy(p, &v, sizeof(v)); // WAV is little endian, like every host we build for.
+}
+
+inline void store_u32(uint8_t* p, uint32_t v) noexcept {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+inline void store_u64(uint8_t* p, uint64_t v) noexcept {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+//? sizes past 4 GiB don't fit in a RIFF header, they are saturated.
+inline uint32_t riff_size(uint64_t bytes) noexcept {
+    return static_cast<uint32_t>(std::min<uint64_t>(bytes, UINT32_MAX));
+}
+
+}
+
+AJ::io::WavStreamWriter::~WavStreamWriter(){
+    release();
+}
+
+void AJ::io::WavStreamWriter::release() noexcept {
+#if defined(__linux__)
+    if(mFd >= 0) ::close(mFd);
+#endif
+    std::free(pBatch);
+
+    mFd = -1;
+    mDirect = false;
+    pBatch = nullptr;
+    mBatchBytes = 0;
+    mBatchUsed = 0;
+}
+
+void AJ::io::WavStreamWriter::header(uint8_t* out) const noexcept {
+    const uint16_t block_align = static_cast<uint16_t>(mChannels * sizeof(float));
+    const uint64_t riff_bytes = kHeaderBytes - 8 + mDataBytes;
+
+    //* RF64 (EBU Tech 3306): the reserved JUNK becomes ds64, the 32-bit sizes are set to 0xFFFFFFFF.
+    const bool rf64 = mOptions.rf64 && riff_bytes > UINT32_MAX;
+
+    std::memset(out, 0, kHeaderBytes);
+
+    std::memcpy(out, rf64 ? "RF64" : "RIFF", 4);
+    store_u32(out + 4, riff_size(riff_bytes));
+    std::memcpy(out + 8, "WAVE", 4);
+
+    std::memcpy(out + kDs64Offset, rf64 ? "ds64" : "JUNK", 4);
+    store_u32(out + kDs64Offset + 4, kDs64Bytes);
+
+    if(rf64){
+        store_u64(out + kDs64Offset + 8, riff_bytes);
+        store_u64(out + kDs64Offset + 16, mDataBytes);
+        store_u64(out + kDs64Offset + 24, frames()); // table length stays 0.
+    }
+
+    std::memcpy(out + kFmtOffset, "fmt ", 4);
+    store_u32(out + kFmtOffset + 4, 16);
+    store_u16(out + kFmtOffset + 8, kWaveFormatFloat);
+    store_u16(out + kFmtOffset + 10, mChannels);
+    store_u32(out + kFmtOffset + 12, mSamplerate);
+    store_u32(out + kFmtOffset + 16, mSamplerate * block_align);
+    store_u16(out + kFmtOffset + 20, block_align);
+    store_u16(out + kFmtOffset + 22, 32);
+
+    std::memcpy(out + kJunkOffset, "JUNK", 4);
+    store_u32(out + kJunkOffset + 4, static_cast<uint32_t>(kDataOffset - kJunkOffset - 8));
+
+    std::memcpy(out + kDataOffset, "data", 4);
+    store_u32(out + kDataOffset + 4, riff_size(mDataBytes));
+}
+
+bool AJ::io::WavStreamWriter::open(const std::string &path, uint16_t channels, uint32_t samplerate,
+    const WavStreamOptions &options, AJ::error::IErrorHandler &handler){
+    release();
+
+    mOptions = options;
+    mAllocated = 0;
+    mPath = path;
+    mChannels = channels;
+    mSamplerate = samplerate;
+    mFileOffset = 0;
+    mDataBytes = 0;
+    mWrites = 0;
+
+    if(channels == 0){
+        const std::string message = "Error: a stream needs at least one channel.\n";
+        handler.onError(AJ::error::Error::InvalidChannelCount, message);
+        return false;
+    }
+
+#if defined(__linux__)
+    //* one aligned block at least, and room for the header in the first batch.
+    mBatchBytes = std::max(options.batchBytes, 2 * kStreamWriteAlignment);
+    mBatchBytes = (mBatchBytes + kStreamWriteAlignment - 1) / kStreamWriteAlignment * kStreamWriteAlignment;
+    pBatch = static_cast<uint8_t*>(std::aligned_alloc(kStreamWriteAlignment, mBatchBytes));
+
+    if(!pBatch){
+        const std::string message = "Error: couldn't allocate the write batch of " + path + "\n";
+        handler.onError(AJ::error::Error::ResourceAllocationFailed, message);
+        return false;
+    }
+
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+    if(options.direct){
+        //? O_DIRECT is refused by some file systems (tmpfs, some network mounts): buffered then.
+        mFd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        mDirect = mFd >= 0;
+    }
+
+    if(mFd < 0){
+        mFd = ::open(path.c_str(), flags, 0644);
+    }
+
+    if(mFd < 0){
+        const std::string message = "Error: Couldn't create file at: " + path + "\n";
+        handler.onError(AJ::error::Error::FileOpenError, message);
+        release();
+        return false;
+    }
+
+    // sizes are patched by close().
+    header(pBatch);
+    mBatchUsed = kHeaderBytes;
+
+    preallocate(mBatchBytes);
+    return true;
+#else
+    (void)options;
+    const std::string message = "Error: the coalesced stream writer is only available on Linux.\n";
+    handler.onError(AJ::error::Error::OperationNotAllowed, message);
+    return false;
+#endif
+}
+
+void AJ::io::WavStreamWriter::preallocate(uint64_t end) noexcept {
+    if(mOptions.preallocateBytes == 0 || end <= mAllocated){
+        return;
+    }
+
+#if defined(__linux__)
+    const uint64_t extent = (mOptions.preallocateBytes + kStreamWriteAlignment - 1) / kStreamWriteAlignment * kStreamWriteAlignment;
+    uint64_t target = mAllocated;
+    while(target < end) target += extent;
+
+    //* KEEP_SIZE: the file size still follows the writes, a crash never leaves reserved zeros as samples.
+    if(fallocate(mFd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(mAllocated), static_cast<off_t>(target - mAllocated)) != 0){
+        mOptions.preallocateBytes = 0;
+        return;
+    }
+
+    mAllocated = target;
+#endif
+}
+
+bool AJ::io::WavStreamWriter::flush(AJ::error::IErrorHandler &handler){
+    if(mBatchUsed == 0){
+        return true;
+    }
+
+    //? one batch ahead: the next write lands in space that's already reserved.
+    preallocate(mFileOffset + mBatchUsed + mBatchBytes);
+
+#if defined(__linux__)
+    if(!AJ::utils::FileUtils::write_all(mFd, pBatch, mBatchUsed, mFileOffset)){
+        const std::string message = "Error: failed to write audio samples to file " + mPath + "\n";
+        handler.onError(AJ::error::Error::FileWriteError, message);
+        mFileOffset += mBatchUsed; // the batch is lost, later batches keep their offsets.
+        mBatchUsed = 0;
+        return false;
+    }
+#endif
+
+    mFileOffset += mBatchUsed;
+    mBatchUsed = 0;
+    ++mWrites;
+    return true;
+}
+
+bool AJ::io::WavStreamWriter::append(const float* interleaved, size_t frames, AJ::error::IErrorHandler &handler){
+    if(mFd < 0){
+        return false;
+    }
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(interleaved);
+    size_t left = frames * mChannels * sizeof(float);
+    bool ok = true;
+
+    mDataBytes += left;
+
+    //* frames may straddle two batches, the file is one contiguous run of bytes.
+    while(left > 0){
+        const size_t n = std::min(left, mBatchBytes - mBatchUsed);
+        std::memcpy(pBatch + mBatchUsed, bytes, n);
+
+        mBatchUsed += n;
+        bytes += n;
+        left -= n;
+
+        if(mBatchUsed == mBatchBytes){
+            ok = flush(handler) && ok;
+        }
+    }
+
+    return ok;
+}
+
+bool AJ::io::WavStreamWriter::close(AJ::error::IErrorHandler &handler){
+    if(mFd < 0){
+        return false;
+    }
+
+    bool ok = true;
+
+#if defined(__linux__)
+    //? the tail isn't a whole block: O_DIRECT is dropped for the last write and the header.
+    if(mDirect){
+        const int flags = fcntl(mFd, F_GETFL);
+        if(flags < 0 || fcntl(mFd, F_SETFL, flags & ~O_DIRECT) != 0){
+            const std::string message = "Error: couldn't finish the file " + mPath + "\n";
+            handler.onError(AJ::error::Error::FileWriteError, message);
+            ok = false;
+        }
+    }
+
+    ok = ok && flush(handler);
+
+    uint8_t block[kHeaderBytes];
+    header(block);
+
+    if(!AJ::utils::FileUtils::write_all(mFd, block, kHeaderBytes, 0)){
+        const std::string message = "Error: failed to write the header of " + mPath + "\n";
+        handler.onError(AJ::error::Error::FileWriteError, message);
+        ok = false;
+    }
+
+    //* give back the reservation past the last sample.
+    if(mAllocated > mFileOffset && ftruncate(mFd, static_cast<off_t>(mFileOffset)) != 0){
+        const std::string message = "Error: couldn't trim the preallocated space of " + mPath + "\n";
+        handler.onError(AJ::error::Error::FileWriteError, message);
+        ok = false;
+    }
+
+    if(::close(mFd) != 0){
+        const std::string message = "Failed to close audio file. Resource may still be in use.\n";
+        handler.onError(AJ::error::Error::FileClosingError, message);
+        ok = false;
+    }
+
+    mFd = -1;
+#endif
+
+    release();
+    return ok;
+}
@@ -0,0 +1,178 @@
+#include <algorithm>
+
+#include "file_io/writer_pool.h"
+
+AJ::io::file_streamer::WriterPool::WriterPool(size_t workers){
+    start(workers, nullptr, nullptr);
+}
+
+AJ::io::file_streamer::WriterPool::WriterPool(size_t workers, const AJ::utils::ThreadPlacement &placement,
+    AJ::error::IErrorHandler &handler){
+    start(workers, &placement, &handler);
+}
+
+void AJ::io::file_streamer::WriterPool::start(size_t workers, const AJ::utils::ThreadPlacement *placement,
+    AJ::error::IErrorHandler *handler){
+    workers = std::max<size_t>(workers, 1);
+
+    mWorkers.reserve(workers);
+    for(size_t i = 0; i < workers; ++i){
+        mWorkers.emplace_back(std::make_unique<Worker>());
+    }
+
+    std::mutex start_mux;
+    std::condition_variable started;
+    size_t starting = placement ? workers : 0;
+
+    for(auto &worker : mWorkers){
+        Worker *w = worker.get();
+        w->thread = std::thread([this, w, placement, handler, &start_mux, &started, &starting](){
+            if(placement){
+                if(!AJ::utils::placeCurrentThread(*placement, *handler)){
+                    mPlaced.store(false, std::memory_order_relaxed);
+                }
+
+                //? the placement and the latch live on the constructor's stack.
+                std::lock_guard<std::mutex> lock(start_mux);
+                if(--starting == 0){
+                    started.notify_one();
+                }
+            }
+            run(*w);
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(start_mux);
+    started.wait(lock, [&starting](){ return starting == 0; });
+}
+
+AJ::io::file_streamer::WriterPool::~WriterPool(){
+    for(auto &worker : mWorkers){
+        {
+            std::lock_guard<std::mutex> lock(worker->mux);
+            mStop = true;
+            for(auto &stream : worker->streams){
+                stream->closing = true;
+            }
+        }
+        worker->wake.notify_one();
+    }
+
+    for(auto &worker : mWorkers){
+        worker->thread.join();
+    }
+}
+
+bool AJ::io::file_streamer::WriterPool::add(std::shared_ptr<FileStreamer> streamer, AJ::error::IErrorHandler &handler){
+    if(!streamer || !streamer->beginWrite(handler)){
+        return false;
+    }
+
+    auto stream = std::make_shared<Stream>();
+    stream->streamer = std::move(streamer);
+    stream->handler = &handler;
+
+    //* the least busy worker, the stream stays on it until it's removed.
+    Worker *target = nullptr;
+    size_t fewest = 0;
+    for(auto &worker : mWorkers){
+        std::lock_guard<std::mutex> lock(worker->mux);
+        if(!target || worker->streams.size() < fewest){
+            target = worker.get();
+            fewest = worker->streams.size();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(target->mux);
+        target->streams.push_back(std::move(stream));
+    }
+    target->wake.notify_one();
+
+    return true;
+}
+
+std::future<bool> AJ::io::file_streamer::WriterPool::remove(const std::shared_ptr<FileStreamer> &streamer){
+    for(auto &worker : mWorkers){
+        std::unique_lock<std::mutex> lock(worker->mux);
+
+        for(auto &stream : worker->streams){
+            if(stream->streamer == streamer && !stream->closing){
+                stream->closing = true;
+                std::future<bool> done = stream->done.get_future();
+
+                lock.unlock();
+                worker->wake.notify_one();
+                return done;
+            }
+        }
+    }
+
+    std::promise<bool> missing;
+    missing.set_value(false);
+    return missing.get_future();
+}
+
+size_t AJ::io::file_streamer::WriterPool::streams(){
+    size_t count = 0;
+    for(auto &worker : mWorkers){
+        std::lock_guard<std::mutex> lock(worker->mux);
+        count += worker->streams.size();
+    }
+    return count;
+}
+
+void AJ::io::file_streamer::WriterPool::run(Worker &worker){
+    std::vector<std::shared_ptr<Stream>> streams;
+
+    while(true){
+        {
+            std::lock_guard<std::mutex> lock(worker.mux);
+            if(mStop && worker.streams.empty()){
+                return;
+            }
+            //? a copy: the disk writes below don't hold the lock add() / remove() take.
+            streams = worker.streams;
+        }
+
+        size_t written = 0;
+        bool finished = false;
+
+        for(auto &stream : streams){
+            bool closing;
+            {
+                std::lock_guard<std::mutex> lock(worker.mux);
+                closing = stream->closing;
+            }
+
+            if(!closing){
+                written += stream->streamer->writePending(*stream->handler);
+                continue;
+            }
+
+            //* the producer stopped: the rest of the queue, then the file is closed.
+            const bool ok = stream->streamer->endWrite(*stream->handler);
+            {
+                std::lock_guard<std::mutex> lock(worker.mux);
+                worker.streams.erase(std::find(worker.streams.begin(), worker.streams.end(), stream));
+            }
+            stream->done.set_value(ok);
+            finished = true;
+        }
+
+        if(written > 0 || finished){
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(worker.mux);
+        worker.wake.wait_for(lock, kStreamerWakeTimeout, [&](){
+            if(mStop){
+                return true;
+            }
+            for(auto &stream : worker.streams){
+                if(stream->closing) return true;
+            }
+            return worker.streams.size() != streams.size();
+        });
+    }
+}
@@ -1,66 +1,138 @@
 #include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
 #include "core/aj_audio_engine.h"
+#include "core/batch_runner.h"
+#include "core/trace.h"
+#include "file_io/file_utils.h"
 
-int main(){
-    // you can just use: auto engine = AJ::AJ_Engine::create();
-    std::shared_ptr<AJ::AJ_Engine> engine = AJ::AJ_Engine::create();
+namespace {
+
+void usage(){
+    std::cout << "usage: sound_processor --effect <spec> --out <directory> [--budget-mb <n>] [--jobs <n>] [--trace <file>] <input>\n"
+              << "\n"
+              << "  <input>         a directory (every WAV / MP3 file), a WAV / MP3 file, or a manifest\n"
+              << "                  (one input per line, optionally followed by a tab and its output).\n"
+              << "  --effect <spec> gain=<x> | normalize[=<peak>] | lufs[=<target>] | fadein | fadeout | reverse | reverb[=<wet>] | gate[=<dB>] | trim[=<dB>]\n"
+              << "  --out <dir>     directory of the processed files (created if missing).\n"
+              << "  --budget-mb <n> decoded megabytes held at once (default " << AJ::kBatchMemoryBudget / (1024 * 1024) << ").\n"
+              << "  --jobs <n>      files processed at the same time (default: one per thread).\n"
+              << "  --trace <file>  write a Chrome trace of the run (chrome://tracing, ui.perfetto.dev),\n"
+              << "                  needs a build with -DAJ_TRACE=ON.\n";
+}
+
+double ms(double seconds){
+    return 1000.0 * seconds;
+}
+
+}
+
+int main(int argc, char **argv){
+    std::string input, out, effect, trace;
+    AJ::batch::BatchOptions options;
+
+    for(int i = 1; i < argc; ++i){
+        const std::string arg = argv[i];
+        const bool valued = i + 1 < argc;
+
+        if(arg == "--effect" && valued){
+            effect = argv[++i];
+        } else if(arg == "--out" && valued){
+            out = argv[++i];
+        } else if(arg == "--budget-mb" && valued){
+            options.memoryBudget = std::stoull(argv[++i]) * 1024 * 1024;
+        } else if(arg == "--jobs" && valued){
+            options.maxConcurrentFiles = std::stoull(argv[++i]);
+        } else if(arg == "--trace" && valued){
+            trace = argv[++i];
+        } else if(input.empty() && arg[0] != '-'){
+            input = arg;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if(input.empty() || out.empty() || effect.empty()){
+        usage();
+        return 1;
+    }
 
-    const std::string path = "/home/aj-e/Programming Codes/C++/AJ-Audio-Engine/build/build/bin/audio/violin.wav";
-    const std::string ext = "wav";
     AJ::error::ConsoleErrorHandler handler;
 
-    std::cout << "start reaing wav file.\n";
-    // auto audio = engine->loadAudio(path, ext, handler);
-    std::shared_ptr<AJ::io::AudioFile> audio = engine->loadAudio(path, handler, ext);
+    AJ::batch::EffectSpec spec;
+    if(!AJ::batch::EffectSpec::parse(effect, spec, handler)){
+        return 1;
+    }
+
+    if(!AJ::utils::FileUtils::make_directory(out)){
+        std::cerr << "can't create the output directory " << out << "\n";
+        return 1;
+    }
 
-    if(audio){
-        std::cout << "file reading done successfully.\n";
+    //* a directory, a single audio file, or a manifest.
+    std::vector<AJ::batch::Job> jobs;
+    std::string ext = std::filesystem::path(input).extension().string();
+    if(std::filesystem::is_directory(input)){
+        jobs = AJ::batch::BatchRunner::fromDirectory(input, out, handler);
+    } else if(ext == ".wav" || ext == ".WAV" || ext == ".mp3" || ext == ".MP3"){
+        jobs.push_back(AJ::batch::Job{ input, (std::filesystem::path(out) / std::filesystem::path(input).filename()).string() });
     } else {
-        return 0;
+        jobs = AJ::batch::BatchRunner::fromManifest(input, out, handler);
     }
 
-    AJ::dsp::reverb::Params params;
+    if(jobs.empty()){
+        std::cerr << "nothing to process in " << input << "\n";
+        return 1;
+    }
 
-    params.mDelayMS = 40.0f;
-    params.mDryMix = 0.3f;
-    params.mWetMix = 0.7f;
-    params.mGain = 0.7f;
-    params.mSamplerate = audio->mInfo.samplerate;
-    params.mStart = 0;
-    params.mEnd = (audio->mInfo.length / audio->mInfo.channels) - 1; // end is included.
+    std::shared_ptr<AJ::AJ_Engine> engine = AJ::AJ_Engine::create();
+    //* a batch only needs the DSP threads, the record pools are never created.
+    engine->setEngineResources(std::make_shared<AJ::EngineResources>(handler, AJ::EngineResources::Config::transcode()));
+    engine->setUndoSupportEnabled(false);
 
+    AJ::batch::BatchRunner runner(*engine, options);
+    size_t failed = 0;
 
-    auto reverbParams = AJ::dsp::reverb::ReverbParams::create(params, handler);
+#ifndef AJ_TRACE
+    if(!trace.empty()){
+        std::cerr << "built without AJ_TRACE, the trace will be empty\n";
+    }
+#endif
 
-    std::cout << "start processing reverb effect.\n";
-    if(engine->applyEffect(audio->pAudio->at(0), AJ::Effect::reverb, reverbParams, handler)){
-        std::cout << "first channel processed successfully.\n";
-    } else {
-        return 0;
+    if(!trace.empty()){
+        AJ::utils::trace::start();
     }
 
-    if(audio->mInfo.channels == 2){ // stereo
-        if(engine->applyEffect(audio->pAudio->at(1), AJ::Effect::reverb, reverbParams, handler)){
-            std::cout << "second channel processed successfully.\n";
-        } else {
-            return 0;
+    const auto begin = std::chrono::steady_clock::now();
+    runner.run(jobs, spec, [&](const AJ::batch::JobResult &result){
+        failed += result.success ? 0 : 1;
+        std::cout << "[" << std::setw(4) << result.index + 1 << "/" << jobs.size() << "] "
+                  << (result.success ? "ok    " : "FAILED") << " " << result.job->input << " -> " << result.job->output
+                  << std::fixed << std::setprecision(1)
+                  << "  (wait " << ms(result.wait) << " ms, load " << ms(result.load) << " ms, process "
+                  << ms(result.process) << " ms, save " << ms(result.save) << " ms)\n";
+    }, handler);
+    const double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    if(!trace.empty()){
+        AJ::utils::trace::stop();
+        if(AJ::utils::trace::write(trace, handler)){
+            std::cout << AJ::utils::trace::recorded() << " trace events written to " << trace;
+            if(const uint64_t lost = AJ::utils::trace::overwritten()){
+                std::cout << " (" << lost << " oldest overwritten)";
+            }
+            std::cout << "\n";
         }
     }
 
-    AJ::AudioWriteInfo writeInfo;
-    writeInfo.bitdepth = audio->mInfo.bitdepth;
-    writeInfo.samplerate = audio->mInfo.samplerate;
-    writeInfo.channels = audio->mInfo.channels;
-    writeInfo.length = audio->mInfo.length; // the length here is the samples for all channels.
-    writeInfo.seekable = audio->mInfo.seekable;
-    writeInfo.format = audio->mInfo.format;
-    writeInfo.name = "reverbed_violin";
-    writeInfo.path = "/home/aj-e/Programming Codes/C++/AJ-Audio-Engine/build/build/bin/audio/";
-
-    audio->setWriteInfo(writeInfo, handler);
-
-    std::cout << "start saving new file.\n";
-    if(engine->saveAudio(audio, handler)){
-        std::cout << "new file saved successfully.\n";
-    }
-}
\ No newline at end of file
+    std::cout << jobs.size() - failed << " of " << jobs.size() << " files processed in " << std::fixed
+              << std::setprecision(2) << total << " s, at most " << runner.peakBytes() / (1024 * 1024)
+              << " MB decoded at once.\n";
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,326 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include "core/types.h"
+#include "core/errors.h"
+#include "core/error_handler.h"
+
+#include "undo_system/state.h"
+
+namespace {
+
+uint8_t file_channels(const AJ::io::AudioFile &file){
+    return static_cast<uint8_t>(file.mInfo.channels == 2 ? 2 : 1);
+}
+
+void remove_file(const std::string &path){
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+}
+
+AJ::undo::State::State(State &&other) noexcept
+    : mChanges(std::move(other.mChanges)), mLabel(std::move(other.mLabel)), mSpillPath(std::move(other.mSpillPath)) {
+    other.mSpillPath.clear();
+}
+
+AJ::undo::State& AJ::undo::State::operator=(State &&other) noexcept {
+    if(this != &other){
+        if(!mSpillPath.empty()){
+            remove_file(mSpillPath);
+        }
+
+        mChanges = std::move(other.mChanges);
+        mLabel = std::move(other.mLabel);
+        mSpillPath = std::move(other.mSpillPath);
+        other.mSpillPath.clear();
+    }
+
+    return *this;
+}
+
+AJ::undo::State::~State(){
+    if(!mSpillPath.empty()){
+        remove_file(mSpillPath);
+    }
+}
+
+bool AJ::undo::State::capture(Change &change, AJ::error::IErrorHandler &handler){
+    const sample_pos start = change.start;
+
+    if(auto table = change.table.lock()){
+        change.channels = table->channels();
+
+        if(start < 0 || start + static_cast<sample_pos>(change.removed) > static_cast<sample_pos>(table->frames())){
+            const std::string message = "invalid undo range, frames " + std::to_string(start) + " + "
+                + std::to_string(change.removed) + " aren't in the piece table.\n";
+            handler.onError(error::Error::InvalidProcessingRange, message);
+            return false;
+        }
+
+        //* pieces of the table's own chunks, nothing is copied.
+        if(change.removed > 0){
+            return table->copy(start, start + static_cast<sample_pos>(change.removed) - 1, change.saved, handler);
+        }
+
+        return change.saved.assign(std::make_shared<AudioBuffer>(), change.channels, handler);
+    }
+
+    auto file = change.file.lock();
+    if(!file){
+        const std::string message = "the file or piece table of the undo state was released.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    change.channels = file_channels(*file);
+
+    if(start < 0 || start + static_cast<sample_pos>(change.removed) > static_cast<sample_pos>(file->channelFrames())){
+        const std::string message = "invalid undo range, frames " + std::to_string(start) + " + "
+            + std::to_string(change.removed) + " aren't in the file.\n";
+        handler.onError(error::Error::InvalidProcessingRange, message);
+        return false;
+    }
+
+    auto chunk = std::make_shared<AudioBuffer>();
+    for(uint8_t ch = 0; ch < change.channels; ++ch){
+        (*chunk)[ch].resize(change.removed);
+        file->readFrames(ch, static_cast<size_t>(start), change.removed, (*chunk)[ch].data());
+    }
+
+    return change.saved.assign(std::move(chunk), change.channels, handler);
+}
+
+bool AJ::undo::State::restore(Change &change, AJ::error::IErrorHandler &handler){
+    const sample_pos start = change.start;
+    const sample_pos end = start + static_cast<sample_pos>(change.inserted);
+
+    if(auto table = change.table.lock()){
+        if(end > static_cast<sample_pos>(table->frames()) || table->channels() != change.channels){
+            const std::string message = "the piece table doesn't hold the frames of the undo state anymore.\n";
+            handler.onError(error::Error::OperationNotAllowed, message);
+            return false;
+        }
+
+        if(change.inserted > 0 && !table->cut(start, end - 1, handler)){
+            return false;
+        }
+
+        return change.removed == 0 || table->insert(start, change.saved, handler);
+    }
+
+    auto file = change.file.lock();
+    if(!file){
+        const std::string message = "the file or piece table of the undo state was released.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    if(end > static_cast<sample_pos>(file->channelFrames()) || file_channels(*file) != change.channels){
+        const std::string message = "the file doesn't hold the frames of the undo state anymore.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    //* same length (an effect): written in place, in any storage.
+    if(change.removed == change.inserted){
+        size_t position = static_cast<size_t>(start);
+        change.saved.forEachChunk(0, change.removed, [&](const float *const *channels, size_t frames){
+            for(uint8_t ch = 0; ch < change.channels; ++ch){
+                file->writeFrames(ch, position, frames, channels[ch]);
+            }
+            position += frames;
+        });
+
+        if(change.removed > 0){
+            file->updateLevelIndex(start, end - 1);
+        }
+        return true;
+    }
+
+    if(file->storage() != io::SampleStorage::Float32){
+        const std::string message = "undoing a cut or insert needs the samples in Float32 storage.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    for(uint8_t ch = 0; ch < change.channels; ++ch){
+        Float &channel = (*file->pAudio)[ch];
+        channel.erase(channel.begin() + start, channel.begin() + end);
+        channel.insert(channel.begin() + start, change.removed, 0.0f);
+    }
+
+    size_t position = static_cast<size_t>(start);
+    change.saved.forEachChunk(0, change.removed, [&](const float *const *channels, size_t frames){
+        for(uint8_t ch = 0; ch < change.channels; ++ch){
+            std::memcpy((*file->pAudio)[ch].data() + position, channels[ch], frames * sizeof(float));
+        }
+        position += frames;
+    });
+
+    file->mInfo.length = file->channelFrames() * file->mInfo.channels;
+    file->updateLevelIndex(start);
+    return true;
+}
+
+bool AJ::undo::State::add(const std::shared_ptr<io::AudioFile> &file, sample_pos start, size_t removed,
+    size_t inserted, AJ::error::IErrorHandler &handler){
+    if(!file){
+        const std::string message = "invalid file for the undo state.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    Change change;
+    change.file = file;
+    change.start = start;
+    change.removed = removed;
+    change.inserted = inserted;
+
+    if(!capture(change, handler)){
+        return false;
+    }
+
+    mChanges.push_back(std::move(change));
+    return true;
+}
+
+bool AJ::undo::State::add(const std::shared_ptr<editing::piece_table::PieceTable> &table, sample_pos start,
+    size_t removed, size_t inserted, AJ::error::IErrorHandler &handler){
+    if(!table || table->channels() == 0){
+        const std::string message = "invalid piece table for the undo state.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    Change change;
+    change.table = table;
+    change.start = start;
+    change.removed = removed;
+    change.inserted = inserted;
+
+    if(!capture(change, handler)){
+        return false;
+    }
+
+    mChanges.push_back(std::move(change));
+    return true;
+}
+
+bool AJ::undo::State::apply(State &inverse, AJ::error::IErrorHandler &handler){
+    if(spilled() && !load(handler)){
+        return false;
+    }
+
+    inverse = State(mLabel);
+
+    //? undone last first; the inverse is then applied in the order the changes were made.
+    for(auto it = mChanges.rbegin(); it != mChanges.rend(); ++it){
+        Change redo;
+        redo.file = it->file;
+        redo.table = it->table;
+        redo.start = it->start;
+        redo.removed = it->inserted;
+        redo.inserted = it->removed;
+
+        if(!capture(redo, handler) || !restore(*it, handler)){
+            return false;
+        }
+
+        inverse.mChanges.push_back(std::move(redo));
+    }
+
+    return true;
+}
+
+bool AJ::undo::State::spill(const std::string &path, AJ::error::IErrorHandler &handler){
+    if(spilled()){
+        return true;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    bool written = false;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+        //* planar: every channel of every change, in order.
+        for(const Change &change : mChanges){
+            for(uint8_t ch = 0; ch < change.channels && out; ++ch){
+                change.saved.forEachChunk(0, change.removed, [&](const float *const *channels, size_t frames){
+                    out.write(reinterpret_cast<const char*>(channels[ch]), static_cast<std::streamsize>(frames * sizeof(float)));
+                });
+            }
+        }
+
+        written = out && out.flush();
+    }
+
+    if(!written){
+        remove_file(path);
+        const std::string message = "failed to spill the undo state to " + path + ".\n";
+        handler.onError(error::Error::FileWriteError, message);
+        return false;
+    }
+
+    for(Change &change : mChanges){
+        change.saved = editing::piece_table::PieceTable();
+    }
+
+    mSpillPath = path;
+    return true;
+}
+
+bool AJ::undo::State::load(AJ::error::IErrorHandler &handler){
+    if(!spilled()){
+        return true;
+    }
+
+    std::vector<AudioSamples> chunks;
+    chunks.reserve(mChanges.size());
+
+    {
+        std::ifstream in(mSpillPath, std::ios::binary);
+
+        for(const Change &change : mChanges){
+            auto chunk = std::make_shared<AudioBuffer>();
+            for(uint8_t ch = 0; ch < change.channels && in; ++ch){
+                (*chunk)[ch].resize(change.removed);
+                in.read(reinterpret_cast<char*>((*chunk)[ch].data()), static_cast<std::streamsize>(change.removed * sizeof(float)));
+            }
+            chunks.push_back(std::move(chunk));
+        }
+
+        if(!in){
+            const std::string message = "failed to read the spilled undo state " + mSpillPath + ".\n";
+            handler.onError(error::Error::FileReadError, message);
+            return false;
+        }
+    }
+
+    for(size_t i = 0; i < mChanges.size(); ++i){
+        if(!mChanges[i].saved.assign(std::move(chunks[i]), mChanges[i].channels, handler)){
+            return false;
+        }
+    }
+
+    remove_file(mSpillPath);
+    mSpillPath.clear();
+    return true;
+}
+
+size_t AJ::undo::State::residentBytes() const noexcept {
+    return spilled() ? 0 : savedBytes();
+}
+
+size_t AJ::undo::State::savedBytes() const noexcept {
+    size_t bytes = 0;
+    for(const Change &change : mChanges){
+        bytes += change.removed * change.channels * sizeof(float);
+    }
+    return bytes;
+}
@@ -0,0 +1,158 @@
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "core/errors.h"
+#include "core/error_handler.h"
+
+#include "undo_system/undo.h"
+
+namespace {
+
+/**
+ * @brief Spill or drop the oldest states of `states` until `resident` fits `budget`.
+ *
+ * A state can only be undone after every later one, so dropping a state drops the older ones with it.
+ */
+template<typename SpillPath>
+void shed(std::deque<AJ::undo::State> &states, size_t &resident, size_t budget, bool spill,
+    SpillPath &&spillPath, AJ::error::IErrorHandler &handler){
+
+    size_t index = 0;
+    while(resident > budget && index < states.size()){
+        AJ::undo::State &state = states[index];
+        const size_t bytes = state.residentBytes();
+
+        if(bytes == 0){
+            ++index;
+            continue;
+        }
+
+        if(spill && state.spill(spillPath(), handler)){
+            resident -= bytes;
+            ++index;
+            continue;
+        }
+
+        for(size_t i = 0; i <= index; ++i){
+            resident -= states[i].residentBytes();
+        }
+        states.erase(states.begin(), states.begin() + static_cast<std::ptrdiff_t>(index) + 1);
+        index = 0;
+    }
+}
+
+}
+
+std::string AJ::undo::UndoSystem::spillPath(){
+    //? the address keeps two histories sharing a directory apart.
+    const std::string name = "undo-" + std::to_string(reinterpret_cast<uintptr_t>(this))
+        + "-" + std::to_string(mNextSpill++) + ".ajundo";
+    return (std::filesystem::path(mDirectory) / name).string();
+}
+
+void AJ::undo::UndoSystem::enforce(AJ::error::IErrorHandler &handler){
+    size_t resident = residentBytes();
+    if(resident <= mBudget){
+        return;
+    }
+
+    auto path = [this]{ return spillPath(); };
+    const bool spill = !mDirectory.empty();
+
+    //* the undo history first, the redo states are the most likely to be needed next.
+    shed(mUndo, resident, mBudget, spill, path, handler);
+    shed(mRedo, resident, mBudget, spill, path, handler);
+}
+
+void AJ::undo::UndoSystem::push(State state, AJ::error::IErrorHandler &handler){
+    if(state.empty()){
+        return;
+    }
+
+    mRedo.clear();
+    mUndo.push_back(std::move(state));
+
+    while(mUndo.size() > mMaxStates){
+        mUndo.pop_front();
+    }
+
+    enforce(handler);
+}
+
+bool AJ::undo::UndoSystem::undo(AJ::error::IErrorHandler &handler){
+    if(mUndo.empty()){
+        const std::string message = "nothing to undo.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    State inverse;
+    const bool success = mUndo.back().apply(inverse, handler);
+
+    //? a state that can't be restored (released target, partial restore) is dropped with the redo history.
+    mUndo.pop_back();
+    if(!success){
+        mRedo.clear();
+        return false;
+    }
+
+    mRedo.push_back(std::move(inverse));
+    enforce(handler);
+    return true;
+}
+
+bool AJ::undo::UndoSystem::redo(AJ::error::IErrorHandler &handler){
+    if(mRedo.empty()){
+        const std::string message = "nothing to redo.\n";
+        handler.onError(error::Error::OperationNotAllowed, message);
+        return false;
+    }
+
+    State inverse;
+    const bool success = mRedo.back().apply(inverse, handler);
+
+    mRedo.pop_back();
+    if(!success){
+        mRedo.clear();
+        return false;
+    }
+
+    mUndo.push_back(std::move(inverse));
+    while(mUndo.size() > mMaxStates){
+        mUndo.pop_front();
+    }
+
+    enforce(handler);
+    return true;
+}
+
+void AJ::undo::UndoSystem::assign(std::deque<State> undo, std::deque<State> redo, AJ::error::IErrorHandler &handler){
+    mUndo = std::move(undo);
+    mRedo = std::move(redo);
+
+    while(mUndo.size() > mMaxStates){
+        mUndo.pop_front();
+    }
+
+    enforce(handler);
+}
+
+bool AJ::undo::UndoSystem::load(AJ::error::IErrorHandler &handler){
+    for(State &state : mUndo){
+        if(!state.load(handler)) return false;
+    }
+
+    for(State &state : mRedo){
+        if(!state.load(handler)) return false;
+    }
+
+    return true;
+}
+
+size_t AJ::undo::UndoSystem::residentBytes() const noexcept {
+    size_t bytes = 0;
+    for(const State &state : mUndo) bytes += state.residentBytes();
+    for(const State &state : mRedo) bytes += state.residentBytes();
+    return bytes;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/types.h"
+#include "file_io/wav_file.h"
+
+/**
+ * @brief Synthetic audio shared by the test suites.
+ *
+ * `fill(ch, i)` gives sample `i` of channel `ch`, the suites keep their own signals:
+ * @code
+ * auto file = fixtures::make_file(4096, 2, [](size_t ch, size_t i) { return 0.5f * std::sin(0.01f * i * (ch + 1)); });
+ * @endcode
+ */
+namespace fixtures {
+
+template <typename Fill>
+AJ::AudioSamples make_audio(size_t frames, uint8_t channels, Fill fill) {
+    auto audio = std::make_shared<AJ::AudioBuffer>();
+    for (uint8_t ch = 0; ch < channels; ++ch) {
+        (*audio)[ch].resize(frames);
+        for (size_t i = 0; i < frames; ++i) (*audio)[ch][i] = fill(ch, i);
+    }
+    return audio;
+}
+
+/// @brief Stereo `first + step * i`, the right channel 0.5 above the left one.
+inline AJ::AudioSamples ramp(size_t frames, float first, float step) {
+    return make_audio(frames, 2, [first, step](size_t ch, size_t i) { return first + step * i + 0.5f * ch; });
+}
+
+/// @brief Two sines, the slow one differs per channel.
+inline float tones(size_t ch, size_t i) {
+    return 0.3f * std::sin(i / (40.0f + 13.0f * ch)) + 0.1f * std::sin(i / 7.0f);
+}
+
+/// @brief WAV_File in memory holding `audio` (its first `channels` channels, of equal length).
+inline std::shared_ptr<AJ::io::WAV_File> make_file(AJ::AudioSamples audio, uint8_t channels = 2,
+    AJ::sample_c samplerate = 48000) {
+    auto file = std::make_shared<AJ::io::WAV_File>();
+    file->mInfo.channels = channels;
+    file->mInfo.samplerate = samplerate;
+    file->mInfo.length = (*audio)[0].size() * channels;
+    file->pAudio = std::move(audio);
+    return file;
+}
+
+template <typename Fill>
+std::shared_ptr<AJ::io::WAV_File> make_file(size_t frames, uint8_t channels, Fill fill,
+    AJ::sample_c samplerate = 48000) {
+    return make_file(make_audio(frames, channels, fill), channels, samplerate);
+}
+
+} // namespace fixtures
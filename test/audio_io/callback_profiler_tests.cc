@@ -0,0 +1,129 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "audio_io/callback_profiler.h"
+
+class CallbackProfilerTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Callback Profiler Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_deadline_and_flags();
+        test_worst_callbacks();
+        test_snapshot_while_recording();
+        test_reset();
+
+        std::cout << "All Callback Profiler Tests Completed Successfully.\n";
+    }
+
+private:
+    static void test_deadline_and_flags() {
+        std::cout << "\nTest: Deadline misses and input xruns are counted\n";
+
+        AJ::io::record::CallbackProfiler profiler;
+        profiler.setSamplerate(48000);
+
+        // 480 frames at 48 kHz: 10 ms per callback.
+        for (uint64_t i = 0; i < 100; ++i) {
+            assert(!profiler.onCallback(1000000, 480, 0, nullptr, i % 4));
+        }
+        assert(profiler.onCallback(12000000, 480, paInputOverflow, nullptr, 9));
+        assert(!profiler.onCallback(2000000, 480, paInputOverflow | paInputUnderflow, nullptr, 1));
+
+        const AJ::io::record::CallbackProfile profile = profiler.snapshot();
+        assert(profile.callbacks == 102 && profile.deadlineMisses == 1);
+        assert(profile.inputOverflows == 2 && profile.inputUnderflows == 1);
+        assert(profile.deadline == 10000000);
+        assert(profile.queueDepth == 1 && profile.maxQueueDepth == 9);
+        assert(profile.durations.count == 102 && profile.durations.max == 12000000);
+        assert(profile.maxLoad() > 1.19 && profile.maxLoad() < 1.21);
+
+        std::cout << "  ✓ 1 miss, 2 overflows, 1 underflow in 102 callbacks\n";
+    }
+
+    static void test_worst_callbacks() {
+        std::cout << "\nTest: The slowest callbacks are kept, slowest first\n";
+
+        AJ::io::record::CallbackProfiler profiler;
+        profiler.setSamplerate(44100);
+
+        // every duration from 1 to 200 µs once, in a scrambled order (97 is coprime with 200).
+        for (uint64_t i = 0; i < 200; ++i) {
+            const uint64_t us = (i * 97) % 200 + 1;
+            PaStreamCallbackTimeInfo time{};
+            time.inputBufferAdcTime = 0.5 * static_cast<double>(i);
+            profiler.onCallback(us * 1000, 256, 0, &time, us);
+        }
+
+        const AJ::io::record::CallbackProfile profile = profiler.snapshot();
+        assert(profile.worst.size() == AJ::kRecordWorstCallbacks);
+
+        for (size_t k = 0; k < profile.worst.size(); ++k) {
+            const AJ::io::record::SlowCallback &slow = profile.worst[k];
+            const uint64_t us = 200 - k;
+            assert(slow.duration == us * 1000 && slow.queueDepth == us && slow.frames == 256);
+            assert((slow.index * 97) % 200 + 1 == us);
+            assert(slow.inputTime == 0.5 * static_cast<double>(slow.index));
+            assert(slow.deadline == static_cast<uint64_t>(256 * (1e9 / 44100)));
+        }
+
+        std::cout << "  ✓ 200 µs down to " << profile.worst.back().duration / 1000 << " µs\n";
+    }
+
+    static void test_snapshot_while_recording() {
+        std::cout << "\nTest: Snapshots taken while the callback runs are consistent\n";
+
+        AJ::io::record::CallbackProfiler profiler;
+        profiler.setSamplerate(48000);
+
+        const uint64_t callbacks = 200000;
+        std::atomic<bool> done{false};
+
+        // always slower than the last one: the log is republished on every callback.
+        std::thread callback([&] {
+            for (uint64_t i = 1; i <= callbacks; ++i) {
+                profiler.onCallback(i, 64, 0, nullptr, i % 1000);
+            }
+            done.store(true, std::memory_order_release);
+        });
+
+        size_t snapshots = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            const AJ::io::record::CallbackProfile profile = profiler.snapshot();
+            for (size_t k = 0; k < profile.worst.size(); ++k) {
+                const AJ::io::record::SlowCallback &slow = profile.worst[k];
+                assert(slow.index + 1 == slow.duration && slow.queueDepth == slow.duration % 1000);
+                assert(k == 0 || profile.worst[k - 1].duration > slow.duration);
+            }
+            ++snapshots;
+        }
+        callback.join();
+
+        const AJ::io::record::CallbackProfile last = profiler.snapshot();
+        assert(last.callbacks == callbacks && last.worst.front().duration == callbacks);
+
+        std::cout << "  ✓ " << snapshots << " snapshots during " << callbacks << " callbacks\n";
+    }
+
+    static void test_reset() {
+        std::cout << "\nTest: Reset keeps the samplerate\n";
+
+        AJ::io::record::CallbackProfiler profiler;
+        profiler.setSamplerate(48000);
+        profiler.onCallback(50000000, 480, paInputOverflow, nullptr, 3);
+        profiler.reset();
+
+        const AJ::io::record::CallbackProfile cleared = profiler.snapshot();
+        assert(cleared.callbacks == 0 && cleared.inputOverflows == 0 && cleared.maxQueueDepth == 0);
+        assert(cleared.worst.empty() && cleared.durations.count == 0);
+
+        assert(profiler.onCallback(20000000, 480, 0, nullptr, 0));
+        assert(profiler.snapshot().worst.size() == 1);
+
+        std::cout << "  ✓ Cleared, deadline still 10 ms\n";
+    }
+};
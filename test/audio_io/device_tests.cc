@@ -0,0 +1,139 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "audio_io/device.h"
+#include "core/error_handler.h"
+
+class DeviceTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Audio Device Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_presets();
+        test_validate();
+        test_pool_sizing();
+        test_detect_delay();
+        test_detect_silence();
+
+        std::cout << "All Audio Device Tests Completed Successfully.\n";
+    }
+
+private:
+    static void test_presets() {
+        std::cout << "\nTest: Tracking, safe and default buffer sizes\n";
+
+        const AJ::io::device::DeviceConfig defaults;
+        assert(defaults.framesPerBuffer() == static_cast<size_t>(44100 * AJ::BUFFER_SECONDS));
+        assert(defaults.mInput.mName.empty() && defaults.mInput.mSuggestedLatency == 0.0);
+
+        const AJ::io::device::DeviceConfig tracking = AJ::io::device::DeviceConfig::tracking(48000);
+        assert(tracking.framesPerBuffer() == AJ::kDeviceTrackingFrames && tracking.mSamplerate == 48000);
+
+        const AJ::io::device::DeviceConfig safe = AJ::io::device::DeviceConfig::safe(96000);
+        assert(safe.framesPerBuffer() == AJ::kDeviceSafeFrames);
+        assert(safe.mInput.mSuggestedLatency == AJ::kDeviceSafeLatency && safe.mOutput.mSuggestedLatency == AJ::kDeviceSafeLatency);
+
+        std::cout << "  ✓ " << defaults.framesPerBuffer() << " / " << tracking.framesPerBuffer() << " / " << safe.framesPerBuffer() << " frames\n";
+    }
+
+    static void test_validate() {
+        std::cout << "\nTest: Invalid configurations are rejected\n";
+
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::io::device::DeviceConfig config = AJ::io::device::DeviceConfig::tracking();
+        assert(config.validate(handler) && !handler.hasErrors());
+
+        config.mChannels = 3;
+        assert(!config.validate(handler));
+        config.mChannels = 1;
+
+        config.mSamplerate = 1000;
+        assert(!config.validate(handler));
+        config.mSamplerate = 48000;
+
+        config.mFramesPerBuffer = 96000;
+        assert(!config.validate(handler));
+
+        const auto &errors = handler.errors();
+        assert(errors.size() == 3);
+        assert(errors[0].first == AJ::error::Error::InvalidChannelCount);
+        assert(errors[1].first == AJ::error::Error::InvalidSampleRate);
+        assert(errors[2].first == AJ::error::Error::InvalidBufferSize);
+
+        std::cout << "  ✓ Channels, samplerate and buffer size checked\n";
+    }
+
+    static void test_pool_sizing() {
+        std::cout << "\nTest: The record pool holds the same time at any buffer size\n";
+
+        const AJ::io::device::PoolSizing tracking = AJ::io::device::poolSizing(AJ::io::device::DeviceConfig::tracking(48000));
+        const AJ::io::device::PoolSizing safe = AJ::io::device::poolSizing(AJ::io::device::DeviceConfig::safe(48000));
+
+        for (const AJ::io::device::PoolSizing &sizing : {tracking, safe}) {
+            assert((sizing.buffers & (sizing.buffers - 1)) == 0);
+            assert(sizing.buffers * sizing.bufferFrames >= AJ::kDeviceBufferedSeconds * 48000);
+            assert(sizing.buffers * sizing.bufferFrames < 2 * AJ::kDeviceBufferedSeconds * 48000 + sizing.bufferFrames);
+        }
+        assert(tracking.bufferFrames == 32 && tracking.buffers == 4096);
+        assert(safe.bufferFrames == 2048 && safe.buffers == 64);
+
+        AJ::io::device::DeviceConfig tiny = AJ::io::device::DeviceConfig::safe(8000);
+        tiny.mBufferedSeconds = 0.01;
+        assert(AJ::io::device::poolSizing(tiny).buffers == AJ::kDeviceMinBuffers);
+
+        std::cout << "  ✓ " << tracking.buffers << " x 32 frames, " << safe.buffers << " x 2048 frames\n";
+    }
+
+    static void test_detect_delay() {
+        std::cout << "\nTest: The calibration burst is found through a noisy, inverted loopback\n";
+
+        const std::vector<float> probe = AJ::io::device::calibrationProbe();
+        assert(probe == AJ::io::device::calibrationProbe());
+
+        const size_t delay = 3271;
+        std::vector<float> captured(48000, 0.0f);
+
+        uint32_t state = 7;
+        for (size_t i = 0; i < captured.size(); ++i) {
+            state = state * 1103515245u + 12345u;
+            captured[i] = 0.05f * (static_cast<float>(state >> 16) / 32768.0f - 1.0f);
+        }
+        for (size_t i = 0; i < probe.size(); ++i) {
+            captured[delay + i] -= 0.3f * probe[i];
+        }
+
+        float confidence = 0.0f;
+        const size_t found = AJ::io::device::detectDelay(captured.data(), captured.size(), probe.data(), probe.size(), confidence);
+
+        assert(found == delay);
+        assert(confidence > AJ::kCalibrationMinConfidence);
+
+        std::cout << "  ✓ " << found << " frames, confidence " << confidence << "\n";
+    }
+
+    static void test_detect_silence() {
+        std::cout << "\nTest: Silence or noise alone isn't taken for the burst\n";
+
+        const std::vector<float> probe = AJ::io::device::calibrationProbe(512);
+
+        std::vector<float> silence(8192, 0.0f);
+        float confidence = 1.0f;
+        AJ::io::device::detectDelay(silence.data(), silence.size(), probe.data(), probe.size(), confidence);
+        assert(confidence == 0.0f);
+
+        std::vector<float> noise(8192);
+        uint32_t state = 99;
+        for (float &sample : noise) {
+            state = state * 1103515245u + 12345u;
+            sample = static_cast<float>(state >> 16) / 32768.0f - 1.0f;
+        }
+        AJ::io::device::detectDelay(noise.data(), noise.size(), probe.data(), probe.size(), confidence);
+        assert(confidence < AJ::kCalibrationMinConfidence);
+
+        std::cout << "  ✓ Confidence " << confidence << " on noise\n";
+    }
+};
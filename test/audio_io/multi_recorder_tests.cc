@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <string>
+
+#include "audio_io/multi_recorder.h"
+#include "core/error_handler.h"
+
+class MultiRecorderTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Multi Recorder Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_tracks_from_channels();
+        test_invalid_tracks();
+
+        std::cout << "All Multi Recorder Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::io::record::InitMultiRecordInfo info() {
+        AJ::io::record::InitMultiRecordInfo info;
+        info.mSessionDirectory = std::filesystem::temp_directory_path().string();
+        info.mFramesPerBuffer = 256;
+        return info;
+    }
+
+    /// no audio device involved: the tracks, queues and shared pools are set up at construction.
+    static void test_tracks_from_channels() {
+        std::cout << "\nTest: 24 mono tracks of one interface and a stereo pair of another\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::io::record::InitMultiRecordInfo init = info();
+
+        AJ::io::record::DeviceStreamSpec interface;
+        interface.mChannels = 24;
+        init.mStreams.push_back(interface);
+
+        AJ::io::record::DeviceStreamSpec pair;
+        pair.mChannels = 4;
+        pair.mTracks.push_back(AJ::io::record::TrackSpec{ 2, 2, "room" });
+        init.mStreams.push_back(pair);
+
+        AJ::io::record::MultiRecorder recorder(init, handler);
+        assert(recorder.isValid() && !handler.hasErrors());
+        assert(recorder.streamCount() == 2 && recorder.trackCount() == 25);
+        assert(!recorder.isRecording() && !recorder.stop());
+
+        for (size_t t = 0; t < recorder.trackCount(); ++t) {
+            assert(recorder.stats(t).blocks == 0);
+        }
+
+        std::cout << "  ✓ " << recorder.trackCount() << " tracks on " << recorder.streamCount() << " streams\n";
+    }
+
+    static void test_invalid_tracks() {
+        std::cout << "\nTest: Tracks outside their device or wider than stereo are rejected\n";
+
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::io::record::InitMultiRecordInfo none = info();
+        assert(!AJ::io::record::MultiRecorder(none, handler).isValid());
+
+        AJ::io::record::InitMultiRecordInfo outside = info();
+        AJ::io::record::DeviceStreamSpec stream;
+        stream.mChannels = 2;
+        stream.mTracks.push_back(AJ::io::record::TrackSpec{ 1, 2, "" });
+        outside.mStreams.push_back(stream);
+        assert(!AJ::io::record::MultiRecorder(outside, handler).isValid());
+
+        AJ::io::record::InitMultiRecordInfo wide = info();
+        stream.mChannels = 8;
+        stream.mTracks = { AJ::io::record::TrackSpec{ 0, 3, "" } };
+        wide.mStreams.push_back(stream);
+        assert(!AJ::io::record::MultiRecorder(wide, handler).isValid());
+
+        const auto &errors = handler.errors();
+        assert(errors.size() == 3);
+        assert(errors[0].first == AJ::error::Error::InvalidConfiguration);
+        assert(errors[1].first == AJ::error::Error::InvalidChannelCount);
+        assert(errors[2].first == AJ::error::Error::InvalidChannelCount);
+
+        std::cout << "  ✓ Rejected before anything is opened\n";
+    }
+};
@@ -0,0 +1,199 @@
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "audio_io/play.h"
+#include "file_io/wav_file.h"
+#include "core/error_handler.h"
+
+class PlayerTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Player Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_audio_file_source();
+        test_compact_file_source();
+        test_render_underrun_and_end();
+        test_render_seek_flush();
+
+        std::cout << "All Player Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::shared_ptr<AJ::io::WAV_File> make_mono_file(size_t frames) {
+        auto wav = std::make_shared<AJ::io::WAV_File>();
+        wav->mInfo.channels = 1;
+        wav->mInfo.samplerate = 48000;
+        wav->mInfo.length = frames;
+
+        AJ::Float &samples = wav->pAudio->at(0);
+        samples.resize(frames);
+        for (size_t i = 0; i < frames; ++i) samples[i] = static_cast<float>(i);
+
+        return wav;
+    }
+
+    /// write frames numbered from `first` the way the read-ahead thread does.
+    static size_t produce(AJ::io::play::PlayData &data, size_t frames, float first) {
+        AJ::utils::RingRegion region = data.mRing.acquireWrite(frames);
+        size_t n = 0;
+
+        for (AJ::utils::RingSpan span : {region.first, region.second}) {
+            for (size_t i = 0; i < span.frames; ++i, ++n) {
+                span.data[2 * i] = first + n;
+                span.data[2 * i + 1] = -(first + n);
+            }
+        }
+
+        data.mRing.commitWrite(n);
+        return n;
+    }
+
+    static void test_audio_file_source() {
+        std::cout << "\nTest: AudioFileSource interleaves, seeks and ends\n";
+
+        AJ::io::play::AudioFileSource source(make_mono_file(1000), 2);
+        assert(source.samplerate() == 48000);
+        assert(source.length() == 1000);
+
+        std::vector<float> out(2 * 600);
+        assert(source.read(out.data(), 600) == 600);
+        assert(out[0] == 0.0f && out[1] == 0.0f);
+        assert(out[2 * 599] == 599.0f && out[2 * 599 + 1] == 599.0f);
+
+        assert(source.read(out.data(), 600) == 400);
+        assert(source.finished());
+        assert(source.read(out.data(), 600) == 0);
+
+        assert(source.seek(990));
+        assert(!source.finished());
+        assert(source.read(out.data(), 600) == 10);
+        assert(out[0] == 990.0f);
+
+        //* backwards: positions count from the last frame, the file isn't touched.
+        auto file = make_mono_file(1000);
+        AJ::io::play::AudioFileSource reversed(file, 2, true);
+        assert(reversed.reversed());
+        assert(reversed.read(out.data(), 600) == 600);
+        assert(out[0] == 999.0f && out[1] == 999.0f);
+        assert(out[2 * 599] == 400.0f && out[2 * 599 + 1] == 400.0f);
+        assert(reversed.read(out.data(), 600) == 400);
+        assert(out[2 * 399] == 0.0f && reversed.finished());
+
+        assert(reversed.seek(990));
+        assert(reversed.read(out.data(), 600) == 10);
+        assert(out[0] == 9.0f && out[2 * 9] == 0.0f);
+        assert(file->pAudio->at(0)[0] == 0.0f && file->pAudio->at(0)[999] == 999.0f);
+
+        std::cout << "  ✓ Mono file played on 2 channels, forwards and backwards\n";
+    }
+
+    static void test_compact_file_source() {
+        std::cout << "\nTest: AudioFileSource widens compact samples as it reads\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto file = make_mono_file(1000);
+        file->mInfo.channels = 2;
+        file->mInfo.length = 2000;
+        file->pAudio->at(1).resize(1000);
+        for (size_t i = 0; i < 1000; ++i) file->pAudio->at(1)[i] = -static_cast<float>(i);
+
+        //* 16-bit exact for small integers over 32768.
+        for (size_t ch = 0; ch < 2; ++ch) {
+            for (float &sample : file->pAudio->at(ch)) sample /= 32768.0f;
+        }
+        assert(file->setStorage(AJ::io::SampleStorage::Int16, handler));
+        assert(file->pAudio->at(0).empty());
+
+        AJ::io::play::AudioFileSource source(file, 2);
+        assert(source.length() == 1000);
+
+        std::vector<float> out(2 * 600);
+        assert(source.read(out.data(), 600) == 600);
+        assert(out[2 * 599] == 599.0f / 32768.0f && out[2 * 599 + 1] == -599.0f / 32768.0f);
+        assert(source.read(out.data(), 600) == 400 && source.finished());
+
+        AJ::io::play::AudioFileSource reversed(file, 2, true);
+        assert(reversed.read(out.data(), 10) == 10);
+        assert(out[0] == 999.0f / 32768.0f && out[2 * 9 + 1] == -990.0f / 32768.0f);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Int16 samples played without widening the file\n";
+    }
+
+    static void test_render_underrun_and_end() {
+        std::cout << "\nTest: Output callback counts underruns and ends with the source\n";
+
+        AJ::error::ConsoleErrorHandler errHandler;
+        AJ::io::play::PlayData data(1024, 2, errHandler);
+        assert(data.mRing.isValid());
+
+        std::vector<float> out(2 * 256, 1.0f);
+
+        // still buffering: silence, nothing counted.
+        produce(data, 100, 0.0f);
+        assert(data.render(out.data(), 256));
+        assert(out[0] == 0.0f && data.mUnderruns.load() == 0 && data.mPosition.load() == 0);
+
+        // playing with only 100 frames queued: one underrun of 156 frames.
+        data.mBuffering.store(false);
+        assert(data.render(out.data(), 256));
+        assert(out[2 * 99] == 99.0f && out[2 * 99 + 1] == -99.0f && out[2 * 100] == 0.0f);
+        assert(data.mUnderruns.load() == 1 && data.mUnderrunFrames.load() == 156);
+        assert(data.mPosition.load() == 100 && data.mFramesPlayed.load() == 100);
+
+        // paused: the ring is kept.
+        produce(data, 300, 100.0f);
+        data.mTransport.store(AJ::io::play::Transport::Paused);
+        assert(data.render(out.data(), 256));
+        assert(out[0] == 0.0f && data.mPosition.load() == 100);
+
+        // end of the source: the rest is played, then the callback reports the end.
+        data.mTransport.store(AJ::io::play::Transport::Playing);
+        data.mSourceDone.store(true);
+        assert(data.render(out.data(), 256));
+        assert(out[0] == 100.0f);
+        assert(data.render(out.data(), 256));
+        assert(out[2 * 43] == 399.0f && out[2 * 44] == 0.0f);
+        assert(data.mUnderruns.load() == 1);
+        assert(!data.render(out.data(), 256));
+        assert(data.mPosition.load() == 400);
+
+        std::cout << "  ✓ Underruns counted, end of source reported\n";
+    }
+
+    static void test_render_seek_flush() {
+        std::cout << "\nTest: Seek flushes the ring before the new frames\n";
+
+        AJ::error::ConsoleErrorHandler errHandler;
+        AJ::io::play::PlayData data(1024, 2, errHandler);
+        data.mBuffering.store(false);
+
+        std::vector<float> out(2 * 256, 1.0f);
+        produce(data, 1024, 0.0f);
+        assert(data.render(out.data(), 256));
+        assert(data.mPosition.load() == 256);
+
+        // read-ahead side of a seek to frame 5000.
+        data.mBuffering.store(true);
+        data.mFlushTarget.store(5000);
+        data.mFlushRequest.store(1);
+
+        assert(data.render(out.data(), 256));
+        assert(out[0] == 0.0f);
+        assert(data.mFlushed.load() == 1 && data.mSeeks.load() == 1);
+        assert(data.mPosition.load() == 5000);
+        assert(data.mRing.acquireRead(1024).frames() == 0);
+
+        // refilled from the new position.
+        produce(data, 512, 5000.0f);
+        data.mBuffering.store(false);
+        assert(data.render(out.data(), 256));
+        assert(out[0] == 5000.0f && data.mPosition.load() == 5256);
+        assert(data.mUnderruns.load() == 0);
+
+        std::cout << "  ✓ Old frames dropped, position moved\n";
+    }
+};
@@ -2,6 +2,9 @@
 #include <thread>
 #include <cassert>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <vector>
 
 #include "core/buffer_pool.h"
 #include "core/thread_pool.h"
@@ -9,6 +12,7 @@
 #include "core/engine_resources.h"
 #include "audio_io/audio_io_manager.h"
 #include "core/event_handler.h"   // IEventHandler + ConsoleRecordHandler
+#include "dsp/gain.h"
 
 class AudioIOManagerRecordTests {
 public:
@@ -16,6 +20,10 @@ public:
         std::cout << "\nRunning AudioIOManager Record Tests\n";
         std::cout << "---------------------------------------------\n";
 
+        test_overflow_policy();
+        test_writer_lag();
+        test_monitor();
+        test_preroll();
         // test_invalid_record();
         test_valid_record();
 
@@ -23,6 +31,211 @@ public:
     }
 
 private:
+    /// callback buffer selection when the pool runs dry, no audio device involved.
+    static void test_overflow_policy() {
+        std::cout << "\nTest: Record overflow policies\n";
+
+        using AJ::io::record::OverflowPolicy;
+        AJ::error::ConsoleErrorHandler errHandler;
+
+        for (OverflowPolicy policy : {OverflowPolicy::Reserve, OverflowPolicy::DropOldest, OverflowPolicy::DropNewest}) {
+            auto pool = std::make_shared<AJ::utils::BufferPool>(errHandler, 6, 64, 2);
+            auto stopFlag = std::make_shared<AJ::LFControlFlag>();
+
+            AJ::io::record::AudioData data(pool, nullptr, stopFlag, errHandler);
+            data.mPolicy = policy;
+            data.mReserveSize = 2;
+            data.fillReserve();
+            assert(data.mReserveCount == 2);
+
+            std::vector<AJ::utils::Buffer*> taken;
+            while (pool->currentSize() > 0) {
+                taken.push_back(data.acquire());
+                assert(taken.back());
+            }
+
+            // pool is empty now, only the reserve is left.
+            const size_t fromReserve = policy == OverflowPolicy::DropNewest ? 0 : 2;
+            for (size_t i = 0; i < fromReserve; ++i) {
+                taken.push_back(data.acquire());
+                assert(taken.back());
+            }
+            assert(data.acquire() == nullptr);
+
+            const AJ::io::file_streamer::StreamStats stats = data.pCounters->snapshot();
+            assert(stats.poolExhausted == fromReserve + 1);
+            assert(stats.reserveUsed == fromReserve);
+            assert(data.pCounters->discardRequests.load() == (policy == OverflowPolicy::DropOldest ? 2u : 0u));
+
+            // buffers come back: the next acquire tops the reserve up again.
+            for (AJ::utils::Buffer* buffer : taken) pool->push(buffer, errHandler);
+            AJ::utils::Buffer* buffer = data.acquire();
+            assert(buffer);
+            assert(data.mReserveCount == (fromReserve == 2 ? 1u : 2u));
+
+            pool->push(buffer, errHandler);
+            data.releaseReserve();
+        }
+
+        std::cout << "  ✓ Reserve, drop oldest and drop newest behave as documented\n";
+    }
+
+    /// lag and queue depth as the writer reports them, no audio device involved.
+    static void test_writer_lag() {
+        std::cout << "\nTest: Writer lag and queue depth\n";
+
+        AJ::io::file_streamer::StreamCounters counters;
+        counters.blocks.store(10);
+        counters.written.store(6);
+        counters.discarded.store(1);
+        counters.maxQueueDepth.store(3);
+
+        AJ::io::file_streamer::StreamStats stats = counters.snapshot();
+        assert(stats.lag() == 3);
+        assert(stats.maxQueueDepth == 3);
+
+        // the snapshot isn't atomic as a whole: a writer ahead of the count never underflows.
+        counters.written.store(12);
+        assert(counters.snapshot().lag() == 0);
+
+        counters.reset();
+        stats = counters.snapshot();
+        assert(stats.written == 0 && stats.maxQueueDepth == 0 && stats.lag() == 0);
+
+        std::cout << "  ✓ Lag counts blocks not written yet\n";
+    }
+
+    /// monitor path of a duplex callback, no audio device involved.
+    static void test_monitor() {
+        std::cout << "\nTest: Monitor chain on the output, dry on failure\n";
+
+        AJ::error::CollectingErrorHandler errHandler;
+        auto pool = std::make_shared<AJ::utils::BufferPool>(errHandler, 4, 64, 2);
+        auto stopFlag = std::make_shared<AJ::LFControlFlag>();
+        auto metrics = std::make_shared<AJ::utils::MetricsRegistry>();
+
+        AJ::io::record::AudioData data(pool, nullptr, stopFlag, errHandler);
+        data.mChannels = 2;
+        data.pMetrics = metrics;
+
+        AJ::dsp::gain::Params params{ 0, 1 << 20, 0.5f };
+        auto gain = std::make_shared<AJ::dsp::gain::Gain>();
+        assert(gain->setParams(AJ::dsp::gain::GainParams::create(params, errHandler), errHandler));
+        auto chain = std::make_shared<AJ::dsp::EffectChain>();
+        assert(chain->add(gain, errHandler));
+
+        const size_t frames = 32;
+        std::vector<float> input(2 * frames, 0.8f);
+        std::vector<float> output(2 * frames, 1.0f);
+
+        // no chain: dry, and silence on an input underflow.
+        data.monitor(output.data(), input.data(), frames);
+        assert(output == input);
+        data.monitor(output.data(), nullptr, frames);
+        assert(output == std::vector<float>(2 * frames, 0.0f));
+
+        data.pMonitorChain = chain;
+        data.pMonitorState = chain->createState(2, errHandler);
+        data.monitor(output.data(), input.data(), frames);
+        for (float sample : output) assert(sample == 0.4f);
+        assert(input[0] == 0.8f);   // the recorded block is untouched
+        assert(metrics->snapshot()[AJ::utils::Latency::MonitorChain].count == 1);
+
+        // a state of the wrong channel count: the chain fails, the block plays dry from then on.
+        data.pMonitorState = chain->createState(1, errHandler);
+        data.monitor(output.data(), input.data(), frames);
+        assert(output == input && data.mMonitorBypassed);
+        assert(data.mMonitorErrors.count() == 1);
+        assert(metrics->snapshot()[AJ::utils::Counter::MonitorFailures] == 1);
+
+        data.monitor(output.data(), input.data(), frames);
+        assert(data.mMonitorErrors.count() == 1 && !errHandler.hasErrors());
+
+        std::cout << "  ✓ Processed, dry and bypassed blocks\n";
+    }
+
+    /// pre-roll kept by the writer while armed and the reserved writer, no audio device involved.
+    static void test_preroll() {
+        std::cout << "\nTest: Pre-roll held before the file opens\n";
+
+        AJ::error::CollectingErrorHandler errHandler;
+        const size_t frames = 64;
+        const std::string sessionDir = std::filesystem::temp_directory_path().string() + "/aj_preroll";
+        std::filesystem::create_directories(sessionDir);
+
+        auto pool = std::make_shared<AJ::utils::BufferPool>(errHandler, 16, frames, 1);
+        auto queue = std::make_shared<AJ::utils::Queue>(true, 16, frames, 1, errHandler);
+        auto counters = std::make_shared<AJ::io::file_streamer::StreamCounters>();
+        const size_t available = pool->currentSize();
+
+        AJ::io::file_streamer::FileStreamer streamer(queue, pool, std::make_shared<AJ::LFControlFlag>(),
+            AJ::FileStreamingTypes::recording, sessionDir);
+        AJ::io::file_streamer::WriteOptions options;
+        options.coalesce = true;
+        streamer.setCounters(counters);
+        streamer.setWriteOptions(options);
+        streamer.setFileName("preroll.wav");
+
+        AJ::AudioWriteInfo info;
+        info.channels = 1;
+        info.samplerate = 48000;
+        assert(streamer.setWriteInfo(info, errHandler));
+
+        // blocks 0..9 captured while armed, only the newest 3 are kept.
+        auto capture = [&](size_t block) {
+            AJ::utils::Buffer *buffer = pool->tryPop();
+            assert(buffer);
+            for (size_t i = 0; i < frames; ++i) buffer->data[i] = static_cast<float>(block);
+            buffer->frames = frames;
+            counters->blocks.fetch_add(1);
+            assert(queue->push(buffer));
+        };
+        for (size_t block = 0; block < 10; ++block) {
+            capture(block);
+            streamer.holdPending(3, errHandler);
+        }
+        assert(counters->snapshot().blocks == 3 && pool->currentSize() == available - 3);
+
+        // record pressed: the held blocks start the file, then the queue.
+        capture(10);
+        assert(streamer.beginWrite(errHandler));
+        assert(streamer.endWrite(errHandler));
+        assert(counters->snapshot().written == 4 && pool->currentSize() == available);
+
+        std::ifstream file(streamer.writePath(), std::ios::binary);
+        file.seekg(AJ::kStreamWriteAlignment);
+        std::vector<float> samples(4 * frames);
+        file.read(reinterpret_cast<char*>(samples.data()), samples.size() * sizeof(float));
+        for (size_t block = 0; block < 4; ++block) assert(samples[block * frames] == static_cast<float>(block + 7));
+        file.close();
+        std::filesystem::remove(streamer.writePath());
+
+        // disarmed: held and queued buffers go back unwritten.
+        capture(0);
+        streamer.holdPending(3, errHandler);
+        capture(1);
+        assert(streamer.discardPending(errHandler) == 2 && pool->currentSize() == available);
+
+        // the recorder's writer is parked from construction to destruction.
+        AJ::io::record::InitRecordInfo recordInfo;
+        recordInfo.mSamplerate = 48000;
+        recordInfo.mChannels = 1;
+        recordInfo.mFramesPerBuffer = frames;
+        recordInfo.mSessionDirectory = sessionDir;
+        recordInfo.pStopFlag = std::make_shared<AJ::LFControlFlag>();
+        recordInfo.pBufferPool = pool;
+        recordInfo.pQueue = queue;
+        {
+            AJ::io::record::Recorder recorder(recordInfo, errHandler);
+            assert(recorder.setPreroll(4 * frames / 48000.0, errHandler) && recorder.prerollBuffers() == 4);
+            assert(!recorder.setPreroll(1.0, errHandler));
+            assert(errHandler.errors().back().first == AJ::error::Error::InvalidBufferSize);
+            assert(!recorder.isArmed());
+        }
+
+        std::cout << "  ✓ Newest blocks kept, written first, discarded on disarm\n";
+    }
+
     static void test_invalid_record() {
         std::cout << "\nTest: Invalid Record Setup\n";
 
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "core/aj_audio_engine.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "dsp/effect.h"
+#include "dsp/gain.h"
+#include "dsp/echo.h"
+#include "dsp/dynamics/dynamics.h"
+
+class AudioViewTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Audio View Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_packed_in_place();
+        test_strided_view();
+        test_latency_goes_through_process();
+        test_invalid_views();
+
+        std::cout << "All Audio View Tests Completed Successfully.\n";
+    }
+
+private:
+    /// @brief Block effect that remembers the memory it was given.
+    class Probe : public AJ::dsp::Effect {
+    public:
+        const float *seen = nullptr;
+
+        bool process(AJ::Float &buffer, AJ::error::IErrorHandler &handler) override {
+            return false;
+        }
+
+        bool setParams(std::shared_ptr<AJ::dsp::EffectParams> params, AJ::error::IErrorHandler &handler) override {
+            return true;
+        }
+
+        bool supportsBlockProcessing() const override {
+            return true;
+        }
+
+        bool processBlock(float *data, size_t frames, uint8_t channels, AJ::dsp::EffectState &state,
+            AJ::error::IErrorHandler &handler) override {
+            seen = data;
+            for (size_t i = 0; i < frames * channels; ++i) data[i] *= 2.0f;
+            return true;
+        }
+    };
+
+    static AJ::AudioBuffer make_planar(size_t frames) {
+        AJ::AudioBuffer audio;
+        for (size_t ch = 0; ch < 2; ++ch) {
+            audio[ch].resize(frames);
+            for (size_t i = 0; i < frames; ++i) audio[ch][i] = 0.5f * std::sin(0.01f * i * (ch + 1));
+        }
+        return audio;
+    }
+
+    //* interleaved in `stride` floats per frame, the floats past the 2 channels set to `pad`.
+    static std::vector<float> interleave(const AJ::AudioBuffer &audio, size_t frames, size_t stride, float pad) {
+        std::vector<float> out(frames * stride, pad);
+        for (size_t i = 0; i < frames; ++i) {
+            out[i * stride] = audio[0][i];
+            out[i * stride + 1] = audio[1][i];
+        }
+        return out;
+    }
+
+    static float max_error(const std::vector<float> &view, size_t stride, const AJ::AudioBuffer &audio) {
+        float error = 0.0f;
+        for (size_t i = 0; i < audio[0].size(); ++i) {
+            for (size_t ch = 0; ch < 2; ++ch) error = std::max(error, std::fabs(view[i * stride + ch] - audio[ch][i]));
+        }
+        return error;
+    }
+
+    static void test_packed_in_place() {
+        std::cout << "\nTest: A packed view is processed in the caller's memory\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+
+        const size_t frames = 20000;
+        AJ::AudioBuffer reference = make_planar(frames);
+        std::vector<float> samples = interleave(reference, frames, 2, 0.0f);
+        const AJ::AudioView view{ samples.data(), frames, 2, 2 };
+        assert(view.packed() && &view.at(1, 3) == &samples[7]);
+
+        AJ::dsp::gain::Params gain{ 100, 15000, 0.5f };
+        auto params = AJ::dsp::gain::GainParams::create(gain, handler);
+        assert(engine.applyEffect(view, AJ::Effect::gain, params, handler));
+        assert(engine.applyEffect(reference, 2, AJ::Effect::gain, params, handler));
+        assert(max_error(samples, 2, reference) == 0.0f);
+
+        //* no copy on the way.
+        Probe probe;
+        assert(probe.processView(view, handler));
+        assert(probe.seen == samples.data() && samples[2 * 200] == 2.0f * reference[0][200]);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Gain matches the planar path, the effect saw the caller's pointer\n";
+    }
+
+    static void test_strided_view() {
+        std::cout << "\nTest: A view leaving interleaved channels out only touches its own\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+
+        const size_t frames = 48000;
+        AJ::AudioBuffer reference = make_planar(frames);
+        std::vector<float> samples = interleave(reference, frames, 3, 7.0f);
+        const AJ::AudioView view{ samples.data(), frames, 2, 3 };
+        assert(!view.packed());
+
+        AJ::dsp::echo::Params echo{ 100, static_cast<AJ::sample_pos>(frames) - 100, 0.6f, 0.05f, 48000 };
+        auto params = AJ::dsp::echo::EchoParams::create(echo, handler);
+        assert(engine.applyEffect(view, AJ::Effect::echo, params, handler));
+        assert(engine.applyEffect(reference, 2, AJ::Effect::echo, params, handler));
+        assert(max_error(samples, 3, reference) == 0.0f);
+
+        for (size_t i = 0; i < frames; ++i) assert(samples[i * 3 + 2] == 7.0f);
+
+        //* packed, the echo streams in place and matches too.
+        AJ::AudioBuffer streamed = make_planar(frames);
+        std::vector<float> packed = interleave(streamed, frames, 2, 0.0f);
+        assert(engine.applyEffect(AJ::AudioView{ packed.data(), frames, 2, 2 }, AJ::Effect::echo, params, handler));
+        assert(max_error(packed, 2, reference) < 1e-5f);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Echo on 2 of 3 interleaved channels, the third left alone\n";
+    }
+
+    static void test_latency_goes_through_process() {
+        std::cout << "\nTest: Effects whose stream lags are applied like on a buffer\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+
+        const size_t frames = 20000;
+        AJ::AudioBuffer reference = make_planar(frames);
+        std::vector<float> samples = interleave(reference, frames, 2, 0.0f);
+
+        AJ::dsp::dynamics::Params limiter{ 0, static_cast<AJ::sample_pos>(frames) - 1, 48000, 0.0f, 1.0f, 0.0f,
+            1.0f, 50.0f, 0.0f, -6.0f, 5.0f };
+        auto params = AJ::dsp::dynamics::DynamicsParams::create(limiter, handler);
+        assert(params && params->Latency() > 0);
+
+        AJ::dsp::dynamics::Dynamics dynamics;
+        assert(!dynamics.blockMatchesProcess());
+
+        assert(engine.applyEffect(AJ::AudioView{ samples.data(), frames, 2, 2 }, AJ::Effect::dynamics, params, handler));
+        assert(engine.applyEffect(reference, 2, AJ::Effect::dynamics, params, handler));
+        assert(max_error(samples, 2, reference) == 0.0f);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ The limiter isn't delayed by its lookahead\n";
+    }
+
+    static void test_invalid_views() {
+        std::cout << "\nTest: Invalid views and ranges are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+
+        std::vector<float> samples(200, 0.25f);
+        AJ::dsp::gain::Params gain{ 0, 99, 0.5f };
+        auto params = AJ::dsp::gain::GainParams::create(gain, handler);
+
+        assert(!engine.applyEffect(AJ::AudioView{ nullptr, 100, 2, 2 }, AJ::Effect::gain, params, handler));
+        assert(handler.errors().back().first == AJ::error::Error::NullBufferPtr);
+
+        assert(!engine.applyEffect(AJ::AudioView{ samples.data(), 100, 2, 1 }, AJ::Effect::gain, params, handler));
+        assert(handler.errors().back().first == AJ::error::Error::InvalidChannelCount);
+
+        //* 99 is past a view of 50 frames.
+        assert(!engine.applyEffect(AJ::AudioView{ samples.data(), 50, 2, 2 }, AJ::Effect::gain, params, handler));
+        assert(handler.errors().back().first == AJ::error::Error::InvalidEffectParameters);
+
+        for (float sample : samples) assert(sample == 0.25f);
+        assert(handler.errors().size() == 3);
+        std::cout << "  ✓ " << handler.errors().size() << " errors reported, the samples untouched\n";
+    }
+};
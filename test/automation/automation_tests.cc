@@ -0,0 +1,211 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "dsp/automation.h"
+#include "dsp/gain.h"
+#include "dsp/fade.h"
+#include "dsp/echo.h"
+#include "dsp/reverb/reverb.h"
+#include "core/error_handler.h"
+
+class AutomationTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Automation Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_segment_shapes();
+        test_gain_lane_matches_fade();
+        test_gain_lane_streaming();
+        test_constant_lanes();
+
+        std::cout << "All Automation Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::Float make_signal(size_t frames) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = 0.4f * std::sin(0.003f * i) + 0.2f * std::sin(0.05f * i);
+        }
+        return signal;
+    }
+
+    static void test_segment_shapes() {
+        std::cout << "\nTest: Hold, linear, exponential and S-curve segments\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::dsp::Automation lane;
+        assert(lane.add({ 1000, 0.5f, AJ::dsp::CurveShape::Linear }, handler));
+        assert(lane.add({ 100, 1.0f, AJ::dsp::CurveShape::Hold }, handler));
+        assert(lane.add({ 2000, 0.1f, AJ::dsp::CurveShape::Exponential }, handler));
+        assert(lane.add({ 3000, 1.0f, AJ::dsp::CurveShape::SCurve }, handler));
+        assert(lane.add({ 4000, 0.0f }, handler));
+        assert(!lane.add({ -1, 0.0f }, handler));
+        assert(lane.size() == 5 && lane.points().front().mFrame == 100);
+
+        // before the first and after the last point the lane holds.
+        assert(lane.valueAt(0) == 1.0f && lane.valueAt(999) == 1.0f);
+        assert(lane.valueAt(1000) == 0.5f && lane.valueAt(10000) == 0.0f);
+
+        assert(std::fabs(lane.valueAt(1500) - 0.3f) < 1e-6f);
+        // curves are exact every kAutomationRampFrames frames, 512 = 8 * 64 frames into the segment.
+        // exponential: 0.1 * 10^t.
+        assert(std::fabs(lane.valueAt(2512) - 0.1f * std::pow(10.0f, 0.512f)) < 1e-5f);
+        // S-curve: 3t^2 - 2t^3 down from 1, flat near the ends.
+        const float t = 0.512f;
+        assert(std::fabs(lane.valueAt(3512) - (1.0f - t * t * (3.0f - 2.0f * t))) < 1e-5f);
+        assert(lane.valueAt(3010) > 0.995f);
+
+        // render() gives valueAt() of every frame.
+        std::vector<float> values(5000);
+        lane.render(0, values.size(), values.data());
+        for (size_t i = 0; i < values.size(); i += 7) {
+            assert(std::fabs(values[i] - lane.valueAt(i)) < 1e-6f);
+        }
+
+        // between the exact points a curved segment is off by less than 0.05 dB.
+        for (size_t i = 2000; i < 3000; ++i) {
+            const float exact = 0.1f * std::pow(10.0f, (i - 2000) / 1000.0f);
+            assert(std::fabs(values[i] - exact) < 5e-3f * exact);
+        }
+        assert(handler.errors().size() == 1);
+
+        std::cout << "  ✓ Shapes, holds and render match\n";
+    }
+
+    static void test_gain_lane_matches_fade() {
+        std::cout << "\nTest: A linear gain lane gives the same ramp as Fade\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 44100;
+        AJ::Float faded = make_signal(frames);
+        AJ::Float ridden = faded;
+
+        AJ::dsp::fade::Params fp{ 1000, 40999, 1.0f, 0.25f, AJ::dsp::fade::FadeMode::In };
+        AJ::dsp::fade::Fade fade;
+        assert(fade.setParams(AJ::dsp::fade::FadeParams::create(fp, handler), handler));
+        assert(fade.process(faded, handler));
+
+        // the fade ramps from 0.25 at 1000 to 1.0 at 41000 (exclusive).
+        auto lane = std::make_shared<AJ::dsp::Automation>();
+        assert(lane->add({ 1000, 0.25f }, handler));
+        assert(lane->add({ 41000, 1.0f }, handler));
+
+        AJ::dsp::gain::Params gp{ 1000, 40999, 1.0f };
+        AJ::dsp::gain::Gain gain;
+        assert(gain.setParams(AJ::dsp::gain::GainParams::create(gp, handler), handler));
+        gain.setGainAutomation(lane);
+        assert(gain.process(ridden, handler));
+
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(ridden[i] - faded[i]) < 1e-6f);
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Same samples as the fade\n";
+    }
+
+    static void test_gain_lane_streaming() {
+        std::cout << "\nTest: Streamed interleaved blocks follow the lane of the buffer\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 20000;
+        auto lane = std::make_shared<AJ::dsp::Automation>();
+        assert(lane->add({ 0, 1.0f, AJ::dsp::CurveShape::SCurve }, handler));
+        assert(lane->add({ 5000, 0.2f, AJ::dsp::CurveShape::Hold }, handler));
+        assert(lane->add({ 9000, 0.2f, AJ::dsp::CurveShape::Exponential }, handler));
+        assert(lane->add({ 15000, 1.5f }, handler));
+
+        AJ::dsp::gain::Params gp{ 100, static_cast<AJ::sample_pos>(frames) - 101, 1.0f };
+        AJ::dsp::gain::Gain gain;
+        assert(gain.setParams(AJ::dsp::gain::GainParams::create(gp, handler), handler));
+        gain.setGainAutomation(lane);
+
+        AJ::Float mono = make_signal(frames);
+        std::vector<float> stereo(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            stereo[2 * i] = stereo[2 * i + 1] = mono[i];
+        }
+
+        assert(gain.process(mono, handler));
+
+        auto state = gain.createState(2, handler);
+        for (size_t done = 0; done < frames; done += 999) {
+            const size_t n = std::min<size_t>(999, frames - done);
+            assert(gain.processBlock(stereo.data() + done * 2, n, 2, *state, handler));
+        }
+
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(stereo[2 * i] - mono[i]) < 1e-6f && stereo[2 * i] == stereo[2 * i + 1]);
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Blocks match the whole buffer\n";
+    }
+
+    static void test_constant_lanes() {
+        std::cout << "\nTest: Constant decay / mix lanes give the constant parameter result\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 5 * 44100;
+        const AJ::Float signal = make_signal(frames);
+
+        // echo, decay 0.5.
+        AJ::dsp::echo::Params ep{ 0, static_cast<AJ::sample_pos>(frames) - 1, 0.5f, 0.1f, 44100 };
+        AJ::dsp::echo::Echo echo;
+        assert(echo.setParams(AJ::dsp::echo::EchoParams::create(ep, handler), handler));
+
+        AJ::Float expected = signal;
+        assert(echo.process(expected, handler));
+
+        auto decay = std::make_shared<AJ::dsp::Automation>();
+        assert(decay->add({ 0, 0.5f }, handler));
+        echo.setDecayAutomation(decay);
+
+        AJ::Float automated = signal;
+        assert(echo.process(automated, handler));
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(automated[i] - expected[i]) < 1e-6f);
+        }
+
+        // reverb, the default mixes.
+        AJ::dsp::reverb::Params rp{ AJ::REVERB_DELAY, AJ::REVERB_WET_MIX, AJ::REVERB_DRY_MIX, 44100,
+            AJ::REVERB_GAIN, 0, frames - 1 };
+        AJ::dsp::reverb::Reverb reverb;
+        assert(reverb.setParams(AJ::dsp::reverb::ReverbParams::create(rp, handler), handler));
+
+        expected = signal;
+        assert(reverb.process(expected, handler));
+
+        auto wet = std::make_shared<AJ::dsp::Automation>();
+        auto dry = std::make_shared<AJ::dsp::Automation>();
+        assert(wet->add({ 0, AJ::REVERB_WET_MIX }, handler));
+        assert(dry->add({ 0, AJ::REVERB_DRY_MIX }, handler));
+        reverb.setMixAutomation(wet, dry);
+
+        automated = signal;
+        assert(reverb.process(automated, handler));
+        assert(automated == expected);
+
+        // a wet ride changes the mix from its frame on only.
+        assert(wet->points().size() == 1);
+        auto ride = std::make_shared<AJ::dsp::Automation>();
+        assert(ride->add({ 44100, AJ::REVERB_WET_MIX, AJ::dsp::CurveShape::Hold }, handler));
+        assert(ride->add({ 2 * 44100, 0.0f }, handler));
+        reverb.setMixAutomation(ride);
+
+        automated = signal;
+        assert(reverb.process(automated, handler));
+        for (size_t i = 0; i < 2 * 44100; ++i) {
+            assert(automated[i] == expected[i]);
+        }
+        assert(automated[3 * 44100] == std::clamp(AJ::REVERB_DRY_MIX * signal[3 * 44100], -1.0f, 1.0f));
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Echo and reverb unchanged by constant lanes, ride applied\n";
+    }
+};
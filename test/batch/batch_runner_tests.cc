@@ -0,0 +1,224 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sndfile.h>
+
+#include "core/batch_runner.h"
+#include "core/aj_audio_engine.h"
+#include "core/engine_resources.h"
+#include "core/error_handler.h"
+
+class BatchRunnerTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Batch Runner Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_batch_in_order();
+        test_memory_budget();
+        test_failed_job();
+        test_specs_and_manifest();
+
+        std::cout << "All Batch Runner Tests Completed Successfully.\n";
+    }
+
+private:
+    using BatchRunner = AJ::batch::BatchRunner;
+    using EffectSpec = AJ::batch::EffectSpec;
+    using JobResult = AJ::batch::JobResult;
+
+    static std::filesystem::path temp_dir(const std::string &name) {
+        const auto dir = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir / "out");
+        return dir;
+    }
+
+    //* stereo float WAV of `frames` frames, frame i of file `seed` holds (s, -s) with s = sin((i + seed) / 50).
+    static void write_wav(const std::string &path, size_t frames, size_t seed) {
+        SF_INFO info{};
+        info.channels = 2;
+        info.samplerate = 44100;
+        info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+
+        SNDFILE *file = sf_open(path.c_str(), SFM_WRITE, &info);
+        assert(file);
+        std::vector<float> samples(2 * frames);
+        for (size_t i = 0; i < frames; ++i) {
+            samples[2 * i] = 0.5f * std::sin((i + seed) / 50.0f);
+            samples[2 * i + 1] = -samples[2 * i];
+        }
+        assert(sf_writef_float(file, samples.data(), frames) == static_cast<sf_count_t>(frames));
+        sf_close(file);
+    }
+
+    static std::vector<float> read_wav(const std::string &path) {
+        SF_INFO info{};
+        SNDFILE *file = sf_open(path.c_str(), SFM_READ, &info);
+        assert(file && info.channels == 2);
+        std::vector<float> samples(2 * info.frames);
+        assert(sf_readf_float(file, samples.data(), info.frames) == info.frames);
+        sf_close(file);
+        return samples;
+    }
+
+    static std::shared_ptr<AJ::AJ_Engine> make_engine(AJ::error::IErrorHandler &handler) {
+        auto engine = AJ::AJ_Engine::create();
+        engine->setEngineResources(std::make_shared<AJ::EngineResources>(handler));
+        engine->setUndoSupportEnabled(false);
+        return engine;
+    }
+
+    static void test_batch_in_order() {
+        std::cout << "\nTest: A directory is processed concurrently, results come in order\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const auto dir = temp_dir("aj_batch_order");
+        const size_t files = 12;
+        for (size_t f = 0; f < files; ++f) {
+            //* the first files are the longest: they complete last.
+            write_wav((dir / ("take_" + std::to_string(10 + f) + ".wav")).string(), 40000 - 3000 * f, f);
+        }
+
+        auto engine = make_engine(handler);
+        EffectSpec spec;
+        assert(EffectSpec::parse("gain=0.5", spec, handler));
+
+        const auto jobs = BatchRunner::fromDirectory(dir.string(), (dir / "out").string(), handler);
+        assert(jobs.size() == files);
+
+        std::vector<size_t> order;
+        BatchRunner runner(*engine);
+        assert(runner.run(jobs, spec, [&](const JobResult &result) {
+            assert(result.success && result.errors.empty());
+            assert(result.load >= 0.0 && result.process >= 0.0 && result.save >= 0.0);
+            order.push_back(result.index);
+        }, handler));
+        assert(handler.errors().empty());
+
+        for (size_t f = 0; f < files; ++f) {
+            assert(order[f] == f);
+            const std::vector<float> out = read_wav(jobs[f].output);
+            assert(out.size() == 2 * (40000 - 3000 * f));
+            for (size_t i = 0; i < out.size() / 2; ++i) {
+                assert(std::fabs(out[2 * i] - 0.25f * std::sin((i + f) / 50.0f)) < 1e-6f);
+            }
+        }
+
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ " << files << " files, reported in order\n";
+    }
+
+    static void test_memory_budget() {
+        std::cout << "\nTest: The memory budget bounds the files decoded at once\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const auto dir = temp_dir("aj_batch_budget");
+        for (size_t f = 0; f < 8; ++f) {
+            write_wav((dir / ("take_" + std::to_string(f) + ".wav")).string(), 20000, f);
+        }
+
+        auto engine = make_engine(handler);
+        EffectSpec spec;
+        assert(EffectSpec::parse("fadein", spec, handler));
+        const auto jobs = BatchRunner::fromDirectory(dir.string(), (dir / "out").string(), handler);
+        const size_t bytes = 2 * 20000 * sizeof(float);
+
+        //* room for two files at a time.
+        AJ::batch::BatchOptions options;
+        options.memoryBudget = 2 * bytes + bytes / 2;
+        BatchRunner two(*engine, options);
+        assert(two.run(jobs, spec, nullptr, handler));
+        assert(two.peakBytes() >= bytes && two.peakBytes() <= 2 * bytes);
+
+        //* a budget smaller than any file: one at a time, each still runs.
+        options.memoryBudget = 1;
+        BatchRunner one(*engine, options);
+        size_t done = 0;
+        assert(one.run(jobs, spec, [&](const JobResult &result) { done += result.success ? 1 : 0; }, handler));
+        assert(one.peakBytes() == bytes && done == jobs.size());
+        assert(handler.errors().empty());
+
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ At most " << two.peakBytes() << " bytes for a budget of " << 2 * bytes + bytes / 2 << "\n";
+    }
+
+    static void test_failed_job() {
+        std::cout << "\nTest: A failing file is reported in its place, the others are processed\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const auto dir = temp_dir("aj_batch_failed");
+        write_wav((dir / "a.wav").string(), 5000, 0);
+        write_wav((dir / "c.wav").string(), 5000, 1);
+
+        const std::string manifest = (dir / "jobs.txt").string();
+        std::ofstream(manifest) << (dir / "a.wav").string() << "\n"
+                                << (dir / "missing.wav").string() << "\n"
+                                << (dir / "c.wav").string() << "\tc_out.wav\n";
+
+        auto engine = make_engine(handler);
+        EffectSpec spec;
+        assert(EffectSpec::parse("normalize=0.9", spec, handler));
+        const auto jobs = BatchRunner::fromManifest(manifest, (dir / "out").string(), handler);
+        assert(jobs.size() == 3 && jobs[2].output == (dir / "out" / "c_out.wav").string());
+
+        std::vector<bool> succeeded;
+        BatchRunner runner(*engine);
+        assert(!runner.run(jobs, spec, [&](const JobResult &result) {
+            succeeded.push_back(result.success);
+            assert(result.success == result.errors.empty());
+        }, handler));
+        assert((succeeded == std::vector<bool>{ true, false, true }));
+        assert(!handler.errors().empty());
+        assert(std::filesystem::exists(jobs[2].output));
+
+        //* the engine's undo history isn't thread-safe.
+        handler.clear();
+        engine->setUndoSupportEnabled(true);
+        assert(!runner.run(jobs, spec, nullptr, handler));
+        assert(handler.errors().size() == 1);
+
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ Failure reported, 2 files processed\n";
+    }
+
+    static void test_specs_and_manifest() {
+        std::cout << "\nTest: Effect specs and manifests are parsed\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        EffectSpec spec;
+        assert(EffectSpec::parse("lufs", spec, handler) && spec.lufs && spec.value == -23.0f);
+        assert(EffectSpec::parse("lufs=-14", spec, handler) && spec.value == -14.0f);
+        assert(EffectSpec::parse("reverse", spec, handler) && spec.effect == AJ::Effect::reverse);
+        assert(EffectSpec::parse("gate=-45", spec, handler) && spec.effect == AJ::Effect::gate && spec.value == -45.0f);
+        assert(EffectSpec::parse("trim", spec, handler) && spec.trim && spec.value == AJ::kTrimThresholdDb);
+        assert(EffectSpec::parse("reverb=0.4", spec, handler) && spec.effect == AJ::Effect::reverb && !spec.trim);
+        assert(handler.errors().empty());
+
+        assert(!EffectSpec::parse("chorus", spec, handler));
+        assert(!EffectSpec::parse("gain=loud", spec, handler));
+        assert(!EffectSpec::parse("gain=1.5x", spec, handler));
+        assert(!EffectSpec::parse("fadein=2", spec, handler));
+        assert(handler.errors().size() == 4 && spec.effect == AJ::Effect::reverb);
+
+        const auto dir = temp_dir("aj_batch_manifest");
+        const std::string manifest = (dir / "jobs.txt").string();
+        std::ofstream(manifest) << "# field recordings\n\n/data/one.wav\r\n/data/two.mp3\t/exports/two.mp3\n";
+
+        const auto jobs = BatchRunner::fromManifest(manifest, "/out", handler);
+        assert(jobs.size() == 2);
+        assert(jobs[0].input == "/data/one.wav" && jobs[0].output == "/out/one.wav");
+        assert(jobs[1].input == "/data/two.mp3" && jobs[1].output == "/exports/two.mp3");
+        assert(BatchRunner::fromManifest((dir / "none.txt").string(), "/out", handler).empty());
+        assert(BatchRunner::fromDirectory((dir / "none").string(), "/out", handler).empty());
+        assert(handler.errors().size() == 6);
+
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ Parsed\n";
+    }
+};
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "core/types.h"
+#include "core/constants.h"
+
+class AlignedAllocatorTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Aligned Allocator Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_alignment();
+        test_explicit_zeros();
+        test_container_semantics();
+
+        std::cout << "All Aligned Allocator Tests Completed Successfully.\n";
+    }
+
+private:
+    static bool aligned(const float *data) {
+        return reinterpret_cast<uintptr_t>(data) % AJ::kBufferAlignment == 0;
+    }
+
+    static void test_alignment() {
+        std::cout << "\nTest: Float storage is cache line aligned\n";
+
+        for (size_t frames : { 1, 3, 15, 16, 17, 1000, 44101 }) {
+            AJ::Float samples(frames);
+            assert(aligned(samples.data()));
+        }
+
+        // every reallocation while growing stays aligned.
+        AJ::Float grown;
+        for (size_t i = 0; i < 5000; ++i) {
+            grown.push_back(static_cast<float>(i));
+            assert(aligned(grown.data()));
+        }
+        assert(grown[4999] == 4999.0f);
+
+        AJ::AudioBuffer audio;
+        audio[0].resize(777);
+        audio[1].resize(777);
+        assert(aligned(audio[0].data()) && aligned(audio[1].data()));
+
+        std::cout << "  ✓ Aligned for every size\n";
+    }
+
+    static void test_explicit_zeros() {
+        std::cout << "\nTest: Zeros are given when asked for\n";
+
+        AJ::Float samples(1000, 0.0f);
+        for (float sample : samples) assert(sample == 0.0f);
+
+        samples.assign(2000, 1.0f);
+        samples.resize(3000, 0.0f);
+        assert(samples[1999] == 1.0f && samples[2000] == 0.0f && samples[2999] == 0.0f);
+
+        std::cout << "  ✓ Value-initializing overloads still fill\n";
+    }
+
+    static void test_container_semantics() {
+        std::cout << "\nTest: Float behaves like a vector\n";
+
+        AJ::Float a(100);
+        for (size_t i = 0; i < a.size(); ++i) a[i] = 0.5f * i;
+
+        AJ::Float b = a;
+        assert(b == a && aligned(b.data()));
+
+        AJ::Float c = std::move(b);
+        assert(c == a && b.empty());
+
+        std::vector<float> plain(a.begin(), a.end());
+        AJ::Float back(plain.begin(), plain.end());
+        assert(back == a);
+
+        AJ::Float().swap(c);
+        assert(c.capacity() == 0);
+
+        std::cout << "  ✓ Copy, move, range construction and swap\n";
+    }
+};
@@ -3,6 +3,7 @@
 #include <thread>
 #include <vector>
 #include <cassert>
+#include <algorithm>
 #include <condition_variable>
 
 #include "core/buffer_pool.h"
@@ -19,6 +20,9 @@ public:
         // test_push_pop_single_thread();
         // test_invalid_push_pop();
         test_push_pop_multi_thread();
+        test_slab_alignment();
+        test_queue_wait_wakeup();
+        test_batch();
 
         std::cout << "All BufferPool Tests Completed Successfully.\n";
     }
@@ -285,4 +289,155 @@ private:
 
         std::cout << "  ✓ Invalid cases handled correctly.\n";
     }
+
+    static void test_slab_alignment() {
+        std::cout << "\nTest: Slab Alignment\n";
+        AJ::error::ConsoleErrorHandler handler;
+
+        for (bool huge : {false, true}) {
+            AJ::utils::BufferPool pool(handler, 64, 1024, 2, huge);
+            assert(pool.isValid());
+
+            std::vector<AJ::utils::Buffer*> buffers;
+            for (int i = 0; i < pool.capacity(); ++i) {
+                AJ::utils::Buffer* buf = pool.pop(handler);
+                assert(buf != nullptr);
+                assert(!buf->owned);
+                assert(reinterpret_cast<uintptr_t>(buf->data) % AJ::kBufferAlignment == 0);
+                assert(buf->data[0] == 0.0f && buf->data[buf->size - 1] == 0.0f);
+                buffers.push_back(buf);
+            }
+
+            //* buffers are carved from one slab, so consecutive buffers are one stride apart.
+            for (size_t i = 1; i < buffers.size(); ++i) {
+                assert(buffers[i]->data - buffers[i - 1]->data == static_cast<ptrdiff_t>(buffers[i]->size));
+            }
+
+            for (auto* b : buffers) {
+                assert(pool.push(b, handler));
+            }
+        }
+
+        AJ::utils::Buffer owning(100, 1);
+        assert(owning.owned && owning.data != nullptr);
+        assert(reinterpret_cast<uintptr_t>(owning.data) % AJ::kBufferAlignment == 0);
+
+        std::cout << "  ✓ Slab buffers are 64-byte aligned and contiguous.\n";
+    }
+
+    static void test_queue_wait_wakeup() {
+        std::cout << "\nTest: Queue wait / wake (parked consumer)\n";
+        using namespace std::chrono;
+        AJ::error::ConsoleErrorHandler handler;
+        AJ::utils::Queue queue(/*empty=*/true, 16, 64, 1, handler);
+        assert(queue.isValid());
+
+        std::vector<AJ::utils::Buffer> buffers;
+        buffers.reserve(8);
+        for (int i = 0; i < 8; ++i) buffers.emplace_back(64, 1);
+
+        // nothing queued: times out.
+        auto start = steady_clock::now();
+        assert(!queue.wait(1, milliseconds(20)));
+        assert(steady_clock::now() - start >= milliseconds(20));
+
+        // woken by the push, long before the timeout.
+        std::thread producer([&] {
+            std::this_thread::sleep_for(milliseconds(20));
+            queue.push(&buffers[0]);
+        });
+        start = steady_clock::now();
+        assert(queue.wait(1, seconds(5)));
+        assert(steady_clock::now() - start < seconds(2));
+        producer.join();
+        assert(queue.pop() == &buffers[0]);
+
+        // batch threshold: 3 buffers don't wake a consumer waiting for 4, the 4th does.
+        std::atomic<bool> woke{false};
+        std::thread consumer([&] {
+            assert(queue.wait(4, seconds(5)));
+            woke.store(true);
+        });
+        for (int i = 1; i <= 3; ++i) queue.push(&buffers[i]);
+        std::this_thread::sleep_for(milliseconds(50));
+        assert(!woke.load());
+        queue.push(&buffers[4]);
+        consumer.join();
+        assert(woke.load());
+        assert(queue.currentSize() == 4);
+        while (queue.pop()) {}
+
+        // wake() releases the consumer without data.
+        consumer = std::thread([&] {
+            assert(!queue.wait(1, seconds(5)));
+        });
+        std::this_thread::sleep_for(milliseconds(20));
+        queue.wake();
+        consumer.join();
+
+        std::cout << "  ✓ Consumer parks until the batch is queued, wake() and timeouts release it.\n";
+    }
+
+    static void test_batch() {
+        std::cout << "\nTest: Batch push / pop\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::Queue queue(/*empty=*/true, 8, 64, 1, handler);
+        assert(queue.isValid());
+
+        std::vector<AJ::utils::Buffer> buffers;
+        buffers.reserve(12);
+        for (int i = 0; i < 12; ++i) buffers.emplace_back(64, 1);
+
+        AJ::utils::Buffer* in[12];
+        for (int i = 0; i < 12; ++i) in[i] = &buffers[i];
+        AJ::utils::Buffer* out[12];
+
+        // the batch stops where the queue is full, the full queue takes nothing.
+        assert(queue.pushBatch(in, 5) == 5);
+        assert(queue.pushBatch(in + 5, 7) == 3);
+        assert(queue.currentSize() == 8 && queue.pushBatch(in + 8, 1) == 0);
+
+        // in order, across the wrap.
+        assert(queue.popBatch(out, 6) == 6);
+        for (int i = 0; i < 6; ++i) assert(out[i] == in[i]);
+        assert(queue.pushBatch(in + 8, 4) == 4);
+        assert(queue.popBatch(out, 12) == 6);
+        for (int i = 0; i < 6; ++i) assert(out[i] == in[i + 6]);
+        assert(queue.popBatch(out, 12) == 0 && queue.currentSize() == 0);
+
+        // a nullptr ends the batch.
+        AJ::utils::Buffer* holed[3] = { in[0], nullptr, in[1] };
+        assert(queue.pushBatch(holed, 3) == 1 && queue.pop() == in[0]);
+
+        // the pool reports what it couldn't take back.
+        AJ::utils::BufferPool pool(handler, 4, 64, 1);
+        AJ::utils::Buffer* taken[4];
+        assert(pool.popBatch(taken, 8) == 4 && pool.popBatch(taken, 8) == 0);
+        assert(pool.pushBatch(taken, 4, handler) == 4 && !handler.hasErrors());
+        assert(pool.pushBatch(taken, 1, handler) == 0);
+        assert(handler.errors().back().first == AJ::error::Error::BufferOverflow);
+
+        // producer and consumer in batches of different sizes.
+        const size_t total = 100000;
+        std::thread producer([&] {
+            size_t sent = 0;
+            while (sent < total) {
+                AJ::utils::Buffer* batch[3];
+                const size_t n = std::min<size_t>(3, total - sent);
+                for (size_t i = 0; i < n; ++i) batch[i] = in[(sent + i) % 12];
+                sent += queue.pushBatch(batch, n);
+            }
+        });
+
+        size_t received = 0;
+        while (received < total) {
+            const size_t n = queue.popBatch(out, 5);
+            for (size_t i = 0; i < n; ++i) assert(out[i] == in[(received + i) % 12]);
+            received += n;
+        }
+        producer.join();
+        assert(queue.currentSize() == 0);
+
+        std::cout << "  ✓ Partial batches, wrap-around and " << total << " buffers across threads in order.\n";
+    }
 };
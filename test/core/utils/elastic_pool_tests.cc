@@ -0,0 +1,241 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/elastic_pool.h"
+#include "core/metrics.h"
+#include "core/error_handler.h"
+
+class ElasticPoolTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Elastic Pool Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_classes();
+        test_grow_on_demand();
+        test_budget_cap();
+        test_idle_shrink();
+        test_trim();
+        test_background_maintenance();
+        test_invalid();
+
+        std::cout << "All Elastic Pool Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::utils::SizeClass sizeClass(size_t frames, uint8_t channels, size_t initial, size_t low, size_t grow, size_t max) {
+        AJ::utils::SizeClass spec;
+        spec.frames = frames;
+        spec.channels = channels;
+        spec.initial = initial;
+        spec.lowWatermark = low;
+        spec.growBy = grow;
+        spec.max = max;
+        return spec;
+    }
+
+    static void test_classes() {
+        std::cout << "\nTest: Buffers come from the smallest class that fits\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ElasticBufferPool pool(handler, {
+            sizeClass(4096, 2, 2, 1, 1, 4), sizeClass(256, 2, 4, 1, 1, 8), sizeClass(256, 1, 4, 1, 1, 8)
+        }, 1 << 20, false);
+        assert(pool.isValid() && pool.classCount() == 3);
+
+        const size_t small = pool.classFor(200, 2);
+        const size_t large = pool.classFor(1000, 2);
+        assert(pool.sizeClass(small).frames == 256 && pool.sizeClass(large).frames == 4096);
+        assert(pool.sizeClass(pool.classFor(256, 1)).channels == 1);
+        assert(pool.classFor(8192, 2) == pool.classCount());
+
+        AJ::utils::Buffer *buffer = pool.take(small);
+        assert(buffer && buffer->size == 512 && buffer->channels == 2);
+        assert(pool.stats(small).free == 3);
+
+        // back through the return list, counted as free right away.
+        assert(pool.give(buffer));
+        assert(pool.stats(small).free == 4 && pool.stats(small).taken == 1);
+
+        AJ::utils::Buffer stranger(100, 1);
+        assert(!pool.give(&stranger));
+        assert(!handler.hasErrors());
+
+        std::cout << "  ✓ 3 classes, one take and give\n";
+    }
+
+    static void test_grow_on_demand() {
+        std::cout << "\nTest: An empty class misses, the maintenance grows it\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        auto metrics = std::make_shared<AJ::utils::MetricsRegistry>();
+        AJ::utils::ElasticBufferPool pool(handler, {sizeClass(128, 1, 4, 2, 4, 16)}, 1 << 20, false);
+        pool.setMetrics(metrics);
+
+        std::vector<AJ::utils::Buffer*> held;
+        while (AJ::utils::Buffer *buffer = pool.take(0)) held.push_back(buffer);
+        assert(held.size() == 4 && pool.stats(0).misses == 1);
+
+        pool.maintain();
+        AJ::utils::SizeClassStats stats = pool.stats(0);
+        assert(stats.buffers == 8 && stats.free == 4 && stats.grown == 4 && stats.peakInUse == 4);
+        const AJ::utils::MetricsSnapshot snapshot = metrics->snapshot();
+        assert(snapshot[AJ::utils::Counter::ElasticMisses] == 1);
+        assert(snapshot[AJ::utils::Counter::ElasticGrowths] == 4);
+        assert(snapshot[AJ::utils::Peak::ElasticBytes] == pool.bytes());
+
+        // given back buffers are recycled, not reallocated.
+        for (AJ::utils::Buffer *buffer : held) assert(pool.give(buffer));
+        pool.maintain();
+        assert(pool.stats(0).buffers == 8 && pool.stats(0).free == 8);
+
+        std::cout << "  ✓ Grew from 4 to 8 buffers after one miss\n";
+    }
+
+    static void test_budget_cap() {
+        std::cout << "\nTest: Growth stops at the class max and the pool budget\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const size_t bytes = AJ::utils::Buffer::storageBytes(1024);
+
+        // room for 6 buffers: 2 initial in each class, 2 more for whoever asks first.
+        AJ::utils::ElasticBufferPool pool(handler, {sizeClass(1024, 1, 2, 1, 4, 16), sizeClass(512, 2, 2, 1, 4, 3)},
+                                          6 * bytes, false);
+        assert(pool.isValid() && pool.bytes() == 4 * bytes);
+
+        const size_t mono = pool.classFor(1024, 1);
+        const size_t stereo = pool.classFor(512, 2);
+
+        std::vector<AJ::utils::Buffer*> held;
+        while (AJ::utils::Buffer *buffer = pool.take(stereo)) held.push_back(buffer);
+        pool.maintain();
+        assert(pool.stats(stereo).buffers == 3 && pool.stats(stereo).capped == 1);   // the class max
+
+        while (AJ::utils::Buffer *buffer = pool.take(mono)) held.push_back(buffer);
+        pool.maintain();
+        assert(pool.stats(mono).buffers == 3 && pool.stats(mono).capped == 1);       // the budget
+        assert(pool.bytes() == pool.budget());
+
+        for (AJ::utils::Buffer *buffer : held) pool.give(buffer);
+        assert(!handler.hasErrors());
+
+        std::cout << "  ✓ 6 buffers of a 6-buffer budget\n";
+    }
+
+    static void test_idle_shrink() {
+        std::cout << "\nTest: An idle class frees the buffers it got back\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ElasticBufferPool pool(handler, {sizeClass(64, 1, 4, 2, 2, 64)}, 1 << 20, false);
+
+        // a burst grows the class to 12.
+        std::vector<AJ::utils::Buffer*> held;
+        for (int round = 0; round < 4; ++round) {
+            while (AJ::utils::Buffer *buffer = pool.take(0)) held.push_back(buffer);
+            pool.maintain();
+        }
+        const size_t grown = pool.stats(0).buffers;
+        assert(grown > 4);
+
+        // the free list stays above the margin from here on.
+        for (size_t i = 0; i < held.size() / 2; ++i) pool.give(held[i]);
+        for (size_t pass = 0; pass < AJ::kElasticPoolIdlePasses; ++pass) pool.maintain();
+        assert(pool.stats(0).buffers == grown && pool.stats(0).shrunk == 0);
+
+        for (size_t i = held.size() / 2; i < held.size(); ++i) pool.give(held[i]);
+        pool.maintain();
+
+        AJ::utils::SizeClassStats stats = pool.stats(0);
+        assert(stats.shrunk > 0 && stats.buffers < grown && stats.buffers >= 4);
+        assert(stats.free == stats.buffers);
+
+        std::cout << "  ✓ " << grown << " buffers down to " << stats.buffers << "\n";
+    }
+
+    static void test_trim() {
+        std::cout << "\nTest: Trimming a stopped class\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ElasticBufferPool pool(handler, {sizeClass(256, 2, 2, 2, 6, 32)}, 1 << 20, false);
+
+        std::vector<AJ::utils::Buffer*> held;
+        while (AJ::utils::Buffer *buffer = pool.take(0)) held.push_back(buffer);
+        pool.maintain();
+        assert(pool.stats(0).buffers == 8);
+
+        for (AJ::utils::Buffer *buffer : held) pool.give(buffer);
+        assert(pool.trim(0) == 6);
+        assert(pool.stats(0).buffers == 2 && pool.stats(0).free == 2);
+        assert(pool.bytes() == 2 * AJ::utils::Buffer::storageBytes(512));
+
+        std::cout << "  ✓ Back to the 2 initial buffers\n";
+    }
+
+    static void test_background_maintenance() {
+        std::cout << "\nTest: A taker and a giver with the maintenance thread\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ElasticBufferPool pool(handler, {sizeClass(256, 2, 8, 4, 8, 256)}, 1 << 24);
+        assert(pool.isValid());
+
+        AJ::utils::Queue inFlight(true, 256, 256, 2, handler);
+        const size_t blocks = 20000;
+        std::atomic<bool> done{false};
+
+        std::thread giver([&]() {
+            size_t given = 0;
+            while (given < blocks) {
+                if (AJ::utils::Buffer *buffer = inFlight.pop()) {
+                    assert(buffer->data[0] == static_cast<float>(given % 1000));
+                    assert(pool.give(buffer));
+                    ++given;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            done = true;
+        });
+
+        size_t sent = 0;
+        while (sent < blocks) {
+            AJ::utils::Buffer *buffer = pool.take(0);
+            if (!buffer) {
+                std::this_thread::yield();
+                continue;
+            }
+            buffer->data[0] = static_cast<float>(sent % 1000);
+            while (!inFlight.push(buffer)) std::this_thread::yield();
+            ++sent;
+        }
+        giver.join();
+        assert(done);
+
+        AJ::utils::SizeClassStats stats = pool.stats(0);
+        assert(stats.taken == blocks && stats.buffers <= 256);
+        assert(!handler.hasErrors());
+
+        std::cout << "  ✓ " << blocks << " blocks, " << stats.misses << " misses, " << stats.buffers << " buffers\n";
+    }
+
+    static void test_invalid() {
+        std::cout << "\nTest: Invalid classes and budgets\n";
+
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::utils::ElasticBufferPool duplicate(handler, {sizeClass(256, 2, 1, 1, 1, 4), sizeClass(256, 2, 2, 1, 1, 4)}, 1 << 20, false);
+        assert(!duplicate.isValid() && handler.errors().back().first == AJ::error::Error::InvalidConfiguration);
+
+        AJ::utils::ElasticBufferPool initial(handler, {sizeClass(256, 2, 8, 1, 1, 4)}, 1 << 20, false);
+        assert(!initial.isValid() && handler.errors().back().first == AJ::error::Error::InvalidConfiguration);
+
+        AJ::utils::ElasticBufferPool budget(handler, {sizeClass(4096, 2, 64, 1, 1, 64)}, 1 << 20, false);
+        assert(!budget.isValid() && handler.errors().back().first == AJ::error::Error::InvalidBufferSize);
+        assert(budget.bytes() == 0);
+
+        std::cout << "  ✓ Refused with an error\n";
+    }
+};
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/engine_resources.h"
+#include "core/memory.h"
+#include "core/error_handler.h"
+
+class EngineResourcesTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Engine Resources Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_lazy_pools();
+        test_thread_roles();
+        test_eager();
+        test_concurrent_first_use();
+
+        std::cout << "All Engine Resources Tests Completed Successfully.\n";
+    }
+
+private:
+    static uint64_t poolBytes() {
+        return AJ::utils::engineAllocator().snapshot()[AJ::utils::Subsystem::Pools].current;
+    }
+
+    static void test_lazy_pools() {
+        std::cout << "\nTest: Record pools are allocated on first use\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const uint64_t before = poolBytes();
+
+        AJ::EngineResources resources(handler, AJ::EngineResources::Config().monoStream(64, 256).stereoStream(32, 128));
+        assert(poolBytes() == before);
+        assert(!resources.hasStreamBuffers(1) && !resources.hasStreamBuffers(2));
+
+        // the pool and its queue come together, once.
+        std::shared_ptr<AJ::utils::Queue> queue = resources.queueStereo();
+        assert(resources.hasStreamBuffers(2) && !resources.hasStreamBuffers(1));
+        assert(resources.bufferPoolStereo()->currentSize() == 32 && resources.bufferPoolStereo()->bufferSize() == 256);
+        assert(resources.queueStereo() == queue);
+        assert(poolBytes() > before);
+
+        // resizing follows, the config with it.
+        assert(resources.resizeStreamBuffers(1, 16, 64, handler));
+        assert(resources.bufferPoolMono()->currentSize() == 16 && resources.config().mMono.frames == 64);
+        assert(!handler.hasErrors());
+
+        std::cout << "  ✓ Nothing allocated until asked for\n";
+    }
+
+    static void test_thread_roles() {
+        std::cout << "\nTest: Threads per role\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::EngineResources resources(handler, AJ::EngineResources::Config().dspThreads(3).ioThreads(1).diskThreads(2));
+
+        assert(resources.threadPool()->size() == 3);
+        assert(resources.ioThreadPool()->size() == AJ::kEngineIoThreads);    // a read-ahead and a handler at least.
+        assert(resources.ioThreadPool() != resources.threadPool());
+        assert(resources.diskWriters()->workers() == 2);
+
+        std::cout << "  ✓ DSP, I/O and disk pools sized apart\n";
+    }
+
+    static void test_eager() {
+        std::cout << "\nTest: A recording config creates everything up front\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::EngineResources resources(handler, AJ::EngineResources::Config::recording().monoStream(8, 64).stereoStream(8, 64));
+
+        assert(resources.hasStreamBuffers(1) && resources.hasStreamBuffers(2));
+        assert(resources.metricsSnapshot().poolAvailable == 8);
+
+        std::cout << "  ✓ Pools ready before the first use\n";
+    }
+
+    static void test_concurrent_first_use() {
+        std::cout << "\nTest: Concurrent first use creates one pool\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::EngineResources resources(handler, AJ::EngineResources::Config::transcode());
+
+        std::vector<std::shared_ptr<AJ::utils::BufferPool>> seen(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < seen.size(); ++t) {
+            threads.emplace_back([&, t]() { seen[t] = resources.bufferPoolMono(); });
+        }
+        for (std::thread &thread : threads) thread.join();
+
+        for (auto &pool : seen) assert(pool && pool == seen[0]);
+
+        std::cout << "  ✓ Every thread got the same pool\n";
+    }
+};
@@ -0,0 +1,172 @@
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/error_channel.h"
+#include "core/error_handler.h"
+
+class ErrorChannelTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Error Channel Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_report_formats();
+        test_queued_until_drained();
+        test_rate_limit();
+        test_full_queue_drops();
+        test_producers();
+        test_reporter_thread();
+
+        std::cout << "All Error Channel Tests Completed Successfully.\n";
+    }
+
+private:
+    using Error = AJ::error::Error;
+
+    static void test_report_formats() {
+        std::cout << "\nTest: report() formats through onError(), or is only counted\n";
+        AJ::error::CollectingErrorHandler collecting;
+
+        AJ::error::report(collecting, Error::InvalidChannelCount, "block of {} channels, the state has {}.\n", 3, -2);
+        AJ::error::report(collecting, Error::NullBufferPtr, "no arguments {}.\n");
+        assert(collecting.errors().size() == 2);
+        assert(collecting.errors()[0].first == Error::InvalidChannelCount);
+        assert(collecting.errors()[0].second == "block of 3 channels, the state has -2.\n");
+        assert(collecting.errors()[1].second == "no arguments {}.\n");
+
+        AJ::error::CountingErrorHandler counting;
+        AJ::error::report(counting, Error::BufferOverflow, "{} frames.\n", 512);
+        assert(counting.count() == 1 && counting.last() == Error::BufferOverflow);
+
+        std::cout << "  ✓ Formatted and counted\n";
+    }
+
+    static void test_queued_until_drained() {
+        std::cout << "\nTest: Events reach the sink in order, on drain() only\n";
+        AJ::error::CollectingErrorHandler sink;
+        AJ::error::ErrorChannel channel(sink);
+
+        AJ::error::report(channel, Error::BufferOverflow, "block {} dropped.\n", 7);
+        channel.onError(Error::FileWriteError, "disk full.\n");
+        channel.onError(Error::FileWriteError, std::string(500, 'x'));
+        assert(!sink.hasErrors());
+
+        assert(channel.drain() == 3);
+        assert(sink.errors().size() == 3);
+        assert(sink.errors()[0].second == "block 7 dropped.\n");
+        assert(sink.errors()[1].first == Error::FileWriteError && sink.errors()[1].second == "disk full.\n");
+        assert(sink.errors()[2].second.size() == AJ::kErrorEventTextBytes - 1);
+
+        assert(channel.drain() == 0);
+        assert(channel.count(Error::FileWriteError) == 2 && channel.count() == 3);
+
+        std::cout << "  ✓ 3 events, in order\n";
+    }
+
+    static void test_rate_limit() {
+        std::cout << "\nTest: A code past its burst is counted and summarized, others pass\n";
+        AJ::error::CollectingErrorHandler sink;
+        AJ::error::ErrorChannel channel(sink, 64, 4);
+
+        for (int i = 0; i < 100; ++i) AJ::error::report(channel, Error::BufferOverflow, "overflow {}.\n", i);
+        AJ::error::report(channel, Error::NullBufferPtr, "null.\n");
+
+        assert(channel.count(Error::BufferOverflow) == 100);
+        assert(channel.suppressed(Error::BufferOverflow) == 96);
+        assert(channel.suppressed(Error::NullBufferPtr) == 0);
+
+        //* 4 overflows, the null pointer, one summary.
+        assert(channel.drain() == 6);
+        assert(sink.errors()[3].second == "overflow 3.\n");
+        assert(sink.errors()[4].first == Error::NullBufferPtr);
+        assert(sink.errors()[5].first == Error::BufferOverflow);
+        assert(sink.errors()[5].second.find("96 more") == 0);
+
+        //* the summary isn't repeated.
+        assert(channel.drain() == 0);
+
+        std::cout << "  ✓ " << channel.suppressed(Error::BufferOverflow) << " suppressed\n";
+    }
+
+    static void test_full_queue_drops() {
+        std::cout << "\nTest: A full queue drops the newest events\n";
+        AJ::error::CollectingErrorHandler sink;
+        AJ::error::ErrorChannel channel(sink, 8, 1000);
+
+        for (int i = 0; i < 20; ++i) AJ::error::report(channel, Error::InternalError, "event {}.\n", i);
+        assert(channel.dropped() == 12);
+
+        assert(channel.drain() == 8);
+        assert(sink.errors().back().second == "event 7.\n");
+
+        //* the cells are free again.
+        AJ::error::report(channel, Error::InternalError, "event {}.\n", 20);
+        assert(channel.drain() == 1 && sink.errors().back().second == "event 20.\n");
+
+        std::cout << "  ✓ 12 dropped, the queue reused\n";
+    }
+
+    static void test_producers() {
+        std::cout << "\nTest: Producers on several threads while another drains\n";
+        AJ::error::CollectingErrorHandler sink;
+        AJ::error::ErrorChannel channel(sink, 1024, 1000000);
+
+        constexpr int kThreads = 4;
+        constexpr int kEvents = 5000;
+        std::atomic<bool> done{false};
+        size_t drained = 0;
+
+        std::thread consumer([&]() {
+            while (!done.load()) drained += channel.drain();
+        });
+
+        std::vector<std::thread> producers;
+        for (int t = 0; t < kThreads; ++t) {
+            producers.emplace_back([&channel, t]() {
+                for (int i = 0; i < kEvents; ++i) {
+                    AJ::error::report(channel, static_cast<Error>(100 + t), "thread {} event {}.\n", t, i);
+                }
+            });
+        }
+        for (auto &producer : producers) producer.join();
+        done = true;
+        consumer.join();
+        drained += channel.drain();
+
+        assert(channel.count() == kThreads * kEvents);
+        assert(drained + channel.dropped() == kThreads * kEvents);
+        assert(sink.errors().size() == drained);
+
+        std::cout << "  ✓ " << drained << " drained, " << channel.dropped() << " dropped\n";
+    }
+
+    static void test_reporter_thread() {
+        std::cout << "\nTest: start() drains in the background, the destructor drains the rest\n";
+        //* the reporter calls the sink on its own thread: a sink readable from this one.
+        AJ::error::CountingErrorHandler sink;
+
+        {
+            AJ::error::ErrorChannel channel(sink);
+            channel.start();
+            AJ::error::report(channel, Error::RecordingError, "xrun {}.\n", 1);
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (sink.count() == 0 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            assert(sink.count() == 1);
+
+            channel.stop();
+            AJ::error::report(channel, Error::StateError, "xrun {}.\n", 2);
+            assert(sink.count() == 1);
+        }
+
+        assert(sink.count() == 2 && sink.last() == Error::StateError);
+        std::cout << "  ✓ Reported by the reporter and on destruction\n";
+    }
+};
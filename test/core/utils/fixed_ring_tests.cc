@@ -0,0 +1,163 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "core/fixed_ring_buffer.h"
+#include "core/fixed_queue.h"
+#include "core/error_handler.h"
+
+class FixedRingTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Fixed Ring Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_ring_frames();
+        test_ring_regions();
+        test_ring_threads();
+        test_queue();
+
+        std::cout << "All Fixed Ring Tests Completed Successfully.\n";
+    }
+
+private:
+    static void test_ring_frames() {
+        std::cout << "\nTest: Fixed ring, frames in and out across the wrap\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::FixedRingBuffer<2, 8> ring(handler);
+        static_assert(AJ::utils::FixedRingBuffer<2, 8>::kInline, "a small ring lives in the object");
+        static_assert(!AJ::utils::FixedRingBuffer<2, 16384>::kInline, "a big one doesn't");
+        assert(ring.isValid() && ring.frameCapacity() == 8 && ring.samplesCapacity() == 16 && ring.channels() == 2);
+
+        float in[24], out[24];
+        for (int i = 0; i < 24; ++i) in[i] = static_cast<float>(i);
+
+        assert(ring.writeFrames(in, 5) == 5);
+        assert(ring.readFrames(out, 3) == 3 && out[5] == 5.0f);
+
+        // 6 free frames: 3 up to the end, 3 at the start.
+        assert(ring.writeFrames(in + 10, 12) == 6);
+        assert(!ring.writeFrame(in));
+        assert(ring.readFrames(out, 12) == 8);
+        assert(out[0] == 6.0f && out[3] == 9.0f && out[4] == 10.0f && out[15] == 21.0f);
+        assert(ring.readFrames(out, 1) == 0 && !ring.readFrame(out));
+
+        float frame[2] = { 1.5f, -1.5f };
+        assert(ring.writeFrame(frame) && ring.readFrame(out) && out[0] == 1.5f && out[1] == -1.5f);
+        assert(!ring.writeFrame(nullptr) && ring.writeFrames(nullptr, 4) == 0);
+
+        AJ::utils::FixedRingBuffer<1, 16384> big(handler);
+        assert(big.isValid() && big.writeFrames(in, 24) == 24 && big.readFrames(out, 24) == 24 && out[23] == 23.0f);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Partial writes, wrap-around, single frames, inline and heap storage\n";
+    }
+
+    static void test_ring_regions() {
+        std::cout << "\nTest: Fixed ring, acquire / commit\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::FixedRingBuffer<1, 8> ring(handler);
+
+        float in[6] = { 0, 1, 2, 3, 4, 5 };
+        assert(ring.writeFrames(in, 6) == 6);
+        float out[6];
+        assert(ring.readFrames(out, 6) == 6);
+
+        // the next 5 frames split: 2 at the end, 3 at the start.
+        AJ::utils::RingRegion region = ring.acquireWrite(5);
+        assert(region.first.frames == 2 && region.second.frames == 3);
+        for (size_t f = 0; f < region.first.frames; ++f) region.first.data[f] = 10.0f + f;
+        for (size_t f = 0; f < region.second.frames; ++f) region.second.data[f] = 12.0f + f;
+        ring.commitWrite(5);
+
+        region = ring.acquireRead(8);
+        assert(region.frames() == 5 && region.first.data[1] == 11.0f && region.second.data[2] == 14.0f);
+        ring.commitRead(2);
+        assert(ring.acquireRead(8).frames() == 3);
+        ring.commitRead(8);
+        assert(ring.acquireRead(8).frames() == 0 && ring.acquireWrite(16).frames() == 8);
+
+        std::cout << "  ✓ Regions split at the wrap, commits clamp to what is there\n";
+    }
+
+    static void test_ring_threads() {
+        std::cout << "\nTest: Fixed ring, producer and consumer threads\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::FixedRingBuffer<2, 64> ring(handler);
+        const size_t total = 200000;
+
+        std::thread producer([&] {
+            float chunk[2 * 7];
+            size_t sent = 0;
+            while (sent < total) {
+                const size_t frames = std::min<size_t>(7, total - sent);
+                for (size_t f = 0; f < frames; ++f) {
+                    chunk[2 * f] = static_cast<float>(sent + f);
+                    chunk[2 * f + 1] = -static_cast<float>(sent + f);
+                }
+                size_t written = 0;
+                while (written < frames) written += ring.writeFrames(chunk + 2 * written, frames - written);
+                sent += frames;
+            }
+        });
+
+        float chunk[2 * 13];
+        size_t received = 0;
+        while (received < total) {
+            const size_t frames = ring.readFrames(chunk, 13);
+            for (size_t f = 0; f < frames; ++f) {
+                assert(chunk[2 * f] == static_cast<float>(received + f));
+                assert(chunk[2 * f + 1] == -static_cast<float>(received + f));
+            }
+            received += frames;
+        }
+        producer.join();
+
+        std::cout << "  ✓ " << total << " frames in order\n";
+    }
+
+    static void test_queue() {
+        std::cout << "\nTest: Fixed queue\n";
+
+        AJ::utils::FixedQueue<4> queue;
+        static_assert(AJ::utils::FixedQueue<4>::queueSize() == 4, "constant capacity");
+
+        std::vector<AJ::utils::Buffer> buffers;
+        buffers.reserve(6);
+        for (int i = 0; i < 6; ++i) buffers.emplace_back(16, 1);
+        AJ::utils::Buffer* in[6];
+        for (int i = 0; i < 6; ++i) in[i] = &buffers[i];
+        AJ::utils::Buffer* out[6];
+
+        assert(queue.push(in[0]) && !queue.push(nullptr));
+        assert(queue.pushBatch(in + 1, 5) == 3 && !queue.push(in[4]) && queue.currentSize() == 4);
+        assert(queue.pop() == in[0]);
+        assert(queue.pushBatch(in + 4, 2) == 1);
+        assert(queue.popBatch(out, 6) == 4);
+        for (int i = 0; i < 4; ++i) assert(out[i] == in[i + 1]);
+        assert(!queue.pop() && queue.popBatch(out, 6) == 0);
+
+        // across threads, one buffer at a time against batches.
+        AJ::utils::FixedQueue<16> shared;
+        const size_t total = 100000;
+        std::thread producer([&] {
+            for (size_t sent = 0; sent < total; ) {
+                if (shared.push(in[sent % 6])) ++sent;
+            }
+        });
+        size_t received = 0;
+        while (received < total) {
+            const size_t n = shared.popBatch(out, 5);
+            for (size_t i = 0; i < n; ++i) assert(out[i] == in[(received + i) % 6]);
+            received += n;
+        }
+        producer.join();
+
+        std::cout << "  ✓ Bounded, batched and " << total << " buffers across threads in order\n";
+    }
+};
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "core/memory.h"
+#include "core/types.h"
+#include "core/buffer_pool.h"
+#include "core/error_handler.h"
+
+class MemoryTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Memory Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_tracking_counts();
+        test_scoped_float();
+        test_realtime_allocations();
+        test_pools();
+        test_allocation_rate();
+
+        std::cout << "All Memory Tests Completed Successfully.\n";
+    }
+
+private:
+    using Subsystem = AJ::utils::Subsystem;
+
+    static void test_tracking_counts() {
+        std::cout << "\nTest: Current and peak bytes per subsystem\n";
+
+        AJ::utils::SystemAllocator system;
+        AJ::utils::TrackingAllocator tracking(system);
+
+        void *a = tracking.allocate(4096, 64, Subsystem::Dsp);
+        void *b = tracking.allocate(1024, 64, Subsystem::Dsp);
+        void *c = tracking.allocate(512, 64, Subsystem::FileIO);
+        assert(a && b && c);
+
+        tracking.deallocate(a, 4096, 64, Subsystem::Dsp);
+
+        AJ::utils::MemorySnapshot snapshot = tracking.snapshot();
+        assert(snapshot[Subsystem::Dsp].current == 1024 && snapshot[Subsystem::Dsp].peak == 5120);
+        assert(snapshot[Subsystem::Dsp].allocations == 2 && snapshot[Subsystem::Dsp].frees == 1);
+        assert(snapshot[Subsystem::FileIO].current == 512 && snapshot[Subsystem::Editing].allocations == 0);
+        assert(snapshot.current() == 1536);
+
+        tracking.resetPeaks();
+        assert(tracking.snapshot()[Subsystem::Dsp].peak == 1024);
+
+        tracking.deallocate(b, 1024, 64, Subsystem::Dsp);
+        tracking.deallocate(c, 512, 64, Subsystem::FileIO);
+        assert(tracking.snapshot().current() == 0);
+
+        std::cout << "  ✓ dsp peak 5120 bytes, nothing held at the end\n";
+    }
+
+    static void test_scoped_float() {
+        std::cout << "\nTest: A Float is accounted to its scope, wherever it's freed\n";
+
+        AJ::utils::TrackingAllocator &engine = AJ::utils::engineAllocator();
+        const AJ::utils::MemorySnapshot before = engine.snapshot();
+
+        auto samples = std::make_unique<AJ::Float>();
+        {
+            AJ::utils::MemoryScope dsp(Subsystem::Dsp);
+            {
+                AJ::utils::MemoryScope editing(Subsystem::Editing);
+                assert(AJ::utils::currentSubsystem() == Subsystem::Editing);
+            }
+            assert(AJ::utils::currentSubsystem() == Subsystem::Dsp);
+            samples->resize(48000);
+        }
+        assert(AJ::utils::currentSubsystem() == Subsystem::Other);
+
+        const AJ::utils::MemorySnapshot held = engine.snapshot();
+        assert(held[Subsystem::Dsp].current >= before[Subsystem::Dsp].current + 48000 * sizeof(float));
+        assert(held[Subsystem::Dsp].allocations == before[Subsystem::Dsp].allocations + 1);
+
+        // freed on another thread, outside of any scope.
+        std::thread([&samples] { samples.reset(); }).join();
+
+        const AJ::utils::MemorySnapshot after = engine.snapshot();
+        assert(after[Subsystem::Dsp].current == before[Subsystem::Dsp].current);
+        assert(after[Subsystem::Dsp].frees == before[Subsystem::Dsp].frees + 1);
+
+        std::cout << "  ✓ " << held[Subsystem::Dsp].current - before[Subsystem::Dsp].current << " bytes charged to dsp and returned\n";
+    }
+
+    static void test_realtime_allocations() {
+        std::cout << "\nTest: Allocations in a realtime scope are counted\n";
+
+        AJ::utils::TrackingAllocator &engine = AJ::utils::engineAllocator();
+        const uint64_t before = engine.snapshot().realtimeAllocations;
+
+        AJ::Float outside(256);
+        assert(!AJ::utils::inRealtimeScope());
+        {
+            AJ::utils::RealtimeScope realtime;
+            assert(AJ::utils::inRealtimeScope());
+
+            AJ::Float inside(256);
+        }
+        assert(!AJ::utils::inRealtimeScope());
+
+        assert(engine.snapshot().realtimeAllocations == before + 1);
+
+        std::cout << "  ✓ 1 realtime allocation\n";
+    }
+
+    static void test_pools() {
+        std::cout << "\nTest: Buffer pools are accounted to pools\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::TrackingAllocator &engine = AJ::utils::engineAllocator();
+        const uint64_t before = engine.snapshot()[Subsystem::Pools].current;
+
+        uint64_t held = 0;
+        {
+            AJ::utils::BufferPool pool(handler, 64, 1024, 2);
+            held = engine.snapshot()[Subsystem::Pools].current - before;
+            assert(held >= 64 * 1024 * 2 * sizeof(float));
+        }
+
+        assert(!handler.hasErrors());
+        assert(engine.snapshot()[Subsystem::Pools].current == before);
+
+        std::cout << "  ✓ " << held / 1024 << " KiB while the pool lived\n";
+    }
+
+    static void test_allocation_rate() {
+        std::cout << "\nTest: Allocation rate between two snapshots\n";
+
+        AJ::utils::SystemAllocator system;
+        AJ::utils::TrackingAllocator tracking(system);
+
+        const AJ::utils::MemorySnapshot first = tracking.snapshot();
+        for (int i = 0; i < 100; ++i) {
+            tracking.deallocate(tracking.allocate(64, 64, Subsystem::Editing), 64, 64, Subsystem::Editing);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const AJ::utils::MemorySnapshot second = tracking.snapshot();
+
+        const double rate = second.allocationRate(first, Subsystem::Editing);
+        assert(rate > 0.0 && rate <= 100.0 / 0.010);
+        assert(second.allocationRate(first, Subsystem::Dsp) == 0.0);
+        assert(first.allocationRate(second, Subsystem::Editing) == 0.0);
+
+        std::cout << "  ✓ " << static_cast<uint64_t>(rate) << " allocations/s\n";
+    }
+};
@@ -0,0 +1,157 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/metrics.h"
+#include "core/aj_audio_engine.h"
+#include "core/engine_resources.h"
+#include "dsp/gain.h"
+#include "file_io/wav_file.h"
+#include "core/error_handler.h"
+
+class MetricsTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Metrics Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_threads_merge();
+        test_histogram_buckets();
+        test_percentiles_and_reset();
+        test_prometheus();
+        test_engine_effects();
+
+        std::cout << "All Metrics Tests Completed Successfully.\n";
+    }
+
+private:
+    static void test_threads_merge() {
+        std::cout << "\nTest: Updates of concurrent threads are merged exactly\n";
+
+        AJ::utils::MetricsRegistry metrics;
+        const size_t threads = 12, updates = 100000;
+
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&metrics, t, updates] {
+                for (size_t i = 0; i < updates; ++i) {
+                    metrics.add(AJ::utils::Counter::BlocksWritten);
+                    metrics.add(AJ::utils::Counter::BytesWritten, 4);
+                    metrics.record(AJ::utils::Latency::BlockWrite, 1000 + i % 100);
+                }
+                metrics.raise(AJ::utils::Peak::QueueDepth, 10 + t);
+            });
+        }
+        for (std::thread &worker : workers) worker.join();
+
+        const AJ::utils::MetricsSnapshot snapshot = metrics.snapshot();
+        assert(snapshot[AJ::utils::Counter::BlocksWritten] == threads * updates);
+        assert(snapshot[AJ::utils::Counter::BytesWritten] == 4 * threads * updates);
+        assert(snapshot[AJ::utils::Counter::DroppedBlocks] == 0);
+        assert(snapshot[AJ::utils::Peak::QueueDepth] == 10 + threads - 1);
+
+        const AJ::utils::LatencySummary &writes = snapshot[AJ::utils::Latency::BlockWrite];
+        assert(writes.count == threads * updates && writes.max == 1099);
+        assert(writes.sum == threads * (updates / 100) * (100 * 1000 + 4950));
+
+        std::cout << "  ✓ Counters, peaks and histograms of " << threads << " threads\n";
+    }
+
+    static void test_histogram_buckets() {
+        std::cout << "\nTest: Buckets hold their values within 1/8\n";
+
+        using AJ::utils::LatencySummary;
+
+        for (uint64_t v = 0; v < 100000; v = v * 9 / 8 + 1) {
+            const size_t b = LatencySummary::bucket(v);
+            assert(LatencySummary::lowest(b) <= v && v < LatencySummary::lowest(b + 1));
+            assert(v - LatencySummary::lowest(b) <= v / 8);
+        }
+
+        // past the range everything lands in the last bucket.
+        assert(LatencySummary::bucket(uint64_t(1) << 50) == LatencySummary::kBuckets - 1);
+        assert(LatencySummary::bucket(UINT64_MAX) == LatencySummary::kBuckets - 1);
+
+        std::cout << "  ✓ Log-linear buckets, saturating\n";
+    }
+
+    static void test_percentiles_and_reset() {
+        std::cout << "\nTest: Percentiles and reset\n";
+
+        AJ::utils::MetricsRegistry metrics;
+        assert(metrics.snapshot()[AJ::utils::Latency::Effect].percentile(0.5) == 0);
+
+        // 1 µs to 1 ms, one each.
+        for (uint64_t ns = 1000; ns <= 1000000; ns += 1000) {
+            metrics.record(AJ::utils::Latency::Effect, ns);
+        }
+
+        const AJ::utils::LatencySummary effect = metrics.snapshot()[AJ::utils::Latency::Effect];
+        const uint64_t p50 = effect.percentile(0.5), p99 = effect.percentile(0.99);
+        assert(p50 >= 500000 * 7 / 8 && p50 <= 501000);
+        assert(p99 >= 990000 * 7 / 8 && p99 <= 991000);
+        assert(effect.percentile(1.0) == 1000000 && effect.max == 1000000);
+
+        metrics.add(AJ::utils::Counter::Underruns, 3);
+        metrics.reset();
+        const AJ::utils::MetricsSnapshot cleared = metrics.snapshot();
+        assert(cleared[AJ::utils::Counter::Underruns] == 0 && cleared[AJ::utils::Latency::Effect].count == 0);
+
+        std::cout << "  ✓ p50 " << p50 << " ns, p99 " << p99 << " ns\n";
+    }
+
+    static void test_prometheus() {
+        std::cout << "\nTest: Prometheus text format\n";
+
+        AJ::utils::MetricsRegistry metrics;
+        metrics.add(AJ::utils::Counter::DroppedBlocks, 7);
+        metrics.record(AJ::utils::Latency::RecordCallback, 2000);
+
+        const std::string text = metrics.snapshot().prometheus();
+        assert(text.find("# TYPE aj_dropped_blocks_total counter\naj_dropped_blocks_total 7\n") != std::string::npos);
+        assert(text.find("aj_max_queue_depth 0\n") != std::string::npos);
+        assert(text.find("aj_record_callback_seconds{quantile=\"0.99\"} ") != std::string::npos);
+        assert(text.find("aj_record_callback_seconds_count 1\n") != std::string::npos);
+
+        std::cout << "  ✓ Counters, gauges and summaries\n";
+    }
+
+    static void test_engine_effects() {
+        std::cout << "\nTest: The engine counts and times its effects\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        auto resources = std::make_shared<AJ::EngineResources>(handler);
+
+        AJ::AJ_Engine engine;
+        engine.setEngineResources(resources);
+
+        auto file = std::make_shared<AJ::io::WAV_File>();
+        file->mInfo.channels = 2;
+        file->mInfo.samplerate = 48000;
+        for (size_t ch = 0; ch < 2; ++ch) (*file->pAudio)[ch].assign(48000, 0.25f);
+        file->mInfo.length = 2 * 48000;
+
+        AJ::dsp::gain::Params good{ 0, 47999, 0.5f };
+        assert(engine.applyEffect(file, AJ::Effect::gain, AJ::dsp::gain::GainParams::create(good, handler), handler));
+
+        // a range past the end fails in the effect.
+        AJ::dsp::gain::Params past{ 0, 99999, 0.5f };
+        assert(!engine.applyEffect(file, AJ::Effect::gain, AJ::dsp::gain::GainParams::create(past, handler), handler));
+
+        const AJ::utils::MetricsSnapshot snapshot = resources->metricsSnapshot();
+        assert(snapshot[AJ::utils::Counter::EffectRuns] == 2);
+        assert(snapshot[AJ::utils::Counter::EffectFailures] == 1);
+        assert(snapshot[AJ::utils::Latency::Effect].count == 2 && snapshot[AJ::utils::Latency::Effect].max > 0);
+
+        // nothing recorded: the stereo pool isn't even created, then full with its queue empty.
+        assert(!resources->hasStreamBuffers(2) && snapshot.poolAvailable == 0 && snapshot.queueDepth == 0);
+        const size_t available = resources->bufferPoolStereo()->currentSize();
+        assert(available > 0 && resources->metricsSnapshot().poolAvailable == available);
+
+        std::cout << "  ✓ Runs, failures and time of applyEffect()\n";
+    }
+};
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "core/mpmc_queue.h"
+#include "core/error_handler.h"
+
+class MPMCQueueTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning MPMC Queue Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_fifo();
+        test_pool();
+        test_fan_in_fan_out();
+
+        std::cout << "All MPMC Queue Tests Completed Successfully.\n";
+    }
+
+private:
+    static void test_fifo() {
+        std::cout << "\nTest: One thread, in order, bounded\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::MPMCQueue queue(true, 6, 128, 2, handler);
+        assert(queue.isValid() && queue.queueSize() == 8 && queue.bufferFrameCapacity() == 128);
+
+        std::vector<AJ::utils::Buffer> buffers;
+        for (int i = 0; i < 9; ++i) buffers.emplace_back(nullptr, 256, 2);
+
+        // three laps around the cells.
+        for (int lap = 0; lap < 3; ++lap) {
+            for (int i = 0; i < 8; ++i) assert(queue.push(&buffers[i]));
+            assert(!queue.push(&buffers[8]) && queue.currentSize() == 8);
+
+            for (int i = 0; i < 8; ++i) assert(queue.pop() == &buffers[i]);
+            assert(!queue.pop() && queue.currentSize() == 0);
+        }
+
+        assert(!queue.push(nullptr));
+        assert(!handler.hasErrors());
+
+        std::cout << "  ✓ 3 laps of 8 cells\n";
+    }
+
+    static void test_pool() {
+        std::cout << "\nTest: An MPMC pool owns zeroed buffers\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::MPMCBufferPool pool(handler, 16, 256, 1);
+        assert(pool.isValid() && pool.capacity() == 16 && pool.currentSize() == 16);
+        assert(pool.bufferSize() == 256 && pool.channels() == 1);
+
+        std::vector<AJ::utils::Buffer*> taken;
+        while (AJ::utils::Buffer *buffer = pool.tryPop()) {
+            assert(buffer->data[0] == 0.0f && buffer->data[255] == 0.0f);
+            taken.push_back(buffer);
+        }
+        assert(taken.size() == 16);
+        assert(!pool.pop(handler) && handler.errors().back().first == AJ::error::Error::EmptyBufferQueue);
+
+        for (AJ::utils::Buffer *buffer : taken) assert(pool.push(buffer, handler));
+        assert(!pool.push(taken[0], handler) && handler.errors().back().first == AJ::error::Error::BufferOverflow);
+        assert(pool.currentSize() == 16);
+
+        std::cout << "  ✓ 16 buffers taken and given back\n";
+    }
+
+    static void test_fan_in_fan_out() {
+        std::cout << "\nTest: 4 producers, 3 consumers, one queue\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const size_t producers = 4, consumers = 3;
+        const uint64_t perProducer = 20000;
+
+        AJ::utils::MPMCBufferPool pool(handler, 64, 64, 1);
+        AJ::utils::MPMCQueue queue(true, 64, 64, 1, handler);
+
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> disorders{0};
+        std::vector<std::atomic<uint64_t>> sums(producers);
+        for (auto &sum : sums) sum = 0;
+
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (uint64_t sequence = 1; sequence <= perProducer; ++sequence) {
+                    AJ::utils::Buffer *buffer;
+                    while (!(buffer = pool.tryPop())) std::this_thread::yield();
+
+                    const uint64_t tag[2] = { p, sequence };
+                    std::memcpy(buffer->data, tag, sizeof(tag));
+                    while (!queue.push(buffer)) std::this_thread::yield();
+                }
+            });
+        }
+
+        for (size_t c = 0; c < consumers; ++c) {
+            threads.emplace_back([&] {
+                // what one consumer sees of a producer is still in its order.
+                std::vector<uint64_t> last(producers, 0);
+                while (received.load() < producers * perProducer) {
+                    AJ::utils::Buffer *buffer = queue.pop();
+                    if (!buffer) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    uint64_t tag[2];
+                    std::memcpy(tag, buffer->data, sizeof(tag));
+                    if (tag[1] <= last[tag[0]]) disorders.fetch_add(1);
+                    last[tag[0]] = tag[1];
+                    sums[tag[0]].fetch_add(tag[1]);
+
+                    pool.push(buffer, handler);
+                    received.fetch_add(1);
+                }
+            });
+        }
+
+        for (std::thread &thread : threads) thread.join();
+
+        assert(received == producers * perProducer && disorders == 0);
+        for (auto &sum : sums) assert(sum == perProducer * (perProducer + 1) / 2);   // each block exactly once
+        assert(pool.currentSize() == 64 && queue.currentSize() == 0);
+        assert(!handler.hasErrors());
+
+        std::cout << "  ✓ " << received << " blocks, none lost, duplicated or reordered\n";
+    }
+};
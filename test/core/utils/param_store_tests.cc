@@ -0,0 +1,177 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/param_store.h"
+#include "dsp/gain.h"
+#include "dsp/echo.h"
+#include "core/error_handler.h"
+
+class ParamStoreTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning ParamStore Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_latest_snapshot();
+        test_concurrent_snapshots();
+        test_smoother();
+        test_live_gain();
+        test_live_echo_decay();
+
+        std::cout << "All ParamStore Tests Completed Successfully.\n";
+    }
+
+private:
+    struct Pair {
+        uint64_t a;
+        uint64_t b;
+    };
+
+    static void test_latest_snapshot() {
+        std::cout << "\nTest: Reader gets the initial, then the latest published snapshot\n";
+
+        AJ::utils::ParamStore<Pair> store(Pair{ 1, 1 });
+        assert(store.acquire().a == 1);
+
+        store.publish(Pair{ 2, 2 });
+        store.publish(Pair{ 3, 3 });
+        assert(store.acquire().a == 3);
+        assert(store.acquire().a == 3);
+
+        store.publish(Pair{ 4, 4 });
+        assert(store.acquire().b == 4);
+
+        std::cout << "  ✓ Intermediate snapshots skipped, latest kept\n";
+    }
+
+    static void test_concurrent_snapshots() {
+        std::cout << "\nTest: Snapshots are never torn across threads\n";
+
+        AJ::utils::ParamStore<Pair> store(Pair{ 0, 0 });
+        const uint64_t count = 200000;
+        std::atomic<bool> done{false};
+
+        std::thread writer([&]() {
+            for (uint64_t n = 1; n <= count; ++n) {
+                store.publish(Pair{ n, ~n });
+            }
+            done.store(true, std::memory_order_release);
+        });
+
+        uint64_t last = 0;
+        while (true) {
+            const bool finished = done.load(std::memory_order_acquire);
+            const Pair &pair = store.acquire();
+
+            assert(pair.b == ~pair.a || (pair.a == 0 && pair.b == 0));
+            assert(pair.a >= last);
+            last = pair.a;
+
+            if (finished) break;
+        }
+        writer.join();
+        assert(last == count);
+
+        std::cout << "  ✓ Every snapshot complete, in order, the last one seen\n";
+    }
+
+    static void test_smoother() {
+        std::cout << "\nTest: Smoother ramps linearly and lands on the target\n";
+
+        AJ::utils::LinearSmoother smoother;
+        smoother.reset(1.0f);
+        smoother.setTarget(0.0f, 4);
+
+        assert(smoother.smoothing());
+        assert(std::fabs(smoother.next() - 0.75f) < 1e-6f);
+        assert(std::fabs(smoother.next() - 0.5f) < 1e-6f);
+        smoother.skip(1);
+        assert(smoother.next() == 0.0f);
+        assert(!smoother.smoothing() && smoother.next() == 0.0f);
+
+        smoother.setTarget(2.0f, 100);
+        smoother.skip(1000);
+        assert(!smoother.smoothing() && smoother.next() == 2.0f);
+
+        std::cout << "  ✓ Linear steps, exact target\n";
+    }
+
+    static void test_live_gain() {
+        std::cout << "\nTest: A live gain change ramps without a jump\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 4096;
+        AJ::dsp::gain::Params p{ 0, static_cast<AJ::sample_pos>(frames) - 1, 1.0f };
+
+        AJ::dsp::gain::Gain gain;
+        assert(gain.setParams(AJ::dsp::gain::GainParams::create(p, handler), handler));
+
+        auto live = std::make_shared<AJ::dsp::gain::LiveStore>(AJ::dsp::gain::LiveParams{ 0.5f });
+        gain.setLiveParams(live);
+
+        auto state = gain.createState(2, handler);
+        assert(state);
+
+        std::vector<float> block(256 * 2, 0.5f);
+        assert(gain.processBlock(block.data(), 256, 2, *state, handler));
+        assert(block[0] == 0.25f && block.back() == 0.25f);
+
+        // 0.5 -> 1.5, over kParamSmoothFrames frames spread across blocks.
+        live->publish(AJ::dsp::gain::LiveParams{ 1.5f });
+
+        std::vector<float> out;
+        for (size_t done = 256; done < frames; done += 256) {
+            std::fill(block.begin(), block.end(), 0.5f);
+            assert(gain.processBlock(block.data(), 256, 2, *state, handler));
+            out.insert(out.end(), block.begin(), block.end());
+        }
+
+        const float step = 0.5f * 1.0f / AJ::kParamSmoothFrames;
+        float previous = 0.25f;
+        for (size_t i = 0; i < out.size(); i += 2) {
+            assert(out[i] == out[i + 1]);
+            assert(out[i] >= previous && out[i] - previous <= step + 1e-6f);
+            previous = out[i];
+        }
+        assert(out.back() == 0.75f);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Steps of at most one ramp increment, target reached\n";
+    }
+
+    static void test_live_echo_decay() {
+        std::cout << "\nTest: A live echo decay change is picked up by the next block\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::dsp::echo::Params p{ 0, 100000, 0.5f, 0.001f, 10000 };
+
+        AJ::dsp::echo::Echo echo;
+        assert(echo.setParams(AJ::dsp::echo::EchoParams::create(p, handler), handler));
+
+        auto live = std::make_shared<AJ::dsp::echo::LiveStore>(AJ::dsp::echo::LiveParams{ 0.5f });
+        echo.setLiveParams(live);
+
+        auto state = echo.createState(1, handler);
+        assert(state);
+
+        // constant input, the echo adds decay * 0.25 once the delay (10 frames) is past.
+        std::vector<float> block(1024, 0.25f);
+        assert(echo.processBlock(block.data(), block.size(), 1, *state, handler));
+        assert(block[5] == 0.25f && block[100] == 0.25f + 0.5f * 0.25f);
+
+        live->publish(AJ::dsp::echo::LiveParams{ 0.0f });
+
+        std::fill(block.begin(), block.end(), 0.25f);
+        assert(echo.processBlock(block.data(), block.size(), 1, *state, handler));
+        assert(block[0] < 0.25f + 0.5f * 0.25f && block[0] > 0.25f);
+        assert(block[AJ::kParamSmoothFrames] == 0.25f && block.back() == 0.25f);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Decay ramped to the new value\n";
+    }
+};
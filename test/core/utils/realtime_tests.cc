@@ -0,0 +1,115 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "core/realtime.h"
+#include "core/memory.h"
+#include "core/error_handler.h"
+
+class RealtimeTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Realtime Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_denormals_flushed();
+        test_guard_reports();
+        test_guard_ignores_other_threads();
+
+        std::cout << "All Realtime Tests Completed Successfully.\n";
+    }
+
+private:
+    static void test_denormals_flushed() {
+        std::cout << "\nTest: Denormals are flushed inside a DenormalScope only\n";
+
+        volatile float tiny = std::numeric_limits<float>::min();   // smallest normal
+        volatile float half = 0.5f;
+
+        const float before = tiny * half;
+        assert(before > 0.0f);   // a denormal
+
+#if defined(AJ_DENORMALS_MXCSR) || defined(AJ_DENORMALS_FPCR)
+        {
+            AJ::utils::DenormalScope denormals;
+            const float flushed = tiny * half;
+            assert(flushed == 0.0f);
+        }
+        std::cout << "  ✓ " << before << " outside, 0 inside\n";
+#else
+        std::cout << "  - no flush-to-zero control on this architecture\n";
+#endif
+
+        const float after = tiny * half;
+        assert(after == before);
+    }
+
+    static void test_guard_reports() {
+        std::cout << "\nTest: Allocations, locks and sleeps in a RealtimeScope are reported\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const uint64_t before = AJ::utils::RealtimeGuard::violations();
+
+        std::mutex mux;
+        void *volatile data = nullptr;
+        {
+            AJ::utils::RealtimeGuard guard(handler);
+
+            std::thread([&] {
+                AJ::utils::RealtimeScope realtime;
+                data = std::malloc(64);
+                std::lock_guard<std::mutex> lock(mux);
+                std::this_thread::sleep_for(std::chrono::microseconds(1));
+            }).join();
+        }
+        std::free(data);
+
+        const uint64_t violations = AJ::utils::RealtimeGuard::violations() - before;
+
+        if (!AJ::utils::RealtimeGuard::enabled()) {
+            assert(violations == 0 && !handler.hasErrors());
+            std::cout << "  - guard disabled (build with AJ_REALTIME_GUARD), nothing reported\n";
+            return;
+        }
+
+        assert(violations >= 3 && handler.errors().size() == violations);
+
+        bool allocation = false, lock = false, sleep = false;
+        for (const auto &[err, message] : handler.errors()) {
+            assert(err == AJ::error::Error::RealtimeViolation);
+            assert(message.find("  #0 ") != std::string::npos);   // the stack
+
+            allocation |= message.find("allocation (malloc)") != std::string::npos;
+            lock |= message.find("lock (pthread_mutex_lock)") != std::string::npos;
+            sleep |= message.find("sleep") != std::string::npos;
+        }
+        assert(allocation && lock && sleep);
+
+        std::cout << "  ✓ " << violations << " violations reported with their stacks\n";
+    }
+
+    static void test_guard_ignores_other_threads() {
+        std::cout << "\nTest: Calls outside a RealtimeScope are not reported\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const uint64_t before = AJ::utils::RealtimeGuard::violations();
+        {
+            AJ::utils::RealtimeGuard guard(handler);
+
+            std::mutex mux;
+            std::lock_guard<std::mutex> lock(mux);
+            std::free(std::malloc(64));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        assert(AJ::utils::RealtimeGuard::violations() == before);
+        assert(!handler.hasErrors());
+
+        std::cout << "  ✓ Nothing reported\n";
+    }
+};
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/scratch_arena.h"
+#include "dsp/echo.h"
+#include "core/error_handler.h"
+
+class ScratchArenaTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Scratch Arena Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_alignment_and_rewind();
+        test_destructors();
+        test_steady_state();
+        test_pool_leases();
+
+        std::cout << "All Scratch Arena Tests Completed Successfully.\n";
+    }
+
+private:
+    static bool aligned(const void *p) {
+        return reinterpret_cast<uintptr_t>(p) % AJ::kBufferAlignment == 0;
+    }
+
+    static void test_alignment_and_rewind() {
+        std::cout << "\nTest: Arrays are aligned and released by scope\n";
+
+        AJ::utils::ScratchArena arena(4096);
+
+        {
+            AJ::utils::ScratchScope scope(arena);
+            assert(&AJ::utils::ScratchArena::current() == &arena);
+
+            float *a = arena.array<float>(3);
+            float *b = arena.array<float>(100);
+            assert(a && b && aligned(a) && aligned(b) && b >= a + 3);
+
+            {
+                AJ::utils::ScratchScope inner;
+                assert(&inner.arena() == &arena);
+
+                // bigger than a block: a block of its own.
+                float *big = arena.array<float>(10000);
+                assert(big && aligned(big));
+                big[9999] = 1.0f;
+            }
+
+            // the inner allocations are gone, the outer ones stay.
+            const size_t used = arena.used();
+            assert(arena.array<float>(1) != nullptr && arena.used() > used);
+        }
+
+        assert(&AJ::utils::ScratchArena::current() != &arena);
+        assert(arena.used() == 0);
+
+        std::cout << "  ✓ Aligned, nested scopes rewind\n";
+    }
+
+    static void test_destructors() {
+        std::cout << "\nTest: Created objects are destroyed on rewind\n";
+
+        AJ::utils::ScratchArena arena;
+        auto counter = std::make_shared<int>(0);
+
+        struct Tracked {
+            std::shared_ptr<int> count;
+            explicit Tracked(std::shared_ptr<int> c) : count(std::move(c)) { ++*count; }
+            ~Tracked() { --*count; }
+        };
+
+        const auto marker = arena.mark();
+        for (int i = 0; i < 10; ++i) {
+            assert(arena.create<Tracked>(counter));
+        }
+        assert(*counter == 10);
+
+        arena.rewind(marker);
+        assert(*counter == 0);
+
+        assert(arena.create<Tracked>(counter));
+        arena.reset();
+        assert(*counter == 0);
+
+        std::cout << "  ✓ Destructors run in rewind and reset\n";
+    }
+
+    static void test_steady_state() {
+        std::cout << "\nTest: Repeated processing stops allocating\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ScratchArena arena(1024);
+
+        AJ::dsp::echo::Params params{ 0, 199999, 0.5f, 0.1f, 44100 };
+        auto echoParams = AJ::dsp::echo::EchoParams::create(params, handler);
+        AJ::dsp::echo::Echo echo;
+        assert(echoParams && echo.setParams(echoParams, handler));
+
+        AJ::Float signal(200000);
+        for (size_t i = 0; i < signal.size(); ++i) signal[i] = 0.3f * std::sin(0.01f * i);
+
+        uint64_t warm = 0;
+        for (int run = 0; run < 5; ++run) {
+            {
+                AJ::utils::ScratchScope scope(arena);
+                assert(echo.process(signal, handler));
+
+                // a later temporary reuses the memory the echo released.
+                const size_t capacity = arena.capacity();
+                assert(scope.arena().array<float>(50000));
+                assert(arena.capacity() == capacity);
+            }
+            arena.reset();
+
+            if (run == 1) warm = arena.blockAllocations();
+            if (run > 1) assert(arena.blockAllocations() == warm);
+        }
+
+        assert(arena.capacity() >= 200000 * sizeof(float));
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ No block allocated after the first runs\n";
+    }
+
+    static void test_pool_leases() {
+        std::cout << "\nTest: Concurrent leases get their own arenas\n";
+
+        AJ::utils::ScratchPool pool;
+
+        {
+            AJ::utils::ScratchPool::Lease a(pool);
+            AJ::utils::ScratchPool::Lease b(pool);
+            assert(&a.arena() != &b.arena());
+            assert(&AJ::utils::ScratchArena::current() == &b.arena());
+        }
+        assert(pool.idle() == 2);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&pool] {
+                for (int i = 0; i < 200; ++i) {
+                    AJ::utils::ScratchPool::Lease lease(pool);
+                    float *data = AJ::utils::ScratchArena::current().array<float>(4096);
+                    assert(data);
+                    for (size_t j = 0; j < 4096; ++j) data[j] = static_cast<float>(j);
+                    assert(data[4095] == 4095.0f);
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+
+        // at most one arena per concurrent lease.
+        assert(pool.idle() >= 2 && pool.idle() <= 4);
+
+        pool.trim();
+        assert(pool.idle() == 0);
+
+        std::cout << "  ✓ Arenas are reused and never shared\n";
+    }
+};
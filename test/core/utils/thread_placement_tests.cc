@@ -0,0 +1,105 @@
+#include <iostream>
+#include <cassert>
+#include <future>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "core/thread_placement.h"
+#include "core/thread_pool.h"
+#include "core/engine_resources.h"
+#include "core/buffer_pool.h"
+#include "core/error_handler.h"
+
+class ThreadPlacementTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Thread Placement Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_topology();
+        test_pinned_pool();
+        test_bad_cores();
+        test_engine_roles();
+
+        std::cout << "All Thread Placement Tests Completed Successfully.\n";
+    }
+
+private:
+    static void test_topology() {
+        std::cout << "\nTest: NUMA nodes and their cores\n";
+
+        const int nodes = AJ::utils::numaNodes();
+        assert(nodes >= 1);
+
+#if defined(__linux__)
+        const std::vector<int> cores = AJ::utils::numaNodeCores(0);
+        assert(cores.empty() || AJ::utils::numaNodeOfCore(cores.front()) == 0);
+        assert(AJ::utils::numaNodeOfCore(0) >= 0);
+#endif
+        assert(AJ::utils::numaNodeOfCore(-1) == -1);
+        assert(AJ::utils::ThreadPlacement().node() == -1);
+        assert(AJ::utils::ThreadPlacement().onNode(0).node() == 0);
+        assert(AJ::utils::ThreadPlacement().isDefault());
+
+        std::cout << "  ✓ " << nodes << " node(s)\n";
+    }
+
+    static void test_pinned_pool() {
+        std::cout << "\nTest: Pool workers run on their cores\n";
+
+#if defined(__linux__)
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ThreadPool pool(2, AJ::utils::ThreadPlacement().onCores({0}), handler);
+        assert(pool.placed() && !handler.hasErrors());
+
+        std::vector<std::future<int>> cpus;
+        for (int i = 0; i < 8; ++i) cpus.push_back(pool.enqueue([] { return sched_getcpu(); }));
+        for (std::future<int> &cpu : cpus) assert(cpu.get() == 0);
+
+        std::cout << "  ✓ 8 tasks on core 0\n";
+#else
+        std::cout << "  ✓ Skipped outside Linux\n";
+#endif
+    }
+
+    static void test_bad_cores() {
+        std::cout << "\nTest: Cores the host doesn't have\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ThreadPool pool(2, AJ::utils::ThreadPlacement().onCores({1 << 20}), handler);
+        assert(!pool.placed());
+        assert(handler.errors().size() == 2);
+
+        // the workers run anyway.
+        assert(pool.enqueue([] { return 7; }).get() == 7);
+
+        std::cout << "  ✓ Reported once per worker, the pool still works\n";
+    }
+
+    static void test_engine_roles() {
+        std::cout << "\nTest: EngineResources places each role\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::EngineResources resources(handler, AJ::EngineResources::Config()
+            .dspThreads(2).dspPlacement(AJ::utils::ThreadPlacement().onCores({0}))
+            .diskPlacement(AJ::utils::ThreadPlacement().onNode(0))
+            .monoStream(16, 256));
+
+        assert(resources.threadPool()->placed());
+        assert(resources.diskWriters()->placed());
+
+        // the record pool lives on the disk writers' node, its buffers work as usual.
+        std::shared_ptr<AJ::utils::BufferPool> pool = resources.bufferPoolMono();
+        assert(pool->currentSize() == 16);
+        AJ::utils::Buffer *buffer = pool->tryPop();
+        assert(buffer && buffer->data[0] == 0.0f);
+        assert(pool->push(buffer, handler));
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ DSP pinned, disk writers and record pool on node 0\n";
+    }
+};
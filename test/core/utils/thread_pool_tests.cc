@@ -2,6 +2,8 @@
 #include <atomic>
 #include <chrono>
 #include <iostream>
+#include <future>
+#include <numeric>
 #include <thread>
 #include <vector>
 #include "core/thread_pool.h"
@@ -16,8 +18,10 @@ public:
         test_threadpool_basic();
         test_threadpool_parallelism();
         test_threadpool_available();
+        test_threadpool_futures();
+        test_threadpool_parallel_for();
     
-        std::cout << "All RingBuffer Tests Completed Successfully.\n";
+        std::cout << "All ThreadPool Tests Completed Successfully.\n";
     }
 
     static void test_threadpool_basic() {
@@ -117,5 +121,68 @@ public:
         std::cout << "------------------------------------------------------------------\n";
     }
 
-};
+    static void test_threadpool_futures() {
+        std::cout << "\nTest: ThreadPool Futures\n";
+        std::cout << "------------------------------------------------------------------\n";
+
+        AJ::utils::ThreadPool pool(4);
+
+        std::vector<std::future<int>> results;
+        for (int i = 0; i < 100; ++i) {
+            results.push_back(pool.enqueue([i] { return i * i; }));
+        }
+
+        int sum = 0;
+        for (auto& f : results) {
+            sum += f.get();
+        }
+
+        // sum of i^2 for i in [0, 99]
+        std::cout << "Sum of squares: " << sum << "\n";
+        assert(sum == 328350);
+
+        //* nested enqueue from inside a worker (goes to the worker's own deque).
+        std::future<int> nested = pool.enqueue([&pool] {
+            std::atomic<int> inner{0};
+            pool.parallel_for(0, 64, 1, [&](size_t b, size_t e) {
+                inner.fetch_add(static_cast<int>(e - b));
+            });
+            return inner.load();
+        });
+        assert(nested.get() == 64);
+
+        std::cout << "  ✓ Futures and nested tasks validated\n";
+        std::cout << "------------------------------------------------------------------\n";
+    }
 
+    static void test_threadpool_parallel_for() {
+        std::cout << "\nTest: ThreadPool parallel_for\n";
+        std::cout << "------------------------------------------------------------------\n";
+
+        AJ::utils::ThreadPool pool(4);
+
+        const size_t n = 1 << 20;
+        std::vector<float> data(n, 1.0f);
+
+        pool.parallel_for(0, n, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                data[i] *= 2.0f;
+            }
+        });
+
+        double total = std::accumulate(data.begin(), data.end(), 0.0);
+        std::cout << "Total after parallel_for: " << total << "\n";
+        assert(total == 2.0 * n);
+
+        //* uneven range: last chunk is smaller than the grain.
+        std::atomic<size_t> visited{0};
+        pool.parallel_for(3, 1003, 64, [&](size_t begin, size_t end) {
+            visited.fetch_add(end - begin);
+        });
+        assert(visited == 1000);
+
+        std::cout << "  ✓ parallel_for validated\n";
+        std::cout << "------------------------------------------------------------------\n";
+    }
+
+};
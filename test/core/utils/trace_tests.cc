@@ -0,0 +1,132 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/trace.h"
+#include "core/error_handler.h"
+
+class TraceTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Trace Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_zones_of_threads();
+        test_chrome_json();
+        test_full_ring();
+        test_unwritable_path();
+
+        std::cout << "All Trace Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::string temp_path(const std::string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    static std::string read_file(const std::string &path) {
+        std::ifstream in(path);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    static size_t occurrences(const std::string &text, const std::string &pattern) {
+        size_t count = 0;
+        for (size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1)) ++count;
+        return count;
+    }
+
+    static void test_zones_of_threads() {
+        std::cout << "\nTest: Zones are recorded only while recording, on every thread\n";
+
+        AJ::utils::trace::start();
+        assert(AJ::utils::trace::recording() && AJ::utils::trace::recorded() == 0);
+
+        const size_t threads = 4, zones = 100;
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([zones] {
+                for (size_t i = 0; i < zones; ++i) {
+                    AJ::utils::trace::Zone zone("test", "zone");
+                }
+            });
+        }
+        for (std::thread &worker : workers) worker.join();
+
+        AJ::utils::trace::stop();
+        { AJ::utils::trace::Zone ignored("test", "after_stop"); }
+
+        assert(!AJ::utils::trace::recording());
+        assert(AJ::utils::trace::recorded() == threads * zones);
+        assert(AJ::utils::trace::overwritten() == 0);
+
+        std::cout << "  ✓ " << threads * zones << " zones of " << threads << " finished threads\n";
+    }
+
+    static void test_chrome_json() {
+        std::cout << "\nTest: The trace is Chrome JSON, one track per thread\n";
+
+        AJ::utils::trace::start();
+        std::thread other([] { AJ::utils::trace::Zone zone("io", "block_write"); });
+        other.join();
+        {
+            AJ::utils::trace::Zone outer("effect", "outer");
+            AJ::utils::trace::Zone inner("effect", "inner");
+        }
+        AJ::utils::trace::stop();
+
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = temp_path("aj_trace_test.json");
+        assert(AJ::utils::trace::write(path, handler) && !handler.hasErrors());
+
+        const std::string json = read_file(path);
+        assert(json.rfind("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", 0) == 0);
+        assert(json.find("\n]}\n") == json.size() - 4);
+        assert(occurrences(json, "\"ph\": \"M\"") == 2);
+        assert(occurrences(json, "\"ph\": \"X\"") == 3);
+        assert(json.find("{\"name\": \"block_write\", \"cat\": \"io\", \"ph\": \"X\"") != std::string::npos);
+        assert(json.find("{\"name\": \"inner\", \"cat\": \"effect\"") != std::string::npos);
+        assert(json.find("\"ts\": -") == std::string::npos);
+
+        std::filesystem::remove(path);
+        std::cout << "  ✓ Metadata and complete events of 2 threads\n";
+    }
+
+    static void test_full_ring() {
+        std::cout << "\nTest: A full ring keeps the newest events\n";
+
+        AJ::utils::trace::start();
+        const uint64_t base = AJ::utils::trace::now();
+        for (uint64_t i = 0; i < AJ::kTraceThreadEvents + 10; ++i) {
+            AJ::utils::trace::record("test", "event", base + i, base + i + 1);
+        }
+        AJ::utils::trace::stop();
+
+        assert(AJ::utils::trace::recorded() == AJ::kTraceThreadEvents + 10);
+        assert(AJ::utils::trace::overwritten() == 10);
+
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = temp_path("aj_trace_full_test.json");
+        assert(AJ::utils::trace::write(path, handler));
+        assert(occurrences(read_file(path), "\"ph\": \"X\"") == AJ::kTraceThreadEvents);
+
+        std::filesystem::remove(path);
+        std::cout << "  ✓ " << AJ::kTraceThreadEvents << " events kept, 10 overwritten\n";
+    }
+
+    static void test_unwritable_path() {
+        std::cout << "\nTest: An unwritable path is reported\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        assert(!AJ::utils::trace::write(temp_path("aj_missing_dir/trace.json"), handler));
+        assert(handler.errors().size() == 1 && handler.errors()[0].first == AJ::error::Error::FileOpenError);
+
+        std::cout << "  ✓ FileOpenError\n";
+    }
+};
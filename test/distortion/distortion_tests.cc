@@ -3,6 +3,7 @@
 #include <cassert>
 #include <filesystem>
 #include <cmath>
+#include <algorithm>
 
 #include "dsp/distortion.h"
 #include "file_io/wav_file.h"
@@ -23,11 +24,74 @@ public:
         test_distortion_on_valid_file("guitar_short.wav", 2, "full", 4.0f, AJ::dsp::distortion::DistortionType::SoftClipping);
 
         test_distortion_with_invalid_indexes("test_32bit_int_stereo.wav", 2);
+        test_distortion_precisions_and_curves();
 
         std::cout << "All Distortion Tests Completed Successfully.\n";
     }
 
 private:
+    static void test_distortion_precisions_and_curves() {
+        using namespace AJ;
+        using namespace AJ::dsp::distortion;
+
+        std::cout << "\nTest: Distortion precisions and curves on a synthetic signal\n";
+
+        error::ConsoleErrorHandler errorHandler;
+
+        const sample_pos frames = 4801;
+        Float input(frames);
+        for (sample_pos i = 0; i < frames; ++i) {
+            input[i] = std::sin(0.01f * i);
+        }
+
+        auto run = [&](DistortionType type, DistortionPrecision precision) {
+            Params distParams;
+            distParams.mStart = 0;
+            distParams.mEnd = frames - 1;
+            distParams.mGain = 5.0f;
+            distParams.mType = type;
+            distParams.mPrecision = precision;
+
+            auto params = DistortionParams::create(distParams, errorHandler);
+            assert(params);
+
+            AJ::dsp::distortion::Distortion dist;
+            assert(dist.setParams(params, errorHandler));
+
+            Float out = input;
+            assert(dist.process(out, errorHandler));
+            return out;
+        };
+
+        //* vectorized tanh stays close to std::tanh, full scale stays at full scale.
+        Float exact = run(DistortionType::SoftClipping, DistortionPrecision::Exact);
+        Float accurate = run(DistortionType::SoftClipping, DistortionPrecision::Accurate);
+        Float fast = run(DistortionType::SoftClipping, DistortionPrecision::Fast);
+
+        for (sample_pos i = 0; i < frames; ++i) {
+            assert(std::fabs(exact[i] - accurate[i]) < 2e-4f);
+            assert(std::fabs(exact[i] - fast[i]) < 5e-2f);
+            assert(std::fabs(accurate[i]) <= 1.0f + 1e-6f);
+        }
+
+        Float hard = run(DistortionType::HardClipping, DistortionPrecision::Accurate);
+        Float cubic = run(DistortionType::Cubic, DistortionPrecision::Accurate);
+        Float asym = run(DistortionType::Asymmetric, DistortionPrecision::Exact);
+        Float asymFast = run(DistortionType::Asymmetric, DistortionPrecision::Accurate);
+
+        for (sample_pos i = 0; i < frames; ++i) {
+            assert(std::fabs(hard[i] - std::clamp(5.0f * input[i], -1.0f, 1.0f)) < 1e-6f);
+            assert(std::fabs(cubic[i]) <= 1.0f);
+            assert(std::fabs(asym[i] - asymFast[i]) < 2e-4f);
+
+            //* positive half-wave is the plain soft clip, the negative one is driven harder.
+            if (input[i] >= 0.0f) assert(std::fabs(asym[i] - exact[i]) < 1e-6f);
+            else assert(asym[i] <= exact[i] + 1e-6f);
+        }
+
+        std::cout << "  ✓ Accurate/Fast tanh within bounds, curves behave as expected.\n";
+    }
+
     static constexpr const char* audio_dir  = "/home/aj-e/Programming Codes/C++/AJ-Audio-Engine/build/build/bin/audio";
     static constexpr const char* output_dir = "/home/aj-e/Programming Codes/C++/AJ-Audio-Engine/build/build/bin/dist_audio";
 
@@ -35,6 +99,9 @@ private:
         using AJ::dsp::distortion::DistortionType;
         switch (t) {
             case DistortionType::SoftClipping: return "softclip";
+            case DistortionType::HardClipping: return "hardclip";
+            case DistortionType::Cubic: return "cubic";
+            case DistortionType::Asymmetric: return "asymmetric";
             default: return "unknown";
         }
     }
@@ -0,0 +1,238 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dsp/dynamics/dynamics.h"
+#include "core/error_handler.h"
+
+class DynamicsTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Dynamics Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_limiter_holds_ceiling();
+        test_quiet_signal_untouched();
+        test_compressor_curve();
+        test_blocks_match_process();
+        test_linked_channels();
+        test_invalid_params();
+
+        std::cout << "All Dynamics Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::dsp::dynamics::Params limiter_params(AJ::sample_pos start, AJ::sample_pos end, float ceilingDb) {
+        return { start, end, 48000, 0.0f, 1.0f, 0.0f, 1.0f, 50.0f, 0.0f, ceilingDb, 5.0f };
+    }
+
+    static std::shared_ptr<AJ::dsp::dynamics::DynamicsParams> make_params(AJ::dsp::dynamics::Params params,
+        AJ::error::IErrorHandler &handler) {
+        return AJ::dsp::dynamics::DynamicsParams::create(params, handler);
+    }
+
+    // a 0.5 sine with short bursts up to 2.0.
+    static AJ::Float make_spiky(size_t frames) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = 0.5f * std::sin(0.03f * i);
+            if (i % 9000 > 8000) signal[i] *= 1.0f + 3.0f * std::fabs(std::sin(0.002f * i));
+        }
+        return signal;
+    }
+
+    static void test_limiter_holds_ceiling() {
+        std::cout << "\nTest: The limiter keeps every sample under the ceiling, latency compensated\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 60000;
+        const AJ::Float input = make_spiky(frames);
+        AJ::Float output = input;
+
+        AJ::dsp::dynamics::Dynamics dynamics;
+        assert(dynamics.setParams(make_params(limiter_params(0, frames - 1, -3.0f), handler), handler));
+        assert(dynamics.process(output, handler));
+
+        const float ceiling = std::pow(10.0f, -3.0f / 20.0f);
+        for (float sample : output) assert(std::fabs(sample) <= ceiling * (1.0f + 1e-6f));
+
+        //* before the first burst (minus the lookahead) nothing changes, and the output isn't delayed.
+        for (size_t i = 0; i < 8000 - 240; ++i) assert(output[i] == input[i]);
+
+        //* the bursts are held at the ceiling, not squashed under it.
+        const float burst = *std::max_element(output.begin() + 8000, output.begin() + 9000);
+        assert(burst > 0.95f * ceiling);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Peaks under " << ceiling << ", untouched before the first burst\n";
+    }
+
+    static void test_quiet_signal_untouched() {
+        std::cout << "\nTest: Without compression a signal under the ceiling passes unchanged\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::Float signal(10000);
+        for (size_t i = 0; i < signal.size(); ++i) signal[i] = 0.7f * std::sin(0.011f * i);
+        AJ::Float output = signal;
+
+        AJ::dsp::dynamics::Dynamics dynamics;
+        assert(dynamics.setParams(make_params(limiter_params(100, 9000, -1.0f), handler), handler));
+        assert(dynamics.process(output, handler));
+        assert(output == signal);
+
+        std::cout << "  ✓ Bit-exact\n";
+    }
+
+    static void test_compressor_curve() {
+        std::cout << "\nTest: Settled levels follow the ratio and the soft knee\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::dsp::dynamics::Dynamics dynamics;
+        auto settle = [&](float level, float kneeDb) {
+            AJ::Float dc(20000, level);
+            AJ::dsp::dynamics::Params params{ 0, 19999, 48000, -20.0f, 4.0f, kneeDb, 1.0f, 20.0f, 0.0f, 0.0f, 1.0f };
+            assert(dynamics.setParams(make_params(params, handler), handler));
+            assert(dynamics.process(dc, handler));
+            return dc[15000];
+        };
+
+        //* 0.5 is 13.98 dB over the threshold, 4:1 takes 10.49 dB off.
+        const float over = 20.0f * std::log10(0.5f) + 20.0f;
+        assert(std::fabs(settle(0.5f, 0.0f) - 0.5f * std::pow(10.0f, -0.75f * over / 20.0f)) < 1e-4f);
+
+        //* at the threshold a 12 dB knee already takes 0.75 · 6² / 24 = 1.125 dB off, a hard knee nothing.
+        assert(std::fabs(settle(0.1f, 12.0f) - 0.1f * std::pow(10.0f, -1.125f / 20.0f)) < 1e-5f);
+        assert(std::fabs(settle(0.1f, 0.0f) - 0.1f) < 1e-5f);
+        assert(std::fabs(settle(0.05f, 0.0f) - 0.05f) < 1e-7f);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Ratio and knee\n";
+    }
+
+    static void test_blocks_match_process() {
+        std::cout << "\nTest: Streamed blocks of any size match process(), delayed by the lookahead\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 40000;
+        const AJ::Float mono = make_spiky(frames);
+
+        AJ::dsp::dynamics::Params params{ 0, frames - 1, 44100, -18.0f, 3.0f, 6.0f, 5.0f, 100.0f, 4.0f, -0.5f, 2.0f };
+        auto dynamicsParams = make_params(params, handler);
+        const size_t latency = dynamicsParams->Latency();
+        assert(latency == 88);
+
+        AJ::dsp::dynamics::Dynamics dynamics;
+        assert(dynamics.setParams(dynamicsParams, handler));
+
+        AJ::Float expected = mono;
+        assert(dynamics.process(expected, handler));
+
+        std::vector<float> stereo(2 * frames);
+        for (size_t i = 0; i < frames; ++i) stereo[2 * i] = stereo[2 * i + 1] = mono[i];
+
+        auto state = dynamics.createState(2, handler);
+        assert(state);
+
+        size_t position = 0, size = 1;
+        while (position < frames) {
+            const size_t n = std::min(size, frames - position);
+            assert(dynamics.processBlock(stereo.data() + 2 * position, n, 2, *state, handler));
+            position += n;
+            size = size * 3 % 997 + 1;
+        }
+
+        for (size_t i = 0; i < latency; ++i) assert(stereo[2 * i] == 0.0f);
+        for (size_t i = latency; i < frames; ++i) {
+            assert(stereo[2 * i] == expected[i - latency]);
+            assert(stereo[2 * i + 1] == stereo[2 * i]);
+        }
+
+        //* a state of other parameters is rejected.
+        assert(dynamics.setParams(make_params(params, handler), handler));
+        assert(!dynamics.processBlock(stereo.data(), 1, 2, *state, handler));
+        assert(handler.errors().size() == 1);
+
+        std::cout << "  ✓ Same samples, " << latency << " frames late\n";
+    }
+
+    static void test_linked_channels() {
+        std::cout << "\nTest: Stereo buffers are limited with one gain for both channels\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 30000;
+        AJ::dsp::dynamics::Dynamics dynamics;
+        assert(dynamics.linksChannels());
+        assert(dynamics.setParams(make_params(limiter_params(0, frames - 1, -3.0f), handler), handler));
+
+        //* the bursts are in the left channel only, the right one is a quiet tone.
+        AJ::AudioBuffer audio;
+        audio[0] = make_spiky(frames);
+        audio[1].resize(frames);
+        for (size_t i = 0; i < frames; ++i) audio[1][i] = 0.2f * std::sin(0.01f * i);
+
+        AJ::AudioBuffer linked = audio;
+        assert(dynamics.process(linked, 2, handler));
+
+        const float ceiling = std::pow(10.0f, -3.0f / 20.0f);
+        bool ducked = false;
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(linked[0][i]) <= ceiling * (1.0f + 1e-6f));
+            //* same gain: the right channel is turned down with the left bursts.
+            if (std::fabs(audio[0][i]) > 0.01f && std::fabs(audio[1][i]) > 0.01f) {
+                const float left = linked[0][i] / audio[0][i], right = linked[1][i] / audio[1][i];
+                assert(std::fabs(left - right) < 1e-4f);
+                ducked = ducked || right < 0.9f;
+            }
+        }
+        assert(ducked);
+
+        //* the same signal in both channels is limited as a mono one.
+        AJ::AudioBuffer dual;
+        dual[0] = dual[1] = audio[0];
+        AJ::Float mono = audio[0];
+        assert(dynamics.process(dual, 2, handler));
+        assert(dynamics.process(mono, handler));
+        assert(dual[0] == mono && dual[1] == mono);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Linked gain, peaks under " << ceiling << "\n";
+    }
+
+    static void test_invalid_params() {
+        std::cout << "\nTest: Invalid parameters are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto with = [](auto change) {
+            AJ::dsp::dynamics::Params params = limiter_params(0, 99, -1.0f);
+            change(params);
+            return params;
+        };
+
+        assert(make_params(limiter_params(0, 99, -1.0f), handler));
+        assert(!make_params(limiter_params(10, 5, -1.0f), handler));
+        assert(!make_params(limiter_params(0, 99, 1.0f), handler));
+        assert(!make_params(with([](auto &p) { p.mSamplerate = 1000; }), handler));
+        assert(!make_params(with([](auto &p) { p.mThresholdDb = -80.0f; }), handler));
+        assert(!make_params(with([](auto &p) { p.mRatio = 0.5f; }), handler));
+        assert(!make_params(with([](auto &p) { p.mKneeDb = NAN; }), handler));
+        assert(!make_params(with([](auto &p) { p.mAttackMs = -1.0f; }), handler));
+        assert(!make_params(with([](auto &p) { p.mLookaheadMs = 0.0f; }), handler));
+        assert(!make_params(with([](auto &p) { p.mLookaheadMs = 50.0f; }), handler));
+        assert(handler.errors().size() == 9);
+
+        AJ::dsp::dynamics::Dynamics dynamics;
+        AJ::Float buffer(50, 0.1f);
+        handler.clear();
+        assert(!dynamics.process(buffer, handler));
+        assert(!dynamics.createState(1, handler));
+        assert(dynamics.setParams(make_params(limiter_params(0, 99, -1.0f), handler), handler));
+        assert(!dynamics.process(buffer, handler));
+        assert(!dynamics.createState(3, handler));
+        assert(handler.errors().size() == 4);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
@@ -0,0 +1,192 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dsp/dynamics/gate.h"
+#include "core/error_handler.h"
+
+class GateTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Gate Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_gate_closes_on_noise();
+        test_envelope_matches_reference();
+        test_blocks_match_process();
+        test_linked_channels();
+        test_invalid_params();
+
+        std::cout << "All Gate Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::dsp::gate::Params gate_params(AJ::sample_pos start, AJ::sample_pos end, float attackMs,
+        float holdMs, float releaseMs) {
+        return { start, end, 48000, -30.0f, -60.0f, attackMs, holdMs, releaseMs };
+    }
+
+    static std::shared_ptr<AJ::dsp::gate::GateParams> make_params(AJ::dsp::gate::Params params,
+        AJ::error::IErrorHandler &handler) {
+        return AJ::dsp::gate::GateParams::create(params, handler);
+    }
+
+    // bursts of a 0.5 sine separated by -50 dB noise.
+    static AJ::Float make_bursts(size_t frames) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            const bool burst = i % 20000 < 8000;
+            signal[i] = burst ? 0.5f * std::sin(0.05f * i) : 0.003f * std::sin(1.7f * i);
+        }
+        return signal;
+    }
+
+    //* the envelope a frame at a time, what the glides must reproduce.
+    static AJ::Float reference(const AJ::Float &input, const AJ::dsp::gate::Settings &s) {
+        AJ::Float output = input;
+        float gain = s.mFloor;
+        bool open = false;
+        size_t hold = 0;
+
+        for (size_t i = 0; i < input.size(); ++i) {
+            const float peak = std::fabs(input[i]);
+            if (peak >= (open ? s.mClose : s.mOpen)) {
+                open = true;
+                hold = s.mHold;
+            } else if (open && hold > 0) {
+                --hold;
+            } else {
+                open = false;
+            }
+
+            const float target = open ? 1.0f : s.mFloor;
+            gain = target + (target > gain ? s.mAttack : s.mRelease) * (gain - target);
+            output[i] *= gain;
+        }
+        return output;
+    }
+
+    static void test_gate_closes_on_noise() {
+        std::cout << "\nTest: The gate passes the bursts and pushes the noise down by the range\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const AJ::Float input = make_bursts(60000);
+        AJ::Float output = input;
+
+        AJ::dsp::gate::Gate gate;
+        assert(gate.setParams(make_params(gate_params(0, 59999, 1.0f, 20.0f, 10.0f), handler), handler));
+        assert(gate.process(output, handler));
+
+        //* well inside a burst: unchanged. Well inside the noise (after hold and release): at the floor.
+        for (size_t i = 1000; i < 8000; ++i) assert(std::fabs(output[i] - input[i]) < 1e-4f);
+        const float floor = std::pow(10.0f, -60.0f / 20.0f);
+        for (size_t i = 16000; i < 20000; ++i) assert(std::fabs(output[i]) <= std::fabs(input[i]) * floor * 1.01f);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Bursts kept, noise at -60 dB\n";
+    }
+
+    static void test_envelope_matches_reference() {
+        std::cout << "\nTest: The vectorized attack / release follows the per-frame one-pole envelope\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const AJ::Float input = make_bursts(70000);
+
+        for (float attack : { 0.0f, 2.0f, 30.0f }) {
+            auto params = make_params(gate_params(0, 69999, attack, 5.0f, 40.0f), handler);
+            const AJ::Float expected = reference(input, params->Setup());
+
+            AJ::Float output = input;
+            AJ::dsp::gate::Gate gate;
+            assert(gate.setParams(params, handler));
+            assert(gate.process(output, handler));
+
+            for (size_t i = 0; i < input.size(); ++i) {
+                assert(std::fabs(output[i] - expected[i]) <= 1e-4f);
+            }
+        }
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Within 1e-4 for attacks of 0, 2 and 30 ms\n";
+    }
+
+    static void test_blocks_match_process() {
+        std::cout << "\nTest: Block processing in odd sized blocks matches process()\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const AJ::Float input = make_bursts(50000);
+        auto params = make_params(gate_params(3000, 45000, 3.0f, 10.0f, 25.0f), handler);
+
+        AJ::Float whole = input;
+        AJ::dsp::gate::Gate gate;
+        assert(gate.setParams(params, handler));
+        assert(gate.process(whole, handler));
+
+        AJ::Float blocks = input;
+        auto state = gate.createState(1, handler);
+        assert(state);
+        for (size_t pos = 0; pos < blocks.size(); ) {
+            const size_t n = std::min<size_t>(777, blocks.size() - pos);
+            assert(gate.processBlock(blocks.data() + pos, n, 1, *state, handler));
+            pos += n;
+        }
+
+        //* the chunks split the glides elsewhere: the same envelope up to rounding.
+        for (size_t i = 0; i < input.size(); ++i) assert(std::fabs(blocks[i] - whole[i]) <= 1e-5f);
+        for (size_t i = 0; i < 3000; ++i) assert(blocks[i] == input[i]);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Same output, frames outside the range untouched\n";
+    }
+
+    static void test_linked_channels() {
+        std::cout << "\nTest: A loud channel keeps the gate open on the quiet one\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::AudioBuffer audio{ AJ::Float(30000), AJ::Float(30000) };
+        for (size_t i = 0; i < 30000; ++i) {
+            audio[0][i] = 0.5f * std::sin(0.02f * i);
+            audio[1][i] = 0.002f * std::sin(0.3f * i);
+        }
+        const AJ::Float quiet = audio[1];
+
+        AJ::dsp::gate::Gate gate;
+        assert(gate.setParams(make_params(gate_params(0, 29999, 0.0f, 50.0f, 10.0f), handler), handler));
+        assert(gate.process(audio, 2, handler));
+
+        for (size_t i = 1000; i < 30000; ++i) assert(std::fabs(audio[1][i] - quiet[i]) < 1e-6f);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Quiet channel unchanged\n";
+    }
+
+    static void test_invalid_params() {
+        std::cout << "\nTest: Out of range parameters are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto params = gate_params(0, 100, 1.0f, 10.0f, 10.0f);
+        params.mThresholdDb = 3.0f;
+        assert(!make_params(params, handler));
+
+        params = gate_params(0, 100, 1.0f, 10.0f, 10.0f);
+        params.mRangeDb = -200.0f;
+        assert(!make_params(params, handler));
+
+        assert(!make_params(gate_params(0, 100, -1.0f, 10.0f, 10.0f), handler));
+        assert(!make_params(gate_params(0, 100, 1.0f, NAN, 10.0f), handler));
+        assert(!make_params(gate_params(50, 10, 1.0f, 10.0f, 10.0f), handler));
+        assert(handler.errors().size() == 5);
+
+        AJ::dsp::gate::Gate gate;
+        AJ::Float buffer(10);
+        assert(!gate.process(buffer, handler));
+        assert(gate.setParams(make_params(gate_params(0, 100, 1.0f, 10.0f, 10.0f), handler), handler));
+        assert(!gate.process(buffer, handler));
+        assert(handler.errors().size() == 7);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
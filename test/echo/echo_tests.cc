@@ -4,6 +4,8 @@
 #include <filesystem>
 #include <cmath>
 
+#include <vector>
+
 #include "dsp/echo.h"
 #include "file_io/wav_file.h"
 #include "core/error_handler.h"
@@ -21,11 +23,66 @@ public:
         test_echo_on_valid_file("test_32bit_float_mono.wav", 1, "partial");
         test_echo_with_invalid_indexes("test_32bit_int_stereo.wav", 2);
         test_echo_on_valid_file("test_64bit_double_mono.wav", 1, "full");
+        test_echo_block_matches_process();
 
         std::cout << "All Echo Tests Completed Successfully.\n";
     }
 
 private:
+    static void test_echo_block_matches_process() {
+        using namespace AJ;
+        using namespace AJ::dsp::echo;
+
+        std::cout << "\nTest: Echo processBlock matches process (stereo, odd block size)\n";
+
+        error::ConsoleErrorHandler errorHandler;
+
+        const sample_pos frames = 48000;
+        const int samplerate = 48000;
+
+        AudioBuffer channels;
+        for (int ch = 0; ch < 2; ++ch) {
+            channels[ch].resize(frames);
+            for (sample_pos i = 0; i < frames; ++i) {
+                channels[ch][i] = 0.5f * std::sin(0.01f * i * (ch + 1));
+            }
+        }
+
+        //* interleave before processing.
+        std::vector<float> interleaved(frames * 2);
+        for (sample_pos i = 0; i < frames; ++i) {
+            interleaved[2 * i] = channels[0][i];
+            interleaved[2 * i + 1] = channels[1][i];
+        }
+
+        Params echoParams{ 100, frames - 100, 0.6f, 0.05f, samplerate };
+        auto params = EchoParams::create(echoParams, errorHandler);
+        assert(params);
+
+        Echo echo;
+        assert(echo.setParams(params, errorHandler));
+        assert(echo.process(channels[0], errorHandler));
+        assert(echo.process(channels[1], errorHandler));
+
+        Echo blockEcho;
+        assert(blockEcho.setParams(params, errorHandler));
+        auto state = blockEcho.createState(2, errorHandler);
+        assert(state);
+
+        const size_t block = 257;
+        for (size_t pos = 0; pos < static_cast<size_t>(frames); pos += block) {
+            size_t n = std::min(block, static_cast<size_t>(frames) - pos);
+            assert(blockEcho.processBlock(interleaved.data() + pos * 2, n, 2, *state, errorHandler));
+        }
+
+        for (sample_pos i = 0; i < frames; ++i) {
+            assert(std::fabs(interleaved[2 * i] - channels[0][i]) < 1e-5f);
+            assert(std::fabs(interleaved[2 * i + 1] - channels[1][i]) < 1e-5f);
+        }
+
+        std::cout << "  ✓ Block processing result matches whole-buffer processing.\n";
+    }
+
     static constexpr const char* audio_dir = "/home/aj-e/Programming Codes/C++/AJ-Audio-Engine/build/build/bin/audio";
     static constexpr const char* output_dir = "/home/aj-e/Programming Codes/C++/AJ-Audio-Engine/build/build/bin/generated_echo_audio";
 
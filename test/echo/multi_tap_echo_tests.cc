@@ -0,0 +1,160 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dsp/multi_tap_echo.h"
+#include "core/error_handler.h"
+
+class MultiTapEchoTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Multi-Tap Echo Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_matches_reference();
+        test_blocks_match_buffer();
+        test_invalid_params();
+
+        std::cout << "All Multi-Tap Echo Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::Float make_signal(size_t frames, float phase = 0.0f) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = 0.3f * std::sin(0.01f * i + phase) + 0.1f * std::sin(0.37f * i);
+        }
+        return signal;
+    }
+
+    static std::shared_ptr<AJ::dsp::multitap::MultiTapParams> make_params(AJ::sample_pos start, AJ::sample_pos end,
+        AJ::error::IErrorHandler &handler) {
+        // 70, 300 and 1001 samples at 10 kHz.
+        AJ::dsp::multitap::Params p{ start, end, { { 0.007f, 0.5f }, { 0.03f, -0.3f }, { 0.1001f, 0.25f } },
+            0.6f, 10000 };
+        return AJ::dsp::multitap::MultiTapParams::create(p, handler);
+    }
+
+    static void test_matches_reference() {
+        std::cout << "\nTest: Output matches the feedback delay line equation\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 20000;
+        const AJ::sample_pos start = 500, end = 17999;
+        auto params = make_params(start, end, handler);
+        assert(params && params->MinDelay() == 70 && params->MaxDelay() == 1001);
+
+        const AJ::Float signal = make_signal(frames);
+
+        // w[n] = x[n] + fb * w[n - D], y[n] = clamp(x[n] + sum g_k * w[n - d_k]).
+        AJ::Float expected = signal;
+        std::vector<double> w(frames, 0.0);
+        const size_t D = params->MaxDelay();
+        for (size_t n = start; n <= static_cast<size_t>(end); ++n) {
+            const size_t i = n - start;
+            double y = signal[n];
+            for (const auto &tap : params->Taps()) {
+                if (i >= tap.mDelay) y += tap.mGain * w[i - tap.mDelay];
+            }
+            w[i] = signal[n] + (i >= D ? params->Feedback() * w[i - D] : 0.0);
+            expected[n] = static_cast<float>(std::clamp(y, -1.0, 1.0));
+        }
+
+        AJ::dsp::multitap::MultiTapEcho echo;
+        assert(echo.setParams(params, handler));
+
+        AJ::Float output = signal;
+        assert(echo.process(output, handler));
+
+        for (size_t n = 0; n < frames; ++n) {
+            assert(std::fabs(output[n] - expected[n]) < 1e-5f);
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Taps and feedback match the reference\n";
+    }
+
+    static void test_blocks_match_buffer() {
+        std::cout << "\nTest: Streamed stereo blocks match the whole-buffer echo\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 15000;
+        auto params = make_params(123, 13999, handler);
+
+        AJ::dsp::multitap::MultiTapEcho echo;
+        assert(echo.setParams(params, handler));
+
+        AJ::Float left = make_signal(frames);
+        AJ::Float right = make_signal(frames, 1.0f);
+
+        std::vector<float> stereo(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            stereo[2 * i] = left[i];
+            stereo[2 * i + 1] = right[i];
+        }
+
+        assert(echo.process(left, handler));
+        assert(echo.process(right, handler));
+
+        auto state = echo.createState(2, handler);
+        assert(state);
+
+        // odd block sizes, so chunks straddle blocks and ring wraps.
+        const size_t sizes[] = { 1, 37, 511, 64, 1000, 3 };
+        size_t done = 0;
+        for (size_t b = 0; done < frames; ++b) {
+            const size_t n = std::min(sizes[b % 6], frames - done);
+            assert(echo.processBlock(stereo.data() + done * 2, n, 2, *state, handler));
+            done += n;
+        }
+
+        for (size_t i = 0; i < frames; ++i) {
+            assert(stereo[2 * i] == left[i] && stereo[2 * i + 1] == right[i]);
+        }
+
+        // a state of another channel count is rejected.
+        auto mono = echo.createState(1, handler);
+        assert(!echo.processBlock(stereo.data(), 16, 2, *mono, handler));
+        assert(handler.errors().size() == 1);
+
+        std::cout << "  ✓ Same samples block by block\n";
+    }
+
+    static void test_invalid_params() {
+        std::cout << "\nTest: Invalid taps, feedback and ranges are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::dsp::multitap::Params none{ 0, 100, {}, 0.5f, 44100 };
+        assert(!AJ::dsp::multitap::MultiTapParams::create(none, handler));
+
+        std::vector<AJ::dsp::multitap::Tap> many(AJ::kEchoMaxTaps + 1, { 0.01f, 0.5f });
+        AJ::dsp::multitap::Params tooMany{ 0, 100, many, 0.5f, 44100 };
+        assert(!AJ::dsp::multitap::MultiTapParams::create(tooMany, handler));
+
+        AJ::dsp::multitap::Params zeroDelay{ 0, 100, { { 0.0f, 0.5f } }, 0.5f, 44100 };
+        assert(!AJ::dsp::multitap::MultiTapParams::create(zeroDelay, handler));
+
+        AJ::dsp::multitap::Params loudTap{ 0, 100, { { 0.01f, 1.5f } }, 0.5f, 44100 };
+        assert(!AJ::dsp::multitap::MultiTapParams::create(loudTap, handler));
+
+        AJ::dsp::multitap::Params runaway{ 0, 100, { { 0.01f, 0.5f } }, 1.0f, 44100 };
+        assert(!AJ::dsp::multitap::MultiTapParams::create(runaway, handler));
+
+        AJ::dsp::multitap::Params reversed{ 100, 0, { { 0.01f, 0.5f } }, 0.5f, 44100 };
+        assert(!AJ::dsp::multitap::MultiTapParams::create(reversed, handler));
+        assert(handler.errors().size() == 6);
+
+        // the range must fit the buffer.
+        AJ::dsp::multitap::MultiTapEcho echo;
+        AJ::Float buffer(50, 0.1f);
+        assert(!echo.process(buffer, handler));
+        assert(echo.setParams(make_params(0, 100, handler), handler));
+        assert(!echo.process(buffer, handler));
+        assert(handler.errors().size() == 8);
+
+        std::cout << "  ✓ Every invalid input reported\n";
+    }
+};
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "editing/piece_table.h"
+#include "editing/cut.h"
+#include "editing/insert.h"
+#include "file_io/wav_file.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "audio_fixtures.h"
+
+class PieceTableTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Piece Table Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_edits_match_reference();
+        test_chunks_are_shared();
+        test_file_round_trip();
+        test_invalid_edits();
+
+        std::cout << "All Piece Table Tests Completed Successfully.\n";
+    }
+
+private:
+    //* frame i of channel ch holds i + ch * 0.5 (exact in float up to 2^23).
+    static void assert_equal(const AJ::editing::piece_table::PieceTable &table, const std::vector<float> &left) {
+        assert(table.frames() == left.size());
+        AJ::AudioSamples flat = table.flatten();
+        assert(std::vector<float>((*flat)[0].begin(), (*flat)[0].end()) == left);
+        for (size_t i = 0; i < left.size(); ++i) assert((*flat)[1][i] == left[i] + 0.5f);
+    }
+
+    static void test_edits_match_reference() {
+        std::cout << "\nTest: Hundreds of edits match the same edits on a plain buffer\n";
+        AJ::error::CollectingErrorHandler handler;
+        using AJ::editing::piece_table::PieceTable;
+
+        const size_t frames = 1 << 20;
+        AJ::AudioSamples audio = fixtures::ramp(frames, 0.0f, 1.0f);
+        std::vector<float> reference((*audio)[0].begin(), (*audio)[0].end());
+
+        PieceTable table;
+        assert(table.assign(audio, 2, handler));
+        audio.reset();
+
+        uint32_t state = 12345;
+        auto next = [&](size_t bound) {
+            state = state * 1664525u + 1013904223u;
+            return bound ? (state >> 8) % bound : 0;
+        };
+
+        const auto begin = std::chrono::steady_clock::now();
+        float fresh = 1e6f;
+
+        for (size_t edit = 0; edit < 600; ++edit) {
+            const size_t size = reference.size();
+            const size_t start = next(size - 1000);
+            const size_t length = 1 + next(900);
+
+            switch (edit % 4) {
+            case 0: {
+                assert(table.cut(start, start + length - 1, handler));
+                reference.erase(reference.begin() + start, reference.begin() + start + length);
+                break;
+            }
+            case 1: {
+                AJ::AudioSamples insert = fixtures::ramp(length, fresh, 1.0f);
+                assert(table.insert(start, insert, handler));
+                reference.insert(reference.begin() + start, (*insert)[0].begin(), (*insert)[0].end());
+                fresh += 1000.0f;
+                break;
+            }
+            case 2: {
+                assert(table.duplicate(start, start + length - 1, handler));
+                std::vector<float> copy(reference.begin() + start, reference.begin() + start + length);
+                reference.insert(reference.begin() + start + length, copy.begin(), copy.end());
+                break;
+            }
+            default: {
+                //* move a region: copy, cut, paste elsewhere.
+                PieceTable clip;
+                assert(table.copy(start, start + length - 1, clip, handler));
+                assert(table.cut(start, start + length - 1, handler));
+                const size_t to = next(reference.size() - length);
+                assert(table.insert(to, clip, handler));
+
+                std::vector<float> copy(reference.begin() + start, reference.begin() + start + length);
+                reference.erase(reference.begin() + start, reference.begin() + start + length);
+                reference.insert(reference.begin() + to, copy.begin(), copy.end());
+                break;
+            }
+            }
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        assert(handler.errors().empty());
+        assert_equal(table, reference);
+
+        //* reads across piece boundaries.
+        std::vector<float> window(5000);
+        table.read(1, 12345, window.size(), window.data());
+        for (size_t i = 0; i < window.size(); ++i) assert(window[i] == reference[12345 + i] + 0.5f);
+
+        std::cout << "  ✓ 600 edits in " << ms << " ms, " << table.pieces().size() << " pieces\n";
+    }
+
+    static void test_chunks_are_shared() {
+        std::cout << "\nTest: Copies and self inserts share the chunks, neighbours merge back\n";
+        AJ::error::CollectingErrorHandler handler;
+        using AJ::editing::piece_table::PieceTable;
+
+        AJ::AudioSamples audio = fixtures::ramp(1000, 0.0f, 1.0f);
+        const AJ::AudioBuffer *chunk = audio.get();
+
+        PieceTable table;
+        assert(table.assign(std::move(audio), 2, handler));
+
+        //* the table inserted into itself, then a snapshot: one chunk for all.
+        assert(table.insert(500, table, handler));
+        assert(table.frames() == 2000 && table.pieces().size() == 3);
+        PieceTable snapshot = table;
+        for (const auto &piece : snapshot.pieces()) assert(piece.source.get() == chunk);
+
+        std::vector<float> expected;
+        for (size_t i = 0; i < 500; ++i) expected.push_back(i);
+        for (size_t i = 0; i < 1000; ++i) expected.push_back(i);
+        for (size_t i = 500; i < 1000; ++i) expected.push_back(i);
+        assert_equal(table, expected);
+
+        //* cutting the inserted copy joins the two halves of the original again.
+        assert(table.cut(500, 1499, handler));
+        assert(table.pieces().size() == 1 && table.frames() == 1000);
+
+        //* a split boundary stays until an edit around it merges it.
+        assert(table.split(300, handler));
+        assert(table.pieces().size() == 2);
+        assert(snapshot.frames() == 2000);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ One chunk, " << snapshot.pieces().size() << " pieces in the snapshot\n";
+    }
+
+    static void test_file_round_trip() {
+        std::cout << "\nTest: Load a file, edit it with Cut and Insert, flatten it back\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto file = fixtures::make_file(fixtures::ramp(48000, 0.0f, 1.0f));
+        file->buildLevelIndex();
+
+        AJ::editing::piece_table::PieceTable table;
+        assert(table.load(*file, handler));
+        assert(file->channelFrames() == 0 && file->mInfo.length == 0);
+
+        AJ::editing::cut::Cut cut;
+        assert(cut.setRange(1000, 1999, handler));
+        assert(cut.process(table, handler));
+
+        AJ::editing::insert::Insert insert;
+        assert(insert.setInsertAt(0, handler));
+        assert(insert.process(table, fixtures::ramp(10, -10.0f, 1.0f), handler));
+
+        assert(table.flatten(*file, handler));
+        assert(file->channelFrames() == 47010 && file->mInfo.length == 2 * 47010);
+        assert((*file->pAudio)[0][0] == -10.0f && (*file->pAudio)[0][10] == 0.0f);
+        assert((*file->pAudio)[0][1010] == 2000.0f && (*file->pAudio)[1][1010] == 2000.5f);
+
+        //* the level index follows the flattened samples.
+        AJ::dsp::kernels::Levels levels;
+        assert(file->levels(0, 0, 47009, levels, handler));
+        assert(levels.min == -10.0f && levels.max == 47999.0f);
+
+        //* editing goes on after a flatten, the file's samples aren't shared with the table.
+        (*file->pAudio)[0][0] = 7.0f;
+        assert(table.cut(0, 9, handler));
+        assert(table.flatten()->at(0)[0] == 0.0f);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Cut and Insert on the table, file flattened back\n";
+    }
+
+    static void test_invalid_edits() {
+        std::cout << "\nTest: Invalid edits are rejected and leave the table unchanged\n";
+        AJ::error::CollectingErrorHandler handler;
+        using AJ::editing::piece_table::PieceTable;
+
+        PieceTable empty;
+        assert(!empty.insert(0, fixtures::ramp(10, 0.0f, 1.0f), handler));
+
+        PieceTable table;
+        assert(table.assign(fixtures::ramp(100, 0.0f, 1.0f), 2, handler));
+        assert(!table.cut(50, 100, handler));
+        assert(!table.cut(60, 50, handler));
+        assert(!table.cut(-1, 5, handler));
+        assert(!table.insert(101, fixtures::ramp(10, 0.0f, 1.0f), handler));
+        assert(!table.insert(5, std::make_shared<AJ::AudioBuffer>(), handler));
+
+        AJ::AudioSamples uneven = fixtures::ramp(10, 0.0f, 1.0f);
+        (*uneven)[1].resize(9);
+        assert(!table.insert(5, uneven, handler));
+
+        PieceTable mono;
+        AJ::AudioSamples one = fixtures::ramp(10, 0.0f, 1.0f);
+        assert(mono.assign(one, 1, handler));
+        assert(!table.insert(5, mono, handler));
+
+        AJ::editing::cut::Cut cut;
+        assert(!cut.process(table, handler));
+        assert(handler.errors().size() == 9);
+        assert(table.frames() == 100 && table.pieces().size() == 1);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
@@ -0,0 +1,222 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "core/aj_audio_engine.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "dsp/gain.h"
+#include "dsp/distortion.h"
+#include "dsp/effect_chain.h"
+#include "editing/preview.h"
+#include "file_io/wav_file.h"
+#include "audio_fixtures.h"
+
+class PreviewRendererTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Preview Renderer Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_dry_is_full();
+        test_preview_then_full();
+        test_edits_invalidate();
+        test_preview_quality();
+
+        std::cout << "All Preview Renderer Tests Completed Successfully.\n";
+    }
+
+private:
+    using Quality = AJ::editing::preview::Quality;
+
+    static std::shared_ptr<AJ::io::WAV_File> copy_file(const AJ::io::WAV_File &file) {
+        auto copy = std::make_shared<AJ::io::WAV_File>();
+        copy->mInfo = file.mInfo;
+        copy->pAudio = std::make_shared<AJ::AudioBuffer>(*file.pAudio);
+        return copy;
+    }
+
+    static std::shared_ptr<AJ::dsp::EffectParams> gain(AJ::sample_pos start, AJ::sample_pos end, float value,
+        AJ::error::IErrorHandler &handler) {
+        AJ::dsp::gain::Params params{ start, end, value };
+        return AJ::dsp::gain::GainParams::create(params, handler);
+    }
+
+    static std::shared_ptr<AJ::dsp::distortion::DistortionParams> distortion(AJ::sample_pos start,
+        AJ::sample_pos end, AJ::error::IErrorHandler &handler) {
+        AJ::dsp::distortion::Params params;
+        params.mStart = start;
+        params.mEnd = end;
+        params.mGain = 3.0f;
+        return AJ::dsp::distortion::DistortionParams::create(params, handler);
+    }
+
+    static AJ::AudioBuffer read(AJ::editing::preview::PreviewRenderer &preview, Quality &quality,
+        AJ::error::IErrorHandler &handler) {
+        AJ::AudioBuffer out;
+        float *outs[AJ::kNumChannels] = {};
+        for (size_t ch = 0; ch < preview.channels(); ++ch) {
+            out[ch].resize(preview.frames());
+            outs[ch] = out[ch].data();
+        }
+        assert(preview.read(0, preview.frames(), outs, quality, handler));
+        return out;
+    }
+
+    static float max_error(const AJ::AudioBuffer &a, const AJ::AudioBuffer &b) {
+        float error = 0.0f;
+        for (size_t ch = 0; ch < 2; ++ch) {
+            assert(a[ch].size() == b[ch].size());
+            for (size_t i = 0; i < a[ch].size(); ++i) error = std::max(error, std::fabs(a[ch][i] - b[ch][i]));
+        }
+        return error;
+    }
+
+    static void test_dry_is_full() {
+        std::cout << "\nTest: Frames no effect reaches are the source, at full quality\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+
+        auto file = fixtures::make_file(3 * AJ::kPreviewWindowFrames + 100, 2, fixtures::tones);
+        auto preview = engine.createPreview(file, handler);
+        assert(preview && preview->frames() == file->pAudio->at(0).size() && preview->channels() == 2);
+
+        Quality quality = Quality::Missing;
+        assert(read(*preview, quality, handler) == *file->pAudio);
+        assert(quality == Quality::Full);
+
+        //* a gain on the last window only.
+        const AJ::sample_pos last = 3 * AJ::kPreviewWindowFrames;
+        assert(preview->push(AJ::Effect::gain, gain(last, last + 99, 0.5f, handler), handler));
+        assert(preview->quality(0, 3 * AJ::kPreviewWindowFrames) == Quality::Full);
+
+        std::vector<float> left(10), right(10);
+        float *outs[] = { left.data(), right.data() };
+        assert(preview->read(100, 10, outs, quality, handler) && quality == Quality::Full);
+        assert(left[0] == (*file->pAudio)[0][100]);
+
+        assert(!preview->read(last, 101, outs, quality, handler));
+        assert(handler.errors().size() == 1 && handler.errors()[0].first == AJ::error::Error::InvalidProcessingRange);
+        std::cout << "  ✓ Dry windows are Full, out of range reads are rejected\n";
+    }
+
+    static void test_preview_then_full() {
+        std::cout << "\nTest: A read is previewed at once, then replaced by the full render\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+        engine.setUndoSupportEnabled(false);
+
+        const size_t frames = 6 * AJ::kPreviewWindowFrames;
+        auto file = fixtures::make_file(frames, 2, fixtures::tones);
+        auto reference = copy_file(*file);
+
+        auto preview = engine.createPreview(file, handler);
+        assert(preview && preview->decimation() == AJ::kPreviewDecimation);
+
+        auto first = gain(0, frames - 1, 0.5f, handler);
+        auto second = distortion(0, frames - 1, handler);
+        assert(preview->push(AJ::Effect::gain, first, handler));
+        assert(preview->push(AJ::Effect::Distortion, second, handler));
+        assert(engine.applyEffect(reference, AJ::Effect::gain, first, handler));
+        assert(engine.applyEffect(reference, AJ::Effect::Distortion, second, handler));
+
+        //* the background thread may be ahead, the read is at least a preview.
+        Quality quality = Quality::Missing;
+        const AJ::AudioBuffer provisional = read(*preview, quality, handler);
+        assert(quality != Quality::Missing);
+        const float error = max_error(provisional, *reference->pAudio);
+        assert(error < 0.05f);
+
+        assert(preview->wait(std::chrono::seconds(30)));
+        assert(preview->quality(0, frames) == Quality::Full);
+        assert(max_error(read(*preview, quality, handler), *reference->pAudio) < 1e-5f);
+        assert(quality == Quality::Full);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Preview within " << error << " of the render, Full matches it\n";
+    }
+
+    static void test_edits_invalidate() {
+        std::cout << "\nTest: setParams() and pop() drop the windows they change\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+        engine.setUndoSupportEnabled(false);
+
+        const size_t frames = 4 * AJ::kPreviewWindowFrames;
+        auto file = fixtures::make_file(frames, 2, fixtures::tones);
+        auto preview = engine.createPreview(file, handler);
+        assert(preview);
+
+        //* at the source rate the preview of a gain is exact, the steps of its short range don't ring.
+        preview->setDecimation(1);
+        const AJ::sample_pos second = AJ::kPreviewWindowFrames;
+        assert(preview->push(AJ::Effect::gain, gain(second, second + 100, 0.5f, handler), handler));
+        assert(preview->wait(std::chrono::seconds(30)));
+
+        //* a tweak inside the second window leaves the others final.
+        auto louder = gain(second, second + 100, 2.0f, handler);
+        assert(preview->setParams(0, louder, handler));
+        assert(preview->quality(0, AJ::kPreviewWindowFrames) == Quality::Full);
+        assert(preview->quality(2 * AJ::kPreviewWindowFrames, 2 * AJ::kPreviewWindowFrames) == Quality::Full);
+
+        auto reference = copy_file(*file);
+        assert(engine.applyEffect(reference, AJ::Effect::gain, louder, handler));
+
+        Quality quality = Quality::Missing;
+        assert(max_error(read(*preview, quality, handler), *reference->pAudio) < 1e-5f);
+        assert(preview->wait(std::chrono::seconds(30)));
+        assert(max_error(read(*preview, quality, handler), *reference->pAudio) < 1e-5f);
+
+        assert(preview->pop(handler) && preview->size() == 0);
+        assert(preview->wait(std::chrono::seconds(30)));
+        assert(read(*preview, quality, handler) == *file->pAudio);
+
+        //* failures leave the renderer as it was.
+        assert(!preview->pop(handler));
+        assert(!preview->setParams(0, louder, handler));
+        assert(handler.errors().size() == 2);
+
+        std::cout << "  ✓ Only the changed window is dropped, the output follows every edit\n";
+    }
+
+    static void test_preview_quality() {
+        std::cout << "\nTest: RenderQuality::Preview trades precision, an EffectChain forwards it\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::Float input(4096);
+        for (size_t i = 0; i < input.size(); ++i) input[i] = std::sin(i / 30.0f);
+
+        auto params = distortion(0, input.size() - 1, handler);
+        AJ::dsp::distortion::Distortion full;
+        assert(full.setParams(params, handler));
+        AJ::Float accurate = input;
+        assert(full.process(accurate, handler));
+
+        auto fast = std::make_shared<AJ::dsp::distortion::Distortion>();
+        assert(fast->setParams(params, handler));
+        AJ::dsp::EffectChain chain;
+        chain.setQuality(AJ::dsp::RenderQuality::Preview);
+        assert(chain.add(fast, handler));
+        assert(chain.quality() == AJ::dsp::RenderQuality::Preview);
+
+        AJ::Float previewed = input;
+        assert(chain.process(previewed, handler));
+
+        float error = 0.0f;
+        for (size_t i = 0; i < input.size(); ++i) error = std::max(error, std::fabs(previewed[i] - accurate[i]));
+        assert(error > 0.0f && error < 2.5e-2f);
+
+        //* back to Full, the chain renders as the effect alone.
+        chain.setQuality(AJ::dsp::RenderQuality::Full);
+        previewed = input;
+        assert(chain.process(previewed, handler));
+        assert(previewed == accurate);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Fast tanh within " << error << ", Full restored\n";
+    }
+};
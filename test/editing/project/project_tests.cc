@@ -0,0 +1,385 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "editing/piece_table.h"
+#include "editing/project.h"
+#include "file_io/seek_index.h"
+#include "undo_system/undo.h"
+#include "undo_system/state.h"
+#include "audio_fixtures.h"
+
+class ProjectStoreTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Project Store Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_commit_and_reopen();
+        test_chunks_written_once();
+        test_history_round_trip();
+        test_torn_journal();
+        test_damaged_journal();
+        test_indices_and_compact();
+        test_invalid_use();
+
+        std::cout << "All Project Store Tests Completed Successfully.\n";
+    }
+
+private:
+    using PieceTable = AJ::editing::piece_table::PieceTable;
+    using ProjectStore = AJ::editing::project::ProjectStore;
+
+    static std::string directory(const char *name) {
+        const std::string path = (std::filesystem::temp_directory_path() / name).string();
+        std::filesystem::remove_all(path);
+        return path;
+    }
+
+    static std::vector<float> read(const ProjectStore &store, uint8_t channel) {
+        std::vector<float> out(store.frames());
+        assert(store.read(channel, 0, out.size(), out.data()) == out.size());
+        return out;
+    }
+
+    static std::vector<float> read(const PieceTable &table, uint8_t channel) {
+        std::vector<float> out(table.frames());
+        table.read(channel, 0, out.size(), out.data());
+        return out;
+    }
+
+    static void test_commit_and_reopen() {
+        std::cout << "\nTest: A committed table reads back from the mapping after a reopen\n";
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = directory("aj_project_reopen_test");
+
+        PieceTable table;
+        assert(table.assign(fixtures::ramp(100000, 0.0f, 0.001f), 2, handler));
+        assert(table.cut(20000, 29999, handler));
+        assert(table.insert(5000, fixtures::ramp(3000, 2.0f, 0.001f), handler));
+
+        {
+            ProjectStore store;
+            assert(store.create(path, 2, 48000, handler));
+            assert(store.isOpen() && store.frames() == 0);
+            assert(store.commit(table, handler));
+            assert(store.frames() == table.frames());
+        }
+
+        ProjectStore store;
+        assert(store.open(path, handler));
+        assert(store.channels() == 2 && store.samplerate() == 48000 && store.frames() == 93000);
+        assert(read(store, 0) == read(table, 0) && read(store, 1) == read(table, 1));
+
+        //* stored blocks and partial blocks across pieces give the levels of the samples.
+        const std::vector<float> samples = read(table, 1);
+        const AJ::sample_pos ranges[][2] = { {0, 92999}, {4990, 8123}, {100, 200}, {19999, 20000}, {7, 7} };
+        for (const auto &range : ranges) {
+            float min = samples[range[0]], max = min;
+            double sum = 0.0;
+            for (AJ::sample_pos i = range[0]; i <= range[1]; ++i) {
+                min = std::min(min, samples[i]);
+                max = std::max(max, samples[i]);
+                sum += double(samples[i]) * samples[i];
+            }
+
+            const AJ::dsp::kernels::Levels levels = store.levels(1, range[0], range[1]);
+            assert(levels.min == min && levels.max == max);
+            assert(std::fabs(levels.sumSquares - sum) <= 1e-6 * sum + 1e-9);
+        }
+        assert(store.levels(0, 0, 93000).min > store.levels(0, 0, 93000).max);
+
+        //* editable again, the copy is the committed table.
+        PieceTable restored;
+        assert(store.table(restored, handler));
+        assert(restored.pieces().size() == table.pieces().size());
+        assert(*restored.flatten() == *table.flatten());
+        assert(restored.cut(0, 999, handler));
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ " << store.frames() << " frames in " << table.pieces().size() << " pieces read back\n";
+    }
+
+    static void test_chunks_written_once() {
+        std::cout << "\nTest: Commits append only the chunks not stored yet\n";
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = directory("aj_project_chunks_test");
+
+        ProjectStore store;
+        assert(store.create(path, 2, 48000, handler));
+
+        PieceTable table;
+        assert(table.assign(fixtures::ramp(200000, 0.0f, 0.001f), 2, handler));
+        assert(store.commit(table, handler));
+        const uint64_t data = store.dataBytes();
+        const uint64_t journal = store.journalBytes();
+        assert(data >= 2 * 200000 * sizeof(float) && data % AJ::kProjectAlignment == 0);
+
+        //* nothing changed, nothing written.
+        assert(store.commit(table, handler));
+        assert(store.dataBytes() == data && store.journalBytes() == journal);
+
+        //* cuts and duplicates only move pieces.
+        assert(table.cut(1000, 50999, handler));
+        assert(table.duplicate(0, 9999, handler));
+        assert(store.commit(table, handler));
+        assert(store.dataBytes() == data && store.journalBytes() > journal);
+
+        //* an insert appends its own chunk alone.
+        assert(table.insert(100, fixtures::ramp(1000, 1.0f, 0.001f), handler));
+        assert(store.commit(table, handler));
+        assert(store.dataBytes() > data && store.dataBytes() - data < 3 * AJ::kProjectAlignment + 1000 * 2 * sizeof(float));
+        assert(read(store, 0) == read(table, 0));
+
+        //* a table from the store shares its chunks, committing it writes no sample.
+        PieceTable restored;
+        assert(store.table(restored, handler));
+        const uint64_t after = store.dataBytes();
+        assert(restored.cut(0, 99, handler));
+        assert(store.commit(restored, handler));
+        assert(store.dataBytes() == after && store.frames() == table.frames() - 100);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ " << data << " bytes for the file, " << store.dataBytes() - data << " for the insert\n";
+    }
+
+    static void test_history_round_trip() {
+        std::cout << "\nTest: The undo history of the table is committed and undoable after a reopen\n";
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = directory("aj_project_history_test");
+
+        auto table = std::make_shared<PieceTable>();
+        assert(table->assign(fixtures::ramp(50000, 0.0f, 0.001f), 2, handler));
+        const AJ::AudioSamples original = table->flatten();
+
+        AJ::undo::UndoSystem history;
+        AJ::undo::State cut("cut");
+        assert(cut.add(table, 10000, 20000, 0, handler));
+        assert(table->cut(10000, 29999, handler));
+        history.push(std::move(cut), handler);
+
+        AJ::undo::State insert("insert");
+        assert(insert.add(table, 500, 0, 700, handler));
+        assert(table->insert(500, fixtures::ramp(700, 3.0f, 0.001f), handler));
+        history.push(std::move(insert), handler);
+        const AJ::AudioSamples edited = table->flatten();
+
+        //* undone once: the redo state is committed too.
+        assert(history.undo(handler));
+        {
+            ProjectStore store;
+            assert(store.create(path, 2, 44100, handler));
+            assert(store.commit(table, history, handler));
+            assert(store.undoCount() == 1 && store.redoCount() == 1);
+        }
+
+        ProjectStore store;
+        assert(store.open(path, handler));
+        assert(store.undoCount() == 1 && store.redoCount() == 1);
+
+        auto restored = std::make_shared<PieceTable>();
+        AJ::undo::UndoSystem undo;
+        assert(store.table(*restored, handler));
+        assert(store.history(restored, undo, handler));
+        assert(undo.undoCount() == 1 && undo.redoCount() == 1);
+
+        assert(undo.redo(handler));
+        assert(*restored->flatten() == *edited);
+        assert(undo.undo(handler) && undo.undo(handler));
+        assert(*restored->flatten() == *original);
+        assert(!undo.canUndo());
+
+        //* the changes of another table aren't part of its history.
+        assert(store.commit(std::make_shared<PieceTable>(*restored), undo, handler));
+        assert(store.undoCount() == 0 && store.redoCount() == 0);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Redo, then undo to the original, from the reopened project\n";
+    }
+
+    static void test_torn_journal() {
+        std::cout << "\nTest: A record torn by a crash is dropped on open\n";
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = directory("aj_project_torn_test");
+        const std::string journal = (std::filesystem::path(path) / "journal.ajpj").string();
+
+        PieceTable table;
+        assert(table.assign(fixtures::ramp(30000, 0.0f, 0.001f), 2, handler));
+
+        uint64_t committed = 0;
+        {
+            ProjectStore store;
+            assert(store.create(path, 2, 48000, handler));
+            assert(store.commit(table, handler));
+            committed = store.journalBytes();
+        }
+
+        //* the last commit only half made it to disk.
+        PieceTable cut;
+        {
+            ProjectStore store;
+            assert(store.open(path, handler));
+            assert(store.table(cut, handler) && cut.cut(0, 9999, handler));
+            assert(store.commit(cut, handler) && store.frames() == 20000);
+        }
+        std::filesystem::resize_file(journal, std::filesystem::file_size(journal) - 5);
+
+        ProjectStore store;
+        assert(store.open(path, handler));
+        assert(store.frames() == 30000 && store.journalBytes() == committed);
+        assert(std::filesystem::file_size(journal) == committed);
+        assert(read(store, 0) == read(table, 0));
+
+        //* garbage after the last record is cut as well, the next commit follows the valid ones.
+        store.close();
+        {
+            std::ofstream out(journal, std::ios::binary | std::ios::app);
+            out << "AJPR and then nothing";
+        }
+        assert(store.open(path, handler) && store.journalBytes() == committed);
+        assert(store.commit(cut, handler));
+        store.close();
+        assert(store.open(path, handler) && store.frames() == 20000);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Reopened at the last complete commit\n";
+    }
+
+    static void test_damaged_journal() {
+        std::cout << "\nTest: A damaged record before the end fails the open, the journal is kept\n";
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = directory("aj_project_damaged_test");
+        const std::string journal = (std::filesystem::path(path) / "journal.ajpj").string();
+
+        PieceTable table;
+        assert(table.assign(fixtures::ramp(30000, 0.0f, 0.001f), 2, handler));
+
+        uint64_t committed = 0;
+        {
+            ProjectStore store;
+            assert(store.create(path, 2, 48000, handler));
+            assert(store.commit(table, handler));
+            committed = store.journalBytes();
+            assert(table.cut(0, 9999, handler) && store.commit(table, handler));
+        }
+        const uint64_t size = std::filesystem::file_size(journal);
+
+        //* the last byte of the first commit: complete records follow it.
+        {
+            std::fstream io(journal, std::ios::binary | std::ios::in | std::ios::out);
+            io.seekg(static_cast<std::streamoff>(committed - 1));
+            const char byte = static_cast<char>(io.get() ^ 0x5a);
+            io.seekp(static_cast<std::streamoff>(committed - 1));
+            io.put(byte);
+        }
+
+        ProjectStore store;
+        assert(!store.open(path, handler) && !store.isOpen());
+        assert(handler.errors().size() == 1 && handler.errors().back().first == AJ::error::Error::FileReadError);
+        assert(std::filesystem::file_size(journal) == size);
+
+        std::cout << "  ✓ Open failed, " << size << " bytes of journal left\n";
+    }
+
+    static void test_indices_and_compact() {
+        std::cout << "\nTest: Loudness and seek indices persist, compact() keeps the state\n";
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = directory("aj_project_indices_test");
+
+        PieceTable table;
+        assert(table.assign(fixtures::ramp(40000, 0.0f, 0.001f), 2, handler));
+
+        std::vector<AJ::io::SeekIndex::Point> points;
+        for (int64_t i = 0; i < 50; ++i) points.push_back({ 4096 + 417 * i, 1152 * i });
+        const AJ::io::SeekIndex index(points, 50 * AJ::kSeekIndexStride, 1152 * 50);
+
+        {
+            ProjectStore store;
+            assert(store.create(path, 2, 48000, handler));
+            assert(store.commit(table, handler));
+            for (int edit = 0; edit < 20; ++edit) {
+                assert(table.duplicate(0, 99, handler));
+                assert(store.commit(table, handler));
+            }
+
+            assert(store.storeLoudness(0, 41999, 48000, { -23.5, -1.25f }, handler));
+            assert(store.storeSeekIndex("/music/source.mp3", index, handler));
+        }
+
+        ProjectStore store;
+        assert(store.open(path, handler));
+        const AJ::dsp::loudness::Measurement *loudness = store.loudness(0, 41999, 48000);
+        assert(loudness && loudness->mIntegrated == -23.5 && loudness->mTruePeak == -1.25f);
+        assert(!store.loudness(0, 41999, 44100));
+
+        AJ::io::SeekIndex loaded;
+        assert(store.loadSeekIndex("/music/source.mp3", loaded));
+        assert(loaded.packets() == index.packets() && loaded.frames() == index.frames());
+        assert(loaded.points().size() == 50 && loaded.points()[49].mPos == points[49].mPos);
+        assert(!store.loadSeekIndex("/music/other.mp3", loaded));
+
+        //* the journal holds every commit, compacted it holds the last one.
+        const uint64_t before = store.journalBytes();
+        assert(store.compact(handler));
+        assert(store.journalBytes() < before);
+        store.close();
+
+        assert(store.open(path, handler));
+        assert(store.journalBytes() < before && read(store, 0) == read(table, 0));
+        assert(store.loudness(0, 41999, 48000) && store.loadSeekIndex("/music/source.mp3", loaded));
+
+        //* new pieces, the measurement is of the old ones.
+        assert(table.cut(0, 999, handler));
+        assert(store.commit(table, handler));
+        assert(!store.loudness(0, 41999, 48000));
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Journal compacted from " << before << " to " << store.journalBytes() << " bytes\n";
+    }
+
+    static void test_invalid_use() {
+        std::cout << "\nTest: Invalid projects and tables are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = directory("aj_project_invalid_test");
+
+        ProjectStore store;
+        assert(!store.open(path, handler));
+        assert(handler.errors().back().first == AJ::error::Error::FileOpenError);
+        assert(!store.create(path, 0, 48000, handler));
+        assert(handler.errors().back().first == AJ::error::Error::InvalidChannelCount);
+
+        PieceTable table;
+        assert(!store.commit(table, handler));
+        assert(handler.errors().back().first == AJ::error::Error::OperationNotAllowed);
+
+        assert(store.create(path, 1, 48000, handler));
+        ProjectStore twice;
+        assert(!twice.create(path, 1, 48000, handler));
+        assert(handler.errors().back().first == AJ::error::Error::FileOpenError);
+
+        //* a stereo table in a mono project.
+        assert(table.assign(fixtures::ramp(1000, 0.0f, 0.001f), 2, handler));
+        assert(!store.commit(table, handler));
+        assert(handler.errors().back().first == AJ::error::Error::InvalidChannelCount);
+        assert(store.frames() == 0 && store.dataBytes() == 0);
+
+        //* not a journal.
+        store.close();
+        {
+            std::ofstream out((std::filesystem::path(path) / "journal.ajpj").string(), std::ios::binary | std::ios::trunc);
+            out << "not a project";
+        }
+        assert(!store.open(path, handler) && !store.isOpen());
+        assert(handler.errors().back().first == AJ::error::Error::FileReadError);
+
+        assert(handler.errors().size() == 6);
+        std::cout << "  ✓ " << handler.errors().size() << " errors reported\n";
+    }
+};
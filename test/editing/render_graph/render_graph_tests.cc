@@ -0,0 +1,319 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "core/aj_audio_engine.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "dsp/gain.h"
+#include "dsp/echo.h"
+#include "dsp/normalization.h"
+#include "editing/render_graph.h"
+#include "audio_io/play.h"
+#include "file_io/wav_file.h"
+#include "audio_fixtures.h"
+
+class RenderGraphTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Render Graph Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_matches_immediate();
+        test_reads_what_is_needed();
+        test_edits_invalidate();
+        test_cache_budget();
+        test_engine_deferred();
+
+        std::cout << "All Render Graph Tests Completed Successfully.\n";
+    }
+
+private:
+    using RenderGraph = AJ::editing::render_graph::RenderGraph;
+
+    static constexpr size_t kChunkBytes = AJ::kRenderChunkFrames * 2 * sizeof(float);
+
+    static std::shared_ptr<AJ::io::WAV_File> copy_file(const AJ::io::WAV_File &file) {
+        auto copy = std::make_shared<AJ::io::WAV_File>();
+        copy->mInfo = file.mInfo;
+        copy->pAudio = std::make_shared<AJ::AudioBuffer>(*file.pAudio);
+        return copy;
+    }
+
+    static std::shared_ptr<AJ::dsp::EffectParams> gain(AJ::sample_pos start, AJ::sample_pos end, float value,
+        AJ::error::IErrorHandler &handler) {
+        AJ::dsp::gain::Params params{ start, end, value };
+        return AJ::dsp::gain::GainParams::create(params, handler);
+    }
+
+    static std::shared_ptr<AJ::dsp::EffectParams> echo(AJ::sample_pos start, AJ::sample_pos end,
+        AJ::error::IErrorHandler &handler) {
+        AJ::dsp::echo::Params params{ start, end, 0.4f, 0.01f, 48000 };
+        return AJ::dsp::echo::EchoParams::create(params, handler);
+    }
+
+    static std::shared_ptr<AJ::dsp::EffectParams> normalization(AJ::sample_pos start, AJ::sample_pos end,
+        AJ::error::IErrorHandler &handler) {
+        AJ::dsp::normalization::Params params;
+        params.mStart = start;
+        params.mEnd = end;
+        params.mTarget = 0.9f;
+        return AJ::dsp::normalization::NormalizationParams::create(params, handler);
+    }
+
+    static AJ::AudioBuffer render(RenderGraph &graph, AJ::error::IErrorHandler &handler) {
+        AJ::AudioBuffer out;
+        float *outs[AJ::kNumChannels] = {};
+        for (size_t ch = 0; ch < graph.channels(); ++ch) {
+            out[ch].resize(graph.frames());
+            outs[ch] = out[ch].data();
+        }
+        assert(graph.read(0, graph.frames(), outs, handler));
+        return out;
+    }
+
+    static void assert_close(const AJ::AudioBuffer &a, const AJ::AudioBuffer &b) {
+        for (size_t ch = 0; ch < 2; ++ch) {
+            assert(a[ch].size() == b[ch].size());
+            for (size_t i = 0; i < a[ch].size(); ++i) assert(std::fabs(a[ch][i] - b[ch][i]) < 1e-5f);
+        }
+    }
+
+    static void test_matches_immediate() {
+        std::cout << "\nTest: Deferred effects render what applyEffect() computes\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+        engine.setUndoSupportEnabled(false);
+
+        const size_t frames = 100000;
+        auto file = fixtures::make_file(frames, 2, fixtures::tones);
+        auto reference = copy_file(*file);
+
+        const std::vector<std::pair<AJ::Effect, std::shared_ptr<AJ::dsp::EffectParams>>> effects = {
+            { AJ::Effect::gain, gain(1000, 60000, 0.5f, handler) },
+            { AJ::Effect::echo, echo(5000, 90000, handler) },
+            { AJ::Effect::normalization, normalization(20000, frames - 1, handler) },
+            { AJ::Effect::gain, gain(0, 30000, 1.5f, handler) },
+        };
+
+        RenderGraph graph(engine.effectRegistry());
+        assert(graph.assign(file->pAudio, 2, handler));
+        for (const auto &[effect, params] : effects) {
+            assert(graph.push(effect, params, handler));
+            assert(engine.applyEffect(reference, effect, params, handler));
+        }
+        assert(graph.size() == 4 && graph.cachedBytes() == 0);
+
+        //* a window first, then everything: the window's chunks are reused.
+        std::vector<float> window(3000);
+        assert(graph.read(1, 40000, window.size(), window.data(), handler));
+        for (size_t i = 0; i < window.size(); ++i) {
+            assert(std::fabs(window[i] - (*reference->pAudio)[1][40000 + i]) < 1e-5f);
+        }
+        assert_close(render(graph, handler), *reference->pAudio);
+
+        AJ::dsp::kernels::Levels levels;
+        assert(graph.levels(0, 0, frames - 1, levels, handler));
+        const auto peak = std::minmax_element((*reference->pAudio)[0].begin(), (*reference->pAudio)[0].end());
+        assert(std::fabs(levels.min - *peak.first) < 1e-5f && std::fabs(levels.max - *peak.second) < 1e-5f);
+
+        //* flatten() gives the file the rendered samples, the graph keeps its nodes.
+        assert(graph.flatten(*file, handler));
+        assert_close(*file->pAudio, *reference->pAudio);
+        assert(render(graph, handler) == *file->pAudio);
+        assert(graph.size() == 4);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Gain, echo, normalization and gain match within 1e-5, levels and flatten agree\n";
+    }
+
+    static void test_reads_what_is_needed() {
+        std::cout << "\nTest: Only the chunks read are computed\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+
+        const size_t frames = 20 * AJ::kRenderChunkFrames;
+        auto file = fixtures::make_file(frames, 2, fixtures::tones);
+        RenderGraph graph(engine.effectRegistry());
+        assert(graph.assign(file->pAudio, 2, handler));
+
+        //* a gain computes the chunk read, nothing else.
+        assert(graph.push(AJ::Effect::gain, gain(0, frames - 1, 0.5f, handler), handler));
+        std::vector<float> out(100);
+        assert(graph.read(0, 10 * AJ::kRenderChunkFrames + 5, out.size(), out.data(), handler));
+        assert(graph.cachedBytes() == kChunkBytes);
+
+        //* an echo streams its range up to the chunk read: chunks 0 to 5 of both nodes.
+        assert(graph.push(AJ::Effect::echo, echo(0, frames - 1, handler), handler));
+        assert(graph.read(0, 5 * AJ::kRenderChunkFrames, out.size(), out.data(), handler));
+        assert(graph.cachedBytes() == (1 + 2 * 6) * kChunkBytes);
+
+        //* the next chunk continues the stream.
+        assert(graph.read(0, 6 * AJ::kRenderChunkFrames, out.size(), out.data(), handler));
+        assert(graph.cachedBytes() == (1 + 2 * 7) * kChunkBytes);
+
+        //* outside of every range nothing is cached.
+        RenderGraph partial(engine.effectRegistry());
+        assert(partial.assign(file->pAudio, 2, handler));
+        assert(partial.push(AJ::Effect::gain, gain(0, 1000, 2.0f, handler), handler));
+        assert(partial.read(1, 5 * AJ::kRenderChunkFrames, out.size(), out.data(), handler));
+        assert(partial.cachedBytes() == 0 && out[0] == (*file->pAudio)[1][5 * AJ::kRenderChunkFrames]);
+
+        graph.clearCache();
+        assert(graph.cachedBytes() == 0);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ One chunk for a gain, the stream up to the chunk for an echo\n";
+    }
+
+    static void test_edits_invalidate() {
+        std::cout << "\nTest: setParams(), erase() and pop() recompute what they changed\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+        engine.setUndoSupportEnabled(false);
+
+        const size_t frames = 12 * AJ::kRenderChunkFrames;
+        auto file = fixtures::make_file(frames, 2, fixtures::tones);
+        RenderGraph graph(engine.effectRegistry());
+        assert(graph.assign(file->pAudio, 2, handler));
+
+        assert(graph.push(AJ::Effect::gain, gain(AJ::kRenderChunkFrames, 3 * AJ::kRenderChunkFrames - 1, 0.8f, handler), handler));
+        assert(graph.push(AJ::Effect::gain, gain(0, frames - 1, 0.5f, handler), handler));
+        assert(graph.push(AJ::Effect::echo, echo(6 * AJ::kRenderChunkFrames, frames - 1, handler), handler));
+        render(graph, handler);
+        const size_t full = graph.cachedBytes();
+        assert(full == (2 + 12 + 6) * kChunkBytes);
+
+        //* the first gain changes chunks 1 and 2: the later gain drops those, the echo (after them) none.
+        auto first = gain(AJ::kRenderChunkFrames, 3 * AJ::kRenderChunkFrames - 1, 0.25f, handler);
+        assert(graph.setParams(0, first, handler));
+        assert(graph.cachedBytes() == (10 + 6) * kChunkBytes);
+
+        auto reference = copy_file(*file);
+        assert(engine.applyEffect(reference, AJ::Effect::gain, first, handler));
+        assert(engine.applyEffect(reference, AJ::Effect::gain, gain(0, frames - 1, 0.5f, handler), handler));
+        assert(engine.applyEffect(reference, AJ::Effect::echo, echo(6 * AJ::kRenderChunkFrames, frames - 1, handler), handler));
+        assert_close(render(graph, handler), *reference->pAudio);
+
+        //* the second gain over everything: the echo restarts its range.
+        assert(graph.erase(1, handler));
+        assert(graph.size() == 2 && graph.cachedBytes() == 2 * kChunkBytes);
+
+        reference = copy_file(*file);
+        assert(engine.applyEffect(reference, AJ::Effect::gain, first, handler));
+        assert(engine.applyEffect(reference, AJ::Effect::echo, echo(6 * AJ::kRenderChunkFrames, frames - 1, handler), handler));
+        assert_close(render(graph, handler), *reference->pAudio);
+
+        assert(graph.pop(handler) && graph.pop(handler) && graph.size() == 0 && graph.cachedBytes() == 0);
+        assert(render(graph, handler) == *file->pAudio);
+
+        //* failures leave the graph as it was.
+        assert(!graph.pop(handler));
+        assert(graph.push(AJ::Effect::gain, gain(0, 10, 0.5f, handler), handler));
+        assert(!graph.setParams(0, gain(0, frames, 0.5f, handler), handler));
+        assert(!graph.erase(3, handler));
+        assert(!graph.push(AJ::Effect::gain, gain(5, frames, 0.5f, handler), handler));
+        assert(graph.size() == 1 && graph.nodes()[0].end == 10);
+        assert(handler.errors().size() == 4);
+
+        std::cout << "  ✓ Only the changed chunks are dropped, the output follows every edit\n";
+    }
+
+    static void test_cache_budget() {
+        std::cout << "\nTest: The cache stays within its budget\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+        engine.setUndoSupportEnabled(false);
+
+        const size_t frames = 16 * AJ::kRenderChunkFrames;
+        auto file = fixtures::make_file(frames, 2, fixtures::tones);
+        auto reference = copy_file(*file);
+
+        RenderGraph graph(engine.effectRegistry());
+        assert(graph.assign(file->pAudio, 2, handler));
+        assert(graph.push(AJ::Effect::gain, gain(0, frames - 1, 0.7f, handler), handler));
+        assert(graph.push(AJ::Effect::echo, echo(0, frames - 1, handler), handler));
+        assert(engine.applyEffect(reference, AJ::Effect::gain, gain(0, frames - 1, 0.7f, handler), handler));
+        assert(engine.applyEffect(reference, AJ::Effect::echo, echo(0, frames - 1, handler), handler));
+
+        graph.setCacheBudget(8 * kChunkBytes);
+        assert_close(render(graph, handler), *reference->pAudio);
+        assert(graph.cachedBytes() <= 6 * kChunkBytes);
+
+        //* an evicted echo chunk restarts its stream, the output doesn't change.
+        std::vector<float> out(AJ::kRenderChunkFrames);
+        assert(graph.read(0, AJ::kRenderChunkFrames, out.size(), out.data(), handler));
+        for (size_t i = 0; i < out.size(); ++i) {
+            assert(std::fabs(out[i] - (*reference->pAudio)[0][AJ::kRenderChunkFrames + i]) < 1e-5f);
+        }
+
+        graph.setCacheBudget(0);
+        assert(graph.cachedBytes() == 0);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Least recently read chunks evicted, recomputed when read again\n";
+    }
+
+    static void test_engine_deferred() {
+        std::cout << "\nTest: Deferred mode of the engine\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::AJ_Engine engine;
+        engine.setDeferredEffects(true);
+
+        const size_t frames = 50000;
+        auto file = fixtures::make_file(frames, 2, fixtures::tones);
+        const AJ::AudioBuffer dry = *file->pAudio;
+        auto reference = copy_file(*file);
+        {
+            AJ::AJ_Engine immediate;
+            immediate.setUndoSupportEnabled(false);
+            assert(immediate.applyEffect(reference, AJ::Effect::gain, gain(0, frames - 1, 0.5f, handler), handler));
+            assert(immediate.applyEffect(reference, AJ::Effect::echo, echo(100, 40000, handler), handler));
+        }
+
+        //* recorded, the file stays dry.
+        assert(engine.applyEffect(file, AJ::Effect::gain, gain(0, frames - 1, 0.5f, handler), handler));
+        assert(engine.applyEffect(file, AJ::Effect::echo, echo(100, 40000, handler), handler));
+        assert(engine.applyEffect(file, AJ::Effect::gain, gain(0, 100, 3.0f, handler), handler));
+        assert(*file->pAudio == dry);
+
+        auto graph = engine.renderGraph(file, handler);
+        assert(graph && graph->size() == 3);
+
+        //* undo() pops the last deferred effect.
+        assert(engine.undo(handler) && graph->size() == 2);
+
+        //* playback renders the graph.
+        AJ::io::play::RenderGraphSource source(graph, 2, 48000, handler);
+        std::vector<float> played(2 * 1000);
+        assert(source.seek(20000) && source.read(played.data(), 1000) == 1000);
+        for (size_t i = 0; i < 1000; ++i) {
+            assert(std::fabs(played[2 * i] - (*reference->pAudio)[0][20000 + i]) < 1e-5f);
+            assert(std::fabs(played[2 * i + 1] - (*reference->pAudio)[1][20000 + i]) < 1e-5f);
+        }
+        assert(source.seek(frames - 10) && source.read(played.data(), 1000) == 10 && source.finished());
+
+        //* committed as one operation of the undo history.
+        assert(engine.commitEffects(file, handler));
+        assert(graph->size() == 0);
+        assert_close(*file->pAudio, *reference->pAudio);
+
+        assert(engine.undo(handler));
+        assert(*file->pAudio == dry);
+        assert(engine.redo(handler));
+        assert_close(*file->pAudio, *reference->pAudio);
+
+        //* out of deferred mode an effect commits first, nothing is waiting then.
+        assert(engine.applyEffect(file, AJ::Effect::gain, gain(0, 10, 0.5f, handler), handler));
+        engine.setDeferredEffects(false);
+        assert(engine.applyEffect(file, AJ::Effect::gain, gain(0, 10, 2.0f, handler), handler));
+        assert(graph->size() == 0);
+        assert(std::fabs((*file->pAudio)[0][5] - (*reference->pAudio)[0][5]) < 1e-5f);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Recorded, undone, played, committed and undone through the history\n";
+    }
+};
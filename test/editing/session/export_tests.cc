@@ -0,0 +1,306 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sndfile.h>
+
+#include "editing/session/export.h"
+#include "file_io/mp3_file.h"
+#include "file_io/wav_file.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "audio_fixtures.h"
+
+class ExportTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Export Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_float_wav_matches_render();
+        test_integer_exports();
+        test_pipelined_matches_inline();
+        test_mp3_export();
+        test_small_pools();
+        test_invalid_exports();
+
+        std::cout << "All Export Tests Completed Successfully.\n";
+    }
+
+private:
+    using Clip = AJ::editing::session::Clip;
+    using Session = AJ::editing::session::Session;
+    using Exporter = AJ::editing::session::Exporter;
+    using ExportOptions = AJ::editing::session::ExportOptions;
+    using ExportFormat = AJ::editing::session::ExportFormat;
+
+    static std::string temp_path(const std::string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    static std::shared_ptr<AJ::io::WAV_File> make_file(size_t frames, uint8_t channels, float frequency) {
+        return fixtures::make_file(frames, channels, [frequency](size_t ch, size_t i) {
+            return 0.4f * std::sin(frequency * (ch + 1) * i);
+        });
+    }
+
+    //* a few overlapping tracks, the session ends past a block boundary.
+    static void make_session(Session &session, AJ::error::IErrorHandler &handler) {
+        auto mono = make_file(70000, 1, 0.013f);
+        auto stereo = make_file(90000, 2, 0.0041f);
+
+        for (size_t t = 0; t < 6; ++t) {
+            auto track = session.addTrack(handler);
+            assert(track);
+            track->setGain(0.3f + 0.05f * t);
+            track->setPan(-0.9f + 0.3f * t);
+            const auto &source = t % 2 ? std::static_pointer_cast<AJ::io::AudioFile>(stereo)
+                                       : std::static_pointer_cast<AJ::io::AudioFile>(mono);
+            assert(track->timeline().add(Clip{ source, 1000 * t, 50000 + 3 * t, 7000 * t, 0.8f }, handler));
+        }
+    }
+
+    static std::vector<float> read_back(const std::string &path, int channels = 2) {
+        SF_INFO info = {};
+        SNDFILE *file = sf_open(path.c_str(), SFM_READ, &info);
+        assert(file && info.channels == channels);
+
+        std::vector<float> samples(static_cast<size_t>(info.frames) * channels);
+        assert(sf_readf_float(file, samples.data(), info.frames) == info.frames);
+        sf_close(file);
+        return samples;
+    }
+
+    static float max_error(const std::vector<float> &a, const std::vector<float> &b) {
+        assert(a.size() == b.size());
+        float error = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i) {
+            error = std::max(error, std::fabs(a[i] - b[i]));
+        }
+        return error;
+    }
+
+    static void print_stats(const Exporter &exporter) {
+        const auto &stats = exporter.stats();
+        std::cout << "    " << stats.blocks << " blocks " << (stats.pipelined ? "pipelined" : "inline")
+                  << ": render " << 1000.0 * stats.render << " ms, convert " << 1000.0 * stats.convert
+                  << " ms, write " << 1000.0 * stats.write << " ms, total " << 1000.0 * stats.total << " ms\n";
+    }
+
+    static void test_float_wav_matches_render() {
+        std::cout << "\nTest: A float WAV export holds the samples of a render\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        Session session(48000, handler, std::make_shared<AJ::utils::ThreadPool>(4), 8, 4096);
+        make_session(session, handler);
+
+        const size_t frames = session.length();
+        std::vector<float> out(2 * frames);
+        assert(session.render(0, frames, out.data(), handler));
+
+        const std::string path = temp_path("aj_export_float.wav");
+        ExportOptions options;
+        options.bitdepth = AJ::BitDepth_t::float_32;
+
+        Exporter exporter(session);
+        assert(exporter.run(path, options, handler));
+        assert(read_back(path) == out);
+        assert(exporter.stats().blocks == (frames + 4095) / 4096);
+        assert(handler.errors().empty());
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ " << frames << " frames exported\n";
+        print_stats(exporter);
+    }
+
+    static void test_integer_exports() {
+        std::cout << "\nTest: 16 and 24-bit exports are within a few steps of the render, with or without dither\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        Session session(48000, handler, std::make_shared<AJ::utils::ThreadPool>(4), 8, 1000);
+        make_session(session, handler);
+
+        //* a range that doesn't start or end on a block.
+        const size_t start = 12345, frames = 31000 + 17;
+        std::vector<float> out(2 * frames);
+        assert(session.render(start, frames, out.data(), handler));
+
+        const std::string path = temp_path("aj_export_int.wav");
+        Exporter exporter(session);
+
+        for (AJ::BitDepth_t bitdepth : { AJ::BitDepth_t::int_16, AJ::BitDepth_t::int_24 }) {
+            const float step = bitdepth == AJ::BitDepth_t::int_16 ? 1.0f / 32767.0f : 1.0f / 8388607.0f;
+
+            for (bool dither : { false, true }) {
+                ExportOptions options;
+                options.bitdepth = bitdepth;
+                options.dither = dither;
+                options.start = start;
+                options.frames = frames;
+
+                assert(exporter.run(path, options, handler));
+                //* rounding is half a step and TPDF dither adds up to one more. The samples are
+                //* written at 2^(bits-1) - 1 and read back at 2^(bits-1): up to one more at full scale.
+                assert(max_error(read_back(path), out) <= (dither ? 2.5f : 1.5f) * step);
+            }
+
+            std::cout << "  ✓ " << (bitdepth == AJ::BitDepth_t::int_16 ? 16 : 24) << "-bit\n";
+        }
+
+        ExportOptions options;
+        options.format = ExportFormat::Flac;
+        options.bitdepth = AJ::BitDepth_t::int_16;
+        options.start = start;
+        options.frames = frames;
+        const std::string flac = temp_path("aj_export_int.flac");
+        assert(exporter.run(flac, options, handler));
+        assert(max_error(read_back(flac), out) <= 2.5f / 32767.0f);
+        assert(handler.errors().empty());
+
+        std::filesystem::remove(path);
+        std::filesystem::remove(flac);
+        std::cout << "  ✓ FLAC\n";
+    }
+
+    static void test_pipelined_matches_inline() {
+        std::cout << "\nTest: The pipeline writes the same file as the stages run inline\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        Session pipelined(48000, handler, std::make_shared<AJ::utils::ThreadPool>(4), 8, 2048);
+        Session serial(48000, handler, nullptr, 8, 2048);
+        make_session(pipelined, handler);
+        make_session(serial, handler);
+
+        ExportOptions options;
+        options.bitdepth = AJ::BitDepth_t::int_24;
+        options.inflightBlocks = 3;
+
+        const std::string a = temp_path("aj_export_pipelined.wav");
+        const std::string b = temp_path("aj_export_inline.wav");
+        Exporter first(pipelined), second(serial);
+        assert(first.run(a, options, handler));
+        assert(second.run(b, options, handler));
+        assert(!second.stats().pipelined);
+
+        //* the dither is drawn block after block on both: exact.
+        assert(read_back(a) == read_back(b));
+        assert(first.stats().blocks == second.stats().blocks);
+        assert(handler.errors().empty());
+
+        std::filesystem::remove(a);
+        std::filesystem::remove(b);
+        std::cout << "  ✓ Same samples\n";
+        print_stats(first);
+        print_stats(second);
+    }
+
+    static void test_mp3_export() {
+        std::cout << "\nTest: An MP3 export is encoded from the session's blocks\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        Session session(44100, handler, std::make_shared<AJ::utils::ThreadPool>(4), 8, 4096);
+        make_session(session, handler);
+
+        const std::string path = temp_path("aj_export.mp3");
+        ExportOptions options;
+        options.format = ExportFormat::Mp3;
+
+        Exporter exporter(session);
+        assert(exporter.run(path, options, handler));
+        assert(handler.errors().empty());
+
+        //* the encoder delay and padding only add frames.
+        AJ::io::MP3_File file;
+        std::string file_path = path;
+        assert(file.setFilePath(file_path));
+        assert(file.read(handler));
+        assert(file.mInfo.channels == 2);
+        assert(file.pAudio->at(0).size() >= session.length());
+
+        std::filesystem::remove(path);
+        std::cout << "  ✓ " << file.pAudio->at(0).size() << " frames decoded\n";
+        print_stats(exporter);
+    }
+
+    static void test_small_pools() {
+        std::cout << "\nTest: Pools of one and two workers export without waiting on themselves\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        Session serial(48000, handler, nullptr, 8, 2048);
+        make_session(serial, handler);
+
+        ExportOptions wav;
+        wav.bitdepth = AJ::BitDepth_t::int_24;
+        wav.inflightBlocks = 3;
+        ExportOptions mp3;
+        mp3.format = ExportFormat::Mp3;
+
+        const std::string reference = temp_path("aj_export_small_reference.wav");
+        Exporter inline_exporter(serial);
+        assert(inline_exporter.run(reference, wav, handler));
+
+        for (size_t workers : { 1, 2 }) {
+            Session session(48000, handler, std::make_shared<AJ::utils::ThreadPool>(workers), 8, 2048);
+            make_session(session, handler);
+
+            const std::string a = temp_path("aj_export_small_pool.wav");
+            Exporter wav_exporter(session);
+            assert(wav_exporter.run(a, wav, handler));
+            assert(read_back(a) == read_back(reference));
+
+            //* render and the encoder's two stages don't fit: the MP3 export runs inline.
+            const std::string b = temp_path("aj_export_small_pool.mp3");
+            Exporter mp3_exporter(session);
+            assert(mp3_exporter.run(b, mp3, handler));
+            assert(!mp3_exporter.stats().pipelined);
+
+            AJ::io::MP3_File file;
+            std::string file_path = b;
+            assert(file.setFilePath(file_path));
+            assert(file.read(handler));
+            assert(file.pAudio->at(0).size() >= session.length());
+
+            std::filesystem::remove(a);
+            std::filesystem::remove(b);
+            std::cout << "  ✓ " << workers << " worker(s): same WAV samples, MP3 decoded\n";
+        }
+
+        assert(handler.errors().empty());
+        std::filesystem::remove(reference);
+    }
+
+    static void test_invalid_exports() {
+        std::cout << "\nTest: Empty ranges, unsupported bit depths and paths are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        Session session(48000, handler, nullptr, 8, 1024);
+        Exporter exporter(session);
+        const std::string path = temp_path("aj_export_invalid.wav");
+
+        //* an empty session.
+        assert(!exporter.run(path, ExportOptions(), handler));
+
+        make_session(session, handler);
+        ExportOptions options;
+        options.start = session.length();
+        assert(!exporter.run(path, options, handler));
+
+        options = ExportOptions();
+        options.format = ExportFormat::Flac;
+        options.bitdepth = AJ::BitDepth_t::int_32;
+        assert(!exporter.run(path, options, handler));
+
+        options.format = ExportFormat::Wav;
+        options.bitdepth = AJ::BitDepth_t::int_8;
+        assert(!exporter.run(path, options, handler));
+
+        assert(!exporter.run(temp_path("aj_no_such_directory/export.wav"), ExportOptions(), handler));
+
+        assert(handler.errors().size() == 5);
+        std::cout << "  ✓ Rejected\n";
+    }
+};
@@ -0,0 +1,229 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "editing/session/session.h"
+#include "editing/session/render_cache.h"
+#include "dsp/effect_chain.h"
+#include "dsp/gain.h"
+#include "dsp/echo.h"
+#include "file_io/wav_file.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "audio_fixtures.h"
+
+class RenderCacheTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Render Cache Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_cache_spills();
+        test_fader_change();
+        test_chain_change();
+        test_clip_edit();
+
+        std::cout << "All Render Cache Tests Completed Successfully.\n";
+    }
+
+private:
+    using Clip = AJ::editing::session::Clip;
+    using Session = AJ::editing::session::Session;
+    using RenderCache = AJ::editing::session::RenderCache;
+
+    static constexpr size_t kTracks = 12;
+    static constexpr size_t kBlock = 2048;
+    static constexpr size_t kLength = 40 * kBlock;
+
+    static std::shared_ptr<AJ::io::WAV_File> make_file(size_t frames, float frequency) {
+        return fixtures::make_file(frames, 2, [frequency](size_t ch, size_t i) {
+            return 0.5f * std::sin(frequency * (ch + 1) * i);
+        });
+    }
+
+    static std::shared_ptr<AJ::dsp::echo::Echo> make_echo(float decay, AJ::error::IErrorHandler &handler) {
+        AJ::dsp::echo::Params params{ 0, static_cast<AJ::sample_pos>(kLength) - 1, decay, 0.03f, 48000 };
+        auto echo = std::make_shared<AJ::dsp::echo::Echo>();
+        assert(echo->setParams(AJ::dsp::echo::EchoParams::create(params, handler), handler));
+        return echo;
+    }
+
+    //* every track: clips of one source and a chain of a gain and an echo (a stage with memory).
+    static void make_session(Session &session, const std::shared_ptr<AJ::io::WAV_File> &source,
+        AJ::error::IErrorHandler &handler) {
+
+        for (size_t t = 0; t < kTracks; ++t) {
+            auto track = session.addTrack(handler);
+            track->setGain(0.1f + 0.05f * t);
+            track->setPan(-0.8f + 0.13f * t);
+
+            for (size_t c = 0; c < 3; ++c) {
+                const size_t position = (t * 3001 + c * 11003) % (kLength - 20000);
+                assert(track->timeline().add(Clip{ source, 100 * t + c, 15000, position, 0.7f }, handler));
+            }
+
+            AJ::dsp::gain::Params params{ 0, static_cast<AJ::sample_pos>(kLength) - 1, 0.9f };
+            auto gain = std::make_shared<AJ::dsp::gain::Gain>();
+            assert(gain->setParams(AJ::dsp::gain::GainParams::create(params, handler), handler));
+
+            auto chain = std::make_shared<AJ::dsp::EffectChain>();
+            assert(chain->add(gain, handler) && chain->add(make_echo(0.4f, handler), handler));
+            assert(track->setChain(chain, handler));
+        }
+    }
+
+    static std::vector<float> render(Session &session, AJ::error::IErrorHandler &handler) {
+        std::vector<float> out(2 * kLength);
+        assert(session.render(0, kLength, out.data(), handler));
+        return out;
+    }
+
+    static void test_cache_spills() {
+        std::cout << "\nTest: Blocks over the budget spill to the directory and come back\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const auto dir = std::filesystem::temp_directory_path() / "aj_render_cache";
+        std::filesystem::remove_all(dir);
+        const size_t bytes = 2 * kBlock * sizeof(float);
+
+        std::vector<std::vector<float>> blocks(6, std::vector<float>(2 * kBlock));
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            for (size_t i = 0; i < blocks[b].size(); ++i) blocks[b][i] = static_cast<float>(b * 100000 + i);
+        }
+
+        std::vector<float> out(2 * kBlock);
+        {
+            RenderCache cache(3 * bytes, dir.string());
+            for (size_t b = 0; b < blocks.size(); ++b) cache.store(b, blocks[b].data(), kBlock, handler);
+            assert(cache.size() == 6 && cache.residentBytes() == 3 * bytes && cache.spilledBytes() == 3 * bytes);
+
+            //* the oldest block is on disk, reading it spills the least recently used one.
+            assert(cache.find(0, out.data(), kBlock, handler) && out == blocks[0]);
+            assert(cache.residentBytes() == 3 * bytes && cache.spilledBytes() == 3 * bytes);
+            assert(!cache.find(7, out.data(), kBlock, handler) && !cache.find(1, out.data(), kBlock - 1, handler));
+            assert(cache.hits() == 1 && cache.misses() == 2);
+
+            //* the disk has its own budget, the oldest spilled blocks go first.
+            cache.setSpillBudget(2 * bytes, handler);
+            assert(cache.size() == 5 && cache.spilledBytes() == 2 * bytes);
+            assert(std::distance(std::filesystem::directory_iterator(dir), {}) == 2);
+
+            for (size_t b = 0; b < blocks.size(); ++b) {
+                if (cache.find(b, out.data(), kBlock, handler)) assert(out == blocks[b]);
+            }
+        }
+        assert(std::filesystem::is_empty(dir));
+
+        //* without a directory, blocks over the budget are dropped.
+        RenderCache dropping(2 * bytes);
+        for (size_t b = 0; b < blocks.size(); ++b) dropping.store(b, blocks[b].data(), kBlock, handler);
+        assert(dropping.size() == 2 && dropping.find(5, out.data(), kBlock, handler) && !dropping.find(0, out.data(), kBlock, handler));
+        dropping.clear();
+        assert(dropping.size() == 0 && dropping.residentBytes() == 0);
+
+        assert(!handler.hasErrors());
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ Spilled, read back, capped on disk, files removed with the cache\n";
+    }
+
+    static void test_fader_change() {
+        std::cout << "\nTest: A gain, pan or mute change renders no track again\n";
+        AJ::error::CollectingErrorHandler handler;
+        auto source = make_file(20000, 0.013f);
+        auto pool = std::make_shared<AJ::utils::ThreadPool>(4);
+
+        Session cached(48000, handler, pool, kTracks, kBlock), plain(48000, handler, pool, kTracks, kBlock);
+        make_session(cached, source, handler);
+        make_session(plain, source, handler);
+        auto cache = std::make_shared<RenderCache>();
+        cached.mixer().setRenderCache(cache);
+
+        assert(render(cached, handler) == render(plain, handler));
+        const size_t blocks = kLength / kBlock;
+        assert(cache->misses() == kTracks * blocks && cache->hits() == 0);
+
+        for (Session *session : { &cached, &plain }) {
+            session->tracks()[3]->setGain(1.5f);
+            session->tracks()[7]->setPan(0.9f);
+            session->tracks()[9]->setMute(true);
+        }
+        assert(render(cached, handler) == render(plain, handler));
+        assert(cache->misses() == kTracks * blocks && cache->hits() == (kTracks - 1) * blocks);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ " << cache->hits() << " blocks from the cache, the mix matches an uncached session\n";
+    }
+
+    static void test_chain_change() {
+        std::cout << "\nTest: A changed chain renders only its track again\n";
+        AJ::error::CollectingErrorHandler handler;
+        auto source = make_file(20000, 0.007f);
+
+        Session cached(48000, handler, nullptr, kTracks, kBlock), plain(48000, handler, nullptr, kTracks, kBlock);
+        make_session(cached, source, handler);
+        make_session(plain, source, handler);
+        auto cache = std::make_shared<RenderCache>();
+        cached.mixer().setRenderCache(cache);
+        render(cached, handler);
+
+        const size_t blocks = kLength / kBlock;
+        const uint64_t misses = cache->misses();
+
+        //* the parameters changed in place: the track is told.
+        for (Session *session : { &cached, &plain }) {
+            auto track = session->tracks()[5];
+            AJ::dsp::echo::Params params{ 0, static_cast<AJ::sample_pos>(kLength) - 1, 0.6f, 0.01f, 48000 };
+            assert(track->chain()->at(1)->setParams(AJ::dsp::echo::EchoParams::create(params, handler), handler));
+            assert(track->chainChanged(handler));
+        }
+        assert(render(cached, handler) == render(plain, handler));
+        assert(cache->misses() - misses == blocks);
+
+        //* a track out of the cache always runs its chain.
+        cached.tracks()[2]->setCached(false);
+        assert(render(cached, handler) == render(plain, handler));
+        assert(cache->misses() - misses == blocks);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ " << blocks << " blocks of one track rendered again\n";
+    }
+
+    static void test_clip_edit() {
+        std::cout << "\nTest: A clip added mid-session renders the blocks from it on, the echo carries on\n";
+        AJ::error::CollectingErrorHandler handler;
+        auto source = make_file(20000, 0.019f);
+
+        Session cached(48000, handler, nullptr, kTracks, kBlock), plain(48000, handler, nullptr, kTracks, kBlock);
+        make_session(cached, source, handler);
+        make_session(plain, source, handler);
+        auto cache = std::make_shared<RenderCache>();
+        cached.mixer().setRenderCache(cache);
+        render(cached, handler);
+
+        const uint64_t misses = cache->misses();
+        const size_t edit = 25 * kBlock + 100;
+        for (Session *session : { &cached, &plain }) {
+            assert(session->tracks()[1]->timeline().add(Clip{ source, 0, 1000, edit, 1.0f }, handler));
+        }
+
+        //* block 25 follows 25 blocks from the cache: the echo's state is brought up to it first.
+        assert(render(cached, handler) == render(plain, handler));
+        assert(cache->misses() - misses == kLength / kBlock - 25);
+
+        //* a render from the middle is a new stream, rendered once and then found.
+        std::vector<float> a(2 * 4 * kBlock), b(2 * 4 * kBlock);
+        assert(cached.render(30 * kBlock, 4 * kBlock, a.data(), handler));
+        assert(plain.render(30 * kBlock, 4 * kBlock, b.data(), handler));
+        assert(a == b);
+        const uint64_t streamed = cache->misses();
+        assert(cached.render(30 * kBlock, 4 * kBlock, a.data(), handler) && a == b);
+        assert(cache->misses() == streamed);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ " << kLength / kBlock - 25 << " blocks of one track rendered again, samples unchanged\n";
+    }
+};
@@ -0,0 +1,260 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "editing/session/session.h"
+#include "dsp/effect_chain.h"
+#include "dsp/gain.h"
+#include "dsp/reverse.h"
+#include "file_io/wav_file.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "audio_fixtures.h"
+
+class SessionTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Session Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_mix_matches_reference();
+        test_parallel_matches_serial();
+        test_track_chain();
+        test_bounce();
+        test_invalid_session();
+
+        std::cout << "All Session Tests Completed Successfully.\n";
+    }
+
+private:
+    using Clip = AJ::editing::session::Clip;
+    using Session = AJ::editing::session::Session;
+
+    static std::shared_ptr<AJ::io::WAV_File> make_file(size_t frames, uint8_t channels, float frequency) {
+        return fixtures::make_file(frames, channels, [frequency](size_t ch, size_t i) {
+            return 0.5f * std::sin(frequency * (ch + 1) * i);
+        });
+    }
+
+    /**
+     * @brief `tracks` tracks of random clips from a mono, a stereo and an int16 stereo source,
+     * with random gain and pan, every fifth track muted.
+     */
+    static void make_session(Session &session, size_t tracks, size_t length, AJ::error::IErrorHandler &handler) {
+        auto mono = make_file(200000, 1, 0.011f);
+        auto stereo = make_file(300000, 2, 0.0037f);
+        auto compact = make_file(150000, 2, 0.023f);
+        assert(compact->setStorage(AJ::io::SampleStorage::Int16, handler));
+        const std::shared_ptr<AJ::io::AudioFile> sources[] = { mono, stereo, compact };
+
+        uint32_t state = 99;
+        auto next = [&](size_t bound) {
+            state = state * 1664525u + 1013904223u;
+            return (state >> 8) % bound;
+        };
+
+        for (size_t t = 0; t < tracks; ++t) {
+            auto track = session.addTrack(handler);
+            assert(track);
+            track->setGain(0.2f + 0.01f * next(100));
+            track->setPan(-1.0f + 0.02f * next(101));
+            track->setMute(t % 5 == 4);
+
+            for (size_t c = 0; c < 6; ++c) {
+                const auto &source = sources[next(3)];
+                Clip clip;
+                clip.source = source;
+                clip.sourceStart = next(source->channelFrames() / 2);
+                clip.frames = 1 + next(source->channelFrames() - clip.sourceStart - 1);
+                clip.position = next(length);
+                clip.gain = 0.5f + 0.01f * next(100);
+                assert(track->timeline().add(clip, handler));
+            }
+        }
+    }
+
+    //* the mix computed sample by sample, straight from the definition.
+    static std::vector<float> reference(const Session &session, size_t position, size_t frames) {
+        std::vector<float> out(2 * frames, 0.0f);
+        for (const auto &track : session.tracks()) {
+            if (track->muted()) continue;
+            float left, right;
+            track->sideGains(left, right);
+
+            for (const Clip &clip : track->timeline().clips()) {
+                const AJ::io::AudioFile &source = *clip.source;
+                for (size_t f = 0; f < frames; ++f) {
+                    const size_t frame = position + f;
+                    if (frame < clip.position || frame >= clip.position + clip.frames) continue;
+                    const size_t at = clip.sourceStart + frame - clip.position;
+                    float l, r;
+                    source.readFrames(0, at, 1, &l);
+                    r = l;
+                    if (source.mInfo.channels == 2) source.readFrames(1, at, 1, &r);
+                    out[2 * f] += left * clip.gain * l;
+                    out[2 * f + 1] += right * clip.gain * r;
+                }
+            }
+        }
+        return out;
+    }
+
+    static void assert_close(const std::vector<float> &a, const std::vector<float> &b) {
+        assert(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            assert(std::fabs(a[i] - b[i]) <= 1e-4f * (1.0f + std::fabs(a[i])));
+        }
+    }
+
+    static void test_mix_matches_reference() {
+        std::cout << "\nTest: A mix of overlapping mono, stereo and compact clips matches the reference\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        Session session(48000, handler, nullptr, 16, 1000);
+        assert(session.isValid());
+        make_session(session, 16, 100000, handler);
+
+        //* blocks that don't divide the range, from a position that isn't block aligned.
+        const size_t position = 54321, frames = 20000 + 7;
+        std::vector<float> out(2 * frames);
+        assert(session.render(position, frames, out.data(), handler));
+        assert_close(reference(session, position, frames), out);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ " << frames << " frames of " << session.tracks().size() << " tracks match\n";
+    }
+
+    static void test_parallel_matches_serial() {
+        std::cout << "\nTest: Rendering the tracks on the pool gives the same samples\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 1 << 19;
+        Session serial(48000, handler, nullptr, 64);
+        Session parallel(48000, handler, std::make_shared<AJ::utils::ThreadPool>(), 64);
+        make_session(serial, 64, frames, handler);
+        make_session(parallel, 64, frames, handler);
+
+        std::vector<float> a(2 * frames), b(2 * frames);
+        auto begin = std::chrono::steady_clock::now();
+        assert(serial.render(0, frames, a.data(), handler));
+        const double serialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        begin = std::chrono::steady_clock::now();
+        assert(parallel.render(0, frames, b.data(), handler));
+        const double parallelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        //* the tracks are summed in the same order on every thread count: exact.
+        assert(a == b);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ 64 tracks, " << frames << " frames: " << serialMs << " ms serial, "
+                  << parallelMs << " ms on the pool\n";
+    }
+
+    static void test_track_chain() {
+        std::cout << "\nTest: A track chain runs in time line frames, across blocks and seeks\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto file = make_file(10000, 2, 0.01f);
+        Session session(48000, handler, std::make_shared<AJ::utils::ThreadPool>(2), 4, 256);
+        auto track = session.addTrack(handler);
+        assert(track->timeline().add(Clip{ file, 0, 10000, 500, 1.0f }, handler));
+        track->setPan(-1.0f);
+
+        AJ::dsp::gain::Params params{ 3000, 5999, 2.0f };
+        auto gain = std::make_shared<AJ::dsp::gain::Gain>();
+        assert(gain->setParams(AJ::dsp::gain::GainParams::create(params, handler), handler));
+        auto chain = std::make_shared<AJ::dsp::EffectChain>();
+        assert(chain->add(gain, handler));
+        assert(track->setChain(chain, handler));
+
+        const size_t frames = 11000;
+        std::vector<float> out(2 * frames);
+        assert(session.render(0, frames, out.data(), handler));
+
+        //* hard left: only the left side, doubled on time line frames [3000, 5999].
+        for (size_t f = 0; f < frames; ++f) {
+            const float source = f >= 500 && f < 10500 ? (*file->pAudio)[0][f - 500] : 0.0f;
+            const float expected = f >= 3000 && f < 6000 ? 2.0f * source : source;
+            assert(std::fabs(out[2 * f] - expected) <= 1e-6f);
+            assert(std::fabs(out[2 * f + 1]) <= 1e-6f);
+        }
+
+        //* a jump back into the range renders the same frames.
+        std::vector<float> again(2 * 1000);
+        assert(session.render(4000, 1000, again.data(), handler));
+        assert(std::equal(again.begin(), again.end(), out.begin() + 2 * 4000));
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Chain applied on its range\n";
+    }
+
+    static void test_bounce() {
+        std::cout << "\nTest: Bouncing a session writes its whole length into a stereo file\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        Session session(44100, handler, std::make_shared<AJ::utils::ThreadPool>(4), 8);
+        make_session(session, 8, 50000, handler);
+
+        const size_t frames = session.length();
+        std::vector<float> out(2 * frames);
+        assert(session.render(0, frames, out.data(), handler));
+
+        auto mixdown = make_file(100, 1, 0.1f);
+        mixdown->buildLevelIndex();
+        assert(session.bounce(*mixdown, handler));
+        assert(mixdown->mInfo.channels == 2 && mixdown->mInfo.samplerate == 44100);
+        assert(mixdown->channelFrames() == frames && mixdown->mInfo.length == 2 * frames);
+        for (size_t f = 0; f < frames; ++f) {
+            assert((*mixdown->pAudio)[0][f] == out[2 * f] && (*mixdown->pAudio)[1][f] == out[2 * f + 1]);
+        }
+
+        AJ::dsp::kernels::Levels levels;
+        assert(mixdown->levels(1, 0, static_cast<AJ::sample_pos>(frames) - 1, levels, handler));
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ " << frames << " frames bounced\n";
+    }
+
+    static void test_invalid_session() {
+        std::cout << "\nTest: Invalid clips, chains, tracks and blocks are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto file = make_file(1000, 2, 0.1f);
+        Session session(48000, handler, nullptr, 2, 512);
+        auto track = session.addTrack(handler);
+        assert(session.addTrack(handler));
+        assert(!session.addTrack(handler));
+
+        assert(!track->timeline().add(Clip{ nullptr, 0, 10, 0, 1.0f }, handler));
+        assert(!track->timeline().add(Clip{ file, 0, 0, 0, 1.0f }, handler));
+        assert(!track->timeline().add(Clip{ file, 900, 101, 0, 1.0f }, handler));
+        assert(!track->timeline().add(Clip{ file, 1000, 1, 0, 1.0f }, handler));
+
+        auto wide = make_file(1000, 2, 0.1f);
+        wide->mInfo.channels = 3;
+        assert(!track->timeline().add(Clip{ wide, 0, 10, 0, 1.0f }, handler));
+        assert(track->timeline().size() == 0);
+
+        //* a stage that needs the whole buffer can't run on blocks.
+        auto chain = std::make_shared<AJ::dsp::EffectChain>();
+        assert(chain->add(std::make_shared<AJ::dsp::reverse::Reverse>(), handler));
+        assert(!track->setChain(chain, handler));
+        assert(!track->chain());
+
+        std::vector<float> out(2 * 1024);
+        assert(!session.mixer().mix(out.data(), 0, 1024, nullptr, handler));
+
+        //* a compact file can't be replaced by a bounce.
+        assert(file->setStorage(AJ::io::SampleStorage::Int16, handler));
+        assert(!session.bounce(*file, handler));
+
+        assert(handler.errors().size() == 9);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "editing/transaction.h"
+#include "editing/cut.h"
+#include "undo_system/undo.h"
+#include "file_io/wav_file.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "audio_fixtures.h"
+
+class TransactionTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Transaction Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_cut_list_matches_reference();
+        test_parallel_matches_serial();
+        test_commit_is_undoable();
+        test_invalid_edits();
+
+        std::cout << "All Transaction Tests Completed Successfully.\n";
+    }
+
+private:
+    //* frame i of channel ch holds first + i + ch * 0.5 (exact in float up to 2^23).
+    /**
+     * @brief Random cuts (some overlapping) and inserts outside of them, recorded in `edits`
+     * and applied frame by frame to the left channel in `reference`.
+     */
+    static void make_edits(size_t frames, size_t cuts, size_t inserts, AJ::editing::transaction::Transaction &edits,
+        std::vector<float> &reference, AJ::error::IErrorHandler &handler) {
+        uint32_t state = 4242;
+        auto next = [&](size_t bound) {
+            state = state * 1664525u + 1013904223u;
+            return (state >> 8) % bound;
+        };
+
+        std::vector<char> removed(frames, 0);
+        for (size_t i = 0; i < cuts; ++i) {
+            const size_t start = next(frames - 2000), length = 1 + next(1500);
+            assert(edits.cut(start, start + length - 1, handler));
+            for (size_t f = start; f < start + length; ++f) removed[f] = 1;
+        }
+
+        std::map<size_t, std::vector<float>> inserted;
+        float fresh = 1e7f;
+        for (size_t i = 0; i < inserts; ++i) {
+            size_t at = next(frames + 1);
+            //? an insert must not fall inside a cut, one at the first frame of a cut is fine.
+            while (at > 0 && at < frames && removed[at] && removed[at - 1]) --at;
+
+            const size_t length = 1 + next(300);
+            AJ::AudioSamples audio = fixtures::ramp(length, fresh, 1.0f);
+            assert(edits.insert(at, audio, handler));
+            inserted[at].insert(inserted[at].end(), (*audio)[0].begin(), (*audio)[0].end());
+            fresh += 1000.0f;
+        }
+
+        reference.clear();
+        for (size_t f = 0; f <= frames; ++f) {
+            auto it = inserted.find(f);
+            if (it != inserted.end()) reference.insert(reference.end(), it->second.begin(), it->second.end());
+            if (f < frames && !removed[f]) reference.push_back(static_cast<float>(f));
+        }
+    }
+
+    static void test_cut_list_matches_reference() {
+        std::cout << "\nTest: A cut list with inserts matches the frame by frame result, in one pass\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 1 << 21;
+        auto file = fixtures::make_file(fixtures::ramp(frames, 0.0f, 1.0f));
+        file->buildLevelIndex();
+
+        AJ::editing::transaction::Transaction edits;
+        std::vector<float> reference;
+        make_edits(frames, 2000, 200, edits, reference, handler);
+        assert(edits.size() == 2200);
+
+        const auto begin = std::chrono::steady_clock::now();
+        assert(edits.commit(file, handler));
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        assert(edits.empty());
+        assert(file->channelFrames() == reference.size() && file->mInfo.length == 2 * reference.size());
+        for (size_t i = 0; i < reference.size(); ++i) {
+            assert((*file->pAudio)[0][i] == reference[i]);
+            assert((*file->pAudio)[1][i] == reference[i] + 0.5f);
+        }
+
+        //* the level index follows the new samples.
+        AJ::dsp::kernels::Levels levels;
+        assert(file->levels(0, 0, static_cast<AJ::sample_pos>(reference.size()) - 1, levels, handler));
+        assert(levels.max == *std::max_element(reference.begin(), reference.end()));
+
+        //* 200 cuts made one Cut at a time (a pass over the file each) against the same cuts in one commit.
+        auto sequential = fixtures::make_file(fixtures::ramp(frames, 0.0f, 1.0f));
+        AJ::editing::transaction::Transaction few;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < 200; ++i) {
+            AJ::editing::cut::Cut cut;
+            assert(cut.setRange(1000 * i, 1000 * i + 499, handler));
+            assert(cut.process(sequential, handler));
+            assert(few.cut(1500 * i, 1500 * i + 499, handler));
+        }
+        const double cutMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        auto batched = fixtures::make_file(fixtures::ramp(frames, 0.0f, 1.0f));
+        assert(few.commit(batched, handler));
+        assert(*batched->pAudio == *sequential->pAudio);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ 2200 edits committed in " << ms << " ms (200 Cut calls: " << cutMs << " ms)\n";
+    }
+
+    static void test_parallel_matches_serial() {
+        std::cout << "\nTest: Gathering the channels on the pool gives the same samples\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 3000000 + 7;
+        AJ::editing::transaction::Transaction serial, parallel;
+        std::vector<float> reference;
+        make_edits(frames, 500, 100, serial, reference, handler);
+        make_edits(frames, 500, 100, parallel, reference, handler);
+
+        auto a = fixtures::make_file(fixtures::ramp(frames, 0.0f, 1.0f)), b = fixtures::make_file(fixtures::ramp(frames, 0.0f, 1.0f));
+        AJ::utils::ThreadPool pool(4);
+        assert(serial.commit(a, handler));
+        assert(parallel.commit(b, handler, &pool));
+        assert(*a->pAudio == *b->pAudio && a->channelFrames() == reference.size());
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Same " << reference.size() << " frames\n";
+    }
+
+    static void test_commit_is_undoable() {
+        std::cout << "\nTest: A commit recorded in an undo state is undone and redone\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto file = fixtures::make_file(fixtures::ramp(100000, 0.0f, 1.0f));
+        const AJ::AudioBuffer original = *file->pAudio;
+
+        AJ::editing::transaction::Transaction edits;
+        assert(edits.cut(5000, 9999, handler));
+        assert(edits.insert(30000, fixtures::ramp(100, -500.0f, 1.0f), handler));
+        assert(edits.insert(5000, fixtures::ramp(10, -100.0f, 1.0f), handler));
+        assert(edits.cut(8000, 20000, handler));
+        assert(edits.insert(100000, fixtures::ramp(7, -1.0f, 1.0f), handler));
+
+        AJ::undo::State state("cut list");
+        assert(edits.commit(file, handler, nullptr, &state));
+        const AJ::AudioBuffer edited = *file->pAudio;
+        assert(file->channelFrames() == 100000 - 15001 + 10 + 100 + 7);
+
+        AJ::undo::UndoSystem undo;
+        undo.push(std::move(state), handler);
+        assert(undo.undo(handler));
+        assert(*file->pAudio == original && file->mInfo.length == 200000);
+        assert(undo.redo(handler));
+        assert(*file->pAudio == edited);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ " << edited[0].size() << " frames after the commit, original restored\n";
+    }
+
+    static void test_invalid_edits() {
+        std::cout << "\nTest: Invalid edits are rejected, the file is left unchanged\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto file = fixtures::make_file(fixtures::ramp(1000, 0.0f, 1.0f));
+        const AJ::AudioBuffer original = *file->pAudio;
+
+        AJ::editing::transaction::Transaction edits;
+        assert(!edits.cut(10, 5, handler));
+        assert(!edits.cut(-1, 5, handler));
+        assert(!edits.insert(-1, fixtures::ramp(10, 0.0f, 1.0f), handler));
+        assert(!edits.insert(5, std::make_shared<AJ::AudioBuffer>(), handler));
+        assert(edits.empty());
+
+        //* an insert inside a cut.
+        assert(edits.cut(100, 199, handler));
+        assert(edits.insert(150, fixtures::ramp(10, 0.0f, 1.0f), handler));
+        assert(!edits.commit(file, handler));
+        assert(edits.size() == 2);
+        edits.clear();
+
+        //* a cut past the end.
+        assert(edits.cut(900, 1000, handler));
+        assert(!edits.commit(file, handler));
+        edits.clear();
+
+        //* an insert of uneven channels.
+        AJ::AudioSamples uneven = fixtures::ramp(10, 0.0f, 1.0f);
+        (*uneven)[1].resize(9);
+        assert(edits.insert(10, uneven, handler));
+        assert(!edits.commit(file, handler));
+        edits.clear();
+
+        //* compact samples.
+        assert(file->setStorage(AJ::io::SampleStorage::Int16, handler));
+        assert(edits.cut(0, 9, handler));
+        assert(!edits.commit(file, handler));
+        assert(file->setStorage(AJ::io::SampleStorage::Float32, handler));
+
+        assert(handler.errors().size() == 8);
+        assert(file->channelFrames() == 1000);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
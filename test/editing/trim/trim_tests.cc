@@ -0,0 +1,160 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "editing/trim.h"
+#include "undo_system/undo.h"
+#include "file_io/wav_file.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+#include "audio_fixtures.h"
+
+class TrimTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Auto-Trim Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_trims_edges_with_pad();
+        test_inner_silences();
+        test_trim_is_undoable();
+        test_nothing_to_trim();
+        test_invalid_options();
+
+        std::cout << "All Auto-Trim Tests Completed Successfully.\n";
+    }
+
+private:
+    //* stereo, silent except for sine sections [start, end) (the right channel at half the level).
+    static std::shared_ptr<AJ::io::WAV_File> make_file(size_t frames, const std::vector<std::pair<size_t, size_t>> &sounds) {
+        return fixtures::make_file(frames, 2, [&sounds](size_t ch, size_t i) {
+            for (const auto &[start, end] : sounds) {
+                if (i >= start && i < end) return (ch == 0 ? 0.5f : 0.25f) * std::sin(0.01f * (i - start) + 0.5f);
+            }
+            return 0.0f;
+        });
+    }
+
+    static AJ::editing::trim::Options options(bool inner) {
+        AJ::editing::trim::Options options;
+        options.mThresholdDb = -60.0f;
+        options.mMinSilenceMs = 100.0f;
+        options.mPadMs = 10.0f;
+        options.mInner = inner;
+        return options;
+    }
+
+    static void test_trims_edges_with_pad() {
+        std::cout << "\nTest: Leading and trailing silence go, the pad next to the sound stays\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto file = make_file(200000, { { 48000, 120000 } });
+        const float first = file->pAudio->at(0)[48000];
+
+        AJ::editing::trim::AutoTrim trim;
+        assert(trim.setOptions(options(false), handler));
+        assert(trim.process(file, handler));
+
+        //* 480 frames of pad on each side of the 72000 frames of sound.
+        assert(file->channelFrames() == 72000 + 2 * 480);
+        assert(file->mInfo.length == 2 * (72000 + 2 * 480));
+        assert(file->pAudio->at(0)[479] == 0.0f && file->pAudio->at(0)[480] == first);
+        assert(file->pAudio->at(1).size() == file->channelFrames());
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ " << file->channelFrames() << " frames left\n";
+    }
+
+    static void test_inner_silences() {
+        std::cout << "\nTest: With mInner, long inner silences shrink to two pads, short ones stay\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ThreadPool pool(2);
+
+        //* gaps of 20000 (trimmed) and 2000 (< 100 ms, kept) frames.
+        auto file = make_file(150000, { { 10000, 40000 }, { 60000, 70000 }, { 72000, 90000 } });
+
+        AJ::editing::trim::AutoTrim trim;
+        assert(trim.setOptions(options(true), handler));
+
+        AJ::editing::transaction::Transaction edits;
+        AJ::sample_c removed = 0;
+        assert(trim.record(*file, edits, removed, handler));
+        assert(edits.size() == 3);
+
+        assert(edits.commit(file, handler, &pool));
+        assert(file->channelFrames() == 150000 - removed);
+        assert(file->channelFrames() == 30000 + 960 + 10000 + 2000 + 18000 + 2 * 480);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ " << removed << " frames removed in " << 3 << " cuts\n";
+    }
+
+    static void test_trim_is_undoable() {
+        std::cout << "\nTest: A trim recorded in an undo state is undone\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto file = make_file(100000, { { 30000, 60000 } });
+        file->buildLevelIndex();
+        const AJ::AudioBuffer original = *file->pAudio;
+
+        AJ::editing::trim::AutoTrim trim;
+        AJ::undo::State state("auto-trim");
+        assert(trim.setOptions(options(false), handler));
+        assert(trim.process(file, handler, nullptr, &state));
+        assert(file->channelFrames() == 30000 + 960);
+
+        AJ::undo::UndoSystem undo;
+        undo.push(std::move(state), handler);
+        assert(undo.undo(handler));
+        assert(*file->pAudio == original && file->mInfo.length == 200000);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Original restored\n";
+    }
+
+    static void test_nothing_to_trim() {
+        std::cout << "\nTest: Sound up to the edges and a silent file are left alone\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::editing::trim::AutoTrim trim;
+        assert(trim.setOptions(options(false), handler));
+
+        auto full = make_file(50000, { { 0, 50000 } });
+        assert(trim.process(full, handler));
+        assert(full->channelFrames() == 50000);
+
+        auto silent = make_file(50000, {});
+        assert(trim.process(silent, handler));
+        assert(silent->channelFrames() == 50000);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Unchanged\n";
+    }
+
+    static void test_invalid_options() {
+        std::cout << "\nTest: Invalid options are rejected and the previous ones kept\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::editing::trim::AutoTrim trim;
+        auto bad = options(false);
+        bad.mThresholdDb = 1.0f;
+        assert(!trim.setOptions(bad, handler));
+
+        bad = options(false);
+        bad.mMinSilenceMs = 0.0f;
+        assert(!trim.setOptions(bad, handler));
+
+        bad = options(false);
+        bad.mPadMs = NAN;
+        assert(!trim.setOptions(bad, handler));
+
+        assert(handler.errors().size() == 3);
+        assert(trim.options().mThresholdDb == AJ::kTrimThresholdDb);
+        assert(!trim.process(nullptr, handler));
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
@@ -0,0 +1,239 @@
+#include <iostream>
+#include <chrono>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include <sndfile.h>
+
+#include "dsp/effect_chain.h"
+#include "dsp/gain.h"
+#include "dsp/fade.h"
+#include "dsp/echo.h"
+#include "dsp/distortion.h"
+#include "dsp/reverse.h"
+#include "core/error_handler.h"
+#include "core/aj_audio_engine.h"
+#include "file_io/mapped_wav.h"
+
+class EffectChainTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning EffectChain Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_chain_matches_sequential();
+        test_chain_with_whole_buffer_stage();
+        test_chain_block_streaming();
+        test_process_file();
+
+        std::cout << "All EffectChain Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::Float make_signal(size_t frames) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = 0.4f * std::sin(0.003f * i) + 0.2f * std::sin(0.05f * i);
+        }
+        return signal;
+    }
+
+    static std::shared_ptr<AJ::dsp::gain::Gain> make_gain(AJ::sample_pos start, AJ::sample_pos end,
+        AJ::error::IErrorHandler &handler) {
+        AJ::dsp::gain::Params p{ start, end, 1.5f };
+        auto gain = std::make_shared<AJ::dsp::gain::Gain>();
+        assert(gain->setParams(AJ::dsp::gain::GainParams::create(p, handler), handler));
+        return gain;
+    }
+
+    static std::shared_ptr<AJ::dsp::fade::Fade> make_fade(AJ::sample_pos start, AJ::sample_pos end,
+        AJ::error::IErrorHandler &handler) {
+        AJ::dsp::fade::Params p{ start, end, 1.0f, 0.0f, AJ::dsp::fade::FadeMode::In };
+        auto fade = std::make_shared<AJ::dsp::fade::Fade>();
+        assert(fade->setParams(AJ::dsp::fade::FadeParams::create(p, handler), handler));
+        return fade;
+    }
+
+    static std::shared_ptr<AJ::dsp::echo::Echo> make_echo(AJ::sample_pos start, AJ::sample_pos end,
+        AJ::error::IErrorHandler &handler) {
+        AJ::dsp::echo::Params p{ start, end, 0.5f, 0.1f, 44100 };
+        auto echo = std::make_shared<AJ::dsp::echo::Echo>();
+        assert(echo->setParams(AJ::dsp::echo::EchoParams::create(p, handler), handler));
+        return echo;
+    }
+
+    static void test_chain_matches_sequential() {
+        std::cout << "\nTest: Chain result matches sequential applyEffect calls\n";
+        AJ::error::ConsoleErrorHandler handler;
+
+        const size_t frames = 10 * 44100 + 123;
+        AJ::Float expected = make_signal(frames);
+        AJ::Float fused = expected;
+
+        auto gain = make_gain(0, frames - 1, handler);
+        auto fade = make_fade(1000, 5 * 44100, handler);
+        auto echo = make_echo(500, frames - 1000, handler);
+
+        auto seq_start = std::chrono::high_resolution_clock::now();
+        assert(gain->process(expected, handler));
+        assert(fade->process(expected, handler));
+        assert(echo->process(expected, handler));
+        auto seq_end = std::chrono::high_resolution_clock::now();
+
+        AJ::dsp::EffectChain chain;
+        assert(chain.add(gain, handler));
+        assert(chain.add(fade, handler));
+        assert(chain.add(echo, handler));
+        assert(chain.supportsBlockProcessing());
+
+        auto chain_start = std::chrono::high_resolution_clock::now();
+        assert(chain.process(fused, handler));
+        auto chain_end = std::chrono::high_resolution_clock::now();
+
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(expected[i] - fused[i]) < 1e-5f);
+        }
+
+        std::chrono::duration<double> seq_time = seq_end - seq_start;
+        std::chrono::duration<double> chain_time = chain_end - chain_start;
+        std::cout << "Sequential: " << seq_time.count() << "s, Chain: " << chain_time.count() << "s\n";
+        std::cout << "  ✓ Fused chain output matches.\n";
+    }
+
+    static void test_chain_with_whole_buffer_stage() {
+        std::cout << "\nTest: Chain with a whole-buffer stage (reverse)\n";
+        AJ::error::ConsoleErrorHandler handler;
+
+        const size_t frames = 50000;
+        AJ::Float expected = make_signal(frames);
+        AJ::Float fused = expected;
+
+        auto gain = make_gain(0, frames - 1, handler);
+        auto fade = make_fade(0, frames / 2, handler);
+
+        AJ::dsp::reverse::Params rp{ 0, frames - 1 };
+        auto reverse = std::make_shared<AJ::dsp::reverse::Reverse>();
+        assert(reverse->setParams(AJ::dsp::reverse::ReverseParams::create(rp, handler), handler));
+
+        assert(gain->process(expected, handler));
+        assert(reverse->process(expected, handler));
+        assert(fade->process(expected, handler));
+
+        AJ::dsp::EffectChain chain(1000);
+        assert(chain.add(gain, handler));
+        assert(chain.add(reverse, handler));
+        assert(chain.add(fade, handler));
+        assert(!chain.supportsBlockProcessing());
+        assert(chain.process(fused, handler));
+
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(expected[i] - fused[i]) < 1e-5f);
+        }
+
+        std::cout << "  ✓ Whole-buffer stage splits the chain correctly.\n";
+    }
+
+    static void test_chain_block_streaming() {
+        std::cout << "\nTest: Chain processBlock on interleaved stereo blocks\n";
+        AJ::error::ConsoleErrorHandler handler;
+
+        const size_t frames = 4096 * 3 + 17;
+        AJ::Float left = make_signal(frames);
+        AJ::Float right = make_signal(frames);
+        for (auto &s : right) s *= -0.5f;
+
+        AJ::Float interleaved(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            interleaved[2 * i] = left[i];
+            interleaved[2 * i + 1] = right[i];
+        }
+
+        AJ::dsp::EffectChain chain;
+        assert(chain.add(make_gain(10, frames - 10, handler), handler));
+        assert(chain.add(make_echo(0, frames - 1, handler), handler));
+
+        assert(chain.process(left, handler));
+        assert(chain.process(right, handler));
+
+        auto state = chain.createState(2, handler);
+        assert(state);
+
+        for (size_t pos = 0; pos < frames; pos += 300) {
+            size_t n = std::min<size_t>(300, frames - pos);
+            assert(chain.processBlock(interleaved.data() + pos * 2, n, 2, *state, handler));
+        }
+
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(interleaved[2 * i] - left[i]) < 1e-5f);
+            assert(std::fabs(interleaved[2 * i + 1] - right[i]) < 1e-5f);
+        }
+
+        std::cout << "  ✓ Streaming chain matches whole-buffer chain.\n";
+    }
+
+    static void test_process_file() {
+        std::cout << "\nTest: processFile streams a file through the chain with a bounded number of blocks\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 50000 + 123;
+        AJ::Float left = make_signal(frames);
+        AJ::Float right = make_signal(frames);
+        for (auto &s : right) s *= -0.5f;
+
+        const std::string in = (std::filesystem::temp_directory_path() / "aj_process_in.wav").string();
+        const std::string out = (std::filesystem::temp_directory_path() / "aj_process_out.wav").string();
+
+        SF_INFO info{};
+        info.channels = 2;
+        info.samplerate = 44100;
+        info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+        SNDFILE *file = sf_open(in.c_str(), SFM_WRITE, &info);
+        assert(file);
+        std::vector<float> interleaved(2 * frames);
+        for (size_t i = 0; i < frames; ++i) {
+            interleaved[2 * i] = left[i];
+            interleaved[2 * i + 1] = right[i];
+        }
+        assert(sf_writef_float(file, interleaved.data(), frames) == static_cast<sf_count_t>(frames));
+        sf_close(file);
+
+        AJ::dsp::EffectChain chain;
+        assert(chain.add(make_gain(1000, frames - 1000, handler), handler));
+        assert(chain.add(make_echo(0, frames - 1, handler), handler));
+
+        //* 3 blocks of 1000 frames in flight for the whole file.
+        AJ::AJ_Engine engine;
+        AJ::FileProcessOptions options;
+        options.blockFrames = 1000;
+        options.inflightBlocks = 3;
+        assert(engine.processFile(in, out, chain, handler, options));
+        assert(handler.errors().empty());
+
+        assert(chain.process(left, handler));
+        assert(chain.process(right, handler));
+
+        AJ::io::MappedWav map;
+        assert(map.open(out));
+        assert(map.channels() == 2 && map.samplerate() == 44100 && map.frames() == frames);
+        std::vector<float> l(frames), r(frames);
+        float *outs[2] = { l.data(), r.data() };
+        assert(map.readPlanar(0, frames, outs) == frames);
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(l[i] - left[i]) < 1e-5f && std::fabs(r[i] - right[i]) < 1e-5f);
+        }
+        map.close();
+
+        //* a stage that needs the whole file, and a file processed into itself.
+        AJ::dsp::EffectChain whole;
+        assert(whole.add(std::make_shared<AJ::dsp::reverse::Reverse>(), handler));
+        assert(!engine.processFile(in, out, whole, handler));
+        assert(!engine.processFile(in, in, chain, handler));
+        assert(handler.errors().size() == 2);
+
+        std::filesystem::remove(in);
+        std::filesystem::remove(out);
+        std::cout << "  ✓ " << frames << " frames processed in blocks of 1000.\n";
+    }
+};
@@ -0,0 +1,267 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "dsp/effect_registry.h"
+#include "dsp/gain.h"
+#include "dsp/fade.h"
+#include "dsp/reverse.h"
+#include "dsp/distortion.h"
+#include "dsp/normalization.h"
+#include "dsp/reverb/reverb.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+
+class EffectRegistryTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Effect Registry Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_every_effect_reachable();
+        test_instances_are_reused();
+        test_params_checks();
+        test_custom_factory();
+        test_reused_params_changed();
+        test_split_ranges();
+
+        std::cout << "All Effect Registry Tests Completed Successfully.\n";
+    }
+
+private:
+    /// counts setParams() calls to see when the registry skips them.
+    class CountingGain : public AJ::dsp::gain::Gain {
+    public:
+        static inline int sSetParams = 0;
+
+        bool setParams(std::shared_ptr<AJ::dsp::EffectParams> params, AJ::error::IErrorHandler &handler) override {
+            ++sSetParams;
+            return Gain::setParams(params, handler);
+        }
+    };
+
+    static std::unique_ptr<AJ::dsp::Effect> makeCountingGain() {
+        return std::make_unique<CountingGain>();
+    }
+
+    static std::shared_ptr<AJ::dsp::gain::GainParams> gainParams(float gain, AJ::error::IErrorHandler &handler) {
+        AJ::dsp::gain::Params params{ 0, 99, gain };
+        return AJ::dsp::gain::GainParams::create(params, handler);
+    }
+
+    static void test_every_effect_reachable() {
+        std::cout << "\nTest: Every effect has a factory\n";
+
+        AJ::dsp::EffectRegistry registry;
+
+        for (size_t i = 0; i < AJ::dsp::kEffectCount; ++i) {
+            const auto effect = static_cast<AJ::Effect>(i);
+            assert(registry.has(effect));
+            assert(registry.create(effect) != nullptr);
+        }
+
+        AJ::error::CollectingErrorHandler handler;
+        assert(!registry.acquire(AJ::Effect::pitchShift, gainParams(1.0f, handler), handler));
+        assert(handler.hasErrors());
+
+        std::cout << "  ✓ All effects\n";
+    }
+
+    static void test_instances_are_reused() {
+        std::cout << "\nTest: Instances are cached per thread\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::dsp::EffectRegistry registry;
+        auto params = gainParams(0.5f, handler);
+
+        AJ::dsp::Effect *first = registry.acquire(AJ::Effect::gain, params, handler);
+        AJ::dsp::Effect *again = registry.acquire(AJ::Effect::gain, gainParams(2.0f, handler), handler);
+        assert(first && first == again);
+
+        AJ::Float buffer(100, 0.25f);
+        assert(again->process(buffer, handler));
+        assert(buffer[0] == 0.5f);
+
+        // another thread gets its own instance.
+        AJ::dsp::Effect *other = nullptr;
+        std::thread worker([&] {
+            AJ::error::CollectingErrorHandler local;
+            other = registry.acquire(AJ::Effect::gain, params, local);
+        });
+        worker.join();
+        assert(other && other != first);
+
+        // another registry doesn't reuse this one's instances.
+        AJ::dsp::EffectRegistry second;
+        assert(second.acquire(AJ::Effect::gain, params, handler));
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ One instance per thread and registry\n";
+    }
+
+    static void test_params_checks() {
+        std::cout << "\nTest: Parameters are checked\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::dsp::EffectRegistry registry;
+
+        // wrong parameter type.
+        assert(!registry.acquire(AJ::Effect::reverse, gainParams(1.0f, handler), handler));
+        assert(handler.hasErrors());
+        handler.clear();
+
+        AJ::dsp::fade::Params fade{ 0, 99, 1.0f, 0.0f, AJ::dsp::fade::FadeMode::In };
+        auto fadeIn = AJ::dsp::fade::FadeParams::create(fade, handler);
+        assert(fadeIn);
+
+        assert(registry.acquire(AJ::Effect::fadeIn, fadeIn, handler));
+        assert(!registry.acquire(AJ::Effect::fadeOut, fadeIn, handler));
+        assert(handler.hasErrors());
+
+        std::cout << "  ✓ Wrong type and fade direction rejected\n";
+    }
+
+    static void test_custom_factory() {
+        std::cout << "\nTest: Registered factories replace the built-in effect\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::dsp::EffectRegistry registry;
+        auto params = gainParams(0.5f, handler);
+
+        AJ::dsp::Effect *builtin = registry.acquire(AJ::Effect::gain, params, handler);
+        assert(builtin && !dynamic_cast<CountingGain*>(builtin));
+
+        assert(registry.registerEffect(AJ::Effect::gain, makeCountingGain));
+        assert(!registry.registerEffect(AJ::Effect::gain, nullptr));
+
+        CountingGain::sSetParams = 0;
+        AJ::dsp::Effect *custom = registry.acquire(AJ::Effect::gain, params, handler);
+        assert(custom && dynamic_cast<CountingGain*>(custom));
+
+        // the instance is kept, the parameters are set on every call.
+        for (int i = 0; i < 10; ++i) {
+            assert(registry.acquire(AJ::Effect::gain, params, handler) == custom);
+        }
+        assert(CountingGain::sSetParams == 11);
+
+        assert(registry.acquire(AJ::Effect::gain, gainParams(0.7f, handler), handler) == custom);
+        assert(CountingGain::sSetParams == 12);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ New factory used, its instance kept across calls\n";
+    }
+
+    static void test_reused_params_changed() {
+        std::cout << "\nTest: A parameters object changed between two calls is applied again\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::dsp::EffectRegistry registry;
+
+        AJ::dsp::reverb::Params values{ 25.0f, 0.4f, 0.6f, 48000, 0.5f, 100, 39999 };
+        auto params = AJ::dsp::reverb::ReverbParams::create(values, handler);
+        assert(params);
+
+        AJ::Float input(48000);
+        for (size_t i = 0; i < input.size(); ++i) input[i] = std::sin(i / 20.0f);
+
+        AJ::Float first = input;
+        AJ::dsp::Effect *reverb = registry.acquire(AJ::Effect::reverb, params, handler);
+        assert(reverb && reverb->process(first, handler));
+
+        //* the all-pass filters follow the new samplerate, like a fresh instance.
+        params->setSamplerate(22050);
+        AJ::Float second = input;
+        assert(registry.acquire(AJ::Effect::reverb, params, handler) == reverb);
+        assert(reverb->process(second, handler));
+
+        AJ::dsp::reverb::Reverb fresh;
+        AJ::Float expected = input;
+        assert(fresh.setParams(params, handler) && fresh.process(expected, handler));
+        assert(second == expected && second != first);
+
+        assert(handler.errors().empty());
+        std::cout << "  ✓ Samplerate change reached the cached reverb\n";
+    }
+
+    static void test_split_ranges() {
+        std::cout << "\nTest: Stateless effects processed in pieces match process()\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ThreadPool pool(4);
+
+        const size_t frames = 50000;
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) signal[i] = 0.8f * std::sin(0.0123f * i) * std::cos(0.00071f * i);
+
+        //* uneven pieces of [Start, End] on the pool, against one process() call.
+        auto check = [&](AJ::dsp::Effect &effect, AJ::sample_pos start, AJ::sample_pos end, float tolerance) {
+            assert(effect.splitsRange());
+            AJ::Float expected = signal, pieces = signal;
+            assert(effect.process(expected, handler));
+
+            const size_t count = static_cast<size_t>(end - start) + 1;
+            std::vector<size_t> cuts{ 0 };
+            for (size_t size = 1; cuts.back() < count; size = size * 7 % 4093 + 1) {
+                cuts.push_back(std::min(count, cuts.back() + size));
+            }
+
+            pool.parallel_for(0, cuts.size() - 1, 1, [&](size_t begin, size_t last) {
+                for (size_t p = begin; p < last; ++p) assert(effect.processRange(pieces, cuts[p], cuts[p + 1], handler));
+            });
+
+            for (size_t i = 0; i < frames; ++i) assert(std::fabs(pieces[i] - expected[i]) <= tolerance);
+        };
+
+        AJ::dsp::gain::Gain gain;
+        assert(gain.setParams(gainParams(1.7f, handler), handler));
+        AJ::dsp::gain::Params gp{ 1000, 48000, 0.5f };
+        check(gain, 0, 99, 0.0f);
+        assert(gain.setParams(AJ::dsp::gain::GainParams::create(gp, handler), handler));
+        check(gain, 1000, 48000, 0.0f);
+
+        AJ::dsp::fade::Fade fade;
+        AJ::dsp::fade::Params fp{ 17, 49990, 1.0f, 0.0f, AJ::dsp::fade::FadeMode::Out };
+        assert(fade.setParams(AJ::dsp::fade::FadeParams::create(fp, handler), handler));
+        check(fade, 17, 49990, 1e-6f);
+
+        AJ::dsp::distortion::Distortion distortion;
+        AJ::dsp::distortion::Params dp;
+        dp.mStart = 3;
+        dp.mEnd = 40000;
+        dp.mGain = 4.0f;
+        dp.mType = AJ::dsp::distortion::DistortionType::Asymmetric;
+        assert(distortion.setParams(AJ::dsp::distortion::DistortionParams::create(dp, handler), handler));
+        //* the last samples of a piece go through the scalar curve, an ulp away from the vector one.
+        check(distortion, 3, 40000, 1e-6f);
+
+        //* odd and even counts: the middle frame stays, every pair is swapped once.
+        AJ::dsp::reverse::Reverse reverse;
+        for (AJ::sample_pos end : { 30000, 30001 }) {
+            AJ::dsp::reverse::Params rp{ 10, end };
+            assert(reverse.setParams(AJ::dsp::reverse::ReverseParams::create(rp, handler), handler));
+            check(reverse, 10, end, 0.0f);
+
+            //* both channels in one pass.
+            AJ::AudioBuffer audio{ signal, signal };
+            std::reverse(audio[1].begin(), audio[1].end());
+            AJ::Float left = audio[0], right = audio[1];
+            std::reverse(left.begin() + 10, left.begin() + end + 1);
+            std::reverse(right.begin() + 10, right.begin() + end + 1);
+            assert(reverse.process(audio, 2, handler));
+            assert(audio[0] == left && audio[1] == right);
+        }
+        assert(handler.errors().empty());
+
+        //* effects with memory or linked levels process their range in one call.
+        AJ::dsp::normalization::Normalization normalization;
+        assert(!normalization.splitsRange());
+        AJ::Float buffer(10, 0.5f);
+        assert(!normalization.processRange(buffer, 0, 10, handler));
+        assert(handler.errors().size() == 1);
+
+        std::cout << "  ✓ Gain, fade, distortion and reverse\n";
+    }
+};
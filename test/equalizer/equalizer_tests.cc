@@ -0,0 +1,225 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dsp/eq/equalizer.h"
+#include "core/error_handler.h"
+
+class EqualizerTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Equalizer Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_band_responses();
+        test_blocks_match_process();
+        test_channels_are_independent();
+        test_new_params_keep_state();
+        test_invalid_params();
+
+        std::cout << "All Equalizer Tests Completed Successfully.\n";
+    }
+
+private:
+    using Band = AJ::dsp::eq::Band;
+    using BandType = AJ::dsp::eq::BandType;
+
+    static AJ::Float make_tone(size_t frames, double hz, double rate = 48000.0) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = static_cast<float>(0.1 * std::sin(2.0 * M_PI * hz * i / rate));
+        }
+        return signal;
+    }
+
+    static std::shared_ptr<AJ::dsp::eq::EqParams> make_params(AJ::sample_pos start, AJ::sample_pos end,
+        std::vector<Band> bands, AJ::error::IErrorHandler &handler, uint32_t samplerate = 48000) {
+        AJ::dsp::eq::Params params{ start, end, std::move(bands), samplerate };
+        return AJ::dsp::eq::EqParams::create(params, handler);
+    }
+
+    // gain of the equalizer at `hz`, measured on a settled tone.
+    static double response(const std::vector<Band> &bands, double hz) {
+        AJ::error::CollectingErrorHandler handler;
+        const size_t frames = 48000;
+        const AJ::Float input = make_tone(frames, hz);
+        AJ::Float output = input;
+
+        AJ::dsp::eq::Equalizer eq;
+        assert(eq.setParams(make_params(0, frames - 1, bands, handler), handler));
+        assert(eq.process(output, handler));
+
+        double in = 0.0, out = 0.0;
+        for (size_t i = frames / 2; i < frames; ++i) {
+            in += static_cast<double>(input[i]) * input[i];
+            out += static_cast<double>(output[i]) * output[i];
+        }
+        return std::sqrt(out / in);
+    }
+
+    static void test_band_responses() {
+        std::cout << "\nTest: Every band type boosts / cuts where it should\n";
+
+        const std::vector<Band> peak{ { BandType::Peaking, 1000.0f, 12.0f, 1.0f } };
+        assert(std::fabs(response(peak, 1000.0) - std::pow(10.0, 12.0 / 20.0)) < 0.02);
+        assert(std::fabs(response(peak, 50.0) - 1.0) < 0.02);
+
+        const std::vector<Band> low{ { BandType::LowShelf, 200.0f, 6.0f, 0.707f } };
+        assert(std::fabs(response(low, 30.0) - std::pow(10.0, 6.0 / 20.0)) < 0.05);
+        assert(std::fabs(response(low, 8000.0) - 1.0) < 0.01);
+
+        const std::vector<Band> high{ { BandType::HighShelf, 4000.0f, -9.0f, 0.707f } };
+        assert(std::fabs(response(high, 18000.0) - std::pow(10.0, -9.0 / 20.0)) < 0.02);
+        assert(std::fabs(response(high, 100.0) - 1.0) < 0.01);
+
+        //* 12 dB / octave: more than 30 dB down 3 octaves past the corner, flat well inside the passband.
+        const std::vector<Band> lowPass{ { BandType::LowPass, 1000.0f, 0.0f, 0.707f } };
+        assert(response(lowPass, 8000.0) < 0.03);
+        assert(std::fabs(response(lowPass, 100.0) - 1.0) < 0.01);
+
+        const std::vector<Band> highPass{ { BandType::HighPass, 1000.0f, 0.0f, 0.707f } };
+        assert(response(highPass, 125.0) < 0.03);
+        assert(std::fabs(response(highPass, 10000.0) - 1.0) < 0.01);
+
+        //* cascaded bands multiply.
+        const std::vector<Band> both{ { BandType::Peaking, 1000.0f, 12.0f, 1.0f }, { BandType::HighShelf, 4000.0f, -9.0f, 0.707f } };
+        assert(std::fabs(response(both, 18000.0) - response(high, 18000.0) * response(peak, 18000.0)) < 0.01);
+
+        std::cout << "  ✓ Peaking, shelves, low / high pass and cascades\n";
+    }
+
+    static void test_blocks_match_process() {
+        std::cout << "\nTest: Streamed blocks of any size match process()\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 20000;
+        AJ::Float mono = make_tone(frames, 440.0);
+        for (size_t i = 0; i < frames; ++i) mono[i] += 0.05f * std::sin(0.71f * i);
+
+        std::vector<Band> bands;
+        for (size_t b = 0; b < AJ::kEqMaxBands; ++b) {
+            bands.push_back({ static_cast<BandType>(b % 5), 100.0f + 1500.0f * b, b % 2 ? -6.0f : 4.0f, 0.5f + 0.3f * b });
+        }
+
+        for (size_t count : { size_t(1), size_t(3), AJ::kEqMaxBands }) {
+            auto params = make_params(1000, 15000, std::vector<Band>(bands.begin(), bands.begin() + count), handler);
+
+            AJ::dsp::eq::Equalizer eq;
+            assert(eq.setParams(params, handler));
+
+            AJ::Float expected = mono;
+            assert(eq.process(expected, handler));
+
+            std::vector<float> stereo(2 * frames);
+            for (size_t i = 0; i < frames; ++i) stereo[2 * i] = stereo[2 * i + 1] = mono[i];
+
+            auto state = eq.createState(2, handler);
+            assert(state);
+
+            size_t position = 0, size = 1;
+            while (position < frames) {
+                const size_t n = std::min(size, frames - position);
+                assert(eq.processBlock(stereo.data() + 2 * position, n, 2, *state, handler));
+                position += n;
+                size = size * 5 % 1021 + 1;
+            }
+
+            for (size_t i = 0; i < frames; ++i) {
+                assert(std::fabs(stereo[2 * i] - expected[i]) < 1e-5f);
+                assert(stereo[2 * i + 1] == stereo[2 * i]);
+            }
+            assert(std::equal(mono.begin(), mono.begin() + 1000, expected.begin()));
+            assert(std::equal(mono.begin() + 15001, mono.end(), expected.begin() + 15001));
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ 1, 3 and " << AJ::kEqMaxBands << " bands, outside of the range untouched\n";
+    }
+
+    static void test_channels_are_independent() {
+        std::cout << "\nTest: Channels don't leak into each other\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 4096;
+        const AJ::Float tone = make_tone(frames, 1000.0);
+        std::vector<float> stereo(2 * frames, 0.0f);
+        for (size_t i = 0; i < frames; ++i) stereo[2 * i] = tone[i];
+
+        AJ::dsp::eq::Equalizer eq;
+        assert(eq.setParams(make_params(0, frames - 1, { { BandType::Peaking, 1000.0f, 18.0f, 2.0f },
+            { BandType::LowPass, 5000.0f, 0.0f, 0.707f } }, handler), handler));
+
+        auto state = eq.createState(2, handler);
+        assert(eq.processBlock(stereo.data(), frames, 2, *state, handler));
+
+        for (size_t i = 0; i < frames; ++i) assert(stereo[2 * i + 1] == 0.0f);
+        assert(std::fabs(stereo[2 * (frames - 1)]) > 0.0f);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Silent channel stays silent\n";
+    }
+
+    static void test_new_params_keep_state() {
+        std::cout << "\nTest: New parameters with as many bands keep the filter state\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 8000;
+        const AJ::Float tone = make_tone(frames, 300.0);
+        const std::vector<Band> bands{ { BandType::Peaking, 300.0f, 9.0f, 4.0f }, { BandType::HighPass, 80.0f, 0.0f, 0.707f } };
+
+        AJ::dsp::eq::Equalizer eq;
+        assert(eq.setParams(make_params(0, frames - 1, bands, handler), handler));
+
+        AJ::Float continuous = tone;
+        assert(eq.process(continuous, handler));
+
+        //* the same bands in a new parameters object half-way: no restart, the output is unchanged.
+        AJ::Float switched = tone;
+        auto state = eq.createState(1, handler);
+        assert(eq.processBlock(switched.data(), frames / 2, 1, *state, handler));
+        assert(eq.setParams(make_params(0, frames - 1, bands, handler), handler));
+        assert(eq.processBlock(switched.data() + frames / 2, frames / 2, 1, *state, handler));
+
+        for (size_t i = 0; i < frames; ++i) assert(std::fabs(switched[i] - continuous[i]) < 1e-6f);
+
+        //* another band count lays the cascade out again from silence.
+        assert(eq.setParams(make_params(0, frames - 1, { bands[0] }, handler), handler));
+        assert(eq.processBlock(switched.data(), 1, 1, *state, handler));
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Seamless\n";
+    }
+
+    static void test_invalid_params() {
+        std::cout << "\nTest: Invalid parameters are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const Band good{ BandType::Peaking, 1000.0f, 3.0f, 1.0f };
+        assert(!make_params(10, 5, { good }, handler));
+        assert(!make_params(0, 99, {}, handler));
+        assert(!make_params(0, 99, std::vector<Band>(AJ::kEqMaxBands + 1, good), handler));
+        assert(!make_params(0, 99, { { BandType::Peaking, 5.0f, 3.0f, 1.0f } }, handler));
+        assert(!make_params(0, 99, { { BandType::Peaking, 24000.0f, 3.0f, 1.0f } }, handler));
+        assert(!make_params(0, 99, { { BandType::Peaking, NAN, 3.0f, 1.0f } }, handler));
+        assert(!make_params(0, 99, { { BandType::Peaking, 1000.0f, 30.0f, 1.0f } }, handler));
+        assert(!make_params(0, 99, { { BandType::Peaking, 1000.0f, 3.0f, 0.0f } }, handler));
+        assert(!make_params(0, 99, { good }, handler, 1000));
+        assert(handler.errors().size() == 9);
+
+        AJ::dsp::eq::Equalizer eq;
+        AJ::Float buffer(50, 0.1f);
+        handler.clear();
+        assert(!eq.process(buffer, handler));
+        assert(!eq.createState(2, handler));
+        assert(eq.setParams(make_params(0, 99, { good }, handler), handler));
+        assert(!eq.process(buffer, handler));
+        assert(!eq.createState(3, handler));
+        assert(buffer == AJ::Float(50, 0.1f));
+        assert(handler.errors().size() == 4);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "dsp/fft.h"
+#include "core/scratch_arena.h"
+
+class FFTTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning FFT Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_matches_dft();
+        test_round_trip();
+        test_plan_cache();
+        test_arena_spectrum();
+
+        std::cout << "All FFT Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::vector<float> make_signal(size_t n) {
+        std::vector<float> x(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = 0.5f * std::sin(0.37f * i) + 0.25f * std::cos(1.3f * i + 0.2f) + (i % 7 == 0 ? 0.1f : 0.0f);
+        }
+        return x;
+    }
+
+    static void test_matches_dft() {
+        std::cout << "\nTest: Spectra match the DFT for every size path\n";
+
+        // 4 and 8 points run the radix-2 / radix-4 passes only, 64 and 1024 the butterfly kernel too.
+        for (size_t n : { 4, 8, 16, 64, 1024 }) {
+            auto fft = AJ::dsp::fft::plan(n);
+            assert(fft && fft->size() == n && fft->bins() == n / 2 + 1);
+
+            const std::vector<float> x = make_signal(n);
+            std::vector<float> re(fft->bins()), im(fft->bins());
+            fft->forward(x.data(), re.data(), im.data());
+
+            for (size_t k = 0; k < fft->bins(); ++k) {
+                double dr = 0.0, di = 0.0;
+                for (size_t t = 0; t < n; ++t) {
+                    dr += x[t] * std::cos(2.0 * M_PI * k * t / n);
+                    di -= x[t] * std::sin(2.0 * M_PI * k * t / n);
+                }
+                assert(std::fabs(re[k] - dr) < 1e-4 * std::sqrt(n) && std::fabs(im[k] - di) < 1e-4 * std::sqrt(n));
+            }
+            assert(im[0] == 0.0f && im[n / 2] == 0.0f);
+        }
+
+        std::cout << "  ✓ Bins match\n";
+    }
+
+    static void test_round_trip() {
+        std::cout << "\nTest: inverse(forward(x)) = N * x\n";
+
+        for (size_t n : { 4, 32, 4096 }) {
+            auto fft = AJ::dsp::fft::plan(n);
+            const std::vector<float> x = make_signal(n);
+            std::vector<float> re(fft->bins()), im(fft->bins()), back(n);
+
+            fft->forward(x.data(), re.data(), im.data());
+            fft->inverse(re.data(), im.data(), back.data());
+
+            for (size_t t = 0; t < n; ++t) {
+                assert(std::fabs(back[t] / n - x[t]) < 1e-5f);
+            }
+        }
+
+        std::cout << "  ✓ Signal restored\n";
+    }
+
+    static void test_plan_cache() {
+        std::cout << "\nTest: One plan per size, shared across threads\n";
+
+        assert(!AJ::dsp::fft::plan(0) && !AJ::dsp::fft::plan(2) && !AJ::dsp::fft::plan(1000));
+        assert(!AJ::dsp::fft::plan(AJ::kFFTMaxSize * 2));
+
+        const AJ::dsp::fft::Plan *first = AJ::dsp::fft::plan(2048).get();
+        std::vector<const AJ::dsp::fft::Plan*> seen(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < seen.size(); ++t) {
+            threads.emplace_back([&seen, t] { seen[t] = AJ::dsp::fft::plan(2048).get(); });
+        }
+        for (auto &thread : threads) thread.join();
+
+        for (const auto *plan : seen) {
+            assert(plan == first);
+        }
+        assert(AJ::dsp::fft::plan(4096).get() != first);
+
+        std::cout << "  ✓ Same plan returned\n";
+    }
+
+    static void test_arena_spectrum() {
+        std::cout << "\nTest: Work spectra come aligned from the scratch arena\n";
+
+        AJ::utils::ScratchArena arena;
+        auto fft = AJ::dsp::fft::plan(256);
+        {
+            AJ::utils::ScratchScope scope(arena);
+            AJ::dsp::fft::Spectrum spectrum = AJ::dsp::fft::spectrum(scope.arena(), *fft);
+
+            assert(spectrum.re && spectrum.im);
+            assert(reinterpret_cast<uintptr_t>(spectrum.re) % AJ::kBufferAlignment == 0);
+            assert(reinterpret_cast<uintptr_t>(spectrum.im) % AJ::kBufferAlignment == 0);
+
+            const std::vector<float> x = make_signal(256);
+            fft->forward(x.data(), spectrum.re, spectrum.im);
+            assert(arena.used() >= 2 * fft->bins() * sizeof(float));
+        }
+        assert(arena.used() == 0);
+
+        std::cout << "  ✓ Aligned and released with the scope\n";
+    }
+};
@@ -0,0 +1,227 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sndfile.h>
+
+#include "core/aj_audio_engine.h"
+#include "core/engine_resources.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+#include "file_io/wav_file.h"
+
+class AsyncLoadTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Async Load Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_read_pool();
+        test_load_async();
+        test_load_batch();
+        test_save_async();
+        test_without_resources();
+
+        std::cout << "All Async Load Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::filesystem::path temp_dir(const std::string &name) {
+        const auto dir = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    //* stereo WAV of `frames` frames, frame i holds (s, -s) with s = sin((i + seed) / 50).
+    static void write_wav(const std::string &path, size_t frames, size_t seed, int subformat = SF_FORMAT_FLOAT) {
+        SF_INFO info{};
+        info.channels = 2;
+        info.samplerate = 44100;
+        info.format = SF_FORMAT_WAV | subformat;
+
+        SNDFILE *file = sf_open(path.c_str(), SFM_WRITE, &info);
+        assert(file);
+        std::vector<float> samples(2 * frames);
+        for (size_t i = 0; i < frames; ++i) {
+            samples[2 * i] = 0.5f * std::sin((i + seed) / 50.0f);
+            samples[2 * i + 1] = -samples[2 * i];
+        }
+        assert(sf_writef_float(file, samples.data(), frames) == static_cast<sf_count_t>(frames));
+        sf_close(file);
+    }
+
+    static std::shared_ptr<AJ::AJ_Engine> make_engine(AJ::error::IErrorHandler &handler) {
+        auto engine = AJ::AJ_Engine::create();
+        engine->setEngineResources(std::make_shared<AJ::EngineResources>(handler));
+        engine->setUndoSupportEnabled(false);
+        return engine;
+    }
+
+    static bool same_samples(const AJ::io::WAV_File &a, const AJ::io::WAV_File &b) {
+        for (int ch = 0; ch < 2; ++ch) {
+            if (a.pAudio->at(ch) != b.pAudio->at(ch)) return false;
+        }
+        return true;
+    }
+
+    static void check_file(const AJ::io::AudioFile &audio, size_t frames, size_t seed) {
+        assert(audio.mInfo.channels == 2 && audio.pAudio->at(0).size() == frames);
+        for (size_t i = 0; i < frames; i += 997) {
+            const float s = 0.5f * std::sin((i + seed) / 50.0f);
+            assert(std::fabs(audio.pAudio->at(0)[i] - s) < 1e-6f && std::fabs(audio.pAudio->at(1)[i] + s) < 1e-6f);
+        }
+    }
+
+    static void test_read_pool() {
+        std::cout << "\nTest: A read pool gives the same samples as a plain read\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ThreadPool pool(3);
+
+        const auto dir = temp_dir("aj_async_read");
+        //* µ-law can't be mapped: libsndfile reads it, the workers deinterleave.
+        std::string ulaw = (dir / "ulaw.wav").string();
+        std::string mapped = (dir / "mapped.wav").string();
+        write_wav(ulaw, 3 * AJ::kIOChunkFrames + 17, 0, SF_FORMAT_ULAW);
+        write_wav(mapped, AJ::kLoadStretchFrames + 5000, 3);
+
+        for (std::string *path : { &ulaw, &mapped }) {
+            AJ::io::WAV_File plain, pooled;
+            assert(plain.setFilePath(*path) && pooled.setFilePath(*path));
+            assert(plain.read(handler));
+
+            pooled.setReadPool(&pool);
+            assert(pooled.read(handler));
+            assert(same_samples(plain, pooled));
+        }
+
+        //* from a worker of the pool itself: the reader helps instead of waiting on it.
+        AJ::io::WAV_File nested;
+        assert(nested.setFilePath(ulaw));
+        nested.setReadPool(&pool);
+        assert(pool.enqueue([&] { return nested.read(handler); }).get());
+        check_file(nested, 3 * AJ::kIOChunkFrames + 17, 0);
+
+        assert(!handler.hasErrors());
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ Double-buffered libsndfile reads and mapped stretches match\n";
+    }
+
+    static void test_load_async() {
+        std::cout << "\nTest: loadAudioAsync() loads on the I/O workers\n";
+        AJ::error::CollectingErrorHandler handler;
+        auto engine = make_engine(handler);
+
+        const auto dir = temp_dir("aj_async_load");
+        const std::string path = (dir / "take.wav").string();
+        write_wav(path, 50000, 7);
+
+        std::future<AJ::LoadResult> loading = engine->loadAudioAsync(path);
+        std::future<AJ::LoadResult> missing = engine->loadAudioAsync((dir / "missing.wav").string());
+
+        AJ::LoadResult loaded = loading.get();
+        assert(loaded.audio && !loaded.errors.hasErrors());
+        check_file(*loaded.audio, 50000, 7);
+
+        AJ::LoadResult failed = missing.get();
+        assert(!failed.audio && failed.errors.hasErrors());
+
+        assert(!handler.hasErrors());
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ A file loaded, a missing one reported through its result\n";
+    }
+
+    static void test_load_batch() {
+        std::cout << "\nTest: A batch loads within its memory budget\n";
+        AJ::error::CollectingErrorHandler handler;
+        auto engine = make_engine(handler);
+
+        const auto dir = temp_dir("aj_async_batch");
+        const size_t files = 8;
+        std::vector<std::string> paths;
+        for (size_t f = 0; f < files; ++f) {
+            paths.push_back((dir / ("take_" + std::to_string(f) + ".wav")).string());
+            write_wav(paths.back(), 20000 + 5000 * f, f);
+        }
+        paths.push_back((dir / "missing.wav").string());
+
+        //* about two files fit at once, the biggest ones load alone.
+        AJ::AsyncLoadOptions options;
+        options.maxInFlight = 0;
+        options.memoryBudget = 2 * 2 * 40000 * sizeof(float);
+
+        std::vector<std::future<AJ::LoadResult>> futures = engine->loadAudioAsync(paths, options);
+        assert(futures.size() == files + 1);
+
+        for (size_t f = 0; f < files; ++f) {
+            AJ::LoadResult result = futures[f].get();
+            assert(result.audio && !result.errors.hasErrors());
+            check_file(*result.audio, 20000 + 5000 * f, f);
+        }
+        assert(!futures[files].get().audio);
+
+        assert(!handler.hasErrors());
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ " << files << " files and a missing one, each future in the order of its path\n";
+    }
+
+    static void test_save_async() {
+        std::cout << "\nTest: saveAudioAsync() writes on the I/O workers\n";
+        AJ::error::CollectingErrorHandler handler;
+        auto engine = make_engine(handler);
+
+        const auto dir = temp_dir("aj_async_save");
+        const std::string path = (dir / "take.wav").string();
+        write_wav(path, 30000, 11);
+
+        std::shared_ptr<AJ::io::AudioFile> audio = engine->loadAudioAsync(path).get().audio;
+        assert(audio);
+
+        AJ::AudioWriteInfo info;
+        info.length = audio->mInfo.length;
+        info.samplerate = audio->mInfo.samplerate;
+        info.channels = audio->mInfo.channels;
+        info.bitdepth = audio->mInfo.bitdepth;
+        info.format = audio->mInfo.format;
+        info.seekable = audio->mInfo.seekable;
+        info.path = dir.string();
+        info.name = "copy.wav";
+        assert(audio->setWriteInfo(info, handler));
+
+        AJ::SaveResult saved = engine->saveAudioAsync(audio).get();
+        assert(saved.success && !saved.errors.hasErrors());
+
+        AJ::LoadResult copy = engine->loadAudioAsync((dir / "copy.wav").string()).get();
+        assert(copy.audio);
+        check_file(*copy.audio, 30000, 11);
+
+        assert(!handler.hasErrors());
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ Saved and read back\n";
+    }
+
+    static void test_without_resources() {
+        std::cout << "\nTest: Without engine resources the futures are ready at once\n";
+        auto engine = AJ::AJ_Engine::create();
+        engine->setUndoSupportEnabled(false);
+
+        const auto dir = temp_dir("aj_async_sync");
+        const std::string path = (dir / "take.wav").string();
+        write_wav(path, 10000, 1);
+
+        std::vector<std::future<AJ::LoadResult>> futures = engine->loadAudioAsync(std::vector<std::string>{ path, path });
+        for (auto &future : futures) {
+            assert(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+            AJ::LoadResult result = future.get();
+            assert(result.audio);
+            check_file(*result.audio, 10000, 1);
+        }
+
+        std::filesystem::remove_all(dir);
+        std::cout << "  ✓ Loaded on the calling thread\n";
+    }
+};
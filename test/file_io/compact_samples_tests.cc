@@ -0,0 +1,176 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "file_io/compact_samples.h"
+#include "file_io/wav_file.h"
+#include "dsp/kernels.h"
+#include "core/error_handler.h"
+#include "audio_fixtures.h"
+
+class CompactSamplesTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Compact Samples Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_int16_round_trip();
+        test_half_precision();
+        test_storage_switch();
+        test_compact_write();
+
+        std::cout << "All Compact Samples Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::shared_ptr<AJ::io::WAV_File> make_file(size_t frames) {
+        auto wav = fixtures::make_file(frames, 2, [](size_t ch, size_t i) {
+            return 0.7f * std::sin(0.001f * i * (ch + 1));
+        }, 44100);
+        wav->mInfo.bitdepth = AJ::BitDepth_t::int_16;
+        return wav;
+    }
+
+    static void test_int16_round_trip() {
+        std::cout << "\nTest: int16 storage keeps 16-bit samples exactly\n";
+
+        // every 16-bit value, as libsndfile reads them (n / 32768).
+        AJ::AudioBuffer audio;
+        for (int n = -32768; n <= 32767; ++n) {
+            audio[0].push_back(n / 32768.0f);
+        }
+
+        AJ::io::CompactSamples compact;
+        assert(compact.pack(audio, 1, AJ::io::SampleStorage::Int16));
+        assert(compact.frames() == 65536);
+        assert(compact.bytes() == 65536 * sizeof(uint16_t));
+
+        AJ::AudioBuffer out;
+        compact.unpack(out);
+        assert(out[0] == audio[0]);
+
+        // out of range samples clip.
+        const float loud[2] = { 1.5f, -1.5f };
+        float back[2];
+        compact.write(0, 0, 2, loud);
+        compact.read(0, 0, 2, back);
+        assert(back[0] == 32767.0f / 32768.0f && back[1] == -1.0f);
+
+        std::cout << "  ✓ All 65536 values round trip\n";
+    }
+
+    static void test_half_precision() {
+        std::cout << "\nTest: half storage keeps 11 bits of precision\n";
+
+        AJ::AudioBuffer audio;
+        for (size_t i = 0; i < 10000; ++i) {
+            audio[0].push_back(0.9f * std::sin(0.01f * i) * std::pow(10.0f, -3.0f * i / 10000));
+        }
+
+        AJ::io::CompactSamples compact;
+        assert(compact.pack(audio, 1, AJ::io::SampleStorage::Float16));
+
+        AJ::AudioBuffer out;
+        compact.unpack(out);
+        for (size_t i = 0; i < audio[0].size(); ++i) {
+            assert(std::fabs(out[0][i] - audio[0][i]) <= std::fabs(audio[0][i]) / 2048.0f + 1e-7f);
+        }
+
+        // channels of different lengths aren't packed.
+        audio[1].resize(10);
+        assert(!compact.pack(audio, 2, AJ::io::SampleStorage::Float16));
+
+        std::cout << "  ✓ Relative error within 2^-11, quiet samples included\n";
+    }
+
+    static void test_storage_switch() {
+        std::cout << "\nTest: AudioFile storage can be compacted and widened back\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const size_t frames = 50000;
+        auto wav = make_file(frames);
+        const AJ::AudioBuffer original = *wav->pAudio;
+        const size_t float_bytes = wav->residentBytes();
+
+        AJ::dsp::kernels::Levels before;
+        assert(wav->levels(1, 100, 40000, before, handler));
+
+        assert(wav->setStorage(AJ::io::SampleStorage::Int16, handler));
+        assert(wav->storage() == AJ::io::SampleStorage::Int16);
+        assert(wav->pAudio->at(0).empty() && wav->pAudio->at(0).capacity() == 0);
+        assert(wav->channelFrames() == frames);
+        assert(wav->residentBytes() * 2 == float_bytes);
+
+        // levels scan the compact samples.
+        AJ::dsp::kernels::Levels compact;
+        assert(wav->levels(1, 100, 40000, compact, handler));
+        assert(std::fabs(compact.max - before.max) < 1e-4f && std::fabs(compact.min - before.min) < 1e-4f);
+
+        // edits go through writeFrames.
+        std::vector<float> block(1000, 0.25f);
+        wav->writeFrames(0, 2000, block.size(), block.data());
+
+        std::vector<float> read(1000);
+        wav->readFrames(0, 2000, read.size(), read.data());
+        assert(read == block);
+
+        // int16 -> half -> float keeps the samples within the half precision.
+        assert(wav->setStorage(AJ::io::SampleStorage::Float16, handler));
+        assert(wav->setStorage(AJ::io::SampleStorage::Float32, handler));
+        assert(wav->storage() == AJ::io::SampleStorage::Float32);
+        assert(wav->pAudio->at(1).size() == frames);
+
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(wav->pAudio->at(1)[i] - original[1][i]) < 1e-3f);
+        }
+        assert(wav->pAudio->at(0)[2500] == 0.25f);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Half the memory, samples and levels preserved\n";
+    }
+
+    static void test_compact_write() {
+        std::cout << "\nTest: Compact files are written block by block\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const size_t frames = 3 * AJ::kIOChunkFrames + 17;
+        const std::string dir = std::filesystem::temp_directory_path().string();
+
+        auto wav = make_file(frames);
+        assert(wav->setStorage(AJ::io::SampleStorage::Int16, handler));
+
+        AJ::AudioWriteInfo write_info;
+        write_info.bitdepth = AJ::BitDepth_t::int_16;
+        write_info.channels = 2;
+        write_info.length = frames * 2;
+        write_info.samplerate = 44100;
+        write_info.seekable = true;
+        write_info.path = dir;
+        write_info.name = "aj_compact_write.wav";
+        write_info.format = ".wav";
+
+        assert(wav->setWriteInfo(write_info, handler));
+        assert(wav->write(handler));
+
+        AJ::io::WAV_File back;
+        std::string path = dir + "/aj_compact_write.wav";
+        assert(back.setFilePath(path));
+        assert(back.read(handler));
+        assert(back.pAudio->at(0).size() == frames);
+
+        // a 16-bit file of int16 samples is bit exact.
+        AJ::Float expected(frames);
+        for (uint8_t ch = 0; ch < 2; ++ch) {
+            wav->readFrames(ch, 0, frames, expected.data());
+            assert(back.pAudio->at(ch) == expected);
+        }
+        assert(handler.errors().empty());
+
+        std::filesystem::remove(path);
+        std::cout << "  ✓ Written samples match the stored ones\n";
+    }
+};
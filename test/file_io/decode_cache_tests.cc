@@ -0,0 +1,176 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "file_io/decode_cache.h"
+#include "file_io/wav_file.h"
+#include "file_io/seek_index.h"
+
+class DecodeCacheTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Decode Cache Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_store_and_load();
+        test_changed_source_misses();
+        test_damaged_entry_misses();
+        test_seek_index_entry();
+
+        std::cout << "All Decode Cache Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::string temp_path(const std::string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    /// stands in for a compressed file: the cache only looks at its path, size and modification time.
+    static void write_source(const std::string &path, const std::string &content) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    }
+
+    static void fill(AJ::io::AudioFile &audio, size_t frames, uint8_t channels) {
+        audio.mInfo.length = frames * channels;
+        audio.mInfo.samplerate = 44100;
+        audio.mInfo.channels = channels;
+        audio.mInfo.bitdepth = AJ::BitDepth_t::Not_Supported;
+        audio.mInfo.format = ".mp3";
+        audio.mInfo.seekable = false;
+
+        for (uint8_t ch = 0; ch < channels; ++ch) {
+            audio.pAudio->at(ch).resize(frames);
+            for (size_t i = 0; i < frames; ++i) audio.pAudio->at(ch)[i] = (ch ? -1.0f : 1.0f) * i / frames;
+        }
+    }
+
+    static void test_store_and_load() {
+        std::cout << "\nTest: A stored entry loads back the samples and info\n";
+
+        const std::string dir = temp_path("aj_decode_cache");
+        const std::string source = temp_path("aj_decode_cache_source.mp3");
+        std::filesystem::remove_all(dir);
+        write_source(source, "compressed bytes");
+
+        AJ::io::DecodeCache cache(dir);
+        AJ::io::WAV_File decoded, cached;
+        assert(!cache.load(source, cached));
+
+        // not a multiple of the page size: the second channel starts on a padded boundary.
+        const size_t frames = 3000;
+        fill(decoded, frames, 2);
+        assert(cache.store(source, decoded));
+        assert(std::filesystem::exists(cache.entryPath(source)));
+
+        assert(cache.load(source, cached));
+        assert(cached.mInfo.length == decoded.mInfo.length && cached.mInfo.channels == 2);
+        assert(cached.mInfo.samplerate == 44100 && cached.mInfo.format == ".mp3" && !cached.mInfo.seekable);
+        assert(cached.pAudio->at(0) == decoded.pAudio->at(0) && cached.pAudio->at(1) == decoded.pAudio->at(1));
+
+        // mono replaces the entry of the same source.
+        AJ::io::WAV_File mono, mono_cached;
+        fill(mono, 10, 1);
+        assert(cache.store(source, mono));
+        assert(cache.load(source, mono_cached));
+        assert(mono_cached.mInfo.channels == 1 && mono_cached.pAudio->at(0) == mono.pAudio->at(0));
+
+        std::filesystem::remove_all(dir);
+        std::filesystem::remove(source);
+
+        std::cout << "  ✓ Samples and info match\n";
+    }
+
+    static void test_changed_source_misses() {
+        std::cout << "\nTest: A changed source isn't served from its old entry\n";
+
+        const std::string dir = temp_path("aj_decode_cache_changed");
+        const std::string source = temp_path("aj_decode_cache_changed.mp3");
+        std::filesystem::remove_all(dir);
+        write_source(source, "first version");
+
+        AJ::io::DecodeCache cache(dir);
+        AJ::io::WAV_File decoded, cached;
+        fill(decoded, 100, 2);
+        assert(cache.store(source, decoded));
+
+        write_source(source, "second, longer version");
+        assert(!cache.load(source, cached));
+        assert(cached.pAudio->at(0).empty());
+
+        // same size, other modification time.
+        assert(cache.store(source, decoded));
+        write_source(source, "second, longer version");
+        std::filesystem::last_write_time(source, std::filesystem::last_write_time(source) - std::chrono::hours(1));
+        assert(!cache.load(source, cached));
+
+        std::filesystem::remove_all(dir);
+        std::filesystem::remove(source);
+
+        std::cout << "  ✓ Stale entries are misses\n";
+    }
+
+    static void test_damaged_entry_misses() {
+        std::cout << "\nTest: A truncated entry is a miss\n";
+
+        const std::string dir = temp_path("aj_decode_cache_damaged");
+        const std::string source = temp_path("aj_decode_cache_damaged.mp3");
+        std::filesystem::remove_all(dir);
+        write_source(source, "compressed bytes");
+
+        AJ::io::DecodeCache cache(dir);
+        AJ::io::WAV_File decoded, cached;
+        fill(decoded, 5000, 2);
+        assert(cache.store(source, decoded));
+
+        const std::string entry = cache.entryPath(source);
+        std::filesystem::resize_file(entry, std::filesystem::file_size(entry) - 4);
+        assert(!cache.load(source, cached));
+        assert(cached.pAudio->at(0).empty());
+
+        std::filesystem::remove_all(dir);
+        std::filesystem::remove(source);
+
+        std::cout << "  ✓ Damaged entry refused\n";
+    }
+
+    static void test_seek_index_entry() {
+        std::cout << "\nTest: A seek index entry loads back its points, a stale or cut one is a miss\n";
+
+        const std::string dir = temp_path("aj_decode_cache_index");
+        const std::string source = temp_path("aj_decode_cache_index.mp3");
+        std::filesystem::remove_all(dir);
+        write_source(source, "compressed bytes");
+
+        AJ::io::SeekIndex index;
+        for (int64_t p = 0; p < 1000; ++p) index.append(1000 + 417 * p, 1152, p == 0 ? 1105 : 0);
+
+        AJ::io::DecodeCache cache(dir);
+        AJ::io::SeekIndex loaded;
+        assert(!cache.loadSeekIndex(source, loaded));
+        assert(cache.storeSeekIndex(source, index));
+        assert(cache.seekIndexPath(source) != cache.entryPath(source));
+
+        assert(cache.loadSeekIndex(source, loaded));
+        assert(loaded.packets() == 1000 && loaded.frames() == index.frames());
+        assert(loaded.points().size() == index.points().size());
+        for (size_t i = 0; i < loaded.points().size(); ++i) {
+            assert(loaded.points()[i].mPos == index.points()[i].mPos && loaded.points()[i].mFrame == index.points()[i].mFrame);
+        }
+
+        const std::string entry = cache.seekIndexPath(source);
+        std::filesystem::resize_file(entry, std::filesystem::file_size(entry) - 8);
+        AJ::io::SeekIndex damaged;
+        assert(!cache.loadSeekIndex(source, damaged) && damaged.empty());
+
+        assert(cache.storeSeekIndex(source, index));
+        write_source(source, "changed bytes!!");
+        assert(!cache.loadSeekIndex(source, damaged) && damaged.empty());
+
+        std::filesystem::remove_all(dir);
+        std::filesystem::remove(source);
+
+        std::cout << "  ✓ " << loaded.points().size() << " points round trip\n";
+    }
+};
@@ -123,3 +123,199 @@ private:
         std::cout << "  ✓ Multi-threaded streamer test validated.\n";
     }
 };
+
+class FileStreamerReadTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning FileStreamer Read Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_streamed_read_with_backpressure();
+        test_seek_before_read();
+        test_seek_after_end();
+        test_reversed_read();
+
+        std::cout << "All FileStreamer Read Tests Completed Successfully.\n";
+    }
+
+private:
+    static constexpr size_t kFrames = 10000;
+
+    /// stereo float WAV where frame i holds (i, -i) / kFrames.
+    static std::string write_ramp() {
+        const std::string path = "/tmp/aj_streamer_read_test.wav";
+
+        SF_INFO info{};
+        info.channels = 2;
+        info.samplerate = 44100;
+        info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+
+        SNDFILE *file = sf_open(path.c_str(), SFM_WRITE, &info);
+        assert(file);
+
+        std::vector<float> samples(2 * kFrames);
+        for (size_t i = 0; i < kFrames; ++i) {
+            samples[2 * i] = static_cast<float>(i) / kFrames;
+            samples[2 * i + 1] = -static_cast<float>(i) / kFrames;
+        }
+
+        assert(sf_writef_float(file, samples.data(), kFrames) == static_cast<sf_count_t>(kFrames));
+        sf_close(file);
+        return path;
+    }
+
+    /// drain the queue on this thread until the streamer is done, check every frame is the next one
+    /// (the previous one of the file when `reversed`).
+    static size_t consume(AJ::utils::Queue &queue, AJ::utils::BufferPool &pool,
+        AJ::io::file_streamer::FileStreamer &streamer, size_t first, AJ::error::IErrorHandler &handler,
+        bool reversed = false) {
+        size_t expected = first;
+
+        while (true) {
+            const bool done = streamer.endFlag()->flag.load(std::memory_order_acquire);
+            AJ::utils::Buffer *buffer = queue.pop();
+
+            if (!buffer) {
+                if (done) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+
+            for (size_t f = 0; f < buffer->frames; ++f, ++expected) {
+                const size_t frame = reversed ? kFrames - 1 - expected : expected;
+                assert(buffer->data[2 * f] == static_cast<float>(frame) / kFrames);
+                assert(buffer->data[2 * f + 1] == -static_cast<float>(frame) / kFrames);
+            }
+
+            pool.push(buffer, handler);
+        }
+
+        return expected - first;
+    }
+
+    static void test_streamed_read_with_backpressure() {
+        std::cout << "\nTest: Streamed read through a small pool\n";
+        AJ::error::ConsoleErrorHandler handler;
+
+        // 4 buffers of 512 frames for a 10000 frames file: the reader must wait for the consumer.
+        auto pool = std::make_shared<AJ::utils::BufferPool>(handler, 4, 512, 2);
+        auto queue = std::make_shared<AJ::utils::Queue>(true, 4, 512, 2, handler);
+        auto stopFlag = std::make_shared<AJ::LFControlFlag>();
+        stopFlag->flag.store(false, std::memory_order_release);
+
+        AJ::io::file_streamer::FileStreamer streamer(queue, pool, stopFlag,
+            AJ::FileStreamingTypes::playing, "/tmp");
+
+        assert(streamer.setReadInfo(write_ramp(), handler));
+        assert(streamer.readInfo()->channels == 2);
+        assert(streamer.readInfo()->samplerate == 44100);
+        assert(streamer.readInfo()->length == 2 * kFrames);
+
+        AJ::utils::ThreadPool tp(1);
+        std::future<bool> reader = tp.enqueue([&] {
+            return streamer.read(handler);
+        });
+
+        assert(consume(*queue, *pool, streamer, 0, handler) == kFrames);
+
+        //* the reader waits for a seek at the end of the file.
+        stopFlag->flag.store(true, std::memory_order_release);
+        assert(reader.get());
+        assert(streamer.readPosition() == static_cast<AJ::sample_pos>(kFrames));
+        assert(pool->currentSize() == 4);
+
+        std::cout << "  ✓ Every frame streamed in order with 4 buffers.\n";
+    }
+
+    static void test_seek_before_read() {
+        std::cout << "\nTest: Seek moves the decode position\n";
+        AJ::error::ConsoleErrorHandler handler;
+
+        auto pool = std::make_shared<AJ::utils::BufferPool>(handler, 8, 1024, 2);
+        auto queue = std::make_shared<AJ::utils::Queue>(true, 8, 1024, 2, handler);
+        auto stopFlag = std::make_shared<AJ::LFControlFlag>();
+        stopFlag->flag.store(false, std::memory_order_release);
+
+        AJ::io::file_streamer::FileStreamer streamer(queue, pool, stopFlag,
+            AJ::FileStreamingTypes::playing, "/tmp");
+
+        assert(streamer.setReadInfo(write_ramp(), handler));
+        streamer.seek(7000);
+
+        AJ::utils::ThreadPool tp(1);
+        std::future<bool> reader = tp.enqueue([&] {
+            return streamer.read(handler);
+        });
+
+        assert(consume(*queue, *pool, streamer, 7000, handler) == kFrames - 7000);
+        stopFlag->flag.store(true, std::memory_order_release);
+        assert(reader.get());
+
+        std::cout << "  ✓ Read started at the seek target.\n";
+    }
+
+    static void test_seek_after_end() {
+        std::cout << "\nTest: A seek after the end of the file reads again\n";
+        AJ::error::ConsoleErrorHandler handler;
+
+        auto pool = std::make_shared<AJ::utils::BufferPool>(handler, 4, 512, 2);
+        auto queue = std::make_shared<AJ::utils::Queue>(true, 4, 512, 2, handler);
+        auto stopFlag = std::make_shared<AJ::LFControlFlag>();
+        stopFlag->flag.store(false, std::memory_order_release);
+
+        AJ::io::file_streamer::FileStreamer streamer(queue, pool, stopFlag,
+            AJ::FileStreamingTypes::playing, "/tmp");
+
+        assert(streamer.setReadInfo(write_ramp(), handler));
+
+        AJ::utils::ThreadPool tp(1);
+        std::future<bool> reader = tp.enqueue([&] {
+            return streamer.read(handler);
+        });
+
+        assert(consume(*queue, *pool, streamer, 0, handler) == kFrames);
+
+        //? 5000 frames don't fit in the 4 buffers: the end flag stays cleared until they're consumed.
+        streamer.seek(5000);
+        while (streamer.endFlag()->flag.load(std::memory_order_acquire)) std::this_thread::yield();
+
+        assert(consume(*queue, *pool, streamer, 5000, handler) == kFrames - 5000);
+        assert(reader.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+
+        stopFlag->flag.store(true, std::memory_order_release);
+        assert(reader.get());
+        assert(pool->currentSize() == 4);
+
+        std::cout << "  ✓ The reader stayed at the end and streamed the file again from 5000.\n";
+    }
+
+    static void test_reversed_read() {
+        std::cout << "\nTest: Reversed read streams the file from its last frame\n";
+        AJ::error::ConsoleErrorHandler handler;
+
+        auto pool = std::make_shared<AJ::utils::BufferPool>(handler, 4, 768, 2);
+        auto queue = std::make_shared<AJ::utils::Queue>(true, 4, 768, 2, handler);
+        auto stopFlag = std::make_shared<AJ::LFControlFlag>();
+        stopFlag->flag.store(false, std::memory_order_release);
+
+        AJ::io::file_streamer::FileStreamer streamer(queue, pool, stopFlag,
+            AJ::FileStreamingTypes::playing, "/tmp");
+
+        assert(streamer.setReadInfo(write_ramp(), handler));
+        streamer.setReadReversed(true);
+        streamer.seek(1234);
+
+        AJ::utils::ThreadPool tp(1);
+        std::future<bool> reader = tp.enqueue([&] {
+            return streamer.read(handler);
+        });
+
+        //* the seek target counts in played order too: 1234 frames from the end.
+        assert(consume(*queue, *pool, streamer, 1234, handler, true) == kFrames - 1234);
+        stopFlag->flag.store(true, std::memory_order_release);
+        assert(reader.get());
+        assert(streamer.readPosition() == static_cast<AJ::sample_pos>(kFrames));
+
+        std::cout << "  ✓ Every frame streamed backwards, in blocks of 768.\n";
+    }
+};
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "file_io/level_index.h"
+#include "file_io/wav_file.h"
+#include "editing/cut.h"
+#include "editing/insert.h"
+#include "dsp/kernels.h"
+#include "core/error_handler.h"
+#include "audio_fixtures.h"
+
+class LevelIndexTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Level Index Tests\n";
+        std::cout << "--------------------------------------------------\n";
+
+        test_queries_match_scan();
+        test_update_after_edit();
+        test_cut_and_insert_keep_index();
+        test_loudness_cache();
+
+        std::cout << "All Level Index Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::shared_ptr<AJ::io::WAV_File> make_file(size_t frames) {
+        return fixtures::make_file(frames, 2, [](size_t ch, size_t i) {
+            return 0.6f * std::sin(0.0003f * i * (ch + 1)) + 0.2f * std::sin(0.21f * i);
+        });
+    }
+
+    static AJ::dsp::kernels::Levels scan(const AJ::Float &samples, size_t start, size_t end) {
+        return AJ::dsp::kernels::analyzeScalar(samples.data() + start, end - start + 1);
+    }
+
+    static void assert_levels(const AJ::dsp::kernels::Levels &a, const AJ::dsp::kernels::Levels &b) {
+        assert(a.min == b.min);
+        assert(a.max == b.max);
+        assert(std::fabs(a.sumSquares - b.sumSquares) <= 1e-9 * b.sumSquares + 1e-12);
+    }
+
+    /// every query shape: inside one base block, unaligned edges, whole top-level blocks, the tail.
+    static void assert_queries(const AJ::io::WAV_File &wav) {
+        AJ::error::ConsoleErrorHandler errorHandler;
+        const size_t frames = wav.pAudio->at(0).size();
+
+        const std::vector<std::pair<size_t, size_t>> ranges = {
+            {0, 0}, {3, 200}, {100, 300}, {0, 255}, {256, 4095}, {17, 70000},
+            {65536, 2 * 65536 - 1}, {1000, frames - 1}, {0, frames - 1}, {frames - 5, frames - 1}
+        };
+
+        for (uint8_t ch = 0; ch < 2; ++ch) {
+            for (auto [start, end] : ranges) {
+                if (end >= frames) continue;
+
+                AJ::dsp::kernels::Levels levels;
+                assert(wav.levels(ch, start, end, levels, errorHandler));
+                assert_levels(levels, scan(wav.pAudio->at(ch), start, end));
+            }
+        }
+    }
+
+    static void test_queries_match_scan() {
+        std::cout << "\nTest: Level index queries match a scan of the samples\n";
+
+        auto wav = make_file(3 * 65536 + 4321);
+        wav->buildLevelIndex();
+        assert(wav->levelIndex());
+        assert(wav->levelIndex()->frames(0) == 3 * 65536 + 4321);
+        assert(wav->levelIndex()->blocks(0, 2).size() == 4);
+
+        assert_queries(*wav);
+
+        // invalid ranges are reported.
+        AJ::error::ConsoleErrorHandler errorHandler;
+        AJ::dsp::kernels::Levels levels;
+        assert(!wav->levels(0, 10, 5, levels, errorHandler));
+        assert(!wav->levels(0, 0, 3 * 65536 + 4321, levels, errorHandler));
+
+        std::cout << "  ✓ Queries match.\n";
+    }
+
+    static void test_update_after_edit() {
+        std::cout << "\nTest: Level index follows an edited range\n";
+
+        auto wav = make_file(2 * 65536 + 77);
+        wav->buildLevelIndex();
+
+        for (uint8_t ch = 0; ch < 2; ++ch) {
+            AJ::Float &samples = wav->pAudio->at(ch);
+            for (size_t i = 5000; i <= 70000; ++i) samples[i] *= 0.25f;
+            samples[6000] = 0.99f;
+        }
+        wav->updateLevelIndex(5000, 70000);
+
+        assert_queries(*wav);
+
+        std::cout << "  ✓ Edited range re-indexed.\n";
+    }
+
+    static void test_cut_and_insert_keep_index() {
+        std::cout << "\nTest: Cut and Insert keep the level index up to date\n";
+
+        AJ::error::ConsoleErrorHandler errorHandler;
+        auto wav = make_file(2 * 65536 + 999);
+        wav->buildLevelIndex();
+
+        AJ::editing::cut::Cut cut;
+        assert(cut.setRange(1234, 40000, errorHandler));
+        assert(cut.process(wav, errorHandler));
+        assert(wav->levelIndex()->frames(0) == wav->pAudio->at(0).size());
+        assert_queries(*wav);
+
+        auto extra = std::make_shared<AJ::AudioBuffer>();
+        for (uint8_t ch = 0; ch < 2; ++ch) {
+            extra->at(ch).assign(70000, ch == 0 ? 0.95f : -0.9f);
+        }
+
+        AJ::editing::insert::Insert insert;
+        assert(insert.setInsertAt(500, errorHandler));
+        assert(insert.process(wav, extra, errorHandler));
+        assert(wav->levelIndex()->frames(1) == wav->pAudio->at(1).size());
+        assert_queries(*wav);
+
+        AJ::dsp::kernels::Levels levels;
+        assert(wav->levels(0, 500, 500 + 69999, levels, errorHandler));
+        assert(levels.min == 0.95f && levels.max == 0.95f);
+
+        std::cout << "  ✓ Index matches after cut and insert.\n";
+    }
+
+    static void test_loudness_cache() {
+        std::cout << "\nTest: Loudness measurements are cached until their range changes\n";
+
+        AJ::error::ConsoleErrorHandler errorHandler;
+        auto wav = make_file(2 * 65536 + 77);
+        wav->mInfo.samplerate = 48000;
+        wav->buildLevelIndex();
+
+        AJ::dsp::loudness::Measurement whole, tail;
+        assert(wav->loudness(0, 2 * 65536 + 76, whole, nullptr, errorHandler));
+        assert(wav->loudness(100000, 130000, tail, nullptr, errorHandler));
+        assert(whole.audible() && tail.audible());
+
+        const AJ::dsp::loudness::Measurement *cached = wav->levelIndex()->loudness(0, 2 * 65536 + 76, 48000);
+        assert(cached && cached->mIntegrated == whole.mIntegrated && cached->mTruePeak == whole.mTruePeak);
+        assert(!wav->levelIndex()->loudness(0, 2 * 65536 + 76, 44100));
+
+        //* an edit drops the ranges it touches only.
+        for (uint8_t ch = 0; ch < 2; ++ch) {
+            AJ::Float &samples = wav->pAudio->at(ch);
+            for (size_t i = 5000; i <= 70000; ++i) samples[i] *= 0.5f;
+        }
+        wav->updateLevelIndex(5000, 70000);
+
+        assert(!wav->levelIndex()->loudness(0, 2 * 65536 + 76, 48000));
+        assert(wav->levelIndex()->loudness(100000, 130000, 48000));
+
+        AJ::dsp::loudness::Measurement edited;
+        assert(wav->loudness(0, 2 * 65536 + 76, edited, nullptr, errorHandler));
+        assert(edited.mIntegrated < whole.mIntegrated);
+
+        assert(!wav->loudness(10, 5, edited, nullptr, errorHandler));
+
+        std::cout << "  ✓ Cached, dropped by the edit.\n";
+    }
+};
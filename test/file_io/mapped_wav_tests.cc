@@ -0,0 +1,266 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "file_io/mapped_wav.h"
+#include "file_io/wav_file.h"
+#include "core/error_handler.h"
+
+class MappedWavTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Mapped WAV Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_pcm16_stereo();
+        test_pcm24_and_float();
+        test_wav_file_reads_mapped();
+        test_wav_file_reads_range();
+        test_rf64();
+        test_rejected_files();
+
+        std::cout << "All Mapped WAV Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::string temp_path(const std::string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    static void put_u16(std::vector<uint8_t> &out, uint16_t v) {
+        out.push_back(v & 0xFF);
+        out.push_back(v >> 8);
+    }
+
+    static void put_u32(std::vector<uint8_t> &out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back((v >> (8 * i)) & 0xFF);
+    }
+
+    /// RIFF WAV with an extra chunk before the data, `data` holds the interleaved sample bytes.
+    static void write_wav(const std::string &path, uint16_t format, uint16_t channels, uint16_t bits,
+        const std::vector<uint8_t> &data) {
+        std::vector<uint8_t> file = {'R', 'I', 'F', 'F'};
+        put_u32(file, static_cast<uint32_t>(4 + 24 + 10 + 8 + data.size()));
+        file.insert(file.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+        put_u32(file, 16);
+        put_u16(file, format);
+        put_u16(file, channels);
+        put_u32(file, 48000);
+        put_u32(file, 48000 * channels * bits / 8);
+        put_u16(file, channels * bits / 8);
+        put_u16(file, bits);
+
+        // odd sized chunk, padded to 2 bytes.
+        file.insert(file.end(), {'L', 'I', 'S', 'T'});
+        put_u32(file, 1);
+        file.insert(file.end(), {0, 0});
+
+        file.insert(file.end(), {'d', 'a', 't', 'a'});
+        put_u32(file, static_cast<uint32_t>(data.size()));
+        file.insert(file.end(), data.begin(), data.end());
+
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(file.data()), file.size());
+    }
+
+    static std::vector<uint8_t> pcm16_stereo(size_t frames) {
+        std::vector<uint8_t> data;
+        for (size_t i = 0; i < frames; ++i) {
+            put_u16(data, static_cast<uint16_t>(static_cast<int16_t>(i)));
+            put_u16(data, static_cast<uint16_t>(static_cast<int16_t>(-static_cast<int>(i))));
+        }
+        return data;
+    }
+
+    static void test_pcm16_stereo() {
+        std::cout << "\nTest: 16-bit stereo ranges are converted on demand\n";
+
+        const std::string path = temp_path("aj_mapped_pcm16.wav");
+        write_wav(path, 1, 2, 16, pcm16_stereo(1000));
+
+        AJ::io::MappedWav map;
+        assert(map.open(path));
+        assert(map.frames() == 1000 && map.channels() == 2);
+        assert(map.samplerate() == 48000 && map.bitdepth() == AJ::BitDepth_t::int_16);
+
+        std::vector<float> right(100);
+        assert(map.read(1, 500, 100, right.data()) == 100);
+        assert(right[0] == -500.0f / 32768.0f && right[99] == -599.0f / 32768.0f);
+
+        std::vector<float> left(50), rgt(50);
+        float *outs[2] = {left.data(), rgt.data()};
+        assert(map.readPlanar(980, 50, outs) == 20);
+        assert(left[19] == 999.0f / 32768.0f && rgt[19] == -999.0f / 32768.0f);
+        assert(map.readPlanar(1000, 50, outs) == 0);
+
+        map.close();
+        assert(!map.isOpen());
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ Ranges match the samples\n";
+    }
+
+    static void test_pcm24_and_float() {
+        std::cout << "\nTest: 24-bit PCM and 32-bit float\n";
+
+        const std::string path = temp_path("aj_mapped_24.wav");
+        std::vector<uint8_t> data;
+        for (int32_t v : {0, 1, -1, 8388607, -8388608}) {
+            const uint32_t u = static_cast<uint32_t>(v);
+            data.insert(data.end(), {uint8_t(u), uint8_t(u >> 8), uint8_t(u >> 16)});
+        }
+        write_wav(path, 1, 1, 24, data);
+
+        AJ::io::MappedWav map;
+        assert(map.open(path));
+        std::vector<float> out(5);
+        assert(map.read(0, 0, 5, out.data()) == 5);
+        assert(out[1] == 1.0f / 8388608.0f && out[2] == -1.0f / 8388608.0f);
+        assert(out[4] == -1.0f && out[3] < 1.0f && out[3] > 0.9999f);
+
+        data.clear();
+        for (float v : {0.25f, -0.5f, 1.5f}) {
+            uint32_t u;
+            std::memcpy(&u, &v, sizeof(u));
+            put_u32(data, u);
+        }
+        write_wav(path, 3, 1, 32, data);
+
+        assert(map.open(path));
+        assert(map.bitdepth() == AJ::BitDepth_t::float_32 && map.frames() == 3);
+        assert(map.read(0, 0, 5, out.data()) == 3);
+        assert(out[0] == 0.25f && out[1] == -0.5f && out[2] == 1.5f);
+
+        map.close();
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ Sign extension and float passthrough\n";
+    }
+
+    static void test_wav_file_reads_mapped() {
+        std::cout << "\nTest: WAV_File::read deinterleaves a mapped file\n";
+
+        AJ::error::ConsoleErrorHandler errHandler;
+        const size_t frames = 3 * AJ::kIOChunkFrames / 2 + 7;
+        std::string path = temp_path("aj_mapped_read.wav");
+        write_wav(path, 1, 2, 16, pcm16_stereo(frames));
+
+        AJ::io::WAV_File wav;
+        assert(wav.setFilePath(path));
+        assert(wav.read(errHandler));
+
+        assert(wav.mInfo.channels == 2 && wav.mInfo.length == static_cast<AJ::sample_c>(2 * frames));
+        assert(wav.mInfo.samplerate == 48000 && wav.mInfo.bitdepth == AJ::BitDepth_t::int_16);
+        assert(wav.pAudio->at(0).size() == frames && wav.pAudio->at(1).size() == frames);
+
+        for (size_t i : {size_t(0), size_t(1), AJ::kIOChunkFrames - 1, AJ::kIOChunkFrames, frames - 1}) {
+            const float v = static_cast<int16_t>(i) / 32768.0f;
+            assert(wav.pAudio->at(0)[i] == v && wav.pAudio->at(1)[i] == static_cast<int16_t>(-static_cast<int>(i)) / 32768.0f);
+        }
+
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ Both channels match across chunk edges\n";
+    }
+
+    static void test_wav_file_reads_range() {
+        std::cout << "\nTest: WAV_File::readRange only converts the requested frames\n";
+
+        AJ::error::CollectingErrorHandler errHandler;
+        const size_t frames = 2 * AJ::kIOChunkFrames + 100;
+        std::string path = temp_path("aj_mapped_range.wav");
+        write_wav(path, 1, 2, 16, pcm16_stereo(frames));
+
+        AJ::io::WAV_File wav;
+        assert(wav.setFilePath(path));
+
+        // across a chunk edge.
+        const size_t first = AJ::kIOChunkFrames - 10;
+        assert(wav.readRange(first, first + 19, errHandler));
+        assert(wav.pAudio->at(0).size() == 20 && wav.mInfo.length == 40);
+        assert(wav.rangeStart() == static_cast<AJ::sample_pos>(first) && wav.sourceFrames() == frames && wav.isPartial());
+        assert(wav.pAudio->at(0)[0] == static_cast<int16_t>(first) / 32768.0f);
+        assert(wav.pAudio->at(1)[19] == static_cast<int16_t>(-static_cast<int>(first + 19)) / 32768.0f);
+
+        // -1 (or an end past the file) reads to the end.
+        assert(wav.readRange(frames - 5, -1, errHandler) && wav.pAudio->at(1).size() == 5);
+        assert(wav.readRange(0, frames + 50, errHandler) && wav.pAudio->at(0).size() == frames && !wav.isPartial());
+
+        assert(!wav.readRange(frames, -1, errHandler));
+        assert(!wav.readRange(10, 5, errHandler));
+        assert(errHandler.errors().size() == 2);
+
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ Range, clamping and invalid ranges\n";
+    }
+
+    static void test_rf64() {
+        std::cout << "\nTest: RF64 data size comes from the ds64 chunk\n";
+
+        // RF64 header: 0xFFFFFFFF sizes, the real data size in ds64.
+        std::vector<uint8_t> file = {'R', 'F', '6', '4'};
+        put_u32(file, 0xFFFFFFFF);
+        file.insert(file.end(), {'W', 'A', 'V', 'E', 'd', 's', '6', '4'});
+        put_u32(file, 28);
+        for (uint64_t v : {uint64_t(0), uint64_t(40), uint64_t(10)}) {
+            put_u32(file, static_cast<uint32_t>(v));
+            put_u32(file, static_cast<uint32_t>(v >> 32));
+        }
+        put_u32(file, 0);
+
+        file.insert(file.end(), {'f', 'm', 't', ' '});
+        put_u32(file, 16);
+        put_u16(file, 1);
+        put_u16(file, 2);
+        put_u32(file, 48000);
+        put_u32(file, 48000 * 4);
+        put_u16(file, 4);
+        put_u16(file, 16);
+
+        file.insert(file.end(), {'d', 'a', 't', 'a'});
+        put_u32(file, 0xFFFFFFFF);
+        const std::vector<uint8_t> data = pcm16_stereo(12); // 2 frames past the ds64 size.
+        file.insert(file.end(), data.begin(), data.end());
+
+        const std::string path = temp_path("aj_mapped_rf64.wav");
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(file.data()), file.size());
+
+        AJ::io::MappedWav map;
+        assert(map.open(path));
+        assert(map.frames() == 10 && map.channels() == 2);
+
+        std::vector<float> left(10);
+        assert(map.read(0, 0, 20, left.data()) == 10 && left[9] == 9.0f / 32768.0f);
+
+        map.close();
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ ds64 size used\n";
+    }
+
+    static void test_rejected_files() {
+        std::cout << "\nTest: Unsupported files are left to libsndfile\n";
+
+        AJ::io::MappedWav map;
+        assert(!map.open(temp_path("aj_mapped_missing.wav")));
+
+        // A-law (format 6) isn't converted by the mapping.
+        const std::string path = temp_path("aj_mapped_alaw.wav");
+        write_wav(path, 6, 1, 8, std::vector<uint8_t>(64, 0xD5));
+        assert(!map.open(path));
+        assert(!map.isOpen());
+
+        std::ofstream(path, std::ios::binary) << "not a riff file, just some text long enough to map";
+        assert(!map.open(path));
+
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ Mapping refused\n";
+    }
+};
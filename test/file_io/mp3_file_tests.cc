@@ -1,10 +1,13 @@
 #include <iostream>
+#include <algorithm>
 #include <chrono>
 #include <cassert>
+#include <cmath>
 #include <filesystem>
 #include "../include/file_io/mp3_file.h"
 #include "../include/core/errors.h"
 #include "../include/core/error_handler.h"
+#include "../include/core/thread_pool.h"
 
 namespace fs = std::filesystem;
 
@@ -63,7 +66,61 @@ private:
                   << ", Samplerate: " << info.samplerate << "\n";
 
         assert(info.channels == expected_channels);
-        
+
+        // Range: seeking decodes exactly the requested frames.
+        {
+            const sample_pos frames = static_cast<sample_pos>(info.length / info.channels);
+            const sample_pos first = frames / 2;
+            const sample_pos last = std::min<sample_pos>(first + 44099, frames - 1);
+
+            MP3_File part;
+            assert(part.setFilePath(input_path));
+            assert(part.readRange(first, last, errorHandler));
+            assert(part.rangeStart() == first && part.isPartial());
+            assert(part.pAudio->at(0).size() == static_cast<size_t>(last - first + 1));
+            assert(part.mInfo.length == static_cast<sample_c>(last - first + 1) * info.channels);
+        }
+
+        // Parallel segments: the same samples as the sequential decode.
+        {
+            AJ::utils::ThreadPool pool(4);
+            MP3_File segmented;
+            assert(segmented.setFilePath(input_path));
+            segmented.setReadPool(&pool);
+
+            auto start_segmented = std::chrono::high_resolution_clock::now();
+            assert(segmented.read(errorHandler));
+            std::chrono::duration<double> elapsed_segmented = std::chrono::high_resolution_clock::now() - start_segmented;
+            std::cout << "Segmented read time: " << elapsed_segmented.count() << "s\n";
+
+            assert(segmented.mInfo.length == info.length);
+            for (int ch = 0; ch < expected_channels; ++ch) {
+                const Float &expected = mp3.pAudio->at(ch);
+                const Float &got = segmented.pAudio->at(ch);
+                assert(got.size() == expected.size());
+                for (size_t i = 0; i < got.size(); ++i) assert(std::fabs(got[i] - expected[i]) <= 1e-6f);
+            }
+        }
+
+        // Seek index: a range seeked through it has the samples of the full decode.
+        if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".mp3") == 0) {
+            MP3_File indexed;
+            assert(indexed.setFilePath(input_path));
+            assert(indexed.buildSeekIndex(errorHandler));
+            assert(mp3.seekIndex() && indexed.seekIndex()->packets() == mp3.seekIndex()->packets());
+
+            const sample_pos frames = static_cast<sample_pos>(info.length / info.channels);
+            const sample_pos first = frames * 2 / 3;
+            const sample_pos last = std::min<sample_pos>(first + 44099, frames - 1);
+            assert(indexed.readRange(first, last, errorHandler));
+
+            for (int ch = 0; ch < expected_channels; ++ch) {
+                const Float &got = indexed.pAudio->at(ch);
+                assert(got.size() == static_cast<size_t>(last - first + 1));
+                for (size_t i = 0; i < got.size(); ++i) assert(std::fabs(got[i] - mp3.pAudio->at(ch)[first + i]) <= 1e-6f);
+            }
+        }
+
 
         // Prepare write info (writes as WAV by default)
         AudioWriteInfo write_info;
@@ -0,0 +1,212 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "file_io/mp3_stream_encoder.h"
+#include "file_io/mp3_file.h"
+#include "core/buffer_pool.h"
+#include "core/thread_pool.h"
+
+class Mp3StreamEncoderTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning MP3 Stream Encoder Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_append_round_trip();
+        test_pipelined_queue();
+        test_run_on_busy_pool();
+        test_resampled_input();
+
+        std::cout << "All MP3 Stream Encoder Tests Completed Successfully.\n";
+    }
+
+private:
+    static constexpr uint32_t kRate = 44100;
+
+    static std::string temp_path(const std::string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    static float sample(size_t frame, uint8_t ch) {
+        return 0.5f * std::sin(2.0f * 3.14159265f * (ch ? 660.0f : 440.0f) * frame / kRate);
+    }
+
+    /// decodes the file back, the encoder delay and padding only add frames.
+    static size_t decoded_frames(const std::string &path, uint8_t channels) {
+        AJ::error::CollectingErrorHandler handler;
+        AJ::io::MP3_File file;
+        std::string file_path = path;
+
+        assert(file.setFilePath(file_path));
+        assert(file.read(handler));
+        assert(file.mInfo.channels == channels);
+        return file.pAudio->at(0).size();
+    }
+
+    static void test_append_round_trip() {
+        std::cout << "\nTest: Appended blocks are encoded on the calling thread\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = temp_path("aj_mp3_stream_append.mp3");
+        const size_t frames = kRate * 2;
+
+        AJ::io::Mp3StreamEncoder encoder;
+        assert(encoder.open(path, 2, kRate, AJ::io::Mp3StreamOptions(), handler));
+
+        // blocks that aren't a multiple of the encoder frame size.
+        std::vector<float> block(2 * 1000);
+        for (size_t start = 0; start < frames; start += 1000) {
+            for (size_t i = 0; i < 1000; ++i) {
+                block[2 * i] = sample(start + i, 0);
+                block[2 * i + 1] = sample(start + i, 1);
+            }
+            assert(encoder.append(block.data(), 1000, handler));
+        }
+
+        // opened for interleaved blocks.
+        const float* planes[2] = { block.data(), block.data() };
+        assert(!encoder.appendPlanar(planes, 10, handler));
+        handler.clear();
+
+        assert(encoder.frames() == frames);
+        assert(encoder.close(handler));
+        assert(handler.errors().empty());
+
+        const size_t decoded = decoded_frames(path, 2);
+        assert(decoded >= frames && decoded < frames + 4 * AJ::kMP3MaxFrameSamples);
+
+        std::filesystem::remove(path);
+        std::cout << "  ✓ Decoded length matches\n";
+    }
+
+    //* pushes `blocks` blocks of sample() through `queue`, then sets `done`.
+    static void fill(AJ::utils::BufferPool &pool, AJ::utils::Queue &queue, AJ::LFControlFlag &done,
+        size_t block, size_t blocks) {
+        for (size_t b = 0; b < blocks; ++b) {
+            AJ::utils::Buffer* buffer = nullptr;
+            while (!(buffer = pool.tryPop())) std::this_thread::yield();
+
+            for (size_t i = 0; i < block; ++i) {
+                buffer->data[2 * i] = sample(b * block + i, 0);
+                buffer->data[2 * i + 1] = sample(b * block + i, 1);
+            }
+            buffer->frames = block;
+
+            while (!queue.push(buffer)) std::this_thread::yield();
+        }
+
+        done.flag.store(true, std::memory_order_release);
+        queue.wake();
+    }
+
+    static void test_pipelined_queue() {
+        std::cout << "\nTest: Queued buffers are encoded by the pipeline\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = temp_path("aj_mp3_stream_queue.mp3");
+        const size_t block = 512, blocks = 400;
+
+        auto pool = std::make_shared<AJ::utils::BufferPool>(handler, 16, block, 2);
+        auto queue = std::make_shared<AJ::utils::Queue>(true, 16, block, 2, handler);
+        auto done = std::make_shared<AJ::LFControlFlag>();
+        auto threads = std::make_shared<AJ::utils::ThreadPool>(4);
+
+        AJ::io::Mp3StreamEncoder encoder;
+        assert(encoder.open(path, 2, kRate, AJ::io::Mp3StreamOptions(), handler));
+
+        // a pool of 16 buffers for 400 blocks, the encoder has to recycle them.
+        std::thread producer([&] { fill(*pool, *queue, *done, block, blocks); });
+
+        assert(encoder.run(queue, pool, done, threads, handler));
+        producer.join();
+
+        assert(encoder.frames() == block * blocks);
+        assert(encoder.close(handler));
+        assert(handler.errors().empty());
+        assert(pool->currentSize() == 16);
+
+        const size_t decoded = decoded_frames(path, 2);
+        assert(decoded >= block * blocks && decoded < block * blocks + 4 * AJ::kMP3MaxFrameSamples);
+
+        std::filesystem::remove(path);
+        std::cout << "  ✓ Every block encoded, every buffer recycled\n";
+    }
+
+    static void test_run_on_busy_pool() {
+        std::cout << "\nTest: run() on a pool whose workers wait on it encodes inline\n";
+        const size_t block = 512, blocks = 100;
+
+        for (bool nested : { true, false }) {
+            AJ::error::CollectingErrorHandler handler;
+            const std::string path = temp_path("aj_mp3_stream_busy.mp3");
+
+            auto pool = std::make_shared<AJ::utils::BufferPool>(handler, 16, block, 2);
+            auto queue = std::make_shared<AJ::utils::Queue>(true, 16, block, 2, handler);
+            auto done = std::make_shared<AJ::LFControlFlag>();
+            auto threads = std::make_shared<AJ::utils::ThreadPool>(2);
+
+            AJ::io::Mp3StreamEncoder encoder;
+            assert(encoder.open(path, 2, kRate, AJ::io::Mp3StreamOptions(), handler));
+
+            //? nested: the producer holds a worker until the converter gave back its buffers, run()
+            //? the other, the stages queued behind them never start on a worker. Otherwise the
+            //? stages may take both workers while the producer is still queued.
+            std::future<void> producer = threads->enqueue([&] { fill(*pool, *queue, *done, block, blocks); });
+            if (nested) {
+                std::future<bool> encoded = threads->enqueue([&] {
+                    return encoder.run(queue, pool, done, threads, handler);
+                });
+                assert(encoded.get());
+            } else {
+                assert(encoder.run(queue, pool, done, threads, handler));
+            }
+            producer.get();
+
+            assert(encoder.frames() == block * blocks);
+            assert(encoder.close(handler));
+            assert(handler.errors().empty());
+            assert(pool->currentSize() == 16);
+
+            const size_t decoded = decoded_frames(path, 2);
+            assert(decoded >= block * blocks && decoded < block * blocks + 4 * AJ::kMP3MaxFrameSamples);
+
+            std::filesystem::remove(path);
+            std::cout << "  ✓ Every block encoded, no deadlock (run() " << (nested ? "on the pool" : "on this thread") << ")\n";
+        }
+    }
+
+    static void test_resampled_input() {
+        std::cout << "\nTest: Input at another rate is resampled\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = temp_path("aj_mp3_stream_resampled.mp3");
+        const size_t frames = 48000;
+
+        AJ::io::Mp3StreamOptions options;
+        options.inputSamplerate = 48000;
+        options.planar = true;
+
+        std::vector<float> mono(frames);
+        for (size_t i = 0; i < frames; ++i) mono[i] = sample(i, 0);
+        const float* planes[1] = { mono.data() };
+
+        AJ::io::Mp3StreamEncoder encoder;
+        assert(encoder.open(path, 1, kRate, options, handler));
+        assert(encoder.appendPlanar(planes, frames, handler));
+        assert(encoder.close(handler));
+        assert(!encoder.isOpen());
+
+        // one second at 48 kHz is one second at 44.1 kHz.
+        const size_t decoded = decoded_frames(path, 1);
+        assert(decoded >= kRate - 64 && decoded < kRate + 4 * AJ::kMP3MaxFrameSamples);
+
+        std::filesystem::remove(path);
+        std::cout << "  ✓ Length follows the output rate\n";
+    }
+};
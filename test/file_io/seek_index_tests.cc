@@ -0,0 +1,98 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "file_io/seek_index.h"
+
+class SeekIndexTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Seek Index Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_points_follow_packets();
+        test_seek_point_matches_search();
+        test_start_of_file();
+
+        std::cout << "All Seek Index Tests Completed Successfully.\n";
+    }
+
+private:
+    //* an MP3 like stream: 1152 frames per packet, VBR packet sizes, the encoder delay skipped.
+    static AJ::io::SeekIndex make_index(size_t packets, int64_t skip, unsigned seed, std::vector<int64_t> &starts) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int64_t> bytes(104, 1441);
+
+        AJ::io::SeekIndex index;
+        int64_t pos = 417;
+        int64_t frame = 0;
+        starts.clear();
+
+        for (size_t p = 0; p < packets; ++p) {
+            const int64_t dropped = p == 0 ? skip : 0;
+            starts.push_back(frame);
+            index.append(pos, 1152, dropped);
+            pos += bytes(rng);
+            frame += 1152 - dropped;
+        }
+        return index;
+    }
+
+    static void test_points_follow_packets() {
+        std::cout << "\nTest: Every stride-th packet is a point at the frame its samples start\n";
+
+        std::vector<int64_t> starts;
+        const AJ::io::SeekIndex index = make_index(1000, 1105, 1, starts);
+
+        assert(index.packets() == 1000);
+        assert(index.frames() == 1000 * 1152 - 1105);
+        assert(index.points().size() == (1000 + AJ::kSeekIndexStride - 1) / AJ::kSeekIndexStride);
+
+        for (size_t k = 0; k < index.points().size(); ++k) {
+            assert(index.points()[k].mFrame == starts[k * AJ::kSeekIndexStride]);
+        }
+        assert(index.points()[1].mFrame == static_cast<int64_t>(AJ::kSeekIndexStride * 1152) - 1105);
+
+        std::cout << "  ✓ " << index.points().size() << " points\n";
+    }
+
+    static void test_seek_point_matches_search() {
+        std::cout << "\nTest: seekPoint() is one point before the last one at or before the frame\n";
+
+        std::vector<int64_t> starts;
+        const AJ::io::SeekIndex index = make_index(5000, 576, 2, starts);
+        const auto &points = index.points();
+
+        for (int64_t frame = points[1].mFrame; frame < index.frames() + 5000; frame += 997) {
+            size_t expected = 0;
+            while (expected + 1 < points.size() && points[expected + 1].mFrame <= frame) ++expected;
+
+            const AJ::io::SeekIndex::Point *point = index.seekPoint(frame);
+            if (expected < 2) {
+                assert(!point);
+            } else {
+                assert(point == &points[expected - 1]);
+                assert(frame - point->mFrame >= static_cast<int64_t>(AJ::kSeekIndexStride * 1152));
+            }
+        }
+
+        std::cout << "  ✓ Same points as a linear search\n";
+    }
+
+    static void test_start_of_file() {
+        std::cout << "\nTest: No point near the start of the file or in an empty index\n";
+
+        AJ::io::SeekIndex empty;
+        assert(empty.empty() && !empty.seekPoint(100000));
+
+        std::vector<int64_t> starts;
+        const AJ::io::SeekIndex index = make_index(100, 1105, 3, starts);
+        assert(!index.seekPoint(-5) && !index.seekPoint(0));
+        assert(!index.seekPoint(index.points()[2].mFrame - 1));
+        assert(index.seekPoint(index.points()[2].mFrame) == &index.points()[1]);
+
+        std::cout << "  ✓ Timestamp seeks there\n";
+    }
+};
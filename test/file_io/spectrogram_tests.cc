@@ -0,0 +1,205 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "file_io/spectrogram.h"
+#include "file_io/wav_file.h"
+#include "editing/cut.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+#include "audio_fixtures.h"
+
+class SpectrogramTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Spectrogram Tests\n";
+        std::cout << "--------------------------------------------------\n";
+
+        test_sine_peaks();
+        test_parallel_matches_serial();
+        test_cache_and_budget();
+        test_edits_drop_tiles();
+        test_invalid_requests();
+
+        std::cout << "All Spectrogram Tests Completed Successfully.\n";
+    }
+
+private:
+    using Tiles = std::vector<std::shared_ptr<const AJ::io::SpectrogramTile>>;
+
+    static constexpr size_t kFFT = 1024;
+    static constexpr size_t kHop = 256;
+
+    //* a sine right on `bin` in the left channel, a quieter one an octave up in the right.
+    static std::shared_ptr<AJ::io::WAV_File> make_file(size_t frames, size_t bin) {
+        return fixtures::make_file(frames, 2, [bin](size_t ch, size_t i) {
+            return static_cast<float>((ch == 0 ? 0.5f : 0.25f) * std::sin(2.0 * M_PI * bin * (ch + 1) * i / kFFT));
+        });
+    }
+
+    static size_t peak(const float *column, size_t bins) {
+        size_t best = 0;
+        for (size_t k = 1; k < bins; ++k) {
+            if (column[k] > column[best]) best = k;
+        }
+        return best;
+    }
+
+    static void test_sine_peaks() {
+        std::cout << "\nTest: Every zoom level finds the sines at their bins and amplitudes\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto wav = make_file(300000, 40);
+        auto spectrogram = AJ::io::Spectrogram::create(kFFT, kHop, handler);
+        assert(spectrogram && spectrogram->bins() == kFFT / 2 + 1);
+
+        for (size_t level = 0; level < AJ::kSpectrogramLevels; ++level) {
+            for (uint8_t ch = 0; ch < 2; ++ch) {
+                auto tile = spectrogram->tile(*wav, ch, level, 0, handler);
+                assert(tile && tile->hop == spectrogram->hop(level));
+
+                //* a column whose windows are all inside the file.
+                const size_t c = std::min<size_t>(tile->columns / 2, (300000 - kFFT) / tile->hop - 1);
+                const float *column = tile->column(c);
+                assert(peak(column, tile->bins) == 40 * (ch + 1));
+                assert(std::fabs(column[40 * (ch + 1)] - (ch == 0 ? 0.5f : 0.25f)) < 0.01f);
+            }
+        }
+
+        //* the last tile of a level stops at the end of the file.
+        auto last = spectrogram->tile(*wav, 0, 0, spectrogram->tileCount(*wav, 0) - 1, handler);
+        assert(last && last->columns == (300000 - last->start + kHop - 1) / kHop);
+        assert(last->magnitudes.size() == last->columns * last->bins);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Peaks at bins 40 / 80 on " << AJ::kSpectrogramLevels << " levels\n";
+    }
+
+    static void test_parallel_matches_serial() {
+        std::cout << "\nTest: Tiles computed on the pool match tiles computed on the caller\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ThreadPool pool(4);
+
+        auto wav = make_file(500000, 23);
+        for (size_t i = 0; i < 500000; i += 7919) wav->pAudio->at(0)[i] = 0.9f;
+
+        auto parallel = AJ::io::Spectrogram::create(kFFT, kHop, handler);
+        auto serial = AJ::io::Spectrogram::create(kFFT, kHop, handler);
+
+        for (size_t level : { 0, 2 }) {
+            const size_t count = parallel->tileCount(*wav, level);
+            Tiles a, b;
+            assert(parallel->tiles(*wav, 0, level, 0, count, a, &pool, handler));
+            assert(serial->tiles(*wav, 0, level, 0, count, b, nullptr, handler));
+
+            assert(a.size() == count && b.size() == count);
+            for (size_t t = 0; t < count; ++t) {
+                assert(a[t]->index == t && a[t]->magnitudes == b[t]->magnitudes);
+            }
+        }
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Same magnitudes\n";
+    }
+
+    static void test_cache_and_budget() {
+        std::cout << "\nTest: Tiles are cached up to the budget, least recently used out first\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto wav = make_file(8 * 256 * kHop, 11);
+        const size_t tileBytes = 256 * (kFFT / 2 + 1) * sizeof(float);
+        auto spectrogram = AJ::io::Spectrogram::create(kFFT, kHop, handler, 3 * tileBytes);
+
+        Tiles tiles;
+        assert(spectrogram->tiles(*wav, 0, 0, 0, 3, tiles, nullptr, handler));
+        assert(spectrogram->misses() == 3 && spectrogram->size() == 3 && spectrogram->bytes() == 3 * tileBytes);
+
+        Tiles again;
+        assert(spectrogram->tiles(*wav, 0, 0, 0, 3, again, nullptr, handler));
+        assert(spectrogram->hits() == 3 && again[1] == tiles[1]);
+
+        //* tile 0 was used last: tile 1 goes first.
+        assert(spectrogram->tile(*wav, 0, 0, 0, handler));
+        assert(spectrogram->tile(*wav, 0, 0, 5, handler));
+        assert(spectrogram->size() == 3);
+        assert(spectrogram->tile(*wav, 0, 0, 0, handler) == tiles[0]);
+        assert(spectrogram->tile(*wav, 0, 0, 1, handler) != tiles[1]);
+
+        //* a dropped tile stays valid for whoever holds it.
+        spectrogram->clear();
+        assert(spectrogram->size() == 0 && spectrogram->bytes() == 0);
+        assert(tiles[2]->magnitudes.size() == 256 * (kFFT / 2 + 1));
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ Hits, misses and evictions as expected\n";
+    }
+
+    static void test_edits_drop_tiles() {
+        std::cout << "\nTest: A cut drops the tiles from its start on, the others are kept\n";
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::ThreadPool pool(4);
+
+        auto wav = make_file(10 * 256 * kHop, 31);
+        auto spectrogram = AJ::io::Spectrogram::create(kFFT, kHop, handler);
+        wav->setSpectrogram(spectrogram);
+
+        Tiles before;
+        assert(spectrogram->tiles(*wav, 0, 0, 0, 10, before, &pool, handler));
+
+        //* the cut starts in tile 4 (the windows of tile 3 end before it).
+        AJ::editing::cut::Cut cut;
+        const AJ::sample_pos start = 4 * 256 * kHop + 5000;
+        assert(cut.setRange(start, start + 100000, handler));
+        assert(cut.process(wav, handler));
+        assert(spectrogram->size() == 4);
+
+        Tiles after;
+        const size_t count = spectrogram->tileCount(*wav, 0);
+        assert(spectrogram->tiles(*wav, 0, 0, 0, count, after, &pool, handler));
+        for (size_t t = 0; t < 4; ++t) assert(after[t] == before[t]);
+
+        //* the recomputed tiles match a fresh spectrogram of the edited file.
+        auto fresh = AJ::io::Spectrogram::create(kFFT, kHop, handler);
+        Tiles expected;
+        assert(fresh->tiles(*wav, 0, 0, 0, count, expected, nullptr, handler));
+        for (size_t t = 0; t < count; ++t) assert(after[t]->magnitudes == expected[t]->magnitudes);
+
+        //* an in-place edit drops only the tiles whose windows read it.
+        for (size_t i = 1000; i < 2000; ++i) wav->pAudio->at(0)[i] = 0.0f;
+        wav->updateLevelIndex(1000, 1999);
+        assert(spectrogram->size() == count - 1);
+
+        //* compact samples are read through readFrames().
+        assert(wav->setStorage(AJ::io::SampleStorage::Int16, handler));
+        auto compact = spectrogram->tile(*wav, 0, 0, 0, handler);
+        assert(compact && compact != after[0]);
+        assert(std::fabs(compact->column(100)[31] - 0.5f) < 0.01f);
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ " << count - 4 << " tiles recomputed after the cut, 1 after the in-place edit\n";
+    }
+
+    static void test_invalid_requests() {
+        std::cout << "\nTest: Invalid sizes, channels, levels and tiles are reported\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        assert(!AJ::io::Spectrogram::create(1000, kHop, handler));
+        assert(!AJ::io::Spectrogram::create(kFFT, 0, handler));
+        assert(handler.errors().size() == 2);
+
+        auto wav = make_file(70000, 5);
+        wav->mInfo.channels = 1;
+        auto spectrogram = AJ::io::Spectrogram::create(kFFT, kHop, handler);
+
+        Tiles tiles;
+        assert(!spectrogram->tiles(*wav, 1, 0, 0, 1, tiles, nullptr, handler));
+        assert(!spectrogram->tiles(*wav, 0, AJ::kSpectrogramLevels, 0, 1, tiles, nullptr, handler));
+        assert(!spectrogram->tiles(*wav, 0, 0, 1, 2, tiles, nullptr, handler));
+        assert(spectrogram->tiles(*wav, 0, 0, 0, 2, tiles, nullptr, handler));
+        assert(handler.errors().size() == 5);
+
+        std::cout << "  ✓ Reported\n";
+    }
+};
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cassert>
 #include <filesystem>
+#include <algorithm>
 #include "../include/file_io/wav_file.h"
 #include "../include/core/errors.h"
 #include "../include/core/error_handler.h"
@@ -65,6 +66,16 @@ private:
             return;
         }
 
+        // Probe (header only), must agree with the full read below.
+        AudioInfo probed;
+        {
+            WAV_File header;
+            assert(header.setFilePath(input_path));
+            assert(header.probe(errorHandler));
+            assert(header.pAudio->at(0).empty());
+            probed = header.mInfo;
+        }
+
         // Read
         auto start_read = std::chrono::high_resolution_clock::now();
         bool read_success = wav.read(errorHandler);
@@ -83,6 +94,26 @@ private:
 
         assert(info.channels == expected_channels);
         assert(info.bitdepth == expected_bitdepth);
+        assert(probed.channels == info.channels && probed.length == info.length);
+        assert(probed.samplerate == info.samplerate && probed.bitdepth == info.bitdepth);
+
+        // Range: a slice from the middle must match the full read.
+        {
+            const sample_pos frames = static_cast<sample_pos>(info.length / info.channels);
+            const sample_pos first = frames / 3;
+            const sample_pos last = std::min<sample_pos>(first + 999, frames - 1);
+
+            WAV_File part;
+            assert(part.setFilePath(input_path));
+            assert(part.readRange(first, last, errorHandler));
+            assert(part.rangeStart() == first && part.sourceFrames() == static_cast<sample_c>(frames));
+            assert(part.mInfo.length == static_cast<sample_c>(last - first + 1) * info.channels);
+
+            for (uint8_t ch = 0; ch < info.channels; ++ch) {
+                assert(std::equal(part.pAudio->at(ch).begin(), part.pAudio->at(ch).end(),
+                    wav.pAudio->at(ch).begin() + first));
+            }
+        }
 
         // Now reuse the same object to write
         AudioWriteInfo write_info;
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "file_io/wav_stream_writer.h"
+#include "file_io/mapped_wav.h"
+#include "core/error_handler.h"
+
+class WavStreamWriterTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning WAV Stream Writer Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_coalesced_blocks(false);
+        test_coalesced_blocks(true);
+        test_empty_stream();
+        test_preallocated_rf64();
+
+        std::cout << "All WAV Stream Writer Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::string temp_path(const std::string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    static void test_coalesced_blocks(bool direct) {
+        std::cout << "\nTest: Small blocks are coalesced into batches" << (direct ? " (O_DIRECT)" : "") << "\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = temp_path("aj_stream_writer.wav");
+
+        // 235 stereo frames per block (a 5.33 ms callback at 44.1k), 16 KiB batches.
+        const size_t block = 235, blocks = 100;
+        AJ::io::WavStreamOptions options;
+        options.batchBytes = 16 * 1024;
+        options.direct = direct;
+
+        AJ::io::WavStreamWriter writer;
+        assert(writer.open(path, 2, 44100, options, handler));
+
+        std::vector<float> samples(2 * block);
+        for (size_t b = 0; b < blocks; ++b) {
+            for (size_t i = 0; i < block; ++i) {
+                samples[2 * i] = static_cast<float>(b * block + i);
+                samples[2 * i + 1] = -static_cast<float>(b * block + i);
+            }
+            assert(writer.append(samples.data(), block, handler));
+        }
+
+        // 4 KiB header + 188000 sample bytes: 11 full batches before close.
+        assert(writer.frames() == block * blocks);
+        assert(writer.writes() == (4096 + block * blocks * 8) / (16 * 1024));
+        assert(writer.close(handler));
+        assert(!writer.isOpen() && handler.errors().empty());
+
+        AJ::io::MappedWav map;
+        assert(map.open(path));
+        assert(map.channels() == 2 && map.samplerate() == 44100);
+        assert(map.bitdepth() == AJ::BitDepth_t::float_32 && map.frames() == block * blocks);
+
+        std::vector<float> left(block * blocks), right(block * blocks);
+        float *outs[2] = {left.data(), right.data()};
+        assert(map.readPlanar(0, block * blocks, outs) == block * blocks);
+
+        for (size_t i = 0; i < block * blocks; ++i) {
+            assert(left[i] == static_cast<float>(i) && right[i] == -static_cast<float>(i));
+        }
+
+        map.close();
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ " << writer.writes() << " writes, samples and header match\n";
+    }
+
+    static void test_preallocated_rf64() {
+        std::cout << "\nTest: Preallocated RF64 stream is trimmed and stays WAV under 4 GiB\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = temp_path("aj_stream_writer_prealloc.wav");
+
+        AJ::io::WavStreamOptions options;
+        options.batchBytes = 8 * 1024;
+        options.preallocateBytes = 1 << 20;
+        options.rf64 = true;
+
+        AJ::io::WavStreamWriter writer;
+        assert(writer.open(path, 1, 48000, options, handler));
+
+        //? fallocate isn't supported everywhere (the writer then just grows the file).
+        const bool reserved = writer.allocated() > 0;
+        if (reserved) assert(writer.allocated() >= (1u << 20));
+
+        std::vector<float> block(1000, 0.5f);
+        for (int i = 0; i < 300; ++i) assert(writer.append(block.data(), block.size(), handler));
+        if (reserved) assert(writer.allocated() >= 2u << 20);
+
+        assert(writer.close(handler) && handler.errors().empty());
+        assert(std::filesystem::file_size(path) == AJ::kStreamWriteAlignment + 300 * 1000 * sizeof(float));
+
+        std::ifstream file(path, std::ios::binary);
+        char magic[4];
+        file.read(magic, 4);
+        assert(std::string(magic, 4) == "RIFF");
+
+        AJ::io::MappedWav map;
+        assert(map.open(path) && map.frames() == 300 * 1000);
+
+        map.close();
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ " << (reserved ? "Reserved extents trimmed" : "fallocate unsupported, file grew") << "\n";
+    }
+
+    static void test_empty_stream() {
+        std::cout << "\nTest: A stream closed without samples is a valid empty WAV\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        const std::string path = temp_path("aj_stream_writer_empty.wav");
+
+        AJ::io::WavStreamWriter writer;
+        assert(!writer.append(nullptr, 0, handler)); // not open.
+        AJ::io::WavStreamOptions options;
+        options.batchBytes = 0;
+        assert(writer.open(path, 1, 48000, options, handler));
+        assert(writer.close(handler));
+        assert(std::filesystem::file_size(path) == AJ::kStreamWriteAlignment);
+
+        // no data: the mapping has nothing to offer, but the header is complete.
+        AJ::io::MappedWav map;
+        assert(map.open(path) && map.frames() == 0 && map.channels() == 1);
+
+        map.close();
+        std::filesystem::remove(path);
+
+        std::cout << "  ✓ Header only\n";
+    }
+};
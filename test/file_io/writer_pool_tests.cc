@@ -0,0 +1,148 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "file_io/writer_pool.h"
+#include "file_io/file_streamer.h"
+#include "core/buffer_pool.h"
+#include "core/error_handler.h"
+#include "core/types.h"
+
+class WriterPoolTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Writer Pool Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_shared_pool_lease();
+        test_many_streams_few_writers();
+        test_remove_unknown();
+
+        std::cout << "All Writer Pool Tests Completed Successfully.\n";
+    }
+
+private:
+    static void test_shared_pool_lease() {
+        std::cout << "\nTest: Streams lease their pools from one shared pool\n";
+
+        AJ::error::CollectingErrorHandler handler;
+        AJ::utils::SharedBufferPool shared(handler, 64, 128, 1);
+        assert(shared.isValid() && shared.available() == 64);
+
+        std::shared_ptr<AJ::utils::BufferPool> a = shared.lease(32, handler);
+        std::shared_ptr<AJ::utils::BufferPool> b = shared.lease(16, handler);
+        assert(a && b && shared.available() == 16);
+        assert(a->currentSize() == 32 && a->channels() == 1 && a->bufferSize() == 128);
+
+        assert(!shared.lease(17, handler));
+        assert(handler.errors().size() == 1 && handler.errors()[0].first == AJ::error::Error::EmptyBufferQueue);
+
+        // the leased pool recycles on its own, like any BufferPool.
+        AJ::utils::Buffer *buffer = a->tryPop();
+        assert(buffer && a->push(buffer, handler));
+
+        assert(shared.release(*a, handler) == 32 && a->currentSize() == 0);
+        assert(shared.release(*b, handler) == 16);
+        assert(shared.available() == 64);
+
+        std::cout << "  ✓ Leased 32 + 16 of 64, all given back\n";
+    }
+
+    static void test_many_streams_few_writers() {
+        std::cout << "\nTest: Two writers finish the files of 12 streams\n";
+
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t streams = 12;
+        const size_t frames = 256;
+        const size_t blocks = 40;
+        const std::string sessionDir = std::filesystem::temp_directory_path().string() + "/aj_writer_pool";
+        std::filesystem::create_directories(sessionDir);
+
+        AJ::utils::SharedBufferPool shared(handler, streams * 16, frames, 1);
+        const size_t available = shared.available();   // rounded up to a power of two
+        AJ::io::file_streamer::WriterPool writers(2);
+        assert(writers.workers() == 2);
+
+        AJ::io::file_streamer::WriteOptions options;
+        options.coalesce = true;
+
+        struct Stream {
+            std::shared_ptr<AJ::utils::BufferPool> pool;
+            std::shared_ptr<AJ::utils::Queue> queue;
+            std::shared_ptr<AJ::io::file_streamer::StreamCounters> counters;
+            std::shared_ptr<AJ::io::file_streamer::FileStreamer> streamer;
+        };
+        std::vector<Stream> all(streams);
+
+        for (size_t s = 0; s < streams; ++s) {
+            Stream &stream = all[s];
+            stream.pool = shared.lease(16, handler);
+            stream.queue = std::make_shared<AJ::utils::Queue>(true, 16, frames, 1, handler);
+            stream.counters = std::make_shared<AJ::io::file_streamer::StreamCounters>();
+            stream.streamer = std::make_shared<AJ::io::file_streamer::FileStreamer>(stream.queue, stream.pool,
+                std::make_shared<AJ::LFControlFlag>(), AJ::FileStreamingTypes::recording, sessionDir);
+
+            stream.streamer->setCounters(stream.counters);
+            stream.streamer->setWriteOptions(options);
+            stream.streamer->setFileName("stream_" + std::to_string(s) + ".wav");
+
+            AJ::AudioWriteInfo info;
+            info.channels = 1;
+            info.samplerate = 48000;
+            assert(stream.streamer->setWriteInfo(info, handler));
+            assert(writers.add(stream.streamer, handler));
+        }
+        assert(writers.streams() == streams);
+
+        // one producer for all, like a device callback: a block per stream per round.
+        for (size_t block = 0; block < blocks; ++block) {
+            for (size_t s = 0; s < streams; ++s) {
+                AJ::utils::Buffer *buffer = nullptr;
+                while (!(buffer = all[s].pool->tryPop())) {
+                    std::this_thread::yield();
+                }
+
+                for (size_t i = 0; i < frames; ++i) buffer->data[i] = static_cast<float>(s) / streams;
+                buffer->frames = frames;
+
+                assert(all[s].queue->push(buffer));
+            }
+        }
+
+        std::vector<std::future<bool>> done;
+        for (Stream &stream : all) done.push_back(writers.remove(stream.streamer));
+        for (std::future<bool> &file : done) assert(file.get());
+        assert(writers.streams() == 0);
+
+        for (size_t s = 0; s < streams; ++s) {
+            assert(all[s].counters->snapshot().written == blocks);
+            assert(all[s].pool->currentSize() == 16);
+
+            const std::string path = all[s].streamer->writePath();
+            assert(path.find("stream_" + std::to_string(s) + ".wav") != std::string::npos);
+            assert(std::filesystem::file_size(path) == AJ::kStreamWriteAlignment + blocks * frames * sizeof(float));
+
+            shared.release(*all[s].pool, handler);
+            std::filesystem::remove(path);
+        }
+        assert(shared.available() == available);
+        assert(!handler.hasErrors());
+
+        std::cout << "  ✓ " << streams << " files of " << blocks * frames << " frames\n";
+    }
+
+    static void test_remove_unknown() {
+        std::cout << "\nTest: Removing a stream the pool doesn't serve\n";
+
+        AJ::io::file_streamer::WriterPool writers(1);
+        assert(!writers.remove(nullptr).get());
+
+        std::cout << "  ✓ Returns false right away\n";
+    }
+};
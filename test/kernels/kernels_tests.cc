@@ -0,0 +1,449 @@
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "dsp/kernels.h"
+
+class KernelsTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning SIMD Kernels Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        using AJ::dsp::kernels::ISA;
+
+        std::cout << "Resolved ISA: " << AJ::dsp::kernels::name(AJ::dsp::kernels::table().isa) << "\n";
+
+        for (ISA isa : {ISA::SSE41, ISA::AVX2, ISA::AVX512, ISA::NEON}) {
+            if (!AJ::dsp::kernels::supported(isa)) {
+                std::cout << "Skipping " << AJ::dsp::kernels::name(isa) << ": not supported on this CPU\n";
+                continue;
+            }
+
+            test_kernels_match_scalar(isa);
+        }
+
+        test_tanh_approx_error();
+        test_conversion_values();
+        test_phase_kernels();
+
+        std::cout << "All SIMD Kernels Tests Completed Successfully.\n";
+    }
+
+private:
+    static void test_tanh_approx_error() {
+        using namespace AJ::dsp::kernels;
+
+        std::cout << "\nTest: tanh approximations stay within their error bounds\n";
+
+        float accurate = 0.0f, fast = 0.0f;
+        for (int i = -80000; i <= 80000; ++i) {
+            const float x = i / 10000.0f;
+            accurate = std::max(accurate, std::fabs(tanhApprox(x, TanhApprox::Accurate) - std::tanh(x)));
+            fast = std::max(fast, std::fabs(tanhApprox(x, TanhApprox::Fast) - std::tanh(x)));
+
+            assert(std::fabs(tanhApprox(x, TanhApprox::Accurate)) <= 1.0f + 1e-6f);
+            assert(std::fabs(tanhApprox(x, TanhApprox::Fast)) <= 1.0f + 1e-6f);
+        }
+
+        std::cout << "  Accurate max error: " << accurate << ", Fast max error: " << fast << "\n";
+        assert(accurate < 1e-4f);
+        assert(fast < 2.4e-2f);
+
+        std::cout << "  ✓ Error bounds hold.\n";
+    }
+
+    static void test_phase_kernels() {
+        using namespace AJ::dsp::kernels;
+
+        std::cout << "\nTest: phase kernels follow atan2 / sin / cos\n";
+
+        const KernelTable scalar = tableFor(ISA::Scalar);
+        const float hopPhase = 2.0f * static_cast<float>(M_PI) / 4.0f;
+
+        //* points all around the circle, one bin each.
+        const size_t count = 4096;
+        std::vector<float> re(count), im(count), last(count, 0.0f), mag(count), freq(count);
+        for (size_t i = 0; i < count; ++i) {
+            const double angle = -M_PI + 2.0 * M_PI * i / count;
+            re[i] = static_cast<float>(0.5 * std::cos(angle));
+            im[i] = static_cast<float>(0.5 * std::sin(angle));
+        }
+
+        scalar.phaseAnalyze(re.data(), im.data(), last.data(), mag.data(), freq.data(), 0, count, hopPhase);
+
+        for (size_t i = 1; i < count; ++i) {
+            const double expected = std::atan2(static_cast<double>(im[i]), static_cast<double>(re[i]));
+            assert(std::fabs(last[i] - expected) < 3e-6);
+            assert(std::fabs(mag[i] - 0.5f) < 1e-6f);
+
+            //* the deviation from the bin frequency is within half a turn per hop.
+            assert(std::fabs(freq[i] - static_cast<float>(i)) <= 2.0f + 1e-3f);
+        }
+
+        //* resynthesizing the measured frequencies from a zero phase lands on the analysed phase.
+        std::vector<float> sum(count, 0.0f), outRe(count), outIm(count);
+        scalar.phaseSynthesize(mag.data(), freq.data(), sum.data(), outRe.data(), outIm.data(), count, hopPhase);
+
+        for (size_t i = 1; i < count; ++i) {
+            assert(std::fabs(sum[i]) <= static_cast<float>(M_PI) + 1e-6f);
+            assert(std::fabs(outRe[i] - re[i]) < 2e-3f && std::fabs(outIm[i] - im[i]) < 2e-3f);
+        }
+
+        std::cout << "  ✓ Phases, magnitudes and resynthesis hold.\n";
+    }
+
+    static void test_conversion_values() {
+        using namespace AJ::dsp::kernels;
+
+        std::cout << "\nTest: int conversions scale, round and clip\n";
+
+        const KernelTable scalar = tableFor(ISA::Scalar);
+
+        const std::vector<float> in = {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.5f, 0.25f};
+        std::vector<int16_t> pcm(in.size());
+        scalar.toInt16(in.data(), pcm.data(), in.size(), nullptr);
+        assert((pcm == std::vector<int16_t>{0, 32767, -32767, 32767, -32768, 16384, 8192}));
+
+        std::vector<int32_t> pcm32(in.size());
+        scalar.toInt32(in.data(), pcm32.data(), in.size(), 2147483647.0f, nullptr);
+        assert(pcm32[1] == 2147483520 && pcm32[3] == 2147483520 && pcm32[4] == -2147483647 - 1);
+
+        scalar.toInt32(in.data(), pcm32.data(), in.size(), 8388607.0f, nullptr);
+        assert(pcm32[1] == 8388607 && pcm32[4] == -8388608);
+
+        std::vector<float> out(in.size());
+        scalar.fromInt16(pcm.data(), out.data(), pcm.size());
+        assert(out[4] == -1.0f && out[5] == 0.5f);
+
+        //* half: exact for halves, ties to even, overflow to inf, subnormals and NaN kept.
+        const std::vector<float> wide = {0.0f, -0.0f, 1.0f, -2.0f, 65504.0f, 65520.0f, 1.0f + 1.0f / 2048.0f,
+            5.9604645e-8f, 6.1035156e-5f, INFINITY, NAN};
+        std::vector<uint16_t> half(wide.size());
+        scalar.toHalf(wide.data(), half.data(), wide.size());
+        assert((half == std::vector<uint16_t>{0x0000, 0x8000, 0x3c00, 0xc000, 0x7bff, 0x7c00, 0x3c00,
+            0x0001, 0x0400, 0x7c00, 0x7e00}));
+
+        std::vector<float> narrow(half.size());
+        scalar.fromHalf(half.data(), narrow.data(), half.size());
+        assert(narrow[2] == 1.0f && narrow[4] == 65504.0f && narrow[7] == 5.9604645e-8f);
+        assert(std::isinf(narrow[5]) && std::isnan(narrow[10]) && std::signbit(narrow[1]));
+
+        //* TPDF: in [-1, 1), mean ~0, more values near 0 than near the edges.
+        std::vector<float> noise(100000);
+        uint32_t state = 1;
+        ditherTPDF(noise.data(), noise.size(), state);
+
+        double mean = 0.0;
+        size_t center = 0, edges = 0;
+        for (float n : noise) {
+            assert(n >= -1.0f && n < 1.0f);
+            mean += n;
+            center += std::fabs(n) < 0.25f;
+            edges += std::fabs(n) > 0.75f;
+        }
+        assert(std::fabs(mean / noise.size()) < 0.01);
+        assert(center > 5 * edges);
+
+        std::cout << "  ✓ Values and dither distribution hold.\n";
+    }
+
+    static std::vector<float> signal(size_t count, float amplitude, float freq) {
+        std::vector<float> out(count);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = amplitude * std::sin(freq * i);
+        }
+        return out;
+    }
+
+    static void assert_close(const std::vector<float> &a, const std::vector<float> &b) {
+        assert(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            assert(std::fabs(a[i] - b[i]) < 1e-5f);
+        }
+    }
+
+    //* phases equal up to a turn (±π may come out on either side).
+    static void assert_phase_close(const std::vector<float> &a, const std::vector<float> &b) {
+        assert(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            const double d = std::remainder(static_cast<double>(a[i]) - b[i], 2.0 * M_PI);
+            assert(std::fabs(d) < 1e-3);
+        }
+    }
+
+    static void test_kernels_match_scalar(AJ::dsp::kernels::ISA isa) {
+        using namespace AJ::dsp::kernels;
+
+        std::cout << "\nTest: " << name(isa) << " kernels match the scalar kernels\n";
+
+        const KernelTable scalar = tableFor(ISA::Scalar);
+        const KernelTable simd = tableFor(isa);
+        assert(simd.isa == isa);
+
+        //* odd sizes so every kernel also runs its tail.
+        for (size_t count : {1, 7, 15, 33, 1001}) {
+            std::vector<float> in = signal(count, 0.9f, 0.05f);
+            std::vector<float> delayed = signal(count, 0.7f, 0.011f);
+
+            std::vector<float> a = in, b = in;
+            scalar.gain(a.data(), count, 1.7f);
+            simd.gain(b.data(), count, 1.7f);
+            assert_close(a, b);
+
+            a = in; b = in;
+            scalar.scale(a.data(), count, 1.3f);
+            simd.scale(b.data(), count, 1.3f);
+            assert_close(a, b);
+
+            a = in; b = in;
+            scalar.fade(a.data(), count, 1.0, -1.0 / count);
+            simd.fade(b.data(), count, 1.0, -1.0 / count);
+            assert_close(a, b);
+
+            a.assign(count, 0.0f); b.assign(count, 0.0f);
+            scalar.echo(in.data(), delayed.data(), a.data(), count, 0.6f);
+            simd.echo(in.data(), delayed.data(), b.data(), count, 0.6f);
+            assert_close(a, b);
+
+            //* in place, as the multi-tap echo uses it.
+            a = in; b = in;
+            scalar.mulAdd(a.data(), delayed.data(), a.data(), count, -1.4f);
+            simd.mulAdd(b.data(), delayed.data(), b.data(), count, -1.4f);
+            assert_close(a, b);
+
+            //* every curve, both tanh approximations, asymmetric drive, inputs out of [-1, 1] too.
+            for (Curve curve : {Curve::Tanh, Curve::HardClip, Curve::Cubic}) {
+                for (TanhApprox approx : {TanhApprox::Accurate, TanhApprox::Fast}) {
+                    ShapeParams shape;
+                    shape.curve = curve;
+                    shape.approx = approx;
+                    shape.drive = 3.0f;
+                    shape.driveNeg = 6.0f;
+                    shape.makeup = 1.0f / tanhApprox(3.0f, approx);
+                    shape.makeupNeg = 1.0f / tanhApprox(6.0f, approx);
+
+                    std::vector<float> loud = signal(count, 1.5f, 0.05f);
+                    a = loud; b = loud;
+                    scalar.shape(a.data(), count, shape);
+                    simd.shape(b.data(), count, shape);
+                    assert_close(a, b);
+                }
+            }
+
+            //* acc += a * b, (in, delayed) and (delayed, in) as the complex operands.
+            std::vector<float> reA(count, 0.2f), imA(count, -0.3f), reB = reA, imB = imA;
+            scalar.complexMulAdd(in.data(), delayed.data(), delayed.data(), in.data(), reA.data(), imA.data(), count);
+            simd.complexMulAdd(in.data(), delayed.data(), delayed.data(), in.data(), reB.data(), imB.data(), count);
+            assert_close(reA, reB);
+            assert_close(imA, imB);
+
+            //* butterflies on (in, delayed) with (delayed, in) as twiddles.
+            std::vector<float> xrA = in, xiA = delayed, yrA = delayed, yiA = in;
+            std::vector<float> xrB = xrA, xiB = xiA, yrB = yrA, yiB = yiA;
+            scalar.butterfly(xrA.data(), xiA.data(), yrA.data(), yiA.data(), delayed.data(), in.data(), count);
+            simd.butterfly(xrB.data(), xiB.data(), yrB.data(), yiB.data(), delayed.data(), in.data(), count);
+            assert_close(xrA, xrB);
+            assert_close(xiA, xiB);
+            assert_close(yrA, yrB);
+            assert_close(yiA, yiB);
+
+            //* phase vocoder: (in, delayed) as the spectrum, bins numbered from 3.
+            const float hopPhase = 2.0f * static_cast<float>(M_PI) / 4.0f;
+            std::vector<float> lastA = signal(count, 3.0f, 0.02f), lastB = lastA;
+            std::vector<float> magA(count), magB(count), freqA(count), freqB(count);
+            scalar.phaseAnalyze(in.data(), delayed.data(), lastA.data(), magA.data(), freqA.data(), 3, count, hopPhase);
+            simd.phaseAnalyze(in.data(), delayed.data(), lastB.data(), magB.data(), freqB.data(), 3, count, hopPhase);
+            assert_close(magA, magB);
+            assert_phase_close(lastA, lastB);
+            for (size_t i = 0; i < count; ++i) {
+                assert(std::fabs(freqA[i] - freqB[i]) < 1e-3f);
+            }
+
+            std::vector<float> sumA = signal(count, 3.0f, 0.07f), sumB = sumA;
+            std::vector<float> outReA(count), outImA(count), outReB(count), outImB(count);
+            scalar.phaseSynthesize(magA.data(), freqA.data(), sumA.data(), outReA.data(), outImA.data(), count, hopPhase);
+            simd.phaseSynthesize(magA.data(), freqA.data(), sumB.data(), outReB.data(), outImB.data(), count, hopPhase);
+            assert_phase_close(sumA, sumB);
+            for (size_t i = 0; i < count; ++i) {
+                assert(std::fabs(outReA[i] - outReB[i]) < 1e-3f && std::fabs(outImA[i] - outImB[i]) < 1e-3f);
+            }
+
+            //* windows of `in` against the start of `delayed`, every lag count from 1 to count / 2 + 1.
+            const size_t lags = count / 2 + 1, length = count - lags + 1;
+            std::vector<float> corrA(lags), corrB(lags);
+            scalar.crossCorrelate(in.data(), delayed.data(), corrA.data(), lags, length);
+            simd.crossCorrelate(in.data(), delayed.data(), corrB.data(), lags, length);
+            for (size_t i = 0; i < lags; ++i) {
+                assert(std::fabs(corrA[i] - corrB[i]) < 1e-5f * (1.0f + std::fabs(corrA[i])));
+            }
+
+            //* 3 phases of count / 4 + 1 taps, 5 / 3 input samples per output, from phase 1.
+            const size_t taps = count / 4 + 1, outputs = (count - taps) * 3 / 5;
+            std::vector<float> bank(3 * taps);
+            for (size_t i = 0; i < bank.size(); ++i) bank[i] = std::sin(0.37f * i) / taps;
+            std::vector<float> polyA(outputs + 1), polyB(outputs + 1);
+            scalar.polyphase(in.data(), bank.data(), taps, 3, 5, 1, polyA.data(), outputs);
+            simd.polyphase(in.data(), bank.data(), taps, 3, 5, 1, polyB.data(), outputs);
+            for (size_t i = 0; i < outputs; ++i) {
+                assert(std::fabs(polyA[i] - polyB[i]) < 1e-5f * (1.0f + std::fabs(polyA[i])));
+            }
+
+            //* cascades of 1 to kBiquadLanes / channels stages, identity stages above the used lanes.
+            for (size_t channels : {1, 2}) {
+                for (size_t lanes = channels; lanes <= AJ::dsp::kernels::kBiquadLanes; lanes += 3 * channels) {
+                    std::vector<float> coeffs(5 * AJ::dsp::kernels::kBiquadLanes, 0.0f);
+                    std::vector<float> stateA(2 * AJ::dsp::kernels::kBiquadLanes, 0.0f);
+                    for (size_t j = 0; j < AJ::dsp::kernels::kBiquadLanes; ++j) {
+                        coeffs[j] = 1.0f;
+                        if (j >= lanes) continue;
+                        //* poles at radius 0.9 keep every stage stable.
+                        const float angle = 0.3f + 0.17f * (j / channels);
+                        coeffs[j] = 0.5f + 0.05f * j;
+                        coeffs[AJ::dsp::kernels::kBiquadLanes + j] = std::sin(1.3f * j) * 0.4f;
+                        coeffs[2 * AJ::dsp::kernels::kBiquadLanes + j] = 0.2f - 0.03f * j;
+                        coeffs[3 * AJ::dsp::kernels::kBiquadLanes + j] = -1.8f * std::cos(angle);
+                        coeffs[4 * AJ::dsp::kernels::kBiquadLanes + j] = 0.81f;
+                        stateA[j] = 0.01f * j;
+                    }
+                    std::vector<float> stateB = stateA;
+
+                    const size_t frames = count / channels;
+                    std::vector<float> dataA(in.begin(), in.begin() + frames * channels), dataB = dataA;
+                    scalar.biquad(dataA.data(), frames, channels, lanes, coeffs.data(), stateA.data());
+                    simd.biquad(dataB.data(), frames, channels, lanes, coeffs.data(), stateB.data());
+
+                    //* resonant cascades amplify the rounding differences (FMA): compare against the peak.
+                    float peak = 1.0f;
+                    for (float v : dataA) peak = std::max(peak, std::fabs(v));
+                    for (float v : stateA) peak = std::max(peak, std::fabs(v));
+                    for (size_t i = 0; i < dataA.size(); ++i) assert(std::fabs(dataA[i] - dataB[i]) < 1e-4f * peak);
+                    for (size_t i = 0; i < stateA.size(); ++i) assert(std::fabs(stateA[i] - stateB[i]) < 1e-4f * peak);
+                }
+            }
+
+            for (size_t channels : {1, 2, 3}) {
+                const size_t frames = count / channels;
+                std::vector<float> peaksA(frames), peaksB(frames);
+                scalar.framePeak(in.data(), frames, channels, peaksA.data());
+                simd.framePeak(in.data(), frames, channels, peaksB.data());
+                assert(peaksA == peaksB);
+
+                a.assign(in.begin(), in.begin() + frames * channels); b = a;
+                scalar.frameGain(a.data(), frames, channels, delayed.data());
+                simd.frameGain(b.data(), frames, channels, delayed.data());
+                assert(a == b);
+
+                //* the two halves of a range swapped, the middle frame of an odd count stays.
+                a.assign(in.begin(), in.begin() + frames * channels); b = a;
+                const size_t pairs = frames / 2, back = (frames - pairs) * channels;
+                scalar.reverse(a.data(), a.data() + back, pairs, channels);
+                simd.reverse(b.data(), b.data() + back, pairs, channels);
+                assert(a == b);
+                for (size_t f = 0; f < frames; ++f) {
+                    for (size_t ch = 0; ch < channels; ++ch) {
+                        assert(b[f * channels + ch] == in[(frames - 1 - f) * channels + ch]);
+                    }
+                }
+            }
+
+            std::vector<float> lineA = delayed, lineB = delayed;
+            std::vector<float> accA(count, 0.1f), accB(count, 0.1f);
+            scalar.comb(lineA.data(), 0.45f, in.data(), accA.data(), count);
+            simd.comb(lineB.data(), 0.45f, in.data(), accB.data(), count);
+            assert_close(lineA, lineB);
+            assert_close(accA, accB);
+
+            //* same min / max, sum of squares only differs by the order of the double additions.
+            const Levels levelsA = scalar.analyze(in.data(), count);
+            const Levels levelsB = simd.analyze(in.data(), count);
+            assert(levelsA.min == levelsB.min && levelsA.max == levelsB.max);
+            assert(std::fabs(levelsA.sumSquares - levelsB.sumSquares) <= 1e-9 * levelsA.sumSquares);
+
+            //* interleave / deinterleave only move samples: exact.
+            std::vector<float> frames(2 * count), framesB(2 * count);
+            scalar.interleave(in.data(), delayed.data(), frames.data(), count);
+            simd.interleave(in.data(), delayed.data(), framesB.data(), count);
+            assert(frames == framesB);
+
+            std::vector<float> left(count), right(count);
+            simd.deinterleave(frames.data(), left.data(), right.data(), count);
+            assert(left == in && right == delayed);
+
+            //* stereo accumulate with a gain per side, over (in, delayed) interleaved.
+            std::vector<float> mixA(2 * count, 0.25f), mixB = mixA;
+            scalar.mixAdd(frames.data(), mixA.data(), count, 0.8f, -0.35f);
+            simd.mixAdd(frames.data(), mixB.data(), count, 0.8f, -0.35f);
+            assert_close(mixA, mixB);
+
+            //* threshold scans: a loud sample in a vector, in the tail, or none at all.
+            for (float threshold : {0.0f, 0.5f, 0.899f, 2.0f}) {
+                assert(scalar.findAbove(in.data(), count, threshold) == simd.findAbove(in.data(), count, threshold));
+                assert(scalar.findLastAbove(in.data(), count, threshold) == simd.findLastAbove(in.data(), count, threshold));
+            }
+            for (size_t spike = 0; spike < count; spike += 37) {
+                std::vector<float> quiet = signal(count, 0.01f, 0.3f);
+                quiet[spike] = -0.5f;
+                assert(simd.findAbove(quiet.data(), count, 0.1f) == spike);
+                assert(simd.findLastAbove(quiet.data(), count, 0.1f) == spike + 1);
+            }
+
+            //* glides drift apart by float rounding only, over a thousand steps.
+            for (float target : {0.0f, 1.0f}) {
+                a.assign(count, 0.0f); b.assign(count, 0.0f);
+                scalar.glide(a.data(), count, 1.0f - target, target, 0.997f);
+                simd.glide(b.data(), count, 1.0f - target, target, 0.997f);
+                for (size_t i = 0; i < count; ++i) assert(std::fabs(a[i] - b[i]) < 1e-4f);
+            }
+
+            //* conversions: same rounding, clipped out of range, with and without dither.
+            std::vector<float> loud = signal(count, 1.2f, 0.03f);
+            std::vector<float> noise(count);
+            uint32_t state = 12345;
+            ditherTPDF(noise.data(), count, state);
+
+            for (const float *dither : {static_cast<const float*>(nullptr), static_cast<const float*>(noise.data())}) {
+                std::vector<int16_t> pcmA(count), pcmB(count);
+                scalar.toInt16(loud.data(), pcmA.data(), count, dither);
+                simd.toInt16(loud.data(), pcmB.data(), count, dither);
+                assert(pcmA == pcmB);
+
+                for (float scale : {8388607.0f, 2147483647.0f}) {
+                    std::vector<int32_t> intA(count), intB(count);
+                    scalar.toInt32(loud.data(), intA.data(), count, scale, dither);
+                    simd.toInt32(loud.data(), intB.data(), count, scale, dither);
+                    assert(intA == intB);
+
+                    a.assign(count, 0.0f); b.assign(count, 0.0f);
+                    scalar.fromInt32(intA.data(), a.data(), count, 1.0f / (scale + 1.0f));
+                    simd.fromInt32(intA.data(), b.data(), count, 1.0f / (scale + 1.0f));
+                    assert(a == b);
+                }
+
+                a.assign(count, 0.0f); b.assign(count, 0.0f);
+                scalar.fromInt16(pcmA.data(), a.data(), count);
+                simd.fromInt16(pcmA.data(), b.data(), count);
+                assert(a == b);
+            }
+
+            //* half conversions round the same way (quiet samples go subnormal).
+            std::vector<float> quiet = signal(count, 1e-5f, 0.07f);
+            for (const std::vector<float> *samples : {&loud, &quiet}) {
+                std::vector<uint16_t> halfA(count), halfB(count);
+                scalar.toHalf(samples->data(), halfA.data(), count);
+                simd.toHalf(samples->data(), halfB.data(), count);
+                assert(halfA == halfB);
+
+                a.assign(count, 0.0f); b.assign(count, 0.0f);
+                scalar.fromHalf(halfA.data(), a.data(), count);
+                simd.fromHalf(halfA.data(), b.data(), count);
+                assert(a == b);
+            }
+        }
+
+        std::cout << "  ✓ gain, scale, fade, echo, mulAdd, complexMulAdd, butterfly, phase, crossCorrelate, polyphase, biquad, framePeak, frameGain, reverse, mixAdd, findAbove, glide, comb, shape, analyze, interleave, int and half conversion kernels match.\n";
+    }
+};
@@ -0,0 +1,197 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "dsp/loudness/loudness.h"
+#include "dsp/normalization.h"
+#include "core/error_handler.h"
+#include "core/thread_pool.h"
+
+class LoudnessTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Loudness Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_reference_tones();
+        test_gating();
+        test_true_peak();
+        test_pool_matches_serial();
+        test_lufs_normalization();
+
+        std::cout << "All Loudness Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::Float make_tone(size_t frames, double hz, double amplitude, double rate = 48000.0, double phase = 0.0) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = static_cast<float>(amplitude * std::sin(2.0 * M_PI * hz * i / rate + phase));
+        }
+        return signal;
+    }
+
+    static AJ::dsp::loudness::Measurement measure(const std::vector<const AJ::Float*> &channels, uint32_t rate = 48000,
+        AJ::utils::ThreadPool *pool = nullptr) {
+        std::vector<const float*> data;
+        for (const AJ::Float *channel : channels) data.push_back(channel->data());
+
+        AJ::dsp::loudness::Measurement measurement;
+        assert(AJ::dsp::loudness::measure(data.data(), data.size(), channels[0]->size(), rate, measurement, pool));
+        return measurement;
+    }
+
+    static void test_reference_tones() {
+        std::cout << "\nTest: 1 kHz tones measure as in EBU Tech 3341\n";
+
+        //* -23 dBFS in both channels is -23 LUFS, at any samplerate.
+        for (uint32_t rate : { 44100u, 48000u, 96000u }) {
+            const AJ::Float tone = make_tone(20 * rate, 1000.0, std::pow(10.0, -23.0 / 20.0), rate);
+            const auto stereo = measure({ &tone, &tone }, rate);
+            assert(std::fabs(stereo.mIntegrated + 23.0) < 0.1);
+
+            //* one channel alone is 3 dB quieter.
+            const auto mono = measure({ &tone }, rate);
+            assert(std::fabs(mono.mIntegrated - stereo.mIntegrated + 10.0 * std::log10(2.0)) < 1e-3);
+        }
+
+        //* the K-weighting favours the presence range over the low end.
+        const AJ::Float low = make_tone(10 * 48000, 40.0, 0.1);
+        const AJ::Float high = make_tone(10 * 48000, 4000.0, 0.1);
+        assert(measure({ &high }).mIntegrated > measure({ &low }).mIntegrated + 3.0);
+
+        std::cout << "  ✓ -23 dBFS stereo is -23 LUFS at 44.1, 48 and 96 kHz\n";
+    }
+
+    static void test_gating() {
+        std::cout << "\nTest: Silence and quiet passages are gated out\n";
+
+        const size_t rate = 48000;
+        const AJ::Float loud = make_tone(10 * rate, 1000.0, 0.1);
+        const double reference = measure({ &loud }).mIntegrated;
+
+        //* half silence: the absolute gate drops it, only the 3 blocks over the edge lower the loudness a little.
+        AJ::Float gapped = loud;
+        gapped.resize(20 * rate, 0.0f);
+        assert(std::fabs(measure({ &gapped }).mIntegrated - reference) < 0.1);
+
+        //* a passage 30 dB down is under the relative gate.
+        AJ::Float quiet = loud;
+        const AJ::Float soft = make_tone(10 * rate, 1000.0, 0.1 * std::pow(10.0, -30.0 / 20.0));
+        quiet.insert(quiet.end(), soft.begin(), soft.end());
+        assert(std::fabs(measure({ &quiet }).mIntegrated - reference) < 0.1);
+
+        //* silence and anything shorter than one block have no loudness.
+        const AJ::Float silence(5 * rate, 0.0f);
+        assert(!measure({ &silence }).audible());
+        const AJ::Float short_tone = make_tone(rate / 4, 1000.0, 0.5);
+        assert(!measure({ &short_tone }).audible());
+        assert(measure({ &short_tone }).mTruePeak > 0.49f);
+
+        std::cout << "  ✓ Absolute and relative gates\n";
+    }
+
+    static void test_true_peak() {
+        std::cout << "\nTest: The true peak finds the peaks between samples\n";
+
+        //* fs / 4 at 45°: every sample is at 0.707 of the amplitude, the waveform reaches it in between.
+        const AJ::Float tone = make_tone(48000, 12000.0, 0.5, 48000.0, M_PI / 4.0);
+        float sample_peak = 0.0f;
+        for (float x : tone) sample_peak = std::max(sample_peak, std::fabs(x));
+        assert(std::fabs(sample_peak - 0.5f * std::sqrt(0.5f)) < 1e-4f);
+
+        const float true_peak = measure({ &tone }).mTruePeak;
+        assert(true_peak > 0.48f && true_peak < 0.52f);
+
+        //* a full scale low tone: the true peak is the sample peak.
+        const AJ::Float low = make_tone(48000, 100.0, 0.9);
+        assert(std::fabs(measure({ &low }).mTruePeak - 0.9f) < 0.01f);
+
+        std::cout << "  ✓ Sample peak " << sample_peak << ", true peak " << true_peak << "\n";
+    }
+
+    static void test_pool_matches_serial() {
+        std::cout << "\nTest: Measured on a thread pool, the result is the same\n";
+
+        const size_t frames = 95 * 44100 + 777;
+        AJ::Float left(frames), right(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            const float envelope = 0.2f + 0.8f * std::fabs(std::sin(0.00001f * i));
+            left[i] = envelope * (0.3f * std::sin(0.05f * i) + 0.1f * std::sin(0.71f * i));
+            right[i] = envelope * 0.4f * std::sin(0.013f * i);
+        }
+
+        const auto serial = measure({ &left, &right }, 44100);
+        AJ::utils::ThreadPool pool(4);
+        const auto pooled = measure({ &left, &right }, 44100, &pool);
+
+        assert(serial.mIntegrated == pooled.mIntegrated);
+        assert(serial.mTruePeak == pooled.mTruePeak);
+
+        std::cout << "  ✓ " << serial.mIntegrated << " LUFS either way\n";
+    }
+
+    static void test_lufs_normalization() {
+        std::cout << "\nTest: LUFS normalization reaches the target under the true peak ceiling\n";
+        using namespace AJ::dsp::normalization;
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t rate = 48000;
+        AJ::Float signal(12 * rate);
+        for (size_t i = 0; i < signal.size(); ++i) {
+            signal[i] = 0.25f * std::sin(0.06f * i) + 0.1f * std::sin(0.3f * i);
+        }
+
+        auto normalize = [&](float target, AJ::Float buffer) {
+            Params params;
+            params.mStart = 0;
+            params.mEnd = buffer.size() - 1;
+            params.mMode = NormalizationMode::LUFS;
+            params.mTarget = target;
+            params.mSamplerate = rate;
+
+            Normalization normalization(NormalizationParams::create(params, handler), handler);
+            assert(normalization.process(buffer, handler));
+            return buffer;
+        };
+
+        //* a plain gain: the loudness lands on the target.
+        const AJ::Float quiet = normalize(-23.0f, signal);
+        assert(std::fabs(measure({ &quiet }).mIntegrated + 23.0) < 0.01);
+
+        //* too loud for the ceiling: the limiter holds the peaks, the loudness only misses by what it takes off.
+        const AJ::Float loud = normalize(-5.0f, signal);
+        const auto measured = measure({ &loud });
+        const float ceiling = std::pow(10.0f, AJ::kNormalizationCeilingDb / 20.0f);
+        for (float x : loud) assert(std::fabs(x) <= ceiling * (1.0f + 1e-6f));
+        assert(measured.mIntegrated < -5.0 && measured.mIntegrated > -7.0);
+
+        //* a file measured beforehand: the buffer isn't measured again.
+        Params params;
+        params.mStart = 0;
+        params.mEnd = signal.size() - 1;
+        params.mMode = NormalizationMode::LUFS;
+        params.mTarget = -20.0f;
+        params.mSamplerate = rate;
+        auto preset = NormalizationParams::create(params, handler);
+        assert(preset->Target() == -20.0f);
+
+        AJ::dsp::loudness::Measurement file = measure({ &signal });
+        file.mIntegrated += 6.0;
+        preset->setLoudness(file);
+
+        AJ::Float buffer = signal;
+        Normalization normalization(preset, handler);
+        assert(normalization.process(buffer, handler));
+        assert(std::fabs(measure({ &buffer }).mIntegrated + 26.0) < 0.01);
+
+        //* silence is left alone.
+        AJ::Float silence(rate, 0.0f);
+        assert(normalize(-23.0f, silence) == silence);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ -23 LUFS exact, -5 LUFS limited to " << measured.mIntegrated << " LUFS\n";
+    }
+};
@@ -3,8 +3,10 @@
 #include <cassert>
 #include <filesystem>
 #include <cmath>
+#include <vector>
 
 #include "dsp/normalization.h"
+#include "core/thread_pool.h"
 #include "file_io/wav_file.h"
 #include "core/error_handler.h"
 
@@ -34,6 +36,14 @@ public:
         // Invalid range test
         test_normalization_invalid_range("long_audio.wav", 2);
 
+        // Synthetic: single pass vs thread pool split
+        test_normalization_thread_pool(AJ::dsp::normalization::NormalizationMode::Peak, 0.8f);
+        test_normalization_thread_pool(AJ::dsp::normalization::NormalizationMode::RMS, 0.3f);
+        test_normalization_thread_pool(AJ::dsp::normalization::NormalizationMode::RMS, 0.55f);
+
+        // Synthetic: both channels of a stereo buffer in one call
+        test_normalization_linked_channels();
+
         std::cout << "All Normalization Tests Completed Successfully.\n";
     }
 
@@ -161,4 +171,144 @@ private:
         std::cout << "Handled invalid range without crashing.\n";
         std::cout << "--------------------------------------------------\n";
     }
+
+    static void test_normalization_thread_pool(AJ::dsp::normalization::NormalizationMode norm_mode,
+                                               float target) {
+        using namespace AJ;
+        using namespace AJ::dsp::normalization;
+
+        std::cout << "\nTest: Normalization (" 
+                  << (norm_mode == NormalizationMode::Peak ? "Peak" : "RMS")
+                  << ") with a thread pool, synthetic signal\n";
+
+        error::ConsoleErrorHandler errorHandler;
+
+        //* long enough to be split in several chunks (not a multiple of the chunk size).
+        const size_t length = 5 * kParallelChunkFrames + 123;
+        Float signal(length);
+        for (size_t i = 0; i < length; ++i) {
+            signal[i] = 0.4f * std::sin(0.001f * i) + 0.1f * std::sin(0.37f * i);
+        }
+
+        Params normParams;
+        normParams.mStart = 17;
+        normParams.mEnd = length - 11;
+        normParams.mTarget = target;
+        normParams.mMode = norm_mode;
+
+        Float serial = signal, parallel = signal;
+
+        auto params = NormalizationParams::create(normParams, errorHandler);
+        assert(params);
+        Normalization normalization(params, errorHandler);
+        assert(normalization.process(serial, errorHandler));
+
+        auto pool = std::make_shared<utils::ThreadPool>(4);
+        params = NormalizationParams::create(normParams, errorHandler);
+        Normalization pooled(params, errorHandler);
+        pooled.setThreadPool(pool);
+        assert(pooled.process(parallel, errorHandler));
+
+        //* combined in chunk order: same gain up to the double rounding of the partial sums.
+        double peak = 0.0, sum = 0.0;
+        for (size_t i = 0; i < length; ++i) {
+            assert(std::fabs(serial[i] - parallel[i]) < 1e-6f);
+            if (i < (size_t)normParams.mStart || i > (size_t)normParams.mEnd) {
+                assert(serial[i] == signal[i]);
+                continue;
+            }
+            peak = std::max(peak, (double)std::fabs(serial[i]));
+            sum += (double)serial[i] * serial[i];
+        }
+
+        const double rms = std::sqrt(sum / (normParams.mEnd - normParams.mStart + 1));
+        if (norm_mode == NormalizationMode::Peak) {
+            assert(std::fabs(peak - target) < 1e-5);
+        } else {
+            //* the limiter keeps the peaks under the ceiling and only takes a little level off the loudest parts.
+            assert(peak <= std::pow(10.0, kNormalizationCeilingDb / 20.0) + 1e-5);
+            assert(rms < 1.01 * target && rms > 0.9 * target);
+        }
+
+        std::cout << "  ✓ peak " << peak << ", rms " << rms << ", pooled result matches.\n";
+        std::cout << "--------------------------------------------------\n";
+    }
+
+    static void test_normalization_linked_channels() {
+        using namespace AJ;
+        using namespace AJ::dsp::normalization;
+
+        std::cout << "\nTest: Normalization of a stereo buffer, linked channels\n";
+
+        error::ConsoleErrorHandler errorHandler;
+
+        //* the left channel is twice as loud as the right one.
+        const size_t length = 3 * kParallelChunkFrames + 41;
+        AudioBuffer audio;
+        audio[0].resize(length);
+        audio[1].resize(length);
+        for (size_t i = 0; i < length; ++i) {
+            audio[0][i] = 0.4f * std::sin(0.002f * i) + 0.05f * std::sin(0.5f * i);
+            audio[1][i] = 0.5f * audio[0][i];
+        }
+
+        auto normalize = [&](NormalizationMode mode, float target, AudioBuffer buffer, size_t channels,
+            std::shared_ptr<utils::ThreadPool> pool = nullptr) {
+            Params normParams;
+            normParams.mStart = 5;
+            normParams.mEnd = length - 7;
+            normParams.mTarget = target;
+            normParams.mMode = mode;
+
+            Normalization normalization(NormalizationParams::create(normParams, errorHandler), errorHandler);
+            normalization.setThreadPool(pool);
+            assert(normalization.linksChannels());
+            assert(normalization.process(buffer, channels, errorHandler));
+            return buffer;
+        };
+
+        //* Peak: the loudest channel reaches the target, the balance is kept.
+        const AudioBuffer peak = normalize(NormalizationMode::Peak, 0.9f, audio, 2);
+        float left = 0.0f, right = 0.0f;
+        for (size_t i = 5; i <= length - 7; ++i) {
+            left = std::max(left, std::fabs(peak[0][i]));
+            right = std::max(right, std::fabs(peak[1][i]));
+            assert(std::fabs(peak[1][i] - 0.5f * peak[0][i]) < 1e-6f);
+        }
+        assert(std::fabs(left - 0.9f) < 1e-5f && std::fabs(right - 0.45f) < 1e-5f);
+        assert(peak[0][0] == audio[0][0] && peak[1][length - 1] == audio[1][length - 1]);
+
+        //* RMS over the samples of both channels, pooled or not.
+        const AudioBuffer rms = normalize(NormalizationMode::RMS, 0.2f, audio, 2);
+        const AudioBuffer pooled = normalize(NormalizationMode::RMS, 0.2f, audio, 2,
+            std::make_shared<utils::ThreadPool>(4));
+        double sum = 0.0;
+        for (size_t i = 5; i <= length - 7; ++i) {
+            sum += (double)rms[0][i] * rms[0][i] + (double)rms[1][i] * rms[1][i];
+            assert(std::fabs(rms[0][i] - pooled[0][i]) < 1e-6f && std::fabs(rms[1][i] - pooled[1][i]) < 1e-6f);
+        }
+        assert(std::fabs(std::sqrt(sum / (2 * (length - 11))) - 0.2) < 1e-4);
+
+        //* one channel in the AudioBuffer call is the single buffer call.
+        Float mono = audio[0];
+        Params normParams;
+        normParams.mStart = 5;
+        normParams.mEnd = length - 7;
+        normParams.mTarget = 0.9f;
+        Normalization normalization(NormalizationParams::create(normParams, errorHandler), errorHandler);
+        assert(normalization.process(mono, errorHandler));
+        assert(normalize(NormalizationMode::Peak, 0.9f, audio, 1)[0] == mono);
+
+        //* a channel shorter than the range is rejected.
+        AudioBuffer uneven = audio;
+        uneven[1].resize(length - 10);
+        error::CollectingErrorHandler collecting;
+        Normalization rejecting(NormalizationParams::create(normParams, collecting), collecting);
+        assert(!rejecting.process(uneven, 2, collecting));
+        assert(!rejecting.process(uneven, 3, collecting));
+        assert(collecting.errors().size() == 2);
+
+        std::cout << "  ✓ peaks " << left << " / " << right << ", shared gain.\n";
+        std::cout << "--------------------------------------------------\n";
+    }
 };
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dsp/pitch/pitch_shift.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+
+class PitchShiftTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Pitch Shift Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_zero_shift_is_identity();
+        test_shift_moves_frequency();
+        test_segments_match_with_pool();
+        test_blocks_lag_buffer();
+        test_invalid_params();
+
+        std::cout << "All Pitch Shift Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::Float make_tone(size_t frames, double hz, double rate = 44100.0) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = static_cast<float>(0.4 * std::sin(2.0 * M_PI * hz * i / rate));
+        }
+        return signal;
+    }
+
+    // power of `hz` in [first, last) (Goertzel).
+    static double power(const AJ::Float &x, size_t first, size_t last, double hz, double rate = 44100.0) {
+        const double coeff = 2.0 * std::cos(2.0 * M_PI * hz / rate);
+        double s1 = 0.0, s2 = 0.0;
+        for (size_t i = first; i < last; ++i) {
+            const double s = x[i] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s;
+        }
+        return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    }
+
+    static std::shared_ptr<AJ::dsp::pitch::PitchParams> make_params(AJ::sample_pos start, AJ::sample_pos end,
+        float semitones, size_t frame, AJ::error::IErrorHandler &handler) {
+        AJ::dsp::pitch::Params params{ start, end, semitones, frame };
+        return AJ::dsp::pitch::PitchParams::create(params, handler);
+    }
+
+    static void test_zero_shift_is_identity() {
+        std::cout << "\nTest: A shift of 0 semitones gives back the input, aligned\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::Float signal = make_tone(20000, 440.0);
+        for (size_t i = 0; i < signal.size(); ++i) {
+            signal[i] += 0.2f * std::sin(0.9f * i) * (i % 3000 < 100 ? 1.0f : 0.1f);
+        }
+
+        AJ::dsp::pitch::PitchShift shift;
+        assert(shift.setParams(make_params(1000, 18999, 0.0f, 1024, handler), handler));
+
+        AJ::Float output = signal;
+        assert(shift.process(output, handler));
+
+        for (size_t i = 0; i < signal.size(); ++i) {
+            assert(std::fabs(output[i] - signal[i]) < 1e-3f);
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Input restored\n";
+    }
+
+    static void test_shift_moves_frequency() {
+        std::cout << "\nTest: +12 / -12 / +7 / -5 semitones move a 440 Hz tone by that interval, same length and level\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 44100;
+        for (float semitones : { 12.0f, -12.0f, 7.0f, -5.0f }) {
+            const double target = 440.0 * std::exp2(semitones / 12.0);
+
+            AJ::Float output = make_tone(frames, 440.0);
+            AJ::dsp::pitch::PitchShift shift;
+            assert(shift.setParams(make_params(0, frames - 1, semitones, 2048, handler), handler));
+            assert(shift.process(output, handler));
+            assert(output.size() == frames);
+
+            const double moved = power(output, 4096, frames - 4096, target);
+            const double original = power(output, 4096, frames - 4096, 440.0);
+            assert(moved > 100.0 * original);
+
+            //* the level is kept (a sine of 0.4 has an RMS of ~0.28).
+            double squares = 0.0;
+            for (size_t i = 4096; i < frames - 4096; ++i) squares += output[i] * output[i];
+            const double rms = std::sqrt(squares / (frames - 8192));
+            assert(rms > 0.24 && rms < 0.32);
+        }
+
+        std::cout << "  ✓ Pitch moved\n";
+    }
+
+    static void test_segments_match_with_pool() {
+        std::cout << "\nTest: Long ranges are segmented the same way with and without a pool\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 3 * AJ::kPitchSegmentFrames + 12345;
+        const AJ::Float signal = make_tone(frames, 523.25);
+
+        auto params = make_params(100, frames - 50, 3.0f, 1024, handler);
+        assert(params);
+
+        AJ::Float sequential = signal, pooled = signal;
+
+        AJ::dsp::pitch::PitchShift shift;
+        assert(shift.setParams(params, handler));
+        assert(shift.process(sequential, handler));
+
+        shift.setThreadPool(std::make_shared<AJ::utils::ThreadPool>(4));
+        assert(shift.process(pooled, handler));
+
+        assert(sequential == pooled);
+        for (size_t i = 0; i < 100; ++i) assert(pooled[i] == signal[i]);
+
+        //* no click at the segment boundaries: a 0 shift crossfades two copies of the input.
+        AJ::Float identity = signal;
+        assert(shift.setParams(make_params(0, frames - 1, 0.0f, 1024, handler), handler));
+        assert(shift.process(identity, handler));
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(identity[i] - signal[i]) < 1e-3f);
+        }
+
+        std::cout << "  ✓ Same output, seamless stitching\n";
+    }
+
+    static void test_blocks_lag_buffer() {
+        std::cout << "\nTest: Streamed blocks equal the buffer output delayed by the latency\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 30000;
+        const AJ::sample_pos start = 2000, end = 25999;
+        const AJ::Float left = make_tone(frames, 300.0), right = make_tone(frames, 1250.0);
+
+        auto params = make_params(start, end, -5.0f, 512, handler);
+        AJ::dsp::pitch::PitchShift shift;
+        assert(shift.setParams(params, handler));
+
+        AJ::Float expectedL = left, expectedR = right;
+        assert(shift.process(expectedL, handler));
+        assert(shift.process(expectedR, handler));
+
+        std::vector<float> interleaved(2 * frames);
+        for (size_t i = 0; i < frames; ++i) {
+            interleaved[2 * i] = left[i];
+            interleaved[2 * i + 1] = right[i];
+        }
+
+        auto state = shift.createState(2, handler);
+        assert(state);
+
+        size_t offset = 0, block = 97;
+        while (offset < frames) {
+            const size_t n = std::min(block, frames - offset);
+            assert(shift.processBlock(interleaved.data() + 2 * offset, n, 2, *state, handler));
+            offset += n;
+            block = block * 7 % 1031 + 1;
+        }
+
+        const size_t latency = params->Latency();
+        for (size_t i = 0; i < frames; ++i) {
+            const AJ::sample_pos n = static_cast<AJ::sample_pos>(i);
+            if (n < start || n > end) {
+                assert(interleaved[2 * i] == left[i] && interleaved[2 * i + 1] == right[i]);
+            } else if (n < start + static_cast<AJ::sample_pos>(latency)) {
+                assert(interleaved[2 * i] == 0.0f && interleaved[2 * i + 1] == 0.0f);
+            } else {
+                assert(std::fabs(interleaved[2 * i] - expectedL[i - latency]) < 1e-5f);
+                assert(std::fabs(interleaved[2 * i + 1] - expectedR[i - latency]) < 1e-5f);
+            }
+        }
+
+        std::cout << "  ✓ Blocks match\n";
+    }
+
+    static void test_invalid_params() {
+        std::cout << "\nTest: Invalid parameters are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        assert(!make_params(10, 5, 2.0f, 1024, handler));
+        assert(!make_params(0, 99, 30.0f, 1024, handler));
+        assert(!make_params(0, 99, NAN, 1024, handler));
+        assert(!make_params(0, 99, 2.0f, 1000, handler));
+        assert(!make_params(0, 99, 2.0f, 128, handler));
+        assert(!make_params(0, 99, 2.0f, 16384, handler));
+        assert(handler.errors().size() == 6);
+
+        AJ::dsp::pitch::PitchShift shift;
+        AJ::Float buffer(50, 0.1f);
+        handler.clear();
+        assert(!shift.process(buffer, handler));
+        assert(shift.setParams(make_params(0, 99, 2.0f, 1024, handler), handler));
+        assert(!shift.process(buffer, handler));
+        assert(handler.errors().size() == 2);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
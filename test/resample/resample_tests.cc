@@ -0,0 +1,205 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dsp/resample/resampler.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+
+class ResampleTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Resample Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_filter_tables();
+        test_tone_keeps_frequency();
+        test_downsampling_removes_aliases();
+        test_streaming_matches_offline();
+        test_segments_match_with_pool();
+        test_invalid_rates();
+
+        std::cout << "All Resample Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::Float make_tone(size_t frames, double hz, double rate, double phase = 0.0) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = static_cast<float>(0.4 * std::sin(2.0 * M_PI * hz * i / rate + phase));
+        }
+        return signal;
+    }
+
+    static double rms(const AJ::Float &x, size_t first, size_t last) {
+        double squares = 0.0;
+        for (size_t i = first; i < last; ++i) squares += static_cast<double>(x[i]) * x[i];
+        return std::sqrt(squares / (last - first));
+    }
+
+    static void test_filter_tables() {
+        std::cout << "\nTest: Filters reduce the ratio, widen when downsampling and are shared\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto up = AJ::dsp::resample::filter(44100, 48000, handler);
+        auto down = AJ::dsp::resample::filter(48000, 44100, handler);
+        assert(up && down);
+        assert(up->Up() == 160 && up->Down() == 147);
+        assert(down->Up() == 147 && down->Down() == 160);
+        assert(up->Taps() == 2 * AJ::kResampleZeroCrossings);
+        assert(down->Taps() > up->Taps());
+        assert(up->OutputLength(44100) == 48000 && up->OutputLength(1) == 2 && down->OutputLength(160) == 147);
+        assert(AJ::dsp::resample::filter(44100, 48000, handler) == up);
+
+        //* every phase has unity gain at DC.
+        for (size_t p = 0; p < up->Up(); ++p) {
+            double sum = 0.0;
+            for (size_t t = 0; t < up->Taps(); ++t) sum += up->Bank()[p * up->Taps() + t];
+            assert(std::fabs(sum - 1.0) < 1e-5);
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ 160 / 147 phases, unity DC gain, one table per pair\n";
+    }
+
+    static void test_tone_keeps_frequency() {
+        std::cout << "\nTest: A 1 kHz tone converted 44.1k -> 48k -> 44.1k stays a 1 kHz tone\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const AJ::Float input = make_tone(44100, 1000.0, 44100.0);
+        AJ::Float converted, back;
+
+        AJ::dsp::resample::resample(input.data(), input.size(), converted, *AJ::dsp::resample::filter(44100, 48000, handler));
+        assert(converted.size() == 48000);
+
+        //* away from the edges the output is the same sine sampled at 48 kHz.
+        const AJ::Float expected = make_tone(48000, 1000.0, 48000.0);
+        for (size_t i = 200; i < 47800; ++i) {
+            assert(std::fabs(converted[i] - expected[i]) < 1e-3f);
+        }
+
+        AJ::dsp::resample::resample(converted.data(), converted.size(), back, *AJ::dsp::resample::filter(48000, 44100, handler));
+        assert(back.size() == 44100);
+        for (size_t i = 200; i < 43900; ++i) {
+            assert(std::fabs(back[i] - input[i]) < 2e-3f);
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Same sine at both rates\n";
+    }
+
+    static void test_downsampling_removes_aliases() {
+        std::cout << "\nTest: Downsampling removes the content above the new Nyquist frequency\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        //* 20 kHz would alias to 2.05 kHz at 22.05 kHz, 5 kHz stays.
+        const AJ::Float high = make_tone(48000, 20000.0, 48000.0);
+        const AJ::Float low = make_tone(48000, 5000.0, 48000.0);
+        auto filter = AJ::dsp::resample::filter(48000, 22050, handler);
+
+        AJ::Float out;
+        AJ::dsp::resample::resample(high.data(), high.size(), out, *filter);
+        assert(rms(out, 500, out.size() - 500) < 0.4 * 1e-4);
+
+        AJ::dsp::resample::resample(low.data(), low.size(), out, *filter);
+        const double kept = rms(out, 500, out.size() - 500);
+        assert(kept > 0.28 && kept < 0.29);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Aliases below -80 dB, passband kept\n";
+    }
+
+    static void test_streaming_matches_offline() {
+        std::cout << "\nTest: Streamed blocks of any size match the offline conversion\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 20011;
+        const AJ::Float left = make_tone(frames, 440.0, 48000.0);
+        AJ::Float right = make_tone(frames, 3000.0, 48000.0, 0.5);
+        for (size_t i = 0; i < frames; ++i) right[i] += 0.05f * std::sin(0.91f * i);
+
+        std::vector<float> interleaved(2 * frames);
+        for (size_t i = 0; i < frames; ++i) {
+            interleaved[2 * i] = left[i];
+            interleaved[2 * i + 1] = right[i];
+        }
+
+        for (auto rates : { std::pair<uint32_t, uint32_t>{ 48000, 44100 }, { 22050, 96000 }, { 48000, 8000 } }) {
+            auto resampler = AJ::dsp::resample::Resampler::create(rates.first, rates.second, 2, handler);
+            assert(resampler);
+            const AJ::dsp::resample::Filter &filter = resampler->filter();
+
+            AJ::Float offlineL, offlineR;
+            AJ::dsp::resample::resample(left.data(), frames, offlineL, filter);
+            AJ::dsp::resample::resample(right.data(), frames, offlineR, filter);
+
+            std::vector<float> streamed;
+            std::vector<float> block(2 * resampler->maxOutput(3000));
+            size_t position = 0, size = 1;
+            while (position < frames) {
+                const size_t n = std::min(size, frames - position);
+                const size_t written = resampler->process(interleaved.data() + 2 * position, n, block.data());
+                assert(written <= resampler->maxOutput(n));
+                streamed.insert(streamed.end(), block.begin(), block.begin() + 2 * written);
+                position += n;
+                size = size * 7 % 2999 + 1;
+            }
+            const size_t tail = resampler->flush(block.data());
+            assert(tail <= resampler->maxOutput(0));
+            streamed.insert(streamed.end(), block.begin(), block.begin() + 2 * tail);
+
+            assert(streamed.size() == 2 * filter.OutputLength(frames));
+            for (size_t i = 0; i < offlineL.size(); ++i) {
+                assert(std::fabs(streamed[2 * i] - offlineL[i]) < 1e-5f);
+                assert(std::fabs(streamed[2 * i + 1] - offlineR[i]) < 1e-5f);
+            }
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ 48k -> 44.1k, 22.05k -> 96k and 48k -> 8k streams match\n";
+    }
+
+    static void test_segments_match_with_pool() {
+        std::cout << "\nTest: Long conversions give the same output with and without a pool\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = static_cast<size_t>(3.6 * AJ::kResampleSegmentFrames);
+        AJ::Float input = make_tone(frames, 523.25, 44100.0);
+        for (size_t i = 0; i < frames; ++i) input[i] += 0.1f * std::sin(0.013f * i * (i % 97));
+
+        auto filter = AJ::dsp::resample::filter(44100, 48000, handler);
+        AJ::utils::ThreadPool pool(4);
+
+        AJ::Float sequential, pooled;
+        AJ::dsp::resample::resample(input.data(), frames, sequential, *filter);
+        AJ::dsp::resample::resample(input.data(), frames, pooled, *filter, &pool);
+
+        assert(sequential.size() == filter->OutputLength(frames));
+        assert(sequential == pooled);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Identical\n";
+    }
+
+    static void test_invalid_rates() {
+        std::cout << "\nTest: Invalid rates and channel counts are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        assert(!AJ::dsp::resample::filter(7999, 48000, handler));
+        assert(!AJ::dsp::resample::filter(44100, 200000, handler));
+        assert(!AJ::dsp::resample::filter(44100, 44101, handler));
+        assert(!AJ::dsp::resample::Resampler::create(44100, 48000, 0, handler));
+        assert(!AJ::dsp::resample::Resampler::create(44100, 48000, 3, handler));
+        assert(handler.errors().size() == 5);
+
+        //* any pair of rates with up to kResampleMaxPhases phases is supported.
+        assert(AJ::dsp::resample::filter(44100, 44100, handler)->Up() == 1);
+        assert(AJ::dsp::resample::filter(11025, 192000, handler)->Up() == 2560);
+        assert(handler.errors().size() == 5);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dsp/reverb/convolution_reverb.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+
+class ConvolutionReverbTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Convolution Reverb Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_matches_direct_convolution();
+        test_blocks_match_buffer();
+        test_invalid_params();
+
+        std::cout << "All Convolution Reverb Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::Float make_signal(size_t frames, float phase = 0.0f) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = 0.3f * std::sin(0.013f * i + phase) + 0.1f * std::sin(0.41f * i);
+        }
+        return signal;
+    }
+
+    // decaying pseudo-random taps.
+    static AJ::Float make_impulse(size_t frames, uint32_t seed) {
+        AJ::Float taps(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            const float noise = static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+            taps[i] = 0.05f * noise * std::exp(-3.0f * i / frames);
+        }
+        taps[0] = 0.5f;
+        return taps;
+    }
+
+    static void test_matches_direct_convolution() {
+        std::cout << "\nTest: Uniform and non-uniform partitions match the direct convolution\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 12000;
+        const AJ::sample_pos start = 333, end = 11000;
+        const AJ::Float signal = make_signal(frames);
+
+        auto ir = AJ::dsp::reverb::convolution::ImpulseResponse::create({ make_impulse(3000, 7) }, handler);
+        assert(ir);
+        const AJ::Float &h = ir->channel(0);
+
+        AJ::Float expected = signal;
+        for (AJ::sample_pos n = start; n <= end; ++n) {
+            double acc = 0.0;
+            for (size_t k = 0; k < h.size() && n - static_cast<AJ::sample_pos>(k) >= start; ++k) {
+                acc += h[k] * signal[n - k];
+            }
+            expected[n] = static_cast<float>(std::clamp(0.8 * signal[n] + 0.6 * acc, -1.0, 1.0));
+        }
+
+        // uniform, non-uniform, and a tail partition too long for this impulse response.
+        const size_t partitions[][2] = { { 64, 0 }, { 32, 256 }, { 128, 1024 }, { 64, 2048 } };
+        for (const auto &p : partitions) {
+            AJ::dsp::reverb::convolution::Params params{ start, end, ir, 0.6f, 0.8f, p[0], p[1] };
+            auto convolutionParams = AJ::dsp::reverb::convolution::ConvolutionParams::create(params, handler);
+            assert(convolutionParams);
+            assert((convolutionParams->Partitions()->mTailPartition != 0) == (p[1] == 256 || p[1] == 1024));
+
+            AJ::dsp::reverb::convolution::ConvolutionReverb reverb;
+            assert(reverb.setParams(convolutionParams, handler));
+
+            AJ::Float output = signal;
+            assert(reverb.process(output, handler));
+
+            for (size_t i = 0; i < frames; ++i) {
+                assert(std::fabs(output[i] - expected[i]) < 1e-5f);
+            }
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Same output for every partitioning\n";
+    }
+
+    static void test_blocks_match_buffer() {
+        std::cout << "\nTest: Streamed stereo blocks on a pool match the whole-buffer reverb\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 30000;
+        auto ir = AJ::dsp::reverb::convolution::ImpulseResponse::create(
+            { make_impulse(9000, 1), make_impulse(9000, 2) }, handler);
+        assert(ir);
+
+        AJ::dsp::reverb::convolution::Params params{ 50, 28999, ir, 0.5f, 1.0f, 64, 1024 };
+        auto convolutionParams = AJ::dsp::reverb::convolution::ConvolutionParams::create(params, handler);
+
+        // the partitions are computed once per impulse response and partitioning.
+        auto again = AJ::dsp::reverb::convolution::ConvolutionParams::create(params, handler);
+        assert(again->Partitions() == convolutionParams->Partitions());
+
+        AJ::Float left = make_signal(frames);
+        AJ::Float right = make_signal(frames, 1.0f);
+
+        std::vector<float> stereo(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            stereo[2 * i] = left[i];
+            stereo[2 * i + 1] = right[i];
+        }
+
+        // channel 1 of the impulse response is only used by the stream, take it as mono.
+        auto rightIR = AJ::dsp::reverb::convolution::ImpulseResponse::create({ ir->channel(1) }, handler);
+        AJ::dsp::reverb::convolution::Params rightParams{ 50, 28999, rightIR, 0.5f, 1.0f, 64, 1024 };
+
+        AJ::dsp::reverb::convolution::ConvolutionReverb mono;
+        assert(mono.setParams(convolutionParams, handler));
+        assert(mono.process(left, handler));
+        assert(mono.setParams(AJ::dsp::reverb::convolution::ConvolutionParams::create(rightParams, handler), handler));
+        assert(mono.process(right, handler));
+
+        AJ::dsp::reverb::convolution::ConvolutionReverb reverb;
+        assert(reverb.setParams(convolutionParams, handler));
+        reverb.setThreadPool(std::make_shared<AJ::utils::ThreadPool>(2));
+
+        auto state = reverb.createState(2, handler);
+        assert(state);
+
+        const size_t sizes[] = { 1, 37, 511, 64, 1000, 3, 4096 };
+        size_t done = 0;
+        for (size_t b = 0; done < frames; ++b) {
+            const size_t n = std::min(sizes[b % 7], frames - done);
+            assert(reverb.processBlock(stereo.data() + done * 2, n, 2, *state, handler));
+            done += n;
+        }
+
+        for (size_t i = 0; i < frames; ++i) {
+            assert(stereo[2 * i] == left[i] && stereo[2 * i + 1] == right[i]);
+        }
+
+        // a stereo impulse response can't run on a 4 channel stream.
+        assert(!reverb.createState(4, handler));
+        assert(handler.errors().size() == 1);
+
+        std::cout << "  ✓ Same samples block by block, tail on the pool\n";
+    }
+
+    static void test_invalid_params() {
+        std::cout << "\nTest: Invalid impulse responses and partitions are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        assert(!AJ::dsp::reverb::convolution::ImpulseResponse::create({}, handler));
+        assert(!AJ::dsp::reverb::convolution::ImpulseResponse::create({ AJ::Float(10), AJ::Float(11) }, handler));
+        assert(!AJ::dsp::reverb::convolution::ImpulseResponse::create({ AJ::Float() }, handler));
+
+        auto ir = AJ::dsp::reverb::convolution::ImpulseResponse::create({ make_impulse(500, 3) }, handler);
+        assert(ir && handler.errors().size() == 3);
+
+        AJ::dsp::reverb::convolution::Params none{ 0, 100, nullptr, 0.5f, 0.5f, 64, 0 };
+        AJ::dsp::reverb::convolution::Params odd{ 0, 100, ir, 0.5f, 0.5f, 100, 0 };
+        AJ::dsp::reverb::convolution::Params small{ 0, 100, ir, 0.5f, 0.5f, 16, 0 };
+        AJ::dsp::reverb::convolution::Params shortTail{ 0, 100, ir, 0.5f, 0.5f, 256, 128 };
+        AJ::dsp::reverb::convolution::Params loud{ 0, 100, ir, 3.0f, 0.5f, 64, 0 };
+        AJ::dsp::reverb::convolution::Params reversed{ 100, 0, ir, 0.5f, 0.5f, 64, 0 };
+
+        for (auto *p : { &none, &odd, &small, &shortTail, &loud, &reversed }) {
+            assert(!AJ::dsp::reverb::convolution::ConvolutionParams::create(*p, handler));
+        }
+        assert(handler.errors().size() == 9);
+
+        AJ::dsp::reverb::convolution::ConvolutionReverb reverb;
+        AJ::Float buffer(50, 0.1f);
+        assert(!reverb.process(buffer, handler));
+
+        AJ::dsp::reverb::convolution::Params valid{ 0, 100, ir, 0.5f, 0.5f, 64, 0 };
+        assert(reverb.setParams(AJ::dsp::reverb::convolution::ConvolutionParams::create(valid, handler), handler));
+        assert(!reverb.process(buffer, handler));
+        assert(handler.errors().size() == 11);
+
+        std::cout << "  ✓ Every invalid input reported\n";
+    }
+};
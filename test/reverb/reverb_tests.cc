@@ -2,6 +2,8 @@
 #include <chrono>
 #include <cassert>
 #include <filesystem>
+#include <cmath>
+#include <vector>
 
 #include "dsp/reverb/reverb.h"
 #include "file_io/wav_file.h"
@@ -21,12 +23,67 @@ public:
         // test_reverb_on_valid_file("test_64bit_double_mono.wav", 1, "full", 90.0f, 0.7f, 0.3f, 0.6f);
         // test_reverb_on_valid_file("violin.wav", 2, "full", 25.0f, 0.7f, 0.3f, 0.4f);
         test_reverb_on_valid_file("tefa.wav", 2, "full", 25.0f, 0.7f, 0.3f, 0.4f);
+        test_reverb_block_matches_process();
 
 
         std::cout << "All Reverb Tests Completed Successfully.\n";
     }
 
 private:
+    static void test_reverb_block_matches_process() {
+        using namespace AJ;
+        using namespace AJ::dsp::reverb;
+
+        std::cout << "\nTest: Reverb processBlock matches process (stereo, odd block size)\n";
+
+        error::ConsoleErrorHandler errorHandler;
+
+        const sample_pos frames = 48000;
+        const int samplerate = 48000;
+
+        AudioBuffer channels;
+        for (int ch = 0; ch < 2; ++ch) {
+            channels[ch].resize(frames);
+            for (sample_pos i = 0; i < frames; ++i) {
+                channels[ch][i] = 0.5f * std::sin(0.01f * i * (ch + 1));
+            }
+        }
+
+        //* interleave before processing.
+        std::vector<float> interleaved(frames * 2);
+        for (sample_pos i = 0; i < frames; ++i) {
+            interleaved[2 * i] = channels[0][i];
+            interleaved[2 * i + 1] = channels[1][i];
+        }
+
+        Params reverbParams{ 25.0f, 0.4f, 0.6f, samplerate, 0.5f, 100, frames - 100 };
+        auto params = ReverbParams::create(reverbParams, errorHandler);
+        assert(params);
+
+        Reverb reverb;
+        assert(reverb.setParams(params, errorHandler));
+        assert(reverb.process(channels[0], errorHandler));
+        assert(reverb.process(channels[1], errorHandler));
+
+        Reverb blockReverb;
+        assert(blockReverb.setParams(params, errorHandler));
+        auto state = blockReverb.createState(2, errorHandler);
+        assert(state);
+
+        const size_t block = 257;
+        for (size_t pos = 0; pos < static_cast<size_t>(frames); pos += block) {
+            size_t n = std::min(block, static_cast<size_t>(frames) - pos);
+            assert(blockReverb.processBlock(interleaved.data() + pos * 2, n, 2, *state, errorHandler));
+        }
+
+        for (sample_pos i = 0; i < frames; ++i) {
+            assert(std::fabs(interleaved[2 * i] - channels[0][i]) < 1e-5f);
+            assert(std::fabs(interleaved[2 * i + 1] - channels[1][i]) < 1e-5f);
+        }
+
+        std::cout << "  ✓ Block processing result matches whole-buffer processing.\n";
+    }
+
     static constexpr const char* audio_dir = "/home/aj-e/Programming Codes/C++/AJ-Audio-Engine/build/build/bin/audio";
     static constexpr const char* output_dir = "/home/aj-e/Programming Codes/C++/AJ-Audio-Engine/build/build/bin/reverb_audio";
 
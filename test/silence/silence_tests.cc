@@ -0,0 +1,192 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "dsp/silence.h"
+#include "file_io/wav_file.h"
+#include "core/error_handler.h"
+#include "audio_fixtures.h"
+
+class SilenceTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Silence Detection Tests\n";
+        std::cout << "--------------------------------------------------\n";
+
+        test_scanner_matches_reference();
+        test_chunked_feeds();
+        test_file_paths_agree();
+        test_invalid_requests();
+
+        std::cout << "All Silence Detection Tests Completed Successfully.\n";
+    }
+
+private:
+    using Regions = std::vector<AJ::dsp::silence::Region>;
+
+    //* runs of frames where every channel is at or under the threshold, one frame at a time.
+    static Regions reference(const std::vector<AJ::Float> &channels, float threshold, size_t minFrames) {
+        Regions regions;
+        const size_t frames = channels[0].size();
+        size_t start = 0;
+
+        for (size_t i = 0; i <= frames; ++i) {
+            bool loud = i == frames;
+            for (const AJ::Float &channel : channels) loud = loud || std::fabs(channel[i]) > threshold;
+
+            if (loud) {
+                if (i - start >= minFrames) regions.push_back({ static_cast<AJ::sample_pos>(start), static_cast<AJ::sample_pos>(i) - 1 });
+                start = i + 1;
+            }
+        }
+        return regions;
+    }
+
+    static bool same(const Regions &a, const Regions &b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].mStart != b[i].mStart || a[i].mEnd != b[i].mEnd) return false;
+        }
+        return true;
+    }
+
+    //* quiet noise with loud bursts and lone clicks of random lengths.
+    static std::vector<AJ::Float> make_channels(size_t count, size_t frames, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> noise(-0.0005f, 0.0005f);
+        std::uniform_int_distribution<size_t> gap(1, 6000);
+
+        std::vector<AJ::Float> channels(count, AJ::Float(frames));
+        for (auto &channel : channels) {
+            for (float &x : channel) x = noise(rng);
+        }
+
+        for (size_t pos = gap(rng); pos < frames; pos += gap(rng)) {
+            const size_t length = gap(rng) % 700 + 1;
+            AJ::Float &channel = channels[pos % count];
+            for (size_t i = pos; i < std::min(frames, pos + length); ++i) {
+                channel[i] = 0.3f * std::sin(0.1f * i) + (i == pos ? 0.2f : 0.0f);
+            }
+        }
+        return channels;
+    }
+
+    static void test_scanner_matches_reference() {
+        std::cout << "\nTest: The scanner finds the same regions as a frame by frame scan\n";
+
+        const float threshold = 0.001f;
+        size_t total = 0;
+
+        for (unsigned seed = 1; seed <= 6; ++seed) {
+            const size_t count = seed % 2 + 1;
+            const auto channels = make_channels(count, 200000, seed);
+            const float *data[2] = { channels[0].data(), channels[count - 1].data() };
+
+            for (size_t minFrames : { 1, 7, 300, 4800 }) {
+                const Regions expected = reference(channels, threshold, minFrames);
+                const Regions found = AJ::dsp::silence::detect(data, count, 200000, threshold, minFrames);
+                assert(same(found, expected));
+                total += found.size();
+            }
+        }
+
+        std::cout << "  ✓ " << total << " regions match\n";
+    }
+
+    static void test_chunked_feeds() {
+        std::cout << "\nTest: Feeding in odd chunks and skipping known silence changes nothing\n";
+
+        const auto channels = make_channels(2, 150000, 42);
+        const float *data[2] = { channels[0].data(), channels[1].data() };
+        const Regions expected = reference(channels, 0.001f, 500);
+
+        AJ::dsp::silence::Scanner scanner(0.001f, 500);
+        for (size_t pos = 0; pos < 150000; ) {
+            const size_t n = std::min<size_t>(1237, 150000 - pos);
+            const float *chunk[2] = { data[0] + pos, data[1] + pos };
+            scanner.feed(chunk, 2, n);
+            pos += n;
+        }
+        assert(scanner.position() == 150000);
+        assert(same(scanner.finish(), expected));
+
+        //* a stretch fed as silent joins the regions on both sides of it.
+        AJ::Float zeros(3000, 0.0f);
+        AJ::Float loud(10, 0.5f);
+        AJ::dsp::silence::Scanner joined(0.001f, 100);
+        const float *z[1] = { zeros.data() };
+        const float *l[1] = { loud.data() };
+        joined.feed(l, 1, 10);
+        joined.feed(z, 1, 3000);
+        joined.feedSilent(5000);
+        joined.feed(z, 1, 3000);
+        joined.feed(l, 1, 10);
+
+        const Regions regions = joined.finish();
+        assert(regions.size() == 1 && regions[0].mStart == 10 && regions[0].mEnd == 11009);
+
+        std::cout << "  ✓ Same regions\n";
+    }
+
+    static std::shared_ptr<AJ::io::WAV_File> make_file(const std::vector<AJ::Float> &channels) {
+        auto audio = std::make_shared<AJ::AudioBuffer>();
+        std::copy(channels.begin(), channels.end(), audio->begin());
+        return fixtures::make_file(audio, static_cast<uint8_t>(channels.size()));
+    }
+
+    static void test_file_paths_agree() {
+        std::cout << "\nTest: AudioFile::silences() agrees with and without the level index, and compact\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        //* long silences (skipped from the index) around the material.
+        auto channels = make_channels(2, 400000, 7);
+        for (auto &channel : channels) {
+            std::fill(channel.begin(), channel.begin() + 100000, 0.0f);
+            std::fill(channel.begin() + 250000, channel.begin() + 330000, 0.0002f);
+        }
+
+        const float thresholdDb = -50.0f;
+        const float threshold = std::pow(10.0f, thresholdDb / 20.0f);
+        const Regions expected = reference(channels, threshold, 2400);
+
+        auto wav = make_file(channels);
+        Regions plain, indexed, compact;
+
+        assert(wav->silences(thresholdDb, 2400, plain, handler));
+        wav->buildLevelIndex();
+        assert(wav->levelIndex());
+        assert(wav->silences(thresholdDb, 2400, indexed, handler));
+
+        assert(same(plain, expected) && same(indexed, expected));
+        assert(expected.front().mStart == 0 && expected.front().mEnd >= 99999);
+
+        //* 16-bit rounding only moves levels by less than a step, far from the threshold here.
+        assert(wav->setStorage(AJ::io::SampleStorage::Int16, handler));
+        assert(wav->silences(thresholdDb, 2400, compact, handler));
+        assert(compact.size() == expected.size());
+
+        assert(!handler.hasErrors());
+        std::cout << "  ✓ " << expected.size() << " regions on every path\n";
+    }
+
+    static void test_invalid_requests() {
+        std::cout << "\nTest: An invalid threshold or length is reported\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        auto wav = make_file({ AJ::Float(1000, 0.0f) });
+        Regions regions;
+
+        assert(!wav->silences(6.0f, 100, regions, handler));
+        assert(!wav->silences(-200.0f, 100, regions, handler));
+        assert(!wav->silences(-40.0f, 0, regions, handler));
+        assert(handler.errors().size() == 3);
+
+        assert(wav->silences(-40.0f, 100, regions, handler));
+        assert(regions.size() == 1 && regions[0].frames() == 1000);
+
+        std::cout << "  ✓ Reported\n";
+    }
+};
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "dsp/static_chain.h"
+#include "dsp/effect_chain.h"
+#include "core/error_handler.h"
+
+class StaticChainTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning StaticChain Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_matches_effect_chain();
+        test_interleaved_streaming();
+        test_invalid_params();
+
+        std::cout << "All StaticChain Tests Completed Successfully.\n";
+    }
+
+private:
+    using Preset = AJ::dsp::StaticChain<AJ::dsp::GainStage, AJ::dsp::FadeStage,
+        AJ::dsp::DistortionStage<AJ::dsp::distortion::DistortionType::SoftClipping>>;
+
+    static AJ::Float make_signal(size_t frames) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = 0.4f * std::sin(0.003f * i) + 0.2f * std::sin(0.05f * i);
+        }
+        return signal;
+    }
+
+    struct PresetParams {
+        std::shared_ptr<AJ::dsp::gain::GainParams> gain;
+        std::shared_ptr<AJ::dsp::fade::FadeParams> fade;
+        std::shared_ptr<AJ::dsp::distortion::DistortionParams> distortion;
+    };
+
+    static PresetParams make_params(size_t frames, AJ::error::IErrorHandler &handler) {
+        AJ::dsp::gain::Params gain{ 0, static_cast<AJ::sample_pos>(frames) - 1, 1.5f };
+        AJ::dsp::fade::Params fade{ 1000, 5 * 44100, 1.0f, 0.2f, AJ::dsp::fade::FadeMode::Out };
+
+        AJ::dsp::distortion::Params distortion;
+        distortion.mStart = 3000;
+        distortion.mEnd = frames - 3001;
+        distortion.mGain = 2.0f;
+
+        PresetParams params;
+        params.gain = AJ::dsp::gain::GainParams::create(gain, handler);
+        params.fade = AJ::dsp::fade::FadeParams::create(fade, handler);
+        params.distortion = AJ::dsp::distortion::DistortionParams::create(distortion, handler);
+        return params;
+    }
+
+    static void test_matches_effect_chain() {
+        std::cout << "\nTest: Fused preset matches the EffectChain of the same effects\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 10 * 44100 + 123;
+        AJ::Float expected = make_signal(frames);
+        AJ::Float fused = expected;
+        PresetParams params = make_params(frames, handler);
+
+        auto gain = std::make_shared<AJ::dsp::gain::Gain>();
+        auto fade = std::make_shared<AJ::dsp::fade::Fade>();
+        auto distortion = std::make_shared<AJ::dsp::distortion::Distortion>();
+        assert(gain->setParams(params.gain, handler));
+        assert(fade->setParams(params.fade, handler));
+        assert(distortion->setParams(params.distortion, handler));
+
+        AJ::dsp::EffectChain chain;
+        assert(chain.add(gain, handler) && chain.add(fade, handler) && chain.add(distortion, handler));
+        assert(chain.process(expected, handler));
+
+        Preset preset;
+        assert(preset.setParams(handler, params.gain, params.fade, params.distortion));
+        assert(preset.process(fused, handler));
+
+        // the vector shape kernel may round differently than the inline curve.
+        for (size_t i = 0; i < frames; ++i) {
+            assert(std::fabs(fused[i] - expected[i]) < 1e-5f);
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Same samples, partly covered blocks included\n";
+    }
+
+    static void test_interleaved_streaming() {
+        std::cout << "\nTest: Interleaved blocks of any size give the result of one pass\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 8 * 44100;
+        PresetParams params = make_params(frames, handler);
+
+        Preset preset;
+        assert(preset.setParams(handler, params.gain, params.fade, params.distortion));
+
+        std::vector<float> whole(frames * 2);
+        for (size_t i = 0; i < whole.size(); ++i) {
+            whole[i] = 0.5f * std::sin(0.0007f * i);
+        }
+        std::vector<float> streamed = whole;
+
+        assert(preset.processInterleaved(whole.data(), frames, 0, handler));
+
+        const size_t sizes[] = { 1, 127, 2048, 5000, 333 };
+        size_t position = 0;
+        for (size_t n = 0; position < frames; ++n) {
+            const size_t block = std::min(sizes[n % 5], frames - position);
+            assert(preset.processInterleaved(streamed.data() + position * 2, block, position, handler));
+            position += block;
+        }
+
+        assert(streamed == whole);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Streamed blocks bit exact\n";
+    }
+
+    static void test_invalid_params() {
+        std::cout << "\nTest: Missing, mismatched and out of range parameters are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        PresetParams params = make_params(44100, handler);
+        AJ::Float buffer = make_signal(44100);
+
+        Preset preset;
+        // not configured yet.
+        assert(!preset.process(buffer, handler));
+        assert(!preset.setParams(handler, params.gain, nullptr, params.distortion));
+        assert(!preset.processInterleaved(buffer.data(), 100, 0, handler));
+
+        // the stage is compiled for SoftClipping.
+        params.distortion->setType(AJ::dsp::distortion::DistortionType::HardClipping);
+        assert(!preset.setParams(handler, params.gain, params.fade, params.distortion));
+        params.distortion->setType(AJ::dsp::distortion::DistortionType::SoftClipping);
+        assert(preset.setParams(handler, params.gain, params.fade, params.distortion));
+
+        // the fade range ends past a 1000 frames buffer, nothing is processed.
+        AJ::Float shorter = make_signal(1000);
+        const AJ::Float original = shorter;
+        assert(!preset.process(shorter, handler));
+        assert(shorter == original);
+
+        assert(handler.errors().size() == 5);
+
+        std::cout << "  ✓ Errors reported, buffer untouched\n";
+    }
+};
@@ -4,23 +4,80 @@
 #include "file_io/wav_file_tests.cc"
 #include "file_io/mp3_file_tests.cc"
 #include "file_io/file_streamer_tests.cc"
+#include "file_io/writer_pool_tests.cc"
+#include "file_io/level_index_tests.cc"
+#include "file_io/seek_index_tests.cc"
+#include "file_io/spectrogram_tests.cc"
+#include "file_io/mapped_wav_tests.cc"
+#include "file_io/decode_cache_tests.cc"
+#include "file_io/wav_stream_writer_tests.cc"
+#include "file_io/mp3_stream_encoder_tests.cc"
+#include "file_io/compact_samples_tests.cc"
+#include "file_io/async_load_tests.cc"
 
 #include "echo/echo_tests.cc"
+#include "echo/multi_tap_echo_tests.cc"
 #include "gain/gain_tests.cc"
 #include "reverb/reverb_tests.cc"
+#include "reverb/convolution_reverb_tests.cc"
 #include "fade/fade_tests.cc"
 #include "normalization/norm_tests.cc"
 #include "distortion/distortion_tests.cc"
 #include "reverse/reverse_tests.cc"
+#include "pitch_shift/pitch_shift_tests.cc"
+#include "equalizer/equalizer_tests.cc"
+#include "dynamics/dynamics_tests.cc"
+#include "dynamics/gate_tests.cc"
+#include "silence/silence_tests.cc"
+#include "loudness/loudness_tests.cc"
+#include "time_stretch/time_stretch_tests.cc"
+#include "resample/resample_tests.cc"
+#include "effect_chain/effect_chain_tests.cc"
+#include "effect_registry/effect_registry_tests.cc"
+#include "static_chain/static_chain_tests.cc"
+#include "automation/automation_tests.cc"
+#include "audio_view/audio_view_tests.cc"
+#include "kernels/kernels_tests.cc"
+#include "fft/fft_tests.cc"
 
 #include "editing/cut/cut_tests.cc"
 #include "editing/insert/insert_tests.cc"
+#include "editing/piece_table/piece_table_tests.cc"
+#include "editing/render_graph/render_graph_tests.cc"
+#include "editing/preview/preview_tests.cc"
+#include "editing/project/project_tests.cc"
+#include "editing/transaction/transaction_tests.cc"
+#include "editing/trim/trim_tests.cc"
+#include "editing/session/session_tests.cc"
+#include "editing/session/export_tests.cc"
+#include "editing/session/render_cache_tests.cc"
+
+#include "undo/undo_tests.cc"
+
+#include "batch/batch_runner_tests.cc"
 
 #include "core/utils/buffer_pool_tests.cc"
+#include "core/utils/mpmc_queue_tests.cc"
 #include "core/utils/ring_buffer_tests.cc"
+#include "core/utils/fixed_ring_tests.cc"
 #include "core/utils/thread_pool_tests.cc"
+#include "core/utils/aligned_allocator_tests.cc"
+#include "core/utils/scratch_arena_tests.cc"
+#include "core/utils/param_store_tests.cc"
+#include "core/utils/metrics_tests.cc"
+#include "core/utils/trace_tests.cc"
+#include "core/utils/memory_tests.cc"
+#include "core/utils/realtime_tests.cc"
+#include "core/utils/engine_resources_tests.cc"
+#include "core/utils/elastic_pool_tests.cc"
+#include "core/utils/thread_placement_tests.cc"
+#include "core/utils/error_channel_tests.cc"
 
 #include "audio_io/record_tests.cc"
+#include "audio_io/play_tests.cc"
+#include "audio_io/callback_profiler_tests.cc"
+#include "audio_io/device_tests.cc"
+#include "audio_io/multi_recorder_tests.cc"
 
 int main() {
     // Show current working directory
@@ -35,10 +92,14 @@ int main() {
 
     // EchoTests::run_all();
 
+    // MultiTapEchoTests::run_all();
+
     // GainTests::run_all();
 
     ReverbTests::run_all();
 
+    // ConvolutionReverbTests::run_all();
+
     // FadeTests::run_all();
 
     // NormalizationTests::run_all();
@@ -47,20 +108,109 @@ int main() {
     
     // ReverseTests::run_all();
 
+    // PitchShiftTests::run_all();
+
+    // EqualizerTests::run_all();
+
+    // DynamicsTests::run_all();
+
+    // GateTests::run_all();
+
+    // SilenceTests::run_all();
+
+    // LoudnessTests::run_all();
+
+    // TimeStretchTests::run_all();
+
+    // ResampleTests::run_all();
+
+    // EffectChainTests::run_all();
+
+    // EffectRegistryTests::run_all();
+
+    // StaticChainTests::run_all();
+
+    // AutomationTests::run_all();
+
+    // AudioViewTests::run_all();
+
+    // KernelsTests::run_all();
+
+    // FFTTests::run_all();
+
     // CutTests::run_all();
 
     // InsertTests::run_all();
 
+    // PieceTableTests::run_all();
+    // RenderGraphTests::run_all();
+    // PreviewRendererTests::run_all();
+    // ProjectStoreTests::run_all();
+
+    // TransactionTests::run_all();
+
+    // TrimTests::run_all();
+
+    // SessionTests::run_all();
+    // ExportTests::run_all();
+    // RenderCacheTests::run_all();
+
+    // UndoTests::run_all();
+
+    // BatchRunnerTests::run_all();
+
     // BufferPoolTests::run_all();
+    // MPMCQueueTests::run_all();
 
     // RingBufferTests::run_all();
+    // FixedRingTests::run_all();
 
 
     // ThreadPoolTests::run_all();
 
+    // AlignedAllocatorTests::run_all();
+
+    // ScratchArenaTests::run_all();
+
+    // ParamStoreTests::run_all();
+
+    // MetricsTests::run_all();
+    // TraceTests::run_all();
+    // MemoryTests::run_all();
+    // RealtimeTests::run_all();
+    // EngineResourcesTests::run_all();
+    // ElasticPoolTests::run_all();
+    // ThreadPlacementTests::run_all();
+    // ErrorChannelTests::run_all();
+
     // FileStreamerWriteTests::run_all();
 
+    // FileStreamerReadTests::run_all();
+
+    // WriterPoolTests::run_all();
+
+    // LevelIndexTests::run_all();
+    // SeekIndexTests::run_all();
+    // SpectrogramTests::run_all();
+
+    // MappedWavTests::run_all();
+
+    // DecodeCacheTests::run_all();
+
+    // WavStreamWriterTests::run_all();
+
+    // Mp3StreamEncoderTests::run_all();
+
+    // CompactSamplesTests::run_all();
+    // AsyncLoadTests::run_all();
+
     // AudioIOManagerRecordTests::run_all();
 
+    // PlayerTests::run_all();
+
+    // CallbackProfilerTests::run_all();
+    // DeviceTests::run_all();
+    // MultiRecorderTests::run_all();
+
     return 0;
 }
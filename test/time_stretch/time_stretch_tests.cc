@@ -0,0 +1,194 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+
+#include "dsp/stretch/time_stretch.h"
+#include "core/thread_pool.h"
+#include "core/error_handler.h"
+
+class TimeStretchTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Time Stretch Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_rate_changes_length_not_pitch();
+        test_rate_one_is_untouched();
+        test_segments_match_with_pool();
+        test_channels_share_alignment();
+        test_invalid_params();
+
+        std::cout << "All Time Stretch Tests Completed Successfully.\n";
+    }
+
+private:
+    static AJ::Float make_tone(size_t frames, double hz, double rate = 44100.0) {
+        AJ::Float signal(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            signal[i] = static_cast<float>(0.4 * std::sin(2.0 * M_PI * hz * i / rate));
+        }
+        return signal;
+    }
+
+    // power of `hz` in [first, last) (Goertzel).
+    static double power(const AJ::Float &x, size_t first, size_t last, double hz, double rate = 44100.0) {
+        const double coeff = 2.0 * std::cos(2.0 * M_PI * hz / rate);
+        double s1 = 0.0, s2 = 0.0;
+        for (size_t i = first; i < last; ++i) {
+            const double s = x[i] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s;
+        }
+        return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    }
+
+    static std::shared_ptr<AJ::dsp::stretch::StretchParams> make_params(AJ::sample_pos start, AJ::sample_pos end,
+        float rate, size_t frame, size_t seek, AJ::error::IErrorHandler &handler) {
+        AJ::dsp::stretch::Params params{ start, end, rate, frame, seek };
+        return AJ::dsp::stretch::StretchParams::create(params, handler);
+    }
+
+    static void test_rate_changes_length_not_pitch() {
+        std::cout << "\nTest: Rates 1.5 / 0.75 / 2 change the length of the range, not its pitch\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const size_t frames = 50000, start = 1000, length = 40000;
+        AJ::Float signal = make_tone(frames, 440.0);
+        for (size_t i = start + length; i < frames; ++i) signal[i] = 0.001f * (i % 17);
+
+        for (float rate : { 1.5f, 0.75f, 2.0f }) {
+            auto params = make_params(start, start + length - 1, rate, 1024, 256, handler);
+            const size_t stretched = params->StretchedLength(length);
+            assert(stretched == static_cast<size_t>(std::llround(length / rate)));
+
+            AJ::Float output = signal;
+            AJ::dsp::stretch::TimeStretch stretch;
+            assert(stretch.setParams(params, handler));
+            assert(stretch.process(output, handler));
+
+            //* the samples around the range are kept, the ones after it moved.
+            assert(output.size() == frames - length + stretched);
+            assert(std::equal(signal.begin(), signal.begin() + start, output.begin()));
+            assert(std::equal(signal.begin() + start + length, signal.end(), output.begin() + start + stretched));
+
+            const size_t first = start + 2048, last = start + stretched - 2048;
+            const double kept = power(output, first, last, 440.0);
+            assert(kept > 100.0 * power(output, first, last, 440.0 * rate));
+            assert(kept > 100.0 * power(output, first, last, 440.0 / rate));
+
+            //* aligned frames add up in phase: the level is kept (a sine of 0.4 has an RMS of ~0.28).
+            double squares = 0.0;
+            for (size_t i = first; i < last; ++i) squares += output[i] * output[i];
+            const double rms = std::sqrt(squares / (last - first));
+            assert(rms > 0.26 && rms < 0.30);
+        }
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Length changed, pitch and level kept\n";
+    }
+
+    static void test_rate_one_is_untouched() {
+        std::cout << "\nTest: A rate of 1 leaves the buffer as it is\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const AJ::Float signal = make_tone(5000, 1000.0);
+        AJ::Float output = signal;
+
+        AJ::dsp::stretch::TimeStretch stretch;
+        assert(stretch.setParams(make_params(10, 4000, 1.0f, 512, 128, handler), handler));
+        assert(stretch.process(output, handler));
+        assert(output == signal);
+
+        std::cout << "  ✓ Untouched\n";
+    }
+
+    static void test_segments_match_with_pool() {
+        std::cout << "\nTest: Long ranges are segmented the same way with and without a pool\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const float rate = 1.25f;
+        const size_t frames = static_cast<size_t>(3.4 * AJ::kStretchSegmentFrames * rate);
+
+        AJ::AudioBuffer sequential;
+        sequential[0] = make_tone(frames, 200.0);
+        sequential[1] = make_tone(frames, 330.0);
+        AJ::AudioBuffer pooled = sequential;
+
+        auto params = make_params(0, frames - 1, rate, 1024, 256, handler);
+        AJ::dsp::stretch::TimeStretch stretch;
+        assert(stretch.setParams(params, handler));
+        assert(stretch.process(sequential, 2, handler));
+
+        stretch.setThreadPool(std::make_shared<AJ::utils::ThreadPool>(4));
+        assert(stretch.process(pooled, 2, handler));
+
+        assert(sequential[0] == pooled[0] && sequential[1] == pooled[1]);
+        assert(pooled[0].size() == params->StretchedLength(frames));
+
+        //* no click anywhere, at the segment boundaries neither (a 200 Hz sine of 0.4 moves < 0.012 per sample).
+        for (size_t i = 1; i < pooled[0].size(); ++i) {
+            assert(std::fabs(pooled[0][i] - pooled[0][i - 1]) < 0.03f);
+        }
+
+        std::cout << "  ✓ Same output, seamless stitching\n";
+    }
+
+    static void test_channels_share_alignment() {
+        std::cout << "\nTest: Channels are stretched with one alignment\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::AudioBuffer audio;
+        audio[0] = make_tone(30000, 523.25);
+        for (size_t i = 0; i < audio[0].size(); ++i) audio[0][i] += 0.1f * std::sin(0.37f * i);
+        audio[1] = audio[0];
+
+        AJ::dsp::stretch::TimeStretch stretch;
+        assert(stretch.setParams(make_params(500, 29000, 0.8f, 1024, 300, handler), handler));
+        assert(stretch.process(audio, 2, handler));
+        assert(audio[0] == audio[1]);
+
+        //* a single channel finds the same alignment as two identical ones.
+        AJ::Float mono = make_tone(30000, 523.25);
+        for (size_t i = 0; i < mono.size(); ++i) mono[i] += 0.1f * std::sin(0.37f * i);
+        assert(stretch.process(mono, handler));
+        assert(mono.size() == audio[0].size());
+        for (size_t i = 0; i < mono.size(); ++i) {
+            assert(std::fabs(mono[i] - audio[0][i]) < 1e-5f);
+        }
+
+        std::cout << "  ✓ Channels stay in phase\n";
+    }
+
+    static void test_invalid_params() {
+        std::cout << "\nTest: Invalid parameters are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        assert(!make_params(10, 5, 1.5f, 1024, 256, handler));
+        assert(!make_params(0, 99, 0.1f, 1024, 256, handler));
+        assert(!make_params(0, 99, 5.0f, 1024, 256, handler));
+        assert(!make_params(0, 99, NAN, 1024, 256, handler));
+        assert(!make_params(0, 99, 1.5f, 1001, 256, handler));
+        assert(!make_params(0, 99, 1.5f, 64, 16, handler));
+        assert(!make_params(0, 99, 1.5f, 1024, 513, handler));
+        assert(handler.errors().size() == 7);
+
+        AJ::dsp::stretch::TimeStretch stretch;
+        AJ::Float buffer(50, 0.1f);
+        handler.clear();
+        assert(!stretch.process(buffer, handler));
+        assert(stretch.setParams(make_params(0, 99, 1.5f, 1024, 256, handler), handler));
+        assert(!stretch.process(buffer, handler));
+
+        AJ::AudioBuffer audio;
+        audio[0].assign(200, 0.1f);
+        audio[1].assign(150, 0.1f);
+        assert(!stretch.process(audio, 2, handler));
+        assert(!stretch.process(audio, 0, handler));
+        assert(buffer.size() == 50 && audio[0].size() == 200);
+        assert(handler.errors().size() == 4);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};
@@ -0,0 +1,251 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/aj_audio_engine.h"
+#include "undo_system/undo.h"
+#include "undo_system/state.h"
+#include "editing/cut.h"
+#include "editing/insert.h"
+#include "editing/piece_table.h"
+#include "dsp/gain.h"
+#include "file_io/wav_file.h"
+#include "core/error_handler.h"
+#include "audio_fixtures.h"
+
+class UndoTests {
+public:
+    static void run_all() {
+        std::cout << "\nRunning Undo Tests\n";
+        std::cout << "---------------------------------------------\n";
+
+        test_effect_undo_redo();
+        test_cut_and_insert();
+        test_piece_table_shares_chunks();
+        test_budget_spills_oldest();
+        test_invalid_undo();
+
+        std::cout << "All Undo Tests Completed Successfully.\n";
+    }
+
+private:
+    static std::shared_ptr<AJ::dsp::gain::GainParams> gain_params(AJ::sample_pos start, AJ::sample_pos end,
+        float gain, AJ::error::IErrorHandler &handler) {
+        AJ::dsp::gain::Params params{ start, end, gain };
+        return AJ::dsp::gain::GainParams::create(params, handler);
+    }
+
+    static void test_effect_undo_redo() {
+        std::cout << "\nTest: An effect is undone and redone, only its range is kept\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::AJ_Engine engine;
+        auto file = fixtures::make_file(fixtures::ramp(200000, 0.0f, 0.001f));
+        file->buildLevelIndex();
+        const AJ::AudioBuffer original = *file->pAudio;
+
+        assert(engine.applyEffect(file, AJ::Effect::gain, gain_params(1000, 50999, 0.5f, handler), handler));
+        const AJ::AudioBuffer processed = *file->pAudio;
+        assert(processed != original);
+
+        //* 50000 frames of 2 channels saved, not the 200000 of the file.
+        assert(engine.undoSystem().residentBytes() == 50000 * 2 * sizeof(float));
+
+        assert(engine.undo(handler));
+        assert(*file->pAudio == original);
+        AJ::dsp::kernels::Levels levels;
+        assert(file->levels(0, 1000, 50999, levels, handler) && levels.max == original[0][50999]);
+
+        assert(engine.redo(handler));
+        assert(*file->pAudio == processed);
+
+        //* a new operation drops the redo history.
+        assert(engine.undo(handler));
+        assert(engine.applyEffect(file, AJ::Effect::gain, gain_params(0, 99, 2.0f, handler), handler));
+        assert(!engine.undoSystem().canRedo() && engine.undoSystem().undoCount() == 1);
+
+        //* one undo for a batch of files.
+        auto other = fixtures::make_file(fixtures::ramp(1000, 0.0f, 0.001f));
+        const AJ::AudioBuffer before = *other->pAudio;
+        assert(engine.applyEffect({ file, other }, AJ::Effect::gain, gain_params(0, 499, 0.25f, handler), handler));
+        assert(engine.undoSystem().undoCount() == 2);
+        assert(engine.undo(handler));
+        assert(*other->pAudio == before && (*file->pAudio)[0][0] == 2.0f * original[0][0]);
+
+        //* without undo support nothing is saved.
+        engine.setUndoSupportEnabled(false);
+        assert(!engine.undoSystem().canUndo());
+        assert(engine.applyEffect(file, AJ::Effect::gain, gain_params(0, 99, 2.0f, handler), handler));
+        assert(!engine.undoSystem().canUndo());
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ Bit-exact undo and redo\n";
+    }
+
+    static void test_cut_and_insert() {
+        std::cout << "\nTest: Cut and Insert states restore the length and the samples\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::undo::UndoSystem undo;
+        auto file = fixtures::make_file(fixtures::ramp(10000, 0.0f, 0.001f));
+        const AJ::AudioBuffer original = *file->pAudio;
+
+        //* a cut replaces its range by nothing.
+        AJ::undo::State cutState("cut");
+        assert(cutState.add(file, 2000, 3000, 0, handler));
+        AJ::editing::cut::Cut cut;
+        assert(cut.setRange(2000, 4999, handler));
+        assert(cut.process(file, handler));
+        undo.push(std::move(cutState), handler);
+
+        //* an insert replaces nothing by its frames.
+        AJ::undo::State insertState("insert");
+        assert(insertState.add(file, 100, 0, 50, handler));
+        AJ::editing::insert::Insert insert;
+        assert(insert.setInsertAt(100, handler));
+        assert(insert.process(file, fixtures::ramp(50, -1.0f, 0.001f), handler));
+        undo.push(std::move(insertState), handler);
+
+        assert(file->channelFrames() == 7050);
+        const AJ::AudioBuffer edited = *file->pAudio;
+
+        assert(undo.undo(handler) && undo.undo(handler));
+        assert(*file->pAudio == original && file->mInfo.length == 2 * 10000);
+
+        assert(undo.redo(handler) && undo.redo(handler));
+        assert(*file->pAudio == edited && file->mInfo.length == 2 * 7050);
+        assert(!undo.canRedo() && undo.undoCount() == 2);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ 10000 -> 7050 -> 10000 -> 7050 frames\n";
+    }
+
+    static void test_piece_table_shares_chunks() {
+        std::cout << "\nTest: Piece table states keep the table's chunks, no sample is copied\n";
+        AJ::error::CollectingErrorHandler handler;
+        using AJ::editing::piece_table::PieceTable;
+
+        auto table = std::make_shared<PieceTable>();
+        AJ::AudioSamples audio = fixtures::ramp(100000, 0.0f, 0.001f);
+        const AJ::AudioBuffer *chunk = audio.get();
+        assert(table->assign(std::move(audio), 2, handler));
+        const AJ::AudioSamples original = table->flatten();
+
+        AJ::undo::UndoSystem undo;
+        AJ::undo::State state("cut");
+        assert(state.add(table, 10000, 50000, 0, handler));
+        assert(table->cut(10000, 59999, handler));
+        undo.push(std::move(state), handler);
+
+        AJ::undo::State duplicate("duplicate");
+        assert(duplicate.add(table, 0, 0, 1000, handler));
+        assert(table->duplicate(0, 999, handler));
+        undo.push(std::move(duplicate), handler);
+
+        assert(undo.undo(handler) && undo.undo(handler));
+        assert(*table->flatten() == *original);
+
+        //* the restored table is one piece of the original chunk again.
+        assert(table->pieces().size() == 1 && table->pieces()[0].source.get() == chunk);
+
+        assert(undo.redo(handler));
+        assert(table->frames() == 50000);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ " << table->pieces().size() << " pieces of the original chunk after the redo\n";
+    }
+
+    static void test_budget_spills_oldest() {
+        std::cout << "\nTest: Over the budget the oldest states spill to disk, or drop without a directory\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        const std::string directory = (std::filesystem::temp_directory_path() / "aj_undo_spill_test").string();
+        std::filesystem::remove_all(directory);
+
+        AJ::AJ_Engine engine;
+        engine.undoSystem().setSpillDirectory(directory);
+        engine.undoSystem().setBudget(3 * 10000 * 2 * sizeof(float), handler);
+
+        auto file = fixtures::make_file(fixtures::ramp(100000, 0.0f, 0.001f));
+        std::vector<AJ::AudioBuffer> history{ *file->pAudio };
+
+        for (size_t i = 0; i < 8; ++i) {
+            const AJ::sample_pos start = static_cast<AJ::sample_pos>(i * 10000);
+            assert(engine.applyEffect(file, AJ::Effect::gain, gain_params(start, start + 9999, 0.9f, handler), handler));
+            history.push_back(*file->pAudio);
+        }
+
+        //* 8 states of 80 KB, 3 in memory, 5 spilled.
+        assert(engine.undoSystem().undoCount() == 8);
+        assert(engine.undoSystem().residentBytes() <= engine.undoSystem().budget());
+        size_t spilled = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(directory)) spilled += entry.is_regular_file();
+        assert(spilled == 5);
+
+        for (size_t i = 8; i > 0; --i) {
+            assert(engine.undo(handler));
+            assert(*file->pAudio == history[i - 1]);
+        }
+
+        //* every spill file was loaded back and removed, or went to the redo states.
+        assert(engine.undoSystem().residentBytes() <= engine.undoSystem().budget());
+        engine.undoSystem().clear();
+        assert(std::filesystem::is_empty(directory));
+
+        //* no directory: the oldest states are dropped.
+        AJ::AJ_Engine dropping;
+        dropping.undoSystem().setBudget(2 * 10000 * 2 * sizeof(float), handler);
+        for (size_t i = 0; i < 5; ++i) {
+            assert(dropping.applyEffect(file, AJ::Effect::gain, gain_params(0, 9999, 0.9f, handler), handler));
+        }
+        assert(dropping.undoSystem().undoCount() == 2);
+
+        //* and the depth is capped.
+        dropping.undoSystem().setMaxStates(1);
+        assert(dropping.undoSystem().undoCount() == 1);
+
+        std::filesystem::remove_all(directory);
+        assert(handler.errors().empty());
+
+        std::cout << "  ✓ " << spilled << " states spilled and restored in order\n";
+    }
+
+    static void test_invalid_undo() {
+        std::cout << "\nTest: Invalid undo operations are rejected\n";
+        AJ::error::CollectingErrorHandler handler;
+
+        AJ::undo::UndoSystem undo;
+        assert(!undo.undo(handler));
+        assert(!undo.redo(handler));
+
+        auto file = fixtures::make_file(fixtures::ramp(1000, 0.0f, 0.001f));
+        AJ::undo::State state;
+        assert(!state.add(file, 900, 200, 200, handler));
+        assert(!state.add(file, -1, 10, 10, handler));
+        assert(!state.add(std::shared_ptr<AJ::io::AudioFile>(), 0, 10, 10, handler));
+        assert(state.empty());
+
+        //* a released file can't be restored, its state is dropped.
+        assert(state.add(file, 0, 10, 10, handler));
+        undo.push(std::move(state), handler);
+        file.reset();
+        assert(!undo.undo(handler));
+        assert(!undo.canUndo());
+
+        //* a file shortened since the state can't be restored either.
+        auto shortened = fixtures::make_file(fixtures::ramp(1000, 0.0f, 0.001f));
+        AJ::undo::State late;
+        assert(late.add(shortened, 500, 400, 400, handler));
+        undo.push(std::move(late), handler);
+        (*shortened->pAudio)[0].resize(600);
+        (*shortened->pAudio)[1].resize(600);
+        assert(!undo.undo(handler));
+
+        assert(handler.errors().size() == 7);
+
+        std::cout << "  ✓ Rejected\n";
+    }
+};